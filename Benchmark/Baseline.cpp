@@ -0,0 +1,345 @@
+#include "Baseline.h"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace bench
+{
+    namespace
+    {
+        // Recursive descent over the JSON the benchmark writes, flattening objects into dotted paths
+        class ResultParser
+        {
+        public:
+            ResultParser(const std::string& Text, ResultFile& Result) : m_Text(Text), m_Result(Result) {}
+
+            bool Parse()
+            {
+                return ParseValue("") && (SkipSpace(), m_Position == m_Text.size());
+            }
+
+        private:
+            void SkipSpace()
+            {
+                while (m_Position < m_Text.size() && std::isspace(static_cast<unsigned char>(m_Text[m_Position])))
+                {
+                    m_Position++;
+                }
+            }
+
+            bool Consume(char Expected)
+            {
+                SkipSpace();
+                if (m_Position >= m_Text.size() || m_Text[m_Position] != Expected)
+                    return false;
+                m_Position++;
+                return true;
+            }
+
+            bool ParseString(std::string& Value)
+            {
+                if (!Consume('"'))
+                    return false;
+                while (m_Position < m_Text.size() && m_Text[m_Position] != '"')
+                {
+                    // Escapes only appear in renderer names, the escaped character is kept as is
+                    if (m_Text[m_Position] == '\\' && m_Position + 1 < m_Text.size())
+                    {
+                        m_Position++;
+                    }
+                    Value += m_Text[m_Position++];
+                }
+                return Consume('"');
+            }
+
+            bool ParseValue(const std::string& Path)
+            {
+                SkipSpace();
+                if (m_Position >= m_Text.size())
+                    return false;
+
+                const char First = m_Text[m_Position];
+                if (First == '{')
+                {
+                    m_Position++;
+                    if (Consume('}'))
+                        return true;
+                    do
+                    {
+                        std::string Key;
+                        if (!ParseString(Key) || !Consume(':') || !ParseValue(Path.empty() ? Key : Path + '.' + Key))
+                            return false;
+                    } while (Consume(','));
+                    return Consume('}');
+                }
+                if (First == '[')
+                {
+                    // Arrays hold per-event data, they aren't metrics
+                    m_Position++;
+                    if (Consume(']'))
+                        return true;
+                    do
+                    {
+                        if (!ParseValue(Path + ".[]"))
+                            return false;
+                    } while (Consume(','));
+                    return Consume(']');
+                }
+                if (First == '"')
+                {
+                    std::string Value;
+                    if (!ParseString(Value))
+                        return false;
+                    if (Path.find(".[]") == std::string::npos)
+                    {
+                        m_Result.Strings[Path] = Value;
+                    }
+                    return true;
+                }
+                for (const char* Literal : { "true", "false", "null" })
+                {
+                    const size_t Length = std::char_traits<char>::length(Literal);
+                    if (m_Text.compare(m_Position, Length, Literal) == 0)
+                    {
+                        m_Position += Length;
+                        if (Path.find(".[]") == std::string::npos)
+                        {
+                            m_Result.Strings[Path] = Literal;
+                        }
+                        return true;
+                    }
+                }
+
+                const char* Begin = m_Text.c_str() + m_Position;
+                char* End = nullptr;
+                const double Value = std::strtod(Begin, &End);
+                if (End == Begin)
+                    return false;
+                m_Position += static_cast<size_t>(End - Begin);
+                if (Path.find(".[]") == std::string::npos)
+                {
+                    m_Result.Numbers[Path] = Value;
+                }
+                return true;
+            }
+
+            const std::string& m_Text;
+            ResultFile& m_Result;
+            size_t m_Position = 0;
+        };
+
+        enum class MetricKind
+        {
+            Ignored,
+            Time,
+            Counter,
+            Memory
+        };
+
+        bool StartsWith(const std::string& Text, std::string_view Prefix)
+        {
+            return Text.compare(0, Prefix.size(), Prefix) == 0;
+        }
+
+        bool EndsWith(const std::string& Text, std::string_view Suffix)
+        {
+            return Text.size() >= Suffix.size() && Text.compare(Text.size() - Suffix.size(), Suffix.size(), Suffix) == 0;
+        }
+
+        MetricKind GetKind(const std::string& Name)
+        {
+            // The config describes the scene, sample counts the run
+            if (StartsWith(Name, "config.") || EndsWith(Name, ".samples"))
+                return MetricKind::Ignored;
+            if (Name == "frame_ms.hitches" || StartsWith(Name, "per_frame.") || EndsWith(Name, ".allocations"))
+                return MetricKind::Counter;
+            if (StartsWith(Name, "cpu_ms.") || StartsWith(Name, "gpu_ms.") || StartsWith(Name, "frame_ms."))
+                return MetricKind::Time;
+            if (StartsWith(Name, "startup."))
+                return EndsWith(Name, "_ms") ? MetricKind::Time : MetricKind::Counter;
+            // Current bytes at exit depend on what was freed last, the peaks and totals are what a change moves
+            if (Name == "gpu_memory_bytes" || Name == "cpu_memory.total_bytes" || EndsWith(Name, ".peak_bytes"))
+                return MetricKind::Memory;
+            return MetricKind::Ignored;
+        }
+
+        const char* GetStatusName(DiffStatus Status)
+        {
+            switch (Status)
+            {
+            case DiffStatus::Improved:
+                return "improved";
+            case DiffStatus::Regressed:
+                return "regressed";
+            default:
+                return "unchanged";
+            }
+        }
+
+        // Numbers in keys print without trailing zeros, 0.25 rather than 0.250000
+        std::string FormatNumber(double Value)
+        {
+            std::ostringstream Stream;
+            Stream << Value;
+            return Stream.str();
+        }
+    }
+
+    bool ReadResult(const std::string& Path, ResultFile& Result)
+    {
+        std::ifstream File(Path, std::ios::binary);
+        if (!File)
+            return false;
+
+        std::ostringstream Text;
+        Text << File.rdbuf();
+        const std::string Contents = Text.str();
+        Result = ResultFile();
+        return ResultParser(Contents, Result).Parse();
+    }
+
+    std::string GetSceneKey(const ResultFile& Result)
+    {
+        const auto Number = [&Result](const char* Key)
+        {
+            const auto Found = Result.Numbers.find(std::string("config.") + Key);
+            return Found != Result.Numbers.end() ? FormatNumber(Found->second) : std::string("0");
+        };
+        const auto Text = [&Result](const char* Key)
+        {
+            const auto Found = Result.Strings.find(std::string("config.") + Key);
+            return Found != Result.Strings.end() ? Found->second : std::string();
+        };
+
+        // Frame counts and the resolution are left out: they change how a scene is measured, not which one
+        std::string Key = "objects" + Number("objects") + "-spheres" + Number("spheres") + "-materials" + Number("materials")
+            + "-lights" + Number("lights") + "-dynamic" + Number("dynamic") + '-' + Text("path") + '-' + Text("mode");
+        if (Text("gpu_culling") == "true")
+        {
+            Key += "-gpuculling";
+        }
+        if (Number("particles") != "0")
+        {
+            Key += "-particles" + Number("particles");
+        }
+        return Key;
+    }
+
+    std::string GetBaselinePath(const std::string& Directory, const std::string& Name, const std::string& Scene)
+    {
+        if (EndsWith(Name, ".json"))
+            return Name;
+        return (std::filesystem::path(Directory) / Name / (Scene + ".json")).string();
+    }
+
+    bool SaveBaseline(const std::string& ResultPath, const std::string& BaselinePath)
+    {
+        std::error_code Error;
+        const std::filesystem::path Target(BaselinePath);
+        if (Target.has_parent_path())
+        {
+            std::filesystem::create_directories(Target.parent_path(), Error);
+        }
+        std::filesystem::copy_file(ResultPath, Target, std::filesystem::copy_options::overwrite_existing, Error);
+        return !Error;
+    }
+
+    Comparison Compare(const ResultFile& Baseline, const ResultFile& Current, const Thresholds& Limits)
+    {
+        Comparison Result;
+        Result.Scene = GetSceneKey(Current);
+
+        // Same scene key but other frame counts, resolution or GPU: the numbers are still listed, flagged
+        for (const auto& [Key, Value] : Current.Numbers)
+        {
+            const auto Found = Baseline.Numbers.find(Key);
+            if (StartsWith(Key, "config.") && (Found == Baseline.Numbers.end() || Found->second != Value))
+            {
+                Result.ConfigMismatches.push_back(Key);
+            }
+        }
+        for (const auto& [Key, Value] : Current.Strings)
+        {
+            const auto Found = Baseline.Strings.find(Key);
+            if (Found == Baseline.Strings.end() || Found->second != Value)
+            {
+                Result.ConfigMismatches.push_back(Key);
+            }
+        }
+
+        for (const auto& [Name, Value] : Current.Numbers)
+        {
+            const MetricKind Kind = GetKind(Name);
+            const auto Found = Baseline.Numbers.find(Name);
+            if (Kind == MetricKind::Ignored || Found == Baseline.Numbers.end())
+                continue;
+
+            MetricDiff Diff;
+            Diff.Name = Name;
+            Diff.Baseline = Found->second;
+            Diff.Current = Value;
+            const double Delta = Diff.Current - Diff.Baseline;
+            Diff.DeltaPercent = Diff.Baseline != 0.0 ? Delta / std::abs(Diff.Baseline) * 100.0 : (Delta != 0.0 ? 100.0 : 0.0);
+
+            const double Limit = Kind == MetricKind::Time ? Limits.TimePercent : Kind == MetricKind::Counter ? Limits.CounterPercent : Limits.MemoryPercent;
+            const bool bSignificant = std::abs(Diff.DeltaPercent) > Limit && (Kind != MetricKind::Time || std::abs(Delta) > Limits.TimeMinimumMs);
+            if (bSignificant)
+            {
+                Diff.Status = Delta > 0.0 ? DiffStatus::Regressed : DiffStatus::Improved;
+                Result.Regressions += Diff.Status == DiffStatus::Regressed ? 1 : 0;
+                Result.Improvements += Diff.Status == DiffStatus::Improved ? 1 : 0;
+            }
+            Result.Metrics.push_back(Diff);
+        }
+        return Result;
+    }
+
+    bool WriteComparison(const std::string& Path, const std::string& BaselinePath, const Comparison& Result)
+    {
+        std::ofstream File(Path);
+        File << std::fixed << std::setprecision(4);
+        File << "{\n";
+        File << "  \"scene\": \"" << Result.Scene << "\",\n";
+        File << "  \"baseline\": \"" << BaselinePath << "\",\n";
+        File << "  \"regressions\": " << Result.Regressions << ",\n";
+        File << "  \"improvements\": " << Result.Improvements << ",\n";
+        File << "  \"config_mismatches\": [";
+        for (size_t Index = 0; Index < Result.ConfigMismatches.size(); Index++)
+        {
+            File << (Index > 0 ? ", " : "") << '"' << Result.ConfigMismatches[Index] << '"';
+        }
+        File << "],\n";
+        File << "  \"metrics\": [\n";
+        for (size_t Index = 0; Index < Result.Metrics.size(); Index++)
+        {
+            const MetricDiff& Diff = Result.Metrics[Index];
+            File << "    { \"name\": \"" << Diff.Name << "\", \"baseline\": " << Diff.Baseline << ", \"current\": " << Diff.Current
+                << ", \"delta_percent\": " << Diff.DeltaPercent << ", \"status\": \"" << GetStatusName(Diff.Status) << "\" }"
+                << (Index + 1 < Result.Metrics.size() ? ",\n" : "\n");
+        }
+        File << "  ]\n";
+        File << "}\n";
+
+        std::cout << std::fixed << std::setprecision(2);
+        for (const std::string& Mismatch : Result.ConfigMismatches)
+        {
+            std::cout << "[" << Result.Scene << "] differs from the baseline: " << Mismatch << '\n';
+        }
+        for (const MetricDiff& Diff : Result.Metrics)
+        {
+            if (Diff.Status != DiffStatus::Unchanged)
+            {
+                std::cout << "[" << Result.Scene << "] " << GetStatusName(Diff.Status) << ' ' << Diff.Name << ": " << Diff.Baseline
+                    << " -> " << Diff.Current << " (" << std::showpos << Diff.DeltaPercent << std::noshowpos << "%)\n";
+            }
+        }
+        std::cout << "[" << Result.Scene << "] " << Result.Regressions << " regressions, " << Result.Improvements
+            << " improvements against " << BaselinePath << '\n';
+        return static_cast<bool>(File);
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+// Baselines of the scene benchmark: a run's result file saved under a name, and the comparison of later runs against it.
+//
+// Every result file is flattened into numeric metrics keyed by their JSON path ("cpu_ms.p99", "per_frame.draw_calls",
+// "cpu_memory.mesh.peak_bytes"...). Each metric is judged by its kind: times must move by more than a relative and an
+// absolute threshold to count, counters and memory by a relative one. Lower is better for all of them, so a rise past
+// its threshold is a regression and a fall an improvement.
+//
+//     FireGLBench --objects=5000 --save-baseline=main         // Baselines/main/<scene>.json
+//     FireGLBench --objects=5000 --compare=main --threshold=3  // exit code 2 on regressions, diff next to the output
+
+namespace bench
+{
+    // Numbers and strings of a result file by JSON path, arrays are skipped
+    struct ResultFile
+    {
+        std::map<std::string, double> Numbers;
+        std::map<std::string, std::string> Strings;
+    };
+
+    // Significance thresholds of the comparison
+    struct Thresholds
+    {
+        double TimePercent = 5.0;       // Relative change of a time that counts
+        double TimeMinimumMs = 0.05;    // Absolute change of a time that counts, below it everything is noise
+        double CounterPercent = 1.0;    // Relative change of a per-frame counter (draw calls, binds, uploads...)
+        double MemoryPercent = 5.0;     // Relative change of a memory total or peak
+    };
+
+    enum class DiffStatus
+    {
+        Unchanged,
+        Improved,
+        Regressed
+    };
+
+    // One metric of the baseline compared with the current run
+    struct MetricDiff
+    {
+        std::string Name;
+        double Baseline = 0.0;
+        double Current = 0.0;
+        double DeltaPercent = 0.0;      // (Current - Baseline) / Baseline, in percent; 0 if both are 0
+        DiffStatus Status = DiffStatus::Unchanged;
+    };
+
+    struct Comparison
+    {
+        std::string Scene;                          // Scene key of both runs
+        std::vector<MetricDiff> Metrics;            // Every metric both files have, in name order
+        std::vector<std::string> ConfigMismatches;  // Config or renderer entries that differ, the runs may not compare
+        size_t Regressions = 0;
+        size_t Improvements = 0;
+    };
+
+    // Reads a result file written by the benchmark. Returns false if it can't be read or parsed.
+    bool ReadResult(const std::string& Path, ResultFile& Result);
+
+    // Name of the scene a result describes, built from its config, e.g. "objects5000-materials8-lights64-dynamic0.25-orbit-forward"
+    std::string GetSceneKey(const ResultFile& Result);
+
+    // Path of the baseline of a scene: <Directory>/<Name>/<Scene>.json, or Name itself if it is a .json file
+    std::string GetBaselinePath(const std::string& Directory, const std::string& Name, const std::string& Scene);
+
+    // Copies a result file to a baseline path, creating its directories
+    bool SaveBaseline(const std::string& ResultPath, const std::string& BaselinePath);
+
+    // Compares every metric of a run with its baseline
+    Comparison Compare(const ResultFile& Baseline, const ResultFile& Current, const Thresholds& Limits);
+
+    // Writes a comparison as JSON, then every changed metric to the console
+    bool WriteComparison(const std::string& Path, const std::string& BaselinePath, const Comparison& Result);
+}
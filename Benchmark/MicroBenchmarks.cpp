@@ -0,0 +1,402 @@
+#include <FireGL/Renderer/Transform.h>
+#include <FireGL/Renderer/TransformPool.h>
+#include <FireGL/Renderer/RenderQueue.h>
+#include <FireGL/Renderer/DynamicBVH.h>
+#include <FireGL/Renderer/Frustum.h>
+#include <FireGL/Renderer/FrustumCulling.h>
+#include <FireGL/Renderer/MeshOptimizer.h>
+#include <FireGL/Renderer/Mesh.h>
+#include <FireGL/Renderer/Model.h>
+#include <FireGL/Renderer/Skeleton.h>
+#include <FireGL/Renderer/AnimationClip.h>
+#include <FireGL/Renderer/AnimationSystem.h>
+#include <FireGL/Renderer/BonePaletteBuffer.h>
+#include <FireGL/Core/JobSystem.h>
+#include <FireGL/Core/InputManager.h>
+#include <FireGL/Core/SystemManager.h>
+
+#include <External/glm/gtc/matrix_transform.hpp>
+#include <External/assimp/scene.h>
+
+#include <benchmark/benchmark.h>
+
+// Microbenchmarks of the CPU kernels behind a frame, a model load, animation and input processing. None of them needs an
+// OpenGL context. Shader::GetUniformLocation isn't among them: it is only reached with a linked program, so only
+// with a context, and its cache is timed by the FireGLBench scenes instead.
+//
+//     FireGLMicroBench --benchmark_filter=Transform --benchmark_format=json
+
+namespace
+{
+    // Low-discrepancy sequence in [0, 1), the same inputs on every run and platform
+    float Sequence(uint32_t Index, float Irrational)
+    {
+        const float Value = static_cast<float>(Index + 1) * Irrational;
+        return Value - std::floor(Value);
+    }
+
+    glm::vec3 ScenePosition(uint32_t Index, float Extent)
+    {
+        return glm::vec3(Sequence(Index, 0.7548776662f), Sequence(Index, 0.5698402910f), Sequence(Index, 0.3247179572f)) * (2.0f * Extent) - Extent;
+    }
+
+    // Looks at the origin from the edge of a scene of the given extent, as the renderer's cameras do
+    fgl::Frustum SceneFrustum(float Extent)
+    {
+        const glm::mat4 Projection = glm::perspectiveRH_ZO(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, Extent * 4.0f);
+        const glm::mat4 View = glm::lookAtRH(glm::vec3(0.0f, Extent * 0.5f, Extent * 1.5f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        return fgl::Frustum(Projection * View);
+    }
+
+    // Grid of Side x Side quads, the vertex and index layout a model import produces
+    void MakeGrid(uint32_t Side, std::vector<fgl::Vertex>& Vertices, std::vector<unsigned int>& Indices)
+    {
+        Vertices.clear();
+        Indices.clear();
+        for (uint32_t Y = 0; Y <= Side; Y++)
+        {
+            for (uint32_t X = 0; X <= Side; X++)
+            {
+                const float U = static_cast<float>(X) / static_cast<float>(Side);
+                const float V = static_cast<float>(Y) / static_cast<float>(Side);
+                Vertices.push_back({ glm::vec3(U, std::sin(U * 12.0f) * std::cos(V * 12.0f) * 0.1f, V), glm::vec3(0.0f, 1.0f, 0.0f), glm::vec2(U, V) });
+            }
+        }
+        for (uint32_t Y = 0; Y < Side; Y++)
+        {
+            for (uint32_t X = 0; X < Side; X++)
+            {
+                const unsigned int Corner = Y * (Side + 1) + X;
+                Indices.insert(Indices.end(), { Corner, Corner + Side + 1, Corner + 1, Corner + 1, Corner + Side + 1, Corner + Side + 2 });
+            }
+        }
+    }
+
+    // The grid as Assimp imports it, positions, normals and texture coordinates in separate arrays and one face per triangle
+    std::unique_ptr<aiMesh> MakeAssimpGrid(uint32_t Side)
+    {
+        std::vector<fgl::Vertex> Vertices;
+        std::vector<unsigned int> Indices;
+        MakeGrid(Side, Vertices, Indices);
+
+        auto Mesh = std::make_unique<aiMesh>();
+        Mesh->mPrimitiveTypes = aiPrimitiveType_TRIANGLE;
+        Mesh->mNumVertices = static_cast<unsigned int>(Vertices.size());
+        Mesh->mVertices = new aiVector3D[Vertices.size()];
+        Mesh->mNormals = new aiVector3D[Vertices.size()];
+        Mesh->mTextureCoords[0] = new aiVector3D[Vertices.size()];
+        Mesh->mNumUVComponents[0] = 2;
+        for (size_t Index = 0; Index < Vertices.size(); Index++)
+        {
+            const fgl::Vertex& Source = Vertices[Index];
+            Mesh->mVertices[Index] = aiVector3D(Source.Position.x, Source.Position.y, Source.Position.z);
+            Mesh->mNormals[Index] = aiVector3D(Source.Normal.x, Source.Normal.y, Source.Normal.z);
+            Mesh->mTextureCoords[0][Index] = aiVector3D(Source.TexCoords.x, Source.TexCoords.y, 0.0f);
+        }
+
+        Mesh->mNumFaces = static_cast<unsigned int>(Indices.size() / 3);
+        Mesh->mFaces = new aiFace[Mesh->mNumFaces];
+        for (unsigned int Face = 0; Face < Mesh->mNumFaces; Face++)
+        {
+            Mesh->mFaces[Face].mNumIndices = 3;
+            Mesh->mFaces[Face].mIndices = new unsigned int[3]{ Indices[Face * 3], Indices[Face * 3 + 1], Indices[Face * 3 + 2] };
+        }
+        return Mesh;
+    }
+
+    // Chain of BoneCount bones under a root node, swaying for Seconds at 30 keys per second: the skeleton and clip
+    // of a skinned character, without shipping one. The scene owns the nodes, the mesh and the animation
+    std::unique_ptr<aiScene> MakeAnimatedChain(uint32_t BoneCount, float Seconds)
+    {
+        constexpr double TicksPerSecond = 30.0;
+        const unsigned int KeyCount = static_cast<unsigned int>(Seconds * TicksPerSecond) + 1;
+
+        auto Scene = std::make_unique<aiScene>();
+        Scene->mRootNode = new aiNode("Root");
+
+        auto Mesh = new aiMesh();
+        Mesh->mNumBones = BoneCount;
+        Mesh->mBones = new aiBone*[BoneCount];
+
+        auto Animation = new aiAnimation();
+        Animation->mName = "Sway";
+        Animation->mTicksPerSecond = TicksPerSecond;
+        Animation->mDuration = static_cast<double>(KeyCount - 1);
+        Animation->mNumChannels = BoneCount;
+        Animation->mChannels = new aiNodeAnim*[BoneCount];
+
+        aiNode* Parent = Scene->mRootNode;
+        for (uint32_t Bone = 0; Bone < BoneCount; Bone++)
+        {
+            const aiString Name(("Bone" + std::to_string(Bone)).c_str());
+
+            aiNode* Node = new aiNode(Name.C_Str());
+            Node->mTransformation = aiMatrix4x4::Translation(aiVector3D(0.0f, Bone == 0 ? 0.0f : 0.1f, 0.0f), Node->mTransformation);
+            Node->mParent = Parent;
+            Parent->mNumChildren = 1;
+            Parent->mChildren = new aiNode*[1]{ Node };
+            Parent = Node;
+
+            Mesh->mBones[Bone] = new aiBone();
+            Mesh->mBones[Bone]->mName = Name;
+            aiMatrix4x4::Translation(aiVector3D(0.0f, -0.1f * static_cast<float>(Bone), 0.0f), Mesh->mBones[Bone]->mOffsetMatrix);
+
+            // Every bone bends back and forth around z, a little out of phase with its parent
+            aiNodeAnim* Channel = new aiNodeAnim();
+            Channel->mNodeName = Name;
+            Channel->mNumPositionKeys = 1;
+            Channel->mPositionKeys = new aiVectorKey[1]{ aiVectorKey(0.0, Node->mTransformation * aiVector3D()) };
+            Channel->mNumScalingKeys = 1;
+            Channel->mScalingKeys = new aiVectorKey[1]{ aiVectorKey(0.0, aiVector3D(1.0f)) };
+            Channel->mNumRotationKeys = KeyCount;
+            Channel->mRotationKeys = new aiQuatKey[KeyCount];
+            for (unsigned int Key = 0; Key < KeyCount; Key++)
+            {
+                const float Angle = 0.2f * std::sin(static_cast<float>(Key) * 0.2f + static_cast<float>(Bone) * 0.3f);
+                Channel->mRotationKeys[Key] = aiQuatKey(static_cast<double>(Key), aiQuaternion(aiVector3D(0.0f, 0.0f, 1.0f), Angle));
+            }
+            Animation->mChannels[Bone] = Channel;
+        }
+
+        Scene->mNumMeshes = 1;
+        Scene->mMeshes = new aiMesh*[1]{ Mesh };
+        Scene->mNumAnimations = 1;
+        Scene->mAnimations = new aiAnimation*[1]{ Animation };
+        return Scene;
+    }
+
+    // Stands in for the application window, never initialized: the InputManager only asks it for the focus
+    class BenchmarkWindow : public fgl::BaseWindow
+    {
+    public:
+        BenchmarkWindow()
+        {
+            fgl::SystemManager<fgl::BaseWindow>::Set(this);
+        }
+    };
+
+    class BenchmarkInputManager : public fgl::InputManager
+    {
+    public:
+        using fgl::InputManager::RegisterKeyEvent;
+    };
+}
+
+// Moves every transform, then sweeps the pool like Renderer::BatchSceneObjects does (TransformPool::RecalculateModelMatrix per slot)
+static void BM_TransformUpdateDirtyMatrices(benchmark::State& State)
+{
+    const uint32_t Count = static_cast<uint32_t>(State.range(0));
+    std::vector<std::unique_ptr<fgl::Transform>> Transforms;
+    for (uint32_t Index = 0; Index < Count; Index++)
+    {
+        Transforms.push_back(std::make_unique<fgl::Transform>(nullptr));
+    }
+
+    float Phase = 0.0f;
+    for (auto _ : State)
+    {
+        Phase += 1.0f;
+        for (uint32_t Index = 0; Index < Count; Index++)
+        {
+            Transforms[Index]->SetPosition(static_cast<float>(Index), Phase, 0.0f);
+            Transforms[Index]->SetRotation(Phase, static_cast<float>(Index), 0.0f);
+        }
+        fgl::TransformPool::UpdateDirtyMatrices();
+        benchmark::DoNotOptimize(Transforms.front()->GetModelMatrix());
+    }
+    State.SetItemsProcessed(State.iterations() * Count);
+}
+BENCHMARK(BM_TransformUpdateDirtyMatrices)->Arg(1000)->Arg(10000)->Arg(100000);
+
+// Builds and sorts the draw order of a frame's batches, the second half of batching
+static void BM_RenderQueueSort(benchmark::State& State)
+{
+    const uint32_t Count = static_cast<uint32_t>(State.range(0));
+    fgl::RenderQueue Queue;
+    for (auto _ : State)
+    {
+        Queue.Clear();
+        for (uint32_t Index = 0; Index < Count; Index++)
+        {
+            Queue.Push(fgl::RenderQueue::MakeSortKey(0, Index % 8, Index % 64, Index % 512, Sequence(Index, 0.6180339887f) * 100.0f), Index);
+        }
+        Queue.Sort();
+        benchmark::DoNotOptimize(Queue.GetItems().data());
+    }
+    State.SetItemsProcessed(State.iterations() * Count);
+}
+BENCHMARK(BM_RenderQueueSort)->Arg(1000)->Arg(10000)->Arg(100000);
+
+// Frustum query of the BVH, the culling half of batching (Scene::QueryFrustum)
+static void BM_BVHQueryFrustum(benchmark::State& State)
+{
+    const uint32_t Count = static_cast<uint32_t>(State.range(0));
+    const float Extent = std::sqrt(static_cast<float>(Count)) * 2.0f;
+    fgl::DynamicBVH Tree;
+    for (uint32_t Index = 0; Index < Count; Index++)
+    {
+        const glm::vec3 Center = ScenePosition(Index, Extent);
+        fgl::BoundingBox Box;
+        Box.Min = Center - 0.5f;
+        Box.Max = Center + 0.5f;
+        Tree.Insert(Index, Box);
+    }
+
+    const fgl::Frustum ViewFrustum = SceneFrustum(Extent);
+    std::vector<uint32_t> Visible;
+    for (auto _ : State)
+    {
+        Visible.clear();
+        Tree.QueryFrustum(ViewFrustum, Visible);
+        benchmark::DoNotOptimize(Visible.data());
+    }
+    State.SetItemsProcessed(State.iterations() * Count);
+}
+BENCHMARK(BM_BVHQueryFrustum)->Arg(1000)->Arg(10000)->Arg(100000);
+
+// Brute-force SIMD sphere culling of every object
+static void BM_CullSpheres(benchmark::State& State)
+{
+    const uint32_t Count = static_cast<uint32_t>(State.range(0));
+    const float Extent = std::sqrt(static_cast<float>(Count)) * 2.0f;
+    fgl::BoundingSphereArrays Spheres;
+    Spheres.Resize(Count);
+    for (uint32_t Index = 0; Index < Count; Index++)
+    {
+        const glm::vec3 Center = ScenePosition(Index, Extent);
+        Spheres.X[Index] = Center.x;
+        Spheres.Y[Index] = Center.y;
+        Spheres.Z[Index] = Center.z;
+        Spheres.Radius[Index] = 0.87f;
+    }
+
+    const fgl::Frustum ViewFrustum = SceneFrustum(Extent);
+    std::vector<uint32_t> Visible;
+    for (auto _ : State)
+    {
+        Visible.clear();
+        fgl::CullSpheres(ViewFrustum, Spheres, Visible);
+        benchmark::DoNotOptimize(Visible.data());
+    }
+    State.SetItemsProcessed(State.iterations() * Count);
+}
+BENCHMARK(BM_CullSpheres)->Arg(1000)->Arg(10000)->Arg(100000);
+
+// Post-import mesh processing of Model loading: vertex fetch order, then overdraw order
+static void BM_MeshOptimize(benchmark::State& State)
+{
+    const uint32_t Side = static_cast<uint32_t>(State.range(0));
+    std::vector<fgl::Vertex> SourceVertices;
+    std::vector<unsigned int> SourceIndices;
+    MakeGrid(Side, SourceVertices, SourceIndices);
+
+    for (auto _ : State)
+    {
+        State.PauseTiming();
+        std::vector<fgl::Vertex> Vertices = SourceVertices;
+        std::vector<unsigned int> Indices = SourceIndices;
+        State.ResumeTiming();
+
+        fgl::OptimizeVertexFetch(Vertices, Indices);
+        fgl::OptimizeOverdraw(Vertices, Indices);
+        benchmark::DoNotOptimize(Indices.data());
+    }
+    State.SetItemsProcessed(State.iterations() * (SourceIndices.size() / 3));
+}
+BENCHMARK(BM_MeshOptimize)->Arg(64)->Arg(256);
+
+// Content hash of an imported mesh, paid by every BaseMesh built with deduplication (BaseMesh constructor)
+static void BM_MeshContentHash(benchmark::State& State)
+{
+    const uint32_t Side = static_cast<uint32_t>(State.range(0));
+    std::vector<fgl::Vertex> Vertices;
+    std::vector<unsigned int> Indices;
+    MakeGrid(Side, Vertices, Indices);
+
+    for (auto _ : State)
+    {
+        benchmark::DoNotOptimize(fgl::ComputeMeshContentHash(Vertices, Indices));
+    }
+    State.SetBytesProcessed(State.iterations() * (Vertices.size() * sizeof(fgl::Vertex) + Indices.size() * sizeof(unsigned int)));
+}
+BENCHMARK(BM_MeshContentHash)->Arg(64)->Arg(256);
+
+// Conversion of an Assimp mesh into vertices and indices, the first step of Model::ProcessMesh
+static void BM_ModelProcessMesh(benchmark::State& State)
+{
+    const std::unique_ptr<aiMesh> Mesh = MakeAssimpGrid(static_cast<uint32_t>(State.range(0)));
+
+    for (auto _ : State)
+    {
+        std::vector<fgl::Vertex> Vertices = fgl::ProcessMeshVertices(*Mesh);
+        std::vector<unsigned int> Indices = fgl::ProcessMeshIndices(*Mesh);
+        benchmark::DoNotOptimize(Vertices.data());
+        benchmark::DoNotOptimize(Indices.data());
+    }
+    State.SetItemsProcessed(State.iterations() * Mesh->mNumVertices);
+}
+BENCHMARK(BM_ModelProcessMesh)->Arg(64)->Arg(256);
+
+// One input frame with every bound key changing: InputManager::UpdateKeyState, then the dispatch of the key events
+static void BM_InputManagerProcessInput(benchmark::State& State)
+{
+    BenchmarkWindow Window;
+    BenchmarkInputManager Input;
+
+    const int KeyCount = static_cast<int>(State.range(0));
+    int Fired = 0;
+    for (int Key = 0; Key < KeyCount; Key++)
+    {
+        Input.RegisterKeyEvent(GLFW_KEY_SPACE + Key, fgl::KeyEventType::OnPressed, [&Fired]() { Fired++; });
+        Input.RegisterKeyEvent(GLFW_KEY_SPACE + Key, fgl::KeyEventType::OnReleased, [&Fired]() { Fired--; });
+    }
+
+    int Action = GLFW_PRESS;
+    for (auto _ : State)
+    {
+        for (int Key = 0; Key < KeyCount; Key++)
+        {
+            Input.UpdateKey(GLFW_KEY_SPACE + Key, Action, 0);
+        }
+        Input.ProcessInput();
+        Action = Action == GLFW_PRESS ? GLFW_RELEASE : GLFW_PRESS;
+    }
+    benchmark::DoNotOptimize(Fired);
+    State.SetItemsProcessed(State.iterations() * KeyCount);
+}
+BENCHMARK(BM_InputManagerProcessInput)->Arg(8)->Arg(64);
+
+// A crowd of 60-bone characters: AnimationSystem::Update samples, blends and builds the palettes on the JobSystem workers
+static void BM_AnimationCrowdUpdate(benchmark::State& State)
+{
+    const std::unique_ptr<aiScene> Scene = MakeAnimatedChain(60, 4.0f);
+    const std::shared_ptr<fgl::Skeleton> Chain = fgl::Skeleton::Import(Scene.get());
+    const fgl::AnimationClip Sway = fgl::AnimationClip::Import(Scene->mAnimations[0], *Chain);
+
+    fgl::JobSystem Jobs;
+    fgl::BonePaletteBuffer Palettes;
+    fgl::AnimationSystem Crowd;
+    Crowd.SetJobSystem(&Jobs);
+
+    // Characters start at different times; a quarter stay in a long cross-fade, blending two poses every update
+    const uint32_t InstanceCount = static_cast<uint32_t>(State.range(0));
+    for (uint32_t Index = 0; Index < InstanceCount; Index++)
+    {
+        const uint32_t Instance = Crowd.AddInstance(*Chain, Palettes.Allocate(Chain->GetBoneCount()));
+        Crowd.Play(Instance, Sway, Sequence(Index, 0.6180339887f) * Sway.GetDuration());
+        Crowd.SetSpeed(Instance, 0.8f + 0.4f * Sequence(Index, 0.4142135624f));
+        if (Index % 4 == 0)
+        {
+            Crowd.CrossFade(Instance, Sway, 1000.0f);
+        }
+    }
+
+    for (auto _ : State)
+    {
+        Crowd.Update(1.0f / 60.0f, Palettes);
+    }
+    State.SetItemsProcessed(State.iterations() * InstanceCount);
+}
+BENCHMARK(BM_AnimationCrowdUpdate)->Arg(500)->UseRealTime();
+
+BENCHMARK_MAIN();
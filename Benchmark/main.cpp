@@ -0,0 +1,530 @@
+#include <FireGL/FireGL.h>
+
+#include "Baseline.h"
+
+#include <External/glm/gtc/constants.hpp>
+
+#include <chrono>
+#include <iomanip>
+
+// Headless scene benchmark: renders a generated scene along a fixed camera path for a fixed number of frames,
+// then writes the CPU and GPU frame time percentiles as JSON. Every run with the same parameters draws the same frames.
+//
+//     FireGLBench --objects=5000 --materials=8 --lights=64 --dynamic=0.25 --path=flythrough --output=bench.json
+//
+// A run can be saved as a named baseline, or compared against one: the comparison writes a per-metric diff of the scene
+// and exits with 2 when a metric regressed past its threshold, see Baseline.h.
+
+namespace
+{
+    // A camera only moved by the benchmark
+    class BenchCamera : public fgl::BaseCamera
+    {
+    public:
+        virtual void ProcessMovementInput(fgl::CameraMovement MovementDirection, float DeltaTime) override {}
+        virtual void ProcessRotationInput(float XOffset, float YOffset) override {}
+
+        // Places the camera at Position, looking at Target
+        void LookAt(const glm::vec3& Position, const glm::vec3& Target)
+        {
+            const glm::vec3 Direction = glm::normalize(Target - Position);
+            GetCameraTransform().SetPosition(Position);
+            GetCameraTransform().SetRotation(glm::vec3(glm::degrees(std::atan2(Direction.z, Direction.x)),
+                glm::degrees(std::asin(Direction.y)), 0.0f));
+        }
+    };
+
+    struct BenchConfig
+    {
+        uint32_t Objects = 1000;        // Objects of the scene
+        float SphereRatio = 0.5f;       // Share of spheres, the rest are cubes
+        uint32_t Materials = 4;         // Distinct materials, assigned round-robin
+        uint32_t Lights = 0;            // Clustered point lights (OpenGL 4.3+)
+        float DynamicRatio = 0.1f;      // Share of objects moved every frame
+        uint32_t Frames = 600;          // Measured frames
+        uint32_t WarmupFrames = 60;     // Frames rendered before measuring
+        int Width = 1280;               // Framebuffer size
+        int Height = 720;
+        std::string Path = "orbit";     // Camera path: orbit or flythrough
+        bool bDeferred = false;         // RenderingMode::Deferred instead of Default
+        bool bGPUCulling = false;       // GPU culling path (OpenGL 4.3+)
+        uint32_t Particles = 0;         // Capacity of a GPU particle system kept full, none if 0
+        std::string Output = "FireGLBench.json";
+        std::string StartupOutput;      // Startup timeline JSON, not written when empty
+        std::string BaselineDirectory = "Baselines";
+        std::string SaveBaseline;       // Baseline name to store the result under, not stored when empty
+        std::string CompareBaseline;    // Baseline name or .json file to compare the result with, not compared when empty
+        std::string DiffOutput;         // Comparison JSON, next to the output when empty
+        bench::Thresholds Thresholds;
+    };
+
+    struct Percentiles
+    {
+        double Mean = 0.0;
+        double P50 = 0.0;
+        double P90 = 0.0;
+        double P95 = 0.0;
+        double P99 = 0.0;
+        double Max = 0.0;
+    };
+
+    bool ParseArguments(int argc, char** argv, BenchConfig& Config)
+    {
+        for (int Index = 1; Index < argc; Index++)
+        {
+            const std::string_view Argument = argv[Index];
+            const size_t Separator = Argument.find('=');
+            if (Argument.substr(0, 2) != "--" || Separator == std::string_view::npos)
+            {
+                std::cerr << "Expected --name=value, got " << Argument << '\n';
+                return false;
+            }
+
+            const std::string_view Name = Argument.substr(2, Separator - 2);
+            const std::string Value(Argument.substr(Separator + 1));
+            if (Name == "objects") Config.Objects = static_cast<uint32_t>(std::stoul(Value));
+            else if (Name == "spheres") Config.SphereRatio = std::clamp(std::stof(Value), 0.0f, 1.0f);
+            else if (Name == "materials") Config.Materials = std::max(static_cast<uint32_t>(std::stoul(Value)), 1u);
+            else if (Name == "lights") Config.Lights = static_cast<uint32_t>(std::stoul(Value));
+            else if (Name == "dynamic") Config.DynamicRatio = std::clamp(std::stof(Value), 0.0f, 1.0f);
+            else if (Name == "frames") Config.Frames = std::max(static_cast<uint32_t>(std::stoul(Value)), 1u);
+            else if (Name == "warmup") Config.WarmupFrames = static_cast<uint32_t>(std::stoul(Value));
+            else if (Name == "width") Config.Width = std::max(std::stoi(Value), 1);
+            else if (Name == "height") Config.Height = std::max(std::stoi(Value), 1);
+            else if (Name == "path") Config.Path = Value;
+            else if (Name == "mode") Config.bDeferred = Value == "deferred";
+            else if (Name == "gpu-culling") Config.bGPUCulling = Value == "1" || Value == "on";
+            else if (Name == "particles") Config.Particles = static_cast<uint32_t>(std::stoul(Value));
+            else if (Name == "output") Config.Output = Value;
+            else if (Name == "startup") Config.StartupOutput = Value;
+            else if (Name == "baseline-dir") Config.BaselineDirectory = Value;
+            else if (Name == "save-baseline") Config.SaveBaseline = Value;
+            else if (Name == "compare") Config.CompareBaseline = Value;
+            else if (Name == "diff") Config.DiffOutput = Value;
+            else if (Name == "threshold") Config.Thresholds.TimePercent = std::max(std::stod(Value), 0.0);
+            else if (Name == "min-delta-ms") Config.Thresholds.TimeMinimumMs = std::max(std::stod(Value), 0.0);
+            else if (Name == "counter-threshold") Config.Thresholds.CounterPercent = std::max(std::stod(Value), 0.0);
+            else if (Name == "memory-threshold") Config.Thresholds.MemoryPercent = std::max(std::stod(Value), 0.0);
+            else
+            {
+                std::cerr << "Unknown option --" << Name << '\n';
+                return false;
+            }
+        }
+        return Config.Path == "orbit" || Config.Path == "flythrough";
+    }
+
+    // Low-discrepancy sequence in [0, 1), identical on every platform unlike the <random> distributions
+    float Sequence(uint32_t Index, float Irrational)
+    {
+        const float Value = static_cast<float>(Index + 1) * Irrational;
+        return Value - std::floor(Value);
+    }
+
+    // Camera of a frame, a function of its index only
+    void PlaceCamera(BenchCamera& Camera, const BenchConfig& Config, uint32_t Frame, uint32_t FrameCount, float Extent)
+    {
+        const float Progress = static_cast<float>(Frame) / static_cast<float>(std::max(FrameCount, 1u));
+        if (Config.Path == "orbit")
+        {
+            const float Angle = Progress * glm::two_pi<float>();
+            const glm::vec3 Position(std::cos(Angle) * Extent * 1.5f, Extent * 0.5f, std::sin(Angle) * Extent * 1.5f);
+            Camera.LookAt(Position, glm::vec3(0.0f));
+        }
+        else
+        {
+            // Through the scene along its diagonal and back, looking ahead
+            const float Travel = 1.0f - std::abs(Progress * 2.0f - 1.0f);
+            const glm::vec3 Start(-Extent, Extent * 0.1f, -Extent);
+            const glm::vec3 End(Extent, Extent * 0.1f, Extent);
+            const glm::vec3 Position = glm::mix(Start, End, Travel);
+            const glm::vec3 Ahead = Progress < 0.5f ? End : Start;
+            Camera.LookAt(Position, Ahead);
+        }
+    }
+
+    Percentiles ComputePercentiles(std::vector<double> Samples)
+    {
+        Percentiles Result;
+        if (Samples.empty())
+            return Result;
+
+        std::sort(Samples.begin(), Samples.end());
+        const auto Rank = [&Samples](double Percentile)
+        {
+            const size_t Index = static_cast<size_t>(std::ceil(Percentile * Samples.size()));
+            return Samples[std::clamp<size_t>(Index, 1, Samples.size()) - 1];
+        };
+        for (double Sample : Samples)
+        {
+            Result.Mean += Sample;
+        }
+        Result.Mean /= static_cast<double>(Samples.size());
+        Result.P50 = Rank(0.50);
+        Result.P90 = Rank(0.90);
+        Result.P95 = Rank(0.95);
+        Result.P99 = Rank(0.99);
+        Result.Max = Samples.back();
+        return Result;
+    }
+
+    void WritePercentiles(std::ofstream& File, const char* Name, const Percentiles& Values, size_t Samples)
+    {
+        File << "  \"" << Name << "\": { \"samples\": " << Samples << ", \"mean\": " << Values.Mean << ", \"p50\": " << Values.P50
+            << ", \"p90\": " << Values.P90 << ", \"p95\": " << Values.P95 << ", \"p99\": " << Values.P99 << ", \"max\": " << Values.Max << " }";
+    }
+
+    // Current and peak heap bytes of every MemoryTracker tag, keyed by the lowercase tag name
+    void WriteCPUMemory(std::ofstream& File)
+    {
+        File << "  \"cpu_memory\": { \"total_bytes\": " << fgl::MemoryTracker::GetTotal();
+        for (size_t Tag = 0; Tag < static_cast<size_t>(fgl::MemoryTag::Count); Tag++)
+        {
+            std::string Name = fgl::MemoryTracker::GetTagName(static_cast<fgl::MemoryTag>(Tag));
+            std::transform(Name.begin(), Name.end(), Name.begin(), [](unsigned char Character) { return static_cast<char>(std::tolower(Character)); });
+            const fgl::MemoryTagStats Stats = fgl::MemoryTracker::GetStats(static_cast<fgl::MemoryTag>(Tag));
+            File << ", \"" << Name << "\": { \"bytes\": " << Stats.CurrentBytes << ", \"peak_bytes\": " << Stats.PeakBytes
+                << ", \"allocations\": " << Stats.TotalAllocations << " }";
+        }
+        File << " }";
+    }
+
+    // Startup totals: when the first frame ended and the decode and upload time of every asset before it
+    void WriteStartup(std::ofstream& File)
+    {
+        const std::vector<fgl::StartupEvent> Events = fgl::StartupTimeline::GetEvents();
+        uint64_t DecodeTime = 0;
+        uint64_t UploadTime = 0;
+        uint64_t BytesRead = 0;
+        for (const fgl::StartupEvent& Event : Events)
+        {
+            DecodeTime += Event.DecodeTime;
+            UploadTime += Event.UploadTime;
+            BytesRead += Event.BytesRead;
+        }
+        File << "  \"startup\": { \"first_frame_ms\": " << fgl::StartupTimeline::GetFirstFrameTime() / 1e6 << ", \"decode_ms\": " << DecodeTime / 1e6
+            << ", \"upload_ms\": " << UploadTime / 1e6 << ", \"asset_count\": " << Events.size() << ", \"bytes_read\": " << BytesRead << " }";
+    }
+
+    // GPU time of a frame from a timestamp pair, read back without waiting on the GPU
+    class GPUFrameTimer
+    {
+    public:
+        static constexpr size_t FrameLatency = 4;
+
+        void Create() { glGenQueries(static_cast<GLsizei>(m_Queries.size()), m_Queries.data()); }
+        void Destroy() { glDeleteQueries(static_cast<GLsizei>(m_Queries.size()), m_Queries.data()); }
+
+        // Starts a frame, left unmeasured if every slot still waits on the GPU
+        void BeginFrame()
+        {
+            m_bTiming = !m_bPending[m_Next];
+            if (m_bTiming)
+            {
+                glQueryCounter(m_Queries[m_Next * 2], GL_TIMESTAMP);
+            }
+        }
+
+        void EndFrame(bool bMeasured)
+        {
+            if (m_bTiming)
+            {
+                glQueryCounter(m_Queries[m_Next * 2 + 1], GL_TIMESTAMP);
+                m_bPending[m_Next] = true;
+                m_bMeasured[m_Next] = bMeasured;
+                m_Next = (m_Next + 1) % FrameLatency;
+            }
+            Read(false);
+        }
+
+        // Reads the finished frames, all of them if bWait
+        void Read(bool bWait)
+        {
+            while (m_bPending[m_Oldest])
+            {
+                GLint bAvailable = GL_FALSE;
+                glGetQueryObjectiv(m_Queries[m_Oldest * 2 + 1], GL_QUERY_RESULT_AVAILABLE, &bAvailable);
+                if (!bAvailable && !bWait)
+                    return;
+
+                GLuint64 Begin = 0;
+                GLuint64 End = 0;
+                glGetQueryObjectui64v(m_Queries[m_Oldest * 2], GL_QUERY_RESULT, &Begin);
+                glGetQueryObjectui64v(m_Queries[m_Oldest * 2 + 1], GL_QUERY_RESULT, &End);
+                if (m_bMeasured[m_Oldest])
+                {
+                    m_Times.push_back(End > Begin ? static_cast<double>(End - Begin) * 1e-6 : 0.0);
+                }
+                m_bPending[m_Oldest] = false;
+                m_Oldest = (m_Oldest + 1) % FrameLatency;
+            }
+        }
+
+        const std::vector<double>& GetTimes() const { return m_Times; }
+
+    private:
+        std::array<GLuint, FrameLatency * 2> m_Queries{};
+        std::array<bool, FrameLatency> m_bPending{};
+        std::array<bool, FrameLatency> m_bMeasured{};
+        size_t m_Next = 0;
+        size_t m_Oldest = 0;
+        bool m_bTiming = false;
+        std::vector<double> m_Times;
+    };
+}
+
+int main(int argc, char** argv)
+{
+    BenchConfig Config;
+    if (!ParseArguments(argc, argv, Config))
+    {
+        std::cerr << "Usage: FireGLBench [--objects=N] [--spheres=0..1] [--materials=M] [--lights=K] [--dynamic=0..1] [--frames=N]\n"
+            "                   [--warmup=N] [--width=W] [--height=H] [--path=orbit|flythrough] [--mode=forward|deferred]\n"
+            "                   [--gpu-culling=0|1] [--particles=N] [--output=file.json] [--startup=file.json]\n"
+            "                   [--baseline-dir=dir] [--save-baseline=name] [--compare=name|file.json] [--diff=file.json]\n"
+            "                   [--threshold=percent] [--min-delta-ms=ms] [--counter-threshold=percent] [--memory-threshold=percent]\n";
+        return 1;
+    }
+
+    fgl::AssetPathManager AssetManager(BENCH_CONTENT_ROOT + std::string("Config.ini"));
+
+    // Hidden window without VSync, nothing waits on the display
+    fgl::BaseWindow MainWindow;
+    MainWindow.Initialize(4, 1, "FireGLBench", fgl::WindowType::Hidden, false, Config.Width, Config.Height);
+    glViewport(0, 0, Config.Width, Config.Height);
+
+    fgl::TimeManager MainTimer;
+    MainTimer.Initialize();
+
+    std::shared_ptr<BenchCamera> Camera = std::make_shared<BenchCamera>();
+    Camera->SetPerspective(45.f, static_cast<float>(Config.Width) / static_cast<float>(Config.Height), 0.1f, 1000);
+
+    // Lights need the clustered shader, the deferred geometry pass writes the G-buffer instead
+    const bool bClustered = Config.Lights > 0 && fgl::ClusteredLightManager::IsSupported() && !Config.bDeferred;
+    const std::string FragmentKey = Config.bDeferred ? "DeferredGeometryFragment" : bClustered ? "ClusteredLightingFragment" : "BaseLightingFragment";
+    fgl::Shader SurfaceShader(AssetManager.GetPath("BaseLightingVertex"), AssetManager.GetPath(FragmentKey));
+    std::unique_ptr<fgl::Shader> DeferredLightingShader;
+    if (Config.bDeferred)
+    {
+        DeferredLightingShader = std::make_unique<fgl::Shader>(AssetManager.GetPath("DeferredLightingVertex"), AssetManager.GetPath("DeferredLightingFragment"));
+    }
+
+    fgl::Texture WoodTexture;
+    WoodTexture.LoadTexture(AssetManager.GetPath("Wood"));
+
+    std::vector<std::shared_ptr<fgl::LightingMaterial>> Materials;
+    for (uint32_t Index = 0; Index < Config.Materials; Index++)
+    {
+        std::shared_ptr<fgl::LightingMaterial> Material = std::make_shared<fgl::LightingMaterial>(&SurfaceShader);
+        Material->SetTexture("diffuse", &WoodTexture);
+        Material->SetShininess(8.0f + 8.0f * static_cast<float>(Index % 8));
+        Materials.push_back(Material);
+    }
+
+    // Objects on a square grid, spheres and dynamic objects spread evenly through it
+    fgl::JobSystem Jobs;
+    fgl::Scene BenchScene(Camera);
+    BenchScene.SetJobSystem(&Jobs);
+
+    constexpr float Spacing = 3.0f;
+    const uint32_t Side = std::max(static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(Config.Objects)))), 1u);
+    const float Extent = static_cast<float>(Side) * Spacing * 0.5f;
+    std::vector<fgl::SceneObject*> DynamicObjects;
+    for (uint32_t Index = 0; Index < Config.Objects; Index++)
+    {
+        std::unique_ptr<fgl::SceneObject> Object;
+        if (Sequence(Index, 0.6180339887f) < Config.SphereRatio)
+        {
+            Object = std::make_unique<fgl::Sphere>();
+        }
+        else
+        {
+            Object = std::make_unique<fgl::Cube>();
+        }
+        Object->SetMaterial(Materials[Index % Materials.size()]);
+        Object->GetTransform().SetPosition(static_cast<float>(Index % Side) * Spacing - Extent, 0.0f,
+            static_cast<float>(Index / Side) * Spacing - Extent);
+        if (Sequence(Index, 0.7548776662f) < Config.DynamicRatio)
+        {
+            DynamicObjects.push_back(Object.get());
+        }
+        BenchScene.AddObject(std::move(Object));
+    }
+
+    fgl::Renderer SceneRenderer(Config.bDeferred ? fgl::RenderingMode::Deferred : fgl::RenderingMode::Default);
+    SceneRenderer.SetJobSystem(&Jobs);
+    SceneRenderer.SetGPUCulling(Config.bGPUCulling);
+    if (DeferredLightingShader)
+    {
+        SceneRenderer.SetDeferredLightingShader(DeferredLightingShader.get());
+    }
+    if (bClustered)
+    {
+        for (uint32_t Index = 0; Index < Config.Lights; Index++)
+        {
+            fgl::ClusteredPointLight Light;
+            Light.PositionRange = glm::vec4((Sequence(Index, 0.5698402910f) * 2.0f - 1.0f) * Extent, 2.0f,
+                (Sequence(Index, 0.3247179572f) * 2.0f - 1.0f) * Extent, Spacing * 4.0f);
+            Light.ColorIntensity = glm::vec4(Sequence(Index, 0.8191725134f), Sequence(Index, 0.6710436067f), Sequence(Index, 0.5497004779f), 1.0f);
+            SceneRenderer.GetClusteredLights().AddLight(Light);
+        }
+    }
+
+    // Spawned as fast as they die, so the system stays at capacity after the first lifetime
+    fgl::ParticleSystem Particles;
+    if (Config.Particles > 0)
+    {
+        fgl::ParticleSettings Settings;
+        Settings.SpawnRadius = Extent * 0.5f;
+        Settings.Velocity = glm::vec3(0.0f, 4.0f, 0.0f);
+        Settings.VelocitySpread = 2.0f;
+        Settings.MinLifetime = 2.0f;
+        Settings.MaxLifetime = 2.0f;
+        Settings.EmissionRate = static_cast<float>(Config.Particles) / Settings.MaxLifetime;
+        Particles.Create(Config.Particles);
+        Particles.SetSettings(Settings);
+        SceneRenderer.AddParticleSystem(&Particles);
+    }
+
+    GPUFrameTimer GPUTimer;
+    GPUTimer.Create();
+    std::vector<double> CPUTimes;
+    CPUTimes.reserve(Config.Frames);
+    fgl::RenderStats StatsTotal;
+
+    const uint32_t TotalFrames = Config.WarmupFrames + Config.Frames;
+    for (uint32_t Frame = 0; Frame < TotalFrames && !MainWindow.ShouldClose(); Frame++)
+    {
+        const bool bMeasured = Frame >= Config.WarmupFrames;
+        const auto FrameStart = std::chrono::steady_clock::now();
+        GPUTimer.BeginFrame();
+
+        // Motion is a function of the frame index, not of the measured time
+        MainTimer.Update();
+        if (Frame == Config.WarmupFrames)
+        {
+            // The TimeManager's window then holds the start-to-start times of the measured frames
+            MainTimer.SetFrameHistorySize(Config.Frames);
+        }
+        PlaceCamera(*Camera, Config, Frame, TotalFrames, Extent);
+        const float Phase = static_cast<float>(Frame) * 0.05f;
+        for (size_t Index = 0; Index < DynamicObjects.size(); Index++)
+        {
+            fgl::Transform& ObjectTransform = DynamicObjects[Index]->GetTransform();
+            const glm::vec3 Position = ObjectTransform.GetPosition();
+            ObjectTransform.SetPosition(Position.x, std::sin(Phase + static_cast<float>(Index)), Position.z);
+            ObjectTransform.SetRotation(glm::vec3(Phase * 40.0f, 0.0f, 0.0f));
+        }
+
+        BenchScene.Process();
+        if (Particles.IsCreated())
+        {
+            Particles.Update(1.0f / 60.0f);
+        }
+        SceneRenderer.Render(&BenchScene);
+
+        GPUTimer.EndFrame(bMeasured);
+        glfwSwapBuffers(MainWindow.GetWindowPtr());
+        glfwPollEvents();
+
+        if (bMeasured)
+        {
+            CPUTimes.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - FrameStart).count());
+            const fgl::RenderStats& Stats = SceneRenderer.GetStats();
+            StatsTotal.DrawCalls += Stats.DrawCalls;
+            StatsTotal.Triangles += Stats.Triangles;
+            StatsTotal.ProgramBinds += Stats.ProgramBinds;
+            StatsTotal.TextureBinds += Stats.TextureBinds;
+            StatsTotal.BytesUploaded += Stats.BytesUploaded;
+        }
+    }
+    GPUTimer.Read(true);
+    GPUTimer.Destroy();
+
+    const Percentiles CPU = ComputePercentiles(CPUTimes);
+    const Percentiles GPU = ComputePercentiles(GPUTimer.GetTimes());
+    const fgl::FrameTimeStats FrameStats = MainTimer.GetFrameStats();
+    const double FrameCount = static_cast<double>(std::max<size_t>(CPUTimes.size(), 1));
+
+    std::ofstream File(Config.Output);
+    File << std::fixed << std::setprecision(4);
+    File << "{\n";
+    File << "  \"renderer\": \"" << reinterpret_cast<const char*>(glGetString(GL_RENDERER)) << "\",\n";
+    File << "  \"config\": { \"objects\": " << Config.Objects << ", \"spheres\": " << Config.SphereRatio << ", \"materials\": " << Config.Materials
+        << ", \"lights\": " << (bClustered ? Config.Lights : 0) << ", \"dynamic\": " << Config.DynamicRatio << ", \"frames\": " << Config.Frames
+        << ", \"warmup\": " << Config.WarmupFrames << ", \"width\": " << Config.Width << ", \"height\": " << Config.Height
+        << ", \"path\": \"" << Config.Path << "\", \"mode\": \"" << (Config.bDeferred ? "deferred" : "forward")
+        << "\", \"gpu_culling\": " << (Config.bGPUCulling ? "true" : "false") << ", \"particles\": " << Config.Particles << " },\n";
+    WritePercentiles(File, "cpu_ms", CPU, CPUTimes.size());
+    File << ",\n";
+    WritePercentiles(File, "gpu_ms", GPU, GPUTimer.GetTimes().size());
+    File << ",\n";
+    File << "  \"frame_ms\": { \"samples\": " << FrameStats.Samples << ", \"mean\": " << FrameStats.Mean << ", \"p50\": " << FrameStats.P50
+        << ", \"p95\": " << FrameStats.P95 << ", \"p99\": " << FrameStats.P99 << ", \"max\": " << FrameStats.Max
+        << ", \"hitches\": " << FrameStats.Hitches << " },\n";
+    File << "  \"per_frame\": { \"draw_calls\": " << StatsTotal.DrawCalls / FrameCount << ", \"triangles\": " << StatsTotal.Triangles / FrameCount
+        << ", \"program_binds\": " << StatsTotal.ProgramBinds / FrameCount << ", \"texture_binds\": " << StatsTotal.TextureBinds / FrameCount
+        << ", \"bytes_uploaded\": " << StatsTotal.BytesUploaded / FrameCount << " },\n";
+    File << "  \"gpu_memory_bytes\": " << fgl::GPUMemoryTracker::GetTotal() << ",\n";
+    WriteCPUMemory(File);
+    File << ",\n";
+    WriteStartup(File);
+    File << "\n";
+    File << "}\n";
+    File.close();
+
+    if (!Config.StartupOutput.empty() && !fgl::StartupTimeline::WriteJSON(Config.StartupOutput))
+    {
+        std::cerr << "Failed to write the startup timeline to " << Config.StartupOutput << '\n';
+    }
+
+    std::cout << "CPU p50 " << CPU.P50 << " ms, p99 " << CPU.P99 << " ms | GPU p50 " << GPU.P50 << " ms, p99 " << GPU.P99
+        << " ms | CPU memory " << fgl::MemoryTracker::GetTotal() / (1024 * 1024) << " MiB | written to " << Config.Output << '\n';
+
+    MainWindow.Terminate();
+    if (!File)
+        return 1;
+
+    const bool bBaseline = !Config.SaveBaseline.empty() || !Config.CompareBaseline.empty();
+    bench::ResultFile Current;
+    if (bBaseline && !bench::ReadResult(Config.Output, Current))
+    {
+        std::cerr << "Failed to read back " << Config.Output << '\n';
+        return 1;
+    }
+    const std::string Scene = bench::GetSceneKey(Current);
+
+    int ExitCode = 0;
+    if (!Config.CompareBaseline.empty())
+    {
+        const std::string BaselinePath = bench::GetBaselinePath(Config.BaselineDirectory, Config.CompareBaseline, Scene);
+        bench::ResultFile Baseline;
+        if (!bench::ReadResult(BaselinePath, Baseline))
+        {
+            std::cerr << "No baseline of " << Scene << " at " << BaselinePath << '\n';
+            return 1;
+        }
+
+        const bench::Comparison Comparison = bench::Compare(Baseline, Current, Config.Thresholds);
+        const std::string DiffOutput = Config.DiffOutput.empty()
+            ? std::filesystem::path(Config.Output).replace_extension(".diff.json").string() : Config.DiffOutput;
+        if (!bench::WriteComparison(DiffOutput, BaselinePath, Comparison))
+        {
+            std::cerr << "Failed to write the comparison to " << DiffOutput << '\n';
+        }
+        ExitCode = Comparison.Regressions > 0 ? 2 : 0;
+    }
+
+    // Saved after comparing, so a run can be checked against the previous baseline and replace it
+    if (!Config.SaveBaseline.empty())
+    {
+        const std::string BaselinePath = bench::GetBaselinePath(Config.BaselineDirectory, Config.SaveBaseline, Scene);
+        if (!bench::SaveBaseline(Config.Output, BaselinePath))
+        {
+            std::cerr << "Failed to save the baseline to " << BaselinePath << '\n';
+            return 1;
+        }
+        std::cout << "Baseline of " << Scene << " saved to " << BaselinePath << '\n';
+    }
+    return ExitCode;
+}
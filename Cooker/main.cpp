@@ -0,0 +1,109 @@
+#include <FireGL/FireGL.h>
+
+// Offline asset cooker: cooks every asset listed in a config file into an output directory laid out the same way,
+// with a rewritten config file, and optionally packs the output into an asset archive.
+//
+//     FireGLCook --config=Example/Config.ini --output=Cooked --archive=Cooked.fglpak --lods=3 --optimize=1
+
+namespace
+{
+    struct CookConfig
+    {
+        std::string ConfigPath;         // Config file of the assets to cook
+        std::string Output = "Cooked";  // Output directory
+        std::string Archive;            // Archive packed from the output, none when empty
+        fgl::AssetArchive::Compression Compression = fgl::AssetArchive::Compression::None;
+        uint32_t LODCount = 1;          // Levels of detail per mesh
+        bool bOptimize = false;         // Vertex cache, overdraw and vertex fetch optimizations
+        bool bCompressTextures = true;  // BCn KTX2 textures instead of copies
+        uint32_t Threads = 0;           // Worker threads, one per hardware thread if 0
+        std::vector<std::string> RawKeys;
+    };
+
+    std::vector<std::string> SplitList(const std::string& Value)
+    {
+        std::vector<std::string> Items;
+        std::stringstream Stream(Value);
+        for (std::string Item; std::getline(Stream, Item, ',');)
+        {
+            if (!Item.empty())
+            {
+                Items.push_back(Item);
+            }
+        }
+        return Items;
+    }
+
+    bool ParseArguments(int argc, char** argv, CookConfig& Config)
+    {
+        for (int Index = 1; Index < argc; Index++)
+        {
+            const std::string_view Argument = argv[Index];
+            const size_t Separator = Argument.find('=');
+            if (Argument.substr(0, 2) != "--" || Separator == std::string_view::npos)
+            {
+                std::cerr << "Expected --name=value, got " << Argument << '\n';
+                return false;
+            }
+
+            const std::string_view Name = Argument.substr(2, Separator - 2);
+            const std::string Value(Argument.substr(Separator + 1));
+            if (Name == "config") Config.ConfigPath = Value;
+            else if (Name == "output") Config.Output = Value;
+            else if (Name == "archive") Config.Archive = Value;
+            else if (Name == "compression")
+            {
+                if (Value == "none") Config.Compression = fgl::AssetArchive::Compression::None;
+                else if (Value == "lz4") Config.Compression = fgl::AssetArchive::Compression::LZ4;
+                else if (Value == "zstd") Config.Compression = fgl::AssetArchive::Compression::Zstd;
+                else return false;
+            }
+            else if (Name == "lods") Config.LODCount = std::max(static_cast<uint32_t>(std::stoul(Value)), 1u);
+            else if (Name == "optimize") Config.bOptimize = Value == "1" || Value == "on";
+            else if (Name == "compress-textures") Config.bCompressTextures = Value == "1" || Value == "on";
+            else if (Name == "threads") Config.Threads = static_cast<uint32_t>(std::stoul(Value));
+            else if (Name == "raw") Config.RawKeys = SplitList(Value);
+            else
+            {
+                std::cerr << "Unknown option --" << Name << '\n';
+                return false;
+            }
+        }
+        return !Config.ConfigPath.empty();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    CookConfig Config;
+    if (!ParseArguments(argc, argv, Config))
+    {
+        std::cerr << "Usage: FireGLCook --config=Config.ini [--output=dir] [--archive=file] [--compression=none|lz4|zstd] [--lods=N]\n"
+            "                  [--optimize=0|1] [--compress-textures=0|1] [--threads=N] [--raw=Key1,Key2]\n";
+        return 1;
+    }
+
+    try
+    {
+        fgl::AssetPathManager AssetManager(Config.ConfigPath);
+        fgl::JobSystem Jobs(Config.Threads);
+
+        fgl::AssetCookSettings Settings;
+        Settings.OutputDirectory = Config.Output;
+        Settings.Import.LODCount = Config.LODCount;
+        Settings.Import.bOptimizeVertexCache = Config.bOptimize;
+        Settings.Import.bOptimizeOverdraw = Config.bOptimize;
+        Settings.Import.bOptimizeVertexFetch = Config.bOptimize;
+        Settings.bCompressTextures = Config.bCompressTextures;
+        Settings.RawKeys = Config.RawKeys;
+        Settings.ArchivePath = Config.Archive;
+        Settings.ArchiveCompression = Config.Compression;
+        Settings.Jobs = &Jobs;
+        return fgl::AssetCooker::Cook(Config.ConfigPath, AssetManager, Settings) ? 0 : 2;
+    }
+    catch (const std::exception& Exception)
+    {
+        std::cerr << Exception.what() << '\n';
+        return 2;
+    }
+}
@@ -4,66 +4,127 @@ out vec4 FragColor;
 struct Material {
     sampler2D diffuse;
     sampler2D specular;
-    float shininess;
 }; 
 
+// std140 mirrors of the structs in LightUniformBuffer.h, the w components are unused
 struct DirLight {
-    vec3 direction;
-	
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
+    vec4 direction;
+    vec4 ambient;
+    vec4 diffuse;
+    vec4 specular;
 };
 
 struct PointLight {
-    vec3 position;
-    
-    float constant;
-    float linear;
-    float quadratic;
-	
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
+    vec4 position;
+    vec4 ambient;
+    vec4 diffuse;
+    vec4 specular;
+    vec4 attenuation;     // constant, linear, quadratic
 };
 
 struct SpotLight {
-    vec3 position;
-    vec3 direction;
-    float cutOff;
-    float outerCutOff;
-  
-    float constant;
-    float linear;
-    float quadratic;
-  
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;       
+    vec4 position;
+    vec4 direction;
+    vec4 ambient;
+    vec4 diffuse;
+    vec4 specular;
+    vec4 attenuation;     // constant, linear, quadratic
+    vec4 cutOff;          // cosines of the inner and outer cone angles
 };
 
-#define NR_POINT_LIGHTS 4
+#define NR_POINT_LIGHTS 16     // LightData::MaxPointLights
 
 in vec3 FragPos;
 in vec3 Normal;
 in vec2 TexCoords;
+#ifdef LIGHTMAP
+in vec2 LightmapCoords;
+#endif
+#ifdef REFLECTION_PROBES
+flat in uint ReflectionProbe;     // index of the object's probe plus 1, 0 if none
+#endif
+#ifdef OBJECT_LIGHTS
+flat in uint ObjectLights;        // point lights picked for the object plus 1, one byte each, see ObjectLightAssigner.h
+#endif
+
+layout (std140) uniform CameraData
+{
+    mat4 View;
+    mat4 Projection;
+    mat4 ViewProjection;
+    vec4 Position;
+} Camera;
+
+layout (std140) uniform LightData
+{
+    DirLight dirLight;
+    PointLight pointLights[NR_POINT_LIGHTS];
+    SpotLight spotLight;
+    ivec4 counts;         // point lights used, spot light enabled
+} Lights;
+
+layout (std140) uniform MaterialParameters
+{
+    float shininess;
+} Parameters;
+
+// cascades of the directional light, see CascadedShadowMaps.h
+layout (std140) uniform ShadowData
+{
+    mat4 LightViewProjection[4];
+    vec4 SplitDepths;     // view depth where each cascade ends
+    vec4 TexelSizes;      // world-space size of a texel in each cascade
+    vec4 Params;          // cascade count (0 when off), depth bias, normal bias in texels, 1 / resolution
+} Shadows;
+
+// shadows of the point lights and the spot light, see LocalShadowAtlas.h
+struct LocalShadow {
+    mat4 viewProjection[6];   // world to light clip space of each face: +X, -X, +Y, -Y, +Z, -Z; the spot light uses the first
+    vec4 tiles[6];            // atlas rectangle of each face: offset, size
+    vec4 params;              // face count (0 when unshadowed), depth bias, normal bias in texels, 2 * tan(half field of view)
+};
+
+layout (std140) uniform LocalShadowData
+{
+    LocalShadow pointShadows[NR_POINT_LIGHTS];
+    LocalShadow spotShadow;
+    vec4 params;          // 1 / atlas size
+} LocalShadows;
 
-uniform vec3 viewPos;
-uniform DirLight dirLight;
-uniform PointLight pointLights[NR_POINT_LIGHTS];
-uniform SpotLight spotLight;
 uniform Material material;
+uniform sampler2DArrayShadow ShadowMap;
+uniform sampler2DShadow LocalShadowMap;
+uniform sampler2D AmbientOcclusionMap;
+// fog between the camera and the fragment, see VolumetricFog.h
+layout (std140) uniform VolumetricFogData
+{
+    vec4 DepthParams;     // volume depth of a view depth: log(depth) * x + y
+    vec4 ScreenParams;    // viewport offset, 1 / viewport size
+} Fog;
+uniform sampler3D VolumetricFogMap;
+#ifdef LIGHTMAP
+uniform sampler2D LightmapAtlas;      // baked directional and point lights, see Lightmap.h
+#endif
+#ifdef REFLECTION_PROBES
+#define REFLECTION_PROBE_LEVELS 5     // ReflectionProbes::PrefilteredLevels
+uniform samplerCubeArray ReflectionProbeMaps;
+vec3 CalcProbeReflection(vec3 normal, vec3 viewDir);
+#endif
 
 // function prototypes
+float CalcAmbientOcclusion();
+vec3 ApplyVolumetricFog(vec3 color, float viewDepth);
 vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir);
-vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
+float CalcDirShadow(vec3 normal);
+float CalcLocalShadow(int slot, vec3 lightPos, vec3 normal, vec3 fragPos);
+vec3 CalcPointLight(PointLight light, int slot, vec3 normal, vec3 fragPos, vec3 viewDir);
 vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
 
 void main()
 {    
     // properties
     vec3 norm = normalize(Normal);
-    vec3 viewDir = normalize(viewPos - FragPos);
+    vec3 viewDir = normalize(Camera.Position.xyz - FragPos);
     
     // == =====================================================
     // Our lighting is set up in 3 phases: directional, point lights and an optional flashlight
@@ -71,77 +132,204 @@ void main()
     // per lamp. In the main() function we take all the calculated colors and sum them up for
     // this fragment's final color.
     // == =====================================================
+#ifdef LIGHTMAP
+    // phases 1 and 2 were baked: one fetch of the light reaching this texel, times the albedo
+    vec3 result = texture(LightmapAtlas, LightmapCoords).rgb * vec3(texture(material.diffuse, TexCoords));
+#else
     // phase 1: directional lighting
-    vec3 result = CalcDirLight(dirLight, norm, viewDir);
-    // phase 2: point lights
-    for(int i = 0; i < NR_POINT_LIGHTS; i++)
-        result += CalcPointLight(pointLights[i], norm, FragPos, viewDir);    
-    // phase 3: spot light
-    result += CalcSpotLight(spotLight, norm, FragPos, viewDir);    
+    vec3 result = CalcDirLight(Lights.dirLight, norm, viewDir);
+    // phase 2: point lights, only the strongest few reaching the object in the OBJECT_LIGHTS variant
+#ifdef OBJECT_LIGHTS
+    for(uint i = 0u; i < 4u; i++)
+    {
+        uint light = (ObjectLights >> (8u * i)) & 0xFFu;
+        if (light == 0u)
+            break;
+        result += CalcPointLight(Lights.pointLights[light - 1u], int(light - 1u), norm, FragPos, viewDir);
+    }
+#else
+    for(int i = 0; i < min(Lights.counts.x, NR_POINT_LIGHTS); i++)
+        result += CalcPointLight(Lights.pointLights[i], i, norm, FragPos, viewDir);    
+#endif
+#endif
+    // phase 3: spot light, compiled out of the NO_SPOT_LIGHT variant
+#ifndef NO_SPOT_LIGHT
+    if (Lights.counts.y != 0)
+        result += CalcSpotLight(Lights.spotLight, norm, FragPos, viewDir);    
+#endif
+    // phase 4: local reflections, compiled into the REFLECTION_PROBES variant
+#ifdef REFLECTION_PROBES
+    if (ReflectionProbe != 0u)
+        result += CalcProbeReflection(norm, viewDir);
+#endif
     
-    FragColor = vec4(result, 1.0);
+    FragColor = vec4(ApplyVolumetricFog(result, -(Camera.View * vec4(FragPos, 1.0)).z), 1.0);
 }
 
 // calculates the color when using a directional light.
 vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir)
 {
-    vec3 lightDir = normalize(-light.direction);
+    vec3 lightDir = normalize(-light.direction.xyz);
     // diffuse shading
     float diff = max(dot(normal, lightDir), 0.0);
-    // specular shading
+    // specular shading, compiled out of the NO_SPECULAR variant
+#ifndef NO_SPECULAR
     vec3 reflectDir = reflect(-lightDir, normal);
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
-    // combine results
-    vec3 ambient = light.ambient * vec3(texture(material.diffuse, TexCoords));
-    vec3 diffuse = light.diffuse * diff * vec3(texture(material.diffuse, TexCoords));
-    vec3 specular = light.specular * spec * vec3(texture(material.specular, TexCoords));
-    return (ambient + diffuse + specular);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), Parameters.shininess);
+#else
+    float spec = 0.0;
+#endif
+    // combine results, the shadow only takes away direct light
+    vec3 ambient = light.ambient.rgb * vec3(texture(material.diffuse, TexCoords)) * CalcAmbientOcclusion();
+    vec3 diffuse = light.diffuse.rgb * diff * vec3(texture(material.diffuse, TexCoords));
+#ifndef NO_SPECULAR
+    vec3 specular = light.specular.rgb * spec * vec3(texture(material.specular, TexCoords));
+#else
+    vec3 specular = vec3(0.0);
+#endif
+    return (ambient + (diffuse + specular) * CalcDirShadow(normal));
+}
+
+// calculates how lit the fragment is by the directional light, 1 outside the cascades.
+float CalcDirShadow(vec3 normal)
+{
+    int count = int(Shadows.Params.x);
+    float viewDepth = -(Camera.View * vec4(FragPos, 1.0)).z;
+    int cascade = 0;
+    while (cascade < count && viewDepth > Shadows.SplitDepths[cascade])
+        cascade++;
+    if (cascade >= count)
+        return 1.0;
+    // the normal offset keeps surfaces from shadowing themselves at grazing angles
+    vec3 offsetPos = FragPos + normal * Shadows.Params.z * Shadows.TexelSizes[cascade];
+    vec3 shadowPos = (Shadows.LightViewProjection[cascade] * vec4(offsetPos, 1.0)).xyz;
+    shadowPos.xy = shadowPos.xy * 0.5 + 0.5;
+    // 3x3 taps, each filtered 2x2 by the comparison sampler
+    float lit = 0.0;
+    for (int x = -1; x <= 1; x++)
+        for (int y = -1; y <= 1; y++)
+            lit += texture(ShadowMap, vec4(shadowPos.xy + vec2(x, y) * Shadows.Params.w, float(cascade), shadowPos.z - Shadows.Params.y));
+    return lit / 9.0;
+}
+
+// calculates how lit the fragment is by a point light (slot = its index) or the spot light (slot = NR_POINT_LIGHTS), 1 without its shadow.
+float CalcLocalShadow(int slot, vec3 lightPos, vec3 normal, vec3 fragPos)
+{
+    vec4 params = slot < NR_POINT_LIGHTS ? LocalShadows.pointShadows[slot].params : LocalShadows.spotShadow.params;
+    if (params.x == 0.0)
+        return 1.0;
+    // a point light sees the fragment through the face of the major axis of their direction
+    vec3 toFrag = fragPos - lightPos;
+    vec3 axis = abs(toFrag);
+    int face = 0;
+    if (params.x > 1.0)
+        face = axis.x >= axis.y && axis.x >= axis.z ? (toFrag.x >= 0.0 ? 0 : 1) : (axis.y >= axis.z ? (toFrag.y >= 0.0 ? 2 : 3) : (toFrag.z >= 0.0 ? 4 : 5));
+    mat4 viewProjection = slot < NR_POINT_LIGHTS ? LocalShadows.pointShadows[slot].viewProjection[face] : LocalShadows.spotShadow.viewProjection[0];
+    vec4 tile = slot < NR_POINT_LIGHTS ? LocalShadows.pointShadows[slot].tiles[face] : LocalShadows.spotShadow.tiles[0];
+    // the normal offset grows with the distance, like the texels of a perspective view
+    float texelSize = LocalShadows.params.x;
+    float worldTexel = params.w * length(toFrag) * texelSize / tile.z;
+    vec4 clipPos = viewProjection * vec4(fragPos + normal * params.z * worldTexel, 1.0);
+    if (clipPos.w <= 0.0)
+        return 1.0;
+    vec3 shadowPos = clipPos.xyz / clipPos.w;
+    vec2 uv = tile.xy + clamp(shadowPos.xy * 0.5 + 0.5, 0.0, 1.0) * tile.zw;
+    // 3x3 taps, each filtered 2x2 by the comparison sampler, kept inside the tile
+    vec2 low = tile.xy + 0.5 * texelSize;
+    vec2 high = tile.xy + tile.zw - 0.5 * texelSize;
+    float lit = 0.0;
+    for (int x = -1; x <= 1; x++)
+        for (int y = -1; y <= 1; y++)
+            lit += texture(LocalShadowMap, vec3(clamp(uv + vec2(x, y) * texelSize, low, high), shadowPos.z - params.y));
+    return lit / 9.0;
 }
 
 // calculates the color when using a point light.
-vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
+vec3 CalcPointLight(PointLight light, int slot, vec3 normal, vec3 fragPos, vec3 viewDir)
 {
-    vec3 lightDir = normalize(light.position - fragPos);
+    vec3 lightDir = normalize(light.position.xyz - fragPos);
     // diffuse shading
     float diff = max(dot(normal, lightDir), 0.0);
-    // specular shading
+    // specular shading, compiled out of the NO_SPECULAR variant
+#ifndef NO_SPECULAR
     vec3 reflectDir = reflect(-lightDir, normal);
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), Parameters.shininess);
+#else
+    float spec = 0.0;
+#endif
     // attenuation
-    float distance = length(light.position - fragPos);
-    float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));    
+    float distance = length(light.position.xyz - fragPos);
+    float attenuation = 1.0 / (light.attenuation.x + light.attenuation.y * distance + light.attenuation.z * (distance * distance));    
     // combine results
-    vec3 ambient = light.ambient * vec3(texture(material.diffuse, TexCoords));
-    vec3 diffuse = light.diffuse * diff * vec3(texture(material.diffuse, TexCoords));
-    vec3 specular = light.specular * spec * vec3(texture(material.specular, TexCoords));
+    vec3 ambient = light.ambient.rgb * vec3(texture(material.diffuse, TexCoords)) * CalcAmbientOcclusion();
+    vec3 diffuse = light.diffuse.rgb * diff * vec3(texture(material.diffuse, TexCoords));
+#ifndef NO_SPECULAR
+    vec3 specular = light.specular.rgb * spec * vec3(texture(material.specular, TexCoords));
+#else
+    vec3 specular = vec3(0.0);
+#endif
     ambient *= attenuation;
     diffuse *= attenuation;
     specular *= attenuation;
-    return (ambient + diffuse + specular);
+    return (ambient + (diffuse + specular) * CalcLocalShadow(slot, light.position.xyz, normal, fragPos));
 }
 
 // calculates the color when using a spot light.
 vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
 {
-    vec3 lightDir = normalize(light.position - fragPos);
+    vec3 lightDir = normalize(light.position.xyz - fragPos);
     // diffuse shading
     float diff = max(dot(normal, lightDir), 0.0);
-    // specular shading
+    // specular shading, compiled out of the NO_SPECULAR variant
+#ifndef NO_SPECULAR
     vec3 reflectDir = reflect(-lightDir, normal);
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), Parameters.shininess);
+#else
+    float spec = 0.0;
+#endif
     // attenuation
-    float distance = length(light.position - fragPos);
-    float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));    
+    float distance = length(light.position.xyz - fragPos);
+    float attenuation = 1.0 / (light.attenuation.x + light.attenuation.y * distance + light.attenuation.z * (distance * distance));    
     // spotlight intensity
-    float theta = dot(lightDir, normalize(-light.direction)); 
-    float epsilon = light.cutOff - light.outerCutOff;
-    float intensity = clamp((theta - light.outerCutOff) / epsilon, 0.0, 1.0);
+    float theta = dot(lightDir, normalize(-light.direction.xyz)); 
+    float epsilon = light.cutOff.x - light.cutOff.y;
+    float intensity = clamp((theta - light.cutOff.y) / epsilon, 0.0, 1.0);
     // combine results
-    vec3 ambient = light.ambient * vec3(texture(material.diffuse, TexCoords));
-    vec3 diffuse = light.diffuse * diff * vec3(texture(material.diffuse, TexCoords));
-    vec3 specular = light.specular * spec * vec3(texture(material.specular, TexCoords));
+    vec3 ambient = light.ambient.rgb * vec3(texture(material.diffuse, TexCoords)) * CalcAmbientOcclusion();
+    vec3 diffuse = light.diffuse.rgb * diff * vec3(texture(material.diffuse, TexCoords));
+#ifndef NO_SPECULAR
+    vec3 specular = light.specular.rgb * spec * vec3(texture(material.specular, TexCoords));
+#else
+    vec3 specular = vec3(0.0);
+#endif
     ambient *= attenuation * intensity;
     diffuse *= attenuation * intensity;
     specular *= attenuation * intensity;
-    return (ambient + diffuse + specular);
-}
\ No newline at end of file
+    return (ambient + (diffuse + specular) * CalcLocalShadow(NR_POINT_LIGHTS, light.position.xyz, normal, fragPos));
+}
+
+// occlusion of the ambient light at this pixel, see AmbientOcclusion.h; white while it is off
+float CalcAmbientOcclusion()
+{
+    return texture(AmbientOcclusionMap, gl_FragCoord.xy / vec2(textureSize(AmbientOcclusionMap, 0))).r;
+}
+
+// fogs a shaded color: the light scattered in front of the fragment plus what reaches the camera; unchanged while the fog is off
+vec3 ApplyVolumetricFog(vec3 color, float viewDepth)
+{
+    vec3 uvw = vec3((gl_FragCoord.xy - Fog.ScreenParams.xy) * Fog.ScreenParams.zw, log(max(viewDepth, 1e-4)) * Fog.DepthParams.x + Fog.DepthParams.y);
+    vec4 fog = texture(VolumetricFogMap, uvw);
+    return color * fog.a + fog.rgb;
+}
+
+#ifdef REFLECTION_PROBES
+// reflection of the surroundings from the object's probe, blurrier as the highlight gets wider; see ReflectionProbes.h
+vec3 CalcProbeReflection(vec3 normal, vec3 viewDir)
+{
+    vec3 reflectDir = reflect(-viewDir, normal);
+    float roughness = sqrt(2.0 / (Parameters.shininess + 2.0));
+    float lod = roughness * float(REFLECTION_PROBE_LEVELS - 1);
+    vec3 reflection = textureLod(ReflectionProbeMaps, vec4(reflectDir, float(ReflectionProbe - 1u)), lod).rgb;
+    return reflection * vec3(texture(material.specular, TexCoords));
+}
+#endif
\ No newline at end of file
@@ -1,19 +1,173 @@
 #version 410 core     // Ensure this matches the OpenGL version configuration when initializing the window class.
+#ifdef VERTEX_PULLING
+// OpenGL 4.3+ with gl_BaseInstanceARB, see GeometryArena::SupportsVertexPulling()
+#extension GL_ARB_shader_storage_buffer_object : require
+#extension GL_ARB_shader_draw_parameters : require
+#extension GL_ARB_shading_language_420pack : require
+#extension GL_ARB_shading_language_packing : require
+#endif
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoords;
-layout (location = 3) in mat4 MVPMatrix;
-layout (location = 7) in mat4 ModelMatrix;
+layout (location = 3) in mat4 ModelMatrix;
+layout (location = 7) in mat3x4 NormalMatrix;     // packed procedural animation in the w of the columns
+#ifdef LIGHTMAP
+// second UV set of VertexFormat::Lightmapped, and the object's atlas region set by Lightmap::Bake()
+layout (location = 13) in vec2 aLightmapCoords;
+layout (location = 15) in vec4 LightmapRegion;    // scale in xy, offset in zw
+#endif
+#if defined(REFLECTION_PROBES) || defined(OBJECT_LIGHTS)
+layout (location = 12) in uvec3 InstanceIndices;  // first bone, reflection probe plus 1, point lights plus 1
+#endif
+
+layout (std140) uniform CameraData
+{
+    mat4 View;
+    mat4 Projection;
+    mat4 ViewProjection;
+    vec4 Position;
+    mat4 InverseViewProjection;
+    vec4 Time;
+} Camera;
+
+// Same decoding as fgl::ProceduralAnimation::Pack(), the packed words are all 0 for objects that aren't animated
+float UnpackHalf(uint Bits)
+{
+    float Mantissa = float(Bits & 0x3FFu);
+    uint Exponent = (Bits >> 10u) & 0x1Fu;
+    float Value = Exponent == 0u ? Mantissa * exp2(-24.0) : (1024.0 + Mantissa) * exp2(float(Exponent) - 25.0);
+    return (Bits & 0x8000u) != 0u ? -Value : Value;
+}
+
+// Spin and sway around the octahedral axis as a rotation, the bob along it as an offset
+mat3 ProceduralRotation(uvec3 Packed, float Time, out vec3 Offset)
+{
+    vec2 Octahedral = vec2(Packed.x & 0xFFu, (Packed.x >> 8u) & 0xFFu) / 127.5 - 1.0;
+    vec3 Axis = vec3(Octahedral, 1.0 - abs(Octahedral.x) - abs(Octahedral.y));
+    if (Axis.z < 0.0)
+        Axis.xy = (1.0 - abs(Axis.yx)) * mix(vec2(-1.0), vec2(1.0), greaterThanEqual(Axis.xy, vec2(0.0)));
+    Axis = normalize(Axis);
+    float Wave = sin(6.2831853 * UnpackHalf(Packed.z >> 16u) * Time + UnpackHalf(Packed.z & 0xFFFFu));
+    float Angle = UnpackHalf(Packed.x >> 16u) * Time + UnpackHalf(Packed.y & 0xFFFFu) * Wave;
+    Offset = Axis * (UnpackHalf(Packed.y >> 16u) * Wave);
+    float Cosine = cos(Angle);
+    return mat3(Cosine) + sin(Angle) * mat3(0.0, Axis.z, -Axis.y, -Axis.z, 0.0, Axis.x, Axis.y, -Axis.x, 0.0) + (1.0 - Cosine) * outerProduct(Axis, Axis);
+}
 
 out vec3 FragPos;
 out vec3 Normal;
 out vec2 TexCoords;
+#ifdef LIGHTMAP
+out vec2 LightmapCoords;
+#endif
+#ifdef REFLECTION_PROBES
+flat out uint ReflectionProbe;
+#endif
+#ifdef OBJECT_LIGHTS
+flat out uint ObjectLights;
+#endif
+
+#ifdef VERTEX_PULLING
+// Vertex buffer of each VertexFormat and the instances, bound by GeometryArena::BindPulledBuffers()
+layout (std430, binding = 15) buffer StandardVertices { uint StandardWords[]; };       // 8 words per vertex
+layout (std430, binding = 16) buffer PackedVertices { uint PackedWords[]; };           // 4 words per vertex
+layout (std430, binding = 17) buffer SkinnedVertices { uint SkinnedWords[]; };         // 11 words per vertex
+layout (std430, binding = 18) buffer LightmappedVertices { uint LightmappedWords[]; }; // 10 words per vertex
+struct PulledInstance { mat4 Model; vec4 NormalColumns[3]; uvec4 TextureLayers; uvec4 Indices; vec4 Payload; };
+layout (std430, binding = 19) buffer PulledInstances { PulledInstance Instances[]; };
+
+// What the attributes hold in draws through the format VAOs
+struct PulledVertex { vec3 Position; vec3 Normal; vec2 TexCoords; vec2 LightmapCoords; };
+
+PulledVertex PullVertex(uint Format, uint Index)
+{
+    PulledVertex Result;
+    Result.LightmapCoords = vec2(0.0);
+    uint Words[8];
+    if (Format == 2u)
+    {
+        // fgl::PackedVertex: half-float position and UVs, signed normalized 10:10:10:2 normal
+        uint Base = Index * 4u;
+        uint NormalBits = PackedWords[Base + 2u];
+        Result.Position = vec3(unpackHalf2x16(PackedWords[Base]), unpackHalf2x16(PackedWords[Base + 1u]).x);
+        Result.Normal = max(vec3(bitfieldExtract(int(NormalBits), 0, 10), bitfieldExtract(int(NormalBits), 10, 10), bitfieldExtract(int(NormalBits), 20, 10)) / 511.0, -1.0);
+        Result.TexCoords = unpackHalf2x16(PackedWords[Base + 3u]);
+        return Result;
+    }
+    // The float formats all start like fgl::Vertex: position, normal and UVs
+    for (uint Word = 0u; Word < 8u; Word++)
+    {
+        Words[Word] = Format == 3u ? SkinnedWords[Index * 11u + Word] : Format == 4u ? LightmappedWords[Index * 10u + Word] : StandardWords[Index * 8u + Word];
+    }
+    Result.Position = uintBitsToFloat(uvec3(Words[0], Words[1], Words[2]));
+    Result.Normal = uintBitsToFloat(uvec3(Words[3], Words[4], Words[5]));
+    Result.TexCoords = uintBitsToFloat(uvec2(Words[6], Words[7]));
+    if (Format == 4u)
+    {
+        Result.LightmapCoords = uintBitsToFloat(uvec2(LightmappedWords[Index * 10u + 8u], LightmappedWords[Index * 10u + 9u]));
+    }
+    return Result;
+}
+#endif
 
 void main()
 {
-    FragPos = vec3(ModelMatrix * vec4(aPos, 1.0));
-    Normal = mat3(transpose(inverse(ModelMatrix))) * aNormal;
-    TexCoords = aTexCoords;
+    vec3 Position = aPos;
+    vec3 VertexNormal = aNormal;
+    vec2 VertexTexCoords = aTexCoords;
+    mat4 Model = ModelMatrix;
+    mat3 Normals = mat3(NormalMatrix);
+    uvec3 Animation = floatBitsToUint(vec3(NormalMatrix[0].w, NormalMatrix[1].w, NormalMatrix[2].w));
+#ifdef LIGHTMAP
+    vec2 VertexLightmapCoords = aLightmapCoords;
+    vec4 Region = LightmapRegion;
+#endif
+#if defined(REFLECTION_PROBES) || defined(OBJECT_LIGHTS)
+    uvec3 Indices = InstanceIndices;
+#endif
+#ifdef VERTEX_PULLING
+    // Format plus 1 in the top bits of pulled draws, 0 for draws through the format VAOs
+    uint Format = uint(gl_VertexID) >> 28u;
+    if (Format != 0u)
+    {
+        PulledVertex Pulled = PullVertex(Format, uint(gl_VertexID) & 0x0FFFFFFFu);
+        PulledInstance Instance = Instances[gl_BaseInstanceARB + gl_InstanceID];
+        Position = Pulled.Position;
+        VertexNormal = Pulled.Normal;
+        VertexTexCoords = Pulled.TexCoords;
+        Model = Instance.Model;
+        Normals = mat3(Instance.NormalColumns[0].xyz, Instance.NormalColumns[1].xyz, Instance.NormalColumns[2].xyz);
+        Animation = floatBitsToUint(vec3(Instance.NormalColumns[0].w, Instance.NormalColumns[1].w, Instance.NormalColumns[2].w));
+#ifdef LIGHTMAP
+        VertexLightmapCoords = Pulled.LightmapCoords;
+        Region = Instance.Payload;
+#endif
+#if defined(REFLECTION_PROBES) || defined(OBJECT_LIGHTS)
+        Indices = Instance.Indices.yzw;
+#endif
+    }
+#endif
+
+    if (Animation != uvec3(0u))
+    {
+        vec3 Offset;
+        mat3 Rotation = ProceduralRotation(Animation, Camera.Time.x, Offset);
+        Position = Rotation * Position + Offset;
+        VertexNormal = Rotation * VertexNormal;
+    }
+
+    FragPos = vec3(Model * vec4(Position, 1.0));
+    Normal = Normals * VertexNormal;
+    TexCoords = VertexTexCoords;
+#ifdef LIGHTMAP
+    LightmapCoords = VertexLightmapCoords * Region.xy + Region.zw;
+#endif
+#ifdef REFLECTION_PROBES
+    ReflectionProbe = Indices.y;
+#endif
+#ifdef OBJECT_LIGHTS
+    ObjectLights = Indices.z;
+#endif
 
-    gl_Position = MVPMatrix * vec4(aPos, 1.0);
+    gl_Position = Camera.ViewProjection * vec4(FragPos, 1.0);
 }
\ No newline at end of file
@@ -0,0 +1,165 @@
+#version 430 core        // Shader storage buffers need OpenGL 4.3, use with BaseLighting.vert.
+out vec4 FragColor;
+
+struct Material {
+    sampler2D diffuse;
+    sampler2D specular;
+}; 
+
+// std140 mirror of DirectionalLightData in LightUniformBuffer.h, the w components are unused
+struct DirLight {
+    vec4 direction;
+    vec4 ambient;
+    vec4 diffuse;
+    vec4 specular;
+};
+
+// std430 mirror of ClusteredPointLight in ClusteredLightManager.h
+struct PointLight {
+    vec4 positionRange;   // world-space position, range
+    vec4 colorIntensity;  // linear color, intensity
+};
+
+in vec3 FragPos;
+in vec3 Normal;
+in vec2 TexCoords;
+
+layout (std140) uniform CameraData
+{
+    mat4 View;
+    mat4 Projection;
+    mat4 ViewProjection;
+    vec4 Position;
+} Camera;
+
+// Only the directional light is read, the fixed point lights are replaced by the clusters
+layout (std140) uniform LightData
+{
+    DirLight dirLight;
+} Lights;
+
+layout (std140) uniform MaterialParameters
+{
+    float shininess;
+} Parameters;
+
+layout (std430, binding = 1) readonly buffer ClusteredLightData
+{
+    PointLight pointLights[];
+};
+
+layout (std430, binding = 2) readonly buffer LightClusterData
+{
+    uvec4 gridSize;       // clusters along x, y, z, light count
+    vec4 depthParams;     // near, far, slice scale, slice bias
+    vec4 screenParams;    // viewport width, height, tile width, tile height
+    uvec2 clusters[];     // offset in lightIndices, light count
+};
+
+layout (std430, binding = 3) readonly buffer LightIndexData
+{
+    uint lightIndices[];
+};
+
+uniform Material material;
+uniform sampler2D AmbientOcclusionMap;
+// fog between the camera and the fragment, see VolumetricFog.h
+layout (std140) uniform VolumetricFogData
+{
+    vec4 DepthParams;     // volume depth of a view depth: log(depth) * x + y
+    vec4 ScreenParams;    // viewport offset, 1 / viewport size
+} Fog;
+uniform sampler3D VolumetricFogMap;
+
+// function prototypes
+float CalcAmbientOcclusion();
+vec3 ApplyVolumetricFog(vec3 color, float viewDepth);
+vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir);
+vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
+
+void main()
+{    
+    // properties
+    vec3 norm = normalize(Normal);
+    vec3 viewDir = normalize(Camera.Position.xyz - FragPos);
+
+    // phase 1: directional lighting
+    vec3 result = CalcDirLight(Lights.dirLight, norm, viewDir);
+
+    // phase 2: the point lights of this fragment's cluster only
+    float viewDepth = -(Camera.View * vec4(FragPos, 1.0)).z;
+    uvec3 cluster;
+    cluster.xy = min(uvec2(gl_FragCoord.xy / screenParams.zw), gridSize.xy - 1u);
+    cluster.z = uint(clamp(floor(log(viewDepth) * depthParams.z + depthParams.w), 0.0, float(gridSize.z - 1u)));
+    uvec2 lightList = clusters[cluster.x + gridSize.x * (cluster.y + gridSize.y * cluster.z)];
+    for(uint i = 0u; i < lightList.y; i++)
+        result += CalcPointLight(pointLights[lightIndices[lightList.x + i]], norm, FragPos, viewDir);
+    
+    FragColor = vec4(ApplyVolumetricFog(result, viewDepth), 1.0);
+}
+
+// calculates the color when using a directional light.
+vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir)
+{
+    vec3 lightDir = normalize(-light.direction.xyz);
+    // diffuse shading
+    float diff = max(dot(normal, lightDir), 0.0);
+    // specular shading, compiled out of the NO_SPECULAR variant
+#ifndef NO_SPECULAR
+    vec3 reflectDir = reflect(-lightDir, normal);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), Parameters.shininess);
+#else
+    float spec = 0.0;
+#endif
+    // combine results
+    vec3 ambient = light.ambient.rgb * vec3(texture(material.diffuse, TexCoords)) * CalcAmbientOcclusion();
+    vec3 diffuse = light.diffuse.rgb * diff * vec3(texture(material.diffuse, TexCoords));
+#ifndef NO_SPECULAR
+    vec3 specular = light.specular.rgb * spec * vec3(texture(material.specular, TexCoords));
+#else
+    vec3 specular = vec3(0.0);
+#endif
+    return (ambient + diffuse + specular);
+}
+
+// calculates the color when using a clustered point light, which fades to zero at its range.
+vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
+{
+    vec3 lightDir = normalize(light.positionRange.xyz - fragPos);
+    // diffuse shading
+    float diff = max(dot(normal, lightDir), 0.0);
+    // specular shading, compiled out of the NO_SPECULAR variant
+#ifndef NO_SPECULAR
+    vec3 reflectDir = reflect(-lightDir, normal);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), Parameters.shininess);
+#else
+    float spec = 0.0;
+#endif
+    // windowed inverse square attenuation, zero outside the clusters the light was assigned to
+    float distance = length(light.positionRange.xyz - fragPos);
+    float window = clamp(1.0 - pow(distance / light.positionRange.w, 4.0), 0.0, 1.0);
+    float attenuation = window * window / (distance * distance + 1.0);
+    vec3 radiance = light.colorIntensity.rgb * light.colorIntensity.w * attenuation;
+    // combine results
+    vec3 diffuse = radiance * diff * vec3(texture(material.diffuse, TexCoords));
+#ifndef NO_SPECULAR
+    vec3 specular = radiance * spec * vec3(texture(material.specular, TexCoords));
+#else
+    vec3 specular = vec3(0.0);
+#endif
+    return (diffuse + specular);
+}
+
+// occlusion of the ambient light at this pixel, see AmbientOcclusion.h; white while it is off
+float CalcAmbientOcclusion()
+{
+    return texture(AmbientOcclusionMap, gl_FragCoord.xy / vec2(textureSize(AmbientOcclusionMap, 0))).r;
+}
+
+// fogs a shaded color: the light scattered in front of the fragment plus what reaches the camera; unchanged while the fog is off
+vec3 ApplyVolumetricFog(vec3 color, float viewDepth)
+{
+    vec3 uvw = vec3((gl_FragCoord.xy - Fog.ScreenParams.xy) * Fog.ScreenParams.zw, log(max(viewDepth, 1e-4)) * Fog.DepthParams.x + Fog.DepthParams.y);
+    vec4 fog = texture(VolumetricFogMap, uvw);
+    return color * fog.a + fog.rgb;
+}
\ No newline at end of file
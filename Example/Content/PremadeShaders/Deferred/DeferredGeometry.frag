@@ -0,0 +1,37 @@
+#version 410 core        // Geometry pass of RenderingMode::Deferred, use with BaseLighting.vert.
+layout (location = 0) out vec4 gAlbedoSpecular;   // albedo, specular intensity
+layout (location = 1) out vec4 gNormalRoughness;  // octahedral normal, roughness, unused
+
+struct Material {
+    sampler2D diffuse;
+    sampler2D specular;
+}; 
+
+in vec3 FragPos;
+in vec3 Normal;
+in vec2 TexCoords;
+
+layout (std140) uniform MaterialParameters
+{
+    float shininess;
+} Parameters;
+
+uniform Material material;
+
+// maps a unit vector to the [0, 1] square, two 10-bit channels keep it within a fraction of a degree
+vec2 EncodeNormal(vec3 n)
+{
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    vec2 signs = vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    vec2 encoded = n.z >= 0.0 ? n.xy : (1.0 - abs(n.yx)) * signs;
+    return encoded * 0.5 + 0.5;
+}
+
+void main()
+{
+    // shininess 1 to 1024 stored as a linear roughness, decoded by DeferredLighting.frag
+    float roughness = 1.0 - clamp(log2(Parameters.shininess) / 10.0, 0.0, 1.0);
+
+    gAlbedoSpecular = vec4(texture(material.diffuse, TexCoords).rgb, texture(material.specular, TexCoords).r);
+    gNormalRoughness = vec4(EncodeNormal(normalize(Normal)), roughness, 0.0);
+}
\ No newline at end of file
@@ -0,0 +1,269 @@
+#version 410 core        // Lighting pass of RenderingMode::Deferred, use with DeferredLighting.vert.
+out vec4 FragColor;
+
+// std140 mirrors of the structs in LightUniformBuffer.h, the w components are unused
+struct DirLight {
+    vec4 direction;
+    vec4 ambient;
+    vec4 diffuse;
+    vec4 specular;
+};
+
+struct PointLight {
+    vec4 position;
+    vec4 ambient;
+    vec4 diffuse;
+    vec4 specular;
+    vec4 attenuation;     // constant, linear, quadratic
+};
+
+struct SpotLight {
+    vec4 position;
+    vec4 direction;
+    vec4 ambient;
+    vec4 diffuse;
+    vec4 specular;
+    vec4 attenuation;     // constant, linear, quadratic
+    vec4 cutOff;          // cosines of the inner and outer cone angles
+};
+
+// surface read back from the G-buffer
+struct Surface {
+    vec3 position;
+    vec3 normal;
+    vec3 albedo;
+    float specular;
+    float shininess;
+};
+
+#define NR_POINT_LIGHTS 16     // LightData::MaxPointLights
+
+in vec2 TexCoords;
+
+layout (std140) uniform CameraData
+{
+    mat4 View;
+    mat4 Projection;
+    mat4 ViewProjection;
+    vec4 Position;
+    mat4 InverseViewProjection;
+} Camera;
+
+layout (std140) uniform LightData
+{
+    DirLight dirLight;
+    PointLight pointLights[NR_POINT_LIGHTS];
+    SpotLight spotLight;
+    ivec4 counts;         // point lights used, spot light enabled
+} Lights;
+
+uniform sampler2D gAlbedoSpecular;
+uniform sampler2D gNormalRoughness;
+uniform sampler2D gDepth;
+
+// cascades of the directional light, see CascadedShadowMaps.h
+layout (std140) uniform ShadowData
+{
+    mat4 LightViewProjection[4];
+    vec4 SplitDepths;     // view depth where each cascade ends
+    vec4 TexelSizes;      // world-space size of a texel in each cascade
+    vec4 Params;          // cascade count (0 when off), depth bias, normal bias in texels, 1 / resolution
+} Shadows;
+
+// shadows of the point lights and the spot light, see LocalShadowAtlas.h
+struct LocalShadow {
+    mat4 viewProjection[6];   // world to light clip space of each face: +X, -X, +Y, -Y, +Z, -Z; the spot light uses the first
+    vec4 tiles[6];            // atlas rectangle of each face: offset, size
+    vec4 params;              // face count (0 when unshadowed), depth bias, normal bias in texels, 2 * tan(half field of view)
+};
+
+layout (std140) uniform LocalShadowData
+{
+    LocalShadow pointShadows[NR_POINT_LIGHTS];
+    LocalShadow spotShadow;
+    vec4 params;          // 1 / atlas size
+} LocalShadows;
+
+uniform sampler2DArrayShadow ShadowMap;
+uniform sampler2DShadow LocalShadowMap;
+uniform sampler2D AmbientOcclusionMap;
+// fog between the camera and the fragment, see VolumetricFog.h
+layout (std140) uniform VolumetricFogData
+{
+    vec4 DepthParams;     // volume depth of a view depth: log(depth) * x + y
+    vec4 ScreenParams;    // viewport offset, 1 / viewport size
+} Fog;
+uniform sampler3D VolumetricFogMap;
+
+// function prototypes
+float CalcAmbientOcclusion();
+vec3 ApplyVolumetricFog(vec3 color, float viewDepth);
+vec3 DecodeNormal(vec2 encoded);
+float CalcDirShadow(Surface surface);
+vec3 CalcDirLight(DirLight light, Surface surface, vec3 viewDir);
+float CalcLocalShadow(int slot, vec3 lightPos, Surface surface);
+vec3 CalcPointLight(PointLight light, int slot, Surface surface, vec3 viewDir);
+vec3 CalcSpotLight(SpotLight light, Surface surface, vec3 viewDir);
+
+void main()
+{
+    // pixels the geometry pass didn't cover keep the cleared background
+    float depth = texture(gDepth, TexCoords).r;
+    if (depth == 1.0)
+        discard;
+    gl_FragDepth = depth;
+
+    // rebuild the surface from the G-buffer, the position from the depth buffer
+    vec4 albedoSpecular = texture(gAlbedoSpecular, TexCoords);
+    vec4 normalRoughness = texture(gNormalRoughness, TexCoords);
+    vec4 worldPos = Camera.InverseViewProjection * vec4(vec3(TexCoords, depth) * 2.0 - 1.0, 1.0);
+
+    Surface surface;
+    surface.position = worldPos.xyz / worldPos.w;
+    surface.normal = DecodeNormal(normalRoughness.xy);
+    surface.albedo = albedoSpecular.rgb;
+    surface.specular = albedoSpecular.a;
+    surface.shininess = exp2((1.0 - normalRoughness.z) * 10.0);
+    vec3 viewDir = normalize(Camera.Position.xyz - surface.position);
+
+    // same three phases as BaseLighting.frag: directional, point lights and an optional flashlight
+    vec3 result = CalcDirLight(Lights.dirLight, surface, viewDir);
+    for(int i = 0; i < min(Lights.counts.x, NR_POINT_LIGHTS); i++)
+        result += CalcPointLight(Lights.pointLights[i], i, surface, viewDir);    
+    if (Lights.counts.y != 0)
+        result += CalcSpotLight(Lights.spotLight, surface, viewDir);    
+    
+    FragColor = vec4(ApplyVolumetricFog(result, -(Camera.View * vec4(surface.position, 1.0)).z), 1.0);
+}
+
+// inverse of EncodeNormal in DeferredGeometry.frag
+vec3 DecodeNormal(vec2 encoded)
+{
+    encoded = encoded * 2.0 - 1.0;
+    vec3 n = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    float t = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
+
+// calculates the color when using a directional light.
+vec3 CalcDirLight(DirLight light, Surface surface, vec3 viewDir)
+{
+    vec3 lightDir = normalize(-light.direction.xyz);
+    // diffuse shading
+    float diff = max(dot(surface.normal, lightDir), 0.0);
+    // specular shading
+    vec3 reflectDir = reflect(-lightDir, surface.normal);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), surface.shininess);
+    // combine results
+    vec3 ambient = light.ambient.rgb * surface.albedo * CalcAmbientOcclusion();
+    vec3 diffuse = light.diffuse.rgb * diff * surface.albedo;
+    vec3 specular = light.specular.rgb * spec * surface.specular;
+    return (ambient + (diffuse + specular) * CalcDirShadow(surface));
+}
+
+// same cascade lookup as BaseLighting.frag, 1 outside the cascades.
+float CalcDirShadow(Surface surface)
+{
+    int count = int(Shadows.Params.x);
+    float viewDepth = -(Camera.View * vec4(surface.position, 1.0)).z;
+    int cascade = 0;
+    while (cascade < count && viewDepth > Shadows.SplitDepths[cascade])
+        cascade++;
+    if (cascade >= count)
+        return 1.0;
+    vec3 offsetPos = surface.position + surface.normal * Shadows.Params.z * Shadows.TexelSizes[cascade];
+    vec3 shadowPos = (Shadows.LightViewProjection[cascade] * vec4(offsetPos, 1.0)).xyz;
+    shadowPos.xy = shadowPos.xy * 0.5 + 0.5;
+    float lit = 0.0;
+    for (int x = -1; x <= 1; x++)
+        for (int y = -1; y <= 1; y++)
+            lit += texture(ShadowMap, vec4(shadowPos.xy + vec2(x, y) * Shadows.Params.w, float(cascade), shadowPos.z - Shadows.Params.y));
+    return lit / 9.0;
+}
+
+// same tile lookup as BaseLighting.frag, 1 for a light without its shadow.
+float CalcLocalShadow(int slot, vec3 lightPos, Surface surface)
+{
+    vec4 params = slot < NR_POINT_LIGHTS ? LocalShadows.pointShadows[slot].params : LocalShadows.spotShadow.params;
+    if (params.x == 0.0)
+        return 1.0;
+    vec3 toFrag = surface.position - lightPos;
+    vec3 axis = abs(toFrag);
+    int face = 0;
+    if (params.x > 1.0)
+        face = axis.x >= axis.y && axis.x >= axis.z ? (toFrag.x >= 0.0 ? 0 : 1) : (axis.y >= axis.z ? (toFrag.y >= 0.0 ? 2 : 3) : (toFrag.z >= 0.0 ? 4 : 5));
+    mat4 viewProjection = slot < NR_POINT_LIGHTS ? LocalShadows.pointShadows[slot].viewProjection[face] : LocalShadows.spotShadow.viewProjection[0];
+    vec4 tile = slot < NR_POINT_LIGHTS ? LocalShadows.pointShadows[slot].tiles[face] : LocalShadows.spotShadow.tiles[0];
+    float texelSize = LocalShadows.params.x;
+    float worldTexel = params.w * length(toFrag) * texelSize / tile.z;
+    vec4 clipPos = viewProjection * vec4(surface.position + surface.normal * params.z * worldTexel, 1.0);
+    if (clipPos.w <= 0.0)
+        return 1.0;
+    vec3 shadowPos = clipPos.xyz / clipPos.w;
+    vec2 uv = tile.xy + clamp(shadowPos.xy * 0.5 + 0.5, 0.0, 1.0) * tile.zw;
+    vec2 low = tile.xy + 0.5 * texelSize;
+    vec2 high = tile.xy + tile.zw - 0.5 * texelSize;
+    float lit = 0.0;
+    for (int x = -1; x <= 1; x++)
+        for (int y = -1; y <= 1; y++)
+            lit += texture(LocalShadowMap, vec3(clamp(uv + vec2(x, y) * texelSize, low, high), shadowPos.z - params.y));
+    return lit / 9.0;
+}
+
+// calculates the color when using a point light.
+vec3 CalcPointLight(PointLight light, int slot, Surface surface, vec3 viewDir)
+{
+    vec3 lightDir = normalize(light.position.xyz - surface.position);
+    // diffuse shading
+    float diff = max(dot(surface.normal, lightDir), 0.0);
+    // specular shading
+    vec3 reflectDir = reflect(-lightDir, surface.normal);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), surface.shininess);
+    // attenuation
+    float distance = length(light.position.xyz - surface.position);
+    float attenuation = 1.0 / (light.attenuation.x + light.attenuation.y * distance + light.attenuation.z * (distance * distance));    
+    // combine results
+    vec3 ambient = light.ambient.rgb * surface.albedo * CalcAmbientOcclusion();
+    vec3 diffuse = light.diffuse.rgb * diff * surface.albedo;
+    vec3 specular = light.specular.rgb * spec * surface.specular;
+    return (ambient + (diffuse + specular) * CalcLocalShadow(slot, light.position.xyz, surface)) * attenuation;
+}
+
+// calculates the color when using a spot light.
+vec3 CalcSpotLight(SpotLight light, Surface surface, vec3 viewDir)
+{
+    vec3 lightDir = normalize(light.position.xyz - surface.position);
+    // diffuse shading
+    float diff = max(dot(surface.normal, lightDir), 0.0);
+    // specular shading
+    vec3 reflectDir = reflect(-lightDir, surface.normal);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), surface.shininess);
+    // attenuation
+    float distance = length(light.position.xyz - surface.position);
+    float attenuation = 1.0 / (light.attenuation.x + light.attenuation.y * distance + light.attenuation.z * (distance * distance));    
+    // spotlight intensity
+    float theta = dot(lightDir, normalize(-light.direction.xyz)); 
+    float epsilon = light.cutOff.x - light.cutOff.y;
+    float intensity = clamp((theta - light.cutOff.y) / epsilon, 0.0, 1.0);
+    // combine results
+    vec3 ambient = light.ambient.rgb * surface.albedo * CalcAmbientOcclusion();
+    vec3 diffuse = light.diffuse.rgb * diff * surface.albedo;
+    vec3 specular = light.specular.rgb * spec * surface.specular;
+    return (ambient + (diffuse + specular) * CalcLocalShadow(NR_POINT_LIGHTS, light.position.xyz, surface)) * attenuation * intensity;
+}
+
+// occlusion of the ambient light at this pixel, see AmbientOcclusion.h; white while it is off
+float CalcAmbientOcclusion()
+{
+    return texture(AmbientOcclusionMap, gl_FragCoord.xy / vec2(textureSize(AmbientOcclusionMap, 0))).r;
+}
+
+// fogs a shaded color: the light scattered in front of the fragment plus what reaches the camera; unchanged while the fog is off
+vec3 ApplyVolumetricFog(vec3 color, float viewDepth)
+{
+    vec3 uvw = vec3((gl_FragCoord.xy - Fog.ScreenParams.xy) * Fog.ScreenParams.zw, log(max(viewDepth, 1e-4)) * Fog.DepthParams.x + Fog.DepthParams.y);
+    vec4 fog = texture(VolumetricFogMap, uvw);
+    return color * fog.a + fog.rgb;
+}
\ No newline at end of file
@@ -0,0 +1,10 @@
+#version 410 core     // Lighting pass of RenderingMode::Deferred, drawn as one triangle without vertex buffers.
+
+out vec2 TexCoords;
+
+void main()
+{
+    // vertices (0, 0), (2, 0) and (0, 2) cover the screen
+    TexCoords = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    gl_Position = vec4(TexCoords * 2.0 - 1.0, 0.0, 1.0);
+}
\ No newline at end of file
@@ -1,8 +1,16 @@
 #version 410 core     // Ensure this matches the OpenGL version configuration when initializing the window class.
 layout (location = 0) in vec3 aPos;
-layout (location = 3) in mat4 MVPMatrix;
+layout (location = 3) in mat4 ModelMatrix;
+
+layout (std140) uniform CameraData
+{
+	mat4 View;
+	mat4 Projection;
+	mat4 ViewProjection;
+	vec4 Position;
+} Camera;
 
 void main()
 {
-	gl_Position = MVPMatrix * vec4(aPos, 1.0);
+	gl_Position = Camera.ViewProjection * ModelMatrix * vec4(aPos, 1.0);
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include <FireGL/Core/InputManager.h>
 #include <FireGL/Core/SystemManager.h>
 #include <FireGL/Renderer/Scene.h>
+#include <FireGL/Renderer/PerformanceHUD.h>
 #include <FireGL/Renderer/Shapes/Sphere.h>
 
 #include <../Example/CustomCamera.h>
@@ -20,6 +21,12 @@ public:
     {
     }
 
+    // The HUD toggled with F3, none if nullptr
+    void SetPerformanceHUD(fgl::PerformanceHUD* HUD)
+    {
+        m_HUD = HUD;
+    }
+
 protected:
    
     virtual void OnInitialized() override
@@ -31,6 +38,26 @@ protected:
             //std::cout << "W key triggered!" << std::endl;
             });
         RegisterKeyEvent(GLFW_KEY_W, KeyEventType::OnReleased, &CustomInputManager::test, this, 1);
+
+        // Actions map several inputs to one callback, here the keyboard and the gamepad
+        const InputAction Exit = AddAction("Exit");
+        BindAction(Exit, GLFW_KEY_ESCAPE);
+        BindAction(Exit, GamepadButton(GLFW_GAMEPAD_BUTTON_BACK));
+        SetActionCallback(Exit, KeyEventType::OnPressed, []() {
+            SystemManager<BaseWindow>::Get()->Terminate();
+            });
+
+        const InputAction HUDAction = AddAction("ToggleHUD");
+        BindAction(HUDAction, GLFW_KEY_F3);
+        SetActionCallback(HUDAction, KeyEventType::OnPressed, FunctionRef<void()>::Bind<&CustomInputManager::ToggleHUD>(this));
+    }
+
+    void ToggleHUD()
+    {
+        if (m_HUD)
+        {
+            m_HUD->Toggle();
+        }
     }
 
     void test(int x)
@@ -48,12 +75,6 @@ protected:
 
     virtual void OnProcessInput() override
     {
-        // Exit
-        if (IsKeyTriggered(GLFW_KEY_ESCAPE))
-        {
-            SystemManager<BaseWindow>::Get()->Terminate();
-        }
-        
         // Forward/Backward
         if (IsKeyTriggered(GLFW_KEY_W))
         {
@@ -77,4 +98,5 @@ protected:
 
 private:
     std::shared_ptr<CustomCamera> m_Camera;  // Access to the camera or other game objects
+    fgl::PerformanceHUD* m_HUD = nullptr;     // Performance overlay toggled with F3
 };
\ No newline at end of file
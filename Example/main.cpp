@@ -28,10 +28,10 @@ int main()
     CustomInputManager Input( Camera );
     Input.Initialize();
 
-    // Load shaders
-    fgl::Shader LightingShader( AssetManager.GetPath("BaseLightingVertex"), AssetManager.GetPath("BaseLightingFragment") );
-    fgl::Shader PointLightShader( AssetManager.GetPath("LightVertex"), AssetManager.GetPath("LightFragment") );
-    fgl::Shader SkyBoxShader( AssetManager.GetPath("SkyboxVertex"), AssetManager.GetPath("SkyboxFragment") );
+    // Load shaders, the driver compiles them while the textures and models below load
+    fgl::GLExtensions::SetMaxShaderCompilerThreads(0xFFFFFFFF);
+    fgl::Shader LightingShader( AssetManager.GetPath("BaseLightingVertex"), AssetManager.GetPath("BaseLightingFragment"), true );
+    fgl::Shader PointLightShader( AssetManager.GetPath("LightVertex"), AssetManager.GetPath("LightFragment"), true );
 
     // Load textures
     fgl::Texture WoodTexture;
@@ -43,17 +43,11 @@ int main()
         AssetManager.GetPath("Skybox4"), AssetManager.GetPath("Skybox5"), AssetManager.GetPath("Skybox6") 
         });
 
-    // Set up materials for lighting, point lights, and skyboxes
+    // Set up materials for lighting and point lights
     std::shared_ptr<fgl::LightingMaterial> LightingMaterial = std::make_shared<fgl::LightingMaterial>(&LightingShader);
     LightingMaterial->SetTexture("normal", &WoodTexture);
 
     std::shared_ptr<fgl::Material> PointLightMaterial = std::make_shared<fgl::Material>(&PointLightShader);
-    std::shared_ptr<fgl::SkyboxMaterial> SkyboxMaterial = std::make_shared<fgl::SkyboxMaterial>(&SkyBoxShader);
-    SkyboxMaterial->SetTexture("skybox", &SkyboxTexture);
-
-    // Create shape objects and set materials
-    std::shared_ptr<fgl::Cube> SkyboxCube = std::make_shared<fgl::Cube>();
-    SkyboxCube->SetMaterial(SkyboxMaterial);
 
     // Load imported model and set material
     std::shared_ptr<fgl::Model> BackpackModel = std::make_shared<fgl::Model>( AssetManager.GetPath("BackpackModel") );
@@ -61,10 +55,11 @@ int main()
 
     // Create entities
     std::unique_ptr<fgl::Entity> BackpackEntity = std::make_unique<fgl::Entity>(BackpackModel);
-    std::unique_ptr<fgl::SkyboxEntity> SkyboxEntity = std::make_unique<fgl::SkyboxEntity>(SkyboxCube);
 
-    // Initialize the scene with the active camera
+    // Initialize the scene with the active camera, thread-safe objects tick on the job system workers
+    fgl::JobSystem Jobs;
     fgl::Scene MainScene(Camera);
+    MainScene.SetJobSystem(&Jobs);
 
     for (int i = 0; i < 15; i++)
     {
@@ -73,11 +68,29 @@ int main()
         PointLightCube->GetTransform().SetPosition(i * 2, 0, 0);
         MainScene.AddObject(std::move(PointLightCube));
     }
-    MainScene.AddObject(std::move(SkyboxEntity));
     MainScene.AddObject(std::move(BackpackEntity));
 
     // Renderer
     fgl::Renderer SceneRenderer(fgl::RenderingMode::Default);
+    SceneRenderer.SetJobSystem(&Jobs);
+
+    // The sky is drawn as one full-screen triangle behind the Scene
+    SceneRenderer.SetSkybox(&SkyboxTexture);
+
+    // Rotate the camera with unaccelerated motion, sampled again right before rendering
+    MainWindow.SetRawMouseMotion(true);
+    SceneRenderer.SetLateLatchInput(true);
+
+    // Recompile the lighting shader when its sources are saved
+    fgl::ShaderHotReloader ShaderReloader;
+    ShaderReloader.Watch(LightingShader);
+
+    // Frame times, GPU passes, render stats and memory over the frame, toggled with F3
+    fgl::SpriteBatch Overlay;
+    fgl::PerformanceHUD HUD(SceneRenderer);
+    HUD.Initialize();
+    SceneRenderer.SetOverlay(&Overlay);
+    Input.SetPerformanceHUD(&HUD);
 
     // Main Loop
     while (!MainWindow.ShouldClose())
@@ -85,7 +98,9 @@ int main()
         MainTimer.Update();
         Input.ProcessInput();
 
+        ShaderReloader.Update();
         MainScene.Process();
+        HUD.Record(Overlay);
         SceneRenderer.Render(&MainScene);
 
         Input.FinalizeInput();
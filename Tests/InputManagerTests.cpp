@@ -0,0 +1,120 @@
+#include <FireGL/Core/InputManager.h>
+#include <FireGL/Core/SystemManager.h>
+
+#include <cstdio>
+#include <cstdlib>
+
+// Key event callbacks registering bindings while they run, which their maps must survive. Needs no OpenGL
+// context: the window is never initialized, it only reports the focus the InputManager asks for.
+//
+//     ctest -R InputManager
+
+namespace
+{
+    class TestWindow : public fgl::BaseWindow
+    {
+    public:
+        TestWindow()
+        {
+            fgl::SystemManager<fgl::BaseWindow>::Set(this);
+        }
+    };
+
+    class TestInputManager : public fgl::InputManager
+    {
+    public:
+        using fgl::InputManager::RegisterKeyEvent;
+    };
+
+    int Failures = 0;
+
+    void Check(bool bCondition, const char* Description)
+    {
+        if (!bCondition)
+        {
+            std::fprintf(stderr, "FAILED: %s\n", Description);
+            Failures++;
+        }
+    }
+
+    // Presses a key for one frame
+    void PressKey(TestInputManager& Input, int Key)
+    {
+        Input.UpdateKey(Key, GLFW_PRESS, 0);
+        Input.ProcessInput();
+        Input.UpdateKey(Key, GLFW_RELEASE, 0);
+        Input.ProcessInput();
+    }
+
+    void RegisterFromPressedCallback()
+    {
+        TestWindow Window;
+        TestInputManager Input;
+
+        int Registered = 0;
+        int Fired = 0;
+        bool bDone = false;
+        Input.RegisterKeyEvent(GLFW_KEY_A, fgl::KeyEventType::OnPressed, [&]()
+        {
+            // Enough bindings to grow the map while this callback runs, then its own binding is replaced
+            for (int Key = GLFW_KEY_0; Key <= GLFW_KEY_9; Key++)
+            {
+                Input.RegisterKeyEvent(Key, fgl::KeyEventType::OnPressed, [&Fired]() { Fired++; });
+                Registered++;
+            }
+            for (int Key = GLFW_KEY_F1; Key <= GLFW_KEY_F25; Key++)
+            {
+                Input.RegisterKeyEvent(Key, fgl::KeyEventType::OnPressed, [&Fired]() { Fired++; });
+                Registered++;
+            }
+            Input.RegisterKeyEvent(GLFW_KEY_A, fgl::KeyEventType::OnPressed, [&Fired]() { Fired++; });
+
+            // Reads the captures after the map changed, they must still belong to this callback
+            bDone = Registered == 35;
+        });
+
+        PressKey(Input, GLFW_KEY_A);
+        Check(bDone, "a pressed callback finishes after registering bindings");
+
+        PressKey(Input, GLFW_KEY_5);
+        PressKey(Input, GLFW_KEY_A);
+        Check(Fired == 2, "bindings registered by a pressed callback fire on later frames");
+    }
+
+    void RegisterFromTriggeredCallback()
+    {
+        TestWindow Window;
+        TestInputManager Input;
+
+        int Calls = 0;
+        bool bDone = false;
+        Input.RegisterKeyEvent(GLFW_KEY_B, fgl::KeyEventType::OnTriggered, [&]()
+        {
+            Calls++;
+            for (int Key = GLFW_KEY_F1; Key <= GLFW_KEY_F25; Key++)
+            {
+                Input.RegisterKeyEvent(Key, fgl::KeyEventType::OnTriggered, []() {});
+            }
+            bDone = Calls > 0;
+        });
+
+        Input.UpdateKey(GLFW_KEY_B, GLFW_PRESS, 0);
+        Input.ProcessInput();
+        Input.ProcessInput();
+        Check(bDone && Calls == 2, "a triggered callback runs once per frame while registering bindings");
+    }
+}
+
+int main()
+{
+    RegisterFromPressedCallback();
+    RegisterFromTriggeredCallback();
+
+    if (Failures > 0)
+    {
+        std::fprintf(stderr, "%d check(s) failed\n", Failures);
+        return EXIT_FAILURE;
+    }
+    std::printf("All InputManager tests passed\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+#include <FireGL/Core/MappedFile.h>
+
+#include <shared_mutex>
+#include <span>
+
+namespace fgl
+{
+
+	/**
+	 * Packed asset archives, memory-mapped and mounted over a directory of loose files.
+	 *
+	 * An archive holds every file of a directory tree in one file. Once mounted, a path under its mount point
+	 * resolves to a read-only view of the mapping instead of a file on disk: Shader, Texture and Model loads
+	 * look their files up here first, then fall back to the disk. Opening one file and letting the OS page it
+	 * in replaces an open and a seek per asset, which dominates cold starts on slow disks.
+	 *
+	 * Entries are stored as is or compressed, each with its own method: LZ4 decompresses fastest, Zstd packs
+	 * densest. Compressed entries trade CPU for I/O, worth it on slow or network-mounted disks; they decompress
+	 * on the thread reading them, e.g. a loader worker, streaming from the mapping into the destination. The
+	 * methods are compiled in with FIREGL_ENABLE_LZ4 and FIREGL_ENABLE_ZSTD.
+	 *
+	 * Layout (native endianness): a header {Magic, Version, EntryCount, Reserved}, the entries
+	 * {KeyHash, Offset, StoredSize, Size, Compression, Reserved} sorted by KeyHash, then the stored contents,
+	 * each aligned to 16 bytes. Keys are the paths relative to the archived directory with '/' separators,
+	 * hashed with FNV-1a.
+	 *
+	 * Mounting isn't meant to happen while assets load; lookups are thread-safe.
+	 */
+	class AssetArchive
+	{
+	public:
+		static constexpr uint32_t Magic = 0x4B504746;             ///< "FGPK", identifies a FireGL asset archive.
+		static constexpr uint32_t Version = 2;                    ///< Bumped whenever the layout changes.
+		static constexpr const char* Extension = ".fglpak";       ///< Conventional extension of archives.
+
+		/** How an entry is stored. */
+		enum class Compression : uint32_t
+		{
+			None = 0, ///< Stored as is, reads view the mapping.
+			LZ4 = 1,  ///< LZ4 frame, fast to decompress.
+			Zstd = 2  ///< Zstandard frame, smaller but slower to decompress.
+		};
+
+		/** Contents of an archived file, see Read(). */
+		struct Blob
+		{
+			std::span<const uint8_t> Data;      ///< The contents, valid while Storage or the mount lives.
+			std::shared_ptr<uint8_t[]> Storage; ///< Owns Data once decompressed, empty when Data views the mapping.
+		};
+
+		/**
+		 * Builds an archive from every file under a directory.
+		 *
+		 * @param SourceDirectory The directory to pack, its files are keyed by their path relative to it.
+		 * @param ArchivePath The archive file to write.
+		 * @param Method How to compress the files, those it doesn't shrink are stored as is.
+		 * @return False if the directory couldn't be read, two keys collide, the method isn't compiled in or the
+		 *         archive couldn't be written.
+		 */
+		static bool Build(std::string_view SourceDirectory, std::string_view ArchivePath, Compression Method = Compression::None);
+
+		/**
+		 * Maps an archive and mounts it: paths under MountPoint are looked up in it.
+		 * Archives mounted later take precedence over earlier ones.
+		 *
+		 * @param ArchivePath The archive file to map.
+		 * @param MountPoint The directory the archive replaces, usually the one it was built from.
+		 * @return False if the file couldn't be mapped, isn't a valid archive or uses a method not compiled in.
+		 */
+		static bool Mount(std::string_view ArchivePath, std::string_view MountPoint);
+
+		/** Unmaps every archive. Blobs viewing a mapping become invalid. */
+		static void UnmountAll();
+
+		/** @return True if at least one archive is mounted. */
+		static bool IsMounted();
+
+		/**
+		 * Reads a file from the mounted archives: a view of the mapping if stored, decompressed otherwise.
+		 *
+		 * @param Path The path of the file, as it would be opened from disk.
+		 * @param Contents Receives the contents.
+		 * @return False if no mounted archive holds the file or it failed to decompress.
+		 */
+		static bool Read(std::string_view Path, Blob& Contents);
+
+		/**
+		 * Gets the size of an archived file once decompressed, to size the memory given to ReadInto().
+		 *
+		 * @return False if no mounted archive holds the file.
+		 */
+		static bool GetSize(std::string_view Path, uint64_t& Size);
+
+		/**
+		 * Copies or decompresses an archived file straight into caller memory, e.g. a mapped staging buffer.
+		 *
+		 * @param Path The path of the file.
+		 * @param Destination Exactly GetSize() bytes.
+		 * @return False if no mounted archive holds the file, the size differs or it failed to decompress.
+		 */
+		static bool ReadInto(std::string_view Path, std::span<uint8_t> Destination);
+
+		/** @return True if a mounted archive holds the file at Path. */
+		static bool Contains(std::string_view Path);
+
+		/** @return The FNV-1a hash an archive keys a relative path with. */
+		static uint64_t HashKey(std::string_view Key);
+
+		/**
+		 * Compresses a buffer into one frame of Method, the format entries are stored in; other packed formats,
+		 * e.g. VirtualTexture page files, use it too.
+		 *
+		 * @return False if the method isn't compiled in or failed.
+		 */
+		static bool Compress(Compression Method, const std::vector<char>& Contents, std::vector<char>& Compressed);
+
+		/**
+		 * Decompresses one frame written by Compress(). Thread-safe.
+		 *
+		 * @param Method The method the frame was compressed with, not None.
+		 * @param Source The compressed frame.
+		 * @param Destination Exactly the uncompressed size.
+		 * @return False if the method isn't compiled in, the frame is corrupt or its size differs.
+		 */
+		static bool Decompress(Compression Method, std::span<const uint8_t> Source, std::span<uint8_t> Destination);
+
+		/** @return True if Method is compiled in. */
+		static bool IsSupported(Compression Method);
+
+	private:
+		struct Header
+		{
+			uint32_t Magic;
+			uint32_t Version;
+			uint32_t EntryCount;
+			uint32_t Reserved;
+		};
+
+		struct Entry
+		{
+			uint64_t KeyHash;
+			uint64_t Offset;
+			uint64_t StoredSize;
+			uint64_t Size;
+			uint32_t Compression;
+			uint32_t Reserved;
+		};
+
+		/** A mapped archive and where it is mounted. */
+		struct MountedArchive
+		{
+			std::string MountPoint;       ///< Absolute, normalized, with '/' separators and a trailing '/'.
+			MappedFile File;              ///< The mapping.
+			const Entry* Entries = nullptr; ///< Entry table inside the mapping.
+			uint32_t EntryCount = 0;      ///< Entries in the table.
+		};
+
+		/** @return The entry of a file in the mounted archives and its stored bytes, nullptr if none holds it. Needs s_Mutex. */
+		static const Entry* FindEntry(std::string_view Path, const uint8_t*& Stored);
+
+		/** @return The absolute, normalized form of a path with '/' separators, compared against mount points. */
+		static std::string NormalizePath(std::string_view Path);
+
+		static std::vector<std::unique_ptr<MountedArchive>> s_Archives; ///< Mounted archives, the last one searched first.
+		static std::shared_mutex s_Mutex;                                ///< Guards s_Archives.
+	};
+
+} // namespace fgl
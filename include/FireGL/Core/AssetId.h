@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+namespace fgl
+{
+
+	/**
+	 * Precomputed handle of an AssetPathManager key: the 64-bit FNV-1a hash of the key string.
+	 *
+	 * Declared constexpr, the hash is computed at compile time, so looking a path up by AssetId neither hashes
+	 * nor allocates at runtime:
+	 *
+	 *     constexpr fgl::AssetId WoodId("Wood");
+	 *     const std::string& WoodPath = AssetManager.GetPath(WoodId);
+	 */
+	struct AssetId
+	{
+		uint64_t Hash = 0; ///< FNV-1a hash of the key.
+
+		constexpr AssetId() = default;
+		constexpr explicit AssetId(std::string_view Key) : Hash(HashKey(Key)) {}
+
+		/** @return The 64-bit FNV-1a hash of a string. */
+		static constexpr uint64_t HashKey(std::string_view Key)
+		{
+			uint64_t Result = 14695981039346656037ull;
+			for (const char Character : Key)
+			{
+				Result ^= static_cast<uint8_t>(Character);
+				Result *= 1099511628211ull;
+			}
+			return Result;
+		}
+
+		constexpr bool operator==(const AssetId&) const = default;
+	};
+
+	/** Hashes an AssetId for unordered containers, the key is already a hash. */
+	struct AssetIdHash
+	{
+		size_t operator()(AssetId Id) const { return static_cast<size_t>(Id.Hash); }
+	};
+
+} // namespace fgl
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+
+#include <atomic>
+#include <mutex>
+
+namespace fgl
+{
+
+	/**
+	 * Dependencies between assets, e.g. model -> textures or level -> models and shaders.
+	 *
+	 * Loaders only discover what an asset needs while parsing it, so its dependencies are read one after the
+	 * other. The manifest records them ahead of time for AssetPrefetcher, which then reads everything a level
+	 * needs at once.
+	 *
+	 * Manifests are text files, one asset per line, parsed like the AssetPathManager config:
+	 * - Level1=BackpackModel;BaseLightingVertex;BaseLightingFragment
+	 * - Models/Backpack/backpack.obj=Models/Backpack/diffuse.jpg;Models/Backpack/specular.jpg
+	 * Assets and dependencies are either AssetPathManager keys or paths relative to the manifest's directory,
+	 * written back that way by Save(). Lines starting with '[' or '#' are skipped.
+	 *
+	 * Models record their textures while SetRecording(true), so loading a level once writes its manifest.
+	 * Every function is thread-safe, models load on worker threads.
+	 */
+	class AssetManifest
+	{
+	public:
+		/**
+		 * Adds the dependencies listed in a manifest file.
+		 *
+		 * @param ManifestPath The manifest to read.
+		 * @return False if the file couldn't be read.
+		 */
+		static bool Load(std::string_view ManifestPath);
+
+		/**
+		 * Writes every recorded dependency.
+		 *
+		 * @param ManifestPath The manifest to write, paths are stored relative to its directory.
+		 * @return False if the file couldn't be written.
+		 */
+		static bool Save(std::string_view ManifestPath);
+
+		/** Forgets every dependency. */
+		static void Clear();
+
+		/** Starts or stops recording the dependencies loaders discover. */
+		static void SetRecording(bool bRecording);
+
+		/** @return True while loaders record their dependencies. */
+		static bool IsRecording();
+
+		/**
+		 * Records that an asset needs another one.
+		 *
+		 * @param Asset The key or path of the asset.
+		 * @param Dependency The key or path of the asset it needs.
+		 */
+		static void Record(std::string_view Asset, std::string_view Dependency);
+
+		/**
+		 * Collects the dependencies of an asset and theirs, each once, dependencies before their dependents.
+		 *
+		 * @param Asset The key or path of the asset.
+		 * @param Dependencies Receives the keys or paths, without Asset itself.
+		 */
+		static void GetDependencies(std::string_view Asset, std::vector<std::string>& Dependencies);
+
+	private:
+		/** @return The key unchanged, or the path in the lexically normal, '/'-separated form manifests are keyed by. */
+		static std::string Normalize(std::string_view Asset);
+
+		static std::unordered_map<std::string, std::vector<std::string>> s_Dependencies; ///< Direct dependencies by asset.
+		static std::mutex s_Mutex;                                                         ///< Guards s_Dependencies.
+		static std::atomic<bool> s_bRecording;                                             ///< Set by SetRecording().
+	};
+
+} // namespace fgl
@@ -2,6 +2,8 @@
 
 #include <FireGL/fglpch.h>
 #include <FireGL/Core/BaseSingletonManager.h>
+#include <FireGL/Core/AssetId.h>
+#include <FireGL/Core/FlatHashMap.h>
 
 #include <filesystem>
 
@@ -20,6 +22,12 @@ namespace fgl
 	 *
 	 * The file is parsed from top to bottom, so referenced keys must be defined beforehand.
 	 *
+	 * Keys are stored by their AssetId: lookups by a precomputed AssetId or by string neither build a string nor
+	 * copy the path, so runtime queries, e.g. while streaming, don't allocate.
+	 *
+	 * An AssetArchive built from the config file's directory can be mounted over it: the resolved paths stay
+	 * the same and the loaders read them from the archive.
+	 *
 	 * This class is part of a singleton-based system and is not intended to be derived from.
 	 * It serves as a blueprint for implementing asset path management systems.
 	 */
@@ -30,8 +38,10 @@ namespace fgl
 		 * Constructs the AssetPathManager and loads the configuration file.
 		 *
 		 * @param ConfigPath The path to the .ini file to load.
+		 * @param ArchivePath An AssetArchive to mount over the config file's directory first, empty for loose files only.
+		 *                    Archives don't record directories, so paths are then only checked when loaded.
 		 */
-		AssetPathManager(std::string_view ConfigPath);
+		AssetPathManager(std::string_view ConfigPath, std::string_view ArchivePath = {});
 
 		/**
 		 * @brief Retrieves the resolved path for a given key.
@@ -42,7 +52,23 @@ namespace fgl
 		 * @param Key The key to look up.
 		 * @return The resolved path corresponding to the key, or an empty string if the key is not found (results in a crash).
 		 */
-		std::string GetPath(std::string_view Key);
+		const std::string& GetPath(std::string_view Key) const;
+
+		/**
+		 * Retrieves the resolved path for a precomputed key handle, see GetPath(std::string_view).
+		 *
+		 * @param Id The handle of the key, e.g. a constexpr AssetId("Wood").
+		 * @return The resolved path, or an empty string if the key is not found (results in a crash).
+		 */
+		const std::string& GetPath(AssetId Id) const;
+
+		/**
+		 * Looks a key up without treating a missing key as an error.
+		 *
+		 * @param Id The handle of the key.
+		 * @return The resolved path, or nullptr if the key is not defined.
+		 */
+		const std::string* FindPath(AssetId Id) const;
 	
 	protected:
 		/**
@@ -76,7 +102,14 @@ namespace fgl
 		std::string ResolvePath(std::string_view Value) const;
 
 	private:
-		std::unordered_map<std::string, std::string> m_ConfigMap;  ///< Stores key-value pairs from the .ini file.
+		/** A key of the .ini file and its resolved path. */
+		struct PathEntry
+		{
+			std::string Key;  ///< The key as written, kept to report collisions.
+			std::string Path; ///< The resolved path.
+		};
+
+		FlatHashMap<AssetId, PathEntry, AssetIdHash> m_ConfigMap; ///< Stores key-value pairs from the .ini file by key handle, only filled by the constructor.
 		std::filesystem::path m_ConfigPathPath;					   ///< Directory path of the loaded config file (used for relative path resolution).
 	};
 
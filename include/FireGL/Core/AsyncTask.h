@@ -0,0 +1,290 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+#include <FireGL/Core/JobSystem.h>
+#include <FireGL/Core/BaseLog.h>
+
+#include <atomic>
+#include <coroutine>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+namespace fgl
+{
+
+	template<typename T>
+	class AsyncTask;
+
+	namespace Detail
+	{
+		/**
+		 * State shared by the promises of every AsyncTask: the coroutine waiting for the result, and the count of
+		 * owners, the AsyncTask and the running coroutine, so whichever lets go last destroys the frame.
+		 */
+		class AsyncPromiseBase
+		{
+		public:
+			/** Resumes the awaiting coroutine, if any, once the result is stored. */
+			struct FinalAwaiter
+			{
+				bool await_ready() const noexcept { return false; }
+
+				template<typename Promise>
+				std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> Handle) noexcept
+				{
+					AsyncPromiseBase& State = Handle.promise();
+					void* const Waiting = State.m_Continuation.exchange(&State, std::memory_order_acq_rel);
+					const std::coroutine_handle<> Continuation = Waiting ? std::coroutine_handle<>::from_address(Waiting) : std::noop_coroutine();
+					if (State.m_Owners.fetch_sub(1, std::memory_order_acq_rel) == 1)
+					{
+						Handle.destroy();
+					}
+					return Continuation;
+				}
+
+				void await_resume() const noexcept {}
+			};
+
+			/** Tasks start right away, on the calling thread up to their first co_await. */
+			std::suspend_never initial_suspend() const noexcept { return {}; }
+
+			FinalAwaiter final_suspend() const noexcept { return {}; }
+
+			/** Loaders report their failures through their results, an escaping exception is a bug. */
+			void unhandled_exception() const noexcept { std::terminate(); }
+
+			/** @return True once the coroutine returned. */
+			bool IsDone() const { return m_Continuation.load(std::memory_order_acquire) == this; }
+
+			/**
+			 * Registers the coroutine to resume when the task completes.
+			 *
+			 * @return False if the task already completed, the caller then continues without suspending.
+			 */
+			bool SetContinuation(std::coroutine_handle<> Continuation)
+			{
+				void* Expected = nullptr;
+				return m_Continuation.compare_exchange_strong(Expected, Continuation.address(), std::memory_order_acq_rel);
+			}
+
+			/** @return True if the AsyncTask was the last owner, the frame must then be destroyed. */
+			bool Release() { return m_Owners.fetch_sub(1, std::memory_order_acq_rel) == 1; }
+
+		private:
+			std::atomic<void*> m_Continuation = nullptr;  ///< nullptr, the awaiting coroutine, or this once completed.
+			std::atomic<uint32_t> m_Owners = 2;           ///< The AsyncTask and the running coroutine.
+		};
+
+		template<typename T>
+		class AsyncPromise : public AsyncPromiseBase
+		{
+		public:
+			AsyncTask<T> get_return_object();
+
+			template<typename U>
+			void return_value(U&& Value) { m_Result.emplace(std::forward<U>(Value)); }
+
+			/** @return The returned value, valid once IsDone(). */
+			T& GetResult() { return *m_Result; }
+
+		private:
+			std::optional<T> m_Result; ///< Value of the co_return.
+		};
+
+		template<>
+		class AsyncPromise<void> : public AsyncPromiseBase
+		{
+		public:
+			AsyncTask<void> get_return_object();
+
+			void return_void() const {}
+
+			void GetResult() const {}
+		};
+	}
+
+	/**
+	 * Coroutine running asynchronous work, e.g. an asset load that decodes on a worker and uploads on the GL thread.
+	 *
+	 * A coroutine returning AsyncTask starts right away and runs on the calling thread up to its first suspension;
+	 * it moves between threads by awaiting AsyncScheduler::ResumeOnWorker() and AsyncScheduler::ResumeOnMainThread().
+	 * Another coroutine awaits it with co_await, which suspends until the result is ready and then continues on the
+	 * thread that completed it; plain code polls IsDone() and reads Get(). Dropping the task doesn't cancel the
+	 * coroutine: it runs to completion and frees itself.
+	 *
+	 * @tparam T The type of the result, void for none.
+	 */
+	template<typename T = void>
+	class [[nodiscard]] AsyncTask
+	{
+	public:
+		using promise_type = Detail::AsyncPromise<T>;
+
+		AsyncTask() = default;
+
+		explicit AsyncTask(std::coroutine_handle<promise_type> Handle)
+			: m_Handle(Handle)
+		{
+		}
+
+		/** Lets go of the coroutine, freed by whichever of the task and the coroutine finishes last. */
+		~AsyncTask()
+		{
+			Reset();
+		}
+
+		AsyncTask(AsyncTask&& Other) noexcept
+			: m_Handle(std::exchange(Other.m_Handle, nullptr))
+		{
+		}
+
+		AsyncTask& operator=(AsyncTask&& Other) noexcept
+		{
+			if (this != &Other)
+			{
+				Reset();
+				m_Handle = std::exchange(Other.m_Handle, nullptr);
+			}
+			return *this;
+		}
+
+		AsyncTask(const AsyncTask&) = delete;
+		AsyncTask& operator=(const AsyncTask&) = delete;
+
+		/** @return True if the task holds a coroutine. */
+		bool IsValid() const { return static_cast<bool>(m_Handle); }
+
+		/** @return True once the coroutine returned. */
+		bool IsDone() const { return m_Handle && m_Handle.promise().IsDone(); }
+
+		/** @return The result of the coroutine, which must be done. */
+		decltype(auto) Get()
+		{
+			LOG_ASSERT(IsDone(), "The asynchronous task isn't done yet.")
+			return m_Handle.promise().GetResult();
+		}
+
+		/** Awaiting the task suspends until the coroutine returned, then gives its result. */
+		auto operator co_await() && noexcept
+		{
+			struct Awaiter
+			{
+				std::coroutine_handle<promise_type> Handle;
+
+				bool await_ready() const noexcept { return Handle.promise().IsDone(); }
+				bool await_suspend(std::coroutine_handle<> Awaiting) noexcept { return Handle.promise().SetContinuation(Awaiting); }
+
+				auto await_resume()
+				{
+					if constexpr (std::is_void_v<T>)
+					{
+						return;
+					}
+					else
+					{
+						return std::move(Handle.promise().GetResult());
+					}
+				}
+			};
+			return Awaiter{ m_Handle };
+		}
+
+	private:
+		void Reset()
+		{
+			if (m_Handle && m_Handle.promise().Release())
+			{
+				m_Handle.destroy();
+			}
+			m_Handle = nullptr;
+		}
+
+		std::coroutine_handle<promise_type> m_Handle; ///< The coroutine, nullptr once moved from.
+	};
+
+	template<typename T>
+	AsyncTask<T> Detail::AsyncPromise<T>::get_return_object()
+	{
+		return AsyncTask<T>(std::coroutine_handle<AsyncPromise<T>>::from_promise(*this));
+	}
+
+	inline AsyncTask<void> Detail::AsyncPromise<void>::get_return_object()
+	{
+		return AsyncTask<void>(std::coroutine_handle<AsyncPromise<void>>::from_promise(*this));
+	}
+
+	/**
+	 * Moves coroutines between the workers of a JobSystem and the thread owning the OpenGL context.
+	 *
+	 * co_await ResumeOnWorker() continues the coroutine as a job, for file I/O and decoding; co_await
+	 * ResumeOnMainThread() queues it for the next ProcessMainThread(), called once per frame on the GL thread, which
+	 * resumes the queued coroutines within a time budget so uploads spread over frames instead of stalling one.
+	 */
+	class AsyncScheduler
+	{
+	public:
+		/** @param Jobs The job system the worker parts run on, must outlive the scheduler. */
+		explicit AsyncScheduler(JobSystem& Jobs);
+
+		/** Waits for the coroutines running on workers; the ones queued for the main thread are never resumed. */
+		~AsyncScheduler();
+
+		AsyncScheduler(const AsyncScheduler&) = delete;
+		AsyncScheduler& operator=(const AsyncScheduler&) = delete;
+
+		/** @return An awaitable continuing the coroutine on a JobSystem worker. */
+		auto ResumeOnWorker()
+		{
+			struct Awaiter
+			{
+				AsyncScheduler& Scheduler;
+
+				bool await_ready() const noexcept { return false; }
+				void await_suspend(std::coroutine_handle<> Handle) { Scheduler.m_Jobs.Schedule([Handle]() { Handle.resume(); }, Scheduler.m_Counter); }
+				void await_resume() const noexcept {}
+			};
+			return Awaiter{ *this };
+		}
+
+		/** @return An awaitable continuing the coroutine in the next ProcessMainThread(). */
+		auto ResumeOnMainThread()
+		{
+			struct Awaiter
+			{
+				AsyncScheduler& Scheduler;
+
+				bool await_ready() const noexcept { return false; }
+				void await_suspend(std::coroutine_handle<> Handle) { Scheduler.QueueMainThread(Handle); }
+				void await_resume() const noexcept {}
+			};
+			return Awaiter{ *this };
+		}
+
+		/**
+		 * Resumes the coroutines queued for the main thread until the budget is spent, at least one per call so
+		 * loading always progresses. Coroutines queued again meanwhile wait for the next call. Must run on the
+		 * thread owning the OpenGL context.
+		 *
+		 * @param BudgetMilliseconds Time the resumed coroutines may take this frame.
+		 */
+		void ProcessMainThread(float BudgetMilliseconds = 2.0f);
+
+		/** @return True while coroutines run on workers or wait for the main thread. */
+		bool IsBusy() const;
+
+		/** @return The loads in progress: coroutines running on workers or waiting for the main thread. */
+		size_t GetPendingCount() const;
+
+	private:
+		/** Queues a coroutine for ProcessMainThread(), from any thread. */
+		void QueueMainThread(std::coroutine_handle<> Handle);
+
+		JobSystem& m_Jobs;                                  ///< Runs the worker parts.
+		JobCounter m_Counter;                               ///< Worker parts in flight.
+		mutable std::mutex m_Mutex;                         ///< Guards m_MainQueue.
+		std::deque<std::coroutine_handle<>> m_MainQueue;    ///< Coroutines waiting for the main thread.
+		std::deque<std::coroutine_handle<>> m_Resuming;     ///< Coroutines taken by the ProcessMainThread() in progress.
+	};
+
+} // namespace fgl
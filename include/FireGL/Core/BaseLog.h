@@ -2,16 +2,128 @@
 
 #include <FireGL/fglpch.h>
 
+#if __has_include(<format>)
+#include <format>
+#endif
+
+// Lowest level compiled in, set by the FIREGL_LOG_LEVEL CMake option: 0 info, 1 errors, 2 none. Asserts are always compiled in.
+#ifndef FIREGL_MIN_LOG_LEVEL
+#define FIREGL_MIN_LOG_LEVEL 0
+#endif
+
 namespace fgl 
 {
 
-#define LOG_INFO(Message) Log::Log(Message);
-#define LOG_ERROR(ErrorMessage, ShouldThrow) Log::Error(ErrorMessage, __FILE__, __LINE__, ShouldThrow);
-#define LOG_ASSERT(Condition, AssertMessage) Log::Assert(Condition, AssertMessage, __FILE__, __LINE__);
-#define LOG_ASSERT_CALLBACK(Condition, AssertMessage, Callback) Log::Assert(Condition, AssertMessage, __FILE__, __LINE__, Callback);
+// Messages of a disabled level are never evaluated: below FIREGL_MIN_LOG_LEVEL the call is discarded at compile time,
+// below Log::SetLevel() it is skipped at run time. LOG_INFO also takes std::format arguments: LOG_INFO("{} meshes", Count).
+#define FGL_LOG_ENABLED(Level) (::fgl::IsLogEnabled<Level> && ::fgl::Log::IsEnabled(Level))
+#define LOG_INFO(...) do { if constexpr (::fgl::IsLogEnabled<::fgl::LogLevel::Info>) { \
+	if (::fgl::Log::IsEnabled(::fgl::LogLevel::Info)) ::fgl::Log::Log(::fgl::Log::Format(__VA_ARGS__)); } } while (0);
+#define LOG_ERROR(ErrorMessage, ShouldThrow) do { const bool bLogThrow = (ShouldThrow); \
+	if (bLogThrow || FGL_LOG_ENABLED(::fgl::LogLevel::Error)) ::fgl::Log::Error(ErrorMessage, __FILE__, __LINE__, bLogThrow); } while (0);
+#define LOG_ASSERT(Condition, AssertMessage) do { if (!(Condition)) ::fgl::Log::Assert(false, AssertMessage, __FILE__, __LINE__); } while (0);
+#define LOG_ASSERT_CALLBACK(Condition, AssertMessage, Callback) do { if (!(Condition)) ::fgl::Log::Assert(false, AssertMessage, __FILE__, __LINE__, Callback); } while (0);
+
+	/** Severity of a message, in increasing order. */
+	enum class LogLevel : uint8_t
+	{
+		Info,  ///< LOG_INFO messages.
+		Error, ///< LOG_ERROR messages. Throwing errors still throw when the level is disabled.
+		None   ///< Nothing but failed asserts.
+	};
+
+	/** FIREGL_MIN_LOG_LEVEL as a constant, only compared through IsLogEnabled. */
+	inline constexpr int MinLogLevel = FIREGL_MIN_LOG_LEVEL;
+
+	/** True if messages of a level are compiled in, false if FIREGL_MIN_LOG_LEVEL discards them. */
+	template<LogLevel Level>
+	inline constexpr bool IsLogEnabled = static_cast<int>(Level) >= MinLogLevel;
 
 	namespace Log {
 
+		/**
+		 * @brief Sets the lowest level written at run time, on top of FIREGL_MIN_LOG_LEVEL.
+		 *
+		 * @param Level The lowest level to write, LogLevel::Info by default.
+		 */
+		void SetLevel(LogLevel Level);
+
+		/**
+		 * @brief Returns the lowest level written at run time.
+		 */
+		LogLevel GetLevel();
+
+		/**
+		 * @brief Checks whether messages of a level are written at run time.
+		 */
+		inline bool IsEnabled(LogLevel Level)
+		{
+			return Level >= GetLevel();
+		}
+
+		/**
+		 * @brief Passes a message given without arguments through as is, braces included.
+		 */
+		inline std::string_view Format(std::string_view Message)
+		{
+			return Message;
+		}
+
+#if defined(__cpp_lib_format)
+		/**
+		 * @brief Formats a message with std::format, the format string is checked at compile time.
+		 */
+		template <typename First, typename... Rest>
+		std::string Format(std::format_string<First, Rest...> FormatString, First&& Argument, Rest&&... Arguments)
+		{
+			return std::format(FormatString, std::forward<First>(Argument), std::forward<Rest>(Arguments)...);
+		}
+#else
+		/**
+		 * @brief Replaces every {} of the format string with the next argument, written with operator<<.
+		 *
+		 * Stands in for std::format on standard libraries without <format>; "{{" and "}}" are literal braces.
+		 */
+		template <typename First, typename... Rest>
+		std::string Format(std::string_view FormatString, First&& Argument, Rest&&... Arguments)
+		{
+			std::ostringstream Output;
+			auto WriteNext = [&Output, &FormatString](const auto& Value) {
+				for (size_t Index = 0; Index < FormatString.size(); Index++)
+				{
+					const char Character = FormatString[Index];
+					const char Following = Index + 1 < FormatString.size() ? FormatString[Index + 1] : '\0';
+					if (Character == '{' && Following == '}')
+					{
+						Output << Value;
+						FormatString.remove_prefix(Index + 2);
+						return;
+					}
+					if ((Character == '{' && Following == '{') || (Character == '}' && Following == '}'))
+					{
+						Index++;
+					}
+					Output << Character;
+				}
+				FormatString = std::string_view();
+			};
+			WriteNext(Argument);
+			(WriteNext(Arguments), ...);
+
+			// The text after the last argument
+			for (size_t Index = 0; Index < FormatString.size(); Index++)
+			{
+				const char Character = FormatString[Index];
+				if ((Character == '{' || Character == '}') && Index + 1 < FormatString.size() && FormatString[Index + 1] == Character)
+				{
+					Index++;
+				}
+				Output << Character;
+			}
+			return Output.str();
+		}
+#endif
+
 		/**
 		 * @brief Logs a simple informational message.
 		 *
@@ -49,6 +161,32 @@ namespace fgl
 		 */
 		void Assert(bool Condition, std::string_view AssertMessage, const char* File, int Line, std::function<void()> Callback = nullptr);
 
+		/**
+		 * @brief Selects whether messages are written by the background thread.
+		 *
+		 * Asynchronous logging is the default: Log(), Error() and Assert() push the message on a lock-free
+		 * queue and return, a background thread formats the queued messages and writes them in batches,
+		 * flushing each sink once per batch. Messages of one thread keep their order. Error() and Assert()
+		 * flush before throwing so the message is out before the exception unwinds. Synchronous logging
+		 * writes and flushes every message before returning.
+		 *
+		 * @param bAsync False to write every message on the calling thread.
+		 */
+		void SetAsync(bool bAsync);
+
+		/**
+		 * @brief Also writes the messages logged from now on to a file, appending to it.
+		 *
+		 * @param Path The file to append to, an empty path to stop writing to a file.
+		 * @return False if the file couldn't be opened.
+		 */
+		bool SetFileSink(std::string_view Path);
+
+		/**
+		 * @brief Returns once every message logged before the call is written and flushed.
+		 */
+		void Flush();
+
 		/**
 		 * @brief Retrieves the current timestamp.
 		 *
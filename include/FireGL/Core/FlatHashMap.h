@@ -0,0 +1,620 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+#include <FireGL/Core/BaseLog.h>
+
+#include <bit>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+	#include <immintrin.h>
+	#define FGL_FLAT_MAP_SSE 1
+#elif (defined(__ARM_NEON) && defined(__aarch64__)) || defined(_M_ARM64)
+	#include <arm_neon.h>
+	#define FGL_FLAT_MAP_NEON 1
+#endif
+
+namespace fgl
+{
+
+	/**
+	 * Default hash of FlatHashMap: std::hash mixed so that both the low and the high bits vary, which
+	 * std::hash of integers and pointers doesn't do. Strings are hashed as std::string_view, so a map keyed by
+	 * std::string can be searched with a std::string_view or a const char* without building a string.
+	 */
+	template<typename Key>
+	struct FlatHash
+	{
+		size_t operator()(const Key& Value) const
+		{
+			return Mix(static_cast<uint64_t>(std::hash<Key>()(Value)));
+		}
+
+		/** Spreads the bits of Hash over the whole word (the finalizer of MurmurHash3). */
+		static size_t Mix(uint64_t Hash)
+		{
+			Hash ^= Hash >> 33;
+			Hash *= 0xFF51AFD7ED558CCDull;
+			Hash ^= Hash >> 33;
+			Hash *= 0xC4CEB9FE1A85EC53ull;
+			Hash ^= Hash >> 33;
+			return static_cast<size_t>(Hash);
+		}
+	};
+
+	template<>
+	struct FlatHash<std::string>
+	{
+		using is_transparent = void;
+
+		size_t operator()(std::string_view Value) const
+		{
+			return FlatHash<size_t>::Mix(static_cast<uint64_t>(std::hash<std::string_view>()(Value)));
+		}
+	};
+
+	/**
+	 * Hash map storing its entries in one flat array with open addressing, for lookups on hot paths.
+	 *
+	 * Next to the entries, one control byte per slot holds 7 bits of the key's hash, or marks the slot empty or
+	 * erased. A lookup reads the control bytes 16 at a time, compared at once with SSE2 or NEON, and only compares
+	 * the keys whose 7 bits match, so a miss rarely touches an entry. Unlike std::unordered_map, inserting doesn't
+	 * allocate a node: the map allocates when it grows, by doubling, or on reserve().
+	 *
+	 * The interface is the subset of std::unordered_map the engine uses, with a few differences:
+	 * - entries are std::pair<Key, Value> and must not have their key modified through an iterator;
+	 * - inserting may move every entry, invalidating iterators, pointers and references to entries;
+	 * - erasing only invalidates the erased entry, so erasing while iterating is fine.
+	 * With a transparent Hash and Equal, as for std::string keys by default, lookups accept any type comparable
+	 * to Key, e.g. find(std::string_view).
+	 */
+	template<typename Key, typename Value, typename Hash = FlatHash<Key>, typename Equal = std::equal_to<>>
+	class FlatHashMap
+	{
+	public:
+		using key_type = Key;
+		using mapped_type = Value;
+		using value_type = std::pair<Key, Value>;
+		using size_type = size_t;
+
+		static constexpr size_t GroupSize = 16; ///< Control bytes compared at once, the capacity is a multiple of it.
+
+	private:
+		/** Whether Lookup can search the map: Key itself, or anything else if Hash and Equal are transparent. */
+		template<typename Lookup>
+		static constexpr bool IsLookup = std::is_convertible_v<const Lookup&, const Key&>
+			|| (requires { typename Hash::is_transparent; typename Equal::is_transparent; }
+				&& std::is_invocable_v<const Hash&, const Lookup&>);
+
+		template<typename Entry>
+		class Iterator
+		{
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = std::pair<Key, Value>;
+			using difference_type = std::ptrdiff_t;
+			using pointer = Entry*;
+			using reference = Entry&;
+
+			Iterator() = default;
+
+			/** Converts an iterator to a const_iterator. */
+			template<typename Other>
+				requires (std::is_const_v<Entry> && !std::is_const_v<Other>)
+			Iterator(const Iterator<Other>& Mutable)
+				: m_Control(Mutable.m_Control), m_Entry(Mutable.m_Entry), m_End(Mutable.m_End)
+			{
+			}
+
+			reference operator*() const { return *m_Entry; }
+			pointer operator->() const { return m_Entry; }
+
+			Iterator& operator++()
+			{
+				++m_Control;
+				++m_Entry;
+				SkipFree();
+				return *this;
+			}
+
+			Iterator operator++(int)
+			{
+				Iterator Previous = *this;
+				++*this;
+				return Previous;
+			}
+
+			bool operator==(const Iterator& Other) const { return m_Entry == Other.m_Entry; }
+
+		private:
+			friend class FlatHashMap;
+			template<typename> friend class Iterator;
+
+			Iterator(const int8_t* Control, Entry* Slot, const int8_t* End)
+				: m_Control(Control), m_Entry(Slot), m_End(End)
+			{
+			}
+
+			/** Moves to the first full slot from here, or to the end. */
+			void SkipFree()
+			{
+				while (m_Control != m_End && *m_Control < 0)
+				{
+					++m_Control;
+					++m_Entry;
+				}
+			}
+
+			const int8_t* m_Control = nullptr; ///< Control byte of the entry.
+			Entry* m_Entry = nullptr;          ///< Current entry.
+			const int8_t* m_End = nullptr;     ///< Control byte past the last slot.
+		};
+
+	public:
+		using iterator = Iterator<value_type>;
+		using const_iterator = Iterator<const value_type>;
+
+		FlatHashMap() = default;
+
+		FlatHashMap(std::initializer_list<value_type> Entries)
+		{
+			reserve(Entries.size());
+			for (const value_type& Entry : Entries)
+			{
+				try_emplace(Entry.first, Entry.second);
+			}
+		}
+
+		FlatHashMap(const FlatHashMap& Other)
+		{
+			*this = Other;
+		}
+
+		FlatHashMap(FlatHashMap&& Other) noexcept
+		{
+			Swap(Other);
+		}
+
+		FlatHashMap& operator=(const FlatHashMap& Other)
+		{
+			if (this != &Other)
+			{
+				clear();
+				reserve(Other.m_Size);
+				for (const value_type& Entry : Other)
+				{
+					InsertUnique(Entry.first, Entry.second);
+				}
+			}
+			return *this;
+		}
+
+		FlatHashMap& operator=(FlatHashMap&& Other) noexcept
+		{
+			if (this != &Other)
+			{
+				Release();
+				Swap(Other);
+			}
+			return *this;
+		}
+
+		~FlatHashMap()
+		{
+			Release();
+		}
+
+		iterator begin()
+		{
+			iterator First(m_Control, m_Slots, m_Control + m_Capacity);
+			First.SkipFree();
+			return First;
+		}
+
+		const_iterator begin() const
+		{
+			const_iterator First(m_Control, m_Slots, m_Control + m_Capacity);
+			First.SkipFree();
+			return First;
+		}
+
+		iterator end() { return iterator(m_Control + m_Capacity, m_Slots + m_Capacity, m_Control + m_Capacity); }
+		const_iterator end() const { return const_iterator(m_Control + m_Capacity, m_Slots + m_Capacity, m_Control + m_Capacity); }
+
+		size_t size() const { return m_Size; }
+		bool empty() const { return m_Size == 0; }
+
+		/** @return The entries the map holds before growing again. */
+		size_t capacity() const { return MaxLoad(m_Capacity); }
+
+		/** Grows the map so that it holds Count entries without growing again. */
+		void reserve(size_t Count)
+		{
+			if (Count > MaxLoad(m_Capacity))
+			{
+				Rehash(CapacityFor(Count));
+			}
+		}
+
+		/** Destroys every entry, keeping the memory. */
+		void clear()
+		{
+			if (m_Size > 0 || m_Erased > 0)
+			{
+				for (size_t Index = 0; Index < m_Capacity; Index++)
+				{
+					if (m_Control[Index] >= 0)
+					{
+						std::destroy_at(m_Slots + Index);
+					}
+				}
+				std::memset(m_Control, Empty, m_Capacity);
+			}
+			m_Size = 0;
+			m_Erased = 0;
+		}
+
+		template<typename Lookup>
+			requires IsLookup<Lookup>
+		iterator find(const Lookup& Name)
+		{
+			const size_t Index = Find(Name);
+			return Index == NotFound ? end() : iterator(m_Control + Index, m_Slots + Index, m_Control + m_Capacity);
+		}
+
+		template<typename Lookup>
+			requires IsLookup<Lookup>
+		const_iterator find(const Lookup& Name) const
+		{
+			const size_t Index = Find(Name);
+			return Index == NotFound ? end() : const_iterator(m_Control + Index, m_Slots + Index, m_Control + m_Capacity);
+		}
+
+		template<typename Lookup>
+			requires IsLookup<Lookup>
+		bool contains(const Lookup& Name) const
+		{
+			return Find(Name) != NotFound;
+		}
+
+		template<typename Lookup>
+			requires IsLookup<Lookup>
+		size_t count(const Lookup& Name) const
+		{
+			return Find(Name) != NotFound ? 1 : 0;
+		}
+
+		/**
+		 * Inserts an entry of Name, its value built from Arguments, if the map has none.
+		 * @return The entry of Name, and true if it was inserted.
+		 */
+		template<typename KeyType, typename... Args>
+		std::pair<iterator, bool> try_emplace(KeyType&& Name, Args&&... Arguments)
+		{
+			size_t Index = Find(Name);
+			if (Index != NotFound)
+				return { iterator(m_Control + Index, m_Slots + Index, m_Control + m_Capacity), false };
+
+			Index = InsertUnique(std::forward<KeyType>(Name), std::forward<Args>(Arguments)...);
+			return { iterator(m_Control + Index, m_Slots + Index, m_Control + m_Capacity), true };
+		}
+
+		template<typename KeyType, typename ValueType>
+		std::pair<iterator, bool> emplace(KeyType&& Name, ValueType&& NewValue)
+		{
+			return try_emplace(std::forward<KeyType>(Name), std::forward<ValueType>(NewValue));
+		}
+
+		std::pair<iterator, bool> insert(const value_type& Entry)
+		{
+			return try_emplace(Entry.first, Entry.second);
+		}
+
+		std::pair<iterator, bool> insert(value_type&& Entry)
+		{
+			return try_emplace(std::move(Entry.first), std::move(Entry.second));
+		}
+
+		template<typename KeyType, typename ValueType>
+		std::pair<iterator, bool> insert_or_assign(KeyType&& Name, ValueType&& NewValue)
+		{
+			std::pair<iterator, bool> Result = try_emplace(std::forward<KeyType>(Name), std::forward<ValueType>(NewValue));
+			if (!Result.second)
+			{
+				Result.first->second = std::forward<ValueType>(NewValue);
+			}
+			return Result;
+		}
+
+		/** @return The value of Name, default constructed first if the map has none. */
+		template<typename KeyType>
+		Value& operator[](KeyType&& Name)
+		{
+			return try_emplace(std::forward<KeyType>(Name)).first->second;
+		}
+
+		/** @return The value of Name, which must be in the map. */
+		template<typename Lookup>
+			requires IsLookup<Lookup>
+		Value& at(const Lookup& Name)
+		{
+			const size_t Index = Find(Name);
+			LOG_ASSERT(Index != NotFound, "FlatHashMap::at() called with a missing key.")
+			return m_Slots[Index].second;
+		}
+
+		template<typename Lookup>
+			requires IsLookup<Lookup>
+		const Value& at(const Lookup& Name) const
+		{
+			const size_t Index = Find(Name);
+			LOG_ASSERT(Index != NotFound, "FlatHashMap::at() called with a missing key.")
+			return m_Slots[Index].second;
+		}
+
+		/** @return The number of entries erased, 0 or 1. */
+		template<typename Lookup>
+			requires IsLookup<Lookup>
+		size_t erase(const Lookup& Name)
+		{
+			const size_t Index = Find(Name);
+			if (Index == NotFound)
+				return 0;
+
+			EraseAt(Index);
+			return 1;
+		}
+
+		/** @return The iterator following Position. */
+		iterator erase(const_iterator Position)
+		{
+			const size_t Index = static_cast<size_t>(Position.m_Control - m_Control);
+			EraseAt(Index);
+			iterator Next(m_Control + Index, m_Slots + Index, m_Control + m_Capacity);
+			Next.SkipFree();
+			return Next;
+		}
+
+		iterator erase(iterator Position)
+		{
+			return erase(const_iterator(Position));
+		}
+
+	private:
+		static constexpr int8_t Empty = -128;   ///< Control byte of a slot never used since the last rehash.
+		static constexpr int8_t Erased = -2;    ///< Control byte of an erased slot, which lookups probe past.
+		static constexpr size_t NotFound = ~size_t(0);
+
+		/** Bit i is set for each control byte i of a group that matched. */
+		using GroupMask = uint32_t;
+
+		/** @return The bits of the bytes of Group equal to Byte. */
+		static GroupMask Match(const int8_t* Group, int8_t Byte)
+		{
+#if defined(FGL_FLAT_MAP_SSE)
+			const __m128i Bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Group));
+			return static_cast<GroupMask>(_mm_movemask_epi8(_mm_cmpeq_epi8(Bytes, _mm_set1_epi8(Byte))));
+#elif defined(FGL_FLAT_MAP_NEON)
+			static constexpr uint8_t BitWeights[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+			const uint8x16_t Equal = vceqq_s8(vld1q_s8(Group), vdupq_n_s8(Byte));
+			const uint8x16_t Bits = vandq_u8(Equal, vld1q_u8(BitWeights));
+			return static_cast<GroupMask>(vaddv_u8(vget_low_u8(Bits))) | (static_cast<GroupMask>(vaddv_u8(vget_high_u8(Bits))) << 8);
+#else
+			GroupMask Mask = 0;
+			for (size_t Index = 0; Index < GroupSize; Index++)
+			{
+				Mask |= static_cast<GroupMask>(Group[Index] == Byte) << Index;
+			}
+			return Mask;
+#endif
+		}
+
+		/** @return The bits of the empty or erased bytes of Group, whose sign bit is set. */
+		static GroupMask MatchFree(const int8_t* Group)
+		{
+#if defined(FGL_FLAT_MAP_SSE)
+			return static_cast<GroupMask>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(Group))));
+#elif defined(FGL_FLAT_MAP_NEON)
+			static constexpr uint8_t BitWeights[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+			const uint8x16_t Free = vcltq_s8(vld1q_s8(Group), vdupq_n_s8(0));
+			const uint8x16_t Bits = vandq_u8(Free, vld1q_u8(BitWeights));
+			return static_cast<GroupMask>(vaddv_u8(vget_low_u8(Bits))) | (static_cast<GroupMask>(vaddv_u8(vget_high_u8(Bits))) << 8);
+#else
+			GroupMask Mask = 0;
+			for (size_t Index = 0; Index < GroupSize; Index++)
+			{
+				Mask |= static_cast<GroupMask>(Group[Index] < 0) << Index;
+			}
+			return Mask;
+#endif
+		}
+
+		/** @return The 7 bits of Hashed kept in the control byte of its entry. */
+		static int8_t ControlByte(size_t Hashed)
+		{
+			return static_cast<int8_t>(Hashed & 0x7F);
+		}
+
+		/** @return The entries a table of Capacity slots holds, 7/8 of them. */
+		static size_t MaxLoad(size_t Capacity)
+		{
+			return Capacity - Capacity / 8;
+		}
+
+		/** @return The smallest power of two capacity, at least a group, holding Count entries. */
+		static size_t CapacityFor(size_t Count)
+		{
+			size_t Capacity = GroupSize;
+			while (MaxLoad(Capacity) < Count)
+			{
+				Capacity *= 2;
+			}
+			return Capacity;
+		}
+
+		/**
+		 * Visits the groups of the probe sequence of Hashed until Visitor returns true: the group the hash selects,
+		 * then the following ones at triangular offsets, which reaches every group once the group count is a power
+		 * of two.
+		 */
+		template<typename Visitor>
+		void Probe(size_t Hashed, Visitor&& Visit) const
+		{
+			const size_t GroupMaskBits = m_Capacity / GroupSize - 1;
+			size_t Group = (Hashed >> 7) & GroupMaskBits;
+			for (size_t Step = 1; ; Step++)
+			{
+				if (Visit(Group * GroupSize))
+					return;
+				Group = (Group + Step) & GroupMaskBits;
+			}
+		}
+
+		/** @return The slot of the entry of Name, NotFound if none. */
+		template<typename Lookup>
+		size_t Find(const Lookup& Name) const
+		{
+			if (m_Size == 0)
+				return NotFound;
+
+			const size_t Hashed = Hash()(Name);
+			const int8_t Byte = ControlByte(Hashed);
+			size_t Found = NotFound;
+			Probe(Hashed, [&](size_t First)
+			{
+				for (GroupMask Mask = Match(m_Control + First, Byte); Mask != 0; Mask &= Mask - 1)
+				{
+					const size_t Index = First + static_cast<size_t>(std::countr_zero(Mask));
+					if (Equal()(m_Slots[Index].first, Name))
+					{
+						Found = Index;
+						return true;
+					}
+				}
+				// An empty slot ends the search, the key would have been placed there
+				return Match(m_Control + First, Empty) != 0;
+			});
+			return Found;
+		}
+
+		/** @return The first empty or erased slot of the probe sequence of Hashed, the table having one. */
+		size_t FindFree(size_t Hashed) const
+		{
+			size_t Found = NotFound;
+			Probe(Hashed, [&](size_t First)
+			{
+				const GroupMask Mask = MatchFree(m_Control + First);
+				if (Mask == 0)
+					return false;
+				Found = First + static_cast<size_t>(std::countr_zero(Mask));
+				return true;
+			});
+			return Found;
+		}
+
+		/** Inserts an entry of Name, which the map doesn't have. @return Its slot. */
+		template<typename KeyType, typename... Args>
+		size_t InsertUnique(KeyType&& Name, Args&&... Arguments)
+		{
+			// Erased slots count as used until a rehash drops them, so that a probe always meets an empty slot;
+			// a table mostly made of them is rebuilt at the same capacity
+			if (m_Size + m_Erased + 1 > MaxLoad(m_Capacity))
+			{
+				Rehash(m_Size + 1 > MaxLoad(m_Capacity) / 2 ? std::max(m_Capacity * 2, GroupSize) : m_Capacity);
+			}
+
+			const size_t Hashed = Hash()(Name);
+			const size_t Index = FindFree(Hashed);
+			if (m_Control[Index] == Erased)
+			{
+				m_Erased--;
+			}
+			std::construct_at(m_Slots + Index, std::piecewise_construct, std::forward_as_tuple(std::forward<KeyType>(Name)),
+				std::forward_as_tuple(std::forward<Args>(Arguments)...));
+			m_Control[Index] = ControlByte(Hashed);
+			m_Size++;
+			return Index;
+		}
+
+		void EraseAt(size_t Index)
+		{
+			std::destroy_at(m_Slots + Index);
+			m_Size--;
+
+			// A group with an empty slot ends every probe reaching it, so the slot needs no tombstone
+			const size_t First = Index & ~(GroupSize - 1);
+			if (Match(m_Control + First, Empty) != 0)
+			{
+				m_Control[Index] = Empty;
+			}
+			else
+			{
+				m_Control[Index] = Erased;
+				m_Erased++;
+			}
+		}
+
+		/** Moves every entry to a table of Capacity slots, a power of two of at least GroupSize. */
+		void Rehash(size_t Capacity)
+		{
+			int8_t* OldControl = m_Control;
+			value_type* OldSlots = m_Slots;
+			const size_t OldCapacity = m_Capacity;
+
+			m_Control = static_cast<int8_t*>(::operator new(Capacity));
+			m_Slots = std::allocator<value_type>().allocate(Capacity);
+			m_Capacity = Capacity;
+			m_Erased = 0;
+			std::memset(m_Control, Empty, Capacity);
+
+			for (size_t Index = 0; Index < OldCapacity; Index++)
+			{
+				if (OldControl[Index] >= 0)
+				{
+					value_type& Entry = OldSlots[Index];
+					const size_t Hashed = Hash()(Entry.first);
+					const size_t Target = FindFree(Hashed);
+					std::construct_at(m_Slots + Target, std::move(Entry));
+					m_Control[Target] = ControlByte(Hashed);
+					std::destroy_at(&Entry);
+				}
+			}
+
+			if (OldControl)
+			{
+				::operator delete(OldControl);
+				std::allocator<value_type>().deallocate(OldSlots, OldCapacity);
+			}
+		}
+
+		/** Destroys every entry and frees the table. */
+		void Release()
+		{
+			if (m_Control)
+			{
+				clear();
+				::operator delete(m_Control);
+				std::allocator<value_type>().deallocate(m_Slots, m_Capacity);
+			}
+			m_Control = nullptr;
+			m_Slots = nullptr;
+			m_Capacity = 0;
+		}
+
+		void Swap(FlatHashMap& Other) noexcept
+		{
+			std::swap(m_Control, Other.m_Control);
+			std::swap(m_Slots, Other.m_Slots);
+			std::swap(m_Capacity, Other.m_Capacity);
+			std::swap(m_Size, Other.m_Size);
+			std::swap(m_Erased, Other.m_Erased);
+		}
+
+		int8_t* m_Control = nullptr;     ///< Control byte of each slot: the hash's low 7 bits if full, else Empty or Erased.
+		value_type* m_Slots = nullptr;   ///< Entries, constructed in the full slots only.
+		size_t m_Capacity = 0;           ///< Slots, 0 or a power of two of at least GroupSize.
+		size_t m_Size = 0;               ///< Full slots.
+		size_t m_Erased = 0;             ///< Erased slots, reclaimed by the next rehash.
+	};
+
+} // namespace fgl
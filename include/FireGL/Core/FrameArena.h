@@ -0,0 +1,73 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+
+#include <memory_resource>
+#include <optional>
+
+namespace fgl
+{
+
+	/**
+	 * Double-buffered linear allocator for data that only lives for one frame.
+	 *
+	 * GetResource() hands out a std::pmr::memory_resource that bumps a pointer through a preallocated buffer;
+	 * deallocations are no-ops and the whole buffer is reset by BeginFrame(). Two buffers alternate, so what a
+	 * frame allocated stays valid during the next one. When a frame outgrows its buffer the extra memory comes
+	 * from the heap, and the buffer is enlarged the next time it is reset: steady-state frames allocate nothing.
+	 */
+	class FrameArena
+	{
+	public:
+		/**
+		 * Allocates both buffers.
+		 *
+		 * @param InitialSize The size of each buffer in bytes.
+		 */
+		explicit FrameArena(size_t InitialSize = 256 * 1024);
+
+		FrameArena(const FrameArena&) = delete;
+		FrameArena& operator=(const FrameArena&) = delete;
+
+		/**
+		 * Switches to the other buffer and resets it, invalidating what was allocated two frames ago.
+		 * The buffer is enlarged first if its last frame overflowed it.
+		 */
+		void BeginFrame();
+
+		/** @return The memory resource of the current frame, for std::pmr containers. */
+		std::pmr::memory_resource* GetResource();
+
+		/** @return The size in bytes of the current frame's buffer. */
+		size_t GetCapacity() const;
+
+	private:
+		/** Forwards to the heap, counting the bytes a frame needed beyond its buffer. */
+		class OverflowResource : public std::pmr::memory_resource
+		{
+		public:
+			size_t OverflowBytes = 0; ///< Bytes requested since the last reset.
+
+		private:
+			void* do_allocate(size_t Bytes, size_t Alignment) override;
+			void do_deallocate(void* Pointer, size_t Bytes, size_t Alignment) override;
+			bool do_is_equal(const std::pmr::memory_resource& Other) const noexcept override;
+		};
+
+		/** One frame's storage. */
+		struct FrameBuffer
+		{
+			std::unique_ptr<std::byte[]> Memory;
+			size_t Size = 0;
+			OverflowResource Overflow;
+			std::optional<std::pmr::monotonic_buffer_resource> Resource;
+		};
+
+		/** Creates the memory resource of a buffer over its current memory. */
+		static void CreateResource(FrameBuffer& Buffer);
+
+		FrameBuffer m_Buffers[2]; ///< The alternating frame buffers.
+		size_t m_Current = 0;     ///< Buffer of the current frame.
+	};
+
+} // namespace fgl
\ No newline at end of file
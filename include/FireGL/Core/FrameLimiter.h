@@ -0,0 +1,58 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+
+#include <chrono>
+
+namespace fgl
+{
+
+	/**
+	 * Caps the frame rate by waiting until each frame's deadline on a steady high-resolution clock.
+	 *
+	 * Deadlines are spaced by the target period from the previous deadline rather than from when the frame ended,
+	 * so frames are evenly paced and the average rate matches the target. A frame that ends more than a period
+	 * late restarts the schedule instead of running the next frames back to back to catch up.
+	 *
+	 * Waiting is hybrid: the thread sleeps until shortly before the deadline, then spins for the rest. Sleeps
+	 * wake up late by up to the OS timer resolution (about 1 ms on Linux and macOS, up to 15.6 ms on Windows
+	 * without a raised timer resolution), so the spin margin follows the largest oversleep measured recently.
+	 * Sleeping most of the frame keeps the CPU idle, spinning the end keeps the deadline to a few microseconds.
+	 */
+	class FrameLimiter
+	{
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		/**
+		 * Sets the frame rate to hold.
+		 *
+		 * @param FramesPerSecond The cap, zero or less to never wait.
+		 */
+		void SetTargetFrameRate(double FramesPerSecond);
+
+		/** @return The frame rate held, zero without a cap. */
+		double GetTargetFrameRate() const;
+
+		/** @return True if a cap is set. */
+		bool IsEnabled() const;
+
+		/** Waits until the deadline of the current frame, then schedules the next one. Returns at once without a cap. */
+		void Wait();
+
+		/** @return The time the last Wait() spent sleeping and spinning, in seconds. */
+		double GetLastWaitTime() const;
+
+	private:
+		/** Sleeps until shortly before Deadline, measuring how late the sleep woke up. */
+		void SleepUntil(Clock::time_point Deadline);
+
+		Clock::duration m_Period{ 0 };                                      ///< Time between two deadlines, zero without a cap.
+		Clock::time_point m_NextDeadline;                                   ///< When the current frame may end.
+		Clock::duration m_SpinMargin = std::chrono::microseconds(2000);     ///< Time before the deadline spent spinning instead of sleeping.
+		Clock::duration m_WorstOversleep{ 0 };                              ///< Largest oversleep since the margin was last adjusted.
+		uint32_t m_SleepCount = 0;                                          ///< Sleeps since the margin was last adjusted.
+		double m_LastWaitTime = 0.0;                                        ///< Time the last Wait() blocked, in seconds.
+	};
+
+} // namespace fgl
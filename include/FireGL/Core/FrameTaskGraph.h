@@ -0,0 +1,115 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+namespace fgl
+{
+	class JobSystem;
+	struct JobCounter;
+
+	/** Thread a task of a FrameTaskGraph runs on. */
+	enum class TaskAffinity
+	{
+		Any,        ///< Any JobSystem worker.
+		MainThread  ///< The thread calling FrameTaskGraph::Run(), e.g. for the OpenGL calls and the window's events.
+	};
+
+	/**
+	 * The stages of a frame and their dependencies, run across the workers of a JobSystem.
+	 *
+	 * A frame's work is declared once as tasks, e.g. input, simulation, animation, transform propagation, culling,
+	 * instance generation, command recording and submission, each naming the tasks it must run after. Run() then
+	 * executes one frame: every task starts as soon as the tasks it depends on are done, so independent stages
+	 * overlap without the main loop ordering them by hand, and stages added later find their place from their
+	 * dependencies alone.
+	 *
+	 * Tasks with TaskAffinity::MainThread run on the thread calling Run(), which waits for them in between;
+	 * the others are scheduled on the JobSystem. A task becomes ready once all its dependencies finished, whatever
+	 * their threads, so a worker task may follow a main thread task and the reverse. The graph is checked for
+	 * cycles when first run after a change. Tasks must not throw, and two tasks writing the same data need a
+	 * dependency between them. Tasks must not be added while Run() is in progress.
+	 */
+	class FrameTaskGraph
+	{
+	public:
+		using TaskId = uint32_t;
+		using Task = std::function<void()>;
+
+		static constexpr TaskId InvalidTask = UINT32_MAX; ///< No task.
+
+		FrameTaskGraph() = default;
+
+		FrameTaskGraph(const FrameTaskGraph&) = delete;
+		FrameTaskGraph& operator=(const FrameTaskGraph&) = delete;
+
+		/**
+		 * Declares a task, run once by every Run().
+		 *
+		 * @param Name The name of the task, its Profiler zone.
+		 * @param Body The work of the task.
+		 * @param Dependencies The tasks it runs after, declared before it.
+		 * @param Affinity The thread it runs on.
+		 * @return The id of the task.
+		 */
+		TaskId AddTask(std::string_view Name, Task Body, std::initializer_list<TaskId> Dependencies = {}, TaskAffinity Affinity = TaskAffinity::Any);
+
+		/**
+		 * Makes a task run after another one, e.g. to order tasks declared by different systems.
+		 *
+		 * @param Dependent The task that waits.
+		 * @param Dependency The task it waits for.
+		 */
+		void AddDependency(TaskId Dependent, TaskId Dependency);
+
+		/** Removes every task. */
+		void Clear();
+
+		/**
+		 * Runs every task once, in dependency order, and returns when all finished.
+		 *
+		 * @param Jobs The job system running the tasks without affinity.
+		 */
+		void Run(JobSystem& Jobs);
+
+		/** @return The id of the task with a name, InvalidTask if none. */
+		TaskId FindTask(std::string_view Name) const;
+
+		/** @return The number of tasks. */
+		size_t GetTaskCount() const;
+
+	private:
+		/** A declared task. */
+		struct Node
+		{
+			std::string Name;                   ///< Profiler zone of the task.
+			Task Body;                          ///< Work of the task.
+			TaskAffinity Affinity;              ///< Thread it runs on.
+			std::vector<TaskId> Dependents;     ///< Tasks waiting for it.
+			uint32_t DependencyCount = 0;       ///< Tasks it waits for.
+		};
+
+		/** Asserts the graph has no cycle, with Kahn's algorithm. */
+		void Validate() const;
+
+		/** Runs a task, then releases the dependents it was the last dependency of. */
+		void Execute(TaskId Id, JobSystem& Jobs);
+
+		/** Schedules a ready task on its thread. */
+		void Dispatch(TaskId Id, JobSystem& Jobs);
+
+		std::vector<Node> m_Nodes;                                  ///< Every task, by id.
+		std::unique_ptr<std::atomic<uint32_t>[]> m_Remaining;       ///< Unfinished dependencies of every task during Run().
+		size_t m_RemainingSize = 0;                                 ///< Entries of m_Remaining.
+		bool m_bValidated = false;                                  ///< Whether the graph was checked since its last change.
+		std::mutex m_Mutex;                                         ///< Guards the main thread queue and m_Finished.
+		std::condition_variable m_Condition;                        ///< Wakes Run() when a main thread task is ready or all finished.
+		std::vector<TaskId> m_MainQueue;                            ///< Ready main thread tasks.
+		size_t m_Finished = 0;                                      ///< Tasks done in the current Run().
+		JobCounter* m_Counter = nullptr;                            ///< Worker tasks of the current Run().
+	};
+
+} // namespace fgl
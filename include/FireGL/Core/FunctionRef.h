@@ -0,0 +1,107 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+
+namespace fgl
+{
+
+	template<typename Signature>
+	class FunctionRef;
+
+	/**
+	 * Non-owning reference to a callable, two pointers wide: calling it costs one indirect call, and creating
+	 * it never allocates, unlike a std::function whose captures outgrow its small buffer.
+	 *
+	 * It refers to, in order of preference:
+	 * - a free function or a captureless lambda, converted to a function pointer and safe to keep;
+	 * - a member function of an object, through Bind<&Class::Method>(Object), valid while the object lives;
+	 * - any other callable lvalue, e.g. a capturing lambda stored in a member, valid while the callable lives.
+	 *
+	 * Temporary capturing lambdas are rejected at compile time, the reference would dangle right away.
+	 */
+	template<typename R, typename... Args>
+	class FunctionRef<R(Args...)>
+	{
+	public:
+		using FunctionPointer = R(*)(Args...);
+
+		FunctionRef() = default;
+
+		/** @param Function A free function, or nullptr for an empty reference. */
+		FunctionRef(FunctionPointer Function)
+		{
+			if (Function)
+			{
+				m_Target.Function = Function;
+				m_Invoke = &InvokeFunction;
+			}
+		}
+
+		/** @param Lambda A captureless lambda, referred to through its function pointer. */
+		template<typename Callable>
+			requires (!std::is_same_v<std::decay_t<Callable>, FunctionRef> && std::is_convertible_v<Callable, FunctionPointer>)
+		FunctionRef(Callable&& Lambda)
+			: FunctionRef(static_cast<FunctionPointer>(Lambda))
+		{
+		}
+
+		/** @param Object A callable that must outlive the reference. */
+		template<typename Callable>
+			requires (!std::is_same_v<std::remove_const_t<Callable>, FunctionRef> && !std::is_convertible_v<Callable&, FunctionPointer>
+				&& std::is_invocable_r_v<R, Callable&, Args...>)
+		FunctionRef(Callable& Object)
+		{
+			m_Target.Object = const_cast<void*>(static_cast<const void*>(&Object));
+			m_Invoke = [](const Target& Stored, Args... Arg) -> R
+			{
+				return std::invoke(*static_cast<Callable*>(Stored.Object), std::forward<Args>(Arg)...);
+			};
+		}
+
+		/**
+		 * @tparam Method The member function to call.
+		 * @param Object The object to call it on, which must outlive the reference.
+		 * @return A reference calling Object->Method().
+		 */
+		template<auto Method, typename Class>
+		static FunctionRef Bind(Class* Object)
+		{
+			FunctionRef Bound;
+			Bound.m_Target.Object = const_cast<void*>(static_cast<const void*>(Object));
+			Bound.m_Invoke = [](const Target& Stored, Args... Arg) -> R
+			{
+				return std::invoke(Method, static_cast<Class*>(Stored.Object), std::forward<Args>(Arg)...);
+			};
+			return Bound;
+		}
+
+		/** Calls the referred callable, which must be set. */
+		R operator()(Args... Arg) const
+		{
+			return m_Invoke(m_Target, std::forward<Args>(Arg)...);
+		}
+
+		/** @return True if the reference is set. */
+		explicit operator bool() const
+		{
+			return m_Invoke != nullptr;
+		}
+
+	private:
+		/** A function pointer can't portably be stored in a void*, the two live side by side. */
+		union Target
+		{
+			void* Object = nullptr;       ///< The callable object, or the object of a member function.
+			FunctionPointer Function;     ///< The free function.
+		};
+
+		static R InvokeFunction(const Target& Bound, Args... Arg)
+		{
+			return Bound.Function(std::forward<Args>(Arg)...);
+		}
+
+		Target m_Target;                                  ///< What is called.
+		R(*m_Invoke)(const Target&, Args...) = nullptr;   ///< Calls m_Target with the arguments, nullptr if empty.
+	};
+
+} // namespace fgl
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+
+#include <External/glad/glad.h>
+
+namespace fgl
+{
+
+	/**
+	 * Annotations for GPU capture tools such as RenderDoc or Nsight, through KHR_debug (core in OpenGL 4.3).
+	 *
+	 * Debug groups nest the calls of every renderer pass and batch under a name, object labels name the vertex
+	 * arrays, buffers, textures and programs after their owner or asset path, and the message callback logs the
+	 * driver's errors and warnings. Without KHR_debug, e.g. on an OpenGL 4.1 context, every call does nothing.
+	 *
+	 * The renderer calls these through the FGL_GL_* macros below, which compile to nothing unless the
+	 * FIREGL_ENABLE_GL_DEBUG CMake option is on, and never in Release builds: their arguments aren't even evaluated.
+	 */
+	class GLDebug
+	{
+	public:
+		/**
+		 * Loads the KHR_debug entry points of the current context. Called by the window once the loader is initialized.
+		 *
+		 * @param bMessageCallback True to log the messages of the driver, which needs a debug context
+		 *        (GLFW_OPENGL_DEBUG_CONTEXT, requested by the window when FIREGL_ENABLE_GL_DEBUG is on) on most drivers.
+		 * @return True if KHR_debug is available.
+		 */
+		static bool Initialize(bool bMessageCallback);
+
+		/** @return True if the calls below reach the driver. */
+		static bool IsAvailable();
+
+		/**
+		 * Opens a debug group, shown as a folder of calls by capture tools. Groups nest, each must be closed.
+		 *
+		 * @param Name The name of the group, copied by the driver.
+		 */
+		static void PushGroup(std::string_view Name);
+
+		/** Closes the innermost debug group. */
+		static void PopGroup();
+
+		/**
+		 * Names an OpenGL object.
+		 *
+		 * @param Identifier GL_BUFFER, GL_TEXTURE, GL_VERTEX_ARRAY, GL_PROGRAM, GL_FRAMEBUFFER...
+		 * @param Object The name of the object, which must have been bound or created once.
+		 * @param Label The label, truncated to the driver's maximum length.
+		 */
+		static void Label(GLenum Identifier, GLuint Object, std::string_view Label);
+
+	private:
+		static bool s_bAvailable;   ///< Whether KHR_debug was found by Initialize().
+		static GLint s_MaxLabel;    ///< Longest label the driver takes, terminator included.
+	};
+
+	/** Opens a debug group for its scope. */
+	class GLDebugGroup
+	{
+	public:
+		explicit GLDebugGroup(std::string_view Name) { GLDebug::PushGroup(Name); }
+		~GLDebugGroup() { GLDebug::PopGroup(); }
+
+		GLDebugGroup(const GLDebugGroup&) = delete;
+		GLDebugGroup& operator=(const GLDebugGroup&) = delete;
+	};
+
+} // namespace fgl
+
+#if defined(FIREGL_ENABLE_GL_DEBUG)
+#define FGL_GL_DEBUG_CONCAT_INNER(A, B) A##B
+#define FGL_GL_DEBUG_CONCAT(A, B) FGL_GL_DEBUG_CONCAT_INNER(A, B)
+#define FGL_GL_DEBUG_GROUP(Name) ::fgl::GLDebugGroup FGL_GL_DEBUG_CONCAT(GLDebugGroup_, __LINE__)(Name);
+#define FGL_GL_PUSH_GROUP(Name) ::fgl::GLDebug::PushGroup(Name);
+#define FGL_GL_POP_GROUP() ::fgl::GLDebug::PopGroup();
+#define FGL_GL_LABEL(Identifier, Object, Text) ::fgl::GLDebug::Label(Identifier, Object, Text);
+#else
+#define FGL_GL_DEBUG_GROUP(Name)
+#define FGL_GL_PUSH_GROUP(Name)
+#define FGL_GL_POP_GROUP()
+#define FGL_GL_LABEL(Identifier, Object, Text)
+#endif
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+
+#include <External/glad/glad.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+struct GLFWwindow;
+
+namespace fgl
+{
+
+	/**
+	 * Background thread owning a hidden OpenGL context shared with the window, running resource uploads.
+	 *
+	 * Objects live in the share group of both contexts, so a texture or buffer whose name was generated on the
+	 * main thread can be filled here while the main thread keeps rendering. After each upload the thread inserts a
+	 * glFenceSync() and flushes; IsComplete() polls those fences on the main context, and only once an upload's fence
+	 * signalled may the main context use what it wrote.
+	 *
+	 * Uploads run with no GLStateCache, PixelUploadPool or GPUMemoryTracker: those are bound to the main context and
+	 * not thread-safe, so upload functions call OpenGL directly and memory is tracked by the main thread.
+	 */
+	class GLUploadThread
+	{
+	public:
+		GLUploadThread() = default;
+		GLUploadThread(const GLUploadThread&) = delete;
+		GLUploadThread& operator=(const GLUploadThread&) = delete;
+
+		/** Stops the thread if it still runs. */
+		~GLUploadThread();
+
+		/**
+		 * Creates a hidden window sharing SharedWith's context and starts the thread, which makes it current.
+		 * Must run on the main thread, as every GLFW window creation.
+		 *
+		 * @param SharedWith The window whose objects the uploads create.
+		 * @return False if the shared context couldn't be created, uploads then have to stay on the main thread.
+		 */
+		bool Start(GLFWwindow* SharedWith);
+
+		/** Runs the queued uploads and waits for their fences, then stops the thread and destroys its hidden window. */
+		void Stop();
+
+		/** @return True between a successful Start() and Stop(). */
+		bool IsRunning() const;
+
+		/**
+		 * Queues an upload, uploads run one after another in submission order.
+		 *
+		 * @param Upload The GL calls of the upload, run on the upload thread. It must bind its objects itself
+		 *               and leave no binding behind.
+		 * @return The ticket IsComplete() and Wait() take.
+		 */
+		uint64_t Enqueue(std::function<void()> Upload);
+
+		/**
+		 * Checks without blocking whether the GPU finished an upload. Must run on the thread owning the main context.
+		 *
+		 * @param Ticket Returned by Enqueue().
+		 * @return True once the fence of the upload and of every earlier one signalled.
+		 */
+		bool IsComplete(uint64_t Ticket);
+
+		/** Blocks until IsComplete(Ticket), e.g. before a texture is needed for the first time. */
+		void Wait(uint64_t Ticket);
+
+	private:
+		/** Ticket of a finished upload and the fence following its commands. */
+		struct Fence
+		{
+			uint64_t Ticket; ///< Upload the fence follows.
+			GLsync Sync;     ///< Signalled once its commands completed on the GPU.
+		};
+
+		/** Body of the upload thread. */
+		void Run();
+
+		/** Deletes the signalled fences in ticket order. Waits up to TimeoutNanoseconds for the first one. */
+		void PollFences(uint64_t TimeoutNanoseconds);
+
+		GLFWwindow* m_Context = nullptr;                      ///< Hidden window holding the shared context.
+		std::thread m_Thread;                                 ///< The upload thread.
+		std::mutex m_Mutex;                                   ///< Guards the members below.
+		std::condition_variable m_Condition;                  ///< Signalled on new uploads, finished uploads and Stop().
+		std::deque<std::pair<uint64_t, std::function<void()>>> m_Uploads; ///< Queued uploads by ticket.
+		std::deque<Fence> m_Fences;                           ///< Fences of run uploads, not signalled yet as far as known.
+		uint64_t m_NextTicket = 1;                            ///< Ticket of the next Enqueue().
+		uint64_t m_SubmittedTicket = 0;                       ///< Last upload whose fence was inserted.
+		uint64_t m_CompletedTicket = 0;                       ///< Last upload whose fence signalled.
+		bool m_bStopping = false;                             ///< Set by Stop().
+	};
+
+} // namespace fgl
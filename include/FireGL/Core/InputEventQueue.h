@@ -0,0 +1,115 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+
+#include <External/glm/vec2.hpp>
+
+namespace fgl
+{
+
+	/** What an InputEvent reports. */
+	enum class InputEventType : uint8_t
+	{
+		Key,         ///< A key was pressed or released: Code, Action and Mods are set.
+		MouseButton, ///< A mouse button was pressed or released: Code, Action and Mods are set.
+		CursorMove,  ///< The cursor moved: X and Y are the offset from the previous position.
+		Scroll       ///< The wheel or touchpad scrolled: X and Y are the scroll offsets.
+	};
+
+	/** One input event, as GLFW delivered it. */
+	struct InputEvent
+	{
+		InputEventType Type = InputEventType::Key; ///< Selects the fields that are set.
+		double Time = 0.0;                         ///< When the callback ran, in seconds on the glfwGetTime() clock.
+		int Code = 0;                              ///< GLFW_KEY_... or GLFW_MOUSE_BUTTON_... constant.
+		int Action = 0;                            ///< GLFW_PRESS, GLFW_RELEASE or GLFW_REPEAT.
+		int Mods = 0;                              ///< GLFW_MOD_... bits.
+		double X = 0.0;                            ///< Horizontal cursor offset or scroll offset.
+		double Y = 0.0;                            ///< Vertical cursor offset or scroll offset.
+	};
+
+	/**
+	 * Fixed-size ring buffer of the input events received since they were last consumed, in the order GLFW delivered them.
+	 *
+	 * The BaseWindow callbacks push every key, mouse button, cursor and scroll event with the time the callback ran,
+	 * so code can tell the order and spacing of the events within a frame. Cursor offsets are also summed apart from
+	 * the ring: ConsumeMouseDelta() returns every movement since its last call even when the ring overflowed. When the
+	 * ring is full the oldest event is dropped and counted.
+	 *
+	 * GLFW runs its callbacks on the main thread while polling events, the queue isn't thread-safe.
+	 */
+	class InputEventQueue
+	{
+	public:
+		static constexpr size_t Capacity = 256; ///< Events kept before the oldest are dropped.
+
+		/** Appends an event, dropping the oldest one when the ring is full. */
+		void Push(const InputEvent& Event);
+
+		/** Records a key event at the current time. */
+		void PushKey(int Key, int Action, int Mods);
+
+		/** Records a mouse button event at the current time. */
+		void PushMouseButton(int Button, int Action, int Mods);
+
+		/**
+		 * Records a cursor position as its offset from the previous one and adds it to the mouse delta.
+		 * The first position after ResetCursor() only sets the reference.
+		 */
+		void PushCursorPosition(double XPos, double YPos);
+
+		/** Records a scroll event at the current time. */
+		void PushScroll(double XOffset, double YOffset);
+
+		/** Forgets the previous cursor position, so a jump (e.g. after regaining focus) isn't reported as movement. */
+		void ResetCursor();
+
+		/**
+		 * Removes the oldest event.
+		 *
+		 * @param Event Receives the event.
+		 * @return False if the queue is empty.
+		 */
+		bool Pop(InputEvent& Event);
+
+		/** Removes every event, passing them oldest first to Callback. */
+		template<typename Callable>
+		void Consume(Callable&& Callback)
+		{
+			InputEvent Event;
+			while (Pop(Event))
+			{
+				Callback(Event);
+			}
+		}
+
+		/** Discards every queued event, the mouse delta is kept. */
+		void Clear();
+
+		/**
+		 * Returns the cursor movement summed since the last call, and resets it.
+		 *
+		 * @return The horizontal and vertical offsets, in screen coordinates.
+		 */
+		glm::dvec2 ConsumeMouseDelta();
+
+		/** @return The number of queued events. */
+		size_t GetSize() const { return m_Size; }
+
+		/** @return True if no event is queued. */
+		bool IsEmpty() const { return m_Size == 0; }
+
+		/** @return The number of events dropped because the ring was full, since the queue was created. */
+		uint64_t GetDroppedCount() const { return m_Dropped; }
+
+	private:
+		std::array<InputEvent, Capacity> m_Events; ///< The ring.
+		size_t m_First = 0;                        ///< Index of the oldest event.
+		size_t m_Size = 0;                         ///< Queued events.
+		uint64_t m_Dropped = 0;                    ///< Events overwritten while the ring was full.
+		glm::dvec2 m_MouseDelta{ 0.0 };            ///< Cursor movement since the last ConsumeMouseDelta().
+		glm::dvec2 m_LastCursor{ 0.0 };            ///< Previous cursor position.
+		bool m_bHasCursor = false;                 ///< False until a position was recorded after ResetCursor().
+	};
+
+} // namespace fgl
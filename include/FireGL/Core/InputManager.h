@@ -4,6 +4,11 @@
 #include <FireGL/Core/Window.h>
 #include <FireGL/Core/BaseSingletonManager.h>
 #include <FireGL/Core/BaseLog.h>
+#include <FireGL/Core/InputEventQueue.h>
+#include <FireGL/Core/InputRecording.h>
+#include <FireGL/Core/FunctionRef.h>
+
+#include <bitset>
 
 namespace fgl 
 {
@@ -16,6 +21,9 @@ namespace fgl
 		OnReleased		///< Triggered when the key is released.
 	};
 
+	/** Index of an action of the InputManager, see InputManager::AddAction(). */
+	using InputAction = uint32_t;
+
 	/**
 	 * @class InputManager
 	 * @brief Manages and processes input events for various devices (keyboard, mouse, joystick).
@@ -32,10 +40,32 @@ namespace fgl
 	 *   player-related functions (e.g., jump, move) based on the registered input events.
 	 *
 	 * @note For all key events, you must use GLFW key constants like GLFW_KEY_A, GLFW_KEY_B, etc., from GLFW itself.
+	 *
+	 * Keys, mouse buttons and the buttons of the first gamepad share one space of input codes: a key is its GLFW_KEY_...
+	 * constant, MouseButton() and GamepadButton() give the codes of the others. Actions name what the player does
+	 * ("Jump", "Fire") rather than which input does it: AddAction() creates one, BindAction() maps input codes to it,
+	 * and IsActionPressed() or the callbacks of SetActionCallback() report it. Bindings are chained per input code in
+	 * dense arrays, so a frame only walks the bindings of the inputs that changed since the previous one, and
+	 * callbacks are FunctionRefs, which never allocate.
+	 *
+	 * StartRecording() and StopRecording() save a play session to a file, StartReplay() plays it back: the recorded
+	 * inputs are delivered at the same points of the same frames, and TimeManager::Update() hands out the recorded
+	 * delta times, so the Scene and the Renderer go through the same frames on every run.
 	 */
 	class InputManager : public BaseSingletonManager
 	{
 	public:
+		static constexpr int MouseButtonCodes = GLFW_KEY_LAST + 1;                                 ///< Code of the first mouse button.
+		static constexpr int GamepadButtonCodes = MouseButtonCodes + GLFW_MOUSE_BUTTON_LAST + 1;   ///< Code of the first gamepad button.
+		static constexpr int InputCodeCount = GamepadButtonCodes + GLFW_GAMEPAD_BUTTON_LAST + 1;   ///< Keys, mouse and gamepad buttons.
+		static constexpr InputAction InvalidAction = UINT32_MAX;                                   ///< Returned by FindAction() for unknown names.
+
+		/** @return The input code of a GLFW_MOUSE_BUTTON_... constant. */
+		static constexpr int MouseButton(int Button) { return MouseButtonCodes + Button; }
+
+		/** @return The input code of a GLFW_GAMEPAD_BUTTON_... constant, read from the first gamepad (GLFW_JOYSTICK_1). */
+		static constexpr int GamepadButton(int Button) { return GamepadButtonCodes + Button; }
+
 		/**
 		 * @brief Initializes the InputManager.
 		 *
@@ -59,9 +89,120 @@ namespace fgl
 		 *
 		 * This function should be called at the end of each frame to perform any necessary cleanup
 		 * and finalize the input state, including polling events and swapping buffers.
+		 * The buffers aren't swapped while the window's render thread runs, its frames swap them.
+		 * While the window isn't presentable (see BaseWindow::IsPresentable()) nothing is swapped and events are
+		 * waited for, up to the window's idle event timeout, instead of polled.
 		 */		
 		void FinalizeInput();
 
+		/**
+		 * @brief Polls GLFW for the input received since the last poll.
+		 *
+		 * Call it right before latency-sensitive work, e.g. updating the camera just before rendering, to act on
+		 * input that arrived after ProcessInput(). The new events land in GetInputEvents() and the virtual handlers.
+		 */
+		void PollLatestInput();
+
+		/**
+		 * @brief Retrieves the timestamped events of every key, mouse button, cursor and scroll callback.
+		 *
+		 * Nothing consumes them by default; events left in the queue are dropped oldest first once it is full.
+		 */
+		InputEventQueue& GetInputEvents();
+
+		/**
+		 * @brief Creates an action, bound to no input yet.
+		 *
+		 * @param Name The name of the action, e.g. to find it from gameplay code with FindAction().
+		 * @return The index of the action, valid for the lifetime of the input manager.
+		 */
+		InputAction AddAction(std::string_view Name);
+
+		/** @return The action of a name, InvalidAction if there is none. */
+		InputAction FindAction(std::string_view Name) const;
+
+		/**
+		 * @brief Maps an input to an action; an action is down while any of its inputs is down.
+		 *
+		 * @param Action The action returned by AddAction().
+		 * @param Code A GLFW_KEY_... constant, or a code from MouseButton() or GamepadButton().
+		 */
+		void BindAction(InputAction Action, int Code);
+
+		/**
+		 * @brief Removes a mapping made by BindAction(), nothing if there is none.
+		 *
+		 * @param Action The action returned by AddAction().
+		 * @param Code The input code it was bound to.
+		 */
+		void UnbindAction(InputAction Action, int Code);
+
+		/**
+		 * @brief Sets the function called when an action is pressed, every frame it is held, or when it is released.
+		 *
+		 * @param Action The action returned by AddAction().
+		 * @param EventType When the callback runs.
+		 * @param Callback A free function, a captureless lambda or a FunctionRef::Bind() of a member function; an empty
+		 *        reference removes the callback. It must outlive the binding.
+		 */
+		void SetActionCallback(InputAction Action, KeyEventType EventType, FunctionRef<void()> Callback);
+
+		/** @return True if the action went down this frame. */
+		bool IsActionPressed(InputAction Action) const;
+
+		/** @return True if the action is down this frame. */
+		bool IsActionTriggered(InputAction Action) const;
+
+		/** @return True if the action went up this frame. */
+		bool IsActionReleased(InputAction Action) const;
+
+		/**
+		 * @brief Starts recording the inputs and the frame times, until StopRecording().
+		 *
+		 * Every input is released first, a replay starting from the same state. Replaying stops.
+		 */
+		void StartRecording();
+
+		/**
+		 * @brief Stops recording and writes the session to a file.
+		 *
+		 * @param Path The file to write, conventionally with the InputRecording::Extension extension.
+		 * @return False if nothing was recorded or the file can't be written.
+		 */
+		bool StopRecording(std::string_view Path);
+
+		/**
+		 * @brief Replays a recorded session in place of the live input, until it ends or StopReplay().
+		 *
+		 * Every input is released first. While replaying, the live input callbacks are ignored, the window's focus
+		 * is the recorded one and TimeManager::Update() returns the recorded delta times, while its frame statistics
+		 * keep measuring the real frames: run the same loop that recorded the session and compare GetFrameStats().
+		 *
+		 * @param Path A file written by StopRecording().
+		 * @return False if the file can't be read.
+		 */
+		bool StartReplay(std::string_view Path);
+
+		/** Stops replaying, the live input takes over. */
+		void StopReplay();
+
+		/** @return True between StartRecording() and StopRecording(). */
+		bool IsRecording() const;
+
+		/** @return True while a replay runs, false again once its last frame was processed. */
+		bool IsReplaying() const;
+
+		/** @return The frames processed since recording or replaying started. */
+		uint32_t GetInputFrame() const;
+
+		/**
+		 * @brief Called by TimeManager::Update() with the measured delta time of the frame.
+		 *
+		 * @param MeasuredSeconds The time since the previous frame.
+		 * @return The recorded delta time while replaying, MeasuredSeconds otherwise, recorded while recording.
+		 */
+		double ResolveFrameTime(double MeasuredSeconds);
+
 	protected:
 		/**
 		 * @brief Checks if a key is pressed.
@@ -69,7 +210,7 @@ namespace fgl
 		 * This function returns `true` if the specified key is pressed in the current frame but was
 		 * not pressed in the previous frame.
 		 *
-		 * @param Key The key to check (use GLFW_KEY_... constants from GLFW).
+		 * @param Key The key to check (use GLFW_KEY_... constants from GLFW, or MouseButton() and GamepadButton() codes).
 		 * @return `true` if the key is pressed; `false` otherwise.
 		 */
 		bool IsKeyPressed(int Key) const;
@@ -89,7 +230,7 @@ namespace fgl
 		 *
 		 * This function returns `true` if the specified key was released in the current frame.
 		 *
-		 * @param Key The key to check (use GLFW_KEY_... constants from GLFW).
+		 * @param Key The key to check (use GLFW_KEY_... constants from GLFW, or MouseButton() and GamepadButton() codes).
 		 * @return `true` if the key was released; `false` otherwise.
 		 */
 		bool IsKeyReleased(int Key) const;
@@ -166,10 +307,13 @@ namespace fgl
 		 * @brief These are static functions called by the window manager class to send callbacks to this class.
 		 *
 		 * These functions should never be called manually, even though they are public. They are designed to be
-		 * invoked by the window manager to handle mouse movement and scroll events, and should only be used in that context.
+		 * invoked by the window manager to handle mouse movement, scroll and key events, and should only be used in that context.
 		 */
 		void UpdateMouse(GLFWwindow* window, double xpos, double ypos);
 		void UpdateScroll(double xoffset, double yoffset);
+		void UpdateKey(int Key, int Action, int Mods);
+		void UpdateMouseButton(int Button, int Action, int Mods);
+		void ResetCursor();
 
 	private:
 		/**
@@ -183,10 +327,48 @@ namespace fgl
 		/**
 		 * @brief Updates the key state.
 		 *
-		 * This function updates the state of all keys, tracking whether they are pressed or not.
+		 * Samples the state the key callback maintains into the current frame, the current frame becoming the
+		 * previous one, and takes the list of keys that changed since the last sample.
 		 */
 		void UpdateKeyState();
 
+		/** Records the live state of an input code, and the code as changed if it wasn't already. */
+		void SetInputDown(int Code, bool bDown);
+
+		/** Reads the buttons of the first gamepad into the live state, GLFW has no callback for them. */
+		void PollGamepad();
+
+		/** Counts the transitions of this frame's changed inputs into their actions, and calls the action callbacks. */
+		void ProcessActions();
+
+		/** Sets whether an action is down, adding it to or removing it from the held actions. */
+		void SetActionDown(InputAction Action, bool bDown);
+
+		/** Appends an input to the recording, stamped with the current frame and phase. */
+		void RecordInput(RecordedInputType Type, int Code, int Action, int Mods, double X = 0.0, double Y = 0.0);
+
+		/**
+		 * Delivers the recorded inputs due at a point of the current frame. At the frame start these are every input
+		 * of the frame not delivered yet, late-latched ones included if PollLatestInput() wasn't called.
+		 */
+		void ReplayInputs(RecordedInputPhase Phase);
+
+		/** Delivers one recorded input as its callback did. */
+		void ApplyRecordedInput(const RecordedInput& Input);
+
+		/** Releases every input down, without events, and forgets the cursor position. */
+		void ReleaseAllInputs();
+
+		/** @return Whether the frame processes the input: the window's focus, or the recorded one while replaying. */
+		bool IsFrameFocused(const BaseWindow& Window);
+
+		// Bodies of the input callbacks, shared by the live and the replayed input
+		void ApplyMouse(double xpos, double ypos);
+		void ApplyScroll(double xoffset, double yoffset);
+		void ApplyKey(int Key, int Action, int Mods);
+		void ApplyMouseButton(int Button, int Action, int Mods);
+		void ApplyResetCursor();
+
 		/**
 		 * @brief Processes the pressed key events.
 		 *
@@ -213,23 +395,77 @@ namespace fgl
 		 * @brief Invokes the callback function for a specific key event.
 		 *
 		 * This function invokes the callback function associated with a key event, passing the key and
-		 * event type as arguments.
+		 * event type as arguments. The callback runs from a copy, so it may replace its own binding.
 		 *
 		 * @param Callback The callback function to invoke.
 		 * @param Key The key associated with the event (Debug only).
 		 * @param EventType The type of the event (pressed, triggered, or released) (Debug only).
 		 */
-		void InvokeCallback(const std::function<void()>& Callback, int Key, std::string_view EventType);
+		void InvokeCallback(std::function<void()> Callback, int Key, std::string_view EventType);
 
 	private:
+		using KeyStates = std::bitset<InputCodeCount>;
+
+		static constexpr uint32_t NoBinding = UINT32_MAX; ///< End of a binding chain.
+
+		/** An action and its state this frame. */
+		struct ActionState
+		{
+			std::string Name;                                ///< Name given to AddAction().
+			std::array<FunctionRef<void()>, 3> Callbacks;    ///< Callback of each KeyEventType, empty if none.
+			uint32_t DownInputs = 0;                         ///< Bound inputs down this frame.
+			uint32_t HeldSlot = NoBinding;                   ///< Index in m_HeldActions while down.
+			bool bDown = false;                              ///< Whether any bound input is down this frame.
+			bool bWasDown = false;                           ///< Whether the action was down last frame.
+			bool bChanged = false;                           ///< Whether the action is in m_ChangedActions.
+		};
+
+		/** One input code mapped to an action, chained with the other bindings of the code. */
+		struct ActionBinding
+		{
+			InputAction Action = InvalidAction;              ///< The action, InvalidAction while the binding is free.
+			uint32_t Next = NoBinding;                       ///< Next binding of the same code, or of the free list.
+		};
+
 		// State tracking for the key states (pressed, released, etc.)
-		std::unordered_map<int, bool> m_CurrentKeyStates;
-		std::unordered_map<int, bool> m_PreviousKeyStates;
+		KeyStates m_KeyDown;                 ///< Live state, set by the key callback between frames.
+		KeyStates m_CurrentKeyStates;        ///< Keys down this frame.
+		KeyStates m_PreviousKeyStates;       ///< Keys down last frame.
+		KeyStates m_bKeyChanged;             ///< Keys already in m_ChangedKeys.
+		std::vector<int> m_ChangedKeys;      ///< Keys with a transition since the last UpdateKeyState().
+		std::vector<int> m_FrameChangedKeys; ///< Keys with a transition this frame, the only ones pressed and released events check.
+
+		InputEventQueue m_InputEvents;       ///< Every input callback, in order.
+
+		// Action mapping, indexed by input code and by action
+		std::vector<ActionState> m_Actions;                                          ///< Every action, by index.
+		std::vector<uint32_t> m_FirstBindings = std::vector<uint32_t>(InputCodeCount, NoBinding); ///< First binding of each input code.
+		std::vector<ActionBinding> m_Bindings;                                       ///< Bindings of every code, and free ones.
+		uint32_t m_FreeBindings = NoBinding;                                         ///< First free binding.
+		std::vector<InputAction> m_ChangedActions;                                   ///< Actions that went down or up this frame.
+		std::vector<InputAction> m_HeldActions;                                      ///< Actions down this frame, for their OnTriggered callbacks.
+
+		/** Whether the input is live, recorded or replayed. */
+		enum class InputMode : uint8_t
+		{
+			Live,
+			Recording,
+			Replaying
+		};
+
+		// Recording and replay
+		InputMode m_InputMode = InputMode::Live;                                     ///< Where the input comes from.
+		InputRecording m_Recording;                                                  ///< Session being recorded or replayed.
+		uint32_t m_InputFrame = 0;                                                   ///< Index of the next ProcessInput() since recording or replaying started.
+		size_t m_ReplayInput = 0;                                                    ///< Next recorded input to deliver.
+		size_t m_ReplayFrameTime = 0;                                                ///< Next recorded frame time to hand out.
+		bool m_bLatchingInput = false;                                               ///< True while PollLatestInput() polls.
 
-		// Callbacks for the key events
+		// Callbacks for the key events, node-based so a callback may register bindings while it runs
 		std::unordered_map<int, std::function<void()>> m_OnPressedCallbacks;
 		std::unordered_map<int, std::function<void()>> m_OnTriggeredCallbacks;
 		std::unordered_map<int, std::function<void()>> m_OnReleasedCallbacks;
+		std::vector<int> m_TriggeredKeys; ///< Keys of the triggered callbacks to run this frame, reused across frames.
 	};
 
 	/**
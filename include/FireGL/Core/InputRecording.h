@@ -0,0 +1,78 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+
+namespace fgl
+{
+
+	/** What a RecordedInput replays. */
+	enum class RecordedInputType : uint8_t
+	{
+		Key,           ///< InputManager::UpdateKey(): Code, Action and Mods are set.
+		MouseButton,   ///< InputManager::UpdateMouseButton(): Code, Action and Mods are set.
+		GamepadButton, ///< A button of the first gamepad went down or up: Code and Action are set.
+		Cursor,        ///< InputManager::UpdateMouse(): X and Y are the cursor position.
+		Scroll,        ///< InputManager::UpdateScroll(): X and Y are the scroll offsets.
+		ResetCursor    ///< InputManager::ResetCursor().
+	};
+
+	/** When a RecordedInput is delivered within its frame. */
+	enum class RecordedInputPhase : uint8_t
+	{
+		FrameStart,    ///< In InputManager::ProcessInput(), before the key state is sampled.
+		LateLatch      ///< In InputManager::PollLatestInput(), right before rendering.
+	};
+
+	/** One input callback as the InputManager received it, stamped with the frame it is delivered in. */
+	struct RecordedInput
+	{
+		uint32_t Frame = 0;                                    ///< Index of the InputManager::ProcessInput() call it belongs to.
+		RecordedInputType Type = RecordedInputType::Key;       ///< Selects the fields that are set.
+		RecordedInputPhase Phase = RecordedInputPhase::FrameStart; ///< Where in the frame it is delivered.
+		uint16_t Reserved = 0;
+		int32_t Code = 0;                                      ///< GLFW_KEY_..., GLFW_MOUSE_BUTTON_... or GLFW_GAMEPAD_BUTTON_... constant.
+		int32_t Action = 0;                                    ///< GLFW_PRESS, GLFW_RELEASE or GLFW_REPEAT.
+		int32_t Mods = 0;                                      ///< GLFW_MOD_... bits.
+		int32_t Padding = 0;
+		double X = 0.0;                                        ///< Cursor position or scroll offset.
+		double Y = 0.0;                                        ///< Cursor position or scroll offset.
+	};
+
+	/**
+	 * A recorded play session: the delta time of every frame and every input received, in order.
+	 * Written by InputManager::StopRecording() and read by InputManager::StartReplay().
+	 *
+	 * Layout (native endianness): a header {Magic, Version, FrameTimeCount, FrameCount, InputCount, Reserved},
+	 * the frame times as doubles, the focus flag of each frame as bytes, then the inputs.
+	 */
+	struct InputRecording
+	{
+		static constexpr uint32_t Magic = 0x49524746;          ///< "FGRI", identifies a FireGL input recording.
+		static constexpr uint32_t Version = 1;                 ///< Bumped whenever the layout changes.
+		static constexpr const char* Extension = ".fglinput";  ///< Conventional extension of recordings.
+
+		std::vector<double> FrameTimes;       ///< Delta time of each TimeManager::Update(), in seconds.
+		std::vector<uint8_t> FrameFocus;      ///< Whether the window was focused in each InputManager::ProcessInput().
+		std::vector<RecordedInput> Inputs;    ///< Every input, ordered by frame then by arrival.
+
+		/** Empties the recording. */
+		void Clear();
+
+		/**
+		 * Writes the recording to a file, replacing it.
+		 *
+		 * @param Path The file to write.
+		 * @return False if the file can't be written.
+		 */
+		bool Save(std::string_view Path) const;
+
+		/**
+		 * Reads a recording written by Save().
+		 *
+		 * @param Path The file to read.
+		 * @return False if the file can't be read, or isn't a recording of this version; the recording is then empty.
+		 */
+		bool Load(std::string_view Path);
+	};
+
+} // namespace fgl
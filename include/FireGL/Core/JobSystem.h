@@ -0,0 +1,123 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace fgl
+{
+
+	/**
+	 * Counts the jobs of a group that haven't finished yet, see JobSystem::Schedule() and JobSystem::Wait().
+	 */
+	struct JobCounter
+	{
+		std::atomic<uint32_t> Remaining = 0; ///< Jobs scheduled with this counter and not finished yet.
+
+		/** @return True once every job scheduled with this counter has run. */
+		bool IsDone() const { return Remaining.load(std::memory_order_acquire) == 0; }
+	};
+
+	/**
+	 * Work-stealing pool of worker threads.
+	 *
+	 * Every worker owns a queue: jobs scheduled from a worker go to the back of its own queue and are taken back
+	 * from there (the most recent job has its data in cache), while idle workers steal from the front of the
+	 * other queues. Jobs scheduled from other threads are spread over the workers' queues in turn.
+	 * A thread waiting on a counter runs queued jobs instead of blocking, so jobs may schedule and wait on
+	 * sub-jobs without exhausting the pool.
+	 *
+	 * Jobs must not throw, and must only touch data no other job of the same group writes.
+	 */
+	class JobSystem
+	{
+	public:
+		using Job = std::function<void()>;
+
+		/**
+		 * Starts the worker threads.
+		 *
+		 * @param WorkerCount Number of workers, 0 (the default) for one less than the hardware threads so the
+		 *        calling thread keeps a core; at least one worker is started.
+		 */
+		explicit JobSystem(uint32_t WorkerCount = 0);
+
+		/** Runs the jobs still queued, then stops and joins the workers. */
+		~JobSystem();
+
+		JobSystem(const JobSystem&) = delete;
+		JobSystem& operator=(const JobSystem&) = delete;
+
+		/**
+		 * Queues a job.
+		 *
+		 * @param Task The job to run on a worker.
+		 * @param Counter Incremented now and decremented once the job ran, must outlive the job.
+		 */
+		void Schedule(Job Task, JobCounter& Counter);
+
+		/**
+		 * Returns once every job scheduled with the counter ran, running queued jobs meanwhile.
+		 *
+		 * @param Counter The counter the jobs were scheduled with.
+		 */
+		void Wait(JobCounter& Counter);
+
+		/**
+		 * Splits [0, Count) into chunks and runs Body on every chunk in parallel, returning once all ran.
+		 *
+		 * @param Count The number of items.
+		 * @param ChunkSize The number of items per job; larger chunks lower the scheduling overhead.
+		 * @param Body Called with the half-open [Begin, End) range of each chunk, from any thread.
+		 */
+		void ParallelFor(size_t Count, size_t ChunkSize, const std::function<void(size_t Begin, size_t End)>& Body);
+
+		/** @return The number of worker threads. */
+		uint32_t GetWorkerCount() const;
+
+	private:
+		/** A queued job and the counter it decrements. */
+		struct PendingJob
+		{
+			Job Task;
+			JobCounter* Counter;
+		};
+
+		/** Job queue owned by one worker, the owner works at the back and thieves at the front. */
+		struct WorkerQueue
+		{
+			std::mutex Mutex;
+			std::deque<PendingJob> Jobs;
+		};
+
+		/** Main loop of a worker thread. */
+		void WorkerLoop(uint32_t WorkerIndex);
+
+		/**
+		 * Runs one job, taken from the back of the given worker's queue or stolen from another one.
+		 *
+		 * @param WorkerIndex The queue of the calling worker, or GetWorkerCount() if the caller isn't a worker.
+		 * @return False if every queue was empty.
+		 */
+		bool TryRunJob(uint32_t WorkerIndex);
+
+		/** @return The worker index of the calling thread in this system, or GetWorkerCount() if it isn't one. */
+		uint32_t GetCurrentWorker() const;
+
+		std::vector<std::unique_ptr<WorkerQueue>> m_Queues;   ///< One queue per worker.
+		std::vector<std::thread> m_Workers;                   ///< Worker threads.
+		std::mutex m_WakeMutex;                               ///< Guards the sleep of idle workers.
+		std::condition_variable m_WakeCondition;              ///< Wakes idle workers when jobs are queued.
+		std::atomic<uint32_t> m_QueuedJobs = 0;               ///< Jobs waiting in any queue.
+		std::atomic<uint32_t> m_NextQueue = 0;                ///< Queue receiving the next job scheduled from outside.
+		bool m_bStopping = false;                             ///< Set under m_WakeMutex when the workers must exit.
+
+		static thread_local const JobSystem* s_CurrentSystem; ///< System the calling thread is a worker of.
+		static thread_local uint32_t s_CurrentWorker;         ///< Worker index of the calling thread in s_CurrentSystem.
+	};
+
+} // namespace fgl
\ No newline at end of file
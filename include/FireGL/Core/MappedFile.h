@@ -0,0 +1,49 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+
+namespace fgl
+{
+
+	/**
+	 * Read-only memory mapping of a whole file.
+	 *
+	 * The file stays mapped until the object is destroyed or Close() is called; pages are loaded on
+	 * demand by the OS, so reading a large file doesn't go through an intermediate copy.
+	 */
+	class MappedFile
+	{
+	public:
+		MappedFile() = default;
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		/**
+		 * Maps a file, closing any previously mapped one.
+		 *
+		 * @param Path The file to map.
+		 * @return True if the file exists, is not empty and could be mapped.
+		 */
+		bool Open(std::string_view Path);
+
+		/** Unmaps the file. */
+		void Close();
+
+		/** @return The first byte of the mapping, or nullptr if no file is mapped. */
+		const uint8_t* GetData() const;
+
+		/** @return The size of the mapping in bytes. */
+		size_t GetSize() const;
+
+	private:
+		const uint8_t* m_Data = nullptr; ///< Start of the mapping.
+		size_t m_Size = 0;               ///< Size of the mapping in bytes.
+#if defined(_WIN32) || defined(_WIN64)
+		void* m_FileHandle = nullptr;    ///< Handle of the opened file.
+		void* m_MappingHandle = nullptr; ///< Handle of the file mapping object.
+#endif
+	};
+
+} // namespace fgl
\ No newline at end of file
@@ -0,0 +1,236 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+
+#include <atomic>
+#include <deque>
+
+namespace fgl
+{
+
+	/** The subsystem a CPU allocation is made for. */
+	enum class MemoryTag : uint8_t
+	{
+		Meshes,     ///< CPU copies of mesh geometry: vertices, indices, levels of detail, meshlets and skins.
+		Textures,   ///< Decoded images and container files waiting for their upload.
+		Scene,      ///< Object lists, queues and cameras of the scenes.
+		Components, ///< Component pool chunks and free lists.
+		Models,     ///< Mesh arrays, texture bookkeeping and animations of imported models.
+		Logging,    ///< Messages queued for the logging thread.
+		Count
+	};
+
+	/** Counters of one MemoryTag. */
+	struct MemoryTagStats
+	{
+		uint64_t CurrentBytes = 0;     ///< Bytes allocated now.
+		uint64_t PeakBytes = 0;        ///< Highest CurrentBytes since start or the last ResetPeaks().
+		uint64_t LiveAllocations = 0;  ///< Allocations not freed yet.
+		uint64_t TotalAllocations = 0; ///< Allocations made since start.
+		uint64_t BudgetBytes = 0;      ///< Limit set with SetBudget(), 0 for none.
+	};
+
+	/**
+	 * Bytes of heap memory allocated per subsystem, the CPU side of the GPUMemoryTracker.
+	 *
+	 * Containers report through TaggedAllocator, whose tag is part of their type; memory allocated elsewhere,
+	 * e.g. by an image decoder, is reported with OnAllocate() and OnFree() or held by a MemoryCharge. The counters
+	 * are atomics, so any thread may allocate, and the allocations of untagged containers aren't counted.
+	 *
+	 * Budgets don't fail allocations: IsOverBudget() lets loaders and streamers hold back new work, and the first
+	 * allocation exceeding a budget logs an error once.
+	 */
+	class MemoryTracker
+	{
+	public:
+		/** Counts an allocation of Bytes under a tag. */
+		static void OnAllocate(MemoryTag Tag, uint64_t Bytes);
+
+		/** Counts the release of an allocation of Bytes under a tag. */
+		static void OnFree(MemoryTag Tag, uint64_t Bytes);
+
+		/**
+		 * Allocates a byte buffer counted under a tag until its last owner lets go, e.g. for decoded pixels.
+		 *
+		 * @param Tag The subsystem the buffer is counted under.
+		 * @param Bytes The size of the buffer.
+		 * @return The uninitialized buffer.
+		 */
+		static std::shared_ptr<unsigned char> MakeSharedBuffer(MemoryTag Tag, size_t Bytes);
+
+		/** @return The counters of a tag. */
+		static MemoryTagStats GetStats(MemoryTag Tag);
+
+		/** @return The bytes allocated now over every tag. */
+		static uint64_t GetTotal();
+
+		/**
+		 * Sets how many bytes a tag should stay under, e.g. to fit a 2 GB device.
+		 *
+		 * @param Tag The subsystem to limit.
+		 * @param Bytes The limit, 0 to remove it.
+		 */
+		static void SetBudget(MemoryTag Tag, uint64_t Bytes);
+
+		/** @return True if the tag has a budget and allocated more. */
+		static bool IsOverBudget(MemoryTag Tag);
+
+		/** Restarts the peaks of every tag from their current bytes, e.g. once loading is done. */
+		static void ResetPeaks();
+
+		/** Logs the counters of every tag. */
+		static void LogReport();
+
+		/** @return The name of a tag, as shown by LogReport(). */
+		static const char* GetTagName(MemoryTag Tag);
+
+	private:
+		/** Counters of one tag, updated concurrently. */
+		struct Counters
+		{
+			std::atomic<uint64_t> Current{ 0 };
+			std::atomic<uint64_t> Peak{ 0 };
+			std::atomic<uint64_t> Live{ 0 };
+			std::atomic<uint64_t> Total{ 0 };
+			std::atomic<uint64_t> Budget{ 0 };
+			std::atomic<bool> bBudgetReported{ false };
+		};
+
+		static std::array<Counters, static_cast<size_t>(MemoryTag::Count)> s_Counters; ///< Counters of every tag.
+	};
+
+	/**
+	 * Standard allocator counting its allocations in the MemoryTracker under a tag fixed by its type.
+	 *
+	 * @tparam T The allocated type.
+	 * @tparam Tag The subsystem the memory is counted under.
+	 */
+	template<typename T, MemoryTag Tag>
+	class TaggedAllocator
+	{
+	public:
+		using value_type = T;
+
+		template<typename U>
+		struct rebind
+		{
+			using other = TaggedAllocator<U, Tag>;
+		};
+
+		TaggedAllocator() noexcept = default;
+
+		template<typename U>
+		TaggedAllocator(const TaggedAllocator<U, Tag>&) noexcept
+		{
+		}
+
+		T* allocate(size_t Count)
+		{
+			T* Allocated = std::allocator<T>().allocate(Count);
+			MemoryTracker::OnAllocate(Tag, Count * sizeof(T));
+			return Allocated;
+		}
+
+		void deallocate(T* Pointer, size_t Count) noexcept
+		{
+			MemoryTracker::OnFree(Tag, Count * sizeof(T));
+			std::allocator<T>().deallocate(Pointer, Count);
+		}
+
+		template<typename U>
+		bool operator==(const TaggedAllocator<U, Tag>&) const noexcept { return true; }
+
+		template<typename U>
+		bool operator!=(const TaggedAllocator<U, Tag>&) const noexcept { return false; }
+	};
+
+	/** std::vector counting its storage under a tag. */
+	template<typename T, MemoryTag Tag>
+	using TaggedVector = std::vector<T, TaggedAllocator<T, Tag>>;
+
+	/** std::deque counting its storage under a tag. */
+	template<typename T, MemoryTag Tag>
+	using TaggedDeque = std::deque<T, TaggedAllocator<T, Tag>>;
+
+	/** std::unordered_map counting its nodes and buckets under a tag. */
+	template<typename Key, typename Value, MemoryTag Tag>
+	using TaggedUnorderedMap = std::unordered_map<Key, Value, std::hash<Key>, std::equal_to<Key>, TaggedAllocator<std::pair<const Key, Value>, Tag>>;
+
+	/**
+	 * Bytes counted under a tag on behalf of an object whose storage doesn't go through a TaggedAllocator,
+	 * e.g. containers that are part of an interface. The owner updates the amount with Set() when its storage
+	 * changes; a copy charges the same amount again, a move hands it over and destruction releases it.
+	 */
+	class MemoryCharge
+	{
+	public:
+		explicit MemoryCharge(MemoryTag Tag)
+			: m_Tag(Tag)
+		{
+		}
+
+		~MemoryCharge()
+		{
+			Set(0);
+		}
+
+		MemoryCharge(const MemoryCharge& Other)
+			: m_Tag(Other.m_Tag)
+		{
+			Set(Other.m_Bytes);
+		}
+
+		MemoryCharge(MemoryCharge&& Other) noexcept
+			: m_Tag(Other.m_Tag)
+			, m_Bytes(std::exchange(Other.m_Bytes, 0))
+		{
+		}
+
+		MemoryCharge& operator=(const MemoryCharge& Other)
+		{
+			if (this != &Other)
+			{
+				Set(0);
+				m_Tag = Other.m_Tag;
+				Set(Other.m_Bytes);
+			}
+			return *this;
+		}
+
+		MemoryCharge& operator=(MemoryCharge&& Other) noexcept
+		{
+			if (this != &Other)
+			{
+				Set(0);
+				m_Tag = Other.m_Tag;
+				m_Bytes = std::exchange(Other.m_Bytes, 0);
+			}
+			return *this;
+		}
+
+		/** Replaces the charged amount, counted as one allocation while non-zero. */
+		void Set(uint64_t Bytes)
+		{
+			if (Bytes == m_Bytes)
+				return;
+
+			if (m_Bytes > 0)
+			{
+				MemoryTracker::OnFree(m_Tag, m_Bytes);
+			}
+			if (Bytes > 0)
+			{
+				MemoryTracker::OnAllocate(m_Tag, Bytes);
+			}
+			m_Bytes = Bytes;
+		}
+
+		/** @return The charged amount. */
+		uint64_t Get() const { return m_Bytes; }
+
+	private:
+		MemoryTag m_Tag;      ///< Tag the bytes are counted under.
+		uint64_t m_Bytes = 0; ///< Bytes counted now.
+	};
+
+} // namespace fgl
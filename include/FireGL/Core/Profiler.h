@@ -0,0 +1,127 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+
+#if defined(FIREGL_ENABLE_TRACY)
+#include <tracy/Tracy.hpp>
+#endif
+
+namespace fgl
+{
+
+#if defined(FIREGL_ENABLE_TRACY)
+#define FGL_TRACY_SCOPE(Name) ZoneScopedN(Name);
+#define FGL_TRACY_FUNCTION() ZoneScoped;
+#define FGL_TRACY_THREAD(Name) ::tracy::SetThreadName(std::string(Name).c_str());
+#else
+#define FGL_TRACY_SCOPE(Name)
+#define FGL_TRACY_FUNCTION()
+#define FGL_TRACY_THREAD(Name)
+#endif
+
+#if defined(FIREGL_ENABLE_PROFILER)
+#define FGL_PROFILE_CONCAT_INNER(A, B) A##B
+#define FGL_PROFILE_CONCAT(A, B) FGL_PROFILE_CONCAT_INNER(A, B)
+#define FGL_PROFILE_SCOPE(Name) FGL_TRACY_SCOPE(Name) ::fgl::ProfileScope FGL_PROFILE_CONCAT(ProfileScope_, __LINE__)(Name);
+#define FGL_PROFILE_FUNCTION() FGL_TRACY_FUNCTION() ::fgl::ProfileScope FGL_PROFILE_CONCAT(ProfileScope_, __LINE__)(__func__);
+#define FGL_PROFILE_THREAD(Name) FGL_TRACY_THREAD(Name) ::fgl::Profiler::SetThreadName(Name);
+#else
+#define FGL_PROFILE_SCOPE(Name) FGL_TRACY_SCOPE(Name)
+#define FGL_PROFILE_FUNCTION() FGL_TRACY_FUNCTION()
+#define FGL_PROFILE_THREAD(Name) FGL_TRACY_THREAD(Name)
+#endif
+
+	/**
+	 * CPU profiler recording timed zones, compiled in with the FIREGL_ENABLE_PROFILER CMake option.
+	 *
+	 * FGL_PROFILE_SCOPE("Name") times the rest of the enclosing scope; the name must be a string literal or
+	 * outlive the trace. Zones opened inside each other nest in the trace. Without the option the macros expand
+	 * to nothing, and the functions below record nothing.
+	 *
+	 * Every thread writes its zones into its own ring buffer of ThreadCapacity zones: the owning thread is the
+	 * only writer and publishes each zone with a release store, so recording takes no lock. A thread only locks
+	 * once, to register its buffer the first time it records. When a ring is full its oldest zones are overwritten.
+	 * Buffers outlive their threads, so zones of finished workers are still dumped.
+	 *
+	 * The FIREGL_ENABLE_TRACY CMake option sends the same zones and thread names to Tracy, with or without this
+	 * profiler. Tracy's zones must be named by string literals. It also adds the frame marks and GPU contexts below,
+	 * Tracy GPU zones around the GPUProfiler passes and Tracy memory events for every operator new and delete.
+	 */
+	namespace Profiler {
+
+		static constexpr size_t ThreadCapacity = 1 << 16; ///< Zones kept per thread.
+
+		/**
+		 * @return The time since the profiler's epoch, in nanoseconds.
+		 */
+		uint64_t Now();
+
+		/**
+		 * Records a finished zone on the calling thread.
+		 *
+		 * @param Name The name of the zone, not copied.
+		 * @param Start Start of the zone, from Now().
+		 * @param End End of the zone, from Now().
+		 */
+		void RecordZone(const char* Name, uint64_t Start, uint64_t End);
+
+		/**
+		 * Names the calling thread in the trace. Threads without a name are shown by their registration order.
+		 *
+		 * @param Name The name of the thread, copied.
+		 */
+		void SetThreadName(std::string_view Name);
+
+		/**
+		 * Writes the zones of every thread in the Chrome trace event format, readable by chrome://tracing and Perfetto.
+		 * Zones recorded while the trace is written may be missing from it, never torn.
+		 *
+		 * @param Path The JSON file to write.
+		 * @param Since Zones that ended before this Now() time are left out, 0 to write every zone kept.
+		 * @param ExtraEvents Trace events appended after the zones, JSON objects separated by commas, e.g. counters.
+		 * @return False if the file couldn't be written.
+		 */
+		bool WriteChromeTrace(std::string_view Path, uint64_t Since = 0, std::string_view ExtraEvents = {});
+
+		/** Drops the zones recorded so far by every thread. Call while no thread records. */
+		void Clear();
+
+		/**
+		 * Creates Tracy's GPU context for the OpenGL context current on the calling thread.
+		 * No-op without FIREGL_ENABLE_TRACY.
+		 */
+		void CreateGPUContext();
+
+		/**
+		 * Ends a frame in Tracy and collects the GPU zones whose queries arrived. Call after the buffer swap.
+		 * No-op without FIREGL_ENABLE_TRACY.
+		 */
+		void MarkFrame();
+	}
+
+	/** Times its own lifetime as a Profiler zone, see FGL_PROFILE_SCOPE. */
+	class ProfileScope
+	{
+	public:
+		/** @param Name The name of the zone, not copied. */
+		explicit ProfileScope(const char* Name)
+			: m_Name(Name)
+			, m_Start(Profiler::Now())
+		{
+		}
+
+		/** Records the zone. */
+		~ProfileScope()
+		{
+			Profiler::RecordZone(m_Name, m_Start, Profiler::Now());
+		}
+
+		ProfileScope(const ProfileScope&) = delete;
+		ProfileScope& operator=(const ProfileScope&) = delete;
+
+	private:
+		const char* m_Name; ///< Name of the zone.
+		uint64_t m_Start;   ///< Start of the zone, from Profiler::Now().
+	};
+
+} // namespace fgl
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+struct GLFWwindow;
+
+namespace fgl
+{
+
+	/**
+	 * Dedicated thread owning a window's OpenGL context, running one frame at a time.
+	 *
+	 * Start() moves the context from the calling thread to the render thread; from then on every GL call,
+	 * buffer swaps included, must run in a submitted frame. The main thread keeps polling events and
+	 * simulating: SubmitFrame() waits for the previous frame to finish, then hands over the next one and
+	 * returns, so the simulation of frame N+1 overlaps the submission of frame N. What a frame reads
+	 * must not change while it runs, see Renderer::PrepareFrame() for the snapshot the renderer draws.
+	 *
+	 * An exception thrown by a frame (a failed LOG_ASSERT) is rethrown on the main thread by the next
+	 * WaitForFrame() or SubmitFrame().
+	 */
+	class RenderThread
+	{
+	public:
+		RenderThread() = default;
+		RenderThread(const RenderThread&) = delete;
+		RenderThread& operator=(const RenderThread&) = delete;
+
+		/** Stops the thread if it still runs. */
+		~RenderThread();
+
+		/**
+		 * Releases the window's context from the calling thread and starts the render thread, which makes it current.
+		 *
+		 * @param Window The window whose context is current on the calling thread.
+		 */
+		void Start(GLFWwindow* Window);
+
+		/** Waits for the frame in flight, stops the thread and makes the context current on the calling thread again. */
+		void Stop();
+
+		/** @return True between Start() and Stop(). */
+		bool IsRunning() const;
+
+		/**
+		 * Waits for the previous frame, then runs Frame on the render thread.
+		 *
+		 * @param Frame The GL work of the frame, swap included.
+		 */
+		void SubmitFrame(std::function<void()> Frame);
+
+		/** Waits until the frame in flight finished. Returns at once if none is. */
+		void WaitForFrame();
+
+		/**
+		 * Sets the viewport the next frame starts with, for framebuffer size changes: the thread receiving them
+		 * has no context while the render thread runs.
+		 */
+		void SetViewport(int Width, int Height);
+
+		/** @return The time the last WaitForFrame() or SubmitFrame() blocked, in seconds. */
+		double GetLastWaitTime() const;
+
+	private:
+		/** Body of the render thread. */
+		void Run();
+
+		GLFWwindow* m_Window = nullptr;                ///< Window whose context the thread owns.
+		std::thread m_Thread;                          ///< The render thread.
+		mutable std::mutex m_Mutex;                    ///< Guards the members below.
+		std::condition_variable m_Condition;           ///< Signalled when a frame is submitted or finished, and on Stop().
+		std::function<void()> m_Frame;                 ///< Frame submitted, cleared once it finished.
+		std::exception_ptr m_Error;                    ///< Thrown by the last frame, rethrown on the main thread.
+		bool m_bStopping = false;                      ///< Set by Stop().
+		std::atomic<uint64_t> m_PendingViewport{ 0 };  ///< Width in the high and height in the low 32 bits, 0 if unchanged.
+		double m_LastWaitTime = 0.0;                   ///< Time the main thread last blocked on a frame, in seconds.
+	};
+
+} // namespace fgl
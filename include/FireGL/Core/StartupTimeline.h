@@ -0,0 +1,73 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+
+namespace fgl
+{
+
+	/** One asset loaded before the first frame. Times are in nanoseconds on the Profiler::Now() clock. */
+	struct StartupEvent
+	{
+		std::string Phase;       ///< What was loaded: "Config", "Shader", "Texture", "CubeMap" or "Model".
+		std::string Asset;       ///< Path of the asset, both stages of a shader.
+		uint64_t BytesRead = 0;  ///< Size of the files read for it.
+		uint64_t Start = 0;      ///< When loading started.
+		uint64_t DecodeTime = 0; ///< Reading and decoding on the CPU.
+		uint64_t UploadTime = 0; ///< Creating and filling the OpenGL objects.
+	};
+
+	/**
+	 * Timeline of the asset loads between the start of the process and the first rendered frame, always recorded.
+	 *
+	 * What decode and upload cover per phase:
+	 * - Config: parsing the .ini file; nothing is uploaded.
+	 * - Shader: reading the stage sources; upload is compiling and linking, or only submitting them when the link check is deferred.
+	 * - Texture, CubeMap: stb_image decoding; upload is the glTexImage calls and mipmap generation.
+	 * - Model: importing or reading the mesh cache, building the meshes and decoding the textures; upload is creating the
+	 *   textures, zero when ModelLoader defers them. Bytes are the model file's and its textures', even when the mesh cache
+	 *   was read instead. Models sharing an already loaded resource aren't recorded.
+	 *
+	 * The Renderer calls Finish() after its first frame, later loads aren't recorded. Loader threads may record concurrently.
+	 */
+	namespace StartupTimeline {
+
+		/**
+		 * Records an asset load, unless the timeline is finished.
+		 *
+		 * @param Phase The kind of asset, see StartupEvent::Phase.
+		 * @param Asset The path of the asset.
+		 * @param BytesRead The size of the files read, see FileSize().
+		 * @param Start When loading started, from Profiler::Now().
+		 * @param Decoded When decoding ended and uploading started.
+		 * @param End When uploading ended.
+		 */
+		void Record(std::string_view Phase, std::string_view Asset, uint64_t BytesRead, uint64_t Start, uint64_t Decoded, uint64_t End);
+
+		/** @return False once Finish() was called, callers can skip gathering what Record() would drop. */
+		bool IsRecording();
+
+		/** Ends the timeline at the first frame. Calls after the first one do nothing. */
+		void Finish();
+
+		/** @return The recorded loads, in the order they ended. */
+		std::vector<StartupEvent> GetEvents();
+
+		/** @return When Finish() was called, or zero while recording. */
+		uint64_t GetFirstFrameTime();
+
+		/**
+		 * Writes the timeline as JSON, times in milliseconds, along with the totals of every phase.
+		 *
+		 * @param Path The JSON file to write.
+		 * @return False if the file couldn't be written.
+		 */
+		bool WriteJSON(std::string_view Path);
+
+		/** Logs the totals of every phase and the slowest loads. */
+		void LogSummary();
+
+		/** @return The size of the file at Path, zero if it can't be read. */
+		uint64_t FileSize(std::string_view Path);
+	}
+
+} // namespace fgl
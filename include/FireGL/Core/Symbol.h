@@ -0,0 +1,68 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+#include <FireGL/Core/FlatHashMap.h>
+
+namespace fgl
+{
+
+	/**
+	 * Interned string: a 32-bit ID into a global table keeping one copy of every string interned.
+	 *
+	 * Equal strings always get the same ID, so comparing or hashing symbols compares or hashes an integer,
+	 * and copying one copies 4 bytes. Texture names and paths and material slots are symbols: the texture views
+	 * of every mesh share their strings, and looking a texture up compares IDs.
+	 *
+	 * Interning takes a shared lock when the string is known and an exclusive one to add it; reading a symbol's
+	 * string takes no lock. Interned strings are never freed, they live until the program exits, so symbols
+	 * are meant for names and paths, not for arbitrary text.
+	 *
+	 *     const Symbol Diffuse("diffuse");
+	 *     if (MeshTexture.GetNameSymbol() == Diffuse) ...
+	 */
+	class Symbol
+	{
+	public:
+		/** The empty string, ID 0. */
+		constexpr Symbol() = default;
+
+		/** @param Text The string to intern, added to the table the first time it is seen. */
+		explicit Symbol(std::string_view Text);
+
+		/**
+		 * Looks a string up without interning it, e.g. for a lookup that may miss.
+		 *
+		 * @param Text The string to look for.
+		 * @return Its symbol, or the empty symbol if it was never interned.
+		 */
+		static Symbol Find(std::string_view Text);
+
+		/** @return The interned string, valid until the program exits. */
+		const std::string& GetString() const;
+
+		/** @return The ID of the string, 0 for the empty string. */
+		uint32_t GetID() const { return m_ID; }
+
+		/** @return True for the empty string. */
+		bool IsEmpty() const { return m_ID == 0; }
+
+		constexpr bool operator==(const Symbol&) const = default;
+
+		/** @return The strings interned so far, the empty string included. */
+		static uint32_t GetCount();
+
+	private:
+		uint32_t m_ID = 0; ///< Index of the string in the table.
+	};
+
+	/** Hashes a Symbol for FlatHashMap, the ID being mixed like an integer key. */
+	template<>
+	struct FlatHash<Symbol>
+	{
+		size_t operator()(Symbol Value) const
+		{
+			return FlatHash<size_t>::Mix(Value.GetID());
+		}
+	};
+
+} // namespace fgl
@@ -1,10 +1,26 @@
 #pragma once
 
+#include <FireGL/fglpch.h>
 #include <FireGL/Core/BaseSingletonManager.h>
+#include <FireGL/Core/TimerWheel.h>
+
+#include <chrono>
 
 namespace fgl 
 {
 
+    /** Statistics of the frame times in the TimeManager's rolling window, in milliseconds. */
+    struct FrameTimeStats
+    {
+        size_t Samples = 0;   ///< Frames in the window.
+        double Mean = 0.0;    ///< Average frame time.
+        double P50 = 0.0;     ///< Median frame time.
+        double P95 = 0.0;     ///< 95th percentile, nearest rank.
+        double P99 = 0.0;     ///< 99th percentile, nearest rank.
+        double Max = 0.0;     ///< Longest frame.
+        size_t Hitches = 0;   ///< Frames longer than the hitch threshold.
+    };
+
     /**
      * @class TimeManager
      *
@@ -29,9 +45,19 @@ namespace fgl
          * Updates deltaTime each frame.
          * This function must be called within the game loop to calculate the time difference
          * between the current and previous frames. It is used for frame-independent calculations.
+         * The timers that came due during the frame fire at the end of the call (see GetTimers()).
          */
         void Update();
 
+        /**
+         * Gives access to the timers of the application: callbacks scheduled after a delay or at an interval,
+         * fired by Update() in real time. Prefer them to counting the elapsed time in a Tick(), which costs
+         * every frame; pending timers cost nothing until they come due.
+         *
+         * @return The timer wheel, with a resolution of one millisecond.
+         */
+        TimerWheel& GetTimers();
+
         /**
          * Retrieves the deltaTime (time difference between the current and previous frame).
          * This value is useful for performing frame-independent logic (e.g., movement, animations).
@@ -40,6 +66,36 @@ namespace fgl
          */
         float GetDeltaTime();
 
+        /**
+         * Retrieves the deltaTime in double precision, measured on std::chrono::steady_clock.
+         *
+         * @return The time between the current and previous frame, in seconds.
+         */
+        double GetDeltaTimeSeconds() const;
+
+        /**
+         * Sets how many of the last frame times GetFrameStats() is computed over, clearing the window.
+         *
+         * @param Frames The size of the rolling window, 600 by default (10 s at 60 FPS).
+         */
+        void SetFrameHistorySize(size_t Frames);
+
+        /**
+         * Sets the frame time above which a frame counts as a hitch.
+         *
+         * @param Milliseconds The threshold, zero or less (the default) for twice the median of the window.
+         */
+        void SetHitchThreshold(double Milliseconds);
+
+        /**
+         * Computes the statistics of the frame times in the rolling window. Costs a copy and a few partial
+         * sorts of the window, call it when the figures are needed rather than every frame.
+         */
+        FrameTimeStats GetFrameStats() const;
+
+        /** @return The frame times of the rolling window in milliseconds, oldest first. */
+        std::vector<double> GetFrameTimes() const;
+
         /**
          * Retrieves the total time elapsed since the application started.
          *
@@ -48,6 +104,35 @@ namespace fgl
          */
         double GetTimeSeconds();
 
+        /**
+         * Enables or disables the fixed-timestep simulation.
+         * When enabled, Update() accumulates the real frame time and converts it into whole steps of StepSeconds:
+         * Scene::Process() ticks the objects once per step with GetFixedDeltaTime(), zero or several times a frame,
+         * so the simulation runs at the same rate whatever the frame rate. The time left over is exposed as
+         * GetInterpolationAlpha(), the Transforms moved by the last step are rendered that far between their
+         * previous and current state. A frame longer than MaxStepsPerFrame steps only runs that many: the
+         * simulation slows down instead of spending every next frame catching up (the "spiral of death").
+         *
+         * @param StepSeconds The simulated time per step, e.g. 1/120 s. Zero or less returns to one variable step per frame.
+         * @param MaxStepsPerFrame The most steps run in one frame.
+         */
+        void SetFixedTimeStep(double StepSeconds, uint32_t MaxStepsPerFrame = 8);
+
+        /** @return True if the simulation runs in fixed steps. */
+        bool IsFixedTimeStep() const;
+
+        /** @return The simulated time per fixed step, in seconds. */
+        float GetFixedDeltaTime() const;
+
+        /** @return The number of fixed steps to run this frame, computed by Update(). */
+        uint32_t GetFixedStepCount() const;
+
+        /**
+         * @return The accumulated time not simulated yet, as a fraction of a step in [0, 1): how far the rendered
+         * state is between the previous and the last step.
+         */
+        float GetInterpolationAlpha() const;
+
         /**
          * This function must be called immediately after the constructor is invoked.
          * It is used to call functions that are mostly virtual, as they cannot be called
@@ -70,8 +155,24 @@ namespace fgl
         virtual void RegisterWithSystemManager() override final;
 
     private:
+        /** Converts the accumulated frame time into this frame's fixed steps. */
+        void UpdateFixedSteps();
+
         float m_DeltaTime;  ///< The deltaTime between the current and previous frame.
-        double m_LastFrame; ///< Stores the time of the previous frame to calculate the DeltaTime between frames.
+        double m_DeltaTimeSeconds = 0.0; ///< m_DeltaTime in double precision.
+        std::optional<std::chrono::steady_clock::time_point> m_LastFrame; ///< When the previous frame started, none before the first Update().
+
+        std::vector<double> m_FrameTimes;   ///< Ring of the last frame times, in milliseconds.
+        size_t m_FrameTimeNext = 0;         ///< Slot the next frame time is written to.
+        size_t m_FrameTimeCount = 0;        ///< Frame times recorded, up to the ring's size.
+        double m_HitchThreshold = 0.0;      ///< Hitch threshold in milliseconds, zero for twice the median.
+
+        double m_FixedStep = 0.0;        ///< Simulated time per fixed step, zero without a fixed timestep.
+        uint32_t m_MaxFixedSteps = 8;    ///< Most steps run in one frame.
+        double m_Accumulator = 0.0;      ///< Real time not simulated yet.
+        uint32_t m_FixedStepCount = 0;   ///< Steps to run this frame.
+
+        TimerWheel m_Timers;             ///< Deferred callbacks, advanced by Update().
     };
 
 } // namespace fgl
\ No newline at end of file
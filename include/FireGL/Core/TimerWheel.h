@@ -0,0 +1,142 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+
+namespace fgl
+{
+
+	/** Identifies a timer of a TimerWheel, stays safe to cancel once the timer fired or was cancelled. */
+	struct TimerHandle
+	{
+		uint32_t Index = UINT32_MAX;    ///< Slot of the timer in the wheel's pool.
+		uint32_t Generation = 0;        ///< Generation of the slot when the timer was scheduled.
+
+		/** @return True if the handle was returned by a schedule call, whether the timer is still pending or not. */
+		bool IsValid() const { return Index != UINT32_MAX; }
+	};
+
+	/**
+	 * Hierarchical timer wheel firing deferred callbacks, e.g. "explode in 3 seconds" without polling the elapsed
+	 * time in a tick. Owned by the TimeManager (see TimeManager::GetTimers()) and advanced by its Update().
+	 *
+	 * Time is counted in ticks of a fixed resolution. Four levels of 256 slots cover 2^32 ticks, 49 days at the
+	 * default millisecond resolution: level 0 holds the timers due within 256 ticks, one slot per tick, and each
+	 * next level covers 256 times the span with slots as wide as the whole level below. Scheduling and cancelling
+	 * link and unlink a timer in one slot, in constant time; when level 0 wraps around, the next slot of level 1
+	 * is spread over level 0, and so on up. A frame only visits the level 0 slots of its ticks, so pending timers
+	 * cost nothing until they come due.
+	 *
+	 * The timers due in a tick are unlinked first, then fired together; callbacks may schedule and cancel timers,
+	 * the current one included, but not call Advance(). Not thread-safe: schedule, cancel and advance on one thread.
+	 */
+	class TimerWheel
+	{
+	public:
+		using Callback = std::function<void()>;
+
+		/**
+		 * @param TickSeconds Resolution of the wheel: timers fire on the first tick at or after their deadline.
+		 */
+		explicit TimerWheel(double TickSeconds = 0.001);
+
+		TimerWheel(const TimerWheel&) = delete;
+		TimerWheel& operator=(const TimerWheel&) = delete;
+
+		/**
+		 * Schedules a callback to run once.
+		 *
+		 * @param DelaySeconds Time from now after which the callback runs, at least one tick.
+		 * @param Function The callback, run by the Advance() reaching its deadline.
+		 * @return The handle of the timer.
+		 */
+		TimerHandle Schedule(double DelaySeconds, Callback Function);
+
+		/**
+		 * Schedules a callback to run periodically until cancelled. Deadlines follow each other by exactly one
+		 * interval, a late Advance() doesn't shift the next ones.
+		 *
+		 * @param IntervalSeconds Time between two runs, at least one tick; the first run is one interval from now.
+		 * @param Function The callback.
+		 * @return The handle of the timer.
+		 */
+		TimerHandle ScheduleRepeating(double IntervalSeconds, Callback Function);
+
+		/**
+		 * Cancels a timer before it fires. Does nothing if it already fired or was cancelled.
+		 *
+		 * @param Handle The handle of the timer.
+		 * @return True if the timer was pending.
+		 */
+		bool Cancel(TimerHandle Handle);
+
+		/** @return True if the timer of a handle is still to fire (a repeating one until cancelled). */
+		bool IsPending(TimerHandle Handle) const;
+
+		/**
+		 * Moves the wheel forward and fires the timers that came due, tick by tick.
+		 *
+		 * @param Seconds Time elapsed since the last call, the remainder below one tick is carried over.
+		 */
+		void Advance(double Seconds);
+
+		/** Cancels every timer. */
+		void Clear();
+
+		/** @return The number of pending timers. */
+		size_t GetPendingCount() const;
+
+		/** @return The resolution of the wheel, in seconds. */
+		double GetTickSeconds() const;
+
+	private:
+		static constexpr uint32_t SlotBits = 8;               ///< Slots per level as a power of two.
+		static constexpr uint32_t SlotCount = 1u << SlotBits; ///< Slots per level.
+		static constexpr uint32_t SlotMask = SlotCount - 1;   ///< Mask of the slot bits of a tick.
+		static constexpr uint32_t LevelCount = 4;             ///< Levels of the wheel.
+		static constexpr uint32_t NullTimer = UINT32_MAX;     ///< End of a list.
+
+		/** A timer in the pool, linked in one slot while pending. */
+		struct Timer
+		{
+			Callback Function;                  ///< Run when the timer fires.
+			uint64_t Deadline = 0;              ///< Tick the timer fires at.
+			uint64_t Interval = 0;              ///< Ticks between two runs, 0 for a one-shot timer.
+			uint32_t Previous = NullTimer;      ///< Previous timer of the slot, or of the free list.
+			uint32_t Next = NullTimer;          ///< Next timer of the slot, or of the free list.
+			uint32_t Slot = NullTimer;          ///< Slot the timer is linked in, level * SlotCount + index.
+			uint32_t Generation = 0;            ///< Incremented when the timer fires for good or is cancelled.
+			bool bPending = false;              ///< True while the timer is scheduled.
+		};
+
+		/** @return The number of ticks of a delay, at least one. */
+		uint64_t ToTicks(double Seconds) const;
+
+		/** Schedules a timer from a free slot of the pool. */
+		TimerHandle Add(uint64_t Delay, uint64_t Interval, Callback Function);
+
+		/** Links a timer in the slot of its deadline, relative to the current tick. */
+		void Link(uint32_t Index);
+
+		/** Unlinks a timer from its slot. */
+		void Unlink(uint32_t Index);
+
+		/** Returns a timer to the free list, invalidating its handles. */
+		void Release(uint32_t Index);
+
+		/** Spreads the timers of a slot of a higher level over the levels below. */
+		void Cascade(uint32_t Level, uint32_t SlotIndex);
+
+		/** Fires the timers of the level 0 slot of the current tick. */
+		void FireCurrentSlot();
+
+		double m_TickSeconds;                                 ///< Resolution of the wheel.
+		double m_Remainder = 0.0;                             ///< Time below one tick carried to the next Advance().
+		uint64_t m_CurrentTick = 0;                           ///< Tick the wheel is at.
+		std::array<uint32_t, SlotCount * LevelCount> m_Slots; ///< First timer of each slot, level after level.
+		std::vector<Timer> m_Timers;                          ///< Pool of timers, pending or free.
+		uint32_t m_FreeTimers = NullTimer;                    ///< First free timer of the pool.
+		size_t m_PendingCount = 0;                            ///< Timers scheduled and not fired or cancelled.
+		std::vector<std::pair<uint32_t, uint32_t>> m_Firing;  ///< Timers and generations of the slot being fired.
+	};
+
+} // namespace fgl
@@ -2,6 +2,9 @@
 
 #include <FireGL/fglpch.h>
 #include <FireGL/Core/BaseSingletonManager.h>
+#include <FireGL/Core/FrameLimiter.h>
+#include <FireGL/Core/RenderThread.h>
+#include <FireGL/Core/GLUploadThread.h>
 
 #include <External/glad/glad.h>
 #include <External/GLFW/glfw3.h>
@@ -16,7 +19,16 @@ namespace fgl
 		FullScreen,			  ///< Fullscreen without borders.
 		WindowedFullScreen,   ///< Fullscreen with borders (maximized window).
 		Windowed,			  ///< Windowed mode with a custom size.
-		BorderlessWindowed    ///< Borderless window mode (for custom border implementations).
+		BorderlessWindowed,   ///< Borderless window mode (for custom border implementations).
+		Hidden                ///< Invisible window with a custom size, for headless rendering such as benchmarks.
+	};
+
+	// How buffer swaps are synchronized with the display refresh.
+	enum class VSyncMode
+	{
+		Off,     ///< Swap immediately, tearing when a frame misses the refresh.
+		On,      ///< Wait for the refresh on every swap.
+		Adaptive ///< Wait for the refresh, but swap immediately when the frame is late (swap interval -1).
 	};
 
 	/**
@@ -92,6 +104,44 @@ namespace fgl
 		 */
 		[[nodiscard]] bool IsFocused() const;
 
+		/**
+		 * @brief Checks if a rendered frame can be seen.
+		 *
+		 * The window isn't presentable while iconified or while its framebuffer is empty (zero width or height).
+		 * Renderer::Render() and SwapBuffers() then do nothing, and InputManager::FinalizeInput() sleeps on
+		 * events for up to the idle event timeout instead of polling, so a minimized window costs no GPU time.
+		 * Thread-safe, the render thread reads it.
+		 *
+		 * @return True if frames should be rendered and presented.
+		 */
+		[[nodiscard]] bool IsPresentable() const;
+
+		/**
+		 * @brief Sets how long InputManager::FinalizeInput() sleeps waiting for events while the window isn't presentable.
+		 *
+		 * The simulation keeps ticking at that rate; a restore or any other event wakes it at once.
+		 *
+		 * @param Seconds The maximum sleep, 0.1 seconds by default.
+		 */
+		void SetIdleEventTimeout(double Seconds);
+
+		/** @brief Retrieves the maximum event wait while the window isn't presentable, in seconds. */
+		[[nodiscard]] double GetIdleEventTimeout() const;
+
+		/**
+		 * @brief Sets the multisampling of the default framebuffer, applied by the next Initialize().
+		 *
+		 * Every sample multiplies the color and depth bandwidth of the frames drawn into the window. With the
+		 * renderer set to another anti-aliasing than MSAA (see Renderer::SetAntiAliasing()), or drawing offscreen,
+		 * the window's samples only cost without smoothing anything: 0 is then the cheaper choice.
+		 *
+		 * @param Samples Samples per pixel, 0 to disable multisampling. Defaults to 4.
+		 */
+		void SetSamples(int Samples);
+
+		/** @brief Retrieves the multisampling requested for the default framebuffer. */
+		[[nodiscard]] int GetSamples() const;
+
 		/**
 		 * @brief Gets the current window title.
 		 *
@@ -135,6 +185,75 @@ namespace fgl
 		 */
 		void SetVSync(bool VSyncEnabled);
 
+		/**
+		 * @brief Sets how buffer swaps wait for the display refresh.
+		 *
+		 * Adaptive VSync only tears frames that missed their refresh instead of waiting a whole extra refresh for them.
+		 * It needs WGL_EXT_swap_control_tear or GLX_EXT_swap_control_tear, without them the mode falls back to On.
+		 *
+		 * @param Mode The synchronization to use.
+		 * @return The mode applied, On if Adaptive isn't supported.
+		 */
+		VSyncMode SetVSyncMode(VSyncMode Mode);
+
+		/**
+		 * @brief Caps the frame rate, each buffer swap waiting for its deadline (see FrameLimiter).
+		 *
+		 * Useful with VSync off to pace frames evenly and save power, or below the refresh rate with VSync on.
+		 *
+		 * @param FramesPerSecond The cap, zero or less (the default) for no cap.
+		 */
+		void SetFrameRateLimit(double FramesPerSecond);
+
+		/** @brief Retrieves the frame limiter, e.g. for the time the last frame waited. */
+		FrameLimiter& GetFrameLimiter();
+
+		/**
+		 * @brief Waits for the frame deadline if the frame rate is capped, swaps the buffers and marks the frame for the profiler.
+		 *
+		 * Called by InputManager::FinalizeInput(), or at the end of each frame submitted to the render thread.
+		 */
+		void SwapBuffers();
+
+		/**
+		 * @brief Moves the OpenGL context to a dedicated render thread, or back to the calling thread.
+		 *
+		 * With the render thread running, frames are submitted to it (see RenderThread::SubmitFrame()) while the
+		 * main thread polls events and simulates the next frame; it swaps the buffers itself, InputManager::FinalizeInput()
+		 * then only polls events. Nothing may call OpenGL on the main thread until it is disabled again.
+		 *
+		 * @param bEnabled True to start the render thread, false (the default) to stop it.
+		 */
+		void SetRenderThread(bool bEnabled);
+
+		/** @brief Retrieves the render thread, running only after SetRenderThread(true). */
+		RenderThread& GetRenderThread();
+
+		/**
+		 * @brief Starts or stops the background thread uploading resources through a hidden shared context.
+		 *
+		 * While it runs, Model texture uploads and Texture::UploadImageAsync() leave the main thread, which
+		 * only polls their fences. Must be called from the main thread.
+		 *
+		 * @param bEnabled True to start the upload thread, false (the default) to stop it.
+		 * @return True if the thread is in the requested state, false if the shared context couldn't be created.
+		 */
+		bool SetUploadThread(bool bEnabled);
+
+		/** @brief Retrieves the upload thread, running only after SetUploadThread(true). */
+		GLUploadThread& GetUploadThread();
+
+		/**
+		 * @brief Enables or disables raw mouse motion, where the platform supports it.
+		 *
+		 * Raw motion skips the desktop's pointer acceleration and scaling, so camera rotation follows the
+		 * mouse exactly. It only applies while the cursor is disabled, i.e. while the window is focused.
+		 *
+		 * @param bEnabled True to read unaccelerated motion, false (the default) for the desktop's.
+		 * @return False if raw motion was requested but isn't supported, the setting is then left unchanged.
+		 */
+		bool SetRawMouseMotion(bool bEnabled);
+
 		/**
 		 * @brief Updates the window's title.
 		 *
@@ -329,6 +448,8 @@ namespace fgl
 		 * Override this function to register your custom callback functions for window
 		 * events. This function provides the flexibility to add custom behavior
 		 * based on your application's needs.
+		 *
+		 * @note The InputManager's key state is fed by the key callback, a replacement must forward to InputManager::UpdateKey().
 		 */
 		virtual void OnRegisterCallbacks();
 
@@ -337,7 +458,7 @@ namespace fgl
 		 *
 		 * This function is called when the framebuffer size changes (e.g., on window
 		 * resize). The default implementation sets the OpenGL view to match the new
-		 * size, but you can override it to apply custom behavior.
+		 * size, through the render thread while it runs, but you can override it to apply custom behavior.
 		 * @param Width The new width of the framebuffer.
 		 * @param Height The new height of the framebuffer.
 		 */
@@ -445,8 +566,9 @@ namespace fgl
 		* @brief Configures input modes for the window.
 		*
 		* Sets input-related behaviors such as cursor visibility and locking.
+		* Hidden windows keep the cursor, a headless process mustn't capture it.
 		*/
-		void SetupInputModes();
+		void SetupInputModes(WindowType WindowType);
 
 		/**
 		* @brief Registers all GLFW event callbacks for the window.
@@ -526,10 +648,18 @@ namespace fgl
 		static void glfwMouseButtonCallback(GLFWwindow* Window, int Button, int Action, int Mods);
 		static void glfwMouseMoveCallback(GLFWwindow* window, double xpos, double ypos);
 		static void glfwScrollCallback(GLFWwindow* window, double xoffset, double yoffset);
+		static void glfwKeyCallback(GLFWwindow* Window, int Key, int Scancode, int Action, int Mods);
 	
 	private:
 		bool m_WindowFocused = true;			///< Tracks the focus state of the window.
+		std::atomic<bool> m_bIconified{ false };		///< Set by the iconify callback, read by the render thread.
+		std::atomic<bool> m_bFramebufferEmpty{ false };	///< Set while the framebuffer has a zero width or height.
+		double m_IdleEventTimeout = 0.1;		///< Maximum event wait while not presentable, in seconds.
+		int m_Samples = 4;						///< Samples per pixel of the default framebuffer.
 		GLFWwindow* m_CurrentWindow = nullptr;	///< Pointer to the GLFW window instance.
+		FrameLimiter m_FrameLimiter;			///< Paces the buffer swaps when the frame rate is capped.
+		RenderThread m_RenderThread;			///< Owns the OpenGL context while enabled.
+		GLUploadThread m_UploadThread;			///< Uploads resources through a shared context while enabled.
 	};
 
 } // namespace fgl
\ No newline at end of file
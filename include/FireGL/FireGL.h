@@ -7,10 +7,23 @@
 #include <FireGL/Core/BaseLog.h>
 #include <FireGL/Core/BaseSingletonManager.h>
 #include <FireGL/Core/InputManager.h>
+#include <FireGL/Core/InputRecording.h>
+#include <FireGL/Core/FunctionRef.h>
+#include <FireGL/Core/FlatHashMap.h>
+#include <FireGL/Core/Symbol.h>
+#include <FireGL/Core/GLDebug.h>
 #include <FireGL/Core/SystemManager.h>
 #include <FireGL/Core/TimeManager.h>
+#include <FireGL/Core/TimerWheel.h>
 #include <FireGL/Core/Window.h>
 #include <FireGL/Core/AssetPathManager.h>
+#include <FireGL/Core/MappedFile.h>
+#include <FireGL/Core/JobSystem.h>
+#include <FireGL/Core/FrameTaskGraph.h>
+#include <FireGL/Core/AsyncTask.h>
+#include <FireGL/Core/MemoryTracker.h>
+#include <FireGL/Core/FrameArena.h>
+#include <FireGL/Core/StartupTimeline.h>
 
 // #Renderer: Rendering-related headers and components
 #include <FireGL/Renderer/Entity.h>
@@ -19,14 +32,82 @@
 #include <FireGL/Renderer/Model.h>
 #include <FireGL/Renderer/Renderer.h>
 #include <FireGL/Renderer/Scene.h>
+#include <FireGL/Renderer/RenderLayers.h>
 #include <FireGL/Renderer/SceneObject.h>
+#include <FireGL/Renderer/StaticGeometry.h>
+#include <FireGL/Renderer/ImpostorAtlas.h>
+#include <FireGL/Renderer/Terrain.h>
+#include <FireGL/Renderer/DynamicMesh.h>
+#include <FireGL/Renderer/VirtualTexture.h>
+#include <FireGL/Renderer/PostProcessStack.h>
+#include <FireGL/Renderer/AmbientOcclusion.h>
+#include <FireGL/Renderer/VolumetricFog.h>
+#include <FireGL/Renderer/Lightmap.h>
+#include <FireGL/Renderer/ReflectionProbes.h>
+#include <FireGL/Renderer/TextureCameras.h>
+#include <FireGL/Renderer/DebugDraw.h>
 #include <FireGL/Renderer/Shader.h>
 #include <FireGL/Renderer/Texture.h>
+#include <FireGL/Renderer/TextureCache.h>
+#include <FireGL/Renderer/SamplerCache.h>
+#include <FireGL/Renderer/MipGenerator.h>
+#include <FireGL/Renderer/GPUMemoryTracker.h>
+#include <FireGL/Renderer/TextureContainer.h>
+#include <FireGL/Renderer/ImageDecoder.h>
+#include <FireGL/Renderer/PixelUploadPool.h>
+#include <FireGL/Renderer/TextureArrayPool.h>
+#include <FireGL/Renderer/GLExtensions.h>
+#include <FireGL/Renderer/MaterialBuffer.h>
+#include <FireGL/Renderer/MaterialInstanceBuffer.h>
+#include <FireGL/Renderer/TextureStreamer.h>
+#include <FireGL/Renderer/ShaderCache.h>
+#include <FireGL/Renderer/LightUniformBuffer.h>
+#include <FireGL/Renderer/LocalShadowAtlas.h>
+#include <FireGL/Renderer/ShaderHotReloader.h>
+#include <FireGL/Renderer/ShaderVariants.h>
+#include <FireGL/Renderer/ClusteredLightManager.h>
+#include <FireGL/Renderer/ObjectLightAssigner.h>
+#include <FireGL/Renderer/GBuffer.h>
+#include <FireGL/Renderer/ParticleSystem.h>
+#include <FireGL/Renderer/QualityGovernor.h>
+#include <FireGL/Renderer/SpriteBatch.h>
+#include <FireGL/Renderer/PerformanceHUD.h>
+#include <FireGL/Renderer/HitchRecorder.h>
+#include <FireGL/Renderer/ObjectPicker.h>
+#include <FireGL/Renderer/Skeleton.h>
+#include <FireGL/Renderer/AnimationClip.h>
+#include <FireGL/Renderer/AnimationSystem.h>
+#include <FireGL/Renderer/DynamicBVH.h>
+#include <FireGL/Renderer/PortalGraph.h>
+#include <FireGL/Renderer/TransformPool.h>
+#include <FireGL/Renderer/ComponentPool.h>
+#include <FireGL/Renderer/ObjectPool.h>
 #include <FireGL/Renderer/Vertex.h>
 #include <FireGL/Renderer/MatrixBuffer.h>
+#include <FireGL/Renderer/CameraUniformBuffer.h>
 #include <FireGL/Renderer/Component.h>
 #include <FireGL/Renderer/Transform.h>
+#include <FireGL/Renderer/ProceduralAnimation.h>
 #include <FireGL/Renderer/Shapes/Shape.h>
 #include <FireGL/Renderer/Shapes/Cube.h>
 #include <FireGL/Renderer/Shapes/Sphere.h>
-#include <FireGL/Renderer/BaseCamera.h>
\ No newline at end of file
+#include <FireGL/Renderer/BaseCamera.h>
+#include <FireGL/Renderer/BoundingVolume.h>
+#include <FireGL/Renderer/OverlapSystem.h>
+#include <FireGL/Renderer/TickScheduler.h>
+#include <FireGL/Renderer/SceneFile.h>
+#include <FireGL/Renderer/WorldStreamer.h>
+#include <FireGL/Renderer/Frustum.h>
+#include <FireGL/Renderer/FrustumCulling.h>
+#include <FireGL/Renderer/RenderQueue.h>
+#include <FireGL/Renderer/GLStateCache.h>
+#include <FireGL/Renderer/RasterState.h>
+#include <FireGL/Renderer/IndirectDrawBuffer.h>
+#include <FireGL/Renderer/GeometryArena.h>
+#include <FireGL/Renderer/RenderDevice.h>
+#include <FireGL/Renderer/OpenGLRenderDevice.h>
+#include <FireGL/Renderer/MeshOptimizer.h>
+#include <FireGL/Renderer/MeshCache.h>
+#include <FireGL/Renderer/ModelLoader.h>
+#include <FireGL/Renderer/AssetCooker.h>
+#include <FireGL/Renderer/AsyncAssets.h>
\ No newline at end of file
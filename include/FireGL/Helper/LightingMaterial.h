@@ -7,16 +7,38 @@ namespace fgl
 	class Shader;
 
 	/**
-	 * This class handles the application of lighting uniforms, including directional, point, and spotlights,
-	 * as well as camera position and material properties for proper shading in the scene.
+	 * Parameters of a LightingMaterial, mirroring its "MaterialParameters" block in std140:
+	 *
+	 *     layout (std140) uniform MaterialParameters
+	 *     {
+	 *         float Shininess;
+	 *     } Parameters;
+	 */
+	struct LightingParameters
+	{
+		float Shininess = 32.0f; ///< Specular exponent.
+		float Padding[3] = {};   ///< std140 rounds the block up to 16 bytes.
+	};
+
+	/**
+	 * This class handles the shading parameters of lit surfaces. The directional, point and spot lights
+	 * and the camera position come from the per-frame "LightData" and "CameraData" blocks, bound once per
+	 * frame by the renderer, so drawing with this material sends no light uniform.
 	 */
 	class LightingMaterial : public Material
 	{
 	public:
 		LightingMaterial(Shader* Shader);
 
-	protected:
-		virtual void ApplyUniforms() override;
+		/**
+		 * Sets the specular exponent, uploaded with the parameter block on the next activation.
+		 *
+		 * @param Shininess The specular exponent.
+		 */
+		void SetShininess(float Shininess);
+
+	private:
+		LightingParameters m_Parameters; ///< Current contents of the parameter block.
 	};
 
 } // namespace fgl
\ No newline at end of file
@@ -6,7 +6,13 @@ namespace fgl
 {
 
 	/** 
-	 * Simple Skybox class derived from Entity to demonstrate what can be done with custom rendering logic
+	 * Simple Skybox class derived from Entity, drawn after the opaque batches.
+	 * Its SkyboxMaterial carries the depth function and culling that keep it behind other objects.
+	 *
+	 * Renderer::SetSkybox() draws a sky cheaper, without geometry or an instance slot; a SkyboxEntity is then not drawn.
+	 *
+	 * The renderer records it into a RenderCommandList replayed by RenderDevice::ExecuteCommands(): its cube map,
+	 * program, vertex array and draw all go through the RenderDevice.
 	 */
 	class SkyboxEntity : public Entity
 	{
@@ -14,19 +20,6 @@ namespace fgl
 		using Entity::Entity;
 
 		virtual bool IsSkybox() const override { return true; }
-
-	protected:
-		virtual void OnPrepareRender() const override
-		{
-			// Skybox will be rendered behind other objects.
-			glDepthFunc(GL_LEQUAL);
-		}
-
-		virtual void OnPostRender() const override
-		{
-			// Restores the default depth function for further rendering.
-			glDepthFunc(GL_LESS);
-		}
 	};
 
 } // namespace fgl
\ No newline at end of file
@@ -9,6 +9,7 @@ namespace fgl
 	/** 
 	 * This class customizes the material for the skybox, ensuring it is rendered as infinite by 
 	 * manually applying the projection and view matrices without model transformations.
+	 * Its raster state draws the inside of the cube at the far plane: front faces culled, GL_LEQUAL depth test.
 	 */
 	class SkyboxMaterial : public Material
 	{
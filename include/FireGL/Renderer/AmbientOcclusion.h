@@ -0,0 +1,111 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+#include <FireGL/Renderer/Shader.h>
+#include <FireGL/Renderer/RenderTargetPool.h>
+
+#include <External/glad/glad.h>
+
+namespace fgl
+{
+	struct CameraData;
+
+	/** Parameters of an AmbientOcclusion. */
+	struct AmbientOcclusionSettings
+	{
+		float Radius = 0.5f;      ///< World distance around a point its occluders are searched within.
+		float Intensity = 1.0f;   ///< Darkening of the occluded points, 0 to disable.
+		float Bias = 0.02f;       ///< World distance an occluder must rise above the surface's plane to count: hides the self-occlusion of tessellated curves.
+		float Sharpness = 4.0f;   ///< Depth sensitivity of the blur and the upsample, higher keeps the edges sharper.
+	};
+
+	/**
+	 * Screen-space ambient occlusion computed from the depth prepass, at half resolution.
+	 *
+	 * Compute() runs between the prepass and the shading, on the depth the prepass just wrote:
+	 *  - the depth is copied, then downsampled to a half-resolution R32F target of view distances;
+	 *  - every half-resolution pixel reconstructs its position and normal from the distances and tests
+	 *    SampleCount points on a spiral around it. The spiral is rotated by a 4x4 interleaved pattern, so
+	 *    neighbouring pixels test different directions and 16 pixels together cover the full disk;
+	 *  - a separable blur, weighted by the depth difference, averages the pattern away without bleeding
+	 *    over the silhouettes;
+	 *  - a joint bilateral upsample writes the full-resolution result, each pixel taking the four closest
+	 *    half-resolution ones weighted by how close their depth is to its own, so edges stay sharp.
+	 * The passes touch a quarter of the pixels but the last, about 1 ms at 1080p on midrange hardware.
+	 *
+	 * The result is bound at TextureUnit as SamplerName, registered in the shaders' default samplers, until
+	 * the next Compute(). Lighting shaders multiply their ambient term by it, reading it at gl_FragCoord:
+	 * while AO is off a white 1x1 texture is bound instead, so they need no variant without it.
+	 */
+	class AmbientOcclusion
+	{
+	public:
+		static constexpr uint32_t TextureUnit = 28;                          ///< Texture unit the occlusion is sampled from.
+		static constexpr const char* SamplerName = "AmbientOcclusionMap";    ///< Name of the occlusion sampler in GLSL.
+		static constexpr int SampleCount = 8;                                ///< Points tested per half-resolution pixel.
+		static constexpr GLint DepthUnit = 0;                                ///< Texture unit of the depth read by the passes.
+		static constexpr GLint SourceUnit = 1;                               ///< Texture unit of the occlusion read by the passes.
+
+		AmbientOcclusion() = default;
+
+		/** Deletes the textures and the shaders. */
+		~AmbientOcclusion();
+
+		AmbientOcclusion(const AmbientOcclusion&) = delete;
+		AmbientOcclusion& operator=(const AmbientOcclusion&) = delete;
+
+		/** Creates the white texture and binds it to TextureUnit. Requires a current OpenGL context. */
+		void Create();
+
+		/** Deletes the textures, the targets and the shaders. */
+		void Destroy();
+
+		/** @return True once Create() was called. */
+		bool IsCreated() const;
+
+		/** @return The parameters read by every Compute(). */
+		AmbientOcclusionSettings& GetSettings();
+
+		/** @return The parameters read by every Compute(). */
+		const AmbientOcclusionSettings& GetSettings() const;
+
+		/**
+		 * Computes the occlusion of the depth in the viewport of the bound draw framebuffer and binds it to TextureUnit.
+		 * The framebuffers, viewport and depth test are restored; changes the program, vertex array and texture
+		 * units DepthUnit and SourceUnit.
+		 *
+		 * @param Camera The camera data the depth was drawn with, its projection perspective.
+		 */
+		void Compute(const CameraData& Camera);
+
+		/** Binds the white texture to TextureUnit, the lighting is then unoccluded. */
+		void Disable();
+
+		/** @return The number of full-screen passes the last Compute() drew. */
+		uint32_t GetPassCount() const;
+
+	private:
+		/** Allocates the depth copy for a viewport size and a depth format. */
+		void AllocateDepthCopy(GLint Width, GLint Height, GLenum DepthFormat);
+
+		/** Draws the full-screen triangle with the active program. */
+		void DrawFullScreen();
+
+		AmbientOcclusionSettings m_Settings;          ///< Parameters of the passes.
+		RenderTargetPool m_Targets;                   ///< Half-resolution passes and the result, reused across frames.
+		PooledTarget m_Result;                        ///< Full-resolution occlusion of the last Compute(), held until the next one.
+		GLuint m_WhiteTexture = 0;                    ///< 1x1 unoccluded texture bound while AO is off.
+		GLuint m_DepthCopy = 0;                       ///< Single-sampled copy of the depth, in the format of the source.
+		GLuint m_DepthFramebuffer = 0;                ///< Framebuffer of m_DepthCopy, blit target.
+		GLint m_DepthWidth = 0;                       ///< Width of m_DepthCopy.
+		GLint m_DepthHeight = 0;                      ///< Height of m_DepthCopy.
+		GLenum m_DepthFormat = 0;                     ///< Sized internal format of m_DepthCopy.
+		std::unique_ptr<Shader> m_DownsampleShader;   ///< Converts the depth copy to half-resolution view distances.
+		std::unique_ptr<Shader> m_OcclusionShader;    ///< Tests the spiral of points around every half-resolution pixel.
+		std::unique_ptr<Shader> m_BlurShader;         ///< Depth-aware blur along one axis.
+		std::unique_ptr<Shader> m_UpsampleShader;     ///< Joint bilateral upsample to the full resolution.
+		GLuint m_FullScreenVertexArray = 0;           ///< Empty vertex array, the triangle is generated from gl_VertexID.
+		uint32_t m_PassCount = 0;                     ///< Full-screen passes of the last Compute().
+	};
+
+} // namespace fgl
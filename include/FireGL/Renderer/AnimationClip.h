@@ -0,0 +1,157 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+
+#include <External/glm/mat4x4.hpp>
+#include <External/glm/vec3.hpp>
+#include <External/glm/gtc/quaternion.hpp>
+
+struct aiAnimation;
+
+namespace fgl
+{
+	class Skeleton;
+
+	/**
+	 * Local translation, rotation and scale of every node of a Skeleton, in structure-of-arrays layout.
+	 *
+	 * Each component has its own array of GetStride() floats, the node count rounded up to a multiple of 4,
+	 * so sampling and blending process four nodes per SSE2 / NEON instruction without a scalar tail. The
+	 * padding nodes hold the identity and are never read back.
+	 */
+	class SkeletonPose
+	{
+	public:
+		/** Arrays of a pose, each holding one value per node. */
+		enum Component : uint32_t
+		{
+			TranslationX, TranslationY, TranslationZ,
+			RotationX, RotationY, RotationZ, RotationW,
+			ScaleX, ScaleY, ScaleZ,
+			ComponentCount
+		};
+
+		/**
+		 * Sets the number of nodes, every node reset to the identity. Does nothing if it doesn't change.
+		 *
+		 * @param NodeCount The nodes of the skeleton the pose is for.
+		 */
+		void Resize(uint32_t NodeCount);
+
+		/** @return The number of nodes. */
+		uint32_t GetNodeCount() const;
+
+		/** @return The length of each component array, GetNodeCount() rounded up to a multiple of 4. */
+		uint32_t GetStride() const;
+
+		/**
+		 * Sets the local transform of one node.
+		 *
+		 * @param Node The index of the node.
+		 * @param Translation The translation relative to the parent.
+		 * @param Rotation The rotation, normalized.
+		 * @param Scale The scale along each axis.
+		 */
+		void SetNode(uint32_t Node, const glm::vec3& Translation, const glm::quat& Rotation, const glm::vec3& Scale);
+
+		/**
+		 * Sets the local transform of one node from a matrix without shear.
+		 *
+		 * @param Node The index of the node.
+		 * @param Transform The transform relative to the parent.
+		 */
+		void SetNode(uint32_t Node, const glm::mat4& Transform);
+
+		/** @return The GetStride() values of one component. */
+		float* GetComponent(Component Index);
+
+		/** @return The GetStride() values of one component. */
+		const float* GetComponent(Component Index) const;
+
+		/**
+		 * Blends two poses of the same skeleton, translations and scales linearly, rotations along the shortest
+		 * arc, normalized (nlerp). Out may be A or B.
+		 *
+		 * @param A The pose at weight 0.
+		 * @param B The pose at weight 1.
+		 * @param Weight How much of B the result takes, from 0 to 1.
+		 * @param Out Receives the blended pose.
+		 */
+		static void Blend(const SkeletonPose& A, const SkeletonPose& B, float Weight, SkeletonPose& Out);
+
+		/**
+		 * Builds the local matrix of every node.
+		 *
+		 * @param Transforms Receives GetNodeCount() matrices.
+		 */
+		void GetTransforms(std::vector<glm::mat4>& Transforms) const;
+
+	private:
+		uint32_t m_NodeCount = 0;        ///< Nodes of the pose.
+		uint32_t m_Stride = 0;           ///< Values per component, a multiple of 4.
+		std::vector<float> m_Components; ///< ComponentCount arrays of m_Stride values.
+	};
+
+	/**
+	 * Animation of a Skeleton's nodes, imported with Assimp and stored compactly for sampling crowds.
+	 *
+	 * The keys of the file are resampled at a fixed rate when imported, with exact interpolation (spherical for
+	 * rotations), so sampling needs no key search: a time maps straight to two frames, interpolated with nlerp,
+	 * which the dense frames keep indistinguishable from slerp. Every node has a value in every frame, stored
+	 * component by component like SkeletonPose, quantized to 16 bits:
+	 * - rotations as signed normalized components, each frame on the same hemisphere as the previous one;
+	 * - translations and scales as unsigned normalized components within the range of their node.
+	 * A frame of a 64-node skeleton takes 1.25 KB, so the clips a crowd plays stay in cache while it is sampled.
+	 */
+	class AnimationClip
+	{
+	public:
+		static constexpr float DefaultFrameRate = 30.0f; ///< Frames per second of imported clips.
+
+		/**
+		 * Resamples and quantizes an imported animation.
+		 *
+		 * @param Animation The animation read by Assimp.
+		 * @param Target The skeleton imported from the same scene, channels of unknown nodes are dropped.
+		 * @param FrameRate Frames per second stored, at least 1.
+		 * @return The clip, its times converted to seconds (25 ticks per second when the file doesn't say).
+		 */
+		static AnimationClip Import(const aiAnimation* Animation, const Skeleton& Target, float FrameRate = DefaultFrameRate);
+
+		/** @return The name of the animation in the imported file. */
+		const std::string& GetName() const;
+
+		/** @return The length of the clip in seconds. */
+		float GetDuration() const;
+
+		/** @return The number of nodes animated, the node count of the skeleton. */
+		uint32_t GetNodeCount() const;
+
+		/** @return The size of the frames and ranges in bytes. */
+		size_t GetMemorySize() const;
+
+		/**
+		 * Evaluates the local transform of every node at a time of the clip.
+		 *
+		 * @param Time The time in seconds, wrapped to the clip when bLoop is set, clamped to it otherwise.
+		 * @param Pose Receives the pose, resized to the node count of the clip.
+		 * @param bLoop Whether the clip repeats.
+		 */
+		void Sample(float Time, SkeletonPose& Pose, bool bLoop = true) const;
+
+	private:
+		/** Quantized translation and scale components, in SkeletonPose order. */
+		static constexpr uint32_t RangeComponentCount = 6;
+
+		std::string m_Name;                   ///< Name of the animation in the imported file.
+		float m_Duration = 0.0f;              ///< Length in seconds.
+		float m_FrameRate = DefaultFrameRate; ///< Frames per second.
+		uint32_t m_FrameCount = 0;            ///< Frames stored, the last one at or after m_Duration.
+		uint32_t m_NodeCount = 0;             ///< Nodes of the skeleton.
+		uint32_t m_Stride = 0;                ///< Values per component and frame, a multiple of 4.
+		std::vector<uint16_t> m_Frames;       ///< SkeletonPose::ComponentCount arrays of m_Stride values per frame.
+		std::vector<float> m_RangeMin;        ///< Lowest value of each translation and scale component, per node.
+		std::vector<float> m_RangeScale;      ///< Value of one quantization step of each translation and scale component, per node.
+	};
+
+} // namespace fgl
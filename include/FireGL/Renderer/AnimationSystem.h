@@ -0,0 +1,111 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+#include <FireGL/Renderer/AnimationClip.h>
+
+namespace fgl
+{
+	class JobSystem;
+	class Skeleton;
+	class BonePaletteBuffer;
+
+	/**
+	 * Plays animation clips on many skinned objects and writes their palettes.
+	 *
+	 * Every instance plays one clip, optionally cross-fading from the previous one. Update() samples, blends and
+	 * evaluates the palettes of all instances in parallel on the job system, each job with its own scratch poses,
+	 * then writes them to the BonePaletteBuffer on the calling thread. The skeletons and clips are referenced,
+	 * not copied: they must outlive the instances playing them (see Model::GetSkeleton() and Model::GetAnimations()).
+	 */
+	class AnimationSystem
+	{
+	public:
+		/**
+		 * Adds an animated object, in the rest pose until a clip is played.
+		 *
+		 * @param Target The skeleton of the object's model.
+		 * @param BoneOffset The palette allocated for the object in the BonePaletteBuffer.
+		 * @return The index of the instance, given to the other functions.
+		 */
+		uint32_t AddInstance(const Skeleton& Target, uint32_t BoneOffset);
+
+		/**
+		 * Stops animating an object, its index is reused by a later AddInstance().
+		 *
+		 * @param Instance The index returned by AddInstance().
+		 */
+		void RemoveInstance(uint32_t Instance);
+
+		/**
+		 * Starts playing a clip right away, any fade in progress is dropped.
+		 *
+		 * @param Instance The index returned by AddInstance().
+		 * @param Clip The clip, imported for the instance's skeleton.
+		 * @param StartTime The time of the clip to start from, in seconds.
+		 * @param bLoop Whether the clip repeats, it holds its last frame otherwise.
+		 */
+		void Play(uint32_t Instance, const AnimationClip& Clip, float StartTime = 0.0f, bool bLoop = true);
+
+		/**
+		 * Fades from the clip playing to another one, both advancing during the fade.
+		 *
+		 * @param Instance The index returned by AddInstance().
+		 * @param Clip The clip, imported for the instance's skeleton, started from its beginning.
+		 * @param Duration The length of the fade in seconds, 0 to switch right away.
+		 * @param bLoop Whether the clip repeats.
+		 */
+		void CrossFade(uint32_t Instance, const AnimationClip& Clip, float Duration, bool bLoop = true);
+
+		/**
+		 * @param Instance The index returned by AddInstance().
+		 * @param Speed The playback rate, 1 for real time.
+		 */
+		void SetSpeed(uint32_t Instance, float Speed);
+
+		/**
+		 * Sets the job system the instances are updated on.
+		 *
+		 * @param Jobs The job system, nullptr to update on the calling thread.
+		 * @param ChunkSize The number of instances updated per job.
+		 */
+		void SetJobSystem(JobSystem* Jobs, size_t ChunkSize = 16);
+
+		/**
+		 * Advances every instance, then writes its palette.
+		 *
+		 * @param DeltaTime The time elapsed since the last update, in seconds.
+		 * @param Palettes The buffer the instances' palettes were allocated in.
+		 */
+		void Update(float DeltaTime, BonePaletteBuffer& Palettes);
+
+		/** @return The number of instances, removed ones excluded. */
+		uint32_t GetInstanceCount() const;
+
+	private:
+		/** Playback state of one animated object. */
+		struct Instance
+		{
+			const Skeleton* Target = nullptr;         ///< Skeleton of the object, nullptr once removed.
+			uint32_t BoneOffset = 0;                  ///< First bone of the object's palette.
+			const AnimationClip* Clip = nullptr;      ///< Clip playing, nullptr for the rest pose.
+			const AnimationClip* FadeFrom = nullptr;  ///< Clip faded out, nullptr when not fading.
+			float Time = 0.0f;                        ///< Time of Clip in seconds.
+			float FadeFromTime = 0.0f;                ///< Time of FadeFrom in seconds.
+			float FadeElapsed = 0.0f;                 ///< Seconds since the fade started.
+			float FadeDuration = 0.0f;                ///< Length of the fade in seconds.
+			float Speed = 1.0f;                       ///< Playback rate.
+			bool bLoop = true;                        ///< Whether Clip repeats.
+			bool bFadeFromLoop = true;                ///< Whether FadeFrom repeats.
+			std::vector<glm::mat4> Palette;           ///< Skinning matrices computed by the last update.
+		};
+
+		/** Advances one instance and computes its palette, thread-safe across instances. */
+		static void UpdateInstance(Instance& Animated, float DeltaTime);
+
+		std::vector<Instance> m_Instances;  ///< Instances by index, removed ones included.
+		std::vector<uint32_t> m_FreeList;   ///< Indices of removed instances.
+		JobSystem* m_JobSystem = nullptr;   ///< Job system the instances are updated on, nullptr for the calling thread.
+		size_t m_ChunkSize = 16;            ///< Instances updated per job.
+	};
+
+} // namespace fgl
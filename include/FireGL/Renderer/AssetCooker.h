@@ -0,0 +1,87 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+#include <FireGL/Core/AssetArchive.h>
+#include <FireGL/Renderer/Model.h>
+
+#include <filesystem>
+
+namespace fgl
+{
+	class AssetPathManager;
+	class JobSystem;
+
+	/** Options of AssetCooker::Cook(). */
+	struct AssetCookSettings
+	{
+		std::string OutputDirectory;                  ///< Receives the cooked files and the rewritten config file, laid out as the config file's directory.
+		ModelImportSettings Import;                   ///< Optimizations and levels of detail the models are cooked with; load them with the same geometry settings.
+		bool bCompressTextures = true;                ///< Whether images become BC1 or BC3 KTX2 files with their mip chain, rather than copies.
+		std::vector<std::string> RawKeys;             ///< Keys whose files are copied as they are, e.g. cube map faces, which are loaded unflipped.
+		std::string ArchivePath;                      ///< AssetArchive built from OutputDirectory once cooked, none when empty.
+		AssetArchive::Compression ArchiveCompression = AssetArchive::Compression::None; ///< Compression of the archive entries.
+		JobSystem* Jobs = nullptr;                    ///< Job system the images are encoded on, and the models imported on unless Import.Jobs is set.
+	};
+
+	/**
+	 * Offline preprocessing of the assets listed in a config file (see AssetPathManager), so the runtime only
+	 * maps and uploads them. Runs without an OpenGL context, e.g. in the FireGLCook tool.
+	 *
+	 * Every key naming a file is cooked into OutputDirectory, at the same place relative to the config file:
+	 * - Models are imported once with the import settings and written as cooked MeshCache files, loaded by
+	 *   Model from the `.fglmesh` path without Assimp nor the source file. Their textures are cooked along.
+	 * - Images are encoded to BC1, or BC3 when they have alpha, with their whole mip chain, and written as
+	 *   `.ktx2` files next to where the image was; they are flipped for OpenGL like Texture::LoadTexture() does.
+	 * - Every other file, shaders included, is copied. Shaders are compiled to SPIR-V at build time instead,
+	 *   see `fgl_compile_spirv()` in CMake.
+	 * The config file is written to OutputDirectory with the cooked files' extensions appended to their keys'
+	 * values, so the same keys resolve to the cooked files. Keys naming directories are kept as they are.
+	 */
+	class AssetCooker
+	{
+	public:
+		/**
+		 * Cooks every asset of a config file.
+		 *
+		 * @param ConfigPath The config file to cook, as loaded by Paths.
+		 * @param Paths The paths resolved from the config file.
+		 * @param Settings Where and how to cook.
+		 * @return False if any asset failed to cook, the others are cooked anyway.
+		 */
+		static bool Cook(std::string_view ConfigPath, const AssetPathManager& Paths, const AssetCookSettings& Settings);
+
+	private:
+		/** An image encoded to a KTX2 file. */
+		struct ImageJob
+		{
+			std::filesystem::path Source; ///< The image file.
+			std::filesystem::path Output; ///< The .ktx2 file written.
+			bool bCooked = false;         ///< Set once written.
+		};
+
+		/** @return True if the file extension is one Assimp imports models from. */
+		static bool IsModel(const std::filesystem::path& Path);
+
+		/** @return True if the file extension is one of the 8-bit images Texture::DecodeImage() reads. */
+		static bool IsImage(const std::filesystem::path& Path);
+
+		/**
+		 * Imports a model and writes its cooked MeshCache, encoding the images it references first.
+		 *
+		 * @param Source The model file.
+		 * @param Output The cooked path of the model file, the cache is written there with MeshCache::Extension.
+		 * @param Settings The cook options.
+		 * @param CookedImages Outputs of the images already encoded and whether they succeeded, shared between models.
+		 * @return False if the model couldn't be imported or written.
+		 */
+		static bool CookModel(const std::filesystem::path& Source, const std::filesystem::path& Output, const AssetCookSettings& Settings,
+			std::unordered_map<std::string, bool>& CookedImages);
+
+		/** Encodes images, on the job system when one is set. */
+		static void CookImages(std::vector<ImageJob>& Jobs, JobSystem* JobSystem);
+
+		/** Copies a file, creating its directory. */
+		static bool CopyAsset(const std::filesystem::path& Source, const std::filesystem::path& Output);
+	};
+
+} // namespace fgl
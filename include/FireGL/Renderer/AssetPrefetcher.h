@@ -0,0 +1,79 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+#include <FireGL/Core/JobSystem.h>
+#include <FireGL/Renderer/Texture.h>
+
+#include <mutex>
+#include <unordered_set>
+
+namespace fgl
+{
+
+	/**
+	 * Reads every file a level needs in parallel, ahead of the loads, from the dependencies of an AssetManifest.
+	 *
+	 * Loaders discover dependencies while parsing, so a model reads its textures only once its own file is
+	 * parsed, paying the latency of each read in turn. Prefetch() instead schedules one job per file on a
+	 * JobSystem up front, keeping as many reads in flight as there are workers:
+	 * - Images are decoded as Model textures are, and kept until a Model needing them takes them with
+	 *   TakeImage() instead of decoding them again.
+	 * - Other files, e.g. models and shaders, are read through once, so the loads find them in the OS page
+	 *   cache (or the pages of a mounted AssetArchive resident).
+	 *
+	 * Prefetch() and Wait() run on the thread owning the prefetcher; TakeImage() is thread-safe.
+	 */
+	class AssetPrefetcher
+	{
+	public:
+		/**
+		 * @param Jobs The job system the reads are scheduled on, must outlive the prefetcher.
+		 */
+		explicit AssetPrefetcher(JobSystem& Jobs);
+
+		/** Waits for the reads in flight, then drops the images no Model took. */
+		~AssetPrefetcher();
+
+		AssetPrefetcher(const AssetPrefetcher&) = delete;
+		AssetPrefetcher& operator=(const AssetPrefetcher&) = delete;
+
+		/**
+		 * Reads an asset and every dependency the AssetManifest records for it, each file once.
+		 *
+		 * @param Asset An AssetPathManager key, e.g. a level listed in the manifest, or a path.
+		 * @return The number of reads scheduled.
+		 */
+		size_t Prefetch(std::string_view Asset);
+
+		/** @return True once every scheduled read finished. */
+		bool IsDone() const;
+
+		/** Returns once every scheduled read finished, running jobs meanwhile. */
+		void Wait();
+
+		/**
+		 * Takes an image a prefetcher decoded, flipped vertically like Model textures.
+		 *
+		 * @param Key The TextureCache key of the image.
+		 * @param Image Receives the decoded image.
+		 * @return False if no prefetcher decoded the image, or it was taken already.
+		 */
+		static bool TakeImage(size_t Key, ImageData& Image);
+
+	private:
+		/** Decodes an image into s_Images. */
+		static void PrefetchImage(const std::string& FilePath);
+
+		/** Reads a file through, or touches its archived contents. */
+		static void PrefetchFile(const std::string& FilePath);
+
+		JobSystem& m_Jobs;                           ///< Runs the reads.
+		JobCounter m_Counter;                        ///< Reads in flight.
+		std::vector<size_t> m_ImageKeys;             ///< Images this prefetcher decodes, dropped by the destructor if not taken.
+		std::unordered_set<std::string> m_Prefetched; ///< Files already scheduled, by path.
+
+		static std::unordered_map<size_t, ImageData> s_Images; ///< Decoded images waiting for a Model, by TextureCache key.
+		static std::mutex s_Mutex;                             ///< Guards s_Images.
+	};
+
+} // namespace fgl
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+#include <FireGL/Core/AsyncTask.h>
+#include <FireGL/Renderer/Model.h>
+#include <FireGL/Renderer/Texture.h>
+#include <FireGL/Renderer/Shader.h>
+
+namespace fgl
+{
+	class SceneFile;
+
+	/**
+	 * Awaitable asset loads: each coroutine reads and decodes on a JobSystem worker, then resumes on the GL thread
+	 * in AsyncScheduler::ProcessMainThread() for the OpenGL work, so game code writes its loading sequentially,
+	 *
+	 *     AsyncTask<> LoadLevel(AsyncScheduler& Scheduler)
+	 *     {
+	 *         std::shared_ptr<Model> Ship = co_await AsyncAssets::LoadModel(Scheduler, "Ship.obj");
+	 *         std::shared_ptr<Texture> Decal = co_await AsyncAssets::LoadTexture(Scheduler, "Decal.png");
+	 *         ...
+	 *     }
+	 *
+	 * without blocking a frame or chaining callbacks. Failed loads give nullptr or false. Loads started together,
+	 * e.g. several tasks created before the first co_await, run in parallel.
+	 */
+	namespace AsyncAssets
+	{
+		/**
+		 * Imports a model on a worker, then uploads its textures on the GL thread, one per ProcessMainThread()
+		 * budget slice so large models spread over frames. Mesh geometry is uploaded by the Renderer when first drawn.
+		 *
+		 * @param Scheduler The scheduler moving the load between threads.
+		 * @param Path The model file.
+		 * @param Settings Import settings; texture uploads are always deferred to the GL thread.
+		 * @return The model once usable, nullptr if the import failed.
+		 */
+		AsyncTask<std::shared_ptr<Model>> LoadModel(AsyncScheduler& Scheduler, std::string Path, ModelImportSettings Settings = ModelImportSettings());
+
+		/**
+		 * Decodes an image on a worker, then creates the 2D texture on the GL thread.
+		 *
+		 * @param Scheduler The scheduler moving the load between threads.
+		 * @param Path The image file, DDS and KTX2 included.
+		 * @param bFlipVertical Whether to flip the image vertically, ignored by compressed containers.
+		 * @return The texture, nullptr if the image couldn't be decoded or uploaded.
+		 */
+		AsyncTask<std::shared_ptr<Texture>> LoadTexture(AsyncScheduler& Scheduler, std::string Path, bool bFlipVertical = true);
+
+		/**
+		 * Reads the sources of a vertex and a fragment shader on a worker, then compiles and links them on the GL thread.
+		 *
+		 * @param Scheduler The scheduler moving the load between threads.
+		 * @param VertexPath The vertex shader file.
+		 * @param FragmentPath The fragment shader file.
+		 * @return The program, nullptr if a file couldn't be read.
+		 */
+		AsyncTask<std::shared_ptr<Shader>> LoadShader(AsyncScheduler& Scheduler, std::string VertexPath, std::string FragmentPath);
+
+		/**
+		 * Maps a scene file and reads its records through on a worker, so the disk reads happen there, then
+		 * resumes on the GL thread where the caller can Instantiate() it.
+		 *
+		 * @param Scheduler The scheduler moving the load between threads.
+		 * @param File The scene file to open, must outlive the load and not be used meanwhile.
+		 * @param Path The scene file path.
+		 * @return True if the file was opened, see SceneFile::Open().
+		 */
+		AsyncTask<bool> OpenSceneFile(AsyncScheduler& Scheduler, SceneFile& File, std::string Path);
+	}
+
+} // namespace fgl
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <FireGL/Renderer/Transform.h>
+#include <FireGL/Renderer/Frustum.h>
+#include <FireGL/Renderer/RenderLayers.h>
 
 #include <External/glm/glm.hpp>
 
@@ -77,12 +79,33 @@ namespace fgl
 
 		/**
 		 * Returns the projection matrix of the camera, which defines how the 3D scene is projected onto the 2D screen.
-		 * This matrix is updated based on the camera's settings (perspective or orthographic).
+		 * This matrix is updated based on the camera's settings (perspective or orthographic), then offset by the jitter.
 		 *
 		 * @return The camera's projection matrix.
 		 */
 		glm::mat4 GetProjectionMatrix() const;
+
+		/** @return The camera's projection matrix without the jitter, the one the frustum is built from. */
+		glm::mat4 GetUnjitteredProjectionMatrix() const;
+
+		/**
+		 * Offsets the projection by a fraction of a pixel, e.g. a different one every frame for temporal anti-aliasing.
+		 * The jitter is applied by GetProjectionMatrix() after the projection, so it survives SetPerspective().
+		 *
+		 * @param Offset The offset in normalized device coordinates: 2 / viewport width is one pixel along X.
+		 */
+		void SetJitter(const glm::vec2& Offset);
+
+		/** @return The offset of the projection in normalized device coordinates, zero by default. */
+		glm::vec2 GetJitter() const;
 		
+		/**
+		 * Builds the view frustum of the camera from its current view and projection matrices.
+		 *
+		 * @return The camera's world-space frustum.
+		 */
+		Frustum GetFrustum() const;
+
 		/**
 		 * @return the forward direction vector of the camera, indicating where the camera is looking.
 		 */
@@ -98,6 +121,31 @@ namespace fgl
 		 */
 		glm::vec3 GetUpVector() const;
 
+		/**
+		 * @return the position the view matrix was last built from by UpdateViewMatrix().
+		 * Unlike the transform, it is a copy the renderer can read while the next frame moves the camera.
+		 */
+		glm::vec3 GetViewPosition() const;
+
+		/**
+		 * Sets the render layers this camera draws: objects sharing no layer with the mask (see SceneObject::SetLayers())
+		 * are skipped before batching, as if culled.
+		 *
+		 * @param Mask The layers to draw, AllLayers by default.
+		 */
+		void SetCullingMask(LayerMask Mask);
+
+		/** @return The render layers this camera draws. */
+		LayerMask GetCullingMask() const;
+
+		/**
+		 * Copies the view of another camera: its vectors, view and projection matrices, jitter, view position and culling mask.
+		 * Used to snapshot the active camera of a frame, the transform of this camera isn't changed.
+		 *
+		 * @param Other The camera to copy the view of.
+		 */
+		void CopyView(const BaseCamera& Other);
+
 		/**
 		 * Returns a reference to the camera's transform, which holds the camera's position, rotation, and scale.
 		 * This allows for direct manipulation of the camera’s transform in world space.
@@ -139,8 +187,29 @@ namespace fgl
 		 * @param Right The right boundary of the orthographic view.
 		 * @param Top The top boundary of the orthographic view.
 		 * @param Bottom The bottom boundary of the orthographic view.
+		 * @param Near The near clipping plane distance, -1 by default for 2D rendering.
+		 * @param Far The far clipping plane distance, 1 by default for 2D rendering.
+		 */
+		void SetOrthographic(float Left, float Right, float Top, float Bottom, float Near = -1.0f, float Far = 1.0f);
+
+		/**
+		 * Turns the camera towards a point: the yaw and pitch of its transform are set, then its vectors updated.
+		 * The view matrix is rebuilt by the next UpdateViewMatrix().
+		 *
+		 * @param Target The point to look at, neither at the camera's position nor straight above or below it.
+		 */
+		void LookAt(const glm::vec3& Target);
+
+		/**
+		 * Sets the view directly from a position and a basis, without the yaw and pitch of the transform, e.g. for
+		 * the faces of a cube map, which look straight up and down and roll. The transform isn't changed: the next
+		 * UpdateViewMatrix() builds the view from it again.
+		 *
+		 * @param Position The position of the view.
+		 * @param Front The direction the view looks at.
+		 * @param Up The up direction of the view, not parallel to Front.
 		 */
-		void SetOrthographic(float Left, float Right, float Top, float Bottom);
+		void SetView(const glm::vec3& Position, const glm::vec3& Front, const glm::vec3& Up);
 
 		/**
 		 * Virtual method that must be implemented in derived classes to handle input for camera movement.
@@ -180,10 +249,16 @@ namespace fgl
 
 		/** Cached view matrix to avoid recalculating multiple time every frame but just once */
 		glm::mat4 m_View;
+
+		glm::vec3 m_ViewPosition{ 0.f }; ///< Position m_View was built from.
 		
 		/** Cached projection matrix, updated when the camera's projection settings change */
 		glm::mat4 m_Projection;
 
+		glm::vec2 m_Jitter{ 0.f }; ///< Offset of the projection in normalized device coordinates.
+
+		LayerMask m_CullingMask = AllLayers; ///< Render layers the camera draws.
+
 	private:
 		/** Variables for tracking input between frames(e.g., mouse, joystick) */
 		bool m_FirstInput = true;   ///< Ensures input coordinates are initialized only once
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+
+#include <External/glm/mat4x4.hpp>
+#include <External/glm/vec4.hpp>
+#include <External/glad/glad.h>
+
+namespace fgl
+{
+
+	/**
+	 * Skinning matrices of every animated object, in one buffer texture read by the vertex shader.
+	 *
+	 * Each object owns a range of bones (Allocate()) whose first bone it passes in its instance data
+	 * (SceneObject::SetBoneOffset()), so objects sharing a skinned mesh and a material still render in one
+	 * instanced draw, each with its own pose. A bone is stored as the three rows of its affine matrix in a
+	 * GL_RGBA32F buffer texture, which every OpenGL 4.1 context can fetch from. The renderer uploads the
+	 * written palettes once per frame and binds the texture to TextureUnit. Skinned vertex shaders read:
+	 *
+	 *     layout (location = 12) in uint BoneOffset;
+	 *     layout (location = 13) in uvec4 BoneIndices;
+	 *     layout (location = 14) in vec4 BoneWeights;
+	 *     uniform samplerBuffer BonePalette; // set to BonePaletteBuffer::TextureUnit
+	 *
+	 *     mat4 GetBone(uint Bone)
+	 *     {
+	 *         int Row = int((BoneOffset + Bone) * 3u);
+	 *         return transpose(mat4(texelFetch(BonePalette, Row), texelFetch(BonePalette, Row + 1),
+	 *             texelFetch(BonePalette, Row + 2), vec4(0.0, 0.0, 0.0, 1.0)));
+	 *     }
+	 *
+	 *     mat4 Skin = GetBone(BoneIndices.x) * BoneWeights.x + GetBone(BoneIndices.y) * BoneWeights.y
+	 *         + GetBone(BoneIndices.z) * BoneWeights.z + GetBone(BoneIndices.w) * BoneWeights.w;
+	 *     if (dot(BoneWeights, vec4(1.0)) == 0.0)
+	 *         Skin = mat4(1.0); // vertex without bones
+	 *     vec4 LocalPosition = Skin * vec4(aPos, 1.0);
+	 *     vec3 LocalNormal = mat3(Skin) * aNormal;
+	 */
+	class BonePaletteBuffer
+	{
+	public:
+		static constexpr uint32_t TextureUnit = 29;    ///< Texture unit the palettes are sampled from.
+		static constexpr uint32_t InitialBones = 1024; ///< Bones the buffer holds when first created.
+
+		BonePaletteBuffer() = default;
+
+		/** Deletes the buffer and its texture. */
+		~BonePaletteBuffer();
+
+		BonePaletteBuffer(const BonePaletteBuffer&) = delete;
+		BonePaletteBuffer& operator=(const BonePaletteBuffer&) = delete;
+
+		/**
+		 * Reserves the palette of one object, initialized to identity matrices (the bind pose).
+		 * A range of the same size released earlier is reused first.
+		 *
+		 * @param BoneCount The bones of the object's skeleton (see Skeleton::GetBoneCount()).
+		 * @return The first bone of the range, to give to SceneObject::SetBoneOffset().
+		 */
+		uint32_t Allocate(uint32_t BoneCount);
+
+		/**
+		 * Gives a range back for later allocations.
+		 *
+		 * @param Offset The first bone returned by Allocate().
+		 * @param BoneCount The bone count given to Allocate().
+		 */
+		void Release(uint32_t Offset, uint32_t BoneCount);
+
+		/**
+		 * Writes the pose of one object, uploaded with the next Upload().
+		 *
+		 * @param Offset The first bone returned by Allocate().
+		 * @param Palette One matrix per bone (see Skeleton::ComputePalette()), affine: the last row is dropped.
+		 */
+		void Write(uint32_t Offset, const std::vector<glm::mat4>& Palette);
+
+		/**
+		 * Uploads the palettes written since the last call and binds the buffer texture to TextureUnit.
+		 * Creates or grows the buffer as needed. Requires a current OpenGL context; does nothing while no bone is allocated.
+		 */
+		void Upload();
+
+		/** Deletes the buffer and its texture, the palettes are kept and uploaded again by the next Upload(). */
+		void Destroy();
+
+		/** @return The bones allocated, released ranges included. */
+		uint32_t GetBoneCount() const;
+
+	private:
+		std::vector<glm::vec4> m_Rows;                           ///< Three rows per bone, CPU copy of the buffer.
+		std::vector<std::pair<uint32_t, uint32_t>> m_FreeRanges; ///< Released ranges, first bone and count.
+		size_t m_DirtyBegin = SIZE_MAX;                          ///< First row written since the last upload.
+		size_t m_DirtyEnd = 0;                                   ///< One past the last row written since the last upload.
+		GLuint m_Buffer = 0;                                     ///< Buffer object holding the rows.
+		GLuint m_Texture = 0;                                    ///< Buffer texture reading m_Buffer.
+		size_t m_CapacityRows = 0;                               ///< Rows m_Buffer can hold.
+	};
+
+} // namespace fgl
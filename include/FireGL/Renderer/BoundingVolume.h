@@ -0,0 +1,119 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+#include <FireGL/Renderer/Vertex.h>
+
+#include <External/glm/vec3.hpp>
+#include <External/glm/mat4x4.hpp>
+
+namespace fgl
+{
+
+	/**
+	 * Axis-aligned bounding box, described by its minimum and maximum corners.
+	 * A default-constructed box is empty (Min > Max) until points or boxes are merged into it.
+	 */
+	struct BoundingBox
+	{
+		glm::vec3 Min = glm::vec3(std::numeric_limits<float>::max());    ///< Minimum corner.
+		glm::vec3 Max = glm::vec3(std::numeric_limits<float>::lowest()); ///< Maximum corner.
+
+		/** @return True if no point was merged into the box yet. */
+		bool IsEmpty() const;
+
+		/** @return The center of the box. */
+		glm::vec3 GetCenter() const;
+
+		/**
+		 * Grows the box to contain the given point.
+		 * @param Point The point to include.
+		 */
+		void Merge(const glm::vec3& Point);
+
+		/**
+		 * Grows the box to contain another box.
+		 * @param Other The box to include.
+		 */
+		void Merge(const BoundingBox& Other);
+
+		/**
+		 * Tests whether two boxes share a point, touching faces included.
+		 * @param Other The box to test against.
+		 * @return True if the boxes overlap, false if either is empty.
+		 */
+		bool Overlaps(const BoundingBox& Other) const;
+
+		/**
+		 * Transforms the box by a model matrix.
+		 * The result is the axis-aligned box enclosing the transformed box, so it grows with rotations.
+		 *
+		 * @param ModelMatrix The transformation to apply.
+		 * @return The transformed box, empty if this box is.
+		 */
+		BoundingBox Transformed(const glm::mat4& ModelMatrix) const;
+	};
+
+	/**
+	 * Bounding sphere, described by its center and radius.
+	 */
+	struct BoundingSphere
+	{
+		glm::vec3 Center = glm::vec3(0.0f); ///< Center of the sphere.
+		float Radius = 0.0f;                ///< Radius of the sphere.
+
+		/**
+		 * Transforms the sphere by a model matrix.
+		 * The radius is scaled by the largest axis scale so the result still encloses the geometry.
+		 *
+		 * @param ModelMatrix The transformation to apply.
+		 * @return The transformed sphere.
+		 */
+		BoundingSphere Transformed(const glm::mat4& ModelMatrix) const;
+	};
+
+	/**
+	 * World-space bounding spheres stored as a structure of arrays, one entry per object.
+	 * The split layout lets the culling code load 4 or 8 spheres per SIMD register.
+	 */
+	struct BoundingSphereArrays
+	{
+		std::vector<float> X;      ///< Sphere centers, X component.
+		std::vector<float> Y;      ///< Sphere centers, Y component.
+		std::vector<float> Z;      ///< Sphere centers, Z component.
+		std::vector<float> Radius; ///< Sphere radii. An infinite radius is never culled.
+
+		/** @return The number of spheres stored. */
+		size_t Size() const;
+
+		/**
+		 * Resizes every array to hold Count spheres.
+		 * @param Count The new number of spheres.
+		 */
+		void Resize(size_t Count);
+
+		/**
+		 * Stores a sphere at the given index.
+		 * @param Index The index to write.
+		 * @param Sphere The world-space sphere.
+		 */
+		void Set(size_t Index, const BoundingSphere& Sphere);
+	};
+
+	/**
+	 * Computes the bounding box of a set of vertices.
+	 *
+	 * @param Vertices The vertices to enclose.
+	 * @return The smallest axis-aligned box containing every vertex position.
+	 */
+	BoundingBox ComputeBoundingBox(const std::vector<Vertex>& Vertices);
+
+	/**
+	 * Computes a bounding sphere of a set of vertices, centered on their bounding box.
+	 *
+	 * @param Vertices The vertices to enclose.
+	 * @param Box The bounding box of the vertices.
+	 * @return A sphere containing every vertex position.
+	 */
+	BoundingSphere ComputeBoundingSphere(const std::vector<Vertex>& Vertices, const BoundingBox& Box);
+
+} // namespace fgl
\ No newline at end of file
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+#include <FireGL/Renderer/RenderDevice.h>
+
+#include <External/glm/mat4x4.hpp>
+#include <External/glm/vec4.hpp>
+#include <External/glad/glad.h>
+
+namespace fgl
+{
+	class BaseCamera;
+
+	/**
+	 * CPU-side mirror of the "CameraData" uniform block, laid out to match std140.
+	 *
+	 * Shaders access the camera through this block instead of per-instance or per-draw matrices:
+	 *
+	 *     layout (std140) uniform CameraData
+	 *     {
+	 *         mat4 View;
+	 *         mat4 Projection;
+	 *         mat4 ViewProjection;
+	 *         vec4 Position;
+	 *         mat4 InverseViewProjection;
+	 *         vec4 Time;
+	 *     } Camera;
+	 *
+	 * Trailing members a shader doesn't use can be left out of its declaration.
+	 */
+	struct CameraData
+	{
+		glm::mat4 View;                  ///< View matrix of the active camera.
+		glm::mat4 Projection;            ///< Projection matrix of the active camera.
+		glm::mat4 ViewProjection;        ///< Projection * View, computed once per frame.
+		glm::vec4 Position;              ///< World-space camera position (w unused).
+		glm::mat4 InverseViewProjection; ///< inverse(ViewProjection), rebuilds world positions from depth.
+		glm::vec4 Time;                  ///< Seconds since the application started in x, the clock of ProceduralAnimation (yzw unused).
+	};
+
+	/**
+	 * Owns the uniform buffer holding the per-frame camera data.
+	 *
+	 * The buffer is bound once to a fixed binding point, and every Shader linked with a "CameraData"
+	 * block gets that block assigned to the same binding point, so no per-draw uniform upload is needed.
+	 */
+	class CameraUniformBuffer
+	{
+	public:
+		static constexpr GLuint BindingPoint = 0;             ///< Uniform buffer binding point of the camera block.
+		static constexpr const char* BlockName = "CameraData"; ///< Name of the uniform block in GLSL.
+
+		/** Creates the uniform buffer and binds it to BindingPoint. Requires a current OpenGL context. */
+		void Create();
+
+		/** Deletes the uniform buffer. */
+		void Destroy();
+
+		/**
+		 * Uploads the matrices and position of the given camera, and the time of the frame.
+		 *
+		 * @param Camera The camera the frame is rendered from.
+		 * @param Time Seconds since the application started, see TimeManager::GetTimeSeconds().
+		 */
+		void Update(BaseCamera& Camera, float Time = 0.0f);
+
+		/** @return The camera data uploaded by the last Update(). */
+		const CameraData& GetData() const;
+
+	private:
+		BufferHandle m_Buffer; ///< Uniform buffer, created through the RenderDevice.
+		CameraData m_Data{};   ///< Last uploaded camera data.
+	};
+
+} // namespace fgl
\ No newline at end of file
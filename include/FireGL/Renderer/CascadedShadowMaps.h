@@ -0,0 +1,169 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+#include <FireGL/Renderer/Shader.h>
+#include <FireGL/Renderer/CameraUniformBuffer.h>
+
+#include <External/glm/vec4.hpp>
+#include <External/glm/mat4x4.hpp>
+#include <External/glad/glad.h>
+
+namespace fgl
+{
+
+	/**
+	 * CPU-side mirror of the "ShadowData" uniform block, laid out to match std140.
+	 *
+	 *     layout (std140) uniform ShadowData
+	 *     {
+	 *         mat4 LightViewProjection[4];
+	 *         vec4 SplitDepths;  // view depth where each cascade ends
+	 *         vec4 TexelSizes;   // world-space size of a shadow map texel in each cascade
+	 *         vec4 Params;       // cascade count (0 when shadows are off), depth bias, normal bias in texels, 1 / resolution
+	 *     } Shadows;
+	 *     uniform sampler2DArrayShadow ShadowMap;
+	 */
+	struct ShadowData
+	{
+		static constexpr uint32_t MaxCascades = 4;
+
+		glm::mat4 LightViewProjection[MaxCascades]; ///< World to shadow clip space of each cascade, depth in [0, 1].
+		glm::vec4 SplitDepths = glm::vec4(0.0f);    ///< View depth where each cascade ends.
+		glm::vec4 TexelSizes = glm::vec4(0.0f);     ///< World-space size of a texel in each cascade.
+		glm::vec4 Params = glm::vec4(0.0f);         ///< Cascade count, depth bias, normal bias in texels, 1 / resolution.
+	};
+
+	/**
+	 * Cascaded shadow maps of the directional light.
+	 *
+	 * Update() splits the view range of the camera, up to the shadow distance, into cascades spaced between
+	 * uniform and logarithmic splits. Each cascade is an orthographic light view around the bounding sphere of
+	 * its slice of the camera frustum: the size only depends on the split, and the center is snapped to whole
+	 * texels, so the cascade doesn't shimmer when the camera turns or moves and its matrix stays the same while
+	 * the camera is still. Every cascade is a layer of one depth texture array, sampled with hardware comparison.
+	 *
+	 * Casters are drawn once for all cascades by BeginCasterPass(): a geometry shader instanced per cascade
+	 * sends each triangle to the layers its instance's cascade mask (the material index of the caster instances)
+	 * selects, and drops it when it lies outside the layer. Depth clamping flattens casters between the light and
+	 * a cascade onto its near plane. A cascade whose matrix and casters didn't change since it was drawn keeps
+	 * its depth, so static views only redraw the cascades something moved in.
+	 *
+	 * Lit shaders declare the ShadowData block and the ShadowMap sampler: both are bound by default (see
+	 * Shader::SetDefaultBlockBinding() and Shader::SetDefaultSamplerUnit()). A fragment picks the first cascade
+	 * whose split depth is beyond its view depth, and is unshadowed past the last one.
+	 */
+	class CascadedShadowMaps
+	{
+	public:
+		static constexpr uint32_t MaxCascades = ShadowData::MaxCascades; ///< Cascades of the texture array.
+		static constexpr GLuint BindingPoint = 3;                        ///< Uniform buffer binding point of the shadow block.
+		static constexpr const char* BlockName = "ShadowData";           ///< Name of the uniform block in GLSL.
+		static constexpr uint32_t TextureUnit = 30;                      ///< Texture unit the shadow map is sampled from.
+		static constexpr const char* SamplerName = "ShadowMap";          ///< Name of the shadow sampler in GLSL.
+
+		/** Creates the uniform buffer with shadows off and binds it to BindingPoint. Requires a current OpenGL context. */
+		void Create();
+
+		/** Deletes the uniform buffer, the shadow map and the caster shader. */
+		void Destroy();
+
+		/**
+		 * Sets the size of every cascade. The shadow map is reallocated on the next caster pass.
+		 *
+		 * @param Resolution Width and height of a cascade in texels.
+		 */
+		void SetResolution(uint32_t Resolution);
+
+		/**
+		 * @param Count Number of cascades, clamped to [1, MaxCascades].
+		 */
+		void SetCascadeCount(uint32_t Count);
+
+		/** @return The number of cascades. */
+		uint32_t GetCascadeCount() const;
+
+		/**
+		 * @param Distance View depth up to which shadows are drawn, the camera far plane if closer.
+		 */
+		void SetShadowDistance(float Distance);
+
+		/**
+		 * @param Lambda Blend between uniform (0) and logarithmic (1) split depths.
+		 */
+		void SetSplitLambda(float Lambda);
+
+		/**
+		 * @param Distance How far towards the light, from a cascade, objects still cast into it.
+		 */
+		void SetCasterDistance(float Distance);
+
+		/**
+		 * @param DepthBias Constant subtracted from the depth of the receivers.
+		 * @param NormalBias Offset of the receivers along their normal, in texels of their cascade.
+		 */
+		void SetBias(float DepthBias, float NormalBias);
+
+		/**
+		 * Fits the cascades to the camera and uploads the shadow block.
+		 *
+		 * @param Camera The camera data of the frame (see CameraUniformBuffer).
+		 * @param LightDirection The direction the directional light shines towards.
+		 */
+		void Update(const CameraData& Camera, const glm::vec3& LightDirection);
+
+		/** Uploads a shadow block without cascades, so lit shaders skip the shadow lookup. */
+		void Disable();
+
+		/**
+		 * @param Cascade A cascade index.
+		 * @return The view-projection of the cascade, its near plane pushed back by the caster distance, for culling.
+		 */
+		const glm::mat4& GetCasterViewProjection(uint32_t Cascade) const;
+
+		/**
+		 * Starts drawing casters into the cascades that changed: binds the shadow framebuffer, viewport and caster
+		 * shader, and clears the cascades to draw. Does nothing if every cascade is still current.
+		 *
+		 * @param CasterHashes Hash of the casters overlapping each cascade, their identity, mesh and transform revision.
+		 * @return The mask of the cascades to draw, 0 if no caster pass is needed.
+		 */
+		uint32_t BeginCasterPass(const std::array<uint64_t, MaxCascades>& CasterHashes);
+
+		/** Restores the framebuffer, viewport and depth state, and binds the shadow map for sampling. */
+		void EndCasterPass();
+
+	private:
+		/** Allocates the depth texture array and the layered framebuffer for the current resolution. */
+		void Allocate();
+
+		/** Deletes the shadow map and its framebuffer. */
+		void DestroyTextures();
+
+		/** Uploads m_Data to the uniform buffer. */
+		void Upload();
+
+		GLuint m_BufferID = 0;             ///< Uniform buffer of the shadow block.
+		GLuint m_ShadowMap = 0;            ///< Depth texture array, one layer per cascade.
+		GLuint m_Framebuffer = 0;          ///< Layered framebuffer of m_ShadowMap.
+		uint32_t m_AllocatedResolution = 0; ///< Resolution m_ShadowMap was allocated with.
+		std::unique_ptr<Shader> m_CasterShader; ///< Depth-only shader with the layer selecting geometry shader.
+
+		ShadowData m_Data{};               ///< Shadow block, as last uploaded.
+		glm::mat4 m_CasterViewProjection[MaxCascades] = {}; ///< Cascade matrices extended towards the light.
+		glm::mat4 m_DrawnViewProjection[MaxCascades] = {};  ///< Matrix each cascade's depth was drawn with.
+		uint64_t m_DrawnHashes[MaxCascades] = {};           ///< Caster hash each cascade's depth was drawn with.
+		uint32_t m_CurrentMask = 0;        ///< Cascades whose depth matches their drawn matrix and hash.
+
+		uint32_t m_Resolution = 2048;      ///< Width and height of a cascade.
+		uint32_t m_CascadeCount = 4;       ///< Number of cascades used.
+		float m_ShadowDistance = 100.0f;   ///< View depth covered by the cascades.
+		float m_SplitLambda = 0.75f;       ///< Logarithmic share of the split depths.
+		float m_CasterDistance = 200.0f;   ///< Extent of the caster volumes towards the light.
+		float m_DepthBias = 0.0005f;       ///< Constant depth bias of the receivers.
+		float m_NormalBias = 1.5f;         ///< Normal offset of the receivers, in texels.
+
+		GLint m_SavedViewport[4] = {};     ///< Viewport restored by EndCasterPass().
+		GLint m_SavedFramebuffer = 0;      ///< Draw framebuffer restored by EndCasterPass().
+	};
+
+} // namespace fgl
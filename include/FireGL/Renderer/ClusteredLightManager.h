@@ -0,0 +1,162 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+
+#include <External/glm/vec2.hpp>
+#include <External/glm/vec4.hpp>
+#include <External/glm/mat4x4.hpp>
+#include <External/glad/glad.h>
+
+namespace fgl
+{
+	class BaseCamera;
+
+	/**
+	 * One point light of the clustered light list, laid out to match std430.
+	 * The light fades out smoothly and reaches zero at its range, which is what bounds its clusters.
+	 */
+	struct ClusteredPointLight
+	{
+		glm::vec4 PositionRange = glm::vec4(0.0f, 0.0f, 0.0f, 10.0f); ///< World-space position, range in w.
+		glm::vec4 ColorIntensity = glm::vec4(1.0f);                    ///< Linear color, intensity in w.
+	};
+
+	/**
+	 * Clustered forward lighting: point lights in a shader storage buffer, and per-cluster light lists.
+	 *
+	 * The view frustum of the active camera is split into a GridX * GridY * GridZ grid: screen tiles, and
+	 * depth slices spaced exponentially so clusters stay roughly cubic. Every frame Update() assigns each light
+	 * to the clusters its range overlaps on the CPU, and uploads three storage buffers:
+	 *
+	 *     struct PointLight { vec4 PositionRange; vec4 ColorIntensity; };
+	 *     layout (std430, binding = 1) readonly buffer ClusteredLightData { PointLight PointLights[]; };
+	 *     layout (std430, binding = 2) readonly buffer LightClusterData
+	 *     {
+	 *         uvec4 GridSize;     // clusters along x, y, z; light count in w
+	 *         vec4 DepthParams;   // near, far, slice scale, slice bias
+	 *         vec4 ScreenParams;  // viewport width, height, tile width, tile height
+	 *         uvec2 Clusters[];   // offset in LightIndices, light count
+	 *     };
+	 *     layout (std430, binding = 3) readonly buffer LightIndexData { uint LightIndices[]; };
+	 *
+	 * A fragment finds its cluster from gl_FragCoord.xy / ScreenParams.zw and the slice
+	 * int(log(ViewDepth) * DepthParams.z + DepthParams.w), then only shades with the lights listed there, so
+	 * the cost per pixel depends on the local light density instead of the total light count.
+	 * The camera must use a perspective projection with a [0, 1] depth range, as configured for glm.
+	 * Update() reads the lights copied by Capture(), so they can be edited while a render thread draws.
+	 */
+	class ClusteredLightManager
+	{
+	public:
+		static constexpr uint32_t GridX = 16;                 ///< Screen tiles along x.
+		static constexpr uint32_t GridY = 9;                  ///< Screen tiles along y.
+		static constexpr uint32_t GridZ = 24;                 ///< Depth slices.
+		static constexpr GLuint LightBindingPoint = 1;        ///< Shader storage binding point of the lights.
+		static constexpr GLuint ClusterBindingPoint = 2;      ///< Shader storage binding point of the cluster grid.
+		static constexpr GLuint IndexBindingPoint = 3;        ///< Shader storage binding point of the light index lists.
+
+		/** @return True if the context supports shader storage buffers (OpenGL 4.3). */
+		static bool IsSupported();
+
+		/** Creates the storage buffers and binds them to their binding points. Requires a current OpenGL context. */
+		void Create();
+
+		/** Deletes the storage buffers. */
+		void Destroy();
+
+		/**
+		 * Adds a light.
+		 *
+		 * @param Light The light to add.
+		 * @return The index of the light, valid until a light is removed.
+		 */
+		size_t AddLight(const ClusteredPointLight& Light);
+
+		/**
+		 * Removes a light; the last light takes its index.
+		 *
+		 * @param Index The index returned by AddLight().
+		 */
+		void RemoveLight(size_t Index);
+
+		/**
+		 * Gives write access to a light, read again by the first Update() after the next Capture().
+		 *
+		 * @param Index The index returned by AddLight().
+		 * @return The light to edit.
+		 */
+		ClusteredPointLight& EditLight(size_t Index);
+
+		/** @return Every light, by index. */
+		const std::vector<ClusteredPointLight>& GetLights() const;
+
+		/** Removes every light. */
+		void ClearLights();
+
+		/** Copies the lights edited since the last call to the ones Update() reads. Called while no frame is drawn. */
+		void Capture();
+
+		/** @return The lights captured by the last Capture(), by index. */
+		const std::vector<ClusteredPointLight>& GetRenderLights() const;
+
+		/**
+		 * Caps the number of lights shading a cluster, e.g. to bound the cost of crowded clusters on slow GPUs.
+		 * Clusters keep their lights of lowest index, so the lights that matter most should be added first.
+		 *
+		 * @param MaxLights The lights per cluster at most, UINT32_MAX (the default) for no cap.
+		 */
+		void SetMaxLightsPerCluster(uint32_t MaxLights);
+
+		/** @return The number of lights shading a cluster at most. */
+		uint32_t GetMaxLightsPerCluster() const;
+
+		/**
+		 * Assigns the captured lights to the clusters of the camera's view and uploads the buffers.
+		 *
+		 * @param Camera           The camera the frame is rendered from.
+		 * @param ViewportWidth    The width of the viewport in pixels.
+		 * @param ViewportHeight   The height of the viewport in pixels.
+		 */
+		void Update(const BaseCamera& Camera, int ViewportWidth, int ViewportHeight);
+
+	private:
+		/** Fixed-size start of the cluster buffer, std430. */
+		struct ClusterHeader
+		{
+			glm::uvec4 GridSize;
+			glm::vec4 DepthParams;
+			glm::vec4 ScreenParams;
+		};
+
+		static constexpr uint32_t ClusterCount = GridX * GridY * GridZ;
+
+		/** Clusters covered by one light, inclusive bounds. */
+		struct ClusterRange
+		{
+			uint32_t MinX, MaxX, MinY, MaxY, MinZ, MaxZ;
+		};
+
+		/**
+		 * Computes the clusters a light overlaps.
+		 * @return False if the light is entirely outside the depth range.
+		 */
+		static bool GetClusterRange(const ClusteredPointLight& Light, const glm::mat4& View, const glm::mat4& Projection,
+			float Near, float Far, float SliceScale, float SliceBias, ClusterRange& Range);
+
+		/** Replaces the storage of a storage buffer with Size bytes of Data, or with a zeroed word if Size is 0. */
+		static void Upload(GLuint Buffer, const void* Data, size_t Size);
+
+		std::vector<ClusteredPointLight> m_Lights;       ///< Every light, by index.
+		std::vector<ClusteredPointLight> m_RenderLights; ///< Lights read by Update(), copied from m_Lights by Capture().
+		bool m_bLightsEdited = false;                    ///< Whether m_Lights changed since the last Capture().
+		std::vector<ClusterRange> m_Ranges;              ///< Clusters of each visible light, reused across frames.
+		std::vector<uint32_t> m_RangeLights;             ///< Light index of each entry of m_Ranges.
+		std::vector<glm::uvec2> m_Clusters;              ///< Offset and light count of every cluster, as uploaded.
+		std::vector<uint32_t> m_LightIndices;            ///< Concatenated light lists of every cluster.
+		uint32_t m_MaxLightsPerCluster = UINT32_MAX;     ///< Lights of a cluster at most, the later ones are dropped.
+		GLuint m_LightBuffer = 0;                        ///< Storage buffer of the lights.
+		GLuint m_ClusterBuffer = 0;                      ///< Storage buffer of the cluster grid.
+		GLuint m_IndexBuffer = 0;                        ///< Storage buffer of the light lists.
+	};
+
+} // namespace fgl
\ No newline at end of file
@@ -1,16 +1,19 @@
 #pragma once
 
+#include <cstdint>
+
 namespace fgl
 {
 	class Entity;
+	class Scene;
+	class ComponentPoolBase;
+	class SceneObject;
 
 	/**
 	 * This class serves as the base class for components in a simple and easy-to-use ECS (Entity-Component-System) framework.
 	 *
-	 * While not the most performance-optimized approach (due to the lack of CPU cache optimizations and efficient memory layout),
-	 * it was designed for ease of use and rapid implementation. If you're looking for a high-performance ECS with CPU caching optimizations,
-	 * you should consider using a more advanced solution like EnTT or create your own. This implementation is focused on simplicity
-	 * and suitability for rendering purposes, rather than high-performance compute tasks.
+	 * Components are stored per type in contiguous ComponentPool chunks rather than on their own heap allocation, and are
+	 * ticked type by type by Scene::Process(), each pool sweeping its own storage, before the scene objects are ticked.
 	 *
 	 * Components derived from this class can be attached to entities, providing functionality such as handling lifecycle events
 	 * (e.g., OnBeginPlay, OnTick, OnDestroyed). These methods are meant to be overridden by derived classes to implement specific behavior.
@@ -28,19 +31,42 @@ namespace fgl
 		virtual void OnBeginPlay();
 
 		/**
-		 * Called every frame to update the component.
+		 * Called every frame to update the component, once the owning entity was added to a scene.
 		 * Override this in derived classes to perform per-frame updates.
 		 *
 		 * @param DeltaTime The time that has passed since the last frame.
 		 */
 		virtual void OnTick(float DeltaTime);
 
+		/**
+		 * Override to return true if OnTick() only touches the state of this component and its owner,
+		 * letting the component be ticked on a worker thread along with the other components of its type.
+		 *
+		 * @return False by default.
+		 */
+		virtual bool IsTickThreadSafe() const;
+
 		/**
 		 * Called when the entity or the component is destroyed.
 		 * Override this in derived classes to handle cleanup when the component is no longer needed.
 		 */
 		virtual void OnDestroyed();
 
+		/**
+		 * Called when the owner starts overlapping another object, if the owner has overlap events enabled
+		 * (see SceneObject::SetOverlapEvents()). Override this to react to the object without searching for it.
+		 *
+		 * @param Other The object whose bounding box started overlapping the owner's.
+		 */
+		virtual void OnOverlapBegin(SceneObject* Other);
+
+		/**
+		 * Called when the owner stops overlapping another object, including when either leaves the scene.
+		 *
+		 * @param Other The object whose bounding box stopped overlapping the owner's.
+		 */
+		virtual void OnOverlapEnd(SceneObject* Other);
+
 		/**
 		 * Sets the owner entity for this component.
 		 * This function is called internally during component creation, and is not intended to be called manually.
@@ -49,6 +75,14 @@ namespace fgl
 		 */
 		void SetOwner(Entity* Owner);
 
+		/**
+		 * Sets the scene the owner entity was added to, the component is only ticked by that scene.
+		 * This function is called internally by the owner, and is not intended to be called manually.
+		 *
+		 * @param OwnerScene The scene of the owner, nullptr if it isn't in one.
+		 */
+		void SetScene(const Scene* OwnerScene);
+
 	protected:
 		/**
 		 * Gets the owner entity of this component.
@@ -59,7 +93,12 @@ namespace fgl
 		Entity* GetOwner() const;
 
 	private:
-		Entity* m_Owner; ///< Pointer to the entity that owns this component.
+		friend class ComponentPoolBase;
+
+		Entity* m_Owner = nullptr;          ///< Pointer to the entity that owns this component.
+		const Scene* m_Scene = nullptr;     ///< Scene the owner was added to, nullptr if none.
+		ComponentPoolBase* m_Pool = nullptr; ///< Pool the component was created from.
+		uint32_t m_PoolSlot = 0;            ///< Slot of the component in m_Pool.
 	};
 
 } // namespace fgl
\ No newline at end of file
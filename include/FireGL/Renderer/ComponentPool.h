@@ -0,0 +1,278 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+#include <FireGL/Renderer/Component.h>
+#include <FireGL/Core/JobSystem.h>
+#include <FireGL/Core/MemoryTracker.h>
+
+#include <bitset>
+
+namespace fgl
+{
+	class Scene;
+
+	/**
+	 * Type-erased side of a ComponentPool, what the registry and the entities need to know about every pool.
+	 *
+	 * Every pool registers itself when first used; ComponentPoolBase::TickAll() then runs the per-type update
+	 * "systems": each pool sweeps its own contiguous storage, one component type after the other.
+	 */
+	class ComponentPoolBase
+	{
+	public:
+		static constexpr uint32_t MaxComponentTypes = 64; ///< Component types an application can define at most.
+
+		virtual ~ComponentPoolBase() = default;
+
+		/**
+		 * Ticks the components of this pool whose owner was added to a scene.
+		 *
+		 * @param TargetScene Only the components of entities in this scene are ticked.
+		 * @param DeltaTime The time that has passed since the last frame.
+		 * @param Jobs Job system the thread-safe components are ticked on, nullptr to tick all of them on the calling thread.
+		 */
+		virtual void Tick(const Scene* TargetScene, float DeltaTime, JobSystem* Jobs) = 0;
+
+		/** @return The number of live components in this pool. */
+		virtual size_t GetCount() const = 0;
+
+		/**
+		 * Ticks every registered pool, in the order they were first used.
+		 *
+		 * @param TargetScene Only the components of entities in this scene are ticked.
+		 * @param DeltaTime The time that has passed since the last frame.
+		 * @param Jobs Job system the thread-safe components are ticked on, nullptr to tick all of them on the calling thread.
+		 */
+		static void TickAll(const Scene* TargetScene, float DeltaTime, JobSystem* Jobs = nullptr);
+
+		/**
+		 * Destroys a component and releases its slot in the pool it was created from.
+		 *
+		 * @param Instance The component to destroy.
+		 */
+		static void Release(Component* Instance);
+
+		/**
+		 * Assigns the next dense component type index, see ComponentPool::GetTypeID().
+		 *
+		 * @return A new index, below MaxComponentTypes.
+		 */
+		static uint32_t NextTypeID();
+
+	protected:
+		/** Adds a pool to the registry ticked by TickAll(). */
+		static void Register(ComponentPoolBase* Pool);
+
+		/** Returns the components to their pool once they are destroyed. */
+		virtual void Destroy(Component* Instance) = 0;
+
+		/** Records where a component lives, Component only befriends this class. */
+		static void SetSlot(Component* Instance, ComponentPoolBase* Pool, uint32_t Slot);
+
+		/** @return The slot of a component in its pool. */
+		static uint32_t GetSlot(const Component* Instance);
+
+		/** @return The scene the owner of a component was added to, nullptr if none. */
+		static const Scene* GetScene(const Component* Instance);
+	};
+
+	/**
+	 * Contiguous storage of every component of type T.
+	 *
+	 * Components are constructed in place in fixed-size chunks, so a component never moves once created and
+	 * the pointers handed out by Entity::CreateComponent() stay valid. Released slots are reused by the next
+	 * component. Tick() sweeps the chunks linearly and calls OnTick() through the static type T; declare
+	 * components final so the compiler can drop the virtual dispatch. The storage counts under MemoryTag::Components.
+	 *
+	 * @tparam T The component type, derived from Component.
+	 */
+	template<typename T>
+	class ComponentPool final : public ComponentPoolBase
+	{
+	public:
+		static constexpr uint32_t ChunkCapacity = 64; ///< Components stored per chunk.
+
+		/** @return The pool of component type T, created and registered on first use. */
+		static ComponentPool& Get();
+
+		/**
+		 * Retrieves the dense index of component type T, assigned once by a static counter.
+		 * Entities use it to find their component of type T with a bit test and an array index.
+		 *
+		 * @return The index of T, below MaxComponentTypes.
+		 */
+		static uint32_t GetTypeID();
+
+		/** @return A new default-constructed component, owned by the pool until Release(). */
+		T* Create();
+
+		/**
+		 * Calls a function on every live component.
+		 *
+		 * @param Body Called with a T& for each component, in storage order.
+		 */
+		template<typename Function>
+		void ForEach(Function&& Body);
+
+		virtual void Tick(const Scene* TargetScene, float DeltaTime, JobSystem* Jobs) override;
+		virtual size_t GetCount() const override;
+
+		~ComponentPool();
+
+	private:
+		ComponentPool();
+
+		virtual void Destroy(Component* Instance) override;
+
+		/** ChunkCapacity components worth of raw storage, constructed on demand. */
+		struct Chunk
+		{
+			alignas(T) std::byte Storage[sizeof(T) * ChunkCapacity];
+			std::bitset<ChunkCapacity> Alive; ///< Slots holding a constructed component.
+
+			T* At(uint32_t Index) { return std::launder(reinterpret_cast<T*>(Storage) + Index); }
+		};
+
+		/** Ticks the live components of one chunk whose thread safety matches bThreadSafe. */
+		void TickChunk(Chunk& Storage, const Scene* TargetScene, float DeltaTime, bool bThreadSafe);
+
+		TaggedVector<std::unique_ptr<Chunk>, MemoryTag::Components> m_Chunks; ///< Storage, never shrinks.
+		TaggedVector<uint32_t, MemoryTag::Components> m_FreeSlots;            ///< Released slots, reused first.
+		uint32_t m_Size = 0;                          ///< Slots ever used, live or released.
+		size_t m_Count = 0;                           ///< Live components.
+	};
+
+	template<typename T>
+	ComponentPool<T>& ComponentPool<T>::Get()
+	{
+		static ComponentPool Pool;
+		return Pool;
+	}
+
+	template<typename T>
+	uint32_t ComponentPool<T>::GetTypeID()
+	{
+		static const uint32_t TypeID = NextTypeID();
+		return TypeID;
+	}
+
+	template<typename T>
+	ComponentPool<T>::ComponentPool()
+	{
+		Register(this);
+	}
+
+	template<typename T>
+	ComponentPool<T>::~ComponentPool()
+	{
+		ForEach([](T& Instance) { Instance.~T(); });
+		MemoryTracker::OnFree(MemoryTag::Components, m_Chunks.size() * sizeof(Chunk));
+	}
+
+	template<typename T>
+	T* ComponentPool<T>::Create()
+	{
+		uint32_t Slot;
+		if (!m_FreeSlots.empty())
+		{
+			Slot = m_FreeSlots.back();
+			m_FreeSlots.pop_back();
+		}
+		else
+		{
+			Slot = m_Size++;
+			if (Slot / ChunkCapacity >= m_Chunks.size())
+			{
+				m_Chunks.push_back(std::make_unique<Chunk>());
+				MemoryTracker::OnAllocate(MemoryTag::Components, sizeof(Chunk));
+			}
+		}
+
+		Chunk& Storage = *m_Chunks[Slot / ChunkCapacity];
+		T* Instance = new (Storage.At(Slot % ChunkCapacity)) T();
+		Storage.Alive.set(Slot % ChunkCapacity);
+		SetSlot(Instance, this, Slot);
+		m_Count++;
+		return Instance;
+	}
+
+	template<typename T>
+	void ComponentPool<T>::Destroy(Component* Instance)
+	{
+		const uint32_t Slot = GetSlot(Instance);
+		static_cast<T*>(Instance)->~T();
+		m_Chunks[Slot / ChunkCapacity]->Alive.reset(Slot % ChunkCapacity);
+		m_FreeSlots.push_back(Slot);
+		m_Count--;
+	}
+
+	template<typename T>
+	template<typename Function>
+	void ComponentPool<T>::ForEach(Function&& Body)
+	{
+		for (const std::unique_ptr<Chunk>& Storage : m_Chunks)
+		{
+			for (uint32_t Index = 0; Index < ChunkCapacity; Index++)
+			{
+				if (Storage->Alive.test(Index))
+				{
+					Body(*Storage->At(Index));
+				}
+			}
+		}
+	}
+
+	template<typename T>
+	void ComponentPool<T>::TickChunk(Chunk& Storage, const Scene* TargetScene, float DeltaTime, bool bThreadSafe)
+	{
+		for (uint32_t Index = 0; Index < ChunkCapacity; Index++)
+		{
+			if (!Storage.Alive.test(Index))
+				continue;
+
+			T* Instance = Storage.At(Index);
+			if (GetScene(Instance) == TargetScene && Instance->IsTickThreadSafe() == bThreadSafe)
+			{
+				Instance->OnTick(DeltaTime);
+			}
+		}
+	}
+
+	template<typename T>
+	void ComponentPool<T>::Tick(const Scene* TargetScene, float DeltaTime, JobSystem* Jobs)
+	{
+		if (m_Count == 0)
+			return;
+
+		// Thread-safe components run first, a chunk per job; the others follow on the calling thread
+		if (Jobs && m_Chunks.size() > 1)
+		{
+			Jobs->ParallelFor(m_Chunks.size(), 1, [this, TargetScene, DeltaTime](size_t Begin, size_t End)
+			{
+				for (size_t ChunkIndex = Begin; ChunkIndex < End; ChunkIndex++)
+				{
+					TickChunk(*m_Chunks[ChunkIndex], TargetScene, DeltaTime, true);
+				}
+			});
+		}
+		else
+		{
+			for (const std::unique_ptr<Chunk>& Storage : m_Chunks)
+			{
+				TickChunk(*Storage, TargetScene, DeltaTime, true);
+			}
+		}
+
+		for (const std::unique_ptr<Chunk>& Storage : m_Chunks)
+		{
+			TickChunk(*Storage, TargetScene, DeltaTime, false);
+		}
+	}
+
+	template<typename T>
+	size_t ComponentPool<T>::GetCount() const
+	{
+		return m_Count;
+	}
+
+} // namespace fgl
\ No newline at end of file
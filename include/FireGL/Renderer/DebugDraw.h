@@ -0,0 +1,120 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+
+#if defined(FIREGL_ENABLE_DEBUG_DRAW)
+#include <FireGL/Renderer/Shader.h>
+
+#include <External/glm/vec3.hpp>
+#include <External/glm/vec4.hpp>
+#include <External/glm/mat4x4.hpp>
+#include <External/glad/glad.h>
+
+#include <mutex>
+
+namespace fgl
+{
+	/**
+	 * Immediate-mode lines for debugging: bounds, frusta, paths, normals.
+	 *
+	 * The Draw functions append the lines of a shape to one list from any thread, and the Renderer draws
+	 * everything recorded since its previous frame at the end of the Scene, before post-processing, then
+	 * forgets it: call them every frame the shapes should stay visible. The whole list is uploaded into one
+	 * streaming vertex buffer, orphaned every frame, and drawn as GL_LINES in a single draw call, depth tested
+	 * against the Scene without writing depth, whatever the number of shapes.
+	 *
+	 * The API only exists when FireGL is compiled with FIREGL_ENABLE_DEBUG_DRAW, which CMake defines outside
+	 * of Release builds. Call it through the FGL_DEBUG_* macros, which compile to nothing otherwise.
+	 */
+	class DebugDraw
+	{
+	public:
+		DebugDraw() = default;
+
+		/** Deletes the buffer and the shader. */
+		~DebugDraw();
+
+		DebugDraw(const DebugDraw&) = delete;
+		DebugDraw& operator=(const DebugDraw&) = delete;
+
+		/**
+		 * Records a line.
+		 *
+		 * @param From The start of the line in world space.
+		 * @param To The end of the line in world space.
+		 * @param Color The color and opacity of the line.
+		 */
+		static void DrawLine(const glm::vec3& From, const glm::vec3& To, const glm::vec4& Color);
+
+		/**
+		 * Records the 12 edges of an axis-aligned box.
+		 *
+		 * @param Min The corner of the box with the lowest coordinates.
+		 * @param Max The corner of the box with the highest coordinates.
+		 * @param Color The color and opacity of the edges.
+		 */
+		static void DrawAABB(const glm::vec3& Min, const glm::vec3& Max, const glm::vec4& Color);
+
+		/**
+		 * Records the three circles of a sphere around the axes.
+		 *
+		 * @param Center The center of the sphere in world space.
+		 * @param Radius The radius of the sphere.
+		 * @param Color The color and opacity of the circles.
+		 * @param Segments The lines per circle, at least 3.
+		 */
+		static void DrawSphere(const glm::vec3& Center, float Radius, const glm::vec4& Color, uint32_t Segments = 24);
+
+		/**
+		 * Records the 12 edges of a view frustum, e.g. of a camera or a shadow cascade.
+		 *
+		 * @param ViewProjection The projection times the view matrix of the frustum.
+		 * @param Color The color and opacity of the edges.
+		 */
+		static void DrawFrustum(const glm::mat4& ViewProjection, const glm::vec4& Color);
+
+		/**
+		 * Takes the lines recorded so far as the ones of the next Render(), new lines go to the next frame.
+		 * Called by the Renderer when it snapshots a frame.
+		 */
+		void Latch();
+
+		/** Draws the latched lines into the bound framebuffer, with the camera of the CameraData block. */
+		void Render();
+
+		/** Deletes the buffer and the shader. */
+		void Destroy();
+
+	private:
+		/** A line end: position and RGBA8 color. */
+		struct Vertex
+		{
+			glm::vec3 Position; ///< World space position.
+			uint32_t Color;     ///< Color and opacity, packed RGBA8.
+		};
+
+		/** Appends lines to the recording list, under its mutex. */
+		static void Append(const Vertex* Vertices, size_t Count);
+
+		static std::mutex s_Mutex;                  ///< Guards s_Recording against draws from several threads.
+		static std::vector<Vertex> s_Recording;     ///< Lines recorded since the last Latch(), two vertices each.
+
+		std::vector<Vertex> m_Latched;              ///< Lines of the next Render().
+		GLuint m_VertexBuffer = 0;                  ///< Streaming buffer of m_Latched, created on first use.
+		GLuint m_VertexArray = 0;                   ///< Layout of m_VertexBuffer.
+		size_t m_Capacity = 0;                      ///< Vertices m_VertexBuffer holds.
+		std::unique_ptr<Shader> m_Shader;           ///< Colored line shader, compiled on first use.
+	};
+
+} // namespace fgl
+
+#define FGL_DEBUG_LINE(...) ::fgl::DebugDraw::DrawLine(__VA_ARGS__)
+#define FGL_DEBUG_AABB(...) ::fgl::DebugDraw::DrawAABB(__VA_ARGS__)
+#define FGL_DEBUG_SPHERE(...) ::fgl::DebugDraw::DrawSphere(__VA_ARGS__)
+#define FGL_DEBUG_FRUSTUM(...) ::fgl::DebugDraw::DrawFrustum(__VA_ARGS__)
+#else
+#define FGL_DEBUG_LINE(...) ((void)0)
+#define FGL_DEBUG_AABB(...) ((void)0)
+#define FGL_DEBUG_SPHERE(...) ((void)0)
+#define FGL_DEBUG_FRUSTUM(...) ((void)0)
+#endif
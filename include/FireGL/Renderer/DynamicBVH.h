@@ -0,0 +1,154 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+#include <FireGL/Renderer/BoundingVolume.h>
+
+#include <External/glm/vec3.hpp>
+
+#include <span>
+
+namespace fgl
+{
+	class Frustum;
+
+	/**
+	 * Dynamic bounding volume hierarchy over axis-aligned boxes, one leaf per object.
+	 *
+	 * Leaves store a box enlarged by a margin around the object's bounds, so small movements refit nothing:
+	 * Move() only re-inserts a leaf once its bounds leave the enlarged box. Insertions pick the sibling that
+	 * grows the tree's surface area the least, and rotations keep the tree balanced, so every query rejects
+	 * whole subtrees at once and costs O(log N) plus the number of results.
+	 *
+	 * Queries report candidates whose enlarged box overlaps the volume; callers test their exact bounds.
+	 */
+	class DynamicBVH
+	{
+	public:
+		static constexpr int32_t NullNode = -1; ///< Index of no node.
+
+		/**
+		 * Adds a leaf for an object.
+		 *
+		 * @param ObjectIndex The object reported by the queries.
+		 * @param Box The world-space bounds of the object.
+		 * @return The leaf of the object, passed to Move() and Remove().
+		 */
+		int32_t Insert(uint32_t ObjectIndex, const BoundingBox& Box);
+
+		/**
+		 * Removes a leaf.
+		 *
+		 * @param Leaf The leaf returned by Insert().
+		 */
+		void Remove(int32_t Leaf);
+
+		/**
+		 * Updates the bounds of a leaf, re-inserting it only if they left its enlarged box.
+		 *
+		 * @param Leaf The leaf returned by Insert().
+		 * @param Box The new world-space bounds of the object.
+		 * @return True if the leaf was re-inserted.
+		 */
+		bool Move(int32_t Leaf, const BoundingBox& Box);
+
+		/**
+		 * Changes the object reported for a leaf, e.g. after the object moved in its container.
+		 *
+		 * @param Leaf The leaf returned by Insert().
+		 * @param ObjectIndex The object reported by the queries from now on.
+		 */
+		void SetObjectIndex(int32_t Leaf, uint32_t ObjectIndex);
+
+		/** Removes every leaf. */
+		void Clear();
+
+		/**
+		 * Appends the objects whose leaf is at least partly inside a frustum.
+		 * Subtrees entirely inside the frustum are reported without testing their nodes.
+		 *
+		 * @param ViewFrustum The frustum to test against.
+		 * @param OutObjects The candidates are appended to it.
+		 */
+		void QueryFrustum(const Frustum& ViewFrustum, std::vector<uint32_t>& OutObjects) const;
+
+		/**
+		 * Appends the objects whose leaf is at least partly inside any of several frustums, in one traversal.
+		 * A subtree is skipped once it is outside every frustum and reported whole once it is inside one of them.
+		 *
+		 * @param Frustums The frustums to test against, e.g. the cameras of several views.
+		 * @param OutObjects The candidates are appended to it, each once.
+		 */
+		void QueryFrustums(std::span<const Frustum> Frustums, std::vector<uint32_t>& OutObjects) const;
+
+		/**
+		 * Appends the objects whose leaf overlaps a box.
+		 *
+		 * @param Box The world-space box to test against.
+		 * @param OutObjects The candidates are appended to it.
+		 */
+		void QueryBox(const BoundingBox& Box, std::vector<uint32_t>& OutObjects) const;
+
+		/**
+		 * Appends the objects whose leaf overlaps a sphere.
+		 *
+		 * @param Sphere The world-space sphere to test against.
+		 * @param OutObjects The candidates are appended to it.
+		 */
+		void QuerySphere(const BoundingSphere& Sphere, std::vector<uint32_t>& OutObjects) const;
+
+		/**
+		 * Appends the objects whose leaf is crossed by a ray segment.
+		 *
+		 * @param Origin The start of the ray.
+		 * @param Direction The normalized direction of the ray.
+		 * @param MaxDistance The length of the segment.
+		 * @param OutObjects The candidates are appended to it.
+		 */
+		void QueryRay(const glm::vec3& Origin, const glm::vec3& Direction, float MaxDistance, std::vector<uint32_t>& OutObjects) const;
+
+		/** @return The height of the tree, 0 when it holds at most one leaf. */
+		int32_t GetHeight() const;
+
+	private:
+		struct Node
+		{
+			BoundingBox Box;             ///< Enlarged bounds for leaves, union of the children otherwise.
+			int32_t Parent = NullNode;   ///< Parent node, or next free node while unused.
+			int32_t Child1 = NullNode;   ///< First child, NullNode for leaves.
+			int32_t Child2 = NullNode;   ///< Second child, NullNode for leaves.
+			int32_t Height = 0;          ///< 0 for leaves, -1 while unused.
+			uint32_t ObjectIndex = 0;    ///< Object of a leaf.
+
+			bool IsLeaf() const { return Child1 == NullNode; }
+		};
+
+		/** Takes a node from the free list, growing the pool when empty. */
+		int32_t AllocateNode();
+
+		/** Returns a node to the free list. */
+		void FreeNode(int32_t Index);
+
+		/** Links a leaf into the tree next to the sibling with the lowest surface area cost. */
+		void InsertLeaf(int32_t Leaf);
+
+		/** Unlinks a leaf from the tree, keeping the node allocated. */
+		void RemoveLeaf(int32_t Leaf);
+
+		/** Refits the boxes and heights from a node up to the root, rebalancing on the way. */
+		void RefitAncestors(int32_t Index);
+
+		/**
+		 * Rotates the deeper grandchild of a node up if the heights of its children differ by more than one.
+		 * @return The node now at the position of Index.
+		 */
+		int32_t Balance(int32_t Index);
+
+		/** Appends every leaf of a subtree. */
+		void CollectLeaves(int32_t Index, std::vector<uint32_t>& OutObjects) const;
+
+		std::vector<Node> m_Nodes;          ///< Node pool, unused nodes are chained through Parent.
+		int32_t m_Root = NullNode;          ///< Root node.
+		int32_t m_FreeList = NullNode;      ///< First unused node.
+	};
+
+} // namespace fgl
\ No newline at end of file
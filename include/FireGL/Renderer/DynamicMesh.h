@@ -0,0 +1,144 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+#include <FireGL/Renderer/Vertex.h>
+
+#include <External/glm/mat4x4.hpp>
+#include <External/glad/glad.h>
+
+namespace fgl
+{
+	class Material;
+
+	/**
+	 * Geometry rewritten by the CPU every frame, e.g. trails, ropes or deformed meshes, without reallocating
+	 * nor waiting on the GPU.
+	 *
+	 * The vertices live in one buffer split into RegionCount regions of the mesh's capacity; every frame writes
+	 * the next region while the GPU may still read the previous ones. On OpenGL 4.4+ the buffer is persistently
+	 * mapped, older contexts map the written range unsynchronized. Either way a region is fenced after its last
+	 * draw and only waited on when reused, which stalls only if the GPU is RegionCount frames behind.
+	 *
+	 * Map() gives a range of this frame's vertices to write, Unmap() publishes them. The vertices outside the
+	 * range keep their previous values: they are copied on the GPU from the previous region, so a frame moving
+	 * the tip of a rope only writes the tip. Indices are static, set once with SetIndices(), or absent to draw
+	 * the vertices in order. Draws select the region with their base vertex, the vertex array never changes.
+	 *
+	 * Vertices have the layout of fgl::Vertex, so the materials of the regular meshes apply. The instance
+	 * attributes they read (the model and normal matrices, material index...) are passed as constant vertex
+	 * attributes by Draw(). Renderer::AddDynamicMesh() draws a mesh with the opaque geometry every frame.
+	 *
+	 *     Vertex* Rope = Mesh.Map(0, PointCount * 2);
+	 *     ...write the vertices...
+	 *     Mesh.Unmap();
+	 */
+	class DynamicMesh
+	{
+	public:
+		static constexpr size_t RegionCount = 3; ///< Frames whose vertices can be in flight at once.
+
+		DynamicMesh() = default;
+
+		/** Deletes the buffers, waiting for nothing. */
+		~DynamicMesh();
+
+		DynamicMesh(const DynamicMesh&) = delete;
+		DynamicMesh& operator=(const DynamicMesh&) = delete;
+
+		/**
+		 * Creates the vertex ring. Requires a current OpenGL context.
+		 *
+		 * @param MaxVertices The vertices a frame can hold, fixed for the life of the mesh.
+		 * @param Primitive The primitive the vertices or indices form, e.g. GL_TRIANGLES or GL_TRIANGLE_STRIP.
+		 */
+		void Create(uint32_t MaxVertices, GLenum Primitive = GL_TRIANGLES);
+
+		/** Deletes the buffers, the vertex array and the fences. */
+		void Destroy();
+
+		/** @return True once Create() was called. */
+		bool IsCreated() const;
+
+		/**
+		 * Sets the indices the vertices are drawn with, uploaded once. Every index must be below the capacity.
+		 *
+		 * @param Indices The indices, nullptr to draw the vertices in order.
+		 * @param Count The number of indices.
+		 */
+		void SetIndices(const uint32_t* Indices, uint32_t Count);
+
+		/**
+		 * Starts the next frame's vertices and maps a range of them for writing, once per frame. Waits only if the
+		 * GPU still reads the region, RegionCount frames later.
+		 *
+		 * @param First The first vertex written.
+		 * @param Count The number of vertices written, First + Count at most the capacity.
+		 * @return The vertices to write, write-only and valid until Unmap(); nullptr if the range doesn't fit.
+		 */
+		Vertex* Map(uint32_t First, uint32_t Count);
+
+		/** Publishes the vertices written since Map() and copies the others from the previous frame. */
+		void Unmap();
+
+		/**
+		 * Sets how many indices, or vertices when there are none, are drawn. Defaults to every index, or to the
+		 * end of the furthest range mapped so far.
+		 *
+		 * @param Count The number of elements drawn, clamped to the indices or the capacity.
+		 */
+		void SetDrawCount(uint32_t Count);
+
+		/** @return The number of elements drawn. */
+		uint32_t GetDrawCount() const;
+
+		/** @param DrawMaterial The material the Renderer draws the mesh with, nullptr to draw with the current program. */
+		void SetMaterial(std::shared_ptr<Material> DrawMaterial);
+
+		/** @return The material the mesh is drawn with. */
+		const std::shared_ptr<Material>& GetMaterial() const;
+
+		/** @param Model The object to world matrix the Renderer draws the mesh with. */
+		void SetTransform(const glm::mat4& Model);
+
+		/** @return The object to world matrix. */
+		const glm::mat4& GetTransform() const;
+
+		/**
+		 * Draws the last published vertices with the current program and fences their region.
+		 * Sets the instance attributes (locations 3 to 12 and 15, see InstanceData) to constants first.
+		 *
+		 * @param Model The object to world matrix.
+		 * @param MaterialIndex The record of the material in the material buffer, 0 if none.
+		 */
+		void Draw(const glm::mat4& Model, uint32_t MaterialIndex = 0);
+
+		/** Activates the material, if any, then draws the mesh with its transform. */
+		void Render();
+
+	private:
+		/** Waits for and deletes the fence of a region, if any. */
+		void WaitRegion(size_t Region);
+
+		GLuint m_VertexBuffer = 0;                 ///< RegionCount regions of m_Capacity vertices.
+		GLuint m_IndexBuffer = 0;                  ///< Static indices, 0 if drawn in order.
+		GLuint m_VertexArray = 0;                  ///< Vertex layout of m_VertexBuffer with m_IndexBuffer.
+		GLenum m_Primitive = GL_TRIANGLES;         ///< Primitive of the draws.
+		uint32_t m_Capacity = 0;                   ///< Vertices per region.
+		uint32_t m_IndexCount = 0;                 ///< Indices of m_IndexBuffer.
+		uint32_t m_VertexCount = 0;                ///< End of the furthest range mapped, the vertices kept from frame to frame.
+		uint32_t m_DrawCount = 0;                  ///< Elements drawn once SetDrawCount() was called.
+		bool m_bDrawCountSet = false;              ///< Whether SetDrawCount() overrides the default count.
+		bool m_bPersistent = false;                ///< Whether m_Mapped is a persistent mapping (OpenGL 4.4+).
+		Vertex* m_Mapped = nullptr;                ///< Persistent mapping of the whole buffer.
+		Vertex* m_Writing = nullptr;               ///< Range returned by Map(), nullptr outside Map()/Unmap().
+		uint32_t m_WriteFirst = 0;                 ///< First vertex of the range being written.
+		uint32_t m_WriteCount = 0;                 ///< Vertices of the range being written.
+		size_t m_Region = 0;                       ///< Region of the last published vertices.
+		size_t m_WriteRegion = 0;                  ///< Region being written between Map() and Unmap().
+		bool m_bPublished = false;                 ///< Whether a frame was published since Create().
+		std::array<GLsync, RegionCount> m_Fences{}; ///< Fence after the last draw of each region.
+		std::shared_ptr<Material> m_Material;      ///< Material the Renderer draws the mesh with.
+		glm::mat4 m_Transform = glm::mat4(1.0f);   ///< Object to world matrix the Renderer draws the mesh with.
+	};
+
+} // namespace fgl
@@ -3,6 +3,7 @@
 #include <FireGL/fglpch.h>
 #include <FireGL/Renderer/SceneObject.h>
 #include <FireGL/Renderer/Material.h>
+#include <FireGL/Renderer/ComponentPool.h>
 #include <FireGL/Core/BaseLog.h>
 
 namespace fgl
@@ -40,6 +41,12 @@ namespace fgl
 		template <typename T, std::enable_if_t<std::is_base_of_v<SceneObject, T>, bool> = true> 
 		Entity(std::shared_ptr<T> Object);
 
+		/** Returns the components of the entity to their pools. */
+		virtual ~Entity();
+
+		Entity(const Entity&) = delete;
+		Entity& operator=(const Entity&) = delete;
+
 		/**
 		 * Sets the material for the entity's object.
 		 *
@@ -61,12 +68,15 @@ namespace fgl
 		/**
 		 * Retrieves all meshes associated with the entity.
 		 *
-		 * @return A reference to a vector containing all meshes attached to the entity.
+		 * @return A span over the meshes of the entity's object.
 		 */
-		virtual std::vector<BaseMesh>& GetMeshes() override;
+		virtual std::span<BaseMesh> GetMeshes() override;
+
+		/** @return A read-only span over the meshes of the entity's object. */
+		virtual std::span<const BaseMesh> GetMeshes() const override;
 
 		/**
-		 * Retrieves the previously generated unique hash for the entity.
+		 * Retrieves the mesh identity of the wrapped object.
 		 *
 		 * @return A size_t representing the entity's hash value.
 		 */
@@ -74,6 +84,7 @@ namespace fgl
 
 		/**
 		 * Creates and attaches a component of type T to the entity.
+		 * The component is stored in ComponentPool<T>, next to the other components of its type.
 		 *
 		 * @tparam T The type of component to create (must derive from Component).
 		 * @return A pointer to the created component, or nullptr if a component of this type already exists.
@@ -91,16 +102,53 @@ namespace fgl
 		T* GetComponent();
 
 		/**
-		 * Removes a component by its unique identifier.
+		 * Removes the component of type T, if the entity has one.
 		 *
-		 * @param ID The unique ID of the component to remove.
+		 * @tparam T The type of component to remove.
+		 */
+		template<typename T>
+		void RemoveComponent();
+
+		/**
+		 * Removes a component by its type identifier.
+		 *
+		 * @param ID The type ID of the component to remove, ComponentPool<T>::GetTypeID().
 		 */
 		void RemoveComponent(size_t ID);
 
+		/**
+		 * The entity can be ticked in parallel when its OnTick() and its object are thread-safe.
+		 * Components are ticked by their pool, see Component::IsTickThreadSafe().
+		 *
+		 * @return True if IsOnTickThreadSafe() and the IsTickThreadSafe() of the object return true.
+		 */
+		virtual bool IsTickThreadSafe() const override final;
+
+		/**
+		 * Forwards the overlap to every component of the entity, see Component::OnOverlapBegin().
+		 *
+		 * @param Other The object whose bounding box started overlapping the entity's.
+		 */
+		virtual void OnOverlapBegin(SceneObject* Other) override final;
+
+		/**
+		 * Forwards the end of the overlap to every component of the entity, see Component::OnOverlapEnd().
+		 *
+		 * @param Other The object whose bounding box stopped overlapping the entity's.
+		 */
+		virtual void OnOverlapEnd(SceneObject* Other) override final;
+
 	protected:
 		/** Called every frame to update the entity. */
 		virtual void OnTick(float DeltaTime);
 
+		/**
+		 * Override to return true if OnTick() only touches this entity's own state, see SceneObject::IsTickThreadSafe().
+		 *
+		 * @return False by default.
+		 */
+		virtual bool IsOnTickThreadSafe() const;
+
 		/** Called when the entity is first initialized (at the start of play). */
 		virtual void OnBeginPlay();
 
@@ -112,6 +160,7 @@ namespace fgl
 		 * This function is often used for operations such as changing the depth function, binding buffers,
 		 * or preparing objects (e.g., skybox setup).
 		 * Example: You might change the depth function here before rendering and bind any resources.
+		 * Only called for skyboxes: batched entities are drawn from their RenderProxy (see SceneObject::CaptureRenderProxy()).
 		 */
 		virtual void OnPrepareRender() const;
 
@@ -125,7 +174,7 @@ namespace fgl
 
 	private:
 		/** Renders the entity's object. */
-		virtual void Render(size_t NumberInstance) const override final;
+		virtual void Render(size_t NumberInstance, size_t BaseInstance = 0, uint32_t LOD = 0) const override final;
 
 		/** Ticks the entity, updating its state. */
 		virtual void Tick(float DeltaTime) override final;
@@ -140,10 +189,13 @@ namespace fgl
 		std::shared_ptr<SceneObject> m_Object; ///< The object associated with this entity.
 
 		/**
-		 * Stores components attached to the entity.
+		 * Stores components attached to the entity, owned by their ComponentPool and indexed by type ID.
 		 * Only one component of each type can be attached at a time.
 		 */		
-		std::unordered_map<size_t, std::unique_ptr<Component>> m_Components;
+		std::array<Component*, ComponentPoolBase::MaxComponentTypes> m_Components = {};
+
+		/** Bit i is set if m_Components[i] holds a component. */
+		std::bitset<ComponentPoolBase::MaxComponentTypes> m_ComponentMask;
 	};
 
 	/**
@@ -164,13 +216,14 @@ namespace fgl
 	{
 		if (!GetComponent<T>())
 		{
-			LOG_ASSERT((std::is_base_of<Component, T>::value), "Invalid template parameter! Type T must derive from the Component class.")
-			size_t ID = typeid(T).hash_code();
+			const uint32_t ID = ComponentPool<T>::GetTypeID();
 
-			std::unique_ptr<T> ComponentPtr = std::make_unique<T>();
-			ComponentPtr->SetOwner(this);
-			m_Components.emplace(ID, std::move(ComponentPtr));
-			return static_cast<T*>(m_Components[ID].get());
+			T* Instance = ComponentPool<T>::Get().Create();
+			Instance->SetOwner(this);
+			Instance->SetScene(GetScene());
+			m_Components[ID] = Instance;
+			m_ComponentMask.set(ID);
+			return Instance;
 		}
 		
 		// Component of this type already exists.
@@ -183,17 +236,23 @@ namespace fgl
 	template<typename T>
 	T* Entity::GetComponent()
 	{
-		LOG_ASSERT((std::is_base_of<Component, T>::value), "Invalid template parameter! Type T must derive from the Component class.")
-		size_t ID = typeid(T).hash_code();
-		
-		auto It = m_Components.find(ID);
-		if (It != m_Components.end())
-		{
-			It->second.get();
-		}
+		static_assert(std::is_base_of_v<Component, T>, "Invalid template parameter! Type T must derive from the Component class.");
+		const uint32_t ID = ComponentPool<T>::GetTypeID();
 
 		// Component of this type not found.
-		return nullptr;
+		if (!m_ComponentMask.test(ID))
+			return nullptr;
+
+		return static_cast<T*>(m_Components[ID]);
+	}
+
+	/**
+	 * Implementation of RemoveComponent - Detaches the component of a type.
+	 */
+	template<typename T>
+	void Entity::RemoveComponent()
+	{
+		RemoveComponent(ComponentPool<T>::GetTypeID());
 	}
 
 } // namespace fgl
\ No newline at end of file
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+#include <FireGL/Renderer/FrameReadback.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace fgl
+{
+
+	/** A frame handed to a recording sink, on the encoder thread. */
+	struct CapturedFrame
+	{
+		std::vector<unsigned char> Pixels; ///< GL_RGBA8 rows, top row first, tightly packed.
+		int Width = 0;                     ///< Width of the frame in pixels.
+		int Height = 0;                    ///< Height of the frame in pixels.
+		uint64_t FrameIndex = 0;           ///< Frames rendered by the Renderer before this one.
+	};
+
+	/**
+	 * Screenshots and recordings of the rendered frames, without stalling the frame loop.
+	 *
+	 * The Renderer calls EndFrame() after each frame. Requested frames are copied through a FrameReadback ring and
+	 * mapped a couple of frames later, once the GPU is done with them; their pixels are then copied out and handed
+	 * to a background encoder thread, which flips them top row first and writes them. A synchronous glReadPixels
+	 * would wait for the whole frame to finish instead.
+	 *
+	 * Screenshots are written as PNG files. Recordings hand every frame to a sink, or append them as raw RGBA8 to a
+	 * file or named pipe, e.g. read by a video encoder with "-f rawvideo -pixel_format rgba".
+	 *
+	 * Requests may come from any thread; EndFrame() and Flush() run on the thread owning the OpenGL context.
+	 */
+	class FrameCapture
+	{
+	public:
+		/** Receives recorded frames on the encoder thread. */
+		using Sink = std::function<void(const CapturedFrame&)>;
+
+		FrameCapture();
+
+		/** Delivers the frames in flight, then stops the encoder once it wrote them. */
+		~FrameCapture();
+
+		FrameCapture(const FrameCapture&) = delete;
+		FrameCapture& operator=(const FrameCapture&) = delete;
+
+		/**
+		 * Captures the next rendered frame into a PNG file.
+		 *
+		 * @param Path The file to write, overwritten if it exists.
+		 */
+		void CaptureScreenshot(std::string_view Path);
+
+		/**
+		 * Hands every following frame to a sink until StopRecording().
+		 *
+		 * @param FrameSink Called on the encoder thread, in frame order.
+		 */
+		void StartRecording(Sink FrameSink);
+
+		/**
+		 * Appends every following frame as raw RGBA8 rows to a file or named pipe until StopRecording().
+		 *
+		 * @param Path The file to write, truncated first.
+		 * @return False if the file couldn't be opened.
+		 */
+		bool StartRecording(std::string_view Path);
+
+		/** Stops recording, the frames already captured are still delivered. */
+		void StopRecording();
+
+		/** @return True while recording. */
+		bool IsRecording() const;
+
+		/**
+		 * Captures the finished frame if requested and delivers the frames whose copy completed.
+		 *
+		 * @param Framebuffer The single-sample framebuffer holding the frame, 0 for the default framebuffer.
+		 * @param Width       The width of the frame in pixels.
+		 * @param Height      The height of the frame in pixels.
+		 */
+		void EndFrame(GLuint Framebuffer, int Width, int Height);
+
+		/** Waits until every captured frame is read back and written, e.g. before exiting. */
+		void Flush();
+
+	private:
+		/** A frame waiting for the encoder thread. */
+		struct EncodeJob
+		{
+			CapturedFrame Frame; ///< Pixels still bottom row first.
+			std::string Path;    ///< PNG file of a screenshot, empty for a recorded frame.
+			Sink FrameSink;      ///< Sink of a recorded frame.
+		};
+
+		/** A frame in the readback ring and the requests it serves. */
+		struct PendingCapture
+		{
+			std::vector<std::string> Screenshots; ///< PNG files to write.
+			Sink FrameSink;                       ///< Sink of the recording, empty if not recorded.
+		};
+
+		/** Copies a frame out of the readback ring and queues it to the encoder. */
+		void OnFrameRead(const ReadbackFrame& Frame);
+
+		/** Body of the encoder thread. */
+		void RunEncoder();
+
+		FrameReadback m_Readback;                  ///< Ring the frames are copied through.
+		std::deque<PendingCapture> m_InFlight;     ///< Captures in the ring, oldest first. GL thread only.
+		uint64_t m_FrameIndex = 0;                 ///< Frames ended so far. GL thread only.
+
+		mutable std::mutex m_RequestMutex;         ///< Guards the requests below.
+		std::vector<std::string> m_Screenshots;    ///< Screenshot paths of the next frame.
+		Sink m_RecordingSink;                      ///< Sink of the recording, empty when not recording.
+
+		std::thread m_Encoder;                     ///< Encodes and writes the frames, started on first use.
+		std::mutex m_EncoderMutex;                 ///< Guards the members below.
+		std::condition_variable m_EncoderCondition; ///< Signalled on new jobs, finished jobs and shutdown.
+		std::deque<EncodeJob> m_Jobs;              ///< Frames to encode, in capture order.
+		size_t m_ActiveJobs = 0;                   ///< Jobs taken by the encoder and not finished.
+		bool m_bStopping = false;                  ///< Set by the destructor.
+	};
+
+} // namespace fgl
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+
+#include <External/glad/glad.h>
+
+#include <functional>
+
+namespace fgl
+{
+
+	/** Pixels of one captured frame, valid only during the FrameReadback callback receiving them. */
+	struct ReadbackFrame
+	{
+		const unsigned char* Pixels = nullptr; ///< GL_RGBA8 rows, bottom row first, tightly packed.
+		int Width = 0;                         ///< Width of the frame in pixels.
+		int Height = 0;                        ///< Height of the frame in pixels.
+		uint64_t Tag = 0;                      ///< Value passed to Capture(), e.g. the frame or thumbnail index.
+	};
+
+	/**
+	 * Asynchronous readback of rendered frames through a ring of pixel pack buffers, for headless rendering.
+	 *
+	 * glReadPixels into client memory waits for the GPU to finish the frame. Capture() reads into a pixel buffer
+	 * instead and fences it, so the copy is queued behind the frame and the CPU moves on to the next one; the
+	 * pixels are handed to the callback a few frames later, once the fence signalled. Only a full ring makes
+	 * Capture() wait, for its oldest frame.
+	 *
+	 * On OpenGL 4.4+ the buffers are persistently mapped, older contexts map each buffer when its frame is delivered.
+	 * Every call must run on the thread owning the OpenGL context.
+	 */
+	class FrameReadback
+	{
+	public:
+		static constexpr size_t DefaultDepth = 3; ///< Frames in flight by default.
+
+		/** Receives the captured frames, oldest first. */
+		using Callback = std::function<void(const ReadbackFrame&)>;
+
+		/**
+		 * @param Depth    Frames in flight at most, at least 1.
+		 * @param OnFrame  Receives every captured frame.
+		 */
+		explicit FrameReadback(Callback OnFrame, size_t Depth = DefaultDepth);
+
+		/** Deletes the buffers, frames still in flight are dropped. */
+		~FrameReadback();
+
+		FrameReadback(const FrameReadback&) = delete;
+		FrameReadback& operator=(const FrameReadback&) = delete;
+
+		/**
+		 * Queues the copy of the first color attachment of a framebuffer. Doesn't wait for the GPU unless the ring is
+		 * full, in which case the oldest frame is delivered first.
+		 *
+		 * @param Framebuffer The single-sample framebuffer to read, e.g. RenderTarget::GetResolveFramebuffer().
+		 * @param Width       The width of the region read from the bottom-left corner, in pixels.
+		 * @param Height      The height of the region read, in pixels.
+		 * @param Tag         Handed back with the frame.
+		 */
+		void Capture(GLuint Framebuffer, int Width, int Height, uint64_t Tag = 0);
+
+		/**
+		 * Delivers the frames the GPU finished copying, without waiting.
+		 * @return The number of frames delivered.
+		 */
+		size_t Collect();
+
+		/** Waits for and delivers every frame in flight, e.g. after the last capture. */
+		void Flush();
+
+		/** @return The number of captured frames not delivered yet. */
+		size_t GetPendingCount() const;
+
+		/** Deletes the buffers and their fences, frames in flight are dropped. */
+		void Destroy();
+
+	private:
+		/** A pixel pack buffer and the frame copied into it. */
+		struct Slot
+		{
+			GLuint Buffer = 0;
+			size_t Capacity = 0;
+			const void* Mapped = nullptr; ///< Persistent mapping (OpenGL 4.4+).
+			GLsync Fence = nullptr;       ///< Signalled once the frame is copied, nullptr if the slot is free.
+			int Width = 0;
+			int Height = 0;
+			uint64_t Tag = 0;
+		};
+
+		/**
+		 * Hands the oldest frame to the callback and frees its slot.
+		 *
+		 * @param bWait True to wait for its copy, false to return false if it isn't finished.
+		 * @return True if the frame was delivered.
+		 */
+		bool DeliverOldest(bool bWait);
+
+		/** (Re)creates the storage of a buffer so it holds at least Size bytes. */
+		void AllocateBuffer(Slot& Target, size_t Size);
+
+		/** Deletes the buffer of a slot. */
+		static void DestroyBuffer(Slot& Target);
+
+		Callback m_OnFrame;         ///< Receives the frames.
+		std::vector<Slot> m_Slots;  ///< The ring.
+		size_t m_Oldest = 0;        ///< Slot of the oldest frame in flight.
+		size_t m_PendingCount = 0;  ///< Frames in flight, in the slots following m_Oldest.
+	};
+
+} // namespace fgl
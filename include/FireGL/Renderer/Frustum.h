@@ -0,0 +1,52 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+#include <FireGL/Renderer/BoundingVolume.h>
+
+#include <External/glm/vec4.hpp>
+#include <External/glm/mat4x4.hpp>
+
+namespace fgl
+{
+
+	/**
+	 * View frustum described by six inward-facing planes, extracted from a view-projection matrix.
+	 *
+	 * Each plane is stored as (Normal, Distance) in a glm::vec4, so a point P is inside the half-space
+	 * when dot(Plane.xyz, P) + Plane.w >= 0.
+	 */
+	class Frustum
+	{
+	public:
+		enum PlaneIndex
+		{
+			Left, Right, Bottom, Top, Near, Far, PlaneCount
+		};
+
+		/** Constructs a frustum that contains everything. */
+		Frustum();
+
+		/**
+		 * Extracts the frustum planes from a view-projection matrix.
+		 * The near plane follows OpenGL's -w..w clip volume, so nothing OpenGL would draw is rejected.
+		 *
+		 * @param ViewProjection Projection * View of the camera.
+		 */
+		explicit Frustum(const glm::mat4& ViewProjection);
+
+		/**
+		 * Tests a world-space sphere against the frustum.
+		 *
+		 * @param Sphere The sphere to test.
+		 * @return False if the sphere is entirely outside one of the planes, true otherwise.
+		 */
+		bool IsVisible(const BoundingSphere& Sphere) const;
+
+		/** @return The normalized frustum planes. */
+		const std::array<glm::vec4, PlaneCount>& GetPlanes() const;
+
+	private:
+		std::array<glm::vec4, PlaneCount> m_Planes; ///< Normalized planes, in PlaneIndex order.
+	};
+
+} // namespace fgl
\ No newline at end of file
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+#include <FireGL/Renderer/Frustum.h>
+#include <FireGL/Renderer/BoundingVolume.h>
+
+namespace fgl
+{
+
+	/**
+	 * Tests every sphere of a structure-of-arrays set against the six planes of a frustum and writes
+	 * the indices of the potentially visible ones, in increasing order, to OutVisibleIndices.
+	 *
+	 * Spheres are tested 8 at a time with AVX2 (when FireGL is built with FIREGL_ENABLE_AVX2),
+	 * 4 at a time with SSE2 on x86-64 or NEON on ARM64, and one at a time for the remainder.
+	 *
+	 * @param ViewFrustum The frustum to test against.
+	 * @param Spheres The world-space spheres.
+	 * @param OutVisibleIndices Cleared, then filled with the indices of the spheres intersecting the frustum.
+	 */
+	void CullSpheres(const Frustum& ViewFrustum, const BoundingSphereArrays& Spheres, std::vector<uint32_t>& OutVisibleIndices);
+
+} // namespace fgl
\ No newline at end of file
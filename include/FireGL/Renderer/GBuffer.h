@@ -0,0 +1,77 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+
+#include <External/glad/glad.h>
+
+namespace fgl
+{
+	class Shader;
+
+	/**
+	 * Render targets of the deferred geometry pass, and the full-screen pass resolving their lighting.
+	 *
+	 * The geometry pass writes the surface of every visible pixel instead of shading it:
+	 *
+	 *     layout (location = 0) out vec4 gAlbedoSpecular;   // GL_RGBA8: albedo, specular intensity
+	 *     layout (location = 1) out vec4 gNormalRoughness;  // GL_RGB10_A2: octahedral normal, roughness, unused
+	 *
+	 * Positions are not stored, the lighting pass rebuilds them from the depth attachment and the inverse
+	 * view-projection. Resolve() then runs the lighting shader once per pixel, reading the attachments from
+	 * the samplers gAlbedoSpecular, gNormalRoughness and gDepth, so the lighting cost no longer depends on
+	 * how many surfaces were drawn over each other.
+	 */
+	class GBuffer
+	{
+	public:
+		static constexpr uint32_t AlbedoSpecularUnit = 0;  ///< Texture unit of the albedo / specular attachment during Resolve().
+		static constexpr uint32_t NormalRoughnessUnit = 1; ///< Texture unit of the normal / roughness attachment during Resolve().
+		static constexpr uint32_t DepthUnit = 2;           ///< Texture unit of the depth attachment during Resolve().
+
+		/** Releases the framebuffer and its attachments. */
+		~GBuffer();
+
+		/**
+		 * (Re)creates the attachments if the size changed. Requires a current OpenGL context.
+		 *
+		 * @param Width    The width of the render targets in pixels.
+		 * @param Height   The height of the render targets in pixels.
+		 */
+		void Resize(int Width, int Height);
+
+		/** Deletes the framebuffer, its attachments and the full-screen vertex array. */
+		void Destroy();
+
+		/** Binds the framebuffer for the geometry pass and clears it. */
+		void BindForGeometry() const;
+
+		/**
+		 * Binds the output framebuffer and draws a full-screen triangle with the lighting shader.
+		 * The lighting shader writes gl_FragDepth from gDepth, so forward passes drawn afterwards (skybox,
+		 * transparent objects) are depth tested against the deferred surfaces.
+		 *
+		 * @param LightingShader The shader resolving the lighting of every pixel.
+		 * @param Framebuffer    The framebuffer the lit pixels are written to, the default framebuffer if 0.
+		 */
+		void Resolve(const Shader& LightingShader, GLuint Framebuffer = 0) const;
+
+		/** @return The width of the render targets in pixels. */
+		int GetWidth() const;
+
+		/** @return The height of the render targets in pixels. */
+		int GetHeight() const;
+
+	private:
+		/** Creates a 2D attachment texture of the current size. */
+		GLuint CreateAttachment(GLenum InternalFormat, GLenum Format, GLenum Type) const;
+
+		GLuint m_Framebuffer = 0;           ///< Framebuffer of the geometry pass.
+		GLuint m_AlbedoSpecular = 0;        ///< Color attachment 0.
+		GLuint m_NormalRoughness = 0;       ///< Color attachment 1.
+		GLuint m_Depth = 0;                 ///< Depth attachment.
+		GLuint m_FullScreenVertexArray = 0; ///< Empty vertex array, the full-screen triangle is generated from gl_VertexID.
+		int m_Width = 0;                    ///< Width of the attachments.
+		int m_Height = 0;                   ///< Height of the attachments.
+	};
+
+} // namespace fgl
\ No newline at end of file
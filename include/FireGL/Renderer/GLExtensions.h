@@ -0,0 +1,104 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+
+#include <External/glad/glad.h>
+
+namespace fgl
+{
+
+	/**
+	 * Queries of the OpenGL extensions FireGL uses beyond the loaded core versions.
+	 *
+	 * The extension list is read once, on the first query, so a context must be current. Extensions the
+	 * generated loader doesn't cover get their entry points loaded here.
+	 */
+	class GLExtensions
+	{
+	public:
+		static constexpr GLenum CompletionStatus = 0x91B1; ///< GL_COMPLETION_STATUS_KHR, missing from the generated loader.
+		static constexpr GLenum TextureSparse = 0x91A6;    ///< GL_TEXTURE_SPARSE_ARB, set before a texture's storage is allocated.
+		static constexpr GLenum VirtualPageSizeX = 0x9195; ///< GL_VIRTUAL_PAGE_SIZE_X_ARB, width of a sparse page of a format.
+		static constexpr GLenum VirtualPageSizeY = 0x9196; ///< GL_VIRTUAL_PAGE_SIZE_Y_ARB, height of a sparse page of a format.
+
+		/**
+		 * Checks whether the context exposes an extension.
+		 *
+		 * @param Name The extension name, e.g. "GL_ARB_bindless_texture".
+		 * @return True if the extension is in the context's extension list.
+		 */
+		static bool Has(std::string_view Name);
+
+		/**
+		 * Checks for GL_ARB_bindless_texture and loads its entry points.
+		 * The material buffer using the handles also needs shader storage buffers (OpenGL 4.3).
+		 *
+		 * @return True if the bindless texture functions below can be called.
+		 */
+		static bool HasBindlessTexture();
+
+		/** @return The bindless handle of a texture, using its own sampler state (glGetTextureHandleARB). */
+		static GLuint64 GetTextureHandle(GLuint Texture);
+
+		/** Makes a bindless handle resident, so shaders can sample it (glMakeTextureHandleResidentARB). */
+		static void MakeTextureHandleResident(GLuint64 Handle);
+
+		/** Makes a bindless handle non-resident before its texture is deleted (glMakeTextureHandleNonResidentARB). */
+		static void MakeTextureHandleNonResident(GLuint64 Handle);
+
+		/**
+		 * Checks for GL_KHR_parallel_shader_compile (or its ARB twin) and loads its entry point.
+		 * With it, compile and link commands return immediately and glGetProgramiv(CompletionStatus)
+		 * tells whether querying the link status would still block.
+		 *
+		 * @return True if the extension is available.
+		 */
+		static bool HasParallelShaderCompile();
+
+		/** Sets how many threads the driver may compile shaders on (glMaxShaderCompilerThreadsKHR). */
+		static void SetMaxShaderCompilerThreads(GLuint Count);
+
+		/**
+		 * Checks for GL_ARB_sparse_texture and loads its entry point. A sparse texture reserves its address space
+		 * when its immutable storage (OpenGL 4.2) is allocated, memory is only backed once pages are committed.
+		 *
+		 * @return True if TexPageCommitment() can be called.
+		 */
+		static bool HasSparseTexture();
+
+		/** Commits or releases the memory of a region of a sparse 2D texture, aligned to its pages (glTexPageCommitmentARB). */
+		static void TexPageCommitment(GLenum Target, GLint Level, GLint X, GLint Y, GLsizei Width, GLsizei Height, bool bCommit);
+
+		/**
+		 * Checks for SPIR-V shader modules, core in OpenGL 4.6 and GL_ARB_gl_spirv before, and loads the
+		 * extension's entry point if needed.
+		 *
+		 * @return True if SpecializeShader() can be called on modules given to glShaderBinary().
+		 */
+		static bool HasSPIRV();
+
+		/**
+		 * Checks for immutable texture storage, core in OpenGL 4.2 and GL_ARB_texture_storage before, and loads
+		 * the extension's entry point if needed. Immutable textures are allocated once with all their levels,
+		 * sparing drivers the completeness and format checks of textures respecified level by level.
+		 *
+		 * @return True if TexStorage2D() can be called.
+		 */
+		static bool HasTextureStorage();
+
+		/** Allocates the immutable storage of the 2D or cube map texture bound to Target (glTexStorage2D). */
+		static void TexStorage2D(GLenum Target, GLsizei LevelCount, GLenum InternalFormat, GLsizei Width, GLsizei Height);
+
+		/**
+		 * Checks for anisotropic filtering, core in OpenGL 4.6 and GL_EXT_texture_filter_anisotropic
+		 * (or GL_ARB_texture_filter_anisotropic) before, which share the GL_TEXTURE_MAX_ANISOTROPY enums.
+		 *
+		 * @return True if GL_TEXTURE_MAX_ANISOTROPY can be set.
+		 */
+		static bool HasAnisotropicFiltering();
+
+		/** Sets the entry point and specialization constants of a SPIR-V module, compiling it (glSpecializeShader). */
+		static void SpecializeShader(GLuint Shader, const char* EntryPoint, GLuint ConstantCount, const GLuint* ConstantIndices, const GLuint* ConstantValues);
+	};
+
+} // namespace fgl
\ No newline at end of file
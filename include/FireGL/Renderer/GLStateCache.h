@@ -0,0 +1,134 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+#include <FireGL/Renderer/RasterState.h>
+
+#include <External/glad/glad.h>
+
+namespace fgl
+{
+
+	/**
+	 * Central tracker of the OpenGL bindings FireGL changes most often.
+	 *
+	 * Every bind in FireGL goes through this class, which remembers the bound program, vertex array,
+	 * GL_ARRAY_BUFFER / GL_UNIFORM_BUFFER / GL_DRAW_INDIRECT_BUFFER buffers, active texture unit, the 2D / cube map texture
+	 * and the sampler object of each unit, and skips calls that would bind what is already bound. Drivers validate state on
+	 * every bind, so redundant calls cost CPU time even when nothing changes. The raster state materials
+	 * change (face culling, depth function and depth writes) is tracked the same way.
+	 *
+	 * The cache assumes a single OpenGL context and that bindings are not changed behind its back.
+	 * Code issuing raw glBind* calls must call Invalidate() afterwards.
+	 */
+	class GLStateCache
+	{
+	public:
+		static constexpr size_t MaxTextureUnits = 32; ///< Texture units tracked, matching Material's texture limit.
+
+		/** Binds a shader program (glUseProgram) if it isn't the current one. */
+		static void UseProgram(GLuint Program);
+
+		/** Binds a vertex array object if it isn't the current one. */
+		static void BindVertexArray(GLuint VertexArray);
+
+		/**
+		 * Binds a buffer to a target if it isn't already bound there.
+		 * GL_ARRAY_BUFFER, GL_UNIFORM_BUFFER and GL_DRAW_INDIRECT_BUFFER are cached; other targets are forwarded as is
+		 * (GL_ELEMENT_ARRAY_BUFFER is vertex array state and must not be cached globally).
+		 */
+		static void BindBuffer(GLenum Target, GLuint Buffer);
+
+		/** Selects the active texture unit (0-based) if it isn't the current one. */
+		static void ActiveTexture(uint32_t Unit);
+
+		/**
+		 * Binds a texture to the active texture unit if it isn't already bound there.
+		 * GL_TEXTURE_2D and GL_TEXTURE_CUBE_MAP are cached; other targets are forwarded as is.
+		 */
+		static void BindTexture(GLenum Target, GLuint Texture);
+
+		/**
+		 * Binds a texture to the given unit, selecting the unit first.
+		 * The unit's sampler object is bound along, so a sampler left by another texture never overrides
+		 * the parameters of a texture bound without one.
+		 *
+		 * @param Sampler The sampler object to sample the texture with (see SamplerCache), 0 for the texture's own parameters.
+		 */
+		static void BindTextureUnit(uint32_t Unit, GLenum Target, GLuint Texture, GLuint Sampler = 0);
+
+		/** Binds a sampler object to a texture unit if it isn't already bound there. */
+		static void BindSampler(uint32_t Unit, GLuint Sampler);
+
+		/** Enables face culling for the given faces, or disables it, if it isn't the current mode. */
+		static void SetCullMode(CullMode Mode);
+
+		/** Sets the depth comparison (glDepthFunc) if it isn't the current one. */
+		static void SetDepthFunc(GLenum Func);
+
+		/** Enables or disables depth writes (glDepthMask) if they aren't already. */
+		static void SetDepthWrite(bool bWrite);
+
+		/**
+		 * Applies the raster state of a material, skipping what is already set.
+		 * The depth function and writes are left alone while a depth override is active.
+		 */
+		static void ApplyRasterState(const RasterState& State);
+
+		/**
+		 * Restores the state draws without a material expect: no culling, GL_LESS and depth writes
+		 * (the depth state only when no override is active). Called after every material-driven pass.
+		 */
+		static void ResetRasterState();
+
+		/**
+		 * Sets the depth state of a pass, which the materials drawn until EndDepthOverride() can't change,
+		 * e.g. GL_EQUAL without writes for the shading pass after a depth prepass. Overrides don't nest.
+		 *
+		 * @param Func The depth comparison of the pass.
+		 * @param bWrite Whether the pass writes depth.
+		 */
+		static void BeginDepthOverride(GLenum Func, bool bWrite);
+
+		/** Ends the override started by BeginDepthOverride(), restoring GL_LESS and depth writes. */
+		static void EndDepthOverride();
+
+		/** Forgets a deleted program so a new object reusing its name is bound again. */
+		static void OnProgramDeleted(GLuint Program);
+
+		/** Forgets a deleted vertex array. */
+		static void OnVertexArrayDeleted(GLuint VertexArray);
+
+		/** Forgets a deleted buffer. */
+		static void OnBufferDeleted(GLuint Buffer);
+
+		/** Forgets a deleted texture on every unit. */
+		static void OnTextureDeleted(GLuint Texture);
+
+		/** Forgets every cached binding and raster state, forcing the next calls through to OpenGL. */
+		static void Invalidate();
+
+	private:
+		static constexpr GLuint Unknown = std::numeric_limits<GLuint>::max(); ///< Binding not known to the cache.
+
+		/** @return The cached slot of a buffer target, or nullptr if the target isn't cached. */
+		static GLuint* GetBufferSlot(GLenum Target);
+
+		/** @return The cached slot of a texture target on the active unit, or nullptr if not cached. */
+		static GLuint* GetTextureSlot(GLenum Target);
+
+		static GLuint s_Program;                                     ///< Current program.
+		static GLuint s_VertexArray;                                 ///< Current vertex array.
+		static GLuint s_ArrayBuffer;                                 ///< Current GL_ARRAY_BUFFER binding.
+		static GLuint s_UniformBuffer;                               ///< Current GL_UNIFORM_BUFFER binding.
+		static GLuint s_DrawIndirectBuffer;                          ///< Current GL_DRAW_INDIRECT_BUFFER binding.
+		static uint32_t s_ActiveUnit;                                ///< Current texture unit, or Unknown.
+		static std::array<GLuint, MaxTextureUnits> s_Texture2D;      ///< GL_TEXTURE_2D binding per unit.
+		static std::array<GLuint, MaxTextureUnits> s_TextureCubeMap; ///< GL_TEXTURE_CUBE_MAP binding per unit.
+		static std::array<GLuint, MaxTextureUnits> s_Sampler;        ///< Sampler object binding per unit.
+		static GLuint s_CullMode;                                    ///< Current CullMode, or Unknown.
+		static GLenum s_DepthFunc;                                   ///< Current depth comparison, or Unknown.
+		static GLuint s_DepthWrite;                                  ///< 1 if depth writes are enabled, 0 if not, or Unknown.
+		static bool s_bDepthOverridden;                              ///< Whether a pass holds the depth state, see BeginDepthOverride().
+	};
+
+} // namespace fgl
\ No newline at end of file
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+#include <FireGL/Renderer/MatrixBuffer.h>
+#include <FireGL/Renderer/IndirectDrawBuffer.h>
+#include <FireGL/Renderer/Shader.h>
+
+#include <External/glm/vec4.hpp>
+#include <External/glad/glad.h>
+
+namespace fgl
+{
+	class BaseCamera;
+	class HiZBuffer;
+
+	/**
+	 * One object of the GPU culling pass, laid out to match std430.
+	 * The instance data is copied as is to the instance buffer when the object is visible.
+	 */
+	struct GPUCullingObject
+	{
+		InstanceData Instance = {};                 ///< Instance data drawn for the object.
+		glm::vec4 BoundingSphere = glm::vec4(0.0f); ///< World-space center, radius in w.
+		uint32_t BatchIndex = UINT32_MAX;           ///< Batch of level 0 of the object, UINT32_MAX to never draw it.
+		uint32_t Layers = 0;                        ///< Render layers of the object, tested against the camera's culling mask.
+		uint32_t Padding[2] = {};                   ///< Keeps the stride a multiple of 16 bytes.
+	};
+
+	/** One batch level of the GPU culling pass, laid out to match std430. */
+	struct GPUCullingBatch
+	{
+		uint32_t LOD;      ///< Level of detail of the batch, the batch of level 0 is LOD batches before it.
+		uint32_t LODCount; ///< Number of levels of the batch's key.
+		float ScreenSize;  ///< Projected size below which this level is selected.
+		uint32_t Padding;  ///< Keeps the record 16 bytes.
+	};
+
+	/**
+	 * GPU-driven culling and level of detail selection (OpenGL 4.3+).
+	 *
+	 * Keeps a copy of every object's instance data and bounds in a storage buffer, updated only for the objects
+	 * edited with SetObject(), and of the renderer's batches. Every frame Cull() runs three compute dispatches:
+	 * the first tests each object against the camera frustum and culling mask, selects its level of detail and
+	 * counts it in the batch of that level; a single workgroup then turns the counts into offsets and writes them to the
+	 * InstanceCount and BaseInstance of the indirect commands; the last copies the instance data of every visible
+	 * object to its slot in the instance buffer. The commands are then drawn with glMultiDrawElementsIndirect, with
+	 * the instance buffer as the source of the instanced attributes, without the CPU reading anything back.
+	 *
+	 *     layout (std430, binding = 4) readonly buffer CullingObjectData { ObjectRecord Objects[]; };
+	 *     layout (std430, binding = 5) readonly buffer CullingBatchData { BatchRecord Batches[]; };
+	 *     layout (std430, binding = 6) coherent buffer CullingCountData { uvec2 Counts[]; };     // instances, first instance
+	 *     layout (std430, binding = 7) buffer CullingVisibilityData { uvec2 Visibility[]; };     // batch, slot in the batch
+	 *     layout (std430, binding = 8) writeonly buffer CullingInstanceData { InstanceData Instances[]; };
+	 *     layout (std430, binding = 9) buffer CullingCommandData { DrawCommand Commands[]; };
+	 *     layout (std430, binding = 10) readonly buffer CullingCommandBatchData { uint CommandBatches[]; };
+	 *
+	 * With a HiZBuffer of the previous frame, objects behind the depth it holds are culled as well (see HiZBuffer).
+	 * Objects are culled by bounding sphere only; with it the sort by depth and the Entity render hooks are
+	 * given up, batches are drawn in the order of their commands.
+	 */
+	class GPUCulling
+	{
+	public:
+		static constexpr GLuint ObjectBindingPoint = 4;       ///< Shader storage binding point of the objects.
+		static constexpr GLuint BatchBindingPoint = 5;        ///< Shader storage binding point of the batches.
+		static constexpr GLuint CountBindingPoint = 6;        ///< Shader storage binding point of the per-batch counts.
+		static constexpr GLuint VisibilityBindingPoint = 7;   ///< Shader storage binding point of the per-object results.
+		static constexpr GLuint InstanceBindingPoint = 8;     ///< Shader storage binding point of the instance buffer.
+		static constexpr GLuint CommandBindingPoint = 9;      ///< Shader storage binding point of the indirect commands.
+		static constexpr GLuint CommandBatchBindingPoint = 10; ///< Shader storage binding point of the batch of each command.
+		static constexpr uint32_t NoBatch = UINT32_MAX;       ///< Batch index of objects that are never drawn.
+
+		/** @return True if the context supports compute shaders and indirect drawing (OpenGL 4.3). */
+		static bool IsSupported();
+
+		/** Creates the storage buffers and compiles the compute shaders. Requires a current OpenGL context. */
+		void Create();
+
+		/** Deletes the storage buffers and the compute shaders. */
+		void Destroy();
+
+		/** @return True once Create() was called. */
+		bool IsCreated() const;
+
+		/**
+		 * Resizes the object list, new objects are never drawn until set.
+		 *
+		 * @param Count The number of objects, e.g. the number of objects of the Scene.
+		 */
+		void SetObjectCount(size_t Count);
+
+		/**
+		 * Replaces an object, uploaded by the next Cull().
+		 *
+		 * @param Index Index of the object, below the object count.
+		 * @param Object The object's instance data, bounds and batch.
+		 */
+		void SetObject(size_t Index, const GPUCullingObject& Object);
+
+		/**
+		 * Appends a batch level; batches are referenced by their index in the order they were added.
+		 *
+		 * @param Batch The level of detail data of the batch.
+		 */
+		void AddBatch(const GPUCullingBatch& Batch);
+
+		/** @return The number of batches added. */
+		size_t GetBatchCount() const;
+
+		/** Removes every indirect command, before they are recorded again. */
+		void ClearCommands();
+
+		/**
+		 * Records an indirect command, its instance count and base instance are written by Cull().
+		 *
+		 * @param Command The draw of one mesh of a batch.
+		 * @param BatchIndex The batch whose visible objects the command draws.
+		 */
+		void PushCommand(const DrawElementsIndirectCommand& Command, uint32_t BatchIndex);
+
+		/** Uploads the recorded commands, kept until they are recorded again. */
+		void UploadCommands();
+
+		/**
+		 * Uploads the changed objects and batches, then culls the objects and fills the commands and the
+		 * instance buffer on the GPU. Ends with the barriers the indirect draws and the attribute fetches need.
+		 *
+		 * @param Camera The camera the frame is rendered from, objects outside of its culling mask are skipped.
+		 * @param bFrustumCulling Whether objects outside the camera frustum are skipped.
+		 * @param bLevelOfDetail Whether levels are selected by projected size, see Renderer::SetLevelOfDetail().
+		 * @param LODBias Scale applied to projected sizes before selecting levels.
+		 * @param Occlusion Depth pyramid of the previous frame to test the objects against, nullptr for no occlusion culling.
+		 */
+		void Cull(BaseCamera& Camera, bool bFrustumCulling, bool bLevelOfDetail, float LODBias, const HiZBuffer* Occlusion = nullptr);
+
+		/** @return The indirect commands, bind them with IndirectDrawBuffer::Bind() before drawing. */
+		const IndirectDrawBuffer& GetCommands() const;
+
+		/** @return The buffer the visible objects' instance data is written to, read as InstanceData. */
+		GLuint GetInstanceBuffer() const;
+
+	private:
+		/** Replaces the storage of a storage buffer with Size bytes of Data (uninitialized if null), or with a zeroed word if Size is 0. */
+		static void Allocate(GLuint Buffer, const void* Data, size_t Size, GLenum Usage);
+
+		/** Uploads the objects edited since the last frame, reallocating the per-object buffers if they grew. */
+		void UploadObjects();
+
+		std::vector<GPUCullingObject> m_Objects;   ///< Every object, as uploaded.
+		size_t m_ObjectCapacity = 0;               ///< Number of objects the per-object buffers can hold.
+		size_t m_DirtyBegin = SIZE_MAX;            ///< First object edited since the last upload.
+		size_t m_DirtyEnd = 0;                     ///< One past the last object edited since the last upload.
+		std::vector<GPUCullingBatch> m_Batches;    ///< Every batch level, by batch index.
+		size_t m_UploadedBatchCount = 0;           ///< Number of batches in the batch buffer.
+		std::vector<uint32_t> m_CommandBatches;    ///< Batch of every recorded command.
+		IndirectDrawBuffer m_Commands;             ///< Indirect commands, completed on the GPU.
+		GLuint m_ObjectBuffer = 0;                 ///< Storage buffer of the objects.
+		GLuint m_BatchBuffer = 0;                  ///< Storage buffer of the batches.
+		GLuint m_CountBuffer = 0;                  ///< Storage buffer of the visible instance count and first instance of each batch.
+		GLuint m_VisibilityBuffer = 0;             ///< Storage buffer of the batch and slot of each visible object.
+		GLuint m_InstanceBuffer = 0;               ///< Instance data of the visible objects, grouped by batch.
+		GLuint m_CommandBatchBuffer = 0;           ///< Storage buffer of the batch of each command.
+		std::unique_ptr<Shader> m_CullShader;      ///< Frustum test, level selection and counting.
+		std::unique_ptr<Shader> m_ScanShader;      ///< Counts to offsets, commands completion.
+		std::unique_ptr<Shader> m_WriteShader;     ///< Instance data copy.
+		UniformHandle m_CullObjectCount;           ///< Uniforms of the compute shaders, resolved once in Create().
+		UniformHandle m_CullFrustumPlanes;
+		UniformHandle m_CullCameraPosition;
+		UniformHandle m_CullSizeScale;
+		UniformHandle m_CullOrthographic;
+		UniformHandle m_CullFrustumCulling;
+		UniformHandle m_CullLevelOfDetail;
+		UniformHandle m_CullOcclusionCulling;
+		UniformHandle m_CullCullingMask;
+		UniformHandle m_CullOcclusionViewProjection;
+		UniformHandle m_CullHiZ;
+		UniformHandle m_CullHiZSize;
+		UniformHandle m_CullHiZMaxLevel;
+		UniformHandle m_ScanBatchCount;
+		UniformHandle m_ScanCommandCount;
+		UniformHandle m_WriteObjectCount;
+	};
+
+} // namespace fgl
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+
+#include <External/glad/glad.h>
+
+namespace fgl
+{
+
+	/** What an OpenGL allocation is used for. */
+	enum class GPUMemoryCategory : uint8_t
+	{
+		Geometry,      ///< Vertex and index buffers: the GeometryArena every mesh lives in, and helper meshes.
+		Instances,     ///< Per-instance model matrices of the MatrixBuffer.
+		Uniforms,      ///< Uniform buffers: camera, lights, shadows and material parameters.
+		Storage,       ///< Shader storage buffers: the MaterialBuffer, clustered lights and GPU culling.
+		Indirect,      ///< Indirect draw commands.
+		Staging,       ///< Pixel buffers of the PixelUploadPool and of FrameReadback.
+		Textures,      ///< Sampled textures and cube maps, with their mip chains.
+		RenderTargets, ///< Framebuffer attachments: render targets, the G-buffer, shadow maps and the Hi-Z pyramid.
+		Count
+	};
+
+	/** The OpenGL object namespace an allocation belongs to, names are only unique within one. */
+	enum class GPUObjectType : uint8_t
+	{
+		Buffer,
+		Texture,
+		Renderbuffer
+	};
+
+	/** One live OpenGL allocation. */
+	struct GPUAllocation
+	{
+		GPUObjectType Type = GPUObjectType::Buffer;               ///< Object namespace of Name.
+		GLuint Name = 0;                                          ///< OpenGL name of the object.
+		GPUMemoryCategory Category = GPUMemoryCategory::Geometry; ///< What it is used for.
+		uint64_t Bytes = 0;                                       ///< Size of its storage.
+		std::string Owner;                                        ///< Class or asset that created it.
+	};
+
+	/** Video memory as reported by the driver, through GL_NVX_gpu_memory_info or GL_ATI_meminfo. */
+	struct GPUDriverMemory
+	{
+		const char* Extension = nullptr; ///< Extension the figures come from, nullptr if the driver exposes neither.
+		uint64_t Dedicated = 0;          ///< Dedicated video memory, zero with GL_ATI_meminfo which doesn't report it.
+		uint64_t Free = 0;               ///< Free video memory; the free texture pool with GL_ATI_meminfo.
+		uint64_t Evicted = 0;            ///< Memory evicted to system memory since the context was created, GL_NVX_gpu_memory_info only.
+	};
+
+	/**
+	 * Byte sizes of every buffer, texture and renderbuffer storage FireGL allocates, by category and owner.
+	 *
+	 * Each call site reports the size it requested with Track() when it (re)allocates storage and calls Untrack()
+	 * when it deletes the object. Texture sizes are computed from their format and mip chain, RGB8 counted at four
+	 * bytes a texel like drivers store it; the driver may still pad or compress. Tracking a name again replaces its
+	 * size, so a reallocation is a single call. Like GLStateCache, the tracker assumes a single OpenGL context.
+	 *
+	 * The driver's own figures are process-agnostic, so LogReport() compares the tracked total against how much free
+	 * video memory dropped since the first allocation was tracked.
+	 */
+	class GPUMemoryTracker
+	{
+	public:
+		/**
+		 * Records the storage of an object, replacing what was recorded for it.
+		 *
+		 * @param Type The object namespace of Name.
+		 * @param Name The OpenGL name of the object.
+		 * @param Bytes The size of its storage.
+		 * @param Category What the object is used for.
+		 * @param Owner The class or asset that created it, copied.
+		 */
+		static void Track(GPUObjectType Type, GLuint Name, uint64_t Bytes, GPUMemoryCategory Category, std::string_view Owner);
+
+		/** Forgets a deleted object. Unknown names are ignored. */
+		static void Untrack(GPUObjectType Type, GLuint Name);
+
+		/** Track() for a buffer. */
+		static void TrackBuffer(GLuint Buffer, uint64_t Bytes, GPUMemoryCategory Category, std::string_view Owner)
+		{
+			Track(GPUObjectType::Buffer, Buffer, Bytes, Category, Owner);
+		}
+
+		/** Untrack() for a buffer. */
+		static void UntrackBuffer(GLuint Buffer) { Untrack(GPUObjectType::Buffer, Buffer); }
+
+		/** Track() for a texture. */
+		static void TrackTexture(GLuint Texture, uint64_t Bytes, GPUMemoryCategory Category, std::string_view Owner)
+		{
+			Track(GPUObjectType::Texture, Texture, Bytes, Category, Owner);
+		}
+
+		/** Untrack() for a texture. */
+		static void UntrackTexture(GLuint Texture) { Untrack(GPUObjectType::Texture, Texture); }
+
+		/** @return The bytes allocated over every category. */
+		static uint64_t GetTotal() { return s_Total; }
+
+		/** @return The bytes allocated in one category. */
+		static uint64_t GetTotal(GPUMemoryCategory Category) { return s_CategoryTotals[static_cast<size_t>(Category)]; }
+
+		/** @return The number of live allocations. */
+		static size_t GetAllocationCount() { return s_Allocations.size(); }
+
+		/** @return The Count largest allocations, largest first. */
+		static std::vector<GPUAllocation> GetLargest(size_t Count);
+
+		/** @return The Count owners holding the most memory with their totals, largest first. */
+		static std::vector<std::pair<std::string, uint64_t>> GetLargestOwners(size_t Count);
+
+		/** @return What the driver reports, queried now. A context must be current. */
+		static GPUDriverMemory QueryDriver();
+
+		/** Logs the totals per category, the TopCount largest owners and the driver's figures next to them. */
+		static void LogReport(size_t TopCount = 10);
+
+		/** @return The name of a category, as shown by LogReport(). */
+		static const char* GetCategoryName(GPUMemoryCategory Category);
+
+		/**
+		 * Computes the storage of a texture from its format.
+		 *
+		 * @param InternalFormat A sized, unsized or compressed internal format.
+		 * @param Width Width of the base level.
+		 * @param Height Height of the base level.
+		 * @param Layers Array layers, or faces of a cube map.
+		 * @param LevelCount Mip levels, from the base level down.
+		 * @return The size in bytes.
+		 */
+		static uint64_t GetTextureSize(GLenum InternalFormat, int Width, int Height, int Layers = 1, int LevelCount = 1);
+
+		/** @return The levels of a full mip chain down to 1x1, as glGenerateMipmap creates it. */
+		static int GetMipLevelCount(int Width, int Height);
+
+	private:
+		static std::unordered_map<uint64_t, GPUAllocation> s_Allocations;                             ///< Live allocations by type and name.
+		static std::array<uint64_t, static_cast<size_t>(GPUMemoryCategory::Count)> s_CategoryTotals; ///< Bytes per category.
+		static uint64_t s_Total;                                                                      ///< Bytes over every category.
+		static std::optional<GPUDriverMemory> s_DriverBaseline;                                       ///< Driver figures at the first Track().
+	};
+
+} // namespace fgl
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+
+#include <External/glad/glad.h>
+
+#if defined(FIREGL_ENABLE_TRACY)
+#include <tracy/TracyOpenGL.hpp>
+#endif
+
+namespace fgl
+{
+
+	/** GPU time of one render pass, accumulated over the frames read back since the last reset. */
+	struct GPUPassStats
+	{
+		std::string Name;          ///< Name the pass was begun with.
+		float Last = 0.0f;         ///< Time of the last frame read back, in milliseconds.
+		float Average = 0.0f;      ///< Mean time over Samples frames, in milliseconds.
+		float Min = 0.0f;          ///< Shortest time, in milliseconds.
+		float Max = 0.0f;          ///< Longest time, in milliseconds.
+		uint64_t Samples = 0;      ///< Number of frames measured.
+		double Total = 0.0;        ///< Sum of the measured times, in milliseconds.
+	};
+
+	/**
+	 * GPU timing of render passes with timestamp queries.
+	 *
+	 * BeginPass() and EndPass() put a glQueryCounter(GL_TIMESTAMP) around the commands of a pass; the pass time
+	 * is the difference of both once the GPU executed them. Passes may nest and a name may be begun several times
+	 * a frame, its times are then summed. Every frame records into its own slot of a ring of FrameLatency frames,
+	 * read back when its last query is available, typically two or three frames later. A frame whose slot is
+	 * still in flight isn't measured, so the profiler never waits on the GPU.
+	 *
+	 * All calls are no-ops while the profiler is disabled, the renderer calls them unconditionally. With the
+	 * FIREGL_ENABLE_TRACY CMake option every pass is also a Tracy GPU zone, enabled or not.
+	 */
+	class GPUProfiler
+	{
+	public:
+		static constexpr size_t FrameLatency = 4; ///< Frames that can be in flight before a frame goes unmeasured.
+
+		/** Deletes the queries. */
+		void Destroy();
+
+		/**
+		 * @param bEnabled True to time the passes of the next frames. Disabling drops the frames in flight.
+		 */
+		void SetEnabled(bool bEnabled);
+
+		/** @return True if the passes are timed. */
+		bool IsEnabled() const;
+
+		/** Starts a frame. Requires a current OpenGL context. */
+		void BeginFrame();
+
+		/**
+		 * Starts timing a pass.
+		 *
+		 * @param Name The name of the pass, its stats are found under it. Must outlive the frame, a literal usually.
+		 */
+		void BeginPass(const char* Name);
+
+		/** Stops timing the innermost pass begun. */
+		void EndPass();
+
+		/** Ends the frame and reads back the frames whose queries arrived. */
+		void EndFrame();
+
+		/** @return The stats of every pass timed so far, in the order the passes were first seen. */
+		const std::vector<GPUPassStats>& GetPassStats() const;
+
+		/**
+		 * @param Name The name of a pass.
+		 * @return Its stats, nullptr if it was never read back.
+		 */
+		const GPUPassStats* FindPass(std::string_view Name) const;
+
+		/**
+		 * @return The GPU time of the last frame read back, from the first timestamp of its first pass to the
+		 * last of its last pass, in milliseconds; idle gaps between the passes included.
+		 */
+		float GetLastFrameTime() const;
+
+		/** @return The number of frames read back so far, a new GetLastFrameTime() whenever it changes. */
+		uint64_t GetFramesRead() const;
+
+		/** Clears the accumulated stats, keeping the passes. */
+		void ResetStats();
+
+	private:
+		/** One pass of a recorded frame. */
+		struct PassRecord
+		{
+			uint32_t Pass;  ///< Index of the pass in m_Stats.
+			uint32_t Begin; ///< Query of the begin timestamp in the frame's pool.
+			uint32_t End;   ///< Query of the end timestamp in the frame's pool.
+		};
+
+		/** Queries and passes of one frame of the ring. */
+		struct FrameRecord
+		{
+			std::vector<GLuint> Queries;     ///< Timestamp queries, grown on demand and reused.
+			uint32_t UsedQueries = 0;        ///< Queries issued this frame.
+			std::vector<PassRecord> Passes;  ///< Passes recorded this frame.
+			bool bPending = false;           ///< Whether the frame waits for its results.
+		};
+
+		/** @return The index of the pass in m_Stats, added if new. */
+		uint32_t FindOrAddPass(const char* Name);
+
+		/** Issues a timestamp query in the current frame. @return Its index in the frame's pool. */
+		uint32_t IssueTimestamp();
+
+		/** Reads the results of a pending frame if its last query is available. @return False if it wasn't. */
+		bool TryReadFrame(FrameRecord& Frame);
+
+		std::array<FrameRecord, FrameLatency> m_Frames; ///< Ring of recorded frames.
+		size_t m_Current = 0;                ///< Ring slot of the current frame.
+		size_t m_Oldest = 0;                 ///< Ring slot of the oldest pending frame.
+		bool m_bEnabled = false;             ///< Whether passes are timed.
+		bool m_bRecording = false;           ///< Whether the current frame is recorded.
+		std::vector<uint32_t> m_OpenPasses;  ///< Records of the passes begun and not yet ended, innermost last.
+		std::vector<GPUPassStats> m_Stats;   ///< Stats of every pass.
+		std::vector<double> m_FrameTimes;    ///< Per-pass sums of the frame being read back, reused.
+		float m_LastFrameTime = 0.0f;        ///< Span of the passes of the last frame read back, in milliseconds.
+		uint64_t m_FramesRead = 0;           ///< Frames read back since the profiler was created.
+#if defined(FIREGL_ENABLE_TRACY)
+		std::vector<std::unique_ptr<tracy::GpuCtxScope>> m_TracyZones; ///< Tracy GPU zones of the open passes, innermost last.
+#endif
+	};
+
+} // namespace fgl
@@ -0,0 +1,342 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+#include <FireGL/Renderer/Vertex.h>
+#include <FireGL/Renderer/RenderDevice.h>
+
+#include <External/glad/glad.h>
+
+#include <mutex>
+
+namespace fgl
+{
+
+	/**
+	 * Vertex layouts stored by the GeometryArena, each with its own vertex buffer and VAO.
+	 */
+	enum class VertexFormat : uint8_t
+	{
+		Standard,   ///< fgl::Vertex: float position, normal and texture coordinates (32 bytes)
+		Packed,     ///< fgl::PackedVertex: half-float position and UVs, 10:10:10:2 normal (16 bytes)
+		Skinned,    ///< fgl::SkinnedVertex: fgl::Vertex plus four bone indices and weights (44 bytes)
+		Lightmapped ///< fgl::LightmappedVertex: fgl::Vertex plus the coordinates of a second UV set (40 bytes)
+	};
+
+	static constexpr size_t VertexFormatCount = 4; ///< Number of VertexFormat values.
+
+	/**
+	 * Location of a mesh inside the GeometryArena.
+	 */
+	struct GeometryAllocation
+	{
+		VertexFormat Format = VertexFormat::Standard; ///< Vertex layout, selects the vertex buffer and VAO.
+		GLuint VertexArray = 0;                       ///< VAO the mesh is drawn with.
+		uint32_t BaseVertex = 0;                      ///< Index of the mesh's first vertex in the format's vertex buffer.
+		uint32_t FirstIndex = 0;                      ///< Offset of the mesh's first index in the shared index buffer, in IndexType units.
+		uint32_t IndexCount = 0;                      ///< Number of indices of the mesh.
+		GLenum IndexType = GL_UNSIGNED_INT;           ///< GL_UNSIGNED_SHORT for meshes of at most 65,535 vertices, else GL_UNSIGNED_INT.
+	};
+
+	/** Handles of the leases given up, filled from any thread and drained by the arena on the render thread. */
+	struct GeometryReleaseQueue
+	{
+		std::mutex Mutex;              ///< Guards Handles.
+		std::vector<uint32_t> Handles; ///< Allocations whose last lease was destroyed.
+	};
+
+	/**
+	 * Shared ownership of an allocation of the GeometryArena, held by every mesh drawing it.
+	 *
+	 * When the last mesh lets go, the lease queues its handle and the arena frees the ranges at its next
+	 * Allocate() or Compact(), so meshes may be destroyed on any thread, and after the arena.
+	 */
+	class GeometryLease
+	{
+	public:
+		~GeometryLease();
+
+		GeometryLease(const GeometryLease&) = delete;
+		GeometryLease& operator=(const GeometryLease&) = delete;
+
+		/** @return The index of the allocation in the arena, see GeometryArena::GetAllocation(). */
+		uint32_t GetHandle() const { return m_Handle; }
+
+	private:
+		friend class GeometryArena;
+
+		GeometryLease(std::weak_ptr<GeometryReleaseQueue> Releases, uint32_t Handle)
+			: m_Releases(std::move(Releases)), m_Handle(Handle)
+		{
+		}
+
+		std::weak_ptr<GeometryReleaseQueue> m_Releases; ///< Queue of the arena, expired once the arena is destroyed.
+		uint32_t m_Handle = 0;                          ///< Index of the allocation in the arena.
+	};
+
+	/** Occupancy of a GeometryArena, over every vertex buffer and the index buffer. */
+	struct GeometryArenaStats
+	{
+		size_t AllocationCount = 0; ///< Live allocations.
+		size_t UsedBytes = 0;       ///< Bytes of the live allocations.
+		size_t FreeBytes = 0;       ///< Bytes of the holes left by freed allocations, below the end of each buffer.
+		size_t CapacityBytes = 0;   ///< Bytes of the buffers.
+		size_t MovedBytes = 0;      ///< Bytes moved by the last Compact().
+	};
+
+	/**
+	 * Shared storage for the geometry of every mesh.
+	 *
+	 * Instead of one VAO, VBO and EBO per mesh, the arena keeps one large vertex buffer and one VAO
+	 * per VertexFormat, plus a single index buffer referenced by every VAO. Meshes are sub-allocated
+	 * linearly and only keep their offsets (base vertex, first index), so consecutive draws of meshes
+	 * sharing a format don't switch VAO and can be merged into one multi-draw indirect call.
+	 *
+	 * Indices are stored relative to the mesh's base vertex, as 16-bit values whenever the mesh has
+	 * at most 65,535 vertices and 32-bit otherwise. Both widths share the index buffer, each mesh's
+	 * indices being aligned to 4 bytes.
+	 *
+	 * When a buffer is full it is replaced by one twice as large and the previous contents are copied
+	 * on the GPU; the VAOs are updated accordingly, allocations stay valid.
+	 *
+	 * Allocations are shared through a GeometryLease and freed with their last lease. Freed ranges go to
+	 * per-buffer free lists, coalesced with their neighbours, which later allocations reuse first-fit. So that
+	 * streaming and removals don't fragment the buffers for good, Compact() moves a budget of live allocations
+	 * per frame from the end of a buffer into the lowest holes that fit, with glCopyBufferSubData, and halves
+	 * a buffer once it is three quarters empty. Allocations are addressed by handle: meshes read their offsets
+	 * through GetAllocation(), so a move takes effect for every mesh at once, between two frames.
+	 *
+	 * The instanced attributes (locations 3 to 12 and 15) live in the VAOs too, so they are configured here,
+	 * once per VAO, rather than once per mesh. Buffers, VAOs and attributes are all set up through the RenderDevice.
+	 *
+	 * On OpenGL 4.3+ with ARB_shader_draw_parameters, the arena also supports vertex pulling: BindPulledBuffers()
+	 * binds every vertex buffer and the instance buffer as shader storage, and GetPullingVertexArray() returns a
+	 * VAO without any attribute, holding only the index buffer. Draws made with it encode their vertex format plus 1
+	 * in the top bits of their base vertex (see EncodePulledBaseVertex()), so gl_VertexID tells the vertex shader
+	 * which buffer and layout to read, and gl_BaseInstanceARB + gl_InstanceID which instance: one pipeline draws
+	 * every format, and consecutive draws of different formats merge into one multi-draw. Draws through the
+	 * format VAOs keep 0 in those bits, so a pulling shader falls back to its attributes for them.
+	 */
+	class GeometryArena
+	{
+	public:
+		static constexpr size_t InitialVertexCapacity = 1 << 16; ///< Vertices allocated when a vertex buffer is first used.
+		static constexpr size_t InitialIndexCapacity = 1 << 20;  ///< Bytes allocated when the index buffer is first used.
+		static constexpr GLuint PulledVertexBindingPoint = 15;   ///< Shader storage binding point of the Standard vertices when pulling, the other formats follow in VertexFormat order.
+		static constexpr GLuint PulledInstanceBindingPoint = 19; ///< Shader storage binding point of the instance buffer when pulling.
+		static constexpr uint32_t PulledFormatShift = 28;        ///< First bit of the base vertex holding the vertex format plus 1 of a pulled draw.
+
+		GeometryArena() = default;
+		~GeometryArena();
+
+		GeometryArena(const GeometryArena&) = delete;
+		GeometryArena& operator=(const GeometryArena&) = delete;
+
+		/** Deletes every buffer and VAO. Allocations handed out become invalid. */
+		void Destroy();
+
+		/**
+		 * Uploads a mesh into the arena, into the first hole that fits or at the end of the buffers. Requires a
+		 * current OpenGL context.
+		 * With VertexFormat::Packed the vertices are converted to PackedVertex before the upload, with
+		 * VertexFormat::Skinned they are interleaved with their skin into SkinnedVertex, with VertexFormat::Lightmapped
+		 * with their lightmap coordinates into LightmappedVertex.
+		 *
+		 * @param Vertices The vertices of the mesh.
+		 * @param Indices The indices of the mesh, relative to its first vertex.
+		 * @param Format The layout the vertices are stored with.
+		 * @param ContentHash Hash of the vertices and indices (see BaseMesh::GetContentHash()), 0 if unknown.
+		 *        Meshes of equal hash and format share one immutable allocation, uploaded once.
+		 * @param Skin The bones of each vertex, only read with VertexFormat::Skinned; vertices past its end aren't skinned.
+		 * @param LightmapCoords The second UV set of each vertex, only read with VertexFormat::Lightmapped; vertices past its end get (0, 0).
+		 * @return The lease of the allocation, shared with the meshes of equal hash; GetAllocation() tells where it is.
+		 */
+		std::shared_ptr<GeometryLease> Allocate(const std::vector<Vertex>& Vertices, const std::vector<unsigned int>& Indices,
+			VertexFormat Format = VertexFormat::Standard, uint64_t ContentHash = 0, const std::vector<VertexSkin>& Skin = {},
+			const std::vector<glm::vec2>& LightmapCoords = {});
+
+		/**
+		 * @param Handle The handle of a lease of this arena.
+		 * @return Where the allocation currently is; empty if the handle is unknown.
+		 */
+		const GeometryAllocation& GetAllocation(uint32_t Handle) const
+		{
+			return Handle < m_Records.size() ? m_Records[Handle].Allocation : s_EmptyAllocation;
+		}
+
+		/**
+		 * Frees the allocations released since the last call, then moves up to BudgetBytes of live allocations into
+		 * the holes below them and shrinks the buffers left mostly empty. Called by the renderer at the start of
+		 * every frame, before any draw reads an allocation. Requires a current OpenGL context.
+		 *
+		 * @param BudgetBytes Bytes copied at most, a single allocation larger than the budget is still moved; 0 only frees.
+		 * @return True if an allocation moved: draw commands built from GetAllocation() before the call are stale.
+		 */
+		bool Compact(size_t BudgetBytes);
+
+		/** @return The occupancy of the buffers. */
+		GeometryArenaStats GetStats() const;
+
+		/**
+		 * Sets the buffer of InstanceData records the instanced attributes read, see ConfigureInstanceAttributes().
+		 * The VAOs keep reading the previous buffer until they are configured again.
+		 */
+		void SetInstanceBuffer(const BufferHandle& Buffer);
+
+		/**
+		 * Configures the instanced attributes of a format's VAO (Model matrix at locations 3 to 6, normal
+		 * matrix at 7 to 9, texture layers at 10, material index at 11, bone offset at 12, payload at 15) against the
+		 * instance buffer given to SetInstanceBuffer(), at instance 0.
+		 * Does nothing if no mesh of the format was allocated yet, or without an instance buffer.
+		 *
+		 * @param Format The vertex format whose VAO is configured.
+		 */
+		void ConfigureInstanceAttributes(VertexFormat Format);
+
+		/**
+		 * Points the instanced attributes of a format's VAO at the given instance, for contexts without
+		 * base instance draws (OpenGL 4.1). Does nothing if they already point there, or without an
+		 * instance buffer.
+		 *
+		 * @param Format The vertex format whose VAO is updated.
+		 * @param BaseInstance Index of the first instance the attributes should read from.
+		 */
+		void BindInstanceBase(VertexFormat Format, size_t BaseInstance);
+
+		/**
+		 * @return True if the context can draw through GetPullingVertexArray(): OpenGL 4.3+, gl_BaseInstanceARB
+		 *         and at least five shader storage blocks in vertex shaders.
+		 */
+		static bool SupportsVertexPulling();
+
+		/**
+		 * @return The VAO of pulled draws, without attributes and reading the shared index buffer;
+		 *         0 if nothing was allocated yet.
+		 */
+		GLuint GetPullingVertexArray();
+
+		/**
+		 * Binds the vertex buffer of every format from PulledVertexBindingPoint on, and the instance buffer to
+		 * PulledInstanceBindingPoint. Buffers move when the arena grows, so this is called before every pulled pass.
+		 *
+		 * @param InstanceBuffer The buffer of InstanceData records the draws read, at their base instance.
+		 */
+		void BindPulledBuffers(GLuint InstanceBuffer) const;
+
+		/**
+		 * @param Format The vertex format of the mesh drawn.
+		 * @param BaseVertex The base vertex of the draw, in the format's vertex buffer.
+		 * @return The base vertex of the same draw made through GetPullingVertexArray().
+		 */
+		static int32_t EncodePulledBaseVertex(VertexFormat Format, int32_t BaseVertex)
+		{
+			return BaseVertex | static_cast<int32_t>((static_cast<uint32_t>(Format) + 1) << PulledFormatShift);
+		}
+
+	private:
+		/** An allocation's range in one buffer. */
+		struct LiveRange
+		{
+			uint32_t Handle = 0; ///< Allocation the range belongs to.
+			size_t Length = 0;   ///< Length of the range.
+		};
+
+		/** Placement of the allocations in one buffer, in vertices or in bytes. */
+		struct RangeList
+		{
+			std::map<size_t, size_t> Free;    ///< Length of every hole by offset, never adjacent to another hole nor to the end.
+			std::map<size_t, LiveRange> Live; ///< Every non-empty range allocated, by offset.
+		};
+
+		/** Vertex buffer and VAO of one vertex format. */
+		struct VertexPool
+		{
+			VertexArrayHandle VertexArray; ///< VAO reading VertexBuffer and the shared index buffer.
+			BufferHandle VertexBuffer;     ///< Vertices of every mesh using this format.
+			size_t Capacity = 0;           ///< Number of vertices VertexBuffer can hold.
+			size_t Count = 0;              ///< End of the last allocation, in vertices.
+			size_t BoundBaseInstance = 0;  ///< Instance the instanced attributes currently point at.
+			RangeList Ranges;              ///< Holes and allocations of VertexBuffer.
+		};
+
+		/** An allocation and what the arena needs to free or move it. */
+		struct AllocationRecord
+		{
+			GeometryAllocation Allocation; ///< Location handed to the meshes.
+			size_t VertexCount = 0;        ///< Vertices of the allocation.
+			size_t IndexBytes = 0;         ///< Bytes of its indices, a multiple of 4.
+			uint64_t ContentHash = 0;      ///< Key in m_SharedAllocations, 0 if not shared.
+			bool bLive = false;            ///< False once freed, until the handle is reused.
+		};
+
+		/** A deduplicated allocation, alive while a mesh holds its lease. */
+		struct SharedAllocation
+		{
+			uint32_t Handle = 0;                 ///< Handle of the allocation.
+			std::weak_ptr<GeometryLease> Lease;  ///< Lease handed to the meshes.
+		};
+
+		/** Frees the allocations of the leases destroyed since the last call. */
+		void ProcessReleases();
+
+		/** Returns the ranges of an allocation to the free lists. */
+		void Free(uint32_t Handle);
+
+		/**
+		 * Takes Length units from the lowest hole that fits.
+		 * @return True if a hole was found, its offset in Offset.
+		 */
+		static bool TakeFreeRange(RangeList& Ranges, size_t Length, size_t& Offset);
+
+		/** Returns a range to the holes, merged with its neighbours; a range ending at End lowers End instead. */
+		static void FreeRange(RangeList& Ranges, size_t Offset, size_t Length, size_t& End);
+
+		/**
+		 * Moves the last allocations of a buffer into the lowest holes they fit, until BudgetBytes are copied.
+		 * @param OnMoved Called with the handle and new offset of every allocation moved.
+		 * @return The bytes copied.
+		 */
+		size_t CompactRanges(const BufferHandle& Buffer, size_t UnitSize, RangeList& Ranges, size_t& End, size_t BudgetBytes,
+			const std::function<void(uint32_t, size_t)>& OnMoved);
+
+		/** Points the element buffer binding of every VAO at m_IndexBuffer. */
+		void BindIndexBuffer();
+
+		/** Makes sure a pool can take AdditionalVertices more vertices, creating or growing it. */
+		void ReserveVertices(VertexPool& Pool, VertexFormat Format, size_t AdditionalVertices);
+
+		/** Makes sure the index buffer can take AdditionalBytes more bytes, growing it if needed. */
+		void ReserveIndices(size_t AdditionalBytes);
+
+		/** Points the per-vertex attributes (locations 0 to 2, 13 and 14 when skinned, 13 when lightmapped) of a pool's VAO at its vertex buffer. */
+		void ConfigureVertexAttributes(VertexPool& Pool, VertexFormat Format);
+
+		/** @return The size in bytes of one vertex of the given format. */
+		static size_t GetVertexSize(VertexFormat Format);
+
+		/** Converts full-precision vertices to the packed layout. */
+		static std::vector<PackedVertex> PackVertices(const std::vector<Vertex>& Vertices);
+
+		/** Interleaves vertices with their skin, vertices without one get no weight. */
+		static std::vector<SkinnedVertex> SkinVertices(const std::vector<Vertex>& Vertices, const std::vector<VertexSkin>& Skin);
+
+		/** Interleaves vertices with their lightmap coordinates, vertices without any get (0, 0). */
+		static std::vector<LightmappedVertex> LightmapVertices(const std::vector<Vertex>& Vertices, const std::vector<glm::vec2>& LightmapCoords);
+
+	private:
+		std::array<VertexPool, VertexFormatCount> m_Pools; ///< Vertex storage of each format.
+		BufferHandle m_IndexBuffer;                        ///< Indices of every mesh, shared by all VAOs.
+		BufferHandle m_InstanceBuffer;                     ///< InstanceData records read by the instanced attributes.
+		VertexArrayHandle m_PullingVertexArray;            ///< VAO of pulled draws, holding only the index buffer.
+		size_t m_IndexCapacity = 0;                        ///< Number of bytes m_IndexBuffer can hold.
+		size_t m_IndexSize = 0;                            ///< End of the last allocation's indices, always a multiple of 4.
+		RangeList m_IndexRanges;                           ///< Holes and allocations of m_IndexBuffer, in bytes.
+		std::vector<AllocationRecord> m_Records;           ///< Every allocation by handle, freed ones included.
+		std::vector<uint32_t> m_FreeHandles;               ///< Handles of the freed records, reused first.
+		std::shared_ptr<GeometryReleaseQueue> m_Releases = std::make_shared<GeometryReleaseQueue>(); ///< Handles given up by the leases.
+		size_t m_MovedBytes = 0;                           ///< Bytes moved by the last Compact().
+		std::array<std::unordered_map<uint64_t, SharedAllocation>, VertexFormatCount> m_SharedAllocations; ///< Allocations of each format by content hash.
+
+		static const GeometryAllocation s_EmptyAllocation; ///< Returned for unknown handles.
+	};
+
+} // namespace fgl
\ No newline at end of file
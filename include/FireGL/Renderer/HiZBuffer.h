@@ -0,0 +1,89 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+#include <FireGL/Renderer/Shader.h>
+
+#include <External/glm/mat4x4.hpp>
+#include <External/glm/vec2.hpp>
+#include <External/glad/glad.h>
+
+namespace fgl
+{
+
+	/**
+	 * Hierarchical depth buffer of the last rendered frame, for GPU occlusion culling (OpenGL 4.3+).
+	 *
+	 * Build() copies the depth of the bound framebuffer once a frame's opaque geometry is drawn, then reduces it
+	 * with compute shaders into a mip chain where every texel holds the farthest depth of the texels it covers.
+	 * The next frame tests the bounds of its objects against it with the view-projection the depth was rendered
+	 * with: the box of a bounding sphere is projected, the level where the box covers at most 2x2 texels is read,
+	 * and the object is hidden if its nearest depth is behind the farthest depth of those texels.
+	 * Objects moving out from behind an occluder can appear one frame late.
+	 */
+	class HiZBuffer
+	{
+	public:
+		static constexpr uint32_t TextureUnit = 31; ///< Texture unit the pyramid is sampled from by the culling pass.
+
+		/** @return True if the context supports compute shaders and image load / store (OpenGL 4.3). */
+		static bool IsSupported();
+
+		/** Compiles the reduction shaders. Requires a current OpenGL context. */
+		void Create();
+
+		/** Deletes the textures, framebuffer and shaders. */
+		void Destroy();
+
+		/** @return True once Create() was called. */
+		bool IsCreated() const;
+
+		/**
+		 * Copies the depth of the framebuffer bound for drawing, over the current viewport, and builds the pyramid.
+		 * The textures are reallocated when the viewport size or the depth format changes.
+		 *
+		 * @param ViewProjection The view-projection the depth was rendered with.
+		 */
+		void Build(const glm::mat4& ViewProjection);
+
+		/** Marks the pyramid as outdated, e.g. after a frame that didn't build it. */
+		void Invalidate();
+
+		/** @return True if the pyramid holds the depth of the previous frame. */
+		bool IsValid() const;
+
+		/** @return The R32F pyramid texture. */
+		GLuint GetTexture() const;
+
+		/** @return The size of level 0 in texels. */
+		glm::vec2 GetSize() const;
+
+		/** @return The index of the smallest level. */
+		uint32_t GetMaxLevel() const;
+
+		/** @return The view-projection the pyramid's depth was rendered with. */
+		const glm::mat4& GetViewProjection() const;
+
+		/** @return The sized internal format of the depth attachment of the framebuffer bound for reading, which depth blits from it require. */
+		static GLenum GetReadDepthFormat();
+
+	private:
+		/** Allocates the depth copy and the pyramid for a viewport size and a depth format. */
+		void Allocate(GLint Width, GLint Height, GLenum DepthFormat);
+
+		/** Deletes the textures and the framebuffer. */
+		void DestroyTextures();
+
+		GLuint m_DepthCopy = 0;             ///< Single-sampled copy of the depth, in the format of the source.
+		GLuint m_DepthFramebuffer = 0;      ///< Framebuffer of m_DepthCopy, blit target.
+		GLuint m_Pyramid = 0;               ///< R32F mip chain of the farthest depths.
+		GLint m_Width = 0;                  ///< Width of level 0.
+		GLint m_Height = 0;                 ///< Height of level 0.
+		GLenum m_DepthFormat = 0;           ///< Internal format of m_DepthCopy.
+		uint32_t m_LevelCount = 0;          ///< Number of levels of m_Pyramid.
+		bool m_bValid = false;              ///< Whether the pyramid holds the previous frame's depth.
+		glm::mat4 m_ViewProjection = glm::mat4(1.0f); ///< View-projection of the captured depth.
+		std::unique_ptr<Shader> m_CopyShader;   ///< Depth to level 0.
+		std::unique_ptr<Shader> m_ReduceShader; ///< Level to next level.
+	};
+
+} // namespace fgl
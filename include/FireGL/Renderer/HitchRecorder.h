@@ -0,0 +1,118 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+#include <FireGL/Renderer/RenderStats.h>
+
+namespace fgl
+{
+	class Renderer;
+
+	/**
+	 * Flight recorder of the last seconds of frames, dumped to disk when a frame takes too long.
+	 *
+	 * Every Record() keeps the frame's CPU time, the last GPU frame time read back, the renderer's RenderStats and
+	 * the CPU and GPU memory totals in a ring. When a frame exceeds the threshold, the frames of the window before
+	 * it are written as a Chrome trace: the Profiler zones of every thread over the window (compiled in with
+	 * FIREGL_ENABLE_PROFILER), one span per frame and counter tracks of the frame times, counters and memory,
+	 * plus a "Hitch" event carrying the GPU pass times and the memory of every MemoryTag. Open it in
+	 * chrome://tracing or Perfetto.
+	 *
+	 * Recording costs a few stores per frame; a dump writes the whole window on the calling thread, once per
+	 * window at most, so a burst of long frames produces one file. While enabled the renderer's GPU profiling is
+	 * on, disabling the recorder restores the previous state.
+	 *
+	 *     HitchRecorder Hitches(SceneRenderer);
+	 *     Hitches.SetOutputDirectory("Hitches");
+	 *     Hitches.SetEnabled(true);
+	 *     ...
+	 *     SceneRenderer.Render(&MainScene);
+	 *     Hitches.Record();
+	 */
+	class HitchRecorder
+	{
+	public:
+		static constexpr size_t Capacity = 4096; ///< Frames kept, a window longer than that many frames is cut short.
+
+		/** @param Target The renderer whose stats and GPU profiler are recorded, must outlive the recorder. */
+		explicit HitchRecorder(Renderer& Target);
+
+		HitchRecorder(const HitchRecorder&) = delete;
+		HitchRecorder& operator=(const HitchRecorder&) = delete;
+
+		/**
+		 * Starts or stops recording. Enabling turns the renderer's GPU profiling on and forgets the frames kept.
+		 *
+		 * @param bEnabled True to record, false (the default) to leave Record() a no-op.
+		 */
+		void SetEnabled(bool bEnabled);
+
+		/** @return True if frames are recorded. */
+		bool IsEnabled() const;
+
+		/** @param Milliseconds Frame time above which a frame is a hitch, 50 ms by default. */
+		void SetThreshold(double Milliseconds);
+
+		/** @param Seconds How far back a dump goes, 5 s by default; also the least time between two dumps. */
+		void SetWindow(double Seconds);
+
+		/** @param Directory Where the dumps are written, created on the first one; the working directory by default. */
+		void SetOutputDirectory(std::string_view Directory);
+
+		/** @param MaxDumps The most dumps written, 16 by default, so a bad session doesn't fill the disk. */
+		void SetMaxDumps(uint32_t MaxDumps);
+
+		/**
+		 * Records the frame that just ended, once per frame after Renderer::Render(), and dumps the window if the
+		 * frame was a hitch. The frame time is the time between two calls.
+		 */
+		void Record();
+
+		/**
+		 * Writes the frames of the window to a file now, e.g. on a key press.
+		 *
+		 * @param Path The JSON file to write.
+		 * @return False if the file couldn't be written.
+		 */
+		bool Dump(std::string_view Path);
+
+		/** @return The dumps written since the recorder was created. */
+		uint32_t GetDumpCount() const;
+
+		/** @return The file of the last dump, empty if none. */
+		const std::string& GetLastDumpPath() const;
+
+	private:
+		/** One recorded frame. */
+		struct FrameRecord
+		{
+			uint64_t Index = 0;        ///< Frame number since recording started.
+			uint64_t Start = 0;        ///< Profiler::Now() at the previous Record().
+			uint64_t End = 0;          ///< Profiler::Now() at this Record().
+			float GPUTime = 0.0f;      ///< Last GPU frame time read back, in milliseconds.
+			RenderStats Stats;         ///< Counters of the frame.
+			uint64_t HeapBytes = 0;    ///< MemoryTracker::GetTotal().
+			uint64_t VideoBytes = 0;   ///< GPUMemoryTracker::GetTotal().
+		};
+
+		/** Appends the frame spans, the counter tracks and the hitch details as trace events. */
+		void WriteEvents(std::string& Events, uint64_t Since, const FrameRecord* Hitch) const;
+
+		/** Writes the window to Path, with Hitch as the frame that triggered it if any. */
+		bool WriteDump(std::string_view Path, const FrameRecord* Hitch);
+
+		Renderer& m_Renderer;                       ///< Renderer whose stats are recorded.
+		bool m_bEnabled = false;                    ///< Whether Record() records anything.
+		bool m_bProfilingWasEnabled = false;        ///< GPU profiling state before the recorder was enabled.
+		double m_Threshold = 50.0;                  ///< Hitch threshold, in milliseconds.
+		uint64_t m_Window = 5'000'000'000;          ///< Length of a dump, in nanoseconds.
+		std::string m_OutputDirectory;              ///< Directory of the dumps, empty for the working directory.
+		uint32_t m_MaxDumps = 16;                   ///< Most dumps written.
+		std::vector<FrameRecord> m_Frames;          ///< Ring of the last Capacity frames.
+		uint64_t m_FrameCount = 0;                  ///< Frames recorded, the next frame's Index.
+		uint64_t m_LastRecord = 0;                  ///< Profiler::Now() of the last Record(), 0 before the first.
+		uint64_t m_LastDump = 0;                    ///< Profiler::Now() of the last dump, 0 before the first.
+		uint32_t m_DumpCount = 0;                   ///< Dumps written.
+		std::string m_LastDumpPath;                 ///< File of the last dump.
+	};
+
+} // namespace fgl
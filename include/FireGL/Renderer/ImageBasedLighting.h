@@ -0,0 +1,124 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+
+#include <External/glad/glad.h>
+#include <External/glm/glm.hpp>
+
+namespace fgl
+{
+	class Shader;
+	class Texture;
+
+	/** Resolution and quality of the image-based lighting precomputation, part of the cache key. */
+	struct ImageBasedLightingSettings
+	{
+		int PrefilteredSize = 128;        ///< Face size of the prefiltered specular cube map's base level.
+		int PrefilteredLevels = 6;        ///< Mip levels, from roughness 0 (base level) to 1 (last level).
+		int PrefilterSamples = 256;       ///< GGX samples per texel of the prefiltered levels.
+		int BRDFLUTSize = 256;            ///< Width and height of the BRDF lookup table.
+		int BRDFSamples = 512;            ///< Samples per texel of the BRDF lookup table.
+		std::string CacheDirectory = "IBLCache"; ///< Where the results are cached, empty to always recompute.
+	};
+
+	/**
+	 * Image-based lighting precomputed from an environment CubeMap, such as a skybox, for PBR shading.
+	 *
+	 * Three results are rendered on the GPU with fragment passes (OpenGL 4.1, no compute needed):
+	 * - The diffuse irradiance as 9 RGB spherical harmonics coefficients, already convolved with the cosine
+	 *   lobe: E(n) = sum of Coefficient[i] * Y[i](n), the diffuse term being Albedo * E(n) / pi.
+	 * - A prefiltered specular CubeMap whose mip levels hold the environment convolved with GGX lobes of
+	 *   increasing roughness (split-sum approximation), sampled at level Roughness * (LevelCount - 1).
+	 * - The BRDF lookup table of the split sum, RG = scale and bias of F0, indexed by (N.V, Roughness).
+	 *
+	 * The convolutions take hundreds of milliseconds, so the results are written to a cache file keyed by a
+	 * hash of the source files' contents and the settings. Later launches upload the cached results instead.
+	 * Everything runs on the thread owning the OpenGL context.
+	 */
+	class ImageBasedLighting
+	{
+	public:
+		static constexpr uint32_t Magic = 0x4C424746;            ///< "FGBL", identifies a FireGL IBL cache.
+		static constexpr uint32_t Version = 1;                   ///< Bumped whenever the layout or the convolutions change.
+		static constexpr const char* Extension = ".fglibl";      ///< Extension of the cache files.
+
+		ImageBasedLighting() = default;
+		~ImageBasedLighting();
+
+		ImageBasedLighting(const ImageBasedLighting&) = delete;
+		ImageBasedLighting& operator=(const ImageBasedLighting&) = delete;
+
+		/**
+		 * Loads the lighting of an environment from the cache, or precomputes and caches it.
+		 *
+		 * @param Environment The environment CubeMap. Mipmaps are generated on it if uncompressed, the
+		 *                    convolutions sample its coarser levels.
+		 * @param SourcePaths The files the environment was loaded from, hashed into the cache key.
+		 * @param Settings The resolution and quality of the results.
+		 * @return False if the environment isn't a CubeMap.
+		 */
+		bool Build(const Texture& Environment, const std::vector<std::string>& SourcePaths,
+			const ImageBasedLightingSettings& Settings = ImageBasedLightingSettings());
+
+		/** Deletes the textures. */
+		void Destroy();
+
+		/**
+		 * Binds the results and sets the uniforms IrradianceSH[9], PrefilteredMap, PrefilteredLevels and BRDFLUT.
+		 *
+		 * @param Target The active shader.
+		 * @param PrefilteredUnit Texture unit of the prefiltered CubeMap.
+		 * @param BRDFUnit Texture unit of the BRDF lookup table.
+		 */
+		void Apply(const Shader& Target, uint32_t PrefilteredUnit, uint32_t BRDFUnit) const;
+
+		/** @return The 9 irradiance coefficients, in the order of the real spherical harmonics bands 0 to 2. */
+		const std::array<glm::vec3, 9>& GetIrradianceSH() const;
+
+		/** @return The prefiltered specular CubeMap, 0 before Build(). */
+		GLuint GetPrefilteredMap() const;
+
+		/** @return The mip levels of the prefiltered CubeMap. */
+		int GetPrefilteredLevels() const;
+
+		/** @return The BRDF lookup table, 0 before Build(). */
+		GLuint GetBRDFLUT() const;
+
+		/** @return True if the last Build() read the cache instead of convolving. */
+		bool WasCached() const;
+
+	private:
+		struct Header
+		{
+			uint32_t Magic;
+			uint32_t Version;
+			uint64_t Key;
+			int32_t PrefilteredSize;
+			int32_t PrefilteredLevels;
+			int32_t BRDFLUTSize;
+			int32_t Reserved;
+		};
+
+		/** @return The cache key: a hash of the source contents and the settings. */
+		static uint64_t ComputeKey(const std::vector<std::string>& SourcePaths, const ImageBasedLightingSettings& Settings);
+
+		/** Creates the empty textures, sized by the settings. */
+		void CreateTextures(const ImageBasedLightingSettings& Settings);
+
+		/** Renders the three results from the environment. */
+		void Precompute(GLuint Environment, const ImageBasedLightingSettings& Settings);
+
+		/** Reads and uploads a cache file, @return False if missing or stale. */
+		bool LoadCache(const std::string& CachePath, uint64_t Key, const ImageBasedLightingSettings& Settings);
+
+		/** Reads the results back and writes them to a cache file. */
+		bool SaveCache(const std::string& CachePath, uint64_t Key, const ImageBasedLightingSettings& Settings) const;
+
+		std::array<glm::vec3, 9> m_IrradianceSH{}; ///< Cosine-convolved irradiance coefficients.
+		GLuint m_PrefilteredMap = 0;               ///< GL_RGB16F CubeMap, one roughness per level.
+		int m_PrefilteredLevels = 0;               ///< Mip levels of m_PrefilteredMap.
+		GLuint m_BRDFLUT = 0;                      ///< GL_RG16F split-sum lookup table.
+		bool m_bCached = false;                    ///< Set when Build() read the cache.
+	};
+
+} // namespace fgl
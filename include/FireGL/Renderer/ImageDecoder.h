@@ -0,0 +1,102 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+#include <FireGL/Renderer/Texture.h>
+
+#include <span>
+
+namespace fgl
+{
+
+	/** Image file formats with a selectable decoder, told apart by their signature. */
+	enum class ImageFileFormat : uint8_t
+	{
+		Unknown, ///< Any other format, only decoded by stb_image.
+		JPEG,    ///< JFIF / Exif JPEG, starting with FF D8 FF.
+		PNG,     ///< PNG, starting with 89 'P' 'N' 'G'.
+		Count
+	};
+
+	/**
+	 * Decodes the JPEG and PNG images of Texture::DecodeImage() with the fastest backend of each format.
+	 *
+	 * stb_image decodes every format and stays the fallback. Builds with FIREGL_ENABLE_TURBOJPEG decode JPEG
+	 * with libjpeg-turbo (SIMD IDCT and color conversion), builds with FIREGL_ENABLE_SPNG decode PNG with
+	 * libspng (SIMD filters); an image a backend rejects, such as a CMYK JPEG or a 16-bit grayscale PNG, is
+	 * decoded again by stb. SetDecoder() plugs in any other decoder, e.g. one linked by the application.
+	 *
+	 * Every decoder returns what stb_image returns with no requested channel count: 8 bits per channel, the
+	 * channels stored in the file (1 to 4, palettes expanded), the rows flipped on request.
+	 */
+	class ImageDecoder
+	{
+	public:
+		/**
+		 * Decodes a whole file in memory. Called on loader threads, concurrently.
+		 *
+		 * @param Data The encoded file.
+		 * @param FlipVertical True to store the bottom row first, as OpenGL expects.
+		 * @param Image Receives the size, the channel count and pixels allocated with AllocatePixels().
+		 * @return False if the image can't be decoded, to fall back to stb_image.
+		 */
+		using DecodeFunction = bool (*)(std::span<const unsigned char> Data, bool FlipVertical, ImageData& Image);
+
+		/**
+		 * Replaces the decoder of a format. Not synchronized with the decodes, call it before loading textures.
+		 *
+		 * @param Format JPEG or PNG.
+		 * @param Decoder The decoder, nullptr to decode the format with stb_image.
+		 * @param Name Name of the decoder in GetDecoderName(), a string literal.
+		 */
+		static void SetDecoder(ImageFileFormat Format, DecodeFunction Decoder, const char* Name);
+
+		/** @return The name of the decoder of a format, "stb_image" without a dedicated one. */
+		static const char* GetDecoderName(ImageFileFormat Format);
+
+		/** @return The format of an encoded file from its signature, Unknown if it isn't JPEG nor PNG. */
+		static ImageFileFormat DetectFormat(std::span<const unsigned char> Data);
+
+		/** @return The format of a file from its extension, for files not read yet. */
+		static ImageFileFormat DetectFormat(std::string_view Path);
+
+		/**
+		 * Decodes a file in memory with the decoder of its format, then with stb_image if it fails.
+		 *
+		 * @param Data The encoded file, e.g. an AssetArchive entry.
+		 * @param FlipVertical True to store the bottom row first.
+		 * @param Image Receives the decoded pixels.
+		 * @return False if no decoder could decode the file.
+		 */
+		static bool Decode(std::span<const unsigned char> Data, bool FlipVertical, ImageData& Image);
+
+		/**
+		 * Decodes a file from disk. Files without a dedicated decoder are read by stb_image directly, the
+		 * others are read into memory first.
+		 *
+		 * @param Path The image file.
+		 * @param FlipVertical True to store the bottom row first.
+		 * @param Image Receives the decoded pixels.
+		 * @return False if the file can't be read or decoded.
+		 */
+		static bool DecodeFile(std::string_view Path, bool FlipVertical, ImageData& Image);
+
+		/**
+		 * Allocates the pixels of a decoded image, counted under MemoryTag::Textures until released.
+		 *
+		 * @param Bytes The size of the pixels.
+		 * @return The pixels, freed with the last copy of the pointer.
+		 */
+		static std::shared_ptr<unsigned char> AllocatePixels(size_t Bytes);
+
+	private:
+		/** A decoder and its name. */
+		struct Backend
+		{
+			DecodeFunction Decode = nullptr;
+			const char* Name = nullptr;
+		};
+
+		static std::array<Backend, static_cast<size_t>(ImageFileFormat::Count)> s_Decoders; ///< Decoder of each format, none for stb_image.
+	};
+
+} // namespace fgl
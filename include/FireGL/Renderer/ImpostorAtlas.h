@@ -0,0 +1,126 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+#include <FireGL/Renderer/Shader.h>
+
+#include <External/glm/vec3.hpp>
+#include <External/glad/glad.h>
+
+namespace fgl
+{
+	class Renderer;
+	class Scene;
+
+	/** One far object drawn by an ImpostorAtlas, as the renderer writes it to the atlas' instance buffer. */
+	struct ImpostorInstance
+	{
+		glm::vec3 Center; ///< World-space center of the object's bounding sphere.
+		float Radius;     ///< Radius of the object's bounding sphere, half the width of the billboard.
+		uint32_t Frame;   ///< Atlas frame captured from the direction closest to the camera's, see SelectFrame().
+	};
+
+	/**
+	 * Pictures of a model captured from many directions, drawn in place of its far instances.
+	 *
+	 * Capture() renders the model Columns x Rows times through a Renderer into an offscreen RenderTarget, each
+	 * time from another direction around its bounding sphere, with an orthographic camera framing the sphere
+	 * exactly. Columns turn around the vertical axis, rows rise from the horizon to MaxElevation. Every picture
+	 * is copied into one tile of a mipmapped RGBA8 atlas, the background left transparent.
+	 *
+	 * Objects given the atlas with SceneObject::SetImpostor() are drawn as a camera-facing quad of their sphere's
+	 * size once the active camera is farther than GetDistance() from them. The renderer picks the frame whose
+	 * direction, in the object's space, is the closest to the camera's and collects every far instance of the
+	 * atlas, then Draw() draws them all with a single instanced call, alpha-tested and depth-written like
+	 * opaque geometry. The lighting is the one of the capture, baked into the pictures.
+	 */
+	class ImpostorAtlas
+	{
+	public:
+		static constexpr GLint AtlasUnit = 0;            ///< Texture unit of the atlas while drawn.
+		static constexpr float DefaultDistance = 100.0f; ///< Distance of the switch to impostors, in world units.
+
+		ImpostorAtlas() = default;
+
+		/** Deletes the atlas, the instance buffer and the shader. */
+		~ImpostorAtlas();
+
+		ImpostorAtlas(const ImpostorAtlas&) = delete;
+		ImpostorAtlas& operator=(const ImpostorAtlas&) = delete;
+
+		/**
+		 * Renders the pictures of a model into the atlas, replacing the previous ones. Requires a current
+		 * OpenGL context; meant for load time, as it draws a full frame per picture.
+		 *
+		 * The capture renderer draws into a RenderTarget set as its output target for the duration of the call,
+		 * with a transparent clear color. It should draw no sky, and have no upload budget so the model is
+		 * drawn from the first picture. The Scene's active camera is replaced during the call, then restored.
+		 *
+		 * @param CaptureRenderer The renderer drawing the pictures, e.g. one created for captures.
+		 * @param CaptureScene A Scene holding the model alone, untransformed, with the lights the pictures are lit by.
+		 * @param FrameSize The width and height of one picture in pixels.
+		 * @param Columns The number of directions around the vertical axis.
+		 * @param Rows The number of elevations, from the horizon to MaxElevation.
+		 * @param MaxElevation The elevation of the last row in degrees, below 90.
+		 */
+		void Capture(Renderer& CaptureRenderer, Scene& CaptureScene, int FrameSize = 256, int Columns = 8, int Rows = 3, float MaxElevation = 60.0f);
+
+		/** Deletes the atlas, the instance buffer and the shader, the pictures are lost. */
+		void Destroy();
+
+		/** @return True once Capture() was called. */
+		bool IsCaptured() const;
+
+		/**
+		 * Sets the distance from the active camera beyond which the objects of this atlas are drawn as impostors.
+		 *
+		 * @param Distance The distance to the center of the object's bounding sphere, in world units.
+		 */
+		void SetDistance(float Distance);
+
+		/** @return The distance beyond which the objects of this atlas are drawn as impostors. */
+		float GetDistance() const;
+
+		/**
+		 * Selects the picture to draw an object with.
+		 *
+		 * @param LocalDirection The direction from the object to the camera, in the object's space.
+		 * @return The frame captured from the closest direction.
+		 */
+		uint32_t SelectFrame(const glm::vec3& LocalDirection) const;
+
+		/**
+		 * Draws instances into the bound framebuffer with a single instanced call, depth tested and written.
+		 *
+		 * @param Instances The far objects of this atlas this frame.
+		 */
+		void Draw(const std::vector<ImpostorInstance>& Instances);
+
+		/** @return The atlas texture, 0 before Capture(). */
+		GLuint GetTexture() const;
+
+		/** @return The number of directions around the vertical axis. */
+		int GetColumns() const;
+
+		/** @return The number of elevations. */
+		int GetRows() const;
+
+	private:
+		/** Compiles the billboard shader and creates the instance buffer and its vertex array. */
+		void CreateDrawResources();
+
+		/** Grows the instance buffer to hold at least Count instances. */
+		void EnsureCapacity(size_t Count);
+
+		GLuint m_Atlas = 0;                      ///< Tiles of every picture, Columns across and Rows down.
+		int m_FrameSize = 0;                     ///< Width and height of one tile in pixels.
+		int m_Columns = 0;                       ///< Directions around the vertical axis.
+		int m_Rows = 0;                          ///< Elevations, from the horizon up.
+		float m_MaxElevation = 0.0f;             ///< Elevation of the last row in radians.
+		float m_Distance = DefaultDistance;      ///< Distance of the switch to impostors.
+		GLuint m_InstanceBuffer = 0;             ///< ImpostorInstance records of the last Draw().
+		size_t m_InstanceCapacity = 0;           ///< Records m_InstanceBuffer holds.
+		GLuint m_VertexArray = 0;                ///< Reads the records as per-instance attributes.
+		std::unique_ptr<Shader> m_Shader;        ///< Expands the records into camera-facing quads.
+	};
+
+} // namespace fgl
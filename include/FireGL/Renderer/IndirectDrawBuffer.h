@@ -0,0 +1,83 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+
+#include <External/glad/glad.h>
+
+namespace fgl
+{
+
+	/**
+	 * One indexed draw read by glMultiDrawElementsIndirect, laid out as OpenGL expects it.
+	 */
+	struct DrawElementsIndirectCommand
+	{
+		uint32_t Count;         ///< Number of indices drawn.
+		uint32_t InstanceCount; ///< Number of instances drawn.
+		uint32_t FirstIndex;    ///< Offset of the first index inside the bound element buffer, in units of the index type.
+		int32_t BaseVertex;     ///< Value added to every index before fetching vertices.
+		uint32_t BaseInstance;  ///< Index of the first instance read from the instanced attributes.
+	};
+
+	/**
+	 * Owns the GL_DRAW_INDIRECT_BUFFER the renderer submits its batches from on OpenGL 4.3+.
+	 *
+	 * Commands are recorded on the CPU with Push(), transferred once per frame by Upload(), and any
+	 * contiguous range of them can then be submitted with a single glMultiDrawElementsIndirect through
+	 * Draw(). Commands of one Draw() share the bound vertex array, program and index type.
+	 */
+	class IndirectDrawBuffer
+	{
+	public:
+		/**
+		 * Checks whether the context supports glMultiDrawElementsIndirect (OpenGL 4.3+).
+		 * The result is queried once, on the first call, after the loader has been initialized.
+		 * @return True if indirect submission is available.
+		 */
+		static bool IsSupported();
+
+		/** Creates the OpenGL buffer. Requires a current OpenGL context. */
+		void Create();
+
+		/** Deletes the OpenGL buffer. */
+		void Destroy();
+
+		/** Removes every recorded command, keeping the allocated storage. */
+		void Clear();
+
+		/**
+		 * Records a command at the end of the buffer.
+		 * @param Command The draw to record.
+		 */
+		void Push(const DrawElementsIndirectCommand& Command);
+
+		/**
+		 * Transfers the recorded commands to the GPU and leaves the buffer bound to GL_DRAW_INDIRECT_BUFFER.
+		 * The storage is orphaned every frame so the driver doesn't stall on the previous frame's draws.
+		 */
+		void Upload();
+
+		/** Binds the buffer to GL_DRAW_INDIRECT_BUFFER, for commands uploaded on an earlier frame. */
+		void Bind() const;
+
+		/**
+		 * Submits a range of uploaded commands with a single glMultiDrawElementsIndirect.
+		 * @param FirstCommand Index of the first command to draw.
+		 * @param CommandCount Number of consecutive commands to draw.
+		 * @param IndexType Index type shared by the drawn commands (GL_UNSIGNED_SHORT or GL_UNSIGNED_INT).
+		 */
+		void Draw(size_t FirstCommand, size_t CommandCount, GLenum IndexType) const;
+
+		/** @return The number of recorded commands. */
+		size_t GetCommandCount() const;
+
+		/** @return The OpenGL buffer ID, e.g. to let a compute shader write the uploaded commands. */
+		GLuint GetBufferID() const;
+
+	private:
+		GLuint m_BufferID = 0;                               ///< OpenGL GL_DRAW_INDIRECT_BUFFER ID.
+		size_t m_Capacity = 0;                               ///< Number of commands the GPU storage can hold.
+		std::vector<DrawElementsIndirectCommand> m_Commands; ///< Commands recorded this frame.
+	};
+
+} // namespace fgl
\ No newline at end of file
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+#include <FireGL/Renderer/RenderDevice.h>
+
+#include <External/glm/vec4.hpp>
+#include <External/glad/glad.h>
+
+namespace fgl
+{
+	class BaseCamera;
+
+	/** A directional light of the "LightData" block, std140 layout (w components unused). */
+	struct DirectionalLightData
+	{
+		glm::vec4 Direction = glm::vec4(-0.2f, -1.0f, -0.3f, 0.0f);
+		glm::vec4 Ambient = glm::vec4(0.01f, 0.01f, 0.01f, 0.0f);
+		glm::vec4 Diffuse = glm::vec4(0.1f, 0.1f, 0.1f, 0.0f);
+		glm::vec4 Specular = glm::vec4(0.5f, 0.5f, 0.5f, 0.0f);
+	};
+
+	/** A point light of the "LightData" block, std140 layout (w components unused). */
+	struct PointLightData
+	{
+		glm::vec4 Position = glm::vec4(0.0f);
+		glm::vec4 Ambient = glm::vec4(0.05f, 0.05f, 0.05f, 0.0f);
+		glm::vec4 Diffuse = glm::vec4(0.8f, 0.8f, 0.8f, 0.0f);
+		glm::vec4 Specular = glm::vec4(1.0f, 1.0f, 1.0f, 0.0f);
+		glm::vec4 Attenuation = glm::vec4(1.0f, 0.09f, 0.032f, 0.0f); ///< Constant, linear and quadratic terms.
+	};
+
+	/** A spot light of the "LightData" block, std140 layout (w components unused). */
+	struct SpotLightData
+	{
+		glm::vec4 Position = glm::vec4(0.0f);
+		glm::vec4 Direction = glm::vec4(0.0f, 0.0f, -1.0f, 0.0f);
+		glm::vec4 Ambient = glm::vec4(0.0f);
+		glm::vec4 Diffuse = glm::vec4(1.0f, 1.0f, 1.0f, 0.0f);
+		glm::vec4 Specular = glm::vec4(1.0f, 1.0f, 1.0f, 0.0f);
+		glm::vec4 Attenuation = glm::vec4(1.0f, 0.09f, 0.032f, 0.0f); ///< Constant, linear and quadratic terms.
+		glm::vec4 CutOff = glm::vec4(0.976296f, 0.965926f, 0.0f, 0.0f); ///< Cosines of the inner and outer cone angles (12.5 and 15 degrees).
+	};
+
+	/**
+	 * CPU-side mirror of the "LightData" uniform block, laid out to match std140.
+	 *
+	 *     struct DirLight   { vec4 Direction; vec4 Ambient; vec4 Diffuse; vec4 Specular; };
+	 *     struct PointLight { vec4 Position; vec4 Ambient; vec4 Diffuse; vec4 Specular; vec4 Attenuation; };
+	 *     struct SpotLight  { vec4 Position; vec4 Direction; vec4 Ambient; vec4 Diffuse; vec4 Specular;
+	 *                         vec4 Attenuation; vec4 CutOff; };
+	 *
+	 *     layout (std140) uniform LightData
+	 *     {
+	 *         DirLight DirectionalLight;
+	 *         PointLight PointLights[16];
+	 *         SpotLight Spot;
+	 *         ivec4 Counts;
+	 *     } Lights;
+	 */
+	struct LightData
+	{
+		/** Point lights of the block; every fragment loops over Counts.x of them unless ObjectLightAssigner picks its own. */
+		static constexpr int MaxPointLights = 16;
+
+		DirectionalLightData DirectionalLight;
+		PointLightData PointLights[MaxPointLights];
+		SpotLightData SpotLight;
+		glm::ivec4 Counts = glm::ivec4(4, 1, 0, 0); ///< Number of point lights used, and 1 if the spot light is on.
+	};
+
+	/**
+	 * Owns the uniform buffer holding the per-frame lights.
+	 *
+	 * Like the camera block, the buffer is bound once to a fixed binding point that every Shader assigns its
+	 * "LightData" block to, so lighting materials don't send any light uniform per draw. The buffer is only
+	 * uploaded in the frames the lights were edited, or moved with the camera.
+	 *
+	 * The edited lights are copied to the ones uploaded and read by the renderer by Capture(), so they can be
+	 * edited while a render thread draws the previous frame (see Renderer::PrepareFrame()).
+	 */
+	class LightUniformBuffer
+	{
+	public:
+		static constexpr GLuint BindingPoint = 1;             ///< Uniform buffer binding point of the light block.
+		static constexpr const char* BlockName = "LightData"; ///< Name of the uniform block in GLSL.
+
+		/** Creates the uniform buffer and binds it to BindingPoint. Requires a current OpenGL context. */
+		void Create();
+
+		/** Deletes the uniform buffer. */
+		void Destroy();
+
+		/**
+		 * Gives write access to the lights, which are uploaded on the first Update() after the next Capture().
+		 *
+		 * @return The light data to edit.
+		 */
+		LightData& Edit();
+
+		/** @return The edited lights. */
+		const LightData& GetData() const;
+
+		/** Copies the lights edited since the last call to the render copy. Called while no frame is drawn. */
+		void Capture();
+
+		/** @return The lights captured by the last Capture(), as uploaded by the next Update(). */
+		const LightData& GetRenderData() const;
+
+		/**
+		 * Makes the spot light follow the camera, like a flashlight. Enabled by default.
+		 *
+		 * @param bFollow Whether Update() moves the spot light to the camera position and direction.
+		 */
+		void SetSpotLightFollowsCamera(bool bFollow);
+
+		/** @return Whether Update() moves the spot light to the camera. */
+		bool GetSpotLightFollowsCamera() const;
+
+		/**
+		 * Uploads the captured lights if they changed since the last call.
+		 *
+		 * @param Camera The camera the frame is rendered from.
+		 */
+		void Update(BaseCamera& Camera);
+
+	private:
+		BufferHandle m_Buffer;                 ///< Uniform buffer, created through the RenderDevice.
+		LightData m_Data{};                    ///< Lights edited through Edit().
+		LightData m_RenderData{};              ///< Lights to upload, copied from m_Data by Capture().
+		bool m_bEdited = true;                 ///< Whether m_Data changed since the last Capture().
+		bool m_bDirty = true;                  ///< Whether m_RenderData changed since the last upload.
+		bool m_bSpotLightFollowsCamera = true; ///< Whether the spot light is attached to the camera.
+	};
+
+} // namespace fgl
\ No newline at end of file
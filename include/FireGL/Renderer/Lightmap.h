@@ -0,0 +1,120 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+
+#include <External/glm/vec3.hpp>
+#include <External/glm/vec4.hpp>
+#include <External/glad/glad.h>
+
+namespace fgl
+{
+	class SceneObject;
+	class JobSystem;
+	struct LightData;
+
+	/** Parameters of Lightmap::Bake(). */
+	struct LightmapBakeSettings
+	{
+		int Resolution = 1024;       ///< Width and height of the atlas in texels.
+		float TexelsPerUnit = 16.0f; ///< Texels per world unit along the surfaces, lowered until every object fits the atlas.
+		int Padding = 2;             ///< Texels around every region, filled from its edges so bilinear filtering never reads the neighbours.
+		bool bShadows = true;        ///< Traces a shadow ray from every texel to every light.
+		float ShadowBias = 0.01f;    ///< World distance the shadow rays start above the surface.
+	};
+
+	/**
+	 * Static lighting baked into one atlas texture, sampled by lightmapped meshes instead of the static lights.
+	 *
+	 * Bake() lights the objects loaded with VertexFormat::Lightmapped once, on the CPU:
+	 *  - every object gets a region of the atlas sized by the area of its surfaces, packed in shelves. The
+	 *    region is stored in the object's instance payload as the scale (xy) and offset (zw) of its lightmap
+	 *    coordinates, which the vertex shader applies; the second UV set of an object's meshes must not overlap;
+	 *  - every triangle is rasterized in the atlas, and each texel it covers evaluates the directional light and
+	 *    the point lights of a LightData like BaseLighting.frag does, ambient and diffuse terms, with a shadow
+	 *    ray through a bounding volume hierarchy of every triangle of the objects;
+	 *  - the empty texels around the regions are filled from their neighbours, Padding times.
+	 * The result is an RGB16F texture of the light reaching every texel, to multiply by the surface's albedo.
+	 * The spot light, a flashlight following the camera, and the specular terms stay dynamic. Baking reads the
+ * vertices of the meshes, which must still hold them in system memory (see BaseMesh::SetCPUGeometryPolicy()).
+	 *
+	 * Baking takes seconds for a level, so it is done offline: Save() the result, then Load() it at runtime with
+	 * the same objects in the same order. Renderer::SetLightmap() binds the atlas to TextureUnit as SamplerName,
+	 * where the LIGHTMAP variant of BaseLighting.frag reads it with one fetch instead of looping over the lights.
+	 */
+	class Lightmap
+	{
+	public:
+		static constexpr uint32_t TextureUnit = 27;                   ///< Texture unit the atlas is sampled from.
+		static constexpr const char* SamplerName = "LightmapAtlas";   ///< Name of the atlas sampler in GLSL.
+		static constexpr uint32_t Magic = 0x4D4C4746;                 ///< "FGLM", identifies a saved lightmap.
+		static constexpr uint32_t Version = 1;                        ///< Bumped whenever the file layout changes.
+
+		Lightmap() = default;
+
+		/** Deletes the texture. */
+		~Lightmap();
+
+		Lightmap(const Lightmap&) = delete;
+		Lightmap& operator=(const Lightmap&) = delete;
+
+		/**
+		 * Packs the lightmapped objects into the atlas, sets their instance payloads to their regions, bakes the
+		 * lights and uploads the atlas. Objects without lightmapped meshes only cast shadows. Requires a current
+		 * OpenGL context.
+		 *
+		 * @param Objects The static objects of the scene, their transforms final.
+		 * @param Lights The lights to bake.
+		 * @param Settings The size of the atlas and the options of the bake.
+		 * @param Jobs The job system the texels are lit on, nullptr to bake on the calling thread.
+		 * @return False if an object has no room in the atlas even at one texel per region.
+		 */
+		bool Bake(const std::vector<SceneObject*>& Objects, const LightData& Lights, const LightmapBakeSettings& Settings = LightmapBakeSettings(),
+			JobSystem* Jobs = nullptr);
+
+		/**
+		 * Writes the atlas and the regions of the last Bake().
+		 *
+		 * @param Path The file to write.
+		 * @return True if the file was written.
+		 */
+		bool Save(std::string_view Path) const;
+
+		/**
+		 * Reads an atlas written by Save(), uploads it and gives the objects their regions back. Requires a current OpenGL context.
+		 *
+		 * @param Path The file to read.
+		 * @param Objects The objects given to the Bake() that was saved, in the same order.
+		 * @return True if the file was read and matches the objects.
+		 */
+		bool Load(std::string_view Path, const std::vector<SceneObject*>& Objects);
+
+		/** Deletes the texture and the texels. */
+		void Destroy();
+
+		/** @return True once Bake() or Load() succeeded. */
+		bool IsBaked() const;
+
+		/** Binds the atlas to TextureUnit. */
+		void Bind() const;
+
+		/** @return The width and height of the atlas in texels. */
+		int GetResolution() const;
+
+		/** @return The region of every object of the last Bake(), as its payload: scale in xy, offset in zw; zero without lightmapped meshes. */
+		const std::vector<glm::vec4>& GetRegions() const;
+
+	private:
+		/** Creates or refills the texture with m_Texels. */
+		void Upload();
+
+		/** Fills the empty texels next to filled ones with their average, Padding times. */
+		void Dilate(int Iterations);
+
+		int m_Resolution = 0;                 ///< Width and height of the atlas.
+		std::vector<glm::vec3> m_Texels;      ///< Light of every texel, row by row.
+		std::vector<uint8_t> m_Coverage;      ///< Whether a triangle covers each texel, or dilation filled it.
+		std::vector<glm::vec4> m_Regions;     ///< Region of every baked object.
+		GLuint m_Texture = 0;                 ///< RGB16F atlas.
+	};
+
+} // namespace fgl
@@ -0,0 +1,279 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+#include <FireGL/Renderer/Shader.h>
+#include <FireGL/Renderer/CameraUniformBuffer.h>
+#include <FireGL/Renderer/LightUniformBuffer.h>
+#include <FireGL/Renderer/BoundingVolume.h>
+
+#include <External/glm/vec2.hpp>
+#include <External/glm/vec4.hpp>
+#include <External/glm/mat4x4.hpp>
+#include <External/glad/glad.h>
+
+namespace fgl
+{
+
+	/** The shadow of one light in the "LocalShadowData" block, std140 layout. */
+	struct LocalShadowSlot
+	{
+		glm::mat4 ViewProjection[6] = {}; ///< World to light clip space of each face: +X, -X, +Y, -Y, +Z, -Z for a point light, the cone of the spot light in the first.
+		glm::vec4 Tiles[6] = {};          ///< Atlas rectangle of each face in texture coordinates, offset in xy and size in zw.
+		glm::vec4 Params = glm::vec4(0.0f); ///< Face count (0 when unshadowed), depth bias, normal bias in texels, 2 * tan(half field of view) of the faces.
+	};
+
+	/**
+	 * CPU-side mirror of the "LocalShadowData" uniform block, laid out to match std140.
+	 *
+	 *     struct LocalShadow { mat4 ViewProjection[6]; vec4 Tiles[6]; vec4 Params; };
+	 *
+	 *     layout (std140) uniform LocalShadowData
+	 *     {
+	 *         LocalShadow PointShadows[16];  // one per point light of the LightData block
+	 *         LocalShadow SpotShadow;
+	 *         vec4 Params;                   // 1 / atlas size
+	 *     } LocalShadows;
+	 *     uniform sampler2DShadow LocalShadowMap;
+	 */
+	struct LocalShadowData
+	{
+		LocalShadowSlot PointLights[LightData::MaxPointLights]; ///< Shadows of the point lights, by index in LightData.
+		LocalShadowSlot SpotLight;                              ///< Shadow of the spot light.
+		glm::vec4 Params = glm::vec4(0.0f);                     ///< 1 / atlas size in x, yzw unused.
+	};
+
+	/**
+	 * Shadows of the point lights and the spot light of the LightData block, in tiles of one depth atlas.
+	 *
+	 * A point light renders six perspective faces of 90 degrees, a cube unfolded into six square tiles, and the
+	 * spot light one face around its cone. The faces of a light share one tile size, chosen every frame from the
+	 * light's screen importance: the projected diameter of the sphere it lights, scaled and rounded to a power of
+	 * two between the minimum and maximum tile sizes. Tiles are carved from the atlas by a quadtree (buddy)
+	 * allocator, so lights of any size pack without fragmenting it for good.
+	 *
+	 * A light keeps its tiles, and their depth, while its view and the hash of its casters (see Renderer) stay
+	 * the same: a static interior lit by dozens of lights redraws nothing. The lights that changed are redrawn
+	 * in order of importance, lights without tiles first and the others weighed by the frames they waited, until
+	 * the update budget is spent; the rest keep their previous depth, and the matrices it was drawn with, until a
+	 * later frame. A tile size only changes when a light is redrawn, growing once its importance asks for twice
+	 * the size and shrinking once it asks for a quarter, so the sizes don't flicker at the boundaries.
+	 *
+	 * Lit shaders declare the LocalShadowData block and the LocalShadowMap sampler, both bound by default. A
+	 * fragment picks the face of a point light from the major axis of its direction from the light, and filters
+	 * 3x3 comparison taps clamped to the face's tile.
+	 */
+	class LocalShadowAtlas
+	{
+	public:
+		static constexpr uint32_t MaxFaces = 6;                                   ///< Faces of a point light.
+		static constexpr uint32_t SpotLightSlot = LightData::MaxPointLights;      ///< Slot of the spot light, after the point lights.
+		static constexpr uint32_t SlotCount = LightData::MaxPointLights + 1;      ///< Lights with a slot in the block.
+		static constexpr GLuint BindingPoint = 4;                                 ///< Uniform buffer binding point of the block.
+		static constexpr const char* BlockName = "LocalShadowData";               ///< Name of the uniform block in GLSL.
+		static constexpr uint32_t TextureUnit = 25;                               ///< Texture unit the atlas is sampled from.
+		static constexpr const char* SamplerName = "LocalShadowMap";              ///< Name of the shadow sampler in GLSL.
+
+		/** Creates the uniform buffer with every light unshadowed and binds it to BindingPoint. Requires a current OpenGL context. */
+		void Create();
+
+		/** Deletes the uniform buffer, the atlas and the caster shader. */
+		void Destroy();
+
+		/**
+		 * Sets the size of the atlas. It is reallocated on the next ScheduleUpdates(), and every light redrawn.
+		 *
+		 * @param Size Width and height of the atlas in texels, rounded up to a power of two.
+		 */
+		void SetAtlasSize(uint32_t Size);
+
+		/** @return The width and height of the atlas in texels. */
+		uint32_t GetAtlasSize() const;
+
+		/**
+		 * Sets the range of the tile sizes. Reallocates the atlas like SetAtlasSize().
+		 *
+		 * @param MinSize Size of the tiles of the least important lights, rounded up to a power of two.
+		 * @param MaxSize Size of the tiles of the lights covering the screen, clamped to the atlas size.
+		 */
+		void SetTileSizes(uint32_t MinSize, uint32_t MaxSize);
+
+		/**
+		 * @param Scale Texels of a face per pixel of the projected diameter of the light's sphere.
+		 */
+		void SetResolutionScale(float Scale);
+
+		/**
+		 * Caps the faces redrawn per frame. A light is redrawn whole, and the first light of a frame even past
+		 * the budget, so a budget below six still updates point lights.
+		 *
+		 * @param Tiles The faces drawn per frame at most.
+		 */
+		void SetUpdateBudget(uint32_t Tiles);
+
+		/** @return The faces drawn per frame at most. */
+		uint32_t GetUpdateBudget() const;
+
+		/**
+		 * Picks the lights that cast shadows, all of them by default.
+		 *
+		 * @param PointLightMask One bit per point light of the LightData block.
+		 * @param bSpotLight Whether the spot light casts shadows.
+		 */
+		void SetShadowedLights(uint32_t PointLightMask, bool bSpotLight);
+
+		/**
+		 * @param Range Distance the shadows of a light reach at most, for lights whose attenuation never fades out.
+		 */
+		void SetMaxRange(float Range);
+
+		/**
+		 * @param Distance Near plane of the light views; casters closer to the light are clipped.
+		 */
+		void SetNearPlane(float Distance);
+
+		/**
+		 * @param DepthBias Constant subtracted from the depth of the receivers.
+		 * @param NormalBias Offset of the receivers along their normal, in texels of their face.
+		 */
+		void SetBias(float DepthBias, float NormalBias);
+
+		/**
+		 * Computes the views of the shadowed lights, their importance and the tile size it asks for.
+		 *
+		 * @param Lights The lights of the frame.
+		 * @param Camera The camera data of the frame (see CameraUniformBuffer).
+		 * @param ViewportHeight The height of the viewport in pixels.
+		 */
+		void Update(const LightData& Lights, const CameraData& Camera, int ViewportHeight);
+
+		/**
+		 * @param Slot A point light index, or SpotLightSlot.
+		 * @return True if the light casts shadows this frame.
+		 */
+		bool IsShadowed(uint32_t Slot) const;
+
+		/** @return The sphere the light of a slot reaches, its casters are culled against it. */
+		const BoundingSphere& GetLightBounds(uint32_t Slot) const;
+
+		/** @return The number of faces of the light of a slot: 6 for a point light, 1 for the spot light. */
+		uint32_t GetFaceCount(uint32_t Slot) const;
+
+		/** @return The view-projection of a face of a light, as computed by the last Update(). */
+		const glm::mat4& GetFaceViewProjection(uint32_t Slot, uint32_t Face) const;
+
+		/**
+		 * Picks the lights to redraw this frame within the budget, allocates their tiles and uploads the block.
+		 *
+		 * @param CasterHashes Hash of the casters in each light's sphere, their identity, mesh and transform revision.
+		 * @return The slots of the lights to draw, empty if no caster pass is needed.
+		 */
+		const std::vector<uint32_t>& ScheduleUpdates(const std::array<uint64_t, SlotCount>& CasterHashes);
+
+		/** Binds the atlas framebuffer and the caster shader, once ScheduleUpdates() returned lights to draw. */
+		void BeginCasterPass();
+
+		/**
+		 * Clears the tile of a face and sets the viewport and matrix the casters of the face are drawn with.
+		 *
+		 * @param Slot A slot returned by ScheduleUpdates().
+		 * @param Face A face of the light.
+		 */
+		void BeginTile(uint32_t Slot, uint32_t Face);
+
+		/** Restores the framebuffer, viewport and raster state, and binds the atlas for sampling. */
+		void EndCasterPass();
+
+		/** Uploads a block with every light unshadowed, keeping the tiles for when shadows come back. */
+		void Disable();
+
+		/** @return The number of faces drawn by the last ScheduleUpdates(). */
+		uint32_t GetUpdatedTileCount() const;
+
+	private:
+		/** What the atlas tracks of one light. */
+		struct LightState
+		{
+			BoundingSphere Bounds;                         ///< Sphere the light reaches.
+			glm::mat4 ViewProjection[MaxFaces] = {};       ///< Face matrices computed by the last Update().
+			std::array<glm::uvec2, MaxFaces> Tiles{};      ///< Texel offset of the tile of each face.
+			uint32_t FaceCount = 0;                        ///< 6 for a point light, 1 for the spot light.
+			uint32_t TileSize = 0;                         ///< Size of the tiles, 0 while the light has none.
+			uint32_t DesiredSize = 0;                      ///< Tile size the importance asks for.
+			float Importance = 0.0f;                       ///< Projected diameter of Bounds, in pixels.
+			float FovScale = 2.0f;                         ///< 2 * tan(half field of view) of the faces.
+			uint64_t LightHash = 0;                        ///< Hash of the light's position, direction, cone and range.
+			uint64_t PendingHash = 0;                      ///< Hash of the light and its casters this frame.
+			uint64_t DrawnHash = 0;                        ///< Hash of the light and casters the tiles were drawn with.
+			uint32_t StaleFrames = 0;                      ///< Frames the light waited for a redraw.
+			bool bShadowed = false;                        ///< Whether the light casts shadows this frame.
+		};
+
+		/** Allocates the depth atlas and its framebuffer for the current size, and resets every tile. */
+		void Allocate();
+
+		/** Deletes the atlas and its framebuffer. */
+		void DestroyTextures();
+
+		/** Uploads a block to the uniform buffer. */
+		void Upload(const LocalShadowData& Data);
+
+		/**
+		 * Gives a light tiles of the size it asks for, or the largest smaller size that fits. A light that
+		 * already has tiles keeps them if no size between the asked and the current one fits.
+		 *
+		 * @return False if the light has no tiles.
+		 */
+		bool FitTiles(LightState& Light);
+
+		/** Returns the tiles of a light to the allocator. */
+		void ReleaseTiles(LightState& Light);
+
+		/**
+		 * Takes a free tile of a size, splitting a larger one if needed.
+		 *
+		 * @return False if no tile of the size is left.
+		 */
+		bool AllocateTile(uint32_t Size, glm::uvec2& Offset);
+
+		/** Returns a tile, merged with its three buddies into their parent while they are all free. */
+		void FreeTile(uint32_t Size, glm::uvec2 Offset);
+
+		/** @return The distance where the diffuse light of an attenuation falls below 1/256, within the near plane and MaxRange. */
+		float GetLightRange(const glm::vec4& Attenuation, const glm::vec4& Diffuse) const;
+
+		/** @return The block slot of a light. */
+		LocalShadowSlot& GetSlot(uint32_t Slot);
+
+		GLuint m_BufferID = 0;                   ///< Uniform buffer of the block.
+		GLuint m_Atlas = 0;                      ///< Depth texture holding every tile.
+		GLuint m_Framebuffer = 0;                ///< Framebuffer of m_Atlas.
+		uint32_t m_AllocatedSize = 0;            ///< Size m_Atlas was allocated with.
+		std::unique_ptr<Shader> m_CasterShader;  ///< Depth-only shader of the faces.
+		UniformHandle m_ViewProjectionUniform;   ///< Matrix of the face being drawn.
+
+		LocalShadowData m_Data{};                ///< Block, as last uploaded.
+		bool m_bDirty = true;                    ///< Whether m_Data changed since the last upload.
+		bool m_bDisabled = false;                ///< Whether the uploaded block is Disable()'s, every light unshadowed.
+		std::array<LightState, SlotCount> m_Lights{}; ///< Every light with a slot.
+		std::vector<std::vector<glm::uvec2>> m_FreeTiles; ///< Free tiles of each quadtree level, the whole atlas at level 0.
+		std::vector<uint32_t> m_Candidates;      ///< Lights to redraw, reused across frames.
+		std::vector<uint32_t> m_Scheduled;       ///< Lights drawn this frame.
+		uint32_t m_UpdatedTiles = 0;             ///< Faces drawn this frame.
+
+		uint32_t m_AtlasSize = 4096;             ///< Width and height of the atlas.
+		uint32_t m_MinTileSize = 64;             ///< Smallest tile size.
+		uint32_t m_MaxTileSize = 1024;           ///< Largest tile size.
+		float m_ResolutionScale = 0.5f;          ///< Face texels per projected pixel.
+		uint32_t m_UpdateBudget = 12;            ///< Faces drawn per frame at most.
+		uint32_t m_PointLightMask = UINT32_MAX;  ///< Point lights casting shadows.
+		bool m_bSpotLightShadowed = true;        ///< Whether the spot light casts shadows.
+		float m_MaxRange = 64.0f;                ///< Farthest reach of a light's shadows.
+		float m_NearPlane = 0.05f;               ///< Near plane of the light views.
+		float m_DepthBias = 0.0005f;             ///< Constant depth bias of the receivers.
+		float m_NormalBias = 1.5f;               ///< Normal offset of the receivers, in texels.
+
+		GLint m_SavedViewport[4] = {};           ///< Viewport restored by EndCasterPass().
+		GLint m_SavedFramebuffer = 0;            ///< Draw framebuffer restored by EndCasterPass().
+	};
+
+} // namespace fgl
@@ -1,14 +1,44 @@
 #pragma once
 
 #include <FireGL/fglpch.h>
+#include <FireGL/Renderer/RasterState.h>
+#include <FireGL/Renderer/MaterialInstanceBuffer.h>
+#include <FireGL/Core/Symbol.h>
+#include <FireGL/Core/FlatHashMap.h>
 
 #include <External/glm/mat4x4.hpp>
+#include <External/glad/glad.h>
 
 namespace fgl
 {
 	class Shader;
+	class ShaderVariants;
 	class Texture;
 	class SceneObject;
+	struct MaterialGPUData;
+
+	/** How the surfaces of a material are combined with what is already drawn. */
+	enum class MaterialBlendMode
+	{
+		Opaque,     ///< Drawn with the batches, writing depth
+		Transparent ///< Blended over the opaque image after the sky, see Renderer::SetTransparencyMode()
+	};
+
+	/**
+	 * What the renderer reads of a Material, a copy of its edited state taken by Material::CaptureChanges().
+	 *
+	 * With a render thread (see Renderer::PrepareFrame()) the simulation keeps editing materials while the
+	 * previous frame is drawn from these copies, so the setters never race with the draws.
+	 */
+	struct MaterialRenderState
+	{
+		Shader* Program = nullptr;                               ///< Shader program the material draws with.
+		FlatHashMap<Symbol, Texture*> Textures;                  ///< Textures by interned name.
+		std::vector<uint8_t> Parameters;                         ///< Contents of the parameter block, empty if the material has none.
+		uint32_t Version = 0;                                    ///< Version of the state, see Material::GetVersion().
+		MaterialBlendMode BlendMode = MaterialBlendMode::Opaque; ///< Whether the material is drawn by the transparent pass.
+		RasterState Raster;                                      ///< Culling and depth state the material draws with.
+	};
 
 	/**
 	 * @class Material
@@ -24,6 +54,9 @@ namespace fgl
 	class Material
 	{
 	public:
+		static constexpr GLuint ParameterBindingPoint = 2;                    ///< Uniform buffer binding point of the parameter blocks.
+		static constexpr const char* ParameterBlockName = "MaterialParameters"; ///< Name of the parameter block in GLSL.
+
 		/**
 		 * Constructs a Material object and initializes the shader for the material.
 		 * This constructor must be called by any derived class to ensure the material
@@ -33,6 +66,12 @@ namespace fgl
 		 */
 		Material(Shader* Shader);
 
+		/** Deletes the parameter buffer, if any. */
+		virtual ~Material();
+
+		Material(const Material&) = delete;
+		Material& operator=(const Material&) = delete;
+
 		/**
 		 * Associates a texture with the material, using the given texture name.
 		 * The maximum number of textures that can be bound to a material is 32.
@@ -42,13 +81,143 @@ namespace fgl
 		 */
 		void SetTexture(std::string_view TextureName, Texture* Texture);
 
+		/** SetTexture() with an interned name, e.g. a Symbol kept by the caller. */
+		void SetTexture(Symbol TextureName, Texture* Texture);
+
+		/**
+		 * Switches the material to a permutation of a shader, compiled on first use (see ShaderVariants).
+		 *
+		 * @param Variants       The permutations to pick from, which must outlive the material.
+		 * @param FeatureMask    The features the material needs.
+		 */
+		void SetShaderVariant(ShaderVariants& Variants, uint32_t FeatureMask);
+
+		/**
+		 * Sets the contents of the material's "MaterialParameters" uniform block (std140).
+		 * The block lives in a uniform buffer owned by the material: it is only uploaded on the next
+		 * Activate() when the bytes changed, and the buffer is rebound to ParameterBindingPoint when the
+		 * material is activated, instead of sending one uniform per parameter on every draw.
+		 *
+		 * @param Data    The block contents, laid out as std140.
+		 * @param Size    The size of the block in bytes.
+		 */
+		void SetParameters(const void* Data, size_t Size);
+
+		/**
+		 * Sets how the material's surfaces are combined with what is already drawn.
+		 * Transparent materials are left out of the opaque batches and drawn by the renderer's transparent pass,
+		 * with depth testing but no depth writes, on the CPU culling paths. Their shaders output straight
+		 * (non-premultiplied) alpha, or the TransparencyBuffer outputs in TransparencyMode::WeightedBlended.
+		 * In RenderingMode::Deferred they are drawn forward after the lighting pass, with their own shading.
+		 *
+		 * @param Mode    The blend mode, MaterialBlendMode::Opaque by default.
+		 */
+		void SetBlendMode(MaterialBlendMode Mode);
+
+		/** @return The blend mode set by SetBlendMode(). */
+		MaterialBlendMode GetBlendMode() const;
+
+		/**
+		 * Sets the face culling and depth state the material draws with, applied by Activate() through
+		 * GLStateCache only where it differs from the current state. Back faces are culled by default, so
+		 * open or double-sided surfaces need CullMode::None. The renderer's passes may hold the depth state,
+		 * e.g. after a depth prepass (see GLStateCache::BeginDepthOverride()).
+		 *
+		 * @param State    The raster state, RasterState() by default.
+		 */
+		void SetRasterState(const RasterState& State);
+
+		/** @return The raster state set by SetRasterState(). */
+		const RasterState& GetRasterState() const;
+
+		/** Sets the parameter block from a struct mirroring its std140 layout, see SetParameters(). */
+		template<typename T>
+		void SetParameters(const T& Parameters)
+		{
+			SetParameters(&Parameters, sizeof(T));
+		}
+
 		/**
 		 * Activates the material, binding all associated textures and the shader.
 		 * This function is called by the renderer to prepare the material for use
-		 * during rendering.
+		 * during rendering. Does nothing if this material is already the active one at the
+		 * same version (see GetVersion()), apart from its raster state, which is always checked against the
+		 * cached one; the renderer resets the active material at the start of every frame.
+		 *
+		 * ApplyUniforms() is skipped as well when the shader still holds the uniforms this material applied
+		 * at its current version since the last reset, e.g. when two materials with different shaders alternate.
 		 */
 		void Activate();
 
+		/**
+		 * Forgets which material is active, so the next Activate() call binds its state again
+		 * and applies its uniforms again. Called by the renderer once per frame, and needed after
+		 * changing the program, textures or uniforms outside of Material::Activate.
+		 */
+		static void InvalidateActiveMaterial();
+
+		/**
+		 * Copies the state of every material edited since the last call to what the renderer reads (see
+		 * GetRenderState()). Called by Renderer::PrepareFrame() while no frame is drawn, or by Render() without
+		 * a render thread; the setters can then be called at any time from the thread running the simulation.
+		 */
+		static void CaptureChanges();
+
+		/**
+		 * @return The state captured by the last CaptureChanges(), what Activate() binds. The other getters
+		 *         return the edited state.
+		 */
+		const MaterialRenderState& GetRenderState() const;
+
+		/**
+		 * Retrieves the unique ID of this material, used to sort draws and group them by material.
+		 *
+		 * @return The material ID, starting at 1.
+		 */
+		uint32_t GetID() const;
+
+		/**
+		 * Lets the objects of this material share the batches of another material's objects, so they are drawn
+		 * together by one instanced call with the other material activated. Only for materials alike in everything
+		 * the draw binds (shader, textures, parameter block, uniforms, blend mode and raster state) whose differences
+		 * live in their instance data, see SetInstanceData(). Takes effect for objects batched afterwards.
+		 *
+		 * @param Other The material whose batches to share, this material itself to stop sharing.
+		 */
+		void ShareBatchesWith(const Material& Other);
+
+		/** @return The ID the renderer batches this material's objects by, GetID() unless batches are shared. */
+		uint32_t GetBatchID() const;
+
+		/**
+		 * Sets the values of this material read per instance from the "MaterialInstanceData" storage block
+		 * (see MaterialInstanceBuffer), e.g. the tint and roughness of variants sharing their batches.
+		 * Doesn't change the version: no state is bound again, only the record is uploaded.
+		 *
+		 * @param Data The values of the material.
+		 */
+		void SetInstanceData(const MaterialInstanceData& Data);
+
+		/** @return The values set by SetInstanceData(), the defaults if none were set. */
+		MaterialInstanceData GetInstanceData() const;
+
+		/**
+		 * Retrieves the version of this material's state, incremented whenever a texture, the parameter
+		 * block or a value read by ApplyUniforms() changes.
+		 *
+		 * @return The current version.
+		 */
+		uint32_t GetVersion() const;
+
+		/**
+		 * Fills the record of this material in the bindless material buffer (see MaterialBuffer).
+		 * The default implementation stores the bindless handle of each texture at its slot index;
+		 * derived classes can override it to also fill the parameters.
+		 *
+		 * @param Data The record to fill, zeroed beforehand.
+		 */
+		virtual void WriteGPUData(MaterialGPUData& Data) const;
+
 		/**
 		 * Sets the SceneObject that the material is applied to, ensuring the material
 		 * has access to the camera MVP (Model-View-Projection) for proper rendering.
@@ -67,6 +236,13 @@ namespace fgl
 		 */
 		const Shader* GetShader() const;
 
+		/**
+		 * Retrieves every texture associated with the material.
+		 *
+		 * @return The map of interned texture names to texture pointers.
+		 */
+		const FlatHashMap<Symbol, Texture*>& GetTextures() const;
+
 	protected:
 		/**
 		 * This function is intended to be overridden by derived classes to apply custom
@@ -76,7 +252,13 @@ namespace fgl
 		virtual void ApplyUniforms();
 
 		/**
-		 * Retrieves the texture associated with the given name.
+		 * Flags the material state as changed, so its next Activate() binds and applies it again even if
+		 * it is the active material. Derived classes call it when a value their ApplyUniforms() reads changes.
+		 */
+		void MarkChanged();
+
+		/**
+		 * Retrieves the captured texture associated with the given name (see GetRenderState()).
 		 * This function is typically used in the derived class' 'ApplyUniforms' method
 		 * to get the texture data and send it to the shader for proper rendering.
 		 *
@@ -85,6 +267,9 @@ namespace fgl
 		 */
 		const Texture* GetTexture(std::string_view TextureName) const;
 
+		/** GetTexture() with an interned name, e.g. a static Symbol of ApplyUniforms(), looked up without hashing a string. */
+		const Texture* GetTexture(Symbol TextureName) const;
+
 		/**
 		 * Retrieves the SceneObject to which the material is applied.
 		 * This function is used in the derived class' 'ApplyUniforms' method to
@@ -102,11 +287,30 @@ namespace fgl
 		 */
 		void ActivateTextures() const;
 
+		/** Uploads the parameter block if it changed, creating its buffer on first use. */
+		void UploadParameters();
+
+		/** Queues the material for the next CaptureChanges(), once. */
+		void QueueCapture();
+
 	private:
-		Shader* m_ShaderProgram;							  ///< A pointer to the shader program used by the material
-		std::unordered_map<std::string, Texture*> m_Textures; ///< A map of texture names to texture pointers
+		MaterialRenderState m_State;						  ///< Edited state: shader, textures, parameter block, version, blend mode and raster state
+		MaterialRenderState m_RenderState;					  ///< State read by the renderer, see CaptureChanges()
 
 		SceneObject* m_SceneObject;							  ///< A pointer to the SceneObject this material is applied to
+		uint32_t m_ID;										  ///< Unique ID of the material, used in render queue sort keys
+		uint32_t m_BatchID;									  ///< ID objects of this material are batched by, see ShareBatchesWith()
+
+		GLuint m_ParameterBuffer = 0;						  ///< Uniform buffer holding the parameter block
+		bool m_bParametersChanged = false;					  ///< Whether m_State.Parameters changed since the last capture
+		bool m_bParametersDirty = false;					  ///< Whether m_RenderState.Parameters changed since the last upload
+		bool m_bCaptureQueued = false;						  ///< Whether the material is in s_CaptureQueue
+
+		static uint32_t s_NextID;							  ///< ID given to the next constructed material
+		static const Material* s_ActiveMaterial;			  ///< Material whose state is currently bound, nullptr if unknown
+		static uint32_t s_ActiveVersion;					  ///< Version of s_ActiveMaterial when it was bound
+		static uint32_t s_Generation;						  ///< Incremented by InvalidateActiveMaterial(), ages the applied uniforms
+		static std::vector<Material*> s_CaptureQueue;		  ///< Materials edited since the last CaptureChanges()
 	};
 
 } // namespace fgl
\ No newline at end of file
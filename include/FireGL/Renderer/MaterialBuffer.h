@@ -0,0 +1,67 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+
+#include <External/glm/vec4.hpp>
+#include <External/glad/glad.h>
+
+namespace fgl
+{
+	class Material;
+
+	/**
+	 * CPU-side mirror of one record of the "MaterialData" shader storage block, laid out to match std430.
+	 *
+	 * Shaders written for bindless materials index the block with the per-instance material index
+	 * (vertex location 11, passed on as a flat varying) and build their samplers from the handles:
+	 *
+	 *     #extension GL_ARB_bindless_texture : require
+	 *     struct MaterialRecord { uvec2 Textures[4]; vec4 Parameters; };
+	 *     layout (std430, binding = 0) readonly buffer MaterialData { MaterialRecord Materials[]; };
+	 *
+	 *     vec4 Diffuse = texture(sampler2D(Materials[MaterialIndex].Textures[0]), TexCoords);
+	 */
+	struct MaterialGPUData
+	{
+		static constexpr size_t MaxTextures = 4; ///< Texture handles stored per material.
+
+		uint64_t Textures[MaxTextures] = {}; ///< Resident bindless handles, in texture slot order.
+		glm::vec4 Parameters{ 0.0f };        ///< Material specific values (see Material::WriteGPUData).
+	};
+
+	/**
+	 * Owns the shader storage buffer holding the records of the materials drawn in a frame (bindless path).
+	 *
+	 * Records are indexed by Material::GetID(), which the renderer also writes in each object's
+	 * instance data, so objects with different materials can be drawn by one instanced draw or one
+	 * multi-draw call without binding any texture.
+	 */
+	class MaterialBuffer
+	{
+	public:
+		static constexpr GLuint BindingPoint = 0;                ///< Shader storage binding point of the material block.
+		static constexpr const char* BlockName = "MaterialData"; ///< Name of the storage block in GLSL.
+
+		/** @return True if the context supports shader storage buffers (OpenGL 4.3) and GL_ARB_bindless_texture. */
+		static bool IsSupported();
+
+		/** Creates the storage buffer and binds it to BindingPoint. Requires a current OpenGL context. */
+		void Create();
+
+		/** Deletes the storage buffer. */
+		void Destroy();
+
+		/**
+		 * Writes and uploads the records of the given materials.
+		 *
+		 * @param Materials The materials drawn this frame, without duplicates.
+		 */
+		void Update(const std::vector<Material*>& Materials);
+
+	private:
+		GLuint m_BufferID = 0;                  ///< OpenGL shader storage buffer ID.
+		size_t m_Capacity = 0;                  ///< Records the GPU storage can hold.
+		std::vector<MaterialGPUData> m_Records; ///< Records by material ID, the last ones uploaded.
+	};
+
+} // namespace fgl
\ No newline at end of file
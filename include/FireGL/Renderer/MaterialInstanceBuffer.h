@@ -0,0 +1,82 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+
+#include <External/glm/vec4.hpp>
+#include <External/glad/glad.h>
+
+#include <mutex>
+
+namespace fgl
+{
+
+	/**
+	 * CPU-side mirror of one record of the "MaterialInstanceData" shader storage block, laid out to match std430.
+	 *
+	 * Shaders index the block with the per-instance material index (vertex location 11, passed on as a flat
+	 * varying), so objects whose materials only differ by these values can be drawn by one instanced call:
+	 *
+	 *     struct MaterialInstance { vec4 Tint; vec4 Emissive; vec4 Parameters; };
+	 *     layout (std430, binding = 14) readonly buffer MaterialInstanceData { MaterialInstance MaterialInstances[]; };
+	 *
+	 *     vec4 Color = texture(Diffuse, TexCoords) * MaterialInstances[MaterialIndex].Tint;
+	 */
+	struct MaterialInstanceData
+	{
+		glm::vec4 Tint{ 1.0f };          ///< Color multiplied with the surface color.
+		glm::vec4 Emissive{ 0.0f };      ///< Emitted color in rgb, intensity in a.
+		glm::vec4 Parameters{ 0.0f };    ///< Roughness in x, metalness in y, the rest material specific.
+
+		bool operator==(const MaterialInstanceData& Other) const = default;
+	};
+
+	/**
+	 * Owns the shader storage buffer holding the per-material values of every material, indexed by Material::GetID().
+	 *
+	 * Materials write their record with Material::SetInstanceData() from any thread, into a table shared by the
+	 * engine; the renderer uploads the table once per frame, and only when a record changed since its last
+	 * upload. Materials that never set their values read the defaults: white tint, no emission.
+	 */
+	class MaterialInstanceBuffer
+	{
+	public:
+		static constexpr GLuint BindingPoint = 14;                       ///< Shader storage binding point of the block.
+		static constexpr const char* BlockName = "MaterialInstanceData"; ///< Name of the storage block in GLSL.
+
+		/** @return True if the context supports shader storage buffers (OpenGL 4.3). */
+		static bool IsSupported();
+
+		/**
+		 * Sets the record of a material, uploaded by the next Update() of every renderer.
+		 *
+		 * @param MaterialID The ID of the material, see Material::GetID().
+		 * @param Data The values of the material.
+		 */
+		static void SetRecord(uint32_t MaterialID, const MaterialInstanceData& Data);
+
+		/** @return The record of a material, the defaults if it was never set. */
+		static MaterialInstanceData GetRecord(uint32_t MaterialID);
+
+		/** Creates the storage buffer and binds it to BindingPoint. Requires a current OpenGL context. */
+		void Create();
+
+		/** Deletes the storage buffer. */
+		void Destroy();
+
+		/** @return True once Create() was called. */
+		bool IsCreated() const;
+
+		/** Uploads the records if any changed since the last call, and binds the buffer to BindingPoint. */
+		void Update();
+
+	private:
+		static std::mutex s_Mutex;                           ///< Guards the records, materials may be edited on loading threads.
+		static std::vector<MaterialInstanceData> s_Records;  ///< Records by material ID.
+		static uint64_t s_Revision;                          ///< Incremented whenever a record changes.
+
+		GLuint m_BufferID = 0;              ///< OpenGL shader storage buffer ID.
+		size_t m_Capacity = 0;              ///< Records the GPU storage can hold.
+		uint64_t m_UploadedRevision = 0;    ///< s_Revision of the last upload.
+	};
+
+} // namespace fgl
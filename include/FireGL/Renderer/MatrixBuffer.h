@@ -1,22 +1,76 @@
 #pragma once
 
 #include <FireGL/fglpch.h>
+#include <FireGL/Renderer/RenderDevice.h>
 
 #include <External/glm/mat4x4.hpp>
+#include <External/glm/mat3x4.hpp>
+#include <External/glm/vec4.hpp>
+#include <External/glad/glad.h>
 
 namespace fgl
 {
 
+    /**
+     * Storage strategy used by a MatrixBuffer for its GPU side.
+     */
+    enum class MatrixBufferMode
+    {
+        Orphaning,     ///< Dirty range uploaded with RenderDevice::UpdateBuffer(), orphaning on full uploads (OpenGL 4.1 fallback)
+        PersistentRing ///< BufferUsage::Persistent, triple-buffered GPU storage fenced per frame (OpenGL 4.4+)
+    };
+
+    /**
+     * Per-instance data read by the instanced vertex attributes.
+     *
+     * Locations 3 to 6 receive the Model matrix and locations 7 to 9 the normal matrix (as the xyz of
+     * three vec4 columns, padded so every column stays 16-byte aligned), their w holding the packed
+     * procedural animation of the object (see ProceduralAnimation::Pack()). Shaders that don't need
+     * normals simply don't declare locations 7 to 9, those without animation declare them as a mat3. Location 10 receives the texture array layers of
+     * the object as a uvec4 (see TextureArrayPool), location 11 its material index as a uint
+     * (see MaterialBuffer) and location 12 the first bone of its palette, its reflection probe and its point
+     * lights as a uvec3 (see BonePaletteBuffer, ReflectionProbes and ObjectLightAssigner), declared as a uint
+     * or a uvec2 by shaders only reading the first components.
+     * Location 15 receives the object's instance payload as a vec4, free-form data the shaders of a
+     * material agree on (see SceneObject::SetInstancePayload()).
+     */
+    struct InstanceData
+    {
+        glm::mat4 Model;          ///< Object to world matrix.
+        glm::mat3x4 NormalMatrix; ///< transpose(inverse(mat3(Model))) in xyz, the packed procedural animation in w.
+        glm::uvec4 TextureLayers; ///< Layers the object samples in the texture arrays of its material.
+        uint32_t MaterialIndex;   ///< Record of the object's material in the bindless material buffer, 0 if none.
+        uint32_t BoneOffset;      ///< First bone of the object's palette in the BonePaletteBuffer, 0 if not skinned.
+        uint32_t ReflectionProbe; ///< Reflection probe the object samples, plus 1; 0 if none (see ReflectionProbes).
+        uint32_t PointLights;     ///< Point lights shading the object plus 1, one byte each; 0 ends the list (see ObjectLightAssigner).
+        glm::vec4 Payload;        ///< Per-instance data declared by the object's shaders (tint, UV offset, animation phase...).
+    };
+
     /**
      * MatrixBuffer class responsible for managing a dynamic array of transformation matrices.
      *
-     * This class handles memory allocation for a buffer of glm::mat4 matrices, typically used
+     * This class handles memory allocation for a buffer of InstanceData records, typically used
      * for instanced rendering. It stores object transformations and can dynamically resize
      * to accommodate a variable number of instances, minimizing reallocation frequency.
+     *
+     * Once CreateGPUBuffer() has been called, the MatrixBuffer also owns the GPU buffer the matrices
+     * are read from, created through the RenderDevice. When the device supports persistent buffers
+     * (OpenGL 4.4+) that buffer is persistently mapped and split into three frame regions guarded by
+     * fences. Older contexts upload with RenderDevice::UpdateBuffer(), orphaning the buffer when
+     * everything changed.
+     *
+     * Matrices are written to the CPU-side array returned by Get(), and the written slots are reported
+     * through MarkDirty(). Upload() then only transfers the dirty range: directly in Orphaning mode, or
+     * into the current ring region together with the ranges the region missed during the last frames.
+     *
+     * A frame is bracketed by BeginFrame() and EndFrame(); GetRegionBaseInstance() gives the instance
+     * offset of the region the current frame draws from.
      */
     class MatrixBuffer
     {
     public:
+        static constexpr size_t RegionCount = 3;       ///< Number of frame regions used by the persistent ring.
+
         /**
          * Default constructor for MatrixBuffer.
          * Initializes an empty buffer with no allocated objects.
@@ -28,25 +82,70 @@ namespace fgl
          *
          * @param ObjectCount The initial number of objects to allocate space for.
          *        Internally allocates space for double the provided count to reduce future allocations.
-         */        
+         */
         MatrixBuffer(size_t ObjectCount);
 
+        /** Releases the GPU buffer, its mapping and any pending fences. */
+        ~MatrixBuffer();
+
+        MatrixBuffer(const MatrixBuffer&) = delete;
+        MatrixBuffer& operator=(const MatrixBuffer&) = delete;
+
+        /**
+         * Creates the GPU buffer backing this MatrixBuffer, once it holds objects.
+         * Requires a current OpenGL context; picks the persistent ring when the RenderDevice supports persistent buffers.
+         */
+        void CreateGPUBuffer();
+
+        /** Deletes the GPU buffer, its persistent mapping and pending fences, if any. */
+        void DestroyGPUBuffer();
+
         /**
          * Resizes the matrix buffer to accommodate a new number of objects.
          *
          * If the new size is larger than the current capacity, the buffer is reallocated
          * to accommodate twice the new object count to minimize frequent reallocations.
+         * Once CreateGPUBuffer() has been called, a new GPU buffer is created and GetBufferID() changes.
+         * The previous contents are discarded: every slot must be written again, and the next Upload()
+         * transfers the full used range.
          *
          * @param NewObjectCount The new number of objects to allocate space for.
+         * @return True if the GPU buffer was replaced and vertex attributes must be rebound.
+         */
+        bool Resize(size_t NewObjectCount);
+
+        /**
+         * Starts a new frame. In PersistentRing mode this advances to the next region and waits
+         * for the GPU to be done reading it.
+         */
+        void BeginFrame();
+
+        /**
+         * Flags the matrices of an object as modified so the next Upload() transfers them.
+         *
+         * @param ObjectIndex Slot of the object whose matrices were written.
+         */
+        void MarkDirty(size_t ObjectIndex);
+
+        /**
+         * Makes the first UsedObjectCount objects visible to the GPU, transferring only the dirty range.
+         * Orphans the buffer when the whole used range is uploaded in Orphaning mode.
+         *
+         * @param UsedObjectCount Number of objects used this frame.
+         */
+        void Upload(size_t UsedObjectCount);
+
+        /**
+         * Ends the frame. In PersistentRing mode this fences the region used by the frame's draws.
          */
-        void Resize(size_t NewObjectCount);
+        void EndFrame();
 
         /**
-         * Retrieves a pointer to the buffer containing glm::mat4 matrices.
+         * Retrieves a pointer to the buffer containing the per-instance data.
          *
-         * @return Pointer to the matrix buffer.
+         * @return Pointer to the CPU-side matrix buffer.
          */
-        glm::mat4* Get() const;
+        InstanceData* Get() const;
 
         /**
          * Returns the current number of objects that can fit in the buffer.
@@ -58,20 +157,54 @@ namespace fgl
         /**
          * Returns the total size (in bytes) of the allocated buffer.
          *
-         * @return Size of the buffer in bytes.
+         * @return Size of the buffer in bytes, for a single frame region.
          */
         size_t GetBufferSize() const;
 
+        /**
+         * Returns the index of the first instance of the current frame region.
+         * Must be added to the base instance of every draw reading from this buffer.
+         *
+         * @return Instance offset of the current region, always 0 in Orphaning mode.
+         */
+        size_t GetRegionBaseInstance() const;
+
+        /** @return The OpenGL buffer ID holding the matrices, 0 until the buffer holds objects. */
+        GLuint GetBufferID() const;
+
+        /** @return The storage strategy selected by CreateGPUBuffer(). */
+        MatrixBufferMode GetMode() const;
+
     private:
-        std::unique_ptr<glm::mat4[]> m_Buffer; ///< Pointer to the dynamically allocated buffer of matrices.
-        
+        /** Creates the GPU buffer for the current capacity. */
+        void AllocateGPUStorage();
+
+    private:
+        /** Half-open [Begin, End) range of object slots. */
+        struct DirtyRange
+        {
+            size_t Begin = SIZE_MAX;
+            size_t End = 0;
+        };
+
+        std::unique_ptr<InstanceData[]> m_Buffer; ///< Pointer to the dynamically allocated buffer of instance data.
+
         /**
          * Number of objects that can currently fit in the buffer.
          *
-         * Each object requires 2 glm::mat4 matrices, so this count reflects the total
+         * Each object requires one InstanceData record, so this count reflects the total
          * number of objects, not individual matrices.
-         */        
+         */
         size_t m_ObjectCount;
+
+        MatrixBufferMode m_Mode = MatrixBufferMode::Orphaning; ///< Storage strategy of the GPU buffer.
+        BufferHandle m_GPUBuffer;                              ///< GPU buffer holding the matrices, mapped in PersistentRing mode.
+        bool m_bGPUBufferCreated = false;                      ///< Whether CreateGPUBuffer() was called, the buffer then follows the capacity.
+        FenceHandle m_RegionFences[RegionCount];               ///< Fences guarding each region (PersistentRing mode).
+        size_t m_CurrentRegion = 0;                            ///< Region written by the current frame.
+        DirtyRange m_Dirty;                                    ///< Slots written since the last Upload().
+        DirtyRange m_RegionDirty[RegionCount];                 ///< Dirty range uploaded by the frame that last used each region.
+        size_t m_PendingFullUploads = 0;                       ///< Uploads that must still transfer the full used range.
     };
 
 } // namespace fgl
\ No newline at end of file
@@ -3,61 +3,298 @@
 #include <FireGL/fglpch.h>
 #include <FireGL/Renderer/Vertex.h>
 #include <FireGL/Renderer/Texture.h>
+#include <FireGL/Renderer/BoundingVolume.h>
+#include <FireGL/Renderer/IndirectDrawBuffer.h>
+#include <FireGL/Renderer/GeometryArena.h>
+#include <FireGL/Renderer/MeshOptimizer.h>
+#include <FireGL/Core/MemoryTracker.h>
 
 #include <External/glm/mat4x4.hpp>
 
+#include <span>
+
 namespace fgl
 {
 	class Material;
 
+	/**
+	 * A reduced level of detail of a BaseMesh: a triangle list over the same vertices, drawn for small projected sizes.
+	 */
+	struct MeshLOD
+	{
+		std::vector<unsigned int> Indices; ///< Triangles of the level, indexing the vertices of the full-detail mesh.
+		float ScreenSize = 0.0f;           ///< Projected size below which the level is drawn (see Renderer::SetLevelOfDetail()).
+		uint32_t IndexOffset = 0;          ///< Offset of the level's indices from the mesh's first index in the arena, set by the first pass.
+		uint32_t IndexCount = 0;           ///< Number of indices of the level, set by the first pass so Indices can be released.
+	};
+
+	/** What a mesh keeps of its geometry in system memory once the first pass uploaded it. */
+	enum class CPUGeometryPolicy : uint8_t
+	{
+		Default,    ///< Follows BaseMesh::SetDefaultCPUGeometryPolicy().
+		Keep,       ///< Keeps every vertex and index, needed to merge the mesh into StaticGeometry or bake a Lightmap.
+		Release,    ///< Frees the vertices, indices, skin and lightmap coordinates; bounds, counts and meshlets stay.
+		Collision   ///< Like Release, but keeps the positions and the full-detail indices for CPU picking and collision.
+	};
+
+	/**
+	 * Computes a hash of every vertex attribute and index of a mesh, a word at a time, deduplicating meshes loaded separately.
+	 * @return The content hash, never 0.
+	 */
+	uint64_t ComputeMeshContentHash(std::span<const Vertex> Vertices, std::span<const unsigned int> Indices);
+
+	class BaseMesh;
+
+	/**
+	 * What drawing one level of detail of a mesh reads, captured by BaseMesh::GetDrawInfo() once the mesh is uploaded.
+	 * Render proxies keep these packed next to each other (see RenderProxy::GetDraws()), so the per-frame draw loops
+	 * walk a small linear array instead of pulling the vertex, index and texture vectors of every BaseMesh into cache.
+	 */
+	struct MeshDrawInfo
+	{
+		DrawElementsIndirectCommand Command{};          ///< Indices of the level, instance count and base instance left at 0.
+		GLuint VertexArray = 0;                         ///< Arena VAO of the mesh's vertex format.
+		GLenum IndexType = GL_UNSIGNED_INT;             ///< Type of the mesh indices on the GPU.
+		VertexFormat Format = VertexFormat::Standard;   ///< Vertex format, selects the instance attributes to rebase.
+		bool bInstanceAttributes = false;               ///< True once the second pass configured the instance attributes.
+		bool bMeshlets = false;                         ///< True if the level is split into meshlets, only the full-detail level is.
+		Material* DrawMaterial = nullptr;               ///< Material of the mesh, nullptr if it has none.
+		GeometryArena* Arena = nullptr;                 ///< Arena holding the mesh, to rebase the instances without base instance support.
+		const BaseMesh* Mesh = nullptr;                 ///< The mesh itself, for its cold data such as the meshlets.
+	};
+
 	/**
 	 * @class BaseMesh
 	 *
 	 * @brief A class that encapsulates the core functionality for rendering a 3D mesh with OpenGL.
-	 *        It manages vertex and index data, sets up vertex attributes, and handles the rendering of
-	 *        the mesh with optional material support. This class is not intended to be derived from, as
-	 *        it controls its own internal state and OpenGL resources.
+	 *        It manages vertex and index data, uploads them to the renderer's GeometryArena, and handles
+	 *        the rendering of the mesh with optional material support. This class is not intended to be
+	 *        derived from, as it controls its own internal state.
 	 *
 	 * @details The class provides methods for:
-	 *          - Initializing and configuring buffers (First and Second Pass)
+	 *          - Uploading its geometry and configuring instancing (First and Second Pass)
 	 *          - Binding textures and materials to the mesh
 	 *          - Rendering the mesh with instancing support
-	 *          - Computing and retrieving a unique mesh hash for efficient instanced rendering
+	 *          - Assigning a mesh ID shared by meshes of identical content for efficient instanced rendering
+	 *          - Storing simplified levels of detail, drawn from the same vertices
+	 *          - Splitting the full-detail triangles into meshlets culled on their own
 	 *          - Storing vertex, index, and texture data for mesh rendering
 	 */
 	class BaseMesh
 	{
 	public:
 		/**
-		 * Constructs a BaseMesh with vertices, indices, textures, and a flag to compute hash.
+		 * Constructs a BaseMesh with vertices, indices, textures, and a flag to deduplicate it.
 		 * @param Vertices The vertices of the mesh.
 		 * @param Indices The indices of the mesh.
 		 * @param Textures The textures associated with the mesh.
-		 * @param bComputeHash Flag indicating whether to compute the mesh hash.
+		 * @param bDeduplicate Hashes the whole geometry so meshes of identical content share their mesh ID.
+		 *        When false, the mesh gets an ID of its own without reading its vertices.
 		 */
-		BaseMesh(std::vector<Vertex>&& Vertices, std::vector<unsigned int>&& Indices, std::vector<Texture>&& Textures, bool bComputeHash);
+		BaseMesh(std::vector<Vertex>&& Vertices, std::vector<unsigned int>&& Indices, std::vector<Texture>&& Textures, bool bDeduplicate);
+
+		/**
+		 * Copies a mesh, e.g. a shared shape geometry given a material of its own.
+		 * The copy shares the geometry allocation and holds views of the textures, which the original keeps owning.
+		 */
+		BaseMesh(const BaseMesh& Other);
+		BaseMesh& operator=(const BaseMesh& Other);
+
+		BaseMesh(BaseMesh&&) = default;
+		BaseMesh& operator=(BaseMesh&&) = default;
 		
 		/**
-		 * Performs the first pass of mesh setup by initializing buffers and configuring vertex attributes.
+		 * Performs the first pass of mesh setup by uploading the vertices and indices into the arena.
+		 * The indices of every level of detail follow the full-detail ones in a single allocation.
+		 * Does nothing if the mesh is already stored in this arena.
+		 * @param Arena The geometry arena the mesh is stored in and drawn from.
+		 */
+		void FirstPass(GeometryArena& Arena);
+
+		/**
+		 * Sets what meshes whose own policy is CPUGeometryPolicy::Default keep in system memory after their
+		 * first pass, CPUGeometryPolicy::Keep by default. Meshes already uploaded aren't affected.
+		 *
+		 * @param Policy The policy, Default being read as Keep.
 		 */
-		void FirstPass();
+		static void SetDefaultCPUGeometryPolicy(CPUGeometryPolicy Policy);
+
+		/**
+		 * Sets what this mesh keeps in system memory after its first pass, overriding the default policy.
+		 * Released geometry can be put back with RestoreCPUGeometry(), e.g. by Model::RestoreCPUGeometry().
+		 *
+		 * @param Policy The policy of the mesh.
+		 */
+		void SetCPUGeometryPolicy(CPUGeometryPolicy Policy);
+
+		/** @return False once the first pass released the vertices and indices (see SetCPUGeometryPolicy()). */
+		bool HasCPUGeometry() const;
+
+		/** @return The number of vertices of the mesh, also known once its CPU copy is released. */
+		size_t GetVertexCount() const;
+
+		/** @return The number of full-detail indices of the mesh, also known once its CPU copy is released. */
+		size_t GetIndexCount() const;
+
+		/**
+		 * Puts back geometry released after the upload, e.g. read again from the MeshCache.
+		 * The skin and lightmap coordinates aren't restored.
+		 *
+		 * @param Vertices The vertices the mesh was created with.
+		 * @param Indices The full-detail indices the mesh was created with.
+		 * @param LODIndices The indices of each simplified level, level 1 first.
+		 */
+		void RestoreCPUGeometry(std::vector<Vertex>&& Vertices, std::vector<unsigned int>&& Indices, std::vector<std::vector<unsigned int>>&& LODIndices);
+
+		/** @return The vertex positions kept by CPUGeometryPolicy::Collision, indexed by GetIndices(), otherwise empty. */
+		const std::vector<glm::vec3>& GetCollisionPositions() const;
 
 		/**
 		 * Performs the second pass of mesh setup by configuring vertex attributes for instancing.
+		 * Must follow FirstPass(), with the instance buffer given to GeometryArena::SetInstanceBuffer().
 		 */
 		void SecondPass();
 		
 		/**
-		 * Retrieves the mesh hash used for automatic instanced rendering.
-		 * @return The hash of the mesh.
+		 * Retrieves the mesh ID used for automatic instanced rendering.
+		 * IDs are small and dense, meshes only share one when their content hashes are equal.
+		 * @return The ID of the mesh, never 0.
+		 */
+		uint32_t GetMeshID() const;
+
+		/** @return The hash of the vertices and indices of the mesh, 0 when it wasn't deduplicated. */
+		uint64_t GetContentHash() const;
+
+		/**
+		 * Uses a content hash computed when the mesh was first imported, e.g. restored from a MeshCache,
+		 * and looks the mesh ID up again from it.
+		 * @param ContentHash The hash of the mesh content, 0 to give the mesh an ID of its own.
 		 */
-		size_t GetMeshHash() const;
+		void SetContentHash(uint64_t ContentHash);
+
+		/**
+		 * Gets the mesh ID registered for a content hash, registering a new one on first use. Thread-safe.
+		 * @param ContentHash The hash identifying the content, 0 to always get a new ID.
+		 * @return The ID shared by every call made with the same non-zero hash.
+		 */
+		static uint32_t AcquireMeshID(uint64_t ContentHash);
 
 		/**
 		 * Renders the mesh with the specified number of instances.
 		 * @param NumberInstance The number of instances to render.
+		 * @param BaseInstance Index of the first instance to read from the bound instance buffer.
+		 * @param LOD The level of detail to draw, clamped to the levels of the mesh; 0 for full detail.
+		 */
+		void Render(size_t NumberInstance, size_t BaseInstance = 0, uint32_t LOD = 0) const;
+
+		/**
+		 * Draws the mesh without activating its material, with whatever program is current (e.g. a depth-only pass).
+		 * @param NumberInstance The number of instances to render.
+		 * @param BaseInstance Index of the first instance to read from the bound instance buffer.
+		 * @param LOD The level of detail to draw, clamped to the levels of the mesh; 0 for full detail.
+		 */
+		void Draw(size_t NumberInstance, size_t BaseInstance = 0, uint32_t LOD = 0) const;
+
+		/**
+		 * Draws a mesh from its captured draw info without activating its material, like Draw() does.
+		 * @param Info The level to draw, see GetDrawInfo().
+		 * @param NumberInstance The number of instances to render.
+		 * @param BaseInstance Index of the first instance to read from the bound instance buffer.
 		 */
-		void Render(size_t NumberInstance) const;
+		static void Draw(const MeshDrawInfo& Info, size_t NumberInstance, size_t BaseInstance = 0);
+
+		/**
+		 * Captures what drawing a level of the mesh reads. Only valid after the first pass, and until the mesh
+		 * is uploaded again or given another material.
+		 * @param LOD The level of detail, clamped to the levels of the mesh; 0 for full detail.
+		 * @return The draw info of the level.
+		 */
+		MeshDrawInfo GetDrawInfo(uint32_t LOD = 0) const;
+
+		/**
+		 * Builds the indirect command drawing this mesh, for submission with glMultiDrawElementsIndirect.
+		 * The mesh VAO must be bound when the command is drawn, and its material activated. Meshes of
+		 * the same vertex format share their VAO, so their commands can be drawn together.
+		 * @param NumberInstance The number of instances to render.
+		 * @param BaseInstance Index of the first instance to read from the instance buffer.
+		 * @param LOD The level of detail to draw, clamped to the levels of the mesh; 0 for full detail.
+		 * @return The command drawing every index of the level.
+		 */
+		DrawElementsIndirectCommand GetDrawCommand(size_t NumberInstance, size_t BaseInstance, uint32_t LOD = 0) const;
+
+		/**
+		 * Adds a simplified level of detail, e.g. from SimplifyMesh(). Must be called before the first pass.
+		 * Levels are added from the most to the least detailed, with decreasing screen sizes. When the mesh
+		 * was deduplicated, the level takes part in its content hash, so its mesh ID is looked up again.
+		 * @param Indices Triangle list of the level, indexing the vertices of the mesh.
+		 * @param ScreenSize Projected size below which the level is drawn.
+		 */
+		void AddLOD(std::vector<unsigned int>&& Indices, float ScreenSize);
+
+		/** @return The number of levels of detail of the mesh, the full-detail level included. */
+		uint32_t GetLODCount() const;
+
+		/** @return The simplified levels of detail, level 1 first. */
+		const std::vector<MeshLOD>& GetLODs() const;
+
+		/**
+		 * Splits the full-detail triangles into meshlets (see BuildMeshlets()), letting the renderer skip the
+		 * clusters outside the view frustum or facing away from the camera. The indices are left untouched.
+		 * @param MaxVertices Largest number of distinct vertices per cluster.
+		 * @param MaxTriangles Largest number of triangles per cluster.
+		 */
+		void BuildMeshlets(size_t MaxVertices = 64, size_t MaxTriangles = 124);
+
+		/** @return The meshlets of the full-detail level, empty unless BuildMeshlets() was called. */
+		const std::vector<Meshlet>& GetMeshlets() const;
+
+		/**
+		 * Builds the indirect command drawing a run of consecutive meshlets, whose indices are contiguous.
+		 * @param FirstMeshlet Index of the first meshlet of the run.
+		 * @param MeshletCount Number of meshlets of the run.
+		 * @param NumberInstance The number of instances to render.
+		 * @param BaseInstance Index of the first instance to read from the instance buffer.
+		 * @return The command drawing the triangles of the run.
+		 */
+		DrawElementsIndirectCommand GetMeshletDrawCommand(uint32_t FirstMeshlet, uint32_t MeshletCount, size_t NumberInstance, size_t BaseInstance) const;
+
+		/** @return The arena VAO the mesh is drawn with, 0 before the first pass. */
+		GLuint GetVertexArray() const;
+
+		/** @return The type of the mesh indices on the GPU, GL_UNSIGNED_SHORT when it has at most 65,535 vertices. */
+		GLenum GetIndexType() const;
+
+		/**
+		 * Selects the layout the mesh is stored with on the GPU. Must be called before the first pass.
+		 * VertexFormat::Packed halves the vertex size at the cost of half-float position precision,
+		 * VertexFormat::Skinned adds the bones set with SetSkin(), VertexFormat::Lightmapped the coordinates set
+		 * with SetLightmapCoords().
+		 * @param Format The vertex layout to upload the mesh with.
+		 */
+		void SetVertexFormat(VertexFormat Format);
+
+		/** @return The layout the mesh is stored with on the GPU. */
+		VertexFormat GetVertexFormat() const;
+
+		/**
+		 * Sets the bones influencing each vertex, uploaded with VertexFormat::Skinned. Must be called before
+		 * the first pass; the skin takes part in the content hash.
+		 * @param Skin One entry per vertex, in vertex order.
+		 */
+		void SetSkin(std::vector<VertexSkin>&& Skin);
+
+		/** @return The bones influencing each vertex, empty if the mesh isn't skinned. */
+		const std::vector<VertexSkin>& GetSkin() const;
+
+		/**
+		 * Sets the second UV set, which addresses the lightmap, uploaded with VertexFormat::Lightmapped. Must be
+		 * called before the first pass; the coordinates take part in the content hash.
+		 * @param LightmapCoords One entry per vertex, in vertex order, in [0, 1].
+		 */
+		void SetLightmapCoords(std::vector<glm::vec2>&& LightmapCoords);
+
+		/** @return The lightmap coordinates of each vertex, empty if the mesh isn't lightmapped. */
+		const std::vector<glm::vec2>& GetLightmapCoords() const;
 
 		/**
 		 * Sets the material for this mesh.
@@ -72,40 +309,88 @@ namespace fgl
 		const std::shared_ptr<Material> GetMaterial() const;
 
 		/**
-		 * Gets the textures associated with the mesh.
-		 * @return A reference to the vector of textures.
+		 * @return A counter bumped whenever any mesh is given a material or uploaded to an arena, so draw data
+		 * grouped by material and vertex array (see Model::Render()) knows when to be rebuilt. Never 0.
 		 */
-		std::vector<Texture>& GetTextures();
+		static uint32_t GetDrawRevision();
 
-	private:
 		/**
-		 * Initializes the vertex buffers (VAO, VBO, EBO).
+		 * Bumps the draw revision after GeometryArena::Compact() moved allocations, so the draw data built from
+		 * the previous offsets is rebuilt.
 		 */
-		void InitializeBuffers();
+		static void OnGeometryMoved();
+
+		/** @return The object-space bounding box of the mesh, computed at construction. */
+		const BoundingBox& GetBoundingBox() const;
+
+		/** @return The object-space bounding sphere of the mesh, computed at construction. */
+		const BoundingSphere& GetBoundingSphere() const;
 
 		/**
-		 * Configures the vertex attributes for the mesh (e.g., position, normal, texture coordinates).
+		 * Gets the textures associated with the mesh.
+		 * @return A reference to the vector of textures.
 		 */
-		void ConfigureVertexAttributes();
+		std::vector<Texture>& GetTextures();
+
+		/** @return The CPU copy of the mesh vertices, empty once released (see HasCPUGeometry()). */
+		const std::vector<Vertex>& GetVertices() const;
+
+		/** @return The CPU copy of the mesh indices, empty once released unless kept for collision. */
+		const std::vector<unsigned int>& GetIndices() const;
+
+	private:
+		/** @return Where the mesh geometry currently is in m_Arena, empty before the first pass. */
+		const GeometryAllocation& GetAllocation() const;
 
 		/**
-		 * Configures the vertex attributes for instancing (e.g., model matrices).
+		 * Checks whether the RenderDevice draws from a base instance, see RenderDevice::SupportsBaseInstance().
+		 * The result is queried once, on the first call, after the loader has been initialized.
+		 * @return True if the base instance can be passed to the draw call directly.
 		 */
-		void ConfigureVertexAttributesInstances();
+		static bool SupportsBaseInstance();
 
 		/**
-		 * Computes a hash for the mesh based on its vertices and indices.
+		 * Locates the indices of a level of detail inside the mesh allocation.
+		 * @param LOD The level, clamped to the levels of the mesh.
+		 * @param FirstIndex Receives the offset of the level's first index in the arena index buffer.
+		 * @param IndexCount Receives the number of indices of the level.
 		 */
-		void ComputeHash();
+		void GetLODRange(uint32_t LOD, uint32_t& FirstIndex, uint32_t& IndexCount) const;
+
+		/** Frees what the mesh's policy doesn't keep of the geometry once uploaded. */
+		void ReleaseCPUGeometry();
+
+		/** Charges the capacity of the CPU geometry to MemoryTag::Meshes, after it changed. */
+		void UpdateCPUMemory();
 
 	private:
 		std::vector<Vertex>		    m_Vertices; ///< Vertices of the mesh.
 		std::vector<unsigned int>   m_Indices;  ///< Indices of the mesh.
+		std::vector<VertexSkin>     m_Skin;     ///< Bones of each vertex, empty if not skinned.
+		std::vector<glm::vec2>      m_LightmapCoords; ///< Second UV set of each vertex, empty if not lightmapped.
+		std::vector<MeshLOD>        m_LODs;     ///< Simplified levels of detail, most detailed first.
+		std::vector<Meshlet>        m_Meshlets; ///< Clusters of the full-detail triangles, in index order.
 		std::vector<Texture>		m_Textures; ///< Textures associated with the mesh.
 		std::shared_ptr<Material>   m_Material; ///< Material applied to the mesh.
-		size_t m_MeshHash;						///< Hash value for the mesh.
+		uint64_t m_ContentHash = 0;				///< Hash of the mesh content, 0 when not computed.
+		uint32_t m_MeshID = 0;					///< Batching identity of the mesh, shared by meshes of equal content hash.
+		BoundingBox m_BoundingBox;				///< Object-space bounds of m_Vertices.
+		BoundingSphere m_BoundingSphere;		///< Object-space bounding sphere of m_Vertices.
+		bool m_HasInstanceAttributes = false;	///< True once the second pass configured the instance attributes.
+		VertexFormat m_VertexFormat = VertexFormat::Standard; ///< GPU layout of the vertices.
+
+		GeometryArena* m_Arena = nullptr;		///< Arena holding the mesh geometry, set by the first pass.
+		std::shared_ptr<GeometryLease> m_Geometry;	///< Lease of the mesh geometry inside m_Arena, freed with its last mesh.
+
+		CPUGeometryPolicy m_CPUGeometryPolicy = CPUGeometryPolicy::Default; ///< What the first pass keeps in system memory.
+		bool m_bCPUGeometryReleased = false;	///< True once m_Vertices was freed.
+		uint32_t m_VertexCount = 0;				///< Number of vertices, set by the first pass.
+		uint32_t m_IndexCount = 0;				///< Number of full-detail indices, set by the first pass.
+		std::vector<glm::vec3> m_CollisionPositions; ///< Positions kept by CPUGeometryPolicy::Collision.
+		MemoryCharge m_CPUMemory{ MemoryTag::Meshes }; ///< Bytes of the CPU geometry, counted by the MemoryTracker.
 
-		GLuint VAO, VBO, EBO;				    ///< OpenGL buffers (Vertex Array, Vertex Buffer, Element Buffer).
+		static CPUGeometryPolicy s_DefaultCPUGeometryPolicy; ///< Policy of the meshes using CPUGeometryPolicy::Default.
+		static std::atomic<uint32_t> s_DrawRevision;         ///< See GetDrawRevision().
 	};
 
 } // namespace fgl
\ No newline at end of file
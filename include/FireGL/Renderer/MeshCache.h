@@ -0,0 +1,118 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+#include <FireGL/Renderer/Vertex.h>
+
+#include <span>
+
+namespace fgl
+{
+	class BaseMesh;
+
+	/**
+	 * A texture referenced by a cached mesh, as found in the source asset.
+	 */
+	struct MeshCacheTexture
+	{
+		std::string TypeName; ///< Semantic type of the texture (e.g. "texture_diffuse").
+		std::string Path;     ///< Path of the texture relative to the model directory.
+	};
+
+	/**
+	 * One submesh read back from a mesh cache file.
+	 */
+	struct MeshCacheEntry
+	{
+		std::vector<Vertex> Vertices;           ///< Vertices of the submesh, after import optimizations.
+		std::vector<unsigned int> Indices;      ///< Indices of the submesh.
+		std::vector<MeshCacheTexture> Textures; ///< Textures of the submesh.
+		std::vector<std::vector<unsigned int>> LODIndices; ///< Indices of the simplified levels of detail, level 1 first.
+		uint64_t ContentHash = 0;               ///< Content hash computed at import (see BaseMesh::GetContentHash()), 0 if the submesh isn't hashed.
+	};
+
+	/**
+	 * Versioned binary cache of imported model geometry, letting later loads skip Assimp.
+	 *
+	 * A cache file stores, for every submesh, the vertex and index blobs, the index blobs of its levels
+	 * of detail, the content hash and the texture references. It also records the size and modification time of the source asset and a
+	 * key of the import settings that change the geometry: a cache that doesn't match the asset, the
+	 * settings or the format version is ignored and rewritten. Files are read through a memory mapping, or from
+	 * a mounted AssetArchive.
+	 *
+	 * Cooked caches (see AssetCooker) record no source stamp: they are used when the source asset isn't shipped,
+	 * and ignored like stale ones when it is present.
+	 *
+	 * Layout (native endianness): a header {Magic, Version, SettingsKey, MeshCount, SourceSize, SourceTime},
+	 * then per submesh {ContentHash, VertexCount, IndexCount, TextureCount, LODCount}, the texture strings as
+	 * {Length, Bytes} pairs and one index count per level of detail, and finally the raw vertex and index
+	 * arrays, each followed by the index arrays of its levels.
+	 */
+	class MeshCache
+	{
+	public:
+		static constexpr uint32_t Magic = 0x434D4746; ///< "FGMC", identifies a FireGL mesh cache.
+		static constexpr uint32_t Version = 3;        ///< Bumped whenever the layout or the Vertex struct changes.
+		static constexpr const char* Extension = ".fglmesh"; ///< Appended to the source file name.
+
+		/**
+		 * Builds the cache file path of a source asset.
+		 *
+		 * @param SourcePath The path of the source asset.
+		 * @param CacheDirectory Directory holding the cache files; empty to store them next to the asset.
+		 * @return The path of the cache file.
+		 */
+		static std::string GetCachePath(std::string_view SourcePath, std::string_view CacheDirectory);
+
+		/**
+		 * Reads a cache file if it is valid for the given source asset and settings.
+		 *
+		 * @param CachePath The cache file to read.
+		 * @param SourcePath The source asset the cache was built from.
+		 * @param SettingsKey Key of the import settings the geometry was produced with.
+		 * @param Meshes Receives the cached submeshes.
+		 * @return True if the cache was valid and fully read.
+		 */
+		static bool Load(std::string_view CachePath, std::string_view SourcePath, uint32_t SettingsKey, std::vector<MeshCacheEntry>& Meshes);
+
+		/**
+		 * Writes the submeshes of an imported model to a cache file.
+		 *
+		 * @param CachePath The cache file to write.
+		 * @param SourcePath The source asset the meshes were imported from.
+		 * @param SettingsKey Key of the import settings the geometry was produced with.
+		 * @param Meshes The imported submeshes, textures included.
+		 * @param bCooked True to write a cooked cache, which is read without its source asset.
+		 * @return True if the file was written.
+		 */
+		static bool Save(std::string_view CachePath, std::string_view SourcePath, uint32_t SettingsKey, std::span<BaseMesh> Meshes, bool bCooked = false);
+
+	private:
+		/** Fixed-size start of a cache file. */
+		struct Header
+		{
+			uint32_t Magic;
+			uint32_t Version;
+			uint32_t SettingsKey;
+			uint32_t MeshCount;
+			uint64_t SourceSize;
+			int64_t SourceTime;
+		};
+
+		/** Fixed-size description of one submesh. */
+		struct MeshHeader
+		{
+			uint64_t ContentHash;
+			uint32_t VertexCount;
+			uint32_t IndexCount;
+			uint32_t TextureCount;
+			uint32_t LODCount;
+		};
+
+		/**
+		 * Queries the size and modification time of the source asset.
+		 * @return False if the source asset doesn't exist.
+		 */
+		static bool GetSourceStamp(std::string_view SourcePath, uint64_t& Size, int64_t& Time);
+	};
+
+} // namespace fgl
\ No newline at end of file
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+#include <FireGL/Renderer/Vertex.h>
+#include <FireGL/Renderer/BoundingVolume.h>
+
+namespace fgl
+{
+
+	/**
+	 * A cluster of consecutive triangles of a mesh, culled on its own (see BuildMeshlets()).
+	 *
+	 * The normal cone bounds the directions its triangles face: seen from a point P, every triangle faces
+	 * away when dot(normalize(ConeApex - P), ConeAxis) >= ConeCutoff.
+	 */
+	struct Meshlet
+	{
+		uint32_t FirstIndex = 0;     ///< Offset of the cluster's first index in the mesh index list.
+		uint32_t TriangleCount = 0;  ///< Number of triangles of the cluster.
+		uint32_t VertexCount = 0;    ///< Number of distinct vertices the triangles reference.
+		BoundingSphere Bounds;       ///< Object-space sphere enclosing the triangles.
+		glm::vec3 ConeApex = glm::vec3(0.0f); ///< Point behind every triangle plane, on the cone axis.
+		glm::vec3 ConeAxis = glm::vec3(0.0f); ///< Average direction of the triangle normals.
+		float ConeCutoff = 2.0f;     ///< Sine of the largest angle between a normal and the axis, 2 when the cone is too wide to cull.
+	};
+
+	/**
+	 * Reorders triangles to reduce overdraw while keeping most of their vertex cache locality.
+	 *
+	 * The index list (ideally already ordered for the post-transform cache) is split into clusters of
+	 * consecutive triangles, and the clusters are sorted so the ones facing away from the mesh center
+	 * come first: those tend to be drawn in front and occlude what follows (Sander et al., "Fast
+	 * Triangle Reordering for Vertex Locality and Reduced Overdraw"). Triangles keep their order
+	 * inside a cluster, so the cache is only disrupted at cluster boundaries.
+	 *
+	 * @param Vertices The vertices referenced by the indices.
+	 * @param Indices Triangle list to reorder in place.
+	 * @param ClusterSize Number of triangles per cluster.
+	 */
+	void OptimizeOverdraw(const std::vector<Vertex>& Vertices, std::vector<unsigned int>& Indices, size_t ClusterSize = 64);
+
+	/**
+	 * Reorders vertices in the order the index list first references them, and remaps the indices.
+	 * Vertex fetches then walk memory linearly. Unreferenced vertices are dropped.
+	 *
+	 * @param Vertices Vertices to reorder in place.
+	 * @param Indices Triangle list to remap in place.
+	 */
+	void OptimizeVertexFetch(std::vector<Vertex>& Vertices, std::vector<unsigned int>& Indices);
+
+	/**
+	 * Reduces the triangle count of a mesh with quadric error edge collapses (Garland and Heckbert,
+	 * "Surface Simplification Using Quadric Error Metrics").
+	 *
+	 * Vertices are collapsed onto existing vertices, so the result indexes the same vertex list and can
+	 * share its vertex buffer with the full-detail mesh. Vertices sharing a position are collapsed
+	 * together, keeping the attributes of the closest vertex at the target; open borders and attribute
+	 * seams are constrained so they stay in place. Collapses flipping a triangle are rejected.
+	 *
+	 * @param Vertices The vertices referenced by the indices.
+	 * @param Indices The triangle list to simplify.
+	 * @param TargetIndexCount Number of indices to reduce the list to.
+	 * @param MaxError Largest distance a collapse may move the surface by, relative to the mesh radius.
+	 * @return The simplified triangle list, larger than TargetIndexCount if the error bound was reached first.
+	 */
+	std::vector<unsigned int> SimplifyMesh(const std::vector<Vertex>& Vertices, const std::vector<unsigned int>& Indices,
+		size_t TargetIndexCount, float MaxError);
+
+	/**
+	 * Splits a triangle list into meshlets: runs of consecutive triangles referencing at most MaxVertices
+	 * distinct vertices and MaxTriangles triangles, each with a bounding sphere and a normal cone.
+	 *
+	 * Clusters keep the index order, so each one is a contiguous index range the mesh can draw as is and
+	 * runs of surviving clusters merge into one draw. Spatially compact clusters, which cull best, come from
+	 * an index list ordered for the vertex cache (see ModelImportSettings::bOptimizeVertexCache).
+	 *
+	 * @param Vertices The vertices referenced by the indices.
+	 * @param Indices The triangle list to split.
+	 * @param MaxVertices Largest number of distinct vertices per cluster.
+	 * @param MaxTriangles Largest number of triangles per cluster.
+	 * @return The clusters, covering every triangle in index order.
+	 */
+	std::vector<Meshlet> BuildMeshlets(const std::vector<Vertex>& Vertices, const std::vector<unsigned int>& Indices,
+		size_t MaxVertices = 64, size_t MaxTriangles = 124);
+
+} // namespace fgl
\ No newline at end of file
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+#include <FireGL/Renderer/Shader.h>
+
+#include <External/glad/glad.h>
+
+namespace fgl
+{
+
+	/**
+	 * Generates the mip chain of textures created at runtime with a compute shader (OpenGL 4.3+).
+	 *
+	 * Each level is a box filter of the level above, odd sizes folding their last row and column into the
+	 * last texel so no texel is left out, read and written through image load / store. Only immutable
+	 * 2D textures and 2D arrays of an image format (RGBA8, RGBA16F, RGBA32F and their one and two channel
+	 * variants) can be bound as images: anything else falls back to glGenerateMipmap, whose implementation
+	 * is up to the driver and may run on the CPU.
+	 *
+	 * One program per format and target is compiled on first use. Must run on the thread owning the
+	 * OpenGL context; Destroy() deletes the programs.
+	 */
+	class MipGenerator
+	{
+	public:
+		/** @return True if the context supports compute shaders and image load / store (OpenGL 4.3). */
+		static bool IsSupported();
+
+		/**
+		 * Fills the levels of a texture from its level 0, then leaves the texture bound to Target on the active unit.
+		 *
+		 * @param Texture The texture, with its storage allocated for every level.
+		 * @param Target GL_TEXTURE_2D, GL_TEXTURE_2D_ARRAY or GL_TEXTURE_CUBE_MAP.
+		 */
+		static void Generate(GLuint Texture, GLenum Target);
+
+		/** Deletes the programs. */
+		static void Destroy();
+
+	private:
+		/** @return The GLSL image format qualifier of an internal format, nullptr if it can't be bound as an image. */
+		static const char* GetImageFormat(GLenum InternalFormat);
+
+		/** @return The program downsampling a format, compiled on first use. */
+		static Shader& GetProgram(GLenum InternalFormat, bool bArray);
+
+		static std::unordered_map<uint64_t, std::unique_ptr<Shader>> s_Programs; ///< Programs by format and target.
+	};
+
+} // namespace fgl
@@ -2,11 +2,16 @@
 
 #include <FireGL/fglpch.h>
 #include <FireGL/Core/BaseLog.h>
+#include <FireGL/Core/MemoryTracker.h>
 #include <FireGL/Renderer/SceneObject.h>
 #include <FireGL/Renderer/Mesh.h>
+#include <FireGL/Renderer/IndirectDrawBuffer.h>
 #include <FireGL/Renderer/Vertex.h>
 #include <FireGL/Renderer/Texture.h>
 #include <FireGL/Renderer/Shader.h>
+#include <FireGL/Renderer/MeshCache.h>
+#include <FireGL/Renderer/Skeleton.h>
+#include <FireGL/Renderer/AnimationClip.h>
 
 #include <External/assimp/Importer.hpp>
 #include <External/assimp/scene.h>
@@ -17,6 +22,116 @@ namespace fgl
 	class Material;
 	class Transform;
 	class BaseMesh;
+	class JobSystem;
+
+	/**
+	 * Options controlling how a Model is imported.
+	 * The optimizations are paid once at import time and make every later draw cheaper; they are
+	 * off by default because they slow down loading.
+	 */
+	struct ModelImportSettings
+	{
+		VertexFormat Format = VertexFormat::Standard; ///< GPU vertex layout of the loaded meshes (Packed: 16 bytes per vertex instead of 32, Skinned: imports bones and animations, Lightmapped: imports the second UV set).
+		bool bOptimizeVertexCache = false;            ///< Joins identical vertices and reorders triangles for the post-transform vertex cache.
+		bool bOptimizeOverdraw = false;               ///< Reorders triangle clusters so outward-facing ones are drawn first.
+		bool bOptimizeVertexFetch = false;            ///< Reorders vertices in first-use order so vertex fetch reads memory linearly.
+		bool bUseMeshCache = true;                    ///< Loads from (and writes) a binary MeshCache file instead of parsing the asset every time.
+		std::string CacheDirectory;                   ///< Directory of the mesh cache files, next to the asset when empty.
+		bool bDeferTextureUploads = false;            ///< Only decodes textures while loading; they are created later by UploadPendingTexture() (set by ModelLoader).
+		bool bShareResources = true;                  ///< Shares the meshes and textures of models already loaded from the same path with the same settings.
+		bool bDeduplicateMeshes = true;               ///< Hashes imported meshes so identical geometry loaded separately shares its mesh IDs, and so its batches.
+		uint32_t LODCount = 1;                        ///< Levels of detail per mesh, the full mesh included; the others are simplified with SimplifyMesh().
+		float LODTriangleRatio = 0.5f;                ///< Triangles each level keeps from the previous one.
+		float LODMaxError = 0.02f;                    ///< Largest surface deviation a level may introduce, relative to the mesh radius.
+		float LODScreenSize = 0.25f;                  ///< Projected size below which the first simplified level is drawn, the next ones scale with the triangle ratio.
+		bool bBuildMeshlets = false;                  ///< Splits high-poly meshes into meshlets the renderer culls one by one (see BaseMesh::BuildMeshlets()).
+		uint32_t MeshletMinTriangles = 16384;         ///< Triangle count from which a mesh is split into meshlets.
+		CPUGeometryPolicy CPUGeometry = CPUGeometryPolicy::Default; ///< What the meshes keep in system memory once uploaded, see BaseMesh::SetCPUGeometryPolicy().
+		JobSystem* Jobs = nullptr;                    ///< Job system the submeshes of an imported file are processed on, nullptr for the loading thread; must outlive the load.
+
+		/** @return A key of the settings that change the imported geometry, stored in mesh cache files. */
+		uint32_t GetGeometryKey() const;
+
+		/**
+		 * @param Level A simplified level of detail, from 1.
+		 * @return The projected size below which the level is drawn.
+		 */
+		float GetLODScreenSize(uint32_t Level) const;
+	};
+
+	/**
+	 * Converts Assimp vertex data into a vector of custom Vertex structures, sized once and filled one
+	 * attribute at a time. Missing normals or texture coordinates are left at zero.
+	 */
+	std::vector<Vertex> ProcessMeshVertices(const aiMesh& Mesh);
+
+	/** Extracts the index data used to define the faces of an Assimp mesh, in a single pre-sized pass. */
+	std::vector<unsigned int> ProcessMeshIndices(const aiMesh& Mesh);
+
+	/**
+	 * Geometry and textures loaded from one model file, shared by every Model created from it.
+	 *
+	 * Resources are immutable once loaded, apart from the texture IDs filled in by the pending uploads.
+	 * The last Model releasing a resource frees its textures, which must happen on the thread owning the
+	 * OpenGL context.
+	 */
+	struct ModelResource
+	{
+		/** A texture referenced by the meshes whose OpenGL texture isn't created yet. */
+		struct PendingTexture
+		{
+			Symbol Path;          ///< Path relative to the model, as referenced by the meshes.
+			std::string FilePath; ///< Path of the image file.
+			size_t Key;           ///< TextureCache key of the image.
+			ImageData Image;      ///< Filled in by Model::DecodePendingTextures().
+		};
+
+		/** A texture whose pixels are being uploaded by the GLUploadThread. */
+		struct UploadingTexture
+		{
+			Symbol Path;          ///< Path relative to the model, as referenced by the meshes.
+			size_t Key;           ///< TextureCache key of the image.
+			Texture Uploaded;     ///< Owns the ID until the upload completed and the TextureCache took it over.
+			uint64_t Ticket;      ///< Returned by Texture::UploadImageAsync().
+		};
+
+		/** Meshes of one material, vertex array and index type, drawn by one glMultiDrawElementsIndirect of Model::Render(). */
+		struct DrawGroup
+		{
+			Material* GroupMaterial = nullptr;    ///< Material of the meshes, activated once for the group; nullptr if none.
+			GLuint VertexArray = 0;               ///< Arena VAO of the meshes.
+			GLenum IndexType = GL_UNSIGNED_INT;   ///< Type of the indices of the meshes.
+			uint32_t FirstCommand = 0;            ///< First entry of the group in DrawOrder, and its first command.
+			uint32_t CommandCount = 0;            ///< Meshes of the group.
+		};
+
+		ModelResource() = default;
+
+		/** Releases the references held in the TextureCache and deletes the draw commands. */
+		~ModelResource();
+
+		ModelResource(const ModelResource&) = delete;
+		ModelResource& operator=(const ModelResource&) = delete;
+
+		TaggedVector<BaseMesh, MemoryTag::Models> Meshes;   ///< A collection of meshes that make up the model.
+		uint32_t MeshSetID = 0;                             ///< Batching identity of the whole set of meshes.
+		std::string Path;                                   ///< Path of the imported model file.
+		std::string Directory;                              ///< Directory containing the path to the imported model.
+		TaggedUnorderedMap<size_t, Texture, MemoryTag::Models> CachedTextures; ///< Views of the model's textures by TextureCache key, each holding one cache reference once uploaded.
+		TaggedVector<PendingTexture, MemoryTag::Models> PendingTextures;        ///< Textures whose OpenGL texture isn't created yet.
+		TaggedVector<UploadingTexture, MemoryTag::Models> UploadingTextures;    ///< Textures uploaded in the background, in submission order.
+		std::shared_ptr<Skeleton> ModelSkeleton;            ///< Bones of the meshes, only imported with VertexFormat::Skinned.
+		TaggedVector<AnimationClip, MemoryTag::Models> Animations; ///< Animations of ModelSkeleton.
+
+		// Grouped draws of Model::Render(), used on the thread owning the OpenGL context only
+		std::vector<uint32_t> DrawOrder;                    ///< Mesh indices, the meshes of each group adjacent.
+		std::vector<DrawGroup> DrawGroups;                  ///< Groups of DrawOrder.
+		uint32_t DrawRevision = 0;                          ///< BaseMesh::GetDrawRevision() the groups were built at, 0 before.
+		IndirectDrawBuffer DrawCommands;                    ///< Command of each mesh in DrawOrder, for the instances below.
+		size_t CommandInstanceCount = 0;                    ///< Instance count of the uploaded commands.
+		size_t CommandBaseInstance = 0;                     ///< Base instance of the uploaded commands.
+		uint32_t CommandLOD = 0;                            ///< Level of detail of the uploaded commands.
+	};
 
 	/**
 	 * Model Importer Class
@@ -31,6 +146,8 @@ namespace fgl
 	 * - Importing models can be slow, taking 5 to 50 seconds depending on model size (5 MB = ~5s, 25 MB = ~50s).
 	 * - Ensure that the model's object file (.obj, .fbx, etc.) is in the same directory as its textures for proper loading.
 	 * - While this class can be rendered directly, creating an entity for it is recommended for additional flexibility.
+	 * - Models loaded from the same path share one ModelResource (see ModelImportSettings::bShareResources): the file
+	 *   is parsed once and only the Transform is owned per object. Their meshes, and so their materials, are shared too.
 	 */
 	class Model : public SceneObject
 	{
@@ -38,9 +155,11 @@ namespace fgl
 		/**
 		  * Constructs a Model object and initiates loading from the specified file path.
 		  *
-		  * @param Path The file path of the model to load.
+		  * @param Path The file path of the model to load, or of a MeshCache cooked by the AssetCooker (ending with MeshCache::Extension),
+		  *             loaded without its source asset.
+		  * @param Settings Vertex layout and import optimizations applied to the loaded meshes; a cooked cache needs the geometry settings it was cooked with.
 		  */
-		Model(std::string_view Path);
+		Model(std::string_view Path, const ModelImportSettings& Settings = ModelImportSettings());
 
 		/**
 		 * Sets up the material for the model using the provided shader.
@@ -60,8 +179,13 @@ namespace fgl
 		/**
 		 * Renders the model.
 		 * This function binds the necessary resources and draws the model meshes to the screen.
+		 *
+		 * Submeshes are grouped by material, vertex array and index type once uploaded, and regrouped after any
+		 * mesh is given another material. With OpenGL 4.3 each group activates its material once and draws its
+		 * meshes with one glMultiDrawElementsIndirect, whose commands are only uploaded again when the instances
+		 * or the level of detail change; otherwise every mesh is drawn on its own.
 		 */
-		virtual void Render(size_t NumberInstance) const override final;
+		virtual void Render(size_t NumberInstance, size_t BaseInstance = 0, uint32_t LOD = 0) const override final;
 
 		/**
 		 * The following functions are unused in this context as this class is an importer
@@ -71,9 +195,16 @@ namespace fgl
 		virtual void BeginPlay() override final;
 		virtual void Destroy() override final;
 
+		/** Tick() is empty, so models can always be ticked in parallel. */
+		virtual bool IsTickThreadSafe() const override final;
+
+		/** Tick() is empty, so models are never registered with the TickScheduler. */
+		virtual bool WantsTick() const override final;
+
 		/**
 		 * Sets the material for the model, replacing the current material.
 		 * This will override the model's attached textures, so use with caution.
+		 * The meshes are shared by every Model of the same resource, which all receive the material.
 		 *
 		 * @param Material A shared pointer to the new material to be assigned to the model.
 		 */
@@ -92,60 +223,148 @@ namespace fgl
 		/**
 		 * Retrieves the meshes that make up the model.
 		 *
-		 * @return A reference to the vector of meshes.
+		 * @return A span over the meshes of the model's resource.
 		 */
-		virtual std::vector<BaseMesh>& GetMeshes() override;
+		virtual std::span<BaseMesh> GetMeshes() override;
+
+		/** @return A read-only span over the meshes of the model's resource. */
+		virtual std::span<const BaseMesh> GetMeshes() const override;
 
 		/**
-		 * Retrieves the hash used for batching the model's vertex objects.
-		 * The hash is calculated based on the vertex data and is used to group together
-		 * identical vertex objects for efficient instanced rendering.
+		 * Retrieves the identity used for batching the model.
+		 * Every submesh takes part: models only share it when all of their mesh IDs are equal.
 		 *
-		 * @return The hash value used for batching the model's vertex objects.
+		 * @return The mesh set ID of the model's resource.
 		 */
 		virtual size_t GetHash() const override;
 
+		/**
+		 * Retrieves the bones the meshes are skinned to, imported with VertexFormat::Skinned.
+		 * Animated instances allocate Skeleton::GetBoneCount() bones in the renderer's BonePaletteBuffer and
+		 * pass the offset to SetBoneOffset().
+		 *
+		 * @return The skeleton, nullptr if the model isn't skinned.
+		 */
+		const Skeleton* GetSkeleton() const;
+
+		/** @return The animations of the skeleton, empty if the model isn't skinned. */
+		std::span<const AnimationClip> GetAnimations() const;
+
+		/**
+		 * Reads the geometry the meshes released after their upload (see ModelImportSettings::CPUGeometry) back
+		 * from the model's MeshCache file, e.g. before merging it into StaticGeometry. Shared by every Model of the resource.
+		 *
+		 * @return False if the model has no valid cache file, which happens with bUseMeshCache off or Skinned and Lightmapped formats.
+		 */
+		bool RestoreCPUGeometry();
+
+		/** @return True if decoded textures still have to be uploaded (only after loading with bDeferTextureUploads). */
+		bool HasPendingTextureUploads() const;
+
+		/**
+		 * Creates the OpenGL texture of one decoded image and hands its ID to every mesh using it.
+		 * Must run on the thread owning the OpenGL context.
+		 *
+		 * While the window's upload thread runs (see BaseWindow::SetUploadThread()), every pending image is queued
+		 * to it at once instead, and the textures whose upload completed are handed to the meshes.
+		 *
+		 * @return False if nothing progressed: the remaining textures wait for the upload thread.
+		 */
+		bool UploadPendingTexture();
+
 	private:
 		/**
-		 * Loads the model from the specified file path using Assimp.
-		 * This function processes the scene root node.
+		 * Gets the resource loaded by another Model from the same path and settings.
+		 * @return The shared resource, or nullptr if none is alive.
+		 */
+		std::shared_ptr<ModelResource> FindSharedResource(const std::string& Key) const;
+
+		/** Makes the loaded resource available to the next Models created with the same key. */
+		void RegisterSharedResource(const std::string& Key) const;
+
+		/** @return The key identifying a resource, built from the canonical path and the settings changing the meshes. */
+		std::string GetResourceKey(std::string_view Path) const;
+
+		/**
+		 * Loads the model from the specified file path into a new resource.
+		 * Loads the geometry, then decodes every referenced texture in parallel.
 		 */
 		void LoadModel(std::string_view Path);
 
 		/**
-		 * Processes a node in the Assimp scene graph.
-		 * Recursively processes all child nodes and their meshes.
+		 * Loads the meshes and collects their texture paths.
+		 * The mesh cache is used when valid, otherwise the asset is imported with Assimp (processing the
+		 * scene root node) and the cache is written for the next load.
+		 */
+		void LoadGeometry(std::string_view Path);
+
+		/**
+		 * Imports the model with Assimp.
+		 * @return False if Assimp failed to read the file.
+		 */
+		bool ImportModel(std::string_view Path);
+
+		/** Builds the meshes from submeshes read back from a mesh cache file. */
+		void LoadCachedMeshes(std::vector<MeshCacheEntry>& Entries);
+
+		/**
+		 * Processes the meshes of the Assimp scene graph under a node.
+		 * The hierarchy is flattened first; the textures are then resolved in order on the calling thread and
+		 * the submeshes, independent of each other, are processed on the settings' job system when given.
+		 * The meshes keep the depth-first order of the hierarchy either way.
 		 */
 		void ProcessNode(aiNode* Node, const aiScene* Scene);
-		void ProcessNodeMesh(aiNode* Node, const aiScene* Scene);
-		void ProcessNodeChild(aiNode* Node, const aiScene* Scene);
+
+		/** Appends the meshes of a node, then those of its children, recursively. */
+		void CollectNodeMeshes(aiNode* Node, const aiScene* Scene, std::vector<aiMesh*>& OutMeshes) const;
 
 		/**
 		 * Processes a single mesh and converts it into a format suitable for rendering.
-		 * If the ComputeHash flag is false, the mesh will be hashed; otherwise, the hash will not be computed.
+		 * The mesh content is hashed when bDeduplicateMeshes is set. Only reads the model, so submeshes may
+		 * be processed in parallel.
 		 *
 		 * @param Mesh The Assimp mesh to be processed.
-		 * @param Scene The Assimp scene.
-		 * @param ComputeHash Flag to determine if the mesh should be hashed.
-		 *                   If true, the mesh will not be hashed; if false, the mesh will be hashed.
+		 * @param Textures The textures of the mesh, see ProcessTextures().
 		 * @return A BaseMesh containing the processed mesh data.
 		 */
-		inline BaseMesh ProcessMesh(aiMesh* Mesh, const aiScene* Scene, bool ComputeHash);
+		BaseMesh ProcessMesh(aiMesh* Mesh, std::vector<Texture>&& Textures) const;
+
+		/**
+		 * Adds the simplified levels of detail requested by the settings to a mesh.
+		 * Each level is simplified from the previous one; the chain stops early once the error bound
+		 * prevents any meaningful reduction.
+		 */
+		void GenerateLODs(BaseMesh& Mesh) const;
+
+		/**
+		 * Splits a mesh into meshlets when the settings ask for them and it has enough triangles.
+		 * Meshlets follow the index order, so they are rebuilt on load rather than stored in the mesh cache.
+		 */
+		void GenerateMeshlets(BaseMesh& Mesh) const;
+
+		/** Derives the mesh set ID of the resource from the IDs of its meshes. */
+		void ComputeMeshSetID();
+
+		/**
+		 * Groups the meshes of the resource by material, vertex array and index type, if a mesh changed since.
+		 * @return False while a mesh isn't uploaded, the meshes are then drawn one by one.
+		 */
+		bool UpdateDrawGroups() const;
 
 		/** Loads textures associated with the imported material. */
 		std::vector<Texture> LoadMaterialTextures(aiMaterial* Material,aiTextureType Type, std::string TypeName);
 
-		/** Converts Assimp vertex data into a vector of custom Vertex structures. */
-		std::vector<Vertex> ProcessVertices(aiMesh* Mesh);
-
 		/**
-		 * Creates a custom Vertex structure from a specific index in the mesh.
-		 * Extracts the position, normal, texture coordinates, and other vertex attributes.
+		 * Reads the bones influencing each vertex, keeping the four strongest (Assimp already limits them
+		 * with aiProcess_LimitBoneWeights) and quantizing their weights to bytes summing to 255.
 		 */
-		Vertex CreateVertex(aiMesh* Mesh, unsigned int Index);
+		std::vector<VertexSkin> ProcessSkin(aiMesh* Mesh) const;
 
-		/** Extracts the index data used to define the faces of the mesh. */
-		std::vector<unsigned int> ProcessIndices(aiMesh* Mesh);
+		/**
+		 * Reads the second UV set of the mesh, the lightmap coordinates, for VertexFormat::Lightmapped.
+		 * Meshes without one reuse their first set, which must then not overlap itself.
+		 */
+		std::vector<glm::vec2> ProcessLightmapCoords(aiMesh* Mesh) const;
 
 		/** Retrieves the textures associated with the mesh from the material. */
 		std::vector<Texture> ProcessTextures(aiMesh* Mesh, const aiScene* Scene);
@@ -156,9 +375,22 @@ namespace fgl
 		 */
 		void AddMaterialTextures(aiMaterial* Material, aiTextureType Type, std::string_view TypeName, std::vector<Texture>& Textures);
 		void AddTexture(aiMaterial* Material, aiTextureType Type, std::string_view TypeName, unsigned int Index, std::vector<Texture>& Textures);
-		bool IsTextureLoaded(const aiString& str);
-		Texture FindLoadedTexture(const aiString& str);
-		Texture LoadNewTexture(const aiString& str, std::string_view TypeName);
+		void AddTexture(std::string_view Path, std::string_view TypeName, std::vector<Texture>& Textures);
+		Texture LoadNewTexture(size_t Key, const std::string& FilePath, std::string_view Path, std::string_view TypeName);
+
+		/** Decodes the images of the pending textures on up to one thread per core, dropping the ones that fail. */
+		void DecodePendingTextures();
+
+		/**
+		 * Hands the textures whose background upload completed to the meshes, in submission order.
+		 *
+		 * @param bWait True to block until at least the oldest upload completed.
+		 * @return True if a texture was handed over.
+		 */
+		bool FinishUploadedTextures(bool bWait);
+
+		/** Gives a texture ID to the cached texture and every mesh texture with the given path. */
+		void AssignTextureID(size_t Key, Symbol Path, GLuint ID);
 		std::string GetTextureNumber(std::string_view Name, unsigned int& DiffuseNr, unsigned int& SpecularNr);
 		template<typename T>
 		void BindTexturesToMaterial(Shader* Shader, const std::shared_ptr<T>& LightingMat);
@@ -166,18 +398,9 @@ namespace fgl
 		void BindTexture(Shader* Shader, const std::shared_ptr<T>& LightingMat,
 			Texture& Texture, unsigned int& DiffuseNr, unsigned int& SpecularNr);
 
-		/**
-		 * Cleanup functions to manage resource deallocation.
-		 * Ensures that textures and cached data are properly cleaned up.
-		 */
-		void CleanupTextures();
-		void CleanupMeshTextures();
-		void CleanupCachedTextures();
-
 	private:
-		std::vector<BaseMesh> m_Meshes;			///< A collection of meshes that make up the model.
-		std::string m_Directory;				///< Directory containing the path to the imported model.
-		std::vector<Texture> m_CachedTextures;  ///< A cache of loaded textures to avoid duplicate loading.
+		std::shared_ptr<ModelResource> m_Resource; ///< Meshes and textures, shared with the Models of the same file.
+		ModelImportSettings m_Settings;			   ///< Vertex layout and optimizations applied to every loaded mesh.
 	};
 
 	/**
@@ -208,7 +431,7 @@ namespace fgl
 	{
 		unsigned int DiffuseNr = 1, SpecularNr = 1;
 
-		for (BaseMesh& Mesh : m_Meshes)
+		for (BaseMesh& Mesh : m_Resource->Meshes)
 		{
 			for (Texture& Texture : Mesh.GetTextures())
 			{
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+#include <FireGL/Renderer/Model.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace fgl
+{
+
+	/**
+	 * Progress of a model loaded through ModelLoader.
+	 */
+	enum class ModelLoadState
+	{
+		Loading,   ///< File I/O, Assimp import and image decoding are running on a worker thread.
+		Uploading, ///< Waiting for its textures to be uploaded by ModelLoader::ProcessUploads().
+		Ready,     ///< The model can be used; its meshes are uploaded by the renderer when first drawn.
+		Failed     ///< The model couldn't be imported.
+	};
+
+	/**
+	 * Handle to a model loading in the background, returned by ModelLoader::LoadAsync().
+	 */
+	class ModelLoadHandle
+	{
+	public:
+		/** @return The current progress of the load. */
+		ModelLoadState GetState() const;
+
+		/** @return True once the model can be used. */
+		bool IsReady() const;
+
+		/** @return The loaded model once ready, nullptr before or if the load failed. */
+		std::shared_ptr<Model> GetModel() const;
+
+	private:
+		friend class ModelLoader;
+
+		std::string m_Path;                                       ///< Path of the model file.
+		ModelImportSettings m_Settings;                           ///< Settings the model is imported with.
+		std::shared_ptr<Model> m_Model;                           ///< The model, owned by the worker until Uploading.
+		std::atomic<ModelLoadState> m_State{ ModelLoadState::Loading }; ///< Progress of the load.
+	};
+
+	/**
+	 * Loads models on a pool of worker threads, keeping the OpenGL work on the main thread.
+	 *
+	 * Workers run everything that doesn't need the OpenGL context: file I/O, the Assimp import (or the
+	 * mesh cache read), vertex conversion and texture decoding. The texture uploads are then performed
+	 * by ProcessUploads(), to be called once per frame from the thread owning the context, within a
+	 * time budget so streaming doesn't cause frame drops. Mesh geometry is uploaded by the Renderer when
+	 * the model is first drawn, see Renderer::SetUploadBudget().
+	 */
+	class ModelLoader
+	{
+	public:
+		/**
+		 * Starts the worker threads.
+		 *
+		 * @param WorkerCount Number of worker threads; 0 picks one less than the hardware thread count.
+		 */
+		ModelLoader(size_t WorkerCount = 0);
+
+		/** Stops the workers, waiting for the models being imported; queued loads are dropped. */
+		~ModelLoader();
+
+		ModelLoader(const ModelLoader&) = delete;
+		ModelLoader& operator=(const ModelLoader&) = delete;
+
+		/**
+		 * Queues a model for background loading.
+		 *
+		 * @param Path The file path of the model to load.
+		 * @param Settings Import settings; texture uploads are always deferred to ProcessUploads().
+		 * @return A handle to poll for completion.
+		 */
+		std::shared_ptr<ModelLoadHandle> LoadAsync(std::string_view Path, const ModelImportSettings& Settings = ModelImportSettings());
+
+		/**
+		 * Uploads the textures of imported models until the budget is spent. At least one texture is
+		 * uploaded per call so loading always progresses. Must run on the thread owning the OpenGL context.
+		 *
+		 * @param BudgetMilliseconds Time the uploads may take this frame.
+		 */
+		void ProcessUploads(float BudgetMilliseconds = 2.0f);
+
+		/** @return True if models are still loading or waiting for uploads. */
+		bool IsBusy() const;
+
+	private:
+		/** Imports queued models until the loader is destroyed. */
+		void WorkerLoop();
+
+	private:
+		std::vector<std::thread> m_Workers;                          ///< Worker threads.
+		mutable std::mutex m_Mutex;                                  ///< Guards m_Queue, m_Imported and m_bStopping.
+		std::condition_variable m_Condition;                         ///< Wakes workers when a load is queued.
+		std::deque<std::shared_ptr<ModelLoadHandle>> m_Queue;        ///< Loads not started yet.
+		std::vector<std::shared_ptr<ModelLoadHandle>> m_Imported;    ///< Imported by a worker, waiting for the main thread.
+		std::vector<std::shared_ptr<ModelLoadHandle>> m_Uploading;   ///< Being uploaded by ProcessUploads() (main thread only).
+		size_t m_ActiveLoads = 0;                                    ///< Loads currently running on a worker.
+		bool m_bStopping = false;                                    ///< Set when the workers must exit.
+	};
+
+} // namespace fgl
\ No newline at end of file
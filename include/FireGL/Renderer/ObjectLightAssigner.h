@@ -0,0 +1,73 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+
+namespace fgl
+{
+	class Scene;
+	struct LightData;
+
+	/**
+	 * Picks the point lights shading each object on the CPU, for the forward path of OpenGL 4.1 contexts
+	 * that can't run the ClusteredLightManager.
+	 *
+	 * Assign() looks up the objects within reach of each point light of the "LightData" block through the
+	 * Scene's spatial index, rates the light by its attenuated brightness at the nearest point of the object's
+	 * bounding sphere, and keeps the MaxLightsPerObject strongest lights of every object. Their indices plus 1
+	 * are packed one byte each, strongest first, into the fourth word of the object's instance data (see
+	 * SceneObject::SetPointLights()), so the lighting shader only loops over those:
+	 *
+	 *     layout (location = 12) in uvec3 InstanceIndices;  // first bone, reflection probe plus 1, point lights
+	 *     ...
+	 *     uint light = (InstanceIndices.z >> (8u * uint(i))) & 0xFFu;  // index plus 1, 0 ends the list
+	 *
+	 * A light reaches as far as its brightness stays above the influence threshold; the cost of a frame is one
+	 * sphere query per light, plus one comparison per object to detect the lists that changed.
+	 */
+	class ObjectLightAssigner
+	{
+	public:
+		static constexpr uint32_t MaxLightsPerObject = 4;     ///< Point lights shading an object at most, one byte each.
+
+		/**
+		 * Sets the brightness below which a light no longer counts for an object. Higher thresholds shorten
+		 * the reach of the lights, so fewer objects are queried and each keeps its strongest lights only.
+		 *
+		 * @param Threshold The attenuated brightness ignored, 0.01 by default.
+		 */
+		void SetInfluenceThreshold(float Threshold);
+
+		/** @return The attenuated brightness below which a light is ignored. */
+		float GetInfluenceThreshold() const;
+
+		/**
+		 * Picks the point lights of every object of a Scene, from the bounds of its last UpdateBoundingSpheres().
+		 * Objects whose list changed have their instance data rewritten by the next frame.
+		 *
+		 * @param Scene The scene whose objects are lit.
+		 * @param Lights The lights of the frame; the first Counts.x point lights are considered.
+		 */
+		void Assign(Scene* Scene, const LightData& Lights);
+
+		/** @return The number of objects reached by at least one point light in the last Assign(). */
+		size_t GetLitObjectCount() const;
+
+	private:
+		/** The strongest lights found so far for an object, strongest first. */
+		struct Candidates
+		{
+			std::array<float, MaxLightsPerObject> Influences;   ///< Attenuated brightness of each light.
+			std::array<uint8_t, MaxLightsPerObject> Lights;     ///< Index of each light in LightData::PointLights.
+			uint32_t Count = 0;                                 ///< Entries in use.
+		};
+
+		/** Inserts a light in the list of an object if it is among its strongest. */
+		static void Insert(Candidates& Object, uint8_t Light, float Influence);
+
+		float m_InfluenceThreshold = 0.01f;       ///< Attenuated brightness below which a light is ignored.
+		std::vector<Candidates> m_Candidates;     ///< Lights of each object by scene index, reused across frames.
+		std::vector<uint32_t> m_Reached;          ///< Objects within reach of the light being assigned.
+		size_t m_LitObjectCount = 0;              ///< Objects lit by the last Assign().
+	};
+
+} // namespace fgl
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+#include <FireGL/Renderer/Shader.h>
+#include <FireGL/Renderer/RenderLayers.h>
+
+#include <External/glm/vec2.hpp>
+#include <External/glm/mat4x4.hpp>
+#include <External/glad/glad.h>
+
+#include <functional>
+#include <mutex>
+
+namespace fgl
+{
+	class Scene;
+	class SceneObject;
+
+	/**
+	 * Object picking through an ID pass, read back asynchronously.
+	 *
+	 * Request() queues the pick of a cursor position. On the next frame the Renderer draws its visible batches
+	 * once more into a 1 x 1 R32UI target with a projection narrowed to the pixel under the cursor, like a pick
+	 * matrix: every instance writes its index in the frame plus 1, depth tested, so the nearest object wins and
+	 * only one pixel is shaded. The pixel is copied into a pixel pack buffer behind a fence and read a frame or
+	 * two later, once the GPU is done, so picking never waits for the pipeline. The index then maps back to the
+	 * SceneObject through the list of the objects drawn that frame, and the callback receives it, or nullptr if
+	 * the cursor was over nothing or the object left the Scene meanwhile.
+	 *
+	 * The pass draws the CPU-batched objects with their position attribute: frames culled on the GPU leave the
+	 * request queued, StaticGeometry chunks and terrains are not pickable, and skinned meshes are picked in their
+	 * bind pose. Request() may be called from any thread; the rest runs on the thread owning the OpenGL context.
+	 */
+	class ObjectPicker
+	{
+	public:
+		static constexpr size_t RingSize = 3; ///< Picks in flight at most.
+
+		/** Receives the object under the cursor, nullptr if none. */
+		using Callback = std::function<void(SceneObject* Object)>;
+
+		ObjectPicker() = default;
+
+		/** Deletes the target, the buffers and the shader; picks in flight are dropped. */
+		~ObjectPicker();
+
+		ObjectPicker(const ObjectPicker&) = delete;
+		ObjectPicker& operator=(const ObjectPicker&) = delete;
+
+		/**
+		 * Queues a pick for the next frame; a request still queued is replaced.
+		 *
+		 * @param Position The position in window coordinates from the top left corner, e.g. BaseWindow::GetCursorPosition().
+		 * @param OnPicked Called on the render thread a frame or two later, with the object under the position.
+		 * @param Layers The render layers that can be picked, objects of other layers are left out of the pass.
+		 */
+		void Request(const glm::vec2& Position, Callback OnPicked, LayerMask Layers = AllLayers);
+
+		/** @return True while a request waits for its pass. */
+		bool HasRequest() const;
+
+		/** @return True while a request waits for its pass or its pixel. */
+		bool IsPending() const;
+
+		/**
+		 * Starts the ID pass of the queued request: binds the target, clears it and activates the ID shader.
+		 *
+		 * @param ViewProjection The unjittered view projection of the frame.
+		 * @param ViewportSize The width and height of the output, in pixels.
+		 * @param WindowSize The width and height of the window the position was taken in, ViewportSize if there is none.
+		 * @return False if the position is outside of the output, in which case the request is answered with nullptr.
+		 */
+		bool BeginPass(const glm::mat4& ViewProjection, const glm::ivec2& ViewportSize, const glm::ivec2& WindowSize);
+
+		/** @return The render layers that can be picked by the pass started by the last BeginPass(). */
+		LayerMask GetPassLayers() const;
+
+		/**
+		 * Sets the index of the first instance of the next draws, their gl_InstanceID added.
+		 *
+		 * @param FirstIndex The position in the frame's object list of the draws' first instance.
+		 */
+		void SetFirstIndex(uint32_t FirstIndex);
+
+		/**
+		 * Queues the readback of the pixel and keeps the objects its indices refer to.
+		 *
+		 * @param Objects Every object drawn by the pass, in index order.
+		 * @param Scene The Scene drawn, answering the oldest pick first if the ring is full.
+		 */
+		void EndPass(std::vector<SceneObject*> Objects, const Scene* Scene);
+
+		/**
+		 * Answers the picks whose pixel arrived, without waiting.
+		 *
+		 * @param Scene The Scene the objects must still belong to.
+		 */
+		void Collect(const Scene* Scene);
+
+		/** Deletes the target, the buffers and the shader; picks in flight are dropped. */
+		void Destroy();
+
+	private:
+		/** A pick whose pixel is being copied. */
+		struct Slot
+		{
+			GLuint Buffer = 0;                  ///< Pixel pack buffer of the 4-byte index.
+			GLsync Fence = nullptr;             ///< Signalled once the copy is done, nullptr if the slot is free.
+			std::vector<SceneObject*> Objects;  ///< Objects drawn by the pass, index - 1.
+			Callback OnPicked;                  ///< Receives the object.
+		};
+
+		/** Creates the target, the buffers and the shader. */
+		void Create();
+
+		mutable std::mutex m_Mutex;             ///< Guards the queued request.
+		bool m_bRequested = false;              ///< Whether a request waits for its pass.
+		glm::vec2 m_RequestPosition{ 0.0f };    ///< Window position of the queued request.
+		Callback m_RequestCallback;             ///< Callback of the queued request.
+		LayerMask m_RequestLayers = AllLayers;  ///< Pickable layers of the queued request.
+		Callback m_PassCallback;                ///< Callback of the request being drawn.
+		LayerMask m_PassLayers = AllLayers;     ///< Pickable layers of the request being drawn.
+		std::vector<Slot> m_Slots;              ///< The readback ring.
+		size_t m_Next = 0;                      ///< Slot of the next pass.
+		GLuint m_Framebuffer = 0;               ///< Framebuffer of the 1 x 1 target.
+		GLuint m_IDTexture = 0;                 ///< R32UI color attachment, the instance index plus 1.
+		GLuint m_DepthBuffer = 0;               ///< Depth attachment, the nearest instance wins.
+		std::unique_ptr<Shader> m_Shader;       ///< Writes the instance index.
+	};
+
+} // namespace fgl
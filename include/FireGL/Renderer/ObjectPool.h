@@ -0,0 +1,120 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+#include <FireGL/Renderer/SceneObject.h>
+
+namespace fgl
+{
+
+	/**
+	 * Receives the objects a Scene removed, instead of deleting them. See ObjectPool.
+	 */
+	class ObjectPoolBase
+	{
+	public:
+		virtual ~ObjectPoolBase() = default;
+
+		/**
+		 * Takes back an object removed from its scene, to hand it out again later.
+		 *
+		 * @param Object The removed object, created by this pool.
+		 */
+		virtual void Recycle(std::unique_ptr<SceneObject> Object) = 0;
+	};
+
+	/**
+	 * Recycles short-lived scene objects of type T, e.g. projectiles or particles.
+	 *
+	 * Objects handed out by Acquire() return to the pool when Scene::RemoveObject() compacts them away,
+	 * instead of being deleted. A recycled object keeps its memory and its meshes' GPU geometry, so spawning
+	 * it again allocates nothing; its Transform, material and gameplay state are kept as they were and should
+	 * be reset by the caller before it is added back with Scene::AddObject().
+	 *
+	 * The pool must outlive the scenes its objects are added to.
+	 *
+	 * @tparam T The object type, derived from SceneObject.
+	 */
+	template<typename T>
+	class ObjectPool final : public ObjectPoolBase
+	{
+	public:
+		/** Creates a new object when the pool is empty. */
+		using FactoryFunction = std::function<std::unique_ptr<T>()>;
+
+		/**
+		 * Constructs an empty pool.
+		 *
+		 * @param Factory Creates the objects handed out when no recycled one is available.
+		 */
+		explicit ObjectPool(FactoryFunction Factory);
+
+		/**
+		 * Hands out a recycled object, or a new one from the factory when none is available.
+		 *
+		 * @return The object, ready to be moved into Scene::AddObject().
+		 */
+		std::unique_ptr<T> Acquire();
+
+		/**
+		 * Creates objects up front so the first spawns don't allocate.
+		 *
+		 * @param Count The number of free objects the pool should hold at least.
+		 */
+		void Reserve(size_t Count);
+
+		/** @return The number of objects waiting to be handed out again. */
+		size_t GetFreeCount() const;
+
+		virtual void Recycle(std::unique_ptr<SceneObject> Object) override;
+
+	private:
+		FactoryFunction m_Factory;                    ///< Creates the objects of an empty pool.
+		std::vector<std::unique_ptr<T>> m_FreeObjects; ///< Recycled objects, handed out last in, first out.
+	};
+
+	template<typename T>
+	ObjectPool<T>::ObjectPool(FactoryFunction Factory)
+		: m_Factory(std::move(Factory))
+	{
+		static_assert(std::is_base_of_v<SceneObject, T>, "Invalid template parameter! Type T must derive from the SceneObject class.");
+	}
+
+	template<typename T>
+	std::unique_ptr<T> ObjectPool<T>::Acquire()
+	{
+		std::unique_ptr<T> Object;
+		if (!m_FreeObjects.empty())
+		{
+			Object = std::move(m_FreeObjects.back());
+			m_FreeObjects.pop_back();
+		}
+		else
+		{
+			Object = m_Factory();
+		}
+		Object->SetObjectPool(this);
+		return Object;
+	}
+
+	template<typename T>
+	void ObjectPool<T>::Reserve(size_t Count)
+	{
+		while (m_FreeObjects.size() < Count)
+		{
+			m_FreeObjects.push_back(m_Factory());
+		}
+	}
+
+	template<typename T>
+	size_t ObjectPool<T>::GetFreeCount() const
+	{
+		return m_FreeObjects.size();
+	}
+
+	template<typename T>
+	void ObjectPool<T>::Recycle(std::unique_ptr<SceneObject> Object)
+	{
+		m_FreeObjects.emplace_back(static_cast<T*>(Object.release()));
+	}
+
+} // namespace fgl
\ No newline at end of file
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+#include <FireGL/Renderer/BoundingVolume.h>
+#include <FireGL/Renderer/Shader.h>
+
+#include <External/glm/mat4x4.hpp>
+#include <External/glad/glad.h>
+
+namespace fgl
+{
+	class SceneObject;
+
+	/**
+	 * Occlusion culling with hardware occlusion queries, for the CPU culling path (OpenGL 4.1).
+	 *
+	 * Once a frame's objects are drawn, Issue() draws the bounding box of frustum-visible objects with color and
+	 * depth writes off, each inside a GL_ANY_SAMPLES_PASSED query. Results are read without waiting on a later
+	 * frame: an object stays hidden while its last query saw no sample pass, and keeps its previous visibility
+	 * while a query is in flight. Visible objects are queried again only every few frames (temporal coherence),
+	 * hidden ones every frame, so an object coming into view is drawn one or two frames late at most.
+	 */
+	class OcclusionQueries
+	{
+	public:
+		/** Creates the box geometry and shader. Requires a current OpenGL context. */
+		void Create();
+
+		/** Deletes the queries, the box geometry and the shader. */
+		void Destroy();
+
+		/** @return True once Create() was called. */
+		bool IsCreated() const;
+
+		/**
+		 * Starts a frame, before the visibility of its objects is read.
+		 *
+		 * @param ObjectCount The number of objects of the Scene.
+		 */
+		void BeginFrame(size_t ObjectCount);
+
+		/**
+		 * Reads the result of the object's last query if it arrived, without waiting for it.
+		 * Objects seen for the first time at an index, or out of view last frame, are visible.
+		 *
+		 * @param Index The index of the object in the Scene.
+		 * @param Object The object at that index, its state is reset when another object took the index.
+		 * @return False if the object was hidden by the depth of a previous frame.
+		 */
+		bool IsVisible(uint32_t Index, const SceneObject* Object);
+
+		/**
+		 * Queries the objects due for a test against the depth of the bound framebuffer.
+		 * Call after the frame's opaque objects are drawn; changes the program and vertex array.
+		 *
+		 * @param Indices The Scene indices of the objects inside the view frustum this frame.
+		 * @param Spheres The bounding spheres of the Scene objects.
+		 * @param ViewProjection The view-projection of the frame.
+		 * @param CameraPosition The world-space position of the camera.
+		 * @param Near The distance of the near plane, objects this close to the camera are never queried.
+		 */
+		void Issue(const std::vector<uint32_t>& Indices, const BoundingSphereArrays& Spheres, const glm::mat4& ViewProjection,
+			const glm::vec3& CameraPosition, float Near);
+
+		/**
+		 * Sets how often the objects found visible are queried again.
+		 *
+		 * @param Frames Number of frames between two queries of a visible object, 1 to query every frame.
+		 */
+		void SetVisibleQueryInterval(uint32_t Frames);
+
+	private:
+		/** Query and last known visibility of the object at one Scene index. */
+		struct QueryState
+		{
+			const SceneObject* Owner = nullptr; ///< Object the state belongs to, compared, never dereferenced
+			GLuint Query = 0;                   ///< Query object, created on the first test
+			uint32_t LastFrame = 0;             ///< Last frame the visibility was read
+			bool bVisible = true;               ///< Result of the last completed query
+			bool bPending = false;              ///< Whether the query's result hasn't been read yet
+		};
+
+		std::vector<QueryState> m_States;     ///< State of every Scene index.
+		uint32_t m_Frame = 1;                 ///< Current frame number.
+		uint32_t m_VisibleQueryInterval = 4;  ///< Frames between two queries of a visible object.
+		GLuint m_BoxVertexArray = 0;          ///< Unit cube, positions at location 0.
+		GLuint m_BoxVertexBuffer = 0;         ///< Corner positions of the cube.
+		GLuint m_BoxIndexBuffer = 0;          ///< Triangles of the cube.
+		std::unique_ptr<Shader> m_BoxShader;  ///< Transforms the cube, writes nothing.
+		UniformHandle m_BoxTransform;         ///< World-view-projection of the box drawn.
+	};
+
+} // namespace fgl
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+#include <FireGL/Renderer/RenderDevice.h>
+
+#include <External/glad/glad.h>
+
+namespace fgl
+{
+
+	/**
+	 * RenderDevice of the OpenGL backend, the existing GL path.
+	 *
+	 * Buffers are written and copied through GL_COPY_WRITE_BUFFER and GL_COPY_READ_BUFFER, so neither the
+	 * vertex array's element buffer nor the bindings known to the GLStateCache change behind its back.
+	 * Textures, samplers (from the SamplerCache), programs, vertex arrays, uniform buffer bindings and the
+	 * pipeline state go through the GLStateCache. Image textures are staged through the PixelUploadPool and
+	 * get immutable storage where GLExtensions::HasTextureStorage(). Persistent buffers need OpenGL 4.4
+	 * (glBufferStorage), base instance draws OpenGL 4.2.
+	 */
+	class OpenGLRenderDevice : public RenderDevice
+	{
+	public:
+		RenderBackend GetBackend() const override;
+		BufferHandle CreateBuffer(const BufferDesc& Desc, const void* Data = nullptr) override;
+		void DestroyBuffer(BufferHandle& Buffer) override;
+		void UpdateBuffer(const BufferHandle& Buffer, size_t Offset, size_t Size, const void* Data) override;
+		void CopyBuffer(const BufferHandle& Source, size_t SourceOffset, const BufferHandle& Target, size_t TargetOffset, size_t Size) override;
+		void DiscardBuffer(const BufferHandle& Buffer) override;
+		bool SupportsPersistentBuffers() const override;
+		void BindUniformBuffer(uint32_t Binding, const BufferHandle& Buffer) override;
+		TextureHandle CreateTexture(const TextureDesc& Desc, const void* Data = nullptr) override;
+		void DestroyTexture(TextureHandle& Texture) override;
+		void UpdateTexture(const TextureHandle& Texture, uint32_t Level, uint32_t X, uint32_t Y, uint32_t Width, uint32_t Height, const void* Data) override;
+		TextureHandle CreateImageTexture(const ImageData& Image, const ImageTextureDesc& Desc) override;
+		TextureHandle CreateCubeTexture(std::span<const ImageData, 6> Faces, const ImageTextureDesc& Desc) override;
+		SamplerHandle GetSampler(const SamplerState& State) override;
+		void BindTexture(uint32_t Slot, const TextureHandle& Texture, SamplerHandle Sampler = {}) override;
+		ProgramHandle CreateProgram() override;
+		uint32_t CompileShaderStage(ShaderStage Stage, const char* Code) override;
+		void LinkProgram(const ProgramHandle& Program, std::span<const uint32_t> Stages, std::span<const char* const> Varyings = {}) override;
+		void ReleaseShaderStage(const ProgramHandle& Program, uint32_t& Stage) override;
+		void DestroyProgram(ProgramHandle& Program) override;
+		void BindProgram(const ProgramHandle& Program) override;
+		void BindPipeline(const PipelineState& State) override;
+		VertexArrayHandle CreateVertexArray(std::string_view Label) override;
+		void DestroyVertexArray(VertexArrayHandle& VertexArray) override;
+		void SetIndexBuffer(const VertexArrayHandle& VertexArray, const BufferHandle& Buffer) override;
+		void SetVertexAttributes(const VertexArrayHandle& VertexArray, const BufferHandle& Buffer, uint32_t Stride, uint32_t Divisor,
+			std::span<const VertexAttribute> Attributes) override;
+		void BindVertexArray(const VertexArrayHandle& VertexArray) override;
+		bool SupportsBaseInstance() const override;
+		void DrawIndexed(const IndexedDraw& Draw) override;
+		void Draw(uint32_t VertexCount, uint32_t InstanceCount = 1, uint32_t FirstVertex = 0) override;
+		void ExecuteCommands(RenderCommandPacket Commands) override;
+		FenceHandle InsertFence() override;
+		void WaitFence(FenceHandle& Fence) override;
+		void DestroyFence(FenceHandle& Fence) override;
+
+		/** @return The glBufferData usage of a BufferUsage. */
+		static GLenum GetUsage(BufferUsage Usage);
+
+		/** @return The sized internal format of a TextureFormat. */
+		static GLenum GetInternalFormat(TextureFormat Format);
+
+		/** @return The pixel format and type of the data of a TextureFormat. */
+		static std::pair<GLenum, GLenum> GetPixelFormat(TextureFormat Format);
+
+		/** @return The binding target of a TextureType, e.g. GL_TEXTURE_CUBE_MAP. */
+		static GLenum GetTarget(TextureType Type);
+
+		/** @return The shader object type of a ShaderStage. */
+		static GLenum GetShaderType(ShaderStage Stage);
+
+		/** @return The component type of a VertexAttributeType. */
+		static GLenum GetAttributeType(VertexAttributeType Type);
+
+		/** @return The internal format decoded pixels are stored with: GL_RGBA8, or GL_RGB8 for 3 channels without immutable storage. */
+		static GLenum GetImageFormat(const ImageData& Image);
+
+		/** @return The bytes of the texture of an image from BaseLevel down, with the mip chain the device creates for it. */
+		static uint64_t GetImageStorageSize(const ImageData& Image, int BaseLevel);
+
+		/** Sets the wrapping and filtering stored in the texture bound to Target, used by binds without a sampler. */
+		static void SetTextureParameters(GLenum Target, const SamplerState& Sampler);
+
+		/**
+		 * Uploads decoded pixels, or every compressed mip level, to the given target of the bound texture.
+		 * Decoded pixels go to BaseLevel, compressed levels finer than BaseLevel are skipped.
+		 * With GLExtensions::HasTextureStorage(), the immutable storage of the levels from BaseLevel is allocated
+		 * first, BaseLevel becoming level 0: the full chain of decoded pixels, the given chain of compressed ones.
+		 * Decoded cube faces are uploaded into the storage allocated by the caller for the six faces.
+		 * The levels of a compressed cube map go to each face, Target being ignored.
+		 * Unstaged uploads read client memory directly, for contexts without a PixelUploadPool such as the
+		 * shared context of the GLUploadThread.
+		 */
+		static void UploadImagePixels(const ImageData& Image, GLenum Target, int BaseLevel = 0, bool bStaged = true);
+	};
+
+} // namespace fgl
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+#include <FireGL/Renderer/BoundingVolume.h>
+
+namespace fgl
+{
+	class SceneObject;
+
+	/**
+	 * Broadphase overlap detection between the objects of a Scene, by sort and sweep.
+	 *
+	 * Objects opt in with SceneObject::SetOverlapEvents(). Each one gets a proxy holding its world-space box,
+	 * the mesh bounds of the object (see SceneObject::GetLocalBoundingBox()) transformed by its Model matrix,
+	 * refreshed only when its Transform revision changed. Every Update() the proxies are sorted by the low X
+	 * of their box with an insertion sort over the previous frame's order: objects barely move between two
+	 * frames, so the order is almost sorted already and the sort runs in near linear time. A single sweep
+	 * along X then only tests the boxes whose X intervals overlap, on Y and Z.
+	 *
+	 * The overlapping pairs are compared with the previous frame's, and SceneObject::OnOverlapBegin() and
+	 * OnOverlapEnd() called on both objects of each pair that started or stopped overlapping; an Entity
+	 * forwards them to its components. Scene::Process() updates the system after ticking the objects.
+	 *
+	 * The boxes are conservative: objects whose boxes overlap may not touch, and a narrow phase may follow.
+	 * Overlaps are detected once per frame, fast objects may pass through each other between two frames.
+	 */
+	class OverlapSystem
+	{
+	public:
+		static constexpr uint32_t InvalidProxy = UINT32_MAX; ///< Proxy of the objects not registered.
+
+		OverlapSystem() = default;
+
+		OverlapSystem(const OverlapSystem&) = delete;
+		OverlapSystem& operator=(const OverlapSystem&) = delete;
+
+		/**
+		 * Registers an object, its overlaps are found from the next Update().
+		 *
+		 * @param Object The object, not registered yet.
+		 */
+		void Add(SceneObject* Object);
+
+		/**
+		 * Unregisters an object, ending its overlaps: both objects of each of its pairs receive OnOverlapEnd().
+		 *
+		 * @param Object The object, registered with Add().
+		 */
+		void Remove(SceneObject* Object);
+
+		/** Refreshes the boxes of the moved objects, finds the overlapping pairs and sends the begin and end events. */
+		void Update();
+
+		/**
+		 * Finds the objects overlapping an object, as of the last Update().
+		 *
+		 * @param Object The object.
+		 * @param OutObjects Cleared, then filled with the objects whose box overlaps the one of Object.
+		 */
+		void QueryOverlaps(const SceneObject* Object, std::vector<SceneObject*>& OutObjects) const;
+
+		/** @return The number of registered objects. */
+		size_t GetProxyCount() const;
+
+		/** @return The number of overlapping pairs found by the last Update(). */
+		size_t GetPairCount() const;
+
+	private:
+		/** A registered object. */
+		struct Proxy
+		{
+			SceneObject* Object = nullptr;      ///< The object.
+			BoundingBox Box;                    ///< World-space box of the object.
+			uint64_t Revision = 0;              ///< Transform revision Box was computed from, 0 if never.
+		};
+
+		/** Two overlapping objects, First < Second. */
+		using Pair = std::pair<SceneObject*, SceneObject*>;
+
+		/** @return The pair of two objects, in the order of the pair list. */
+		static Pair MakePair(SceneObject* A, SceneObject* B);
+
+		std::vector<Proxy> m_Proxies;           ///< Registered objects, indexed by SceneObject::GetOverlapProxy().
+		std::vector<uint32_t> m_Order;          ///< Proxies sorted by the low X of their box, kept from frame to frame.
+		std::vector<Pair> m_Pairs;              ///< Overlapping pairs of the last Update(), sorted.
+		std::vector<Pair> m_NewPairs;           ///< Pairs being found by Update(), reused across frames.
+		std::vector<Pair> m_Begun;              ///< Pairs that started overlapping, reused across frames.
+		std::vector<Pair> m_Ended;              ///< Pairs that stopped overlapping, reused across frames.
+		size_t m_BeginCursor = 0;               ///< Next pair of m_Begun to receive its begin event.
+	};
+
+} // namespace fgl
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+#include <FireGL/Renderer/Shader.h>
+
+#include <External/glm/vec3.hpp>
+#include <External/glm/vec4.hpp>
+#include <External/glad/glad.h>
+
+namespace fgl
+{
+	class Texture;
+
+	/** Emission, motion and appearance of the particles of a ParticleSystem. */
+	struct ParticleSettings
+	{
+		glm::vec3 Position = glm::vec3(0.0f);                   ///< Center of the sphere particles spawn in.
+		float SpawnRadius = 0.0f;                               ///< Radius of the sphere particles spawn in.
+		glm::vec3 Velocity = glm::vec3(0.0f, 2.0f, 0.0f);       ///< Initial velocity.
+		float VelocitySpread = 1.0f;                            ///< Length of the random velocity added to Velocity, at most.
+		glm::vec3 Acceleration = glm::vec3(0.0f, -9.81f, 0.0f); ///< Constant acceleration, e.g. gravity.
+		float Drag = 0.0f;                                      ///< Fraction of the velocity lost per second.
+		float MinLifetime = 1.0f;                               ///< Shortest lifetime in seconds.
+		float MaxLifetime = 2.0f;                               ///< Longest lifetime in seconds.
+		float StartSize = 0.1f;                                 ///< Billboard width at spawn, in world units.
+		float EndSize = 0.0f;                                   ///< Billboard width at death.
+		glm::vec4 StartColor = glm::vec4(1.0f);                 ///< Color and opacity at spawn.
+		glm::vec4 EndColor = glm::vec4(1.0f, 1.0f, 1.0f, 0.0f); ///< Color and opacity at death.
+		float EmissionRate = 1000.0f;                           ///< Particles spawned per second.
+		bool bAdditive = true;                                  ///< Whether particles add light instead of covering what is behind.
+	};
+
+	/**
+	 * Particles emitted, simulated and drawn entirely on the GPU.
+	 *
+	 * Particles live in two buffers of Capacity records (position and age, velocity and lifetime). Every Update()
+	 * reads the live particles of one buffer, moves them and appends the survivors to the other one, so dead
+	 * particles are compacted away as they are simulated; the particles spawned this frame are appended after
+	 * them. The count never comes back to the CPU, the draw reads it directly:
+	 * - On OpenGL 4.3, compute shaders over storage buffers append with an atomic counter. A last single-thread
+	 *   dispatch clamps the count and writes the indirect dispatch of the next simulation and the indirect draw.
+	 *   Particles are drawn as instanced 4-vertex strips, the vertex shader reading its particle from the buffer.
+	 * - On OpenGL 4.1, transform feedback captures the particles a geometry shader keeps, and the count is the
+	 *   number of primitives written: glDrawTransformFeedback() simulates and draws them as points, expanded to
+	 *   billboards by a geometry shader.
+	 *
+	 * Billboards face the camera (Camera.View of the CameraData block), fade from StartColor to EndColor and are
+	 * depth tested against the Scene without writing depth. Renderer::AddParticleSystem() draws them after the
+	 * transparent objects; Update() runs once per frame before Renderer::Render(), on the thread owning the context.
+	 */
+	class ParticleSystem
+	{
+	public:
+		static constexpr GLuint SourceBindingPoint = 11; ///< Shader storage binding point of the live particles.
+		static constexpr GLuint TargetBindingPoint = 12; ///< Shader storage binding point of the particles being written.
+		static constexpr GLuint StateBindingPoint = 13;  ///< Shader storage binding point of the counts and indirect commands.
+		static constexpr GLint SpriteUnit = 0;           ///< Texture unit of the sprite while drawn.
+
+		ParticleSystem() = default;
+
+		/** Deletes the buffers and shaders. */
+		~ParticleSystem();
+
+		ParticleSystem(const ParticleSystem&) = delete;
+		ParticleSystem& operator=(const ParticleSystem&) = delete;
+
+		/**
+		 * Creates the buffers and compiles the shaders of the compute path on OpenGL 4.3, of the transform feedback
+		 * path otherwise. Requires a current OpenGL context.
+		 *
+		 * @param Capacity The number of particles alive at once, at most. Spawns beyond it are dropped.
+		 */
+		void Create(uint32_t Capacity);
+
+		/** Deletes the buffers and shaders, the particles are lost. */
+		void Destroy();
+
+		/** @return True once Create() was called. */
+		bool IsCreated() const;
+
+		/** @return True if the compute path is used. */
+		bool UsesCompute() const;
+
+		/**
+		 * Sets the emission, motion and appearance of the particles, applied from the next Update().
+		 *
+		 * @param Settings The new settings, particles already alive keep their lifetime.
+		 */
+		void SetSettings(const ParticleSettings& Settings);
+
+		/** @return The settings set by SetSettings(). */
+		const ParticleSettings& GetSettings() const;
+
+		/**
+		 * Sets the texture the billboards are drawn with, multiplied by the particle color.
+		 *
+		 * @param Sprite A 2D texture, nullptr (the default) for round soft dots. Must outlive its use.
+		 */
+		void SetSprite(const Texture* Sprite);
+
+		/** Starts or stops spawning particles, the live ones finish their lifetime. */
+		void SetEmitting(bool bEmitting);
+
+		/**
+		 * Scales the emission rate of every particle system, e.g. to lower the particle budget on slow hardware.
+		 *
+		 * @param Scale The fraction of each system's EmissionRate spawned, clamped to [0, 1]; 1 by default.
+		 */
+		static void SetEmissionScale(float Scale);
+
+		/** @return The fraction of each system's emission rate spawned. */
+		static float GetEmissionScale();
+
+		/**
+		 * Ages and moves the particles, drops the dead ones and spawns the new ones.
+		 *
+		 * @param DeltaTime The time since the last update in seconds.
+		 */
+		void Update(float DeltaTime);
+
+		/** Draws the live particles into the bound framebuffer, with depth testing but no depth writes. */
+		void Render();
+
+	private:
+		/** Compiles the shaders of the compute path and creates its storage buffers. */
+		void CreateCompute();
+
+		/** Compiles the shaders of the transform feedback path and creates its buffers and vertex arrays. */
+		void CreateTransformFeedback();
+
+		/** Runs the simulation, emission and count passes of the compute path. */
+		void UpdateCompute(float DeltaTime, uint32_t EmitCount);
+
+		/** Runs the simulation and emission draws of the transform feedback path. */
+		void UpdateTransformFeedback(float DeltaTime, uint32_t EmitCount);
+
+		/** Sets the settings read by the simulation and emission shaders. */
+		void ApplySimulationUniforms(const Shader& Program, float DeltaTime) const;
+
+		ParticleSettings m_Settings;                 ///< Emission, motion and appearance of the particles.
+		const Texture* m_Sprite = nullptr;           ///< Texture of the billboards, nullptr for round dots.
+		bool m_bEmitting = true;                     ///< Whether Update() spawns particles.
+		float m_PendingEmission = 0.0f;              ///< Fraction of a particle carried to the next Update().
+		static float s_EmissionScale;                ///< Fraction of the emission rates spawned, shared by every system.
+		uint32_t m_Capacity = 0;                     ///< Particles per buffer.
+		uint32_t m_Seed = 0;                         ///< Varies the random numbers of each Update().
+		uint32_t m_Current = 0;                      ///< Buffer holding the live particles.
+		bool m_bCompute = false;                     ///< Whether the compute path is used.
+		bool m_bSimulated = false;                   ///< Whether m_Current was written by an Update() (transform feedback path).
+		GLuint m_Particles[2] = {};                  ///< Particle records, read and written alternately.
+		GLuint m_StateBuffer = 0;                    ///< Counts, indirect dispatch and indirect draw (compute path).
+		GLuint m_Feedback[2] = {};                   ///< Transform feedback objects writing m_Particles (transform feedback path).
+		GLuint m_ParticleArrays[2] = {};             ///< Vertex arrays reading m_Particles (transform feedback path).
+		GLuint m_EmptyVertexArray = 0;               ///< Vertex array of the instanced strips (compute path).
+		std::unique_ptr<Shader> m_SimulateShader;    ///< Ages, moves and compacts the particles.
+		std::unique_ptr<Shader> m_EmitShader;        ///< Spawns particles (compute path, the simulation program spawns otherwise).
+		std::unique_ptr<Shader> m_CountShader;       ///< Clamps the count and writes the indirect commands (compute path).
+		std::unique_ptr<Shader> m_RenderShader;      ///< Draws the billboards.
+	};
+
+} // namespace fgl
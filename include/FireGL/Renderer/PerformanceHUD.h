@@ -0,0 +1,128 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+#include <FireGL/Renderer/SpriteBatch.h>
+#include <FireGL/Renderer/RenderDevice.h>
+
+#include <External/glm/vec2.hpp>
+
+namespace fgl
+{
+	class Renderer;
+
+	/**
+	 * Toggleable on-screen performance overlay, recorded into a SpriteBatch: CPU and GPU frame time graphs, the GPU
+	 * time of every pass, the RenderStats counters, the GPU and CPU memory totals and the depth of a loading queue.
+	 * Meant for diagnosing a machine without attaching a profiler, so it is compiled in every configuration.
+	 *
+	 * While hidden, Record() returns at once and the renderer's GPU profiling is left as the application set it:
+	 * no query is issued and no quad recorded. Showing the HUD enables GPU profiling and resets its stats, hiding
+	 * it restores the previous state. The text is rebuilt a few times a second so it stays readable, the graphs
+	 * every frame.
+	 *
+	 * Text is drawn with a built-in 5 x 7 font of the printable ASCII characters, lowercase shown as uppercase,
+	 * created by Initialize(), or with the font given to SetFont().
+	 *
+	 *     PerformanceHUD HUD(SceneRenderer);
+	 *     HUD.Initialize();
+	 *     SceneRenderer.SetOverlay(&Overlay);
+	 *     ...
+	 *     if (bToggleKeyPressed) HUD.Toggle();
+	 *     HUD.Record(Overlay);
+	 *     SceneRenderer.PrepareFrame(&MainScene);
+	 */
+	class PerformanceHUD
+	{
+	public:
+		static constexpr size_t HistoryLength = 120; ///< Frames shown by the graphs.
+
+		/** @param Target The renderer whose stats and GPU profiler are shown, must outlive the HUD. */
+		explicit PerformanceHUD(Renderer& Target);
+
+		/** Deletes the built-in font atlas. */
+		~PerformanceHUD();
+
+		PerformanceHUD(const PerformanceHUD&) = delete;
+		PerformanceHUD& operator=(const PerformanceHUD&) = delete;
+
+		/** Creates the atlas of the built-in font, unless a font was set. Requires a current OpenGL context. */
+		void Initialize();
+
+		/** Deletes the atlas of the built-in font. Requires a current OpenGL context. */
+		void Destroy();
+
+		/**
+		 * Shows or hides the HUD. Showing it enables the renderer's GPU profiling, hiding it restores the previous state.
+		 *
+		 * @param bVisible True to show the HUD, false (the default) to hide it.
+		 */
+		void SetVisible(bool bVisible);
+
+		/** @return True if the HUD is shown. */
+		bool IsVisible() const;
+
+		/** Shows the HUD if hidden, hides it otherwise. */
+		void Toggle();
+
+		/**
+		 * Sets the font of the text, instead of the built-in one.
+		 *
+		 * @param Font The font atlas, which must outlive its use.
+		 */
+		void SetFont(const SpriteFont& Font);
+
+		/**
+		 * Sets where the loading queue depth comes from, e.g. [&Scheduler]() { return Scheduler.GetPendingCount(); }.
+		 *
+		 * @param Depth Returns the loads in progress, called when the text is rebuilt; empty to show no queue.
+		 */
+		void SetLoadingQueue(std::function<size_t()> Depth);
+
+		/**
+		 * Places the HUD.
+		 *
+		 * @param Position The top left corner of the panel, in pixels.
+		 * @param LineHeight The height of a line of text, in pixels; the graphs scale with it.
+		 */
+		void SetLayout(const glm::vec2& Position, float LineHeight);
+
+		/**
+		 * Records the HUD into an overlay, once per frame before the renderer latches it. Does nothing while hidden.
+		 * The quads go to layers Layer to Layer + 3, the batch is left on layer 0.
+		 *
+		 * @param Overlay The sprite batch drawn by the renderer, see Renderer::SetOverlay().
+		 * @param Layer The layer of the panel, above the application's own HUD by default.
+		 */
+		void Record(SpriteBatch& Overlay, int Layer = 1000);
+
+	private:
+		/** Samples the last frame into the histories. */
+		void Sample();
+
+		/** Rebuilds m_Text from the renderer's stats, the memory trackers and the loading queue. */
+		void BuildText();
+
+		/** Records a frame time graph of a history whose oldest frame is at Head, scaled so its longest frame fits; bars on Layer + 1. */
+		void RecordGraph(SpriteBatch& Overlay, const std::array<float, HistoryLength>& History, size_t Head, const glm::vec2& Position,
+			const glm::vec2& Size, int Layer) const;
+
+		Renderer& m_Renderer;                              ///< Renderer whose stats are shown.
+		bool m_bVisible = false;                           ///< Whether Record() records anything.
+		bool m_bProfilingWasEnabled = false;               ///< GPU profiling state before the HUD was shown.
+		SpriteFont m_Font;                                 ///< Font of the text, the built-in one unless set.
+		TextureHandle m_BuiltInAtlas;                      ///< Atlas of the built-in font, empty if not created.
+		std::function<size_t()> m_LoadingQueue;            ///< Depth of the loading queue, none if empty.
+		glm::vec2 m_Position = glm::vec2(8.0f);            ///< Top left corner of the panel, in pixels.
+		float m_LineHeight = 12.0f;                        ///< Height of a line of text, in pixels.
+		std::array<float, HistoryLength> m_CPUTimes{};     ///< CPU frame times in milliseconds, a ring.
+		std::array<float, HistoryLength> m_GPUTimes{};     ///< GPU frame times in milliseconds, a ring.
+		size_t m_CPUHead = 0;                              ///< Next slot of m_CPUTimes.
+		size_t m_GPUHead = 0;                              ///< Next slot of m_GPUTimes.
+		uint64_t m_LastSample = 0;                         ///< Profiler::Now() of the last Record(), 0 before the first.
+		uint64_t m_LastText = 0;                           ///< Profiler::Now() of the last BuildText().
+		uint64_t m_GPUFramesRead = 0;                      ///< GPUProfiler::GetFramesRead() at the last sample.
+		std::string m_Text;                                ///< Lines of text, rebuilt a few times a second.
+		size_t m_TextLines = 0;                            ///< Lines of m_Text.
+	};
+
+} // namespace fgl
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+
+#include <External/glad/glad.h>
+
+namespace fgl
+{
+
+	/**
+	 * Pool of pixel buffer objects texture uploads are staged through.
+	 *
+	 * Uploading from client memory makes glTexImage2D copy the pixels before it returns. Staged uploads
+	 * copy them into a pixel buffer instead and let the driver transfer them asynchronously.
+	 * On OpenGL 4.4+ the buffers are persistently mapped and each one is fenced after its upload, to be
+	 * reused once the GPU has read it; older contexts orphan and map the buffer on every upload.
+	 *
+	 * Every upload is bracketed by Stage() and EndUpload(), on the thread owning the OpenGL context.
+	 */
+	class PixelUploadPool
+	{
+	public:
+		static constexpr size_t BufferCount = 4;               ///< Staging buffers in flight at most.
+		static constexpr size_t MinBufferSize = 4 * 1024 * 1024; ///< Smallest staging buffer allocated, in bytes.
+
+		/**
+		 * Copies pixels into a free staging buffer and binds it to GL_PIXEL_UNPACK_BUFFER.
+		 * Falls back to the client memory when every buffer is still read by the GPU or staging is disabled.
+		 *
+		 * @param Data The pixels to upload.
+		 * @param Size The size of the pixels in bytes.
+		 * @return The pointer to pass to glTexImage2D / glCompressedTexImage2D: an offset into the bound
+		 *         staging buffer, or Data itself when the upload isn't staged.
+		 */
+		static const void* Stage(const void* Data, size_t Size);
+
+		/** Unbinds the staging buffer bound by Stage() and fences it so it is only reused once read. */
+		static void EndUpload();
+
+		/** Enables or disables staging, uploads then read client memory directly. Enabled by default. */
+		static void SetEnabled(bool bEnabled);
+
+		/** Deletes the staging buffers and their fences. */
+		static void Destroy();
+
+	private:
+		/** A staging buffer and the fence of its last upload. */
+		struct StagingBuffer
+		{
+			GLuint Buffer = 0;
+			size_t Capacity = 0;
+			void* Mapped = nullptr; ///< Persistent mapping (OpenGL 4.4+).
+			GLsync Fence = nullptr;
+		};
+
+		/** @return The index of a buffer the GPU is done reading, or BufferCount if all are in flight. */
+		static size_t FindFreeBuffer(size_t Size);
+
+		/** (Re)creates the storage of a buffer so it holds at least Size bytes. */
+		static void AllocateBuffer(StagingBuffer& Staging, size_t Size);
+
+		static std::array<StagingBuffer, BufferCount> s_Buffers; ///< The staging buffers.
+		static size_t s_Current;                                 ///< Buffer staged by the pending upload, BufferCount if none.
+		static bool s_bEnabled;                                  ///< False if uploads read client memory directly.
+	};
+
+} // namespace fgl
\ No newline at end of file
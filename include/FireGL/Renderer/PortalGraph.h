@@ -0,0 +1,134 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+#include <FireGL/Renderer/BoundingVolume.h>
+
+#include <External/glm/vec3.hpp>
+#include <External/glm/vec4.hpp>
+
+#include <span>
+
+namespace fgl
+{
+	class Frustum;
+
+	/**
+	 * Cells and portals of an indoor scene, culling the objects that walls hide from the camera.
+	 *
+	 * A cell is a box of space, typically a room, and a portal a convex opening connecting two cells, e.g. a
+	 * doorway or a window. ComputeVisibility() starts from the cell holding the camera and walks the portals:
+	 * every portal is clipped by the frustum it is seen through, and a portal still visible narrows the frustum
+	 * to the planes through the camera and the edges of its clipped opening before the walk enters the cell
+	 * behind it. A cell reached through several portals keeps one frustum per path. IsVisible() then only
+	 * accepts the objects overlapping a reached cell and inside one of its frustums, so the rooms behind walls
+	 * cost nothing to draw, whatever the view frustum alone sees.
+	 *
+	 * Cells are authored to cover every place objects are, outdoors included: while the camera is inside a
+	 * cell, objects in none of the reached cells are hidden. With the camera outside every cell nothing is culled.
+	 * Closed portals, e.g. shut doors, stop the walk (see SetPortalOpen()).
+	 */
+	class PortalGraph
+	{
+	public:
+		static constexpr uint32_t InvalidCell = UINT32_MAX;     ///< Returned by FindCell() outside every cell.
+		static constexpr size_t MaxPortalCorners = 8;           ///< Corners of a portal at most.
+		static constexpr uint32_t MaxDepth = 16;                ///< Portals a path crosses at most.
+
+		/**
+		 * Adds a cell.
+		 *
+		 * @param Bounds The space of the cell; cells may overlap, the camera is then in the first one added.
+		 * @return The index of the cell.
+		 */
+		uint32_t AddCell(const BoundingBox& Bounds);
+
+		/**
+		 * Adds a portal between two cells, crossed both ways.
+		 *
+		 * @param CellA One of the cells.
+		 * @param CellB The other cell.
+		 * @param Corners The corners of the convex, planar opening in order around it, 3 to MaxPortalCorners.
+		 * @return The index of the portal.
+		 */
+		uint32_t AddPortal(uint32_t CellA, uint32_t CellB, std::span<const glm::vec3> Corners);
+
+		/**
+		 * Opens or closes a portal, e.g. with its door.
+		 *
+		 * @param Portal The index of the portal.
+		 * @param bOpen False to stop the visibility walk at it; portals are open when added.
+		 */
+		void SetPortalOpen(uint32_t Portal, bool bOpen);
+
+		/** Removes every cell and portal. */
+		void Clear();
+
+		/** @return The first cell holding a point, InvalidCell if none does. */
+		uint32_t FindCell(const glm::vec3& Position) const;
+
+		/**
+		 * Walks the portals from the camera's cell, the visibility IsVisible() then tests against.
+		 *
+		 * @param Eye The position of the camera.
+		 * @param ViewFrustum The frustum of the camera.
+		 */
+		void ComputeVisibility(const glm::vec3& Eye, const Frustum& ViewFrustum);
+
+		/** @return True if the last ComputeVisibility() started inside a cell, false if it culls nothing. */
+		bool IsActive() const;
+
+		/**
+		 * Tests a sphere against the cells reached by the last ComputeVisibility().
+		 *
+		 * @param Sphere The world-space bounds of an object.
+		 * @return True if the sphere overlaps a reached cell inside one of its frustums, or if IsActive() is false.
+		 */
+		bool IsVisible(const BoundingSphere& Sphere) const;
+
+		/** @return The number of distinct cells reached by the last ComputeVisibility(). */
+		size_t GetVisibleCellCount() const;
+
+		/** @return The number of cells. */
+		size_t GetCellCount() const;
+
+	private:
+		/** A room or area. */
+		struct Cell
+		{
+			BoundingBox Bounds;                 ///< Space of the cell.
+			std::vector<uint32_t> Portals;      ///< Portals leading out of it.
+		};
+
+		/** An opening between two cells. */
+		struct Portal
+		{
+			uint32_t Cells[2];                                  ///< The connected cells.
+			std::array<glm::vec3, MaxPortalCorners> Corners;    ///< Convex opening.
+			uint32_t CornerCount;                               ///< Used entries of Corners.
+			bool bOpen;                                         ///< Whether the walk crosses it.
+		};
+
+		/** A cell reached by the walk and the frustum it is seen through. */
+		struct View
+		{
+			uint32_t Cell;          ///< Index of the cell.
+			uint32_t FirstPlane;    ///< First plane of the frustum in m_Planes.
+			uint32_t PlaneCount;    ///< Planes of the frustum.
+		};
+
+		/** Adds the view of a cell, then walks the portals leading out of it other than the one it is entered by. */
+		void Visit(uint32_t CellIndex, uint32_t FirstPlane, uint32_t PlaneCount, uint32_t EnteredBy, uint32_t Depth);
+
+		std::vector<Cell> m_Cells;          ///< Every cell, by index.
+		std::vector<Portal> m_Portals;      ///< Every portal, by index.
+		std::vector<View> m_Views;          ///< Cells reached by the last walk, one entry per path.
+		std::vector<glm::vec4> m_Planes;    ///< Inward planes of the views' frustums.
+		std::vector<glm::vec3> m_Clipped;   ///< Portal clipped so far, reused across portals.
+		std::vector<glm::vec3> m_Clipping;  ///< Portal being clipped by the next plane, reused across portals.
+		glm::vec4 m_NearPlane{ 0.0f };      ///< Near plane of the camera, shared by every view.
+		glm::vec4 m_FarPlane{ 0.0f };       ///< Far plane of the camera, shared by every view.
+		glm::vec3 m_Eye{ 0.0f };            ///< Position of the camera.
+		bool m_bActive = false;             ///< Whether the camera is inside a cell.
+	};
+
+} // namespace fgl
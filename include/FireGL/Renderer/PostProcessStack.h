@@ -0,0 +1,188 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+#include <FireGL/Renderer/Shader.h>
+#include <FireGL/Renderer/RenderTargetPool.h>
+
+#include <External/glm/vec2.hpp>
+#include <External/glm/vec3.hpp>
+#include <External/glm/mat4x4.hpp>
+#include <External/glad/glad.h>
+
+namespace fgl
+{
+	/** How the renderer smooths the edges of the geometry, see Renderer::SetAntiAliasing(). */
+	enum class AntiAliasingMode : uint8_t
+	{
+		None, ///< No smoothing.
+		MSAA, ///< Multisampled rasterization, every sample shaded and stored: the smoothest edges at the highest bandwidth.
+		FXAA, ///< Edges found from the luminance of the final image and blurred along, in the final post-process pass.
+		TAA,  ///< Jittered projection, every frame blended with the reprojected previous ones: also smooths shading.
+		TemporalUpscaling ///< TAA resolved at the output size, for a render scale below 1: reconstructs the detail of the missing pixels over frames.
+	};
+
+	/** Effects applied by a PostProcessStack and their parameters. */
+	struct PostProcessSettings
+	{
+		bool bToneMapping = true;                 ///< Maps the HDR scene to the display with the ACES filmic curve.
+		float Exposure = 1.0f;                    ///< Scale of the scene's color before tone mapping.
+		bool bColorGrading = false;               ///< Applies ColorFilter, Contrast and Saturation after tone mapping.
+		glm::vec3 ColorFilter = glm::vec3(1.0f);  ///< Multiplier of every channel.
+		float Contrast = 1.0f;                    ///< Spread of the colors around mid-grey, 1 to keep them.
+		float Saturation = 1.0f;                  ///< 0 for greyscale, 1 to keep the colors.
+		bool bBloom = false;                      ///< Blurs the bright parts of the scene over their surroundings.
+		float BloomThreshold = 1.0f;              ///< Brightness above which pixels bloom, with a soft knee below it.
+		float BloomIntensity = 0.2f;              ///< Scale of the blurred light added to the scene.
+		int BloomDownsample = 2;                  ///< Divisor of the first bloom level's size: 2 for half, 4 for quarter resolution.
+		int BloomLevels = 5;                      ///< Levels of the blur pyramid, each half the size of the previous one, MaxBloomLevels at most.
+		bool bVignette = false;                   ///< Darkens the corners of the image.
+		float VignetteIntensity = 0.4f;           ///< Darkening of the corners, 0 to 1.
+		float VignetteSmoothness = 0.5f;          ///< Share of the distance to the corners the darkening fades in over, 0 to 1.
+	};
+
+	/**
+	 * Post-processing of the frames after the scene is drawn: tone mapping, color grading, bloom and vignette.
+	 *
+	 * The renderer draws the scene into a SceneFormat target, so lighting above 1 survives until tone mapping.
+	 * Apply() then reads it in as few full-screen passes as the enabled effects allow:
+	 *  - bloom is the only effect needing its neighbours, it runs on a pyramid starting at BloomDownsample of
+	 *    the scene's size: the first pass thresholds and downsamples the scene, each next one halves the previous
+	 *    level, then the levels are upsampled back with a tent filter, blended additively into the larger level.
+	 *    Its passes touch a third of the scene's pixels at half resolution, a twelfth at quarter;
+	 *  - every per-pixel effect, and the bloom's composition, is fused into one final pass writing the output
+	 *    framebuffer directly, which also scales the scene to the output viewport. Its shader is compiled with
+	 *    the enabled effects only, one variant per combination, so disabled effects cost nothing.
+	 *
+	 * The intermediate targets come from a RenderTargetPool: the same few textures are reused frame after frame
+	 * instead of each effect owning full-resolution framebuffers.
+	 *
+	 * The stack also hosts the post-process anti-aliasing. FXAA is fused into the final pass: the edge search
+	 * reads the scene's luminance around the pixel and only moves the coordinates the pass then composites
+	 * from, so it costs its taps, no pass of its own. ResolveTemporal() is the TAA resolve, run on the jittered
+	 * scene before the effects.
+	 */
+	class PostProcessStack
+	{
+	public:
+		static constexpr GLenum SceneFormat = GL_RGBA16F;       ///< Format the scene is drawn in when post-processing is on.
+		static constexpr GLenum BloomFormat = GL_R11F_G11F_B10F; ///< Format of the bloom levels, HDR without alpha.
+		static constexpr int MaxBloomLevels = 8;                ///< Bloom levels at most.
+		static constexpr GLint SceneUnit = 0;                   ///< Texture unit of the scene while the final pass draws.
+		static constexpr GLint BloomUnit = 1;                   ///< Texture unit of the bloom while the final pass draws, and of the level read by bloom passes.
+		static constexpr GLint HistoryUnit = 2;                 ///< Texture unit of the previous frames while ResolveTemporal() draws.
+		static constexpr GLint DepthUnit = 3;                   ///< Texture unit of the scene's depth while ResolveTemporal() draws.
+		static constexpr float TemporalFeedback = 0.9f;         ///< Weight of the previous frames in every resolved frame.
+		static constexpr float UpscaleFeedback = 0.85f;         ///< Weight of the previous frames on an upscaled frame's samples, lower as the samples are sparser.
+		static constexpr uint32_t JitterSequenceLength = 8;     ///< Frames before the jitter offsets repeat.
+
+		PostProcessStack() = default;
+
+		/** Deletes the shaders and the pooled targets. */
+		~PostProcessStack();
+
+		PostProcessStack(const PostProcessStack&) = delete;
+		PostProcessStack& operator=(const PostProcessStack&) = delete;
+
+		/** @return The effects and their parameters, read by every Apply(). */
+		PostProcessSettings& GetSettings();
+
+		/** @return The effects and their parameters, read by every Apply(). */
+		const PostProcessSettings& GetSettings() const;
+
+		/**
+		 * Applies the enabled effects to a scene and writes the result over a viewport of a framebuffer.
+		 * Depth testing and blending are off while drawing; changes the program, vertex array and texture units
+		 * SceneUnit and BloomUnit. Requires a current OpenGL context.
+		 *
+		 * @param SceneColor The single-sample color texture of the scene.
+		 * @param Width The width of the scene in pixels.
+		 * @param Height The height of the scene in pixels.
+		 * @param OutputFramebuffer The framebuffer the result is written to, 0 for the default framebuffer.
+		 * @param OutputViewport The viewport of OutputFramebuffer the result covers: x, y, width and height.
+		 * @param bEffects False to skip every effect of the settings, e.g. to only scale the scene or apply FXAA.
+		 * @param bFXAA True to smooth the edges with FXAA in the same pass.
+		 */
+		void Apply(GLuint SceneColor, int Width, int Height, GLuint OutputFramebuffer, const GLint OutputViewport[4], bool bEffects = true, bool bFXAA = false);
+
+		/**
+		 * Blends a jittered frame with the previous ones (TAA resolve) and keeps the result as the next history.
+		 * Every pixel is reprojected into the previous frame through the scene's depth, so camera motion is followed;
+		 * the history is clamped to the colors around the pixel, which rejects what moved or was uncovered.
+		 *
+		 * With an output larger than the scene the resolve also upscales: the history is kept at the output size
+		 * and each output pixel takes the scene's sample closest to it, weighted by their distance. As the jitter
+		 * moves the samples, successive frames fill in the output pixels between them, reconstructing detail the
+		 * scene alone doesn't have.
+		 * Depth testing and blending are off while drawing; changes the program, vertex array, framebuffer, viewport
+		 * and texture units BloomUnit, HistoryUnit and DepthUnit.
+		 *
+		 * @param SceneColor The single-sample color texture of the jittered scene.
+		 * @param SceneDepth The depth texture of the jittered scene.
+		 * @param Width The width of the scene in pixels.
+		 * @param Height The height of the scene in pixels.
+		 * @param Format The internal format of SceneColor, the history is stored in.
+		 * @param Reprojection Maps the normalized device coordinates of this frame to the clip space of the previous one.
+		 * @param Jitter The offset of the scene's projection this frame, in scene pixels (see GetJitterOffset()).
+		 * @param OutputWidth The width of the resolved frame, the scene's to only anti-alias.
+		 * @param OutputHeight The height of the resolved frame, the scene's to only anti-alias.
+		 * @return The resolved frame of OutputWidth x OutputHeight, valid until the next ResolveTemporal().
+		 */
+		GLuint ResolveTemporal(GLuint SceneColor, GLuint SceneDepth, int Width, int Height, GLenum Format, const glm::mat4& Reprojection,
+			const glm::vec2& Jitter, int OutputWidth, int OutputHeight);
+
+		/** Drops the previous frames, e.g. after a camera cut; the next ResolveTemporal() starts over from its frame. */
+		void ResetHistory();
+
+		/**
+		 * Offset of the projection for a frame of temporal anti-aliasing, from the Halton (2, 3) sequence.
+		 *
+		 * @param Frame The index of the frame, the sequence repeats every JitterSequenceLength frames.
+		 * @return The offset within the pixel, each axis in [-0.5, 0.5].
+		 */
+		static glm::vec2 GetJitterOffset(uint32_t Frame);
+
+		/** Deletes the shaders and the pooled targets, recreated by the next Apply(). */
+		void Destroy();
+
+		/** @return The pool the intermediate targets come from. */
+		const RenderTargetPool& GetTargetPool() const;
+
+		/** @return The number of full-screen passes the last Apply() drew. */
+		uint32_t GetPassCount() const;
+
+	private:
+		/** Feature bits of the final pass' variants. */
+		static constexpr uint32_t ToneMappingFeature = 1 << 0;
+		static constexpr uint32_t ColorGradingFeature = 1 << 1;
+		static constexpr uint32_t BloomFeature = 1 << 2;
+		static constexpr uint32_t VignetteFeature = 1 << 3;
+		static constexpr uint32_t FXAAFeature = 1 << 4;
+
+		/**
+		 * Runs the bloom pyramid over the scene.
+		 *
+		 * @return The first level holding the blurred light, to Release() once composited.
+		 */
+		PooledTarget RenderBloom(GLuint SceneColor, int Width, int Height);
+
+		/** @return The final pass' shader with the given features, compiled on first use. */
+		Shader& GetCompositeShader(uint32_t Features);
+
+		/** Draws the full-screen triangle with the active program. */
+		void DrawFullScreen();
+
+		PostProcessSettings m_Settings;                                          ///< Enabled effects and their parameters.
+		RenderTargetPool m_Targets;                                             ///< Bloom levels, reused across frames.
+		std::unordered_map<uint32_t, std::unique_ptr<Shader>> m_CompositeShaders; ///< Final pass variants, by feature bits.
+		std::unique_ptr<Shader> m_PrefilterShader;                              ///< Thresholds and downsamples the scene into the first bloom level.
+		std::unique_ptr<Shader> m_DownsampleShader;                             ///< Halves a bloom level into the next one.
+		std::unique_ptr<Shader> m_UpsampleShader;                               ///< Tent-filters a bloom level into the larger one.
+		std::unique_ptr<Shader> m_TemporalShader;                               ///< Blends a frame with the reprojected history.
+		std::unique_ptr<Shader> m_UpscaleShader;                                ///< Reconstructs a larger frame from a smaller one and the reprojected history.
+		PooledTarget m_History;                                                 ///< Last resolved frame, held from the pool until replaced.
+		bool m_bHistoryValid = false;                                           ///< Whether m_History holds a frame to blend with.
+		GLuint m_FullScreenVertexArray = 0;                                     ///< Empty vertex array, the triangle is generated from gl_VertexID.
+		uint32_t m_PassCount = 0;                                               ///< Full-screen passes of the last Apply().
+	};
+
+} // namespace fgl
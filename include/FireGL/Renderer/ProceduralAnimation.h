@@ -0,0 +1,59 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+#include <FireGL/Renderer/BoundingVolume.h>
+
+#include <External/glm/vec3.hpp>
+
+namespace fgl
+{
+
+	/**
+	 * Spin, sway and bob of an object evaluated by the vertex shaders from the time of the camera block, so an
+	 * object that only moves in place needs no Tick() and keeps its Transform, and its instance data, untouched.
+	 *
+	 * In object space, before the Model matrix, the vertices are rotated around Axis (through the object's
+	 * origin) and moved along it:
+	 *
+	 *     Wave     = sin(2 * pi * Frequency * Time + Phase)
+	 *     Angle    = SpinSpeed * Time + SwayAngle * Wave
+	 *     Position = rotate(Position, Axis, Angle) + Axis * BobAmplitude * Wave
+	 *
+	 * The parameters are packed into the unused w components of the normal matrix columns of InstanceData
+	 * (see Pack()), as half floats and an octahedral axis, and all zero when the object isn't animated.
+	 * BaseLighting.vert, the depth prepass, the shadow casters and the picker apply the same animation.
+	 */
+	struct ProceduralAnimation
+	{
+		glm::vec3 Axis = glm::vec3(0.0f, 1.0f, 0.0f); ///< Object-space axis of the rotation and the bob, normalized when packed.
+		float SpinSpeed = 0.0f;                        ///< Constant rotation around Axis, in radians per second.
+		float SwayAngle = 0.0f;                        ///< Amplitude of the oscillating rotation around Axis, in radians.
+		float BobAmplitude = 0.0f;                     ///< Amplitude of the oscillation along Axis, in object-space units.
+		float Frequency = 0.0f;                        ///< Oscillations per second of the sway and the bob.
+		float Phase = 0.0f;                            ///< Offset of the oscillation in radians, e.g. to desynchronize identical objects.
+
+		/** @return True if the animation moves the vertices at all. */
+		bool IsAnimated() const;
+
+		/**
+		 * Packs the animation in three words, written bit for bit in the w of the normal matrix columns:
+		 * the half-float spin speed over the octahedral axis (two 8-bit unorms), the half-float bob amplitude
+		 * over the sway angle, and the half-float frequency over the phase. All zero when not animated.
+		 *
+		 * @return The packed words.
+		 */
+		glm::uvec3 Pack() const;
+
+		/**
+		 * Encloses every pose of the animation, for culling: a rotation sweeps the sphere around the origin and
+		 * the bob stretches it along the axis.
+		 *
+		 * @param Local The object-space bounding sphere of the meshes at rest.
+		 * @return The object-space sphere enclosing the animated meshes, Local if not animated.
+		 */
+		BoundingSphere Enclose(const BoundingSphere& Local) const;
+
+		bool operator==(const ProceduralAnimation& Other) const = default;
+	};
+
+} // namespace fgl
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+
+namespace fgl
+{
+
+	/** One step of a QualityGovernor's ladder: the settings the renderer draws with at that level. */
+	struct QualityLevel
+	{
+		float LODBias = 1.0f;                      ///< See Renderer::SetLODBias(), below 1 switches to simplified meshes sooner.
+		uint32_t ShadowResolution = 2048;          ///< Size of every shadow cascade, see CascadedShadowMaps::SetResolution().
+		uint32_t CascadeCount = 4;                 ///< Number of shadow cascades, see CascadedShadowMaps::SetCascadeCount().
+		bool bAmbientOcclusion = true;             ///< Whether SSAO may run, see Renderer::SetAmbientOcclusion().
+		float ParticleBudget = 1.0f;               ///< Fraction of every particle system's emission rate, see ParticleSystem::SetEmissionScale().
+		uint32_t MaxLightsPerCluster = UINT32_MAX; ///< See ClusteredLightManager::SetMaxLightsPerCluster().
+	};
+
+	/** Telemetry of a QualityGovernor, as of its last update. */
+	struct QualityGovernorState
+	{
+		size_t Level = 0;               ///< Index of the current level in the ladder, 0 being the highest quality.
+		float FrameTime = 0.0f;         ///< Smoothed frame time, in milliseconds.
+		float GPUFrameTime = 0.0f;      ///< Smoothed GPU frame time, in milliseconds, 0 without GPU measurements.
+		uint32_t FramesOverBudget = 0;  ///< Consecutive frames over the downgrade threshold.
+		uint32_t FramesUnderBudget = 0; ///< Consecutive frames under the upgrade threshold.
+		uint64_t Changes = 0;           ///< Number of level changes since the governor was reset.
+	};
+
+	/**
+	 * Steps the renderer's quality settings through a ladder of levels to hold a frame time.
+	 *
+	 * Every frame Update() receives the frame time of the TimeManager and the GPU frame time of the timer
+	 * queries, both smoothed by an exponential moving average. A frame is over budget when the slower of both
+	 * exceeds the target times the downgrade ratio, and under budget when the GPU time, or the frame time
+	 * without GPU measurements, is below the target times the upgrade ratio: frame times held at the refresh
+	 * rate by vertical sync never look like headroom. The level only drops after DowngradeFrames consecutive
+	 * frames over budget and only rises after UpgradeFrames consecutive frames under it, and both counts start
+	 * over after every change, so the level doesn't oscillate around a threshold.
+	 *
+	 * The governor only decides; Renderer::SetQualityGovernor() applies the levels it selects.
+	 */
+	class QualityGovernor
+	{
+	public:
+		/** Sets up the ladder of MakeDefaultLevels(). */
+		QualityGovernor();
+
+		/** @return A ladder of four levels, from the defaults of the renderer down to no SSAO, one small cascade and a quarter of the particles. */
+		static std::vector<QualityLevel> MakeDefaultLevels();
+
+		/**
+		 * Sets the ladder and resets the governor to its first level.
+		 *
+		 * @param Levels The levels from the highest quality to the lowest, at least one.
+		 */
+		void SetLevels(std::vector<QualityLevel> Levels);
+
+		/** @return The ladder, from the highest quality to the lowest. */
+		const std::vector<QualityLevel>& GetLevels() const;
+
+		/**
+		 * @param Milliseconds The frame time to hold.
+		 */
+		void SetTargetFrameTime(float Milliseconds);
+
+		/** @return The frame time held, in milliseconds. */
+		float GetTargetFrameTime() const;
+
+		/**
+		 * Sets the hysteresis of the level changes.
+		 *
+		 * @param DowngradeRatio Frames slower than the target times this ratio are over budget, above 1.
+		 * @param UpgradeRatio Frames faster than the target times this ratio are under budget, below 1.
+		 * @param DowngradeFrames Consecutive frames over budget before the level drops.
+		 * @param UpgradeFrames Consecutive frames under budget before the level rises, longer so quality comes back cautiously.
+		 */
+		void SetHysteresis(float DowngradeRatio, float UpgradeRatio, uint32_t DowngradeFrames, uint32_t UpgradeFrames);
+
+		/**
+		 * Sets the level the governor continues from and forgets the measured frames.
+		 *
+		 * @param Level The index of the level, clamped to the ladder.
+		 */
+		void Reset(size_t Level = 0);
+
+		/**
+		 * Feeds the times of one frame.
+		 *
+		 * @param FrameTime The time of the whole frame, e.g. TimeManager::GetDeltaTimeSeconds(), in milliseconds.
+		 * @param GPUFrameTime The GPU time of a recent frame in milliseconds, 0 if none was measured.
+		 * @return True if the level changed.
+		 */
+		bool Update(float FrameTime, float GPUFrameTime);
+
+		/** @return The index of the current level, 0 being the highest quality. */
+		size_t GetLevel() const;
+
+		/** @return The settings of the current level. */
+		const QualityLevel& GetCurrentLevel() const;
+
+		/** @return The state of the governor, for telemetry. */
+		const QualityGovernorState& GetState() const;
+
+	private:
+		/** Moves to a level and starts the budget counts over. */
+		void ChangeLevel(size_t Level);
+
+		std::vector<QualityLevel> m_Levels;         ///< The ladder, highest quality first.
+		float m_TargetFrameTime = 1000.0f / 60.0f;  ///< Frame time held, in milliseconds.
+		float m_DowngradeRatio = 1.1f;              ///< Over budget above the target times this.
+		float m_UpgradeRatio = 0.75f;               ///< Under budget below the target times this.
+		uint32_t m_DowngradeFrames = 30;            ///< Frames over budget before dropping a level.
+		uint32_t m_UpgradeFrames = 180;             ///< Frames under budget before rising a level.
+		QualityGovernorState m_State;               ///< Telemetry, and the current level.
+	};
+
+} // namespace fgl
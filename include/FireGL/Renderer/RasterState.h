@@ -0,0 +1,34 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+
+#include <External/glad/glad.h>
+
+namespace fgl
+{
+
+	/** Which faces the rasterizer discards. */
+	enum class CullMode : uint8_t
+	{
+		None,   ///< Both faces are drawn, for open or double-sided surfaces.
+		Back,   ///< Faces wound clockwise on screen are discarded.
+		Front   ///< Faces wound counter-clockwise on screen are discarded, e.g. to draw the inside of a volume.
+	};
+
+	/**
+	 * Fixed-function state a Material draws with (see Material::SetRasterState()), applied through
+	 * GLStateCache only when it differs from the current one.
+	 *
+	 * Front faces are wound counter-clockwise, as in Assimp imports and the built-in shapes. Blending isn't
+	 * part of it: transparent materials are drawn by their own pass, see Material::SetBlendMode().
+	 */
+	struct RasterState
+	{
+		CullMode Cull = CullMode::Back;  ///< Back faces of closed meshes are hidden, culling them saves their fragment work.
+		GLenum DepthFunc = GL_LESS;      ///< Depth comparison, ignored while a pass overrides the depth state.
+		bool bDepthWrite = true;         ///< Whether fragments write their depth, ignored while a pass overrides the depth state.
+
+		bool operator==(const RasterState&) const = default;
+	};
+
+} // namespace fgl
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+#include <FireGL/Renderer/Shader.h>
+#include <FireGL/Renderer/RenderTarget.h>
+
+#include <External/glm/vec3.hpp>
+#include <External/glad/glad.h>
+
+namespace fgl
+{
+	class Renderer;
+	class Scene;
+	class BaseCamera;
+
+	/** Resolution, quality and update budget of ReflectionProbes. */
+	struct ReflectionProbeSettings
+	{
+		int Resolution = 128;          ///< Face size of the probes' cube maps, at least 1 << (PrefilteredLevels - 1).
+		int PrefilterSamples = 64;     ///< GGX samples per texel of the rough levels.
+		float Near = 0.1f;             ///< Near plane of the captures.
+		float Far = 500.0f;            ///< Far plane of the captures.
+		float LODBias = 0.25f;         ///< Scale of the projected sizes in the captures, below 1 draws simpler levels of detail.
+		uint32_t FacesPerUpdate = 1;   ///< Faces captured by every Update(), at least 1.
+		bool bContinuous = false;      ///< Keeps capturing every probe in turn, instead of only the ones marked dirty.
+	};
+
+	/**
+	 * Cube maps of the scene captured from a few points, the local reflections of the objects around them.
+	 *
+	 * Every probe captures its six faces with Renderer::RenderCapture(), a reduced frame drawing simpler levels
+	 * of detail, then convolves them once into the GGX mip chain of its layer of a cube map array: level 0 is a
+	 * mirror, the last one a roughness of 1, as in ImageBasedLighting. Update() spends a budget of faces per
+	 * call, FacesPerUpdate, so a refresh spreads over frames: with the default of one face per frame, a probe
+	 * takes six frames. The faces are captured into a staging cube map and only the finished probe is
+	 * convolved into the array, so a probe never shows half of a refresh.
+	 * Probes are captured when added and when marked dirty, e.g. after the scene changed around them; with
+	 * bContinuous they keep being refreshed in turn, one face per frame following the dynamic objects.
+	 *
+	 * AssignNearest() gives every object the probe whose radius holds the center of its bounds, the closest
+	 * one if several do. The probe travels in the instance data, the second component of location 12, as its
+	 * index plus 1 (see SceneObject::SetReflectionProbe()). The array is bound to TextureUnit as SamplerName,
+	 * registered in the shaders' default samplers, and sampled as
+	 *
+	 *     uniform samplerCubeArray ReflectionProbeMaps;
+	 *     textureLod(ReflectionProbeMaps, vec4(R, float(Probe - 1u)), Roughness * (PrefilteredLevels - 1))
+	 *
+	 * Requires OpenGL 4.0 for the cube map array.
+	 */
+	class ReflectionProbes
+	{
+	public:
+		static constexpr uint32_t TextureUnit = 26;                         ///< Texture unit the probes are sampled from.
+		static constexpr const char* SamplerName = "ReflectionProbeMaps";   ///< Name of the probes' sampler in GLSL.
+		static constexpr uint32_t MaxProbes = 16;                           ///< Layers of the cube map array.
+		static constexpr int PrefilteredLevels = 5;                         ///< Mip levels of every probe, from roughness 0 to 1.
+		static constexpr GLint SourceUnit = 0;                              ///< Texture unit of the staging cube map while it is convolved.
+
+		ReflectionProbes() = default;
+
+		/** Deletes the textures. */
+		~ReflectionProbes();
+
+		ReflectionProbes(const ReflectionProbes&) = delete;
+		ReflectionProbes& operator=(const ReflectionProbes&) = delete;
+
+		/**
+		 * Creates the cube map array and binds it to TextureUnit. Requires a current OpenGL context.
+		 *
+		 * @param Settings The resolution, quality and update budget of the probes.
+		 */
+		void Create(const ReflectionProbeSettings& Settings = ReflectionProbeSettings());
+
+		/** Deletes the textures, the shader and the probes. */
+		void Destroy();
+
+		/** @return True once Create() was called. */
+		bool IsCreated() const;
+
+		/** @return The settings, read by every Update(); the resolution only applies on Create(). */
+		ReflectionProbeSettings& GetSettings();
+
+		/**
+		 * Adds a probe, captured by the next updates.
+		 *
+		 * @param Position The point the probe captures the scene from.
+		 * @param Radius The distance it reflects objects within, see AssignNearest().
+		 * @return The index of the probe, or UINT32_MAX once MaxProbes are added.
+		 */
+		uint32_t AddProbe(const glm::vec3& Position, float Radius);
+
+		/**
+		 * Moves a probe and marks it dirty.
+		 *
+		 * @param Probe The index of the probe.
+		 * @param Position The point the probe captures the scene from.
+		 * @param Radius The distance it reflects objects within.
+		 */
+		void SetProbe(uint32_t Probe, const glm::vec3& Position, float Radius);
+
+		/** @return The number of probes. */
+		uint32_t GetProbeCount() const;
+
+		/**
+		 * Queues a probe for capture, e.g. after objects around it moved or changed.
+		 *
+		 * @param Probe The index of the probe.
+		 */
+		void MarkDirty(uint32_t Probe);
+
+		/** Queues every probe for capture, e.g. after the lights changed. */
+		void MarkAllDirty();
+
+		/** @return True while a probe waits for or is in the middle of a capture. */
+		bool IsUpdating() const;
+
+		/**
+		 * Captures up to FacesPerUpdate faces of the dirty probes, or of every probe in turn with bContinuous,
+		 * and convolves the probes whose six faces are done. Call it once per frame before Renderer::Render(),
+		 * or PrepareFrame() and the render thread's Render().
+		 *
+		 * @param Target The renderer drawing the captures.
+		 * @param Scene The Scene to capture.
+		 */
+		void Update(Renderer& Target, Scene* Scene);
+
+		/**
+		 * Gives every object of a Scene the probe whose radius holds the center of its bounds, the closest one
+		 * if several do, none if none does. Costs objects times probes distance tests: call it once the objects
+		 * and probes are placed, and before Scene::BuildStaticGeometry() which bakes the probes into its chunks,
+		 * then each frame for the objects that move.
+		 *
+		 * @param Scene The Scene whose objects are assigned.
+		 */
+		void AssignNearest(Scene* Scene) const;
+
+		/** Binds the cube map array to TextureUnit. */
+		void Bind() const;
+
+		/** @return The cube map array, 0 before Create(). */
+		GLuint GetProbeMaps() const;
+
+	private:
+		/** A point the scene is captured from. */
+		struct Probe
+		{
+			glm::vec3 Position;  ///< Center of the captures.
+			float Radius;        ///< Distance the probe reflects objects within.
+			bool bDirty;         ///< Whether the probe waits for a capture.
+		};
+
+		/** Draws one face of the probe being captured into the staging cube map. */
+		void CaptureFace(Renderer& Target, Scene* Scene);
+
+		/** Convolves the staging cube map into the layer of the probe just captured. */
+		void Prefilter();
+
+		/** @return The next probe to capture, UINT32_MAX if none. */
+		uint32_t SelectNextProbe();
+
+		ReflectionProbeSettings m_Settings;          ///< Resolution, quality and budget.
+		std::vector<Probe> m_Probes;                 ///< Every probe, by index.
+		GLuint m_ProbeMaps = 0;                      ///< GL_RGB16F cube map array, one layer of 6 faces per probe.
+		GLuint m_StagingMap = 0;                     ///< GL_RGB16F cube map the faces are copied to, mipmapped for the convolution.
+		GLuint m_Framebuffer = 0;                    ///< Draw framebuffer of the copies and the convolution.
+		GLuint m_FullScreenVertexArray = 0;          ///< Empty vertex array, the triangle is generated from gl_VertexID.
+		RenderTarget m_CaptureTarget;                ///< Single-sampled target a face is drawn into.
+		std::shared_ptr<BaseCamera> m_CaptureCamera; ///< 90 degrees square view of the captures.
+		std::unique_ptr<Shader> m_PrefilterShader;   ///< GGX convolution of the staging cube map.
+		uint32_t m_CurrentProbe = UINT32_MAX;        ///< Probe whose faces are being captured, UINT32_MAX between captures.
+		uint32_t m_CurrentFace = 0;                  ///< Next face of m_CurrentProbe to capture.
+		uint32_t m_NextContinuous = 0;               ///< Next probe refreshed in continuous mode.
+	};
+
+} // namespace fgl
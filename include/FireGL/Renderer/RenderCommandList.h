@@ -0,0 +1,175 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+#include <FireGL/Renderer/RenderQueue.h>
+
+#include <mutex>
+
+namespace fgl
+{
+	class Shader;
+	class Material;
+	class BaseMesh;
+	class SceneObject;
+	struct RenderProxy;
+	struct MeshDrawInfo;
+
+	/** What a RenderCommand does on replay. */
+	enum class RenderCommandType : uint8_t
+	{
+		BindShader,       ///< Activates Shader, the next material binds its state again.
+		BindMaterial,     ///< Activates Material: program, textures and uniforms.
+		SetInstanceRange, ///< Sets the instances the following draws of the packet cover.
+		DrawMesh,         ///< Draws Mesh with the bound state, without binding its material.
+		DrawMeshInfo,     ///< Draws DrawInfo with the bound state, without binding its material.
+		DrawObject,       ///< Renders Object, which binds the material of each of its meshes.
+		Invoke,           ///< Calls Function with Data, for pass state such as color masks or depth tests.
+		PushDebugGroup,   ///< Opens the debug group Label for capture tools, see GLDebug.
+		PopDebugGroup     ///< Closes the innermost debug group.
+	};
+
+	/** One recorded command, the fields used depend on Type. */
+	struct RenderCommand
+	{
+		RenderCommandType Type = RenderCommandType::Invoke; ///< Selects the fields below.
+		uint32_t LOD = 0;                                   ///< Level of detail of draws.
+		union
+		{
+			Shader* Program;                                ///< BindShader.
+			Material* BoundMaterial;                        ///< BindMaterial.
+			const BaseMesh* Mesh;                           ///< DrawMesh.
+			const MeshDrawInfo* DrawInfo;                   ///< DrawMeshInfo.
+			const SceneObject* Object;                      ///< DrawObject.
+			void* Data;                                     ///< Invoke.
+			const char* Label;                              ///< PushDebugGroup.
+		};
+		void (*Function)(void*) = nullptr;                  ///< Invoke.
+		size_t InstanceCount = 0;                           ///< SetInstanceRange.
+		size_t BaseInstance = 0;                            ///< SetInstanceRange.
+
+		RenderCommand() : Data(nullptr) {}
+	};
+
+	/**
+	 * Linear buffer of render commands recorded by one thread, grouped in sorted packets.
+	 *
+	 * BeginPacket() starts a packet with a RenderQueue sort key; the commands recorded until the next packet
+	 * are replayed together, in recording order, at the place of the key among the packets of every list
+	 * submitted with it. Nothing calls OpenGL while recording, so lists can be filled by worker threads and
+	 * replayed by RenderCommandQueue::Submit() on the thread owning the context. A list is the recording half of
+	 * the RenderDevice command-list type: each packet reaches RenderDevice::ExecuteCommands() as a
+	 * RenderCommandPacket. Storage is kept across frames.
+	 */
+	class RenderCommandList
+	{
+	public:
+		/**
+		 * Starts a packet. Its instance range starts at one instance from instance 0.
+		 *
+		 * @param SortKey Key built with RenderQueue::MakeSortKey(), lower keys are replayed first.
+		 */
+		void BeginPacket(uint64_t SortKey);
+
+		/** Records the activation of a shader program, e.g. the one of a depth-only pass. */
+		void BindShader(Shader* Program);
+
+		/** Records the activation of a material. */
+		void BindMaterial(Material* BoundMaterial);
+
+		/**
+		 * Records the instances the following draws of the packet cover.
+		 *
+		 * @param InstanceCount The number of instances drawn.
+		 * @param BaseInstance The first instance, in the instance buffer bound on replay.
+		 */
+		void SetInstanceRange(size_t InstanceCount, size_t BaseInstance);
+
+		/** Records a draw of a mesh with the state bound before it, see BaseMesh::Draw(). */
+		void DrawMesh(const BaseMesh& Mesh, uint32_t LOD = 0);
+
+		/** Records a draw of a captured mesh level with the state bound before it, see RenderProxy::GetDraws(). Info must outlive the replay. */
+		void DrawMeshInfo(const MeshDrawInfo& Info);
+
+		/** Records the rendering of an object with its own materials, see SceneObject::Render(). */
+		void DrawObject(const SceneObject& Object, uint32_t LOD = 0);
+
+		/**
+		 * Records the draws of an object's captured meshes, each after the activation of its material.
+		 * Draws what DrawObject() does for shapes and models without calling the object, so no render hook runs,
+		 * and reads the packed draw info of the proxy rather than the meshes once they are uploaded.
+		 */
+		void DrawProxy(const RenderProxy& Proxy, uint32_t LOD = 0);
+
+		/**
+		 * Records a call, replayed on the GL thread.
+		 *
+		 * @param Function The function to call, usually a captureless lambda.
+		 * @param Data Passed to Function, must outlive the replay.
+		 */
+		void Invoke(void (*Function)(void*), void* Data);
+
+		/**
+		 * Records the opening of a debug group, closed by PopDebugGroup() within the same packet.
+		 * Recorded through FGL_GL_* guards by the renderer, so Release builds carry none.
+		 *
+		 * @param Label The name of the group, which must outlive the replay.
+		 */
+		void PushDebugGroup(const char* Label);
+
+		/** Records the closing of the innermost debug group. */
+		void PopDebugGroup();
+
+		/** Removes every packet and command, keeping the storage. */
+		void Clear();
+
+		/** @return True if nothing was recorded. */
+		bool IsEmpty() const { return m_Packets.empty(); }
+
+	private:
+		friend class RenderCommandQueue;
+
+		/** Commands of one sort key. */
+		struct Packet
+		{
+			uint64_t Key;   ///< Sort key.
+			uint32_t First; ///< Index of the first command in m_Commands.
+			uint32_t Count; ///< Number of commands.
+		};
+
+		/** Appends a command to the current packet. */
+		RenderCommand& Push(RenderCommandType Type);
+
+		std::vector<RenderCommand> m_Commands; ///< Every command, packet after packet.
+		std::vector<Packet> m_Packets;         ///< Packets, in recording order.
+	};
+
+	/**
+	 * Hands out command lists to the threads recording a pass, then replays them in sorted order.
+	 *
+	 * Each recording thread or job acquires its own list, so recording needs no lock beyond AcquireList().
+	 * Submit() merges the packets of every acquired list, radix-sorts them by key (packets with equal keys keep
+	 * the order of their lists, then their recording order) and replays them through RenderDevice::ExecuteCommands()
+	 * on the calling thread, which must own the OpenGL context.
+	 */
+	class RenderCommandQueue
+	{
+	public:
+		/**
+		 * Acquires an empty list, reused from earlier frames. Thread-safe.
+		 *
+		 * @return The list, valid until Submit().
+		 */
+		RenderCommandList& AcquireList();
+
+		/** Replays the packets of every acquired list in key order, then releases and clears the lists. */
+		void Submit();
+
+	private:
+		std::vector<std::unique_ptr<RenderCommandList>> m_Lists; ///< Lists of every frame so far, the first m_AcquiredCount in use.
+		size_t m_AcquiredCount = 0;                              ///< Lists handed out since the last Submit().
+		std::mutex m_Mutex;                                      ///< Guards the two members above.
+		RenderQueue m_Order;                                     ///< Packet keys, the payload indexes m_PacketRefs.
+		std::vector<std::pair<uint32_t, uint32_t>> m_PacketRefs; ///< List and packet index of every queued packet.
+	};
+
+} // namespace fgl
@@ -0,0 +1,459 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+#include <FireGL/Renderer/GPUMemoryTracker.h>
+#include <FireGL/Renderer/RasterState.h>
+#include <FireGL/Renderer/SamplerCache.h>
+#include <FireGL/Renderer/RenderCommandList.h>
+
+#include <span>
+
+namespace fgl
+{
+	class Shader;
+	struct ImageData;
+
+	/** Graphics API a RenderDevice drives. */
+	enum class RenderBackend : uint8_t
+	{
+		OpenGL ///< OpenGL 4.1+ through glad, on the context of the Window.
+	};
+
+	/** How often the contents of a buffer change, a hint for where the backend places it. */
+	enum class BufferUsage : uint8_t
+	{
+		Static,  ///< Written once or rarely, read by many draws.
+		Dynamic, ///< Rewritten in part every few frames.
+		Stream,    ///< Rewritten every frame.
+		Persistent ///< Immutable storage mapped for writes for its whole lifetime, see BufferHandle::Mapped.
+	};
+
+	/** Parameters of RenderDevice::CreateBuffer(). */
+	struct BufferDesc
+	{
+		size_t Size = 0;                                         ///< Bytes of the buffer.
+		BufferUsage Usage = BufferUsage::Static;                 ///< Update frequency hint.
+		GPUMemoryCategory Category = GPUMemoryCategory::Geometry; ///< Category the buffer is tracked under by the GPUMemoryTracker.
+		std::string_view Owner;                                  ///< Class or asset creating the buffer, for the tracker and capture tools.
+	};
+
+	/** A buffer created by a RenderDevice, copied by value; 0 is no buffer. */
+	struct BufferHandle
+	{
+		uint32_t ID = 0;                         ///< Name of the buffer in its backend: the OpenGL buffer name.
+		size_t Size = 0;                         ///< Bytes of the buffer.
+		BufferUsage Usage = BufferUsage::Static; ///< Usage the buffer was created with.
+		void* Mapped = nullptr;                  ///< Writable view of the whole buffer, BufferUsage::Persistent only.
+
+		/** @return True if the handle refers to a buffer. */
+		explicit operator bool() const { return ID != 0; }
+	};
+
+	/** Texel layout of a texture. */
+	enum class TextureFormat : uint8_t
+	{
+		RGBA8,   ///< 8-bit normalized color, data as 4 bytes per texel.
+		RGBA16F, ///< Half float color, data as 4 half floats per texel.
+		R32F,    ///< Single float channel, data as 1 float per texel.
+		Depth32F, ///< Float depth, data as 1 float per texel.
+		Compressed ///< Blocks of a compressed ImageData in its own format, never written with RenderDevice::UpdateTexture().
+	};
+
+	/** Kind of texture a TextureHandle names, which decides how shaders sample it. */
+	enum class TextureType : uint8_t
+	{
+		Texture2D, ///< One image and its mip chain.
+		CubeMap,   ///< Six square faces, sampled by direction.
+		Array2D    ///< Layers of one size, sampled by layer index.
+	};
+
+	/** How a texture is filtered between texels and between mip levels. */
+	enum class TextureFilter : uint8_t
+	{
+		Nearest, ///< Closest texel of the closest level.
+		Linear   ///< Bilinear within a level, trilinear between levels.
+	};
+
+	/** How a texture is sampled outside [0, 1]. */
+	enum class TextureWrap : uint8_t
+	{
+		Repeat,     ///< The texture tiles.
+		ClampToEdge ///< The edge texels extend, for atlases and screen-sized textures.
+	};
+
+	/** Parameters of RenderDevice::CreateTexture(). */
+	struct TextureDesc
+	{
+		uint32_t Width = 1;                                       ///< Texels of the first level along x.
+		uint32_t Height = 1;                                      ///< Texels of the first level along y.
+		uint32_t Levels = 1;                                      ///< Mip levels, each half the size of the previous one.
+		TextureFormat Format = TextureFormat::RGBA8;              ///< Texel layout.
+		TextureFilter Filter = TextureFilter::Linear;             ///< Sampling filter.
+		TextureWrap Wrap = TextureWrap::Repeat;                   ///< Sampling outside [0, 1].
+		GPUMemoryCategory Category = GPUMemoryCategory::Textures; ///< Category the texture is tracked under by the GPUMemoryTracker.
+		std::string_view Owner;                                   ///< Class or asset creating the texture, for the tracker and capture tools.
+	};
+
+	/** A texture created by a RenderDevice, copied by value; 0 is no texture. */
+	struct TextureHandle
+	{
+		uint32_t ID = 0;                             ///< Name of the texture in its backend: the OpenGL texture name.
+		uint32_t Width = 0;                          ///< Texels of the first level along x.
+		uint32_t Height = 0;                         ///< Texels of the first level along y.
+		TextureFormat Format = TextureFormat::RGBA8; ///< Texel layout, also of the data given to RenderDevice::UpdateTexture().
+		TextureType Type = TextureType::Texture2D;   ///< Kind of texture, the point it is bound to.
+
+		/** @return True if the handle refers to a texture. */
+		explicit operator bool() const { return ID != 0; }
+	};
+
+	/** Parameters of RenderDevice::CreateImageTexture() and RenderDevice::CreateCubeTexture(). */
+	struct ImageTextureDesc
+	{
+		SamplerState Sampler;                                     ///< Wrapping and filtering stored in the texture, for binds without a sampler and bindless handles.
+		int BaseLevel = 0;                                        ///< Finest mip level of the image allocated, see Texture::UploadMipRange().
+		GPUMemoryCategory Category = GPUMemoryCategory::Textures; ///< Category the texture is tracked under by the GPUMemoryTracker.
+		std::string_view Owner;                                   ///< Class or asset creating the texture, for the tracker and capture tools.
+	};
+
+	/** Wrapping and filtering shared by the textures bound with it, owned by the device; 0 samples with the texture's own. */
+	struct SamplerHandle
+	{
+		uint32_t ID = 0; ///< Name of the sampler in its backend: the OpenGL sampler object.
+
+		/** @return True if the handle refers to a sampler. */
+		explicit operator bool() const { return ID != 0; }
+	};
+
+	/** Stage of a shader program. */
+	enum class ShaderStage : uint8_t
+	{
+		Vertex,         ///< Runs once per vertex.
+		Fragment,       ///< Runs once per covered sample.
+		Geometry,       ///< Runs once per primitive, between the vertex and the fragment stages.
+		TessControl,    ///< Sets the tessellation levels of each patch.
+		TessEvaluation, ///< Runs once per tessellated vertex.
+		Compute         ///< Runs alone, in dispatched work groups.
+	};
+
+	/** A shader program created by a RenderDevice, copied by value; 0 is no program. */
+	struct ProgramHandle
+	{
+		uint32_t ID = 0; ///< Name of the program in its backend: the OpenGL program name.
+
+		/** @return True if the handle refers to a program. */
+		explicit operator bool() const { return ID != 0; }
+	};
+
+	/** Vertex input state created by a RenderDevice: attribute layouts and index buffer; 0 is none. */
+	struct VertexArrayHandle
+	{
+		uint32_t ID = 0; ///< Name of the vertex input state in its backend: the OpenGL vertex array name.
+
+		/** @return True if the handle refers to a vertex array. */
+		explicit operator bool() const { return ID != 0; }
+	};
+
+	/** Type of the components of a vertex attribute, as stored in its buffer. */
+	enum class VertexAttributeType : uint8_t
+	{
+		Float,         ///< 32-bit float.
+		HalfFloat,     ///< 16-bit float.
+		Int2101010,    ///< Signed 10:10:10:2 packed into 32 bits, 4 components.
+		UnsignedByte,  ///< 8-bit unsigned integer.
+		UnsignedShort, ///< 16-bit unsigned integer.
+		UnsignedInt    ///< 32-bit unsigned integer.
+	};
+
+	/** An attribute of RenderDevice::SetVertexAttributes(). */
+	struct VertexAttribute
+	{
+		uint32_t Location = 0;                                 ///< Shader input location.
+		uint32_t Components = 4;                               ///< Components per element, 1 to 4.
+		VertexAttributeType Type = VertexAttributeType::Float; ///< Type of the components in the buffer.
+		bool bNormalized = false;                              ///< Integer components reach the shader as floats in [0, 1] or [-1, 1].
+		bool bInteger = false;                                 ///< Integer components reach the shader as integers.
+		size_t Offset = 0;                                     ///< Byte offset of the first element in the buffer.
+	};
+
+	/** Width of the indices of a draw. */
+	enum class IndexFormat : uint8_t
+	{
+		UInt16, ///< 16-bit indices.
+		UInt32  ///< 32-bit indices.
+	};
+
+	/** Instanced triangles read through the index buffer of the bound vertex array, see RenderDevice::DrawIndexed(). */
+	struct IndexedDraw
+	{
+		uint32_t IndexCount = 0;                  ///< Indices drawn, three per triangle.
+		uint32_t InstanceCount = 1;               ///< Instances drawn.
+		uint32_t FirstIndex = 0;                  ///< Offset of the first index in the index buffer, in Format units.
+		int32_t BaseVertex = 0;                   ///< Added to every index.
+		uint32_t BaseInstance = 0;                ///< First instance the per-instance attributes read, 0 without RenderDevice::SupportsBaseInstance().
+		IndexFormat Format = IndexFormat::UInt32; ///< Width of the indices.
+	};
+
+	/**
+	 * The commands of one packet of a RenderCommandList, in recording order.
+	 *
+	 * A command list has two halves: RenderCommandList records typed commands on any thread without touching the
+	 * graphics API, and RenderDevice::ExecuteCommands() replays them on the thread owning the context, once
+	 * RenderCommandQueue sorted the packets of every list.
+	 */
+	using RenderCommandPacket = std::span<const RenderCommand>;
+
+	/**
+	 * Program and fixed-function state a draw runs with, bound as one by RenderDevice::BindPipeline().
+	 *
+	 * A value, not a device object: the backend applies only what differs from the bound state, which the
+	 * OpenGL backend leaves to the GLStateCache.
+	 */
+	struct PipelineState
+	{
+		const Shader* Program = nullptr; ///< Program of the draws, nullptr keeps the bound one.
+		RasterState Raster;              ///< Culling and depth state of the draws.
+	};
+
+	/** A point in the command stream the CPU can wait for, copied by value; empty is no fence. */
+	struct FenceHandle
+	{
+		void* Sync = nullptr; ///< Backend fence object: the OpenGL GLsync.
+
+		/** @return True if the handle refers to a fence. */
+		explicit operator bool() const { return Sync != nullptr; }
+	};
+
+	/**
+	 * Backend-neutral interface to the resources of the graphics API.
+	 *
+	 * Code going through a RenderDevice names its resources by handle and never calls the API itself, so it
+	 * runs on any backend the device implements. Buffers, textures and samplers, shader programs, vertex arrays,
+	 * draws, fences, the pipeline state and the replay of command lists go through it: the GeometryArena and the
+	 * meshes drawing from it, Texture loading and binding, Shader programs, Material, the instance and uniform
+	 * buffers, the sky pass and the SkyboxEntity, and everything recorded into a RenderCommandList.
+	 *
+	 * Render targets, compute dispatches, indirect multi-draws, uniforms, program binaries and SPIR-V, texture
+	 * arrays and uploads from the GLUploadThread still call OpenGL, reading the names from the handles (the IDs
+	 * are the OpenGL names with the OpenGL backend), until they move behind the device too.
+	 *
+	 * Calls must come from the thread owning the context, like the rest of the renderer; commands recorded on
+	 * other threads go through RenderCommandList.
+	 */
+	class RenderDevice
+	{
+	public:
+		virtual ~RenderDevice() = default;
+
+		/** @return The device of the current context. Only the OpenGL backend exists for now. */
+		static RenderDevice& Get();
+
+		/** @return The graphics API the device drives. */
+		virtual RenderBackend GetBackend() const = 0;
+
+		/**
+		 * Creates a buffer and tracks its memory under Desc.Category.
+		 *
+		 * @param Desc Size, usage and owner of the buffer.
+		 * @param Data Desc.Size bytes to fill it with, or nullptr to leave it undefined.
+		 * @return The buffer.
+		 */
+		virtual BufferHandle CreateBuffer(const BufferDesc& Desc, const void* Data = nullptr) = 0;
+
+		/** Deletes a buffer and forgets its memory. Resets the handle, nothing happens for an empty one. */
+		virtual void DestroyBuffer(BufferHandle& Buffer) = 0;
+
+		/**
+		 * Writes into a buffer. The draws submitted before still read the previous contents.
+		 *
+		 * @param Buffer The buffer written.
+		 * @param Offset First byte written.
+		 * @param Size Bytes written, Offset + Size at most Buffer.Size.
+		 * @param Data Bytes to write.
+		 */
+		virtual void UpdateBuffer(const BufferHandle& Buffer, size_t Offset, size_t Size, const void* Data) = 0;
+
+		/**
+		 * Copies bytes between buffers, or within one buffer when the ranges don't overlap, without a round trip
+		 * through system memory.
+		 */
+		virtual void CopyBuffer(const BufferHandle& Source, size_t SourceOffset, const BufferHandle& Target, size_t TargetOffset, size_t Size) = 0;
+
+		/**
+		 * Replaces a buffer by one of another size, keeping its first bytes.
+		 *
+		 * @param Buffer The buffer replaced, destroyed and set to the new one.
+		 * @param Desc Size, usage and owner of the new buffer.
+		 * @param PreservedBytes Bytes copied from the start of the old buffer, at most both sizes.
+		 */
+		void ResizeBuffer(BufferHandle& Buffer, const BufferDesc& Desc, size_t PreservedBytes);
+
+		/**
+		 * Drops the contents of a buffer, so that the next UpdateBuffer() doesn't wait for the draws still
+		 * reading them. Does nothing for BufferUsage::Persistent buffers, whose storage is immutable.
+		 */
+		virtual void DiscardBuffer(const BufferHandle& Buffer) = 0;
+
+		/** @return Whether BufferUsage::Persistent buffers can be created. */
+		virtual bool SupportsPersistentBuffers() const = 0;
+
+		/**
+		 * Binds a buffer to a uniform block binding point, read by every program whose block is assigned to it.
+		 *
+		 * @param Binding Binding point of the uniform block.
+		 * @param Buffer The buffer, at least the size of the block.
+		 */
+		virtual void BindUniformBuffer(uint32_t Binding, const BufferHandle& Buffer) = 0;
+
+		/**
+		 * Creates a 2D texture and tracks its memory under Desc.Category.
+		 *
+		 * @param Desc Size, format, sampling and owner of the texture.
+		 * @param Data Texels of the first level in Desc.Format, or nullptr to leave every level undefined.
+		 * @return The texture.
+		 */
+		virtual TextureHandle CreateTexture(const TextureDesc& Desc, const void* Data = nullptr) = 0;
+
+		/** Deletes a texture and forgets its memory. Resets the handle, nothing happens for an empty one. */
+		virtual void DestroyTexture(TextureHandle& Texture) = 0;
+
+		/**
+		 * Writes a rectangle of texels into a level of a texture.
+		 *
+		 * @param Texture The texture written.
+		 * @param Level Mip level written.
+		 * @param X, Y First texel written.
+		 * @param Width, Height Texels written along x and y, inside the level.
+		 * @param Data Width * Height tightly packed texels in Texture.Format.
+		 */
+		virtual void UpdateTexture(const TextureHandle& Texture, uint32_t Level, uint32_t X, uint32_t Y, uint32_t Width, uint32_t Height, const void* Data) = 0;
+
+		/**
+		 * Creates a texture from a decoded image and tracks its memory under Desc.Category: a 2D texture, or a cube
+		 * map for the six faces of a compressed container. Compressed images keep their own mip chain, decoded
+		 * pixels get theirs generated.
+		 *
+		 * @param Image The image, holding pixels in a format the context supports (see Texture::DecodeImage()).
+		 * @param Desc Sampling, first level and owner of the texture.
+		 * @return The texture.
+		 */
+		virtual TextureHandle CreateImageTexture(const ImageData& Image, const ImageTextureDesc& Desc) = 0;
+
+		/**
+		 * Creates a cube map of one level from six decoded faces and tracks its memory under Desc.Category.
+		 *
+		 * @param Faces The faces in +X, -X, +Y, -Y, +Z, -Z order, uncompressed pixels of one size.
+		 * @param Desc Sampling and owner of the texture, Desc.BaseLevel is ignored.
+		 * @return The texture.
+		 */
+		virtual TextureHandle CreateCubeTexture(std::span<const ImageData, 6> Faces, const ImageTextureDesc& Desc) = 0;
+
+		/** @return The sampler of a wrapping and filtering state, created on first use and shared by every caller. */
+		virtual SamplerHandle GetSampler(const SamplerState& State) = 0;
+
+		/**
+		 * Binds a texture to a texture unit, read by the samplers of the programs set to that unit.
+		 *
+		 * @param Slot The texture unit.
+		 * @param Texture The texture, an empty handle unbinds the unit.
+		 * @param Sampler Sampling of the texture, the empty handle for its own parameters.
+		 */
+		virtual void BindTexture(uint32_t Slot, const TextureHandle& Texture, SamplerHandle Sampler = {}) = 0;
+
+		/** @return A new program without any stage. */
+		virtual ProgramHandle CreateProgram() = 0;
+
+		/**
+		 * Compiles one stage of a program. The status isn't waited for: it is read once the program is used,
+		 * so a driver compiling in parallel keeps going.
+		 *
+		 * @param Stage The stage.
+		 * @param Code Null-terminated GLSL source of the stage.
+		 * @return The name of the compiled stage in the backend: the OpenGL shader object.
+		 */
+		virtual uint32_t CompileShaderStage(ShaderStage Stage, const char* Code) = 0;
+
+		/**
+		 * Links compiled stages into a program, without waiting for the result.
+		 *
+		 * @param Program The program.
+		 * @param Stages Names from CompileShaderStage(), 0 entries are skipped.
+		 * @param Varyings Outputs of the last vertex stage captured by transform feedback, interleaved.
+		 */
+		virtual void LinkProgram(const ProgramHandle& Program, std::span<const uint32_t> Stages, std::span<const char* const> Varyings = {}) = 0;
+
+		/** Detaches a stage from a linked program and deletes it. Resets the name, nothing happens for 0. */
+		virtual void ReleaseShaderStage(const ProgramHandle& Program, uint32_t& Stage) = 0;
+
+		/** Deletes a program. Resets the handle, nothing happens for an empty one. */
+		virtual void DestroyProgram(ProgramHandle& Program) = 0;
+
+		/** Makes a program the one of the following draws and dispatches. */
+		virtual void BindProgram(const ProgramHandle& Program) = 0;
+
+		/** Binds the program and applies the raster state of the following draws. */
+		virtual void BindPipeline(const PipelineState& State) = 0;
+
+		/**
+		 * Creates a vertex array without attributes nor index buffer.
+		 *
+		 * @param Label Name shown by capture tools.
+		 * @return The vertex array.
+		 */
+		virtual VertexArrayHandle CreateVertexArray(std::string_view Label) = 0;
+
+		/** Deletes a vertex array. Resets the handle, nothing happens for an empty one. */
+		virtual void DestroyVertexArray(VertexArrayHandle& VertexArray) = 0;
+
+		/** Sets the buffer the indexed draws of a vertex array read their indices from. */
+		virtual void SetIndexBuffer(const VertexArrayHandle& VertexArray, const BufferHandle& Buffer) = 0;
+
+		/**
+		 * Points attributes of a vertex array at a buffer of interleaved elements and enables them.
+		 *
+		 * @param VertexArray The vertex array.
+		 * @param Buffer The buffer the attributes read.
+		 * @param Stride Bytes from one element to the next.
+		 * @param Divisor 0 for per-vertex attributes, 1 for attributes advancing once per instance.
+		 * @param Attributes Location, layout and offset of every attribute.
+		 */
+		virtual void SetVertexAttributes(const VertexArrayHandle& VertexArray, const BufferHandle& Buffer, uint32_t Stride, uint32_t Divisor,
+			std::span<const VertexAttribute> Attributes) = 0;
+
+		/** Makes a vertex array the one of the following draws. */
+		virtual void BindVertexArray(const VertexArrayHandle& VertexArray) = 0;
+
+		/** @return Whether IndexedDraw::BaseInstance is honoured, else per-instance attributes must be rebased. */
+		virtual bool SupportsBaseInstance() const = 0;
+
+		/** Draws instanced triangles through the index buffer of the bound vertex array, with the bound pipeline. */
+		virtual void DrawIndexed(const IndexedDraw& Draw) = 0;
+
+		/**
+		 * Draws triangles without index buffer, with the bound pipeline and vertex array.
+		 *
+		 * @param VertexCount Vertices drawn, three per triangle.
+		 * @param InstanceCount Instances drawn.
+		 * @param FirstVertex Index of the first vertex.
+		 */
+		virtual void Draw(uint32_t VertexCount, uint32_t InstanceCount = 1, uint32_t FirstVertex = 0) = 0;
+
+		/**
+		 * Replays one packet of a command list in order. The packet starts at one instance from instance 0,
+		 * SetInstanceRange commands change the instances of the draws after them.
+		 *
+		 * @param Commands The packet, see RenderCommandQueue::Submit().
+		 */
+		virtual void ExecuteCommands(RenderCommandPacket Commands) = 0;
+
+		/** @return A fence signaled once the commands submitted before it are complete. */
+		virtual FenceHandle InsertFence() = 0;
+
+		/** Blocks until a fence is signaled, then destroys it. Nothing happens for an empty one. */
+		virtual void WaitFence(FenceHandle& Fence) = 0;
+
+		/** Destroys a fence without waiting for it. Resets the handle, nothing happens for an empty one. */
+		virtual void DestroyFence(FenceHandle& Fence) = 0;
+	};
+
+} // namespace fgl
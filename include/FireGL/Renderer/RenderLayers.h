@@ -0,0 +1,21 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+
+namespace fgl
+{
+
+	/**
+	 * Set of render layers, one bit per layer.
+	 *
+	 * Scene objects belong to one or more layers (see SceneObject::SetLayers()) and cameras only draw the
+	 * layers of their culling mask (see BaseCamera::SetCullingMask()), e.g. to keep a first-person weapon,
+	 * editor gizmos or UI geometry out of some views. The meaning of each bit is up to the application.
+	 */
+	using LayerMask = uint32_t;
+
+	constexpr uint32_t MaxLayers = 32;      ///< Number of layers a LayerMask can hold.
+	constexpr LayerMask DefaultLayer = 1u;  ///< Layer 0, the one objects start in.
+	constexpr LayerMask AllLayers = ~0u;    ///< Every layer, the default culling mask.
+
+} // namespace fgl
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+
+namespace fgl
+{
+
+	/**
+	 * Single draw submission in a RenderQueue: a sort key and an opaque payload identifying the draw.
+	 */
+	struct RenderQueueItem
+	{
+		uint64_t Key;     ///< Sort key, see RenderQueue::MakeSortKey.
+		uint32_t Payload; ///< Index of the draw in the caller's own storage.
+	};
+
+	/**
+	 * Collects draw submissions with 64-bit sort keys and radix-sorts them every frame.
+	 *
+	 * Keys are laid out from the most to the least expensive state to change:
+	 *
+	 *     | Pass (4) | Shader (12) | Material (16) | Mesh (16) | Depth (16) |
+	 *
+	 * so after sorting, draws sharing a shader, then a material, then a mesh are adjacent and the
+	 * renderer only has to switch state when the corresponding key prefix changes. Depth is ordered
+	 * front to back within identical state, favoring early depth rejection.
+	 *
+	 * Blended draws must be ordered by depth before state instead, back to front (see MakeBackToFrontKey):
+	 *
+	 *     | Pass (4) | Inverted depth (32) | Shader (12) | Material (16) |
+	 */
+	class RenderQueue
+	{
+	public:
+		/**
+		 * Packs the sort criteria of a draw into a key. Each field is truncated to its bit width.
+		 *
+		 * @param Pass        Render pass the draw belongs to (lower passes are drawn first).
+		 * @param ShaderID    OpenGL program ID of the draw.
+		 * @param MaterialID  Material::GetID() of the draw.
+		 * @param MeshID      Identity of the geometry drawn (see SceneObject::GetHash()).
+		 * @param ViewDepth   Distance along the camera's front vector, negative values are clamped to 0.
+		 * @return The sort key.
+		 */
+		static uint64_t MakeSortKey(uint32_t Pass, uint32_t ShaderID, uint32_t MaterialID, size_t MeshID, float ViewDepth);
+
+		/**
+		 * Packs the sort criteria of a blended draw into a key ordering the draws of a pass from the farthest
+		 * to the closest, at full depth precision. Draws at equal depth are grouped by shader and material.
+		 *
+		 * @param Pass        Render pass the draw belongs to (lower passes are drawn first).
+		 * @param ViewDepth   Distance along the camera's front vector, negative values are clamped to 0.
+		 * @param ShaderID    OpenGL program ID of the draw.
+		 * @param MaterialID  Material::GetID() of the draw.
+		 * @return The sort key.
+		 */
+		static uint64_t MakeBackToFrontKey(uint32_t Pass, float ViewDepth, uint32_t ShaderID, uint32_t MaterialID);
+
+		/** Removes every item, keeping the allocated storage for the next frame. */
+		void Clear();
+
+		/**
+		 * Adds a draw to the queue.
+		 *
+		 * @param Key     Sort key built with MakeSortKey.
+		 * @param Payload Index of the draw in the caller's storage.
+		 */
+		void Push(uint64_t Key, uint32_t Payload);
+
+		/** Sorts the items by key with an 8-bit LSD radix sort, skipping passes where every digit is equal. */
+		void Sort();
+
+		/** @return The items, in sorted order after Sort(). */
+		const std::vector<RenderQueueItem>& GetItems() const;
+
+	private:
+		std::vector<RenderQueueItem> m_Items;   ///< Queued draws.
+		std::vector<RenderQueueItem> m_Scratch; ///< Ping-pong storage for the radix sort.
+	};
+
+} // namespace fgl
\ No newline at end of file
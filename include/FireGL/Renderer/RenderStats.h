@@ -0,0 +1,67 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+
+namespace fgl
+{
+
+	/** What the renderer submitted to OpenGL in one frame. */
+	struct RenderStats
+	{
+		uint64_t DrawCalls = 0;        ///< Draw calls issued, a multi-draw indirect call counting once.
+		uint64_t Instances = 0;        ///< Instances drawn, except those of GPU-culled commands, decided on the GPU.
+		uint64_t Triangles = 0;        ///< Triangles drawn, over the same instances.
+		uint64_t ProgramBinds = 0;     ///< glUseProgram calls that reached OpenGL, past the GLStateCache.
+		uint64_t TextureBinds = 0;     ///< glBindTexture calls that reached OpenGL.
+		uint64_t VertexArrayBinds = 0; ///< glBindVertexArray calls that reached OpenGL.
+		uint64_t BytesUploaded = 0;    ///< Bytes written to buffers, by glBuffer(Sub)Data or into mapped storage.
+		uint32_t VisibleObjects = 0;   ///< Objects drawn in batches. Zero with GPU culling, which decides it on the GPU.
+		uint32_t CulledObjects = 0;    ///< Objects rejected by frustum or occlusion culling. Zero with GPU culling.
+		uint32_t Batches = 0;          ///< Batches submitted, every cached batch with GPU culling.
+	};
+
+	/**
+	 * Counters the OpenGL call sites of FireGL add to as they issue draws, binds and uploads.
+	 *
+	 * The renderer collects them once per frame, so a frame's stats hold everything issued since the end of
+	 * the previous one, loading included. Like GLStateCache, the counters assume a single OpenGL context.
+	 */
+	class RenderCounters
+	{
+	public:
+		/** Counts a draw call drawing InstanceCount instances, TriangleCount triangles over all of them. */
+		static void CountDraw(uint64_t InstanceCount, uint64_t TriangleCount)
+		{
+			s_Stats.DrawCalls++;
+			s_Stats.Instances += InstanceCount;
+			s_Stats.Triangles += TriangleCount;
+		}
+
+		/** Counts a program bind. */
+		static void CountProgramBind() { s_Stats.ProgramBinds++; }
+
+		/** Counts a texture bind. */
+		static void CountTextureBind() { s_Stats.TextureBinds++; }
+
+		/** Counts a vertex array bind. */
+		static void CountVertexArrayBind() { s_Stats.VertexArrayBinds++; }
+
+		/** Counts Bytes written to a buffer. */
+		static void CountUpload(size_t Bytes) { s_Stats.BytesUploaded += Bytes; }
+
+		/** Sets the culling results of the frame. */
+		static void SetObjects(uint32_t Visible, uint32_t Culled, uint32_t Batches)
+		{
+			s_Stats.VisibleObjects = Visible;
+			s_Stats.CulledObjects = Culled;
+			s_Stats.Batches = Batches;
+		}
+
+		/** @return The counters since the last call, which are then reset. */
+		static RenderStats Collect();
+
+	private:
+		static RenderStats s_Stats; ///< Counters since the last Collect().
+	};
+
+} // namespace fgl
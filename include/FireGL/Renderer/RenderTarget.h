@@ -0,0 +1,103 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+
+#include <External/glad/glad.h>
+
+namespace fgl
+{
+	class Shader;
+
+	/**
+	 * Offscreen framebuffer with a color and a depth / stencil attachment.
+	 *
+	 * Single-sample targets render straight into textures. Multisampled targets render into multisampled
+	 * renderbuffers and Resolve() averages them into the same textures, so the result is always read from
+	 * GetColorTexture() and GetDepthTexture() whatever the sample count.
+	 *
+	 * Present() draws the color texture over the viewport of the bound framebuffer with bilinear filtering.
+	 * It draws a full-screen triangle rather than blitting: blits can't scale into the multisampled default
+	 * framebuffer the window is created with.
+	 */
+	class RenderTarget
+	{
+	public:
+		static constexpr uint32_t PresentUnit = 0; ///< Texture unit the color texture is read from by Present().
+
+		/** Releases the framebuffers and their attachments. */
+		~RenderTarget();
+
+		/**
+		 * (Re)creates the attachments if the size, sample count or color format changed. Requires a current OpenGL context.
+		 *
+		 * @param Width       The width of the attachments in pixels.
+		 * @param Height      The height of the attachments in pixels.
+		 * @param Samples     Samples per pixel, 0 or 1 for a single-sample target.
+		 * @param ColorFormat The sized internal format of the color attachment, e.g. GL_RGBA16F to keep values above 1.
+		 */
+		void Resize(int Width, int Height, int Samples = 0, GLenum ColorFormat = GL_RGBA8);
+
+		/** Deletes the framebuffers, their attachments and the present shader. */
+		void Destroy();
+
+		/** Binds the framebuffer for drawing and sets the viewport to its size. */
+		void Bind() const;
+
+		/** Averages the samples of a multisampled target into its textures. Does nothing for single-sample targets. */
+		void Resolve() const;
+
+		/**
+		 * Draws the resolved color over the viewport of the bound framebuffer, scaled with bilinear filtering.
+		 * Depth testing is off while drawing; changes the program, vertex array and texture unit PresentUnit.
+		 */
+		void Present();
+
+		/** @return The framebuffer drawn into, multisampled if the target is. */
+		GLuint GetFramebuffer() const;
+
+		/** @return The single-sample framebuffer of the textures, the one to read after Resolve(). */
+		GLuint GetResolveFramebuffer() const;
+
+		/** @return The resolved color texture, of the format given to Resize(). */
+		GLuint GetColorTexture() const;
+
+		/** @return The resolved depth / stencil texture, GL_DEPTH24_STENCIL8. */
+		GLuint GetDepthTexture() const;
+
+		/** @return The width of the attachments in pixels. */
+		int GetWidth() const;
+
+		/** @return The height of the attachments in pixels. */
+		int GetHeight() const;
+
+		/** @return The samples per pixel, 0 for a single-sample target. */
+		int GetSamples() const;
+
+		/** @return The internal format of the color attachment. */
+		GLenum GetColorFormat() const;
+
+	private:
+		/** Creates a 2D texture of the current size. */
+		GLuint CreateTexture(GLenum InternalFormat, GLenum Format, GLenum Type) const;
+
+		/** Creates a multisampled renderbuffer of the current size and sample count. */
+		GLuint CreateRenderbuffer(GLenum InternalFormat) const;
+
+		/** Deletes the framebuffers and their attachments, keeping the present shader. */
+		void DestroyAttachments();
+
+		GLuint m_Framebuffer = 0;           ///< Framebuffer drawn into.
+		GLuint m_ResolveFramebuffer = 0;    ///< Framebuffer of the textures, m_Framebuffer itself without multisampling.
+		GLuint m_ColorTexture = 0;          ///< Resolved color.
+		GLuint m_DepthTexture = 0;          ///< Resolved depth / stencil.
+		GLuint m_ColorRenderbuffer = 0;     ///< Multisampled color, 0 without multisampling.
+		GLuint m_DepthRenderbuffer = 0;     ///< Multisampled depth / stencil, 0 without multisampling.
+		GLuint m_FullScreenVertexArray = 0; ///< Empty vertex array, the full-screen triangle is generated from gl_VertexID.
+		std::unique_ptr<Shader> m_PresentShader; ///< Samples the color texture over the viewport, compiled on first use.
+		int m_Width = 0;                    ///< Width of the attachments.
+		int m_Height = 0;                   ///< Height of the attachments.
+		int m_Samples = 0;                  ///< Samples per pixel, 0 without multisampling.
+		GLenum m_ColorFormat = GL_RGBA8;    ///< Internal format of the color attachment.
+	};
+
+} // namespace fgl
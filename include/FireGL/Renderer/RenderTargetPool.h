@@ -0,0 +1,82 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+
+#include <External/glad/glad.h>
+
+namespace fgl
+{
+	/** A color-only, single-sample framebuffer lent by a RenderTargetPool. */
+	struct PooledTarget
+	{
+		GLuint Framebuffer = 0; ///< Framebuffer with Texture as its only color attachment.
+		GLuint Texture = 0;     ///< Color texture, bilinear filtered and clamped to the edges.
+		int Width = 0;          ///< Width in pixels.
+		int Height = 0;         ///< Height in pixels.
+		GLenum Format = 0;      ///< Sized internal format of Texture.
+	};
+
+	/**
+	 * Intermediate color targets shared by full-screen passes and kept across frames.
+	 *
+	 * Acquire() hands out a free target of the requested size and format, creating one only when none is free,
+	 * and Release() gives it back for the next Acquire() of the frame. A chain of passes that acquires its
+	 * output and releases its input as it goes holds two targets of a size at once, whatever its length, and
+	 * frames reuse the targets of the previous ones: nothing is created at steady state. EndFrame() deletes
+	 * the targets no Acquire() asked for during MaxIdleFrames frames, e.g. the sizes of a window since resized.
+	 */
+	class RenderTargetPool
+	{
+	public:
+		static constexpr uint32_t MaxIdleFrames = 60; ///< Frames a free target is kept unused before EndFrame() deletes it.
+
+		RenderTargetPool() = default;
+
+		/** Deletes the targets. */
+		~RenderTargetPool();
+
+		RenderTargetPool(const RenderTargetPool&) = delete;
+		RenderTargetPool& operator=(const RenderTargetPool&) = delete;
+
+		/**
+		 * Lends a target until Release(). Its content is undefined. Requires a current OpenGL context.
+		 *
+		 * @param Width The width in pixels, at least 1.
+		 * @param Height The height in pixels, at least 1.
+		 * @param Format The sized internal format of the color texture, e.g. GL_RGBA16F.
+		 * @return A target no other Acquire() holds.
+		 */
+		PooledTarget Acquire(int Width, int Height, GLenum Format);
+
+		/**
+		 * Gives a target back to the pool, free for the next Acquire() of its size and format.
+		 *
+		 * @param Target A target returned by Acquire() and not released since.
+		 */
+		void Release(const PooledTarget& Target);
+
+		/** Deletes the free targets unused for MaxIdleFrames frames. Call once per frame. */
+		void EndFrame();
+
+		/** Deletes every target, the lent ones included. */
+		void Destroy();
+
+		/** @return The number of targets alive, lent or free. */
+		size_t GetTargetCount() const;
+
+	private:
+		/** One target and its use. */
+		struct Entry
+		{
+			PooledTarget Target;       ///< The framebuffer and its texture.
+			bool bInUse = false;       ///< Whether an Acquire() holds it.
+			uint32_t IdleFrames = 0;   ///< Frames since it was last acquired.
+		};
+
+		/** Deletes the framebuffer and the texture of a target. */
+		static void DeleteTarget(const PooledTarget& Target);
+
+		std::vector<Entry> m_Entries; ///< Every target alive.
+	};
+
+} // namespace fgl
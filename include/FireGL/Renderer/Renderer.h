@@ -2,13 +2,60 @@
 
 #include <FireGL/fglpch.h>
 #include <FireGL/Renderer/MatrixBuffer.h>
+#include <FireGL/Renderer/CameraUniformBuffer.h>
+#include <FireGL/Renderer/LightUniformBuffer.h>
+#include <FireGL/Renderer/RenderQueue.h>
+#include <FireGL/Renderer/RenderCommandList.h>
+#include <FireGL/Renderer/IndirectDrawBuffer.h>
+#include <FireGL/Renderer/GeometryArena.h>
+#include <FireGL/Renderer/MaterialBuffer.h>
+#include <FireGL/Renderer/MaterialInstanceBuffer.h>
+#include <FireGL/Renderer/ClusteredLightManager.h>
+#include <FireGL/Renderer/ObjectLightAssigner.h>
+#include <FireGL/Renderer/GPUCulling.h>
+#include <FireGL/Renderer/HiZBuffer.h>
+#include <FireGL/Renderer/OcclusionQueries.h>
+#include <FireGL/Renderer/CascadedShadowMaps.h>
+#include <FireGL/Renderer/LocalShadowAtlas.h>
+#include <FireGL/Renderer/GBuffer.h>
+#include <FireGL/Renderer/TransparencyBuffer.h>
+#include <FireGL/Renderer/BonePaletteBuffer.h>
+#include <FireGL/Renderer/RenderTarget.h>
+#include <FireGL/Renderer/PostProcessStack.h>
+#include <FireGL/Renderer/AmbientOcclusion.h>
+#include <FireGL/Renderer/VolumetricFog.h>
+#include <FireGL/Renderer/Lightmap.h>
+#include <FireGL/Renderer/ImpostorAtlas.h>
+#include <FireGL/Renderer/FrameCapture.h>
+#include <FireGL/Renderer/ObjectPicker.h>
+#include <FireGL/Renderer/ResolutionController.h>
+#include <FireGL/Renderer/QualityGovernor.h>
+#include <FireGL/Renderer/GPUProfiler.h>
+#include <FireGL/Renderer/DebugDraw.h>
+#include <FireGL/Renderer/RenderStats.h>
+#include <FireGL/Renderer/Frustum.h>
+#include <FireGL/Renderer/RenderLayers.h>
+#include <FireGL/Core/FrameArena.h>
+#include <FireGL/Core/FlatHashMap.h>
 
 #include <External/glm/mat4x4.hpp>
 
+#include <span>
+
 namespace fgl
 {
 	class Scene;
 	class SceneObject;
+	class Material;
+	class Shader;
+	class Texture;
+	class ParticleSystem;
+	class SpriteBatch;
+	class Terrain;
+	class DynamicMesh;
+	class BaseMesh;
+	class JobSystem;
+	class PortalGraph;
 
 	/**
 	 * Enumeration representing different rendering modes.
@@ -17,7 +64,26 @@ namespace fgl
 	{
 		Default,   ///< Standard rendering mode
 		DebugLine, ///< Renders object outlines as lines
-		DebugFill  ///< Renders object meshes with solid fill for debugging
+		DebugFill, ///< Renders object meshes with solid fill for debugging
+		Deferred   ///< Writes surfaces to a G-buffer, then resolves their lighting in one full-screen pass
+	};
+
+	/**
+	 * How the transparent pass blends the objects of transparent materials (see Material::SetBlendMode()).
+	 */
+	enum class TransparencyMode
+	{
+		Sorted,         ///< Every object blended over the image, sorted back to front each frame
+		WeightedBlended ///< Order-independent accumulation, one instanced draw per batch (see TransparencyBuffer)
+	};
+
+	/**
+	 * One of the views RenderViews() draws in a frame, e.g. a player of a split-screen or an eye of a stereo pair.
+	 */
+	struct RenderView
+	{
+		BaseCamera* Camera = nullptr;                    ///< Camera the view is drawn from, its view and projection up to date
+		glm::vec4 Rectangle{ 0.0f, 0.0f, 1.0f, 1.0f };   ///< Left, bottom, width and height, in fractions of the viewport
 	};
 
 	/**
@@ -25,7 +91,7 @@ namespace fgl
 	 *
 	 * This class manages drawing objects in a Scene and updating Model-View-Projection (MVP)
 	 * matrices for instanced rendering. It supports different rendering modes, such as Default,
-	 * Debug Line, and Debug Fill, enabling visualization and debugging options.
+	 * Debug Line, and Debug Fill, enabling visualization and debugging options, and Deferred shading.
 	 */
 	class Renderer
 	{
@@ -45,10 +111,29 @@ namespace fgl
 		 *
 		 * This function clears the screen, processes the Scene to group objects by mesh,
 		 * updates transformations, and performs instanced rendering.
+		 * Nothing is drawn while the window isn't presentable (see BaseWindow::IsPresentable()).
 		 *
 		 * @param TargetScene A pointer to the Scene to render.
 		 */
 		void Render(Scene* Scene);
+
+		/**
+		 * Prepares the next Render() on the calling thread, for a render thread to draw it while the next frame is simulated.
+		 *
+		 * Recalculates the changed matrices and bounds, then snapshots what the simulation could change under the
+		 * frame: the matrices (TransformPool::CaptureSnapshot()), the active camera's view, the edited materials
+		 * (Material::CaptureChanges()) and the lights, which Render() then draws instead of the live ones. The
+		 * Scene's object list changes are deferred from now on and applied by the next call (see
+		 * Scene::SetDeferredChanges()). Polls the input first with late latching.
+		 *
+		 * The intended loop, with the window's render thread running (see BaseWindow::SetRenderThread()):
+		 * process the input and the Scene on the main thread, wait for the render thread, call PrepareFrame(),
+		 * then submit a frame calling Render() and BaseWindow::SwapBuffers().
+		 * Call Scene::SetDeferredChanges(false) when going back to rendering without it.
+		 *
+		 * @param Scene The Scene the next Render() draws.
+		 */
+		void PrepareFrame(Scene* Scene);
 		
 		/**
 		 * Updates the rendering mode dynamically.
@@ -60,7 +145,625 @@ namespace fgl
 		 */		
 		void ConfigureRenderingMode(RenderingMode NewMode);
 
+		/**
+		 * Enables or disables frustum culling.
+		 * When enabled (the default), objects whose bounding sphere lies outside the active camera's
+		 * frustum are skipped before MVP generation and never reach the instance buffer.
+		 *
+		 * @param bEnabled True to cull objects outside the view frustum.
+		 */
+		void SetFrustumCulling(bool bEnabled);
+
+		/**
+		 * Enables or disables level of detail selection.
+		 * When enabled (the default), objects whose meshes have simplified levels (see BaseMesh::AddLOD()) are drawn
+		 * with the level matching their projected size: the diameter of their bounding sphere over the height of
+		 * the view at their distance from the active camera. Every level of a batch is drawn as a batch of its own.
+		 *
+		 * @param bEnabled True to select levels by projected size, false to always draw the full-detail meshes.
+		 */
+		void SetLevelOfDetail(bool bEnabled);
+
+		/**
+		 * Scales the projected sizes levels of detail are selected with.
+		 *
+		 * @param Bias Above 1 keeps the detailed levels further away, below 1 switches to the simplified ones sooner.
+		 */
+		void SetLODBias(float Bias);
+
+		/**
+		 * Enables or disables impostors.
+		 * When enabled (the default), objects given an ImpostorAtlas (see SceneObject::SetImpostor()) are drawn as
+		 * camera-facing pictures once the active camera is farther than the atlas' distance from their bounding
+		 * sphere, every far object of an atlas in one instanced draw after the opaque batches. The GPU culling path
+		 * and the shadow casters always draw the meshes.
+		 *
+		 * @param bEnabled True to draw far objects as impostors, false to always draw their meshes.
+		 */
+		void SetImpostors(bool bEnabled);
+
+		/**
+		 * Enables or disables multi-draw indirect submission.
+		 * When enabled (the default) and the context is OpenGL 4.3+, every batch mesh becomes one
+		 * indirect command and consecutive commands sharing a material, vertex array and index type are submitted
+		 * with a single glMultiDrawElementsIndirect. Batched objects are drawn from their RenderProxy on both
+		 * paths, so Entity render hooks (OnPrepareRender / OnPostRender) only run for the skybox.
+		 *
+		 * @param bEnabled True to submit batches through the indirect buffer when supported.
+		 */
+		void SetIndirectDrawing(bool bEnabled);
+
+		/**
+		 * Limits the time spent uploading the geometry of newly added objects each frame.
+		 * The Scene's upload queue is drained in insertion order at the start of Render(); objects that
+		 * don't fit in the budget are uploaded, and drawn, on a later frame. At least one new object is
+		 * uploaded per frame so streaming always progresses.
+		 *
+		 * @param Milliseconds Upload time allowed per frame, 0 (the default) for no limit.
+		 */
+		void SetUploadBudget(float Milliseconds);
+
+		/**
+		 * Limits the geometry moved each frame to fill the holes freed meshes leave in the GeometryArena.
+		 * At the start of Render(), the arena frees the meshes destroyed since the last frame, then moves
+		 * allocations from the end of its buffers into the holes, see GeometryArena::Compact(). The draws cached
+		 * by the objects and the batches are updated in the same frame, before anything is drawn.
+		 *
+		 * @param BytesPerFrame Bytes copied per frame at most, 4 MB by default; 0 only frees, holes are then reused by new meshes alone.
+		 */
+		void SetGeometryCompactionBudget(size_t BytesPerFrame);
+
+		/** @return The arena holding the geometry of every mesh drawn, e.g. for its GetStats(). */
+		const GeometryArena& GetGeometryArena() const;
+
+		/**
+		 * Enables or disables bindless materials.
+		 * When enabled (the default) and MaterialBuffer::IsSupported(), the records of the materials drawn
+		 * each frame are uploaded to the material storage buffer and every instance carries its material
+		 * index. Indirect commands are then grouped by shader instead of material, so objects differing by
+		 * material are drawn by one multi-draw call; the shaders must read their textures from the buffer.
+		 *
+		 * @param bEnabled True to use the bindless material buffer when supported.
+		 */
+		void SetBindlessMaterials(bool bEnabled);
+
+		/**
+		 * Enables or disables vertex pulling.
+		 * When enabled, indirect drawing is used and GeometryArena::SupportsVertexPulling(), the indirect batches are
+		 * drawn through the arena's pulling VAO: their vertex shaders read the vertices and instances from storage
+		 * buffers, so consecutive commands of a shader merge into one multi-draw whatever their vertex format.
+		 * The materials of batched objects must then use shaders compiled with VERTEX_PULLING (see BaseLighting.vert),
+		 * which still read their attributes in the passes drawing through the format VAOs.
+		 *
+		 * @param bEnabled True to pull the vertices of indirect batches when supported, false (the default) for vertex attributes.
+		 */
+		void SetVertexPulling(bool bEnabled);
+
+		/** @return True if vertex pulling is enabled and supported, i.e. batch materials need VERTEX_PULLING shaders. */
+		bool UsesVertexPulling() const;
+
+		/**
+		 * Enables or disables GPU-driven culling.
+		 * When enabled, indirect drawing is enabled and the context supports it (see GPUCulling::IsSupported()), the
+		 * frustum test, the level of detail selection and the instance data are moved to compute shaders: only the
+		 * objects added, moved or re-batched since the last frame are sent to the GPU, and the indirect commands are
+		 * only recorded again when batches are added. Batches are then drawn in shader, material and mesh order
+		 * instead of front to back, and Entity render hooks are not called.
+		 *
+		 * @param bEnabled True to cull on the GPU when supported, false (the default) to cull and batch on the CPU.
+		 */
+		void SetGPUCulling(bool bEnabled);
+
+		/**
+		 * Enables or disables occlusion culling, skipping objects hidden behind the depth of the previous frames.
+		 * With GPU culling, the depth of every frame is reduced into a HiZBuffer the next frame's culling pass tests the
+		 * objects' bounds against. Otherwise the bounding boxes of the frustum-visible objects are drawn in occlusion
+		 * queries after the frame (see OcclusionQueries), read back on later frames without stalling.
+		 * Both only know the depth of past frames: objects coming into view from behind an occluder appear a frame or two late.
+		 *
+		 * @param bEnabled True to cull occluded objects, false (the default) to draw everything inside the frustum.
+		 */
+		void SetOcclusionCulling(bool bEnabled);
+
+		/**
+		 * Enables or disables meshlet culling.
+		 * When enabled (the default), the full-detail level of meshes split into meshlets (see BaseMesh::BuildMeshlets())
+		 * is drawn cluster by cluster on the multi-draw indirect path: every instance skips the clusters outside
+		 * the view frustum and the ones whose normal cone faces away from the camera, and each run of surviving
+		 * clusters becomes one indirect command. Other paths draw those meshes whole.
+		 *
+		 * @param bEnabled True to cull the meshlets of the meshes that have them.
+		 */
+		void SetMeshletCulling(bool bEnabled);
+
+		/**
+		 * Enables or disables the cascaded shadows of the directional light.
+		 * When enabled, the cascades are fitted to the active camera every frame and the objects overlapping them
+		 * are drawn into the shadow map before the scene (see CascadedShadowMaps). Cascades whose light view and
+		 * casters didn't change keep their depth from previous frames.
+		 *
+		 * @param bEnabled True to draw shadows, false (the default) for lit shaders to skip the shadow lookup.
+		 */
+		void SetShadows(bool bEnabled);
+
+		/**
+		 * Sets the render layers drawn into the shadow map, independently of the cameras' culling masks:
+		 * e.g. a first-person body hidden from the main camera can still cast its shadow.
+		 *
+		 * @param Layers The layers of the shadow casters, AllLayers by default.
+		 */
+		void SetShadowCasterLayers(LayerMask Layers);
+
+		/** @return The render layers drawn into the shadow map. */
+		LayerMask GetShadowCasterLayers() const;
+
+		/**
+		 * Gives access to the cascade settings: resolution, count, distance, split and bias.
+		 *
+		 * @return The cascaded shadow maps of the renderer.
+		 */
+		CascadedShadowMaps& GetShadowMaps();
+
+		/**
+		 * Enables or disables the shadows of the point lights and the spot light of the light block.
+		 * When enabled, each shadowed light is culled against the sphere it reaches, and the lights whose view or
+		 * casters changed are redrawn into their tiles of the atlas, within its update budget (see LocalShadowAtlas).
+		 * The casters are the render layers of SetShadowCasterLayers().
+		 *
+		 * @param bEnabled True to draw the shadows, false (the default) for lit shaders to skip their lookup.
+		 */
+		void SetLocalShadows(bool bEnabled);
+
+		/**
+		 * Gives access to the atlas settings: size, tile sizes, update budget, shadowed lights and bias.
+		 *
+		 * @return The shadow atlas of the point and spot lights.
+		 */
+		LocalShadowAtlas& GetLocalShadowAtlas();
+
+		/**
+		 * Sets the internal resolution, as a fraction of the viewport size on each axis.
+		 * At any scale other than 1 the Scene is drawn into an offscreen RenderTarget of the scaled size,
+		 * multisampled with the samples set by SetRenderTargetSamples(), then upscaled over the viewport with
+		 * bilinear filtering. With dynamic resolution on, this is the scale the controller starts from.
+		 *
+		 * @param Scale The internal resolution scale, clamped to [0.25, 2].
+		 */
+		void SetRenderScale(float Scale);
+
+		/** @return The internal resolution scale of the last frame. */
+		float GetRenderScale() const;
+
+		/**
+		 * Enables or disables post-processing.
+		 * When enabled, the Scene is always drawn offscreen in PostProcessStack::SceneFormat, keeping the lighting
+		 * above 1, and the effects of GetPostProcessing() are applied as it is scaled to the viewport, in place of
+		 * the plain upscale.
+		 *
+		 * @param bEnabled True to post-process the frames, false (the default) to output the Scene as drawn.
+		 */
+		void SetPostProcessing(bool bEnabled);
+
+		/**
+		 * Gives access to the post-processing effects: tone mapping, color grading, bloom and vignette.
+		 *
+		 * @return The post-process stack of the renderer.
+		 */
+		PostProcessStack& GetPostProcessing();
+
+		/**
+		 * Enables or disables dynamic resolution.
+		 * When enabled, the Scene is always drawn offscreen and the render scale follows the GPU time of the frames,
+		 * measured with timer queries and fed to a PID controller (see ResolutionController): frames slower than
+		 * the target lower the internal resolution, faster ones raise it back.
+		 *
+		 * @param bEnabled True to scale the internal resolution to hold the frame time.
+		 * @param TargetFrameTime The GPU frame time to hold, in milliseconds.
+		 * @param MinScale The lowest render scale allowed.
+		 * @param MaxScale The highest render scale allowed.
+		 */
+		void SetDynamicResolution(bool bEnabled, float TargetFrameTime = 1000.0f / 60.0f, float MinScale = 0.5f, float MaxScale = 1.0f);
+
+		/**
+		 * Gives access to the dynamic resolution controller, for its gains and its telemetry (see ResolutionController::GetState()).
+		 *
+		 * @return The resolution controller of the renderer.
+		 */
+		ResolutionController& GetResolutionController();
+
+		/**
+		 * Enables or disables the quality governor (see QualityGovernor).
+		 * When enabled, the frame time of the TimeManager and the GPU time of every frame, measured with timer
+		 * queries, step the renderer through the governor's ladder of levels: LOD bias, shadow resolution and
+		 * cascade count, ambient occlusion, particle emission and lights per cluster. While enabled the governor
+		 * owns these settings, ambient occlusion only runs if both SetAmbientOcclusion() and the level allow it.
+		 * Disabling it keeps the other settings of the level it reached. Works alongside dynamic resolution.
+		 *
+		 * @param bEnabled True to adapt the quality to the frame time.
+		 * @param TargetFrameTime The frame time to hold, in milliseconds.
+		 */
+		void SetQualityGovernor(bool bEnabled, float TargetFrameTime = 1000.0f / 60.0f);
+
+		/**
+		 * Gives access to the quality governor, for its ladder, its hysteresis and its telemetry (see QualityGovernor::GetState()).
+		 *
+		 * @return The quality governor of the renderer.
+		 */
+		QualityGovernor& GetQualityGovernor();
+
+		/**
+		 * Enables or disables GPU timing of the render passes (see GPUProfiler).
+		 * Every frame's passes ("Clear", "Upload", "Shadows", "Local shadows", "Batches", "Occlusion queries", "Deferred lighting",
+		 * "Skybox", "Upscale" or "Post-processing", the ones that ran) are wrapped in timestamp queries, read back a few frames later.
+		 *
+		 * @param bEnabled True to time the passes, false (the default) to issue no queries.
+		 */
+		void SetGPUProfiling(bool bEnabled);
+
+		/** @return The GPU profiler of the renderer, with the per-pass average, min and max times. */
+		GPUProfiler& GetGPUProfiler();
+
+		/**
+		 * @return What the last frame submitted: draw calls, instances, triangles, binds, bytes uploaded, culling
+		 * results and batches. Counts everything issued since the end of the previous frame, see RenderCounters.
+		 */
+		const RenderStats& GetStats() const;
+
+		/**
+		 * Prints the frame stats through BaseLog every few frames.
+		 *
+		 * @param Frames Frames between two prints, 0 (the default) to never print them.
+		 */
+		void SetStatsLogInterval(uint32_t Frames);
+
+		/**
+		 * Sets the multisampling of the offscreen target used below full resolution or with dynamic resolution.
+		 * The window's own samples (GLFW_SAMPLES) only apply when drawing straight into the default framebuffer.
+		 * Only used with AntiAliasingMode::MSAA, the other modes draw the offscreen target single-sampled.
+		 *
+		 * @param Samples Samples per pixel, 0 or 1 to disable multisampling. Defaults to 4, like the window.
+		 */
+		void SetRenderTargetSamples(int Samples);
+
+		/**
+		 * Sets how the edges of the geometry are smoothed.
+		 * MSAA (the default) multisamples the window (see BaseWindow::SetSamples()) or the offscreen target.
+		 * FXAA and TAA draw the Scene single-sampled into the offscreen target: FXAA filters the edges in the
+		 * final pass of the post-process stack, TAA jitters the projection every frame and blends each frame
+		 * with the previous ones reprojected through the depth, before the post-processing effects. Both cost a
+		 * fraction of MSAA's bandwidth; the window should then be created without samples.
+		 * TemporalUpscaling is TAA resolved at the viewport size rather than the internal one: with a render scale
+		 * of 0.5 to 0.75 (SetRenderScale() or dynamic resolution), the shading costs a fraction of native while the
+		 * jittered frames reconstruct the missing pixels. Its history stays at the viewport size, so it survives
+		 * the render scale changes of dynamic resolution.
+		 *
+		 * @param Mode The anti-aliasing to use.
+		 * @param Samples Samples per pixel of the offscreen target with MSAA, see SetRenderTargetSamples(). Ignored otherwise.
+		 */
+		void SetAntiAliasing(AntiAliasingMode Mode, int Samples = 4);
+
+		/** @return The anti-aliasing in use. */
+		AntiAliasingMode GetAntiAliasing() const;
+
+		/**
+		 * Renders into an offscreen target instead of the default framebuffer, for headless rendering
+		 * (see WindowType::Hidden and FrameReadback). The target is bound at the start of every Render(), which
+		 * uses its size as the viewport, and resolved at the end, so GetResolveFramebuffer() holds the frame.
+		 *
+		 * @param Target The target to render into, sized by the caller, or nullptr (the default) for the default framebuffer.
+		 */
+		void SetOutputTarget(RenderTarget* Target);
+
+		/** @return The target frames are rendered into, nullptr for the default framebuffer. */
+		RenderTarget* GetOutputTarget() const;
+
+		/**
+		 * Gives access to screenshots and recordings of the rendered frames (see FrameCapture).
+		 * Every Render() hands its final image, from the output target or the back buffer, to it.
+		 *
+		 * @return The frame capture of the renderer.
+		 */
+		FrameCapture& GetFrameCapture();
+
+		/**
+		 * Gives access to object picking (see ObjectPicker). A queued pick adds an ID pass over the visible
+		 * objects to the next frame, and its answer arrives a frame or two later.
+		 *
+		 * @return The object picker of the renderer.
+		 */
+		ObjectPicker& GetObjectPicker();
+
+		/**
+		 * Gives access to the per-frame lights read by every shader declaring the "LightData" block.
+		 * Edits are uploaded once, at the start of the next Render().
+		 *
+		 * @return The light uniform buffer of the renderer.
+		 */
+		LightUniformBuffer& GetLightBuffer();
+
+		/**
+		 * Gives access to the point lights of the clustered forward path (OpenGL 4.3+).
+		 * When it holds lights, its storage buffers are rebuilt for the active camera at the start of every Render().
+		 *
+		 * @return The clustered light manager of the renderer.
+		 */
+		ClusteredLightManager& GetClusteredLights();
+
+		/**
+		 * Enables or disables the per-object point lights of the forward path, the cheap alternative to clustered
+		 * lighting on OpenGL 4.1. When enabled, the CPU frames pick the strongest point lights of the light buffer
+		 * for every object (see ObjectLightAssigner), read by shaders compiled with OBJECT_LIGHTS.
+		 *
+		 * @param bEnabled True to assign the lights of every object each frame, false (the default) to leave them as set.
+		 */
+		void SetObjectLights(bool bEnabled);
+
+		/** @return The assigner picking the point lights of every object, e.g. to tune its influence threshold. */
+		ObjectLightAssigner& GetObjectLightAssigner();
+
+		/**
+		 * Sets the shader resolving the lighting of RenderingMode::Deferred.
+		 * In that mode the materials' shaders are the geometry pass and must write the G-buffer outputs (see GBuffer);
+		 * without a lighting shader the Deferred mode renders forward like Default.
+		 *
+		 * @param LightingShader The full-screen lighting shader, e.g. DeferredLighting.vert / .frag.
+		 */
+		void SetDeferredLightingShader(Shader* LightingShader);
+
+		/**
+		 * Sets the CubeMap drawn behind the Scene by the dedicated sky pass.
+		 * The sky is one full-screen triangle at the far plane, drawn after the opaque batches with depth writes off,
+		 * so the depth test rejects every pixel they cover before shading. Its directions are rebuilt from
+		 * Camera.InverseViewProjection: the sky needs no geometry, no instance slot and no upload, unlike a
+		 * SkyboxEntity added to the Scene, which is then not drawn.
+		 *
+		 * @param CubeMap The sky, nullptr (the default) to draw the Scene's SkyboxEntity instead, if any. Must outlive its use.
+		 */
+		void SetSkybox(const Texture* CubeMap);
+
+		/**
+		 * Sets how the objects of transparent materials are blended. Either way they are left out of the opaque
+		 * batches and drawn after the sky with depth writes off, on the CPU culling paths; the GPU culling path
+		 * draws them with the opaque batches.
+		 * Sorted draws one instance per object, ordered back to front by a radix sort of their view depth, with
+		 * straight alpha blending. WeightedBlended skips the sort and draws every batch instanced into a
+		 * TransparencyBuffer composited afterwards, which scales to large counts of particles or foliage
+		 * but needs the material shaders to write the TransparencyBuffer outputs.
+		 *
+		 * @param Mode The blending of the transparent pass, TransparencyMode::Sorted by default.
+		 */
+		void SetTransparencyMode(TransparencyMode Mode);
+
+		/**
+		 * Adds a particle system drawn every frame after the transparent objects, into the Scene's framebuffer.
+		 * The renderer only draws it, ParticleSystem::Update() is still called once per frame before Render().
+		 *
+		 * @param Particles The particle system, which must stay alive until removed.
+		 */
+		void AddParticleSystem(ParticleSystem* Particles);
+
+		/**
+		 * Stops drawing a particle system added with AddParticleSystem().
+		 *
+		 * @param Particles The particle system to remove.
+		 */
+		void RemoveParticleSystem(ParticleSystem* Particles);
+
+		/**
+		 * Adds a terrain drawn every frame with the opaque geometry, after the batches, from the frame's camera.
+		 * Its chunks are streamed as the camera moves, see Terrain::Render().
+		 *
+		 * @param Ground The terrain, which must stay alive until removed.
+		 */
+		void AddTerrain(Terrain* Ground);
+
+		/**
+		 * Stops drawing a terrain added with AddTerrain().
+		 *
+		 * @param Ground The terrain to remove.
+		 */
+		void RemoveTerrain(Terrain* Ground);
+
+		/**
+		 * Adds a mesh whose vertices the CPU rewrites every frame, drawn with the opaque geometry after the batches
+		 * with its material and transform (see DynamicMesh::Render()). It isn't culled nor shadowed.
+		 *
+		 * @param Mesh The mesh, which must stay alive until removed.
+		 */
+		void AddDynamicMesh(DynamicMesh* Mesh);
+
+		/**
+		 * Stops drawing a mesh added with AddDynamicMesh().
+		 *
+		 * @param Mesh The mesh to remove.
+		 */
+		void RemoveDynamicMesh(DynamicMesh* Mesh);
+
+		/**
+		 * Retrieves the skinning matrices of the animated objects, uploaded at the start of every frame and
+		 * bound to BonePaletteBuffer::TextureUnit for the shadow and scene passes. Objects drawn with
+		 * VertexFormat::Skinned allocate their palette here and write it before Render().
+		 *
+		 * @return The bone palettes of the renderer.
+		 */
+		BonePaletteBuffer& GetBonePalettes();
+
+		/**
+		 * Enables or disables the depth prepass.
+		 * When enabled, the batches are first drawn with a position-only shader and color writes off, then
+		 * shaded with GL_EQUAL and depth writes off, so every pixel runs its material shader once whatever the
+		 * draw order. Worth it when the material shaders cost more than drawing the geometry twice.
+		 * The prepass computes positions as Camera.ViewProjection * (ModelMatrix * aPos), the material vertex
+		 * shaders must do the same for their depth to match exactly (see BaseLighting.vert).
+		 *
+		 * @param bEnabled True to draw the depth prepass, false (the default) to shade directly.
+		 */
+		void SetDepthPrepass(bool bEnabled);
+
+		/**
+		 * Enables or disables screen-space ambient occlusion.
+		 * When enabled, the depth prepass is drawn whatever SetDepthPrepass(), and GetAmbientOcclusion() computes
+		 * the occlusion from its depth before the batches are shaded. Lighting shaders read it as
+		 * AmbientOcclusion::SamplerName (see BaseLighting.frag); it is white while disabled. The static geometry
+		 * chunks are drawn before the prepass and stay unoccluded.
+		 *
+		 * @param bEnabled True to compute the ambient occlusion, false (the default) to leave the lighting unoccluded.
+		 */
+		void SetAmbientOcclusion(bool bEnabled);
+
+		/**
+		 * Gives access to the ambient occlusion's parameters.
+		 *
+		 * @return The ambient occlusion of the renderer.
+		 */
+		AmbientOcclusion& GetAmbientOcclusion();
+
+		/**
+		 * Enables or disables volumetric fog (OpenGL 4.3).
+		 * When enabled, GetVolumetricFog() computes the fog of every view after its shadows and before its batches
+		 * are shaded, lit by the directional light and the clustered point lights. Lighting shaders read it as
+		 * VolumetricFog::SamplerName (see BaseLighting.frag); it is clear while disabled. Captures are drawn
+		 * without it, and views drawn by RenderViews() don't reproject the previous frame.
+		 *
+		 * @param bEnabled True to compute the fog, false (the default) to leave the air clear.
+		 */
+		void SetVolumetricFog(bool bEnabled);
+
+		/**
+		 * Gives access to the volumetric fog's parameters.
+		 *
+		 * @return The volumetric fog of the renderer.
+		 */
+		VolumetricFog& GetVolumetricFog();
+
+		/**
+		 * Sets the baked lighting the lightmapped meshes read, bound to Lightmap::TextureUnit every frame before
+		 * the geometry is drawn. Shaders compiled with LIGHTMAP (see BaseLighting.frag) sample it instead of the
+		 * directional and point lights.
+		 *
+		 * @param BakedLighting The baked or loaded lightmap, which must outlive its use; nullptr to bind none.
+		 */
+		void SetLightmap(const Lightmap* BakedLighting);
+
+		/**
+		 * Sets the cells and portals culling the objects hidden behind the walls of an indoor scene, on top of
+		 * frustum culling: with the camera inside a cell, only the objects of the cells seen through the portals
+		 * are drawn (see PortalGraph). Applies to the frames culled on the CPU from one camera, captures included;
+		 * GPU culling and RenderViews() ignore it.
+		 *
+		 * @param Graph The cells and portals, which must outlive their use; nullptr to cull with the frustum alone.
+		 */
+		void SetPortalGraph(PortalGraph* Graph);
+
+		/**
+		 * Sets the 2D overlay drawn over every frame after the post-processing, e.g. a HUD or the RenderStats.
+		 * Its quads are latched with the frame like the Scene's snapshot, so they are recorded on the thread
+		 * calling PrepareFrame(), between two frames.
+		 *
+		 * @param Overlay The sprite batch, which must outlive its use; nullptr to draw none.
+		 */
+		void SetOverlay(SpriteBatch* Overlay);
+
+		/**
+		 * Draws the Scene from another camera into a target, e.g. a face of a reflection probe (see ReflectionProbes).
+		 * The capture is a reduced Render(): the features keeping history of the main view or costing more than
+		 * a capture is worth (shadows, occlusion culling, ambient occlusion, post-processing, anti-aliasing other
+		 * than the target's own samples, scaling) are off, the levels of detail are selected with an extra bias,
+		 * and the spot light stays where the main view left it. The GPU profiler, the frame capture and the frame
+		 * stats don't see it as a frame of its own, its draws count in the next Render()'s stats. A frame prepared
+		 * with PrepareFrame() stays prepared.
+		 *
+		 * @param Scene The Scene to draw.
+		 * @param Camera The camera to draw from, its view and projection up to date; the Scene's active camera isn't used.
+		 * @param Target The target to draw into, its size is the viewport.
+		 * @param LODBias Scale of the projected sizes on top of SetLODBias(), below 1 to draw simpler levels.
+		 * @param CullDistance Objects whose bounds are all farther from the camera are skipped, 0 to draw up to the far plane.
+		 */
+		void RenderCapture(Scene* Scene, BaseCamera& Camera, RenderTarget& Target, float LODBias = 1.0f, float CullDistance = 0.0f);
+
+		/**
+		 * Draws several views of the Scene into one frame, e.g. split-screen, picture-in-picture or stereo as two
+		 * side-by-side views, each into its rectangle of the viewport and in order, so later views draw over earlier ones.
+		 * The views share the CPU work of the frame: objects are culled once against the union of the frustums,
+		 * batched once with the level of detail of the nearest view, and their instances uploaded once; each view
+		 * then only updates the camera and light buffers and records its draws. The shadow cascades are fit to
+		 * the first view and serve every view.
+		 *
+		 * The frame is a reduced Render(): the features keeping per-view history or full-viewport buffers (GPU
+		 * culling, occlusion culling, ambient occlusion, temporal anti-aliasing and upscaling, deferred shading)
+		 * are off for it, and picking requests wait for the next Render(). Post-processing and the overlay apply
+		 * once to the whole frame.
+		 *
+		 * @param Scene The Scene to draw.
+		 * @param Views The views, each with a camera; none draws nothing.
+		 */
+		void RenderViews(Scene* Scene, std::span<const RenderView> Views);
+
+		/**
+		 * Enables or disables late latching of the camera input.
+		 * When enabled, Render() (or PrepareFrame()) polls the input received since InputManager::ProcessInput() first, so the mouse
+		 * handlers rotate the camera again, then recomputes the active camera's view matrix before culling and
+		 * building the camera data. The frame then shows the latest mouse motion, up to a frame earlier.
+		 * Window callbacks (resize, focus, close) may also run at that point.
+		 *
+		 * @param bEnabled True to sample the camera input again at the start of Render(), false (the default) to keep the view of Scene::Process().
+		 */
+		void SetLateLatchInput(bool bEnabled);
+
+		/**
+		 * Sets the job system the per-instance data is generated on.
+		 * Objects are split in chunks of consecutive instance slots written in parallel; frames with at most one
+		 * chunk of objects are processed on the calling thread.
+		 *
+		 * @param Jobs The job system to use, nullptr (the default) to generate everything on the calling thread.
+		 * @param ChunkSize The number of instances written per job.
+		 */
+		void SetJobSystem(JobSystem* Jobs, size_t ChunkSize = 1024);
+
+		/**
+		 * Makes the driver compile the pipelines the Scene draws with before its first frame, e.g. behind a loading screen.
+		 * Drivers finish a program for the vertex format, raster state and blending it is first drawn with, stalling
+		 * that frame; here each distinct combination of material program, vertex format, index type, raster state and
+		 * pass is drawn once instead, one instance of its coarsest level into a one-pixel viewport of the framebuffer
+		 * Render() draws into, along with the depth prepass program when enabled. Pending geometry is uploaded first,
+		 * whatever SetUploadBudget() allows. The framebuffer and viewport are restored, the pixel is cleared by the next frame.
+		 * Call it again after adding objects with new materials or formats; the combinations already drawn are cheap.
+		 *
+		 * @param Scene The Scene to prepare.
+		 * @return The number of combinations drawn.
+		 */
+		size_t PrewarmPipelines(Scene* Scene);
+
 	private:
+		/** One mesh of a batch level, as the GPU culling path draws it without going through the batch's objects. */
+		struct BatchDraw
+		{
+			std::shared_ptr<Material> DrawMaterial; ///< Material of the mesh
+			GLuint VertexArray;                     ///< Vertex array of the mesh's vertex format
+			GLenum IndexType;                       ///< Index type of the mesh
+			VertexFormat Format;                    ///< Vertex format of the mesh, encoded in pulled commands
+			DrawElementsIndirectCommand Command;    ///< Indices of the level, instance count and base instance written by GPUCulling
+		};
+
+		/**
+		 * Objects sharing a mesh, drawn with a single instanced call.
+		 * Batches persist across frames, only the list of their visible objects is refilled.
+		 * The levels of detail of a key are consecutive batches, from level 0 at the batch index of its objects.
+		 */
+		struct ObjectBatch
+		{
+			uint64_t Key;                      ///< Material ID in the high half, mesh identity in the low half
+			size_t MeshID;                     ///< SceneObject::GetHash() of every object of the batch
+			uint32_t LOD;                      ///< Level of detail the batch draws its meshes with
+			uint32_t LODCount;                 ///< Number of levels of the key, batches LOD to LODCount - 1 follow this one
+			float ScreenSize;                  ///< Projected size below which this level is selected
+			std::vector<SceneObject*> Objects; ///< Objects of the batch that are visible this frame
+			std::vector<BatchDraw> Draws;      ///< Every mesh of the level, captured when the batch is created
+		};
+
+		/** This frame's non-empty batches, allocated from the frame arena and valid until the next Render(). */
+		using FrameBatchList = std::pmr::vector<const ObjectBatch*>;
+
 		/**
 		 * Sets up the OpenGL buffer used to store MVP matrices.
 		 *
@@ -75,21 +778,277 @@ namespace fgl
 		void ClearFrameBuffer();
 
 		/**
-		 * Groups Scene objects by their vertex data, preparing them for batch rendering.
+		 * Uploads the objects waiting in the Scene's upload queue, within the upload budget.
+		 * Runs both passes of each object, so the rest of the frame makes no per-object setup call.
+		 *
+		 * @param Scene The Scene whose queue is drained.
+		 */
+		void UploadPendingObjects(Scene* Scene);
+
+		/**
+		 * Frees and compacts the geometry arena within the compaction budget, then updates the draws of the
+		 * Scene's objects and batches if allocations moved.
+		 *
+		 * @param Scene The Scene whose objects are updated.
+		 */
+		void CompactGeometry(Scene* Scene);
+
+		/**
+		 * Updates the draw commands of a cached batch and its levels to an object's allocations, flagging the
+		 * GPU culling commands for recording when one changed.
+		 *
+		 * @param BatchIndex The batch of the object, its first level.
+		 * @param Proxy The render proxy of the object, captured after its upload.
+		 */
+		void RefreshBatchDraws(uint32_t BatchIndex, const RenderProxy& Proxy);
+
+		/**
+		 * Distributes the visible Scene objects over their cached batches, preparing them for batch rendering.
+		 * Objects outside the active camera's frustum are culled here when frustum culling is enabled,
+		 * by querying the Scene's bounding volume hierarchy, then the ones occlusion queries found hidden when
+		 * occlusion culling is enabled. Objects still waiting for their upload
+		 * are skipped. Only objects whose batch was invalidated are looked up again, then each object
+		 * goes to the batch of the level of detail its projected size selects.
 		 *
 		 * @param TargetScene The Scene to process.
 		 * @param Skybox Reference to a pointer that stores the skybox object (if present).
-		 * @return A hashmap that batches SceneObjects by their vertex hash.
+		 * @return The batches holding at least one visible object this frame.
+		 */
+		FrameBatchList BatchSceneObjects(Scene* Scene, SceneObject*& Skybox);
+
+		/** What selects the level of detail of an object, from one camera. */
+		struct LODView
+		{
+			glm::vec3 Position;   ///< Position of the camera
+			float SizeScale;      ///< Vertical scale of the projection times the LOD bias
+			bool bOrthographic;   ///< Whether projected sizes ignore the distance
+		};
+
+		/** @return The level of detail parameters of a camera. */
+		LODView MakeLODView(BaseCamera& Camera) const;
+
+		/** @return The entry of m_LODViews nearest to a point. */
+		const LODView& GetNearestLODView(const glm::vec3& Center) const;
+
+		/**
+		 * Finds or creates the cached batch of an object and records it on the object.
+		 * Called once per object when it is uploaded, and again only after SceneObject::InvalidateBatch().
+		 * The first time a key is seen, one batch is created per level of detail of the object's meshes, with
+		 * the draws of its meshes.
+		 *
+		 * @param Object The object to assign.
+		 * @return Index of the object's batch in the batch cache, the batch of level 0.
+		 */
+		uint32_t AssignBatch(SceneObject* Object);
+
+		/**
+		 * Selects the level of detail of an object from its projected size.
+		 *
+		 * @param BatchIndex Index of the object's batch of level 0.
+		 * @param ScreenSize Projected size of the object, bias applied.
+		 * @return The offset of the selected level's batch from BatchIndex.
 		 */
-		std::map<size_t, std::vector<SceneObject*>> BatchSceneObjects(Scene* Scene, SceneObject*& Skybox);
+		uint32_t SelectLOD(uint32_t BatchIndex, float ScreenSize) const;
+
+		/** Draws the far objects collected by BatchSceneObjects(), one instanced draw per atlas. */
+		void RenderImpostors();
+
 		
 		/**
 		 * Renders batches of Scene objects using instanced rendering.
-		 * This method loops through each batch and renders them efficiently.
+		 * Each batch is submitted once, through its first object, with the batch size as instance
+		 * count and the batch's offset in the MVP buffer as base instance. Batches are sorted by
+		 * shader, material, mesh and depth to minimize state changes: through the render queue for
+		 * indirect submission, as packets of recorded commands otherwise (see RecordBatchCommands()).
+		 *
+		 * @param ObjectBatches The batches of Scene objects visible this frame.
+		 */
+		void RenderBatches(const FrameBatchList& ObjectBatches);
+
+		/**
+		 * Builds the sort key of a batch from its material, mesh and closest instance. Thread-safe.
+		 *
+		 * @param Batch The batch, with at least one object.
+		 * @param Pass The pass field of the key.
+		 */
+		uint64_t MakeBatchKey(const ObjectBatch& Batch, uint32_t Pass) const;
+
+		/** Fills the render queue and m_QueuedBatches with the opaque batches, sorted, for SubmitIndirectBatches(). */
+		void QueueBatches(const FrameBatchList& ObjectBatches);
+
+		/**
+		 * Records the draws of the batches, and the depth prepass if enabled, into m_Commands.
+		 * With a job system set, chunks of batches are recorded in parallel, each into its own list.
+		 */
+		void RecordBatchCommands(const FrameBatchList& ObjectBatches);
+
+		/**
+		 * Records one indirect command per mesh of the sorted batches, in queue order (per run of visible meshlets
+		 * for split meshes), and submits them grouped by material and vertex array (OpenGL 4.3+ path of RenderBatches).
+		 */
+		void SubmitIndirectBatches();
+
+		/**
+		 * Records the indirect commands of a mesh's meshlets surviving the culling of each instance of a batch,
+		 * one command per run of consecutive clusters. The cone test runs in object space, against the camera
+		 * position moved there, as affine transforms keep a triangle's facing.
+		 *
+		 * @param Mesh The mesh, split into meshlets.
+		 * @param InstanceCount The number of instances of the batch.
+		 * @param BaseInstance Index of the batch's first instance in the MVP buffer.
+		 */
+		void PushMeshletCommands(const BaseMesh& Mesh, size_t InstanceCount, size_t BaseInstance);
+
+		/** A run of consecutive indirect commands drawn with a single glMultiDrawElementsIndirect. */
+		struct IndirectGroup
+		{
+			Material* GroupMaterial;
+			const Shader* GroupShader;
+			GLuint VertexArray;
+			GLenum IndexType;
+			size_t FirstCommand;
+			size_t CommandCount;
+		};
+
+		/**
+		 * Adds the next command to the last group, or starts a new group if its state differs.
+		 * With bindless materials, commands of different materials sharing a shader stay in one group.
+		 *
+		 * @param Groups The groups of the commands recorded so far.
+		 * @param CommandMaterial Material of the command's mesh.
+		 * @param VertexArray Vertex array of the command's mesh.
+		 * @param IndexType Index type of the command's mesh.
+		 * @param FirstCommand Index of the command, used if it starts a group.
+		 */
+		void AddToIndirectGroup(std::vector<IndirectGroup>& Groups, Material* CommandMaterial, GLuint VertexArray, GLenum IndexType, size_t FirstCommand) const;
+
+		/**
+		 * Draws groups of uploaded indirect commands, after a depth-only pass over them when the depth prepass is enabled.
+		 *
+		 * @param Groups The groups to draw, in order.
+		 * @param Commands The buffer the groups' commands were uploaded to.
+		 */
+		void DrawIndirectGroups(const std::vector<IndirectGroup>& Groups, const IndirectDrawBuffer& Commands);
+
+		/** @return True if GPU culling is enabled and supported, and indirect drawing is enabled. */
+		bool UsesGPUCulling() const;
+
+		/**
+		 * Updates the GPU copy of the Scene objects for the GPU culling path: objects changed since the last
+		 * frame or uploaded this frame are rewritten, and the commands are recorded again if batches were added.
+		 *
+		 * @param Scene The Scene to render.
+		 * @return The skybox of the Scene, nullptr if it has none or it isn't uploaded yet.
+		 */
+		SceneObject* UpdateGPUObjects(Scene* Scene);
+
+		/**
+		 * Writes the instance data, bounds and batch of one Scene object to the GPU copy.
+		 * Skyboxes and objects waiting for their upload are never drawn by the GPU culling path.
+		 *
+		 * @param Scene The Scene of the object.
+		 * @param Index The index of the object in the Scene.
+		 */
+		void WriteGPUObject(Scene* Scene, uint32_t Index);
+
+		/** Records one command per draw of every batch, sorted by shader, material and vertex array, and groups them. */
+		void RecordGPUCommands();
+
+		/**
+		 * Culls the objects on the GPU, then draws the commands it filled (GPU culling path of RenderBatches).
+		 * With occlusion culling, the depth of the drawn batches is then reduced into the Hi-Z buffer of the next frame.
+		 */
+		void RenderGPUCulledBatches(Scene* Scene);
+
+		/**
+		 * Issues the occlusion queries of the CPU culling path, against the depth of the batches just drawn.
+		 *
+		 * @param Scene The Scene being rendered.
+		 */
+		void IssueOcclusionQueries(Scene* Scene);
+
+		/**
+		 * Culls the Scene against every cascade and draws the casters of the cascades that changed.
+		 * Casters are written to their own instance buffer, each with the mask of the cascades it overlaps.
+		 *
+		 * @param Scene The Scene being rendered, its bounding spheres already updated this frame.
+		 */
+		void RenderShadowCasters(Scene* Scene);
+
+		/**
+		 * Culls the Scene against the sphere of every shadowed point and spot light, and draws the casters of the
+		 * lights the atlas schedules, face by face, each face with its casters in its own run of instances.
+		 *
+		 * @param Scene The Scene being rendered, its bounding spheres already updated this frame.
+		 */
+		void RenderLocalShadowCasters(Scene* Scene);
+
+		/** @return The render scale the offscreen target is sized with, the controller's with dynamic resolution. */
+		float GetAppliedRenderScale() const;
+
+		/** @return True if the Scene is drawn into m_SceneTarget rather than the output framebuffer this frame. */
+		bool UsesRenderTarget() const;
+
+		/**
+		 * Points the instanced attributes of every vertex format at a buffer of InstanceData.
 		 *
-		 * @param ObjectBatches A hashmap containing grouped Scene objects ready for rendering.
+		 * @param Buffer The MVP buffer, or the instance buffer of GPUCulling.
 		 */
-		void RenderBatches(const std::map<size_t, std::vector<SceneObject*>>& ObjectBatches);
+		void BindInstanceSource(GLuint Buffer);
+
+		/** @return True if bindless materials are enabled and supported by the context. */
+		bool UsesBindlessMaterials() const;
+
+		/** @return The camera the frame is drawn from: the snapshot of a prepared frame, the Scene's active camera otherwise. */
+		BaseCamera& GetFrameCamera(Scene* Scene);
+
+		/** Polls the input and recomputes the view of the Scene's active camera, see SetLateLatchInput(). */
+		void LatchCameraInput(Scene* Scene);
+
+		/** @return True if the batches are drawn with a depth prepass this frame, for itself or for the ambient occlusion. */
+		bool UsesDepthPrepass() const;
+
+		/** @return True if the ambient occlusion is computed this frame: enabled, and allowed by the quality level. */
+		bool UsesAmbientOcclusion() const;
+
+		/** Feeds the frame's times to the quality governor, and applies its level when it changes. */
+		void UpdateQualityGovernor();
+
+		/** Applies the settings of a quality level. */
+		void ApplyQualityLevel(const QualityLevel& Level);
+
+		/** Switches to the depth-only prepass: prepass shader, color writes off. Compiles the shader on first use. */
+		void BeginDepthPrepass();
+
+		/** Ends the depth prepass, the following draws only shade the pixels whose depth equals the prepass depth. */
+		void EndDepthPrepass();
+
+		/** Restores the default depth test and writes after the batches of a prepassed frame. */
+		void EndPrepassedShading();
+
+		/** Uploads the records of the materials used by this frame's batches to the material buffer. */
+		void UpdateMaterialBuffer(const FrameBatchList& ObjectBatches);
+
+		/** Uploads the records of the materials of every batch to the material buffer (GPU culling path). */
+		void UpdateGPUMaterialBuffer();
+
+		/** Appends the materials of the static chunks missing from m_FrameMaterials. */
+		void AddStaticMaterials();
+
+		/**
+		 * Uploads the chunks of the Scene's StaticGeometry into the geometry arena, and their instances into
+		 * m_StaticInstanceBuffer, when they were rebuilt since the last upload.
+		 *
+		 * @param Scene The Scene being rendered.
+		 */
+		void UploadStaticGeometry(Scene* Scene);
+
+		/**
+		 * Draws the chunks of the Scene's StaticGeometry inside the view frustum, one draw per chunk, before the batches.
+		 *
+		 * @param Scene The Scene being rendered.
+		 */
+		void RenderStaticGeometry(Scene* Scene);
 		
 		/**
 		 * Renders the skybox object separately from other Scene objects.
@@ -101,44 +1060,73 @@ namespace fgl
 		 */
 		void RenderSkybox(SceneObject* Skybox);
 
+		/** Draws m_Skybox as a full-screen triangle at the far plane, behind everything already drawn. */
+		void RenderSkyPass();
+
+		/**
+		 * Draws the batches of transparent materials over the opaque image, as set by SetTransparencyMode().
+		 *
+		 * @param ObjectBatches This frame's batches, the opaque ones are skipped.
+		 * @param Framebuffer The framebuffer the Scene is drawn into.
+		 * @param Viewport The region of Framebuffer the Scene covers.
+		 */
+		void RenderTransparentObjects(const FrameBatchList& ObjectBatches, GLuint Framebuffer, const GLint Viewport[4]);
+
+		/**
+		 * Draws the ID pass of the queued pick, every batch with its instances' indices in this frame.
+		 *
+		 * @param Scene The Scene being drawn.
+		 * @param ObjectBatches This frame's batches, laid out in the instance buffer in this order.
+		 * @param ViewProjection The unjittered view projection of the frame.
+		 * @param OutputViewport The region of the output, the pick position is relative to.
+		 */
+		void RenderPickingPass(Scene* Scene, const FrameBatchList& ObjectBatches, const glm::mat4& ViewProjection, const GLint OutputViewport[4]);
+
 		/**
 		 * Updates MVP matrices for all batched objects in the Scene.
 		 *
 		 * This function calculates and uploads MVP matrices for instanced rendering.
-		 * If the buffer isn't large enough, it resizes it accordingly.
+		 * If the buffer isn't large enough, it resizes it accordingly. The instance data is written in parallel
+		 * when a job system is set.
 		 *
-		 * @param TargetScene The Scene being rendered.
-		 * @param ObjectBatches Batches of Scene objects to update.
-		 * @param HasSkybox Indicates if the Scene contains a skybox, adjusting matrix allocation.
+		 * @param ObjectBatches Batches of visible Scene objects to update.
 		 */
-		void UpdateMVPInstances(const Scene* Scene, const std::map<size_t, std::vector<SceneObject*>>& ObjectBatches, bool HasSkybox);
+		void UpdateMVPInstances(const FrameBatchList& ObjectBatches);
 		
 		/**
 		 * Ensures the MVP buffer has sufficient capacity to store all matrices.
 		 *
 		 * If the current buffer size is insufficient, it resizes the buffer to accommodate
-		 * all Scene objects, avoiding frequent reallocation.
+		 * all Scene objects, avoiding frequent reallocation. When the resize replaces the
+		 * OpenGL buffer object, instance attributes of already set up objects are rebound.
 		 *
+		 * @param ObjectBatches Batches of Scene objects being rendered this frame.
 		 * @param TotalObjectCount The number of objects requiring MVP matrix storage.
+		 * @return True if the buffer was resized and every object's matrices must be rewritten.
 		 */
-		void EnsureBufferCapacity(size_t TotalObjectCount);
+		bool EnsureBufferCapacity(const FrameBatchList& ObjectBatches, size_t TotalObjectCount);
 
 		/**
-		 * Computes and stores the MVP matrix for a single Scene object.
+		 * Stores the Model and normal matrices of a single Scene object; view-projection is applied in
+		 * the shaders from the camera uniform block.
 		 *
-		 * This function updates the transformation matrices and uploads them to the MVP buffer.
+		 * The matrices are only rewritten when the object moved to another slot, its Transform changed
+		 * since the last upload, or a rewrite is forced. Makes no OpenGL call and only touches the object and
+		 * its slot, so distinct slots can be processed on different threads.
 		 *
 		 * @param Object Pointer to the Scene object being processed.
-		 * @param Index Reference to the buffer index, incremented as matrices are stored.
+		 * @param Slot Slot of the object in the MVP buffer for this frame.
+		 * @param bRewrite Forces the matrices to be rewritten (buffer reallocated).
+		 * @return True if the slot was written and must be flagged dirty.
 		 */
-		void ProcessObjectForMVP(SceneObject* Object, size_t& Index);
+		bool ProcessObjectForMVP(SceneObject* Object, size_t Slot, bool bRewrite);
 
-		/** Binds the MVP buffer to the OpenGL pipeline, preparing for data transfer. */
+		/** Makes the MVP buffer the instance buffer of the GeometryArena, read by the second passes that follow. */
 		void BindMVPBuffer();
 
 		/**
 		 * Performs the first rendering pass for a Scene object.
-		 * The first pass prepares vertex and texture data before instanced rendering.
+		 * The first pass uploads the object's meshes into the geometry arena before instanced rendering.
 		 *
 		 * @param Object Pointer to the Scene object being processed.
 		 */
@@ -152,12 +1140,142 @@ namespace fgl
 		 */
 		void PerformSecondPass(SceneObject* Object);
 
-		/** Transfers updated MVP matrices to the GPU for instanced rendering. */
-		void UploadMVPDataToGPU();
+		/**
+		 * Transfers updated MVP matrices to the GPU for instanced rendering.
+		 * Only the range written this frame is uploaded; persistently mapped buffers need no copy.
+		 *
+		 * @param UsedObjectCount Number of objects written to the MVP buffer this frame.
+		 */
+		void UploadMVPDataToGPU(size_t UsedObjectCount);
 
 	private:
-		unsigned int m_MVPBufferID;		 ///< OpenGL buffer ID for storing MVP matrices
-		MatrixBuffer m_MVPMatrixBuffer;  ///< Buffer to store Model-View-Projection matrices for instanced rendering
+		/** A batch waiting in the render queue: the object drawn, its level of detail and its slice of the MVP buffer. */
+		struct QueuedBatch
+		{
+			SceneObject* Object;
+			size_t InstanceCount;
+			size_t BaseInstance;
+			uint32_t LOD;
+		};
+
+		MatrixBuffer m_MVPMatrixBuffer;  ///< Buffer (and owned OpenGL buffer) storing per-instance Model matrices for instanced rendering
+		CameraUniformBuffer m_CameraBuffer; ///< Per-frame camera uniform block (view, projection, view-projection, position)
+		LightUniformBuffer m_LightBuffer;   ///< Per-frame light uniform block, uploaded only when the lights change
+		bool m_FrustumCulling = true;       ///< Whether objects outside the view frustum are skipped
+		bool m_LevelOfDetail = true;        ///< Whether objects are drawn with the level of detail of their projected size
+		float m_LODBias = 1.0f;             ///< Scale applied to projected sizes before selecting levels of detail
+		bool m_Impostors = true;            ///< Whether far objects with an ImpostorAtlas are drawn as pictures
+		FlatHashMap<ImpostorAtlas*, std::vector<ImpostorInstance>> m_ImpostorInstances; ///< Far objects of each atlas this frame
+		float m_UploadBudget = 0.0f;        ///< Milliseconds of geometry uploads allowed per frame, 0 for no limit
+		size_t m_GeometryCompactionBudget = 4 << 20; ///< Bytes of geometry the arena may move per frame, 0 to only free
+		std::vector<uint32_t> m_VisibleIndices; ///< Indices of the Scene objects that passed culling this frame, reused across frames
+		RenderQueue m_RenderQueue;              ///< Sort keys of this frame's batches
+		FrameArena m_FrameArena;                ///< Double-buffered scratch memory for the per-frame batch list
+		std::vector<ObjectBatch> m_Batches;     ///< Batch cache, indexed by SceneObject::GetBatchIndex()
+		FlatHashMap<uint64_t, uint32_t> m_BatchLookup; ///< Index of the cached batch of each batch key
+
+		std::vector<QueuedBatch> m_QueuedBatches; ///< Batches referenced by the render queue payloads
+		RenderCommandQueue m_Commands;            ///< Command lists of the directly drawn batches and the skybox
+		std::vector<size_t> m_BatchBaseInstances; ///< First MVP buffer instance of each batch, while recording
+		bool m_IndirectDrawing = true;            ///< Whether batches are submitted through m_IndirectBuffer on OpenGL 4.3+
+		bool m_VertexPulling = false;             ///< Whether indirect batches pull their vertices when supported
+		IndirectDrawBuffer m_IndirectBuffer;      ///< Indirect commands of this frame's batches
+		GeometryArena m_GeometryArena;            ///< Shared vertex / index storage of every mesh drawn by this renderer
+		std::vector<IndirectGroup> m_IndirectGroups; ///< Material / vertex array runs of m_IndirectBuffer
+		bool m_BindlessMaterials = true;             ///< Whether materials are read from m_MaterialBuffer when supported
+		MaterialBuffer m_MaterialBuffer;             ///< Records of the materials drawn this frame (bindless path)
+		MaterialInstanceBuffer m_MaterialInstances;  ///< Per-material values read per instance, e.g. tints of shared batches
+		ClusteredLightManager m_ClusteredLights;     ///< Point lights and per-cluster light lists (clustered forward path)
+		bool m_ObjectLights = false;                 ///< Whether m_ObjectLightAssigner picks the point lights of every object
+		ObjectLightAssigner m_ObjectLightAssigner;   ///< Point lights of each object (OpenGL 4.1 forward path)
+		RenderingMode m_Mode = RenderingMode::Default; ///< Mode set by the last ConfigureRenderingMode()
+		GBuffer m_GBuffer;                             ///< Render targets of the deferred geometry pass
+		Shader* m_DeferredLightingShader = nullptr;    ///< Full-screen lighting pass of RenderingMode::Deferred
+		bool m_DepthPrepass = false;                   ///< Whether batches are drawn depth-only before being shaded
+		bool m_AmbientOcclusion = false;               ///< Whether m_SSAO is computed from the depth prepass
+		AmbientOcclusion m_SSAO;                       ///< Occlusion of the ambient lighting, white while disabled
+		bool m_VolumetricFog = false;                  ///< Whether m_Fog is computed for every view
+		VolumetricFog m_Fog;                           ///< Froxel fog applied by the lighting, clear while disabled
+		const Lightmap* m_Lightmap = nullptr;          ///< Baked lighting bound for the lightmapped meshes, not owned
+		SpriteBatch* m_Overlay = nullptr;              ///< 2D quads drawn over the final image, not owned
+		bool m_LateLatchInput = false;                 ///< Whether input is polled and the view recomputed at the start of Render()
+		bool m_bFramePrepared = false;                 ///< Whether PrepareFrame() ran since the last Render()
+		std::shared_ptr<BaseCamera> m_FrameCamera;     ///< View snapshot of the prepared frame, created on first use
+		BaseCamera* m_CaptureCamera = nullptr;         ///< Camera of the RenderCapture() in progress, nullptr outside of one
+		float m_CullDistance = 0.0f;                   ///< Draw distance of the RenderCapture() in progress, 0 for none
+		PortalGraph* m_PortalGraph = nullptr;          ///< Cells and portals culling hidden rooms, not owned
+		std::span<const RenderView> m_Views;           ///< Views of the RenderViews() in progress, empty outside of one
+		std::vector<Frustum> m_ViewFrustums;           ///< Frustums of m_Views, reused across frames
+		std::vector<LODView> m_LODViews;               ///< Level of detail parameters of the frame's cameras, reused across frames
+		std::unique_ptr<Shader> m_DepthPrepassShader;  ///< Position-only shader of the depth prepass, compiled on first use
+		const Texture* m_Skybox = nullptr;             ///< CubeMap of the sky pass, nullptr to draw the Scene's SkyboxEntity
+		std::unique_ptr<Shader> m_SkyShader;           ///< Full-screen triangle shader of the sky pass, compiled on first use
+		VertexArrayHandle m_SkyVertexArray;            ///< Empty vertex array the sky triangle is drawn with
+		TransparencyMode m_TransparencyMode = TransparencyMode::Sorted; ///< Blending of the transparent pass
+		TransparencyBuffer m_TransparencyBuffer;       ///< Accumulation targets of TransparencyMode::WeightedBlended, created on first use
+		std::vector<ParticleSystem*> m_ParticleSystems; ///< Particle systems drawn after the transparent objects
+		std::vector<Terrain*> m_Terrains;              ///< Terrains drawn after the opaque batches
+		std::vector<DynamicMesh*> m_DynamicMeshes;     ///< CPU-updated meshes drawn after the terrains
+		BonePaletteBuffer m_BonePalettes;              ///< Skinning matrices of the animated objects
+		GLuint m_StaticInstanceBuffer = 0;             ///< One identity instance per chunk of the Scene's StaticGeometry
+		uint64_t m_StaticRevision = 0;                 ///< Revision of the StaticGeometry last uploaded, 0 for none
+		std::vector<Material*> m_StaticMaterials;      ///< Distinct materials of the uploaded static chunks
+		JobSystem* m_JobSystem = nullptr;              ///< Job system the instance data is written on, nullptr for the calling thread
+		size_t m_InstanceChunkSize = 1024;             ///< Instances written per job
+		std::vector<SceneObject*> m_SlotObjects;       ///< Object of every instance slot this frame, reused across frames
+		std::vector<std::pair<size_t, size_t>> m_ChunkDirtyRanges; ///< Slots [first, second) written by each chunk
+		std::vector<Material*> m_FrameMaterials;     ///< Distinct materials of this frame's objects, reused across frames
+		bool m_GPUCullingEnabled = false;            ///< Whether objects are culled by m_GPUCulling when supported
+		GPUCulling m_GPUCulling;                     ///< GPU copy of the Scene objects and compute culling passes, created on first use
+		bool m_GPUObjectsCurrent = false;            ///< Whether every object of the GPU copy is up to date, false after CPU frames
+		bool m_GPUCommandsBindless = false;          ///< Whether the GPU culling groups were built for bindless materials
+		bool m_GPUCommandsPulled = false;            ///< Whether the GPU culling groups were built for vertex pulling
+		bool m_bBatchDrawsMoved = false;             ///< Whether a batch draw moved in the arena since the GPU culling commands were recorded
+		std::vector<uint32_t> m_UploadedObjects;     ///< Scene indices of the objects uploaded this frame
+		std::vector<std::pair<uint32_t, uint32_t>> m_GPUDraws; ///< Batch and draw of every command sorted by RecordGPUCommands()
+		std::vector<IndirectGroup> m_GPUIndirectGroups; ///< Material / vertex array runs of the GPU culling commands
+		GLuint m_InstanceSource = 0;                 ///< Buffer the instanced attributes were last pointed at
+		bool m_OcclusionCulling = false;             ///< Whether objects hidden in previous frames' depth are skipped
+		bool m_MeshletCulling = true;                ///< Whether meshlets are culled one by one on the indirect path
+		Frustum m_MeshletFrustum;                    ///< View frustum of the frame the meshlets are culled against
+		HiZBuffer m_HiZBuffer;                       ///< Depth pyramid of the previous frame (GPU culling path), created on first use
+		OcclusionQueries m_OcclusionQueries;         ///< Occlusion queries of the CPU culling path, created on first use
+		bool m_Shadows = false;                      ///< Whether the directional light casts cascaded shadows
+		CascadedShadowMaps m_ShadowMaps;             ///< Cascades of the directional light and their shadow map
+		LayerMask m_ShadowCasterLayers = AllLayers;  ///< Render layers drawn into the shadow map
+		MatrixBuffer m_ShadowInstances;              ///< Instances of the shadow casters, cascade mask in MaterialIndex
+		std::vector<uint32_t> m_CascadeIndices;      ///< Scene indices inside one cascade, reused across frames
+		std::vector<uint32_t> m_CasterMasks;         ///< Cascades overlapped by every Scene object this frame
+		std::vector<std::pair<uint32_t, SceneObject*>> m_ShadowCasters; ///< Batch and object of every caster drawn
+		bool m_LocalShadows = false;                 ///< Whether the point lights and the spot light cast shadows
+		LocalShadowAtlas m_LocalShadowAtlas;         ///< Tiles of the point and spot light shadows
+		MatrixBuffer m_LocalShadowInstances;         ///< Instances of the local shadow casters, one run per face
+		std::array<std::vector<uint32_t>, LocalShadowAtlas::SlotCount> m_LocalCasterIndices; ///< Scene indices in each light's sphere, reused across frames
+		std::vector<std::pair<uint32_t, SceneObject*>> m_LocalShadowCasters; ///< Batch and object of every face's casters, face by face
+		std::vector<uint32_t> m_LocalShadowRuns;     ///< End of each drawn face's casters in m_LocalShadowCasters
+		RenderTarget m_SceneTarget;                  ///< Offscreen target of the Scene below full resolution, created on first use
+		float m_RenderScale = 1.0f;                  ///< Internal resolution over viewport size, per axis, without dynamic resolution
+		bool m_DynamicResolution = false;            ///< Whether the render scale follows the GPU frame time
+		ResolutionController m_ResolutionController; ///< GPU frame timing and render scale of dynamic resolution
+		bool m_QualityGovernorEnabled = false;       ///< Whether m_QualityGovernor steps the quality settings
+		QualityGovernor m_QualityGovernor;           ///< Ladder of quality levels and its hysteresis
+		uint64_t m_QualityMeasurements = 0;          ///< GPU frame times of m_ResolutionController already fed to the governor
+		int m_RenderTargetSamples = 4;               ///< Samples per pixel of m_SceneTarget
+		bool m_PostProcessing = false;               ///< Whether m_PostProcess is applied to the frames
+		AntiAliasingMode m_AntiAliasing = AntiAliasingMode::MSAA; ///< How edges are smoothed
+		uint32_t m_TemporalFrame = 0;                ///< Frames drawn with TAA, indexes the jitter sequence
+		glm::mat4 m_PreviousViewProjection = glm::mat4(1.0f); ///< Unjittered view projection of the last TAA frame
+		PostProcessStack m_PostProcess;              ///< Effects applied between m_SceneTarget and the output
+		RenderTarget* m_OutputTarget = nullptr;      ///< Final target of the frames, nullptr for the default framebuffer
+		FrameCapture m_FrameCapture;                 ///< Reads back the final image of requested frames
+		ObjectPicker m_ObjectPicker;                 ///< ID pass and readback of the requested picks
+		GPUProfiler m_GPUProfiler;                   ///< Timestamps around the passes, when enabled
+#if defined(FIREGL_ENABLE_DEBUG_DRAW)
+		DebugDraw m_DebugDraw;                       ///< Debug lines drawn over the Scene, latched with the frame
+#endif
+		RenderStats m_Stats;                         ///< Counters of the last frame
+		uint32_t m_StatsLogInterval = 0;             ///< Frames between two prints of m_Stats, 0 to never print
+		uint32_t m_StatsLogFrame = 0;                ///< Frames since m_Stats was last printed
 	};
 
 } // namespace fgl
\ No newline at end of file
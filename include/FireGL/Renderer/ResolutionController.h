@@ -0,0 +1,115 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+
+#include <External/glad/glad.h>
+
+namespace fgl
+{
+
+	/** Telemetry of a ResolutionController, as of its last update. */
+	struct ResolutionControllerState
+	{
+		float Scale = 1.0f;        ///< Continuous render scale the controller drives.
+		float AppliedScale = 1.0f; ///< Scale the frame is rendered at, Scale rounded to the controller's step.
+		float GPUFrameTime = 0.0f; ///< Last GPU frame time read back, in milliseconds.
+		float Error = 0.0f;        ///< (target - GPU frame time) / target of the last measurement, positive with headroom.
+		float Adjustment = 0.0f;   ///< Change of Scale made by the last measurement.
+		uint32_t Latency = 0;      ///< Frames between the measured frame and the one its result was read in.
+		uint64_t Measurements = 0; ///< Number of GPU frame times read back since the controller was reset.
+	};
+
+	/**
+	 * Dynamic resolution controller driven by the GPU time of each frame.
+	 *
+	 * BeginFrame() and EndFrame() wrap the frame's GPU work in a GL_TIME_ELAPSED query taken from a small ring.
+	 * Results are read once available, two or three frames later, without ever waiting for them: a frame whose
+	 * ring slot is still busy simply isn't measured. Every result feeds a PID controller in velocity form:
+	 *
+	 *     Error      = (TargetFrameTime - GPUFrameTime) / TargetFrameTime
+	 *     Adjustment = Kp * (Error - PreviousError) + Ki * Error + Kd * (Error - 2 * PreviousError + OlderError)
+	 *
+	 * Adjustment is added to the scale, clamped between the bounds; the velocity form has no integral state to
+	 * wind up while the scale sits at a bound. GetAppliedScale() rounds the scale to steps of 1/16, so render
+	 * targets sized from it are only reallocated when the resolution really changes.
+	 */
+	class ResolutionController
+	{
+	public:
+		static constexpr size_t QueryCount = 4; ///< Frames that can be in flight before a frame goes unmeasured.
+
+		/** Deletes the queries. */
+		void Destroy();
+
+		/**
+		 * Starts timing a frame. Requires a current OpenGL context.
+		 * No other GL_TIME_ELAPSED query may be active until EndFrame().
+		 */
+		void BeginFrame();
+
+		/** Stops timing the frame and reads back the results of earlier frames that arrived. */
+		void EndFrame();
+
+		/**
+		 * @param Milliseconds The GPU frame time to hold.
+		 */
+		void SetTargetFrameTime(float Milliseconds);
+
+		/**
+		 * @param MinScale The lowest render scale allowed.
+		 * @param MaxScale The highest render scale allowed.
+		 */
+		void SetBounds(float MinScale, float MaxScale);
+
+		/**
+		 * Sets the gains of the controller, normalized: an error of 1 is a frame time of zero or twice the target.
+		 *
+		 * @param Proportional Kp, reacts to changes of the error.
+		 * @param Integral Ki, moves the scale while an error persists.
+		 * @param Derivative Kd, damps sudden changes of the error.
+		 */
+		void SetGains(float Proportional, float Integral, float Derivative);
+
+		/**
+		 * Sets the scale the controller continues from, clamped to the bounds, and forgets the previous errors.
+		 *
+		 * @param Scale The render scale.
+		 */
+		void Reset(float Scale);
+
+		/** @return The render scale to size the frame with, rounded to steps of 1/16. */
+		float GetAppliedScale() const;
+
+		/** @return The state of the controller, for telemetry. */
+		const ResolutionControllerState& GetState() const;
+
+	private:
+		/** One frame's query in the ring. */
+		struct FrameQuery
+		{
+			GLuint Query = 0;      ///< GL_TIME_ELAPSED query object, created on first use.
+			uint64_t Frame = 0;    ///< Frame the query timed.
+			bool bPending = false; ///< Whether its result hasn't been read yet.
+		};
+
+		/** Feeds one GPU frame time to the PID controller. */
+		void Apply(float GPUFrameTime, uint32_t Latency);
+
+		std::array<FrameQuery, QueryCount> m_Queries{}; ///< Ring of frame queries.
+		size_t m_Next = 0;                  ///< Ring slot of the next frame.
+		size_t m_Oldest = 0;                ///< Ring slot of the oldest pending query.
+		uint64_t m_Frame = 0;               ///< Frames begun.
+		bool m_bTiming = false;             ///< Whether the current frame's query was begun.
+
+		float m_TargetFrameTime = 1000.0f / 60.0f; ///< GPU frame time held, in milliseconds.
+		float m_MinScale = 0.5f;            ///< Lowest scale.
+		float m_MaxScale = 1.0f;            ///< Highest scale.
+		float m_Proportional = 0.2f;        ///< Kp.
+		float m_Integral = 0.1f;            ///< Ki.
+		float m_Derivative = 0.0f;          ///< Kd.
+		float m_PreviousError = 0.0f;       ///< Error of the previous measurement.
+		float m_OlderError = 0.0f;          ///< Error of the measurement before it.
+		ResolutionControllerState m_State;  ///< Telemetry.
+	};
+
+} // namespace fgl
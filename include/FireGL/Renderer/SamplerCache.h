@@ -0,0 +1,70 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+
+#include <External/glad/glad.h>
+
+namespace fgl
+{
+
+	/** Wrapping and filtering of a texture, as held by an OpenGL sampler object. */
+	struct SamplerState
+	{
+		GLenum WrapS = GL_REPEAT;                   ///< Wrapping of the horizontal axis (U-coordinate).
+		GLenum WrapT = GL_REPEAT;                   ///< Wrapping of the vertical axis (V-coordinate).
+		GLenum WrapR = GL_REPEAT;                   ///< Wrapping of the depth axis, used by cube maps.
+		GLenum MinFilter = GL_LINEAR_MIPMAP_LINEAR; ///< Minification filter.
+		GLenum MagFilter = GL_LINEAR;               ///< Magnification filter.
+		bool bAnisotropic = true;                   ///< Whether the global anisotropy applies, only to mipmapped minification.
+
+		bool operator==(const SamplerState& Other) const = default;
+	};
+
+	/**
+	 * Engine-wide cache of OpenGL sampler objects, one per distinct SamplerState.
+	 *
+	 * Textures bound through Texture::Activate() (as Material does for each of its units) bind the cached
+	 * sampler of their state along, which overrides the parameters stored in the texture. Every texture
+	 * sharing a state shares its sampler, and changing the anisotropy only touches the few samplers.
+	 *
+	 * Samplers are created on first use and live as long as the context. Get() and SetMaxAnisotropy()
+	 * must run on the thread owning the OpenGL context.
+	 */
+	class SamplerCache
+	{
+	public:
+		/**
+		 * Returns the sampler of a state, creating it on first use.
+		 *
+		 * @param State The wrapping and filtering to sample with.
+		 * @return The OpenGL sampler object, owned by the cache.
+		 */
+		static GLuint Get(const SamplerState& State);
+
+		/**
+		 * Sets the anisotropic filtering of every anisotropic sampler, existing and future.
+		 * Higher values keep surfaces seen at grazing angles sharp, at the cost of more texel fetches;
+		 * 1 disables anisotropic filtering, e.g. on low-end targets.
+		 *
+		 * @param Anisotropy The maximum anisotropy, clamped to [1, GetSupportedAnisotropy()].
+		 */
+		static void SetMaxAnisotropy(float Anisotropy);
+
+		/** @return The anisotropy the anisotropic samplers use, 1 by default. */
+		static float GetMaxAnisotropy();
+
+		/** @return The highest anisotropy of the context, 1 without anisotropic filtering support. */
+		static float GetSupportedAnisotropy();
+
+		/** @return The number of samplers created. */
+		static size_t GetCount();
+
+	private:
+		/** Sets the anisotropy of a sampler from its state and the global setting. */
+		static void ApplyAnisotropy(GLuint Sampler, const SamplerState& State);
+
+		static std::vector<std::pair<SamplerState, GLuint>> s_Samplers; ///< Created samplers, a handful at most so scanned linearly.
+		static float s_MaxAnisotropy;                                    ///< Anisotropy of the anisotropic samplers.
+	};
+
+} // namespace fgl
@@ -1,11 +1,56 @@
 #pragma once
 
 #include <FireGL/fglpch.h>
+#include <FireGL/Renderer/BoundingVolume.h>
+#include <FireGL/Renderer/DynamicBVH.h>
+#include <FireGL/Renderer/OverlapSystem.h>
+#include <FireGL/Renderer/TickScheduler.h>
+#include <FireGL/Renderer/RenderLayers.h>
+#include <FireGL/Core/MemoryTracker.h>
+
+#include <mutex>
+#include <deque>
 
 namespace fgl
 {
 	class BaseCamera;
 	class SceneObject;
+	class Frustum;
+	class JobSystem;
+	class StaticGeometry;
+
+	/** An object crossed by a ray, see Scene::QueryRay(). */
+	struct RayHit
+	{
+		uint32_t ObjectIndex; ///< Index of the object in Scene::GetObjects().
+		float Distance;       ///< Distance along the ray to the object's bounding sphere.
+	};
+
+	/** Kinds of change recorded in a Scene's journal, see Scene::GetChanges(). */
+	enum class SceneChange : uint8_t
+	{
+		Added,     ///< The object was added to the scene.
+		Transform, ///< The object's Transform changed.
+		Material,  ///< The object's material changed, see SceneObject::NotifyMaterialChanged().
+		Mesh,      ///< The object's meshes changed, see SceneObject::NotifyMeshChanged().
+		Reindexed, ///< The object was moved to a new index by the compaction of removed objects.
+		Count
+	};
+
+	/**
+	 * The changes of the objects of a Scene over one frame, published by Scene::Process() for systems that
+	 * update incrementally (GPU buffers, acceleration structures, streaming) instead of scanning every object.
+	 * An object appears at most once per list, in no particular order.
+	 */
+	struct SceneChangeList
+	{
+		std::array<TaggedVector<uint32_t, MemoryTag::Scene>, static_cast<size_t>(SceneChange::Count)> Objects; ///< Indices in Scene::GetObjects() of the objects with each change.
+		TaggedVector<const SceneObject*, MemoryTag::Scene> Removed; ///< Objects removed from the scene, only to identify them: they may be destroyed or recycled.
+		uint64_t Frame = 0;                                         ///< Number of publications so far, to detect a missed frame.
+
+		/** @return The indices of the objects with a change. */
+		const TaggedVector<uint32_t, MemoryTag::Scene>& Get(SceneChange Type) const { return Objects[static_cast<size_t>(Type)]; }
+	};
 
 	/**
 	 * Scene Class
@@ -21,10 +66,23 @@ namespace fgl
 	 * - For correct ownership transfer, objects should be passed to the scene using std::move().
 	 * - This class can manage multiple cameras and switch between them.
 	 * - The renderer accesses scene objects directly through the provided GetObjects() method.
+	 * - World-space bounds are kept in a DynamicBVH, refit only for the objects whose Transform changed,
+	 *   and the Query functions use it to answer frustum, box, sphere and ray queries in sub-linear time.
+	 * - Added objects are queued for GPU upload, the renderer drains the queue at the start of its frames.
+	 * - Removed objects stay in place until the next Process(), which compacts them away in one batch by moving
+	 *   the last objects into their slots. Objects acquired from an ObjectPool are recycled instead of deleted.
+	 * - The render layers of the objects are copied in a contiguous array, and each layer lists its objects,
+	 *   so the passes drawing a few layers visit only their objects rather than every object's layers.
+	 * - Additions, removals and changes of transform, material or meshes are recorded in a journal, once per
+	 *   object however often it changes, and published every Process() as a SceneChangeList.
+	 * - The object lists and queues count their storage under MemoryTag::Scene.
 	 */
 	class Scene
 	{
 	public:
+		using ObjectList = TaggedVector<std::unique_ptr<SceneObject>, MemoryTag::Scene>; ///< Objects owned by a scene.
+		using IndexList = TaggedVector<uint32_t, MemoryTag::Scene>;                      ///< Indices in GetObjects().
+
 		/**
 		 * Default constructor for the Scene class.
 		 *
@@ -40,30 +98,279 @@ namespace fgl
 		Scene(std::shared_ptr<BaseCamera> ActiveCamera);
 
 		/** Virtual destructor for proper cleanup of derived classes */
-		virtual ~Scene() = default;
+		virtual ~Scene();
 
 		/**
 		 * Adds a new object to the scene, transferring ownership.
-		 * The passed object is set to nullptr after the transfer.
+		 * The passed object is set to nullptr after the transfer, and queued in GetPendingUploads().
 		 *
 		 * @param Object A unique pointer to the SceneObject being added.
 		 */		
 		void AddObject(std::unique_ptr<SceneObject> Object);
+
+		/**
+		 * Reserves the per-object storage of the scene, so adding many objects at once, e.g. a level loaded
+		 * with SceneFile::Instantiate(), doesn't grow it step by step.
+		 *
+		 * @param ObjectCount The number of objects the scene will hold.
+		 */
+		void Reserve(size_t ObjectCount);
+
+		/**
+		 * Queues an object for removal. It is destroyed, or returned to its ObjectPool, by the next
+		 * FlushRemovedObjects(); until then it stays in GetObjects() and is still ticked and rendered.
+		 * Removal moves other objects to new indices.
+		 *
+		 * @param Object The object to remove, owned by this scene. Queuing it twice has no effect.
+		 */
+		void RemoveObject(SceneObject* Object);
+
+		/**
+		 * Removes every object queued by RemoveObject(), filling their slots with the last objects of the list
+		 * (swap-and-pop). Called at the start of Process(), which is the end of the previous frame.
+		 */
+		void FlushRemovedObjects();
+
+		/**
+		 * Defers the changes to the object list until ApplyDeferredChanges(): while enabled, AddObject() queues
+		 * the objects without adding them (BeginPlay() included) and Process() no longer flushes the removed ones.
+		 * Enabled by Renderer::PrepareFrame(), so a render thread drawing the previous frame never sees the list
+		 * change. Disabling it applies the deferred changes.
+		 *
+		 * @param bEnabled True to defer the changes, false (the default) to apply them as they are made.
+		 */
+		void SetDeferredChanges(bool bEnabled);
+
+		/** @return True while changes to the object list are deferred. */
+		bool IsDeferringChanges() const;
+
+		/** Flushes the removed objects, then adds the objects queued while changes were deferred, in order. */
+		void ApplyDeferredChanges();
 		
 		/**
 		 * Processes all objects in the scene and updates the active camera.
+		 * The objects removed since the last call are compacted away first.
+		 *
+		 * The components of the scene's entities are ticked first, one component type after the other, by
+		 * ComponentPoolBase::TickAll().
+		 *
+		 * The objects are ticked by the TickScheduler, which only visits the objects that want a tick, aren't
+		 * sleeping and whose tick interval elapsed: TickGroup::PrePhysics before the components,
+		 * TickGroup::PostPhysics after them. With a job system set, the due objects whose IsTickThreadSafe()
+		 * returns true are ticked first, in parallel chunks on the workers; the others are then ticked one after
+		 * the other on the calling thread.
+		 *
+		 * With a fixed timestep (see TimeManager::SetFixedTimeStep()) all of the above runs once per step of the
+		 * frame, possibly zero times, with the fixed delta time; the transforms moved by the last step are then
+		 * rendered between their previous and current state (see TransformPool).
+		 *
+		 * The OverlapSystem is updated once per frame, sending the overlap events of the final transforms, and
+		 * TickGroup::Late is ticked last with the frame delta time.
 		 *
 		 * @note This function relies on TimeManager to update each object.
 		 */
 		void Process();
 
+		/**
+		 * Sets the job system thread-safe objects are ticked on.
+		 *
+		 * @param Jobs The job system to use, nullptr (the default) to tick every object on the calling thread.
+		 * @param ChunkSize The number of objects ticked per job.
+		 */
+		void SetJobSystem(JobSystem* Jobs, size_t ChunkSize = 64);
+
 		/**
 		 * Retrieves the list of all objects in the scene.
 		 * This function is called by the renderer to access and render scene objects.
 		 *
 		 * @return A const reference to the vector of unique pointers to SceneObjects.
 		 */		
-		const std::vector<std::unique_ptr<SceneObject>>& GetObjects() const;
+		const ObjectList& GetObjects() const;
+
+		/**
+		 * Merges the meshes of every object marked static (see SceneObject::SetStatic()) into pre-transformed
+		 * chunks of a uniform grid, one per cell and material, replacing the previous ones (see StaticGeometry).
+		 * The merged objects stay in the scene, ticked and returned by the queries, but the renderer draws their
+		 * chunks instead of batching them. Call it once the level is loaded: static objects added later are drawn
+		 * on their own until the next call, and merged objects removed, moved or given other materials keep
+		 * their merged look until then. Objects that can't be merged (see StaticGeometry::CanMerge()) are drawn
+		 * on their own.
+		 *
+		 * @param ChunkSize Edge of the grid cells, in world units: larger cells mean fewer draws but coarser culling.
+		 */
+		void BuildStaticGeometry(float ChunkSize = 64.0f);
+
+		/** Drops the merged geometry, every static object is drawn on its own again. */
+		void ClearStaticGeometry();
+
+		/** @return The geometry merged by the last BuildStaticGeometry(), nullptr if none was built. */
+		StaticGeometry* GetStaticGeometry() const;
+
+		/**
+		 * Retrieves the objects added but not uploaded to the GPU yet, oldest first.
+		 * The renderer pops the objects it uploads; they aren't drawn until then.
+		 *
+		 * @return A reference to the indices, in GetObjects(), of the objects waiting for their upload.
+		 */
+		TaggedDeque<uint32_t, MemoryTag::Scene>& GetPendingUploads();
+
+		/**
+		 * Refreshes the world-space bounding spheres of every object, and their leaves in the BVH.
+		 * Only the objects added or whose Transform changed since the last call are visited. Skyboxes get an
+		 * infinite radius so they are never culled, and stay out of the BVH. Called by the renderer before culling.
+		 * The visited objects are then listed by GetChangedObjects().
+		 */
+		void UpdateBoundingSpheres();
+
+		/**
+		 * Retrieves the objects visited by the last UpdateBoundingSpheres(): added, moved by the compaction of
+		 * removed objects, or whose Transform, batch or texture layers changed. Lets the renderer keep copies
+		 * of per-object data, e.g. in GPU buffers, and only refresh the changed entries.
+		 *
+		 * @return The indices, in GetObjects(), of the changed objects; may hold duplicates. Valid until the next FlushRemovedObjects().
+		 */
+		const IndexList& GetChangedObjects() const;
+
+		/**
+		 * Retrieves the skyboxes, which have no bounds and are left out of the spatial queries' hierarchy.
+		 *
+		 * @return The indices, in GetObjects(), of the skybox objects.
+		 */
+		const IndexList& GetUnboundedObjects() const;
+
+		/**
+		 * Retrieves the render layers of every object, as of the last UpdateBoundingSpheres().
+		 * Index i matches GetObjects()[i].
+		 *
+		 * @return A const reference to the layer masks.
+		 */
+		const TaggedVector<LayerMask, MemoryTag::Scene>& GetObjectLayers() const;
+
+		/**
+		 * Retrieves the objects of one layer, as of the last UpdateBoundingSpheres().
+		 *
+		 * @param Layer The index of the layer, below MaxLayers.
+		 * @return The indices, in GetObjects(), of the objects in the layer in increasing order.
+		 */
+		const IndexList& GetLayerObjects(uint32_t Layer) const;
+
+		/** @return The union of the layers of every object, as of the last UpdateBoundingSpheres(). */
+		LayerMask GetUsedLayers() const;
+
+		/**
+		 * Lists the objects in any of several layers, walking only the lists of these layers.
+		 *
+		 * @param Layers The layers to gather.
+		 * @param OutIndices Cleared, then filled with the indices of the objects in increasing order, each once.
+		 */
+		void GatherLayerObjects(LayerMask Layers, std::vector<uint32_t>& OutIndices) const;
+
+		/**
+		 * Drops the objects in none of several layers from a list, e.g. the result of a query.
+		 * Nothing is visited when every used layer is kept.
+		 *
+		 * @param Layers The layers to keep.
+		 * @param Indices The indices, in GetObjects(), to filter in place; their order is kept.
+		 */
+		void FilterLayers(LayerMask Layers, std::vector<uint32_t>& Indices) const;
+
+		/**
+		 * Called by a SceneObject whose Transform or instance data changed, queues it for the next UpdateBoundingSpheres().
+		 *
+		 * @param ObjectIndex The index of the object in GetObjects().
+		 */
+		void OnObjectMoved(uint32_t ObjectIndex);
+
+		/**
+		 * Records a change of an object in the journal published by the next Process(). Thread-safe, objects
+		 * ticked in parallel report their changes concurrently; an object already recorded only gains a bit.
+		 *
+		 * @param Object The object, owned by this scene.
+		 * @param Type The kind of change.
+		 */
+		void RecordChange(SceneObject* Object, SceneChange Type);
+
+		/**
+		 * Retrieves the changes recorded before the last Process(), including the objects it added and the
+		 * transforms changed by the ticks. Changes recorded later, e.g. transforms computed while rendering,
+		 * are published by the next one.
+		 *
+		 * @return The changes. The indices are valid until the next FlushRemovedObjects().
+		 */
+		const SceneChangeList& GetChanges() const;
+
+		/**
+		 * Finds the objects whose bounding sphere intersects a frustum, skyboxes included.
+		 * Uses the bounds of the last UpdateBoundingSpheres().
+		 *
+		 * @param ViewFrustum The frustum to test against.
+		 * @param OutIndices Cleared, then filled with the indices of the visible objects in increasing order.
+		 */
+		void QueryFrustum(const Frustum& ViewFrustum, std::vector<uint32_t>& OutIndices) const;
+
+		/**
+		 * Finds the objects whose bounding sphere intersects any of several frustums, skyboxes included,
+		 * walking the hierarchy once for all of them rather than once per frustum.
+		 *
+		 * @param Frustums The frustums to test against, e.g. the cameras of several views.
+		 * @param OutIndices Cleared, then filled with the indices of the visible objects in increasing order, each once.
+		 */
+		void QueryFrustums(std::span<const Frustum> Frustums, std::vector<uint32_t>& OutIndices) const;
+
+		/**
+		 * Finds the objects whose bounding sphere overlaps a box.
+		 * Uses the bounds of the last UpdateBoundingSpheres().
+		 *
+		 * @param Box The world-space box to test against.
+		 * @param OutIndices Cleared, then filled with the indices of the overlapping objects in increasing order.
+		 */
+		void QueryBox(const BoundingBox& Box, std::vector<uint32_t>& OutIndices) const;
+
+		/**
+		 * Finds the objects whose bounding sphere overlaps a sphere, e.g. everything within a radius of a point.
+		 * Uses the bounds of the last UpdateBoundingSpheres().
+		 *
+		 * @param Sphere The world-space sphere to test against.
+		 * @param OutIndices Cleared, then filled with the indices of the overlapping objects in increasing order.
+		 */
+		void QuerySphere(const BoundingSphere& Sphere, std::vector<uint32_t>& OutIndices) const;
+
+		/**
+		 * Finds the objects whose bounding sphere is crossed by a ray segment, e.g. for picking.
+		 * Uses the bounds of the last UpdateBoundingSpheres().
+		 *
+		 * @param Origin The start of the ray.
+		 * @param Direction The direction of the ray, normalized by the query.
+		 * @param MaxDistance The length of the segment.
+		 * @param OutHits Cleared, then filled with the crossed objects from nearest to farthest.
+		 */
+		void QueryRay(const glm::vec3& Origin, const glm::vec3& Direction, float MaxDistance, std::vector<RayHit>& OutHits) const;
+
+		/**
+		 * Retrieves the world-space bounding spheres, stored as a structure of arrays.
+		 * Index i matches GetObjects()[i].
+		 *
+		 * @return A const reference to the bounding sphere arrays.
+		 */
+		const BoundingSphereArrays& GetBoundingSpheres() const;
+
+		/**
+		 * Retrieves the broadphase finding the overlaps between the objects with overlap events
+		 * (see SceneObject::SetOverlapEvents()), updated by Process().
+		 *
+		 * @return A reference to the scene's OverlapSystem.
+		 */
+		OverlapSystem& GetOverlapSystem();
+		const OverlapSystem& GetOverlapSystem() const;
+
+		/**
+		 * Retrieves the scheduler ticking the objects, e.g. for the number of active objects per group.
+		 * Objects change their registration with SceneObject::SetTickGroup(), SetTickInterval() and Sleep().
+		 *
+		 * @return A reference to the scene's TickScheduler.
+		 */
+		TickScheduler& GetTickScheduler();
+		const TickScheduler& GetTickScheduler() const;
 
 		/**
 		 * Sets the active camera for the scene.
@@ -94,14 +401,95 @@ namespace fgl
 		void RemoveCamera(std::shared_ptr<BaseCamera> Camera);
 
 	protected:
+		/** Ticks the components and the objects of the step groups once, see Process(). */
+		void TickObjects(float DeltaTime);
+
+		/** Turns the journal into the lists of GetChanges() and starts a new one, at the end of Process(). */
+		void PublishChanges();
+
 		/** A collection of unique pointers to the objects within the scene. */
-		std::vector<std::unique_ptr<SceneObject>> m_Objects;
+		ObjectList m_Objects;
+
+		/** World-space bounding spheres of m_Objects, in structure-of-arrays layout for SIMD culling. */
+		BoundingSphereArrays m_BoundingSpheres;
+
+		/** Transform plus bounds revision each bounding sphere was computed from, 0 if never computed. */
+		TaggedVector<uint64_t, MemoryTag::Scene> m_BoundingSphereRevisions;
+
+		/** Hierarchy over the bounding spheres of every object but skyboxes. */
+		DynamicBVH m_BoundingVolumes;
+
+		/** Leaf of each object in m_BoundingVolumes, DynamicBVH::NullNode if it has none. */
+		TaggedVector<int32_t, MemoryTag::Scene> m_BoundingVolumeLeaves;
+
+		/** Objects added or moved since the last UpdateBoundingSpheres(), may hold duplicates. */
+		IndexList m_MovedObjects;
+
+		/** Objects visited by the last UpdateBoundingSpheres(), may hold duplicates. */
+		IndexList m_ChangedObjects;
+
+		/** Objects queued by RemoveObject(), removed by the next FlushRemovedObjects(). */
+		IndexList m_PendingRemovals;
+
+		/** Objects passed to AddObject() while changes are deferred, added by ApplyDeferredChanges(). */
+		ObjectList m_DeferredObjects;
+
+		/** True while changes to the object list are deferred. */
+		bool m_bDeferChanges = false;
+
+		/** Objects added since the renderer last drained the queue, oldest first. */
+		TaggedDeque<uint32_t, MemoryTag::Scene> m_PendingUploads;
+
+		/** Guards m_MovedObjects, objects ticked in parallel report their moves concurrently. */
+		std::mutex m_MovedObjectsMutex;
+
+		/** Objects with changes since the last PublishChanges(), nullptr once removed. Each holds its entry and changes. */
+		TaggedVector<SceneObject*, MemoryTag::Scene> m_JournalObjects;
+
+		/** Objects removed since the last PublishChanges(), unless they were also added since. */
+		TaggedVector<const SceneObject*, MemoryTag::Scene> m_JournalRemoved;
+
+		/** Changes published by the last PublishChanges(). */
+		SceneChangeList m_Changes;
+
+		/** Guards m_JournalObjects. */
+		std::mutex m_JournalMutex;
+
+		/** Job system thread-safe objects are ticked on, nullptr to tick on the calling thread. */
+		JobSystem* m_JobSystem = nullptr;
+
+		/** Number of objects ticked per job. */
+		size_t m_TickChunkSize = 64;
+
+		/** Lists of the objects to tick, per tick group. */
+		TickScheduler m_TickScheduler;
+
+		/** Sort-and-sweep broadphase of the objects with overlap events. */
+		OverlapSystem m_Overlaps;
+
+		/** Render layers of m_Objects, refreshed for the objects visited by UpdateBoundingSpheres(). */
+		TaggedVector<LayerMask, MemoryTag::Scene> m_ObjectLayers;
+
+		/** Objects of each layer in increasing order, rebuilt by UpdateBoundingSpheres() once m_bLayersDirty. */
+		std::array<IndexList, MaxLayers> m_LayerObjects;
+
+		/** Union of m_ObjectLayers. */
+		LayerMask m_UsedLayers = 0;
+
+		/** True once objects were added, removed or changed layers since m_LayerObjects was built. */
+		bool m_bLayersDirty = false;
+
+		/** Skyboxes, visible from everywhere and never stored in m_BoundingVolumes. */
+		IndexList m_UnboundedObjects;
+
+		/** Meshes of the static objects merged by BuildStaticGeometry(), created on first use. */
+		std::unique_ptr<StaticGeometry> m_StaticGeometry;
 
 		/** A shared pointer to the currently active camera. */
 		std::shared_ptr<BaseCamera> m_ActiveCamera;
 
 		/** A collection of shared pointers to all cameras in the scene. */
-		std::vector<std::shared_ptr<BaseCamera>> m_Cameras;
+		TaggedVector<std::shared_ptr<BaseCamera>, MemoryTag::Scene> m_Cameras;
 	};
 
 } // namespace fgl
\ No newline at end of file
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+#include <FireGL/Core/AssetId.h>
+#include <FireGL/Core/MappedFile.h>
+#include <FireGL/Renderer/Entity.h>
+
+#include <External/glm/vec3.hpp>
+#include <External/glm/gtc/quaternion.hpp>
+
+#include <span>
+
+namespace fgl
+{
+	class Scene;
+	class SceneObject;
+	class Material;
+
+	/**
+	 * One object of a scene file, stored as is so a whole file is read with a single mapping.
+	 * Names are stored as their AssetId hash: types, materials and components are resolved through the
+	 * factories registered with SceneFile, assets are AssetPathManager keys.
+	 */
+	struct SceneFileObject
+	{
+		uint64_t Type = 0;                          ///< Hash of the type name the object is created with, see SceneFile::RegisterType().
+		uint64_t Asset = 0;                         ///< AssetId of the asset the object draws, 0 if none.
+		uint64_t Material = 0;                      ///< Hash of the material name, see SceneFile::RegisterMaterial(), 0 to keep the object's own.
+		glm::vec3 Position{ 0.0f };                 ///< Position of the Transform.
+		glm::quat Orientation{ 1.0f, 0.0f, 0.0f, 0.0f }; ///< Orientation of the Transform.
+		glm::vec3 Scale{ 1.0f };                    ///< Scale of the Transform.
+		uint32_t Flags = 0;                         ///< SceneFile::ObjectFlags of the object.
+		uint32_t FirstComponent = 0;                ///< First hash of the object's components in the component table.
+		uint32_t ComponentCount = 0;                ///< Components created on the object, an Entity.
+		uint32_t Reserved = 0;                      ///< Padding, always 0.
+	};
+
+	/**
+	 * Binary scene format, written once by a tool and instantiated in bulk when a level loads.
+	 *
+	 * A file records, per object, its type, the asset it draws, its material, its Transform, its flags and the
+	 * components of entities; nothing is parsed at load time. Open() maps the file and checks its header, and
+	 * the object records are then read in place from the mapping. Instantiate() reserves the Scene's per-object
+	 * storage for the whole file, creates every object through the factory of its type, applies its material,
+	 * Transform, flags and components, and adds it: the added objects join the Scene's upload queue, which the
+	 * Renderer drains within its upload budget (see Renderer::SetUploadBudget()), so no geometry is uploaded
+	 * during the load itself.
+	 *
+	 * The file only references assets. GetAssets() lists the distinct ones before the objects are created, so
+	 * their loads can all be started at once, e.g. with ModelLoader::LoadAsync(), and the factories then share
+	 * one loaded Model between every object drawing it.
+	 *
+	 * Layout (native endianness): a header {Magic, Version, ObjectCount, ComponentCount}, the SceneFileObject
+	 * records, then the table of component name hashes the records index into.
+	 */
+	class SceneFile
+	{
+	public:
+		static constexpr uint32_t Magic = 0x4E534746;               ///< "FGSN", identifies a FireGL scene file.
+		static constexpr uint32_t Version = 1;                      ///< Bumped whenever the layout changes.
+		static constexpr const char* Extension = ".fglscene";       ///< Conventional extension of scene files.
+
+		/** Flags of SceneFileObject::Flags. */
+		enum ObjectFlags : uint32_t
+		{
+			StaticObject = 1 << 0,      ///< SceneObject::SetStatic(true).
+			OverlapEvents = 1 << 1      ///< SceneObject::SetOverlapEvents(true).
+		};
+
+		/** Creates an object of a registered type drawing an asset, before its material and Transform are applied. */
+		using ObjectFactory = std::function<std::unique_ptr<SceneObject>(AssetId Asset)>;
+
+		/** Attaches a registered component to an entity. */
+		using ComponentFactory = std::function<void(Entity& Owner)>;
+
+		SceneFile() = default;
+
+		SceneFile(const SceneFile&) = delete;
+		SceneFile& operator=(const SceneFile&) = delete;
+
+		/**
+		 * Registers the factory of an object type, e.g. "Cube" or "Model".
+		 *
+		 * @param Name The name records refer to the type with.
+		 * @param Factory Creates the objects of the type.
+		 */
+		void RegisterType(std::string_view Name, ObjectFactory Factory);
+
+		/**
+		 * Registers a material objects can be given by name.
+		 *
+		 * @param Name The name records refer to the material with.
+		 * @param SharedMaterial The material, shared by every object using it.
+		 */
+		void RegisterMaterial(std::string_view Name, std::shared_ptr<Material> SharedMaterial);
+
+		/**
+		 * Registers a component type entities can be given by name.
+		 *
+		 * @tparam T The component type, created with Entity::CreateComponent().
+		 * @param Name The name records refer to the component with.
+		 */
+		template<typename T>
+		void RegisterComponent(std::string_view Name);
+
+		/**
+		 * Appends an object to the file written by Save(), with the Transform and flags it currently has.
+		 *
+		 * @param Type The registered name of its type.
+		 * @param Asset The AssetPathManager key of the asset it draws, empty if none.
+		 * @param MaterialName The registered name of its material, empty to keep the one its factory gives.
+		 * @param Object The object to record.
+		 * @param Components The registered names of the components to create on it, if it is an Entity.
+		 */
+		void Record(std::string_view Type, std::string_view Asset, std::string_view MaterialName, const SceneObject& Object,
+			std::initializer_list<std::string_view> Components = {});
+
+		/** Drops the objects recorded so far. */
+		void ClearRecords();
+
+		/**
+		 * Writes the recorded objects.
+		 *
+		 * @param Path The scene file to write.
+		 * @return False if the file couldn't be written.
+		 */
+		bool Save(std::string_view Path) const;
+
+		/**
+		 * Maps a scene file, closing any previously opened one.
+		 *
+		 * @param Path The scene file to map.
+		 * @return False if the file couldn't be mapped, isn't a scene file of this version or is truncated.
+		 */
+		bool Open(std::string_view Path);
+
+		/** Unmaps the scene file. */
+		void Close();
+
+		/** @return The objects of the opened file, viewing the mapping. */
+		std::span<const SceneFileObject> GetObjects() const;
+
+		/**
+		 * Lists the assets the opened file references, each once, so their loads can start before Instantiate().
+		 *
+		 * @param OutAssets Cleared, then filled with the assets in the order objects first use them.
+		 */
+		void GetAssets(std::vector<AssetId>& OutAssets) const;
+
+		/**
+		 * Creates every object of the opened file and adds it to a Scene.
+		 * Objects whose type isn't registered are skipped, unknown materials and components are ignored.
+		 *
+		 * @param Target The Scene to add the objects to.
+		 * @param OutObjects If not nullptr, receives the added objects, appended.
+		 * @param Factories The SceneFile whose registered factories and materials are used, nullptr for this one's,
+		 *                  e.g. one registry shared by the cells of a WorldStreamer.
+		 * @return The number of objects added.
+		 */
+		size_t Instantiate(Scene& Target, std::vector<SceneObject*>* OutObjects = nullptr, const SceneFile* Factories = nullptr) const;
+
+	private:
+		/** Fixed-size start of a scene file. */
+		struct Header
+		{
+			uint32_t Magic;
+			uint32_t Version;
+			uint32_t ObjectCount;
+			uint32_t ComponentCount;
+		};
+
+		std::unordered_map<uint64_t, ObjectFactory> m_Types;                  ///< Object factories by type name hash.
+		std::unordered_map<uint64_t, std::shared_ptr<Material>> m_Materials;  ///< Materials by name hash.
+		std::unordered_map<uint64_t, ComponentFactory> m_Components;          ///< Component factories by name hash.
+		std::vector<SceneFileObject> m_Records;                               ///< Objects written by Save().
+		std::vector<uint64_t> m_RecordComponents;                             ///< Component table written by Save().
+		MappedFile m_File;                                                    ///< The opened file.
+		std::span<const SceneFileObject> m_Objects;                           ///< Object records of m_File.
+		std::span<const uint64_t> m_ObjectComponents;                         ///< Component table of m_File.
+	};
+
+	template<typename T>
+	void SceneFile::RegisterComponent(std::string_view Name)
+	{
+		m_Components[AssetId::HashKey(Name)] = [](Entity& Owner) { Owner.CreateComponent<T>(); };
+	}
+
+} // namespace fgl
@@ -4,10 +4,48 @@
 #include <FireGL/Renderer/Scene.h>
 #include <FireGL/Renderer/Transform.h>
 #include <FireGL/Renderer/Mesh.h>
+#include <FireGL/Renderer/RenderLayers.h>
+#include <FireGL/Renderer/ProceduralAnimation.h>
+
+#include <cstring>
+#include <span>
 
 namespace fgl
 {
 	class Material;
+	class ObjectPoolBase;
+	class ImpostorAtlas;
+
+	/**
+	 * Flat copy of what the renderer reads of an object every frame.
+	 * Captured from the object's virtual methods when it is added to its Scene and again whenever its batch is
+	 * invalidated (see SceneObject::CaptureRenderProxy()), so the per-frame loops of the renderer read plain data
+	 * instead of dispatching through the vtable of every object. The object's matrices live in its instance slot.
+	 * The draw loops read Draws, packed per proxy, and only reach the BaseMesh itself for cold data such as meshlets.
+	 */
+	struct RenderProxy
+	{
+		static constexpr uint32_t Skybox = 1 << 0;      ///< Flag of the objects whose IsSkybox() returns true.
+
+		std::span<const BaseMesh> Meshes;               ///< GetMeshes(), which don't change after construction.
+		std::vector<MeshDrawInfo> Draws;                ///< Hot draw data of every mesh at every level, level after level, empty before the first pass.
+		std::shared_ptr<Material> ObjectMaterial;       ///< GetMaterial(), kept alive until the next capture.
+		size_t MeshID = 0;                              ///< GetHash().
+		uint32_t LODCount = 1;                          ///< Levels of detail in Draws, the largest of the meshes.
+		uint32_t Flags = 0;                             ///< Combination of the flags above.
+
+		/**
+		 * @param LOD The level of detail, clamped to the levels captured.
+		 * @return The draw info of every mesh at that level, in mesh order; empty if the meshes weren't uploaded when captured.
+		 */
+		std::span<const MeshDrawInfo> GetDraws(uint32_t LOD) const
+		{
+			if (Draws.empty())
+				return {};
+			const size_t Level = std::min(LOD, LODCount - 1);
+			return std::span<const MeshDrawInfo>(Draws).subspan(Level * Meshes.size(), Meshes.size());
+		}
+	};
 
 	/**
 	 * Base class for all game objects that can be stored and managed within the scene container.
@@ -29,9 +67,14 @@ namespace fgl
 		 * Renders the object.
 		 * Must be implemented by derived classes to define rendering logic.
 		 *
+		 * The renderer only calls this for the skybox: batches are drawn from the meshes captured in the
+		 * RenderProxy of a representative object, every instance of the batch in one instanced draw call.
+		 *
 		 * @param NumberInstance Number of instances to render (for instanced rendering).
+		 * @param BaseInstance   Index of the first instance of the batch inside the renderer's MVP buffer.
+		 * @param LOD            Level of detail the batch draws its meshes with (see BaseMesh::AddLOD()), 0 for full detail.
 		 */
-		virtual void Render(size_t NumberInstance) const = 0;
+		virtual void Render(size_t NumberInstance, size_t BaseInstance = 0, uint32_t LOD = 0) const = 0;
 
 		/**
 		 * Called during object initialization, when added to the scene.
@@ -53,6 +96,86 @@ namespace fgl
 		 */
 		virtual void Tick(float DeltaTime) = 0;
 
+		/**
+		 * Indicates whether Tick() may run on a worker thread, in parallel with the Tick() of other such objects.
+		 * Only return true if Tick() touches nothing but this object's own state (its Transform included).
+		 *
+		 * @return True to opt in to parallel ticking, false (the default) to always tick on the main thread.
+		 */
+		virtual bool IsTickThreadSafe() const { return false; }
+
+		/**
+		 * Indicates whether Tick() does anything, read when the object is added to its Scene.
+		 * Objects returning false are never registered with the Scene's TickScheduler, so they cost nothing per frame.
+		 *
+		 * @return True (the default) to be ticked, false if Tick() is empty.
+		 */
+		virtual bool WantsTick() const { return true; }
+
+		/**
+		 * Enables or disables the ticking of this object, e.g. for objects driven from outside. Takes effect
+		 * before the next tick group runs.
+		 *
+		 * @param bEnabled True (the default) to be ticked.
+		 */
+		void SetTickEnabled(bool bEnabled);
+
+		/** @return True unless the tick of the object was disabled. */
+		bool IsTickEnabled() const;
+
+		/**
+		 * Sets when the object is ticked within a frame. Takes effect before the next tick group runs.
+		 *
+		 * @param Group The group, TickGroup::PostPhysics by default.
+		 */
+		void SetTickGroup(TickGroup Group);
+
+		/** @return The group the object is ticked in. */
+		TickGroup GetTickGroup() const;
+
+		/**
+		 * Ticks the object less often than every frame, e.g. for distant AI. Tick() then receives the time
+		 * accumulated since its previous tick. The object is due once both intervals elapsed.
+		 *
+		 * @param Frames Ticks of the object's group between two ticks of the object, 1 for every one.
+		 * @param Seconds Least time between two ticks of the object, 0 for no limit.
+		 */
+		void SetTickInterval(uint32_t Frames, float Seconds = 0.0f);
+
+		/** @return The ticks of the object's group between two ticks of the object. */
+		uint32_t GetTickIntervalFrames() const;
+
+		/** @return The least time between two ticks of the object, in seconds. */
+		float GetTickIntervalSeconds() const;
+
+		/**
+		 * Stops ticking the object until WakeUp(), e.g. an idle object waiting for an overlap event.
+		 * Sleeping objects leave the TickScheduler's lists, they cost nothing per frame. Takes effect before
+		 * the next tick group runs; may be called from Tick().
+		 */
+		void Sleep();
+
+		/** Ticks the object again after Sleep(), from the next tick group on. May be called from any Tick(). */
+		void WakeUp();
+
+		/** @return True between Sleep() and WakeUp(). */
+		bool IsSleeping() const;
+
+		/**
+		 * Records the slot of this object in its Scene's TickScheduler.
+		 * Only the TickScheduler itself should call this method.
+		 *
+		 * @param Group The group whose list holds the slot.
+		 * @param Slot The index of the object in the group, TickScheduler::InvalidSlot once unregistered.
+		 */
+		void SetTickSlot(TickGroup Group, uint32_t Slot);
+
+		/** @return The slot of this object in its Scene's TickScheduler, TickScheduler::InvalidSlot if it isn't registered. */
+		uint32_t GetTickSlot() const;
+
+		/** @return The group the slot of GetTickSlot() belongs to. */
+		TickGroup GetTickSlotGroup() const;
+
 		/**
 		 * Sets the material used for rendering the object.
 		 *
@@ -80,6 +203,117 @@ namespace fgl
 		 * @param Scene Pointer to the owning Scene.
 		 */
 		void SetScene(Scene* Scene);
+
+		/**
+		 * Records the index of this object in its Scene's object list.
+		 * Only the Scene itself should call this method, right after SetScene().
+		 *
+		 * @param Index The index of the object in Scene::GetObjects().
+		 */
+		void SetSceneIndex(uint32_t Index);
+
+		/** @return The index of this object in Scene::GetObjects(). */
+		uint32_t GetSceneIndex() const;
+
+		/**
+		 * Flags this object as queued for removal by its Scene.
+		 * Only the Scene itself should call this method.
+		 *
+		 * @param bPending True once Scene::RemoveObject() was called, false once the object was removed.
+		 */
+		void SetPendingRemoval(bool bPending);
+
+		/** @return True if Scene::RemoveObject() was called and the object is still in the scene. */
+		bool IsPendingRemoval() const;
+
+		/**
+		 * Marks this object as never moving, so Scene::BuildStaticGeometry() merges its meshes with the other
+		 * static objects'. Takes effect on the next build.
+		 *
+		 * @param bStatic True if the object's Transform, meshes and materials no longer change.
+		 */
+		void SetStatic(bool bStatic);
+
+		/** @return True if the object was marked static, false by default. */
+		bool IsStatic() const;
+
+		/**
+		 * Flags this object as drawn by its Scene's StaticGeometry rather than on its own.
+		 * Only the Scene itself should call this method.
+		 *
+		 * @param bMerged True once the object's meshes were merged, false once they no longer are.
+		 */
+		void SetMerged(bool bMerged);
+
+		/** @return True if the object's meshes are drawn by its Scene's StaticGeometry. */
+		bool IsMerged() const;
+
+		/**
+		 * Sets the render layers of this object. Cameras only draw the objects sharing a layer with their
+		 * culling mask (see BaseCamera::SetCullingMask()), the shadow and picking passes filter them the same way.
+		 * Takes effect on the Scene's next UpdateBoundingSpheres().
+		 *
+		 * @param Layers The layers of the object, DefaultLayer by default; 0 hides it from every camera.
+		 */
+		void SetLayers(LayerMask Layers);
+
+		/** @return The render layers of this object. */
+		LayerMask GetLayers() const;
+
+		/**
+		 * Sets the pool this object returns to once removed from its Scene.
+		 * Called by ObjectPool::Acquire(), and not intended to be called manually.
+		 *
+		 * @param Pool The pool, nullptr to delete the object on removal.
+		 */
+		void SetObjectPool(ObjectPoolBase* Pool);
+
+		/** @return The pool this object returns to once removed, nullptr if it is deleted. */
+		ObjectPoolBase* GetObjectPool() const;
+
+		/**
+		 * Enables the overlap events of this object: while in a Scene, its OverlapSystem calls OnOverlapBegin()
+		 * and OnOverlapEnd() when the world-space box of the object starts or stops overlapping the box of
+		 * another object with overlap events.
+		 *
+		 * @param bEnabled True to receive overlap events, false by default.
+		 */
+		void SetOverlapEvents(bool bEnabled);
+
+		/** @return True if the object receives overlap events. */
+		bool HasOverlapEvents() const;
+
+		/**
+		 * Records the proxy of this object in its Scene's OverlapSystem.
+		 * Only the OverlapSystem itself should call this method.
+		 *
+		 * @param Proxy The index of the proxy, OverlapSystem::InvalidProxy once unregistered.
+		 */
+		void SetOverlapProxy(uint32_t Proxy);
+
+		/** @return The proxy of this object in its Scene's OverlapSystem, OverlapSystem::InvalidProxy if it has none. */
+		uint32_t GetOverlapProxy() const;
+
+		/**
+		 * Called by the Scene's OverlapSystem when the box of another object starts overlapping this one's.
+		 *
+		 * @param Other The other object, also receiving the event.
+		 */
+		virtual void OnOverlapBegin(SceneObject* Other) {}
+
+		/**
+		 * Called by the Scene's OverlapSystem when the box of another object stops overlapping this one's,
+		 * or when either object leaves the Scene or disables its overlap events.
+		 *
+		 * @param Other The other object, also receiving the event.
+		 */
+		virtual void OnOverlapEnd(SceneObject* Other) {}
+
+		/**
+		 * Called by the Transform the first time it changes after its Model matrix was calculated.
+		 * Queues the object's bounds for refitting in the owning Scene.
+		 */
+		void OnTransformChanged();
 	
 		/**
 		 * Retrieves the scene that owns this object.
@@ -116,10 +350,193 @@ namespace fgl
 		void SetNew(bool IsNew);
 
 		/**
-		 * Retrieves the hash value of this object.
-		 * Used for batching objects together in the rendering pipeline for instanced rendering.
+		 * Retrieves the slot this object's matrices were last written to in the renderer's instance buffer.
+		 * Used internally by the renderer to only rewrite the slots that changed.
 		 *
-		 * @return Hash value representing the object.
+		 * @return The instance slot, or SIZE_MAX if the object was never uploaded.
+		 */
+		size_t GetInstanceSlot() const;
+
+		/**
+		 * Retrieves the Transform revision that was uploaded with the object's matrices.
+		 *
+		 * @return The uploaded Transform revision.
+		 */
+		uint64_t GetInstanceRevision() const;
+
+		/**
+		 * Records where and with which Transform revision the object's matrices were uploaded.
+		 * Only the renderer should call this after writing the object's instance data.
+		 *
+		 * @param Slot Slot of the object in the instance buffer.
+		 * @param TransformRevision The Transform revision the matrices were computed from.
+		 */
+		void SetInstanceSlot(size_t Slot, uint64_t TransformRevision);
+
+		static constexpr uint32_t InvalidBatch = UINT32_MAX; ///< Batch index of an object not assigned to a batch yet.
+
+		/**
+		 * Retrieves the batch this object was assigned to in the renderer's batch cache.
+		 *
+		 * @return The batch index, or InvalidBatch until the renderer assigns one.
+		 */
+		uint32_t GetBatchIndex() const;
+
+		/**
+		 * Records the batch of this object. Only the renderer should call this.
+		 *
+		 * @param Index Index of the object's batch in the renderer's batch cache.
+		 */
+		void SetBatchIndex(uint32_t Index);
+
+		/**
+		 * Makes the renderer look the batch of this object up again on its next frame.
+		 * Must be called whenever something the batch key (see GetHash()) depends on changes.
+		 * The object is reported to its Scene as changed (see Scene::GetChangedObjects()).
+		 */
+		void InvalidateBatch();
+
+		/**
+		 * Reports a new material: invalidates the batch and records SceneChange::Material in the Scene's journal.
+		 * Called by the SetMaterial() overrides.
+		 */
+		void NotifyMaterialChanged();
+
+		/**
+		 * Reports new meshes, for objects replacing them after construction: drops the cached local bounds,
+		 * invalidates the batch, which captures the render proxy again, and records SceneChange::Mesh.
+		 */
+		void NotifyMeshChanged();
+
+		/** @return The changes recorded in the Scene's journal since its last publication, one bit per SceneChange. */
+		uint8_t GetChangeMask() const;
+
+		/** @return The journal entry of the object, valid while GetChangeMask() isn't 0. */
+		uint32_t GetChangeSlot() const;
+
+		/**
+		 * Records the journal state of the object. Only the owning Scene should call this.
+		 *
+		 * @param Mask The changes recorded since the last publication, 0 once published.
+		 * @param Slot The journal entry holding them.
+		 */
+		void SetChangeState(uint8_t Mask, uint32_t Slot);
+
+		/**
+		 * Selects the texture array layers this object samples, sent to the vertex shader at location 10.
+		 * Lets objects sharing a mesh and a material bound to texture arrays differ by texture while
+		 * staying in one instanced batch (see TextureArrayPool).
+		 *
+		 * @param Layers Up to four layers, their meaning is up to the shader (e.g. diffuse and specular).
+		 */
+		void SetTextureLayers(const glm::uvec4& Layers);
+
+		/** @return The texture array layers of this object, all 0 by default. */
+		const glm::uvec4& GetTextureLayers() const;
+
+		/**
+		 * Selects the bone palette this object is skinned with, sent to the vertex shader at location 12.
+		 * Objects sharing a skinned mesh and a material stay in one instanced batch while each follows
+		 * its own pose (see BonePaletteBuffer).
+		 *
+		 * @param Offset First bone of the object's palette, as returned by BonePaletteBuffer::Allocate().
+		 */
+		void SetBoneOffset(uint32_t Offset);
+
+		/** @return The first bone of this object's palette, 0 by default. */
+		uint32_t GetBoneOffset() const;
+
+		/**
+		 * Selects the reflection probe this object samples, sent to the vertex shader in the second component
+		 * of location 12. Usually assigned by ReflectionProbes::AssignNearest().
+		 *
+		 * @param Probe Index of the probe plus 1, 0 to reflect none.
+		 */
+		void SetReflectionProbe(uint32_t Probe);
+
+		/** @return The reflection probe of this object plus 1, 0 by default. */
+		uint32_t GetReflectionProbe() const;
+
+		/**
+		 * Selects the point lights shading this object, sent to the vertex shader in the third component
+		 * of location 12. Usually assigned by ObjectLightAssigner::Assign().
+		 *
+		 * @param PackedLights Indices in LightData::PointLights plus 1, one byte each from the lowest; 0 ends the list.
+		 */
+		void SetPointLights(uint32_t PackedLights);
+
+		/** @return The packed point lights of this object, 0 (none) by default. */
+		uint32_t GetPointLights() const;
+
+		/**
+		 * Sets the instance payload of this object, sent to the vertex shader at location 15 as a vec4.
+		 * Per-object variations (tint, UV offset, animation phase...) no longer need their own material,
+		 * so the objects stay in one instanced batch.
+		 *
+		 * @param Payload The four values, their meaning is up to the shader.
+		 */
+		void SetInstancePayload(const glm::vec4& Payload);
+
+		/**
+		 * Sets the instance payload of this object from a struct declared by its shaders, e.g.
+		 *
+		 *     struct TintPayload { glm::u8vec4 Color; float Phase; glm::vec2 UVOffset; };
+		 *     // layout (location = 15) in vec4 Payload;
+		 *     // vec4 Color = unpackUnorm4x8(floatBitsToUint(Payload.x)); float Phase = Payload.y; vec2 UVOffset = Payload.zw;
+		 *
+		 * Integer members are read back with floatBitsToUint() / floatBitsToInt().
+		 *
+		 * @param Payload Up to 16 bytes of trivially copyable data, copied bit for bit.
+		 */
+		template<typename T>
+		void SetInstancePayload(const T& Payload)
+		{
+			static_assert(sizeof(T) <= sizeof(glm::vec4), "Instance payloads hold at most 16 bytes");
+			static_assert(std::is_trivially_copyable_v<T>, "Instance payloads are copied bit for bit");
+
+			glm::vec4 Packed(0.0f);
+			std::memcpy(&Packed, &Payload, sizeof(T));
+			SetInstancePayload(Packed);
+		}
+
+		/** @return The instance payload of this object, all 0 by default. */
+		const glm::vec4& GetInstancePayload() const;
+
+		/**
+		 * Sets the spin, sway and bob the vertex shaders apply to this object (see ProceduralAnimation), in
+		 * place of a Tick() moving its Transform: the object's instance data is written once, not every frame.
+		 * Its bounds grow to enclose every pose. Merged static objects don't move, an animated object isn't merged.
+		 *
+		 * @param Animation The animation, default-constructed to stop animating.
+		 */
+		void SetProceduralAnimation(const ProceduralAnimation& Animation);
+
+		/** @return The procedural animation of this object, none by default. */
+		const ProceduralAnimation& GetProceduralAnimation() const;
+
+		/** @return The procedural animation packed for the instance stream, see ProceduralAnimation::Pack(). */
+		const glm::uvec3& GetPackedAnimation() const;
+
+		/** @return A counter incremented whenever the object-space bounds change (procedural animation, meshes), which invalidates the cached ones. */
+		uint64_t GetBoundsRevision() const;
+
+		/**
+		 * Sets the pictures this object is drawn with once the active camera is farther than the atlas' distance,
+		 * a camera-facing quad of its bounding sphere's size replacing its meshes (see ImpostorAtlas).
+		 *
+		 * @param Impostor The atlas captured from this object's model, nullptr (the default) to always draw the meshes. Must outlive its use.
+		 */
+		void SetImpostor(ImpostorAtlas* Impostor);
+
+		/** @return The pictures this object is drawn with from afar, nullptr if none. */
+		ImpostorAtlas* GetImpostor() const;
+
+		/**
+		 * Retrieves the mesh identity of this object.
+		 * Used for batching objects together in the rendering pipeline for instanced rendering:
+		 * the renderer combines it with the ID of the object's material.
+		 *
+		 * @return Value equal for objects drawing the same meshes (see BaseMesh::GetMeshID()).
 		 */		
 		virtual size_t GetHash() const = 0;
 
@@ -137,15 +554,76 @@ namespace fgl
 		 * Retrieves all meshes associated with this object.
 		 * This method is called during initialization to ensure the renderer processes each mesh correctly.
 		 * Shapes return a single mesh, while models may return multiple meshes.
+		 * The span views the object's own storage: nothing is copied or allocated.
 		 *
-		 * @return Vector containing all meshes for the object.
+		 * @return Span over all meshes of the object, valid as long as the object.
+		 */
+		virtual std::span<BaseMesh> GetMeshes() = 0;
+
+		/** @return Read-only span over all meshes of the object, see GetMeshes(). */
+		virtual std::span<const BaseMesh> GetMeshes() const = 0;
+
+		/**
+		 * Retrieves the object-space bounding sphere enclosing every mesh of this object.
+		 * Computed from the mesh bounds on first use and cached, as mesh geometry doesn't change after construction.
+		 *
+		 * @return The object-space bounding sphere.
+		 */
+		const BoundingSphere& GetLocalBoundingSphere();
+
+		/**
+		 * Retrieves the object-space box enclosing every mesh of this object, cached with GetLocalBoundingSphere().
+		 *
+		 * @return The object-space bounding box, empty if the object has no mesh.
+		 */
+		const BoundingBox& GetLocalBoundingBox();
+
+		/**
+		 * Reads the meshes, material, hash and skybox flag of this object into its RenderProxy.
+		 * Called by the Scene when the object is added and by the renderer when its batch is assigned, which
+		 * InvalidateBatch() triggers again after a material change.
 		 */
-		virtual std::vector<BaseMesh>& GetMeshes() = 0;
+		void CaptureRenderProxy();
+
+		/** @return The render data captured by the last CaptureRenderProxy(). */
+		const RenderProxy& GetRenderProxy() const;
 
 	private:
+		/** Queues the object in its Scene's TickScheduler after a change of its tick settings. */
+		void RefreshTick();
+
 		/** Pointer to the Scene that owns this object */
 		Scene* m_OwningScene;
 
+		/** Index of this object in the owning Scene's object list */
+		uint32_t m_SceneIndex;
+
+		/** True while the object waits for its Scene to remove it */
+		bool m_PendingRemoval;
+
+		/** True if the object is merged by the next Scene::BuildStaticGeometry() */
+		bool m_Static;
+
+		/** True while the object's meshes are drawn by its Scene's StaticGeometry */
+		bool m_Merged;
+
+		/** Render layers of the object, one bit per layer */
+		LayerMask m_Layers;
+
+		/** Tick settings of the object, see SetTickGroup(), SetTickInterval() and Sleep() */
+		TickGroup m_TickGroup;
+		bool m_TickEnabled;
+		bool m_Sleeping;
+		uint32_t m_TickIntervalFrames;
+		float m_TickIntervalSeconds;
+
+		/** Slot of the object in its Scene's TickScheduler, and the group of that slot */
+		uint32_t m_TickSlot;
+		TickGroup m_TickSlotGroup;
+
+		/** Pool the object returns to when removed, nullptr to delete it */
+		ObjectPoolBase* m_ObjectPool;
+
 		/**
 		 * The Transform of this object, representing its position, rotation, and scale in the world.
 		 * Every SceneObject is initialized with a Transform to ensure proper spatial representation.
@@ -157,6 +635,58 @@ namespace fgl
 		 * Used internally by the renderer to handle initial rendering passes.
 		 */
 		bool m_New;
+
+		/** Slot of the object's matrices in the renderer's instance buffer, SIZE_MAX until first uploaded */
+		size_t m_InstanceSlot;
+
+		/** Transform revision the uploaded matrices were computed from */
+		uint64_t m_InstanceRevision;
+
+		/** Index of the object's batch in the renderer's batch cache, InvalidBatch until assigned */
+		uint32_t m_BatchIndex;
+
+		/** Cached object-space bounding sphere and box, valid once m_HasLocalBounds is set */
+		BoundingSphere m_LocalBoundingSphere;
+		BoundingBox m_LocalBoundingBox;
+		bool m_HasLocalBounds;
+
+		/** True if the object receives overlap events */
+		bool m_OverlapEvents;
+
+		/** Proxy of the object in its Scene's OverlapSystem */
+		uint32_t m_OverlapProxy;
+
+		/** Render data read by the renderer's per-frame loops */
+		RenderProxy m_RenderProxy;
+
+		/** Texture array layers written to the instance stream */
+		glm::uvec4 m_TextureLayers;
+
+		/** First bone of the object's palette written to the instance stream */
+		uint32_t m_BoneOffset;
+
+		/** Reflection probe plus 1 written to the instance stream */
+		uint32_t m_ReflectionProbe;
+
+		/** Packed point light indices written to the instance stream */
+		uint32_t m_PointLights;
+
+		/** Free-form data written to the instance stream */
+		glm::vec4 m_InstancePayload;
+
+		/** Spin, sway and bob evaluated by the vertex shaders, packed for the instance stream */
+		ProceduralAnimation m_ProceduralAnimation;
+		glm::uvec3 m_PackedAnimation;
+
+		/** Incremented whenever the object-space bounds change, see GetBoundsRevision() */
+		uint64_t m_BoundsRevision;
+
+		/** Changes recorded in the owning Scene's journal since it was last published, one bit per SceneChange, and the entry holding them */
+		uint8_t m_ChangeMask;
+		uint32_t m_ChangeSlot;
+
+		/** Pictures drawn in place of the meshes from afar, nullptr for none */
+		ImpostorAtlas* m_Impostor;
 	};
 
 } // namespace fgl
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <FireGL/fglpch.h>
+#include <FireGL/Core/FlatHashMap.h>
 
 #include <External/glad/glad.h>
 #include <External/glm/glm.hpp>
@@ -9,8 +10,19 @@
 namespace fgl 
 {
 
+	/**
+	 * Location of a uniform resolved once with Shader::GetUniform().
+	 * Only valid for the program it was resolved from; setting it costs no string hashing or allocation.
+	 */
+	struct UniformHandle
+	{
+		GLint Location = -1; ///< The uniform location, -1 if the program has no such active uniform.
+	};
+
 	/**
 	 * Manages an OpenGL shader program, including loading, compiling, and linking shaders.
+	 * The program and its GLSL stages are created, linked, bound and deleted through the RenderDevice;
+	 * uniforms, the ShaderCache binaries and SPIR-V modules still use OpenGL directly.
 	 */
 	class Shader
 	{
@@ -21,13 +33,50 @@ namespace fgl
 		 * @param VertexPath			Path to the vertex shader source file (relative to root, e.g., "src/somefile.vert").
 		 * @param FragmentPath			Path to the fragment shader source file (relative to root, e.g., "src/somefile.frag").
 		 * @throws std::runtime_error   if any shader file cannot be read or compiled.
+		 *
+		 * A program linked on a previous launch with the same sources and driver is loaded from the
+		 * ShaderCache instead of compiled; newly linked programs are added to it.
+		 *
+		 * With bDeferLinkCheck, the compile and link commands are only submitted: errors are checked the
+		 * first time the program is used (or on WaitUntilReady()), so many shaders can be created up front
+		 * and compiled by the driver while assets load. Combine with IsReady() to avoid blocking.
+		 *
+		 * @param bDeferLinkCheck		Whether to defer the compile and link status queries.
+		 */
+		Shader(std::string_view VertexPath, std::string_view FragmentPath, bool bDeferLinkCheck = false);
+
+		/** Deletes the OpenGL program, see Cleanup(). */
+		~Shader();
+
+		// Materials point to their Shader, programs move between shaders with ReplaceProgram()
+		Shader(const Shader&) = delete;
+		Shader& operator=(const Shader&) = delete;
+
+		/**
+		 * Checks whether the driver finished compiling and linking the program.
+		 * Only meaningful with GLExtensions::HasParallelShaderCompile(); without it, the first use of the
+		 * program simply blocks until the driver is done and this always returns true.
+		 *
+		 * @return True if using the program won't block on the driver compiler.
+		 */
+		bool IsReady() const;
+
+		/** Waits for the program to be linked and reports its compile and link errors, if still pending. */
+		void WaitUntilReady() const;
+
+		/**
+		 * Checks whether every shader of a batch created with bDeferLinkCheck is ready (see IsReady()).
+		 *
+		 * @param Shaders The shaders to poll.
+		 * @return True once none of them would block.
 		 */
-		Shader(std::string_view VertexPath, std::string_view FragmentPath);
+		static bool AreReady(const std::vector<const Shader*>& Shaders);
 
 		/**
 		 * Sets a uniform variable in the shader program.
 		 *
 		 * These functions individually handle different types of uniforms (bool, int, float, vec3) because OpenGL's C-based API does not support templates. Each type-specific function ensures the correct uniform type is set.
+		 * Every call looks the name up in the location cache; code setting uniforms on every draw should resolve them once with GetUniform().
 		 *
 		 * @param Name   The name of the uniform variable in the shader.
 		 * @param Value  The value to assign to the uniform variable.
@@ -47,13 +96,191 @@ namespace fgl
 		void SetMat3(std::string_view Name, const glm::mat3& Value) const;
 		void SetMat4(std::string_view Name, const glm::mat4& Value) const;
 
+		/**
+		 * Resolves the location of a uniform, to set it later without any name lookup.
+		 * The handle of a uniform the program doesn't use is still valid, setting it does nothing.
+		 *
+		 * @param Name   The name of the uniform variable in the shader.
+		 * @return       The handle of the uniform in this program.
+		 */
+		UniformHandle GetUniform(std::string_view Name) const;
+
+		/**
+		 * Sets a uniform variable through a handle returned by GetUniform().
+		 *
+		 * @param Uniform  The handle of the uniform in this program.
+		 * @param Value    The value to assign to the uniform variable.
+		 */
+		void SetBool(UniformHandle Uniform, bool Value) const;
+		void SetInt(UniformHandle Uniform, int Value) const;
+		void SetUInt(UniformHandle Uniform, unsigned int Value) const;
+		void SetFloat(UniformHandle Uniform, float Value) const;
+		void SetDouble(UniformHandle Uniform, double Value) const;
+		void SetVec2(UniformHandle Uniform, const glm::vec2& Value) const;
+		void SetVec3(UniformHandle Uniform, const glm::vec3& Value) const;
+		void SetVec4(UniformHandle Uniform, const glm::vec4& Value) const;
+		void SetMat2(UniformHandle Uniform, const glm::mat2& Value) const;
+		void SetMat3(UniformHandle Uniform, const glm::mat3& Value) const;
+		void SetMat4(UniformHandle Uniform, const glm::mat4& Value) const;
+
+		/**
+		 * Assigns a uniform block of the program to a uniform buffer binding point.
+		 * Does nothing if the program has no block with that name. The blocks registered with
+		 * SetDefaultBlockBinding() are assigned automatically after linking.
+		 *
+		 * @param BlockName    The name of the uniform block in the shader.
+		 * @param BindingPoint The uniform buffer binding point to read the block from.
+		 */
+		void BindUniformBlock(std::string_view BlockName, GLuint BindingPoint) const;
+
+		/**
+		 * Registers a uniform block every program linked afterwards gets assigned to a binding point.
+		 * GLSL 4.10 has no binding qualifier for blocks, this stands in for it. "CameraData" (see CameraUniformBuffer),
+		 * "LightData" (see LightUniformBuffer), "MaterialParameters" (see Material::SetParameters) and "ShadowData" (see CascadedShadowMaps)
+		 * are registered by default.
+		 *
+		 * @param BlockName    The name of the uniform block in the shaders.
+		 * @param BindingPoint The uniform buffer binding point to read the block from.
+		 */
+		static void SetDefaultBlockBinding(std::string_view BlockName, GLuint BindingPoint);
+
+		/**
+		 * Registers a sampler every program linked afterwards gets assigned to a texture unit, for textures the
+		 * renderer binds once per frame. GLSL 4.10 has no binding qualifier for samplers either. "ShadowMap"
+		 * (see CascadedShadowMaps) is registered by default.
+		 *
+		 * @param SamplerName The name of the sampler uniform in the shaders.
+		 * @param Unit        The texture unit the sampler reads from.
+		 */
+		static void SetDefaultSamplerUnit(std::string_view SamplerName, GLint Unit);
+
 		/** Activates the shader program for use in rendering */
 		void Activate() const;
 
 		/** Retrieves the ID of the shader program */
-		inline uint32_t GetID() const;
+		uint32_t GetID() const;
+
+		/** @return The path of the vertex shader source, empty for shaders created from source or SPIR-V. */
+		const std::string& GetVertexPath() const;
+
+		/** @return The path of the fragment shader source, empty for shaders created from source or SPIR-V. */
+		const std::string& GetFragmentPath() const;
+
+		/**
+		 * Creates a shader from GLSL sources already in memory (see the file constructor for bDeferLinkCheck).
+		 *
+		 * @param VertexCode       The vertex shader source.
+		 * @param FragmentCode     The fragment shader source.
+		 * @param bDeferLinkCheck  Whether to defer the compile and link status queries.
+		 * @return The new shader.
+		 */
+		static std::unique_ptr<Shader> CreateFromSource(std::string_view VertexCode, std::string_view FragmentCode, bool bDeferLinkCheck = false);
+
+		/**
+		 * Creates a compute program from a GLSL source already in memory. Requires OpenGL 4.3;
+		 * dispatch it with glDispatchCompute() after Activate().
+		 *
+		 * @param ComputeCode      The compute shader source.
+		 * @param bDeferLinkCheck  Whether to defer the compile and link status queries.
+		 * @return The new shader.
+		 */
+		static std::unique_ptr<Shader> CreateComputeFromSource(std::string_view ComputeCode, bool bDeferLinkCheck = false);
+
+		/**
+		 * Creates a shader with a geometry stage from GLSL sources already in memory.
+		 *
+		 * @param VertexCode       The vertex shader source.
+		 * @param GeometryCode     The geometry shader source.
+		 * @param FragmentCode     The fragment shader source.
+		 * @param bDeferLinkCheck  Whether to defer the compile and link status queries.
+		 * @return The new shader.
+		 */
+		static std::unique_ptr<Shader> CreateWithGeometryFromSource(std::string_view VertexCode, std::string_view GeometryCode,
+			std::string_view FragmentCode, bool bDeferLinkCheck = false);
+
+		/**
+		 * Creates a shader with tessellation stages from GLSL sources already in memory. Requires OpenGL 4.0;
+		 * draw GL_PATCHES with it.
+		 *
+		 * @param VertexCode         The vertex shader source.
+		 * @param TessControlCode    The tessellation control shader source.
+		 * @param TessEvaluationCode The tessellation evaluation shader source.
+		 * @param FragmentCode       The fragment shader source.
+		 * @param bDeferLinkCheck    Whether to defer the compile and link status queries.
+		 * @return The new shader.
+		 */
+		static std::unique_ptr<Shader> CreateWithTessellationFromSource(std::string_view VertexCode, std::string_view TessControlCode,
+			std::string_view TessEvaluationCode, std::string_view FragmentCode, bool bDeferLinkCheck = false);
+
+		/**
+		 * Creates a transform feedback program, without a fragment stage, from GLSL sources already in memory.
+		 * The outputs named in Varyings are captured interleaved into the buffer bound to GL_TRANSFORM_FEEDBACK_BUFFER
+		 * index 0; draw with GL_RASTERIZER_DISCARD enabled.
+		 *
+		 * @param VertexCode       The vertex shader source.
+		 * @param GeometryCode     The geometry shader source, empty for no geometry stage.
+		 * @param Varyings         The outputs of the last stage to capture, in buffer order.
+		 * @param bDeferLinkCheck  Whether to defer the compile and link status queries.
+		 * @return The new shader.
+		 */
+		static std::unique_ptr<Shader> CreateTransformFeedbackFromSource(std::string_view VertexCode, std::string_view GeometryCode,
+			const std::vector<std::string>& Varyings, bool bDeferLinkCheck = false);
+
+		/**
+		 * Creates a shader from SPIR-V modules compiled offline (see fgl_compile_spirv() in CMakeLists.txt), so the
+		 * driver's GLSL front-end is skipped and the sources were validated at build time. Modules are read from
+		 * the mounted archives first, like sources, and the linked program is stored in the ShaderCache.
+		 *
+		 * Names aren't guaranteed to survive in SPIR-V: the GLSL it is compiled from should give every uniform an
+		 * explicit location and every block and sampler a binding, name lookups such as SetInt() and the default
+		 * bindings may find nothing.
+		 *
+		 * @param VertexPath       Path to the vertex module, e.g. "Shaders/Lit.vert.spv".
+		 * @param FragmentPath     Path to the fragment module.
+		 * @param Constants        Specialization constants as {constant ID, value} pairs, applied to both stages.
+		 * @param EntryPoint       The entry point of both modules.
+		 * @param bDeferLinkCheck  Whether to defer the compile and link status queries.
+		 * @return The new shader, nullptr if the context can't take SPIR-V (see SupportsSPIRV()) so callers fall back to GLSL.
+		 * @throws std::runtime_error if a module cannot be read or isn't SPIR-V.
+		 */
+		static std::unique_ptr<Shader> CreateFromSPIRV(std::string_view VertexPath, std::string_view FragmentPath,
+			const std::vector<std::pair<GLuint, GLuint>>& Constants = {}, std::string_view EntryPoint = "main", bool bDeferLinkCheck = false);
+
+		/** @return True if the context takes SPIR-V modules: OpenGL 4.6 or GL_ARB_gl_spirv. */
+		static bool SupportsSPIRV();
+
+		/**
+		 * Waits for the program to be linked, see WaitUntilReady().
+		 *
+		 * @return True if the program linked successfully.
+		 */
+		bool IsLinked() const;
+
+		/**
+		 * Takes over the program of another shader, deleting this shader's own program.
+		 * Used to hot-reload a shader: materials keep pointing to this Shader, and draw with the new program
+		 * from their next activation. Cached uniform locations are reset, so UniformHandles resolved from
+		 * the previous program must be resolved again.
+		 *
+		 * @param Source A linked shader, left without a program.
+		 */
+		void ReplaceProgram(Shader& Source);
+
+		/** Deletes the OpenGL program ahead of the destructor. Safe to call more than once. */
+		void Cleanup();
+
+		/**
+		 * Loads shader code from a file.
+		 *
+		 * @param ShaderPath			Path to the shader source file.
+		 * @throws std::runtime_error   if the file cannot be read.
+		 */
+		static std::string LoadShaderCode(std::string_view ShaderPath);
 
 	private:
+		/** Constructs a shader without a program, see CreateFromSource(). */
+		Shader() = default;
+
 		/**
 		 * Retrieves the location of a uniform variable in the shader program.
 		 *
@@ -64,21 +291,51 @@ namespace fgl
 		 */		
 		GLint GetUniformLocation(std::string_view Name) const;
 
-		/** Loads shader code from a file. */
-		std::string LoadShaderCode(std::string_view ShaderPath) const;
 
-		/** Compiles and links vertex and fragment shaders into a program. */
-		void CompileAndLinkShaders(const char* VertexCode, const char* FragmentCode);
+		/** Loads the program from the ShaderCache, or compiles and links vertex, fragment and optional geometry and tessellation shaders into it. */
+		void CompileAndLinkShaders(const char* VertexCode, const char* FragmentCode, const char* GeometryCode = nullptr,
+			const char* TessControlCode = nullptr, const char* TessEvaluationCode = nullptr);
+
+		/** Loads the program from the ShaderCache, or compiles and links a compute shader into it. */
+		void CompileAndLinkCompute(const char* ComputeCode);
 
-		/** Compiles a single shader (vertex or fragment). */
-		uint32_t CompileShader(const char* ShaderCode, GLenum ShaderType);
+		/** Loads the program from the ShaderCache, or compiles and links a vertex and optional geometry shader capturing Varyings. */
+		void CompileAndLinkTransformFeedback(const char* VertexCode, const char* GeometryCode, const std::vector<std::string>& Varyings);
+
+		/** Loads the program from the ShaderCache, or specializes and links a vertex and a fragment SPIR-V module into it. */
+		void SpecializeAndLink(const std::string& VertexModule, const std::string& FragmentModule,
+			const std::vector<std::pair<GLuint, GLuint>>& Constants, const std::string& EntryPoint);
+
+		/** Loads and specializes a single SPIR-V module. The status isn't queried here, see FinishLink(). */
+		uint32_t SpecializeShader(const std::string& Module, GLenum ShaderType, const std::vector<GLuint>& ConstantIndices,
+			const std::vector<GLuint>& ConstantValues, const std::string& EntryPoint);
+
+		/**
+		 * Reports the compile and link errors of a freshly linked program, stores it in the ShaderCache and
+		 * releases its shader objects. Does nothing once done, so every use of the program can call it.
+		 */
+		void FinishLink() const;
 
 		/** Checks for compilation or linking errors in the shader. */
-		void CheckCompileErrors(unsigned int Shader, std::string_view Type);
+		static void CheckCompileErrors(unsigned int Shader, std::string_view Type);
+
+		/** Assigns every block registered with SetDefaultBlockBinding() to its binding point. */
+		void ApplyDefaultBlockBindings() const;
+
+		/** Assigns every sampler registered with SetDefaultSamplerUnit() to its texture unit. */
+		void ApplyDefaultSamplerUnits() const;
 
 	private:
 		/** OpenGL Program ID */
-		uint32_t m_ID;
+		uint32_t m_ID = 0;
+
+		std::string m_VertexPath;   ///< Path of the vertex shader source, if loaded from a file.
+		std::string m_FragmentPath; ///< Path of the fragment shader source, if loaded from a file.
+
+		mutable bool m_bLinkPending = false;       ///< Whether FinishLink() still has to run.
+		mutable uint32_t m_PendingShaders[5] = {}; ///< Vertex, fragment, geometry and tessellation (or only compute) shader objects, until FinishLink().
+		bool m_bCompute = false;                   ///< Whether the program is a compute program.
+		uint64_t m_CacheKey = 0;                   ///< ShaderCache key of the program sources.
 
 		/** 
 		 * Cached Uniform Location map for optimization.
@@ -86,8 +343,15 @@ namespace fgl
 		 * This cache stores uniform locations for each uniform by name.
 		 * Storing these locations avoids the need to repeatedly call glGetUniformLocation during the application lifetime, which can be slow.
 		 * Using a cache improves performance, particularly in real-time rendering where uniforms are set frequently.
+		 * Flat and searched by std::string_view, a lookup neither builds a string nor follows a node.
 		 */
-		mutable std::unordered_map<std::string, GLint> m_UniformLocationCache;
+		mutable FlatHashMap<std::string, GLint> m_UniformLocationCache;
+
+		/** Uniform blocks assigned to a binding point after linking, by block name. */
+		static std::vector<std::pair<std::string, GLuint>> s_DefaultBlockBindings;
+
+		/** Samplers assigned to a texture unit after linking, by sampler name. */
+		static std::vector<std::pair<std::string, GLint>> s_DefaultSamplerUnits;
 	};
 
 } // namespace fgl
\ No newline at end of file
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+
+#include <External/glad/glad.h>
+
+namespace fgl
+{
+
+	/**
+	 * On-disk cache of linked program binaries, letting later launches skip the driver's GLSL compiler.
+	 *
+	 * Programs are keyed by a hash of their sources together with the vendor, renderer and version strings
+	 * of the context: a driver update or another GPU produces new keys, and their stale binaries are simply
+	 * never read again. A binary the driver rejects makes Load() fail, and the caller compiles from source.
+	 *
+	 * Layout (native endianness): a header {Magic, Version, Key, BinaryFormat, BinarySize} followed by the
+	 * bytes returned by glGetProgramBinary. Must be used on the thread owning the OpenGL context.
+	 */
+	class ShaderCache
+	{
+	public:
+		static constexpr uint32_t Magic = 0x50474746;         ///< "FGGP", identifies a FireGL program binary.
+		static constexpr uint32_t Version = 1;                ///< Bumped whenever the layout changes.
+		static constexpr const char* Extension = ".fglprog"; ///< Extension of the cache files.
+
+		/**
+		 * Computes the cache key of a program.
+		 *
+		 * @param Sources The source of every stage of the program, in attachment order.
+		 * @return A hash of the sources and of the driver strings of the current context.
+		 */
+		static uint64_t GetKey(const std::vector<std::string_view>& Sources);
+
+		/**
+		 * Loads a cached binary into a program object.
+		 *
+		 * @param Key The key returned by GetKey().
+		 * @param Program A program object with no shaders attached.
+		 * @return True if the binary was found and the program is linked.
+		 */
+		static bool Load(uint64_t Key, GLuint Program);
+
+		/**
+		 * Writes the binary of a linked program to the cache.
+		 * The program should be linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT set.
+		 *
+		 * @param Key The key returned by GetKey().
+		 * @param Program The linked program.
+		 * @return True if the file was written.
+		 */
+		static bool Save(uint64_t Key, GLuint Program);
+
+		/**
+		 * Sets where the cache files are stored.
+		 *
+		 * @param Directory The cache directory, relative to the working directory or absolute.
+		 */
+		static void SetDirectory(std::string_view Directory);
+
+		/** Enables or disables the cache, enabled by default when the driver exposes a binary format. */
+		static void SetEnabled(bool bEnabled);
+
+		/** @return True if the cache is enabled and the driver supports at least one program binary format. */
+		static bool IsEnabled();
+
+	private:
+		/** Fixed-size start of a cache file. */
+		struct Header
+		{
+			uint32_t Magic;
+			uint32_t Version;
+			uint64_t Key;
+			uint32_t BinaryFormat;
+			uint32_t BinarySize;
+		};
+
+		/** @return The path of the cache file of a key. */
+		static std::string GetCachePath(uint64_t Key);
+
+		static std::string s_Directory; ///< Directory holding the cache files.
+		static bool s_bEnabled;         ///< Whether programs are read from and written to the cache.
+	};
+
+} // namespace fgl
\ No newline at end of file
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+
+namespace fgl
+{
+	class Shader;
+
+	/**
+	 * Recompiles shaders whose source files change on disk, without restarting the application.
+	 *
+	 * A background thread polls the modification time of every watched source file and reads the new
+	 * sources, so file access never happens on the render thread. Update(), called once per frame on the
+	 * thread owning the OpenGL context, submits the changed programs with a deferred link check (compiled
+	 * in parallel by the driver when GL_KHR_parallel_shader_compile is available, or restored from the
+	 * ShaderCache) and swaps each one into its Shader once the driver is done. A program that fails to
+	 * compile keeps the previous one, its errors are logged.
+	 */
+	class ShaderHotReloader
+	{
+	public:
+		/**
+		 * Starts the watcher thread.
+		 *
+		 * @param PollInterval Time between two checks of the watched files.
+		 */
+		ShaderHotReloader(std::chrono::milliseconds PollInterval = std::chrono::milliseconds(250));
+
+		/** Stops the watcher thread and discards the programs still compiling. */
+		~ShaderHotReloader();
+
+		ShaderHotReloader(const ShaderHotReloader&) = delete;
+		ShaderHotReloader& operator=(const ShaderHotReloader&) = delete;
+
+		/**
+		 * Starts watching the source files of a shader loaded from files.
+		 *
+		 * @param Target The shader to reload, which must outlive the watch (see Unwatch()).
+		 */
+		void Watch(Shader& Target);
+
+		/** Stops watching a shader. */
+		void Unwatch(Shader& Target);
+
+		/** Swaps in the programs that finished compiling and submits the ones whose sources changed. */
+		void Update();
+
+	private:
+		/** A watched shader and the state of its reload. */
+		struct WatchedShader
+		{
+			Shader* Target = nullptr;
+			std::filesystem::file_time_type WriteTimes[2];  ///< Last seen modification times of the vertex and fragment sources.
+			bool bSourcesChanged = false;                   ///< Whether Sources holds code Update() hasn't submitted yet.
+			std::string Sources[2];                         ///< Vertex and fragment sources read by the watcher thread.
+			std::unique_ptr<Shader> Replacement;            ///< Program being compiled, swapped in when linked.
+		};
+
+		/** Body of the watcher thread. */
+		void WatchFiles();
+
+		/** @return The modification time of a file, or the minimum time if it can't be read. */
+		static std::filesystem::file_time_type GetWriteTime(const std::string& Path);
+
+		std::vector<std::unique_ptr<WatchedShader>> m_Shaders; ///< Watched shaders, at stable addresses.
+		std::mutex m_Mutex;                                    ///< Guards m_Shaders and the state they hold.
+		std::condition_variable m_StopSignal;                  ///< Wakes the watcher thread up to stop.
+		bool m_bStop = false;                                  ///< Whether the watcher thread must exit.
+		std::chrono::milliseconds m_PollInterval;              ///< Time between two polls.
+		std::thread m_Watcher;                                 ///< Thread polling the source files.
+	};
+
+} // namespace fgl
\ No newline at end of file
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+
+namespace fgl
+{
+	class Shader;
+
+	/**
+	 * Permutations of one vertex / fragment shader pair, selected by a feature bitmask.
+	 *
+	 * Each feature is a preprocessor symbol: bit i of a mask defines Features[i] (as "#define Name 1", right
+	 * after the #version line) in both stages. A variant is compiled the first time its mask is requested,
+	 * with a deferred link check so requesting several variants up front lets the driver compile them in
+	 * parallel, and kept until the ShaderVariants is destroyed. Variants also go through the ShaderCache, the
+	 * defines being part of the hashed sources.
+	 *
+	 * Materials pick their variant with Material::SetShaderVariant(), so objects that don't need a feature
+	 * get a cheaper program instead of paying for the full shader on every fragment.
+	 */
+	class ShaderVariants
+	{
+	public:
+		static constexpr size_t MaxFeatures = 32; ///< Features a mask can hold.
+
+		/**
+		 * Reads the sources; no program is compiled until Get() is called.
+		 *
+		 * @param VertexPath    Path to the vertex shader source file.
+		 * @param FragmentPath  Path to the fragment shader source file.
+		 * @param Features      The preprocessor symbol of each mask bit, at most MaxFeatures.
+		 * @throws std::runtime_error if any shader file cannot be read.
+		 */
+		ShaderVariants(std::string_view VertexPath, std::string_view FragmentPath, std::vector<std::string> Features);
+
+		/** Deletes the program of every variant. */
+		~ShaderVariants();
+
+		ShaderVariants(const ShaderVariants&) = delete;
+		ShaderVariants& operator=(const ShaderVariants&) = delete;
+
+		/**
+		 * Returns the variant of a feature mask, compiling it on first request.
+		 *
+		 * @param FeatureMask Bit i defines the feature at index i. Bits without a feature are ignored.
+		 * @return The variant's shader, owned by this object.
+		 */
+		Shader* Get(uint32_t FeatureMask);
+
+		/**
+		 * Looks a feature up by name.
+		 *
+		 * @param Feature The preprocessor symbol given to the constructor.
+		 * @return The mask bit of the feature, 0 if it isn't one of the features.
+		 */
+		uint32_t GetFeatureBit(std::string_view Feature) const;
+
+		/** @return The number of variants compiled so far. */
+		size_t GetVariantCount() const;
+
+	private:
+		/** @return The source with the given defines inserted after its #version line. */
+		static std::string InsertDefines(const std::string& Source, const std::string& Defines);
+
+		std::string m_VertexCode;                                        ///< Vertex source without defines.
+		std::string m_FragmentCode;                                      ///< Fragment source without defines.
+		std::vector<std::string> m_Features;                             ///< Preprocessor symbol of each mask bit.
+		std::unordered_map<uint32_t, std::unique_ptr<Shader>> m_Variants; ///< Compiled variants by feature mask.
+	};
+
+} // namespace fgl
\ No newline at end of file
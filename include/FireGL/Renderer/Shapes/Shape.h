@@ -35,6 +35,15 @@ namespace fgl
          * @param Indices   A vector containing the indices for the shape's mesh.
          */
         Shape(std::vector<Vertex>&& Vertices, std::vector<unsigned int>&& Indices);
+
+        /**
+         * Constructs a Shape drawing a copy of cached geometry, see AcquireGeometry().
+         * The copy keeps the content hash and bounds of the geometry, so nothing is hashed or measured again,
+         * and the renderer uploads it once for every shape of the same geometry.
+         *
+         * @param Geometry The geometry of the shape, without material.
+         */
+        explicit Shape(const BaseMesh& Geometry);
         
         /** Virtual destructor to allow proper cleanup of derived classes. */
         virtual ~Shape() = default;
@@ -57,14 +66,17 @@ namespace fgl
         /**
          * @brief Provides access to the meshes that make up the shape.
          *
-         * @return A reference to a vector of BaseMesh objects.
+         * @return A span over the shape's single mesh.
          */
-        virtual std::vector<BaseMesh>& GetMeshes() override;
+        virtual std::span<BaseMesh> GetMeshes() override;
+
+        /** @return A read-only span over the shape's single mesh. */
+        virtual std::span<const BaseMesh> GetMeshes() const override;
 
         /**
-         * @brief Retrieves the hash representing the shape.
+         * @brief Retrieves the mesh identity of the shape.
          *
-         * @return The unique hash of the shape, generated during initialization.
+         * @return The mesh ID of the shape, shared by every shape built from the same geometry.
          */
         virtual size_t GetHash() const override;
 
@@ -73,7 +85,19 @@ namespace fgl
          * This function overrides the `Render` method from the SceneObject base class and is
          * responsible for rendering the shape using its mesh and material.
          */
-        virtual void Render(size_t NumberInstance) const override;
+        virtual void Render(size_t NumberInstance, size_t BaseInstance = 0, uint32_t LOD = 0) const override;
+
+    protected:
+        /**
+         * Gets the geometry generated for a key, generating it on first use.
+         * Entries are kept for the lifetime of the process: shapes are few distinct geometries created many times.
+         * Thread-safe, shapes may be created on worker threads.
+         *
+         * @param Key Identity of the shape and its parameters, e.g. a hash of a Sphere's radius, stacks and slices.
+         * @param Generate Builds the geometry, called once per key.
+         * @return The cached geometry.
+         */
+        static const BaseMesh& AcquireGeometry(uint64_t Key, const std::function<BaseMesh()>& Generate);
 
     private:
         /**
@@ -84,6 +108,12 @@ namespace fgl
         virtual void BeginPlay() override final;
         virtual void Destroy() override final;
 
+        /** Tick() is empty, so shapes can always be ticked in parallel. */
+        virtual bool IsTickThreadSafe() const override final;
+
+        /** Tick() is empty, so shapes are never registered with the TickScheduler. */
+        virtual bool WantsTick() const override final;
+
     private:
         /**
          * @brief A single mesh representing the shape.
@@ -13,18 +13,35 @@ namespace fgl
 	 * of horizontal segments (latitude), and 'Slices' determine the number of vertical segments (longitude).
 	 * This allows for adjustable levels of detail for rendering or collision purposes.
 	 *
-	 * @param Radius  The radius of the sphere. Defaults to 1.0f.
-	 * @param Stacks  The number of horizontal segments (latitude). Defaults to 36.
-	 * @param Slices  The number of vertical segments (longitude). Defaults to 18.
+	 * Lower levels of detail halve the stacks and slices of the previous one. They pick their rows and columns
+	 * among the vertices of the full sphere, so every level is an index list over the same vertices.
+	 *
+	 * The geometry is generated once per set of parameters and shared by every sphere built with them.
+	 *
+	 * @param Radius   The radius of the sphere. Defaults to 1.0f.
+	 * @param Stacks   The number of horizontal segments (latitude). Defaults to 36.
+	 * @param Slices   The number of vertical segments (longitude). Defaults to 18.
+	 * @param LODCount The number of levels of detail, the full sphere included. Defaults to 3.
 	 */
 	class Sphere : public Shape
 	{
 	public:
-		Sphere(float Radius = 1.f, int Stacks = 36, int Slices = 18);
+		Sphere(float Radius = 1.f, int Stacks = 36, int Slices = 18, int LODCount = 3);
 
 	private:
-		std::vector<Vertex> GenerateVertices(float Radius, int Stacks, int Slices);
-		std::vector<unsigned int> GenerateIndices(int Stacks, int Slices);
+		/** @return The geometry of a sphere with its levels of detail, for the geometry cache. */
+		static BaseMesh GenerateMesh(float Radius, int Stacks, int Slices, int LODCount);
+
+		static std::vector<Vertex> GenerateVertices(float Radius, int Stacks, int Slices);
+
+		/**
+		 * Builds the triangles of a sphere of LODStacks by LODSlices segments over the vertex grid of a
+		 * Stacks by Slices sphere, each segment spanning the grid rows and columns closest to it.
+		 */
+		static std::vector<unsigned int> GenerateIndices(int Stacks, int Slices, int LODStacks, int LODSlices);
+
+		/** Adds the lower levels of detail of the sphere to its mesh. */
+		static void GenerateLODs(BaseMesh& Mesh, int Stacks, int Slices, int LODCount);
 	};
 
 } // namespace fgl
\ No newline at end of file
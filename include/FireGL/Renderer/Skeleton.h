@@ -0,0 +1,100 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+
+#include <FireGL/Renderer/AnimationClip.h>
+
+#include <External/glm/mat4x4.hpp>
+
+struct aiScene;
+
+namespace fgl
+{
+
+	/** One node of a Skeleton's hierarchy, animated or not. */
+	struct SkeletonNode
+	{
+		std::string Name;                           ///< Name of the node in the imported scene, matched by animation channels.
+		int32_t Parent = -1;                        ///< Index of the parent node, -1 for the root.
+		glm::mat4 LocalTransform = glm::mat4(1.0f); ///< Rest transform relative to the parent.
+	};
+
+	/** A node deforming vertices, indexed by VertexSkin::BoneIndices. */
+	struct SkeletonBone
+	{
+		uint32_t Node = 0;                  ///< Node the bone follows.
+		glm::mat4 Offset = glm::mat4(1.0f); ///< Mesh space to bone space in the bind pose (inverse bind matrix).
+	};
+
+	/**
+	 * Bone hierarchy of a skinned model, imported with Assimp.
+	 *
+	 * Every node of the scene is kept, parents before their children, so a pose is evaluated in one pass
+	 * over the nodes. The bones are the nodes referenced by the meshes' aiBone records, in first-seen order:
+	 * their indices are the ones stored in the vertices, shared by every mesh of the model so one palette
+	 * skins them all. AnimationClip::Sample() fills a SkeletonPose, ComputePalette() turns it into the
+	 * skinning matrices written to a BonePaletteBuffer.
+	 */
+	class Skeleton
+	{
+	public:
+		/**
+		 * Reads the node hierarchy and the bones of every mesh of an imported scene.
+		 *
+		 * @param Scene The scene read by Assimp.
+		 * @return The skeleton, nullptr if no mesh has bones.
+		 */
+		static std::shared_ptr<Skeleton> Import(const aiScene* Scene);
+
+		/**
+		 * @param Name The name of a node in the imported scene.
+		 * @return The index of the node, -1 if the skeleton has none of that name.
+		 */
+		int32_t FindNode(std::string_view Name) const;
+
+		/**
+		 * @param Name The name of a bone in the imported scene.
+		 * @return The index of the bone, -1 if the skeleton has none of that name.
+		 */
+		int32_t FindBone(std::string_view Name) const;
+
+		/** @return The nodes, parents before their children. */
+		const std::vector<SkeletonNode>& GetNodes() const;
+
+		/** @return The bones, in vertex index order. */
+		const std::vector<SkeletonBone>& GetBones() const;
+
+		/** @return The number of bones, the size of a palette. */
+		uint32_t GetBoneCount() const;
+
+		/** @return The rest pose, the local transform of every node in the imported scene. */
+		const SkeletonPose& GetRestPose() const;
+
+		/**
+		 * Computes the skinning matrices of a pose.
+		 *
+		 * @param Transforms The local transform of every node (see SkeletonPose::GetTransforms()), replaced by
+		 *                   the node to model transforms: parents are visited first, so no copy is needed.
+		 * @param Palette Receives one matrix per bone, from the mesh space of the bind pose to the model space of the pose.
+		 */
+		void ComputePalette(std::vector<glm::mat4>& Transforms, std::vector<glm::mat4>& Palette) const;
+
+		/**
+		 * Computes the skinning matrices of a pose.
+		 *
+		 * @param Pose The local transforms of the nodes (see AnimationClip::Sample()).
+		 * @param Transforms Scratch storage, receives the node to model transforms.
+		 * @param Palette Receives one matrix per bone, from the mesh space of the bind pose to the model space of the pose.
+		 */
+		void ComputePalette(const SkeletonPose& Pose, std::vector<glm::mat4>& Transforms, std::vector<glm::mat4>& Palette) const;
+
+	private:
+		std::vector<SkeletonNode> m_Nodes;                       ///< Hierarchy, parents before children.
+		std::vector<SkeletonBone> m_Bones;                       ///< Nodes deforming vertices.
+		std::unordered_map<std::string, uint32_t> m_NodeIndices; ///< Index of each node by name.
+		std::unordered_map<std::string, uint32_t> m_BoneIndices; ///< Index of each bone by name.
+		glm::mat4 m_GlobalInverse = glm::mat4(1.0f);             ///< Inverse of the root transform, brings the palette back to model space.
+		SkeletonPose m_RestPose;                                 ///< Local transforms of the nodes in the imported scene.
+	};
+
+} // namespace fgl
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+#include <FireGL/Renderer/Shader.h>
+#include <FireGL/Renderer/RenderDevice.h>
+
+#include <External/glm/vec2.hpp>
+#include <External/glm/vec4.hpp>
+#include <External/glad/glad.h>
+
+namespace fgl
+{
+	class BaseCamera;
+
+	/**
+	 * A monospace bitmap font: the glyphs of consecutive characters in a grid of equal cells of one texture,
+	 * row by row from the top left, e.g. the 16 x 16 grid of the 256 codes of code page 437.
+	 */
+	struct SpriteFont
+	{
+		GLuint Atlas = 0;                ///< The 2D texture of the grid, white glyphs on a transparent background.
+		uint32_t Columns = 16;           ///< Cells per row of the grid.
+		uint32_t Rows = 16;              ///< Rows of cells.
+		uint32_t FirstCharacter = 0;     ///< Character of the top left cell.
+		float CellAspect = 0.5f;         ///< Width over height of a cell, on screen.
+		float Spacing = 1.0f;            ///< Advance between two characters, in cell widths.
+	};
+
+	/**
+	 * Batched 2D overlay: HUDs, debug text and statistics drawn over the final image.
+	 *
+	 * Draw calls only append a quad to a list, from the thread preparing the frame; no scene object is created.
+	 * The Renderer latches the list with the frame (see Renderer::SetOverlay()) and draws it after the
+	 * post-processing: the quads are sorted by layer then texture, keeping the order of the calls within a
+	 * texture, written straight into a mapped dynamic vertex buffer and drawn with one indexed draw per run of
+	 * quads sharing a texture. Text from a single font atlas is therefore one draw whatever its length, and a
+	 * few thousand glyphs cost one map of the buffer.
+	 *
+	 * Coordinates are in pixels of the output, from the top left corner, projected by an orthographic camera
+	 * (BaseCamera::SetOrthographic()) sized to the viewport every frame. Quads are alpha blended, without depth.
+	 * Sorting by texture reorders overlapping quads of different textures: put what must stay behind, e.g. the
+	 * panel behind a text, on a lower layer.
+	 */
+	class SpriteBatch
+	{
+	public:
+		SpriteBatch();
+
+		/** Deletes the buffers, the texture and the shader. */
+		~SpriteBatch();
+
+		SpriteBatch(const SpriteBatch&) = delete;
+		SpriteBatch& operator=(const SpriteBatch&) = delete;
+
+		/**
+		 * Sets the layer of the next quads, drawn over the lower ones whatever their textures.
+		 *
+		 * @param Layer The layer, 0 by default.
+		 */
+		void SetLayer(int Layer);
+
+		/**
+		 * Records a textured quad.
+		 *
+		 * @param Texture The 2D texture of the sprite, 0 for a plain color.
+		 * @param Position The top left corner of the quad, in pixels.
+		 * @param Size The width and height of the quad, in pixels.
+		 * @param Color The color the texture is multiplied by.
+		 * @param UVRect The texture coordinates of the top left (xy) and bottom right (zw) corners, e.g. a sprite of an atlas.
+		 */
+		void DrawSprite(GLuint Texture, const glm::vec2& Position, const glm::vec2& Size, const glm::vec4& Color = glm::vec4(1.0f),
+			const glm::vec4& UVRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
+
+		/**
+		 * Records a plain rectangle, e.g. the background of a panel.
+		 *
+		 * @param Position The top left corner of the rectangle, in pixels.
+		 * @param Size The width and height of the rectangle, in pixels.
+		 * @param Color The color and opacity of the rectangle.
+		 */
+		void DrawRect(const glm::vec2& Position, const glm::vec2& Size, const glm::vec4& Color);
+
+		/**
+		 * Records a line of text, one quad per visible glyph; '\n' starts a new line below Position.
+		 *
+		 * @param Font The font atlas.
+		 * @param Text The characters, those outside of the font are skipped.
+		 * @param Position The top left corner of the first glyph, in pixels.
+		 * @param Height The height of a line, in pixels.
+		 * @param Color The color of the glyphs.
+		 * @return The width of the longest line, in pixels.
+		 */
+		float DrawString(const SpriteFont& Font, std::string_view Text, const glm::vec2& Position, float Height, const glm::vec4& Color = glm::vec4(1.0f));
+
+		/** @return The number of quads recorded since the last Latch(). */
+		size_t GetQuadCount() const;
+
+		/** Takes the quads recorded so far as the ones of the next Render(), new quads go to the next frame. */
+		void Latch();
+
+		/**
+		 * Draws the latched quads into the bound framebuffer. Requires a current OpenGL context.
+		 *
+		 * @param Width The width of the viewport, in pixels.
+		 * @param Height The height of the viewport, in pixels.
+		 */
+		void Render(int Width, int Height);
+
+		/** Deletes the buffers, the texture and the shader. */
+		void Destroy();
+
+	private:
+		/** A recorded quad, expanded to four vertices when drawn. */
+		struct Quad
+		{
+			glm::vec4 Rect;     ///< Top left corner (xy) and bottom right corner (zw), in pixels.
+			glm::vec4 UVRect;   ///< Texture coordinates of the same corners.
+			uint32_t Color;     ///< Color, packed RGBA8.
+			GLuint Texture;     ///< Texture of the quad, 0 for white.
+			int Layer;          ///< Layer of the quad, sorted before the texture.
+		};
+
+		/** A corner of a quad. */
+		struct Vertex
+		{
+			glm::vec2 Position; ///< Position in pixels.
+			glm::vec2 UV;       ///< Texture coordinates.
+			uint32_t Color;     ///< Color, packed RGBA8.
+		};
+
+		/** Grows the vertex and index buffers to hold QuadCount quads. */
+		void Reserve(size_t QuadCount);
+
+		std::vector<Quad> m_Recording;               ///< Quads recorded since the last Latch().
+		std::vector<Quad> m_Latched;                 ///< Quads of the next Render().
+		std::vector<uint32_t> m_Order;               ///< Indices of m_Latched in drawing order.
+		int m_Layer = 0;                             ///< Layer of the next quads.
+		GLuint m_VertexBuffer = 0;                   ///< Dynamic buffer the quads are written to, orphaned every frame.
+		GLuint m_IndexBuffer = 0;                    ///< Two triangles per quad, for m_Capacity quads.
+		GLuint m_VertexArray = 0;                    ///< Layout of m_VertexBuffer with m_IndexBuffer.
+		TextureHandle m_WhiteTexture;                ///< 1 x 1 white texture of the untextured quads.
+		size_t m_Capacity = 0;                       ///< Quads the buffers hold.
+		std::shared_ptr<BaseCamera> m_Camera;        ///< Orthographic camera of the overlay, sized to the viewport.
+		std::unique_ptr<Shader> m_Shader;            ///< Textured, vertex colored shader, compiled on first use.
+	};
+
+} // namespace fgl
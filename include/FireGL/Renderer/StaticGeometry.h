@@ -0,0 +1,74 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+#include <FireGL/Renderer/Mesh.h>
+#include <FireGL/Renderer/MatrixBuffer.h>
+
+#include <atomic>
+
+namespace fgl
+{
+	class SceneObject;
+
+	/** Pre-transformed geometry of the static meshes of one spatial cell sharing a material. */
+	struct StaticChunk
+	{
+		BaseMesh Mesh;         ///< World-space vertices of every merged mesh, its bounds are the chunk's.
+		InstanceData Instance; ///< Identity transforms, the material, texture layers and payload of the merged meshes.
+	};
+
+	/**
+	 * Static objects of a Scene merged into a few large meshes, see Scene::BuildStaticGeometry().
+	 *
+	 * Level geometry that never moves gains nothing from instancing: every mesh of the merged objects is
+	 * transformed to world space once, and appended to the chunk of its cell of a uniform grid (by the center
+	 * of its object's bounds) and its material. Meshes only share a chunk when their material, texture layers,
+	 * instance payload and reflection probe are equal, so the chunk draws them all with one identity instance. The renderer
+	 * culls the chunks against the view and draws each with one call, the merged objects no longer take part
+	 * in batching nor in the instance buffer.
+	 *
+	 * Lightmapped meshes merge into lightmapped chunks: the lightmap region of their object, its instance payload,
+	 * is applied to their lightmap coordinates, so objects of different regions still share a chunk.
+	 *
+	 * Objects drawing transparent materials or skinned meshes are never merged. Levels of detail and meshlets
+	 * are dropped: chunks draw the full-detail triangles.
+	 */
+	class StaticGeometry
+	{
+	public:
+		static constexpr float DefaultChunkSize = 64.0f; ///< Edge of the grid cells, in world units.
+
+		/**
+		 * Merges the meshes of a set of objects into chunks, replacing the previous chunks.
+		 *
+		 * @param Objects The objects to merge, their current Model matrices are baked into the vertices.
+		 * @param ChunkSize Edge of the grid cells grouping the meshes, in world units.
+		 */
+		void Build(const std::vector<SceneObject*>& Objects, float ChunkSize = DefaultChunkSize);
+
+		/** Drops every chunk. */
+		void Clear();
+
+		/**
+		 * @param Object An object about to be merged.
+		 * @return True if its meshes can be drawn pre-transformed: no transparent material, no skinned mesh, no
+		 *         procedural animation, and their vertices still in system memory (see BaseMesh::SetCPUGeometryPolicy()).
+		 */
+		static bool CanMerge(SceneObject& Object);
+
+		/** @return The chunks, sorted by material. */
+		std::vector<StaticChunk>& GetChunks();
+
+		/** @return The chunks, sorted by material. */
+		const std::vector<StaticChunk>& GetChunks() const;
+
+		/** @return Changes with every Build() and Clear(), unique across every StaticGeometry. */
+		uint64_t GetRevision() const;
+
+	private:
+		std::vector<StaticChunk> m_Chunks;                ///< Merged meshes of each cell and material.
+		uint64_t m_Revision = 0;                          ///< Identity of the current chunks.
+		static std::atomic<uint64_t> s_NextRevision;      ///< Revision handed out by the next Build() or Clear().
+	};
+
+} // namespace fgl
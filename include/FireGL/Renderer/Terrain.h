@@ -0,0 +1,171 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+#include <FireGL/Renderer/Shader.h>
+#include <FireGL/Renderer/DynamicBVH.h>
+
+#include <External/glm/vec3.hpp>
+#include <External/glm/vec4.hpp>
+#include <External/glad/glad.h>
+
+namespace fgl
+{
+	class BaseCamera;
+	class Texture;
+	class VirtualTexture;
+
+	/** Layout, streaming and tessellation of a Terrain. */
+	struct TerrainSettings
+	{
+		glm::vec3 Origin = glm::vec3(0.0f);  ///< World position of the first height sample, at height 0.
+		float CellSize = 1.0f;               ///< Distance between two height samples, in world units.
+		float HeightScale = 1.0f;            ///< Scale applied to the height samples.
+		int ChunkSize = 64;                  ///< Cells per chunk edge, 64 at most: one patch tessellates a chunk at full detail.
+		float StreamDistance = 1024.0f;      ///< Chunks closer than this are resident; it is also the draw distance.
+		int ResidentChunks = 256;            ///< Chunks resident at once, at most.
+		int UploadsPerFrame = 8;             ///< Chunks uploaded per Render(), at most.
+		float TriangleSize = 8.0f;           ///< Target length of the tessellated edges on screen, in pixels.
+		float TextureScale = 8.0f;           ///< World size of one repetition of the albedo texture.
+	};
+
+	/**
+	 * Heightmap ground of any size, drawn in chunks with a bounded vertex cost.
+	 *
+	 * The heights stay on the CPU, split into a grid of chunks of ChunkSize cells. Only the chunks within
+	 * StreamDistance of the camera are resident on the GPU, each in one layer of an R32F texture array, with a
+	 * border of one sample for the normals; the closest missing chunks are uploaded first, UploadsPerFrame per
+	 * frame, evicting the farthest ones when the array is full.
+	 *
+	 * Every visible chunk is one quad patch, all drawn with a single instanced call. The chunks' bounds are
+	 * kept in a DynamicBVH queried with the view frustum, like the Scene's objects. The tessellation control
+	 * shader subdivides each edge of a patch so its tessellated segments span about TriangleSize pixels, from
+	 * the edge alone: the patches sharing an edge agree on its subdivision and the surface has no cracks. The
+	 * evaluation shader displaces the vertices by the heights. Near chunks reach one triangle pair per cell,
+	 * far ones collapse to two triangles, so the vertex count depends on the screen, not on the world's size.
+	 *
+	 * The ground is lit by the directional light of the LightData block, textured with SetTexture() or colored
+	 * by slope otherwise. A VirtualTexture set with SetVirtualTexture() instead stretches unique texels over the
+	 * whole ground, and the patches are drawn a second time into its feedback target. Renderer::AddTerrain()
+	 * draws it with the opaque geometry.
+	 */
+	class Terrain
+	{
+	public:
+		static constexpr int MaxChunkSize = 64; ///< Largest tessellation level of the OpenGL specification's minimum.
+		static constexpr GLint HeightUnit = 0;  ///< Texture unit of the height array while drawn.
+		static constexpr GLint AlbedoUnit = 1;  ///< Texture unit of the albedo texture while drawn.
+		static constexpr GLint VirtualCacheUnit = 2;       ///< Texture unit of the virtual texture's cache while drawn.
+		static constexpr GLint VirtualIndirectionUnit = 3; ///< Texture unit of the virtual texture's indirection while drawn.
+
+		Terrain() = default;
+
+		/** Deletes the height array, buffers and shader. */
+		~Terrain();
+
+		Terrain(const Terrain&) = delete;
+		Terrain& operator=(const Terrain&) = delete;
+
+		/**
+		 * Splits the heights into chunks and compiles the shader. Requires a current OpenGL 4.0 context.
+		 *
+		 * @param Heights Width x Depth height samples, row by row along X, scaled by Settings.HeightScale.
+		 * @param Width The number of samples along X, at least 2.
+		 * @param Depth The number of samples along Z, at least 2.
+		 * @param Settings Layout, streaming and tessellation of the terrain.
+		 */
+		void Create(std::vector<float> Heights, int Width, int Depth, const TerrainSettings& Settings = TerrainSettings());
+
+		/** Deletes the height array, buffers and shader, the heights are lost. */
+		void Destroy();
+
+		/** @return True once Create() was called. */
+		bool IsCreated() const;
+
+		/**
+		 * Sets the texture the ground is drawn with, repeated every TextureScale world units.
+		 *
+		 * @param Albedo A 2D texture, nullptr (the default) to color the ground by slope. Must outlive its use.
+		 */
+		void SetTexture(const Texture* Albedo);
+
+		/**
+		 * Covers the whole ground with a virtual texture, its first texel at the origin and its last at the far
+		 * corner of the heights. Takes precedence over SetTexture(). The caller updates it every frame, Render()
+		 * draws its feedback.
+		 *
+		 * @param Albedo An open virtual texture, nullptr (the default) for none. Must outlive its use.
+		 */
+		void SetVirtualTexture(VirtualTexture* Albedo);
+
+		/**
+		 * Samples the ground, e.g. to place objects on it.
+		 *
+		 * @param X The world X coordinate.
+		 * @param Z The world Z coordinate.
+		 * @return The world height of the ground, interpolated between the samples and clamped at the borders.
+		 */
+		float GetHeight(float X, float Z) const;
+
+		/**
+		 * Streams the chunks around the camera, then draws the visible resident ones into the bound framebuffer.
+		 *
+		 * @param Camera The camera the frame is drawn from, its view matrix up to date.
+		 * @param ViewportHeight The height of the viewport in pixels, which the edges are measured against.
+		 */
+		void Render(const BaseCamera& Camera, float ViewportHeight);
+
+		/** @return The number of chunks resident on the GPU. */
+		uint32_t GetResidentCount() const;
+
+		/** @return The number of chunks drawn by the last Render(). */
+		uint32_t GetDrawnCount() const;
+
+	private:
+		/** One cell of the chunk grid. */
+		struct Chunk
+		{
+			BoundingBox Bounds;  ///< World bounds of the chunk's heights.
+			int32_t Layer = -1;  ///< Layer of the height array holding the chunk, -1 if not resident.
+		};
+
+		/** Uploads the closest missing chunks within StreamDistance, evicting the farthest resident ones. */
+		void StreamChunks(const glm::vec3& ViewPosition);
+
+		/** Copies the heights of a chunk and its border into a layer of the height array. */
+		void UploadChunk(uint32_t ChunkIndex, int32_t Layer);
+
+		/** @return The height sample at a grid position, clamped to the grid. */
+		float GetSample(int X, int Z) const;
+
+		/** @return The horizontal distance from a point to a chunk's bounds. */
+		float GetDistance(const Chunk& Target, const glm::vec3& Position) const;
+
+		/** Sets the layout and tessellation uniforms shared by the shading and feedback shaders. */
+		void SetPatchUniforms(const Shader& Target, float ViewportHeight) const;
+
+		TerrainSettings m_Settings;                ///< Layout, streaming and tessellation.
+		std::vector<float> m_Heights;              ///< Height samples, row by row along X.
+		int m_Width = 0;                           ///< Samples along X.
+		int m_Depth = 0;                           ///< Samples along Z.
+		int m_ChunksX = 0;                         ///< Chunks along X.
+		int m_ChunksZ = 0;                         ///< Chunks along Z.
+		std::vector<Chunk> m_Chunks;               ///< Chunks, row by row along X.
+		DynamicBVH m_ChunkTree;                    ///< Bounds of the chunks, queried with the view frustum.
+		std::vector<int32_t> m_FreeLayers;         ///< Layers of the height array holding no chunk.
+		std::vector<uint32_t> m_ResidentChunks;    ///< Chunks holding a layer.
+		std::vector<uint32_t> m_VisibleChunks;     ///< Chunks the frustum query returned, reused across frames.
+		std::vector<std::pair<float, uint32_t>> m_StreamCandidates; ///< Distance and index of the missing chunks in range, reused across frames.
+		std::vector<float> m_UploadScratch;        ///< Samples of the chunk being uploaded.
+		std::vector<glm::vec4> m_PatchData;        ///< Origin and layer of every drawn patch, reused across frames.
+		const Texture* m_Albedo = nullptr;         ///< Texture of the ground, nullptr to color by slope.
+		VirtualTexture* m_VirtualTexture = nullptr; ///< Virtual texture over the whole ground, nullptr for none.
+		GLuint m_HeightArray = 0;                  ///< One layer of heights per resident chunk.
+		GLuint m_PatchBuffer = 0;                  ///< m_PatchData of the last Render().
+		size_t m_PatchCapacity = 0;                ///< Records m_PatchBuffer holds.
+		GLuint m_VertexArray = 0;                  ///< Reads the patch records as per-instance attributes.
+		std::unique_ptr<Shader> m_Shader;          ///< Tessellates, displaces and lights the patches.
+		std::unique_ptr<Shader> m_FeedbackShader;  ///< Tessellates and displaces the patches like m_Shader, writing virtual texture feedback.
+		uint32_t m_DrawnCount = 0;                 ///< Patches drawn by the last Render().
+	};
+
+} // namespace fgl
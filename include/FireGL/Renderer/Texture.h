@@ -1,6 +1,8 @@
 #pragma once
 
 #include <FireGL/fglpch.h>
+#include <FireGL/Renderer/RenderDevice.h>
+#include <FireGL/Core/Symbol.h>
 
 #include <External/glad/glad.h>
 
@@ -8,11 +10,47 @@
 
 namespace fgl
 {
+    class GLUploadThread;
+
+    /**
+     * Pixels of an image decoded on the CPU, ready to be uploaded to a texture.
+     * Decoding doesn't touch OpenGL, so it can run on any thread.
+     */
+    struct ImageData
+    {
+        /** Location of one mip level of a compressed image inside Pixels. */
+        struct Level
+        {
+            size_t Offset; ///< Byte offset of the level blocks.
+            size_t Size;   ///< Size of the level blocks in bytes.
+            int Width;     ///< Width of the level in pixels.
+            int Height;    ///< Height of the level in pixels.
+        };
+
+        std::shared_ptr<unsigned char> Pixels; ///< Decoded pixels, or the whole container file of a compressed image.
+        int Width = 0;                         ///< Width of the image in pixels.
+        int Height = 0;                        ///< Height of the image in pixels.
+        int Channels = 0;                      ///< Number of channels per pixel, 0 for compressed images.
+        GLenum CompressedFormat = 0;           ///< OpenGL compressed internal format, 0 for uncompressed pixels.
+        std::vector<Level> Levels;             ///< Prebuilt mip chain of a compressed image, from the base level down.
+        int FaceCount = 1;                     ///< 6 for a cube map, whose Levels list the faces of each level in turn (+X, -X, +Y, -Y, +Z, -Z).
+    };
 
     /**
      * Represents a texture in OpenGL, supporting both 2D textures and CubeMaps.
      * This class manages texture loading, binding, and resource cleanup for textures used in rendering.
      * It handles both regular 2D textures as well as CubeMap textures, such as those used for skyboxes.
+     *
+     * A Texture owns the OpenGL texture it creates and deletes it when destroyed, so it can be moved but not
+     * copied. Other holders reference it through a view (see CreateView() and SetID()), which shares the ID
+     * without ever deleting it, e.g. the mesh textures of a Model, owned by the TextureCache.
+     *
+     * The wrapping and filtering given at creation are kept as a SamplerState, whose shared sampler object
+     * (see SamplerCache) Activate() binds along with the texture; the same parameters are also stored in the
+     * texture for bindless handles and raw binds, which sample without a sampler object.
+     *
+     * Loaded images and cube maps are created, and textures bound, through the RenderDevice. Texture arrays,
+     * equirectangular conversion and GLUploadThread uploads still call OpenGL directly.
      */
     class Texture 
     {
@@ -23,9 +61,32 @@ namespace fgl
          */
         Texture();
 
+        /** Deletes the OpenGL texture if this Texture owns it, see Cleanup(). */
+        ~Texture();
+
+        Texture(const Texture&) = delete;
+        Texture& operator=(const Texture&) = delete;
+
+        /** Takes over the texture of another one, which is left empty. */
+        Texture(Texture&& Other) noexcept;
+
+        /** Deletes the owned texture, then takes over the texture of another one, which is left empty. */
+        Texture& operator=(Texture&& Other) noexcept;
+
+        /**
+         * Creates a view of this texture: same ID, target, slot, name and path, but not owning the OpenGL texture.
+         * The view must not be used once the owner deleted the texture.
+         *
+         * @return The non-owning Texture.
+         */
+        Texture CreateView() const;
+
         /**
          * Loads a 2D texture from a specified file path and sets OpenGL texture parameters.
          * The texture is generated, bound, and initialized with the data loaded from the file.
+         * DDS and KTX2 files are uploaded GPU-compressed with their own mip chain (see TextureContainer);
+         * FlipVertical doesn't apply to them. Other images get their mip chain from the MipGenerator.
+         * The storage is immutable where the context supports it (see GLExtensions::HasTextureStorage()).
          *
          * @param Path           The path to the texture file (can be relative or absolute).
          * @param WrapS          The wrapping mode for the horizontal axis (U-coordinate).
@@ -44,9 +105,80 @@ namespace fgl
             bool FlipVertical = true
         );
 
+        /**
+         * Decodes an image file on the CPU without creating any OpenGL object. Thread-safe.
+         * DDS and KTX2 files are only read, their compressed blocks are left as is.
+         *
+         * @param Path           The path to the image file.
+         * @param FlipVertical   Whether or not to flip the image vertically upon loading.
+         * @param Image          Receives the decoded pixels.
+         * @return               `true` if the image was decoded, `false` otherwise.
+         */
+        static bool DecodeImage(std::string_view Path, bool FlipVertical, ImageData& Image);
+
+        /**
+         * Creates the 2D texture from an image decoded with DecodeImage. Must run on the thread owning the OpenGL context.
+         * See LoadTexture for the parameters.
+         *
+         * @param Image          The decoded image to upload.
+         * @return               `true` if the texture was created, `false` if the image holds no pixels
+         *                       or its compressed format isn't supported by the context.
+         */
+        bool UploadImage(
+            const ImageData& Image,
+            GLenum WrapS = GL_REPEAT,
+            GLenum WrapT = GL_REPEAT,
+            GLenum MinFilter = GL_LINEAR,
+            GLenum MagFilter = GL_LINEAR
+        );
+
+        /**
+         * Creates the 2D texture like UploadImage, with its pixels uploaded by the background thread of a shared context.
+         * The texture name and its memory tracking are made on the calling thread, which must own the main context;
+         * the texture must not be sampled before Thread.IsComplete() returns true for the returned ticket.
+         *
+         * @param Thread         A running upload thread, see BaseWindow::SetUploadThread().
+         * @param Image          The decoded image to upload, its pixels are kept alive until the upload ran.
+         * @return               The ticket of the upload, 0 if the image holds no pixels or its compressed format
+         *                       isn't supported by the context.
+         *
+         * See LoadTexture for the other parameters.
+         */
+        uint64_t UploadImageAsync(
+            GLUploadThread& Thread,
+            const ImageData& Image,
+            GLenum WrapS = GL_REPEAT,
+            GLenum WrapT = GL_REPEAT,
+            GLenum MinFilter = GL_LINEAR,
+            GLenum MagFilter = GL_LINEAR
+        );
+
+        /**
+         * Recreates the 2D texture with only the mip levels from BaseLevel down, used to stream textures in and out
+         * of video memory. The previous texture object is deleted and GetID() changes.
+         * Immutable storage only holds the levels from BaseLevel down, BaseLevel becoming level 0; on contexts
+         * without it, GL_TEXTURE_BASE_LEVEL and GL_TEXTURE_MAX_LEVEL clamp sampling to the allocated levels.
+         *
+         * @param Image          A compressed image with its whole mip chain, or the uncompressed pixels of level BaseLevel
+         *                       (whose smaller levels are generated).
+         * @param BaseLevel      The finest mip level to allocate.
+         * @return               `true` if the texture was created.
+         *
+         * See LoadTexture for the other parameters.
+         */
+        bool UploadMipRange(
+            const ImageData& Image,
+            int BaseLevel,
+            GLenum WrapS = GL_REPEAT,
+            GLenum WrapT = GL_REPEAT,
+            GLenum MinFilter = GL_LINEAR_MIPMAP_LINEAR,
+            GLenum MagFilter = GL_LINEAR
+        );
+
         /**
          * Loads a CubeMap texture from multiple faces and sets OpenGL texture parameters.
          * The CubeMap is created by loading six images (one for each face) and binding them as a CubeMap texture.
+         * The faces are decoded in parallel, then uploaded in order.
          *
          * The six faces should be provided in the following order:
          * - +X (right face)
@@ -69,17 +201,101 @@ namespace fgl
             bool FlipVertical = false
         );
 
+        /**
+         * Loads a CubeMap texture from a single file.
+         *
+         * - DDS and KTX2 cube maps are uploaded GPU-compressed (e.g. BC6H for HDR skies) with their prebuilt,
+         *   usually prefiltered, mip chain; nothing is decoded or generated at load time.
+         * - Equirectangular .hdr panoramas are converted to a GL_RGB16F CubeMap on the GPU, then mipmapped.
+         *
+         * @param Path           The .dds, .ktx2 or .hdr file.
+         * @param MinFilter      The minification filter used when the CubeMap is scaled down.
+         * @param MagFilter      The magnification filter used when the CubeMap is scaled up.
+         * @param FaceSize       Face size of a converted panorama, 0 for a quarter of its width.
+         * @return               `true` if the CubeMap was successfully loaded, `false` otherwise.
+         */
+        bool LoadCubeMap(
+            std::string_view Path,
+            GLenum MinFilter = GL_LINEAR_MIPMAP_LINEAR,
+            GLenum MagFilter = GL_LINEAR,
+            int FaceSize = 0
+        );
+
+        /**
+         * Creates an empty GL_TEXTURE_2D_ARRAY whose layers are filled with UploadLayer().
+         * Shaders sample it with a sampler2DArray, the layer usually coming from the instance stream.
+         *
+         * @param Width          The width of every layer in pixels.
+         * @param Height         The height of every layer in pixels.
+         * @param LayerCount     The number of layers.
+         * @param InternalFormat GL_RGB8, GL_RGBA8 or a compressed format (see TextureContainer).
+         * @param LevelCount     The number of mip levels of every layer.
+         * @param MinFilter      The minification filter used when the texture is scaled down.
+         * @param MagFilter      The magnification filter used when the texture is scaled up.
+         * @return               `true` if the array was created.
+         */
+        bool CreateArray(
+            int Width,
+            int Height,
+            int LayerCount,
+            GLenum InternalFormat,
+            int LevelCount,
+            GLenum MinFilter = GL_LINEAR_MIPMAP_LINEAR,
+            GLenum MagFilter = GL_LINEAR
+        );
+
+        /**
+         * Uploads an image to one layer of a texture created with CreateArray().
+         * The image must match the array: same size, and same compressed format and level count,
+         * or 3 / 4 channels for GL_RGB8 / GL_RGBA8 arrays (whose mips are made by GenerateMipmaps()).
+         *
+         * @param Layer          The layer to fill.
+         * @param Image          The decoded image.
+         */
+        void UploadLayer(int Layer, const ImageData& Image);
+
+        /** Regenerates the mip chain of the texture from its base level, with a compute shader when possible (see MipGenerator). */
+        void GenerateMipmaps();
+
         /**
          * Binds the texture for use in rendering.
-         * This activates the texture and makes it available to OpenGL for rendering.
+         * This activates the texture and its sampler object on its slot, making it available to OpenGL for rendering.
          */
         void Activate() const;
 
         /**
-         * Cleans up the OpenGL resources associated with the texture.
-         * This deletes the texture object from OpenGL to free the resources.
+         * Cleans up the OpenGL resources associated with the texture and leaves it empty.
+         * This deletes the texture object from OpenGL to free the resources, and releases its bindless handle,
+         * if this Texture owns it; views only forget the ID. Safe to call more than once.
+         */
+        void Cleanup();
+
+        /**
+         * Deletes an OpenGL texture no Texture owns, e.g. one handed over with ReleaseOwnership(),
+         * releasing its bindless handle and its memory tracking.
+         *
+         * @param ID The texture to delete, 0 does nothing.
+         */
+        static void Delete(GLuint ID);
+
+        /**
+         * Hands the OpenGL texture over to another owner, this Texture becoming a view of it.
+         *
+         * @return The texture ID, which the new owner deletes with Delete().
+         */
+        GLuint ReleaseOwnership();
+
+        /** @return True if the Texture deletes its OpenGL texture when cleaned up or destroyed. */
+        bool IsOwner() const;
+
+        /**
+         * Returns the bindless handle of the texture, making it resident on first use.
+         * Requires GLExtensions::HasBindlessTexture(). Once a handle exists, the texture's parameters
+         * can no longer be changed; it stays resident until Cleanup().
+         *
+         * @return The 64-bit handle shaders sample the texture through, 0 if the texture isn't created.
          */
-        void Cleanup() const;
+        uint64_t GetBindlessHandle() const;
 
 
         /// Getters
@@ -87,11 +303,26 @@ namespace fgl
         /** @return The OpenGL texture ID. */
         unsigned int GetID() const;
 
+        /** @return The OpenGL texture target, e.g. GL_TEXTURE_2D or GL_TEXTURE_CUBE_MAP. */
+        GLenum GetTarget() const;
+
+        /** @return The RenderDevice handle of the texture, e.g. to bind it with RenderDevice::BindTexture(). */
+        const TextureHandle& GetHandle() const;
+
         /** @return The name of the texture (e.g., "diffuse", "specular", etc.). */
-        std::string GetName() const;
+        const std::string& GetName() const;
 
         /** @return The file path from which the texture was loaded. */
-        std::string GetPath() const;
+        const std::string& GetPath() const;
+
+        /** @return The interned name, compared as an integer. */
+        Symbol GetNameSymbol() const;
+
+        /** @return The interned file path, compared as an integer. */
+        Symbol GetPathSymbol() const;
+
+        /** @return The wrapping and filtering the texture is sampled with when activated. */
+        const SamplerState& GetSampler() const;
 
         /** @return The slot index for the texture, representing the binding point in OpenGL. */
         int8_t GetSlotIndex() const;
@@ -99,7 +330,10 @@ namespace fgl
 
         /// Setters
 
-        /** Sets the OpenGL texture ID for the texture. */
+        /**
+         * Makes the texture a view of an OpenGL texture owned elsewhere, e.g. by the TextureCache.
+         * The texture this Texture owned, if any, is deleted first.
+         */
         void SetID(unsigned int ID);
 
         /** Sets the name of the texture (e.g., "diffuse", "specular", etc.). */
@@ -111,28 +345,40 @@ namespace fgl
         /** Sets the slot index for the texture, representing the binding point in OpenGL. */
         void SetSlotIndex(int8_t SlotIndex);
 
+        /**
+         * Sets the wrapping and filtering the texture is sampled with when activated, e.g. a cheaper filter
+         * on low-end targets. The texture's own parameters are left as they were created.
+         * Needs no OpenGL context, the sampler object is looked up on the next Activate().
+         */
+        void SetSampler(const SamplerState& State);
+
     private:
+        /** Deletes the owned texture, then creates a new OpenGL texture of the given type this Texture owns. */
+        void GenerateID(TextureType Type);
+
+        /** Deletes the owned texture, then takes ownership of a texture created by the RenderDevice. */
+        void Adopt(const TextureHandle& Handle);
+
         /**
-         * Configures the texture's wrapping and filtering parameters based on the provided values.
-         *
-         * See the LoadTexture function params for detailed descriptions of each parameter.
+         * Checks an image can be uploaded to this context, logging why not.
+         * @return `true` if the image holds pixels in a supported format.
          */
-        void SetupTextureParameters(GLenum WrapS, GLenum WrapT, GLenum MinFilter, GLenum MagFilter);
+        static bool IsUploadable(const ImageData& Image);
 
         /**
-         * Configures CubeMap specific parameters, such as minification and magnification filters.
+         * @return The sampler of a CubeMap: the given filters, clamped to the edge on every axis.
          */
-        void SetupCubeMapParameters(GLenum MinFilter, GLenum MagFilter);
+        static SamplerState GetCubeMapSampler(GLenum MinFilter, GLenum MagFilter);
 
         /**
-         * Loads texture data from a specified file path using the stb_image library and uploads it to OpenGL.
-         * This function can load both 2D textures and CubeMap faces depending on the specified target.
-         *
-         * @param Path   The path to the texture file. The file can represent either a 2D texture or a CubeMap face.
-         * @param Target The OpenGL texture target (default is `GL_TEXTURE_2D`, but can also be `GL_TEXTURE_CUBE_MAP` for CubeMap textures).
-         * @return `true` if the texture data was successfully loaded and uploaded to OpenGL, `false` otherwise.
+         * Reads a DDS or KTX2 file, from a mounted AssetArchive if one holds it. Thread-safe.
+         */
+        static bool ReadContainer(std::string_view Path, ImageData& Image);
+
+        /**
+         * Renders an equirectangular .hdr panorama into the faces of this CubeMap, see LoadCubeMap().
          */
-        bool LoadTextureFromFile(std::string_view Path, GLenum Target = GL_TEXTURE_2D);
+        bool ConvertEquirectangular(std::string_view Path, int FaceSize);
 
         /**
          * Handles the case when texture loading fails.
@@ -141,11 +387,14 @@ namespace fgl
         void HandleTextureLoadingFailure();
 
     private:
-        unsigned int m_ID;       ///< The OpenGL texture ID assigned after texture creation
-        std::string m_Name;      ///< The type of texture (e.g., diffuse, specular, roughness) (not needed except if it's created in the material class)
-        std::string m_Path;      ///< The file path from which the texture was loaded 
+        TextureHandle m_Handle;  ///< The texture ID assigned after texture creation, with its type and size
+        Symbol m_Name;           ///< The type of texture (e.g., diffuse, specular, roughness) (not needed except if it's created in the material class)
+        Symbol m_Path;           ///< The file path from which the texture was loaded, shared by its views
         int8_t m_SlotIndex;      ///< The texture slot index (binds the texture to a particular active texture unit)
-        GLenum m_TextureTarget;  ///< The OpenGL texture target (2D texture or CubeMap)
+        SamplerState m_Sampler;  ///< The wrapping and filtering bound with the texture by Activate()
+        mutable SamplerHandle m_SamplerHandle; ///< The cached sampler of m_Sampler, empty until the next Activate()
+        bool m_FlipVertical = false; ///< Whether the CubeMap faces being loaded are flipped vertically
+        bool m_bOwnsID = false;  ///< Whether m_Handle is deleted by Cleanup() and the destructor, false for views
     };
 
 } // namespace fgl
\ No newline at end of file
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+#include <FireGL/Renderer/Texture.h>
+
+namespace fgl
+{
+
+	/** Where an image added to a TextureArrayPool ended up. */
+	struct TextureArrayLayer
+	{
+		Texture* Array = nullptr; ///< The GL_TEXTURE_2D_ARRAY holding the image, nullptr if it couldn't be added.
+		uint32_t Layer = 0;       ///< The layer of the image in Array.
+	};
+
+	/**
+	 * Packs images into texture arrays, one array per size and format class.
+	 *
+	 * Objects that share a mesh and only differ by their textures can then use a single material bound to
+	 * the arrays, and be drawn in the same instanced batch: each object picks its layers through
+	 * SceneObject::SetTextureLayers(), which the instance stream hands to the vertex shader at location 10.
+	 *
+	 * Images of the same width, height and format (RGB8, RGBA8, or a compressed format with the same mip
+	 * count) share an array; a new array of the class is created when one is full.
+	 * Must be used on the thread owning the OpenGL context.
+	 */
+	class TextureArrayPool
+	{
+	public:
+		/**
+		 * @param LayersPerArray The number of layers allocated for every array.
+		 */
+		TextureArrayPool(int LayersPerArray = 64);
+
+		/** Deletes every array of the pool. */
+		~TextureArrayPool();
+
+		TextureArrayPool(const TextureArrayPool&) = delete;
+		TextureArrayPool& operator=(const TextureArrayPool&) = delete;
+
+		/**
+		 * Copies a decoded image into the array of its class.
+		 * Mipmaps of uncompressed arrays are only regenerated by GenerateMipmaps().
+		 *
+		 * @param Image The image to add, with 3 or 4 channels if uncompressed.
+		 * @return Its array and layer, or an empty TextureArrayLayer if the image isn't supported.
+		 */
+		TextureArrayLayer AddImage(const ImageData& Image);
+
+		/**
+		 * Decodes an image file and adds it to the pool (see Texture::DecodeImage and AddImage).
+		 */
+		TextureArrayLayer LoadImage(std::string_view Path, bool FlipVertical = true);
+
+		/** Regenerates the mipmaps of the uncompressed arrays that received images since the last call. */
+		void GenerateMipmaps();
+
+		/** @return The number of arrays created so far. */
+		size_t GetArrayCount() const;
+
+	private:
+		/** The images an array can hold. */
+		struct ArrayClass
+		{
+			int Width = 0;
+			int Height = 0;
+			GLenum InternalFormat = 0;
+			int LevelCount = 0;
+
+			bool operator==(const ArrayClass& Other) const = default;
+		};
+
+		/** An array of the pool and its fill state. */
+		struct PoolArray
+		{
+			ArrayClass Class;
+			std::unique_ptr<Texture> Array; ///< Kept at a stable address, TextureArrayLayer points to it.
+			int UsedLayers = 0;
+			bool bMipmapsDirty = false;
+		};
+
+		/** @return The class of an image, with an InternalFormat of 0 if the image can't be stored in an array. */
+		static ArrayClass GetClass(const ImageData& Image);
+
+		std::vector<PoolArray> m_Arrays; ///< Every array created, in creation order.
+		int m_LayersPerArray;            ///< Layers allocated per array.
+	};
+
+} // namespace fgl
\ No newline at end of file
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+
+#include <External/glad/glad.h>
+
+namespace fgl
+{
+
+	/**
+	 * Engine-wide registry of the textures loaded from files, shared by every Model.
+	 *
+	 * Textures are keyed by a hash of their canonical path, so two models referencing the same image
+	 * (two instances of a model, or models sharing an atlas) upload it once and share its ID.
+	 * Each user acquires a reference and releases it when done; the OpenGL texture is deleted with the
+	 * last reference.
+	 *
+	 * Lookups are thread-safe so meshes can be imported on worker threads, but Add() and Release()
+	 * create and delete OpenGL objects and must run on the thread owning the OpenGL context.
+	 */
+	class TextureCache
+	{
+	public:
+		/**
+		 * Computes the cache key of an image file.
+		 *
+		 * @param FilePath The path of the image, relative to the working directory or absolute.
+		 * @return A hash of the canonical path, identical for every spelling of the same file.
+		 */
+		static size_t GetKey(std::string_view FilePath);
+
+		/**
+		 * Takes a reference to a cached texture.
+		 *
+		 * @param Key The key returned by GetKey().
+		 * @param ID Receives the OpenGL texture ID if the texture is cached.
+		 * @return True if the texture was found and its reference count incremented.
+		 */
+		static bool Acquire(size_t Key, GLuint& ID);
+
+		/**
+		 * Registers a newly uploaded texture with one reference.
+		 * If another thread registered the key in the meantime, ID is deleted and replaced by the cached one.
+		 *
+		 * @param Key The key returned by GetKey().
+		 * @param ID The OpenGL texture ID, receiving the ID to use.
+		 */
+		static void Add(size_t Key, GLuint& ID);
+
+		/**
+		 * Drops a reference taken with Acquire() or Add(), deleting the texture with the last one.
+		 *
+		 * @param Key The key returned by GetKey().
+		 */
+		static void Release(size_t Key);
+
+		/** @return The number of distinct textures currently cached. */
+		static size_t GetCount();
+
+	private:
+		/** A cached texture and the number of users holding it. */
+		struct Entry
+		{
+			GLuint ID = 0;
+			size_t RefCount = 0;
+		};
+
+		static std::unordered_map<size_t, Entry> s_Entries; ///< Cached textures by key.
+	};
+
+} // namespace fgl
\ No newline at end of file
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+#include <FireGL/Renderer/RenderTarget.h>
+
+#include <External/glad/glad.h>
+
+namespace fgl
+{
+	class Renderer;
+	class Scene;
+	class BaseCamera;
+
+	/** Target, update rate and quality of one camera of TextureCameras. */
+	struct TextureCameraSettings
+	{
+		int Width = 512;                ///< Width of the texture in pixels.
+		int Height = 512;               ///< Height of the texture in pixels.
+		int Samples = 0;                ///< Samples per pixel of the capture, 0 for a single-sample target.
+		GLenum ColorFormat = GL_RGBA8;  ///< Sized internal format of the texture.
+		uint32_t UpdateInterval = 1;    ///< Frames between two captures, 1 for every frame, 0 to capture only on RequestUpdate().
+		float LODBias = 0.5f;           ///< Scale of the projected sizes in the captures, below 1 draws simpler levels of detail.
+		float CullDistance = 0.0f;      ///< Objects farther from the camera are skipped, 0 to draw up to its far plane.
+	};
+
+	/**
+	 * Secondary cameras drawing the Scene into textures, e.g. in-world monitors, mirrors and minimaps.
+	 *
+	 * Every camera captures with Renderer::RenderCapture(), the reduced frame of ReflectionProbes, into its own
+	 * RenderTarget whose color texture the materials of the world sample. A camera has its own resolution, update
+	 * interval, level of detail bias and draw distance, so a far monitor can refresh every fourth frame at a low
+	 * resolution while a mirror refreshes every frame.
+	 *
+	 * Update() spends a budget of captures per frame, MaxCapturesPerUpdate: of the cameras whose interval has
+	 * elapsed or whose update was requested, the requested ones go first, then the most overdue, and the others
+	 * wait for the next frames growing more overdue, so none starves. The cost of the secondary views is then
+	 * bounded whatever the number of cameras; a texture keeps its last capture until its next one.
+	 *
+	 * The cameras are owned by the caller, their view and projection kept up to date like the Scene's active camera.
+	 */
+	class TextureCameras
+	{
+	public:
+		static constexpr uint32_t InvalidCamera = UINT32_MAX; ///< Returned by Add() when the camera couldn't be added.
+
+		TextureCameras() = default;
+
+		TextureCameras(const TextureCameras&) = delete;
+		TextureCameras& operator=(const TextureCameras&) = delete;
+
+		/**
+		 * Adds a camera, captured by the next Update() whatever its interval. Requires a current OpenGL context.
+		 *
+		 * @param Camera The camera to draw from.
+		 * @param Settings The target, update rate and quality of its captures.
+		 * @return The index of the camera, reused once it is removed; InvalidCamera if Camera is nullptr.
+		 */
+		uint32_t Add(std::shared_ptr<BaseCamera> Camera, const TextureCameraSettings& Settings = TextureCameraSettings());
+
+		/**
+		 * Removes a camera and deletes its target.
+		 *
+		 * @param Index The index Add() returned.
+		 */
+		void Remove(uint32_t Index);
+
+		/**
+		 * Changes the settings of a camera, its target is resized by its next capture.
+		 *
+		 * @param Index The index Add() returned.
+		 * @param Settings The target, update rate and quality of its captures.
+		 */
+		void SetSettings(uint32_t Index, const TextureCameraSettings& Settings);
+
+		/** @return The settings of a camera. */
+		const TextureCameraSettings& GetSettings(uint32_t Index) const;
+
+		/**
+		 * Queues a capture of a camera ahead of the interval ones, e.g. for an on-demand camera after its view changed.
+		 *
+		 * @param Index The index Add() returned.
+		 */
+		void RequestUpdate(uint32_t Index);
+
+		/**
+		 * Sets the number of captures every Update() draws at most.
+		 *
+		 * @param Count The captures per frame, at least 1; 2 by default.
+		 */
+		void SetMaxCapturesPerUpdate(uint32_t Count);
+
+		/**
+		 * Captures the cameras due this frame, within the budget. Call it once per frame before Renderer::Render(),
+		 * or PrepareFrame() and the render thread's Render().
+		 *
+		 * @param Target The renderer drawing the captures.
+		 * @param Scene The Scene to capture.
+		 */
+		void Update(Renderer& Target, Scene* Scene);
+
+		/** @return The color texture of a camera's last capture, 0 before its first one. */
+		GLuint GetTexture(uint32_t Index) const;
+
+		/** @return The number of frames since a camera was last captured. */
+		uint64_t GetAge(uint32_t Index) const;
+
+		/** @return The number of cameras, removed slots excluded. */
+		size_t GetCameraCount() const;
+
+	private:
+		/** A camera and the target it draws into. */
+		struct Slot
+		{
+			std::shared_ptr<BaseCamera> Camera;     ///< Camera drawn from, nullptr for a removed slot.
+			TextureCameraSettings Settings;         ///< Target, rate and quality.
+			std::unique_ptr<RenderTarget> Target;   ///< Target of the captures.
+			uint64_t LastFrame = 0;                 ///< Value of m_Frame at the last capture.
+			bool bCaptured = false;                 ///< Whether the camera was captured at least once.
+			bool bRequested = true;                 ///< Whether RequestUpdate() was called since the last capture.
+		};
+
+		/** @return The slot of a camera, asserting the index is valid. */
+		Slot& GetSlot(uint32_t Index);
+		const Slot& GetSlot(uint32_t Index) const;
+
+		std::vector<Slot> m_Slots;                          ///< Every camera, by index.
+		std::vector<std::pair<uint64_t, uint32_t>> m_Due;   ///< Cameras due this frame by priority, reused across frames.
+		uint32_t m_MaxCapturesPerUpdate = 2;                ///< Captures per Update() at most.
+		uint64_t m_Frame = 0;                               ///< Update() calls so far.
+	};
+
+} // namespace fgl
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+#include <FireGL/Renderer/Texture.h>
+
+#include <External/glad/glad.h>
+
+namespace fgl
+{
+
+	/**
+	 * Reader of the GPU-compressed texture containers, DDS and KTX2, and writer of KTX2 files.
+	 *
+	 * The blocks are handed to OpenGL as stored, with the mip chain built offline: nothing is decoded or
+	 * generated at load time, and the texture takes 4 to 8 times less memory than RGBA8.
+	 * Supported formats are BC1, BC3, BC5, BC6H and BC7 (DDS and KTX2) and the ASTC LDR block sizes (KTX2).
+	 * Files hold a 2D texture or a cube map, read with Texture::LoadCubeMap(); arrays and supercompressed KTX2
+	 * files (Basis Universal, Zstandard) are not supported.
+	 *
+	 * Containers store the top row first and blocks can't be flipped, so images meant for OpenGL's
+	 * bottom-left origin must be exported flipped.
+	 */
+	class TextureContainer
+	{
+	public:
+		/** @return True if the path has a .dds or .ktx2 extension. */
+		static bool IsContainer(std::string_view Path);
+
+		/**
+		 * Reads a container file. Doesn't touch OpenGL, so it can run on any thread.
+		 *
+		 * @param Path The .dds or .ktx2 file.
+		 * @param Image Receives the file contents, the compressed format and the location of every mip level.
+		 * @return False if the file can't be read or holds a layout or format that isn't supported.
+		 */
+		static bool Load(std::string_view Path, ImageData& Image);
+
+		/**
+		 * Parses container contents already in memory, such as an AssetArchive view.
+		 *
+		 * @param Contents The file contents, kept alive by the image as its pixels.
+		 * @param Size The size of the contents in bytes.
+		 * @param Image Receives the compressed format and the location of every mip level.
+		 * @param Name The file name, for error messages.
+		 * @return False if the contents hold a layout or format that isn't supported.
+		 */
+		static bool Parse(std::shared_ptr<unsigned char> Contents, size_t Size, ImageData& Image, std::string_view Name);
+
+		/**
+		 * Checks whether the current context can sample a compressed format.
+		 * The extension list is queried once, on the first call, so a context must be current.
+		 *
+		 * @param Format The compressed internal format.
+		 * @return True if glCompressedTexImage2D accepts the format.
+		 */
+		static bool IsFormatSupported(GLenum Format);
+
+		/**
+		 * Computes the size of one mip level of a compressed format.
+		 *
+		 * @return The size in bytes, 0 if the format is unknown.
+		 */
+		static size_t GetLevelSize(GLenum Format, int Width, int Height);
+
+		/**
+		 * Compresses decoded pixels offline, e.g. by the AssetCooker, with the whole mip chain box-filtered from them.
+		 * Opaque images become BC1, images with any alpha below 255 BC3. Doesn't touch OpenGL.
+		 *
+		 * @param Source The decoded image, 1 to 4 channels of 8 bits.
+		 * @param Compressed Receives the blocks of every level, laid out as a loaded container.
+		 * @return False if the image isn't decoded 8-bit pixels.
+		 */
+		static bool Encode(const ImageData& Source, ImageData& Compressed);
+
+		/**
+		 * Writes a compressed image, as returned by Load() or Encode(), to a KTX2 file without supercompression.
+		 *
+		 * @param Path The .ktx2 file to write, its directory is created if needed.
+		 * @param Image The compressed image and its mip chain.
+		 * @return False if the format has no KTX2 equivalent or the file can't be written.
+		 */
+		static bool SaveKTX2(std::string_view Path, const ImageData& Image);
+
+	private:
+		/** Parses a DDS file (legacy FourCC or DX10 header), reordering cube map levels level by level. */
+		static bool ParseDDS(ImageData& Image, size_t FileSize);
+
+		/** Parses a KTX2 file. */
+		static bool ParseKTX2(ImageData& Image, size_t FileSize);
+
+		/**
+		 * Fills Image.Levels with consecutive mip levels starting at Offset.
+		 * @return False if the levels don't fit in the file.
+		 */
+		static bool AddConsecutiveLevels(ImageData& Image, size_t Offset, size_t LevelCount, size_t FileSize);
+	};
+
+} // namespace fgl
\ No newline at end of file
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+#include <FireGL/Renderer/Texture.h>
+
+namespace fgl
+{
+	class Scene;
+
+	/**
+	 * Streams the mip levels of 2D textures in and out of video memory under a byte budget.
+	 *
+	 * Textures loaded through the streamer start with only their coarsest levels resident (see MinResidentSize).
+	 * Every Update() measures how many pixels each textured object covers on screen, from its world bounding
+	 * sphere and the active camera, and derives the finest mip level worth keeping for every texture.
+	 * A few textures per frame are then re-created with that level as their base (see Texture::UploadMipRange),
+	 * as long as the budget allows it; when it doesn't, the least recently seen textures are dropped back to
+	 * their coarsest levels first.
+	 *
+	 * The decoded image of every texture stays in system memory so levels can be brought back at any time.
+	 * Re-creating a texture changes its OpenGL ID and bindless handle; materials keep the same Texture pointer.
+	 * Must be used on the thread owning the OpenGL context.
+	 */
+	class TextureStreamer
+	{
+	public:
+		static constexpr int MinResidentSize = 64; ///< Largest side, in pixels, of the levels that always stay resident.
+
+		/**
+		 * @param BudgetBytes The video memory the streamed textures may use.
+		 */
+		TextureStreamer(size_t BudgetBytes = 256ull << 20);
+
+		/** Deletes every streamed texture. */
+		~TextureStreamer();
+
+		TextureStreamer(const TextureStreamer&) = delete;
+		TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+		/**
+		 * Decodes an image file and creates its texture with only the coarsest levels resident.
+		 *
+		 * @param Path           The path to the image file, DDS and KTX2 files keep their own mip chain.
+		 * @param FlipVertical   Whether or not to flip the image vertically upon loading.
+		 * @return               The texture to assign to materials, owned by the streamer. nullptr on failure.
+		 */
+		Texture* Load(std::string_view Path, bool FlipVertical = true);
+
+		/**
+		 * Updates the resident mip levels from the objects visible to the active camera of the scene.
+		 * Call once per frame, before rendering.
+		 *
+		 * @param Scene           The scene whose objects use the streamed textures.
+		 * @param ViewportHeight  The height of the viewport in pixels.
+		 */
+		void Update(const Scene& Scene, int ViewportHeight);
+
+		/**
+		 * Sets the video memory the streamed textures may use. Levels over budget are evicted on the next Update().
+		 *
+		 * @param Bytes The budget in bytes.
+		 */
+		void SetBudget(size_t Bytes);
+
+		/** Sets how many textures may be re-created per Update(), to spread the upload cost over frames. */
+		void SetMaxUploadsPerFrame(int Count);
+
+		/** @return The video memory currently used by the streamed textures, in bytes. */
+		size_t GetResidentBytes() const;
+
+		/** @return The budget in bytes. */
+		size_t GetBudget() const;
+
+	private:
+		/** A texture of the streamer and the levels it holds. */
+		struct StreamedTexture
+		{
+			std::unique_ptr<Texture> Handle; ///< Kept at a stable address, materials point to it.
+			ImageData Image;                 ///< The full resolution image, or the whole compressed chain.
+			int LevelCount = 0;              ///< Number of levels of the full mip chain.
+			int ResidentLevel = 0;           ///< Finest level currently allocated.
+			int DesiredLevel = 0;            ///< Finest level requested by the last Update().
+			uint64_t LastUsedFrame = 0;      ///< Last frame an object using the texture was on screen.
+			size_t ResidentBytes = 0;        ///< Video memory used by the allocated levels.
+		};
+
+		/** @return The finest level of a texture that is always kept resident. */
+		static int GetCoarsestLevel(const StreamedTexture& Streamed);
+
+		/** @return The video memory used by a texture whose finest allocated level is the given one. */
+		static size_t GetLevelBytes(const StreamedTexture& Streamed, int Level);
+
+		/** @return The pixels of an uncompressed image reduced to the given mip level by a box filter. */
+		static ImageData Downsample(const ImageData& Image, int Level);
+
+		/** Re-creates a texture with the given level as its finest one and updates the byte count. */
+		void MakeResident(StreamedTexture& Streamed, int Level);
+
+		std::vector<StreamedTexture> m_Textures;                 ///< Every streamed texture, in load order.
+		std::unordered_map<const Texture*, size_t> m_TextureIndices; ///< Index of every streamed texture in m_Textures.
+		size_t m_Budget;                                          ///< Video memory the streamed textures may use.
+		size_t m_ResidentBytes = 0;                               ///< Video memory currently used.
+		int m_MaxUploadsPerFrame = 4;                             ///< Textures re-created per Update() at most.
+		uint64_t m_Frame = 0;                                     ///< Number of Update() calls so far.
+	};
+
+} // namespace fgl
\ No newline at end of file
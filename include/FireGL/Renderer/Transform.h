@@ -2,6 +2,10 @@
 
 #include <External/glm/glm.hpp>
 #include <External/glm/gtc/matrix_transform.hpp>
+#include <External/glm/gtc/quaternion.hpp>
+
+#include <cstdint>
+#include <memory>
 
 namespace fgl
 {
@@ -12,6 +16,12 @@ namespace fgl
      * Represents the position, rotation, and scale of an object in 3D space.
      * This class handles transformations and calculates matrices for rendering in OpenGL.
      * It operates within a right-handed coordinate system by default.
+     *
+     * The data itself lives in the TransformPool; a Transform is a handle to its slot there, so existing
+     * GetTransform().SetPosition() code keeps working while the renderer sweeps every matrix at once.
+     *
+     * A Transform can be parented to another one with SetParent(): its position, rotation and scale are then
+     * relative to the parent, and the Model matrix follows the parent without any per-tick update.
      */    
     class Transform
     {
@@ -30,8 +40,14 @@ namespace fgl
          */
         Transform(SceneObject* Owner);
 
+        /** Releases the slot of this transform in the TransformPool. */
+        ~Transform();
+
+        Transform(const Transform&) = delete;
+        Transform& operator=(const Transform&) = delete;
+
         /**
-         * Sets the position of the transform in world space.
+         * Sets the position of the transform, relative to its parent (in world space without one).
          *
          * @param X The X-coordinate of the new position.
          * @param Y The Y-coordinate of the new position.
@@ -100,6 +116,23 @@ namespace fgl
         /** @return The current rotation as a glm::vec3. */
         const glm::vec3& GetRotation() const;
 
+        /**
+         * Sets the rotation from a quaternion. The Euler angles returned by GetRotation() are derived from it.
+         *
+         * @param NewOrientation The new orientation, normalized by the transform.
+         */
+        void SetOrientation(const glm::quat& NewOrientation);
+
+        /**
+         * Rotates the transform by a quaternion, applied in local space after the current rotation.
+         *
+         * @param RotationOffset The rotation offset.
+         */
+        void RotateBy(const glm::quat& RotationOffset);
+
+        /** @return The current rotation as a unit quaternion, the Model matrix is composed from it. */
+        const glm::quat& GetOrientation() const;
+
         /**
          * Sets the scale of the transform.
          *
@@ -145,6 +178,19 @@ namespace fgl
         /** @return The current scale as a glm::vec3. */
         const glm::vec3& GetScale() const;
 
+        /**
+         * Parents this transform to another one, e.g. a weapon to a character or a wheel to a vehicle.
+         * The local values are kept and become relative to the parent. Not thread-safe: don't call it from
+         * a Tick() run on the job system.
+         *
+         * @param Parent The new parent, nullptr to detach this transform.
+         * @return False if Parent is this transform or one of its descendants, nothing changes then.
+         */
+        bool SetParent(Transform* Parent);
+
+        /** @return True if this transform has a parent. */
+        bool HasParent() const;
+
         /**
          * Calculates the Model-View-Projection matrix and Model matrix for rendering.
          *
@@ -153,12 +199,58 @@ namespace fgl
          */        
         void ComputeModelViewProjection(glm::mat4& OutModelViewProjection, glm::mat4& OutModelMatrix);
 
-    private:
         /**
-         * Recalculates the Model matrix based on the current position, rotation, and scale.
-         * Updates the cached Model matrix and clears the dirty flag.
+         * Composes the local translate * rotate * scale matrix from the current values, ignoring the parent
+         * and the cache. Usable on a const transform.
+         *
+         * @return The local matrix.
          */
-        void RecalculateModelMatrix();
+        glm::mat4 ComputeLocalMatrix() const;
+
+        /**
+         * Retrieves the Model matrix, recalculating it first if the transform or one of its parents changed.
+         *
+         * @return The up-to-date Model matrix, in world space.
+         */
+        const glm::mat4& GetModelMatrix();
+
+        /**
+         * Retrieves the normal matrix, transpose(inverse(mat3(Model))), recalculating it first if the
+         * transform changed. Computed on the CPU once per change instead of per vertex in the shaders.
+         *
+         * @return The up-to-date normal matrix.
+         */
+        const glm::mat3& GetNormalMatrix();
+
+        /** @return True if the transform, or one of its parents, changed since the Model matrix was last calculated. */
+        bool IsDirty() const;
+
+        /**
+         * Retrieves the revision of the cached Model matrix.
+         * The revision is incremented every time the Model matrix is recalculated, which lets
+         * the renderer tell whether the data it uploaded for this transform is still current.
+         *
+         * @return The current Model matrix revision.
+         */
+        uint64_t GetRevision() const;
+
+        /**
+         * Retrieves the Model matrix the renderer draws: the captured one while TransformPool holds a render
+         * snapshot, which the simulation of the next frame doesn't touch, otherwise GetModelMatrix().
+         *
+         * @return The Model matrix of the frame being rendered.
+         */
+        const glm::mat4& GetRenderModelMatrix();
+
+        /** @return The normal matrix of the frame being rendered, see GetRenderModelMatrix(). */
+        const glm::mat3& GetRenderNormalMatrix();
+
+        /** @return The Model matrix revision of the frame being rendered, see GetRenderModelMatrix(). */
+        uint64_t GetRenderRevision() const;
+
+    private:
+        /** Flags the Model matrix for recalculation and tells the owner the first time it changes. */
+        void MarkDirty();
 
         /**
          * Applies the cached Model matrix to compute the Model-View-Projection matrix.
@@ -170,13 +262,7 @@ namespace fgl
         void ApplyCachedModelMatrix(glm::mat4& OutModelViewProjection, glm::mat4& OutModelMatrix, std::shared_ptr<BaseCamera>& Camera);
 
     private:
-        glm::vec3 m_Position;          ///< Position in world space.
-        glm::vec3 m_Rotation;          ///< Rotation in degrees (Pitch, Yaw, Roll).
-        glm::vec3 m_Scale;             ///< Scale factors along each axis.
-
-        bool m_Dirty;                  ///< Indicates whether the model matrix needs to be recalculated.
-        glm::mat4 m_CachedModelMatrix; ///< Cached model matrix to avoid redundant calculations.
-        SceneObject* m_Owner;          ///< The SceneObject that owns this transform.
+        uint32_t m_Handle;             ///< Slot of this transform in the TransformPool.
     };
 
 } // namespace fgl
\ No newline at end of file
@@ -0,0 +1,207 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+
+#include <External/glm/glm.hpp>
+#include <External/glm/gtc/quaternion.hpp>
+
+#include <atomic>
+#include <mutex>
+
+namespace fgl
+{
+	class SceneObject;
+	class JobSystem;
+
+	/**
+	 * Contiguous storage of every Transform, in structure-of-arrays layout.
+	 *
+	 * A Transform only holds a handle: an index into the arrays below, allocated when it is constructed and
+	 * released when it is destroyed. Positions, rotations, scales, the cached matrices and the dirty flags of
+	 * all transforms are therefore packed together, so UpdateDirtyMatrices() recalculates every changed
+	 * matrix in one linear sweep instead of chasing each object on the heap.
+	 *
+	 * Transforms can be parented. The cached Model matrix is then the world matrix, parent's world times
+	 * the local TRS, and each slot remembers the revision of its parent it was computed from: a child is
+	 * out of date when the parent was recalculated since. The sweep visits the slots in a level-sorted
+	 * order, roots first, so every parent is up to date before its children are checked, and each level
+	 * can be split across jobs. When no transform changed since the last sweep it returns immediately,
+	 * static hierarchies cost nothing per frame.
+	 *
+	 * References returned by Transform getters point into these arrays and stay valid until the next
+	 * Transform is constructed. Handles are reused once released.
+	 *
+	 * With a fixed timestep (see TimeManager::SetFixedTimeStep()) the matrices are the rendered state: the
+	 * transforms changed during the last step are composed between their values before and after it, by the
+	 * interpolation alpha. The getters of the local values still return the simulated state.
+	 */
+	class TransformPool
+	{
+	public:
+		static constexpr uint32_t NullHandle = UINT32_MAX; ///< Parent of the root transforms.
+
+		/**
+		 * Allocates the slot of a new transform, set to the identity.
+		 *
+		 * @param Owner The SceneObject owning the transform, nullptr if none (cameras).
+		 * @return The handle of the slot.
+		 */
+		static uint32_t Allocate(SceneObject* Owner);
+
+		/**
+		 * Releases the slot of a destroyed transform so it can be reused.
+		 * Its children become roots, their local values are then read in world space. No owner is notified,
+		 * they may be destroyed along with it.
+		 *
+		 * @param Handle The handle returned by Allocate().
+		 */
+		static void Free(uint32_t Handle);
+
+		/**
+		 * Parents a transform to another one.
+		 * The local values of the child are kept and become relative to the parent.
+		 *
+		 * @param Handle The transform to parent.
+		 * @param Parent The new parent, NullHandle to detach the transform.
+		 * @return False if the parent is the transform itself or one of its descendants, nothing changes then.
+		 */
+		static bool SetParent(uint32_t Handle, uint32_t Parent);
+
+		/**
+		 * Recalculates the world and normal matrices of every dirty transform and of their descendants.
+		 * Called by the renderer once the scene was processed; getters recalculate on demand otherwise.
+		 * The owners of children moved by their parent are notified like if they had changed themselves.
+		 *
+		 * @param Jobs Job system the levels are split on, nullptr to run the sweep on the calling thread.
+		 * @param ChunkSize The number of slots swept per job.
+		 */
+		static void UpdateDirtyMatrices(JobSystem* Jobs = nullptr, size_t ChunkSize = 4096);
+
+		/**
+		 * Enables or disables the interpolation of the rendered matrices between fixed steps.
+		 * Disabling it snaps the interpolated transforms to their current state.
+		 */
+		static void SetInterpolation(bool bEnabled);
+
+		/**
+		 * Starts a fixed step: the state of the transforms changed during the previous step becomes the state
+		 * they are interpolated from. Called by Scene::Process() before every step.
+		 */
+		static void BeginFixedStep();
+
+		/**
+		 * Sets how far the rendered matrices are between the last two steps, and flags the interpolated
+		 * transforms for recalculation. Called by Scene::Process() after the frame's steps.
+		 *
+		 * @param Alpha 0 for the state before the last step, 1 for the current state.
+		 */
+		static void SetInterpolationAlpha(float Alpha);
+
+		/** @return The number of slots, released ones included. */
+		static size_t GetSize();
+
+		/**
+		 * Copies the world matrices, normal matrices and revisions of every slot into the render snapshot.
+		 * Called by Renderer::PrepareFrame() after the sweep: until the snapshot is discarded, the render
+		 * getters of Transform read it, so the next frame can be simulated while this one is submitted.
+		 */
+		static void CaptureSnapshot();
+
+		/** Stops reading the snapshot, the render getters of Transform read the live matrices again. */
+		static void DiscardSnapshot();
+
+		/** @return True while a snapshot is captured. */
+		static bool HasSnapshot();
+
+	private:
+		friend class Transform;
+
+		/** @return True if the slot changed, or its parent was recalculated, since its matrices were computed. */
+		static bool IsOutOfDate(uint32_t Handle);
+
+		/** @return True if the slot or one of its ancestors is out of date. */
+		static bool IsStale(uint32_t Handle);
+
+		/**
+		 * Sets the rotation of a slot from Euler angles, updating its orientation quaternion.
+		 *
+		 * @param Handle The slot to rotate.
+		 * @param Degrees The rotation in degrees (Pitch, Yaw, Roll), applied as X then Y then Z.
+		 */
+		static void SetEulerRotation(uint32_t Handle, const glm::vec3& Degrees);
+
+		/**
+		 * Sets the orientation of a slot, updating its Euler angles.
+		 *
+		 * @param Handle The slot to rotate.
+		 * @param Orientation The new orientation, normalized here.
+		 */
+		static void SetOrientation(uint32_t Handle, const glm::quat& Orientation);
+
+		/**
+		 * Composes the local TRS matrix of a slot straight from its orientation, without any matrix product.
+		 *
+		 * @param Handle The slot to compose.
+		 * @return translate * rotate * scale, as an affine matrix.
+		 */
+		static glm::mat4 ComposeLocalMatrix(uint32_t Handle);
+
+		/** @return translate * rotate * scale of the given values, as an affine matrix. */
+		static glm::mat4 ComposeMatrix(const glm::vec3& Position, const glm::quat& Orientation, const glm::vec3& Scale);
+
+		/**
+		 * Lists a slot whose local values just changed for interpolation, unless it already is or was never
+		 * rendered. Called by Transform setters, possibly from parallel ticks.
+		 */
+		static void TrackMotion(uint32_t Handle);
+
+		/** Flags a slot whose rendered matrix changes with the interpolation, notifying its owner like a move. */
+		static void FlagRecalculation(uint32_t Handle);
+
+		/** Brings the slot's matrices up to date, its ancestors first. */
+		static void Resolve(uint32_t Handle);
+
+		/**
+		 * Recalculates the cached matrices of a slot from its parent's world matrix, clears its dirty flag and
+		 * bumps its revision. Notifies the owner when the slot only moved with its parent.
+		 */
+		static void RecalculateModelMatrix(uint32_t Handle);
+
+		/** Sorts the slots by their depth in the hierarchy into s_LevelOrder. */
+		static void RebuildLevelOrder();
+
+		static std::vector<glm::vec3> s_Positions;      ///< Position relative to the parent, in world space for roots.
+		static std::vector<glm::vec3> s_Rotations;      ///< Rotation in degrees (Pitch, Yaw, Roll), as last set.
+		static std::vector<glm::quat> s_Orientations;   ///< Rotation the matrices are composed from, matching s_Rotations.
+		static std::vector<glm::vec3> s_Scales;         ///< Scale factors along each axis.
+		static std::vector<glm::mat4> s_ModelMatrices;  ///< Cached world matrices.
+		static std::vector<glm::mat3> s_NormalMatrices; ///< Cached normal matrices, matching s_ModelMatrices.
+		static std::vector<uint8_t> s_Dirty;            ///< Non-zero if the local values changed since the last recalculation.
+		static std::vector<uint64_t> s_Revisions;       ///< Incremented each time the cached world matrix is recalculated.
+		static std::vector<SceneObject*> s_Owners;      ///< The SceneObject owning each transform.
+		static std::vector<uint32_t> s_Parents;         ///< Parent of each transform, NullHandle for roots.
+		static std::vector<uint64_t> s_ParentRevisions; ///< Revision of the parent the cached world matrix was computed from.
+		static std::vector<uint32_t> s_ChildCounts;     ///< Number of direct children of each transform.
+		static std::vector<uint32_t> s_FreeHandles;     ///< Released slots, reused by Allocate().
+
+		static std::vector<glm::vec3> s_PreviousPositions;    ///< Position before the last step, equal to s_Positions unless interpolated.
+		static std::vector<glm::quat> s_PreviousOrientations; ///< Orientation before the last step.
+		static std::vector<glm::vec3> s_PreviousScales;       ///< Scale before the last step.
+		static std::vector<uint8_t> s_Interpolated;           ///< Non-zero if the slot is in s_InterpolatedHandles.
+		static std::vector<uint32_t> s_InterpolatedHandles;   ///< Slots changed since the last BeginFixedStep(), may hold released slots.
+		static std::mutex s_InterpolatedMutex;                ///< Guards s_InterpolatedHandles during parallel ticks.
+		static bool s_bInterpolation;                         ///< True with a fixed timestep.
+		static float s_InterpolationAlpha;                    ///< Blend of the interpolated slots, 1 for their current state.
+
+		static std::vector<glm::mat4> s_SnapshotModelMatrices;  ///< World matrices as of the last CaptureSnapshot().
+		static std::vector<glm::mat3> s_SnapshotNormalMatrices; ///< Normal matrices as of the last CaptureSnapshot().
+		static std::vector<uint64_t> s_SnapshotRevisions;       ///< Revisions as of the last CaptureSnapshot().
+		static bool s_bSnapshot;                                ///< True between CaptureSnapshot() and DiscardSnapshot().
+
+		static std::vector<uint32_t> s_LevelOrder;      ///< Every slot, sorted by depth in the hierarchy.
+		static std::vector<size_t> s_LevelStarts;       ///< First entry of each depth in s_LevelOrder, plus the end.
+		static bool s_bLevelOrderDirty;                 ///< True if the hierarchy changed since s_LevelOrder was built.
+		static std::atomic<bool> s_bChanged;            ///< True if any transform changed since the last sweep.
+	};
+
+} // namespace fgl
\ No newline at end of file
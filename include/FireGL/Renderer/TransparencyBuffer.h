@@ -0,0 +1,91 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+
+#include <External/glad/glad.h>
+
+namespace fgl
+{
+	class Shader;
+
+	/**
+	 * Render targets of weighted blended order-independent transparency, and the pass compositing them over
+	 * the opaque image.
+	 *
+	 * Transparent surfaces are accumulated in any order instead of being sorted and blended back to front.
+	 * Their shaders write:
+	 *
+	 *     layout (location = 0) out vec4 Accumulation;  // GL_RGBA16F: vec4(Color.rgb * Color.a, Color.a) * Weight, summed
+	 *     layout (location = 1) out float Revealage;    // GL_R16F: Color.a, the target keeps the product of (1 - Color.a)
+	 *
+	 * with a weight falling off with depth so closer surfaces dominate, for instance
+	 * clamp(pow(min(1.0, Color.a * 10.0) + 0.01, 3.0) * 1e8 * pow(1.0 - gl_FragCoord.z * 0.9, 3.0), 1e-2, 3e3).
+	 * The surfaces are depth tested against a copy of the opaque depth without writing it. Composite() then
+	 * blends the weighted average color over the output, with the coverage 1 - Revealage. The result
+	 * approximates the sorted blend: exact for surfaces of equal color, close when alpha is low, as for
+	 * particles and foliage, and free of the per-object sort.
+	 */
+	class TransparencyBuffer
+	{
+	public:
+		static constexpr uint32_t AccumulationUnit = 0; ///< Texture unit of the accumulation attachment during Composite().
+		static constexpr uint32_t RevealageUnit = 1;    ///< Texture unit of the revealage attachment during Composite().
+
+		/** Releases the framebuffer, its attachments and the composite shader. */
+		~TransparencyBuffer();
+
+		/**
+		 * (Re)creates the attachments if the size changed. Requires a current OpenGL context.
+		 *
+		 * @param Width    The width of the render targets in pixels.
+		 * @param Height   The height of the render targets in pixels.
+		 */
+		void Resize(int Width, int Height);
+
+		/** Deletes the framebuffer, its attachments, the composite shader and the full-screen vertex array. */
+		void Destroy();
+
+		/**
+		 * Copies the depth of the output, then binds and clears the accumulation targets, enables their blending
+		 * and disables depth writes. The viewport is set to the targets.
+		 *
+		 * @param Framebuffer The framebuffer holding the opaque image, the default framebuffer if 0. Its depth
+		 *                    attachment must be GL_DEPTH24_STENCIL8, as RenderTarget's.
+		 * @param X           Left edge of the region of Framebuffer the targets cover.
+		 * @param Y           Bottom edge of the region of Framebuffer the targets cover.
+		 */
+		void BeginAccumulation(GLuint Framebuffer, int X, int Y);
+
+		/**
+		 * Blends the accumulated surfaces over the framebuffer given to BeginAccumulation(), restores its viewport,
+		 * disables blending and restores the default depth test and writes. Compiles the shader on first use.
+		 */
+		void Composite();
+
+		/** @return The width of the render targets in pixels. */
+		int GetWidth() const;
+
+		/** @return The height of the render targets in pixels. */
+		int GetHeight() const;
+
+	private:
+		/** Creates a 2D attachment texture of the current size. */
+		GLuint CreateAttachment(GLenum InternalFormat, GLenum Format, GLenum Type) const;
+
+		/** Deletes the framebuffer and its attachments, keeping the shader and the vertex array. */
+		void DestroyTargets();
+
+		GLuint m_Framebuffer = 0;                  ///< Framebuffer of the accumulation pass.
+		GLuint m_Accumulation = 0;                 ///< Color attachment 0.
+		GLuint m_Revealage = 0;                    ///< Color attachment 1.
+		GLuint m_Depth = 0;                        ///< Depth attachment, a copy of the output's.
+		GLuint m_FullScreenVertexArray = 0;        ///< Empty vertex array, the full-screen triangle is generated from gl_VertexID.
+		std::unique_ptr<Shader> m_CompositeShader; ///< Full-screen composite pass, compiled on first use.
+		GLuint m_Output = 0;                       ///< Framebuffer of the last BeginAccumulation().
+		int m_OutputX = 0;                         ///< Left edge of the covered region of m_Output.
+		int m_OutputY = 0;                         ///< Bottom edge of the covered region of m_Output.
+		int m_Width = 0;                           ///< Width of the attachments.
+		int m_Height = 0;                          ///< Height of the attachments.
+	};
+
+} // namespace fgl
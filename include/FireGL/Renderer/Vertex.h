@@ -3,6 +3,8 @@
 #include "External/glm/vec2.hpp"
 #include "External/glm/vec3.hpp"
 
+#include <cstdint>
+
 namespace fgl
 {
 
@@ -18,4 +20,62 @@ namespace fgl
 		glm::vec2 TexCoords;
 	};
 
+	/**
+	 * @brief Compact vertex layout used by meshes loaded with VertexFormat::Packed (16 bytes).
+	 *
+	 * Every component is decoded by the vertex fetch into the same shader inputs as fgl::Vertex,
+	 * so shaders work with both layouts unchanged.
+	 */
+	struct PackedVertex
+	{
+		uint16_t Position[4];  ///< Half-float x, y, z (w is padding keeping the normal 4-byte aligned).
+		uint32_t Normal;       ///< Signed normalized 10:10:10:2 x, y, z (GL_INT_2_10_10_10_REV).
+		uint16_t TexCoords[2]; ///< Half-float u, v.
+	};
+
+	static_assert(sizeof(PackedVertex) == 16, "PackedVertex must stay tightly packed");
+
+	/**
+	 * @brief Bones influencing one vertex of a skinned mesh, stored alongside its fgl::Vertex.
+	 *
+	 * Indices are relative to the mesh's Skeleton, weights are normalized bytes summing to 255.
+	 * A vertex without any weight is not skinned.
+	 */
+	struct VertexSkin
+	{
+		uint16_t BoneIndices[4] = {}; ///< Bones of the skeleton, unused slots are 0.
+		uint8_t BoneWeights[4] = {};  ///< Unsigned normalized weights, unused slots are 0.
+	};
+
+	/**
+	 * @brief Vertex layout used by meshes loaded with VertexFormat::Skinned (44 bytes).
+	 *
+	 * fgl::Vertex followed by its VertexSkin, read as a uvec4 of bone indices and a vec4 of weights.
+	 */
+	struct SkinnedVertex
+	{
+		glm::vec3 Position;
+		glm::vec3 Normal;
+		glm::vec2 TexCoords;
+		uint16_t BoneIndices[4]; ///< Bones of the skeleton.
+		uint8_t BoneWeights[4];  ///< Unsigned normalized weights.
+	};
+
+	static_assert(sizeof(SkinnedVertex) == 44, "SkinnedVertex must stay tightly packed");
+
+	/**
+	 * @brief Vertex layout used by meshes loaded with VertexFormat::Lightmapped (40 bytes).
+	 *
+	 * fgl::Vertex followed by the coordinates of its second UV set, which addresses the object's lightmap.
+	 */
+	struct LightmappedVertex
+	{
+		glm::vec3 Position;
+		glm::vec3 Normal;
+		glm::vec2 TexCoords;
+		glm::vec2 LightmapCoords; ///< Unique coordinates of the vertex in [0, 1], placed in the atlas by the instance's lightmap region.
+	};
+
+	static_assert(sizeof(LightmappedVertex) == 40, "LightmappedVertex must stay tightly packed");
+
 } // namespace fgl
\ No newline at end of file
@@ -0,0 +1,262 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+#include <FireGL/Core/AssetArchive.h>
+#include <FireGL/Core/JobSystem.h>
+#include <FireGL/Core/MappedFile.h>
+#include <FireGL/Core/MemoryTracker.h>
+#include <FireGL/Renderer/RenderTarget.h>
+#include <FireGL/Renderer/FrameReadback.h>
+
+#include <External/glad/glad.h>
+
+namespace fgl
+{
+	class Shader;
+
+	/** Layout of a page file written by VirtualTexture::BuildPageFile(). */
+	struct VirtualTextureBuildSettings
+	{
+		int PageSize = 128;                                              ///< Texels per page edge, without the border.
+		int Border = 4;                                                  ///< Texels repeated from the neighbour pages around each page, for bilinear filtering.
+		AssetArchive::Compression Compression = AssetArchive::Compression::None; ///< How pages are stored, those it doesn't shrink are stored as is.
+	};
+
+	/** Cache, streaming and feedback of a VirtualTexture. */
+	struct VirtualTextureSettings
+	{
+		int CachePages = 16;         ///< Pages per edge of the physical cache, 256 at most: the texture's whole video memory.
+		int UploadsPerFrame = 8;     ///< Pages loaded and uploaded per Update(), at most.
+		int FeedbackDivisor = 8;     ///< The feedback pass renders at the viewport size divided by this.
+		bool bSparseCache = true;    ///< Back the cache with ARB_sparse_texture when available, committing slots as they fill.
+		JobSystem* Jobs = nullptr;   ///< Reads and decompresses the pages, nullptr to load them in Update().
+	};
+
+	/**
+	 * Texture of any size with a fixed video memory cost, streamed by pages the frame actually samples.
+	 *
+	 * A page file holds the mip chain of the source image cut into square pages of PageSize texels plus a
+	 * border, each stored as is or compressed. Only a cache of CachePages x CachePages pages lives in video
+	 * memory; an indirection texture, one texel per page of every level, tells shaders which cache slot holds
+	 * a page, or holds the nearest coarser resident page while it streams in. The single page of the coarsest
+	 * level is loaded by Open() and never evicted, so every lookup resolves to something.
+	 *
+	 * Which pages are needed is measured on the GPU: a feedback pass draws the textured geometry again into a
+	 * small target, writing the page and level each pixel samples (see GetShaderCode()). The target is read
+	 * back asynchronously with a FrameReadback, and Update() loads the missing pages, coarsest first, evicting
+	 * the least recently seen ones when the cache is full. Pages are read from the mapped file and decompressed
+	 * on the JobSystem when one is set, then uploaded UploadsPerFrame at a time.
+	 *
+	 * When the context has ARB_sparse_texture, the cache is a sparse texture whose memory is committed as
+	 * slots first fill, so a large cache only costs the pages used so far.
+	 *
+	 * Page file layout (native endianness): a header {Magic, Version, Width, Height, PageSize, Border,
+	 * LevelCount, PageCount}, the pages {Offset, StoredSize, Compression} level by level from the finest,
+	 * each row by row along X, then the stored RGBA8 pages of (PageSize + 2 * Border)^2 texels, bottom row first.
+	 *
+	 * Every call must run on the thread owning the OpenGL context, except BuildPageFile().
+	 */
+	class VirtualTexture
+	{
+	public:
+		static constexpr uint32_t Magic = 0x54564746;         ///< "FGVT", identifies a FireGL page file.
+		static constexpr uint32_t Version = 1;                ///< Bumped whenever the layout changes.
+		static constexpr const char* Extension = ".fglvt";    ///< Conventional extension of page files.
+		static constexpr int MaxCachePages = 256;             ///< Slots per cache edge the 8-bit indirection entries address.
+
+		/**
+		 * Cuts an image into a page file, offline or at load. The image and its mip chain are held in memory meanwhile.
+		 *
+		 * @param ImagePath The source image, any format Texture::DecodeImage() reads except compressed containers.
+		 * @param PageFilePath The page file to write.
+		 * @param Settings Page size, border and compression.
+		 * @return False if the image couldn't be decoded, the compression isn't compiled in or the file couldn't be written.
+		 */
+		static bool BuildPageFile(std::string_view ImagePath, std::string_view PageFilePath, const VirtualTextureBuildSettings& Settings = VirtualTextureBuildSettings());
+
+		/**
+		 * The GLSL declarations sampling a virtual texture, to paste after the #version line of a fragment shader:
+		 * - vec4 SampleVirtual(vec2 UV) samples the texture from its resident pages.
+		 * - vec4 VirtualFeedback(vec2 UV) is the color the feedback pass writes for a sample.
+		 * Apply() sets their uniforms.
+		 */
+		static std::string_view GetShaderCode();
+
+		VirtualTexture() = default;
+
+		/** Deletes the cache, indirection and feedback textures. */
+		~VirtualTexture();
+
+		VirtualTexture(const VirtualTexture&) = delete;
+		VirtualTexture& operator=(const VirtualTexture&) = delete;
+
+		/**
+		 * Maps a page file, creates the cache and loads the coarsest page. Requires a current OpenGL 4.0 context.
+		 *
+		 * @param PageFilePath The page file written by BuildPageFile().
+		 * @param Settings Cache, streaming and feedback settings.
+		 * @return False if the file couldn't be mapped or isn't a valid page file.
+		 */
+		bool Open(std::string_view PageFilePath, const VirtualTextureSettings& Settings = VirtualTextureSettings());
+
+		/** Waits for the loads in flight, then deletes the textures and unmaps the file. */
+		void Close();
+
+		/** @return True once Open() succeeded. */
+		bool IsOpen() const;
+
+		/**
+		 * Reads the finished feedback frames, uploads the pages loaded since the last call and starts loading the
+		 * next missing ones. Call once per frame, before rendering.
+		 */
+		void Update();
+
+		/**
+		 * Binds the cache and indirection textures and sets the uniforms of GetShaderCode() on an active shader.
+		 *
+		 * @param Target The active shader including GetShaderCode().
+		 * @param CacheUnit The texture unit of the cache.
+		 * @param IndirectionUnit The texture unit of the indirection texture.
+		 */
+		void Apply(const Shader& Target, GLint CacheUnit, GLint IndirectionUnit) const;
+
+		/**
+		 * Binds and clears the feedback target, sized from the current viewport. Draws until EndFeedback() should
+		 * write VirtualFeedback() with depth testing on; the framebuffer and viewport are restored by EndFeedback().
+		 */
+		void BeginFeedback();
+
+		/** Queues the readback of the feedback target, then rebinds the previous framebuffer and viewport. */
+		void EndFeedback();
+
+		/** @return The width of the finest level in texels. */
+		int GetWidth() const;
+
+		/** @return The height of the finest level in texels. */
+		int GetHeight() const;
+
+		/** @return The number of pages in the cache. */
+		uint32_t GetResidentCount() const;
+
+		/** @return The number of missing pages the last feedback asked for. */
+		uint32_t GetRequestedCount() const;
+
+		/** @return True if the cache is a sparse texture. */
+		bool IsSparse() const;
+
+	private:
+		struct FileHeader
+		{
+			uint32_t Magic;
+			uint32_t Version;
+			uint32_t Width;
+			uint32_t Height;
+			uint32_t PageSize;
+			uint32_t Border;
+			uint32_t LevelCount;
+			uint32_t PageCount;
+		};
+
+		struct FilePage
+		{
+			uint64_t Offset;
+			uint32_t StoredSize;
+			uint32_t Compression;
+		};
+
+		/** Pages of one mip level. */
+		struct Level
+		{
+			uint32_t FirstPage = 0; ///< Index of the level's first page in the file.
+			int PagesX = 0;         ///< Pages along X.
+			int PagesY = 0;         ///< Pages along Y.
+		};
+
+		/** One page-sized region of the cache. */
+		struct Slot
+		{
+			uint32_t Page = InvalidPage; ///< Page held, InvalidPage if free.
+			uint64_t LastUsed = 0;       ///< Last Update() the feedback saw the page.
+			bool bPinned = false;        ///< Never evicted, the coarsest page.
+			bool bCommitted = false;     ///< Backed by memory, always true unless sparse.
+		};
+
+		/** A page read on a worker, uploaded by the next Update() once every load of the batch finished. */
+		struct PageLoad
+		{
+			uint32_t Page = 0;                                 ///< Page read.
+			TaggedVector<uint8_t, MemoryTag::Textures> Texels; ///< The page and its border, RGBA8.
+			bool bLoaded = false;                              ///< False if the page couldn't be decompressed.
+		};
+
+		static constexpr uint32_t InvalidPage = std::numeric_limits<uint32_t>::max();
+
+		/** @return The page count of a level, whose pages each cover PageSize << Level texels of the finest one. */
+		static std::pair<int, int> GetLevelPages(int Width, int Height, int PageSize, int Level);
+
+		/** @return The number of levels down to a single page. */
+		static int GetLevelCount(int Width, int Height, int PageSize);
+
+		/** Reads and decompresses a page, from any thread. */
+		void LoadPage(PageLoad& Load) const;
+
+		/** Adds the pages a feedback frame sampled to m_Requests and marks the resident ones as used. */
+		void ReadFeedback(const ReadbackFrame& Frame);
+
+		/** Requests a page and its missing coarser ancestors, keeping the resident ones. */
+		void RequestPage(uint32_t Page);
+
+		/** Copies a loaded page into a free or evicted cache slot. @return False if every slot is in use this frame. */
+		bool MakeResident(const PageLoad& Load);
+
+		/** @return A free slot, or the least recently used evictable one, -1 if none. */
+		int32_t FindSlot() const;
+
+		/** Commits the sparse pages under a slot. */
+		void CommitSlot(int32_t SlotIndex);
+
+		/** Rewrites the indirection entries of a page and the finer ones it covers, then marks them for upload. */
+		void RefreshIndirection(uint32_t Page);
+
+		/** Uploads the rows of the indirection levels RefreshIndirection() changed. */
+		void UploadIndirection();
+
+		/** Finds the level, X and Y of a page. */
+		void DecodePage(uint32_t Page, int& LevelIndex, int& X, int& Y) const;
+
+		VirtualTextureSettings m_Settings;            ///< Cache, streaming and feedback settings.
+		MappedFile m_File;                            ///< The page file.
+		const FilePage* m_Pages = nullptr;            ///< Page table inside the mapping.
+		int m_Width = 0;                              ///< Texels along X of the finest level.
+		int m_Height = 0;                             ///< Texels along Y of the finest level.
+		int m_PageSize = 0;                           ///< Texels per page edge, without the border.
+		int m_Border = 0;                             ///< Border texels around a page.
+		std::vector<Level> m_Levels;                  ///< Levels from the finest.
+		std::vector<int32_t> m_PageSlots;             ///< Cache slot of every page, -1 if not resident.
+		std::vector<uint64_t> m_RequestFrames;        ///< Last Update() every page was requested or seen, to skip duplicates.
+		std::vector<Slot> m_Slots;                    ///< Cache slots, row by row.
+		std::vector<std::vector<uint32_t>> m_Indirection; ///< RGBA8 entries of every level: cache X, cache Y, resident level, valid.
+		std::vector<std::pair<int, int>> m_DirtyRows; ///< Rows of every level to upload, empty if MinRow > MaxRow.
+		std::vector<uint32_t> m_Requests;             ///< Missing pages the last feedback asked for.
+		uint64_t m_FeedbackFrame = 0;                 ///< Update() whose feedback m_Requests holds.
+		std::vector<PageLoad> m_Loads;                ///< Batch of pages being read.
+		JobCounter m_LoadCounter;                     ///< Reads of m_Loads in flight.
+		uint32_t m_ResidentCount = 0;                 ///< Slots holding a page.
+		uint64_t m_Frame = 0;                         ///< Number of Update() calls so far.
+		GLuint m_Cache = 0;                           ///< CachePages x CachePages slots of RGBA8 texels.
+		GLuint m_IndirectionTexture = 0;              ///< RGBA8UI, one texel per page, one mip per level.
+		int m_CacheTexels = 0;                        ///< Texels per edge of the cache.
+		bool m_bSparse = false;                       ///< The cache is a sparse texture.
+		int m_SparsePageX = 0;                        ///< Width of a sparse page of the cache.
+		int m_SparsePageY = 0;                        ///< Height of a sparse page of the cache.
+		std::vector<bool> m_CommittedPages;           ///< Committed sparse pages of the cache, row by row.
+		uint64_t m_CommittedBytes = 0;                ///< Video memory committed to the sparse cache.
+		RenderTarget m_FeedbackTarget;                ///< Page, level and validity of every feedback pixel.
+		std::unique_ptr<FrameReadback> m_Readback;    ///< Reads the feedback target back without stalling.
+		GLint m_SavedDrawFramebuffer = 0;             ///< Draw framebuffer bound before BeginFeedback().
+		GLint m_SavedReadFramebuffer = 0;             ///< Read framebuffer bound before BeginFeedback().
+		GLint m_SavedViewport[4] = {};                ///< Viewport before BeginFeedback().
+		float m_FeedbackBias = 0.0f;                  ///< Level bias of the feedback pass, compensating its lower resolution.
+	};
+
+} // namespace fgl
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+#include <FireGL/Renderer/Shader.h>
+
+#include <External/glm/vec3.hpp>
+#include <External/glm/vec4.hpp>
+#include <External/glm/mat4x4.hpp>
+#include <External/glad/glad.h>
+
+namespace fgl
+{
+	struct CameraData;
+	struct DirectionalLightData;
+
+	/** Parameters of a VolumetricFog. */
+	struct VolumetricFogSettings
+	{
+		float Density = 0.02f;                 ///< Extinction per world unit at BaseHeight, 0 for clear air.
+		glm::vec3 Albedo = glm::vec3(1.0f);    ///< Share of the extinguished light scattered back, per channel.
+		float Anisotropy = 0.3f;               ///< Henyey-Greenstein g in (-1, 1): positive scatters forward, glowing around the lights.
+		float HeightFalloff = 0.1f;            ///< Exponential thinning of the fog per world unit above BaseHeight, 0 for uniform fog.
+		float BaseHeight = 0.0f;               ///< World height where the density is Density.
+		float Distance = 64.0f;                ///< View distance the volume covers; farther fragments get the fog up to it.
+		float TemporalBlend = 0.1f;            ///< Weight of the new frame against the reprojected history, 1 to disable it.
+	};
+
+	/**
+	 * Volumetric fog computed in a low-resolution froxel volume: GridX * GridY screen tiles by GridZ depth
+	 * slices, spaced exponentially between the camera's near plane and Settings.Distance like the light clusters.
+	 *
+	 * Compute() runs two compute passes before the batches are shaded:
+	 *  - every froxel evaluates the density at a point jittered along its depth, and the light it scatters
+	 *    toward the camera: the directional light, through the cascaded shadow maps when they are on, and the
+	 *    point lights of the ClusteredLightManager cluster it falls in, so it reads the same light lists as the
+	 *    clustered shading. The result is blended with the previous frame's, reprojected, which spreads the
+	 *    jittered samples over frames and hides the slices;
+	 *  - every column integrates its froxels front to back into the in-scattered light and the transmittance
+	 *    from the camera to each slice.
+	 *
+	 * The integrated volume is bound at TextureUnit as SamplerName, with the "VolumetricFogData" block at
+	 * BindingPoint, both registered as shader defaults. Lighting shaders apply the fog with one filtered 3D
+	 * lookup at the fragment's screen position and view depth, see BaseLighting.frag:
+	 *
+	 *     layout (std140) uniform VolumetricFogData
+	 *     {
+	 *         vec4 DepthParams;   // w = log(view depth) * x + y
+	 *         vec4 ScreenParams;  // viewport offset, 1 / viewport size
+	 *     } Fog;
+	 *     uniform sampler3D VolumetricFogMap;
+	 *
+	 *     vec4 Fog = texture(VolumetricFogMap, vec3(uv, log(ViewDepth) * Fog.DepthParams.x + Fog.DepthParams.y));
+	 *     Color = Color * Fog.a + Fog.rgb;
+	 *
+	 * While the fog is off, a 1x1x1 texture of no in-scattering and full transmittance is bound instead, so the
+	 * shaders need no variant without it. The sky isn't fogged. Requires OpenGL 4.3 to compute.
+	 */
+	class VolumetricFog
+	{
+	public:
+		static constexpr uint32_t GridX = 160;                              ///< Froxels along x.
+		static constexpr uint32_t GridY = 90;                               ///< Froxels along y.
+		static constexpr uint32_t GridZ = 64;                               ///< Depth slices.
+		static constexpr uint32_t TextureUnit = 24;                         ///< Texture unit the integrated volume is sampled from.
+		static constexpr const char* SamplerName = "VolumetricFogMap";      ///< Name of the fog sampler in GLSL.
+		static constexpr GLuint BindingPoint = 5;                           ///< Uniform buffer binding point of the block.
+		static constexpr const char* BlockName = "VolumetricFogData";       ///< Name of the uniform block in GLSL.
+		static constexpr GLint HistoryUnit = 0;                             ///< Texture unit of the history read by the scattering pass.
+
+		VolumetricFog() = default;
+
+		/** Deletes the volumes and the shaders. */
+		~VolumetricFog();
+
+		VolumetricFog(const VolumetricFog&) = delete;
+		VolumetricFog& operator=(const VolumetricFog&) = delete;
+
+		/** @return True if the context supports compute shaders (OpenGL 4.3). */
+		static bool IsSupported();
+
+		/** Creates the neutral texture and the block, and binds them. Requires a current OpenGL context. */
+		void Create();
+
+		/** Deletes the volumes, the block and the shaders. */
+		void Destroy();
+
+		/** @return True once Create() was called. */
+		bool IsCreated() const;
+
+		/** @return The parameters read by every Compute(). */
+		VolumetricFogSettings& GetSettings();
+
+		/** @return The parameters read by every Compute(). */
+		const VolumetricFogSettings& GetSettings() const;
+
+		/**
+		 * Computes the fog of a view and binds it. Changes the program and texture unit HistoryUnit.
+		 *
+		 * @param Camera          The camera data of the view, its projection perspective.
+		 * @param Light           The directional light scattered by the fog.
+		 * @param Viewport        The view's viewport: x, y, width, height.
+		 * @param bClusteredLights True if the ClusteredLightManager buffers hold this view's light lists.
+		 * @param bReproject      False to neither read nor keep the history, e.g. when several views share the volumes.
+		 */
+		void Compute(const CameraData& Camera, const DirectionalLightData& Light, const GLint Viewport[4], bool bClusteredLights, bool bReproject);
+
+		/** Binds the neutral texture to TextureUnit and forgets the history, the shading is then unfogged. */
+		void Disable();
+
+	private:
+		/** std140 layout of the "VolumetricFogData" block. */
+		struct FogData
+		{
+			glm::vec4 DepthParams = glm::vec4(0.0f);  ///< Texture w of a view depth: log(depth) * x + y.
+			glm::vec4 ScreenParams = glm::vec4(0.0f); ///< Viewport offset in xy, 1 / viewport size in zw.
+		};
+
+		/** Creates the three froxel volumes. */
+		void CreateVolumes();
+
+		VolumetricFogSettings m_Settings;            ///< Parameters of the passes.
+		FogData m_Data;                              ///< Contents of the block.
+		GLuint m_BufferID = 0;                       ///< Uniform buffer of the block.
+		GLuint m_NeutralTexture = 0;                 ///< 1x1x1 unfogged volume bound while the fog is off.
+		GLuint m_Scattering[2] = {};                 ///< Scattered light and extinction of each froxel, this frame's and the history.
+		GLuint m_Integrated = 0;                     ///< In-scattered light and transmittance from the camera to each froxel.
+		uint32_t m_Current = 0;                      ///< Index of this frame's volume in m_Scattering.
+		bool m_bHistoryValid = false;                ///< Whether m_Scattering[1 - m_Current] holds the previous frame.
+		glm::mat4 m_PreviousViewProjection = glm::mat4(1.0f); ///< View projection the history was computed with.
+		uint32_t m_Frame = 0;                        ///< Frames computed, drives the depth jitter.
+		std::unique_ptr<Shader> m_ScatterShader;     ///< Density and in-scattering of every froxel, blended with the history.
+		std::unique_ptr<Shader> m_IntegrateShader;   ///< Front to back accumulation along every column.
+	};
+
+} // namespace fgl
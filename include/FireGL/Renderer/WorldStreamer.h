@@ -0,0 +1,154 @@
+#pragma once
+
+#include <FireGL/fglpch.h>
+#include <FireGL/Core/JobSystem.h>
+#include <FireGL/Renderer/SceneFile.h>
+
+#include <External/glm/vec2.hpp>
+#include <External/glm/vec3.hpp>
+
+namespace fgl
+{
+	class Scene;
+	class SceneObject;
+
+	/**
+	 * Streams a large world into a Scene cell by cell, around the active camera.
+	 *
+	 * The world is split into square cells of a grid on the XZ plane, each stored as a SceneFile named after
+	 * its coordinates (see GetCellPath()), written by a tool that records every object into the file of the cell
+	 * holding its position (see GetCell()). Update() keeps the cells within the load radius of the camera in
+	 * the Scene and removes those past the unload radius; the gap between both radii is the hysteresis that
+	 * keeps a camera moving along a cell border from loading and unloading the same cells every frame.
+	 *
+	 * Cells load asynchronously: a job maps the cell's file and reads its records through on a JobSystem
+	 * worker, so the disk reads happen there, and the nearest cells are requested first with a bounded number
+	 * of reads in flight, which is the I/O priority. Once read, a cell's assets are handed to the asset
+	 * callback, e.g. to start their ModelLoader::LoadAsync(), and its objects are added by a later Update(), one
+	 * cell per call, so a frame never instantiates more than one cell. Memory and object counts are then
+	 * bounded by the cells within the unload radius, whatever the size of the world.
+	 *
+	 * Cells that have no file are remembered as empty while in range. The objects of a cell belong to the
+	 * streamer: they must not be removed from the Scene by other means. Runs on the thread processing the Scene.
+	 */
+	class WorldStreamer
+	{
+	public:
+		/** Receives the assets of a cell read from disk, before its objects are created. */
+		using AssetCallback = std::function<void(const std::vector<AssetId>& Assets)>;
+
+		/**
+		 * @param Target The Scene the cells are added to, must outlive the streamer.
+		 * @param Factories The registry of the types, materials and components of the cells' objects, must outlive the streamer.
+		 * @param Jobs The job system the cells are read on, must outlive the streamer.
+		 * @param Directory The directory holding the cell files.
+		 * @param CellSize The edge of a cell, in world units.
+		 */
+		WorldStreamer(Scene& Target, const SceneFile& Factories, JobSystem& Jobs, std::string_view Directory, float CellSize);
+
+		/** Waits for the reads in flight; the objects of the loaded cells stay in the Scene. */
+		~WorldStreamer();
+
+		WorldStreamer(const WorldStreamer&) = delete;
+		WorldStreamer& operator=(const WorldStreamer&) = delete;
+
+		/**
+		 * Builds the path of a cell's file.
+		 *
+		 * @param Directory The directory holding the cell files.
+		 * @param Cell The coordinates of the cell on the X and Z axes.
+		 * @return The path, e.g. "Directory/Cell_3_-2.fglscene".
+		 */
+		static std::string GetCellPath(std::string_view Directory, const glm::ivec2& Cell);
+
+		/**
+		 * Finds the cell holding a position.
+		 *
+		 * @param Position The world-space position.
+		 * @param CellSize The edge of a cell, in world units.
+		 * @return The coordinates of the cell on the X and Z axes.
+		 */
+		static glm::ivec2 GetCell(const glm::vec3& Position, float CellSize);
+
+		/**
+		 * Sets the distances cells stream at, from the camera to the nearest point of the cell on the XZ plane.
+		 *
+		 * @param LoadRadius Cells closer than this are loaded.
+		 * @param UnloadRadius Cells farther than this are unloaded, at least LoadRadius.
+		 */
+		void SetRadii(float LoadRadius, float UnloadRadius);
+
+		/**
+		 * Sets the number of cells read at the same time.
+		 *
+		 * @param Count The reads in flight at most, at least 1; 2 by default.
+		 */
+		void SetMaxPendingLoads(size_t Count);
+
+		/**
+		 * Sets the function receiving the assets of each cell read, on the calling thread of Update().
+		 *
+		 * @param Callback The function, nullptr for none.
+		 */
+		void SetAssetCallback(AssetCallback Callback);
+
+		/**
+		 * Streams the cells around the Scene's active camera: collects the finished reads, unloads the cells out
+		 * of range, requests the nearest missing ones and adds the objects of the nearest read cell.
+		 */
+		void Update();
+
+		/** Removes the objects of every loaded cell from the Scene and forgets every cell, waiting for the reads in flight. */
+		void UnloadAll();
+
+		/** @return The number of cells whose objects are in the Scene. */
+		size_t GetLoadedCellCount() const;
+
+		/** @return The number of cells being read or waiting to be added. */
+		size_t GetPendingCellCount() const;
+
+	private:
+		/** Progress of a cell. */
+		enum class CellState
+		{
+			Reading,   ///< A job maps and reads the file.
+			Read,      ///< The file is read, its objects are added by a coming Update().
+			Loaded,    ///< The objects are in the Scene.
+			Empty      ///< No file, or an invalid one.
+		};
+
+		/** A cell within the unload radius. */
+		struct Cell
+		{
+			glm::ivec2 Coordinates{ 0 };            ///< Position in the grid.
+			CellState State = CellState::Reading;   ///< Progress of the cell.
+			SceneFile File;                         ///< The mapped cell file, closed once instantiated.
+			std::vector<AssetId> Assets;            ///< Assets of the file, filled by the job.
+			std::vector<SceneObject*> Objects;      ///< Objects added to the Scene.
+			JobCounter Counter;                     ///< Pending read.
+			bool bOpened = false;                   ///< Set by the job if the file is valid.
+		};
+
+		/** @return The key of a cell in m_Cells. */
+		static uint64_t GetKey(const glm::ivec2& Coordinates);
+
+		/** @return The distance from a point of the XZ plane to the nearest point of a cell. */
+		float GetDistance(const glm::vec2& Viewer, const glm::ivec2& Coordinates) const;
+
+		/** Removes the objects of a cell from the Scene. */
+		void Unload(Cell& Unloaded);
+
+		Scene& m_Scene;                                               ///< Scene the cells are added to.
+		const SceneFile& m_Factories;                                 ///< Registry the objects are created with.
+		JobSystem& m_Jobs;                                            ///< Job system the cells are read on.
+		std::string m_Directory;                                      ///< Directory of the cell files.
+		float m_CellSize;                                             ///< Edge of a cell.
+		float m_LoadRadius;                                           ///< Cells closer than this are loaded.
+		float m_UnloadRadius;                                         ///< Cells farther than this are unloaded.
+		size_t m_MaxPendingLoads = 2;                                 ///< Reads in flight at most.
+		AssetCallback m_AssetCallback;                                ///< Receives the assets of each cell read.
+		std::unordered_map<uint64_t, std::unique_ptr<Cell>> m_Cells;  ///< Cells within the unload radius, by key.
+		std::vector<std::pair<float, glm::ivec2>> m_Candidates;       ///< Cells to request, by distance, reused across frames.
+	};
+
+} // namespace fgl
@@ -17,7 +17,10 @@
 #include <unordered_map>
 #include <map>
 #include <vector>
+#include <array>
 #include <algorithm>
 
 // Type Traits and Utilities
-#include <type_traits>
\ No newline at end of file
+#include <type_traits>
+#include <limits>
+#include <cmath>
\ No newline at end of file
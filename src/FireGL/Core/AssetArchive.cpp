@@ -0,0 +1,391 @@
+#include <FireGL/Core/AssetArchive.h>
+#include <FireGL/Core/AssetId.h>
+#include <FireGL/Core/BaseLog.h>
+#include <FireGL/Core/Profiler.h>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+
+#ifdef FIREGL_ENABLE_LZ4
+#include <lz4frame.h>
+#endif
+#ifdef FIREGL_ENABLE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace fgl
+{
+
+	namespace
+	{
+		constexpr uint64_t DataAlignment = 16;         ///< Alignment of every file in the archive.
+		constexpr size_t DecompressChunk = 256 * 1024; ///< Compressed bytes handed to a decoder per step.
+		constexpr int ZstdLevel = 19;                  ///< Dense, decompression speed barely depends on the level.
+	}
+
+	std::vector<std::unique_ptr<AssetArchive::MountedArchive>> AssetArchive::s_Archives;
+	std::shared_mutex AssetArchive::s_Mutex;
+
+	bool AssetArchive::Build(std::string_view SourceDirectory, std::string_view ArchivePath, Compression Method)
+	{
+		const std::filesystem::path Root(SourceDirectory);
+		std::error_code Error;
+		std::vector<std::pair<uint64_t, std::filesystem::path>> Files;
+		for (auto It = std::filesystem::recursive_directory_iterator(Root, Error); !Error && It != std::filesystem::recursive_directory_iterator(); It.increment(Error))
+		{
+			if (It->is_regular_file())
+			{
+				const std::string Key = It->path().lexically_relative(Root).generic_string();
+				Files.emplace_back(HashKey(Key), It->path());
+			}
+		}
+		if (Error)
+		{
+			LOG_ERROR("Failed to read the directory " + std::string(SourceDirectory) + " to archive.", false);
+			return false;
+		}
+
+		std::sort(Files.begin(), Files.end(), [](const auto& A, const auto& B) { return A.first < B.first; });
+		for (size_t Index = 1; Index < Files.size(); Index++)
+		{
+			if (Files[Index].first == Files[Index - 1].first)
+			{
+				LOG_ERROR("Archive keys collide: " + Files[Index - 1].second.string() + " and " + Files[Index].second.string() + ".", false);
+				return false;
+			}
+		}
+
+		if (!IsSupported(Method))
+		{
+			LOG_ERROR("The compression method of the asset archive " + std::string(ArchivePath) + " isn't compiled in.", false);
+			return false;
+		}
+
+		// The table is rewritten once every offset and size is known
+		std::vector<Entry> Entries(Files.size());
+		std::ofstream Archive(std::string(ArchivePath), std::ios::binary | std::ios::trunc);
+		const Header FileHeader = { Magic, Version, static_cast<uint32_t>(Entries.size()), 0 };
+		Archive.write(reinterpret_cast<const char*>(&FileHeader), sizeof(FileHeader));
+		Archive.write(reinterpret_cast<const char*>(Entries.data()), static_cast<std::streamsize>(Entries.size() * sizeof(Entry)));
+
+		std::vector<char> Contents;
+		std::vector<char> Compressed;
+		for (size_t Index = 0; Index < Files.size() && Archive; Index++)
+		{
+			std::ifstream Source(Files[Index].second, std::ios::binary | std::ios::ate);
+			Contents.resize(Source ? static_cast<size_t>(Source.tellg()) : 0);
+			Source.seekg(0);
+			if (!Source.read(Contents.data(), static_cast<std::streamsize>(Contents.size())))
+			{
+				LOG_ERROR("Failed to read " + Files[Index].second.string() + " into the archive.", false);
+				return false;
+			}
+
+			// Files the method doesn't shrink, e.g. already compressed images, are stored as is
+			const bool bCompressed = Method != Compression::None && Compress(Method, Contents, Compressed) && Compressed.size() < Contents.size();
+			const std::vector<char>& Stored = bCompressed ? Compressed : Contents;
+
+			uint64_t Offset = static_cast<uint64_t>(Archive.tellp());
+			for (; Offset % DataAlignment != 0; Offset++)
+			{
+				Archive.put('\0');
+			}
+
+			Entries[Index] = { Files[Index].first, Offset, Stored.size(), Contents.size(),
+				static_cast<uint32_t>(bCompressed ? Method : Compression::None), 0 };
+			Archive.write(Stored.data(), static_cast<std::streamsize>(Stored.size()));
+		}
+
+		Archive.seekp(sizeof(Header));
+		Archive.write(reinterpret_cast<const char*>(Entries.data()), static_cast<std::streamsize>(Entries.size() * sizeof(Entry)));
+		if (!Archive)
+		{
+			LOG_ERROR("Failed to write the asset archive " + std::string(ArchivePath) + ".", false);
+			return false;
+		}
+		return true;
+	}
+
+	bool AssetArchive::Mount(std::string_view ArchivePath, std::string_view MountPoint)
+	{
+		std::unique_ptr<MountedArchive> Archive = std::make_unique<MountedArchive>();
+		if (!Archive->File.Open(ArchivePath))
+		{
+			LOG_ERROR("Failed to map the asset archive " + std::string(ArchivePath) + ".", false);
+			return false;
+		}
+
+		const uint8_t* Data = Archive->File.GetData();
+		const size_t Size = Archive->File.GetSize();
+		Header FileHeader = {};
+		if (Size >= sizeof(Header))
+		{
+			std::memcpy(&FileHeader, Data, sizeof(Header));
+		}
+		if (FileHeader.Magic != Magic || FileHeader.Version != Version
+			|| (Size - sizeof(Header)) / sizeof(Entry) < FileHeader.EntryCount)
+		{
+			LOG_ERROR("Invalid or outdated asset archive " + std::string(ArchivePath) + ".", false);
+			return false;
+		}
+
+		// Entries are 8-byte aligned right after the 16-byte header, the table is read in place
+		Archive->Entries = reinterpret_cast<const Entry*>(Data + sizeof(Header));
+		Archive->EntryCount = FileHeader.EntryCount;
+		for (uint32_t Index = 0; Index < Archive->EntryCount; Index++)
+		{
+			const Entry& Stored = Archive->Entries[Index];
+			const Compression Method = static_cast<Compression>(Stored.Compression);
+			if (Stored.Offset > Size || Stored.StoredSize > Size - Stored.Offset || !IsSupported(Method)
+				|| (Method == Compression::None && Stored.StoredSize != Stored.Size))
+			{
+				LOG_ERROR("Corrupted or unsupported entry in the asset archive " + std::string(ArchivePath) + ".", false);
+				return false;
+			}
+		}
+
+		Archive->MountPoint = NormalizePath(MountPoint);
+		if (Archive->MountPoint.empty() || Archive->MountPoint.back() != '/')
+		{
+			Archive->MountPoint += '/';
+		}
+
+		std::unique_lock<std::shared_mutex> Lock(s_Mutex);
+		s_Archives.push_back(std::move(Archive));
+		return true;
+	}
+
+	void AssetArchive::UnmountAll()
+	{
+		std::unique_lock<std::shared_mutex> Lock(s_Mutex);
+		s_Archives.clear();
+	}
+
+	bool AssetArchive::IsMounted()
+	{
+		std::shared_lock<std::shared_mutex> Lock(s_Mutex);
+		return !s_Archives.empty();
+	}
+
+	bool AssetArchive::Read(std::string_view Path, Blob& Contents)
+	{
+		std::shared_lock<std::shared_mutex> Lock(s_Mutex);
+		const uint8_t* Source = nullptr;
+		const Entry* Found = FindEntry(Path, Source);
+		if (!Found)
+			return false;
+
+		if (static_cast<Compression>(Found->Compression) == Compression::None)
+		{
+			Contents.Data = std::span<const uint8_t>(Source, static_cast<size_t>(Found->Size));
+			Contents.Storage.reset();
+			return true;
+		}
+
+		std::shared_ptr<uint8_t[]> Storage(new uint8_t[static_cast<size_t>(Found->Size)]);
+		if (!Decompress(static_cast<Compression>(Found->Compression), std::span<const uint8_t>(Source, static_cast<size_t>(Found->StoredSize)),
+			std::span<uint8_t>(Storage.get(), static_cast<size_t>(Found->Size))))
+			return false;
+
+		Contents.Data = std::span<const uint8_t>(Storage.get(), static_cast<size_t>(Found->Size));
+		Contents.Storage = std::move(Storage);
+		return true;
+	}
+
+	bool AssetArchive::GetSize(std::string_view Path, uint64_t& Size)
+	{
+		std::shared_lock<std::shared_mutex> Lock(s_Mutex);
+		const uint8_t* Source = nullptr;
+		const Entry* Found = FindEntry(Path, Source);
+		if (!Found)
+			return false;
+
+		Size = Found->Size;
+		return true;
+	}
+
+	bool AssetArchive::ReadInto(std::string_view Path, std::span<uint8_t> Destination)
+	{
+		std::shared_lock<std::shared_mutex> Lock(s_Mutex);
+		const uint8_t* Source = nullptr;
+		const Entry* Found = FindEntry(Path, Source);
+		if (!Found || Found->Size != Destination.size())
+			return false;
+
+		if (static_cast<Compression>(Found->Compression) == Compression::None)
+		{
+			std::memcpy(Destination.data(), Source, Destination.size());
+			return true;
+		}
+		return Decompress(static_cast<Compression>(Found->Compression), std::span<const uint8_t>(Source, static_cast<size_t>(Found->StoredSize)), Destination);
+	}
+
+	bool AssetArchive::Contains(std::string_view Path)
+	{
+		std::shared_lock<std::shared_mutex> Lock(s_Mutex);
+		const uint8_t* Source = nullptr;
+		return FindEntry(Path, Source) != nullptr;
+	}
+
+	const AssetArchive::Entry* AssetArchive::FindEntry(std::string_view Path, const uint8_t*& Stored)
+	{
+		if (s_Archives.empty())
+			return nullptr;
+
+		const std::string Normalized = NormalizePath(Path);
+		for (auto It = s_Archives.rbegin(); It != s_Archives.rend(); ++It)
+		{
+			const MountedArchive& Archive = **It;
+			if (Normalized.size() <= Archive.MountPoint.size() || Normalized.compare(0, Archive.MountPoint.size(), Archive.MountPoint) != 0)
+				continue;
+
+			const uint64_t Hash = HashKey(std::string_view(Normalized).substr(Archive.MountPoint.size()));
+			const Entry* End = Archive.Entries + Archive.EntryCount;
+			const Entry* Found = std::lower_bound(Archive.Entries, End, Hash, [](const Entry& Candidate, uint64_t Key) { return Candidate.KeyHash < Key; });
+			if (Found != End && Found->KeyHash == Hash)
+			{
+				Stored = Archive.File.GetData() + Found->Offset;
+				return Found;
+			}
+		}
+		return nullptr;
+	}
+
+	bool AssetArchive::Decompress(Compression Method, std::span<const uint8_t> Source, std::span<uint8_t> Destination)
+	{
+		FGL_PROFILE_SCOPE("AssetArchive::Decompress")
+
+		// Both decoders consume the mapping in chunks, the pages are read as decompression reaches them
+		switch (Method)
+		{
+#ifdef FIREGL_ENABLE_LZ4
+		case Compression::LZ4:
+		{
+			LZ4F_dctx* Context = nullptr;
+			if (LZ4F_isError(LZ4F_createDecompressionContext(&Context, LZ4F_VERSION)))
+				return false;
+
+			size_t Read = 0;
+			size_t Written = 0;
+			size_t Hint = 1;
+			while (Hint != 0 && Read < Source.size())
+			{
+				size_t InSize = std::min<size_t>(Source.size() - Read, DecompressChunk);
+				size_t OutSize = Destination.size() - Written;
+				Hint = LZ4F_decompress(Context, Destination.data() + Written, &OutSize, Source.data() + Read, &InSize, nullptr);
+				if (LZ4F_isError(Hint))
+					break;
+
+				Read += InSize;
+				Written += OutSize;
+			}
+			LZ4F_freeDecompressionContext(Context);
+			if (Hint == 0 && Written == Destination.size())
+				return true;
+			break;
+		}
+#endif
+#ifdef FIREGL_ENABLE_ZSTD
+		case Compression::Zstd:
+		{
+			ZSTD_DStream* Stream = ZSTD_createDStream();
+			ZSTD_outBuffer Output = { Destination.data(), Destination.size(), 0 };
+			size_t Remaining = 1;
+			for (size_t Read = 0; Remaining != 0 && Read < Source.size(); )
+			{
+				ZSTD_inBuffer Input = { Source.data() + Read, std::min<size_t>(Source.size() - Read, DecompressChunk), 0 };
+				Remaining = ZSTD_decompressStream(Stream, &Output, &Input);
+				if (ZSTD_isError(Remaining))
+					break;
+
+				Read += Input.pos;
+			}
+			ZSTD_freeDStream(Stream);
+			if (Remaining == 0 && Output.pos == Destination.size())
+				return true;
+			break;
+		}
+#endif
+		default:
+			break;
+		}
+
+		LOG_ERROR("Failed to decompress an asset archive entry.", false);
+		return false;
+	}
+
+	bool AssetArchive::Compress(Compression Method, const std::vector<char>& Contents, std::vector<char>& Compressed)
+	{
+		switch (Method)
+		{
+#ifdef FIREGL_ENABLE_LZ4
+		case Compression::LZ4:
+		{
+			LZ4F_preferences_t Preferences = {};
+			Preferences.frameInfo.contentSize = Contents.size();
+			Compressed.resize(LZ4F_compressFrameBound(Contents.size(), &Preferences));
+			const size_t Size = LZ4F_compressFrame(Compressed.data(), Compressed.size(), Contents.data(), Contents.size(), &Preferences);
+			if (LZ4F_isError(Size))
+				return false;
+
+			Compressed.resize(Size);
+			return true;
+		}
+#endif
+#ifdef FIREGL_ENABLE_ZSTD
+		case Compression::Zstd:
+		{
+			// Archives are built offline, the densest levels only slow the build down
+			Compressed.resize(ZSTD_compressBound(Contents.size()));
+			const size_t Size = ZSTD_compress(Compressed.data(), Compressed.size(), Contents.data(), Contents.size(), ZstdLevel);
+			if (ZSTD_isError(Size))
+				return false;
+
+			Compressed.resize(Size);
+			return true;
+		}
+#endif
+		default:
+			return false;
+		}
+	}
+
+	bool AssetArchive::IsSupported(Compression Method)
+	{
+		switch (Method)
+		{
+		case Compression::None:
+			return true;
+#ifdef FIREGL_ENABLE_LZ4
+		case Compression::LZ4:
+			return true;
+#endif
+#ifdef FIREGL_ENABLE_ZSTD
+		case Compression::Zstd:
+			return true;
+#endif
+		default:
+			return false;
+		}
+	}
+
+	uint64_t AssetArchive::HashKey(std::string_view Key)
+	{
+		return AssetId::HashKey(Key);
+	}
+
+	std::string AssetArchive::NormalizePath(std::string_view Path)
+	{
+		std::error_code Error;
+		std::filesystem::path Absolute = std::filesystem::absolute(std::filesystem::path(Path), Error);
+		if (Error)
+		{
+			Absolute = std::filesystem::path(Path);
+		}
+		return Absolute.lexically_normal().generic_string();
+	}
+
+} // namespace fgl
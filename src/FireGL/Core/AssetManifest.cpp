@@ -0,0 +1,170 @@
+#include <FireGL/Core/AssetManifest.h>
+#include <FireGL/Core/BaseLog.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <unordered_set>
+
+namespace fgl
+{
+
+	namespace
+	{
+		/** @return True if the token names a file rather than an AssetPathManager key. */
+		bool IsPath(std::string_view Token)
+		{
+			return Token.find_first_of("/\\.") != std::string_view::npos;
+		}
+	}
+
+	std::unordered_map<std::string, std::vector<std::string>> AssetManifest::s_Dependencies;
+	std::mutex AssetManifest::s_Mutex;
+	std::atomic<bool> AssetManifest::s_bRecording{ false };
+
+	bool AssetManifest::Load(std::string_view ManifestPath)
+	{
+		std::ifstream File{ std::string(ManifestPath) };
+		if (!File)
+		{
+			LOG_ERROR("Failed to open the asset manifest " + std::string(ManifestPath) + ".", false);
+			return false;
+		}
+
+		// Paths are relative to the manifest, so a manifest moves along with its assets
+		const std::filesystem::path Directory = std::filesystem::path(ManifestPath).parent_path();
+		auto Resolve = [&Directory](std::string_view Token) {
+			return IsPath(Token) ? (Directory / Token).string() : std::string(Token);
+		};
+
+		std::string Line;
+		while (std::getline(File, Line))
+		{
+			if (Line.empty() || Line[0] == '[' || Line[0] == '#')
+				continue;
+
+			const size_t Separator = Line.find('=');
+			if (Separator == std::string::npos)
+			{
+				LOG_ERROR("Malformed asset manifest line (missing '='): " + Line + ".", false);
+				continue;
+			}
+
+			const std::string Asset = Resolve(std::string_view(Line).substr(0, Separator));
+			std::string_view Dependencies = std::string_view(Line).substr(Separator + 1);
+			while (!Dependencies.empty())
+			{
+				const size_t End = std::min(Dependencies.find(';'), Dependencies.size());
+				if (End > 0)
+				{
+					Record(Asset, Resolve(Dependencies.substr(0, End)));
+				}
+				Dependencies.remove_prefix(std::min(End + 1, Dependencies.size()));
+			}
+		}
+		return true;
+	}
+
+	bool AssetManifest::Save(std::string_view ManifestPath)
+	{
+		const std::filesystem::path Directory = std::filesystem::absolute(std::filesystem::path(ManifestPath).parent_path());
+		auto Relative = [&Directory](const std::string& Token) {
+			return IsPath(Token) ? std::filesystem::path(Token).lexically_relative(Directory).generic_string() : Token;
+		};
+
+		std::ofstream File{ std::string(ManifestPath), std::ios::trunc };
+		std::lock_guard<std::mutex> Lock(s_Mutex);
+		for (const auto& [Asset, Dependencies] : s_Dependencies)
+		{
+			File << Relative(Asset) << '=';
+			for (size_t Index = 0; Index < Dependencies.size(); Index++)
+			{
+				File << (Index > 0 ? ";" : "") << Relative(Dependencies[Index]);
+			}
+			File << '\n';
+		}
+
+		if (!File)
+		{
+			LOG_ERROR("Failed to write the asset manifest " + std::string(ManifestPath) + ".", false);
+			return false;
+		}
+		return true;
+	}
+
+	void AssetManifest::Clear()
+	{
+		std::lock_guard<std::mutex> Lock(s_Mutex);
+		s_Dependencies.clear();
+	}
+
+	void AssetManifest::SetRecording(bool bRecording)
+	{
+		s_bRecording = bRecording;
+	}
+
+	bool AssetManifest::IsRecording()
+	{
+		return s_bRecording;
+	}
+
+	void AssetManifest::Record(std::string_view Asset, std::string_view Dependency)
+	{
+		const std::string Key = Normalize(Asset);
+		std::string Needed = Normalize(Dependency);
+
+		std::lock_guard<std::mutex> Lock(s_Mutex);
+		std::vector<std::string>& Dependencies = s_Dependencies[Key];
+		if (std::find(Dependencies.begin(), Dependencies.end(), Needed) == Dependencies.end())
+		{
+			Dependencies.push_back(std::move(Needed));
+		}
+	}
+
+	void AssetManifest::GetDependencies(std::string_view Asset, std::vector<std::string>& Dependencies)
+	{
+		std::lock_guard<std::mutex> Lock(s_Mutex);
+
+		// Depth-first, a dependency is appended once all of its own are; the visited set also breaks cycles
+		std::unordered_set<std::string> Visited;
+		std::vector<std::pair<std::string, size_t>> Stack;
+		const std::string Root = Normalize(Asset);
+		Visited.insert(Root);
+		Stack.emplace_back(Root, 0);
+		while (!Stack.empty())
+		{
+			auto Found = s_Dependencies.find(Stack.back().first);
+			const size_t Next = Stack.back().second++;
+			if (Found == s_Dependencies.end() || Next >= Found->second.size())
+			{
+				if (Stack.size() > 1)
+				{
+					Dependencies.push_back(std::move(Stack.back().first));
+				}
+				Stack.pop_back();
+				continue;
+			}
+
+			const std::string& Child = Found->second[Next];
+			if (Visited.insert(Child).second)
+			{
+				Stack.emplace_back(Child, 0);
+			}
+		}
+	}
+
+	std::string AssetManifest::Normalize(std::string_view Asset)
+	{
+		if (!IsPath(Asset))
+			return std::string(Asset);
+
+		std::error_code Error;
+		std::filesystem::path Absolute = std::filesystem::absolute(std::filesystem::path(Asset), Error);
+		if (Error)
+		{
+			Absolute = std::filesystem::path(Asset);
+		}
+		return Absolute.lexically_normal().generic_string();
+	}
+
+} // namespace fgl
@@ -1,18 +1,26 @@
 #include <FireGL/Core/AssetPathManager.h>
+#include <FireGL/Core/AssetArchive.h>
 #include <FireGL/Core/SystemManager.h>
 #include <FireGL/Core/BaseLog.h>
+#include <FireGL/Core/Profiler.h>
+#include <FireGL/Core/StartupTimeline.h>
 
 namespace fgl
 {
 
-	AssetPathManager::AssetPathManager(std::string_view ConfigPath)
+	AssetPathManager::AssetPathManager(std::string_view ConfigPath, std::string_view ArchivePath)
 	{
+		if (!ArchivePath.empty())
+		{
+			AssetArchive::Mount(ArchivePath, std::filesystem::path(ConfigPath).parent_path().string());
+		}
 		LoadConfig(ConfigPath);
 		RegisterWithSystemManager();
 	}
 
 	void AssetPathManager::LoadConfig(std::string_view ConfigPath)
 	{
+		const uint64_t Start = Profiler::Now();
 		std::ifstream File(ConfigPath.data());
 		if (!File)
 		{
@@ -29,6 +37,9 @@ namespace fgl
 				ParseLine(Line);
 			}
 		}
+
+		const uint64_t End = Profiler::Now();
+		StartupTimeline::Record("Config", ConfigPath, StartupTimeline::FileSize(ConfigPath), Start, End, End);
 	}
 
 	void AssetPathManager::ParseLine(const std::string& Line)
@@ -46,13 +57,21 @@ namespace fgl
 
 		// Construct the full path by appending relative paths to base path
 		std::filesystem::path ResolvedPath = m_ConfigPathPath / Value;
-		if (!std::filesystem::exists(ResolvedPath))
+		if (!AssetArchive::IsMounted() && !std::filesystem::exists(ResolvedPath))
 		{
 			LOG_ERROR("Path resolution failed for key '" + Key + "'. Resolved path does not exist: " + ResolvedPath.string(), true)
 			return;
 		}
 
-		m_ConfigMap[Key] = ResolvedPath.string();
+		// Keys are only stored by hash, two keys sharing one would silently alias
+		PathEntry& Entry = m_ConfigMap[AssetId(Key)];
+		if (!Entry.Key.empty() && Entry.Key != Key)
+		{
+			LOG_ERROR("Keys '" + Entry.Key + "' and '" + Key + "' share the same AssetId. Rename one of them.", true)
+			return;
+		}
+		Entry.Key = std::move(Key);
+		Entry.Path = ResolvedPath.string();
 	}
 
 	std::string AssetPathManager::ResolvePath(std::string_view Value) const
@@ -61,26 +80,39 @@ namespace fgl
 		size_t FirstSlashPos = Value.find('/');
 		if (FirstSlashPos != std::string::npos)
 		{
-			std::string BaseKey = std::string(Value.substr(0, FirstSlashPos));
-			auto It = m_ConfigMap.find(BaseKey);
-			if (It != m_ConfigMap.end())
+			if (const std::string* BasePath = FindPath(AssetId(Value.substr(0, FirstSlashPos))))
 			{
 				// Append the relative path to the resolved base path
-				return It->second + std::string(Value.substr(FirstSlashPos));
+				return *BasePath + std::string(Value.substr(FirstSlashPos));
 			}
 		}
 		return std::string(Value);
 	}
 
-	std::string AssetPathManager::GetPath(std::string_view Key)
+	const std::string& AssetPathManager::GetPath(std::string_view Key) const
 	{
-		auto It = m_ConfigMap.find(Key.data());
-		if (It == m_ConfigMap.end())
-		{
-			LOG_ERROR("Path retrieval failed. No entry found for key: '" + std::string(Key) + "'.", true)
-			return {};
-		}
-		return It->second;
+		if (const std::string* Path = FindPath(AssetId(Key)))
+			return *Path;
+
+		static const std::string Empty;
+		LOG_ERROR("Path retrieval failed. No entry found for key: '" + std::string(Key) + "'.", true)
+		return Empty;
+	}
+
+	const std::string& AssetPathManager::GetPath(AssetId Id) const
+	{
+		if (const std::string* Path = FindPath(Id))
+			return *Path;
+
+		static const std::string Empty;
+		LOG_ERROR("Path retrieval failed. No entry found for key handle " + std::to_string(Id.Hash) + ".", true)
+		return Empty;
+	}
+
+	const std::string* AssetPathManager::FindPath(AssetId Id) const
+	{
+		auto It = m_ConfigMap.find(Id);
+		return It != m_ConfigMap.end() ? &It->second.Path : nullptr;
 	}
 
 	void AssetPathManager::RegisterWithSystemManager()
@@ -0,0 +1,58 @@
+#include <FireGL/Core/AsyncTask.h>
+#include <FireGL/Core/Profiler.h>
+
+#include <chrono>
+
+namespace fgl
+{
+
+	AsyncScheduler::AsyncScheduler(JobSystem& Jobs)
+		: m_Jobs(Jobs)
+	{
+	}
+
+	AsyncScheduler::~AsyncScheduler()
+	{
+		m_Jobs.Wait(m_Counter);
+	}
+
+	void AsyncScheduler::ProcessMainThread(float BudgetMilliseconds)
+	{
+		FGL_PROFILE_SCOPE("AsyncScheduler::ProcessMainThread")
+		{
+			std::lock_guard<std::mutex> Lock(m_Mutex);
+			m_Resuming.insert(m_Resuming.end(), m_MainQueue.begin(), m_MainQueue.end());
+			m_MainQueue.clear();
+		}
+
+		const auto Start = std::chrono::steady_clock::now();
+		const auto Budget = std::chrono::duration<float, std::milli>(BudgetMilliseconds);
+		bool bResumed = false;
+		while (!m_Resuming.empty() && (!bResumed || std::chrono::steady_clock::now() - Start < Budget))
+		{
+			const std::coroutine_handle<> Handle = m_Resuming.front();
+			m_Resuming.pop_front();
+			Handle.resume();
+			bResumed = true;
+		}
+	}
+
+	bool AsyncScheduler::IsBusy() const
+	{
+		std::lock_guard<std::mutex> Lock(m_Mutex);
+		return !m_MainQueue.empty() || !m_Resuming.empty() || !m_Counter.IsDone();
+	}
+
+	size_t AsyncScheduler::GetPendingCount() const
+	{
+		std::lock_guard<std::mutex> Lock(m_Mutex);
+		return m_MainQueue.size() + m_Resuming.size() + m_Counter.Remaining.load(std::memory_order_acquire);
+	}
+
+	void AsyncScheduler::QueueMainThread(std::coroutine_handle<> Handle)
+	{
+		std::lock_guard<std::mutex> Lock(m_Mutex);
+		m_MainQueue.push_back(Handle);
+	}
+
+} // namespace fgl
@@ -1,38 +1,315 @@
 #include <FireGL/Core/BaseLog.h>
+#include <FireGL/Core/MemoryTracker.h>
 #include <stdexcept>
 #include <chrono>
 #include <iomanip>
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
 
 namespace fgl {
 
 	namespace Log {
 
-		std::string GetTimestamp() {
-			auto Now = std::chrono::system_clock::now();
-			auto TimeTNow = std::chrono::system_clock::to_time_t(Now);
+		namespace
+		{
+			enum class Level : uint8_t
+			{
+				Info,
+				Error,
+				Assert
+			};
+
+			/** A message waiting to be written. */
+			struct Record
+			{
+				std::chrono::system_clock::time_point Time; ///< When it was logged.
+				Level Severity = Level::Info;               ///< Selects the tag and the console stream.
+				std::string Text;                           ///< The message, after the source location of errors and asserts.
+			};
+
+			/** Node of the message queue. */
+			struct Node
+			{
+				std::atomic<Node*> Next{ nullptr }; ///< Next message, published by its producer.
+				Record Entry;                       ///< Filled before the node is published.
 
-			std::tm LocalTime;
+				/** @return The bytes the node counts under MemoryTag::Logging while queued. */
+				uint64_t GetTrackedSize() const { return sizeof(Node) + Entry.Text.capacity(); }
+			};
+
+			std::string FormatTimestamp(std::time_t Time)
+			{
+				std::tm LocalTime;
 #if defined(_WIN32) || defined(_WIN64)
-			localtime_s(&LocalTime, &TimeTNow);
+				localtime_s(&LocalTime, &Time);
 #else
-			localtime_r(&TimeTNow, &LocalTime);
+				localtime_r(&Time, &LocalTime);
 #endif
 
-			std::ostringstream Oss;
-			Oss << std::put_time(&LocalTime, "[%Y-%m-%d %H:%M:%S]");
-			return Oss.str();
+				std::ostringstream Oss;
+				Oss << std::put_time(&LocalTime, "[%Y-%m-%d %H:%M:%S]");
+				return Oss.str();
+			}
+
+			/** Formats timestamps, reusing the text while the second doesn't change. */
+			class TimestampCache
+			{
+			public:
+				const std::string& Get(std::chrono::system_clock::time_point Time)
+				{
+					const std::time_t Seconds = std::chrono::system_clock::to_time_t(Time);
+					if (m_Text.empty() || Seconds != m_Seconds)
+					{
+						m_Seconds = Seconds;
+						m_Text = FormatTimestamp(Seconds);
+					}
+					return m_Text;
+				}
+
+			private:
+				std::time_t m_Seconds = 0; ///< Second m_Text shows.
+				std::string m_Text;        ///< Formatted timestamp.
+			};
+
+			void AppendRecord(std::string& Output, const std::string& Timestamp, const Record& Entry)
+			{
+				Output += Timestamp;
+				switch (Entry.Severity)
+				{
+				case Level::Info:
+					Output += " [INFO]: ";
+					Output += Entry.Text;
+					Output += '\n';
+					return;
+				case Level::Error:
+					Output += " [ERROR] ";
+					break;
+				case Level::Assert:
+					Output += " [ASSERTION FAILED] ";
+					break;
+				}
+				Output += Entry.Text;
+				Output += "\n----------------\n";
+			}
+
+			/** The optional log file, written by the background thread or by synchronous calls. */
+			struct FileSink
+			{
+				std::mutex Mutex;                   ///< Guards File.
+				std::ofstream File;                 ///< Appended to while open.
+				std::atomic<bool> bOpen{ false };   ///< Lets writers skip the lock without a file.
+
+				void Write(const std::string& Text)
+				{
+					if (Text.empty() || !bOpen.load(std::memory_order_acquire))
+						return;
+
+					std::lock_guard<std::mutex> Lock(Mutex);
+					if (File.is_open())
+					{
+						File.write(Text.data(), static_cast<std::streamsize>(Text.size()));
+						File.flush();
+					}
+				}
+			};
+
+			// Never destroyed, like the logger, so static destructors can still log
+			FileSink& GetFileSink()
+			{
+				static FileSink* Instance = new FileSink();
+				return *Instance;
+			}
+
+			/**
+			 * Multi-producer single-consumer queue of messages and the thread writing them.
+			 *
+			 * Producers append with a single exchange on the head (Vyukov's intrusive MPSC queue), the consumer
+			 * follows the next pointers from the tail. A node whose producer exchanged the head but didn't link it
+			 * yet is picked up on the next pass; producers only count their message and wake the consumer after linking.
+			 */
+			class AsyncLogger
+			{
+			public:
+				AsyncLogger()
+					: m_Head(&m_Stub)
+					, m_Tail(&m_Stub)
+				{
+					m_Thread = std::thread(&AsyncLogger::Run, this);
+
+					// Runs before the statics constructed earlier are destroyed, messages logged later are written synchronously
+					std::atexit([]() { Get().Shutdown(); });
+				}
+
+				static AsyncLogger& Get()
+				{
+					static AsyncLogger* Instance = new AsyncLogger();
+					return *Instance;
+				}
+
+				/** @return False once shut down, the record is then left to the caller. */
+				bool Push(Record& Entry)
+				{
+					if (!m_bRunning.load(std::memory_order_acquire))
+						return false;
+
+					Node* Pushed = new Node();
+					Pushed->Entry = std::move(Entry);
+					MemoryTracker::OnAllocate(MemoryTag::Logging, Pushed->GetTrackedSize());
+					Node* Previous = m_Head.exchange(Pushed, std::memory_order_acq_rel);
+					Previous->Next.store(Pushed, std::memory_order_release);
+
+					m_Pushed.fetch_add(1, std::memory_order_release);
+					m_Wake.fetch_add(1, std::memory_order_release);
+					m_Wake.notify_one();
+					return true;
+				}
+
+				void Flush()
+				{
+					const uint64_t Target = m_Pushed.load(std::memory_order_acquire);
+					uint64_t Written = m_Written.load(std::memory_order_acquire);
+					while (Written < Target && m_bRunning.load(std::memory_order_acquire))
+					{
+						m_Written.wait(Written, std::memory_order_acquire);
+						Written = m_Written.load(std::memory_order_acquire);
+					}
+				}
+
+				void Shutdown()
+				{
+					if (!m_bRunning.exchange(false, std::memory_order_acq_rel))
+						return;
+
+					m_Wake.fetch_add(1, std::memory_order_release);
+					m_Wake.notify_one();
+					m_Thread.join();
+				}
+
+			private:
+				void Run()
+				{
+					TimestampCache Timestamps;
+					std::string Output, Errors, File;
+					uint64_t Popped = 0;
+					while (true)
+					{
+						// Read before draining, a push after this changes it and the wait below returns at once
+						const uint32_t Wake = m_Wake.load(std::memory_order_acquire);
+
+						Node* Next = m_Tail->Next.load(std::memory_order_acquire);
+						const bool bFile = GetFileSink().bOpen.load(std::memory_order_acquire);
+						while (Next)
+						{
+							const Record& Entry = Next->Entry;
+							const std::string& Timestamp = Timestamps.Get(Entry.Time);
+							AppendRecord(Entry.Severity == Level::Info ? Output : Errors, Timestamp, Entry);
+							if (bFile)
+							{
+								AppendRecord(File, Timestamp, Entry);
+							}
+
+							// The consumed node becomes the new stub
+							Node* Consumed = m_Tail;
+							m_Tail = Next;
+							if (Consumed != &m_Stub)
+							{
+								MemoryTracker::OnFree(MemoryTag::Logging, Consumed->GetTrackedSize());
+								delete Consumed;
+							}
+							Popped++;
+							Next = m_Tail->Next.load(std::memory_order_acquire);
+						}
+
+						// One write and one flush per stream for the whole batch
+						if (!Output.empty())
+						{
+							std::cout.write(Output.data(), static_cast<std::streamsize>(Output.size()));
+							std::cout.flush();
+							Output.clear();
+						}
+						if (!Errors.empty())
+						{
+							std::cerr.write(Errors.data(), static_cast<std::streamsize>(Errors.size()));
+							std::cerr.flush();
+							Errors.clear();
+						}
+						GetFileSink().Write(File);
+						File.clear();
+
+						m_Written.store(Popped, std::memory_order_release);
+						m_Written.notify_all();
+
+						// A counted message not linked yet, or one still being linked, is picked up right away
+						if (m_Pushed.load(std::memory_order_acquire) > Popped)
+							continue;
+						if (!m_bRunning.load(std::memory_order_acquire))
+							break;
+
+						m_Wake.wait(Wake, std::memory_order_acquire);
+					}
+				}
+
+				Node m_Stub;                             ///< First node, consumed from the start.
+				std::atomic<Node*> m_Head;               ///< Last pushed node, exchanged by producers.
+				Node* m_Tail;                            ///< Last consumed node, owned by the consumer.
+				std::atomic<uint64_t> m_Pushed{ 0 };     ///< Messages pushed and linked.
+				std::atomic<uint64_t> m_Written{ 0 };    ///< Messages written and flushed.
+				std::atomic<uint32_t> m_Wake{ 0 };       ///< Changed by every push and by Shutdown(), the consumer waits on it.
+				std::atomic<bool> m_bRunning{ true };    ///< Cleared by Shutdown().
+				std::thread m_Thread;                    ///< The consumer.
+			};
+
+			std::atomic<bool> s_bAsync{ true };
+			std::atomic<LogLevel> s_Level{ LogLevel::Info };
+
+			void WriteNow(const Record& Entry)
+			{
+				std::string Text;
+				AppendRecord(Text, FormatTimestamp(std::chrono::system_clock::to_time_t(Entry.Time)), Entry);
+				std::ostream& Stream = Entry.Severity == Level::Info ? std::cout : std::cerr;
+				Stream.write(Text.data(), static_cast<std::streamsize>(Text.size()));
+				Stream.flush();
+				GetFileSink().Write(Text);
+			}
+
+			void Write(Level Severity, std::string Text)
+			{
+				Record Entry{ std::chrono::system_clock::now(), Severity, std::move(Text) };
+				if (s_bAsync.load(std::memory_order_relaxed) && AsyncLogger::Get().Push(Entry))
+					return;
+
+				WriteNow(Entry);
+			}
+
+			std::string WithLocation(std::string_view Message, const char* File, int Line)
+			{
+				return "(" + std::string(File) + ":" + std::to_string(Line) + "): \n" + std::string(Message);
+			}
+		}
+
+		std::string GetTimestamp() {
+			return FormatTimestamp(std::chrono::system_clock::to_time_t(std::chrono::system_clock::now()));
 		}
 
 		void Log(std::string_view Message)
 		{
-			std::cout << GetTimestamp() << " [INFO]: " << Message << std::endl;
+			if (!IsEnabled(LogLevel::Info))
+				return;
+
+			Write(Level::Info, std::string(Message));
 		}
 
 		void Error(std::string_view ErrorMessage, const char* File, int Line, bool ShoudThrow)
 		{
-			std::cerr << GetTimestamp() << " [ERROR] (" << File << ":" << Line << "): \n" << ErrorMessage << "\n----------------" << std::endl;
+			if (IsEnabled(LogLevel::Error))
+			{
+				Write(Level::Error, WithLocation(ErrorMessage, File, Line));
+			}
 			if (ShoudThrow)
 			{
+				Flush();
 				throw std::runtime_error(ErrorMessage.data());
 			}
 		}
@@ -41,15 +318,61 @@ namespace fgl {
 		{
 			if (!Condition)
 			{
-				std::cerr << GetTimestamp() << " [ASSERTION FAILED] (" << File << ":" << Line << "): \n" << AssertMessage << "\n----------------" << std::endl;
+				Write(Level::Assert, WithLocation(AssertMessage, File, Line));
 				if (Callback)
 				{
 					Callback();
 				}
+				Flush();
 				throw std::runtime_error(AssertMessage.data());
 			}
 		}
 
+		void SetLevel(LogLevel Level)
+		{
+			s_Level.store(Level, std::memory_order_relaxed);
+		}
+
+		LogLevel GetLevel()
+		{
+			return s_Level.load(std::memory_order_relaxed);
+		}
+
+		void SetAsync(bool bAsync)
+		{
+			// Queued messages are written before the first synchronous one
+			if (!bAsync)
+			{
+				Flush();
+			}
+			s_bAsync.store(bAsync, std::memory_order_relaxed);
+		}
+
+		bool SetFileSink(std::string_view Path)
+		{
+			FileSink& Sink = GetFileSink();
+			std::lock_guard<std::mutex> Lock(Sink.Mutex);
+			Sink.bOpen.store(false, std::memory_order_release);
+			if (Sink.File.is_open())
+			{
+				Sink.File.close();
+			}
+			if (Path.empty())
+				return true;
+
+			Sink.File.open(std::string(Path), std::ios::out | std::ios::app);
+			Sink.bOpen.store(Sink.File.is_open(), std::memory_order_release);
+			return Sink.File.is_open();
+		}
+
+		void Flush()
+		{
+			if (s_bAsync.load(std::memory_order_relaxed))
+			{
+				AsyncLogger::Get().Flush();
+			}
+		}
+
 	}
 
-} // namespace fgl
\ No newline at end of file
+} // namespace fgl
@@ -0,0 +1,64 @@
+#include <FireGL/Core/FrameArena.h>
+
+namespace fgl
+{
+
+	FrameArena::FrameArena(size_t InitialSize)
+	{
+		for (FrameBuffer& Buffer : m_Buffers)
+		{
+			Buffer.Size = InitialSize;
+			Buffer.Memory = std::make_unique<std::byte[]>(InitialSize);
+			CreateResource(Buffer);
+		}
+	}
+
+	void FrameArena::BeginFrame()
+	{
+		m_Current = (m_Current + 1) % 2;
+		FrameBuffer& Buffer = m_Buffers[m_Current];
+
+		// Releasing rewinds to the start of the buffer and frees the heap blocks of an overflowing frame
+		Buffer.Resource->release();
+		if (Buffer.Overflow.OverflowBytes == 0)
+			return;
+
+		// The buffer absorbs the overflow from now on
+		Buffer.Size += Buffer.Overflow.OverflowBytes * 2;
+		Buffer.Memory = std::make_unique<std::byte[]>(Buffer.Size);
+		CreateResource(Buffer);
+	}
+
+	std::pmr::memory_resource* FrameArena::GetResource()
+	{
+		return &*m_Buffers[m_Current].Resource;
+	}
+
+	size_t FrameArena::GetCapacity() const
+	{
+		return m_Buffers[m_Current].Size;
+	}
+
+	void FrameArena::CreateResource(FrameBuffer& Buffer)
+	{
+		Buffer.Overflow.OverflowBytes = 0;
+		Buffer.Resource.emplace(Buffer.Memory.get(), Buffer.Size, &Buffer.Overflow);
+	}
+
+	void* FrameArena::OverflowResource::do_allocate(size_t Bytes, size_t Alignment)
+	{
+		OverflowBytes += Bytes;
+		return std::pmr::new_delete_resource()->allocate(Bytes, Alignment);
+	}
+
+	void FrameArena::OverflowResource::do_deallocate(void* Pointer, size_t Bytes, size_t Alignment)
+	{
+		std::pmr::new_delete_resource()->deallocate(Pointer, Bytes, Alignment);
+	}
+
+	bool FrameArena::OverflowResource::do_is_equal(const std::pmr::memory_resource& Other) const noexcept
+	{
+		return this == &Other;
+	}
+
+} // namespace fgl
\ No newline at end of file
@@ -0,0 +1,90 @@
+#include <FireGL/Core/FrameLimiter.h>
+
+#include <thread>
+
+namespace fgl
+{
+
+	namespace
+	{
+		constexpr auto MinSpinMargin = std::chrono::microseconds(200);   ///< Kept even when sleeps are precise.
+		constexpr auto MaxSpinMargin = std::chrono::microseconds(16000); ///< Beyond a Windows timer tick, sleeping is pointless.
+		constexpr uint32_t MarginWindow = 120;                           ///< Sleeps between two adjustments of the margin.
+	}
+
+	void FrameLimiter::SetTargetFrameRate(double FramesPerSecond)
+	{
+		m_Period = FramesPerSecond > 0.0
+			? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / FramesPerSecond))
+			: Clock::duration::zero();
+		m_NextDeadline = Clock::now() + m_Period;
+	}
+
+	double FrameLimiter::GetTargetFrameRate() const
+	{
+		return IsEnabled() ? 1.0 / std::chrono::duration<double>(m_Period).count() : 0.0;
+	}
+
+	bool FrameLimiter::IsEnabled() const
+	{
+		return m_Period > Clock::duration::zero();
+	}
+
+	void FrameLimiter::Wait()
+	{
+		if (!IsEnabled())
+		{
+			m_LastWaitTime = 0.0;
+			return;
+		}
+
+		const Clock::time_point Start = Clock::now();
+		if (Start < m_NextDeadline)
+		{
+			SleepUntil(m_NextDeadline);
+			while (Clock::now() < m_NextDeadline)
+			{
+				std::this_thread::yield();
+			}
+		}
+
+		const Clock::time_point End = Clock::now();
+		m_LastWaitTime = std::chrono::duration<double>(End - Start).count();
+
+		// A frame later than a whole period starts a new schedule rather than bursting to catch up
+		m_NextDeadline += m_Period;
+		if (m_NextDeadline < End)
+		{
+			m_NextDeadline = End + m_Period;
+		}
+	}
+
+	double FrameLimiter::GetLastWaitTime() const
+	{
+		return m_LastWaitTime;
+	}
+
+	void FrameLimiter::SleepUntil(Clock::time_point Deadline)
+	{
+		const Clock::time_point WakeUp = Deadline - m_SpinMargin;
+		if (Clock::now() >= WakeUp)
+			return;
+
+		std::this_thread::sleep_until(WakeUp);
+		m_WorstOversleep = std::max(m_WorstOversleep, Clock::now() - WakeUp);
+
+		// The margin follows the worst oversleep of the last window, with headroom, so it shrinks again once the system is idle
+		if (++m_SleepCount >= MarginWindow)
+		{
+			const Clock::duration Margin = m_WorstOversleep + m_WorstOversleep / 4;
+			m_SpinMargin = std::clamp<Clock::duration>(Margin, MinSpinMargin, MaxSpinMargin);
+			m_WorstOversleep = Clock::duration::zero();
+			m_SleepCount = 0;
+		}
+		else if (m_WorstOversleep > m_SpinMargin)
+		{
+			m_SpinMargin = std::min<Clock::duration>(m_WorstOversleep + m_WorstOversleep / 4, MaxSpinMargin);
+		}
+	}
+
+} // namespace fgl
@@ -0,0 +1,178 @@
+#include <FireGL/Core/FrameTaskGraph.h>
+#include <FireGL/Core/JobSystem.h>
+#include <FireGL/Core/Profiler.h>
+#include <FireGL/Core/BaseLog.h>
+
+namespace fgl
+{
+
+	FrameTaskGraph::TaskId FrameTaskGraph::AddTask(std::string_view Name, Task Body, std::initializer_list<TaskId> Dependencies, TaskAffinity Affinity)
+	{
+		const TaskId Id = static_cast<TaskId>(m_Nodes.size());
+		Node& Added = m_Nodes.emplace_back();
+		Added.Name = Name;
+		Added.Body = std::move(Body);
+		Added.Affinity = Affinity;
+		for (TaskId Dependency : Dependencies)
+		{
+			AddDependency(Id, Dependency);
+		}
+		m_bValidated = false;
+		return Id;
+	}
+
+	void FrameTaskGraph::AddDependency(TaskId Dependent, TaskId Dependency)
+	{
+		LOG_ASSERT(Dependent < m_Nodes.size() && Dependency < m_Nodes.size(), "Invalid frame task id.")
+		LOG_ASSERT(Dependent != Dependency, "A frame task can't depend on itself.")
+		m_Nodes[Dependency].Dependents.push_back(Dependent);
+		m_Nodes[Dependent].DependencyCount++;
+		m_bValidated = false;
+	}
+
+	void FrameTaskGraph::Clear()
+	{
+		m_Nodes.clear();
+		m_bValidated = false;
+	}
+
+	void FrameTaskGraph::Run(JobSystem& Jobs)
+	{
+		FGL_PROFILE_SCOPE("FrameTaskGraph::Run")
+		if (m_Nodes.empty())
+			return;
+
+		if (!m_bValidated)
+		{
+			Validate();
+			m_bValidated = true;
+		}
+		if (m_RemainingSize < m_Nodes.size())
+		{
+			m_Remaining = std::make_unique<std::atomic<uint32_t>[]>(m_Nodes.size());
+			m_RemainingSize = m_Nodes.size();
+		}
+		for (TaskId Id = 0; Id < m_Nodes.size(); Id++)
+		{
+			m_Remaining[Id].store(m_Nodes[Id].DependencyCount, std::memory_order_relaxed);
+		}
+
+		JobCounter Counter;
+		m_Counter = &Counter;
+		m_Finished = 0;
+		m_MainQueue.clear();
+		for (TaskId Id = 0; Id < m_Nodes.size(); Id++)
+		{
+			if (m_Nodes[Id].DependencyCount == 0)
+			{
+				Dispatch(Id, Jobs);
+			}
+		}
+
+		// The calling thread runs its own tasks as they become ready, sleeping while only workers have work
+		std::unique_lock<std::mutex> Lock(m_Mutex);
+		while (m_Finished < m_Nodes.size())
+		{
+			if (m_MainQueue.empty())
+			{
+				m_Condition.wait(Lock, [this] { return !m_MainQueue.empty() || m_Finished == m_Nodes.size(); });
+				continue;
+			}
+
+			const TaskId Id = m_MainQueue.back();
+			m_MainQueue.pop_back();
+			Lock.unlock();
+			Execute(Id, Jobs);
+			Lock.lock();
+		}
+		Lock.unlock();
+
+		// The last worker task signals before its job returns
+		Jobs.Wait(Counter);
+		m_Counter = nullptr;
+	}
+
+	FrameTaskGraph::TaskId FrameTaskGraph::FindTask(std::string_view Name) const
+	{
+		for (TaskId Id = 0; Id < m_Nodes.size(); Id++)
+		{
+			if (m_Nodes[Id].Name == Name)
+				return Id;
+		}
+		return InvalidTask;
+	}
+
+	size_t FrameTaskGraph::GetTaskCount() const
+	{
+		return m_Nodes.size();
+	}
+
+	void FrameTaskGraph::Validate() const
+	{
+		std::vector<uint32_t> Remaining(m_Nodes.size());
+		std::vector<TaskId> Ready;
+		for (TaskId Id = 0; Id < m_Nodes.size(); Id++)
+		{
+			Remaining[Id] = m_Nodes[Id].DependencyCount;
+			if (Remaining[Id] == 0)
+			{
+				Ready.push_back(Id);
+			}
+		}
+
+		size_t Visited = 0;
+		while (!Ready.empty())
+		{
+			const TaskId Id = Ready.back();
+			Ready.pop_back();
+			Visited++;
+			for (TaskId Dependent : m_Nodes[Id].Dependents)
+			{
+				if (--Remaining[Dependent] == 0)
+				{
+					Ready.push_back(Dependent);
+				}
+			}
+		}
+		LOG_ASSERT(Visited == m_Nodes.size(), "The frame task graph has a dependency cycle.")
+	}
+
+	void FrameTaskGraph::Execute(TaskId Id, JobSystem& Jobs)
+	{
+		const Node& Current = m_Nodes[Id];
+		{
+#if defined(FIREGL_ENABLE_PROFILER)
+			ProfileScope Zone(Current.Name.c_str());
+#endif
+			Current.Body();
+		}
+
+		for (TaskId Dependent : Current.Dependents)
+		{
+			if (m_Remaining[Dependent].fetch_sub(1, std::memory_order_acq_rel) == 1)
+			{
+				Dispatch(Dependent, Jobs);
+			}
+		}
+
+		std::lock_guard<std::mutex> Lock(m_Mutex);
+		if (++m_Finished == m_Nodes.size())
+		{
+			m_Condition.notify_one();
+		}
+	}
+
+	void FrameTaskGraph::Dispatch(TaskId Id, JobSystem& Jobs)
+	{
+		if (m_Nodes[Id].Affinity == TaskAffinity::MainThread)
+		{
+			std::lock_guard<std::mutex> Lock(m_Mutex);
+			m_MainQueue.push_back(Id);
+			m_Condition.notify_one();
+			return;
+		}
+
+		Jobs.Schedule([this, Id, &Jobs]() { Execute(Id, Jobs); }, *m_Counter);
+	}
+
+} // namespace fgl
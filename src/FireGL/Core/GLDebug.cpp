@@ -0,0 +1,118 @@
+#include <FireGL/Core/GLDebug.h>
+#include <FireGL/Core/BaseLog.h>
+
+#include <External/GLFW/glfw3.h>
+
+namespace fgl
+{
+
+	namespace
+	{
+		using PushDebugGroupProc = void (APIENTRYP)(GLenum Source, GLuint ID, GLsizei Length, const GLchar* Message);
+		using PopDebugGroupProc = void (APIENTRYP)();
+		using ObjectLabelProc = void (APIENTRYP)(GLenum Identifier, GLuint Name, GLsizei Length, const GLchar* Label);
+		using DebugMessageCallbackProc = void (APIENTRYP)(GLDEBUGPROC Callback, const void* UserParam);
+		using DebugMessageControlProc = void (APIENTRYP)(GLenum Source, GLenum Type, GLenum Severity, GLsizei Count, const GLuint* IDs, GLboolean bEnabled);
+
+		PushDebugGroupProc s_PushDebugGroup = nullptr;
+		PopDebugGroupProc s_PopDebugGroup = nullptr;
+		ObjectLabelProc s_ObjectLabel = nullptr;
+		DebugMessageCallbackProc s_DebugMessageCallback = nullptr;
+		DebugMessageControlProc s_DebugMessageControl = nullptr;
+
+		/** Loads the core entry points, or their KHR-suffixed twins on contexts older than 4.3. */
+		template<typename Proc>
+		Proc LoadProc(const char* Name, Proc Core)
+		{
+			return Core ? Core : reinterpret_cast<Proc>(glfwGetProcAddress((std::string(Name) + "KHR").c_str()));
+		}
+
+		void APIENTRY OnDebugMessage(GLenum Source, GLenum Type, GLuint ID, GLenum Severity, GLsizei Length, const GLchar* Message, const void* UserParam)
+		{
+			// Notifications report buffer placements and the like, they would flood the log
+			if (Severity == GL_DEBUG_SEVERITY_NOTIFICATION)
+				return;
+
+			const std::string Text = "OpenGL debug message " + std::to_string(ID) + ": " + (Length >= 0 ? std::string(Message, Length) : std::string(Message));
+			if (Severity == GL_DEBUG_SEVERITY_HIGH || Type == GL_DEBUG_TYPE_ERROR)
+			{
+				LOG_ERROR(Text, false);
+			}
+			else
+			{
+				LOG_INFO(Text);
+			}
+		}
+	}
+
+	bool GLDebug::s_bAvailable = false;
+	GLint GLDebug::s_MaxLabel = 0;
+
+	bool GLDebug::Initialize(bool bMessageCallback)
+	{
+		s_bAvailable = false;
+		if (!GLAD_GL_VERSION_4_3 && !glfwExtensionSupported("GL_KHR_debug"))
+			return false;
+
+		s_PushDebugGroup = LoadProc("glPushDebugGroup", glad_glPushDebugGroup);
+		s_PopDebugGroup = LoadProc("glPopDebugGroup", glad_glPopDebugGroup);
+		s_ObjectLabel = LoadProc("glObjectLabel", glad_glObjectLabel);
+		s_DebugMessageCallback = LoadProc("glDebugMessageCallback", glad_glDebugMessageCallback);
+		s_DebugMessageControl = LoadProc("glDebugMessageControl", glad_glDebugMessageControl);
+		if (!s_PushDebugGroup || !s_PopDebugGroup || !s_ObjectLabel)
+			return false;
+
+		glGetIntegerv(GL_MAX_LABEL_LENGTH, &s_MaxLabel);
+		s_bAvailable = true;
+
+		if (bMessageCallback && s_DebugMessageCallback)
+		{
+			// Synchronous output puts the offending call on the callback's stack, for breakpoints
+			glEnable(GL_DEBUG_OUTPUT);
+			glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+			s_DebugMessageCallback(OnDebugMessage, nullptr);
+			if (s_DebugMessageControl)
+			{
+				// The groups pushed every pass would otherwise each send a message
+				s_DebugMessageControl(GL_DEBUG_SOURCE_APPLICATION, GL_DEBUG_TYPE_PUSH_GROUP, GL_DONT_CARE, 0, nullptr, GL_FALSE);
+				s_DebugMessageControl(GL_DEBUG_SOURCE_APPLICATION, GL_DEBUG_TYPE_POP_GROUP, GL_DONT_CARE, 0, nullptr, GL_FALSE);
+			}
+		}
+		return true;
+	}
+
+	bool GLDebug::IsAvailable()
+	{
+		return s_bAvailable;
+	}
+
+	void GLDebug::PushGroup(std::string_view Name)
+	{
+		if (!s_bAvailable)
+			return;
+
+		s_PushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, static_cast<GLsizei>(std::min<size_t>(Name.size(), s_MaxLabel - 1)), Name.data());
+	}
+
+	void GLDebug::PopGroup()
+	{
+		if (!s_bAvailable)
+			return;
+
+		s_PopDebugGroup();
+	}
+
+	void GLDebug::Label(GLenum Identifier, GLuint Object, std::string_view Label)
+	{
+		if (!s_bAvailable || Object == 0)
+			return;
+
+		// Paths keep their most telling end, the file name
+		if (Label.size() >= static_cast<size_t>(s_MaxLabel))
+		{
+			Label.remove_prefix(Label.size() - (s_MaxLabel - 1));
+		}
+		s_ObjectLabel(Identifier, Object, static_cast<GLsizei>(Label.size()), Label.data());
+	}
+
+} // namespace fgl
@@ -0,0 +1,151 @@
+#include <FireGL/Core/GLUploadThread.h>
+#include <FireGL/Core/BaseLog.h>
+#include <FireGL/Core/Profiler.h>
+
+#include <External/GLFW/glfw3.h>
+
+namespace fgl
+{
+
+	GLUploadThread::~GLUploadThread()
+	{
+		if (IsRunning())
+		{
+			Stop();
+		}
+	}
+
+	bool GLUploadThread::Start(GLFWwindow* SharedWith)
+	{
+		LOG_ASSERT(!IsRunning(), "The upload thread is already running")
+		LOG_ASSERT(SharedWith, "The upload thread needs a window to share objects with")
+
+		// The context hints of the window are still set, only its visibility differs
+		glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+		m_Context = glfwCreateWindow(1, 1, "FireGL Upload Context", nullptr, SharedWith);
+		glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+		if (!m_Context)
+		{
+			LOG_ERROR("Failed to create the shared context of the upload thread, uploads stay on the main thread.", false);
+			return false;
+		}
+
+		m_bStopping = false;
+		m_Thread = std::thread(&GLUploadThread::Run, this);
+		return true;
+	}
+
+	void GLUploadThread::Stop()
+	{
+		if (!IsRunning())
+			return;
+
+		{
+			std::lock_guard<std::mutex> Lock(m_Mutex);
+			m_bStopping = true;
+		}
+		m_Condition.notify_all();
+		m_Thread.join();
+
+		// The fences belong to the share group: the main context waits on them, so every upload is usable once stopped
+		for (const Fence& Pending : m_Fences)
+		{
+			glClientWaitSync(Pending.Sync, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+			glDeleteSync(Pending.Sync);
+		}
+		m_Fences.clear();
+		m_CompletedTicket = m_SubmittedTicket;
+
+		glfwDestroyWindow(m_Context);
+		m_Context = nullptr;
+	}
+
+	bool GLUploadThread::IsRunning() const
+	{
+		return m_Thread.joinable();
+	}
+
+	uint64_t GLUploadThread::Enqueue(std::function<void()> Upload)
+	{
+		LOG_ASSERT(IsRunning(), "Uploads are queued on a running upload thread")
+		uint64_t Ticket;
+		{
+			std::lock_guard<std::mutex> Lock(m_Mutex);
+			Ticket = m_NextTicket++;
+			m_Uploads.emplace_back(Ticket, std::move(Upload));
+		}
+		m_Condition.notify_all();
+		return Ticket;
+	}
+
+	bool GLUploadThread::IsComplete(uint64_t Ticket)
+	{
+		if (Ticket <= m_CompletedTicket)
+			return true;
+
+		PollFences(0);
+		return Ticket <= m_CompletedTicket;
+	}
+
+	void GLUploadThread::Wait(uint64_t Ticket)
+	{
+		FGL_PROFILE_SCOPE("GLUploadThread::Wait")
+		while (!IsComplete(Ticket))
+		{
+			// Wait for the upload to be run, then for its fence
+			std::unique_lock<std::mutex> Lock(m_Mutex);
+			m_Condition.wait(Lock, [this, Ticket]() { return m_SubmittedTicket >= Ticket; });
+			Lock.unlock();
+			PollFences(GL_TIMEOUT_IGNORED);
+		}
+	}
+
+	void GLUploadThread::PollFences(uint64_t TimeoutNanoseconds)
+	{
+		std::lock_guard<std::mutex> Lock(m_Mutex);
+		while (!m_Fences.empty())
+		{
+			const Fence& Oldest = m_Fences.front();
+			const GLenum Status = glClientWaitSync(Oldest.Sync, GL_SYNC_FLUSH_COMMANDS_BIT, TimeoutNanoseconds);
+			if (Status != GL_ALREADY_SIGNALED && Status != GL_CONDITION_SATISFIED)
+				return;
+
+			glDeleteSync(Oldest.Sync);
+			m_CompletedTicket = Oldest.Ticket;
+			m_Fences.pop_front();
+			TimeoutNanoseconds = 0;
+		}
+	}
+
+	void GLUploadThread::Run()
+	{
+		glfwMakeContextCurrent(m_Context);
+		while (true)
+		{
+			std::pair<uint64_t, std::function<void()>> Upload;
+			{
+				std::unique_lock<std::mutex> Lock(m_Mutex);
+				m_Condition.wait(Lock, [this]() { return !m_Uploads.empty() || m_bStopping; });
+				if (m_Uploads.empty())
+					break;
+
+				Upload = std::move(m_Uploads.front());
+				m_Uploads.pop_front();
+			}
+
+			Upload.second();
+
+			// The flush makes the fence reachable by the main context, which never waits on this one
+			GLsync Sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+			glFlush();
+			{
+				std::lock_guard<std::mutex> Lock(m_Mutex);
+				m_Fences.push_back({ Upload.first, Sync });
+				m_SubmittedTicket = Upload.first;
+			}
+			m_Condition.notify_all();
+		}
+		glfwMakeContextCurrent(nullptr);
+	}
+
+} // namespace fgl
@@ -0,0 +1,103 @@
+#include <FireGL/Core/InputEventQueue.h>
+
+#include <External/GLFW/glfw3.h>
+
+namespace fgl
+{
+
+	void InputEventQueue::Push(const InputEvent& Event)
+	{
+		if (m_Size == Capacity)
+		{
+			m_First = (m_First + 1) % Capacity;
+			m_Size--;
+			m_Dropped++;
+		}
+		m_Events[(m_First + m_Size) % Capacity] = Event;
+		m_Size++;
+	}
+
+	void InputEventQueue::PushKey(int Key, int Action, int Mods)
+	{
+		InputEvent Event;
+		Event.Type = InputEventType::Key;
+		Event.Time = glfwGetTime();
+		Event.Code = Key;
+		Event.Action = Action;
+		Event.Mods = Mods;
+		Push(Event);
+	}
+
+	void InputEventQueue::PushMouseButton(int Button, int Action, int Mods)
+	{
+		InputEvent Event;
+		Event.Type = InputEventType::MouseButton;
+		Event.Time = glfwGetTime();
+		Event.Code = Button;
+		Event.Action = Action;
+		Event.Mods = Mods;
+		Push(Event);
+	}
+
+	void InputEventQueue::PushCursorPosition(double XPos, double YPos)
+	{
+		const glm::dvec2 Position(XPos, YPos);
+		if (!m_bHasCursor)
+		{
+			m_LastCursor = Position;
+			m_bHasCursor = true;
+			return;
+		}
+
+		const glm::dvec2 Offset = Position - m_LastCursor;
+		m_LastCursor = Position;
+		m_MouseDelta += Offset;
+
+		InputEvent Event;
+		Event.Type = InputEventType::CursorMove;
+		Event.Time = glfwGetTime();
+		Event.X = Offset.x;
+		Event.Y = Offset.y;
+		Push(Event);
+	}
+
+	void InputEventQueue::PushScroll(double XOffset, double YOffset)
+	{
+		InputEvent Event;
+		Event.Type = InputEventType::Scroll;
+		Event.Time = glfwGetTime();
+		Event.X = XOffset;
+		Event.Y = YOffset;
+		Push(Event);
+	}
+
+	void InputEventQueue::ResetCursor()
+	{
+		m_bHasCursor = false;
+	}
+
+	bool InputEventQueue::Pop(InputEvent& Event)
+	{
+		if (m_Size == 0)
+			return false;
+
+		Event = m_Events[m_First];
+		m_First = (m_First + 1) % Capacity;
+		m_Size--;
+		return true;
+	}
+
+	void InputEventQueue::Clear()
+	{
+		m_First = 0;
+		m_Size = 0;
+	}
+
+	glm::dvec2 InputEventQueue::ConsumeMouseDelta()
+	{
+		const glm::dvec2 Delta = m_MouseDelta;
+		m_MouseDelta = glm::dvec2(0.0);
+		return Delta;
+	}
+
+} // namespace fgl
@@ -1,6 +1,7 @@
 #include <FireGL/Core/InputManager.h>
 #include <FireGL/Core/SystemManager.h>
 #include <FireGL/Core/TimeManager.h>
+#include <FireGL/Core/Profiler.h>
 
 namespace fgl {
 
@@ -33,69 +34,114 @@ namespace fgl {
 
 	void InputManager::ProcessInput()
 	{
+		FGL_PROFILE_SCOPE("InputManager::ProcessInput")
+		if (m_InputMode == InputMode::Replaying)
+		{
+			if (m_InputFrame >= m_Recording.FrameFocus.size())
+			{
+				LOG_INFO("Input replay finished after " + std::to_string(m_InputFrame) + " frames.")
+				StopReplay();
+			}
+			else
+			{
+				ReplayInputs(RecordedInputPhase::FrameStart);
+			}
+		}
+
 		BaseWindow* Window = SystemManager<BaseWindow>::Get();
 		if (Window)
 		{
-			if (Window->IsFocused())
+			if (IsFrameFocused(*Window))
 			{
 				UpdateKeyState();
 				OnProcessInput();
 				ProcessRegisteredEvents();
+				ProcessActions();
 			}
 		}
 		else
 		{
 			LOG_ERROR("Failed to retrieve the Window class when attempting to get the window's focus state.", true);
 		}
+		m_InputFrame++;
 	}
 
-	bool InputManager::IsKeyPressed(int Key) const
+	bool InputManager::IsFrameFocused(const BaseWindow& Window)
 	{
-		auto It = m_CurrentKeyStates.find(Key);
-		if (It != m_CurrentKeyStates.end())
+		if (m_InputMode == InputMode::Replaying)
+			return m_InputFrame < m_Recording.FrameFocus.size() && m_Recording.FrameFocus[m_InputFrame] != 0;
+
+		const bool bFocused = Window.IsFocused();
+		if (m_InputMode == InputMode::Recording)
 		{
-			return It->second && !m_PreviousKeyStates.at(Key);
+			m_Recording.FrameFocus.push_back(bFocused ? 1 : 0);
 		}
-		return false;
+		return bFocused;
+	}
+
+	bool InputManager::IsKeyPressed(int Key) const
+	{
+		if (Key < 0 || Key >= InputCodeCount)
+			return false;
+
+		return m_CurrentKeyStates[Key] && !m_PreviousKeyStates[Key];
 	}
 
 	bool InputManager::IsKeyTriggered(int Key) const
 	{
-		auto It = m_CurrentKeyStates.find(Key);
-		if (It != m_CurrentKeyStates.end())
-		{
-			return It->second;
-		}
-		return false;
+		if (Key < 0 || Key >= InputCodeCount)
+			return false;
+
+		return m_CurrentKeyStates[Key];
 	}
 
 	bool InputManager::IsKeyReleased(int Key) const
 	{
-		auto It = m_CurrentKeyStates.find(Key);
-		if (It != m_CurrentKeyStates.end())
-		{
-			return !It->second && m_PreviousKeyStates.at(Key);
-		}
-		return false;
+		if (Key < 0 || Key >= InputCodeCount)
+			return false;
+
+		return !m_CurrentKeyStates[Key] && m_PreviousKeyStates[Key];
 	}
 
 	void InputManager::UpdateKeyState()
 	{
+		PollGamepad();
 		m_PreviousKeyStates = m_CurrentKeyStates;
+		m_CurrentKeyStates = m_KeyDown;
 
-		for (int Key = 0; Key <= GLFW_KEY_LAST; ++Key)
+		// A key pressed and released between two frames changed but isn't pressed in either, like when it was polled
+		m_FrameChangedKeys.swap(m_ChangedKeys);
+		m_ChangedKeys.clear();
+		m_bKeyChanged.reset();
+	}
+
+	void InputManager::SetInputDown(int Code, bool bDown)
+	{
+		m_KeyDown[Code] = bDown;
+		if (!m_bKeyChanged[Code])
 		{
-			bool IsPressed = (glfwGetKey(SystemManager<BaseWindow>::Get()->GetWindowPtr(), Key) == GLFW_PRESS);
+			m_bKeyChanged[Code] = true;
+			m_ChangedKeys.push_back(Code);
+		}
+	}
 
-			// Handle key press logic
-			if (IsPressed && !m_PreviousKeyStates[Key]) 
-			{
-				m_CurrentKeyStates[Key] = true;
-			}
-			// Handle key release logic
-			else if (!IsPressed && m_PreviousKeyStates[Key]) 
+	void InputManager::PollGamepad()
+	{
+		// Replayed gamepad buttons were delivered with the frame's other inputs
+		if (m_InputMode == InputMode::Replaying || !glfwJoystickIsGamepad(GLFW_JOYSTICK_1))
+			return;
+
+		GLFWgamepadstate State;
+		if (!glfwGetGamepadState(GLFW_JOYSTICK_1, &State))
+			return;
+
+		for (int Button = 0; Button <= GLFW_GAMEPAD_BUTTON_LAST; Button++)
+		{
+			const bool bDown = State.buttons[Button] == GLFW_PRESS;
+			if (m_KeyDown[GamepadButton(Button)] != bDown)
 			{
-				m_CurrentKeyStates[Key] = false;
+				RecordInput(RecordedInputType::GamepadButton, Button, bDown ? GLFW_PRESS : GLFW_RELEASE, 0);
+				SetInputDown(GamepadButton(Button), bDown);
 			}
 		}
 	}
@@ -109,38 +155,232 @@ namespace fgl {
 
 	void InputManager::ProcessPressedEvents()
 	{
-		for (const auto& [Key, Callback] : m_OnPressedCallbacks)
+		if (m_OnPressedCallbacks.empty())
+			return;
+
+		for (int Key : m_FrameChangedKeys)
 		{
-			if (m_CurrentKeyStates[Key] && !m_PreviousKeyStates[Key])
+			auto Callback = m_OnPressedCallbacks.find(Key);
+			if (Callback != m_OnPressedCallbacks.end() && IsKeyPressed(Key))
 			{
-				InvokeCallback(Callback, Key, "pressed");
+				InvokeCallback(Callback->second, Key, "pressed");
 			}
 		}
 	}
 
 	void InputManager::ProcessTriggeredEvents()
 	{
+		// Collected first, a callback registering a binding may rehash the map under the loop
+		m_TriggeredKeys.clear();
 		for (const auto& [Key, Callback] : m_OnTriggeredCallbacks)
 		{
-			if (m_CurrentKeyStates[Key])
+			if (IsKeyTriggered(Key))
+			{
+				m_TriggeredKeys.push_back(Key);
+			}
+		}
+
+		for (int Key : m_TriggeredKeys)
+		{
+			auto Callback = m_OnTriggeredCallbacks.find(Key);
+			if (Callback != m_OnTriggeredCallbacks.end())
 			{
-				InvokeCallback(Callback, Key, "triggered");
+				InvokeCallback(Callback->second, Key, "triggered");
 			}
 		}
 	}
 
 	void InputManager::ProcessReleasedEvents()
 	{
-		for (const auto& [Key, Callback] : m_OnReleasedCallbacks)
+		if (m_OnReleasedCallbacks.empty())
+			return;
+
+		for (int Key : m_FrameChangedKeys)
+		{
+			auto Callback = m_OnReleasedCallbacks.find(Key);
+			if (Callback != m_OnReleasedCallbacks.end() && IsKeyReleased(Key))
+			{
+				InvokeCallback(Callback->second, Key, "released");
+			}
+		}
+	}
+
+	InputAction InputManager::AddAction(std::string_view Name)
+	{
+		ActionState& Added = m_Actions.emplace_back();
+		Added.Name = Name;
+		return static_cast<InputAction>(m_Actions.size() - 1);
+	}
+
+	InputAction InputManager::FindAction(std::string_view Name) const
+	{
+		for (size_t Action = 0; Action < m_Actions.size(); Action++)
+		{
+			if (m_Actions[Action].Name == Name)
+				return static_cast<InputAction>(Action);
+		}
+		return InvalidAction;
+	}
+
+	void InputManager::BindAction(InputAction Action, int Code)
+	{
+		LOG_ASSERT(Action < m_Actions.size(), "Binding an action that doesn't exist")
+		LOG_ASSERT(Code >= 0 && Code < InputCodeCount, "Binding an action to an unknown input code")
+
+		uint32_t Binding = m_FreeBindings;
+		if (Binding != NoBinding)
+		{
+			m_FreeBindings = m_Bindings[Binding].Next;
+		}
+		else
+		{
+			Binding = static_cast<uint32_t>(m_Bindings.size());
+			m_Bindings.emplace_back();
+		}
+		m_Bindings[Binding].Action = Action;
+		m_Bindings[Binding].Next = m_FirstBindings[Code];
+		m_FirstBindings[Code] = Binding;
+
+		// An input already held counts from now on, without a pressed event
+		ActionState& State = m_Actions[Action];
+		if (m_CurrentKeyStates[Code] && State.DownInputs++ == 0)
+		{
+			State.bWasDown = true;
+			SetActionDown(Action, true);
+		}
+	}
+
+	void InputManager::UnbindAction(InputAction Action, int Code)
+	{
+		if (Code < 0 || Code >= InputCodeCount)
+			return;
+
+		for (uint32_t* Link = &m_FirstBindings[Code]; *Link != NoBinding; Link = &m_Bindings[*Link].Next)
+		{
+			const uint32_t Binding = *Link;
+			if (m_Bindings[Binding].Action != Action)
+				continue;
+
+			*Link = m_Bindings[Binding].Next;
+			m_Bindings[Binding].Action = InvalidAction;
+			m_Bindings[Binding].Next = m_FreeBindings;
+			m_FreeBindings = Binding;
+			// Nor does an input held when unbound release the action
+			ActionState& State = m_Actions[Action];
+			if (m_CurrentKeyStates[Code] && State.DownInputs > 0 && --State.DownInputs == 0)
+			{
+				State.bWasDown = false;
+				SetActionDown(Action, false);
+			}
+			return;
+		}
+	}
+
+	void InputManager::SetActionCallback(InputAction Action, KeyEventType EventType, FunctionRef<void()> Callback)
+	{
+		LOG_ASSERT(Action < m_Actions.size(), "Setting the callback of an action that doesn't exist")
+		m_Actions[Action].Callbacks[static_cast<size_t>(EventType)] = Callback;
+	}
+
+	bool InputManager::IsActionPressed(InputAction Action) const
+	{
+		return Action < m_Actions.size() && m_Actions[Action].bDown && !m_Actions[Action].bWasDown;
+	}
+
+	bool InputManager::IsActionTriggered(InputAction Action) const
+	{
+		return Action < m_Actions.size() && m_Actions[Action].bDown;
+	}
+
+	bool InputManager::IsActionReleased(InputAction Action) const
+	{
+		return Action < m_Actions.size() && !m_Actions[Action].bDown && m_Actions[Action].bWasDown;
+	}
+
+	void InputManager::ProcessActions()
+	{
+		if (m_Actions.empty())
+			return;
+
+		// Only the actions that changed last frame have a stale previous state
+		for (InputAction Action : m_ChangedActions)
+		{
+			m_Actions[Action].bWasDown = m_Actions[Action].bDown;
+			m_Actions[Action].bChanged = false;
+		}
+		m_ChangedActions.clear();
+
+		for (int Code : m_FrameChangedKeys)
 		{
-			if (!m_CurrentKeyStates[Key] && m_PreviousKeyStates[Key])
+			// A code pressed and released between two frames changed nothing, like for IsKeyPressed()
+			if (m_CurrentKeyStates[Code] == m_PreviousKeyStates[Code])
+				continue;
+
+			const bool bCodeDown = m_CurrentKeyStates[Code];
+			for (uint32_t Binding = m_FirstBindings[Code]; Binding != NoBinding; Binding = m_Bindings[Binding].Next)
 			{
-				InvokeCallback(Callback, Key, "released");
+				const InputAction Action = m_Bindings[Binding].Action;
+				ActionState& State = m_Actions[Action];
+				State.DownInputs = bCodeDown ? State.DownInputs + 1 : (State.DownInputs > 0 ? State.DownInputs - 1 : 0);
+				if ((State.DownInputs > 0) == State.bDown)
+					continue;
+
+				if (!State.bChanged)
+				{
+					State.bChanged = true;
+					m_ChangedActions.push_back(Action);
+				}
+				SetActionDown(Action, State.DownInputs > 0);
+			}
+		}
+
+		// Callbacks run in the order of the key events: pressed, held, then released
+		for (InputAction Action : m_ChangedActions)
+		{
+			const FunctionRef<void()>& Callback = m_Actions[Action].Callbacks[static_cast<size_t>(KeyEventType::OnPressed)];
+			if (Callback && IsActionPressed(Action))
+			{
+				Callback();
+			}
+		}
+		for (size_t Held = 0; Held < m_HeldActions.size(); Held++)
+		{
+			const FunctionRef<void()>& Callback = m_Actions[m_HeldActions[Held]].Callbacks[static_cast<size_t>(KeyEventType::OnTriggered)];
+			if (Callback)
+			{
+				Callback();
+			}
+		}
+		for (InputAction Action : m_ChangedActions)
+		{
+			const FunctionRef<void()>& Callback = m_Actions[Action].Callbacks[static_cast<size_t>(KeyEventType::OnReleased)];
+			if (Callback && IsActionReleased(Action))
+			{
+				Callback();
 			}
 		}
 	}
 
-	void InputManager::InvokeCallback(const std::function<void()>& Callback, int Key, std::string_view EventType)
+	void InputManager::SetActionDown(InputAction Action, bool bDown)
+	{
+		ActionState& State = m_Actions[Action];
+		State.bDown = bDown;
+
+		// Swap-and-pop, the order in which held actions are triggered doesn't matter
+		if (bDown)
+		{
+			State.HeldSlot = static_cast<uint32_t>(m_HeldActions.size());
+			m_HeldActions.push_back(Action);
+			return;
+		}
+		const InputAction Last = m_HeldActions.back();
+		m_HeldActions[State.HeldSlot] = Last;
+		m_Actions[Last].HeldSlot = State.HeldSlot;
+		m_HeldActions.pop_back();
+		State.HeldSlot = NoBinding;
+	}
+
+	void InputManager::InvokeCallback(std::function<void()> Callback, int Key, std::string_view EventType)
 	{
 		if (Callback)
 		{
@@ -160,21 +400,266 @@ namespace fgl {
 
 	void InputManager::UpdateMouse(GLFWwindow* window, double xpos, double ypos)
 	{
-		OnMouseUpdate(xpos, ypos);
+		if (m_InputMode == InputMode::Replaying)
+			return;
+
+		RecordInput(RecordedInputType::Cursor, 0, 0, 0, xpos, ypos);
+		ApplyMouse(xpos, ypos);
 	}
 
 	void InputManager::UpdateScroll(double xoffset, double yoffset)
 	{
+		if (m_InputMode == InputMode::Replaying)
+			return;
+
+		RecordInput(RecordedInputType::Scroll, 0, 0, 0, xoffset, yoffset);
+		ApplyScroll(xoffset, yoffset);
+	}
+
+	void InputManager::UpdateKey(int Key, int Action, int Mods)
+	{
+		if (m_InputMode == InputMode::Replaying)
+			return;
+
+		RecordInput(RecordedInputType::Key, Key, Action, Mods);
+		ApplyKey(Key, Action, Mods);
+	}
+
+	void InputManager::UpdateMouseButton(int Button, int Action, int Mods)
+	{
+		if (m_InputMode == InputMode::Replaying)
+			return;
+
+		RecordInput(RecordedInputType::MouseButton, Button, Action, Mods);
+		ApplyMouseButton(Button, Action, Mods);
+	}
+
+	void InputManager::ResetCursor()
+	{
+		if (m_InputMode == InputMode::Replaying)
+			return;
+
+		RecordInput(RecordedInputType::ResetCursor, 0, 0, 0);
+		ApplyResetCursor();
+	}
+
+	void InputManager::ApplyMouse(double xpos, double ypos)
+	{
+		m_InputEvents.PushCursorPosition(xpos, ypos);
+		OnMouseUpdate(xpos, ypos);
+	}
+
+	void InputManager::ApplyScroll(double xoffset, double yoffset)
+	{
+		m_InputEvents.PushScroll(xoffset, yoffset);
 		OnScrollUpdate(xoffset, yoffset);
 	}
 
+	void InputManager::ApplyKey(int Key, int Action, int Mods)
+	{
+		m_InputEvents.PushKey(Key, Action, Mods);
+
+		// Repeats don't change the state, GLFW_KEY_UNKNOWN has no slot
+		if (Action == GLFW_REPEAT || Key < 0 || Key > GLFW_KEY_LAST)
+			return;
+
+		SetInputDown(Key, Action == GLFW_PRESS);
+	}
+
+	void InputManager::ApplyMouseButton(int Button, int Action, int Mods)
+	{
+		m_InputEvents.PushMouseButton(Button, Action, Mods);
+		if (Button < 0 || Button > GLFW_MOUSE_BUTTON_LAST)
+			return;
+
+		SetInputDown(MouseButton(Button), Action == GLFW_PRESS);
+	}
+
+	void InputManager::ApplyResetCursor()
+	{
+		m_InputEvents.ResetCursor();
+	}
+
+	void InputManager::PollLatestInput()
+	{
+		FGL_PROFILE_SCOPE("InputManager::PollLatestInput")
+		m_bLatchingInput = true;
+		glfwPollEvents();
+		m_bLatchingInput = false;
+		if (m_InputMode == InputMode::Replaying)
+		{
+			ReplayInputs(RecordedInputPhase::LateLatch);
+		}
+	}
+
+	void InputManager::StartRecording()
+	{
+		m_InputMode = InputMode::Recording;
+		m_Recording.Clear();
+		m_InputFrame = 0;
+		ReleaseAllInputs();
+	}
+
+	bool InputManager::StopRecording(std::string_view Path)
+	{
+		if (m_InputMode != InputMode::Recording)
+		{
+			LOG_ERROR("Stopping an input recording that wasn't started.", false);
+			return false;
+		}
+
+		m_InputMode = InputMode::Live;
+		const bool bSaved = m_Recording.Save(Path);
+		m_Recording.Clear();
+		return bSaved;
+	}
+
+	bool InputManager::StartReplay(std::string_view Path)
+	{
+		m_InputMode = InputMode::Live;
+		if (!m_Recording.Load(Path))
+			return false;
+
+		m_InputMode = InputMode::Replaying;
+		m_InputFrame = 0;
+		m_ReplayInput = 0;
+		m_ReplayFrameTime = 0;
+		ReleaseAllInputs();
+		return true;
+	}
+
+	void InputManager::StopReplay()
+	{
+		if (m_InputMode != InputMode::Replaying)
+			return;
+
+		// Inputs held at the end of the recording aren't held by anyone now
+		m_InputMode = InputMode::Live;
+		m_Recording.Clear();
+		ReleaseAllInputs();
+	}
+
+	bool InputManager::IsRecording() const
+	{
+		return m_InputMode == InputMode::Recording;
+	}
+
+	bool InputManager::IsReplaying() const
+	{
+		return m_InputMode == InputMode::Replaying;
+	}
+
+	uint32_t InputManager::GetInputFrame() const
+	{
+		return m_InputFrame;
+	}
+
+	double InputManager::ResolveFrameTime(double MeasuredSeconds)
+	{
+		if (m_InputMode == InputMode::Recording)
+		{
+			m_Recording.FrameTimes.push_back(MeasuredSeconds);
+		}
+		else if (m_InputMode == InputMode::Replaying && m_ReplayFrameTime < m_Recording.FrameTimes.size())
+		{
+			return m_Recording.FrameTimes[m_ReplayFrameTime++];
+		}
+		return MeasuredSeconds;
+	}
+
+	void InputManager::RecordInput(RecordedInputType Type, int Code, int Action, int Mods, double X, double Y)
+	{
+		if (m_InputMode != InputMode::Recording)
+			return;
+
+		// Inputs arriving between two frames are delivered at the start of the next one, like their live state is sampled
+		RecordedInput& Input = m_Recording.Inputs.emplace_back();
+		Input.Frame = m_InputFrame;
+		Input.Type = Type;
+		Input.Phase = m_bLatchingInput ? RecordedInputPhase::LateLatch : RecordedInputPhase::FrameStart;
+		Input.Code = Code;
+		Input.Action = Action;
+		Input.Mods = Mods;
+		Input.X = X;
+		Input.Y = Y;
+	}
+
+	void InputManager::ReplayInputs(RecordedInputPhase Phase)
+	{
+		const std::vector<RecordedInput>& Inputs = m_Recording.Inputs;
+		while (m_ReplayInput < Inputs.size() && Inputs[m_ReplayInput].Frame <= m_InputFrame)
+		{
+			// Late-latched inputs precede the frame-start ones of their frame
+			if (Phase == RecordedInputPhase::LateLatch && Inputs[m_ReplayInput].Phase != RecordedInputPhase::LateLatch)
+				break;
+
+			ApplyRecordedInput(Inputs[m_ReplayInput++]);
+		}
+	}
+
+	void InputManager::ApplyRecordedInput(const RecordedInput& Input)
+	{
+		switch (Input.Type)
+		{
+		case RecordedInputType::Key:
+			ApplyKey(Input.Code, Input.Action, Input.Mods);
+			break;
+		case RecordedInputType::MouseButton:
+			ApplyMouseButton(Input.Code, Input.Action, Input.Mods);
+			break;
+		case RecordedInputType::GamepadButton:
+			if (Input.Code >= 0 && Input.Code <= GLFW_GAMEPAD_BUTTON_LAST)
+			{
+				SetInputDown(GamepadButton(Input.Code), Input.Action == GLFW_PRESS);
+			}
+			break;
+		case RecordedInputType::Cursor:
+			ApplyMouse(Input.X, Input.Y);
+			break;
+		case RecordedInputType::Scroll:
+			ApplyScroll(Input.X, Input.Y);
+			break;
+		case RecordedInputType::ResetCursor:
+			ApplyResetCursor();
+			break;
+		}
+	}
+
+	void InputManager::ReleaseAllInputs()
+	{
+		for (int Code = 0; Code < InputCodeCount; Code++)
+		{
+			if (m_KeyDown[Code])
+			{
+				SetInputDown(Code, false);
+			}
+		}
+		m_InputEvents.ResetCursor();
+	}
+
+	InputEventQueue& InputManager::GetInputEvents()
+	{
+		return m_InputEvents;
+	}
+
 	void InputManager::FinalizeInput()
 	{
 		BaseWindow* Window = SystemManager<BaseWindow>::Get();
 		if (Window)
 		{
+			// Nothing is presented while minimized, sleeping on events keeps the loop from spinning
+			if (!Window->IsPresentable())
+			{
+				glfwWaitEventsTimeout(Window->GetIdleEventTimeout());
+				return;
+			}
+
 			// Buffer swap and event polling take 5-10 ms, causing noticeable delay.
-			glfwSwapBuffers(Window->GetWindowPtr());
+			// A running render thread swaps at the end of its frames instead.
+			if (!Window->GetRenderThread().IsRunning())
+			{
+				Window->SwapBuffers();
+			}
 			glfwPollEvents();
 		}
 		else
@@ -0,0 +1,80 @@
+#include <FireGL/Core/InputRecording.h>
+#include <FireGL/Core/BaseLog.h>
+
+#include <fstream>
+
+namespace fgl
+{
+
+	namespace
+	{
+		struct Header
+		{
+			uint32_t Magic;
+			uint32_t Version;
+			uint32_t FrameTimeCount;
+			uint32_t FrameCount;
+			uint32_t InputCount;
+			uint32_t Reserved;
+		};
+
+		template<typename T>
+		void WriteArray(std::ofstream& File, const std::vector<T>& Values)
+		{
+			File.write(reinterpret_cast<const char*>(Values.data()), static_cast<std::streamsize>(Values.size() * sizeof(T)));
+		}
+
+		template<typename T>
+		bool ReadArray(std::ifstream& File, std::vector<T>& Values, uint32_t Count)
+		{
+			Values.resize(Count);
+			return static_cast<bool>(File.read(reinterpret_cast<char*>(Values.data()), static_cast<std::streamsize>(Values.size() * sizeof(T))));
+		}
+	}
+
+	void InputRecording::Clear()
+	{
+		FrameTimes.clear();
+		FrameFocus.clear();
+		Inputs.clear();
+	}
+
+	bool InputRecording::Save(std::string_view Path) const
+	{
+		std::ofstream File(std::string(Path), std::ios::binary | std::ios::trunc);
+		const Header FileHeader = { Magic, Version, static_cast<uint32_t>(FrameTimes.size()),
+			static_cast<uint32_t>(FrameFocus.size()), static_cast<uint32_t>(Inputs.size()), 0 };
+		File.write(reinterpret_cast<const char*>(&FileHeader), sizeof(FileHeader));
+		WriteArray(File, FrameTimes);
+		WriteArray(File, FrameFocus);
+		WriteArray(File, Inputs);
+		if (!File)
+		{
+			LOG_ERROR("Failed to write the input recording " + std::string(Path) + ".", false);
+			return false;
+		}
+		return true;
+	}
+
+	bool InputRecording::Load(std::string_view Path)
+	{
+		Clear();
+		std::ifstream File(std::string(Path), std::ios::binary);
+		Header FileHeader = {};
+		if (!File.read(reinterpret_cast<char*>(&FileHeader), sizeof(FileHeader)) || FileHeader.Magic != Magic || FileHeader.Version != Version)
+		{
+			LOG_ERROR("Invalid or outdated input recording " + std::string(Path) + ".", false);
+			return false;
+		}
+
+		if (!ReadArray(File, FrameTimes, FileHeader.FrameTimeCount) || !ReadArray(File, FrameFocus, FileHeader.FrameCount)
+			|| !ReadArray(File, Inputs, FileHeader.InputCount))
+		{
+			LOG_ERROR("The input recording " + std::string(Path) + " is truncated.", false);
+			Clear();
+			return false;
+		}
+		return true;
+	}
+
+} // namespace fgl
@@ -0,0 +1,168 @@
+#include <FireGL/Core/JobSystem.h>
+#include <FireGL/Core/Profiler.h>
+
+namespace fgl
+{
+
+	thread_local const JobSystem* JobSystem::s_CurrentSystem = nullptr;
+	thread_local uint32_t JobSystem::s_CurrentWorker = 0;
+
+	JobSystem::JobSystem(uint32_t WorkerCount)
+	{
+		if (WorkerCount == 0)
+		{
+			const uint32_t HardwareThreads = std::thread::hardware_concurrency();
+			WorkerCount = HardwareThreads > 1 ? HardwareThreads - 1 : 1;
+		}
+
+		for (uint32_t Index = 0; Index < WorkerCount; Index++)
+		{
+			m_Queues.push_back(std::make_unique<WorkerQueue>());
+		}
+		for (uint32_t Index = 0; Index < WorkerCount; Index++)
+		{
+			m_Workers.emplace_back(&JobSystem::WorkerLoop, this, Index);
+		}
+	}
+
+	JobSystem::~JobSystem()
+	{
+		{
+			std::lock_guard<std::mutex> Lock(m_WakeMutex);
+			m_bStopping = true;
+		}
+		m_WakeCondition.notify_all();
+
+		for (std::thread& Worker : m_Workers)
+		{
+			Worker.join();
+		}
+	}
+
+	void JobSystem::Schedule(Job Task, JobCounter& Counter)
+	{
+		Counter.Remaining.fetch_add(1, std::memory_order_relaxed);
+
+		// Workers keep their jobs local, other threads spread them over the workers
+		uint32_t QueueIndex = GetCurrentWorker();
+		if (QueueIndex == GetWorkerCount())
+		{
+			QueueIndex = m_NextQueue.fetch_add(1, std::memory_order_relaxed) % GetWorkerCount();
+		}
+
+		WorkerQueue& Queue = *m_Queues[QueueIndex];
+		{
+			std::lock_guard<std::mutex> Lock(Queue.Mutex);
+			Queue.Jobs.push_back({ std::move(Task), &Counter });
+		}
+		m_QueuedJobs.fetch_add(1, std::memory_order_release);
+
+		// Taking the lock orders the notification after a sleeping worker checked m_QueuedJobs
+		{
+			std::lock_guard<std::mutex> Lock(m_WakeMutex);
+		}
+		m_WakeCondition.notify_one();
+	}
+
+	void JobSystem::Wait(JobCounter& Counter)
+	{
+		const uint32_t WorkerIndex = GetCurrentWorker();
+		while (!Counter.IsDone())
+		{
+			if (!TryRunJob(WorkerIndex))
+			{
+				// The remaining jobs are running on other threads
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	void JobSystem::ParallelFor(size_t Count, size_t ChunkSize, const std::function<void(size_t Begin, size_t End)>& Body)
+	{
+		if (Count == 0)
+			return;
+
+		ChunkSize = std::max<size_t>(ChunkSize, 1);
+		JobCounter Counter;
+		for (size_t Begin = 0; Begin < Count; Begin += ChunkSize)
+		{
+			const size_t End = std::min(Begin + ChunkSize, Count);
+			Schedule([&Body, Begin, End]() { Body(Begin, End); }, Counter);
+		}
+		Wait(Counter);
+	}
+
+	uint32_t JobSystem::GetWorkerCount() const
+	{
+		return static_cast<uint32_t>(m_Workers.size());
+	}
+
+	void JobSystem::WorkerLoop(uint32_t WorkerIndex)
+	{
+		s_CurrentSystem = this;
+		s_CurrentWorker = WorkerIndex;
+		FGL_PROFILE_THREAD("JobSystem worker " + std::to_string(WorkerIndex))
+
+		while (true)
+		{
+			if (TryRunJob(WorkerIndex))
+				continue;
+
+			std::unique_lock<std::mutex> Lock(m_WakeMutex);
+			m_WakeCondition.wait(Lock, [this]() { return m_bStopping || m_QueuedJobs.load(std::memory_order_acquire) > 0; });
+			if (m_bStopping && m_QueuedJobs.load(std::memory_order_acquire) == 0)
+				return;
+		}
+	}
+
+	bool JobSystem::TryRunJob(uint32_t WorkerIndex)
+	{
+		const uint32_t QueueCount = static_cast<uint32_t>(m_Queues.size());
+		PendingJob Pending;
+		bool bFound = false;
+
+		// Own queue first, newest job first
+		if (WorkerIndex < QueueCount)
+		{
+			WorkerQueue& Queue = *m_Queues[WorkerIndex];
+			std::lock_guard<std::mutex> Lock(Queue.Mutex);
+			if (!Queue.Jobs.empty())
+			{
+				Pending = std::move(Queue.Jobs.back());
+				Queue.Jobs.pop_back();
+				bFound = true;
+			}
+		}
+
+		// Then steal the oldest job of the next non-empty queue
+		for (uint32_t Offset = 1; !bFound && Offset <= QueueCount; Offset++)
+		{
+			const uint32_t Victim = (WorkerIndex + Offset) % QueueCount;
+			if (Victim == WorkerIndex)
+				continue;
+
+			WorkerQueue& Queue = *m_Queues[Victim];
+			std::lock_guard<std::mutex> Lock(Queue.Mutex);
+			if (!Queue.Jobs.empty())
+			{
+				Pending = std::move(Queue.Jobs.front());
+				Queue.Jobs.pop_front();
+				bFound = true;
+			}
+		}
+
+		if (!bFound)
+			return false;
+
+		m_QueuedJobs.fetch_sub(1, std::memory_order_relaxed);
+		Pending.Task();
+		Pending.Counter->Remaining.fetch_sub(1, std::memory_order_release);
+		return true;
+	}
+
+	uint32_t JobSystem::GetCurrentWorker() const
+	{
+		return s_CurrentSystem == this ? s_CurrentWorker : GetWorkerCount();
+	}
+
+} // namespace fgl
\ No newline at end of file
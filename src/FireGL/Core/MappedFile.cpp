@@ -0,0 +1,109 @@
+#include <FireGL/Core/MappedFile.h>
+
+#if defined(_WIN32) || defined(_WIN64)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fgl
+{
+
+	MappedFile::~MappedFile()
+	{
+		Close();
+	}
+
+	bool MappedFile::Open(std::string_view Path)
+	{
+		Close();
+		const std::string PathString(Path);
+
+#if defined(_WIN32) || defined(_WIN64)
+		HANDLE File = CreateFileA(PathString.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (File == INVALID_HANDLE_VALUE)
+			return false;
+
+		LARGE_INTEGER FileSize;
+		if (!GetFileSizeEx(File, &FileSize) || FileSize.QuadPart == 0)
+		{
+			CloseHandle(File);
+			return false;
+		}
+
+		HANDLE Mapping = CreateFileMappingA(File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!Mapping)
+		{
+			CloseHandle(File);
+			return false;
+		}
+
+		m_Data = static_cast<const uint8_t*>(MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0));
+		if (!m_Data)
+		{
+			CloseHandle(Mapping);
+			CloseHandle(File);
+			return false;
+		}
+
+		m_FileHandle = File;
+		m_MappingHandle = Mapping;
+		m_Size = static_cast<size_t>(FileSize.QuadPart);
+#else
+		int File = open(PathString.c_str(), O_RDONLY);
+		if (File < 0)
+			return false;
+
+		struct stat FileStat;
+		if (fstat(File, &FileStat) != 0 || FileStat.st_size == 0)
+		{
+			close(File);
+			return false;
+		}
+
+		void* Data = mmap(nullptr, static_cast<size_t>(FileStat.st_size), PROT_READ, MAP_PRIVATE, File, 0);
+		// The mapping keeps its own reference to the file
+		close(File);
+		if (Data == MAP_FAILED)
+			return false;
+
+		m_Data = static_cast<const uint8_t*>(Data);
+		m_Size = static_cast<size_t>(FileStat.st_size);
+#endif
+		return true;
+	}
+
+	void MappedFile::Close()
+	{
+		if (!m_Data)
+			return;
+
+#if defined(_WIN32) || defined(_WIN64)
+		UnmapViewOfFile(m_Data);
+		CloseHandle(m_MappingHandle);
+		CloseHandle(m_FileHandle);
+		m_MappingHandle = nullptr;
+		m_FileHandle = nullptr;
+#else
+		munmap(const_cast<uint8_t*>(m_Data), m_Size);
+#endif
+		m_Data = nullptr;
+		m_Size = 0;
+	}
+
+	const uint8_t* MappedFile::GetData() const
+	{
+		return m_Data;
+	}
+
+	size_t MappedFile::GetSize() const
+	{
+		return m_Size;
+	}
+
+} // namespace fgl
\ No newline at end of file
@@ -0,0 +1,133 @@
+#include <FireGL/Core/MemoryTracker.h>
+#include <FireGL/Core/BaseLog.h>
+
+#include <iomanip>
+
+namespace fgl
+{
+
+	namespace
+	{
+		std::string FormatBytes(uint64_t Bytes)
+		{
+			std::ostringstream Text;
+			Text << std::fixed << std::setprecision(2) << static_cast<double>(Bytes) / (1024.0 * 1024.0) << " MiB";
+			return Text.str();
+		}
+	}
+
+	// Constant-initialized, so containers of other statics can allocate before it would be constructed
+	std::array<MemoryTracker::Counters, static_cast<size_t>(MemoryTag::Count)> MemoryTracker::s_Counters;
+
+	void MemoryTracker::OnAllocate(MemoryTag Tag, uint64_t Bytes)
+	{
+		Counters& Tagged = s_Counters[static_cast<size_t>(Tag)];
+		const uint64_t Current = Tagged.Current.fetch_add(Bytes, std::memory_order_relaxed) + Bytes;
+		Tagged.Live.fetch_add(1, std::memory_order_relaxed);
+		Tagged.Total.fetch_add(1, std::memory_order_relaxed);
+
+		uint64_t Peak = Tagged.Peak.load(std::memory_order_relaxed);
+		while (Current > Peak && !Tagged.Peak.compare_exchange_weak(Peak, Current, std::memory_order_relaxed))
+		{
+		}
+
+		// Logging allocates under its own tag, which is never reported to avoid logging from within the logger
+		const uint64_t Budget = Tagged.Budget.load(std::memory_order_relaxed);
+		if (Budget > 0 && Current > Budget && Tag != MemoryTag::Logging && !Tagged.bBudgetReported.exchange(true, std::memory_order_relaxed))
+		{
+			LOG_ERROR(std::string(GetTagName(Tag)) + " memory exceeds its budget: " + FormatBytes(Current) + " of " + FormatBytes(Budget) + ".", false)
+		}
+	}
+
+	void MemoryTracker::OnFree(MemoryTag Tag, uint64_t Bytes)
+	{
+		Counters& Tagged = s_Counters[static_cast<size_t>(Tag)];
+		Tagged.Current.fetch_sub(Bytes, std::memory_order_relaxed);
+		Tagged.Live.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	std::shared_ptr<unsigned char> MemoryTracker::MakeSharedBuffer(MemoryTag Tag, size_t Bytes)
+	{
+		std::shared_ptr<unsigned char> Buffer(new unsigned char[Bytes], [Tag, Bytes](unsigned char* Data)
+		{
+			OnFree(Tag, Bytes);
+			delete[] Data;
+		});
+		OnAllocate(Tag, Bytes);
+		return Buffer;
+	}
+
+	MemoryTagStats MemoryTracker::GetStats(MemoryTag Tag)
+	{
+		const Counters& Tagged = s_Counters[static_cast<size_t>(Tag)];
+		MemoryTagStats Stats;
+		Stats.CurrentBytes = Tagged.Current.load(std::memory_order_relaxed);
+		Stats.PeakBytes = Tagged.Peak.load(std::memory_order_relaxed);
+		Stats.LiveAllocations = Tagged.Live.load(std::memory_order_relaxed);
+		Stats.TotalAllocations = Tagged.Total.load(std::memory_order_relaxed);
+		Stats.BudgetBytes = Tagged.Budget.load(std::memory_order_relaxed);
+		return Stats;
+	}
+
+	uint64_t MemoryTracker::GetTotal()
+	{
+		uint64_t Total = 0;
+		for (const Counters& Tagged : s_Counters)
+		{
+			Total += Tagged.Current.load(std::memory_order_relaxed);
+		}
+		return Total;
+	}
+
+	void MemoryTracker::SetBudget(MemoryTag Tag, uint64_t Bytes)
+	{
+		Counters& Tagged = s_Counters[static_cast<size_t>(Tag)];
+		Tagged.Budget.store(Bytes, std::memory_order_relaxed);
+		Tagged.bBudgetReported.store(false, std::memory_order_relaxed);
+	}
+
+	bool MemoryTracker::IsOverBudget(MemoryTag Tag)
+	{
+		const MemoryTagStats Stats = GetStats(Tag);
+		return Stats.BudgetBytes > 0 && Stats.CurrentBytes > Stats.BudgetBytes;
+	}
+
+	void MemoryTracker::ResetPeaks()
+	{
+		for (Counters& Tagged : s_Counters)
+		{
+			Tagged.Peak.store(Tagged.Current.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		}
+	}
+
+	void MemoryTracker::LogReport()
+	{
+		std::string Report = "CPU memory: " + FormatBytes(GetTotal()) + " tracked";
+		for (size_t Tag = 0; Tag < s_Counters.size(); Tag++)
+		{
+			const MemoryTagStats Stats = GetStats(static_cast<MemoryTag>(Tag));
+			Report += "\n  " + std::string(GetTagName(static_cast<MemoryTag>(Tag))) + ": " + FormatBytes(Stats.CurrentBytes) + ", peak "
+				+ FormatBytes(Stats.PeakBytes) + ", " + std::to_string(Stats.LiveAllocations) + " live of " + std::to_string(Stats.TotalAllocations) + " allocations";
+			if (Stats.BudgetBytes > 0)
+			{
+				Report += ", budget " + FormatBytes(Stats.BudgetBytes);
+			}
+		}
+		LOG_INFO(Report)
+	}
+
+	const char* MemoryTracker::GetTagName(MemoryTag Tag)
+	{
+		switch (Tag)
+		{
+		case MemoryTag::Meshes: return "Meshes";
+		case MemoryTag::Textures: return "Textures";
+		case MemoryTag::Scene: return "Scene";
+		case MemoryTag::Components: return "Components";
+		case MemoryTag::Models: return "Models";
+		case MemoryTag::Logging: return "Logging";
+		default: return "Unknown";
+		}
+	}
+
+} // namespace fgl
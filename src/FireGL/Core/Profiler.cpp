@@ -0,0 +1,211 @@
+#include <FireGL/Core/Profiler.h>
+
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <mutex>
+
+#if defined(FIREGL_ENABLE_TRACY)
+#include <cstdlib>
+#include <new>
+
+#include <External/glad/glad.h>
+#include <tracy/TracyOpenGL.hpp>
+
+// Tracy memory events for every allocation of the process; the secure variants are dropped once Tracy shut down
+void* operator new(std::size_t Size)
+{
+	void* Pointer = std::malloc(Size == 0 ? 1 : Size);
+	if (!Pointer)
+		throw std::bad_alloc();
+	TracySecureAlloc(Pointer, Size);
+	return Pointer;
+}
+
+void operator delete(void* Pointer) noexcept
+{
+	TracySecureFree(Pointer);
+	std::free(Pointer);
+}
+
+void operator delete(void* Pointer, std::size_t) noexcept
+{
+	TracySecureFree(Pointer);
+	std::free(Pointer);
+}
+#endif
+
+namespace fgl
+{
+
+	namespace
+	{
+		/** A finished zone. */
+		struct Zone
+		{
+			const char* Name; ///< Name of the zone, not owned.
+			uint64_t Start;   ///< Start, in nanoseconds since the epoch.
+			uint64_t End;     ///< End, in nanoseconds since the epoch.
+		};
+
+		/** Ring of the zones of one thread, written by that thread only. */
+		struct ThreadBuffer
+		{
+			std::array<Zone, Profiler::ThreadCapacity> Zones; ///< Ring of zones, zone i at i % ThreadCapacity.
+			std::atomic<uint64_t> Written{ 0 };               ///< Zones published so far.
+			uint32_t ThreadIndex = 0;                         ///< Registration order, the trace's thread ID.
+			std::string Name;                                 ///< Thread name set by SetThreadName(), under the registry lock.
+		};
+
+		/** Buffers of every thread that recorded a zone. */
+		struct Registry
+		{
+			std::mutex Mutex;                                 ///< Guards Buffers and the buffer names.
+			std::vector<std::unique_ptr<ThreadBuffer>> Buffers; ///< Owned here so they outlive their threads.
+		};
+
+		Registry& GetRegistry()
+		{
+			static Registry Instance;
+			return Instance;
+		}
+
+		const std::chrono::steady_clock::time_point Epoch = std::chrono::steady_clock::now();
+
+		thread_local ThreadBuffer* t_Buffer = nullptr;
+
+		ThreadBuffer& GetThreadBuffer()
+		{
+			if (!t_Buffer)
+			{
+				Registry& Threads = GetRegistry();
+				std::lock_guard<std::mutex> Lock(Threads.Mutex);
+				Threads.Buffers.push_back(std::make_unique<ThreadBuffer>());
+				t_Buffer = Threads.Buffers.back().get();
+				t_Buffer->ThreadIndex = static_cast<uint32_t>(Threads.Buffers.size() - 1);
+			}
+			return *t_Buffer;
+		}
+
+		void WriteEscaped(std::ofstream& File, std::string_view Text)
+		{
+			for (char Character : Text)
+			{
+				if (Character == '"' || Character == '\\')
+				{
+					File << '\\';
+				}
+				File << Character;
+			}
+		}
+	}
+
+	namespace Profiler {
+
+		uint64_t Now()
+		{
+			return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - Epoch).count());
+		}
+
+		void RecordZone(const char* Name, uint64_t Start, uint64_t End)
+		{
+			ThreadBuffer& Buffer = GetThreadBuffer();
+			const uint64_t Index = Buffer.Written.load(std::memory_order_relaxed);
+			Buffer.Zones[Index % ThreadCapacity] = { Name, Start, End };
+			Buffer.Written.store(Index + 1, std::memory_order_release);
+		}
+
+		void SetThreadName(std::string_view Name)
+		{
+			ThreadBuffer& Buffer = GetThreadBuffer();
+			std::lock_guard<std::mutex> Lock(GetRegistry().Mutex);
+			Buffer.Name = Name;
+		}
+
+		bool WriteChromeTrace(std::string_view Path, uint64_t Since, std::string_view ExtraEvents)
+		{
+			std::ofstream File{ std::string(Path) };
+			if (!File)
+				return false;
+
+			Registry& Threads = GetRegistry();
+			std::lock_guard<std::mutex> Lock(Threads.Mutex);
+
+			// Microseconds with nanosecond digits, never in exponent notation
+			File << std::fixed << std::setprecision(3);
+			File << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+			bool bFirst = true;
+			std::vector<Zone> Zones;
+			for (const std::unique_ptr<ThreadBuffer>& Buffer : Threads.Buffers)
+			{
+				// Copy the ring, then drop what the owner may have overwritten while it was copied
+				const uint64_t Written = Buffer->Written.load(std::memory_order_acquire);
+				const uint64_t First = Written > ThreadCapacity ? Written - ThreadCapacity : 0;
+				Zones.clear();
+				for (uint64_t Index = First; Index < Written; Index++)
+				{
+					Zones.push_back(Buffer->Zones[Index % ThreadCapacity]);
+				}
+				const uint64_t WrittenAfter = Buffer->Written.load(std::memory_order_acquire);
+				const uint64_t Overwritten = WrittenAfter > ThreadCapacity ? WrittenAfter - ThreadCapacity : 0;
+				const size_t Skip = static_cast<size_t>(std::min<uint64_t>(Overwritten > First ? Overwritten - First : 0, Zones.size()));
+
+				if (!Buffer->Name.empty())
+				{
+					File << (bFirst ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << Buffer->ThreadIndex
+						<< ",\"args\":{\"name\":\"";
+					WriteEscaped(File, Buffer->Name);
+					File << "\"}}";
+					bFirst = false;
+				}
+
+				// Complete events nest by their times, parents are recorded after their children
+				for (size_t Index = Skip; Index < Zones.size(); Index++)
+				{
+					const Zone& Recorded = Zones[Index];
+					if (Recorded.End < Since)
+						continue;
+
+					File << (bFirst ? "" : ",") << "\n{\"name\":\"";
+					WriteEscaped(File, Recorded.Name);
+					File << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << Buffer->ThreadIndex
+						<< ",\"ts\":" << static_cast<double>(Recorded.Start) * 1e-3
+						<< ",\"dur\":" << static_cast<double>(Recorded.End - Recorded.Start) * 1e-3 << "}";
+					bFirst = false;
+				}
+			}
+			if (!ExtraEvents.empty())
+			{
+				File << (bFirst ? "" : ",") << "\n" << ExtraEvents;
+			}
+			File << "\n]}\n";
+			return static_cast<bool>(File);
+		}
+
+		void Clear()
+		{
+			Registry& Threads = GetRegistry();
+			std::lock_guard<std::mutex> Lock(Threads.Mutex);
+			for (const std::unique_ptr<ThreadBuffer>& Buffer : Threads.Buffers)
+			{
+				Buffer->Written.store(0, std::memory_order_release);
+			}
+		}
+
+		void CreateGPUContext()
+		{
+#if defined(FIREGL_ENABLE_TRACY)
+			TracyGpuContext;
+#endif
+		}
+
+		void MarkFrame()
+		{
+#if defined(FIREGL_ENABLE_TRACY)
+			FrameMark;
+			TracyGpuCollect;
+#endif
+		}
+	}
+
+} // namespace fgl
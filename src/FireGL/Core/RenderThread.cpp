@@ -0,0 +1,141 @@
+#include <FireGL/Core/RenderThread.h>
+#include <FireGL/Core/BaseLog.h>
+
+#include <External/glad/glad.h>
+#include <External/GLFW/glfw3.h>
+
+#include <chrono>
+
+namespace fgl
+{
+
+	RenderThread::~RenderThread()
+	{
+		if (IsRunning())
+		{
+			Stop();
+		}
+	}
+
+	void RenderThread::Start(GLFWwindow* Window)
+	{
+		LOG_ASSERT(!IsRunning(), "The render thread is already running")
+		LOG_ASSERT(Window && glfwGetCurrentContext() == Window, "The window's context must be current on the thread starting the render thread")
+
+		// A context is current on one thread at a time
+		glfwMakeContextCurrent(nullptr);
+		m_Window = Window;
+		m_bStopping = false;
+		m_Error = nullptr;
+		m_Thread = std::thread(&RenderThread::Run, this);
+	}
+
+	void RenderThread::Stop()
+	{
+		if (!IsRunning())
+			return;
+
+		{
+			std::unique_lock<std::mutex> Lock(m_Mutex);
+			m_Condition.wait(Lock, [this]() { return !m_Frame; });
+			m_bStopping = true;
+		}
+		m_Condition.notify_all();
+		m_Thread.join();
+		glfwMakeContextCurrent(m_Window);
+
+		// Stopping after a failed frame still reports it
+		std::exception_ptr Error = std::exchange(m_Error, nullptr);
+		if (Error)
+		{
+			std::rethrow_exception(Error);
+		}
+	}
+
+	bool RenderThread::IsRunning() const
+	{
+		return m_Thread.joinable();
+	}
+
+	void RenderThread::SubmitFrame(std::function<void()> Frame)
+	{
+		LOG_ASSERT(IsRunning(), "Frames are submitted to a running render thread")
+		WaitForFrame();
+		{
+			std::lock_guard<std::mutex> Lock(m_Mutex);
+			m_Frame = std::move(Frame);
+		}
+		m_Condition.notify_all();
+	}
+
+	void RenderThread::WaitForFrame()
+	{
+		const auto Start = std::chrono::steady_clock::now();
+		std::exception_ptr Error;
+		{
+			std::unique_lock<std::mutex> Lock(m_Mutex);
+			m_Condition.wait(Lock, [this]() { return !m_Frame; });
+			Error = std::exchange(m_Error, nullptr);
+		}
+		m_LastWaitTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+		if (Error)
+		{
+			std::rethrow_exception(Error);
+		}
+	}
+
+	void RenderThread::SetViewport(int Width, int Height)
+	{
+		m_PendingViewport.store((static_cast<uint64_t>(Width) << 32) | static_cast<uint32_t>(Height), std::memory_order_release);
+	}
+
+	double RenderThread::GetLastWaitTime() const
+	{
+		return m_LastWaitTime;
+	}
+
+	void RenderThread::Run()
+	{
+		glfwMakeContextCurrent(m_Window);
+		while (true)
+		{
+			std::function<void()> Frame;
+			{
+				std::unique_lock<std::mutex> Lock(m_Mutex);
+				m_Condition.wait(Lock, [this]() { return m_Frame || m_bStopping; });
+				if (!m_Frame)
+					break;
+
+				Frame = m_Frame;
+			}
+
+			const uint64_t Viewport = m_PendingViewport.exchange(0, std::memory_order_acquire);
+			if (Viewport != 0)
+			{
+				glViewport(0, 0, static_cast<GLsizei>(Viewport >> 32), static_cast<GLsizei>(Viewport & 0xFFFFFFFFu));
+			}
+
+			std::exception_ptr Error;
+			try
+			{
+				Frame();
+			}
+			catch (...)
+			{
+				Error = std::current_exception();
+			}
+
+			{
+				std::lock_guard<std::mutex> Lock(m_Mutex);
+				m_Frame = nullptr;
+				if (Error)
+				{
+					m_Error = Error;
+				}
+			}
+			m_Condition.notify_all();
+		}
+		glfwMakeContextCurrent(nullptr);
+	}
+
+} // namespace fgl
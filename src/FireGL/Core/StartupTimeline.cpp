@@ -0,0 +1,170 @@
+#include <FireGL/Core/StartupTimeline.h>
+#include <FireGL/Core/BaseLog.h>
+#include <FireGL/Core/Profiler.h>
+
+#include <atomic>
+#include <filesystem>
+#include <iomanip>
+#include <mutex>
+
+namespace fgl
+{
+
+	namespace
+	{
+		static constexpr size_t SlowestLogged = 10; ///< Loads listed by LogSummary().
+
+		/** Totals of one phase. */
+		struct PhaseTotals
+		{
+			size_t Count = 0;        ///< Assets loaded.
+			uint64_t BytesRead = 0;  ///< Bytes read for them.
+			uint64_t DecodeTime = 0; ///< Summed decode time, in nanoseconds.
+			uint64_t UploadTime = 0; ///< Summed upload time, in nanoseconds.
+		};
+
+		std::mutex s_Mutex;                      ///< Guards s_Events.
+		std::vector<StartupEvent> s_Events;      ///< Loads recorded so far.
+		std::atomic<bool> s_bRecording{ true };  ///< Cleared by Finish().
+		std::atomic<uint64_t> s_FirstFrame{ 0 }; ///< Set by Finish().
+
+		double ToMilliseconds(uint64_t Nanoseconds)
+		{
+			return static_cast<double>(Nanoseconds) * 1e-6;
+		}
+
+		// Phases in the order they were first recorded
+		std::vector<std::pair<std::string, PhaseTotals>> SumPhases(const std::vector<StartupEvent>& Events)
+		{
+			std::vector<std::pair<std::string, PhaseTotals>> Phases;
+			for (const StartupEvent& Event : Events)
+			{
+				auto Phase = std::find_if(Phases.begin(), Phases.end(), [&Event](const auto& Entry) { return Entry.first == Event.Phase; });
+				if (Phase == Phases.end())
+				{
+					Phases.emplace_back(Event.Phase, PhaseTotals());
+					Phase = Phases.end() - 1;
+				}
+				Phase->second.Count++;
+				Phase->second.BytesRead += Event.BytesRead;
+				Phase->second.DecodeTime += Event.DecodeTime;
+				Phase->second.UploadTime += Event.UploadTime;
+			}
+			return Phases;
+		}
+
+		void WriteEscaped(std::ofstream& File, std::string_view Text)
+		{
+			for (char Character : Text)
+			{
+				if (Character == '"' || Character == '\\')
+				{
+					File << '\\';
+				}
+				File << Character;
+			}
+		}
+	}
+
+	namespace StartupTimeline {
+
+		void Record(std::string_view Phase, std::string_view Asset, uint64_t BytesRead, uint64_t Start, uint64_t Decoded, uint64_t End)
+		{
+			if (!IsRecording())
+				return;
+
+			std::lock_guard<std::mutex> Lock(s_Mutex);
+			s_Events.push_back({ std::string(Phase), std::string(Asset), BytesRead, Start, Decoded - Start, End - Decoded });
+		}
+
+		bool IsRecording()
+		{
+			return s_bRecording.load(std::memory_order_relaxed);
+		}
+
+		void Finish()
+		{
+			// Checked first, the renderer calls this every frame
+			if (!IsRecording() || !s_bRecording.exchange(false))
+				return;
+
+			s_FirstFrame.store(Profiler::Now());
+		}
+
+		std::vector<StartupEvent> GetEvents()
+		{
+			std::lock_guard<std::mutex> Lock(s_Mutex);
+			return s_Events;
+		}
+
+		uint64_t GetFirstFrameTime()
+		{
+			return s_FirstFrame.load();
+		}
+
+		bool WriteJSON(std::string_view Path)
+		{
+			std::ofstream File{ std::string(Path) };
+			if (!File)
+				return false;
+
+			const std::vector<StartupEvent> Events = GetEvents();
+			File << std::fixed << std::setprecision(3);
+			File << "{\n\"firstFrameMs\": " << ToMilliseconds(GetFirstFrameTime()) << ",\n\"phases\": {";
+			bool bFirst = true;
+			for (const auto& [Phase, Totals] : SumPhases(Events))
+			{
+				File << (bFirst ? "" : ",") << "\n\"";
+				WriteEscaped(File, Phase);
+				File << "\": {\"count\": " << Totals.Count << ", \"bytesRead\": " << Totals.BytesRead
+					<< ", \"decodeMs\": " << ToMilliseconds(Totals.DecodeTime) << ", \"uploadMs\": " << ToMilliseconds(Totals.UploadTime) << "}";
+				bFirst = false;
+			}
+			File << "\n},\n\"events\": [";
+			bFirst = true;
+			for (const StartupEvent& Event : Events)
+			{
+				File << (bFirst ? "" : ",") << "\n{\"phase\": \"";
+				WriteEscaped(File, Event.Phase);
+				File << "\", \"asset\": \"";
+				WriteEscaped(File, Event.Asset);
+				File << "\", \"bytesRead\": " << Event.BytesRead << ", \"startMs\": " << ToMilliseconds(Event.Start)
+					<< ", \"decodeMs\": " << ToMilliseconds(Event.DecodeTime) << ", \"uploadMs\": " << ToMilliseconds(Event.UploadTime) << "}";
+				bFirst = false;
+			}
+			File << "\n]\n}\n";
+			return static_cast<bool>(File);
+		}
+
+		void LogSummary()
+		{
+			std::vector<StartupEvent> Events = GetEvents();
+			std::ostringstream Summary;
+			Summary << std::fixed << std::setprecision(2) << "Startup: first frame at " << ToMilliseconds(GetFirstFrameTime()) << " ms";
+			for (const auto& [Phase, Totals] : SumPhases(Events))
+			{
+				Summary << "\n  " << Phase << ": " << Totals.Count << " loaded, " << Totals.BytesRead << " bytes, decode "
+					<< ToMilliseconds(Totals.DecodeTime) << " ms, upload " << ToMilliseconds(Totals.UploadTime) << " ms";
+			}
+
+			const size_t Logged = std::min(Events.size(), SlowestLogged);
+			std::partial_sort(Events.begin(), Events.begin() + Logged, Events.end(), [](const StartupEvent& A, const StartupEvent& B) {
+				return A.DecodeTime + A.UploadTime > B.DecodeTime + B.UploadTime;
+				});
+			for (size_t Index = 0; Index < Logged; Index++)
+			{
+				const StartupEvent& Event = Events[Index];
+				Summary << "\n  " << ToMilliseconds(Event.DecodeTime + Event.UploadTime) << " ms " << Event.Phase << " " << Event.Asset;
+			}
+			LOG_INFO(Summary.str())
+		}
+
+		uint64_t FileSize(std::string_view Path)
+		{
+			std::error_code Error;
+			const uintmax_t Size = std::filesystem::file_size(std::filesystem::path(Path), Error);
+			return Error ? 0 : static_cast<uint64_t>(Size);
+		}
+	}
+
+} // namespace fgl
@@ -0,0 +1,114 @@
+#include <FireGL/Core/Symbol.h>
+#include <FireGL/Core/BaseLog.h>
+
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+
+namespace fgl
+{
+
+	namespace
+	{
+		constexpr uint32_t BlockSize = 1024; ///< Strings per block, a block never moves once allocated.
+		constexpr uint32_t MaxBlocks = 4096; ///< Blocks of the table, so at most 4M symbols.
+
+		/** Every interned string, by ID in fixed blocks so that readers index them without a lock. */
+		struct SymbolTable
+		{
+			std::shared_mutex Mutex;                                ///< Guards IDs, Count and the block allocation.
+			FlatHashMap<std::string_view, uint32_t> IDs;            ///< ID of every string, viewing the strings of the blocks.
+			std::array<std::atomic<std::string*>, MaxBlocks> Blocks{}; ///< Strings of IDs [i * BlockSize, (i + 1) * BlockSize).
+			uint32_t Count = 1;                                     ///< Strings interned, ID 0 is the empty string.
+
+			SymbolTable()
+			{
+				Blocks[0].store(new std::string[BlockSize], std::memory_order_release);
+			}
+		};
+
+		/** Never destroyed, so symbols stay readable from the destructors of other statics. */
+		SymbolTable& GetTable()
+		{
+			static SymbolTable* Table = new SymbolTable();
+			return *Table;
+		}
+	}
+
+	Symbol::Symbol(std::string_view Text)
+	{
+		if (Text.empty())
+			return;
+
+		SymbolTable& Table = GetTable();
+		{
+			std::shared_lock Lock(Table.Mutex);
+			auto It = Table.IDs.find(Text);
+			if (It != Table.IDs.end())
+			{
+				m_ID = It->second;
+				return;
+			}
+		}
+
+		// Looked up again, another thread may have added it in between
+		std::unique_lock Lock(Table.Mutex);
+		auto It = Table.IDs.find(Text);
+		if (It != Table.IDs.end())
+		{
+			m_ID = It->second;
+			return;
+		}
+
+		const uint32_t ID = Table.Count;
+		const uint32_t Block = ID / BlockSize;
+		if (Block >= MaxBlocks)
+		{
+			LOG_ERROR("The symbol table is full, symbols are meant for names and paths, not \"" + std::string(Text) + "\".", true)
+			return;
+		}
+		std::string* Strings = Table.Blocks[Block].load(std::memory_order_relaxed);
+		if (!Strings)
+		{
+			Strings = new std::string[BlockSize];
+			Table.Blocks[Block].store(Strings, std::memory_order_release);
+		}
+
+		std::string& Stored = Strings[ID % BlockSize];
+		Stored = Text;
+		Table.IDs.try_emplace(std::string_view(Stored), ID);
+		Table.Count++;
+		m_ID = ID;
+	}
+
+	Symbol Symbol::Find(std::string_view Text)
+	{
+		Symbol Found;
+		if (Text.empty())
+			return Found;
+
+		SymbolTable& Table = GetTable();
+		std::shared_lock Lock(Table.Mutex);
+		auto It = Table.IDs.find(Text);
+		if (It != Table.IDs.end())
+		{
+			Found.m_ID = It->second;
+		}
+		return Found;
+	}
+
+	const std::string& Symbol::GetString() const
+	{
+		// The ID was handed out after its string was written, and blocks are never freed
+		const std::string* Strings = GetTable().Blocks[m_ID / BlockSize].load(std::memory_order_acquire);
+		return Strings[m_ID % BlockSize];
+	}
+
+	uint32_t Symbol::GetCount()
+	{
+		SymbolTable& Table = GetTable();
+		std::shared_lock Lock(Table.Mutex);
+		return Table.Count;
+	}
+
+} // namespace fgl
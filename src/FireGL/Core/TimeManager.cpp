@@ -1,21 +1,97 @@
 #include <FireGL/Core/TimeManager.h>
 #include <FireGL/Core/SystemManager.h>
+#include <FireGL/Core/InputManager.h>
 
 #include <External/GLFW/glfw3.h>
 
 namespace fgl 
 {
 
+	namespace
+	{
+		constexpr size_t DefaultFrameHistory = 600;
+
+		// Index of the nearest-rank percentile among Count sorted samples
+		size_t PercentileRank(size_t Count, double Fraction)
+		{
+			return std::clamp<size_t>(static_cast<size_t>(std::ceil(Fraction * Count)), 1, Count) - 1;
+		}
+	}
+
 	TimeManager::TimeManager()
-		: m_DeltaTime(0.f), m_LastFrame(0.f)
+		: m_DeltaTime(0.f), m_FrameTimes(DefaultFrameHistory, 0.0)
 	{
 	}
 
 	void TimeManager::Update()
 	{
-		double CurrentFrame = GetTimeSeconds();
-		m_DeltaTime = static_cast<float>(CurrentFrame - m_LastFrame);
+		// The steady clock never jumps, unlike the wall clock, and has at least microsecond resolution everywhere
+		const std::chrono::steady_clock::time_point CurrentFrame = std::chrono::steady_clock::now();
+		m_DeltaTimeSeconds = m_LastFrame ? std::chrono::duration<double>(CurrentFrame - *m_LastFrame).count() : 0.0;
+		m_DeltaTime = static_cast<float>(m_DeltaTimeSeconds);
+		if (m_LastFrame && !m_FrameTimes.empty())
+		{
+			m_FrameTimes[m_FrameTimeNext] = m_DeltaTimeSeconds * 1000.0;
+			m_FrameTimeNext = (m_FrameTimeNext + 1) % m_FrameTimes.size();
+			m_FrameTimeCount = std::min(m_FrameTimeCount + 1, m_FrameTimes.size());
+		}
 		m_LastFrame = CurrentFrame;
+
+		// A replayed session simulates its recorded frame times, the statistics above keep the measured ones
+		InputManager* Input = SystemManager<InputManager>::Get();
+		if (Input)
+		{
+			m_DeltaTimeSeconds = Input->ResolveFrameTime(m_DeltaTimeSeconds);
+			m_DeltaTime = static_cast<float>(m_DeltaTimeSeconds);
+		}
+
+		// Callbacks may read the frame's times, the fixed steps are counted first
+		UpdateFixedSteps();
+		m_Timers.Advance(m_DeltaTimeSeconds);
+	}
+
+	void TimeManager::UpdateFixedSteps()
+	{
+		if (m_FixedStep <= 0.0)
+			return;
+
+		m_Accumulator += m_DeltaTimeSeconds;
+		m_FixedStepCount = static_cast<uint32_t>(m_Accumulator / m_FixedStep);
+		if (m_FixedStepCount > m_MaxFixedSteps)
+		{
+			// The whole steps beyond the budget are dropped, the simulation slows down rather than falling further behind
+			m_FixedStepCount = m_MaxFixedSteps;
+			m_Accumulator = std::fmod(m_Accumulator, m_FixedStep) + m_FixedStep * m_MaxFixedSteps;
+		}
+		m_Accumulator = std::max(m_Accumulator - m_FixedStep * m_FixedStepCount, 0.0);
+	}
+
+	void TimeManager::SetFixedTimeStep(double StepSeconds, uint32_t MaxStepsPerFrame)
+	{
+		m_FixedStep = std::max(StepSeconds, 0.0);
+		m_MaxFixedSteps = std::max(MaxStepsPerFrame, 1u);
+		m_Accumulator = 0.0;
+		m_FixedStepCount = 0;
+	}
+
+	bool TimeManager::IsFixedTimeStep() const
+	{
+		return m_FixedStep > 0.0;
+	}
+
+	float TimeManager::GetFixedDeltaTime() const
+	{
+		return static_cast<float>(m_FixedStep);
+	}
+
+	uint32_t TimeManager::GetFixedStepCount() const
+	{
+		return m_FixedStepCount;
+	}
+
+	float TimeManager::GetInterpolationAlpha() const
+	{
+		return m_FixedStep > 0.0 ? static_cast<float>(m_Accumulator / m_FixedStep) : 1.0f;
 	}
 
 	void TimeManager::Initialize()
@@ -33,6 +109,71 @@ namespace fgl
 		return m_DeltaTime;
 	}
 
+	double TimeManager::GetDeltaTimeSeconds() const
+	{
+		return m_DeltaTimeSeconds;
+	}
+
+	TimerWheel& TimeManager::GetTimers()
+	{
+		return m_Timers;
+	}
+
+	void TimeManager::SetFrameHistorySize(size_t Frames)
+	{
+		m_FrameTimes.assign(std::max<size_t>(Frames, 1), 0.0);
+		m_FrameTimeNext = 0;
+		m_FrameTimeCount = 0;
+	}
+
+	void TimeManager::SetHitchThreshold(double Milliseconds)
+	{
+		m_HitchThreshold = std::max(Milliseconds, 0.0);
+	}
+
+	FrameTimeStats TimeManager::GetFrameStats() const
+	{
+		FrameTimeStats Stats;
+		std::vector<double> Samples = GetFrameTimes();
+		if (Samples.empty())
+			return Stats;
+
+		Stats.Samples = Samples.size();
+		for (double Sample : Samples)
+		{
+			Stats.Mean += Sample;
+			Stats.Max = std::max(Stats.Max, Sample);
+		}
+		Stats.Mean /= static_cast<double>(Samples.size());
+
+		// Highest rank first, each nth_element then only reorders the part below the previous one
+		const auto P99 = Samples.begin() + PercentileRank(Samples.size(), 0.99);
+		const auto P95 = Samples.begin() + PercentileRank(Samples.size(), 0.95);
+		const auto P50 = Samples.begin() + PercentileRank(Samples.size(), 0.50);
+		std::nth_element(Samples.begin(), P99, Samples.end());
+		std::nth_element(Samples.begin(), P95, P99);
+		std::nth_element(Samples.begin(), P50, P95);
+		Stats.P99 = *P99;
+		Stats.P95 = *P95;
+		Stats.P50 = *P50;
+
+		const double Threshold = m_HitchThreshold > 0.0 ? m_HitchThreshold : Stats.P50 * 2.0;
+		Stats.Hitches = static_cast<size_t>(std::count_if(Samples.begin(), Samples.end(), [Threshold](double Sample) { return Sample > Threshold; }));
+		return Stats;
+	}
+
+	std::vector<double> TimeManager::GetFrameTimes() const
+	{
+		std::vector<double> Times;
+		Times.reserve(m_FrameTimeCount);
+		const size_t First = (m_FrameTimeNext + m_FrameTimes.size() - m_FrameTimeCount) % m_FrameTimes.size();
+		for (size_t Index = 0; Index < m_FrameTimeCount; Index++)
+		{
+			Times.push_back(m_FrameTimes[(First + Index) % m_FrameTimes.size()]);
+		}
+		return Times;
+	}
+
 	double TimeManager::GetTimeSeconds()
 	{
 		return glfwGetTime();
@@ -0,0 +1,237 @@
+#include <FireGL/Core/TimerWheel.h>
+#include <FireGL/Core/BaseLog.h>
+
+namespace fgl
+{
+
+	TimerWheel::TimerWheel(double TickSeconds)
+		: m_TickSeconds(TickSeconds)
+	{
+		LOG_ASSERT(TickSeconds > 0.0, "The resolution of a timer wheel must be positive")
+		m_Slots.fill(NullTimer);
+	}
+
+	TimerHandle TimerWheel::Schedule(double DelaySeconds, Callback Function)
+	{
+		return Add(ToTicks(DelaySeconds), 0, std::move(Function));
+	}
+
+	TimerHandle TimerWheel::ScheduleRepeating(double IntervalSeconds, Callback Function)
+	{
+		const uint64_t Interval = ToTicks(IntervalSeconds);
+		return Add(Interval, Interval, std::move(Function));
+	}
+
+	bool TimerWheel::Cancel(TimerHandle Handle)
+	{
+		if (!IsPending(Handle))
+			return false;
+
+		Unlink(Handle.Index);
+		Release(Handle.Index);
+		return true;
+	}
+
+	bool TimerWheel::IsPending(TimerHandle Handle) const
+	{
+		return Handle.Index < m_Timers.size() && m_Timers[Handle.Index].Generation == Handle.Generation && m_Timers[Handle.Index].bPending;
+	}
+
+	void TimerWheel::Advance(double Seconds)
+	{
+		m_Remainder += std::max(Seconds, 0.0);
+		const uint64_t Ticks = static_cast<uint64_t>(m_Remainder / m_TickSeconds);
+		m_Remainder -= static_cast<double>(Ticks) * m_TickSeconds;
+
+		for (uint64_t Tick = 0; Tick < Ticks; Tick++)
+		{
+			// Without timers there is nothing to cascade or fire, the wheel only moves
+			if (m_PendingCount == 0)
+			{
+				m_CurrentTick += Ticks - Tick;
+				return;
+			}
+
+			m_CurrentTick++;
+
+			// Each wrap of a level brings the next slot of the level above down, the highest first to wrap last
+			for (uint32_t Level = 1; Level < LevelCount && ((m_CurrentTick >> (SlotBits * (Level - 1))) & SlotMask) == 0; Level++)
+			{
+				Cascade(Level, static_cast<uint32_t>((m_CurrentTick >> (SlotBits * Level)) & SlotMask));
+			}
+			FireCurrentSlot();
+		}
+	}
+
+	void TimerWheel::Clear()
+	{
+		for (uint32_t Index = 0; Index < m_Timers.size(); Index++)
+		{
+			if (m_Timers[Index].bPending)
+			{
+				Unlink(Index);
+				Release(Index);
+			}
+		}
+	}
+
+	size_t TimerWheel::GetPendingCount() const
+	{
+		return m_PendingCount;
+	}
+
+	double TimerWheel::GetTickSeconds() const
+	{
+		return m_TickSeconds;
+	}
+
+	uint64_t TimerWheel::ToTicks(double Seconds) const
+	{
+		// A timer never fires in the tick it was scheduled in, and far deadlines are clamped rather than overflowing
+		const double Ticks = std::ceil(std::max(Seconds, 0.0) / m_TickSeconds - 1e-9);
+		return static_cast<uint64_t>(std::clamp(Ticks, 1.0, static_cast<double>(1ull << 62)));
+	}
+
+	TimerHandle TimerWheel::Add(uint64_t Delay, uint64_t Interval, Callback Function)
+	{
+		uint32_t Index = m_FreeTimers;
+		if (Index != NullTimer)
+		{
+			m_FreeTimers = m_Timers[Index].Next;
+		}
+		else
+		{
+			Index = static_cast<uint32_t>(m_Timers.size());
+			m_Timers.emplace_back();
+		}
+
+		Timer& Added = m_Timers[Index];
+		Added.Function = std::move(Function);
+		Added.Deadline = m_CurrentTick + Delay;
+		Added.Interval = Interval;
+		Added.bPending = true;
+		Link(Index);
+		m_PendingCount++;
+		return { Index, Added.Generation };
+	}
+
+	void TimerWheel::Link(uint32_t Index)
+	{
+		Timer& Linked = m_Timers[Index];
+
+		// The level is picked by the distance to the deadline, the slot by the deadline's own bits at that level
+		const uint64_t Delta = Linked.Deadline > m_CurrentTick ? Linked.Deadline - m_CurrentTick : 0;
+		uint32_t Level = 0;
+		while (Level + 1 < LevelCount && Delta >= (1ull << (SlotBits * (Level + 1))))
+		{
+			Level++;
+		}
+
+		// Beyond the span of the wheel, the timer waits in the last slot it covers and is placed again when cascaded
+		const uint64_t Span = 1ull << (SlotBits * LevelCount);
+		const uint64_t Tick = Delta == 0 ? m_CurrentTick : m_CurrentTick + std::min(Delta, Span - 1);
+		const uint32_t Slot = Level * SlotCount + static_cast<uint32_t>((Tick >> (SlotBits * Level)) & SlotMask);
+
+		Linked.Slot = Slot;
+		Linked.Previous = NullTimer;
+		Linked.Next = m_Slots[Slot];
+		if (Linked.Next != NullTimer)
+		{
+			m_Timers[Linked.Next].Previous = Index;
+		}
+		m_Slots[Slot] = Index;
+	}
+
+	void TimerWheel::Unlink(uint32_t Index)
+	{
+		Timer& Unlinked = m_Timers[Index];
+		if (Unlinked.Slot == NullTimer)
+			return;
+
+		if (Unlinked.Previous != NullTimer)
+		{
+			m_Timers[Unlinked.Previous].Next = Unlinked.Next;
+		}
+		else
+		{
+			m_Slots[Unlinked.Slot] = Unlinked.Next;
+		}
+		if (Unlinked.Next != NullTimer)
+		{
+			m_Timers[Unlinked.Next].Previous = Unlinked.Previous;
+		}
+		Unlinked.Slot = NullTimer;
+		Unlinked.Previous = NullTimer;
+		Unlinked.Next = NullTimer;
+	}
+
+	void TimerWheel::Release(uint32_t Index)
+	{
+		Timer& Released = m_Timers[Index];
+		Released.Function = nullptr;
+		Released.Generation++;
+		Released.bPending = false;
+		Released.Next = m_FreeTimers;
+		m_FreeTimers = Index;
+		m_PendingCount--;
+	}
+
+	void TimerWheel::Cascade(uint32_t Level, uint32_t SlotIndex)
+	{
+		const uint32_t Slot = Level * SlotCount + SlotIndex;
+		uint32_t Index = m_Slots[Slot];
+		m_Slots[Slot] = NullTimer;
+		while (Index != NullTimer)
+		{
+			const uint32_t Next = m_Timers[Index].Next;
+			Link(Index);
+			Index = Next;
+		}
+	}
+
+	void TimerWheel::FireCurrentSlot()
+	{
+		const uint32_t Slot = static_cast<uint32_t>(m_CurrentTick & SlotMask);
+		if (m_Slots[Slot] == NullTimer)
+			return;
+
+		// The whole slot is unlinked before any callback runs, so callbacks may schedule and cancel freely
+		m_Firing.clear();
+		for (uint32_t Index = m_Slots[Slot]; Index != NullTimer;)
+		{
+			Timer& Due = m_Timers[Index];
+			const uint32_t Next = Due.Next;
+			m_Firing.emplace_back(Index, Due.Generation);
+			Due.Slot = NullTimer;
+			Due.Previous = NullTimer;
+			Due.Next = NullTimer;
+			Index = Next;
+		}
+		m_Slots[Slot] = NullTimer;
+
+		for (size_t Fired = 0; Fired < m_Firing.size(); Fired++)
+		{
+			const auto [Index, Generation] = m_Firing[Fired];
+			if (m_Timers[Index].Generation != Generation || !m_Timers[Index].bPending)
+				continue;
+
+			// The callback may grow the pool, it runs from a local rather than from the timer
+			Callback Function = std::move(m_Timers[Index].Function);
+			if (m_Timers[Index].Interval == 0)
+			{
+				Release(Index);
+				Function();
+				continue;
+			}
+
+			m_Timers[Index].Deadline += m_Timers[Index].Interval;
+			Link(Index);
+			Function();
+			if (m_Timers[Index].Generation == Generation)
+			{
+				m_Timers[Index].Function = std::move(Function);
+			}
+		}
+	}
+
+} // namespace fgl
@@ -2,6 +2,8 @@
 #include <FireGL/Core/InputManager.h>
 #include <FireGL/Core/BaseLog.h>
 #include <FireGL/Core/SystemManager.h>
+#include <FireGL/Core/Profiler.h>
+#include <FireGL/Core/GLDebug.h>
 
 #include <External/stb/stb_image.h>
 
@@ -15,7 +17,7 @@ namespace fgl {
         m_CurrentWindow = CreateWindow(ApplicationName, WindowType, WindowWidth, WindowHeight);
 
         SetOpenGLContext();
-        SetupInputModes();
+        SetupInputModes(WindowType);
         RegisterCallbacks();
 
         SetVSync(VSyncEnabled);
@@ -31,15 +33,22 @@ namespace fgl {
         glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, OpenGLMinorVersion);
         glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
         glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-        glfwWindowHint(GLFW_SAMPLES, 4);
+        glfwWindowHint(GLFW_SAMPLES, m_Samples);
+#if defined(FIREGL_ENABLE_GL_DEBUG)
+        // Most drivers only report debug messages to debug contexts
+        glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GLFW_TRUE);
+#endif
     }
 
     GLFWwindow* BaseWindow::CreateWindow(std::string_view ApplicationName, WindowType WindowType, std::optional<int> WindowWidth, std::optional<int> WindowHeight)
     {
+        // Headless machines may have no monitor, which only the fullscreen types need
         GLFWmonitor* Monitor = glfwGetPrimaryMonitor();
-        const GLFWvidmode* Mode = glfwGetVideoMode(Monitor);
-        const int ScreenWidth = Mode->width;
-        const int ScreenHeight = Mode->height;
+        const GLFWvidmode* Mode = Monitor ? glfwGetVideoMode(Monitor) : nullptr;
+        LOG_ASSERT(Mode || WindowType == WindowType::Windowed || WindowType == WindowType::BorderlessWindowed || WindowType == WindowType::Hidden,
+            "No monitor found for a fullscreen window");
+        const int ScreenWidth = Mode ? Mode->width : 0;
+        const int ScreenHeight = Mode ? Mode->height : 0;
         GLFWwindow* Window = nullptr;
 
         switch (WindowType)
@@ -73,6 +82,14 @@ namespace fgl {
             Window = glfwCreateWindow(WindowWidth.value(), WindowHeight.value(), ApplicationName.data(), nullptr, nullptr);
             break;
         }
+        case WindowType::Hidden:
+        {
+            LOG_ASSERT((WindowWidth.has_value() && WindowHeight.has_value()), "Missing at least one Window's Coordinate");
+
+            glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+            Window = glfwCreateWindow(WindowWidth.value(), WindowHeight.value(), ApplicationName.data(), nullptr, nullptr);
+            break;
+        }
         default:
             LOG_ASSERT(false, "No Enum Type matched...");
         }
@@ -89,12 +106,19 @@ namespace fgl {
         glfwSetWindowUserPointer(m_CurrentWindow, this);
         glfwMakeContextCurrent(m_CurrentWindow);
         LOG_ASSERT(gladLoadGLLoader((GLADloadproc)glfwGetProcAddress), "Failed to initialize GLAD");
+		Profiler::CreateGPUContext();
+#if defined(FIREGL_ENABLE_GL_DEBUG)
+        GLDebug::Initialize(true);
+#endif
 
     }
 
-    void BaseWindow::SetupInputModes()
+    void BaseWindow::SetupInputModes(WindowType WindowType)
     {
-        glfwSetInputMode(m_CurrentWindow, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+        if (WindowType != WindowType::Hidden)
+        {
+            glfwSetInputMode(m_CurrentWindow, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+        }
         glfwSetInputMode(m_CurrentWindow, GLFW_STICKY_KEYS, GLFW_TRUE);
     }
 
@@ -113,6 +137,7 @@ namespace fgl {
         glfwSetMouseButtonCallback(m_CurrentWindow, glfwMouseButtonCallback);
         glfwSetCursorPosCallback(m_CurrentWindow, glfwMouseMoveCallback);
         glfwSetScrollCallback(m_CurrentWindow, glfwScrollCallback);
+        glfwSetKeyCallback(m_CurrentWindow, glfwKeyCallback);
 
         OnRegisterCallbacks();
     }
@@ -134,6 +159,13 @@ namespace fgl {
 
         glfwSetInputMode(m_CurrentWindow, GLFW_CURSOR, GLFW_CURSOR_NORMAL);
         m_WindowFocused = false;
+
+        // The cursor moves freely until focus returns, that jump isn't movement
+        InputManager* Input = SystemManager<InputManager>::Get();
+        if (Input)
+        {
+            Input->ResetCursor();
+        }
     }
 
     void BaseWindow::SetVSync(bool VSyncEnabled)
@@ -141,6 +173,96 @@ namespace fgl {
         glfwSwapInterval(static_cast<int>(VSyncEnabled));
     }
 
+    VSyncMode BaseWindow::SetVSyncMode(VSyncMode Mode)
+    {
+        if (Mode == VSyncMode::Adaptive && !glfwExtensionSupported("WGL_EXT_swap_control_tear") && !glfwExtensionSupported("GLX_EXT_swap_control_tear"))
+        {
+            LOG_INFO("Adaptive VSync isn't supported by the driver, using VSync")
+            Mode = VSyncMode::On;
+        }
+
+        switch (Mode)
+        {
+        case VSyncMode::Off:
+            glfwSwapInterval(0);
+            break;
+        case VSyncMode::On:
+            glfwSwapInterval(1);
+            break;
+        case VSyncMode::Adaptive:
+            glfwSwapInterval(-1);
+            break;
+        }
+        return Mode;
+    }
+
+    void BaseWindow::SetFrameRateLimit(double FramesPerSecond)
+    {
+        m_FrameLimiter.SetTargetFrameRate(FramesPerSecond);
+    }
+
+    FrameLimiter& BaseWindow::GetFrameLimiter()
+    {
+        return m_FrameLimiter;
+    }
+
+    void BaseWindow::SwapBuffers()
+    {
+        // A frame nobody sees isn't presented, the frame limiter doesn't pace the idle loop either
+        if (!IsPresentable())
+            return;
+
+        m_FrameLimiter.Wait();
+        glfwSwapBuffers(m_CurrentWindow);
+        Profiler::MarkFrame();
+    }
+
+    void BaseWindow::SetRenderThread(bool bEnabled)
+    {
+        if (bEnabled == m_RenderThread.IsRunning())
+            return;
+
+        if (bEnabled)
+        {
+            m_RenderThread.Start(m_CurrentWindow);
+        }
+        else
+        {
+            m_RenderThread.Stop();
+        }
+    }
+
+    RenderThread& BaseWindow::GetRenderThread()
+    {
+        return m_RenderThread;
+    }
+
+    bool BaseWindow::SetUploadThread(bool bEnabled)
+    {
+        if (bEnabled == m_UploadThread.IsRunning())
+            return true;
+
+        if (bEnabled)
+            return m_UploadThread.Start(m_CurrentWindow);
+
+        m_UploadThread.Stop();
+        return true;
+    }
+
+    GLUploadThread& BaseWindow::GetUploadThread()
+    {
+        return m_UploadThread;
+    }
+
+    bool BaseWindow::SetRawMouseMotion(bool bEnabled)
+    {
+        if (bEnabled && !glfwRawMouseMotionSupported())
+            return false;
+
+        glfwSetInputMode(m_CurrentWindow, GLFW_RAW_MOUSE_MOTION, bEnabled ? GLFW_TRUE : GLFW_FALSE);
+        return true;
+    }
+
     void BaseWindow::SetWindowPositionCenter()
     {
         GLFWmonitor* Monitor = glfwGetPrimaryMonitor();
@@ -174,8 +296,35 @@ namespace fgl {
         return m_WindowFocused;
     }
 
+    bool BaseWindow::IsPresentable() const
+    {
+        return !m_bIconified.load(std::memory_order_relaxed) && !m_bFramebufferEmpty.load(std::memory_order_relaxed);
+    }
+
+    void BaseWindow::SetIdleEventTimeout(double Seconds)
+    {
+        m_IdleEventTimeout = std::max(Seconds, 0.0);
+    }
+
+    double BaseWindow::GetIdleEventTimeout() const
+    {
+        return m_IdleEventTimeout;
+    }
+
+    void BaseWindow::SetSamples(int Samples)
+    {
+        m_Samples = std::max(Samples, 0);
+    }
+
+    int BaseWindow::GetSamples() const
+    {
+        return m_Samples;
+    }
+
     void BaseWindow::Terminate()
     {
+        SetRenderThread(false);
+        SetUploadThread(false);
         Termination();
         glfwTerminate();
     }
@@ -350,7 +499,13 @@ namespace fgl {
 
     void BaseWindow::OnFrameBufferSizeChange(GLFWwindow* Window, int Width, int Height)
     {
-        glViewport(0, 0, Width, Height); ///< Default Implementation not called when overriden.
+        // Default Implementation not called when overriden.
+        if (m_RenderThread.IsRunning())
+        {
+            m_RenderThread.SetViewport(Width, Height);
+            return;
+        }
+        glViewport(0, 0, Width, Height);
     }
 
     void BaseWindow::OnWindowFocusChange(GLFWwindow* Window, bool Focused)
@@ -400,6 +555,13 @@ namespace fgl {
         if (Button == GLFW_MOUSE_BUTTON_LEFT && Action == GLFW_PRESS && !m_WindowFocused)
         {
             HandleFocus(true);
+            return;
+        }
+
+        InputManager* Input = SystemManager<InputManager>::Get();
+        if (Input && m_WindowFocused)
+        {
+            Input->UpdateMouseButton(Button, Action, Mods);
         }
     }
 
@@ -407,6 +569,7 @@ namespace fgl {
     {
         BaseWindow* Self = static_cast<BaseWindow*>(glfwGetWindowUserPointer(Window));
         if (Self) {
+            Self->m_bFramebufferEmpty = Width == 0 || Height == 0;
             Self->OnFrameBufferSizeChange(Window, Width, Height);
         }
     }
@@ -455,6 +618,7 @@ namespace fgl {
     {
         BaseWindow* Self = static_cast<BaseWindow*>(glfwGetWindowUserPointer(Window));
         if (Self) {
+            Self->m_bIconified = static_cast<bool>(Iconified);
             Self->OnWindowIconify(Window, static_cast<bool>(Iconified));
         }
     }
@@ -515,4 +679,14 @@ namespace fgl {
         }
     }
 
+    void BaseWindow::glfwKeyCallback(GLFWwindow* Window, int Key, int Scancode, int Action, int Mods)
+    {
+        // Unlike mouse and scroll, releases while unfocused are forwarded so no key stays down
+        InputManager* Input = SystemManager<InputManager>::Get();
+        if (Input)
+        {
+            Input->UpdateKey(Key, Action, Mods);
+        }
+    }
+
 } // namespace fgl
\ No newline at end of file
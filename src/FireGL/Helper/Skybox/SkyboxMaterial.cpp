@@ -11,11 +11,13 @@ namespace fgl
     SkyboxMaterial::SkyboxMaterial(Shader* Shader)
         : Material(Shader)
     {
+        // Seen from inside, the faces of the cube are its back faces; at the far plane it must pass a depth equal to the clear value
+        SetRasterState({ CullMode::Front, GL_LEQUAL, true });
     }
 
     void SkyboxMaterial::ApplyUniforms()
     {
-        const Shader* SkyboxShader = GetShader();
+        const Shader* SkyboxShader = GetRenderState().Program;
         SceneObject* SceneObject = GetSceneObject();
 
         // The skybox is treated as infinite, so we manually set the projection and view matrices 
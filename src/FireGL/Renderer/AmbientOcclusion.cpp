@@ -0,0 +1,411 @@
+#include <FireGL/Renderer/AmbientOcclusion.h>
+#include <FireGL/Renderer/CameraUniformBuffer.h>
+#include <FireGL/Renderer/HiZBuffer.h>
+#include <FireGL/Renderer/GLStateCache.h>
+#include <FireGL/Renderer/GPUMemoryTracker.h>
+#include <FireGL/Renderer/RenderStats.h>
+#include <FireGL/Core/BaseLog.h>
+
+namespace fgl
+{
+
+	namespace
+	{
+		constexpr std::string_view FullScreenVertexCode = R"(#version 410 core
+void main()
+{
+    // vertices (-1, -1), (3, -1) and (-1, 3) cover the viewport
+    gl_Position = vec4(vec2((gl_VertexID << 1) & 2, gl_VertexID & 2) * 2.0 - 1.0, 0.0, 1.0);
+})";
+
+		constexpr std::string_view DownsampleFragmentCode = R"(#version 410 core
+out vec4 FragColor;
+
+uniform sampler2D Depth;
+uniform vec2 DepthParams;
+
+void main()
+{
+    // View distance from the projection's depth terms, the depth is in [0, 1] and the clip space in [-1, 1]
+    float Value = texelFetch(Depth, min(ivec2(gl_FragCoord.xy) * 2, textureSize(Depth, 0) - 1), 0).r;
+    FragColor = vec4(DepthParams.y / (Value * 2.0 - 1.0 + DepthParams.x));
+})";
+
+		constexpr std::string_view OcclusionFragmentCode = R"(
+out vec4 FragColor;
+
+uniform sampler2D ViewDepth;
+uniform vec4 ProjectionParams;
+uniform float ProjectionScale;
+uniform float Radius;
+uniform float Bias;
+uniform float IntensityDivR6;
+
+vec3 ViewPosition(ivec2 Pixel)
+{
+    float Distance = texelFetch(ViewDepth, Pixel, 0).r;
+    vec2 Ndc = (vec2(Pixel) + 0.5) / vec2(textureSize(ViewDepth, 0)) * 2.0 - 1.0;
+    return vec3(Distance * (Ndc + ProjectionParams.zw) / ProjectionParams.xy, -Distance);
+}
+
+void main()
+{
+    ivec2 Pixel = ivec2(gl_FragCoord.xy);
+    ivec2 Last = textureSize(ViewDepth, 0) - 1;
+    vec3 Position = ViewPosition(Pixel);
+
+    // Normal from the neighbours on the side of the smaller depth step, so silhouettes don't bend it
+    vec3 Right = ViewPosition(min(Pixel + ivec2(1, 0), Last)) - Position;
+    vec3 Left = Position - ViewPosition(max(Pixel - ivec2(1, 0), ivec2(0)));
+    vec3 Up = ViewPosition(min(Pixel + ivec2(0, 1), Last)) - Position;
+    vec3 Down = Position - ViewPosition(max(Pixel - ivec2(0, 1), ivec2(0)));
+    vec3 DX = (Pixel.x == Last.x || (Pixel.x > 0 && abs(Left.z) < abs(Right.z))) ? Left : Right;
+    vec3 DY = (Pixel.y == Last.y || (Pixel.y > 0 && abs(Down.z) < abs(Up.z))) ? Down : Up;
+    vec3 Normal = normalize(cross(DX, DY));
+
+    // Radius of the search on screen, nothing to find below a pixel
+    float ScreenRadius = ProjectionScale * Radius / -Position.z;
+    if (ScreenRadius < 1.0)
+    {
+        FragColor = vec4(1.0, -Position.z, 0.0, 0.0);
+        return;
+    }
+
+    // The 4x4 interleaved pattern rotates the spiral, the 16 pixels of a tile cover every direction
+    float Rotation = float(((Pixel.x & 3) << 2) + (Pixel.y & 3)) * (6.2831853 / 16.0);
+    float Radius2 = Radius * Radius;
+    float Sum = 0.0;
+    for (int Index = 0; Index < SAMPLE_COUNT; Index++)
+    {
+        float Alpha = (float(Index) + 0.5) / float(SAMPLE_COUNT);
+        float Angle = Alpha * (3.0 * 6.2831853) + Rotation;
+        ivec2 Tap = clamp(Pixel + ivec2(round(vec2(cos(Angle), sin(Angle)) * Alpha * ScreenRadius)), ivec2(0), Last);
+        vec3 Offset = ViewPosition(Tap) - Position;
+        float Distance2 = dot(Offset, Offset);
+        float Falloff = max(Radius2 - Distance2, 0.0);
+        Sum += Falloff * Falloff * Falloff * max((dot(Offset, Normal) - Bias) / (Distance2 + 0.01), 0.0);
+    }
+
+    // The distance rides along for the blur and the upsample
+    FragColor = vec4(max(1.0 - Sum * IntensityDivR6 * (5.0 / float(SAMPLE_COUNT)), 0.0), -Position.z, 0.0, 0.0);
+})";
+
+		constexpr std::string_view BlurFragmentCode = R"(#version 410 core
+out vec4 FragColor;
+
+uniform sampler2D Source;
+uniform vec2 Direction;
+uniform float Sharpness;
+
+const float Weights[5] = float[](0.153170, 0.144893, 0.122649, 0.092902, 0.062970);
+
+void main()
+{
+    ivec2 Pixel = ivec2(gl_FragCoord.xy);
+    ivec2 Last = textureSize(Source, 0) - 1;
+    vec2 Center = texelFetch(Source, Pixel, 0).rg;
+    float Sum = Center.r * Weights[0];
+    float Total = Weights[0];
+    for (int Step = 1; Step < 5; Step++)
+    {
+        for (int Side = -1; Side <= 1; Side += 2)
+        {
+            // Taps across a depth discontinuity weigh nothing, occlusion doesn't bleed over the silhouettes
+            vec2 Tap = texelFetch(Source, clamp(Pixel + ivec2(Direction) * (Step * Side), ivec2(0), Last), 0).rg;
+            float Weight = Weights[Step] * max(1.0 - Sharpness * abs(Tap.g - Center.g) / Center.g, 0.0);
+            Sum += Tap.r * Weight;
+            Total += Weight;
+        }
+    }
+    FragColor = vec4(Sum / Total, Center.g, 0.0, 0.0);
+})";
+
+		constexpr std::string_view UpsampleFragmentCode = R"(#version 410 core
+out vec4 FragColor;
+
+uniform sampler2D Depth;
+uniform sampler2D Source;
+uniform vec2 DepthParams;
+uniform vec2 Offset;
+uniform float Sharpness;
+
+void main()
+{
+    ivec2 Pixel = ivec2(gl_FragCoord.xy - Offset);
+    float Distance = DepthParams.y / (texelFetch(Depth, Pixel, 0).r * 2.0 - 1.0 + DepthParams.x);
+
+    // The four half-resolution pixels around this one, bilinear weights scaled down by their depth difference
+    vec2 Position = (vec2(Pixel) + 0.5) * 0.5 - 0.5;
+    ivec2 Base = ivec2(floor(Position));
+    vec2 Fraction = Position - vec2(Base);
+    ivec2 Last = textureSize(Source, 0) - 1;
+    float Sum = 0.0;
+    float Total = 0.0;
+    for (int Y = 0; Y <= 1; Y++)
+    {
+        for (int X = 0; X <= 1; X++)
+        {
+            vec2 Tap = texelFetch(Source, clamp(Base + ivec2(X, Y), ivec2(0), Last), 0).rg;
+            vec2 Bilinear = mix(1.0 - Fraction, Fraction, vec2(X, Y));
+            float Weight = Bilinear.x * Bilinear.y / (0.001 + Sharpness * abs(Tap.g - Distance) / Distance);
+            Sum += Tap.r * Weight;
+            Total += Weight;
+        }
+    }
+    FragColor = vec4(Sum / max(Total, 1e-6));
+})";
+
+		std::string Concatenate(std::initializer_list<std::string_view> Parts)
+		{
+			std::string Result;
+			for (std::string_view Part : Parts)
+			{
+				Result += Part;
+			}
+			return Result;
+		}
+	} // namespace
+
+	AmbientOcclusion::~AmbientOcclusion()
+	{
+		Destroy();
+	}
+
+	void AmbientOcclusion::Create()
+	{
+		LOG_ASSERT(m_WhiteTexture == 0, "Ambient occlusion created twice")
+		const uint8_t White = 255;
+		glGenTextures(1, &m_WhiteTexture);
+		GLStateCache::BindTexture(GL_TEXTURE_2D, m_WhiteTexture);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, 1, 1, 0, GL_RED, GL_UNSIGNED_BYTE, &White);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		GPUMemoryTracker::TrackTexture(m_WhiteTexture, GPUMemoryTracker::GetTextureSize(GL_R8, 1, 1), GPUMemoryCategory::RenderTargets, "AmbientOcclusion");
+		Disable();
+	}
+
+	void AmbientOcclusion::Destroy()
+	{
+		m_Result = PooledTarget();
+		m_Targets.Destroy();
+		for (GLuint* Texture : { &m_WhiteTexture, &m_DepthCopy })
+		{
+			if (*Texture != 0)
+			{
+				glDeleteTextures(1, Texture);
+				GLStateCache::OnTextureDeleted(*Texture);
+				GPUMemoryTracker::UntrackTexture(*Texture);
+				*Texture = 0;
+			}
+		}
+		if (m_DepthFramebuffer != 0)
+		{
+			glDeleteFramebuffers(1, &m_DepthFramebuffer);
+			m_DepthFramebuffer = 0;
+		}
+		for (std::unique_ptr<Shader>* Pass : { &m_DownsampleShader, &m_OcclusionShader, &m_BlurShader, &m_UpsampleShader })
+		{
+			if (*Pass)
+			{
+				(*Pass)->Cleanup();
+				Pass->reset();
+			}
+		}
+		if (m_FullScreenVertexArray != 0)
+		{
+			glDeleteVertexArrays(1, &m_FullScreenVertexArray);
+			GLStateCache::OnVertexArrayDeleted(m_FullScreenVertexArray);
+			m_FullScreenVertexArray = 0;
+		}
+	}
+
+	bool AmbientOcclusion::IsCreated() const
+	{
+		return m_WhiteTexture != 0;
+	}
+
+	AmbientOcclusionSettings& AmbientOcclusion::GetSettings()
+	{
+		return m_Settings;
+	}
+
+	const AmbientOcclusionSettings& AmbientOcclusion::GetSettings() const
+	{
+		return m_Settings;
+	}
+
+	void AmbientOcclusion::Compute(const CameraData& Camera)
+	{
+		LOG_ASSERT(IsCreated(), "Ambient occlusion computed before Create()")
+		if (!m_DownsampleShader)
+		{
+			m_DownsampleShader = Shader::CreateFromSource(FullScreenVertexCode, DownsampleFragmentCode);
+			m_OcclusionShader = Shader::CreateFromSource(FullScreenVertexCode,
+				Concatenate({ "#version 410 core\n#define SAMPLE_COUNT ", std::to_string(SampleCount), "\n", OcclusionFragmentCode }));
+			m_BlurShader = Shader::CreateFromSource(FullScreenVertexCode, BlurFragmentCode);
+			m_UpsampleShader = Shader::CreateFromSource(FullScreenVertexCode, UpsampleFragmentCode);
+			glGenVertexArrays(1, &m_FullScreenVertexArray);
+		}
+		if (m_Result.Framebuffer != 0)
+		{
+			m_Targets.Release(m_Result);
+			m_Result = PooledTarget();
+		}
+
+		GLint Viewport[4];
+		glGetIntegerv(GL_VIEWPORT, Viewport);
+		GLint DrawFramebuffer = 0;
+		glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &DrawFramebuffer);
+		GLint ReadFramebuffer = 0;
+		glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &ReadFramebuffer);
+
+		// Copied like the Hi-Z buffer's depth, the source stays bound for the shading that follows
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, DrawFramebuffer);
+		const GLenum DepthFormat = HiZBuffer::GetReadDepthFormat();
+		if (m_DepthFramebuffer == 0 || Viewport[2] != m_DepthWidth || Viewport[3] != m_DepthHeight || DepthFormat != m_DepthFormat)
+		{
+			AllocateDepthCopy(Viewport[2], Viewport[3], DepthFormat);
+		}
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_DepthFramebuffer);
+		glBlitFramebuffer(Viewport[0], Viewport[1], Viewport[0] + m_DepthWidth, Viewport[1] + m_DepthHeight,
+			0, 0, m_DepthWidth, m_DepthHeight, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+
+		// The debug modes draw lines, the triangles must be filled to cover every pixel
+		GLint PolygonMode[2] = {};
+		glGetIntegerv(GL_POLYGON_MODE, PolygonMode);
+		const GLboolean bDepthTest = glIsEnabled(GL_DEPTH_TEST);
+		const GLboolean bBlend = glIsEnabled(GL_BLEND);
+		glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+		glDisable(GL_DEPTH_TEST);
+		glDisable(GL_BLEND);
+
+		m_PassCount = 0;
+		const glm::mat4& Projection = Camera.Projection;
+		const glm::vec2 DepthParams(Projection[2][2], Projection[3][2]);
+		const int HalfWidth = std::max((m_DepthWidth + 1) / 2, 1);
+		const int HalfHeight = std::max((m_DepthHeight + 1) / 2, 1);
+
+		const PooledTarget HalfDepth = m_Targets.Acquire(HalfWidth, HalfHeight, GL_R32F);
+		glBindFramebuffer(GL_FRAMEBUFFER, HalfDepth.Framebuffer);
+		glViewport(0, 0, HalfWidth, HalfHeight);
+		GLStateCache::BindTextureUnit(DepthUnit, GL_TEXTURE_2D, m_DepthCopy);
+		m_DownsampleShader->Activate();
+		m_DownsampleShader->SetInt("Depth", DepthUnit);
+		m_DownsampleShader->SetVec2("DepthParams", DepthParams);
+		DrawFullScreen();
+
+		// Occlusion in red, view distance in green: the blur and the upsample read both in one fetch
+		const PooledTarget Occlusion = m_Targets.Acquire(HalfWidth, HalfHeight, GL_RG16F);
+		const float Radius = std::max(m_Settings.Radius, 1e-4f);
+		glBindFramebuffer(GL_FRAMEBUFFER, Occlusion.Framebuffer);
+		GLStateCache::BindTextureUnit(DepthUnit, GL_TEXTURE_2D, HalfDepth.Texture);
+		m_OcclusionShader->Activate();
+		m_OcclusionShader->SetInt("ViewDepth", DepthUnit);
+		m_OcclusionShader->SetVec4("ProjectionParams", glm::vec4(Projection[0][0], Projection[1][1], Projection[2][0], Projection[2][1]));
+		m_OcclusionShader->SetFloat("ProjectionScale", Projection[1][1] * 0.5f * static_cast<float>(HalfHeight));
+		m_OcclusionShader->SetFloat("Radius", Radius);
+		m_OcclusionShader->SetFloat("Bias", m_Settings.Bias);
+		m_OcclusionShader->SetFloat("IntensityDivR6", m_Settings.Intensity / std::pow(Radius, 6.0f));
+		DrawFullScreen();
+		m_Targets.Release(HalfDepth);
+
+		// Horizontal then vertical, back into the occlusion target
+		const PooledTarget Blurred = m_Targets.Acquire(HalfWidth, HalfHeight, GL_RG16F);
+		m_BlurShader->Activate();
+		m_BlurShader->SetInt("Source", SourceUnit);
+		m_BlurShader->SetFloat("Sharpness", m_Settings.Sharpness);
+		glBindFramebuffer(GL_FRAMEBUFFER, Blurred.Framebuffer);
+		GLStateCache::BindTextureUnit(SourceUnit, GL_TEXTURE_2D, Occlusion.Texture);
+		m_BlurShader->SetVec2("Direction", 1.0f, 0.0f);
+		DrawFullScreen();
+		glBindFramebuffer(GL_FRAMEBUFFER, Occlusion.Framebuffer);
+		GLStateCache::BindTextureUnit(SourceUnit, GL_TEXTURE_2D, Blurred.Texture);
+		m_BlurShader->SetVec2("Direction", 0.0f, 1.0f);
+		DrawFullScreen();
+		m_Targets.Release(Blurred);
+
+		// Covers the viewport's offset too, the lighting reads the result at gl_FragCoord
+		m_Result = m_Targets.Acquire(Viewport[0] + m_DepthWidth, Viewport[1] + m_DepthHeight, GL_R8);
+		glBindFramebuffer(GL_FRAMEBUFFER, m_Result.Framebuffer);
+		glViewport(Viewport[0], Viewport[1], m_DepthWidth, m_DepthHeight);
+		GLStateCache::BindTextureUnit(DepthUnit, GL_TEXTURE_2D, m_DepthCopy);
+		GLStateCache::BindTextureUnit(SourceUnit, GL_TEXTURE_2D, Occlusion.Texture);
+		m_UpsampleShader->Activate();
+		m_UpsampleShader->SetInt("Depth", DepthUnit);
+		m_UpsampleShader->SetInt("Source", SourceUnit);
+		m_UpsampleShader->SetVec2("DepthParams", DepthParams);
+		m_UpsampleShader->SetVec2("Offset", static_cast<float>(Viewport[0]), static_cast<float>(Viewport[1]));
+		m_UpsampleShader->SetFloat("Sharpness", m_Settings.Sharpness);
+		DrawFullScreen();
+		m_Targets.Release(Occlusion);
+		m_Targets.EndFrame();
+
+		glPolygonMode(GL_FRONT_AND_BACK, static_cast<GLenum>(PolygonMode[0]));
+		if (bDepthTest)
+		{
+			glEnable(GL_DEPTH_TEST);
+		}
+		if (bBlend)
+		{
+			glEnable(GL_BLEND);
+		}
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, ReadFramebuffer);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, DrawFramebuffer);
+		glViewport(Viewport[0], Viewport[1], Viewport[2], Viewport[3]);
+		GLStateCache::BindTextureUnit(TextureUnit, GL_TEXTURE_2D, m_Result.Texture);
+	}
+
+	void AmbientOcclusion::Disable()
+	{
+		if (m_Result.Framebuffer != 0)
+		{
+			m_Targets.Release(m_Result);
+			m_Result = PooledTarget();
+		}
+		GLStateCache::BindTextureUnit(TextureUnit, GL_TEXTURE_2D, m_WhiteTexture);
+	}
+
+	uint32_t AmbientOcclusion::GetPassCount() const
+	{
+		return m_PassCount;
+	}
+
+	void AmbientOcclusion::AllocateDepthCopy(GLint Width, GLint Height, GLenum DepthFormat)
+	{
+		if (m_DepthCopy != 0)
+		{
+			glDeleteTextures(1, &m_DepthCopy);
+			GLStateCache::OnTextureDeleted(m_DepthCopy);
+			GPUMemoryTracker::UntrackTexture(m_DepthCopy);
+			glDeleteFramebuffers(1, &m_DepthFramebuffer);
+		}
+		m_DepthWidth = Width;
+		m_DepthHeight = Height;
+		m_DepthFormat = DepthFormat;
+
+		glGenTextures(1, &m_DepthCopy);
+		GLStateCache::BindTexture(GL_TEXTURE_2D, m_DepthCopy);
+		glTexStorage2D(GL_TEXTURE_2D, 1, DepthFormat, Width, Height);
+		GPUMemoryTracker::TrackTexture(m_DepthCopy, GPUMemoryTracker::GetTextureSize(DepthFormat, Width, Height), GPUMemoryCategory::RenderTargets, "AmbientOcclusion");
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+		glGenFramebuffers(1, &m_DepthFramebuffer);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_DepthFramebuffer);
+		const GLenum Attachment = DepthFormat == GL_DEPTH24_STENCIL8 || DepthFormat == GL_DEPTH32F_STENCIL8 ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+		glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, Attachment, GL_TEXTURE_2D, m_DepthCopy, 0);
+		glDrawBuffer(GL_NONE);
+		LOG_ASSERT(glCheckFramebufferStatus(GL_DRAW_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE, "Ambient occlusion depth framebuffer is incomplete");
+	}
+
+	void AmbientOcclusion::DrawFullScreen()
+	{
+		GLStateCache::BindVertexArray(m_FullScreenVertexArray);
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+		RenderCounters::CountDraw(1, 1);
+		m_PassCount++;
+	}
+
+} // namespace fgl
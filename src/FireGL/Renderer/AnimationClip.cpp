@@ -0,0 +1,462 @@
+#include <FireGL/Renderer/AnimationClip.h>
+#include <FireGL/Renderer/Skeleton.h>
+
+#include <External/assimp/anim.h>
+
+#if defined(__SSE2__) || defined(_M_X64)
+	#include <immintrin.h>
+	#define FGL_ANIMATION_SSE 1
+#elif (defined(__ARM_NEON) && defined(__aarch64__)) || defined(_M_ARM64)
+	#include <arm_neon.h>
+	#define FGL_ANIMATION_NEON 1
+#endif
+
+namespace fgl
+{
+
+	namespace
+	{
+		// Four lanes of floats: every loop below handles four nodes per iteration, the arrays being padded
+#if defined(FGL_ANIMATION_SSE)
+		using Float4 = __m128;
+
+		inline Float4 Load(const float* Source) { return _mm_loadu_ps(Source); }
+		inline void Store(float* Target, Float4 Value) { _mm_storeu_ps(Target, Value); }
+		inline Float4 Splat(float Value) { return _mm_set1_ps(Value); }
+		inline Float4 Add(Float4 A, Float4 B) { return _mm_add_ps(A, B); }
+		inline Float4 Sub(Float4 A, Float4 B) { return _mm_sub_ps(A, B); }
+		inline Float4 Mul(Float4 A, Float4 B) { return _mm_mul_ps(A, B); }
+		inline Float4 InverseSqrt(Float4 Value) { return _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(Value)); }
+
+		/** Flips the sign of the lanes of Value where Sign is negative. */
+		inline Float4 CopySignOf(Float4 Value, Float4 Sign) { return _mm_xor_ps(Value, _mm_and_ps(Sign, _mm_set1_ps(-0.0f))); }
+
+		inline Float4 LoadUnorm16(const uint16_t* Source)
+		{
+			const __m128i Packed = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(Source));
+			return _mm_cvtepi32_ps(_mm_unpacklo_epi16(Packed, _mm_setzero_si128()));
+		}
+
+		inline Float4 LoadSnorm16(const uint16_t* Source)
+		{
+			// Each value lands in the high half of a lane, the arithmetic shift extends its sign
+			const __m128i Packed = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(Source));
+			return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(Packed, Packed), 16));
+		}
+#elif defined(FGL_ANIMATION_NEON)
+		using Float4 = float32x4_t;
+
+		inline Float4 Load(const float* Source) { return vld1q_f32(Source); }
+		inline void Store(float* Target, Float4 Value) { vst1q_f32(Target, Value); }
+		inline Float4 Splat(float Value) { return vdupq_n_f32(Value); }
+		inline Float4 Add(Float4 A, Float4 B) { return vaddq_f32(A, B); }
+		inline Float4 Sub(Float4 A, Float4 B) { return vsubq_f32(A, B); }
+		inline Float4 Mul(Float4 A, Float4 B) { return vmulq_f32(A, B); }
+		inline Float4 InverseSqrt(Float4 Value) { return vdivq_f32(vdupq_n_f32(1.0f), vsqrtq_f32(Value)); }
+
+		/** Flips the sign of the lanes of Value where Sign is negative. */
+		inline Float4 CopySignOf(Float4 Value, Float4 Sign)
+		{
+			const uint32x4_t SignBits = vandq_u32(vreinterpretq_u32_f32(Sign), vdupq_n_u32(0x80000000u));
+			return vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(Value), SignBits));
+		}
+
+		inline Float4 LoadUnorm16(const uint16_t* Source) { return vcvtq_f32_u32(vmovl_u16(vld1_u16(Source))); }
+		inline Float4 LoadSnorm16(const uint16_t* Source) { return vcvtq_f32_s32(vmovl_s16(vld1_s16(reinterpret_cast<const int16_t*>(Source)))); }
+#else
+		struct Float4
+		{
+			float Lane[4];
+		};
+
+		template<typename Operation>
+		inline Float4 PerLane(Float4 A, Float4 B, Operation Op)
+		{
+			return { { Op(A.Lane[0], B.Lane[0]), Op(A.Lane[1], B.Lane[1]), Op(A.Lane[2], B.Lane[2]), Op(A.Lane[3], B.Lane[3]) } };
+		}
+
+		inline Float4 Load(const float* Source) { return { { Source[0], Source[1], Source[2], Source[3] } }; }
+		inline void Store(float* Target, Float4 Value) { std::copy(Value.Lane, Value.Lane + 4, Target); }
+		inline Float4 Splat(float Value) { return { { Value, Value, Value, Value } }; }
+		inline Float4 Add(Float4 A, Float4 B) { return PerLane(A, B, [](float X, float Y) { return X + Y; }); }
+		inline Float4 Sub(Float4 A, Float4 B) { return PerLane(A, B, [](float X, float Y) { return X - Y; }); }
+		inline Float4 Mul(Float4 A, Float4 B) { return PerLane(A, B, [](float X, float Y) { return X * Y; }); }
+		inline Float4 InverseSqrt(Float4 Value) { return PerLane(Value, Value, [](float X, float) { return 1.0f / std::sqrt(X); }); }
+
+		/** Flips the sign of the lanes of Value where Sign is negative. */
+		inline Float4 CopySignOf(Float4 Value, Float4 Sign) { return PerLane(Value, Sign, [](float X, float S) { return std::signbit(S) ? -X : X; }); }
+
+		inline Float4 LoadUnorm16(const uint16_t* Source) { return { { float(Source[0]), float(Source[1]), float(Source[2]), float(Source[3]) } }; }
+		inline Float4 LoadSnorm16(const uint16_t* Source)
+		{
+			return { { float(int16_t(Source[0])), float(int16_t(Source[1])), float(int16_t(Source[2])), float(int16_t(Source[3])) } };
+		}
+#endif
+
+		inline Float4 Lerp(Float4 A, Float4 B, Float4 Weight) { return Add(A, Mul(Sub(B, A), Weight)); }
+
+		constexpr float SnormScale = 32767.0f;
+		constexpr float UnormSteps = 65535.0f;
+
+		/** Component of a pose holding the given quantization range, translations then scales. */
+		constexpr SkeletonPose::Component GetRangeComponent(uint32_t Range)
+		{
+			return static_cast<SkeletonPose::Component>(Range < 3 ? SkeletonPose::TranslationX + Range : SkeletonPose::ScaleX + Range - 3);
+		}
+
+		/** Interpolates vector keys at a time in ticks, Fallback if there is none. */
+		glm::vec3 SampleKeys(const aiVectorKey* Keys, unsigned int Count, double Tick, const glm::vec3& Fallback)
+		{
+			if (Count == 0)
+				return Fallback;
+
+			const aiVectorKey* Next = std::upper_bound(Keys, Keys + Count, Tick, [](double Time, const aiVectorKey& Key) { return Time < Key.mTime; });
+			if (Next == Keys)
+				return glm::vec3(Keys[0].mValue.x, Keys[0].mValue.y, Keys[0].mValue.z);
+			const aiVectorKey& Previous = *(Next - 1);
+			if (Next == Keys + Count)
+				return glm::vec3(Previous.mValue.x, Previous.mValue.y, Previous.mValue.z);
+
+			const float Blend = static_cast<float>((Tick - Previous.mTime) / std::max(Next->mTime - Previous.mTime, 1e-9));
+			return glm::mix(glm::vec3(Previous.mValue.x, Previous.mValue.y, Previous.mValue.z), glm::vec3(Next->mValue.x, Next->mValue.y, Next->mValue.z), Blend);
+		}
+
+		/** Interpolates rotation keys spherically at a time in ticks, Fallback if there is none. */
+		glm::quat SampleKeys(const aiQuatKey* Keys, unsigned int Count, double Tick, const glm::quat& Fallback)
+		{
+			if (Count == 0)
+				return Fallback;
+
+			const aiQuatKey* Next = std::upper_bound(Keys, Keys + Count, Tick, [](double Time, const aiQuatKey& Key) { return Time < Key.mTime; });
+			if (Next == Keys)
+				return glm::quat(Keys[0].mValue.w, Keys[0].mValue.x, Keys[0].mValue.y, Keys[0].mValue.z);
+			const aiQuatKey& Previous = *(Next - 1);
+			if (Next == Keys + Count)
+				return glm::quat(Previous.mValue.w, Previous.mValue.x, Previous.mValue.y, Previous.mValue.z);
+
+			const float Blend = static_cast<float>((Tick - Previous.mTime) / std::max(Next->mTime - Previous.mTime, 1e-9));
+			return glm::slerp(glm::quat(Previous.mValue.w, Previous.mValue.x, Previous.mValue.y, Previous.mValue.z),
+				glm::quat(Next->mValue.w, Next->mValue.x, Next->mValue.y, Next->mValue.z), Blend);
+		}
+	}
+
+	void SkeletonPose::Resize(uint32_t NodeCount)
+	{
+		if (NodeCount == m_NodeCount && !m_Components.empty())
+			return;
+
+		m_NodeCount = NodeCount;
+		m_Stride = (NodeCount + 3) & ~3u;
+		m_Components.assign(size_t(ComponentCount) * m_Stride, 0.0f);
+
+		// Identity rotations and unit scales keep the padding lanes finite when normalized
+		std::fill_n(GetComponent(RotationW), m_Stride, 1.0f);
+		std::fill_n(GetComponent(ScaleX), size_t(3) * m_Stride, 1.0f);
+	}
+
+	uint32_t SkeletonPose::GetNodeCount() const
+	{
+		return m_NodeCount;
+	}
+
+	uint32_t SkeletonPose::GetStride() const
+	{
+		return m_Stride;
+	}
+
+	void SkeletonPose::SetNode(uint32_t Node, const glm::vec3& Translation, const glm::quat& Rotation, const glm::vec3& Scale)
+	{
+		GetComponent(TranslationX)[Node] = Translation.x;
+		GetComponent(TranslationY)[Node] = Translation.y;
+		GetComponent(TranslationZ)[Node] = Translation.z;
+		GetComponent(RotationX)[Node] = Rotation.x;
+		GetComponent(RotationY)[Node] = Rotation.y;
+		GetComponent(RotationZ)[Node] = Rotation.z;
+		GetComponent(RotationW)[Node] = Rotation.w;
+		GetComponent(ScaleX)[Node] = Scale.x;
+		GetComponent(ScaleY)[Node] = Scale.y;
+		GetComponent(ScaleZ)[Node] = Scale.z;
+	}
+
+	void SkeletonPose::SetNode(uint32_t Node, const glm::mat4& Transform)
+	{
+		const glm::vec3 Scale(glm::length(glm::vec3(Transform[0])), glm::length(glm::vec3(Transform[1])), glm::length(glm::vec3(Transform[2])));
+		const glm::mat3 Basis(glm::vec3(Transform[0]) / std::max(Scale.x, 1e-8f), glm::vec3(Transform[1]) / std::max(Scale.y, 1e-8f),
+			glm::vec3(Transform[2]) / std::max(Scale.z, 1e-8f));
+		SetNode(Node, glm::vec3(Transform[3]), glm::normalize(glm::quat_cast(Basis)), Scale);
+	}
+
+	float* SkeletonPose::GetComponent(Component Index)
+	{
+		return m_Components.data() + size_t(Index) * m_Stride;
+	}
+
+	const float* SkeletonPose::GetComponent(Component Index) const
+	{
+		return m_Components.data() + size_t(Index) * m_Stride;
+	}
+
+	void SkeletonPose::Blend(const SkeletonPose& A, const SkeletonPose& B, float Weight, SkeletonPose& Out)
+	{
+		Out.Resize(A.m_NodeCount);
+		const Float4 BlendWeight = Splat(Weight);
+		for (uint32_t Node = 0; Node < A.m_Stride; Node += 4)
+		{
+			for (Component Index : { TranslationX, TranslationY, TranslationZ, ScaleX, ScaleY, ScaleZ })
+			{
+				Store(Out.GetComponent(Index) + Node, Lerp(Load(A.GetComponent(Index) + Node), Load(B.GetComponent(Index) + Node), BlendWeight));
+			}
+
+			// q and -q are the same rotation, B is flipped onto A's hemisphere to take the shortest arc
+			Float4 RotationA[4];
+			Float4 RotationB[4];
+			Float4 Dot = Splat(0.0f);
+			for (uint32_t Axis = 0; Axis < 4; Axis++)
+			{
+				RotationA[Axis] = Load(A.GetComponent(static_cast<Component>(RotationX + Axis)) + Node);
+				RotationB[Axis] = Load(B.GetComponent(static_cast<Component>(RotationX + Axis)) + Node);
+				Dot = Add(Dot, Mul(RotationA[Axis], RotationB[Axis]));
+			}
+
+			Float4 Blended[4];
+			Float4 LengthSquared = Splat(0.0f);
+			for (uint32_t Axis = 0; Axis < 4; Axis++)
+			{
+				Blended[Axis] = Lerp(RotationA[Axis], CopySignOf(RotationB[Axis], Dot), BlendWeight);
+				LengthSquared = Add(LengthSquared, Mul(Blended[Axis], Blended[Axis]));
+			}
+			const Float4 Normalize = InverseSqrt(LengthSquared);
+			for (uint32_t Axis = 0; Axis < 4; Axis++)
+			{
+				Store(Out.GetComponent(static_cast<Component>(RotationX + Axis)) + Node, Mul(Blended[Axis], Normalize));
+			}
+		}
+	}
+
+	void SkeletonPose::GetTransforms(std::vector<glm::mat4>& Transforms) const
+	{
+		Transforms.resize(m_NodeCount);
+		for (uint32_t Node = 0; Node < m_Stride; Node += 4)
+		{
+			const Float4 X = Load(GetComponent(RotationX) + Node);
+			const Float4 Y = Load(GetComponent(RotationY) + Node);
+			const Float4 Z = Load(GetComponent(RotationZ) + Node);
+			const Float4 W = Load(GetComponent(RotationW) + Node);
+			const Float4 SX = Load(GetComponent(ScaleX) + Node);
+			const Float4 SY = Load(GetComponent(ScaleY) + Node);
+			const Float4 SZ = Load(GetComponent(ScaleZ) + Node);
+
+			// Rotation matrix of a unit quaternion, each column scaled, four nodes at once
+			const Float4 Two = Splat(2.0f);
+			const Float4 One = Splat(1.0f);
+			const Float4 XX = Mul(Two, Mul(X, X)), YY = Mul(Two, Mul(Y, Y)), ZZ = Mul(Two, Mul(Z, Z));
+			const Float4 XY = Mul(Two, Mul(X, Y)), XZ = Mul(Two, Mul(X, Z)), YZ = Mul(Two, Mul(Y, Z));
+			const Float4 WX = Mul(Two, Mul(W, X)), WY = Mul(Two, Mul(W, Y)), WZ = Mul(Two, Mul(W, Z));
+
+			float Columns[9][4];
+			Store(Columns[0], Mul(Sub(One, Add(YY, ZZ)), SX));
+			Store(Columns[1], Mul(Add(XY, WZ), SX));
+			Store(Columns[2], Mul(Sub(XZ, WY), SX));
+			Store(Columns[3], Mul(Sub(XY, WZ), SY));
+			Store(Columns[4], Mul(Sub(One, Add(XX, ZZ)), SY));
+			Store(Columns[5], Mul(Add(YZ, WX), SY));
+			Store(Columns[6], Mul(Add(XZ, WY), SZ));
+			Store(Columns[7], Mul(Sub(YZ, WX), SZ));
+			Store(Columns[8], Mul(Sub(One, Add(XX, YY)), SZ));
+
+			const uint32_t LaneCount = std::min(4u, m_NodeCount - std::min(Node, m_NodeCount));
+			for (uint32_t Lane = 0; Lane < LaneCount; Lane++)
+			{
+				glm::mat4& Transform = Transforms[Node + Lane];
+				Transform[0] = glm::vec4(Columns[0][Lane], Columns[1][Lane], Columns[2][Lane], 0.0f);
+				Transform[1] = glm::vec4(Columns[3][Lane], Columns[4][Lane], Columns[5][Lane], 0.0f);
+				Transform[2] = glm::vec4(Columns[6][Lane], Columns[7][Lane], Columns[8][Lane], 0.0f);
+				Transform[3] = glm::vec4(GetComponent(TranslationX)[Node + Lane], GetComponent(TranslationY)[Node + Lane],
+					GetComponent(TranslationZ)[Node + Lane], 1.0f);
+			}
+		}
+	}
+
+	AnimationClip AnimationClip::Import(const aiAnimation* Animation, const Skeleton& Target, float FrameRate)
+	{
+		const double TicksPerSecond = Animation->mTicksPerSecond > 0.0 ? Animation->mTicksPerSecond : 25.0;
+		const SkeletonPose& Rest = Target.GetRestPose();
+
+		AnimationClip Clip;
+		Clip.m_Name = Animation->mName.C_Str();
+		Clip.m_Duration = static_cast<float>(Animation->mDuration / TicksPerSecond);
+		Clip.m_FrameRate = std::max(FrameRate, 1.0f);
+		Clip.m_FrameCount = static_cast<uint32_t>(std::ceil(Clip.m_Duration * Clip.m_FrameRate)) + 1;
+		Clip.m_NodeCount = Rest.GetNodeCount();
+		Clip.m_Stride = Rest.GetStride();
+
+		// Every frame starts from the rest pose, the animated nodes are then evaluated at the frame's time
+		std::vector<const aiNodeAnim*> Channels(Clip.m_NodeCount, nullptr);
+		for (unsigned int i = 0; i < Animation->mNumChannels; i++)
+		{
+			const int32_t Node = Target.FindNode(Animation->mChannels[i]->mNodeName.C_Str());
+			if (Node >= 0)
+			{
+				Channels[Node] = Animation->mChannels[i];
+			}
+		}
+
+		std::vector<SkeletonPose> Frames(Clip.m_FrameCount, Rest);
+		for (uint32_t Frame = 0; Frame < Clip.m_FrameCount; Frame++)
+		{
+			const double Tick = std::min(Frame / static_cast<double>(Clip.m_FrameRate), static_cast<double>(Clip.m_Duration)) * TicksPerSecond;
+			SkeletonPose& Pose = Frames[Frame];
+			for (uint32_t Node = 0; Node < Clip.m_NodeCount; Node++)
+			{
+				const aiNodeAnim* Channel = Channels[Node];
+				if (!Channel)
+					continue;
+
+				const glm::vec3 RestTranslation(Rest.GetComponent(SkeletonPose::TranslationX)[Node], Rest.GetComponent(SkeletonPose::TranslationY)[Node],
+					Rest.GetComponent(SkeletonPose::TranslationZ)[Node]);
+				const glm::quat RestRotation(Rest.GetComponent(SkeletonPose::RotationW)[Node], Rest.GetComponent(SkeletonPose::RotationX)[Node],
+					Rest.GetComponent(SkeletonPose::RotationY)[Node], Rest.GetComponent(SkeletonPose::RotationZ)[Node]);
+				const glm::vec3 RestScale(Rest.GetComponent(SkeletonPose::ScaleX)[Node], Rest.GetComponent(SkeletonPose::ScaleY)[Node],
+					Rest.GetComponent(SkeletonPose::ScaleZ)[Node]);
+
+				glm::quat Rotation = glm::normalize(SampleKeys(Channel->mRotationKeys, Channel->mNumRotationKeys, Tick, RestRotation));
+				if (Frame > 0)
+				{
+					// Neighbouring frames on one hemisphere let Sample() interpolate without a sign test
+					const SkeletonPose& Previous = Frames[Frame - 1];
+					const glm::quat PreviousRotation(Previous.GetComponent(SkeletonPose::RotationW)[Node], Previous.GetComponent(SkeletonPose::RotationX)[Node],
+						Previous.GetComponent(SkeletonPose::RotationY)[Node], Previous.GetComponent(SkeletonPose::RotationZ)[Node]);
+					if (glm::dot(Rotation, PreviousRotation) < 0.0f)
+					{
+						Rotation = -Rotation;
+					}
+				}
+				Pose.SetNode(Node, SampleKeys(Channel->mPositionKeys, Channel->mNumPositionKeys, Tick, RestTranslation), Rotation,
+					SampleKeys(Channel->mScalingKeys, Channel->mNumScalingKeys, Tick, RestScale));
+			}
+		}
+
+		// Ranges per node and component, constant components quantize to 0 with a step of 0
+		Clip.m_RangeMin.assign(size_t(RangeComponentCount) * Clip.m_Stride, 0.0f);
+		Clip.m_RangeScale.assign(size_t(RangeComponentCount) * Clip.m_Stride, 0.0f);
+		for (uint32_t Range = 0; Range < RangeComponentCount; Range++)
+		{
+			const SkeletonPose::Component Component = GetRangeComponent(Range);
+			for (uint32_t Node = 0; Node < Clip.m_Stride; Node++)
+			{
+				float Min = Frames[0].GetComponent(Component)[Node];
+				float Max = Min;
+				for (const SkeletonPose& Pose : Frames)
+				{
+					Min = std::min(Min, Pose.GetComponent(Component)[Node]);
+					Max = std::max(Max, Pose.GetComponent(Component)[Node]);
+				}
+				Clip.m_RangeMin[Range * Clip.m_Stride + Node] = Min;
+				Clip.m_RangeScale[Range * Clip.m_Stride + Node] = (Max - Min) / UnormSteps;
+			}
+		}
+
+		const size_t FrameSize = size_t(SkeletonPose::ComponentCount) * Clip.m_Stride;
+		Clip.m_Frames.resize(FrameSize * Clip.m_FrameCount);
+		for (uint32_t Frame = 0; Frame < Clip.m_FrameCount; Frame++)
+		{
+			uint16_t* Quantized = Clip.m_Frames.data() + Frame * FrameSize;
+			for (uint32_t Axis = 0; Axis < 4; Axis++)
+			{
+				const SkeletonPose::Component Component = static_cast<SkeletonPose::Component>(SkeletonPose::RotationX + Axis);
+				for (uint32_t Node = 0; Node < Clip.m_Stride; Node++)
+				{
+					const float Value = std::clamp(Frames[Frame].GetComponent(Component)[Node], -1.0f, 1.0f);
+					Quantized[Component * Clip.m_Stride + Node] = static_cast<uint16_t>(static_cast<int16_t>(std::lround(Value * SnormScale)));
+				}
+			}
+			for (uint32_t Range = 0; Range < RangeComponentCount; Range++)
+			{
+				const SkeletonPose::Component Component = GetRangeComponent(Range);
+				for (uint32_t Node = 0; Node < Clip.m_Stride; Node++)
+				{
+					const float Step = Clip.m_RangeScale[Range * Clip.m_Stride + Node];
+					const float Offset = Frames[Frame].GetComponent(Component)[Node] - Clip.m_RangeMin[Range * Clip.m_Stride + Node];
+					Quantized[Component * Clip.m_Stride + Node] = Step > 0.0f ? static_cast<uint16_t>(std::lround(std::clamp(Offset / Step, 0.0f, UnormSteps))) : 0;
+				}
+			}
+		}
+		return Clip;
+	}
+
+	const std::string& AnimationClip::GetName() const
+	{
+		return m_Name;
+	}
+
+	float AnimationClip::GetDuration() const
+	{
+		return m_Duration;
+	}
+
+	uint32_t AnimationClip::GetNodeCount() const
+	{
+		return m_NodeCount;
+	}
+
+	size_t AnimationClip::GetMemorySize() const
+	{
+		return m_Frames.size() * sizeof(uint16_t) + (m_RangeMin.size() + m_RangeScale.size()) * sizeof(float);
+	}
+
+	void AnimationClip::Sample(float Time, SkeletonPose& Pose, bool bLoop) const
+	{
+		Pose.Resize(m_NodeCount);
+		if (m_FrameCount == 0)
+			return;
+
+		if (m_Duration > 0.0f)
+		{
+			Time = bLoop ? Time - m_Duration * std::floor(Time / m_Duration) : std::clamp(Time, 0.0f, m_Duration);
+		}
+		else
+		{
+			Time = 0.0f;
+		}
+
+		// Frames are evenly spaced, the time gives the two surrounding ones directly
+		const float FramePosition = Time * m_FrameRate;
+		const uint32_t First = std::min(static_cast<uint32_t>(FramePosition), m_FrameCount - 1);
+		const uint32_t Second = std::min(First + 1, m_FrameCount - 1);
+		const Float4 Blend = Splat(std::clamp(FramePosition - static_cast<float>(First), 0.0f, 1.0f));
+
+		const size_t FrameSize = size_t(SkeletonPose::ComponentCount) * m_Stride;
+		const uint16_t* FrameA = m_Frames.data() + First * FrameSize;
+		const uint16_t* FrameB = m_Frames.data() + Second * FrameSize;
+
+		for (uint32_t Node = 0; Node < m_Stride; Node += 4)
+		{
+			for (uint32_t Range = 0; Range < RangeComponentCount; Range++)
+			{
+				// Both frames share the range, the steps are interpolated before being scaled
+				const SkeletonPose::Component Component = GetRangeComponent(Range);
+				const size_t Offset = Component * m_Stride + Node;
+				const Float4 Steps = Lerp(LoadUnorm16(FrameA + Offset), LoadUnorm16(FrameB + Offset), Blend);
+				const Float4 Value = Add(Load(m_RangeMin.data() + Range * m_Stride + Node), Mul(Steps, Load(m_RangeScale.data() + Range * m_Stride + Node)));
+				Store(Pose.GetComponent(Component) + Node, Value);
+			}
+
+			Float4 Rotation[4];
+			Float4 LengthSquared = Splat(0.0f);
+			for (uint32_t Axis = 0; Axis < 4; Axis++)
+			{
+				const size_t Offset = (SkeletonPose::RotationX + Axis) * m_Stride + Node;
+				Rotation[Axis] = Lerp(LoadSnorm16(FrameA + Offset), LoadSnorm16(FrameB + Offset), Blend);
+				LengthSquared = Add(LengthSquared, Mul(Rotation[Axis], Rotation[Axis]));
+			}
+
+			// The 1 / 32767 scale cancels out in the normalization
+			const Float4 Normalize = InverseSqrt(LengthSquared);
+			for (uint32_t Axis = 0; Axis < 4; Axis++)
+			{
+				Store(Pose.GetComponent(static_cast<SkeletonPose::Component>(SkeletonPose::RotationX + Axis)) + Node, Mul(Rotation[Axis], Normalize));
+			}
+		}
+	}
+
+} // namespace fgl
@@ -0,0 +1,155 @@
+#include <FireGL/Renderer/AnimationSystem.h>
+#include <FireGL/Renderer/BonePaletteBuffer.h>
+#include <FireGL/Renderer/Skeleton.h>
+#include <FireGL/Core/JobSystem.h>
+#include <FireGL/Core/BaseLog.h>
+
+namespace fgl
+{
+
+	uint32_t AnimationSystem::AddInstance(const Skeleton& Target, uint32_t BoneOffset)
+	{
+		uint32_t Index;
+		if (!m_FreeList.empty())
+		{
+			Index = m_FreeList.back();
+			m_FreeList.pop_back();
+		}
+		else
+		{
+			Index = static_cast<uint32_t>(m_Instances.size());
+			m_Instances.emplace_back();
+		}
+
+		m_Instances[Index] = Instance();
+		m_Instances[Index].Target = &Target;
+		m_Instances[Index].BoneOffset = BoneOffset;
+		return Index;
+	}
+
+	void AnimationSystem::RemoveInstance(uint32_t Instance)
+	{
+		LOG_ASSERT(Instance < m_Instances.size() && m_Instances[Instance].Target, "Removed animation instance doesn't exist")
+		m_Instances[Instance].Target = nullptr;
+		m_Instances[Instance].Palette.clear();
+		m_FreeList.push_back(Instance);
+	}
+
+	void AnimationSystem::Play(uint32_t Instance, const AnimationClip& Clip, float StartTime, bool bLoop)
+	{
+		AnimationSystem::Instance& Animated = m_Instances[Instance];
+		LOG_ASSERT(Clip.GetNodeCount() == Animated.Target->GetNodes().size(), "Clip played on another skeleton")
+		Animated.Clip = &Clip;
+		Animated.Time = StartTime;
+		Animated.bLoop = bLoop;
+		Animated.FadeFrom = nullptr;
+	}
+
+	void AnimationSystem::CrossFade(uint32_t Instance, const AnimationClip& Clip, float Duration, bool bLoop)
+	{
+		AnimationSystem::Instance& Animated = m_Instances[Instance];
+		if (!Animated.Clip || Duration <= 0.0f)
+		{
+			Play(Instance, Clip, 0.0f, bLoop);
+			return;
+		}
+
+		LOG_ASSERT(Clip.GetNodeCount() == Animated.Target->GetNodes().size(), "Clip played on another skeleton")
+		Animated.FadeFrom = Animated.Clip;
+		Animated.FadeFromTime = Animated.Time;
+		Animated.bFadeFromLoop = Animated.bLoop;
+		Animated.FadeElapsed = 0.0f;
+		Animated.FadeDuration = Duration;
+		Animated.Clip = &Clip;
+		Animated.Time = 0.0f;
+		Animated.bLoop = bLoop;
+	}
+
+	void AnimationSystem::SetSpeed(uint32_t Instance, float Speed)
+	{
+		m_Instances[Instance].Speed = Speed;
+	}
+
+	void AnimationSystem::SetJobSystem(JobSystem* Jobs, size_t ChunkSize)
+	{
+		m_JobSystem = Jobs;
+		m_ChunkSize = ChunkSize;
+	}
+
+	void AnimationSystem::UpdateInstance(Instance& Animated, float DeltaTime)
+	{
+		// Scratch poses per thread, reused across instances and frames so sampling doesn't allocate
+		thread_local SkeletonPose Pose;
+		thread_local SkeletonPose FadePose;
+		thread_local std::vector<glm::mat4> Transforms;
+
+		if (!Animated.Clip)
+		{
+			Animated.Target->ComputePalette(Animated.Target->GetRestPose(), Transforms, Animated.Palette);
+			return;
+		}
+
+		const float Step = DeltaTime * Animated.Speed;
+		Animated.Time += Step;
+		Animated.Clip->Sample(Animated.Time, Pose, Animated.bLoop);
+
+		if (Animated.FadeFrom)
+		{
+			Animated.FadeFromTime += Step;
+			Animated.FadeElapsed += DeltaTime;
+			if (Animated.FadeElapsed >= Animated.FadeDuration)
+			{
+				Animated.FadeFrom = nullptr;
+			}
+			else
+			{
+				Animated.FadeFrom->Sample(Animated.FadeFromTime, FadePose, Animated.bFadeFromLoop);
+				SkeletonPose::Blend(FadePose, Pose, Animated.FadeElapsed / Animated.FadeDuration, Pose);
+			}
+		}
+
+		Animated.Target->ComputePalette(Pose, Transforms, Animated.Palette);
+	}
+
+	void AnimationSystem::Update(float DeltaTime, BonePaletteBuffer& Palettes)
+	{
+		if (!m_JobSystem || m_Instances.size() <= m_ChunkSize)
+		{
+			for (Instance& Animated : m_Instances)
+			{
+				if (Animated.Target)
+				{
+					UpdateInstance(Animated, DeltaTime);
+				}
+			}
+		}
+		else
+		{
+			m_JobSystem->ParallelFor(m_Instances.size(), m_ChunkSize, [this, DeltaTime](size_t Begin, size_t End)
+			{
+				for (size_t Index = Begin; Index < End; Index++)
+				{
+					if (m_Instances[Index].Target)
+					{
+						UpdateInstance(m_Instances[Index], DeltaTime);
+					}
+				}
+			});
+		}
+
+		// The buffer tracks a single dirty range, it is written from one thread
+		for (const Instance& Animated : m_Instances)
+		{
+			if (Animated.Target)
+			{
+				Palettes.Write(Animated.BoneOffset, Animated.Palette);
+			}
+		}
+	}
+
+	uint32_t AnimationSystem::GetInstanceCount() const
+	{
+		return static_cast<uint32_t>(m_Instances.size() - m_FreeList.size());
+	}
+
+} // namespace fgl
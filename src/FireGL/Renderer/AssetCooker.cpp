@@ -0,0 +1,293 @@
+#include <FireGL/Renderer/AssetCooker.h>
+#include <FireGL/Renderer/MeshCache.h>
+#include <FireGL/Renderer/Mesh.h>
+#include <FireGL/Renderer/TextureContainer.h>
+#include <FireGL/Core/AssetPathManager.h>
+#include <FireGL/Core/JobSystem.h>
+#include <FireGL/Core/BaseLog.h>
+#include <FireGL/Core/Profiler.h>
+
+namespace fgl
+{
+
+	namespace
+	{
+		/** @return The lowercase extension of a path, with its dot. */
+		std::string GetExtension(const std::filesystem::path& Path)
+		{
+			std::string Extension = Path.extension().string();
+			std::transform(Extension.begin(), Extension.end(), Extension.begin(), [](unsigned char C) { return static_cast<char>(std::tolower(C)); });
+			return Extension;
+		}
+
+		std::filesystem::path AppendExtension(const std::filesystem::path& Path, std::string_view Extension)
+		{
+			return std::filesystem::path(Path.string() + std::string(Extension));
+		}
+
+		constexpr std::string_view CookedImageExtension = ".ktx2";
+	}
+
+	bool AssetCooker::Cook(std::string_view ConfigPath, const AssetPathManager& Paths, const AssetCookSettings& Settings)
+	{
+		FGL_PROFILE_SCOPE("AssetCooker::Cook")
+		const auto Start = std::chrono::steady_clock::now();
+		const std::filesystem::path ConfigFile(ConfigPath);
+		const std::filesystem::path ConfigDirectory = ConfigFile.parent_path();
+		const std::filesystem::path OutputDirectory(Settings.OutputDirectory);
+
+		std::ifstream Config{ std::string(ConfigPath) };
+		if (!Config)
+		{
+			LOG_ERROR("Failed to open the config file to cook: " + std::string(ConfigPath) + ".", false)
+			return false;
+		}
+
+		// Lines are written back as read, only the values of cooked files change
+		std::vector<std::string> Lines;
+		std::vector<ImageJob> Images;
+		std::vector<size_t> ImageLines;
+		std::unordered_map<std::string, bool> CookedImages;
+		size_t ModelCount = 0;
+		size_t CopyCount = 0;
+		bool bSucceeded = true;
+		for (std::string Line; std::getline(Config, Line);)
+		{
+			Lines.push_back(Line);
+			const size_t Separator = Line.find('=');
+			if (Line.empty() || Line[0] == '[' || Separator == std::string::npos)
+				continue;
+
+			const std::string Key = Line.substr(0, Separator);
+			const std::string* Resolved = Paths.FindPath(AssetId(Key));
+			std::error_code Error;
+			if (!Resolved || !std::filesystem::is_regular_file(*Resolved, Error))
+				continue;
+
+			const std::filesystem::path Source(*Resolved);
+			const std::filesystem::path Relative = Source.lexically_relative(ConfigDirectory);
+			if (Relative.empty() || *Relative.begin() == "..")
+			{
+				LOG_ERROR("The asset of key '" + Key + "' is outside of the config file's directory, it isn't cooked: " + Source.string(), false)
+				bSucceeded = false;
+				continue;
+			}
+
+			const std::filesystem::path Output = OutputDirectory / Relative;
+			const bool bRaw = std::find(Settings.RawKeys.begin(), Settings.RawKeys.end(), Key) != Settings.RawKeys.end();
+			if (!bRaw && IsModel(Source))
+			{
+				if (CookModel(Source, Output, Settings, CookedImages))
+				{
+					Lines.back() += MeshCache::Extension;
+					ModelCount++;
+				}
+				else
+				{
+					bSucceeded = false;
+				}
+			}
+			else if (!bRaw && Settings.bCompressTextures && IsImage(Source))
+			{
+				Images.push_back({ Source, AppendExtension(Output, CookedImageExtension) });
+				ImageLines.push_back(Lines.size() - 1);
+			}
+			else
+			{
+				bSucceeded &= CopyAsset(Source, Output);
+				CopyCount++;
+			}
+		}
+
+		// Images of the config file are encoded together, those the models referenced already are skipped
+		std::vector<ImageJob> Pending;
+		for (const ImageJob& Image : Images)
+		{
+			if (!CookedImages.contains(Image.Output.string()))
+			{
+				CookedImages.emplace(Image.Output.string(), false);
+				Pending.push_back(Image);
+			}
+		}
+		CookImages(Pending, Settings.Jobs);
+		for (const ImageJob& Image : Pending)
+		{
+			CookedImages[Image.Output.string()] = Image.bCooked;
+		}
+
+		for (size_t Index = 0; Index < Images.size(); Index++)
+		{
+			if (CookedImages[Images[Index].Output.string()])
+			{
+				Lines[ImageLines[Index]] += CookedImageExtension;
+			}
+			else
+			{
+				// An image that can't be encoded is shipped as is, its key keeps resolving to it
+				LOG_ERROR("Failed to encode " + Images[Index].Source.string() + ", it is copied instead.", false)
+				bSucceeded &= CopyAsset(Images[Index].Source, Images[Index].Output.parent_path() / Images[Index].Source.filename());
+			}
+		}
+
+		std::error_code Error;
+		std::filesystem::create_directories(OutputDirectory, Error);
+		std::ofstream CookedConfig(OutputDirectory / ConfigFile.filename(), std::ios::trunc);
+		for (const std::string& Line : Lines)
+		{
+			CookedConfig << Line << '\n';
+		}
+		if (!CookedConfig)
+		{
+			LOG_ERROR("Failed to write the cooked config file to " + OutputDirectory.string() + ".", false)
+			return false;
+		}
+		CookedConfig.close();
+
+		if (!Settings.ArchivePath.empty() && !AssetArchive::Build(OutputDirectory.string(), Settings.ArchivePath, Settings.ArchiveCompression))
+		{
+			bSucceeded = false;
+		}
+
+		const size_t ImageCount = std::count_if(CookedImages.begin(), CookedImages.end(), [](const auto& Image) { return Image.second; });
+		const float Seconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - Start).count();
+		LOG_INFO("Cooked " + std::to_string(ModelCount) + " models and " + std::to_string(ImageCount) + " images, copied "
+			+ std::to_string(CopyCount) + " files in " + std::to_string(Seconds) + " s.")
+		return bSucceeded;
+	}
+
+	bool AssetCooker::IsModel(const std::filesystem::path& Path)
+	{
+		static const std::array<std::string_view, 10> Extensions = { ".obj", ".fbx", ".gltf", ".glb", ".dae", ".3ds", ".blend", ".ply", ".stl", ".x" };
+		return std::find(Extensions.begin(), Extensions.end(), GetExtension(Path)) != Extensions.end();
+	}
+
+	bool AssetCooker::IsImage(const std::filesystem::path& Path)
+	{
+		// HDR images would lose their range in 8-bit blocks, they are copied
+		static const std::array<std::string_view, 6> Extensions = { ".png", ".jpg", ".jpeg", ".tga", ".bmp", ".psd" };
+		return std::find(Extensions.begin(), Extensions.end(), GetExtension(Path)) != Extensions.end();
+	}
+
+	bool AssetCooker::CookModel(const std::filesystem::path& Source, const std::filesystem::path& Output, const AssetCookSettings& Settings,
+		std::unordered_map<std::string, bool>& CookedImages)
+	{
+		FGL_PROFILE_SCOPE("AssetCooker::CookModel")
+		if (Settings.Import.Format == VertexFormat::Skinned || Settings.Import.Format == VertexFormat::Lightmapped)
+		{
+			LOG_ERROR("Skinned and lightmapped models can't be cooked, mesh caches hold no skin nor second UV set: " + Source.string(), false)
+			return false;
+		}
+
+		// Only the geometry is imported, the textures are decoded but never uploaded
+		ModelImportSettings Import = Settings.Import;
+		Import.bUseMeshCache = false;
+		Import.bDeferTextureUploads = true;
+		Import.bShareResources = false;
+		Import.Jobs = Import.Jobs ? Import.Jobs : Settings.Jobs;
+		Model Imported(Source.generic_string(), Import);
+		std::span<BaseMesh> Meshes = Imported.GetMeshes();
+		if (Meshes.empty())
+		{
+			LOG_ERROR("The model " + Source.string() + " has no mesh to cook.", false)
+			return false;
+		}
+
+		// Textures are referenced relative to the model, the cooked ones sit at the same place
+		std::vector<ImageJob> Pending;
+		for (BaseMesh& Mesh : Meshes)
+		{
+			for (const Texture& MeshTexture : Mesh.GetTextures())
+			{
+				if (MeshTexture.GetPath().empty())
+					continue;
+
+				const std::filesystem::path Image = Source.parent_path() / MeshTexture.GetPath();
+				const std::filesystem::path CookedImage = AppendExtension(Output.parent_path() / MeshTexture.GetPath(), CookedImageExtension);
+				if (!CookedImages.contains(CookedImage.string()))
+				{
+					CookedImages.emplace(CookedImage.string(), false);
+					if (Settings.bCompressTextures && IsImage(Image))
+					{
+						Pending.push_back({ Image, CookedImage });
+					}
+					else
+					{
+						CopyAsset(Image, Output.parent_path() / MeshTexture.GetPath());
+					}
+				}
+			}
+		}
+		CookImages(Pending, Settings.Jobs);
+		for (const ImageJob& Image : Pending)
+		{
+			CookedImages[Image.Output.string()] = Image.bCooked;
+			if (!Image.bCooked)
+			{
+				LOG_ERROR("Failed to encode " + Image.Source.string() + ", it is copied instead.", false)
+				CopyAsset(Image.Source, Image.Output.parent_path() / Image.Source.filename());
+			}
+		}
+
+		for (BaseMesh& Mesh : Meshes)
+		{
+			for (Texture& MeshTexture : Mesh.GetTextures())
+			{
+				if (MeshTexture.GetPath().empty())
+					continue;
+
+				const std::string CookedPath = MeshTexture.GetPath() + std::string(CookedImageExtension);
+				if (CookedImages[(Output.parent_path() / CookedPath).string()])
+				{
+					MeshTexture.SetPath(CookedPath);
+				}
+			}
+		}
+
+		const std::string CachePath = AppendExtension(Output, MeshCache::Extension).string();
+		if (!MeshCache::Save(CachePath, Source.string(), Import.GetGeometryKey(), Meshes, true))
+		{
+			LOG_ERROR("Failed to write the cooked model " + CachePath + ".", false)
+			return false;
+		}
+		return true;
+	}
+
+	void AssetCooker::CookImages(std::vector<ImageJob>& Jobs, JobSystem* JobSystem)
+	{
+		// Images are flipped for OpenGL like Texture::LoadTexture() and the models' textures, blocks can't be flipped at load
+		const auto Encode = [&Jobs](size_t Begin, size_t End)
+		{
+			for (size_t Index = Begin; Index < End; Index++)
+			{
+				ImageJob& Job = Jobs[Index];
+				ImageData Decoded;
+				ImageData Compressed;
+				Job.bCooked = Texture::DecodeImage(Job.Source.string(), true, Decoded) && TextureContainer::Encode(Decoded, Compressed)
+					&& TextureContainer::SaveKTX2(Job.Output.string(), Compressed);
+			}
+		};
+
+		if (JobSystem && Jobs.size() > 1)
+		{
+			JobSystem->ParallelFor(Jobs.size(), 1, Encode);
+		}
+		else
+		{
+			Encode(0, Jobs.size());
+		}
+	}
+
+	bool AssetCooker::CopyAsset(const std::filesystem::path& Source, const std::filesystem::path& Output)
+	{
+		std::error_code Error;
+		std::filesystem::create_directories(Output.parent_path(), Error);
+		std::filesystem::copy_file(Source, Output, std::filesystem::copy_options::overwrite_existing, Error);
+		if (Error)
+		{
+			LOG_ERROR("Failed to copy " + Source.string() + " to " + Output.string() + ": " + Error.message(), false)
+			return false;
+		}
+		return true;
+	}
+
+} // namespace fgl
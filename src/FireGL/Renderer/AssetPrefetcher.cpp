@@ -0,0 +1,161 @@
+#include <FireGL/Renderer/AssetPrefetcher.h>
+#include <FireGL/Core/AssetArchive.h>
+#include <FireGL/Core/AssetManifest.h>
+#include <FireGL/Core/AssetPathManager.h>
+#include <FireGL/Core/BaseLog.h>
+#include <FireGL/Core/Profiler.h>
+#include <FireGL/Core/SystemManager.h>
+#include <FireGL/Renderer/TextureCache.h>
+#include <FireGL/Renderer/TextureContainer.h>
+
+#include <filesystem>
+
+namespace fgl
+{
+
+	namespace
+	{
+		constexpr size_t ReadChunk = 1024 * 1024; ///< Bytes read at once when reading a file through.
+		constexpr size_t PageSize = 4096;         ///< Stride touching the pages of an archived file.
+
+		/** @return True if the file is an image Texture::DecodeImage() reads. */
+		bool IsImage(const std::string& FilePath)
+		{
+			if (TextureContainer::IsContainer(FilePath))
+				return true;
+
+			std::string Extension = std::filesystem::path(FilePath).extension().string();
+			std::transform(Extension.begin(), Extension.end(), Extension.begin(), [](unsigned char Character) { return static_cast<char>(std::tolower(Character)); });
+			return Extension == ".png" || Extension == ".jpg" || Extension == ".jpeg" || Extension == ".tga" || Extension == ".bmp"
+				|| Extension == ".psd" || Extension == ".gif" || Extension == ".hdr" || Extension == ".pic" || Extension == ".pnm";
+		}
+	}
+
+	std::unordered_map<size_t, ImageData> AssetPrefetcher::s_Images;
+	std::mutex AssetPrefetcher::s_Mutex;
+
+	AssetPrefetcher::AssetPrefetcher(JobSystem& Jobs)
+		: m_Jobs(Jobs)
+	{
+	}
+
+	AssetPrefetcher::~AssetPrefetcher()
+	{
+		Wait();
+
+		std::lock_guard<std::mutex> Lock(s_Mutex);
+		for (size_t Key : m_ImageKeys)
+		{
+			s_Images.erase(Key);
+		}
+	}
+
+	size_t AssetPrefetcher::Prefetch(std::string_view Asset)
+	{
+		FGL_PROFILE_SCOPE("AssetPrefetcher::Prefetch")
+
+		std::vector<std::string> Assets;
+		AssetManifest::GetDependencies(Asset, Assets);
+		Assets.emplace_back(Asset);
+
+		AssetPathManager* Paths = nullptr;
+		size_t Scheduled = 0;
+		for (const std::string& Name : Assets)
+		{
+			// Keys resolve through the AssetPathManager, levels are keys without a file of their own
+			std::string FilePath = Name;
+			if (Name.find_first_of("/\\.") == std::string::npos)
+			{
+				Paths = Paths ? Paths : SystemManager<AssetPathManager>::Get();
+				const std::string* Resolved = Paths ? Paths->FindPath(AssetId(Name)) : nullptr;
+				if (!Resolved)
+					continue;
+
+				FilePath = *Resolved;
+			}
+			if (!m_Prefetched.insert(FilePath).second)
+				continue;
+
+			if (IsImage(FilePath))
+			{
+				m_ImageKeys.push_back(TextureCache::GetKey(FilePath));
+				m_Jobs.Schedule([FilePath]() { PrefetchImage(FilePath); }, m_Counter);
+			}
+			else
+			{
+				m_Jobs.Schedule([FilePath]() { PrefetchFile(FilePath); }, m_Counter);
+			}
+			Scheduled++;
+		}
+		return Scheduled;
+	}
+
+	bool AssetPrefetcher::IsDone() const
+	{
+		return m_Counter.IsDone();
+	}
+
+	void AssetPrefetcher::Wait()
+	{
+		m_Jobs.Wait(m_Counter);
+	}
+
+	bool AssetPrefetcher::TakeImage(size_t Key, ImageData& Image)
+	{
+		std::lock_guard<std::mutex> Lock(s_Mutex);
+		auto It = s_Images.find(Key);
+		if (It == s_Images.end())
+			return false;
+
+		Image = std::move(It->second);
+		s_Images.erase(It);
+		return true;
+	}
+
+	void AssetPrefetcher::PrefetchImage(const std::string& FilePath)
+	{
+		FGL_PROFILE_SCOPE("AssetPrefetcher::PrefetchImage")
+
+		// Flipped like the textures Model decodes, the only ones taken from here
+		ImageData Image;
+		if (!Texture::DecodeImage(FilePath, true, Image))
+		{
+			LOG_ERROR("Failed to prefetch the image " + FilePath + ".", false);
+			return;
+		}
+
+		const size_t Key = TextureCache::GetKey(FilePath);
+		std::lock_guard<std::mutex> Lock(s_Mutex);
+		s_Images.emplace(Key, std::move(Image));
+	}
+
+	void AssetPrefetcher::PrefetchFile(const std::string& FilePath)
+	{
+		FGL_PROFILE_SCOPE("AssetPrefetcher::PrefetchFile")
+
+		AssetArchive::Blob Contents;
+		if (AssetArchive::Read(FilePath, Contents))
+		{
+			// Touching a byte per page faults the stored contents in, compressed ones were read by decompressing
+			volatile uint8_t Sink = 0;
+			for (size_t Offset = 0; Offset < Contents.Data.size(); Offset += PageSize)
+			{
+				Sink = Sink + Contents.Data[Offset];
+			}
+			return;
+		}
+
+		std::ifstream File(FilePath, std::ios::binary);
+		if (!File)
+		{
+			LOG_ERROR("Failed to prefetch the file " + FilePath + ".", false);
+			return;
+		}
+
+		std::vector<char> Buffer(ReadChunk);
+		while (File.read(Buffer.data(), static_cast<std::streamsize>(Buffer.size())) || File.gcount() > 0)
+		{
+		}
+	}
+
+} // namespace fgl
@@ -0,0 +1,95 @@
+#include <FireGL/Renderer/AsyncAssets.h>
+#include <FireGL/Renderer/SceneFile.h>
+#include <FireGL/Core/BaseLog.h>
+
+namespace fgl
+{
+
+	namespace AsyncAssets
+	{
+		// The parameters are taken by value: the coroutine frame keeps them alive across its threads
+
+		AsyncTask<std::shared_ptr<Model>> LoadModel(AsyncScheduler& Scheduler, std::string Path, ModelImportSettings Settings)
+		{
+			co_await Scheduler.ResumeOnWorker();
+			Settings.bDeferTextureUploads = true;
+			std::shared_ptr<Model> Loaded;
+			try
+			{
+				Loaded = std::make_shared<Model>(Path, Settings);
+			}
+			catch (const std::exception& Exception)
+			{
+				LOG_ERROR("Failed to load model " + Path + ": " + Exception.what(), false)
+			}
+			if (!Loaded)
+				co_return nullptr;
+
+			// One texture per resume, the budget of ProcessMainThread() decides how many fit in a frame
+			co_await Scheduler.ResumeOnMainThread();
+			while (Loaded->HasPendingTextureUploads())
+			{
+				Loaded->UploadPendingTexture();
+				if (Loaded->HasPendingTextureUploads())
+				{
+					co_await Scheduler.ResumeOnMainThread();
+				}
+			}
+			co_return Loaded;
+		}
+
+		AsyncTask<std::shared_ptr<Texture>> LoadTexture(AsyncScheduler& Scheduler, std::string Path, bool bFlipVertical)
+		{
+			co_await Scheduler.ResumeOnWorker();
+			ImageData Image;
+			if (!Texture::DecodeImage(Path, bFlipVertical, Image))
+			{
+				LOG_ERROR("Failed to decode texture " + Path, false)
+				co_return nullptr;
+			}
+
+			co_await Scheduler.ResumeOnMainThread();
+			std::shared_ptr<Texture> Loaded = std::make_shared<Texture>();
+			if (!Loaded->UploadImage(Image))
+				co_return nullptr;
+
+			co_return Loaded;
+		}
+
+		AsyncTask<std::shared_ptr<Shader>> LoadShader(AsyncScheduler& Scheduler, std::string VertexPath, std::string FragmentPath)
+		{
+			co_await Scheduler.ResumeOnWorker();
+			std::string VertexCode;
+			std::string FragmentCode;
+			try
+			{
+				VertexCode = Shader::LoadShaderCode(VertexPath);
+				FragmentCode = Shader::LoadShaderCode(FragmentPath);
+			}
+			catch (const std::exception& Exception)
+			{
+				LOG_ERROR("Failed to read shader " + VertexPath + " / " + FragmentPath + ": " + Exception.what(), false)
+				co_return nullptr;
+			}
+
+			co_await Scheduler.ResumeOnMainThread();
+			co_return std::shared_ptr<Shader>(Shader::CreateFromSource(VertexCode, FragmentCode));
+		}
+
+		AsyncTask<bool> OpenSceneFile(AsyncScheduler& Scheduler, SceneFile& File, std::string Path)
+		{
+			co_await Scheduler.ResumeOnWorker();
+			bool bOpened = File.Open(Path);
+			if (bOpened)
+			{
+				// Touching every record faults the mapped pages in on the worker rather than in Instantiate()
+				std::vector<AssetId> Assets;
+				File.GetAssets(Assets);
+			}
+
+			co_await Scheduler.ResumeOnMainThread();
+			co_return bOpened;
+		}
+	}
+
+} // namespace fgl
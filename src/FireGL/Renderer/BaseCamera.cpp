@@ -25,9 +25,27 @@ namespace fgl {
 		m_Projection = glm::perspective(glm::radians(FOVAngle), WindowRatio, Near, Far);
 	}
 
-	void BaseCamera::SetOrthographic(float Left, float Right, float Top, float Bottom)
+	void BaseCamera::SetOrthographic(float Left, float Right, float Top, float Bottom, float Near, float Far)
 	{
-		m_Projection = glm::ortho(Left, Right, Top, Bottom);
+		m_Projection = glm::ortho(Left, Right, Top, Bottom, Near, Far);
+	}
+
+	void BaseCamera::LookAt(const glm::vec3& Target)
+	{
+		// Inverse of UpdateCameraVectors(): yaw around the up axis from +X towards +Z, then pitch
+		const glm::vec3 Direction = glm::normalize(Target - m_CameraTransform.GetPosition());
+		const glm::vec3& Rotation = m_CameraTransform.GetRotation();
+		m_CameraTransform.SetRotation(glm::degrees(std::atan2(Direction.z, Direction.x)), glm::degrees(std::asin(glm::clamp(Direction.y, -1.0f, 1.0f))), Rotation.z);
+		UpdateCameraVectors();
+	}
+
+	void BaseCamera::SetView(const glm::vec3& Position, const glm::vec3& Front, const glm::vec3& Up)
+	{
+		m_Front = glm::normalize(Front);
+		m_Right = glm::normalize(glm::cross(m_Front, Up));
+		m_Up = glm::cross(m_Right, m_Front);
+		m_ViewPosition = Position;
+		m_View = glm::lookAt(m_ViewPosition, m_ViewPosition + m_Front, m_Up);
 	}
 
 	void BaseCamera::UpdateRotationInput(double XPos, double YPos)
@@ -60,7 +78,8 @@ namespace fgl {
 
 	void BaseCamera::UpdateViewMatrix()
 	{
-		m_View = glm::lookAt(m_CameraTransform.GetPosition(), m_CameraTransform.GetPosition() + m_Front, m_Up);
+		m_ViewPosition = m_CameraTransform.GetPosition();
+		m_View = glm::lookAt(m_ViewPosition, m_ViewPosition + m_Front, m_Up);
 	}
 
 	glm::mat4 BaseCamera::GetViewMatrix() const
@@ -69,10 +88,43 @@ namespace fgl {
 	}
 
 	glm::mat4 BaseCamera::GetProjectionMatrix() const
+	{
+		if (m_Jitter == glm::vec2(0.f))
+			return m_Projection;
+
+		// Translating clip space by the offset times w shifts the projected points by the offset, perspective or not
+		glm::mat4 Jittered = m_Projection;
+		Jittered[0][0] += m_Jitter.x * m_Projection[0][3];
+		Jittered[1][0] += m_Jitter.x * m_Projection[1][3];
+		Jittered[2][0] += m_Jitter.x * m_Projection[2][3];
+		Jittered[3][0] += m_Jitter.x * m_Projection[3][3];
+		Jittered[0][1] += m_Jitter.y * m_Projection[0][3];
+		Jittered[1][1] += m_Jitter.y * m_Projection[1][3];
+		Jittered[2][1] += m_Jitter.y * m_Projection[2][3];
+		Jittered[3][1] += m_Jitter.y * m_Projection[3][3];
+		return Jittered;
+	}
+
+	glm::mat4 BaseCamera::GetUnjitteredProjectionMatrix() const
 	{
 		return m_Projection;
 	}
 
+	void BaseCamera::SetJitter(const glm::vec2& Offset)
+	{
+		m_Jitter = Offset;
+	}
+
+	glm::vec2 BaseCamera::GetJitter() const
+	{
+		return m_Jitter;
+	}
+
+	Frustum BaseCamera::GetFrustum() const
+	{
+		return Frustum(m_Projection * m_View);
+	}
+
 	glm::vec3 BaseCamera::GetFrontVector() const
 	{
 		return m_Front;
@@ -88,19 +140,41 @@ namespace fgl {
 		return m_Up;
 	}
 
+	glm::vec3 BaseCamera::GetViewPosition() const
+	{
+		return m_ViewPosition;
+	}
+
+	void BaseCamera::CopyView(const BaseCamera& Other)
+	{
+		m_Front = Other.m_Front;
+		m_Up = Other.m_Up;
+		m_Right = Other.m_Right;
+		m_View = Other.m_View;
+		m_Projection = Other.m_Projection;
+		m_Jitter = Other.m_Jitter;
+		m_ViewPosition = Other.m_ViewPosition;
+		m_CullingMask = Other.m_CullingMask;
+	}
+
+	void BaseCamera::SetCullingMask(LayerMask Mask)
+	{
+		m_CullingMask = Mask;
+	}
+
+	LayerMask BaseCamera::GetCullingMask() const
+	{
+		return m_CullingMask;
+	}
+
 	Transform& BaseCamera::GetCameraTransform() {
 		return m_CameraTransform;
 	}
 
 	void BaseCamera::ComputeModelViewProjection(glm::mat4& OutModelViewProjection, glm::mat4& OutModelMatrix) const
 	{
-		glm::mat4 ModelMatrix =
-			glm::translate(glm::mat4(1.0f), m_CameraTransform.GetPosition()) *
-			glm::rotate(glm::mat4(1.0f), glm::radians(m_CameraTransform.GetRotation().x), glm::vec3(1, 0, 0)) *
-			glm::rotate(glm::mat4(1.0f), glm::radians(m_CameraTransform.GetRotation().y), glm::vec3(0, 1, 0)) *
-			glm::rotate(glm::mat4(1.0f), glm::radians(m_CameraTransform.GetRotation().z), glm::vec3(0, 0, 1)) *
-			glm::scale(glm::mat4(1.0f), m_CameraTransform.GetScale());
-		
+		glm::mat4 ModelMatrix = m_CameraTransform.ComputeLocalMatrix();
+
 		OutModelViewProjection = GetProjectionMatrix() * GetViewMatrix() * ModelMatrix;
 		OutModelMatrix = ModelMatrix;
 	}
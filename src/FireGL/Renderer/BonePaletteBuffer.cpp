@@ -0,0 +1,135 @@
+#include <FireGL/Renderer/BonePaletteBuffer.h>
+#include <FireGL/Renderer/GLStateCache.h>
+#include <FireGL/Renderer/GPUMemoryTracker.h>
+#include <FireGL/Renderer/RenderStats.h>
+#include <FireGL/Core/BaseLog.h>
+
+namespace fgl
+{
+
+	namespace
+	{
+		constexpr size_t RowsPerBone = 3;
+	}
+
+	BonePaletteBuffer::~BonePaletteBuffer()
+	{
+		Destroy();
+	}
+
+	uint32_t BonePaletteBuffer::Allocate(uint32_t BoneCount)
+	{
+		uint32_t Offset;
+		auto Reused = std::find_if(m_FreeRanges.begin(), m_FreeRanges.end(),
+			[BoneCount](const std::pair<uint32_t, uint32_t>& Range) { return Range.second == BoneCount; });
+		if (Reused != m_FreeRanges.end())
+		{
+			Offset = Reused->first;
+			m_FreeRanges.erase(Reused);
+		}
+		else
+		{
+			Offset = GetBoneCount();
+			m_Rows.resize(m_Rows.size() + BoneCount * RowsPerBone);
+		}
+
+		// Rows of the identity, the bind pose until the first Write()
+		const size_t First = Offset * RowsPerBone;
+		for (size_t Bone = 0; Bone < BoneCount; Bone++)
+		{
+			m_Rows[First + Bone * RowsPerBone + 0] = glm::vec4(1.0f, 0.0f, 0.0f, 0.0f);
+			m_Rows[First + Bone * RowsPerBone + 1] = glm::vec4(0.0f, 1.0f, 0.0f, 0.0f);
+			m_Rows[First + Bone * RowsPerBone + 2] = glm::vec4(0.0f, 0.0f, 1.0f, 0.0f);
+		}
+		m_DirtyBegin = std::min(m_DirtyBegin, First);
+		m_DirtyEnd = std::max(m_DirtyEnd, First + BoneCount * RowsPerBone);
+		return Offset;
+	}
+
+	void BonePaletteBuffer::Release(uint32_t Offset, uint32_t BoneCount)
+	{
+		m_FreeRanges.emplace_back(Offset, BoneCount);
+	}
+
+	void BonePaletteBuffer::Write(uint32_t Offset, const std::vector<glm::mat4>& Palette)
+	{
+		const size_t First = Offset * RowsPerBone;
+		LOG_ASSERT(First + Palette.size() * RowsPerBone <= m_Rows.size(), "Bone palette written past its allocation")
+
+		// glm is column-major, the rows of the affine part are gathered across the columns
+		for (size_t Bone = 0; Bone < Palette.size(); Bone++)
+		{
+			const glm::mat4& Matrix = Palette[Bone];
+			for (size_t Row = 0; Row < RowsPerBone; Row++)
+			{
+				m_Rows[First + Bone * RowsPerBone + Row] = glm::vec4(Matrix[0][Row], Matrix[1][Row], Matrix[2][Row], Matrix[3][Row]);
+			}
+		}
+		m_DirtyBegin = std::min(m_DirtyBegin, First);
+		m_DirtyEnd = std::max(m_DirtyEnd, First + Palette.size() * RowsPerBone);
+	}
+
+	void BonePaletteBuffer::Upload()
+	{
+		if (m_Rows.empty())
+			return;
+
+		if (m_Rows.size() > m_CapacityRows)
+		{
+			// Grown buffers are filled entirely, the texture is pointed at the new storage
+			m_CapacityRows = std::max(m_Rows.size(), std::max(m_CapacityRows * 2, size_t(InitialBones) * RowsPerBone));
+			if (m_Buffer == 0)
+			{
+				glGenBuffers(1, &m_Buffer);
+				glGenTextures(1, &m_Texture);
+			}
+			glBindBuffer(GL_TEXTURE_BUFFER, m_Buffer);
+			glBufferData(GL_TEXTURE_BUFFER, m_CapacityRows * sizeof(glm::vec4), nullptr, GL_DYNAMIC_DRAW);
+			GPUMemoryTracker::TrackBuffer(m_Buffer, m_CapacityRows * sizeof(glm::vec4), GPUMemoryCategory::Storage, "BonePaletteBuffer");
+			GLStateCache::BindTexture(GL_TEXTURE_BUFFER, m_Texture);
+			glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, m_Buffer);
+			m_DirtyBegin = 0;
+			m_DirtyEnd = m_Rows.size();
+		}
+		else if (m_DirtyBegin < m_DirtyEnd)
+		{
+			glBindBuffer(GL_TEXTURE_BUFFER, m_Buffer);
+			if (m_DirtyBegin == 0 && m_DirtyEnd == m_Rows.size())
+			{
+				// Every palette moved: orphan the storage rather than wait for the draws still reading it
+				glBufferData(GL_TEXTURE_BUFFER, m_CapacityRows * sizeof(glm::vec4), nullptr, GL_DYNAMIC_DRAW);
+			}
+		}
+
+		if (m_DirtyBegin < m_DirtyEnd)
+		{
+			const size_t Bytes = (m_DirtyEnd - m_DirtyBegin) * sizeof(glm::vec4);
+			glBufferSubData(GL_TEXTURE_BUFFER, m_DirtyBegin * sizeof(glm::vec4), Bytes, m_Rows.data() + m_DirtyBegin);
+			RenderCounters::CountUpload(Bytes);
+			m_DirtyBegin = SIZE_MAX;
+			m_DirtyEnd = 0;
+		}
+		GLStateCache::BindTextureUnit(TextureUnit, GL_TEXTURE_BUFFER, m_Texture);
+	}
+
+	void BonePaletteBuffer::Destroy()
+	{
+		if (m_Buffer == 0)
+			return;
+
+		glDeleteTextures(1, &m_Texture);
+		GLStateCache::OnTextureDeleted(m_Texture);
+		glDeleteBuffers(1, &m_Buffer);
+		GLStateCache::OnBufferDeleted(m_Buffer);
+		GPUMemoryTracker::UntrackBuffer(m_Buffer);
+		m_Texture = 0;
+		m_Buffer = 0;
+		m_CapacityRows = 0;
+	}
+
+	uint32_t BonePaletteBuffer::GetBoneCount() const
+	{
+		return static_cast<uint32_t>(m_Rows.size() / RowsPerBone);
+	}
+
+} // namespace fgl
@@ -0,0 +1,119 @@
+#include <FireGL/Renderer/BoundingVolume.h>
+
+#include <External/glm/common.hpp>
+#include <External/glm/geometric.hpp>
+
+namespace fgl
+{
+
+	bool BoundingBox::IsEmpty() const
+	{
+		return Min.x > Max.x;
+	}
+
+	glm::vec3 BoundingBox::GetCenter() const
+	{
+		return IsEmpty() ? glm::vec3(0.0f) : (Min + Max) * 0.5f;
+	}
+
+	void BoundingBox::Merge(const glm::vec3& Point)
+	{
+		Min = glm::min(Min, Point);
+		Max = glm::max(Max, Point);
+	}
+
+	void BoundingBox::Merge(const BoundingBox& Other)
+	{
+		if (Other.IsEmpty())
+			return;
+
+		Min = glm::min(Min, Other.Min);
+		Max = glm::max(Max, Other.Max);
+	}
+
+	bool BoundingBox::Overlaps(const BoundingBox& Other) const
+	{
+		return Min.x <= Other.Max.x && Max.x >= Other.Min.x
+			&& Min.y <= Other.Max.y && Max.y >= Other.Min.y
+			&& Min.z <= Other.Max.z && Max.z >= Other.Min.z;
+	}
+
+	BoundingBox BoundingBox::Transformed(const glm::mat4& ModelMatrix) const
+	{
+		if (IsEmpty())
+			return *this;
+
+		// Arvo's method: the extent along each world axis sums the absolute contributions of the local axes
+		const glm::vec3 Center = glm::vec3(ModelMatrix * glm::vec4(GetCenter(), 1.0f));
+		const glm::vec3 Extent = (Max - Min) * 0.5f;
+		const glm::vec3 WorldExtent = glm::abs(glm::vec3(ModelMatrix[0])) * Extent.x
+			+ glm::abs(glm::vec3(ModelMatrix[1])) * Extent.y
+			+ glm::abs(glm::vec3(ModelMatrix[2])) * Extent.z;
+
+		BoundingBox Result;
+		Result.Min = Center - WorldExtent;
+		Result.Max = Center + WorldExtent;
+		return Result;
+	}
+
+	BoundingSphere BoundingSphere::Transformed(const glm::mat4& ModelMatrix) const
+	{
+		float MaxScale = std::max({
+			glm::length(glm::vec3(ModelMatrix[0])),
+			glm::length(glm::vec3(ModelMatrix[1])),
+			glm::length(glm::vec3(ModelMatrix[2]))
+		});
+
+		BoundingSphere Result;
+		Result.Center = glm::vec3(ModelMatrix * glm::vec4(Center, 1.0f));
+		Result.Radius = Radius * MaxScale;
+		return Result;
+	}
+
+	size_t BoundingSphereArrays::Size() const
+	{
+		return Radius.size();
+	}
+
+	void BoundingSphereArrays::Resize(size_t Count)
+	{
+		X.resize(Count);
+		Y.resize(Count);
+		Z.resize(Count);
+		Radius.resize(Count);
+	}
+
+	void BoundingSphereArrays::Set(size_t Index, const BoundingSphere& Sphere)
+	{
+		X[Index] = Sphere.Center.x;
+		Y[Index] = Sphere.Center.y;
+		Z[Index] = Sphere.Center.z;
+		Radius[Index] = Sphere.Radius;
+	}
+
+	BoundingBox ComputeBoundingBox(const std::vector<Vertex>& Vertices)
+	{
+		BoundingBox Box;
+		for (const Vertex& Vertex : Vertices)
+		{
+			Box.Merge(Vertex.Position);
+		}
+		return Box;
+	}
+
+	BoundingSphere ComputeBoundingSphere(const std::vector<Vertex>& Vertices, const BoundingBox& Box)
+	{
+		BoundingSphere Sphere;
+		Sphere.Center = Box.GetCenter();
+
+		float MaxDistanceSquared = 0.0f;
+		for (const Vertex& Vertex : Vertices)
+		{
+			glm::vec3 Offset = Vertex.Position - Sphere.Center;
+			MaxDistanceSquared = std::max(MaxDistanceSquared, glm::dot(Offset, Offset));
+		}
+		Sphere.Radius = std::sqrt(MaxDistanceSquared);
+		return Sphere;
+	}
+
+} // namespace fgl
\ No newline at end of file
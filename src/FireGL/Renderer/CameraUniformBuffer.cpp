@@ -0,0 +1,38 @@
+#include <FireGL/Renderer/CameraUniformBuffer.h>
+#include <FireGL/Renderer/BaseCamera.h>
+#include <FireGL/Renderer/RenderStats.h>
+
+namespace fgl
+{
+
+	void CameraUniformBuffer::Create()
+	{
+		RenderDevice& Device = RenderDevice::Get();
+		m_Buffer = Device.CreateBuffer({ sizeof(CameraData), BufferUsage::Dynamic, GPUMemoryCategory::Uniforms, "CameraUniformBuffer" });
+		Device.BindUniformBuffer(BindingPoint, m_Buffer);
+	}
+
+	void CameraUniformBuffer::Destroy()
+	{
+		RenderDevice::Get().DestroyBuffer(m_Buffer);
+	}
+
+	void CameraUniformBuffer::Update(BaseCamera& Camera, float Time)
+	{
+		m_Data.View = Camera.GetViewMatrix();
+		m_Data.Projection = Camera.GetProjectionMatrix();
+		m_Data.ViewProjection = m_Data.Projection * m_Data.View;
+		m_Data.Position = glm::vec4(Camera.GetViewPosition(), 1.0f);
+		m_Data.InverseViewProjection = glm::inverse(m_Data.ViewProjection);
+		m_Data.Time = glm::vec4(Time, 0.0f, 0.0f, 0.0f);
+
+		RenderDevice::Get().UpdateBuffer(m_Buffer, 0, sizeof(CameraData), &m_Data);
+		RenderCounters::CountUpload(sizeof(CameraData));
+	}
+
+	const CameraData& CameraUniformBuffer::GetData() const
+	{
+		return m_Data;
+	}
+
+} // namespace fgl
\ No newline at end of file
@@ -0,0 +1,382 @@
+#include <FireGL/Renderer/CascadedShadowMaps.h>
+#include <FireGL/Renderer/GLStateCache.h>
+#include <FireGL/Renderer/GPUMemoryTracker.h>
+#include <FireGL/Renderer/RenderStats.h>
+#include <FireGL/Core/BaseLog.h>
+
+#include <External/glm/gtc/matrix_transform.hpp>
+
+namespace fgl
+{
+
+	namespace
+	{
+		constexpr std::string_view CasterVertexCode = R"(#version 410 core
+layout (location = 0) in vec3 aPos;
+layout (location = 3) in mat4 ModelMatrix;
+layout (location = 7) in mat3x4 NormalMatrix;
+layout (location = 11) in uint CascadeMask;
+
+layout (std140) uniform CameraData
+{
+    mat4 View;
+    mat4 Projection;
+    mat4 ViewProjection;
+    vec4 Position;
+    mat4 InverseViewProjection;
+    vec4 Time;
+} Camera;
+
+out vec3 WorldPos;
+flat out uint Cascades;
+
+// Same procedural animation as BaseLighting.vert, see ProceduralAnimation
+float UnpackHalf(uint Bits)
+{
+    float Mantissa = float(Bits & 0x3FFu);
+    uint Exponent = (Bits >> 10u) & 0x1Fu;
+    float Value = Exponent == 0u ? Mantissa * exp2(-24.0) : (1024.0 + Mantissa) * exp2(float(Exponent) - 25.0);
+    return (Bits & 0x8000u) != 0u ? -Value : Value;
+}
+
+mat3 ProceduralRotation(uvec3 Packed, float Time, out vec3 Offset)
+{
+    vec2 Octahedral = vec2(Packed.x & 0xFFu, (Packed.x >> 8u) & 0xFFu) / 127.5 - 1.0;
+    vec3 Axis = vec3(Octahedral, 1.0 - abs(Octahedral.x) - abs(Octahedral.y));
+    if (Axis.z < 0.0)
+        Axis.xy = (1.0 - abs(Axis.yx)) * mix(vec2(-1.0), vec2(1.0), greaterThanEqual(Axis.xy, vec2(0.0)));
+    Axis = normalize(Axis);
+    float Wave = sin(6.2831853 * UnpackHalf(Packed.z >> 16u) * Time + UnpackHalf(Packed.z & 0xFFFFu));
+    float Angle = UnpackHalf(Packed.x >> 16u) * Time + UnpackHalf(Packed.y & 0xFFFFu) * Wave;
+    Offset = Axis * (UnpackHalf(Packed.y >> 16u) * Wave);
+    float Cosine = cos(Angle);
+    return mat3(Cosine) + sin(Angle) * mat3(0.0, Axis.z, -Axis.y, -Axis.z, 0.0, Axis.x, Axis.y, -Axis.x, 0.0) + (1.0 - Cosine) * outerProduct(Axis, Axis);
+}
+
+void main()
+{
+    vec3 Position = aPos;
+    uvec3 Animation = floatBitsToUint(vec3(NormalMatrix[0].w, NormalMatrix[1].w, NormalMatrix[2].w));
+    if (Animation != uvec3(0u))
+    {
+        vec3 Offset;
+        Position = ProceduralRotation(Animation, Camera.Time.x, Offset) * Position + Offset;
+    }
+    WorldPos = vec3(ModelMatrix * vec4(Position, 1.0));
+    Cascades = CascadeMask;
+})";
+
+		// One invocation per cascade, each triangle only reaches the layers its instance overlaps
+		constexpr std::string_view CasterGeometryCode = R"(#version 410 core
+layout (triangles, invocations = 4) in;
+layout (triangle_strip, max_vertices = 3) out;
+
+layout (std140) uniform ShadowData
+{
+    mat4 LightViewProjection[4];
+} Shadows;
+
+in vec3 WorldPos[];
+flat in uint Cascades[];
+
+void main()
+{
+    if ((Cascades[0] & (1u << uint(gl_InvocationID))) == 0u)
+        return;
+
+    vec4 Corners[3];
+    for (int Corner = 0; Corner < 3; Corner++)
+    {
+        Corners[Corner] = Shadows.LightViewProjection[gl_InvocationID] * vec4(WorldPos[Corner], 1.0);
+    }
+
+    // Orthographic, w is 1. The near side isn't tested: depth clamping flattens the casters in front onto it
+    vec3 Min = min(min(Corners[0].xyz, Corners[1].xyz), Corners[2].xyz);
+    vec3 Max = max(max(Corners[0].xyz, Corners[1].xyz), Corners[2].xyz);
+    if (any(greaterThan(Min.xy, vec2(1.0))) || any(lessThan(Max.xy, vec2(-1.0))) || Min.z > 1.0)
+        return;
+
+    for (int Corner = 0; Corner < 3; Corner++)
+    {
+        gl_Layer = gl_InvocationID;
+        gl_Position = Corners[Corner];
+        EmitVertex();
+    }
+    EndPrimitive();
+})";
+
+		constexpr std::string_view CasterFragmentCode = R"(#version 410 core
+void main()
+{
+})";
+	}
+
+	void CascadedShadowMaps::Create()
+	{
+		glGenBuffers(1, &m_BufferID);
+		GLStateCache::BindBuffer(GL_UNIFORM_BUFFER, m_BufferID);
+		glBufferData(GL_UNIFORM_BUFFER, sizeof(ShadowData), &m_Data, GL_DYNAMIC_DRAW);
+		GPUMemoryTracker::TrackBuffer(m_BufferID, sizeof(ShadowData), GPUMemoryCategory::Uniforms, "CascadedShadowMaps");
+
+		// Also binds the generic GL_UNIFORM_BUFFER point, which the cache already holds
+		glBindBufferBase(GL_UNIFORM_BUFFER, BindingPoint, m_BufferID);
+	}
+
+	void CascadedShadowMaps::Destroy()
+	{
+		DestroyTextures();
+		if (m_CasterShader)
+		{
+			m_CasterShader->Cleanup();
+			m_CasterShader.reset();
+		}
+		glDeleteBuffers(1, &m_BufferID);
+		GLStateCache::OnBufferDeleted(m_BufferID);
+		GPUMemoryTracker::UntrackBuffer(m_BufferID);
+		m_BufferID = 0;
+	}
+
+	void CascadedShadowMaps::SetResolution(uint32_t Resolution)
+	{
+		m_Resolution = std::max<uint32_t>(Resolution, 1);
+	}
+
+	void CascadedShadowMaps::SetCascadeCount(uint32_t Count)
+	{
+		m_CascadeCount = std::clamp<uint32_t>(Count, 1, MaxCascades);
+	}
+
+	uint32_t CascadedShadowMaps::GetCascadeCount() const
+	{
+		return m_CascadeCount;
+	}
+
+	void CascadedShadowMaps::SetShadowDistance(float Distance)
+	{
+		m_ShadowDistance = Distance;
+	}
+
+	void CascadedShadowMaps::SetSplitLambda(float Lambda)
+	{
+		m_SplitLambda = std::clamp(Lambda, 0.0f, 1.0f);
+	}
+
+	void CascadedShadowMaps::SetCasterDistance(float Distance)
+	{
+		m_CasterDistance = std::max(Distance, 0.0f);
+	}
+
+	void CascadedShadowMaps::SetBias(float DepthBias, float NormalBias)
+	{
+		m_DepthBias = DepthBias;
+		m_NormalBias = NormalBias;
+	}
+
+	void CascadedShadowMaps::Update(const CameraData& Camera, const glm::vec3& LightDirection)
+	{
+		// Corner rays of the camera frustum, view depth changes linearly along them in both projections
+		glm::vec3 NearCorners[4];
+		glm::vec3 FarCorners[4];
+		for (int Corner = 0; Corner < 4; Corner++)
+		{
+			const glm::vec2 NDC((Corner & 1) ? 1.0f : -1.0f, (Corner & 2) ? 1.0f : -1.0f);
+			const glm::vec4 Near = Camera.InverseViewProjection * glm::vec4(NDC, 0.0f, 1.0f);
+			const glm::vec4 Far = Camera.InverseViewProjection * glm::vec4(NDC, 1.0f, 1.0f);
+			NearCorners[Corner] = glm::vec3(Near) / Near.w;
+			FarCorners[Corner] = glm::vec3(Far) / Far.w;
+		}
+		const float NearDepth = std::max(-(Camera.View * glm::vec4(NearCorners[0], 1.0f)).z, 0.01f);
+		const float FarDepth = std::max(-(Camera.View * glm::vec4(FarCorners[0], 1.0f)).z, NearDepth + 0.01f);
+		const float ShadowFar = std::clamp(m_ShadowDistance, NearDepth + 0.01f, FarDepth);
+
+		// The rotation is taken around the origin, so only the snapped cascade centers move the matrices
+		const glm::vec3 Direction = glm::normalize(LightDirection);
+		const glm::vec3 Up = std::abs(Direction.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+		const glm::mat4 LightView = glm::lookAt(glm::vec3(0.0f), Direction, Up);
+
+		float SplitStart = NearDepth;
+		for (uint32_t Cascade = 0; Cascade < m_CascadeCount; Cascade++)
+		{
+			const float Fraction = static_cast<float>(Cascade + 1) / static_cast<float>(m_CascadeCount);
+			const float UniformSplit = NearDepth + (ShadowFar - NearDepth) * Fraction;
+			const float LogSplit = NearDepth * std::pow(ShadowFar / NearDepth, Fraction);
+			const float SplitEnd = UniformSplit + (LogSplit - UniformSplit) * m_SplitLambda;
+
+			glm::vec3 Slice[8];
+			glm::vec3 Center(0.0f);
+			const float Start = (SplitStart - NearDepth) / (FarDepth - NearDepth);
+			const float End = (SplitEnd - NearDepth) / (FarDepth - NearDepth);
+			for (int Corner = 0; Corner < 4; Corner++)
+			{
+				Slice[Corner] = glm::mix(NearCorners[Corner], FarCorners[Corner], Start);
+				Slice[Corner + 4] = glm::mix(NearCorners[Corner], FarCorners[Corner], End);
+				Center += Slice[Corner] + Slice[Corner + 4];
+			}
+			Center /= 8.0f;
+
+			// The sphere of a slice only depends on the projection, rounding keeps float noise out of the matrix
+			float Radius = 0.0f;
+			for (const glm::vec3& Corner : Slice)
+			{
+				Radius = std::max(Radius, glm::length(Corner - Center));
+			}
+			Radius = std::ceil(Radius * 16.0f) / 16.0f;
+
+			const float TexelSize = 2.0f * Radius / static_cast<float>(m_Resolution);
+			const glm::vec3 LightCenter = glm::floor(glm::vec3(LightView * glm::vec4(Center, 1.0f)) / TexelSize) * TexelSize;
+			const glm::mat4 Projection = glm::ortho(LightCenter.x - Radius, LightCenter.x + Radius, LightCenter.y - Radius, LightCenter.y + Radius,
+				-LightCenter.z - Radius, -LightCenter.z + Radius);
+			const glm::mat4 CasterProjection = glm::ortho(LightCenter.x - Radius, LightCenter.x + Radius, LightCenter.y - Radius, LightCenter.y + Radius,
+				-LightCenter.z - Radius - m_CasterDistance, -LightCenter.z + Radius);
+
+			m_Data.LightViewProjection[Cascade] = Projection * LightView;
+			m_CasterViewProjection[Cascade] = CasterProjection * LightView;
+			m_Data.SplitDepths[Cascade] = SplitEnd;
+			m_Data.TexelSizes[Cascade] = TexelSize;
+			SplitStart = SplitEnd;
+		}
+		m_Data.Params = glm::vec4(static_cast<float>(m_CascadeCount), m_DepthBias, m_NormalBias, 1.0f / static_cast<float>(m_Resolution));
+		Upload();
+
+		if (m_ShadowMap != 0)
+		{
+			GLStateCache::BindTextureUnit(TextureUnit, GL_TEXTURE_2D_ARRAY, m_ShadowMap);
+		}
+	}
+
+	void CascadedShadowMaps::Disable()
+	{
+		if (m_Data.Params.x == 0.0f)
+			return;
+
+		m_Data.Params.x = 0.0f;
+		Upload();
+	}
+
+	void CascadedShadowMaps::Upload()
+	{
+		GLStateCache::BindBuffer(GL_UNIFORM_BUFFER, m_BufferID);
+		glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(ShadowData), &m_Data);
+		RenderCounters::CountUpload(sizeof(ShadowData));
+	}
+
+	const glm::mat4& CascadedShadowMaps::GetCasterViewProjection(uint32_t Cascade) const
+	{
+		return m_CasterViewProjection[Cascade];
+	}
+
+	uint32_t CascadedShadowMaps::BeginCasterPass(const std::array<uint64_t, MaxCascades>& CasterHashes)
+	{
+		if (m_AllocatedResolution != m_Resolution)
+		{
+			Allocate();
+		}
+
+		uint32_t Mask = 0;
+		for (uint32_t Cascade = 0; Cascade < m_CascadeCount; Cascade++)
+		{
+			const uint32_t Bit = 1u << Cascade;
+			if ((m_CurrentMask & Bit) == 0 || m_DrawnViewProjection[Cascade] != m_Data.LightViewProjection[Cascade]
+				|| m_DrawnHashes[Cascade] != CasterHashes[Cascade])
+			{
+				Mask |= Bit;
+				m_DrawnViewProjection[Cascade] = m_Data.LightViewProjection[Cascade];
+				m_DrawnHashes[Cascade] = CasterHashes[Cascade];
+			}
+		}
+		if (Mask == 0)
+			return 0;
+
+		m_CurrentMask |= Mask;
+		glGetIntegerv(GL_VIEWPORT, m_SavedViewport);
+		glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &m_SavedFramebuffer);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_Framebuffer);
+		glViewport(0, 0, static_cast<GLsizei>(m_Resolution), static_cast<GLsizei>(m_Resolution));
+
+		// Clearing the layered attachment clears every layer, cached ones are cleared one by one around it
+		if (Mask == (1u << m_CascadeCount) - 1)
+		{
+			glClear(GL_DEPTH_BUFFER_BIT);
+		}
+		else
+		{
+			for (uint32_t Cascade = 0; Cascade < m_CascadeCount; Cascade++)
+			{
+				if (Mask & (1u << Cascade))
+				{
+					glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, m_ShadowMap, 0, static_cast<GLint>(Cascade));
+					glClear(GL_DEPTH_BUFFER_BIT);
+				}
+			}
+			glFramebufferTexture(GL_DRAW_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, m_ShadowMap, 0);
+		}
+
+		glEnable(GL_DEPTH_CLAMP);
+		glEnable(GL_POLYGON_OFFSET_FILL);
+		glPolygonOffset(2.0f, 1.0f);
+
+		if (!m_CasterShader)
+		{
+			m_CasterShader = Shader::CreateWithGeometryFromSource(CasterVertexCode, CasterGeometryCode, CasterFragmentCode);
+		}
+		m_CasterShader->Activate();
+		return Mask;
+	}
+
+	void CascadedShadowMaps::EndCasterPass()
+	{
+		glDisable(GL_POLYGON_OFFSET_FILL);
+		glDisable(GL_DEPTH_CLAMP);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_SavedFramebuffer);
+		glViewport(m_SavedViewport[0], m_SavedViewport[1], m_SavedViewport[2], m_SavedViewport[3]);
+		GLStateCache::BindTextureUnit(TextureUnit, GL_TEXTURE_2D_ARRAY, m_ShadowMap);
+	}
+
+	void CascadedShadowMaps::Allocate()
+	{
+		DestroyTextures();
+		m_AllocatedResolution = m_Resolution;
+		m_CurrentMask = 0;
+
+		// Hardware comparison with linear filtering gives a 2x2 PCF per tap, outside the cascade is lit
+		glGenTextures(1, &m_ShadowMap);
+		GLStateCache::BindTexture(GL_TEXTURE_2D_ARRAY, m_ShadowMap);
+		glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT32F, static_cast<GLsizei>(m_Resolution), static_cast<GLsizei>(m_Resolution),
+			MaxCascades, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+		GPUMemoryTracker::TrackTexture(m_ShadowMap, GPUMemoryTracker::GetTextureSize(GL_DEPTH_COMPONENT32F, static_cast<int>(m_Resolution),
+			static_cast<int>(m_Resolution), static_cast<int>(MaxCascades)), GPUMemoryCategory::RenderTargets, "CascadedShadowMaps");
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+		const GLfloat Border[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+		glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, Border);
+
+		GLint DrawFramebuffer = 0;
+		glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &DrawFramebuffer);
+		glGenFramebuffers(1, &m_Framebuffer);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_Framebuffer);
+		glFramebufferTexture(GL_DRAW_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, m_ShadowMap, 0);
+		glDrawBuffer(GL_NONE);
+		LOG_ASSERT(glCheckFramebufferStatus(GL_DRAW_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE, "Shadow map framebuffer is incomplete");
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, DrawFramebuffer);
+	}
+
+	void CascadedShadowMaps::DestroyTextures()
+	{
+		m_AllocatedResolution = 0;
+		m_CurrentMask = 0;
+		if (m_Framebuffer == 0)
+			return;
+
+		glDeleteFramebuffers(1, &m_Framebuffer);
+		m_Framebuffer = 0;
+		glDeleteTextures(1, &m_ShadowMap);
+		GLStateCache::OnTextureDeleted(m_ShadowMap);
+		GPUMemoryTracker::UntrackTexture(m_ShadowMap);
+		m_ShadowMap = 0;
+	}
+
+} // namespace fgl
@@ -0,0 +1,255 @@
+#include <FireGL/Renderer/ClusteredLightManager.h>
+#include <FireGL/Renderer/BaseCamera.h>
+#include <FireGL/Renderer/GLStateCache.h>
+#include <FireGL/Renderer/GPUMemoryTracker.h>
+#include <FireGL/Renderer/RenderStats.h>
+#include <FireGL/Core/BaseLog.h>
+
+#include <cmath>
+
+namespace fgl
+{
+
+	bool ClusteredLightManager::IsSupported()
+	{
+		return GLAD_GL_VERSION_4_3;
+	}
+
+	static_assert(sizeof(ClusteredPointLight) == 32, "ClusteredPointLight must match the std430 layout of PointLight");
+
+	void ClusteredLightManager::Create()
+	{
+		glGenBuffers(1, &m_LightBuffer);
+		glGenBuffers(1, &m_ClusterBuffer);
+		glGenBuffers(1, &m_IndexBuffer);
+
+		// Bound buffers need storage even before the first Update()
+		Upload(m_LightBuffer, nullptr, 0);
+		Upload(m_ClusterBuffer, nullptr, 0);
+		Upload(m_IndexBuffer, nullptr, 0);
+
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, LightBindingPoint, m_LightBuffer);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, ClusterBindingPoint, m_ClusterBuffer);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, IndexBindingPoint, m_IndexBuffer);
+	}
+
+	void ClusteredLightManager::Destroy()
+	{
+		for (GLuint* Buffer : { &m_LightBuffer, &m_ClusterBuffer, &m_IndexBuffer })
+		{
+			if (*Buffer == 0)
+				continue;
+
+			glDeleteBuffers(1, Buffer);
+			GLStateCache::OnBufferDeleted(*Buffer);
+			GPUMemoryTracker::UntrackBuffer(*Buffer);
+			*Buffer = 0;
+		}
+	}
+
+	size_t ClusteredLightManager::AddLight(const ClusteredPointLight& Light)
+	{
+		m_Lights.push_back(Light);
+		m_bLightsEdited = true;
+		return m_Lights.size() - 1;
+	}
+
+	void ClusteredLightManager::RemoveLight(size_t Index)
+	{
+		LOG_ASSERT(Index < m_Lights.size(), "Clustered light index out of range");
+		m_Lights[Index] = m_Lights.back();
+		m_Lights.pop_back();
+		m_bLightsEdited = true;
+	}
+
+	ClusteredPointLight& ClusteredLightManager::EditLight(size_t Index)
+	{
+		LOG_ASSERT(Index < m_Lights.size(), "Clustered light index out of range");
+		m_bLightsEdited = true;
+		return m_Lights[Index];
+	}
+
+	const std::vector<ClusteredPointLight>& ClusteredLightManager::GetLights() const
+	{
+		return m_Lights;
+	}
+
+	void ClusteredLightManager::ClearLights()
+	{
+		m_Lights.clear();
+		m_bLightsEdited = true;
+	}
+
+	void ClusteredLightManager::Capture()
+	{
+		if (!m_bLightsEdited)
+			return;
+
+		m_RenderLights = m_Lights;
+		m_bLightsEdited = false;
+	}
+
+	const std::vector<ClusteredPointLight>& ClusteredLightManager::GetRenderLights() const
+	{
+		return m_RenderLights;
+	}
+
+	void ClusteredLightManager::SetMaxLightsPerCluster(uint32_t MaxLights)
+	{
+		m_MaxLightsPerCluster = MaxLights;
+	}
+
+	uint32_t ClusteredLightManager::GetMaxLightsPerCluster() const
+	{
+		return m_MaxLightsPerCluster;
+	}
+
+	void ClusteredLightManager::Update(const BaseCamera& Camera, int ViewportWidth, int ViewportHeight)
+	{
+		const glm::mat4 View = Camera.GetViewMatrix();
+		const glm::mat4 Projection = Camera.GetProjectionMatrix();
+		LOG_ASSERT(Projection[3][3] == 0.0f, "Clustered lighting requires a perspective projection");
+
+		// Planes of the [0, 1] depth range projection
+		const float Near = Projection[3][2] / Projection[2][2];
+		const float Far = Projection[3][2] / (Projection[2][2] + 1.0f);
+
+		// Slice = log(Depth) * Scale + Bias maps [Near, Far] to [0, GridZ]
+		const float LogRatio = std::log(Far / Near);
+		const float SliceScale = GridZ / LogRatio;
+		const float SliceBias = -GridZ * std::log(Near) / LogRatio;
+
+		m_Ranges.clear();
+		m_RangeLights.clear();
+		for (size_t LightIndex = 0; LightIndex < m_RenderLights.size(); LightIndex++)
+		{
+			ClusterRange Range;
+			if (GetClusterRange(m_RenderLights[LightIndex], View, Projection, Near, Far, SliceScale, SliceBias, Range))
+			{
+				m_Ranges.push_back(Range);
+				m_RangeLights.push_back(static_cast<uint32_t>(LightIndex));
+			}
+		}
+
+		// Count the lights of every cluster, then turn the counts into offsets
+		// Both passes visit the lights in the same order, so the capped counts keep the same lights
+		m_Clusters.assign(ClusterCount, glm::uvec2(0));
+		for (const ClusterRange& Range : m_Ranges)
+		{
+			for (uint32_t Z = Range.MinZ; Z <= Range.MaxZ; Z++)
+				for (uint32_t Y = Range.MinY; Y <= Range.MaxY; Y++)
+					for (uint32_t X = Range.MinX; X <= Range.MaxX; X++)
+					{
+						glm::uvec2& Cluster = m_Clusters[X + GridX * (Y + GridY * Z)];
+						Cluster.y += Cluster.y < m_MaxLightsPerCluster ? 1 : 0;
+					}
+		}
+
+		uint32_t Offset = 0;
+		for (glm::uvec2& Cluster : m_Clusters)
+		{
+			Cluster.x = Offset;
+			Offset += Cluster.y;
+			Cluster.y = 0;
+		}
+
+		m_LightIndices.resize(Offset);
+		for (size_t RangeIndex = 0; RangeIndex < m_Ranges.size(); RangeIndex++)
+		{
+			const ClusterRange& Range = m_Ranges[RangeIndex];
+			for (uint32_t Z = Range.MinZ; Z <= Range.MaxZ; Z++)
+				for (uint32_t Y = Range.MinY; Y <= Range.MaxY; Y++)
+					for (uint32_t X = Range.MinX; X <= Range.MaxX; X++)
+					{
+						glm::uvec2& Cluster = m_Clusters[X + GridX * (Y + GridY * Z)];
+						if (Cluster.y < m_MaxLightsPerCluster)
+						{
+							m_LightIndices[Cluster.x + Cluster.y++] = m_RangeLights[RangeIndex];
+						}
+					}
+		}
+
+		ClusterHeader Header;
+		Header.GridSize = glm::uvec4(GridX, GridY, GridZ, static_cast<uint32_t>(m_RenderLights.size()));
+		Header.DepthParams = glm::vec4(Near, Far, SliceScale, SliceBias);
+		Header.ScreenParams = glm::vec4(ViewportWidth, ViewportHeight,
+			static_cast<float>(ViewportWidth) / GridX, static_cast<float>(ViewportHeight) / GridY);
+
+		Upload(m_LightBuffer, m_RenderLights.data(), m_RenderLights.size() * sizeof(ClusteredPointLight));
+		Upload(m_IndexBuffer, m_LightIndices.data(), m_LightIndices.size() * sizeof(uint32_t));
+
+		const size_t ClustersSize = m_Clusters.size() * sizeof(glm::uvec2);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_ClusterBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(ClusterHeader) + ClustersSize, nullptr, GL_STREAM_DRAW);
+		GPUMemoryTracker::TrackBuffer(m_ClusterBuffer, sizeof(ClusterHeader) + ClustersSize, GPUMemoryCategory::Storage, "ClusteredLightManager");
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(ClusterHeader), &Header);
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, sizeof(ClusterHeader), ClustersSize, m_Clusters.data());
+		RenderCounters::CountUpload(sizeof(ClusterHeader) + ClustersSize);
+	}
+
+	bool ClusteredLightManager::GetClusterRange(const ClusteredPointLight& Light, const glm::mat4& View, const glm::mat4& Projection,
+		float Near, float Far, float SliceScale, float SliceBias, ClusterRange& Range)
+	{
+		const glm::vec3 Center = glm::vec3(View * glm::vec4(glm::vec3(Light.PositionRange), 1.0f));
+		const float Radius = Light.PositionRange.w;
+		const float Depth = -Center.z;
+		if (Depth + Radius < Near || Depth - Radius > Far)
+			return false;
+
+		auto GetSlice = [&](float SliceDepth)
+		{
+			const float Slice = std::floor(std::log(SliceDepth) * SliceScale + SliceBias);
+			return static_cast<uint32_t>(glm::clamp(Slice, 0.0f, static_cast<float>(GridZ - 1)));
+		};
+		Range.MinZ = GetSlice(std::max(Depth - Radius, Near));
+		Range.MaxZ = GetSlice(std::min(Depth + Radius, Far));
+
+		// A sphere crossing the near plane can cover the whole screen
+		Range.MinX = 0;
+		Range.MaxX = GridX - 1;
+		Range.MinY = 0;
+		Range.MaxY = GridY - 1;
+		if (Depth - Radius <= Near)
+			return true;
+
+		// Screen bounds of the sphere's view-space box, every corner lies in front of the camera
+		glm::vec2 Min(1.0f), Max(-1.0f);
+		for (int Corner = 0; Corner < 8; Corner++)
+		{
+			const glm::vec3 Offset((Corner & 1) ? Radius : -Radius, (Corner & 2) ? Radius : -Radius, (Corner & 4) ? Radius : -Radius);
+			const glm::vec4 Clip = Projection * glm::vec4(Center + Offset, 1.0f);
+			const glm::vec2 NDC = glm::vec2(Clip) / Clip.w;
+			Min = glm::min(Min, NDC);
+			Max = glm::max(Max, NDC);
+		}
+		if (Min.x > 1.0f || Min.y > 1.0f || Max.x < -1.0f || Max.y < -1.0f)
+			return false;
+
+		auto GetTile = [](float Coordinate, uint32_t TileCount)
+		{
+			const float Tile = std::floor((Coordinate * 0.5f + 0.5f) * TileCount);
+			return static_cast<uint32_t>(glm::clamp(Tile, 0.0f, static_cast<float>(TileCount - 1)));
+		};
+		Range.MinX = GetTile(Min.x, GridX);
+		Range.MaxX = GetTile(Max.x, GridX);
+		Range.MinY = GetTile(Min.y, GridY);
+		Range.MaxY = GetTile(Max.y, GridY);
+		return true;
+	}
+
+	void ClusteredLightManager::Upload(GLuint Buffer, const void* Data, size_t Size)
+	{
+		static constexpr uint32_t Empty = 0;
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, Buffer);
+		if (Size == 0)
+		{
+			glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(Empty), &Empty, GL_STREAM_DRAW);
+			GPUMemoryTracker::TrackBuffer(Buffer, sizeof(Empty), GPUMemoryCategory::Storage, "ClusteredLightManager");
+			return;
+		}
+		glBufferData(GL_SHADER_STORAGE_BUFFER, Size, Data, GL_STREAM_DRAW);
+		GPUMemoryTracker::TrackBuffer(Buffer, Size, GPUMemoryCategory::Storage, "ClusteredLightManager");
+		RenderCounters::CountUpload(Size);
+	}
+
+} // namespace fgl
\ No newline at end of file
@@ -9,6 +9,11 @@ namespace fgl
         m_Owner = Owner;
     }
 
+    void Component::SetScene(const Scene* OwnerScene)
+    {
+        m_Scene = OwnerScene;
+    }
+
     Entity* Component::GetOwner() const
     {
         return m_Owner;
@@ -22,8 +27,21 @@ namespace fgl
     {
     }
 
+    bool Component::IsTickThreadSafe() const
+    {
+        return false;
+    }
+
     void Component::OnDestroyed()
     {
     }
 
+    void Component::OnOverlapBegin(SceneObject* Other)
+    {
+    }
+
+    void Component::OnOverlapEnd(SceneObject* Other)
+    {
+    }
+
 } // namespace fgl
\ No newline at end of file
@@ -0,0 +1,58 @@
+#include <FireGL/Renderer/ComponentPool.h>
+#include <FireGL/Core/BaseLog.h>
+
+namespace fgl
+{
+
+	namespace
+	{
+		/** Every pool created so far, in the order they were first used. */
+		std::vector<ComponentPoolBase*>& GetRegisteredPools()
+		{
+			static std::vector<ComponentPoolBase*> Pools;
+			return Pools;
+		}
+	}
+
+	void ComponentPoolBase::TickAll(const Scene* TargetScene, float DeltaTime, JobSystem* Jobs)
+	{
+		for (ComponentPoolBase* Pool : GetRegisteredPools())
+		{
+			Pool->Tick(TargetScene, DeltaTime, Jobs);
+		}
+	}
+
+	void ComponentPoolBase::Release(Component* Instance)
+	{
+		Instance->m_Pool->Destroy(Instance);
+	}
+
+	uint32_t ComponentPoolBase::NextTypeID()
+	{
+		static uint32_t s_NextTypeID = 0;
+		LOG_ASSERT(s_NextTypeID < MaxComponentTypes, "Too many component types, raise ComponentPoolBase::MaxComponentTypes")
+		return s_NextTypeID++;
+	}
+
+	void ComponentPoolBase::Register(ComponentPoolBase* Pool)
+	{
+		GetRegisteredPools().push_back(Pool);
+	}
+
+	void ComponentPoolBase::SetSlot(Component* Instance, ComponentPoolBase* Pool, uint32_t Slot)
+	{
+		Instance->m_Pool = Pool;
+		Instance->m_PoolSlot = Slot;
+	}
+
+	uint32_t ComponentPoolBase::GetSlot(const Component* Instance)
+	{
+		return Instance->m_PoolSlot;
+	}
+
+	const Scene* ComponentPoolBase::GetScene(const Component* Instance)
+	{
+		return Instance->m_Scene;
+	}
+
+} // namespace fgl
\ No newline at end of file
@@ -0,0 +1,213 @@
+#include <FireGL/Renderer/DebugDraw.h>
+
+#if defined(FIREGL_ENABLE_DEBUG_DRAW)
+#include <FireGL/Renderer/Material.h>
+#include <FireGL/Renderer/GLStateCache.h>
+#include <FireGL/Renderer/GPUMemoryTracker.h>
+#include <FireGL/Renderer/RenderStats.h>
+
+#include <External/glm/gtc/constants.hpp>
+#include <External/glm/gtc/packing.hpp>
+
+namespace fgl
+{
+
+	namespace
+	{
+		constexpr std::string_view LineVertexCode = R"(#version 410 core
+layout (location = 0) in vec3 aPosition;
+layout (location = 1) in vec4 aColor;
+
+layout (std140) uniform CameraData
+{
+    mat4 View;
+    mat4 Projection;
+    mat4 ViewProjection;
+} Camera;
+
+out vec4 Color;
+
+void main()
+{
+    Color = aColor;
+    gl_Position = Camera.ViewProjection * vec4(aPosition, 1.0);
+}
+)";
+
+		constexpr std::string_view LineFragmentCode = R"(#version 410 core
+in vec4 Color;
+
+out vec4 FragColor;
+
+void main()
+{
+    FragColor = Color;
+}
+)";
+
+		/** The 12 edges of a box whose corners are numbered by their bits: x in bit 0, y in bit 1, z in bit 2. */
+		constexpr uint8_t BoxEdges[24] = {
+			0, 1, 2, 3, 4, 5, 6, 7,
+			0, 2, 1, 3, 4, 6, 5, 7,
+			0, 4, 1, 5, 2, 6, 3, 7
+		};
+	} // namespace
+
+	std::mutex DebugDraw::s_Mutex;
+	std::vector<DebugDraw::Vertex> DebugDraw::s_Recording;
+
+	DebugDraw::~DebugDraw()
+	{
+		Destroy();
+	}
+
+	void DebugDraw::DrawLine(const glm::vec3& From, const glm::vec3& To, const glm::vec4& Color)
+	{
+		const uint32_t Packed = glm::packUnorm4x8(Color);
+		const Vertex Line[2] = { { From, Packed }, { To, Packed } };
+		Append(Line, 2);
+	}
+
+	void DebugDraw::DrawAABB(const glm::vec3& Min, const glm::vec3& Max, const glm::vec4& Color)
+	{
+		const uint32_t Packed = glm::packUnorm4x8(Color);
+		Vertex Lines[24];
+		for (int Index = 0; Index < 24; Index++)
+		{
+			const uint8_t Corner = BoxEdges[Index];
+			Lines[Index] = { glm::vec3((Corner & 1) ? Max.x : Min.x, (Corner & 2) ? Max.y : Min.y, (Corner & 4) ? Max.z : Min.z), Packed };
+		}
+		Append(Lines, 24);
+	}
+
+	void DebugDraw::DrawSphere(const glm::vec3& Center, float Radius, const glm::vec4& Color, uint32_t Segments)
+	{
+		Segments = std::max(Segments, 3u);
+		const uint32_t Packed = glm::packUnorm4x8(Color);
+		std::vector<Vertex> Lines;
+		Lines.reserve(Segments * 6);
+		for (uint32_t Segment = 0; Segment < Segments; Segment++)
+		{
+			const float Angle0 = glm::two_pi<float>() * Segment / Segments;
+			const float Angle1 = glm::two_pi<float>() * (Segment + 1) / Segments;
+			const glm::vec2 Point0 = glm::vec2(std::cos(Angle0), std::sin(Angle0)) * Radius;
+			const glm::vec2 Point1 = glm::vec2(std::cos(Angle1), std::sin(Angle1)) * Radius;
+			Lines.push_back({ Center + glm::vec3(Point0.x, Point0.y, 0.0f), Packed });
+			Lines.push_back({ Center + glm::vec3(Point1.x, Point1.y, 0.0f), Packed });
+			Lines.push_back({ Center + glm::vec3(Point0.x, 0.0f, Point0.y), Packed });
+			Lines.push_back({ Center + glm::vec3(Point1.x, 0.0f, Point1.y), Packed });
+			Lines.push_back({ Center + glm::vec3(0.0f, Point0.x, Point0.y), Packed });
+			Lines.push_back({ Center + glm::vec3(0.0f, Point1.x, Point1.y), Packed });
+		}
+		Append(Lines.data(), Lines.size());
+	}
+
+	void DebugDraw::DrawFrustum(const glm::mat4& ViewProjection, const glm::vec4& Color)
+	{
+		// The corners of the clip volume, back to world space; its near depth depends on the clip convention
+#if GLM_CONFIG_CLIP_CONTROL & GLM_CLIP_CONTROL_ZO_BIT
+		constexpr float NearDepth = 0.0f;
+#else
+		constexpr float NearDepth = -1.0f;
+#endif
+		const glm::mat4 InverseViewProjection = glm::inverse(ViewProjection);
+		glm::vec3 Corners[8];
+		for (int Corner = 0; Corner < 8; Corner++)
+		{
+			const glm::vec4 Clip((Corner & 1) ? 1.0f : -1.0f, (Corner & 2) ? 1.0f : -1.0f, (Corner & 4) ? 1.0f : NearDepth, 1.0f);
+			const glm::vec4 World = InverseViewProjection * Clip;
+			Corners[Corner] = glm::vec3(World) / World.w;
+		}
+
+		const uint32_t Packed = glm::packUnorm4x8(Color);
+		Vertex Lines[24];
+		for (int Index = 0; Index < 24; Index++)
+		{
+			Lines[Index] = { Corners[BoxEdges[Index]], Packed };
+		}
+		Append(Lines, 24);
+	}
+
+	void DebugDraw::Append(const Vertex* Vertices, size_t Count)
+	{
+		std::lock_guard<std::mutex> Lock(s_Mutex);
+		s_Recording.insert(s_Recording.end(), Vertices, Vertices + Count);
+	}
+
+	void DebugDraw::Latch()
+	{
+		// Swapped rather than copied, both lists keep their capacity from frame to frame
+		m_Latched.clear();
+		std::lock_guard<std::mutex> Lock(s_Mutex);
+		m_Latched.swap(s_Recording);
+	}
+
+	void DebugDraw::Render()
+	{
+		if (m_Latched.empty())
+			return;
+
+		if (!m_Shader)
+		{
+			m_Shader = Shader::CreateFromSource(LineVertexCode, LineFragmentCode);
+			glGenVertexArrays(1, &m_VertexArray);
+			glGenBuffers(1, &m_VertexBuffer);
+		}
+
+		// Orphaned every frame, the driver hands out fresh storage while the previous frame's lines are still read
+		const GLsizeiptr Size = static_cast<GLsizeiptr>(m_Latched.size() * sizeof(Vertex));
+		GLStateCache::BindBuffer(GL_ARRAY_BUFFER, m_VertexBuffer);
+		if (m_Latched.size() > m_Capacity)
+		{
+			m_Capacity = std::max(m_Latched.size(), m_Capacity * 2);
+			GPUMemoryTracker::UntrackBuffer(m_VertexBuffer);
+			GPUMemoryTracker::TrackBuffer(m_VertexBuffer, static_cast<GLsizeiptr>(m_Capacity * sizeof(Vertex)), GPUMemoryCategory::Geometry, "Debug Draw");
+
+			GLStateCache::BindVertexArray(m_VertexArray);
+			glEnableVertexAttribArray(0);
+			glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<const void*>(offsetof(Vertex, Position)));
+			glEnableVertexAttribArray(1);
+			glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex), reinterpret_cast<const void*>(offsetof(Vertex, Color)));
+		}
+		glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(m_Capacity * sizeof(Vertex)), nullptr, GL_STREAM_DRAW);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, Size, m_Latched.data());
+		RenderCounters::CountUpload(static_cast<size_t>(Size));
+
+		m_Shader->Activate();
+		GLStateCache::BindVertexArray(m_VertexArray);
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		GLStateCache::SetDepthWrite(false);
+		glDrawArrays(GL_LINES, 0, static_cast<GLsizei>(m_Latched.size()));
+		RenderCounters::CountDraw(1, 0);
+		GLStateCache::SetDepthWrite(true);
+		glDisable(GL_BLEND);
+		Material::InvalidateActiveMaterial();
+	}
+
+	void DebugDraw::Destroy()
+	{
+		if (m_VertexBuffer != 0)
+		{
+			glDeleteBuffers(1, &m_VertexBuffer);
+			GLStateCache::OnBufferDeleted(m_VertexBuffer);
+			GPUMemoryTracker::UntrackBuffer(m_VertexBuffer);
+			m_VertexBuffer = 0;
+		}
+		if (m_VertexArray != 0)
+		{
+			glDeleteVertexArrays(1, &m_VertexArray);
+			GLStateCache::OnVertexArrayDeleted(m_VertexArray);
+			m_VertexArray = 0;
+		}
+		if (m_Shader)
+		{
+			m_Shader->Cleanup();
+			m_Shader.reset();
+		}
+		m_Capacity = 0;
+		m_Latched.clear();
+	}
+
+} // namespace fgl
+#endif
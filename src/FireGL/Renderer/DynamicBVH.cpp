@@ -0,0 +1,495 @@
+#include <FireGL/Renderer/DynamicBVH.h>
+#include <FireGL/Renderer/Frustum.h>
+#include <FireGL/Core/BaseLog.h>
+
+#include <External/glm/common.hpp>
+#include <External/glm/geometric.hpp>
+
+namespace fgl
+{
+
+	namespace
+	{
+		/** Fraction of its size a leaf box is enlarged by on every side. */
+		constexpr float LeafMargin = 0.1f;
+
+		/** Smallest enlargement, so points and tiny objects also get some slack. */
+		constexpr float MinLeafMargin = 0.05f;
+
+		BoundingBox Union(const BoundingBox& A, const BoundingBox& B)
+		{
+			return { glm::min(A.Min, B.Min), glm::max(A.Max, B.Max) };
+		}
+
+		float SurfaceArea(const BoundingBox& Box)
+		{
+			const glm::vec3 Size = Box.Max - Box.Min;
+			return 2.0f * (Size.x * Size.y + Size.y * Size.z + Size.z * Size.x);
+		}
+
+		bool Overlaps(const BoundingBox& A, const BoundingBox& B)
+		{
+			return glm::all(glm::lessThanEqual(A.Min, B.Max)) && glm::all(glm::lessThanEqual(B.Min, A.Max));
+		}
+
+		bool Contains(const BoundingBox& Outer, const BoundingBox& Inner)
+		{
+			return glm::all(glm::lessThanEqual(Outer.Min, Inner.Min)) && glm::all(glm::lessThanEqual(Inner.Max, Outer.Max));
+		}
+
+		enum class Containment
+		{
+			Outside, Intersecting, Inside
+		};
+
+		Containment ClassifyBox(const Frustum& ViewFrustum, const BoundingBox& Box)
+		{
+			const glm::vec3 Center = (Box.Min + Box.Max) * 0.5f;
+			const glm::vec3 Extent = (Box.Max - Box.Min) * 0.5f;
+
+			Containment Result = Containment::Inside;
+			for (const glm::vec4& Plane : ViewFrustum.GetPlanes())
+			{
+				// Distance of the center and projected radius of the box along the plane normal
+				const float Distance = glm::dot(glm::vec3(Plane), Center) + Plane.w;
+				const float Radius = glm::dot(Extent, glm::abs(glm::vec3(Plane)));
+				if (Distance < -Radius)
+					return Containment::Outside;
+				if (Distance < Radius)
+				{
+					Result = Containment::Intersecting;
+				}
+			}
+			return Result;
+		}
+
+		bool OverlapsSphere(const BoundingBox& Box, const BoundingSphere& Sphere)
+		{
+			const glm::vec3 Closest = glm::clamp(Sphere.Center, Box.Min, Box.Max);
+			const glm::vec3 Offset = Closest - Sphere.Center;
+			return glm::dot(Offset, Offset) <= Sphere.Radius * Sphere.Radius;
+		}
+
+		bool IntersectsRay(const BoundingBox& Box, const glm::vec3& Origin, const glm::vec3& InverseDirection, float MaxDistance)
+		{
+			// Slab test, an infinite inverse direction component leaves that slab unbounded
+			const glm::vec3 T1 = (Box.Min - Origin) * InverseDirection;
+			const glm::vec3 T2 = (Box.Max - Origin) * InverseDirection;
+			const glm::vec3 TMin = glm::min(T1, T2);
+			const glm::vec3 TMax = glm::max(T1, T2);
+			const float Enter = std::max(std::max(TMin.x, TMin.y), std::max(TMin.z, 0.0f));
+			const float Exit = std::min(std::min(TMax.x, TMax.y), std::min(TMax.z, MaxDistance));
+			return Enter <= Exit;
+		}
+	}
+
+	int32_t DynamicBVH::Insert(uint32_t ObjectIndex, const BoundingBox& Box)
+	{
+		const int32_t Leaf = AllocateNode();
+		const glm::vec3 Margin = glm::max((Box.Max - Box.Min) * LeafMargin, glm::vec3(MinLeafMargin));
+		m_Nodes[Leaf].Box = { Box.Min - Margin, Box.Max + Margin };
+		m_Nodes[Leaf].ObjectIndex = ObjectIndex;
+		m_Nodes[Leaf].Height = 0;
+		InsertLeaf(Leaf);
+		return Leaf;
+	}
+
+	void DynamicBVH::Remove(int32_t Leaf)
+	{
+		LOG_ASSERT(Leaf >= 0 && Leaf < static_cast<int32_t>(m_Nodes.size()) && m_Nodes[Leaf].IsLeaf(), "Invalid BVH leaf");
+		RemoveLeaf(Leaf);
+		FreeNode(Leaf);
+	}
+
+	bool DynamicBVH::Move(int32_t Leaf, const BoundingBox& Box)
+	{
+		LOG_ASSERT(Leaf >= 0 && Leaf < static_cast<int32_t>(m_Nodes.size()) && m_Nodes[Leaf].IsLeaf(), "Invalid BVH leaf");
+		if (Contains(m_Nodes[Leaf].Box, Box))
+			return false;
+
+		RemoveLeaf(Leaf);
+		const glm::vec3 Margin = glm::max((Box.Max - Box.Min) * LeafMargin, glm::vec3(MinLeafMargin));
+		m_Nodes[Leaf].Box = { Box.Min - Margin, Box.Max + Margin };
+		InsertLeaf(Leaf);
+		return true;
+	}
+
+	void DynamicBVH::SetObjectIndex(int32_t Leaf, uint32_t ObjectIndex)
+	{
+		LOG_ASSERT(Leaf >= 0 && Leaf < static_cast<int32_t>(m_Nodes.size()) && m_Nodes[Leaf].IsLeaf(), "Invalid BVH leaf");
+		m_Nodes[Leaf].ObjectIndex = ObjectIndex;
+	}
+
+	void DynamicBVH::Clear()
+	{
+		m_Nodes.clear();
+		m_Root = NullNode;
+		m_FreeList = NullNode;
+	}
+
+	int32_t DynamicBVH::GetHeight() const
+	{
+		return m_Root == NullNode ? 0 : m_Nodes[m_Root].Height;
+	}
+
+	int32_t DynamicBVH::AllocateNode()
+	{
+		if (m_FreeList == NullNode)
+		{
+			m_Nodes.emplace_back();
+			return static_cast<int32_t>(m_Nodes.size() - 1);
+		}
+
+		const int32_t Index = m_FreeList;
+		m_FreeList = m_Nodes[Index].Parent;
+		m_Nodes[Index] = Node();
+		return Index;
+	}
+
+	void DynamicBVH::FreeNode(int32_t Index)
+	{
+		m_Nodes[Index].Parent = m_FreeList;
+		m_Nodes[Index].Height = -1;
+		m_FreeList = Index;
+	}
+
+	void DynamicBVH::InsertLeaf(int32_t Leaf)
+	{
+		if (m_Root == NullNode)
+		{
+			m_Root = Leaf;
+			m_Nodes[Leaf].Parent = NullNode;
+			return;
+		}
+
+		// Descend towards the sibling whose pairing grows the total surface area the least
+		const BoundingBox LeafBox = m_Nodes[Leaf].Box;
+		int32_t Index = m_Root;
+		while (!m_Nodes[Index].IsLeaf())
+		{
+			const Node& Current = m_Nodes[Index];
+			const float Area = SurfaceArea(Current.Box);
+			const float CombinedArea = SurfaceArea(Union(Current.Box, LeafBox));
+
+			// Pairing with this node creates a parent of CombinedArea, descending grows this node by the difference
+			const float Cost = 2.0f * CombinedArea;
+			const float InheritanceCost = 2.0f * (CombinedArea - Area);
+
+			auto GetDescentCost = [&](int32_t Child)
+			{
+				const Node& ChildNode = m_Nodes[Child];
+				const float MergedArea = SurfaceArea(Union(ChildNode.Box, LeafBox));
+				return (ChildNode.IsLeaf() ? MergedArea : MergedArea - SurfaceArea(ChildNode.Box)) + InheritanceCost;
+			};
+			const float Cost1 = GetDescentCost(Current.Child1);
+			const float Cost2 = GetDescentCost(Current.Child2);
+
+			if (Cost < Cost1 && Cost < Cost2)
+				break;
+
+			Index = Cost1 < Cost2 ? Current.Child1 : Current.Child2;
+		}
+
+		// Replace the sibling by a new parent of the sibling and the leaf
+		const int32_t Sibling = Index;
+		const int32_t OldParent = m_Nodes[Sibling].Parent;
+		const int32_t NewParent = AllocateNode();
+		m_Nodes[NewParent].Parent = OldParent;
+		m_Nodes[NewParent].Box = Union(LeafBox, m_Nodes[Sibling].Box);
+		m_Nodes[NewParent].Height = m_Nodes[Sibling].Height + 1;
+		m_Nodes[NewParent].Child1 = Sibling;
+		m_Nodes[NewParent].Child2 = Leaf;
+		m_Nodes[Sibling].Parent = NewParent;
+		m_Nodes[Leaf].Parent = NewParent;
+
+		if (OldParent == NullNode)
+		{
+			m_Root = NewParent;
+		}
+		else if (m_Nodes[OldParent].Child1 == Sibling)
+		{
+			m_Nodes[OldParent].Child1 = NewParent;
+		}
+		else
+		{
+			m_Nodes[OldParent].Child2 = NewParent;
+		}
+
+		RefitAncestors(m_Nodes[Leaf].Parent);
+	}
+
+	void DynamicBVH::RemoveLeaf(int32_t Leaf)
+	{
+		if (Leaf == m_Root)
+		{
+			m_Root = NullNode;
+			return;
+		}
+
+		// The sibling takes the place of the parent
+		const int32_t Parent = m_Nodes[Leaf].Parent;
+		const int32_t GrandParent = m_Nodes[Parent].Parent;
+		const int32_t Sibling = m_Nodes[Parent].Child1 == Leaf ? m_Nodes[Parent].Child2 : m_Nodes[Parent].Child1;
+
+		m_Nodes[Sibling].Parent = GrandParent;
+		FreeNode(Parent);
+		if (GrandParent == NullNode)
+		{
+			m_Root = Sibling;
+			return;
+		}
+
+		if (m_Nodes[GrandParent].Child1 == Parent)
+		{
+			m_Nodes[GrandParent].Child1 = Sibling;
+		}
+		else
+		{
+			m_Nodes[GrandParent].Child2 = Sibling;
+		}
+		RefitAncestors(GrandParent);
+	}
+
+	void DynamicBVH::RefitAncestors(int32_t Index)
+	{
+		while (Index != NullNode)
+		{
+			Index = Balance(Index);
+
+			Node& Current = m_Nodes[Index];
+			const Node& Child1 = m_Nodes[Current.Child1];
+			const Node& Child2 = m_Nodes[Current.Child2];
+			Current.Height = 1 + std::max(Child1.Height, Child2.Height);
+			Current.Box = Union(Child1.Box, Child2.Box);
+
+			Index = Current.Parent;
+		}
+	}
+
+	int32_t DynamicBVH::Balance(int32_t IndexA)
+	{
+		Node& A = m_Nodes[IndexA];
+		if (A.IsLeaf() || A.Height < 2)
+			return IndexA;
+
+		const int32_t IndexB = A.Child1;
+		const int32_t IndexC = A.Child2;
+		Node& B = m_Nodes[IndexB];
+		Node& C = m_Nodes[IndexC];
+		const int32_t HeightDifference = C.Height - B.Height;
+
+		// Rotates Up (a child of A) into A's place, A keeps Up's shallower child and Down
+		auto RotateUp = [&](int32_t IndexUp, Node& Up, Node& Down, bool bUpIsChild2)
+		{
+			const int32_t IndexF = Up.Child1;
+			const int32_t IndexG = Up.Child2;
+			Node& F = m_Nodes[IndexF];
+			Node& G = m_Nodes[IndexG];
+
+			Up.Child1 = IndexA;
+			Up.Parent = A.Parent;
+			A.Parent = IndexUp;
+
+			if (Up.Parent == NullNode)
+			{
+				m_Root = IndexUp;
+			}
+			else if (m_Nodes[Up.Parent].Child1 == IndexA)
+			{
+				m_Nodes[Up.Parent].Child1 = IndexUp;
+			}
+			else
+			{
+				m_Nodes[Up.Parent].Child2 = IndexUp;
+			}
+
+			// The deeper grandchild stays under Up, the other one moves under A in Up's old slot
+			const bool bKeepF = F.Height > G.Height;
+			const int32_t IndexKept = bKeepF ? IndexF : IndexG;
+			const int32_t IndexMoved = bKeepF ? IndexG : IndexF;
+			Node& Kept = m_Nodes[IndexKept];
+			Node& Moved = m_Nodes[IndexMoved];
+
+			Up.Child2 = IndexKept;
+			(bUpIsChild2 ? A.Child2 : A.Child1) = IndexMoved;
+			Moved.Parent = IndexA;
+
+			A.Box = Union(Down.Box, Moved.Box);
+			A.Height = 1 + std::max(Down.Height, Moved.Height);
+			Up.Box = Union(A.Box, Kept.Box);
+			Up.Height = 1 + std::max(A.Height, Kept.Height);
+		};
+
+		if (HeightDifference > 1)
+		{
+			RotateUp(IndexC, C, B, true);
+			return IndexC;
+		}
+		if (HeightDifference < -1)
+		{
+			RotateUp(IndexB, B, C, false);
+			return IndexB;
+		}
+		return IndexA;
+	}
+
+	void DynamicBVH::CollectLeaves(int32_t Index, std::vector<uint32_t>& OutObjects) const
+	{
+		std::vector<int32_t> Stack = { Index };
+		while (!Stack.empty())
+		{
+			const Node& Current = m_Nodes[Stack.back()];
+			Stack.pop_back();
+			if (Current.IsLeaf())
+			{
+				OutObjects.push_back(Current.ObjectIndex);
+				continue;
+			}
+			Stack.push_back(Current.Child1);
+			Stack.push_back(Current.Child2);
+		}
+	}
+
+	void DynamicBVH::QueryFrustum(const Frustum& ViewFrustum, std::vector<uint32_t>& OutObjects) const
+	{
+		if (m_Root == NullNode)
+			return;
+
+		std::vector<int32_t> Stack = { m_Root };
+		while (!Stack.empty())
+		{
+			const int32_t Index = Stack.back();
+			Stack.pop_back();
+			const Node& Current = m_Nodes[Index];
+
+			const Containment Result = ClassifyBox(ViewFrustum, Current.Box);
+			if (Result == Containment::Outside)
+				continue;
+
+			if (Current.IsLeaf())
+			{
+				OutObjects.push_back(Current.ObjectIndex);
+			}
+			else if (Result == Containment::Inside)
+			{
+				CollectLeaves(Index, OutObjects);
+			}
+			else
+			{
+				Stack.push_back(Current.Child1);
+				Stack.push_back(Current.Child2);
+			}
+		}
+	}
+
+	void DynamicBVH::QueryFrustums(std::span<const Frustum> Frustums, std::vector<uint32_t>& OutObjects) const
+	{
+		if (m_Root == NullNode || Frustums.empty())
+			return;
+
+		std::vector<int32_t> Stack = { m_Root };
+		while (!Stack.empty())
+		{
+			const int32_t Index = Stack.back();
+			Stack.pop_back();
+			const Node& Current = m_Nodes[Index];
+
+			// Outside only if outside every frustum, inside as soon as one frustum holds the whole box
+			Containment Result = Containment::Outside;
+			for (const Frustum& ViewFrustum : Frustums)
+			{
+				const Containment Tested = ClassifyBox(ViewFrustum, Current.Box);
+				Result = Tested != Containment::Outside ? Tested : Result;
+				if (Result == Containment::Inside)
+					break;
+			}
+			if (Result == Containment::Outside)
+				continue;
+
+			if (Current.IsLeaf())
+			{
+				OutObjects.push_back(Current.ObjectIndex);
+			}
+			else if (Result == Containment::Inside)
+			{
+				CollectLeaves(Index, OutObjects);
+			}
+			else
+			{
+				Stack.push_back(Current.Child1);
+				Stack.push_back(Current.Child2);
+			}
+		}
+	}
+
+	void DynamicBVH::QueryBox(const BoundingBox& Box, std::vector<uint32_t>& OutObjects) const
+	{
+		if (m_Root == NullNode)
+			return;
+
+		std::vector<int32_t> Stack = { m_Root };
+		while (!Stack.empty())
+		{
+			const Node& Current = m_Nodes[Stack.back()];
+			Stack.pop_back();
+			if (!Overlaps(Current.Box, Box))
+				continue;
+
+			if (Current.IsLeaf())
+			{
+				OutObjects.push_back(Current.ObjectIndex);
+				continue;
+			}
+			Stack.push_back(Current.Child1);
+			Stack.push_back(Current.Child2);
+		}
+	}
+
+	void DynamicBVH::QuerySphere(const BoundingSphere& Sphere, std::vector<uint32_t>& OutObjects) const
+	{
+		if (m_Root == NullNode)
+			return;
+
+		std::vector<int32_t> Stack = { m_Root };
+		while (!Stack.empty())
+		{
+			const Node& Current = m_Nodes[Stack.back()];
+			Stack.pop_back();
+			if (!OverlapsSphere(Current.Box, Sphere))
+				continue;
+
+			if (Current.IsLeaf())
+			{
+				OutObjects.push_back(Current.ObjectIndex);
+				continue;
+			}
+			Stack.push_back(Current.Child1);
+			Stack.push_back(Current.Child2);
+		}
+	}
+
+	void DynamicBVH::QueryRay(const glm::vec3& Origin, const glm::vec3& Direction, float MaxDistance, std::vector<uint32_t>& OutObjects) const
+	{
+		if (m_Root == NullNode)
+			return;
+
+		const glm::vec3 InverseDirection = 1.0f / Direction;
+		std::vector<int32_t> Stack = { m_Root };
+		while (!Stack.empty())
+		{
+			const Node& Current = m_Nodes[Stack.back()];
+			Stack.pop_back();
+			if (!IntersectsRay(Current.Box, Origin, InverseDirection, MaxDistance))
+				continue;
+
+			if (Current.IsLeaf())
+			{
+				OutObjects.push_back(Current.ObjectIndex);
+				continue;
+			}
+			Stack.push_back(Current.Child1);
+			Stack.push_back(Current.Child2);
+		}
+	}
+
+} // namespace fgl
\ No newline at end of file
@@ -0,0 +1,326 @@
+#include <FireGL/Renderer/DynamicMesh.h>
+#include <FireGL/Renderer/Material.h>
+#include <FireGL/Renderer/GLStateCache.h>
+#include <FireGL/Renderer/GPUMemoryTracker.h>
+#include <FireGL/Renderer/RenderStats.h>
+#include <FireGL/Core/GLDebug.h>
+#include <FireGL/Core/BaseLog.h>
+
+#include <External/glm/mat3x3.hpp>
+#include <External/glm/gtc/type_ptr.hpp>
+
+namespace fgl
+{
+
+	namespace
+	{
+		/** @return The triangles Count elements of a primitive form. */
+		uint64_t CountTriangles(GLenum Primitive, uint32_t Count)
+		{
+			switch (Primitive)
+			{
+			case GL_TRIANGLES:
+				return Count / 3;
+			case GL_TRIANGLE_STRIP:
+			case GL_TRIANGLE_FAN:
+				return Count > 2 ? Count - 2 : 0;
+			default:
+				return 0;
+			}
+		}
+	}
+
+	DynamicMesh::~DynamicMesh()
+	{
+		Destroy();
+	}
+
+	void DynamicMesh::Create(uint32_t MaxVertices, GLenum Primitive)
+	{
+		Destroy();
+		LOG_ASSERT(MaxVertices > 0, "A dynamic mesh needs room for at least one vertex")
+
+		m_Capacity = MaxVertices;
+		m_Primitive = Primitive;
+		const GLsizeiptr BufferSize = static_cast<GLsizeiptr>(RegionCount * m_Capacity * sizeof(Vertex));
+
+		glGenVertexArrays(1, &m_VertexArray);
+		GLStateCache::BindVertexArray(m_VertexArray);
+		glGenBuffers(1, &m_VertexBuffer);
+		GLStateCache::BindBuffer(GL_ARRAY_BUFFER, m_VertexBuffer);
+
+		// Persistent mapping needs glBufferStorage (4.4), older contexts map every frame's range
+		m_bPersistent = GLAD_GL_VERSION_4_4;
+		if (m_bPersistent)
+		{
+			const GLbitfield Flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+			glBufferStorage(GL_ARRAY_BUFFER, BufferSize, nullptr, Flags);
+			m_Mapped = static_cast<Vertex*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, BufferSize, Flags));
+			LOG_ASSERT(m_Mapped, "Failed to map the dynamic mesh buffer")
+		}
+		else
+		{
+			glBufferData(GL_ARRAY_BUFFER, BufferSize, nullptr, GL_STREAM_DRAW);
+		}
+		GPUMemoryTracker::TrackBuffer(m_VertexBuffer, static_cast<size_t>(BufferSize), GPUMemoryCategory::Geometry, "Dynamic Mesh");
+
+		glEnableVertexAttribArray(0);
+		glEnableVertexAttribArray(1);
+		glEnableVertexAttribArray(2);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Position));
+		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Normal));
+		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, TexCoords));
+		FGL_GL_LABEL(GL_VERTEX_ARRAY, m_VertexArray, "Dynamic Mesh");
+	}
+
+	void DynamicMesh::Destroy()
+	{
+		for (GLsync& Fence : m_Fences)
+		{
+			if (Fence)
+			{
+				glDeleteSync(Fence);
+				Fence = nullptr;
+			}
+		}
+		if (m_VertexBuffer != 0)
+		{
+			if (m_Mapped)
+			{
+				GLStateCache::BindBuffer(GL_ARRAY_BUFFER, m_VertexBuffer);
+				glUnmapBuffer(GL_ARRAY_BUFFER);
+				m_Mapped = nullptr;
+			}
+			glDeleteBuffers(1, &m_VertexBuffer);
+			GLStateCache::OnBufferDeleted(m_VertexBuffer);
+			GPUMemoryTracker::UntrackBuffer(m_VertexBuffer);
+			m_VertexBuffer = 0;
+		}
+		if (m_IndexBuffer != 0)
+		{
+			glDeleteBuffers(1, &m_IndexBuffer);
+			GLStateCache::OnBufferDeleted(m_IndexBuffer);
+			GPUMemoryTracker::UntrackBuffer(m_IndexBuffer);
+			m_IndexBuffer = 0;
+		}
+		if (m_VertexArray != 0)
+		{
+			glDeleteVertexArrays(1, &m_VertexArray);
+			GLStateCache::OnVertexArrayDeleted(m_VertexArray);
+			m_VertexArray = 0;
+		}
+		m_Capacity = 0;
+		m_IndexCount = 0;
+		m_VertexCount = 0;
+		m_Writing = nullptr;
+		m_Region = 0;
+		m_bPublished = false;
+	}
+
+	bool DynamicMesh::IsCreated() const
+	{
+		return m_VertexArray != 0;
+	}
+
+	void DynamicMesh::SetIndices(const uint32_t* Indices, uint32_t Count)
+	{
+		LOG_ASSERT(IsCreated(), "Create the dynamic mesh before setting its indices")
+		GLStateCache::BindVertexArray(m_VertexArray);
+		if (!Indices || Count == 0)
+		{
+			if (m_IndexBuffer != 0)
+			{
+				GLStateCache::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+				glDeleteBuffers(1, &m_IndexBuffer);
+				GLStateCache::OnBufferDeleted(m_IndexBuffer);
+				GPUMemoryTracker::UntrackBuffer(m_IndexBuffer);
+				m_IndexBuffer = 0;
+			}
+			m_IndexCount = 0;
+			return;
+		}
+
+		if (m_IndexBuffer == 0)
+		{
+			glGenBuffers(1, &m_IndexBuffer);
+		}
+		GPUMemoryTracker::UntrackBuffer(m_IndexBuffer);
+		GLStateCache::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_IndexBuffer);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, Count * sizeof(uint32_t), Indices, GL_STATIC_DRAW);
+		GPUMemoryTracker::TrackBuffer(m_IndexBuffer, Count * sizeof(uint32_t), GPUMemoryCategory::Geometry, "Dynamic Mesh");
+		RenderCounters::CountUpload(Count * sizeof(uint32_t));
+		m_IndexCount = Count;
+	}
+
+	Vertex* DynamicMesh::Map(uint32_t First, uint32_t Count)
+	{
+		LOG_ASSERT(!m_Writing, "Unmap the dynamic mesh before mapping it again")
+		if (!IsCreated() || Count == 0 || First + Count > m_Capacity)
+			return nullptr;
+
+		// The region written three frames ago, its fence only blocks if the GPU didn't draw it yet
+		m_WriteRegion = m_bPublished ? (m_Region + 1) % RegionCount : 0;
+		WaitRegion(m_WriteRegion);
+
+		m_WriteFirst = First;
+		m_WriteCount = Count;
+		const size_t FirstVertex = m_WriteRegion * m_Capacity + First;
+		if (m_bPersistent)
+		{
+			m_Writing = m_Mapped + FirstVertex;
+		}
+		else
+		{
+			// Unsynchronized: the fence above already guarantees the GPU is done with the range
+			GLStateCache::BindBuffer(GL_ARRAY_BUFFER, m_VertexBuffer);
+			m_Writing = static_cast<Vertex*>(glMapBufferRange(GL_ARRAY_BUFFER, FirstVertex * sizeof(Vertex), Count * sizeof(Vertex),
+				GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
+		}
+		return m_Writing;
+	}
+
+	void DynamicMesh::Unmap()
+	{
+		if (!m_Writing)
+			return;
+
+		if (!m_bPersistent)
+		{
+			GLStateCache::BindBuffer(GL_ARRAY_BUFFER, m_VertexBuffer);
+			glUnmapBuffer(GL_ARRAY_BUFFER);
+		}
+		m_Writing = nullptr;
+		RenderCounters::CountUpload(m_WriteCount * sizeof(Vertex));
+
+		// The vertices kept from the previous frame are copied between regions on the GPU, never read back
+		if (m_bPublished)
+		{
+			const GLintptr Source = static_cast<GLintptr>(m_Region * m_Capacity * sizeof(Vertex));
+			const GLintptr Target = static_cast<GLintptr>(m_WriteRegion * m_Capacity * sizeof(Vertex));
+			const uint32_t WriteEnd = m_WriteFirst + m_WriteCount;
+			glBindBuffer(GL_COPY_READ_BUFFER, m_VertexBuffer);
+			if (m_WriteFirst > 0)
+			{
+				glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_READ_BUFFER, Source, Target, m_WriteFirst * sizeof(Vertex));
+			}
+			if (m_VertexCount > WriteEnd)
+			{
+				const GLintptr Offset = static_cast<GLintptr>(WriteEnd * sizeof(Vertex));
+				glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_READ_BUFFER, Source + Offset, Target + Offset, (m_VertexCount - WriteEnd) * sizeof(Vertex));
+			}
+
+			// The copies read the previous region after its last draw, they are what its next Map() waits for
+			GLsync& Fence = m_Fences[m_Region];
+			if (Fence)
+			{
+				glDeleteSync(Fence);
+			}
+			Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		}
+		m_VertexCount = std::max(m_VertexCount, m_WriteFirst + m_WriteCount);
+		m_Region = m_WriteRegion;
+		m_bPublished = true;
+	}
+
+	void DynamicMesh::SetDrawCount(uint32_t Count)
+	{
+		m_DrawCount = Count;
+		m_bDrawCountSet = true;
+	}
+
+	uint32_t DynamicMesh::GetDrawCount() const
+	{
+		const uint32_t Available = m_IndexCount > 0 ? m_IndexCount : m_VertexCount;
+		return m_bDrawCountSet ? std::min(m_DrawCount, m_IndexCount > 0 ? m_IndexCount : m_Capacity) : Available;
+	}
+
+	void DynamicMesh::SetMaterial(std::shared_ptr<Material> DrawMaterial)
+	{
+		m_Material = std::move(DrawMaterial);
+	}
+
+	const std::shared_ptr<Material>& DynamicMesh::GetMaterial() const
+	{
+		return m_Material;
+	}
+
+	void DynamicMesh::SetTransform(const glm::mat4& Model)
+	{
+		m_Transform = Model;
+	}
+
+	const glm::mat4& DynamicMesh::GetTransform() const
+	{
+		return m_Transform;
+	}
+
+	void DynamicMesh::Draw(const glm::mat4& Model, uint32_t MaterialIndex)
+	{
+		const uint32_t Count = GetDrawCount();
+		if (!m_bPublished || Count == 0)
+			return;
+
+		// The VAO only enables locations 0 to 2, the instance locations read these current values
+		const glm::mat3 Normal = glm::transpose(glm::inverse(glm::mat3(Model)));
+		for (int Column = 0; Column < 4; Column++)
+		{
+			glVertexAttrib4fv(3 + Column, glm::value_ptr(Model[Column]));
+		}
+		for (int Column = 0; Column < 3; Column++)
+		{
+			glVertexAttrib4f(7 + Column, Normal[Column].x, Normal[Column].y, Normal[Column].z, 0.0f);
+		}
+		glVertexAttribI4ui(10, 0, 0, 0, 0);
+		glVertexAttribI4ui(11, MaterialIndex, 0, 0, 0);
+		glVertexAttribI4ui(12, 0, 0, 0, 0);
+		glVertexAttrib4f(15, 0.0f, 0.0f, 0.0f, 0.0f);
+
+		GLStateCache::BindVertexArray(m_VertexArray);
+		const GLint BaseVertex = static_cast<GLint>(m_Region * m_Capacity);
+		if (m_IndexCount > 0)
+		{
+			glDrawElementsBaseVertex(m_Primitive, static_cast<GLsizei>(Count), GL_UNSIGNED_INT, nullptr, BaseVertex);
+		}
+		else
+		{
+			glDrawArrays(m_Primitive, BaseVertex, static_cast<GLsizei>(Count));
+		}
+		RenderCounters::CountDraw(1, CountTriangles(m_Primitive, Count));
+
+		// Replaces the fence of an earlier draw of the frame, the last draw is the one to wait for
+		GLsync& Fence = m_Fences[m_Region];
+		if (Fence)
+		{
+			glDeleteSync(Fence);
+		}
+		Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
+
+	void DynamicMesh::Render()
+	{
+		if (m_Material)
+		{
+			m_Material->Activate();
+		}
+		Draw(m_Transform, m_Material ? m_Material->GetID() : 0);
+	}
+
+	void DynamicMesh::WaitRegion(size_t Region)
+	{
+		GLsync& Fence = m_Fences[Region];
+		if (!Fence)
+			return;
+
+		// The GPU is usually two frames behind at most, the loop only spins when it is not
+		GLenum Result = glClientWaitSync(Fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+		while (Result == GL_TIMEOUT_EXPIRED)
+		{
+			Result = glClientWaitSync(Fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1'000'000);
+		}
+		LOG_ASSERT(Result != GL_WAIT_FAILED, "Failed waiting on a dynamic mesh fence")
+
+		glDeleteSync(Fence);
+		Fence = nullptr;
+	}
+
+} // namespace fgl
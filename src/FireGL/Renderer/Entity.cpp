@@ -5,10 +5,26 @@
 
 namespace fgl
 {
-	std::vector<BaseMesh>& Entity::GetMeshes()
+	Entity::~Entity()
+	{
+		for (uint32_t ID = 0; ID < m_Components.size(); ID++)
+		{
+			if (m_ComponentMask.test(ID))
+			{
+				ComponentPoolBase::Release(m_Components[ID]);
+			}
+		}
+	}
+
+	std::span<BaseMesh> Entity::GetMeshes()
 	{
 		return m_Object->GetMeshes();
 	}
+
+	std::span<const BaseMesh> Entity::GetMeshes() const
+	{
+		return std::as_const(*m_Object).GetMeshes();
+	}
 	size_t Entity::GetHash() const
 	{
 		return m_Object->GetHash();
@@ -17,6 +33,7 @@ namespace fgl
 	void Entity::SetMaterial(std::shared_ptr<Material> Material)
 	{
 		m_Object->SetMaterial(Material);
+		NotifyMaterialChanged();
 	}
 
 	const std::shared_ptr<Material> Entity::GetMaterial(size_t MeshIndex) const
@@ -24,29 +41,34 @@ namespace fgl
 		return m_Object->GetMaterial();
 	}
 
-	void Entity::Render(size_t NumberInstance) const
+	void Entity::Render(size_t NumberInstance, size_t BaseInstance, uint32_t LOD) const
 	{
 		OnPrepareRender();
-		m_Object->Render(NumberInstance);
+		m_Object->Render(NumberInstance, BaseInstance, LOD);
 		OnPostRender();
 	}
 
 	void Entity::Tick(float DeltaTime)
 	{
-		for (const auto& [Key, Component] : m_Components)
-		{
-			Component->OnTick(DeltaTime);
-		}
-
+		// Components are ticked beforehand by their pools, see Scene::Process()
 		m_Object->Tick(DeltaTime);
 		OnTick(DeltaTime);
 	};
 
+	bool Entity::IsTickThreadSafe() const
+	{
+		return IsOnTickThreadSafe() && m_Object->IsTickThreadSafe();
+	}
+
 	void Entity::BeginPlay()
 	{
-		for (const auto& [Key, Component] : m_Components)
+		for (uint32_t ID = 0; ID < m_Components.size(); ID++)
 		{
-			Component->OnBeginPlay();
+			if (m_ComponentMask.test(ID))
+			{
+				m_Components[ID]->SetScene(GetScene());
+				m_Components[ID]->OnBeginPlay();
+			}
 		}
 
 		m_Object->BeginPlay();
@@ -55,19 +77,50 @@ namespace fgl
 
 	void Entity::Destroy()
 	{
-		for (const auto& [Key, Component] : m_Components)
+		for (uint32_t ID = 0; ID < m_Components.size(); ID++)
 		{
-			Component->OnDestroyed();
+			if (m_ComponentMask.test(ID))
+			{
+				m_Components[ID]->OnDestroyed();
+				m_Components[ID]->SetScene(nullptr);
+			}
 		}
 
 		OnDestroyed();
 		m_Object->Destroy();
 	}
 
+	void Entity::OnOverlapBegin(SceneObject* Other)
+	{
+		for (uint32_t ID = 0; ID < m_Components.size(); ID++)
+		{
+			if (m_ComponentMask.test(ID))
+			{
+				m_Components[ID]->OnOverlapBegin(Other);
+			}
+		}
+	}
+
+	void Entity::OnOverlapEnd(SceneObject* Other)
+	{
+		for (uint32_t ID = 0; ID < m_Components.size(); ID++)
+		{
+			if (m_ComponentMask.test(ID))
+			{
+				m_Components[ID]->OnOverlapEnd(Other);
+			}
+		}
+	}
+
 	void Entity::OnTick(float DeltaTime)
 	{
 	}
 
+	bool Entity::IsOnTickThreadSafe() const
+	{
+		return false;
+	}
+
 	void Entity::OnBeginPlay()
 	{
 	}
@@ -86,7 +139,12 @@ namespace fgl
 
 	void Entity::RemoveComponent(size_t ID)
 	{
-		m_Components.erase(ID);
+		if (ID >= m_Components.size() || !m_ComponentMask.test(ID))
+			return;
+
+		ComponentPoolBase::Release(m_Components[ID]);
+		m_Components[ID] = nullptr;
+		m_ComponentMask.reset(ID);
 	}
 
 } // namespace fgl
\ No newline at end of file
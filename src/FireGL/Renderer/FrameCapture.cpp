@@ -0,0 +1,299 @@
+#include <FireGL/Renderer/FrameCapture.h>
+#include <FireGL/Core/BaseLog.h>
+#include <FireGL/Core/Profiler.h>
+
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+namespace fgl
+{
+
+	namespace
+	{
+		/** CRC-32 of PNG chunks, table-driven. */
+		uint32_t UpdateCrc(uint32_t Crc, const unsigned char* Data, size_t Size)
+		{
+			static const std::array<uint32_t, 256> Table = []() {
+				std::array<uint32_t, 256> Result{};
+				for (uint32_t Index = 0; Index < 256; Index++)
+				{
+					uint32_t Value = Index;
+					for (int Bit = 0; Bit < 8; Bit++)
+					{
+						Value = (Value & 1) ? 0xEDB88320u ^ (Value >> 1) : Value >> 1;
+					}
+					Result[Index] = Value;
+				}
+				return Result;
+			}();
+
+			for (size_t Index = 0; Index < Size; Index++)
+			{
+				Crc = Table[(Crc ^ Data[Index]) & 0xFF] ^ (Crc >> 8);
+			}
+			return Crc;
+		}
+
+		void AppendBigEndian(std::vector<unsigned char>& Out, uint32_t Value)
+		{
+			Out.push_back(static_cast<unsigned char>(Value >> 24));
+			Out.push_back(static_cast<unsigned char>(Value >> 16));
+			Out.push_back(static_cast<unsigned char>(Value >> 8));
+			Out.push_back(static_cast<unsigned char>(Value));
+		}
+
+		void AppendChunk(std::vector<unsigned char>& Out, const char* Type, const std::vector<unsigned char>& Data)
+		{
+			AppendBigEndian(Out, static_cast<uint32_t>(Data.size()));
+			const size_t TypeOffset = Out.size();
+			Out.insert(Out.end(), Type, Type + 4);
+			Out.insert(Out.end(), Data.begin(), Data.end());
+			const uint32_t Crc = UpdateCrc(0xFFFFFFFFu, Out.data() + TypeOffset, 4 + Data.size()) ^ 0xFFFFFFFFu;
+			AppendBigEndian(Out, Crc);
+		}
+
+		/**
+		 * Writes top-down RGBA8 rows as a PNG. The image data is stored in uncompressed deflate blocks: encoding
+		 * stays a copy, cheap enough to keep up with recordings, at the cost of larger files.
+		 */
+		bool WritePng(const std::string& Path, const unsigned char* Pixels, int Width, int Height)
+		{
+			const size_t RowSize = static_cast<size_t>(Width) * 4;
+
+			// Every row starts with filter type 0 (none)
+			std::vector<unsigned char> Raw;
+			Raw.reserve((RowSize + 1) * Height);
+			for (int Row = 0; Row < Height; Row++)
+			{
+				Raw.push_back(0);
+				Raw.insert(Raw.end(), Pixels + Row * RowSize, Pixels + (Row + 1) * RowSize);
+			}
+
+			std::vector<unsigned char> Zlib = { 0x78, 0x01 };
+			Zlib.reserve(Raw.size() + Raw.size() / 65535 * 5 + 16);
+			uint32_t AdlerA = 1, AdlerB = 0;
+			for (size_t Offset = 0; Offset < Raw.size() || Offset == 0; )
+			{
+				const size_t BlockSize = std::min<size_t>(Raw.size() - Offset, 65535);
+				const bool bFinal = Offset + BlockSize >= Raw.size();
+				Zlib.push_back(bFinal ? 1 : 0);
+				Zlib.push_back(static_cast<unsigned char>(BlockSize));
+				Zlib.push_back(static_cast<unsigned char>(BlockSize >> 8));
+				Zlib.push_back(static_cast<unsigned char>(~BlockSize));
+				Zlib.push_back(static_cast<unsigned char>(~BlockSize >> 8));
+				for (size_t Index = Offset; Index < Offset + BlockSize; Index++)
+				{
+					AdlerA = (AdlerA + Raw[Index]) % 65521;
+					AdlerB = (AdlerB + AdlerA) % 65521;
+				}
+				Zlib.insert(Zlib.end(), Raw.begin() + Offset, Raw.begin() + Offset + BlockSize);
+				Offset += BlockSize;
+				if (bFinal)
+					break;
+			}
+			AppendBigEndian(Zlib, (AdlerB << 16) | AdlerA);
+
+			std::vector<unsigned char> Header;
+			AppendBigEndian(Header, static_cast<uint32_t>(Width));
+			AppendBigEndian(Header, static_cast<uint32_t>(Height));
+			Header.insert(Header.end(), { 8, 6, 0, 0, 0 }); // 8 bits per channel, RGBA, no interlacing
+
+			std::vector<unsigned char> File = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+			AppendChunk(File, "IHDR", Header);
+			AppendChunk(File, "IDAT", Zlib);
+			AppendChunk(File, "IEND", {});
+
+			std::ofstream Stream(Path, std::ios::binary);
+			Stream.write(reinterpret_cast<const char*>(File.data()), static_cast<std::streamsize>(File.size()));
+			return static_cast<bool>(Stream);
+		}
+
+		/** Reverses the row order in place, OpenGL reads the bottom row first. */
+		void FlipRows(std::vector<unsigned char>& Pixels, int Width, int Height)
+		{
+			const size_t RowSize = static_cast<size_t>(Width) * 4;
+			std::vector<unsigned char> Swap(RowSize);
+			for (int Row = 0; Row < Height / 2; Row++)
+			{
+				unsigned char* Top = Pixels.data() + Row * RowSize;
+				unsigned char* Bottom = Pixels.data() + (Height - 1 - Row) * RowSize;
+				std::memcpy(Swap.data(), Top, RowSize);
+				std::memcpy(Top, Bottom, RowSize);
+				std::memcpy(Bottom, Swap.data(), RowSize);
+			}
+		}
+	}
+
+	FrameCapture::FrameCapture()
+		: m_Readback([this](const ReadbackFrame& Frame) { OnFrameRead(Frame); })
+	{
+	}
+
+	FrameCapture::~FrameCapture()
+	{
+		if (!m_InFlight.empty())
+		{
+			m_Readback.Flush();
+		}
+
+		if (m_Encoder.joinable())
+		{
+			{
+				std::lock_guard<std::mutex> Lock(m_EncoderMutex);
+				m_bStopping = true;
+			}
+			m_EncoderCondition.notify_all();
+			m_Encoder.join();
+		}
+	}
+
+	void FrameCapture::CaptureScreenshot(std::string_view Path)
+	{
+		std::lock_guard<std::mutex> Lock(m_RequestMutex);
+		m_Screenshots.emplace_back(Path);
+	}
+
+	void FrameCapture::StartRecording(Sink FrameSink)
+	{
+		std::lock_guard<std::mutex> Lock(m_RequestMutex);
+		m_RecordingSink = std::move(FrameSink);
+	}
+
+	bool FrameCapture::StartRecording(std::string_view Path)
+	{
+		std::FILE* File = std::fopen(std::string(Path).c_str(), "wb");
+		if (!File)
+		{
+			LOG_ERROR("Failed to open " + std::string(Path) + " to record frames.", false);
+			return false;
+		}
+
+		// The sink owns the file, the last frame captured with it closes it
+		std::shared_ptr<std::FILE> Output(File, std::fclose);
+		StartRecording([Output](const CapturedFrame& Frame) {
+			std::fwrite(Frame.Pixels.data(), 1, Frame.Pixels.size(), Output.get());
+		});
+		return true;
+	}
+
+	void FrameCapture::StopRecording()
+	{
+		std::lock_guard<std::mutex> Lock(m_RequestMutex);
+		m_RecordingSink = nullptr;
+	}
+
+	bool FrameCapture::IsRecording() const
+	{
+		std::lock_guard<std::mutex> Lock(m_RequestMutex);
+		return static_cast<bool>(m_RecordingSink);
+	}
+
+	void FrameCapture::EndFrame(GLuint Framebuffer, int Width, int Height)
+	{
+		std::vector<std::string> Screenshots;
+		Sink RecordingSink;
+		{
+			std::lock_guard<std::mutex> Lock(m_RequestMutex);
+			Screenshots.swap(m_Screenshots);
+			RecordingSink = m_RecordingSink;
+		}
+
+		if (!Screenshots.empty() || RecordingSink)
+		{
+			FGL_PROFILE_SCOPE("FrameCapture::EndFrame")
+
+			// One copy serves every request of the frame, each is delivered as its own capture
+			m_InFlight.push_back({ std::move(Screenshots), std::move(RecordingSink) });
+			m_Readback.Capture(Framebuffer, Width, Height, m_FrameIndex);
+		}
+		if (!m_InFlight.empty())
+		{
+			m_Readback.Collect();
+		}
+		m_FrameIndex++;
+	}
+
+	void FrameCapture::Flush()
+	{
+		m_Readback.Flush();
+
+		std::unique_lock<std::mutex> Lock(m_EncoderMutex);
+		m_EncoderCondition.wait(Lock, [this]() { return m_Jobs.empty() && m_ActiveJobs == 0; });
+	}
+
+	void FrameCapture::OnFrameRead(const ReadbackFrame& Frame)
+	{
+		PendingCapture Capture = std::move(m_InFlight.front());
+		m_InFlight.pop_front();
+
+		const size_t Size = static_cast<size_t>(Frame.Width) * Frame.Height * 4;
+		const size_t JobCount = Capture.Screenshots.size() + (Capture.FrameSink ? 1 : 0);
+		std::vector<EncodeJob> Jobs(JobCount);
+		for (size_t Index = 0; Index < JobCount; Index++)
+		{
+			EncodeJob& Job = Jobs[Index];
+			Job.Frame.Pixels.assign(Frame.Pixels, Frame.Pixels + Size);
+			Job.Frame.Width = Frame.Width;
+			Job.Frame.Height = Frame.Height;
+			Job.Frame.FrameIndex = Frame.Tag;
+			if (Index < Capture.Screenshots.size())
+			{
+				Job.Path = std::move(Capture.Screenshots[Index]);
+			}
+			else
+			{
+				Job.FrameSink = Capture.FrameSink;
+			}
+		}
+
+		{
+			std::lock_guard<std::mutex> Lock(m_EncoderMutex);
+			if (!m_Encoder.joinable())
+			{
+				m_Encoder = std::thread(&FrameCapture::RunEncoder, this);
+			}
+			for (EncodeJob& Job : Jobs)
+			{
+				m_Jobs.push_back(std::move(Job));
+			}
+		}
+		m_EncoderCondition.notify_all();
+	}
+
+	void FrameCapture::RunEncoder()
+	{
+		while (true)
+		{
+			EncodeJob Job;
+			{
+				std::unique_lock<std::mutex> Lock(m_EncoderMutex);
+				m_EncoderCondition.wait(Lock, [this]() { return !m_Jobs.empty() || m_bStopping; });
+				if (m_Jobs.empty())
+					break;
+
+				Job = std::move(m_Jobs.front());
+				m_Jobs.pop_front();
+				m_ActiveJobs++;
+			}
+
+			FlipRows(Job.Frame.Pixels, Job.Frame.Width, Job.Frame.Height);
+			if (Job.FrameSink)
+			{
+				Job.FrameSink(Job.Frame);
+			}
+			else if (!WritePng(Job.Path, Job.Frame.Pixels.data(), Job.Frame.Width, Job.Frame.Height))
+			{
+				LOG_ERROR("Failed to write the screenshot " + Job.Path + ".", false);
+			}
+
+			{
+				std::lock_guard<std::mutex> Lock(m_EncoderMutex);
+				m_ActiveJobs--;
+			}
+			m_EncoderCondition.notify_all();
+		}
+	}
+
+} // namespace fgl
@@ -0,0 +1,181 @@
+#include <FireGL/Renderer/FrameReadback.h>
+#include <FireGL/Core/BaseLog.h>
+#include <FireGL/Core/Profiler.h>
+#include <FireGL/Renderer/GLStateCache.h>
+#include <FireGL/Renderer/GPUMemoryTracker.h>
+
+namespace fgl
+{
+
+	FrameReadback::FrameReadback(Callback OnFrame, size_t Depth)
+		: m_OnFrame(std::move(OnFrame))
+		, m_Slots(std::max<size_t>(Depth, 1))
+	{
+	}
+
+	FrameReadback::~FrameReadback()
+	{
+		Destroy();
+	}
+
+	void FrameReadback::Capture(GLuint Framebuffer, int Width, int Height, uint64_t Tag)
+	{
+		FGL_PROFILE_SCOPE("FrameReadback::Capture")
+		if (Width <= 0 || Height <= 0)
+			return;
+
+		if (m_PendingCount == m_Slots.size())
+		{
+			DeliverOldest(true);
+		}
+
+		Slot& Target = m_Slots[(m_Oldest + m_PendingCount) % m_Slots.size()];
+		const size_t Size = static_cast<size_t>(Width) * Height * 4;
+		if (Target.Capacity < Size)
+		{
+			AllocateBuffer(Target, Size);
+		}
+
+		GLint ReadFramebuffer = 0;
+		glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &ReadFramebuffer);
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, Framebuffer);
+		glReadBuffer(Framebuffer == 0 ? GL_BACK : GL_COLOR_ATTACHMENT0);
+
+		// With a pack buffer bound the pointer is an offset, the call returns once the copy is queued
+		GLStateCache::BindBuffer(GL_PIXEL_PACK_BUFFER, Target.Buffer);
+		glPixelStorei(GL_PACK_ALIGNMENT, 4);
+		glReadPixels(0, 0, Width, Height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+		GLStateCache::BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, ReadFramebuffer);
+
+		Target.Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		Target.Width = Width;
+		Target.Height = Height;
+		Target.Tag = Tag;
+		m_PendingCount++;
+	}
+
+	size_t FrameReadback::Collect()
+	{
+		size_t Delivered = 0;
+		while (m_PendingCount > 0 && DeliverOldest(false))
+		{
+			Delivered++;
+		}
+		return Delivered;
+	}
+
+	void FrameReadback::Flush()
+	{
+		FGL_PROFILE_SCOPE("FrameReadback::Flush")
+		while (m_PendingCount > 0)
+		{
+			DeliverOldest(true);
+		}
+	}
+
+	size_t FrameReadback::GetPendingCount() const
+	{
+		return m_PendingCount;
+	}
+
+	void FrameReadback::Destroy()
+	{
+		for (Slot& Target : m_Slots)
+		{
+			if (Target.Fence)
+			{
+				glDeleteSync(Target.Fence);
+			}
+			DestroyBuffer(Target);
+			Target = Slot();
+		}
+		m_Oldest = 0;
+		m_PendingCount = 0;
+	}
+
+	bool FrameReadback::DeliverOldest(bool bWait)
+	{
+		Slot& Oldest = m_Slots[m_Oldest];
+		const GLenum Status = glClientWaitSync(Oldest.Fence, GL_SYNC_FLUSH_COMMANDS_BIT, bWait ? GL_TIMEOUT_IGNORED : 0);
+		if (Status != GL_ALREADY_SIGNALED && Status != GL_CONDITION_SATISFIED)
+			return false;
+
+		glDeleteSync(Oldest.Fence);
+		Oldest.Fence = nullptr;
+
+		const size_t Size = static_cast<size_t>(Oldest.Width) * Oldest.Height * 4;
+		ReadbackFrame Frame;
+		Frame.Width = Oldest.Width;
+		Frame.Height = Oldest.Height;
+		Frame.Tag = Oldest.Tag;
+		if (Oldest.Mapped)
+		{
+			Frame.Pixels = static_cast<const unsigned char*>(Oldest.Mapped);
+			m_OnFrame(Frame);
+		}
+		else
+		{
+			GLStateCache::BindBuffer(GL_PIXEL_PACK_BUFFER, Oldest.Buffer);
+			Frame.Pixels = static_cast<const unsigned char*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, Size, GL_MAP_READ_BIT));
+			if (Frame.Pixels)
+			{
+				m_OnFrame(Frame);
+				glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+			}
+			else
+			{
+				LOG_ERROR("Failed to map a frame readback buffer, the frame is dropped.", false);
+			}
+			GLStateCache::BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		}
+
+		m_Oldest = (m_Oldest + 1) % m_Slots.size();
+		m_PendingCount--;
+		return true;
+	}
+
+	void FrameReadback::AllocateBuffer(Slot& Target, size_t Size)
+	{
+		// Immutable storage can't be respecified, replace the buffer object
+		DestroyBuffer(Target);
+
+		glGenBuffers(1, &Target.Buffer);
+		GLStateCache::BindBuffer(GL_PIXEL_PACK_BUFFER, Target.Buffer);
+		if (GLAD_GL_VERSION_4_4)
+		{
+			// Client storage keeps the buffer in memory the CPU reads quickly
+			const GLbitfield Flags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+			glBufferStorage(GL_PIXEL_PACK_BUFFER, Size, nullptr, Flags | GL_CLIENT_STORAGE_BIT);
+			Target.Mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, Size, Flags);
+			LOG_ASSERT(Target.Mapped, "Failed to persistently map a frame readback buffer");
+		}
+		else
+		{
+			glBufferData(GL_PIXEL_PACK_BUFFER, Size, nullptr, GL_STREAM_READ);
+		}
+		GLStateCache::BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		Target.Capacity = Size;
+		GPUMemoryTracker::TrackBuffer(Target.Buffer, Size, GPUMemoryCategory::Staging, "FrameReadback");
+	}
+
+	void FrameReadback::DestroyBuffer(Slot& Target)
+	{
+		if (Target.Buffer == 0)
+			return;
+
+		if (Target.Mapped)
+		{
+			GLStateCache::BindBuffer(GL_PIXEL_PACK_BUFFER, Target.Buffer);
+			glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+			GLStateCache::BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		}
+		glDeleteBuffers(1, &Target.Buffer);
+		GLStateCache::OnBufferDeleted(Target.Buffer);
+		GPUMemoryTracker::UntrackBuffer(Target.Buffer);
+		Target.Buffer = 0;
+		Target.Capacity = 0;
+		Target.Mapped = nullptr;
+	}
+
+} // namespace fgl
@@ -0,0 +1,49 @@
+#include <FireGL/Renderer/Frustum.h>
+
+#include <External/glm/geometric.hpp>
+#include <External/glm/matrix.hpp>
+
+namespace fgl
+{
+
+	Frustum::Frustum()
+	{
+		m_Planes.fill(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+	}
+
+	Frustum::Frustum(const glm::mat4& ViewProjection)
+	{
+		// Gribb-Hartmann extraction, glm is column-major so the rows are read through the transpose
+		const glm::mat4 Rows = glm::transpose(ViewProjection);
+
+		m_Planes[Left]   = Rows[3] + Rows[0];
+		m_Planes[Right]  = Rows[3] - Rows[0];
+		m_Planes[Bottom] = Rows[3] + Rows[1];
+		m_Planes[Top]    = Rows[3] - Rows[1];
+		m_Planes[Near]   = Rows[3] + Rows[2];
+		m_Planes[Far]    = Rows[3] - Rows[2];
+
+		for (glm::vec4& Plane : m_Planes)
+		{
+			Plane /= glm::length(glm::vec3(Plane));
+		}
+	}
+
+	bool Frustum::IsVisible(const BoundingSphere& Sphere) const
+	{
+		for (const glm::vec4& Plane : m_Planes)
+		{
+			if (glm::dot(glm::vec3(Plane), Sphere.Center) + Plane.w < -Sphere.Radius)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	const std::array<glm::vec4, Frustum::PlaneCount>& Frustum::GetPlanes() const
+	{
+		return m_Planes;
+	}
+
+} // namespace fgl
\ No newline at end of file
@@ -0,0 +1,127 @@
+#include <FireGL/Renderer/FrustumCulling.h>
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+	#include <immintrin.h>
+	#define FGL_CULL_SSE 1
+#elif (defined(__ARM_NEON) && defined(__aarch64__)) || defined(_M_ARM64)
+	#include <arm_neon.h>
+	#define FGL_CULL_NEON 1
+#endif
+
+namespace fgl
+{
+
+	namespace
+	{
+		/** Scalar test of a single sphere, used for the tail of the arrays. */
+		bool IsSphereVisible(const std::array<glm::vec4, Frustum::PlaneCount>& Planes, float X, float Y, float Z, float Radius)
+		{
+			for (const glm::vec4& Plane : Planes)
+			{
+				if (Plane.x * X + Plane.y * Y + Plane.z * Z + Plane.w < -Radius)
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		/** Appends the indices of the set bits of Mask, offset by Base. */
+		void AppendVisible(uint32_t Mask, uint32_t Base, std::vector<uint32_t>& OutVisibleIndices)
+		{
+			while (Mask)
+			{
+				uint32_t Bit = 0;
+				while (!(Mask & (1u << Bit)))
+				{
+					Bit++;
+				}
+				OutVisibleIndices.push_back(Base + Bit);
+				Mask &= Mask - 1;
+			}
+		}
+	}
+
+	void CullSpheres(const Frustum& ViewFrustum, const BoundingSphereArrays& Spheres, std::vector<uint32_t>& OutVisibleIndices)
+	{
+		const std::array<glm::vec4, Frustum::PlaneCount>& Planes = ViewFrustum.GetPlanes();
+		const size_t Count = Spheres.Size();
+		const float* X = Spheres.X.data();
+		const float* Y = Spheres.Y.data();
+		const float* Z = Spheres.Z.data();
+		const float* R = Spheres.Radius.data();
+
+		OutVisibleIndices.clear();
+		OutVisibleIndices.reserve(Count);
+		size_t Index = 0;
+
+#if defined(__AVX2__)
+		for (; Index + 8 <= Count; Index += 8)
+		{
+			const __m256 SX = _mm256_loadu_ps(X + Index);
+			const __m256 SY = _mm256_loadu_ps(Y + Index);
+			const __m256 SZ = _mm256_loadu_ps(Z + Index);
+			const __m256 NegR = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(R + Index));
+
+			__m256 Inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+			for (const glm::vec4& Plane : Planes)
+			{
+				__m256 Distance = _mm256_fmadd_ps(SX, _mm256_set1_ps(Plane.x), _mm256_set1_ps(Plane.w));
+				Distance = _mm256_fmadd_ps(SY, _mm256_set1_ps(Plane.y), Distance);
+				Distance = _mm256_fmadd_ps(SZ, _mm256_set1_ps(Plane.z), Distance);
+				Inside = _mm256_and_ps(Inside, _mm256_cmp_ps(Distance, NegR, _CMP_GE_OQ));
+			}
+			AppendVisible(static_cast<uint32_t>(_mm256_movemask_ps(Inside)), static_cast<uint32_t>(Index), OutVisibleIndices);
+		}
+#endif
+
+#if defined(FGL_CULL_SSE)
+		for (; Index + 4 <= Count; Index += 4)
+		{
+			const __m128 SX = _mm_loadu_ps(X + Index);
+			const __m128 SY = _mm_loadu_ps(Y + Index);
+			const __m128 SZ = _mm_loadu_ps(Z + Index);
+			const __m128 NegR = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(R + Index));
+
+			__m128 Inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+			for (const glm::vec4& Plane : Planes)
+			{
+				__m128 Distance = _mm_add_ps(_mm_mul_ps(SX, _mm_set1_ps(Plane.x)), _mm_set1_ps(Plane.w));
+				Distance = _mm_add_ps(_mm_mul_ps(SY, _mm_set1_ps(Plane.y)), Distance);
+				Distance = _mm_add_ps(_mm_mul_ps(SZ, _mm_set1_ps(Plane.z)), Distance);
+				Inside = _mm_and_ps(Inside, _mm_cmpge_ps(Distance, NegR));
+			}
+			AppendVisible(static_cast<uint32_t>(_mm_movemask_ps(Inside)), static_cast<uint32_t>(Index), OutVisibleIndices);
+		}
+#elif defined(FGL_CULL_NEON)
+		const uint32_t LaneBits[4] = { 1u, 2u, 4u, 8u };
+		const uint32x4_t LaneMask = vld1q_u32(LaneBits);
+		for (; Index + 4 <= Count; Index += 4)
+		{
+			const float32x4_t SX = vld1q_f32(X + Index);
+			const float32x4_t SY = vld1q_f32(Y + Index);
+			const float32x4_t SZ = vld1q_f32(Z + Index);
+			const float32x4_t NegR = vnegq_f32(vld1q_f32(R + Index));
+
+			uint32x4_t Inside = vdupq_n_u32(0xFFFFFFFFu);
+			for (const glm::vec4& Plane : Planes)
+			{
+				float32x4_t Distance = vmlaq_n_f32(vdupq_n_f32(Plane.w), SX, Plane.x);
+				Distance = vmlaq_n_f32(Distance, SY, Plane.y);
+				Distance = vmlaq_n_f32(Distance, SZ, Plane.z);
+				Inside = vandq_u32(Inside, vcgeq_f32(Distance, NegR));
+			}
+			AppendVisible(vaddvq_u32(vandq_u32(Inside, LaneMask)), static_cast<uint32_t>(Index), OutVisibleIndices);
+		}
+#endif
+
+		for (; Index < Count; Index++)
+		{
+			if (IsSphereVisible(Planes, X[Index], Y[Index], Z[Index], R[Index]))
+			{
+				OutVisibleIndices.push_back(static_cast<uint32_t>(Index));
+			}
+		}
+	}
+
+} // namespace fgl
\ No newline at end of file
@@ -0,0 +1,118 @@
+#include <FireGL/Renderer/GBuffer.h>
+#include <FireGL/Renderer/Shader.h>
+#include <FireGL/Renderer/GLStateCache.h>
+#include <FireGL/Renderer/GPUMemoryTracker.h>
+#include <FireGL/Renderer/RenderStats.h>
+#include <FireGL/Core/BaseLog.h>
+
+namespace fgl
+{
+
+	GBuffer::~GBuffer()
+	{
+		Destroy();
+	}
+
+	void GBuffer::Resize(int Width, int Height)
+	{
+		if (m_Framebuffer != 0 && Width == m_Width && Height == m_Height)
+			return;
+
+		Destroy();
+		m_Width = Width;
+		m_Height = Height;
+
+		m_AlbedoSpecular = CreateAttachment(GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE);
+		m_NormalRoughness = CreateAttachment(GL_RGB10_A2, GL_RGBA, GL_UNSIGNED_INT_2_10_10_10_REV);
+		m_Depth = CreateAttachment(GL_DEPTH24_STENCIL8, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8);
+
+		glGenFramebuffers(1, &m_Framebuffer);
+		glBindFramebuffer(GL_FRAMEBUFFER, m_Framebuffer);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_AlbedoSpecular, 0);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, m_NormalRoughness, 0);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, m_Depth, 0);
+
+		const GLenum DrawBuffers[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+		glDrawBuffers(2, DrawBuffers);
+		LOG_ASSERT(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE, "G-buffer framebuffer is incomplete");
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+		glGenVertexArrays(1, &m_FullScreenVertexArray);
+	}
+
+	GLuint GBuffer::CreateAttachment(GLenum InternalFormat, GLenum Format, GLenum Type) const
+	{
+		GLuint Texture;
+		glGenTextures(1, &Texture);
+		GLStateCache::BindTexture(GL_TEXTURE_2D, Texture);
+		glTexImage2D(GL_TEXTURE_2D, 0, InternalFormat, m_Width, m_Height, 0, Format, Type, nullptr);
+		GPUMemoryTracker::TrackTexture(Texture, GPUMemoryTracker::GetTextureSize(InternalFormat, m_Width, m_Height), GPUMemoryCategory::RenderTargets, "GBuffer");
+
+		// Sampled at pixel centers, one texel per pixel
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		return Texture;
+	}
+
+	void GBuffer::Destroy()
+	{
+		if (m_Framebuffer == 0)
+			return;
+
+		glDeleteFramebuffers(1, &m_Framebuffer);
+		m_Framebuffer = 0;
+
+		for (GLuint* Texture : { &m_AlbedoSpecular, &m_NormalRoughness, &m_Depth })
+		{
+			glDeleteTextures(1, Texture);
+			GLStateCache::OnTextureDeleted(*Texture);
+			GPUMemoryTracker::UntrackTexture(*Texture);
+			*Texture = 0;
+		}
+
+		glDeleteVertexArrays(1, &m_FullScreenVertexArray);
+		GLStateCache::OnVertexArrayDeleted(m_FullScreenVertexArray);
+		m_FullScreenVertexArray = 0;
+	}
+
+	void GBuffer::BindForGeometry() const
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, m_Framebuffer);
+		glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	}
+
+	void GBuffer::Resolve(const Shader& LightingShader, GLuint Framebuffer) const
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, Framebuffer);
+
+		GLStateCache::BindTextureUnit(AlbedoSpecularUnit, GL_TEXTURE_2D, m_AlbedoSpecular);
+		GLStateCache::BindTextureUnit(NormalRoughnessUnit, GL_TEXTURE_2D, m_NormalRoughness);
+		GLStateCache::BindTextureUnit(DepthUnit, GL_TEXTURE_2D, m_Depth);
+
+		LightingShader.Activate();
+		LightingShader.SetInt("gAlbedoSpecular", AlbedoSpecularUnit);
+		LightingShader.SetInt("gNormalRoughness", NormalRoughnessUnit);
+		LightingShader.SetInt("gDepth", DepthUnit);
+
+		// Every pixel is written, the surface depth is copied through gl_FragDepth
+		GLStateCache::SetDepthFunc(GL_ALWAYS);
+		GLStateCache::BindVertexArray(m_FullScreenVertexArray);
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+		RenderCounters::CountDraw(1, 1);
+		GLStateCache::SetDepthFunc(GL_LESS);
+	}
+
+	int GBuffer::GetWidth() const
+	{
+		return m_Width;
+	}
+
+	int GBuffer::GetHeight() const
+	{
+		return m_Height;
+	}
+
+} // namespace fgl
\ No newline at end of file
@@ -0,0 +1,183 @@
+#include <FireGL/Renderer/GLExtensions.h>
+
+#include <External/GLFW/glfw3.h>
+
+#include <unordered_set>
+
+namespace fgl
+{
+
+	namespace
+	{
+		using GetTextureHandleProc = GLuint64 (APIENTRYP)(GLuint Texture);
+		using TextureHandleResidencyProc = void (APIENTRYP)(GLuint64 Handle);
+		using MaxShaderCompilerThreadsProc = void (APIENTRYP)(GLuint Count);
+		using SpecializeShaderProc = void (APIENTRYP)(GLuint Shader, const GLchar* EntryPoint, GLuint ConstantCount, const GLuint* ConstantIndices, const GLuint* ConstantValues);
+		using TexStorage2DProc = void (APIENTRYP)(GLenum Target, GLsizei LevelCount, GLenum InternalFormat, GLsizei Width, GLsizei Height);
+		using TexPageCommitmentProc = void (APIENTRYP)(GLenum Target, GLint Level, GLint X, GLint Y, GLint Z, GLsizei Width, GLsizei Height, GLsizei Depth, GLboolean Commit);
+
+		GetTextureHandleProc s_GetTextureHandle = nullptr;
+		TextureHandleResidencyProc s_MakeTextureHandleResident = nullptr;
+		TextureHandleResidencyProc s_MakeTextureHandleNonResident = nullptr;
+		MaxShaderCompilerThreadsProc s_MaxShaderCompilerThreads = nullptr;
+		TexPageCommitmentProc s_TexPageCommitment = nullptr;
+		TexStorage2DProc s_TexStorage2D = nullptr;
+		SpecializeShaderProc s_SpecializeShader = nullptr;
+
+		std::unordered_set<std::string> LoadExtensionList()
+		{
+			std::unordered_set<std::string> Extensions;
+			GLint Count = 0;
+			glGetIntegerv(GL_NUM_EXTENSIONS, &Count);
+			for (GLint i = 0; i < Count; i++)
+			{
+				if (const char* Extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i)))
+				{
+					Extensions.insert(Extension);
+				}
+			}
+			return Extensions;
+		}
+
+		bool LoadBindlessTexture()
+		{
+			if (!GLExtensions::Has("GL_ARB_bindless_texture"))
+				return false;
+
+			s_GetTextureHandle = reinterpret_cast<GetTextureHandleProc>(glfwGetProcAddress("glGetTextureHandleARB"));
+			s_MakeTextureHandleResident = reinterpret_cast<TextureHandleResidencyProc>(glfwGetProcAddress("glMakeTextureHandleResidentARB"));
+			s_MakeTextureHandleNonResident = reinterpret_cast<TextureHandleResidencyProc>(glfwGetProcAddress("glMakeTextureHandleNonResidentARB"));
+			return s_GetTextureHandle && s_MakeTextureHandleResident && s_MakeTextureHandleNonResident;
+		}
+
+		bool LoadParallelShaderCompile()
+		{
+			if (GLExtensions::Has("GL_KHR_parallel_shader_compile"))
+			{
+				s_MaxShaderCompilerThreads = reinterpret_cast<MaxShaderCompilerThreadsProc>(glfwGetProcAddress("glMaxShaderCompilerThreadsKHR"));
+			}
+			else if (GLExtensions::Has("GL_ARB_parallel_shader_compile"))
+			{
+				s_MaxShaderCompilerThreads = reinterpret_cast<MaxShaderCompilerThreadsProc>(glfwGetProcAddress("glMaxShaderCompilerThreadsARB"));
+			}
+			return s_MaxShaderCompilerThreads != nullptr;
+		}
+
+		bool LoadSparseTexture()
+		{
+			if (!GLAD_GL_VERSION_4_2 || !GLExtensions::Has("GL_ARB_sparse_texture"))
+				return false;
+
+			s_TexPageCommitment = reinterpret_cast<TexPageCommitmentProc>(glfwGetProcAddress("glTexPageCommitmentARB"));
+			return s_TexPageCommitment != nullptr;
+		}
+
+		bool LoadTextureStorage()
+		{
+			// The extension's functions have the core names, the generated loader only loads them from OpenGL 4.2
+			if (GLAD_GL_VERSION_4_2)
+			{
+				s_TexStorage2D = glTexStorage2D;
+			}
+			else if (GLExtensions::Has("GL_ARB_texture_storage"))
+			{
+				s_TexStorage2D = reinterpret_cast<TexStorage2DProc>(glfwGetProcAddress("glTexStorage2D"));
+			}
+			return s_TexStorage2D != nullptr;
+		}
+
+		bool LoadSPIRV()
+		{
+			if (GLAD_GL_VERSION_4_6)
+			{
+				s_SpecializeShader = glSpecializeShader;
+			}
+			else if (GLExtensions::Has("GL_ARB_gl_spirv"))
+			{
+				s_SpecializeShader = reinterpret_cast<SpecializeShaderProc>(glfwGetProcAddress("glSpecializeShaderARB"));
+			}
+			return s_SpecializeShader != nullptr;
+		}
+	}
+
+	bool GLExtensions::Has(std::string_view Name)
+	{
+		static const std::unordered_set<std::string> Extensions = LoadExtensionList();
+		return Extensions.find(std::string(Name)) != Extensions.end();
+	}
+
+	bool GLExtensions::HasBindlessTexture()
+	{
+		static const bool bSupported = LoadBindlessTexture();
+		return bSupported;
+	}
+
+	GLuint64 GLExtensions::GetTextureHandle(GLuint Texture)
+	{
+		return s_GetTextureHandle(Texture);
+	}
+
+	void GLExtensions::MakeTextureHandleResident(GLuint64 Handle)
+	{
+		s_MakeTextureHandleResident(Handle);
+	}
+
+	void GLExtensions::MakeTextureHandleNonResident(GLuint64 Handle)
+	{
+		s_MakeTextureHandleNonResident(Handle);
+	}
+
+	bool GLExtensions::HasParallelShaderCompile()
+	{
+		static const bool bSupported = LoadParallelShaderCompile();
+		return bSupported;
+	}
+
+	void GLExtensions::SetMaxShaderCompilerThreads(GLuint Count)
+	{
+		if (HasParallelShaderCompile())
+		{
+			s_MaxShaderCompilerThreads(Count);
+		}
+	}
+
+	bool GLExtensions::HasSparseTexture()
+	{
+		static const bool bSupported = LoadSparseTexture();
+		return bSupported;
+	}
+
+	void GLExtensions::TexPageCommitment(GLenum Target, GLint Level, GLint X, GLint Y, GLsizei Width, GLsizei Height, bool bCommit)
+	{
+		s_TexPageCommitment(Target, Level, X, Y, 0, Width, Height, 1, bCommit ? GL_TRUE : GL_FALSE);
+	}
+
+	bool GLExtensions::HasSPIRV()
+	{
+		static const bool bSupported = LoadSPIRV();
+		return bSupported;
+	}
+
+	bool GLExtensions::HasTextureStorage()
+	{
+		static const bool bSupported = LoadTextureStorage();
+		return bSupported;
+	}
+
+	void GLExtensions::TexStorage2D(GLenum Target, GLsizei LevelCount, GLenum InternalFormat, GLsizei Width, GLsizei Height)
+	{
+		s_TexStorage2D(Target, LevelCount, InternalFormat, Width, Height);
+	}
+
+	bool GLExtensions::HasAnisotropicFiltering()
+	{
+		static const bool bSupported = GLAD_GL_VERSION_4_6 || Has("GL_EXT_texture_filter_anisotropic") || Has("GL_ARB_texture_filter_anisotropic");
+		return bSupported;
+	}
+
+	void GLExtensions::SpecializeShader(GLuint Shader, const char* EntryPoint, GLuint ConstantCount, const GLuint* ConstantIndices, const GLuint* ConstantValues)
+	{
+		s_SpecializeShader(Shader, EntryPoint, ConstantCount, ConstantIndices, ConstantValues);
+	}
+
+} // namespace fgl
\ No newline at end of file
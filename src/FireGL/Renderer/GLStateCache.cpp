@@ -0,0 +1,272 @@
+#include <FireGL/Renderer/GLStateCache.h>
+#include <FireGL/Renderer/RenderStats.h>
+#include <FireGL/Core/BaseLog.h>
+
+namespace fgl
+{
+
+	namespace
+	{
+		std::array<GLuint, GLStateCache::MaxTextureUnits> MakeUnknownUnits()
+		{
+			std::array<GLuint, GLStateCache::MaxTextureUnits> Units;
+			Units.fill(std::numeric_limits<GLuint>::max());
+			return Units;
+		}
+	}
+
+	GLuint GLStateCache::s_Program = GLStateCache::Unknown;
+	GLuint GLStateCache::s_VertexArray = GLStateCache::Unknown;
+	GLuint GLStateCache::s_ArrayBuffer = GLStateCache::Unknown;
+	GLuint GLStateCache::s_UniformBuffer = GLStateCache::Unknown;
+	GLuint GLStateCache::s_DrawIndirectBuffer = GLStateCache::Unknown;
+	uint32_t GLStateCache::s_ActiveUnit = GLStateCache::Unknown;
+	std::array<GLuint, GLStateCache::MaxTextureUnits> GLStateCache::s_Texture2D = MakeUnknownUnits();
+	std::array<GLuint, GLStateCache::MaxTextureUnits> GLStateCache::s_TextureCubeMap = MakeUnknownUnits();
+	std::array<GLuint, GLStateCache::MaxTextureUnits> GLStateCache::s_Sampler = MakeUnknownUnits();
+	GLuint GLStateCache::s_CullMode = GLStateCache::Unknown;
+	GLenum GLStateCache::s_DepthFunc = GLStateCache::Unknown;
+	GLuint GLStateCache::s_DepthWrite = GLStateCache::Unknown;
+	bool GLStateCache::s_bDepthOverridden = false;
+
+	void GLStateCache::UseProgram(GLuint Program)
+	{
+		if (s_Program == Program)
+			return;
+
+		glUseProgram(Program);
+		RenderCounters::CountProgramBind();
+		s_Program = Program;
+	}
+
+	void GLStateCache::BindVertexArray(GLuint VertexArray)
+	{
+		if (s_VertexArray == VertexArray)
+			return;
+
+		glBindVertexArray(VertexArray);
+		RenderCounters::CountVertexArrayBind();
+		s_VertexArray = VertexArray;
+	}
+
+	void GLStateCache::BindBuffer(GLenum Target, GLuint Buffer)
+	{
+		GLuint* Slot = GetBufferSlot(Target);
+		if (Slot && *Slot == Buffer)
+			return;
+
+		glBindBuffer(Target, Buffer);
+		if (Slot)
+		{
+			*Slot = Buffer;
+		}
+	}
+
+	void GLStateCache::ActiveTexture(uint32_t Unit)
+	{
+		if (s_ActiveUnit == Unit)
+			return;
+
+		glActiveTexture(GL_TEXTURE0 + Unit);
+		s_ActiveUnit = Unit;
+	}
+
+	void GLStateCache::BindTexture(GLenum Target, GLuint Texture)
+	{
+		GLuint* Slot = GetTextureSlot(Target);
+		if (Slot && *Slot == Texture)
+			return;
+
+		glBindTexture(Target, Texture);
+		RenderCounters::CountTextureBind();
+		if (Slot)
+		{
+			*Slot = Texture;
+		}
+	}
+
+	void GLStateCache::BindTextureUnit(uint32_t Unit, GLenum Target, GLuint Texture, GLuint Sampler)
+	{
+		ActiveTexture(Unit);
+		BindTexture(Target, Texture);
+		BindSampler(Unit, Sampler);
+	}
+
+	void GLStateCache::BindSampler(uint32_t Unit, GLuint Sampler)
+	{
+		if (Unit < MaxTextureUnits && s_Sampler[Unit] == Sampler)
+			return;
+
+		glBindSampler(Unit, Sampler);
+		if (Unit < MaxTextureUnits)
+		{
+			s_Sampler[Unit] = Sampler;
+		}
+	}
+
+	void GLStateCache::SetCullMode(CullMode Mode)
+	{
+		const GLuint Value = static_cast<GLuint>(Mode);
+		if (s_CullMode == Value)
+			return;
+
+		if (Mode == CullMode::None)
+		{
+			glDisable(GL_CULL_FACE);
+		}
+		else
+		{
+			if (s_CullMode == Unknown || s_CullMode == static_cast<GLuint>(CullMode::None))
+			{
+				glEnable(GL_CULL_FACE);
+			}
+			glCullFace(Mode == CullMode::Back ? GL_BACK : GL_FRONT);
+		}
+		s_CullMode = Value;
+	}
+
+	void GLStateCache::SetDepthFunc(GLenum Func)
+	{
+		if (s_DepthFunc == Func)
+			return;
+
+		glDepthFunc(Func);
+		s_DepthFunc = Func;
+	}
+
+	void GLStateCache::SetDepthWrite(bool bWrite)
+	{
+		const GLuint Value = bWrite ? 1 : 0;
+		if (s_DepthWrite == Value)
+			return;
+
+		glDepthMask(bWrite ? GL_TRUE : GL_FALSE);
+		s_DepthWrite = Value;
+	}
+
+	void GLStateCache::ApplyRasterState(const RasterState& State)
+	{
+		SetCullMode(State.Cull);
+		if (s_bDepthOverridden)
+			return;
+
+		SetDepthFunc(State.DepthFunc);
+		SetDepthWrite(State.bDepthWrite);
+	}
+
+	void GLStateCache::ResetRasterState()
+	{
+		ApplyRasterState({ CullMode::None, GL_LESS, true });
+	}
+
+	void GLStateCache::BeginDepthOverride(GLenum Func, bool bWrite)
+	{
+		LOG_ASSERT(!s_bDepthOverridden, "A depth override is already active")
+
+		SetDepthFunc(Func);
+		SetDepthWrite(bWrite);
+		s_bDepthOverridden = true;
+	}
+
+	void GLStateCache::EndDepthOverride()
+	{
+		s_bDepthOverridden = false;
+		SetDepthFunc(GL_LESS);
+		SetDepthWrite(true);
+	}
+
+	void GLStateCache::OnProgramDeleted(GLuint Program)
+	{
+		if (s_Program == Program)
+		{
+			s_Program = Unknown;
+		}
+	}
+
+	void GLStateCache::OnVertexArrayDeleted(GLuint VertexArray)
+	{
+		if (s_VertexArray == VertexArray)
+		{
+			s_VertexArray = Unknown;
+		}
+	}
+
+	void GLStateCache::OnBufferDeleted(GLuint Buffer)
+	{
+		if (s_ArrayBuffer == Buffer)
+		{
+			s_ArrayBuffer = Unknown;
+		}
+		if (s_UniformBuffer == Buffer)
+		{
+			s_UniformBuffer = Unknown;
+		}
+		if (s_DrawIndirectBuffer == Buffer)
+		{
+			s_DrawIndirectBuffer = Unknown;
+		}
+	}
+
+	void GLStateCache::OnTextureDeleted(GLuint Texture)
+	{
+		for (size_t Unit = 0; Unit < MaxTextureUnits; Unit++)
+		{
+			if (s_Texture2D[Unit] == Texture)
+			{
+				s_Texture2D[Unit] = Unknown;
+			}
+			if (s_TextureCubeMap[Unit] == Texture)
+			{
+				s_TextureCubeMap[Unit] = Unknown;
+			}
+		}
+	}
+
+	void GLStateCache::Invalidate()
+	{
+		s_Program = Unknown;
+		s_VertexArray = Unknown;
+		s_ArrayBuffer = Unknown;
+		s_UniformBuffer = Unknown;
+		s_DrawIndirectBuffer = Unknown;
+		s_ActiveUnit = Unknown;
+		s_Texture2D.fill(Unknown);
+		s_TextureCubeMap.fill(Unknown);
+		s_Sampler.fill(Unknown);
+		s_CullMode = Unknown;
+		s_DepthFunc = Unknown;
+		s_DepthWrite = Unknown;
+	}
+
+	GLuint* GLStateCache::GetBufferSlot(GLenum Target)
+	{
+		switch (Target)
+		{
+		case GL_ARRAY_BUFFER:
+			return &s_ArrayBuffer;
+		case GL_UNIFORM_BUFFER:
+			return &s_UniformBuffer;
+		case GL_DRAW_INDIRECT_BUFFER:
+			return &s_DrawIndirectBuffer;
+		default:
+			return nullptr;
+		}
+	}
+
+	GLuint* GLStateCache::GetTextureSlot(GLenum Target)
+	{
+		if (s_ActiveUnit >= MaxTextureUnits)
+			return nullptr;
+
+		switch (Target)
+		{
+		case GL_TEXTURE_2D:
+			return &s_Texture2D[s_ActiveUnit];
+		case GL_TEXTURE_CUBE_MAP:
+			return &s_TextureCubeMap[s_ActiveUnit];
+		default:
+			return nullptr;
+		}
+	}
+
+} // namespace fgl
\ No newline at end of file
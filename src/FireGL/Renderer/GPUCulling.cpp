@@ -0,0 +1,475 @@
+#include <FireGL/Renderer/GPUCulling.h>
+#include <FireGL/Renderer/BaseCamera.h>
+#include <FireGL/Renderer/Frustum.h>
+#include <FireGL/Renderer/HiZBuffer.h>
+#include <FireGL/Renderer/GLStateCache.h>
+#include <FireGL/Renderer/GPUMemoryTracker.h>
+#include <FireGL/Renderer/RenderStats.h>
+#include <FireGL/Core/BaseLog.h>
+
+namespace fgl
+{
+
+	namespace
+	{
+		constexpr GLuint WorkgroupSize = 256;
+
+		// Records shared by the three passes, must match GPUCullingObject, GPUCullingBatch and DrawElementsIndirectCommand
+		constexpr std::string_view CullingCommonCode = R"(#version 430 core
+layout (local_size_x = 256) in;
+
+struct InstanceData
+{
+    mat4 Model;
+    mat3x4 NormalMatrix;
+    uvec4 TextureLayers;
+    uint MaterialIndex;
+    uint BoneOffset;
+    uint ReflectionProbe;
+    uint PointLights;
+    vec4 Payload;
+};
+
+struct ObjectRecord
+{
+    InstanceData Instance;
+    vec4 BoundingSphere;
+    uint BatchIndex;
+    uint Layers;
+    uint Padding0;
+    uint Padding1;
+};
+
+struct BatchRecord
+{
+    uint LOD;
+    uint LODCount;
+    float ScreenSize;
+    uint Padding;
+};
+
+struct DrawCommand
+{
+    uint Count;
+    uint InstanceCount;
+    uint FirstIndex;
+    int BaseVertex;
+    uint BaseInstance;
+};
+
+const uint NoBatch = 0xFFFFFFFFu;
+
+layout (std430, binding = 4) readonly buffer CullingObjectData { ObjectRecord Objects[]; };
+layout (std430, binding = 5) readonly buffer CullingBatchData { BatchRecord Batches[]; };
+layout (std430, binding = 6) coherent buffer CullingCountData { uvec2 Counts[]; };
+layout (std430, binding = 7) buffer CullingVisibilityData { uvec2 Visibility[]; };
+layout (std430, binding = 8) writeonly buffer CullingInstanceData { InstanceData Instances[]; };
+layout (std430, binding = 9) buffer CullingCommandData { DrawCommand Commands[]; };
+layout (std430, binding = 10) readonly buffer CullingCommandBatchData { uint CommandBatches[]; };
+)";
+
+		// Same tests as Frustum::IsVisible() and Renderer::BatchSceneObjects(), then the occlusion test of HiZBuffer
+		constexpr std::string_view CullCode = R"(
+uniform uint ObjectCount;
+uniform vec4 FrustumPlanes[6];
+uniform vec3 CameraPosition;
+uniform float SizeScale;
+uniform bool bOrthographic;
+uniform bool bFrustumCulling;
+uniform bool bLevelOfDetail;
+uniform bool bOcclusionCulling;
+uniform uint CullingMask;
+uniform mat4 OcclusionViewProjection;
+uniform sampler2D HiZ;
+uniform vec2 HiZSize;
+uniform float HiZMaxLevel;
+
+bool IsOccluded(vec4 Sphere)
+{
+    // Screen rectangle and nearest depth of the sphere's box, as the previous frame saw it
+    vec2 MinXY = vec2(1.0);
+    vec2 MaxXY = vec2(-1.0);
+    float MinZ = 1.0;
+    for (int Corner = 0; Corner < 8; Corner++)
+    {
+        vec3 Offset = vec3((Corner & 1) != 0 ? 1.0 : -1.0, (Corner & 2) != 0 ? 1.0 : -1.0, (Corner & 4) != 0 ? 1.0 : -1.0);
+        vec4 Clip = OcclusionViewProjection * vec4(Sphere.xyz + Offset * Sphere.w, 1.0);
+        if (Clip.w <= 0.0)
+            return false;
+
+        vec3 Ndc = Clip.xyz / Clip.w;
+        MinXY = min(MinXY, Ndc.xy);
+        MaxXY = max(MaxXY, Ndc.xy);
+        MinZ = min(MinZ, Ndc.z);
+    }
+
+    // Parts the previous frame didn't see have no depth to be tested against
+    if (any(lessThan(MinXY, vec2(-1.0))) || any(greaterThan(MaxXY, vec2(1.0))))
+        return false;
+
+    // The box covers at most 2x2 texels of the level matching its size
+    vec2 UVMin = MinXY * 0.5 + 0.5;
+    vec2 UVMax = MaxXY * 0.5 + 0.5;
+    vec2 Extent = (UVMax - UVMin) * HiZSize;
+    float Level = min(ceil(log2(max(max(Extent.x, Extent.y), 1.0))), HiZMaxLevel);
+    float Occluder = max(max(textureLod(HiZ, UVMin, Level).r, textureLod(HiZ, vec2(UVMax.x, UVMin.y), Level).r),
+        max(textureLod(HiZ, vec2(UVMin.x, UVMax.y), Level).r, textureLod(HiZ, UVMax, Level).r));
+
+    // Window depth of the [0, 1] clip depth under the default depth range
+    return MinZ * 0.5 + 0.5 > Occluder;
+}
+
+void main()
+{
+    uint Index = gl_GlobalInvocationID.x;
+    if (Index >= ObjectCount)
+        return;
+
+    Visibility[Index] = uvec2(NoBatch, 0u);
+    uint Batch = Objects[Index].BatchIndex;
+    if (Batch == NoBatch || (Objects[Index].Layers & CullingMask) == 0u)
+        return;
+
+    vec4 Sphere = Objects[Index].BoundingSphere;
+    if (bFrustumCulling)
+    {
+        for (int Plane = 0; Plane < 6; Plane++)
+        {
+            if (dot(FrustumPlanes[Plane].xyz, Sphere.xyz) + FrustumPlanes[Plane].w < -Sphere.w)
+                return;
+        }
+    }
+    if (bOcclusionCulling && IsOccluded(Sphere))
+        return;
+
+    uint LODCount = Batches[Batch].LODCount;
+    if (bLevelOfDetail && LODCount > 1u)
+    {
+        float ScreenSize = Sphere.w * SizeScale;
+        if (!bOrthographic)
+        {
+            float Distance = length(Sphere.xyz - CameraPosition);
+            ScreenSize = Distance > Sphere.w ? ScreenSize / Distance : 3.402823e38;
+        }
+
+        uint LOD = 0u;
+        while (LOD + 1u < LODCount && ScreenSize < Batches[Batch + LOD + 1u].ScreenSize)
+        {
+            LOD++;
+        }
+        Batch += LOD;
+    }
+
+    Visibility[Index] = uvec2(Batch, atomicAdd(Counts[Batch].x, 1u));
+}
+)";
+
+		// A single workgroup scans the counts 256 batches at a time, then completes every command
+		constexpr std::string_view ScanCode = R"(
+uniform uint BatchCount;
+uniform uint CommandCount;
+
+shared uint Partial[256];
+
+void main()
+{
+    uint Thread = gl_LocalInvocationID.x;
+    uint Total = 0u;
+    for (uint Base = 0u; Base < BatchCount; Base += 256u)
+    {
+        uint Batch = Base + Thread;
+        uint Count = Batch < BatchCount ? Counts[Batch].x : 0u;
+        Partial[Thread] = Count;
+        barrier();
+
+        for (uint Offset = 1u; Offset < 256u; Offset <<= 1u)
+        {
+            uint Value = Thread >= Offset ? Partial[Thread - Offset] : 0u;
+            barrier();
+            Partial[Thread] += Value;
+            barrier();
+        }
+
+        if (Batch < BatchCount)
+        {
+            Counts[Batch].y = Total + Partial[Thread] - Count;
+        }
+        Total += Partial[255];
+        barrier();
+    }
+
+    memoryBarrierBuffer();
+    barrier();
+
+    for (uint Command = Thread; Command < CommandCount; Command += 256u)
+    {
+        uint Batch = CommandBatches[Command];
+        Commands[Command].InstanceCount = Counts[Batch].x;
+        Commands[Command].BaseInstance = Counts[Batch].y;
+    }
+}
+)";
+
+		constexpr std::string_view WriteCode = R"(
+uniform uint ObjectCount;
+
+void main()
+{
+    uint Index = gl_GlobalInvocationID.x;
+    if (Index >= ObjectCount)
+        return;
+
+    uvec2 Visible = Visibility[Index];
+    if (Visible.x == NoBatch)
+        return;
+
+    Instances[Counts[Visible.x].y + Visible.y] = Objects[Index].Instance;
+}
+)";
+
+		std::unique_ptr<Shader> CreateCullingShader(std::string_view PassCode)
+		{
+			std::string Code(CullingCommonCode);
+			Code += PassCode;
+			return Shader::CreateComputeFromSource(Code);
+		}
+	}
+
+	static_assert(sizeof(GPUCullingObject) == 192, "GPUCullingObject must match the std430 layout of ObjectRecord");
+	static_assert(sizeof(GPUCullingBatch) == 16, "GPUCullingBatch must match the std430 layout of BatchRecord");
+
+	bool GPUCulling::IsSupported()
+	{
+		return GLAD_GL_VERSION_4_3;
+	}
+
+	void GPUCulling::Create()
+	{
+		for (GLuint* Buffer : { &m_ObjectBuffer, &m_BatchBuffer, &m_CountBuffer, &m_VisibilityBuffer, &m_InstanceBuffer, &m_CommandBatchBuffer })
+		{
+			glGenBuffers(1, Buffer);
+
+			// Bound buffers need storage even before the first Cull()
+			Allocate(*Buffer, nullptr, 0, GL_DYNAMIC_DRAW);
+		}
+		m_Commands.Create();
+
+		m_CullShader = CreateCullingShader(CullCode);
+		m_ScanShader = CreateCullingShader(ScanCode);
+		m_WriteShader = CreateCullingShader(WriteCode);
+
+		m_CullObjectCount = m_CullShader->GetUniform("ObjectCount");
+		m_CullFrustumPlanes = m_CullShader->GetUniform("FrustumPlanes");
+		m_CullCameraPosition = m_CullShader->GetUniform("CameraPosition");
+		m_CullSizeScale = m_CullShader->GetUniform("SizeScale");
+		m_CullOrthographic = m_CullShader->GetUniform("bOrthographic");
+		m_CullFrustumCulling = m_CullShader->GetUniform("bFrustumCulling");
+		m_CullLevelOfDetail = m_CullShader->GetUniform("bLevelOfDetail");
+		m_CullOcclusionCulling = m_CullShader->GetUniform("bOcclusionCulling");
+		m_CullCullingMask = m_CullShader->GetUniform("CullingMask");
+		m_CullOcclusionViewProjection = m_CullShader->GetUniform("OcclusionViewProjection");
+		m_CullHiZ = m_CullShader->GetUniform("HiZ");
+		m_CullHiZSize = m_CullShader->GetUniform("HiZSize");
+		m_CullHiZMaxLevel = m_CullShader->GetUniform("HiZMaxLevel");
+		m_ScanBatchCount = m_ScanShader->GetUniform("BatchCount");
+		m_ScanCommandCount = m_ScanShader->GetUniform("CommandCount");
+		m_WriteObjectCount = m_WriteShader->GetUniform("ObjectCount");
+
+		m_ObjectCapacity = 0;
+		m_UploadedBatchCount = 0;
+	}
+
+	void GPUCulling::Destroy()
+	{
+		for (GLuint* Buffer : { &m_ObjectBuffer, &m_BatchBuffer, &m_CountBuffer, &m_VisibilityBuffer, &m_InstanceBuffer, &m_CommandBatchBuffer })
+		{
+			if (*Buffer == 0)
+				continue;
+
+			glDeleteBuffers(1, Buffer);
+			GLStateCache::OnBufferDeleted(*Buffer);
+			GPUMemoryTracker::UntrackBuffer(*Buffer);
+			*Buffer = 0;
+		}
+		m_Commands.Destroy();
+
+		for (std::unique_ptr<Shader>* Program : { &m_CullShader, &m_ScanShader, &m_WriteShader })
+		{
+			if (*Program)
+			{
+				(*Program)->Cleanup();
+				Program->reset();
+			}
+		}
+	}
+
+	bool GPUCulling::IsCreated() const
+	{
+		return m_ObjectBuffer != 0;
+	}
+
+	void GPUCulling::SetObjectCount(size_t Count)
+	{
+		m_Objects.resize(Count);
+	}
+
+	void GPUCulling::SetObject(size_t Index, const GPUCullingObject& Object)
+	{
+		LOG_ASSERT(Index < m_Objects.size(), "GPU culling object index out of range");
+		m_Objects[Index] = Object;
+		m_DirtyBegin = std::min(m_DirtyBegin, Index);
+		m_DirtyEnd = std::max(m_DirtyEnd, Index + 1);
+	}
+
+	void GPUCulling::AddBatch(const GPUCullingBatch& Batch)
+	{
+		m_Batches.push_back(Batch);
+	}
+
+	size_t GPUCulling::GetBatchCount() const
+	{
+		return m_Batches.size();
+	}
+
+	void GPUCulling::ClearCommands()
+	{
+		m_Commands.Clear();
+		m_CommandBatches.clear();
+	}
+
+	void GPUCulling::PushCommand(const DrawElementsIndirectCommand& Command, uint32_t BatchIndex)
+	{
+		m_Commands.Push(Command);
+		m_CommandBatches.push_back(BatchIndex);
+	}
+
+	void GPUCulling::UploadCommands()
+	{
+		m_Commands.Upload();
+		Allocate(m_CommandBatchBuffer, m_CommandBatches.data(), m_CommandBatches.size() * sizeof(uint32_t), GL_STATIC_DRAW);
+	}
+
+	void GPUCulling::UploadObjects()
+	{
+		if (m_Objects.size() > m_ObjectCapacity)
+		{
+			// Grow to the vector's capacity so the storage follows the same amortized growth
+			m_ObjectCapacity = m_Objects.capacity();
+			Allocate(m_ObjectBuffer, nullptr, m_ObjectCapacity * sizeof(GPUCullingObject), GL_DYNAMIC_DRAW);
+			glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, m_Objects.size() * sizeof(GPUCullingObject), m_Objects.data());
+			RenderCounters::CountUpload(m_Objects.size() * sizeof(GPUCullingObject));
+			Allocate(m_VisibilityBuffer, nullptr, m_ObjectCapacity * sizeof(glm::uvec2), GL_DYNAMIC_COPY);
+			Allocate(m_InstanceBuffer, nullptr, m_ObjectCapacity * sizeof(InstanceData), GL_DYNAMIC_COPY);
+		}
+		else if (m_DirtyBegin < std::min(m_DirtyEnd, m_Objects.size()))
+		{
+			// Only the span of the objects edited since the last frame is transferred
+			const size_t End = std::min(m_DirtyEnd, m_Objects.size());
+			glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_ObjectBuffer);
+			glBufferSubData(GL_SHADER_STORAGE_BUFFER, m_DirtyBegin * sizeof(GPUCullingObject),
+				(End - m_DirtyBegin) * sizeof(GPUCullingObject), &m_Objects[m_DirtyBegin]);
+			RenderCounters::CountUpload((End - m_DirtyBegin) * sizeof(GPUCullingObject));
+		}
+		m_DirtyBegin = SIZE_MAX;
+		m_DirtyEnd = 0;
+	}
+
+	void GPUCulling::Cull(BaseCamera& Camera, bool bFrustumCulling, bool bLevelOfDetail, float LODBias, const HiZBuffer* Occlusion)
+	{
+		UploadObjects();
+		if (m_Batches.size() != m_UploadedBatchCount)
+		{
+			Allocate(m_BatchBuffer, m_Batches.data(), m_Batches.size() * sizeof(GPUCullingBatch), GL_STATIC_DRAW);
+			Allocate(m_CountBuffer, nullptr, m_Batches.size() * sizeof(glm::uvec2), GL_DYNAMIC_COPY);
+			m_UploadedBatchCount = m_Batches.size();
+		}
+		if (m_CommandBatches.empty())
+			return;
+
+		// Other passes may use the same binding points, they are bound again every frame
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, ObjectBindingPoint, m_ObjectBuffer);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, BatchBindingPoint, m_BatchBuffer);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CountBindingPoint, m_CountBuffer);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, VisibilityBindingPoint, m_VisibilityBuffer);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, InstanceBindingPoint, m_InstanceBuffer);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CommandBindingPoint, m_Commands.GetBufferID());
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CommandBatchBindingPoint, m_CommandBatchBuffer);
+
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_CountBuffer);
+		glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+
+		const GLuint ObjectCount = static_cast<GLuint>(m_Objects.size());
+		const GLuint ObjectGroups = (ObjectCount + WorkgroupSize - 1) / WorkgroupSize;
+		if (ObjectCount > 0)
+		{
+			// Projected size is the sphere radius times the projection's vertical scale, over the view distance in perspective
+			const glm::mat4 Projection = Camera.GetProjectionMatrix();
+			const Frustum ViewFrustum = Camera.GetFrustum();
+			m_CullShader->Activate();
+			m_CullShader->SetUInt(m_CullObjectCount, ObjectCount);
+			glUniform4fv(m_CullFrustumPlanes.Location, Frustum::PlaneCount, &ViewFrustum.GetPlanes()[0].x);
+			m_CullShader->SetVec3(m_CullCameraPosition, Camera.GetViewPosition());
+			m_CullShader->SetFloat(m_CullSizeScale, Projection[1][1] * LODBias);
+			m_CullShader->SetBool(m_CullOrthographic, Projection[3][3] == 1.0f);
+			m_CullShader->SetBool(m_CullFrustumCulling, bFrustumCulling);
+			m_CullShader->SetBool(m_CullLevelOfDetail, bLevelOfDetail);
+			m_CullShader->SetBool(m_CullOcclusionCulling, Occlusion != nullptr);
+			m_CullShader->SetUInt(m_CullCullingMask, Camera.GetCullingMask());
+			if (Occlusion)
+			{
+				GLStateCache::BindTextureUnit(HiZBuffer::TextureUnit, GL_TEXTURE_2D, Occlusion->GetTexture());
+				m_CullShader->SetInt(m_CullHiZ, HiZBuffer::TextureUnit);
+				m_CullShader->SetMat4(m_CullOcclusionViewProjection, Occlusion->GetViewProjection());
+				m_CullShader->SetVec2(m_CullHiZSize, Occlusion->GetSize());
+				m_CullShader->SetFloat(m_CullHiZMaxLevel, static_cast<float>(Occlusion->GetMaxLevel()));
+			}
+			glDispatchCompute(ObjectGroups, 1, 1);
+			glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+		}
+
+		m_ScanShader->Activate();
+		m_ScanShader->SetUInt(m_ScanBatchCount, static_cast<GLuint>(m_Batches.size()));
+		m_ScanShader->SetUInt(m_ScanCommandCount, static_cast<GLuint>(m_CommandBatches.size()));
+		glDispatchCompute(1, 1, 1);
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+		if (ObjectCount > 0)
+		{
+			m_WriteShader->Activate();
+			m_WriteShader->SetUInt(m_WriteObjectCount, ObjectCount);
+			glDispatchCompute(ObjectGroups, 1, 1);
+		}
+
+		// The draws read the commands and the instance attributes written above
+		glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+	}
+
+	const IndirectDrawBuffer& GPUCulling::GetCommands() const
+	{
+		return m_Commands;
+	}
+
+	GLuint GPUCulling::GetInstanceBuffer() const
+	{
+		return m_InstanceBuffer;
+	}
+
+	void GPUCulling::Allocate(GLuint Buffer, const void* Data, size_t Size, GLenum Usage)
+	{
+		static constexpr uint32_t Empty = 0;
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, Buffer);
+		if (Size == 0)
+		{
+			glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(Empty), &Empty, Usage);
+			GPUMemoryTracker::TrackBuffer(Buffer, sizeof(Empty), GPUMemoryCategory::Storage, "GPUCulling");
+			return;
+		}
+		glBufferData(GL_SHADER_STORAGE_BUFFER, Size, Data, Usage);
+		GPUMemoryTracker::TrackBuffer(Buffer, Size, GPUMemoryCategory::Storage, "GPUCulling");
+		if (Data)
+		{
+			RenderCounters::CountUpload(Size);
+		}
+	}
+
+} // namespace fgl
@@ -0,0 +1,249 @@
+#include <FireGL/Renderer/GPUMemoryTracker.h>
+#include <FireGL/Renderer/GLExtensions.h>
+#include <FireGL/Renderer/TextureContainer.h>
+#include <FireGL/Core/BaseLog.h>
+#include <FireGL/Core/GLDebug.h>
+
+#include <iomanip>
+
+namespace fgl
+{
+
+	namespace
+	{
+		// GL_NVX_gpu_memory_info and GL_ATI_meminfo queries, missing from the generated loader; both report kilobytes
+		constexpr GLenum DedicatedVideoMemoryNVX = 0x9047;
+		constexpr GLenum CurrentAvailableVideoMemoryNVX = 0x9049;
+		constexpr GLenum EvictedMemoryNVX = 0x904B;
+		constexpr GLenum TextureFreeMemoryATI = 0x87FC;
+
+		uint64_t MakeKey(GPUObjectType Type, GLuint Name)
+		{
+			return (static_cast<uint64_t>(Type) << 32) | Name;
+		}
+
+		// Bytes a texel of an uncompressed format takes, three-channel formats padded to four like drivers store them
+		uint64_t GetTexelSize(GLenum InternalFormat)
+		{
+			switch (InternalFormat)
+			{
+			case GL_R8:
+				return 1;
+			case GL_RG8:
+			case GL_R16F:
+			case GL_DEPTH_COMPONENT16:
+				return 2;
+			case GL_RGBA16F:
+			case GL_RGB16F:
+			case GL_RG32F:
+			case GL_DEPTH32F_STENCIL8:
+				return 8;
+			case GL_RGBA32F:
+			case GL_RGB32F:
+				return 16;
+			default:
+				// RGB(A)8, sRGB, RGB10_A2, R11F_G11F_B10F, RG16F, R32F and the 24 and 32-bit depth formats
+				return 4;
+			}
+		}
+
+		std::string FormatBytes(uint64_t Bytes)
+		{
+			std::ostringstream Text;
+			Text << std::fixed << std::setprecision(2) << static_cast<double>(Bytes) / (1024.0 * 1024.0) << " MiB";
+			return Text.str();
+		}
+	}
+
+	std::unordered_map<uint64_t, GPUAllocation> GPUMemoryTracker::s_Allocations;
+	std::array<uint64_t, static_cast<size_t>(GPUMemoryCategory::Count)> GPUMemoryTracker::s_CategoryTotals = {};
+	uint64_t GPUMemoryTracker::s_Total = 0;
+	std::optional<GPUDriverMemory> GPUMemoryTracker::s_DriverBaseline;
+
+	void GPUMemoryTracker::Track(GPUObjectType Type, GLuint Name, uint64_t Bytes, GPUMemoryCategory Category, std::string_view Owner)
+	{
+		if (Name == 0)
+			return;
+
+		// Free memory before anything of FireGL was allocated, to compare the tracked total against
+		if (!s_DriverBaseline)
+		{
+			s_DriverBaseline = QueryDriver();
+		}
+
+		// Orphaning buffers are tracked again on every upload, the owner is only copied when it changes
+		auto [Allocation, bInserted] = s_Allocations.try_emplace(MakeKey(Type, Name));
+		GPUAllocation& Entry = Allocation->second;
+		if (!bInserted)
+		{
+			s_CategoryTotals[static_cast<size_t>(Entry.Category)] -= Entry.Bytes;
+			s_Total -= Entry.Bytes;
+		}
+		Entry.Type = Type;
+		Entry.Name = Name;
+		Entry.Category = Category;
+		Entry.Bytes = Bytes;
+		if (bInserted || Entry.Owner != Owner)
+		{
+			Entry.Owner = Owner;
+			// The owner, an asset path for textures, names the object in capture tools
+			FGL_GL_LABEL(Type == GPUObjectType::Buffer ? GL_BUFFER : Type == GPUObjectType::Texture ? GL_TEXTURE : GL_RENDERBUFFER, Name, Owner)
+		}
+		s_CategoryTotals[static_cast<size_t>(Category)] += Bytes;
+		s_Total += Bytes;
+	}
+
+	void GPUMemoryTracker::Untrack(GPUObjectType Type, GLuint Name)
+	{
+		auto Allocation = s_Allocations.find(MakeKey(Type, Name));
+		if (Allocation == s_Allocations.end())
+			return;
+
+		s_CategoryTotals[static_cast<size_t>(Allocation->second.Category)] -= Allocation->second.Bytes;
+		s_Total -= Allocation->second.Bytes;
+		s_Allocations.erase(Allocation);
+	}
+
+	std::vector<GPUAllocation> GPUMemoryTracker::GetLargest(size_t Count)
+	{
+		std::vector<GPUAllocation> Largest;
+		Largest.reserve(s_Allocations.size());
+		for (const auto& [Key, Allocation] : s_Allocations)
+		{
+			Largest.push_back(Allocation);
+		}
+
+		Count = std::min(Count, Largest.size());
+		std::partial_sort(Largest.begin(), Largest.begin() + Count, Largest.end(), [](const GPUAllocation& A, const GPUAllocation& B) {
+			return A.Bytes > B.Bytes;
+			});
+		Largest.resize(Count);
+		return Largest;
+	}
+
+	std::vector<std::pair<std::string, uint64_t>> GPUMemoryTracker::GetLargestOwners(size_t Count)
+	{
+		std::unordered_map<std::string, uint64_t> Owners;
+		for (const auto& [Key, Allocation] : s_Allocations)
+		{
+			Owners[Allocation.Owner] += Allocation.Bytes;
+		}
+
+		std::vector<std::pair<std::string, uint64_t>> Largest(Owners.begin(), Owners.end());
+		Count = std::min(Count, Largest.size());
+		std::partial_sort(Largest.begin(), Largest.begin() + Count, Largest.end(), [](const auto& A, const auto& B) {
+			return A.second > B.second;
+			});
+		Largest.resize(Count);
+		return Largest;
+	}
+
+	GPUDriverMemory GPUMemoryTracker::QueryDriver()
+	{
+		static const bool bNVX = GLExtensions::Has("GL_NVX_gpu_memory_info");
+		static const bool bATI = GLExtensions::Has("GL_ATI_meminfo");
+
+		GPUDriverMemory Memory;
+		if (bNVX)
+		{
+			GLint Dedicated = 0, Available = 0, Evicted = 0;
+			glGetIntegerv(DedicatedVideoMemoryNVX, &Dedicated);
+			glGetIntegerv(CurrentAvailableVideoMemoryNVX, &Available);
+			glGetIntegerv(EvictedMemoryNVX, &Evicted);
+			Memory.Extension = "GL_NVX_gpu_memory_info";
+			Memory.Dedicated = static_cast<uint64_t>(Dedicated) * 1024;
+			Memory.Free = static_cast<uint64_t>(Available) * 1024;
+			Memory.Evicted = static_cast<uint64_t>(Evicted) * 1024;
+		}
+		else if (bATI)
+		{
+			// Total free, largest free block, total and largest free auxiliary memory
+			GLint TextureFree[4] = {};
+			glGetIntegerv(TextureFreeMemoryATI, TextureFree);
+			Memory.Extension = "GL_ATI_meminfo";
+			Memory.Free = static_cast<uint64_t>(TextureFree[0]) * 1024;
+		}
+		return Memory;
+	}
+
+	void GPUMemoryTracker::LogReport(size_t TopCount)
+	{
+		std::string Report = "GPU memory: " + FormatBytes(s_Total) + " tracked in " + std::to_string(s_Allocations.size()) + " allocations";
+		for (size_t Category = 0; Category < s_CategoryTotals.size(); Category++)
+		{
+			Report += "\n  " + std::string(GetCategoryName(static_cast<GPUMemoryCategory>(Category))) + ": " + FormatBytes(s_CategoryTotals[Category]);
+		}
+
+		Report += "\n  Largest owners:";
+		for (const auto& [Owner, Bytes] : GetLargestOwners(TopCount))
+		{
+			Report += "\n    " + FormatBytes(Bytes) + " " + Owner;
+		}
+
+		const GPUDriverMemory Driver = QueryDriver();
+		if (Driver.Extension)
+		{
+			Report += "\n  Driver (" + std::string(Driver.Extension) + "): " + FormatBytes(Driver.Free) + " free";
+			if (Driver.Dedicated > 0)
+			{
+				Report += " of " + FormatBytes(Driver.Dedicated) + ", " + FormatBytes(Driver.Evicted) + " evicted";
+			}
+
+			// Other processes allocate from the same memory, a large gap only hints at an untracked allocation or a leak
+			if (s_DriverBaseline && s_DriverBaseline->Free >= Driver.Free)
+			{
+				Report += "\n  Free memory dropped by " + FormatBytes(s_DriverBaseline->Free - Driver.Free) + " since the first allocation, "
+					+ FormatBytes(s_Total) + " tracked";
+			}
+		}
+		else
+		{
+			Report += "\n  The driver exposes neither GL_NVX_gpu_memory_info nor GL_ATI_meminfo.";
+		}
+		LOG_INFO(Report)
+	}
+
+	const char* GPUMemoryTracker::GetCategoryName(GPUMemoryCategory Category)
+	{
+		switch (Category)
+		{
+		case GPUMemoryCategory::Geometry: return "Geometry";
+		case GPUMemoryCategory::Instances: return "Instances";
+		case GPUMemoryCategory::Uniforms: return "Uniforms";
+		case GPUMemoryCategory::Storage: return "Storage";
+		case GPUMemoryCategory::Indirect: return "Indirect";
+		case GPUMemoryCategory::Staging: return "Staging";
+		case GPUMemoryCategory::Textures: return "Textures";
+		case GPUMemoryCategory::RenderTargets: return "Render targets";
+		default: return "Unknown";
+		}
+	}
+
+	uint64_t GPUMemoryTracker::GetTextureSize(GLenum InternalFormat, int Width, int Height, int Layers, int LevelCount)
+	{
+		uint64_t Bytes = 0;
+		for (int Level = 0; Level < LevelCount; Level++)
+		{
+			const int LevelWidth = std::max(Width >> Level, 1);
+			const int LevelHeight = std::max(Height >> Level, 1);
+			uint64_t LevelSize = TextureContainer::GetLevelSize(InternalFormat, LevelWidth, LevelHeight);
+			if (LevelSize == 0)
+			{
+				LevelSize = static_cast<uint64_t>(LevelWidth) * LevelHeight * GetTexelSize(InternalFormat);
+			}
+			Bytes += LevelSize * static_cast<uint64_t>(std::max(Layers, 1));
+		}
+		return Bytes;
+	}
+
+	int GPUMemoryTracker::GetMipLevelCount(int Width, int Height)
+	{
+		int LevelCount = 1;
+		for (int Size = std::max(Width, Height); Size > 1; Size >>= 1)
+		{
+			LevelCount++;
+		}
+		return LevelCount;
+	}
+
+} // namespace fgl
@@ -0,0 +1,217 @@
+#include <FireGL/Renderer/GPUProfiler.h>
+#include <FireGL/Core/GLDebug.h>
+#include <FireGL/Core/BaseLog.h>
+
+namespace fgl
+{
+
+	void GPUProfiler::Destroy()
+	{
+		for (FrameRecord& Frame : m_Frames)
+		{
+			if (!Frame.Queries.empty())
+			{
+				glDeleteQueries(static_cast<GLsizei>(Frame.Queries.size()), Frame.Queries.data());
+			}
+			Frame = FrameRecord();
+		}
+		m_Current = 0;
+		m_Oldest = 0;
+		m_bRecording = false;
+		m_OpenPasses.clear();
+	}
+
+	void GPUProfiler::SetEnabled(bool bEnabled)
+	{
+		if (m_bEnabled == bEnabled)
+			return;
+
+		// Results of the frames in flight are dropped, their queries are reused as they are
+		m_bEnabled = bEnabled;
+		for (FrameRecord& Frame : m_Frames)
+		{
+			Frame.bPending = false;
+		}
+		m_Oldest = m_Current;
+	}
+
+	bool GPUProfiler::IsEnabled() const
+	{
+		return m_bEnabled;
+	}
+
+	void GPUProfiler::BeginFrame()
+	{
+		m_bRecording = false;
+		if (!m_bEnabled)
+			return;
+
+		// The ring is full of frames the GPU hasn't finished: this one isn't measured
+		FrameRecord& Frame = m_Frames[m_Current];
+		if (Frame.bPending)
+			return;
+
+		Frame.UsedQueries = 0;
+		Frame.Passes.clear();
+		m_OpenPasses.clear();
+		m_bRecording = true;
+	}
+
+	void GPUProfiler::BeginPass(const char* Name)
+	{
+#if defined(FIREGL_ENABLE_TRACY)
+		const std::string_view Function = __func__;
+		const std::string_view File = __FILE__;
+		m_TracyZones.push_back(std::make_unique<tracy::GpuCtxScope>(static_cast<uint32_t>(__LINE__), File.data(), File.size(),
+			Function.data(), Function.size(), Name, std::string_view(Name).size(), true));
+#endif
+		// Every pass is a debug group in capture tools, whether or not it is timed
+		FGL_GL_PUSH_GROUP(Name)
+		if (!m_bRecording)
+			return;
+
+		FrameRecord& Frame = m_Frames[m_Current];
+		m_OpenPasses.push_back(static_cast<uint32_t>(Frame.Passes.size()));
+		Frame.Passes.push_back({ FindOrAddPass(Name), IssueTimestamp(), 0 });
+	}
+
+	void GPUProfiler::EndPass()
+	{
+#if defined(FIREGL_ENABLE_TRACY)
+		if (!m_TracyZones.empty())
+		{
+			m_TracyZones.pop_back();
+		}
+#endif
+		FGL_GL_POP_GROUP()
+		if (!m_bRecording)
+			return;
+
+		LOG_ASSERT(!m_OpenPasses.empty(), "GPUProfiler::EndPass() without a matching BeginPass()");
+		m_Frames[m_Current].Passes[m_OpenPasses.back()].End = IssueTimestamp();
+		m_OpenPasses.pop_back();
+	}
+
+	void GPUProfiler::EndFrame()
+	{
+		if (m_bRecording)
+		{
+			LOG_ASSERT(m_OpenPasses.empty(), "GPUProfiler::EndFrame() with passes still open");
+			FrameRecord& Frame = m_Frames[m_Current];
+			Frame.bPending = !Frame.Passes.empty();
+			if (Frame.bPending)
+			{
+				m_Current = (m_Current + 1) % FrameLatency;
+			}
+			m_bRecording = false;
+		}
+
+		// Frames complete in order, the first one not available ends the readback
+		while (m_Frames[m_Oldest].bPending && TryReadFrame(m_Frames[m_Oldest]))
+		{
+			m_Oldest = (m_Oldest + 1) % FrameLatency;
+		}
+	}
+
+	bool GPUProfiler::TryReadFrame(FrameRecord& Frame)
+	{
+		GLint bAvailable = GL_FALSE;
+		glGetQueryObjectiv(Frame.Queries[Frame.UsedQueries - 1], GL_QUERY_RESULT_AVAILABLE, &bAvailable);
+		if (!bAvailable)
+			return false;
+
+		// A pass begun several times this frame counts once, with the sum of its times
+		m_FrameTimes.assign(m_Stats.size(), -1.0);
+		GLuint64 FrameBegin = std::numeric_limits<GLuint64>::max();
+		GLuint64 FrameEnd = 0;
+		for (const PassRecord& Pass : Frame.Passes)
+		{
+			GLuint64 Begin = 0;
+			GLuint64 End = 0;
+			glGetQueryObjectui64v(Frame.Queries[Pass.Begin], GL_QUERY_RESULT, &Begin);
+			glGetQueryObjectui64v(Frame.Queries[Pass.End], GL_QUERY_RESULT, &End);
+			const double Milliseconds = End > Begin ? static_cast<double>(End - Begin) * 1e-6 : 0.0;
+			m_FrameTimes[Pass.Pass] = std::max(m_FrameTimes[Pass.Pass], 0.0) + Milliseconds;
+			FrameBegin = std::min(FrameBegin, Begin);
+			FrameEnd = std::max(FrameEnd, End);
+		}
+		Frame.bPending = false;
+
+		// Nested passes overlap their parent, the span of the frame doesn't count them twice
+		m_LastFrameTime = FrameEnd > FrameBegin ? static_cast<float>(static_cast<double>(FrameEnd - FrameBegin) * 1e-6) : 0.0f;
+		m_FramesRead++;
+
+		for (size_t Pass = 0; Pass < m_Stats.size(); Pass++)
+		{
+			if (m_FrameTimes[Pass] < 0.0)
+				continue;
+
+			GPUPassStats& Stats = m_Stats[Pass];
+			const float Time = static_cast<float>(m_FrameTimes[Pass]);
+			Stats.Last = Time;
+			Stats.Min = Stats.Samples == 0 ? Time : std::min(Stats.Min, Time);
+			Stats.Max = Stats.Samples == 0 ? Time : std::max(Stats.Max, Time);
+			Stats.Total += m_FrameTimes[Pass];
+			Stats.Samples++;
+			Stats.Average = static_cast<float>(Stats.Total / static_cast<double>(Stats.Samples));
+		}
+		return true;
+	}
+
+	uint32_t GPUProfiler::FindOrAddPass(const char* Name)
+	{
+		for (uint32_t Pass = 0; Pass < m_Stats.size(); Pass++)
+		{
+			if (m_Stats[Pass].Name == Name)
+				return Pass;
+		}
+		m_Stats.push_back({ Name });
+		return static_cast<uint32_t>(m_Stats.size() - 1);
+	}
+
+	uint32_t GPUProfiler::IssueTimestamp()
+	{
+		FrameRecord& Frame = m_Frames[m_Current];
+		if (Frame.UsedQueries == Frame.Queries.size())
+		{
+			Frame.Queries.push_back(0);
+			glGenQueries(1, &Frame.Queries.back());
+		}
+		glQueryCounter(Frame.Queries[Frame.UsedQueries], GL_TIMESTAMP);
+		return Frame.UsedQueries++;
+	}
+
+	const std::vector<GPUPassStats>& GPUProfiler::GetPassStats() const
+	{
+		return m_Stats;
+	}
+
+	const GPUPassStats* GPUProfiler::FindPass(std::string_view Name) const
+	{
+		for (const GPUPassStats& Stats : m_Stats)
+		{
+			if (Stats.Name == Name)
+				return Stats.Samples > 0 ? &Stats : nullptr;
+		}
+		return nullptr;
+	}
+
+	float GPUProfiler::GetLastFrameTime() const
+	{
+		return m_LastFrameTime;
+	}
+
+	uint64_t GPUProfiler::GetFramesRead() const
+	{
+		return m_FramesRead;
+	}
+
+	void GPUProfiler::ResetStats()
+	{
+		for (GPUPassStats& Stats : m_Stats)
+		{
+			Stats = GPUPassStats{ Stats.Name };
+		}
+	}
+
+} // namespace fgl
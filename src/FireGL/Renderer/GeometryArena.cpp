@@ -0,0 +1,687 @@
+#include <FireGL/Renderer/GeometryArena.h>
+#include <FireGL/Renderer/MatrixBuffer.h>
+#include <FireGL/Renderer/GPUMemoryTracker.h>
+#include <FireGL/Renderer/RenderStats.h>
+#include <FireGL/Renderer/GLExtensions.h>
+
+#include <External/glm/gtc/packing.hpp>
+
+namespace fgl
+{
+
+	namespace
+	{
+		/** @return The bytes of one index of a type. */
+		size_t GetIndexWidth(GLenum IndexType)
+		{
+			return IndexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t);
+		}
+
+		using Type = VertexAttributeType;
+
+		const VertexAttribute StandardAttributes[] = {
+			{ 0, 3, Type::Float, false, false, offsetof(Vertex, Position) },
+			{ 1, 3, Type::Float, false, false, offsetof(Vertex, Normal) },
+			{ 2, 2, Type::Float, false, false, offsetof(Vertex, TexCoords) }
+		};
+
+		// Decoded by the vertex fetch, shaders still receive vec3 / vec3 / vec2 inputs
+		const VertexAttribute PackedAttributes[] = {
+			{ 0, 3, Type::HalfFloat, false, false, offsetof(PackedVertex, Position) },
+			{ 1, 4, Type::Int2101010, true, false, offsetof(PackedVertex, Normal) },
+			{ 2, 2, Type::HalfFloat, false, false, offsetof(PackedVertex, TexCoords) }
+		};
+
+		// Locations 3 to 12 are taken by the instanced attributes, the skin follows them
+		const VertexAttribute SkinnedAttributes[] = {
+			{ 0, 3, Type::Float, false, false, offsetof(SkinnedVertex, Position) },
+			{ 1, 3, Type::Float, false, false, offsetof(SkinnedVertex, Normal) },
+			{ 2, 2, Type::Float, false, false, offsetof(SkinnedVertex, TexCoords) },
+			{ 13, 4, Type::UnsignedShort, false, true, offsetof(SkinnedVertex, BoneIndices) },
+			{ 14, 4, Type::UnsignedByte, true, false, offsetof(SkinnedVertex, BoneWeights) }
+		};
+
+		// A lightmapped mesh is never skinned, its second UV set takes the first skin location
+		const VertexAttribute LightmappedAttributes[] = {
+			{ 0, 3, Type::Float, false, false, offsetof(LightmappedVertex, Position) },
+			{ 1, 3, Type::Float, false, false, offsetof(LightmappedVertex, Normal) },
+			{ 2, 2, Type::Float, false, false, offsetof(LightmappedVertex, TexCoords) },
+			{ 13, 2, Type::Float, false, false, offsetof(LightmappedVertex, LightmapCoords) }
+		};
+
+		/**
+		 * @return The instanced attributes read from the given instance on: locations 3 to 6 hold the Model matrix,
+		 *         7 to 9 the normal matrix, one column per location, 10 the texture array layers, 11 the material index,
+		 *         12 the bone palette offset, reflection probe and point lights, and 15 the payload.
+		 */
+		std::array<VertexAttribute, 11> GetInstanceAttributes(size_t BaseInstance)
+		{
+			const size_t BaseOffset = BaseInstance * sizeof(InstanceData);
+			const size_t Model = BaseOffset + offsetof(InstanceData, Model);
+			const size_t NormalMatrix = BaseOffset + offsetof(InstanceData, NormalMatrix);
+			return { {
+				{ 3, 4, Type::Float, false, false, Model },
+				{ 4, 4, Type::Float, false, false, Model + sizeof(glm::vec4) },
+				{ 5, 4, Type::Float, false, false, Model + 2 * sizeof(glm::vec4) },
+				{ 6, 4, Type::Float, false, false, Model + 3 * sizeof(glm::vec4) },
+				{ 7, 4, Type::Float, false, false, NormalMatrix },
+				{ 8, 4, Type::Float, false, false, NormalMatrix + sizeof(glm::vec4) },
+				{ 9, 4, Type::Float, false, false, NormalMatrix + 2 * sizeof(glm::vec4) },
+				{ 10, 4, Type::UnsignedInt, false, true, BaseOffset + offsetof(InstanceData, TextureLayers) },
+				{ 11, 1, Type::UnsignedInt, false, true, BaseOffset + offsetof(InstanceData, MaterialIndex) },
+				{ 12, 3, Type::UnsignedInt, false, true, BaseOffset + offsetof(InstanceData, BoneOffset) },
+				{ 15, 4, Type::Float, false, false, BaseOffset + offsetof(InstanceData, Payload) }
+			} };
+		}
+	}
+
+	const GeometryAllocation GeometryArena::s_EmptyAllocation;
+
+	GeometryLease::~GeometryLease()
+	{
+		// The queue is gone with its arena, there is nothing left to free then
+		if (std::shared_ptr<GeometryReleaseQueue> Releases = m_Releases.lock())
+		{
+			std::lock_guard<std::mutex> Lock(Releases->Mutex);
+			Releases->Handles.push_back(m_Handle);
+		}
+	}
+
+	GeometryArena::~GeometryArena()
+	{
+		Destroy();
+	}
+
+	void GeometryArena::Destroy()
+	{
+		RenderDevice& Device = RenderDevice::Get();
+		for (VertexPool& Pool : m_Pools)
+		{
+			if (Pool.VertexArray)
+			{
+				Device.DestroyVertexArray(Pool.VertexArray);
+				Device.DestroyBuffer(Pool.VertexBuffer);
+			}
+			Pool = VertexPool();
+		}
+
+		Device.DestroyVertexArray(m_PullingVertexArray);
+		Device.DestroyBuffer(m_IndexBuffer);
+		m_InstanceBuffer = BufferHandle();
+		m_IndexCapacity = 0;
+		m_IndexSize = 0;
+		m_IndexRanges = RangeList();
+		m_Records.clear();
+		m_FreeHandles.clear();
+		m_MovedBytes = 0;
+		for (std::unordered_map<uint64_t, SharedAllocation>& Shared : m_SharedAllocations)
+		{
+			Shared.clear();
+		}
+
+		// Leases still held refer to the records just cleared, expire their queue so they free nothing
+		m_Releases = std::make_shared<GeometryReleaseQueue>();
+	}
+
+	std::shared_ptr<GeometryLease> GeometryArena::Allocate(const std::vector<Vertex>& Vertices, const std::vector<unsigned int>& Indices, VertexFormat Format, uint64_t ContentHash, const std::vector<VertexSkin>& Skin,
+		const std::vector<glm::vec2>& LightmapCoords)
+	{
+		ProcessReleases();
+
+		// Identical meshes (e.g. every Cube) share one allocation while any of them is alive
+		std::unordered_map<uint64_t, SharedAllocation>& Shared = m_SharedAllocations[static_cast<size_t>(Format)];
+		if (ContentHash != 0)
+		{
+			auto Found = Shared.find(ContentHash);
+			if (Found != Shared.end())
+			{
+				if (std::shared_ptr<GeometryLease> Lease = Found->second.Lease.lock())
+					return Lease;
+
+				// Released but not freed yet, its handle waits in the queue
+				Shared.erase(Found);
+			}
+		}
+
+		const bool bShortIndices = Vertices.size() <= std::numeric_limits<uint16_t>::max();
+		const size_t IndexWidth = bShortIndices ? sizeof(uint16_t) : sizeof(uint32_t);
+		// Keep every mesh 4-byte aligned so both index widths can follow each other
+		const size_t IndexBytes = (Indices.size() * IndexWidth + 3) & ~size_t(3);
+
+		// Holes left by freed meshes first, else the end of the buffers
+		VertexPool& Pool = m_Pools[static_cast<size_t>(Format)];
+		size_t VertexOffset = 0;
+		if (!TakeFreeRange(Pool.Ranges, Vertices.size(), VertexOffset))
+		{
+			ReserveVertices(Pool, Format, Vertices.size());
+			VertexOffset = Pool.Count;
+			Pool.Count += Vertices.size();
+		}
+		size_t IndexOffset = 0;
+		if (!TakeFreeRange(m_IndexRanges, IndexBytes, IndexOffset))
+		{
+			ReserveIndices(IndexBytes);
+			IndexOffset = m_IndexSize;
+			m_IndexSize += IndexBytes;
+		}
+
+		GeometryAllocation Allocation;
+		Allocation.Format = Format;
+		Allocation.VertexArray = Pool.VertexArray.ID;
+		Allocation.BaseVertex = static_cast<uint32_t>(VertexOffset);
+		Allocation.FirstIndex = static_cast<uint32_t>(IndexOffset / IndexWidth);
+		Allocation.IndexCount = static_cast<uint32_t>(Indices.size());
+		Allocation.IndexType = bShortIndices ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+
+		RenderDevice& Device = RenderDevice::Get();
+		const size_t VertexSize = GetVertexSize(Format);
+		if (Format == VertexFormat::Packed)
+		{
+			const std::vector<PackedVertex> Packed = PackVertices(Vertices);
+			Device.UpdateBuffer(Pool.VertexBuffer, VertexOffset * VertexSize, Packed.size() * VertexSize, Packed.data());
+		}
+		else if (Format == VertexFormat::Skinned)
+		{
+			const std::vector<SkinnedVertex> Skinned = SkinVertices(Vertices, Skin);
+			Device.UpdateBuffer(Pool.VertexBuffer, VertexOffset * VertexSize, Skinned.size() * VertexSize, Skinned.data());
+		}
+		else if (Format == VertexFormat::Lightmapped)
+		{
+			const std::vector<LightmappedVertex> Lightmapped = LightmapVertices(Vertices, LightmapCoords);
+			Device.UpdateBuffer(Pool.VertexBuffer, VertexOffset * VertexSize, Lightmapped.size() * VertexSize, Lightmapped.data());
+		}
+		else
+		{
+			Device.UpdateBuffer(Pool.VertexBuffer, VertexOffset * VertexSize, Vertices.size() * VertexSize, Vertices.data());
+		}
+
+		if (bShortIndices)
+		{
+			const std::vector<uint16_t> ShortIndices(Indices.begin(), Indices.end());
+			Device.UpdateBuffer(m_IndexBuffer, IndexOffset, ShortIndices.size() * IndexWidth, ShortIndices.data());
+		}
+		else
+		{
+			Device.UpdateBuffer(m_IndexBuffer, IndexOffset, Indices.size() * IndexWidth, Indices.data());
+		}
+
+		RenderCounters::CountUpload(Vertices.size() * VertexSize + Indices.size() * IndexWidth);
+
+		uint32_t Handle = 0;
+		if (!m_FreeHandles.empty())
+		{
+			Handle = m_FreeHandles.back();
+			m_FreeHandles.pop_back();
+		}
+		else
+		{
+			Handle = static_cast<uint32_t>(m_Records.size());
+			m_Records.emplace_back();
+		}
+
+		AllocationRecord& Record = m_Records[Handle];
+		Record.Allocation = Allocation;
+		Record.VertexCount = Vertices.size();
+		Record.IndexBytes = IndexBytes;
+		Record.ContentHash = ContentHash;
+		Record.bLive = true;
+		if (Record.VertexCount > 0)
+		{
+			Pool.Ranges.Live.emplace(VertexOffset, LiveRange{ Handle, Record.VertexCount });
+		}
+		if (Record.IndexBytes > 0)
+		{
+			m_IndexRanges.Live.emplace(IndexOffset, LiveRange{ Handle, Record.IndexBytes });
+		}
+
+		std::shared_ptr<GeometryLease> Lease(new GeometryLease(m_Releases, Handle));
+		if (ContentHash != 0)
+		{
+			Shared.emplace(ContentHash, SharedAllocation{ Handle, Lease });
+		}
+		return Lease;
+	}
+
+	bool GeometryArena::Compact(size_t BudgetBytes)
+	{
+		ProcessReleases();
+
+		m_MovedBytes = 0;
+		if (BudgetBytes == 0 || !m_IndexBuffer)
+			return false;
+
+		for (size_t FormatIndex = 0; FormatIndex < VertexFormatCount; FormatIndex++)
+		{
+			VertexPool& Pool = m_Pools[FormatIndex];
+			if (!Pool.VertexArray)
+				continue;
+
+			const VertexFormat Format = static_cast<VertexFormat>(FormatIndex);
+			const size_t VertexSize = GetVertexSize(Format);
+			m_MovedBytes += CompactRanges(Pool.VertexBuffer, VertexSize, Pool.Ranges, Pool.Count, BudgetBytes - std::min(m_MovedBytes, BudgetBytes),
+				[this](uint32_t Handle, size_t Offset) { m_Records[Handle].Allocation.BaseVertex = static_cast<uint32_t>(Offset); });
+
+			// Halve a buffer left three quarters empty, never below its first size
+			if (Pool.Count * 4 <= Pool.Capacity && Pool.Capacity > InitialVertexCapacity)
+			{
+				const size_t NewCapacity = std::max(Pool.Capacity / 2, InitialVertexCapacity);
+				RenderDevice::Get().ResizeBuffer(Pool.VertexBuffer, { NewCapacity * VertexSize, BufferUsage::Static, GPUMemoryCategory::Geometry, "GeometryArena vertices" }, Pool.Count * VertexSize);
+				Pool.Capacity = NewCapacity;
+				ConfigureVertexAttributes(Pool, Format);
+			}
+		}
+
+		m_MovedBytes += CompactRanges(m_IndexBuffer, 1, m_IndexRanges, m_IndexSize, BudgetBytes - std::min(m_MovedBytes, BudgetBytes),
+			[this](uint32_t Handle, size_t Offset)
+			{
+				GeometryAllocation& Allocation = m_Records[Handle].Allocation;
+				Allocation.FirstIndex = static_cast<uint32_t>(Offset / GetIndexWidth(Allocation.IndexType));
+			});
+
+		if (m_IndexSize * 4 <= m_IndexCapacity && m_IndexCapacity > InitialIndexCapacity)
+		{
+			const size_t NewCapacity = std::max(m_IndexCapacity / 2, InitialIndexCapacity);
+			RenderDevice::Get().ResizeBuffer(m_IndexBuffer, { NewCapacity, BufferUsage::Static, GPUMemoryCategory::Geometry, "GeometryArena indices" }, m_IndexSize);
+			m_IndexCapacity = NewCapacity;
+			BindIndexBuffer();
+		}
+
+		RenderCounters::CountUpload(m_MovedBytes);
+		return m_MovedBytes > 0;
+	}
+
+	GeometryArenaStats GeometryArena::GetStats() const
+	{
+		GeometryArenaStats Stats;
+		Stats.AllocationCount = m_Records.size() - m_FreeHandles.size();
+		Stats.MovedBytes = m_MovedBytes;
+
+		for (size_t FormatIndex = 0; FormatIndex < VertexFormatCount; FormatIndex++)
+		{
+			const VertexPool& Pool = m_Pools[FormatIndex];
+			const size_t VertexSize = GetVertexSize(static_cast<VertexFormat>(FormatIndex));
+			Stats.CapacityBytes += Pool.Capacity * VertexSize;
+			Stats.UsedBytes += Pool.Count * VertexSize;
+			for (const auto& [Offset, Length] : Pool.Ranges.Free)
+			{
+				Stats.FreeBytes += Length * VertexSize;
+			}
+		}
+
+		Stats.CapacityBytes += m_IndexCapacity;
+		Stats.UsedBytes += m_IndexSize;
+		for (const auto& [Offset, Length] : m_IndexRanges.Free)
+		{
+			Stats.FreeBytes += Length;
+		}
+
+		// The ends of the buffers counted the holes below them
+		Stats.UsedBytes -= Stats.FreeBytes;
+		return Stats;
+	}
+
+	void GeometryArena::ProcessReleases()
+	{
+		std::vector<uint32_t> Released;
+		{
+			std::lock_guard<std::mutex> Lock(m_Releases->Mutex);
+			Released.swap(m_Releases->Handles);
+		}
+
+		for (uint32_t Handle : Released)
+		{
+			Free(Handle);
+		}
+	}
+
+	void GeometryArena::Free(uint32_t Handle)
+	{
+		if (Handle >= m_Records.size() || !m_Records[Handle].bLive)
+			return;
+
+		AllocationRecord& Record = m_Records[Handle];
+		const GeometryAllocation& Allocation = Record.Allocation;
+		VertexPool& Pool = m_Pools[static_cast<size_t>(Allocation.Format)];
+		if (Record.VertexCount > 0)
+		{
+			Pool.Ranges.Live.erase(Allocation.BaseVertex);
+			FreeRange(Pool.Ranges, Allocation.BaseVertex, Record.VertexCount, Pool.Count);
+		}
+		if (Record.IndexBytes > 0)
+		{
+			const size_t IndexOffset = Allocation.FirstIndex * GetIndexWidth(Allocation.IndexType);
+			m_IndexRanges.Live.erase(IndexOffset);
+			FreeRange(m_IndexRanges, IndexOffset, Record.IndexBytes, m_IndexSize);
+		}
+
+		// A newer allocation of the same content may have taken the entry already
+		if (Record.ContentHash != 0)
+		{
+			std::unordered_map<uint64_t, SharedAllocation>& Shared = m_SharedAllocations[static_cast<size_t>(Allocation.Format)];
+			auto Found = Shared.find(Record.ContentHash);
+			if (Found != Shared.end() && Found->second.Handle == Handle)
+			{
+				Shared.erase(Found);
+			}
+		}
+
+		Record = AllocationRecord();
+		m_FreeHandles.push_back(Handle);
+	}
+
+	bool GeometryArena::TakeFreeRange(RangeList& Ranges, size_t Length, size_t& Offset)
+	{
+		if (Length == 0)
+			return false;
+
+		for (auto Hole = Ranges.Free.begin(); Hole != Ranges.Free.end(); ++Hole)
+		{
+			if (Hole->second < Length)
+				continue;
+
+			Offset = Hole->first;
+			const size_t Remaining = Hole->second - Length;
+			Ranges.Free.erase(Hole);
+			if (Remaining > 0)
+			{
+				Ranges.Free.emplace(Offset + Length, Remaining);
+			}
+			return true;
+		}
+		return false;
+	}
+
+	void GeometryArena::FreeRange(RangeList& Ranges, size_t Offset, size_t Length, size_t& End)
+	{
+		if (Offset + Length == End)
+		{
+			// The end moves down, over the hole below the range if there is one
+			End = Offset;
+			if (!Ranges.Free.empty())
+			{
+				auto Last = std::prev(Ranges.Free.end());
+				if (Last->first + Last->second == End)
+				{
+					End = Last->first;
+					Ranges.Free.erase(Last);
+				}
+			}
+			return;
+		}
+
+		auto Next = Ranges.Free.lower_bound(Offset);
+		if (Next != Ranges.Free.end() && Offset + Length == Next->first)
+		{
+			Length += Next->second;
+			Next = Ranges.Free.erase(Next);
+		}
+		if (Next != Ranges.Free.begin())
+		{
+			auto Previous = std::prev(Next);
+			if (Previous->first + Previous->second == Offset)
+			{
+				Previous->second += Length;
+				return;
+			}
+		}
+		Ranges.Free.emplace_hint(Next, Offset, Length);
+	}
+
+	size_t GeometryArena::CompactRanges(const BufferHandle& Buffer, size_t UnitSize, RangeList& Ranges, size_t& End, size_t BudgetBytes,
+		const std::function<void(uint32_t, size_t)>& OnMoved)
+	{
+		// Allocations tried per move, from the end of the buffer down
+		constexpr size_t MaxCandidates = 16;
+
+		size_t MovedBytes = 0;
+		while (MovedBytes < BudgetBytes && !Ranges.Free.empty())
+		{
+			bool bMoved = false;
+			size_t Candidates = 0;
+			for (auto Live = Ranges.Live.rbegin(); Live != Ranges.Live.rend() && Candidates < MaxCandidates; ++Live, Candidates++)
+			{
+				const size_t Source = Live->first;
+				const LiveRange Range = Live->second;
+
+				// The lowest hole below the allocation that fits it
+				auto Hole = Ranges.Free.begin();
+				while (Hole != Ranges.Free.end() && Hole->first < Source && Hole->second < Range.Length)
+				{
+					++Hole;
+				}
+				if (Hole == Ranges.Free.end() || Hole->first >= Source)
+					continue;
+
+				size_t Target = 0;
+				TakeFreeRange(Ranges, Range.Length, Target);
+
+				// Source and target never overlap, a copy within the buffer is allowed
+				RenderDevice::Get().CopyBuffer(Buffer, Source * UnitSize, Buffer, Target * UnitSize, Range.Length * UnitSize);
+
+				Ranges.Live.erase(Source);
+				Ranges.Live.emplace(Target, Range);
+				FreeRange(Ranges, Source, Range.Length, End);
+				OnMoved(Range.Handle, Target);
+
+				MovedBytes += Range.Length * UnitSize;
+				bMoved = true;
+				break;
+			}
+
+			if (!bMoved)
+				break;
+		}
+		return MovedBytes;
+	}
+
+	void GeometryArena::ReserveVertices(VertexPool& Pool, VertexFormat Format, size_t AdditionalVertices)
+	{
+		const size_t Required = Pool.Count + AdditionalVertices;
+		if (Pool.VertexArray && Required <= Pool.Capacity)
+			return;
+
+		const size_t VertexSize = GetVertexSize(Format);
+		const size_t NewCapacity = std::max(Required, std::max(Pool.Capacity * 2, InitialVertexCapacity));
+		const BufferDesc Desc{ NewCapacity * VertexSize, BufferUsage::Static, GPUMemoryCategory::Geometry, "GeometryArena vertices" };
+
+		RenderDevice& Device = RenderDevice::Get();
+		if (!Pool.VertexArray)
+		{
+			Pool.VertexBuffer = Device.CreateBuffer(Desc);
+
+			// Every VAO references the shared index buffer, create it with the first pool
+			if (!m_IndexBuffer)
+			{
+				m_IndexCapacity = InitialIndexCapacity;
+				m_IndexBuffer = Device.CreateBuffer({ m_IndexCapacity, BufferUsage::Static, GPUMemoryCategory::Geometry, "GeometryArena indices" });
+			}
+			Pool.VertexArray = Device.CreateVertexArray("GeometryArena vertex array " + std::to_string(static_cast<int>(Format)));
+			Device.SetIndexBuffer(Pool.VertexArray, m_IndexBuffer);
+		}
+		else
+		{
+			Device.ResizeBuffer(Pool.VertexBuffer, Desc, Pool.Count * VertexSize);
+		}
+
+		Pool.Capacity = NewCapacity;
+		ConfigureVertexAttributes(Pool, Format);
+	}
+
+	void GeometryArena::ReserveIndices(size_t AdditionalBytes)
+	{
+		const size_t Required = m_IndexSize + AdditionalBytes;
+		if (Required <= m_IndexCapacity)
+			return;
+
+		const size_t NewCapacity = std::max(Required, m_IndexCapacity * 2);
+		RenderDevice::Get().ResizeBuffer(m_IndexBuffer, { NewCapacity, BufferUsage::Static, GPUMemoryCategory::Geometry, "GeometryArena indices" }, m_IndexSize);
+		m_IndexCapacity = NewCapacity;
+		BindIndexBuffer();
+	}
+
+	void GeometryArena::BindIndexBuffer()
+	{
+		RenderDevice& Device = RenderDevice::Get();
+		for (const VertexPool& Pool : m_Pools)
+		{
+			if (Pool.VertexArray)
+			{
+				Device.SetIndexBuffer(Pool.VertexArray, m_IndexBuffer);
+			}
+		}
+		if (m_PullingVertexArray)
+		{
+			Device.SetIndexBuffer(m_PullingVertexArray, m_IndexBuffer);
+		}
+	}
+
+	void GeometryArena::ConfigureVertexAttributes(VertexPool& Pool, VertexFormat Format)
+	{
+		std::span<const VertexAttribute> Attributes = StandardAttributes;
+		if (Format == VertexFormat::Packed)
+		{
+			Attributes = PackedAttributes;
+		}
+		else if (Format == VertexFormat::Skinned)
+		{
+			Attributes = SkinnedAttributes;
+		}
+		else if (Format == VertexFormat::Lightmapped)
+		{
+			Attributes = LightmappedAttributes;
+		}
+		RenderDevice::Get().SetVertexAttributes(Pool.VertexArray, Pool.VertexBuffer, static_cast<uint32_t>(GetVertexSize(Format)), 0, Attributes);
+	}
+
+	void GeometryArena::SetInstanceBuffer(const BufferHandle& Buffer)
+	{
+		m_InstanceBuffer = Buffer;
+	}
+
+	void GeometryArena::ConfigureInstanceAttributes(VertexFormat Format)
+	{
+		VertexPool& Pool = m_Pools[static_cast<size_t>(Format)];
+		if (!Pool.VertexArray || !m_InstanceBuffer)
+			return;
+
+		RenderDevice::Get().SetVertexAttributes(Pool.VertexArray, m_InstanceBuffer, sizeof(InstanceData), 1, GetInstanceAttributes(0));
+		Pool.BoundBaseInstance = 0;
+	}
+
+	void GeometryArena::BindInstanceBase(VertexFormat Format, size_t BaseInstance)
+	{
+		VertexPool& Pool = m_Pools[static_cast<size_t>(Format)];
+		if (Pool.BoundBaseInstance == BaseInstance || !m_InstanceBuffer)
+			return;
+
+		RenderDevice::Get().SetVertexAttributes(Pool.VertexArray, m_InstanceBuffer, sizeof(InstanceData), 1, GetInstanceAttributes(BaseInstance));
+		Pool.BoundBaseInstance = BaseInstance;
+	}
+
+	bool GeometryArena::SupportsVertexPulling()
+	{
+		static const bool bSupported = []
+		{
+			if (!GLAD_GL_VERSION_4_3 || (!GLAD_GL_VERSION_4_6 && !GLExtensions::Has("GL_ARB_shader_draw_parameters")))
+				return false;
+
+			// Vertex shaders may have no storage block at all on a conformant 4.3 driver
+			GLint VertexBlocks = 0;
+			GLint Bindings = 0;
+			glGetIntegerv(GL_MAX_VERTEX_SHADER_STORAGE_BLOCKS, &VertexBlocks);
+			glGetIntegerv(GL_MAX_SHADER_STORAGE_BUFFER_BINDINGS, &Bindings);
+			return VertexBlocks >= static_cast<GLint>(VertexFormatCount + 1) && Bindings > static_cast<GLint>(PulledInstanceBindingPoint);
+		}();
+		return bSupported;
+	}
+
+	GLuint GeometryArena::GetPullingVertexArray()
+	{
+		if (!m_PullingVertexArray && m_IndexBuffer)
+		{
+			RenderDevice& Device = RenderDevice::Get();
+			m_PullingVertexArray = Device.CreateVertexArray("GeometryArena pulling vertex array");
+			Device.SetIndexBuffer(m_PullingVertexArray, m_IndexBuffer);
+		}
+		return m_PullingVertexArray.ID;
+	}
+
+	void GeometryArena::BindPulledBuffers(GLuint InstanceBuffer) const
+	{
+		for (size_t Format = 0; Format < VertexFormatCount; Format++)
+		{
+			glBindBufferBase(GL_SHADER_STORAGE_BUFFER, PulledVertexBindingPoint + static_cast<GLuint>(Format), m_Pools[Format].VertexBuffer.ID);
+		}
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, PulledInstanceBindingPoint, InstanceBuffer);
+	}
+
+	size_t GeometryArena::GetVertexSize(VertexFormat Format)
+	{
+		switch (Format)
+		{
+		case VertexFormat::Packed:
+			return sizeof(PackedVertex);
+		case VertexFormat::Skinned:
+			return sizeof(SkinnedVertex);
+		case VertexFormat::Lightmapped:
+			return sizeof(LightmappedVertex);
+		default:
+			return sizeof(Vertex);
+		}
+	}
+
+	std::vector<PackedVertex> GeometryArena::PackVertices(const std::vector<Vertex>& Vertices)
+	{
+		std::vector<PackedVertex> Packed(Vertices.size());
+		for (size_t i = 0; i < Vertices.size(); i++)
+		{
+			const Vertex& Source = Vertices[i];
+			PackedVertex& Target = Packed[i];
+
+			Target.Position[0] = glm::packHalf1x16(Source.Position.x);
+			Target.Position[1] = glm::packHalf1x16(Source.Position.y);
+			Target.Position[2] = glm::packHalf1x16(Source.Position.z);
+			Target.Position[3] = 0;
+
+			const float Length = glm::length(Source.Normal);
+			const glm::vec3 Normal = Length > 0.0f ? Source.Normal / Length : glm::vec3(0.0f);
+			Target.Normal = glm::packSnorm3x10_1x2(glm::vec4(Normal, 0.0f));
+
+			Target.TexCoords[0] = glm::packHalf1x16(Source.TexCoords.x);
+			Target.TexCoords[1] = glm::packHalf1x16(Source.TexCoords.y);
+		}
+		return Packed;
+	}
+
+	std::vector<SkinnedVertex> GeometryArena::SkinVertices(const std::vector<Vertex>& Vertices, const std::vector<VertexSkin>& Skin)
+	{
+		std::vector<SkinnedVertex> Skinned(Vertices.size());
+		for (size_t i = 0; i < Vertices.size(); i++)
+		{
+			SkinnedVertex& Target = Skinned[i];
+			Target.Position = Vertices[i].Position;
+			Target.Normal = Vertices[i].Normal;
+			Target.TexCoords = Vertices[i].TexCoords;
+
+			const VertexSkin Influences = i < Skin.size() ? Skin[i] : VertexSkin();
+			std::copy(std::begin(Influences.BoneIndices), std::end(Influences.BoneIndices), Target.BoneIndices);
+			std::copy(std::begin(Influences.BoneWeights), std::end(Influences.BoneWeights), Target.BoneWeights);
+		}
+		return Skinned;
+	}
+
+	std::vector<LightmappedVertex> GeometryArena::LightmapVertices(const std::vector<Vertex>& Vertices, const std::vector<glm::vec2>& LightmapCoords)
+	{
+		std::vector<LightmappedVertex> Lightmapped(Vertices.size());
+		for (size_t i = 0; i < Vertices.size(); i++)
+		{
+			LightmappedVertex& Target = Lightmapped[i];
+			Target.Position = Vertices[i].Position;
+			Target.Normal = Vertices[i].Normal;
+			Target.TexCoords = Vertices[i].TexCoords;
+			Target.LightmapCoords = i < LightmapCoords.size() ? LightmapCoords[i] : glm::vec2(0.0f);
+		}
+		return Lightmapped;
+	}
+
+} // namespace fgl
\ No newline at end of file
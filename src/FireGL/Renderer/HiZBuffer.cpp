@@ -0,0 +1,251 @@
+#include <FireGL/Renderer/HiZBuffer.h>
+#include <FireGL/Renderer/GLStateCache.h>
+#include <FireGL/Renderer/GPUMemoryTracker.h>
+#include <FireGL/Core/BaseLog.h>
+
+namespace fgl
+{
+
+	namespace
+	{
+		constexpr GLuint WorkgroupSize = 8;
+
+		constexpr std::string_view CopyCode = R"(#version 430 core
+layout (local_size_x = 8, local_size_y = 8) in;
+
+uniform sampler2D Depth;
+layout (r32f, binding = 0) writeonly uniform image2D Destination;
+
+void main()
+{
+    ivec2 Texel = ivec2(gl_GlobalInvocationID.xy);
+    if (any(greaterThanEqual(Texel, imageSize(Destination))))
+        return;
+
+    imageStore(Destination, Texel, vec4(texelFetch(Depth, Texel, 0).r));
+})";
+
+		// Odd sizes fold their last row and column into the last texel, no depth is left out of the level above
+		constexpr std::string_view ReduceCode = R"(#version 430 core
+layout (local_size_x = 8, local_size_y = 8) in;
+
+layout (r32f, binding = 0) readonly uniform image2D Source;
+layout (r32f, binding = 1) writeonly uniform image2D Destination;
+
+void main()
+{
+    ivec2 Texel = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 DestinationSize = imageSize(Destination);
+    if (any(greaterThanEqual(Texel, DestinationSize)))
+        return;
+
+    ivec2 SourceSize = imageSize(Source);
+    ivec2 First = Texel * 2;
+    ivec2 Last = min(First + 1 + ivec2(equal(Texel, DestinationSize - 1)) * (SourceSize & 1), SourceSize - 1);
+
+    float Depth = 0.0;
+    for (int Y = First.y; Y <= Last.y; Y++)
+    {
+        for (int X = First.x; X <= Last.x; X++)
+        {
+            Depth = max(Depth, imageLoad(Source, ivec2(X, Y)).r);
+        }
+    }
+    imageStore(Destination, Texel, vec4(Depth));
+})";
+
+		GLuint GetGroupCount(GLint Size)
+		{
+			return (static_cast<GLuint>(Size) + WorkgroupSize - 1) / WorkgroupSize;
+		}
+	}
+
+	bool HiZBuffer::IsSupported()
+	{
+		return GLAD_GL_VERSION_4_3;
+	}
+
+	void HiZBuffer::Create()
+	{
+		m_CopyShader = Shader::CreateComputeFromSource(CopyCode);
+		m_ReduceShader = Shader::CreateComputeFromSource(ReduceCode);
+	}
+
+	void HiZBuffer::Destroy()
+	{
+		DestroyTextures();
+		for (std::unique_ptr<Shader>* Program : { &m_CopyShader, &m_ReduceShader })
+		{
+			if (*Program)
+			{
+				(*Program)->Cleanup();
+				Program->reset();
+			}
+		}
+	}
+
+	bool HiZBuffer::IsCreated() const
+	{
+		return m_CopyShader != nullptr;
+	}
+
+	void HiZBuffer::DestroyTextures()
+	{
+		m_bValid = false;
+		if (m_DepthFramebuffer == 0)
+			return;
+
+		glDeleteFramebuffers(1, &m_DepthFramebuffer);
+		m_DepthFramebuffer = 0;
+		for (GLuint* Texture : { &m_DepthCopy, &m_Pyramid })
+		{
+			glDeleteTextures(1, Texture);
+			GLStateCache::OnTextureDeleted(*Texture);
+			GPUMemoryTracker::UntrackTexture(*Texture);
+			*Texture = 0;
+		}
+	}
+
+	GLenum HiZBuffer::GetReadDepthFormat()
+	{
+		GLint ReadFramebuffer = 0;
+		glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &ReadFramebuffer);
+
+		// The default framebuffer names its buffers, framebuffer objects their attachments
+		const GLenum DepthAttachment = ReadFramebuffer == 0 ? GL_DEPTH : GL_DEPTH_ATTACHMENT;
+		const GLenum StencilAttachment = ReadFramebuffer == 0 ? GL_STENCIL : GL_STENCIL_ATTACHMENT;
+		GLint DepthSize = 0, StencilSize = 0, ComponentType = GL_UNSIGNED_NORMALIZED;
+		glGetFramebufferAttachmentParameteriv(GL_READ_FRAMEBUFFER, DepthAttachment, GL_FRAMEBUFFER_ATTACHMENT_DEPTH_SIZE, &DepthSize);
+		glGetFramebufferAttachmentParameteriv(GL_READ_FRAMEBUFFER, DepthAttachment, GL_FRAMEBUFFER_ATTACHMENT_COMPONENT_TYPE, &ComponentType);
+		glGetFramebufferAttachmentParameteriv(GL_READ_FRAMEBUFFER, StencilAttachment, GL_FRAMEBUFFER_ATTACHMENT_STENCIL_SIZE, &StencilSize);
+
+		// Depth blits require both framebuffers to have the same depth and stencil formats
+		if (ComponentType == GL_FLOAT)
+			return StencilSize > 0 ? GL_DEPTH32F_STENCIL8 : GL_DEPTH_COMPONENT32F;
+		if (StencilSize > 0)
+			return GL_DEPTH24_STENCIL8;
+		if (DepthSize == 16)
+			return GL_DEPTH_COMPONENT16;
+		if (DepthSize == 32)
+			return GL_DEPTH_COMPONENT32;
+		return GL_DEPTH_COMPONENT24;
+	}
+
+	void HiZBuffer::Allocate(GLint Width, GLint Height, GLenum DepthFormat)
+	{
+		DestroyTextures();
+		m_Width = Width;
+		m_Height = Height;
+		m_DepthFormat = DepthFormat;
+
+		uint32_t LevelCount = 1;
+		while ((std::max(Width, Height) >> LevelCount) > 0)
+		{
+			LevelCount++;
+		}
+		m_LevelCount = LevelCount;
+
+		glGenTextures(1, &m_DepthCopy);
+		GLStateCache::BindTexture(GL_TEXTURE_2D, m_DepthCopy);
+		glTexStorage2D(GL_TEXTURE_2D, 1, DepthFormat, Width, Height);
+		GPUMemoryTracker::TrackTexture(m_DepthCopy, GPUMemoryTracker::GetTextureSize(DepthFormat, Width, Height), GPUMemoryCategory::RenderTargets, "HiZBuffer");
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+		// Read texel by texel: no filtering across texels or levels
+		glGenTextures(1, &m_Pyramid);
+		GLStateCache::BindTexture(GL_TEXTURE_2D, m_Pyramid);
+		glTexStorage2D(GL_TEXTURE_2D, m_LevelCount, GL_R32F, Width, Height);
+		GPUMemoryTracker::TrackTexture(m_Pyramid, GPUMemoryTracker::GetTextureSize(GL_R32F, Width, Height, 1, m_LevelCount),
+			GPUMemoryCategory::RenderTargets, "HiZBuffer");
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+		glGenFramebuffers(1, &m_DepthFramebuffer);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_DepthFramebuffer);
+		const GLenum Attachment = DepthFormat == GL_DEPTH24_STENCIL8 || DepthFormat == GL_DEPTH32F_STENCIL8 ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+		glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, Attachment, GL_TEXTURE_2D, m_DepthCopy, 0);
+		glDrawBuffer(GL_NONE);
+		LOG_ASSERT(glCheckFramebufferStatus(GL_DRAW_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE, "Hi-Z depth framebuffer is incomplete");
+	}
+
+	void HiZBuffer::Build(const glm::mat4& ViewProjection)
+	{
+		GLint Viewport[4];
+		glGetIntegerv(GL_VIEWPORT, Viewport);
+		GLint DrawFramebuffer = 0;
+		glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &DrawFramebuffer);
+		GLint ReadFramebuffer = 0;
+		glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &ReadFramebuffer);
+
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, DrawFramebuffer);
+		const GLenum DepthFormat = GetReadDepthFormat();
+		if (m_DepthFramebuffer == 0 || Viewport[2] != m_Width || Viewport[3] != m_Height || DepthFormat != m_DepthFormat)
+		{
+			Allocate(Viewport[2], Viewport[3], DepthFormat);
+		}
+
+		// Resolves multisampled depth, the blit needs equal rectangles for that
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_DepthFramebuffer);
+		glBlitFramebuffer(Viewport[0], Viewport[1], Viewport[0] + m_Width, Viewport[1] + m_Height,
+			0, 0, m_Width, m_Height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, ReadFramebuffer);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, DrawFramebuffer);
+
+		m_CopyShader->Activate();
+		GLStateCache::BindTextureUnit(TextureUnit, GL_TEXTURE_2D, m_DepthCopy);
+		m_CopyShader->SetInt("Depth", TextureUnit);
+		glBindImageTexture(0, m_Pyramid, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+		glDispatchCompute(GetGroupCount(m_Width), GetGroupCount(m_Height), 1);
+
+		m_ReduceShader->Activate();
+		GLint Width = m_Width, Height = m_Height;
+		for (uint32_t Level = 1; Level < m_LevelCount; Level++)
+		{
+			Width = std::max(Width / 2, 1);
+			Height = std::max(Height / 2, 1);
+			glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+			glBindImageTexture(0, m_Pyramid, Level - 1, GL_FALSE, 0, GL_READ_ONLY, GL_R32F);
+			glBindImageTexture(1, m_Pyramid, Level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+			glDispatchCompute(GetGroupCount(Width), GetGroupCount(Height), 1);
+		}
+
+		// Read by the next frame's culling pass through a sampler
+		glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+		m_ViewProjection = ViewProjection;
+		m_bValid = true;
+	}
+
+	void HiZBuffer::Invalidate()
+	{
+		m_bValid = false;
+	}
+
+	bool HiZBuffer::IsValid() const
+	{
+		return m_bValid;
+	}
+
+	GLuint HiZBuffer::GetTexture() const
+	{
+		return m_Pyramid;
+	}
+
+	glm::vec2 HiZBuffer::GetSize() const
+	{
+		return glm::vec2(m_Width, m_Height);
+	}
+
+	uint32_t HiZBuffer::GetMaxLevel() const
+	{
+		return m_LevelCount - 1;
+	}
+
+	const glm::mat4& HiZBuffer::GetViewProjection() const
+	{
+		return m_ViewProjection;
+	}
+
+} // namespace fgl
@@ -0,0 +1,226 @@
+#include <FireGL/Renderer/HitchRecorder.h>
+#include <FireGL/Renderer/Renderer.h>
+#include <FireGL/Renderer/GPUProfiler.h>
+#include <FireGL/Renderer/GPUMemoryTracker.h>
+#include <FireGL/Core/MemoryTracker.h>
+#include <FireGL/Core/Profiler.h>
+#include <FireGL/Core/BaseLog.h>
+
+#include <cstdarg>
+#include <filesystem>
+
+namespace fgl
+{
+
+	namespace
+	{
+		constexpr int FramesProcess = 1; ///< Trace process of the frame spans and counters, the zones are in process 0.
+
+		/** Appends printf-style text to Events. */
+		void Append(std::string& Events, const char* Format, ...)
+		{
+			char Buffer[512];
+			va_list Arguments;
+			va_start(Arguments, Format);
+			const int Length = std::vsnprintf(Buffer, sizeof(Buffer), Format, Arguments);
+			va_end(Arguments);
+			if (Length > 0)
+			{
+				Events.append(Buffer, std::min<size_t>(static_cast<size_t>(Length), sizeof(Buffer) - 1));
+			}
+		}
+
+		/** Appends a counter track sample, in microseconds like the zones. */
+		void AppendCounter(std::string& Events, const char* Name, uint64_t Time, const char* Series, double Value)
+		{
+			Append(Events, ",\n{\"name\":\"%s\",\"ph\":\"C\",\"pid\":%d,\"ts\":%.3f,\"args\":{\"%s\":%.3f}}",
+				Name, FramesProcess, static_cast<double>(Time) * 1e-3, Series, Value);
+		}
+
+		double ToMegabytes(uint64_t Bytes)
+		{
+			return static_cast<double>(Bytes) / (1024.0 * 1024.0);
+		}
+	}
+
+	HitchRecorder::HitchRecorder(Renderer& Target)
+		: m_Renderer(Target)
+	{
+	}
+
+	void HitchRecorder::SetEnabled(bool bEnabled)
+	{
+		if (bEnabled == m_bEnabled)
+			return;
+
+		m_bEnabled = bEnabled;
+		GPUProfiler& Profiler = m_Renderer.GetGPUProfiler();
+		if (bEnabled)
+		{
+			m_bProfilingWasEnabled = Profiler.IsEnabled();
+			m_Renderer.SetGPUProfiling(true);
+			m_Frames.assign(Capacity, FrameRecord());
+			m_FrameCount = 0;
+			m_LastRecord = 0;
+		}
+		else
+		{
+			m_Renderer.SetGPUProfiling(m_bProfilingWasEnabled);
+			m_Frames.clear();
+			m_Frames.shrink_to_fit();
+		}
+	}
+
+	bool HitchRecorder::IsEnabled() const
+	{
+		return m_bEnabled;
+	}
+
+	void HitchRecorder::SetThreshold(double Milliseconds)
+	{
+		m_Threshold = std::max(Milliseconds, 0.0);
+	}
+
+	void HitchRecorder::SetWindow(double Seconds)
+	{
+		m_Window = static_cast<uint64_t>(std::max(Seconds, 0.0) * 1e9);
+	}
+
+	void HitchRecorder::SetOutputDirectory(std::string_view Directory)
+	{
+		m_OutputDirectory = Directory;
+	}
+
+	void HitchRecorder::SetMaxDumps(uint32_t MaxDumps)
+	{
+		m_MaxDumps = MaxDumps;
+	}
+
+	void HitchRecorder::Record()
+	{
+		if (!m_bEnabled)
+			return;
+
+		// The first call only starts the first frame
+		const uint64_t Now = Profiler::Now();
+		if (m_LastRecord == 0)
+		{
+			m_LastRecord = Now;
+			return;
+		}
+
+		FrameRecord& Frame = m_Frames[m_FrameCount % Capacity];
+		Frame.Index = m_FrameCount++;
+		Frame.Start = m_LastRecord;
+		Frame.End = Now;
+		Frame.GPUTime = m_Renderer.GetGPUProfiler().GetLastFrameTime();
+		Frame.Stats = m_Renderer.GetStats();
+		Frame.HeapBytes = MemoryTracker::GetTotal();
+		Frame.VideoBytes = GPUMemoryTracker::GetTotal();
+		m_LastRecord = Now;
+
+		const double FrameTime = static_cast<double>(Frame.End - Frame.Start) * 1e-6;
+		if (FrameTime <= m_Threshold || m_DumpCount >= m_MaxDumps || (m_LastDump != 0 && Now - m_LastDump < m_Window))
+			return;
+
+		// Named after the frame, so the dumps of a session sort in order
+		std::filesystem::path Path(m_OutputDirectory);
+		std::error_code Error;
+		if (!m_OutputDirectory.empty())
+		{
+			std::filesystem::create_directories(Path, Error);
+		}
+		Path /= "hitch-" + std::to_string(Frame.Index) + "-" + std::to_string(static_cast<uint64_t>(FrameTime)) + "ms.json";
+		m_LastDump = Now;
+		if (WriteDump(Path.string(), &Frame))
+		{
+			LOG_INFO("Frame " + std::to_string(Frame.Index) + " took " + std::to_string(FrameTime) + " ms, wrote " + Path.string() + ".")
+		}
+	}
+
+	bool HitchRecorder::Dump(std::string_view Path)
+	{
+		return WriteDump(Path, nullptr);
+	}
+
+	uint32_t HitchRecorder::GetDumpCount() const
+	{
+		return m_DumpCount;
+	}
+
+	const std::string& HitchRecorder::GetLastDumpPath() const
+	{
+		return m_LastDumpPath;
+	}
+
+	bool HitchRecorder::WriteDump(std::string_view Path, const FrameRecord* Hitch)
+	{
+		const uint64_t End = Hitch ? Hitch->End : Profiler::Now();
+		const uint64_t Since = End > m_Window ? End - m_Window : 0;
+
+		std::string Events;
+		WriteEvents(Events, Since, Hitch);
+		if (!Profiler::WriteChromeTrace(Path, Since, std::string_view(Events).substr(Events.empty() ? 0 : 2)))
+		{
+			LOG_ERROR("Failed to write the hitch trace " + std::string(Path) + ".", false);
+			return false;
+		}
+
+		m_DumpCount++;
+		m_LastDumpPath = Path;
+		return true;
+	}
+
+	void HitchRecorder::WriteEvents(std::string& Events, uint64_t Since, const FrameRecord* Hitch) const
+	{
+		Append(Events, ",\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"Frames\"}}", FramesProcess);
+
+		// Oldest kept frame first, the ring holds min(count, capacity) frames
+		const uint64_t Kept = std::min<uint64_t>(m_FrameCount, m_Frames.size());
+		for (uint64_t Index = m_FrameCount - Kept; Index < m_FrameCount; Index++)
+		{
+			const FrameRecord& Frame = m_Frames[Index % Capacity];
+			if (Frame.End < Since)
+				continue;
+
+			const double CPUTime = static_cast<double>(Frame.End - Frame.Start) * 1e-6;
+			Append(Events, ",\n{\"name\":\"Frame %llu\",\"ph\":\"X\",\"pid\":%d,\"tid\":0,\"ts\":%.3f,\"dur\":%.3f}",
+				static_cast<unsigned long long>(Frame.Index), FramesProcess, static_cast<double>(Frame.Start) * 1e-3, CPUTime * 1e3);
+			AppendCounter(Events, "CPU frame", Frame.End, "ms", CPUTime);
+			AppendCounter(Events, "GPU frame", Frame.End, "ms", Frame.GPUTime);
+			AppendCounter(Events, "Draw calls", Frame.End, "calls", static_cast<double>(Frame.Stats.DrawCalls));
+			AppendCounter(Events, "Triangles", Frame.End, "triangles", static_cast<double>(Frame.Stats.Triangles));
+			AppendCounter(Events, "Binds", Frame.End, "binds",
+				static_cast<double>(Frame.Stats.ProgramBinds + Frame.Stats.TextureBinds + Frame.Stats.VertexArrayBinds));
+			AppendCounter(Events, "Uploaded", Frame.End, "MB", ToMegabytes(Frame.Stats.BytesUploaded));
+			AppendCounter(Events, "Visible objects", Frame.End, "objects", static_cast<double>(Frame.Stats.VisibleObjects));
+			AppendCounter(Events, "Heap", Frame.End, "MB", ToMegabytes(Frame.HeapBytes));
+			AppendCounter(Events, "VRAM", Frame.End, "MB", ToMegabytes(Frame.VideoBytes));
+		}
+
+		// The state at the end of the window, shown when the event is selected
+		const uint64_t Time = Hitch ? Hitch->End : Profiler::Now();
+		Append(Events, ",\n{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"g\",\"pid\":%d,\"tid\":0,\"ts\":%.3f,\"args\":{",
+			Hitch ? "Hitch" : "Dump", FramesProcess, static_cast<double>(Time) * 1e-3);
+		if (Hitch)
+		{
+			Append(Events, "\"frame\":%llu,\"cpu_ms\":%.3f,", static_cast<unsigned long long>(Hitch->Index),
+				static_cast<double>(Hitch->End - Hitch->Start) * 1e-6);
+		}
+		Append(Events, "\"threshold_ms\":%.3f", m_Threshold);
+		for (const GPUPassStats& Pass : m_Renderer.GetGPUProfiler().GetPassStats())
+		{
+			if (Pass.Samples > 0)
+			{
+				Append(Events, ",\"gpu %s ms\":%.3f", Pass.Name.c_str(), Pass.Last);
+			}
+		}
+		for (size_t Tag = 0; Tag < static_cast<size_t>(MemoryTag::Count); Tag++)
+		{
+			const MemoryTagStats Stats = MemoryTracker::GetStats(static_cast<MemoryTag>(Tag));
+			Append(Events, ",\"heap %s MB\":%.3f", MemoryTracker::GetTagName(static_cast<MemoryTag>(Tag)), ToMegabytes(Stats.CurrentBytes));
+		}
+		Append(Events, "}}");
+	}
+
+} // namespace fgl
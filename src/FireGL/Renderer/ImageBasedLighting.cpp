@@ -0,0 +1,635 @@
+#include <FireGL/Renderer/ImageBasedLighting.h>
+#include <FireGL/Renderer/Texture.h>
+#include <FireGL/Renderer/Shader.h>
+#include <FireGL/Renderer/GLStateCache.h>
+#include <FireGL/Renderer/GPUMemoryTracker.h>
+#include <FireGL/Renderer/RenderStats.h>
+#include <FireGL/Core/AssetArchive.h>
+#include <FireGL/Core/AssetId.h>
+#include <FireGL/Core/MappedFile.h>
+#include <FireGL/Core/BaseLog.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace fgl
+{
+
+	namespace
+	{
+		constexpr GLint EnvironmentUnit = 0; ///< Unit the environment is bound to while convolved.
+
+		constexpr std::string_view FullScreenVertexCode = R"(#version 410 core
+void main()
+{
+    // vertices (0, 0), (2, 0) and (0, 2) cover the target
+    vec2 Corner = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    gl_Position = vec4(Corner * 2.0 - 1.0, 0.0, 1.0);
+})";
+
+		// One fragment per coefficient of a 9x1 target, each integrating the whole sphere over a lat-long grid
+		constexpr std::string_view IrradianceFragmentCode = R"(#version 410 core
+out vec4 FragColor;
+
+uniform samplerCube Environment;
+uniform float SampleLod;
+
+const float PI = 3.14159265359;
+const int ThetaSteps = 64;
+const int PhiSteps = 128;
+
+void main()
+{
+    int Index = int(gl_FragCoord.x);
+    float DeltaTheta = PI / float(ThetaSteps);
+    float DeltaPhi = 2.0 * PI / float(PhiSteps);
+
+    vec3 Sum = vec3(0.0);
+    for (int ThetaStep = 0; ThetaStep < ThetaSteps; ThetaStep++)
+    {
+        float Theta = (float(ThetaStep) + 0.5) * DeltaTheta;
+        float SolidAngle = sin(Theta) * DeltaTheta * DeltaPhi;
+        for (int PhiStep = 0; PhiStep < PhiSteps; PhiStep++)
+        {
+            float Phi = (float(PhiStep) + 0.5) * DeltaPhi;
+            vec3 N = vec3(sin(Theta) * cos(Phi), cos(Theta), sin(Theta) * sin(Phi));
+
+            float Basis[9];
+            Basis[0] = 0.282095;
+            Basis[1] = 0.488603 * N.y;
+            Basis[2] = 0.488603 * N.z;
+            Basis[3] = 0.488603 * N.x;
+            Basis[4] = 1.092548 * N.x * N.y;
+            Basis[5] = 1.092548 * N.y * N.z;
+            Basis[6] = 0.315392 * (3.0 * N.z * N.z - 1.0);
+            Basis[7] = 1.092548 * N.x * N.z;
+            Basis[8] = 0.546274 * (N.x * N.x - N.y * N.y);
+            Sum += textureLod(Environment, N, SampleLod).rgb * Basis[Index] * SolidAngle;
+        }
+    }
+
+    // Convolution with the clamped cosine lobe scales each band
+    float Band = Index == 0 ? PI : (Index < 4 ? 2.0 * PI / 3.0 : PI / 4.0);
+    FragColor = vec4(Sum * Band, 1.0);
+})";
+
+		// GGX importance sampling, each sample read from the environment level matching its solid angle
+		constexpr std::string_view PrefilterFragmentCode = R"(#version 410 core
+out vec4 FragColor;
+
+uniform samplerCube Environment;
+uniform int Face;
+uniform float FaceSize;
+uniform float EnvironmentSize;
+uniform float Roughness;
+uniform int SampleCount;
+
+const float PI = 3.14159265359;
+
+vec3 GetDirection()
+{
+    vec2 Coord = gl_FragCoord.xy / FaceSize * 2.0 - 1.0;
+    if (Face == 0)      return vec3(1.0, -Coord.y, -Coord.x);
+    else if (Face == 1) return vec3(-1.0, -Coord.y, Coord.x);
+    else if (Face == 2) return vec3(Coord.x, 1.0, Coord.y);
+    else if (Face == 3) return vec3(Coord.x, -1.0, -Coord.y);
+    else if (Face == 4) return vec3(Coord.x, -Coord.y, 1.0);
+    return vec3(-Coord.x, -Coord.y, -1.0);
+}
+
+vec2 Hammersley(uint Index, uint Count)
+{
+    return vec2(float(Index) / float(Count), float(bitfieldReverse(Index)) * 2.3283064365386963e-10);
+}
+
+vec3 ImportanceSampleGGX(vec2 Xi, vec3 N, float Alpha)
+{
+    float Phi = 2.0 * PI * Xi.x;
+    float CosTheta = sqrt((1.0 - Xi.y) / (1.0 + (Alpha * Alpha - 1.0) * Xi.y));
+    float SinTheta = sqrt(1.0 - CosTheta * CosTheta);
+    vec3 Up = abs(N.z) < 0.999 ? vec3(0.0, 0.0, 1.0) : vec3(1.0, 0.0, 0.0);
+    vec3 TangentX = normalize(cross(Up, N));
+    vec3 TangentY = cross(N, TangentX);
+    return normalize(TangentX * (SinTheta * cos(Phi)) + TangentY * (SinTheta * sin(Phi)) + N * CosTheta);
+}
+
+void main()
+{
+    // Split-sum assumption: the view, normal and reflection directions coincide
+    vec3 N = normalize(GetDirection());
+    float BaseLod = max(log2(EnvironmentSize / FaceSize), 0.0);
+    if (Roughness == 0.0)
+    {
+        FragColor = vec4(textureLod(Environment, N, BaseLod).rgb, 1.0);
+        return;
+    }
+
+    float Alpha = Roughness * Roughness;
+    float TexelSolidAngle = 4.0 * PI / (6.0 * EnvironmentSize * EnvironmentSize);
+    vec3 Sum = vec3(0.0);
+    float Weight = 0.0;
+    for (int Sample = 0; Sample < SampleCount; Sample++)
+    {
+        vec3 H = ImportanceSampleGGX(Hammersley(uint(Sample), uint(SampleCount)), N, Alpha);
+        vec3 L = 2.0 * dot(N, H) * H - N;
+        float NdotL = dot(N, L);
+        if (NdotL <= 0.0)
+            continue;
+
+        // With N = V the pdf of L reduces to D / 4
+        float NdotH = max(dot(N, H), 0.0);
+        float Denominator = NdotH * NdotH * (Alpha * Alpha - 1.0) + 1.0;
+        float D = Alpha * Alpha / (PI * Denominator * Denominator);
+        float SampleSolidAngle = 1.0 / (float(SampleCount) * D * 0.25 + 0.0001);
+        float Lod = max(0.5 * log2(SampleSolidAngle / TexelSolidAngle) + 1.0, BaseLod);
+        Sum += textureLod(Environment, L, Lod).rgb * NdotL;
+        Weight += NdotL;
+    }
+    FragColor = vec4(Sum / max(Weight, 0.0001), 1.0);
+})";
+
+		// Split-sum BRDF: x = N.V, y = roughness, RG = scale and bias applied to F0
+		constexpr std::string_view BRDFFragmentCode = R"(#version 410 core
+out vec4 FragColor;
+
+uniform float Size;
+uniform int SampleCount;
+
+const float PI = 3.14159265359;
+
+vec2 Hammersley(uint Index, uint Count)
+{
+    return vec2(float(Index) / float(Count), float(bitfieldReverse(Index)) * 2.3283064365386963e-10);
+}
+
+float GeometrySchlickGGX(float NdotX, float K)
+{
+    return NdotX / (NdotX * (1.0 - K) + K);
+}
+
+void main()
+{
+    vec2 Coord = gl_FragCoord.xy / Size;
+    float NdotV = max(Coord.x, 0.001);
+    float Alpha = Coord.y * Coord.y;
+    vec3 V = vec3(sqrt(1.0 - NdotV * NdotV), 0.0, NdotV);
+
+    vec2 Sum = vec2(0.0);
+    for (int Sample = 0; Sample < SampleCount; Sample++)
+    {
+        vec2 Xi = Hammersley(uint(Sample), uint(SampleCount));
+        float Phi = 2.0 * PI * Xi.x;
+        float CosTheta = sqrt((1.0 - Xi.y) / (1.0 + (Alpha * Alpha - 1.0) * Xi.y));
+        float SinTheta = sqrt(1.0 - CosTheta * CosTheta);
+        vec3 H = vec3(SinTheta * cos(Phi), SinTheta * sin(Phi), CosTheta);
+        vec3 L = 2.0 * dot(V, H) * H - V;
+
+        float NdotL = max(L.z, 0.0);
+        if (NdotL <= 0.0)
+            continue;
+
+        float NdotH = max(H.z, 0.0);
+        float VdotH = max(dot(V, H), 0.0);
+        float K = Alpha / 2.0;
+        float G = GeometrySchlickGGX(NdotV, K) * GeometrySchlickGGX(NdotL, K);
+        float Visibility = G * VdotH / (NdotH * NdotV);
+        float Fresnel = pow(1.0 - VdotH, 5.0);
+        Sum += vec2((1.0 - Fresnel) * Visibility, Fresnel * Visibility);
+    }
+    FragColor = vec4(Sum / float(SampleCount), 0.0, 1.0);
+})";
+
+		constexpr std::string_view IrradianceNames[9] = {
+			"IrradianceSH[0]", "IrradianceSH[1]", "IrradianceSH[2]", "IrradianceSH[3]", "IrradianceSH[4]",
+			"IrradianceSH[5]", "IrradianceSH[6]", "IrradianceSH[7]", "IrradianceSH[8]"
+		};
+
+		constexpr uint64_t FNVPrime = 1099511628211ull;
+
+		/** Folds bytes into a running FNV-1a hash. */
+		void HashBytes(uint64_t& Hash, const void* Data, size_t Size)
+		{
+			const uint8_t* Bytes = static_cast<const uint8_t*>(Data);
+			for (size_t Index = 0; Index < Size; Index++)
+			{
+				Hash ^= Bytes[Index];
+				Hash *= FNVPrime;
+			}
+		}
+
+		/** @return The bytes of a face of a prefiltered level, stored as RGB half floats. */
+		size_t GetFaceSize(int Size, int Level)
+		{
+			const size_t LevelSize = static_cast<size_t>(std::max(Size >> Level, 1));
+			return LevelSize * LevelSize * 3 * sizeof(uint16_t);
+		}
+	}
+
+	ImageBasedLighting::~ImageBasedLighting()
+	{
+		Destroy();
+	}
+
+	bool ImageBasedLighting::Build(const Texture& Environment, const std::vector<std::string>& SourcePaths, const ImageBasedLightingSettings& Settings)
+	{
+		if (Environment.GetTarget() != GL_TEXTURE_CUBE_MAP || Environment.GetID() == 0)
+		{
+			LOG_ERROR("Image-based lighting needs a CubeMap environment.", false);
+			return false;
+		}
+
+		ImageBasedLightingSettings Clamped = Settings;
+		Clamped.PrefilteredSize = std::max(Clamped.PrefilteredSize, 1);
+		Clamped.PrefilteredLevels = std::clamp(Clamped.PrefilteredLevels, 1, static_cast<int>(GPUMemoryTracker::GetMipLevelCount(Clamped.PrefilteredSize, Clamped.PrefilteredSize)));
+		Clamped.BRDFLUTSize = std::max(Clamped.BRDFLUTSize, 1);
+
+		Destroy();
+		CreateTextures(Clamped);
+
+		const uint64_t Key = ComputeKey(SourcePaths, Clamped);
+		std::string CachePath;
+		if (!Clamped.CacheDirectory.empty())
+		{
+			char Name[17];
+			std::snprintf(Name, sizeof(Name), "%016llx", static_cast<unsigned long long>(Key));
+			CachePath = (std::filesystem::path(Clamped.CacheDirectory) / (std::string(Name) + Extension)).string();
+			if (LoadCache(CachePath, Key, Clamped))
+			{
+				m_bCached = true;
+				return true;
+			}
+		}
+
+		Precompute(Environment.GetID(), Clamped);
+		if (!CachePath.empty() && !SaveCache(CachePath, Key, Clamped))
+		{
+			LOG_ERROR("Failed to write the image-based lighting cache " + CachePath + ".", false);
+		}
+		return true;
+	}
+
+	void ImageBasedLighting::Destroy()
+	{
+		for (GLuint* Texture : { &m_PrefilteredMap, &m_BRDFLUT })
+		{
+			if (*Texture == 0)
+				continue;
+
+			glDeleteTextures(1, Texture);
+			GLStateCache::OnTextureDeleted(*Texture);
+			GPUMemoryTracker::UntrackTexture(*Texture);
+			*Texture = 0;
+		}
+		m_IrradianceSH = {};
+		m_PrefilteredLevels = 0;
+		m_bCached = false;
+	}
+
+	void ImageBasedLighting::Apply(const Shader& Target, uint32_t PrefilteredUnit, uint32_t BRDFUnit) const
+	{
+		GLStateCache::BindTextureUnit(PrefilteredUnit, GL_TEXTURE_CUBE_MAP, m_PrefilteredMap);
+		GLStateCache::BindTextureUnit(BRDFUnit, GL_TEXTURE_2D, m_BRDFLUT);
+		Target.SetInt("PrefilteredMap", static_cast<int>(PrefilteredUnit));
+		Target.SetInt("BRDFLUT", static_cast<int>(BRDFUnit));
+		Target.SetFloat("PrefilteredLevels", static_cast<float>(m_PrefilteredLevels));
+		for (size_t Index = 0; Index < m_IrradianceSH.size(); Index++)
+		{
+			Target.SetVec3(IrradianceNames[Index], m_IrradianceSH[Index]);
+		}
+	}
+
+	const std::array<glm::vec3, 9>& ImageBasedLighting::GetIrradianceSH() const
+	{
+		return m_IrradianceSH;
+	}
+
+	GLuint ImageBasedLighting::GetPrefilteredMap() const
+	{
+		return m_PrefilteredMap;
+	}
+
+	int ImageBasedLighting::GetPrefilteredLevels() const
+	{
+		return m_PrefilteredLevels;
+	}
+
+	GLuint ImageBasedLighting::GetBRDFLUT() const
+	{
+		return m_BRDFLUT;
+	}
+
+	bool ImageBasedLighting::WasCached() const
+	{
+		return m_bCached;
+	}
+
+	uint64_t ImageBasedLighting::ComputeKey(const std::vector<std::string>& SourcePaths, const ImageBasedLightingSettings& Settings)
+	{
+		uint64_t Hash = AssetId::HashKey("ImageBasedLighting");
+		for (const std::string& SourcePath : SourcePaths)
+		{
+			// Keyed by contents, not by path or timestamp, so renamed or re-exported identical skies share a cache
+			AssetArchive::Blob Packed;
+			if (AssetArchive::Read(SourcePath, Packed))
+			{
+				HashBytes(Hash, Packed.Data.data(), Packed.Data.size());
+				continue;
+			}
+
+			std::ifstream File(SourcePath, std::ios::binary);
+			if (!File)
+			{
+				LOG_ERROR("Failed to read " + SourcePath + " for the image-based lighting cache key.", false);
+				HashBytes(Hash, SourcePath.data(), SourcePath.size());
+				continue;
+			}
+
+			std::vector<char> Chunk(1 << 20);
+			while (File.read(Chunk.data(), static_cast<std::streamsize>(Chunk.size())) || File.gcount() > 0)
+			{
+				HashBytes(Hash, Chunk.data(), static_cast<size_t>(File.gcount()));
+			}
+		}
+
+		const int32_t Parameters[] = { static_cast<int32_t>(Version), Settings.PrefilteredSize, Settings.PrefilteredLevels,
+			Settings.PrefilterSamples, Settings.BRDFLUTSize, Settings.BRDFSamples };
+		HashBytes(Hash, Parameters, sizeof(Parameters));
+		return Hash;
+	}
+
+	void ImageBasedLighting::CreateTextures(const ImageBasedLightingSettings& Settings)
+	{
+		m_PrefilteredLevels = Settings.PrefilteredLevels;
+		glGenTextures(1, &m_PrefilteredMap);
+		GLStateCache::BindTexture(GL_TEXTURE_CUBE_MAP, m_PrefilteredMap);
+		for (int Level = 0; Level < m_PrefilteredLevels; Level++)
+		{
+			const int LevelSize = std::max(Settings.PrefilteredSize >> Level, 1);
+			for (int Face = 0; Face < 6; Face++)
+			{
+				glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + Face, Level, GL_RGB16F, LevelSize, LevelSize, 0, GL_RGB, GL_HALF_FLOAT, nullptr);
+			}
+		}
+		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, m_PrefilteredLevels - 1);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+		GLStateCache::BindTexture(GL_TEXTURE_CUBE_MAP, 0);
+		GPUMemoryTracker::TrackTexture(m_PrefilteredMap, GPUMemoryTracker::GetTextureSize(GL_RGB16F, Settings.PrefilteredSize, Settings.PrefilteredSize, 6, m_PrefilteredLevels),
+			GPUMemoryCategory::Textures, "ImageBasedLighting");
+
+		glGenTextures(1, &m_BRDFLUT);
+		GLStateCache::BindTexture(GL_TEXTURE_2D, m_BRDFLUT);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RG16F, Settings.BRDFLUTSize, Settings.BRDFLUTSize, 0, GL_RG, GL_HALF_FLOAT, nullptr);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		GLStateCache::BindTexture(GL_TEXTURE_2D, 0);
+		GPUMemoryTracker::TrackTexture(m_BRDFLUT, GPUMemoryTracker::GetTextureSize(GL_RG16F, Settings.BRDFLUTSize, Settings.BRDFLUTSize),
+			GPUMemoryCategory::Textures, "ImageBasedLighting");
+	}
+
+	void ImageBasedLighting::Precompute(GLuint Environment, const ImageBasedLightingSettings& Settings)
+	{
+		// The convolutions read coarse levels of the environment, uncompressed skies have none until now
+		GLint EnvironmentSize = 0;
+		GLint bCompressed = GL_FALSE;
+		GLStateCache::BindTexture(GL_TEXTURE_CUBE_MAP, Environment);
+		glGetTexLevelParameteriv(GL_TEXTURE_CUBE_MAP_POSITIVE_X, 0, GL_TEXTURE_WIDTH, &EnvironmentSize);
+		glGetTexLevelParameteriv(GL_TEXTURE_CUBE_MAP_POSITIVE_X, 0, GL_TEXTURE_COMPRESSED, &bCompressed);
+		if (!bCompressed)
+		{
+			glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
+			glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		}
+		EnvironmentSize = std::max(EnvironmentSize, 1);
+
+		GLint Viewport[4];
+		GLint PolygonMode[2];
+		GLint DrawFramebuffer = 0;
+		GLint ReadFramebuffer = 0;
+		GLint PackAlignment = 4;
+		glGetIntegerv(GL_VIEWPORT, Viewport);
+		glGetIntegerv(GL_POLYGON_MODE, PolygonMode);
+		glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &DrawFramebuffer);
+		glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &ReadFramebuffer);
+		glGetIntegerv(GL_PACK_ALIGNMENT, &PackAlignment);
+		const GLboolean bDepthTest = glIsEnabled(GL_DEPTH_TEST);
+		const GLboolean bBlend = glIsEnabled(GL_BLEND);
+		const GLboolean bSeamless = glIsEnabled(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+
+		// Run once per sky, the programs and framebuffer don't outlive the precomputation
+		std::unique_ptr<Shader> Irradiance = Shader::CreateFromSource(FullScreenVertexCode, IrradianceFragmentCode);
+		std::unique_ptr<Shader> Prefilter = Shader::CreateFromSource(FullScreenVertexCode, PrefilterFragmentCode);
+		std::unique_ptr<Shader> BRDF = Shader::CreateFromSource(FullScreenVertexCode, BRDFFragmentCode);
+		GLuint Framebuffer = 0;
+		GLuint VertexArray = 0;
+		GLuint Coefficients = 0;
+		glGenFramebuffers(1, &Framebuffer);
+		glGenVertexArrays(1, &VertexArray);
+		glGenTextures(1, &Coefficients);
+		GLStateCache::BindTexture(GL_TEXTURE_2D, Coefficients);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, 9, 1, 0, GL_RGBA, GL_FLOAT, nullptr);
+
+		glBindFramebuffer(GL_FRAMEBUFFER, Framebuffer);
+		glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+		glDisable(GL_DEPTH_TEST);
+		glDisable(GL_BLEND);
+		glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+		GLStateCache::BindTextureUnit(EnvironmentUnit, GL_TEXTURE_CUBE_MAP, Environment);
+		GLStateCache::BindVertexArray(VertexArray);
+
+		// Irradiance: the lat-long grid spaces its samples about 32 texels per face apart
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, Coefficients, 0);
+		glViewport(0, 0, 9, 1);
+		Irradiance->Activate();
+		Irradiance->SetInt("Environment", EnvironmentUnit);
+		Irradiance->SetFloat("SampleLod", std::max(std::log2(static_cast<float>(EnvironmentSize) / 32.0f), 0.0f));
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+		RenderCounters::CountDraw(1, 1);
+
+		float Pixels[9 * 4];
+		glPixelStorei(GL_PACK_ALIGNMENT, 4);
+		glReadBuffer(GL_COLOR_ATTACHMENT0);
+		glReadPixels(0, 0, 9, 1, GL_RGBA, GL_FLOAT, Pixels);
+		for (size_t Index = 0; Index < m_IrradianceSH.size(); Index++)
+		{
+			m_IrradianceSH[Index] = glm::vec3(Pixels[Index * 4], Pixels[Index * 4 + 1], Pixels[Index * 4 + 2]);
+		}
+
+		// Specular: roughness grows linearly with the level
+		Prefilter->Activate();
+		Prefilter->SetInt("Environment", EnvironmentUnit);
+		Prefilter->SetFloat("EnvironmentSize", static_cast<float>(EnvironmentSize));
+		Prefilter->SetInt("SampleCount", std::max(Settings.PrefilterSamples, 1));
+		for (int Level = 0; Level < m_PrefilteredLevels; Level++)
+		{
+			const int LevelSize = std::max(Settings.PrefilteredSize >> Level, 1);
+			glViewport(0, 0, LevelSize, LevelSize);
+			Prefilter->SetFloat("FaceSize", static_cast<float>(LevelSize));
+			Prefilter->SetFloat("Roughness", m_PrefilteredLevels > 1 ? static_cast<float>(Level) / static_cast<float>(m_PrefilteredLevels - 1) : 0.0f);
+			for (int Face = 0; Face < 6; Face++)
+			{
+				glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + Face, m_PrefilteredMap, Level);
+				Prefilter->SetInt("Face", Face);
+				glDrawArrays(GL_TRIANGLES, 0, 3);
+				RenderCounters::CountDraw(1, 1);
+			}
+		}
+
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_BRDFLUT, 0);
+		glViewport(0, 0, Settings.BRDFLUTSize, Settings.BRDFLUTSize);
+		BRDF->Activate();
+		BRDF->SetFloat("Size", static_cast<float>(Settings.BRDFLUTSize));
+		BRDF->SetInt("SampleCount", std::max(Settings.BRDFSamples, 1));
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+		RenderCounters::CountDraw(1, 1);
+
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, DrawFramebuffer);
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, ReadFramebuffer);
+		glViewport(Viewport[0], Viewport[1], Viewport[2], Viewport[3]);
+		glPolygonMode(GL_FRONT_AND_BACK, static_cast<GLenum>(PolygonMode[0]));
+		glPixelStorei(GL_PACK_ALIGNMENT, PackAlignment);
+		if (bDepthTest)
+		{
+			glEnable(GL_DEPTH_TEST);
+		}
+		if (bBlend)
+		{
+			glEnable(GL_BLEND);
+		}
+		if (!bSeamless)
+		{
+			glDisable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+		}
+		GLStateCache::BindVertexArray(0);
+		glDeleteVertexArrays(1, &VertexArray);
+		glDeleteFramebuffers(1, &Framebuffer);
+		GLStateCache::BindTextureUnit(EnvironmentUnit, GL_TEXTURE_CUBE_MAP, 0);
+		GLStateCache::BindTexture(GL_TEXTURE_2D, 0);
+		glDeleteTextures(1, &Coefficients);
+		GLStateCache::OnTextureDeleted(Coefficients);
+	}
+
+	bool ImageBasedLighting::LoadCache(const std::string& CachePath, uint64_t Key, const ImageBasedLightingSettings& Settings)
+	{
+		MappedFile File;
+		if (!File.Open(CachePath))
+			return false;
+
+		size_t Expected = sizeof(Header) + sizeof(m_IrradianceSH) + static_cast<size_t>(Settings.BRDFLUTSize) * Settings.BRDFLUTSize * 2 * sizeof(uint16_t);
+		for (int Level = 0; Level < m_PrefilteredLevels; Level++)
+		{
+			Expected += GetFaceSize(Settings.PrefilteredSize, Level) * 6;
+		}
+
+		Header FileHeader;
+		if (File.GetSize() != Expected)
+			return false;
+
+		std::memcpy(&FileHeader, File.GetData(), sizeof(FileHeader));
+		if (FileHeader.Magic != Magic || FileHeader.Version != Version || FileHeader.Key != Key || FileHeader.PrefilteredSize != Settings.PrefilteredSize
+			|| FileHeader.PrefilteredLevels != m_PrefilteredLevels || FileHeader.BRDFLUTSize != Settings.BRDFLUTSize)
+		{
+			return false;
+		}
+
+		// Uploaded straight from the mapping, the half floats are in the layout OpenGL reads back
+		const uint8_t* Data = File.GetData() + sizeof(FileHeader);
+		std::memcpy(m_IrradianceSH.data(), Data, sizeof(m_IrradianceSH));
+		Data += sizeof(m_IrradianceSH);
+
+		GLint UnpackAlignment = 4;
+		glGetIntegerv(GL_UNPACK_ALIGNMENT, &UnpackAlignment);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		GLStateCache::BindTexture(GL_TEXTURE_CUBE_MAP, m_PrefilteredMap);
+		for (int Level = 0; Level < m_PrefilteredLevels; Level++)
+		{
+			const int LevelSize = std::max(Settings.PrefilteredSize >> Level, 1);
+			for (int Face = 0; Face < 6; Face++)
+			{
+				glTexSubImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + Face, Level, 0, 0, LevelSize, LevelSize, GL_RGB, GL_HALF_FLOAT, Data);
+				Data += GetFaceSize(Settings.PrefilteredSize, Level);
+			}
+		}
+		GLStateCache::BindTexture(GL_TEXTURE_CUBE_MAP, 0);
+
+		GLStateCache::BindTexture(GL_TEXTURE_2D, m_BRDFLUT);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, Settings.BRDFLUTSize, Settings.BRDFLUTSize, GL_RG, GL_HALF_FLOAT, Data);
+		GLStateCache::BindTexture(GL_TEXTURE_2D, 0);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, UnpackAlignment);
+		return true;
+	}
+
+	bool ImageBasedLighting::SaveCache(const std::string& CachePath, uint64_t Key, const ImageBasedLightingSettings& Settings) const
+	{
+		Header FileHeader = {};
+		FileHeader.Magic = Magic;
+		FileHeader.Version = Version;
+		FileHeader.Key = Key;
+		FileHeader.PrefilteredSize = Settings.PrefilteredSize;
+		FileHeader.PrefilteredLevels = m_PrefilteredLevels;
+		FileHeader.BRDFLUTSize = Settings.BRDFLUTSize;
+
+		std::error_code Error;
+		const std::filesystem::path Directory = std::filesystem::path(CachePath).parent_path();
+		if (!Directory.empty())
+		{
+			std::filesystem::create_directories(Directory, Error);
+		}
+
+		GLint PackAlignment = 4;
+		glGetIntegerv(GL_PACK_ALIGNMENT, &PackAlignment);
+		glPixelStorei(GL_PACK_ALIGNMENT, 1);
+
+		// Write to a temporary file first so a crash never leaves a truncated cache behind
+		const std::string TemporaryPath = CachePath + ".tmp";
+		bool bWritten = false;
+		{
+			std::ofstream File(TemporaryPath, std::ios::binary | std::ios::trunc);
+			if (File)
+			{
+				File.write(reinterpret_cast<const char*>(&FileHeader), sizeof(FileHeader));
+				File.write(reinterpret_cast<const char*>(m_IrradianceSH.data()), sizeof(m_IrradianceSH));
+
+				std::vector<uint8_t> Pixels;
+				GLStateCache::BindTexture(GL_TEXTURE_CUBE_MAP, m_PrefilteredMap);
+				for (int Level = 0; Level < m_PrefilteredLevels; Level++)
+				{
+					Pixels.resize(GetFaceSize(Settings.PrefilteredSize, Level));
+					for (int Face = 0; Face < 6; Face++)
+					{
+						glGetTexImage(GL_TEXTURE_CUBE_MAP_POSITIVE_X + Face, Level, GL_RGB, GL_HALF_FLOAT, Pixels.data());
+						File.write(reinterpret_cast<const char*>(Pixels.data()), static_cast<std::streamsize>(Pixels.size()));
+					}
+				}
+				GLStateCache::BindTexture(GL_TEXTURE_CUBE_MAP, 0);
+
+				Pixels.resize(static_cast<size_t>(Settings.BRDFLUTSize) * Settings.BRDFLUTSize * 2 * sizeof(uint16_t));
+				GLStateCache::BindTexture(GL_TEXTURE_2D, m_BRDFLUT);
+				glGetTexImage(GL_TEXTURE_2D, 0, GL_RG, GL_HALF_FLOAT, Pixels.data());
+				GLStateCache::BindTexture(GL_TEXTURE_2D, 0);
+				File.write(reinterpret_cast<const char*>(Pixels.data()), static_cast<std::streamsize>(Pixels.size()));
+				bWritten = static_cast<bool>(File);
+			}
+		}
+		glPixelStorei(GL_PACK_ALIGNMENT, PackAlignment);
+		if (!bWritten)
+			return false;
+
+		std::filesystem::rename(TemporaryPath, std::filesystem::path(CachePath), Error);
+		if (Error)
+		{
+			std::filesystem::remove(TemporaryPath, Error);
+			return false;
+		}
+		return true;
+	}
+
+} // namespace fgl
@@ -0,0 +1,246 @@
+#include <FireGL/Renderer/ImageDecoder.h>
+#include <FireGL/Core/BaseLog.h>
+#include <FireGL/Core/MemoryTracker.h>
+
+#include <External/stb/stb_image.h>
+
+#ifdef FIREGL_ENABLE_TURBOJPEG
+#include <turbojpeg.h>
+#endif
+#ifdef FIREGL_ENABLE_SPNG
+#include <spng.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace fgl
+{
+
+	namespace
+	{
+		/** Hands stb_image's allocation to an image, counted under MemoryTag::Textures like AllocatePixels(). */
+		bool AdoptSTBPixels(unsigned char* Data, ImageData& Image)
+		{
+			if (!Data)
+				return false;
+
+			const uint64_t Bytes = static_cast<uint64_t>(Image.Width) * Image.Height * Image.Channels;
+			MemoryTracker::OnAllocate(MemoryTag::Textures, Bytes);
+			Image.Pixels = std::shared_ptr<unsigned char>(Data, [Bytes](unsigned char* Pixels)
+			{
+				MemoryTracker::OnFree(MemoryTag::Textures, Bytes);
+				stbi_image_free(Pixels);
+			});
+			return true;
+		}
+
+		bool DecodeSTB(std::span<const unsigned char> Data, bool FlipVertical, ImageData& Image)
+		{
+			// The thread-local flag keeps concurrent decodes on loader threads independent
+			stbi_set_flip_vertically_on_load_thread(FlipVertical);
+			return AdoptSTBPixels(stbi_load_from_memory(Data.data(), static_cast<int>(Data.size()), &Image.Width, &Image.Height, &Image.Channels, 0), Image);
+		}
+
+#ifdef FIREGL_ENABLE_TURBOJPEG
+		bool DecodeTurboJPEG(std::span<const unsigned char> Data, bool FlipVertical, ImageData& Image)
+		{
+			// One decompressor per loader thread, created on its first JPEG
+			thread_local std::unique_ptr<void, int (*)(tjhandle)> Decompressor(tjInitDecompress(), &tjDestroy);
+			if (!Decompressor)
+				return false;
+
+			int Width = 0;
+			int Height = 0;
+			int Subsampling = 0;
+			int ColorSpace = 0;
+			const unsigned long Size = static_cast<unsigned long>(Data.size());
+			if (tjDecompressHeader3(Decompressor.get(), Data.data(), Size, &Width, &Height, &Subsampling, &ColorSpace) != 0)
+				return false;
+
+			// CMYK and YCCK have no RGB output, stb rejects them with its usual error
+			if (ColorSpace == TJCS_CMYK || ColorSpace == TJCS_YCCK)
+				return false;
+
+			const int Channels = ColorSpace == TJCS_GRAY ? 1 : 3;
+			std::shared_ptr<unsigned char> Pixels = ImageDecoder::AllocatePixels(static_cast<size_t>(Width) * Height * Channels);
+			const int Flags = FlipVertical ? TJFLAG_BOTTOMUP : 0;
+			if (tjDecompress2(Decompressor.get(), Data.data(), Size, Pixels.get(), Width, 0, Height, Channels == 1 ? TJPF_GRAY : TJPF_RGB, Flags) != 0)
+				return false;
+
+			Image.Pixels = std::move(Pixels);
+			Image.Width = Width;
+			Image.Height = Height;
+			Image.Channels = Channels;
+			return true;
+		}
+#endif
+
+#ifdef FIREGL_ENABLE_SPNG
+		bool DecodeSPNG(std::span<const unsigned char> Data, bool FlipVertical, ImageData& Image)
+		{
+			std::unique_ptr<spng_ctx, void (*)(spng_ctx*)> Context(spng_ctx_new(0), &spng_ctx_free);
+			spng_ihdr Header{};
+			if (!Context || spng_set_png_buffer(Context.get(), Data.data(), Data.size()) != 0 || spng_get_ihdr(Context.get(), &Header) != 0)
+				return false;
+
+			// The channels stb returns: the file's own, palettes expanded, transparency keys as alpha
+			spng_trns Transparency{};
+			const bool bTransparency = spng_get_trns(Context.get(), &Transparency) == 0;
+			int Format = 0;
+			int Channels = 0;
+			switch (Header.color_type)
+			{
+			case SPNG_COLOR_TYPE_GRAYSCALE:
+				if (Header.bit_depth > 8 || bTransparency)
+					return false;
+				Format = SPNG_FMT_G8;
+				Channels = 1;
+				break;
+			case SPNG_COLOR_TYPE_GRAYSCALE_ALPHA:
+				if (Header.bit_depth > 8)
+					return false;
+				Format = SPNG_FMT_GA8;
+				Channels = 2;
+				break;
+			case SPNG_COLOR_TYPE_TRUECOLOR:
+			case SPNG_COLOR_TYPE_INDEXED:
+				Format = bTransparency ? SPNG_FMT_RGBA8 : SPNG_FMT_RGB8;
+				Channels = bTransparency ? 4 : 3;
+				break;
+			case SPNG_COLOR_TYPE_TRUECOLOR_ALPHA:
+				Format = SPNG_FMT_RGBA8;
+				Channels = 4;
+				break;
+			default:
+				return false;
+			}
+
+			size_t Bytes = 0;
+			if (spng_decoded_image_size(Context.get(), Format, &Bytes) != 0)
+				return false;
+
+			std::shared_ptr<unsigned char> Pixels = ImageDecoder::AllocatePixels(Bytes);
+			if (spng_decode_image(Context.get(), Pixels.get(), Bytes, Format, bTransparency ? SPNG_DECODE_TRNS : 0) != 0)
+				return false;
+
+			// libspng stores the top row first, the rows are swapped in place
+			if (FlipVertical)
+			{
+				const size_t RowSize = Bytes / Header.height;
+				std::vector<unsigned char> Row(RowSize);
+				for (uint32_t Top = 0, Bottom = Header.height - 1; Top < Bottom; Top++, Bottom--)
+				{
+					unsigned char* TopRow = Pixels.get() + Top * RowSize;
+					unsigned char* BottomRow = Pixels.get() + Bottom * RowSize;
+					std::memcpy(Row.data(), TopRow, RowSize);
+					std::memcpy(TopRow, BottomRow, RowSize);
+					std::memcpy(BottomRow, Row.data(), RowSize);
+				}
+			}
+
+			Image.Pixels = std::move(Pixels);
+			Image.Width = static_cast<int>(Header.width);
+			Image.Height = static_cast<int>(Header.height);
+			Image.Channels = Channels;
+			return true;
+		}
+#endif
+	}
+
+	std::array<ImageDecoder::Backend, static_cast<size_t>(ImageFileFormat::Count)> ImageDecoder::s_Decoders = {
+		Backend{},
+#ifdef FIREGL_ENABLE_TURBOJPEG
+		Backend{ &DecodeTurboJPEG, "libjpeg-turbo" },
+#else
+		Backend{},
+#endif
+#ifdef FIREGL_ENABLE_SPNG
+		Backend{ &DecodeSPNG, "libspng" }
+#else
+		Backend{}
+#endif
+	};
+
+	void ImageDecoder::SetDecoder(ImageFileFormat Format, DecodeFunction Decoder, const char* Name)
+	{
+		LOG_ASSERT(Format != ImageFileFormat::Unknown && Format != ImageFileFormat::Count, "Only the JPEG and PNG decoders can be replaced")
+		s_Decoders[static_cast<size_t>(Format)] = Decoder ? Backend{ Decoder, Name } : Backend{};
+	}
+
+	const char* ImageDecoder::GetDecoderName(ImageFileFormat Format)
+	{
+		const Backend& Decoder = s_Decoders[static_cast<size_t>(Format)];
+		return Decoder.Decode ? Decoder.Name : "stb_image";
+	}
+
+	ImageFileFormat ImageDecoder::DetectFormat(std::span<const unsigned char> Data)
+	{
+		static constexpr unsigned char JPEGSignature[] = { 0xFF, 0xD8, 0xFF };
+		static constexpr unsigned char PNGSignature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+		if (Data.size() >= sizeof(PNGSignature) && std::memcmp(Data.data(), PNGSignature, sizeof(PNGSignature)) == 0)
+			return ImageFileFormat::PNG;
+		if (Data.size() >= sizeof(JPEGSignature) && std::memcmp(Data.data(), JPEGSignature, sizeof(JPEGSignature)) == 0)
+			return ImageFileFormat::JPEG;
+		return ImageFileFormat::Unknown;
+	}
+
+	ImageFileFormat ImageDecoder::DetectFormat(std::string_view Path)
+	{
+		std::string Extension = std::filesystem::path(Path).extension().string();
+		std::transform(Extension.begin(), Extension.end(), Extension.begin(), [](unsigned char Character) { return static_cast<char>(std::tolower(Character)); });
+		if (Extension == ".jpg" || Extension == ".jpeg")
+			return ImageFileFormat::JPEG;
+		if (Extension == ".png")
+			return ImageFileFormat::PNG;
+		return ImageFileFormat::Unknown;
+	}
+
+	bool ImageDecoder::Decode(std::span<const unsigned char> Data, bool FlipVertical, ImageData& Image)
+	{
+		const Backend& Decoder = s_Decoders[static_cast<size_t>(DetectFormat(Data))];
+		if (Decoder.Decode)
+		{
+			if (Decoder.Decode(Data, FlipVertical, Image))
+				return true;
+
+			Image = ImageData();
+		}
+		return DecodeSTB(Data, FlipVertical, Image);
+	}
+
+	bool ImageDecoder::DecodeFile(std::string_view Path, bool FlipVertical, ImageData& Image)
+	{
+		// Without a dedicated decoder stb reads the file itself, sparing the copy
+		const std::string PathString(Path);
+		if (!s_Decoders[static_cast<size_t>(DetectFormat(Path))].Decode)
+		{
+			stbi_set_flip_vertically_on_load_thread(FlipVertical);
+			return AdoptSTBPixels(stbi_load(PathString.c_str(), &Image.Width, &Image.Height, &Image.Channels, 0), Image);
+		}
+
+		std::ifstream File(PathString, std::ios::binary | std::ios::ate);
+		if (!File)
+			return false;
+
+		std::vector<unsigned char> Data(static_cast<size_t>(File.tellg()));
+		File.seekg(0);
+		if (!File.read(reinterpret_cast<char*>(Data.data()), static_cast<std::streamsize>(Data.size())))
+			return false;
+
+		return Decode(Data, FlipVertical, Image);
+	}
+
+	std::shared_ptr<unsigned char> ImageDecoder::AllocatePixels(size_t Bytes)
+	{
+		MemoryTracker::OnAllocate(MemoryTag::Textures, Bytes);
+		return std::shared_ptr<unsigned char>(new unsigned char[Bytes], [Bytes](unsigned char* Pixels)
+		{
+			MemoryTracker::OnFree(MemoryTag::Textures, Bytes);
+			delete[] Pixels;
+		});
+	}
+
+} // namespace fgl
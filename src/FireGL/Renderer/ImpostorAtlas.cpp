@@ -0,0 +1,320 @@
+#include <FireGL/Renderer/ImpostorAtlas.h>
+#include <FireGL/Renderer/Renderer.h>
+#include <FireGL/Renderer/RenderTarget.h>
+#include <FireGL/Renderer/Scene.h>
+#include <FireGL/Renderer/SceneObject.h>
+#include <FireGL/Renderer/BaseCamera.h>
+#include <FireGL/Renderer/TransformPool.h>
+#include <FireGL/Renderer/Material.h>
+#include <FireGL/Renderer/GLStateCache.h>
+#include <FireGL/Renderer/GPUMemoryTracker.h>
+#include <FireGL/Renderer/RenderStats.h>
+#include <FireGL/Core/BaseLog.h>
+
+#include <External/glm/geometric.hpp>
+#include <External/glm/gtc/constants.hpp>
+
+namespace fgl
+{
+
+	namespace
+	{
+		constexpr int CaptureSamples = 4; ///< Samples per pixel of the pictures, smoothing the silhouettes.
+
+		constexpr std::string_view VertexCode = R"(#version 410 core
+layout (location = 0) in vec4 aCenterRadius;
+layout (location = 1) in uint aFrame;
+
+layout (std140) uniform CameraData
+{
+    mat4 View;
+    mat4 Projection;
+    mat4 ViewProjection;
+} Camera;
+
+uniform int Columns;
+uniform int Rows;
+
+out vec2 TexCoord;
+
+void main()
+{
+    // 4-vertex strip: (0, 0), (1, 0), (0, 1), (1, 1), spanning the sphere's diameter
+    vec2 Corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    vec3 Right = vec3(Camera.View[0][0], Camera.View[1][0], Camera.View[2][0]);
+    vec3 Up = vec3(Camera.View[0][1], Camera.View[1][1], Camera.View[2][1]);
+    vec3 WorldPosition = aCenterRadius.xyz + (Right * (Corner.x * 2.0 - 1.0) + Up * (Corner.y * 2.0 - 1.0)) * aCenterRadius.w;
+    gl_Position = Camera.ViewProjection * vec4(WorldPosition, 1.0);
+
+    ivec2 Tile = ivec2(int(aFrame) % Columns, int(aFrame) / Columns);
+    TexCoord = (vec2(Tile) + Corner) / vec2(Columns, Rows);
+})";
+
+		constexpr std::string_view FragmentCode = R"(#version 410 core
+in vec2 TexCoord;
+out vec4 FragColor;
+
+uniform sampler2D Atlas;
+
+void main()
+{
+    vec4 Texel = texture(Atlas, TexCoord);
+    if (Texel.a < 0.5)
+        discard;
+
+    // The pictures were resolved over a transparent black background, the edges are darkened by their coverage
+    FragColor = vec4(Texel.rgb / Texel.a, 1.0);
+})";
+
+		/** Framing camera of the captures, never moved by input. */
+		class CaptureCamera final : public BaseCamera
+		{
+		public:
+			void ProcessMovementInput(CameraMovement MovementDirection, float DeltaTime) override {}
+			void ProcessRotationInput(float XOffset, float YOffset) override {}
+		};
+	}
+
+	ImpostorAtlas::~ImpostorAtlas()
+	{
+		Destroy();
+	}
+
+	void ImpostorAtlas::Capture(Renderer& CaptureRenderer, Scene& CaptureScene, int FrameSize, int Columns, int Rows, float MaxElevation)
+	{
+		LOG_ASSERT(FrameSize > 0 && Columns > 0 && Rows > 0, "Impostor atlas needs at least one picture")
+		LOG_ASSERT(MaxElevation < 90.0f, "Impostor pictures can't be captured from straight above")
+		Destroy();
+		m_FrameSize = FrameSize;
+		m_Columns = Columns;
+		m_Rows = Rows;
+		m_MaxElevation = glm::radians(MaxElevation);
+
+		// The pictures frame the sphere enclosing every object of the Scene, skyboxes aside
+		TransformPool::UpdateDirtyMatrices();
+		CaptureScene.UpdateBoundingSpheres();
+		const auto& Objects = CaptureScene.GetObjects();
+		const BoundingSphereArrays& Spheres = CaptureScene.GetBoundingSpheres();
+		glm::vec3 Min(std::numeric_limits<float>::max());
+		glm::vec3 Max(std::numeric_limits<float>::lowest());
+		for (size_t Index = 0; Index < Objects.size(); Index++)
+		{
+			if (Objects[Index]->IsSkybox())
+				continue;
+
+			const glm::vec3 Center(Spheres.X[Index], Spheres.Y[Index], Spheres.Z[Index]);
+			Min = glm::min(Min, Center - Spheres.Radius[Index]);
+			Max = glm::max(Max, Center + Spheres.Radius[Index]);
+		}
+		LOG_ASSERT(Min.x <= Max.x, "Impostor capture Scene holds no object")
+		const glm::vec3 Center = (Min + Max) * 0.5f;
+		float Radius = 0.0f;
+		for (size_t Index = 0; Index < Objects.size(); Index++)
+		{
+			if (!Objects[Index]->IsSkybox())
+			{
+				Radius = std::max(Radius, glm::length(glm::vec3(Spheres.X[Index], Spheres.Y[Index], Spheres.Z[Index]) - Center) + Spheres.Radius[Index]);
+			}
+		}
+
+		const int Width = FrameSize * Columns;
+		const int Height = FrameSize * Rows;
+		const int LevelCount = GPUMemoryTracker::GetMipLevelCount(Width, Height);
+		glGenTextures(1, &m_Atlas);
+		GLStateCache::BindTexture(GL_TEXTURE_2D, m_Atlas);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, Width, Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		GPUMemoryTracker::TrackTexture(m_Atlas, GPUMemoryTracker::GetTextureSize(GL_RGBA8, Width, Height, 1, LevelCount), GPUMemoryCategory::Textures, "ImpostorAtlas");
+
+		GLint PreviousFramebuffer = 0;
+		GLint PreviousViewport[4];
+		GLfloat PreviousClearColor[4];
+		glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &PreviousFramebuffer);
+		glGetIntegerv(GL_VIEWPORT, PreviousViewport);
+		glGetFloatv(GL_COLOR_CLEAR_VALUE, PreviousClearColor);
+		const std::shared_ptr<BaseCamera> PreviousCamera = CaptureScene.GetActiveCamera();
+		RenderTarget* const PreviousTarget = CaptureRenderer.GetOutputTarget();
+
+		GLuint AtlasFramebuffer;
+		glGenFramebuffers(1, &AtlasFramebuffer);
+		glBindFramebuffer(GL_FRAMEBUFFER, AtlasFramebuffer);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_Atlas, 0);
+		LOG_ASSERT(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE, "Impostor atlas framebuffer is incomplete")
+
+		RenderTarget Target;
+		Target.Resize(FrameSize, FrameSize, CaptureSamples);
+		CaptureRenderer.SetOutputTarget(&Target);
+		const std::shared_ptr<CaptureCamera> Camera = std::make_shared<CaptureCamera>();
+		CaptureScene.SetActiveCamera(Camera);
+		glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+
+		// The camera stands one radius off the sphere, the depth range spans it whole
+		Camera->SetOrthographic(-Radius, Radius, -Radius, Radius, Radius, Radius * 3.0f);
+		for (int Row = 0; Row < Rows; Row++)
+		{
+			const float Elevation = Rows > 1 ? m_MaxElevation * static_cast<float>(Row) / static_cast<float>(Rows - 1) : 0.0f;
+			for (int Column = 0; Column < Columns; Column++)
+			{
+				const float Azimuth = glm::two_pi<float>() * static_cast<float>(Column) / static_cast<float>(Columns);
+				const glm::vec3 Direction(std::cos(Azimuth) * std::cos(Elevation), std::sin(Elevation), std::sin(Azimuth) * std::cos(Elevation));
+				Camera->GetCameraTransform().SetPosition(Center + Direction * (Radius * 2.0f));
+				Camera->LookAt(Center);
+				Camera->UpdateViewMatrix();
+				CaptureRenderer.Render(&CaptureScene);
+
+				glBindFramebuffer(GL_READ_FRAMEBUFFER, Target.GetResolveFramebuffer());
+				glBindFramebuffer(GL_DRAW_FRAMEBUFFER, AtlasFramebuffer);
+				glBlitFramebuffer(0, 0, FrameSize, FrameSize, Column * FrameSize, Row * FrameSize, (Column + 1) * FrameSize, (Row + 1) * FrameSize,
+					GL_COLOR_BUFFER_BIT, GL_NEAREST);
+			}
+		}
+
+		CaptureScene.SetActiveCamera(PreviousCamera);
+		CaptureRenderer.SetOutputTarget(PreviousTarget);
+		glClearColor(PreviousClearColor[0], PreviousClearColor[1], PreviousClearColor[2], PreviousClearColor[3]);
+		glBindFramebuffer(GL_FRAMEBUFFER, PreviousFramebuffer);
+		glViewport(PreviousViewport[0], PreviousViewport[1], PreviousViewport[2], PreviousViewport[3]);
+		glDeleteFramebuffers(1, &AtlasFramebuffer);
+
+		GLStateCache::BindTexture(GL_TEXTURE_2D, m_Atlas);
+		glGenerateMipmap(GL_TEXTURE_2D);
+		CreateDrawResources();
+		LOG_INFO("Captured impostor atlas of " + std::to_string(Columns * Rows) + " pictures, " + std::to_string(Width) + "x" + std::to_string(Height))
+	}
+
+	void ImpostorAtlas::CreateDrawResources()
+	{
+		m_Shader = Shader::CreateFromSource(VertexCode, FragmentCode);
+		glGenBuffers(1, &m_InstanceBuffer);
+		glGenVertexArrays(1, &m_VertexArray);
+		EnsureCapacity(256);
+	}
+
+	void ImpostorAtlas::EnsureCapacity(size_t Count)
+	{
+		if (Count <= m_InstanceCapacity)
+			return;
+
+		// Grows geometrically, the records are rewritten by every Draw()
+		m_InstanceCapacity = std::max(Count, m_InstanceCapacity * 2);
+		const GLsizeiptr Size = static_cast<GLsizeiptr>(m_InstanceCapacity * sizeof(ImpostorInstance));
+		GLStateCache::BindBuffer(GL_ARRAY_BUFFER, m_InstanceBuffer);
+		glBufferData(GL_ARRAY_BUFFER, Size, nullptr, GL_STREAM_DRAW);
+		GPUMemoryTracker::UntrackBuffer(m_InstanceBuffer);
+		GPUMemoryTracker::TrackBuffer(m_InstanceBuffer, Size, GPUMemoryCategory::Instances, "ImpostorAtlas");
+
+		GLStateCache::BindVertexArray(m_VertexArray);
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(ImpostorInstance), reinterpret_cast<const void*>(offsetof(ImpostorInstance, Center)));
+		glVertexAttribDivisor(0, 1);
+		glEnableVertexAttribArray(1);
+		glVertexAttribIPointer(1, 1, GL_UNSIGNED_INT, sizeof(ImpostorInstance), reinterpret_cast<const void*>(offsetof(ImpostorInstance, Frame)));
+		glVertexAttribDivisor(1, 1);
+	}
+
+	void ImpostorAtlas::Destroy()
+	{
+		if (m_Atlas != 0)
+		{
+			glDeleteTextures(1, &m_Atlas);
+			GLStateCache::OnTextureDeleted(m_Atlas);
+			GPUMemoryTracker::UntrackTexture(m_Atlas);
+			m_Atlas = 0;
+		}
+		if (m_InstanceBuffer != 0)
+		{
+			glDeleteBuffers(1, &m_InstanceBuffer);
+			GLStateCache::OnBufferDeleted(m_InstanceBuffer);
+			GPUMemoryTracker::UntrackBuffer(m_InstanceBuffer);
+			m_InstanceBuffer = 0;
+			m_InstanceCapacity = 0;
+		}
+		if (m_VertexArray != 0)
+		{
+			glDeleteVertexArrays(1, &m_VertexArray);
+			GLStateCache::OnVertexArrayDeleted(m_VertexArray);
+			m_VertexArray = 0;
+		}
+		if (m_Shader)
+		{
+			m_Shader->Cleanup();
+			m_Shader.reset();
+		}
+	}
+
+	bool ImpostorAtlas::IsCaptured() const
+	{
+		return m_Atlas != 0;
+	}
+
+	void ImpostorAtlas::SetDistance(float Distance)
+	{
+		m_Distance = Distance;
+	}
+
+	float ImpostorAtlas::GetDistance() const
+	{
+		return m_Distance;
+	}
+
+	uint32_t ImpostorAtlas::SelectFrame(const glm::vec3& LocalDirection) const
+	{
+		// Inverse of the capture directions: azimuth from +X towards +Z, elevation from the horizon
+		const glm::vec3 Direction = glm::normalize(LocalDirection);
+		float Azimuth = std::atan2(Direction.z, Direction.x);
+		if (Azimuth < 0.0f)
+		{
+			Azimuth += glm::two_pi<float>();
+		}
+		const int Column = static_cast<int>(std::lround(Azimuth / glm::two_pi<float>() * static_cast<float>(m_Columns))) % m_Columns;
+
+		int Row = 0;
+		if (m_Rows > 1)
+		{
+			const float Elevation = glm::clamp(std::asin(glm::clamp(Direction.y, -1.0f, 1.0f)), 0.0f, m_MaxElevation);
+			Row = static_cast<int>(std::lround(Elevation / m_MaxElevation * static_cast<float>(m_Rows - 1)));
+		}
+		return static_cast<uint32_t>(Row * m_Columns + Column);
+	}
+
+	void ImpostorAtlas::Draw(const std::vector<ImpostorInstance>& Instances)
+	{
+		if (!IsCaptured() || Instances.empty())
+			return;
+
+		EnsureCapacity(Instances.size());
+		const GLsizeiptr Size = static_cast<GLsizeiptr>(Instances.size() * sizeof(ImpostorInstance));
+		GLStateCache::BindBuffer(GL_ARRAY_BUFFER, m_InstanceBuffer);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, Size, Instances.data());
+		RenderCounters::CountUpload(static_cast<size_t>(Size));
+
+		GLStateCache::BindTextureUnit(AtlasUnit, GL_TEXTURE_2D, m_Atlas);
+		m_Shader->Activate();
+		m_Shader->SetInt("Atlas", AtlasUnit);
+		m_Shader->SetInt("Columns", m_Columns);
+		m_Shader->SetInt("Rows", m_Rows);
+		GLStateCache::BindVertexArray(m_VertexArray);
+		glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(Instances.size()));
+		RenderCounters::CountDraw(Instances.size(), Instances.size() * 2);
+		Material::InvalidateActiveMaterial();
+	}
+
+	GLuint ImpostorAtlas::GetTexture() const
+	{
+		return m_Atlas;
+	}
+
+	int ImpostorAtlas::GetColumns() const
+	{
+		return m_Columns;
+	}
+
+	int ImpostorAtlas::GetRows() const
+	{
+		return m_Rows;
+	}
+
+} // namespace fgl
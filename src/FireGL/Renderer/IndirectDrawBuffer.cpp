@@ -0,0 +1,87 @@
+#include <FireGL/Renderer/IndirectDrawBuffer.h>
+#include <FireGL/Renderer/GLStateCache.h>
+#include <FireGL/Renderer/GPUMemoryTracker.h>
+#include <FireGL/Renderer/RenderStats.h>
+
+namespace fgl
+{
+
+	bool IndirectDrawBuffer::IsSupported()
+	{
+		static const bool bSupported = GLAD_GL_VERSION_4_3 != 0;
+		return bSupported;
+	}
+
+	void IndirectDrawBuffer::Create()
+	{
+		glGenBuffers(1, &m_BufferID);
+	}
+
+	void IndirectDrawBuffer::Destroy()
+	{
+		if (m_BufferID == 0)
+			return;
+
+		glDeleteBuffers(1, &m_BufferID);
+		GLStateCache::OnBufferDeleted(m_BufferID);
+		GPUMemoryTracker::UntrackBuffer(m_BufferID);
+		m_BufferID = 0;
+		m_Capacity = 0;
+	}
+
+	void IndirectDrawBuffer::Clear()
+	{
+		m_Commands.clear();
+	}
+
+	void IndirectDrawBuffer::Push(const DrawElementsIndirectCommand& Command)
+	{
+		m_Commands.push_back(Command);
+	}
+
+	void IndirectDrawBuffer::Upload()
+	{
+		GLStateCache::BindBuffer(GL_DRAW_INDIRECT_BUFFER, m_BufferID);
+		if (m_Commands.empty())
+			return;
+
+		// Grow to the vector's capacity so the storage follows the same amortized growth
+		m_Capacity = std::max(m_Capacity, m_Commands.capacity());
+		glBufferData(GL_DRAW_INDIRECT_BUFFER, m_Capacity * sizeof(DrawElementsIndirectCommand), nullptr, GL_STREAM_DRAW);
+		GPUMemoryTracker::TrackBuffer(m_BufferID, m_Capacity * sizeof(DrawElementsIndirectCommand), GPUMemoryCategory::Indirect, "IndirectDrawBuffer");
+		glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, m_Commands.size() * sizeof(DrawElementsIndirectCommand), m_Commands.data());
+		RenderCounters::CountUpload(m_Commands.size() * sizeof(DrawElementsIndirectCommand));
+	}
+
+	void IndirectDrawBuffer::Bind() const
+	{
+		GLStateCache::BindBuffer(GL_DRAW_INDIRECT_BUFFER, m_BufferID);
+	}
+
+	void IndirectDrawBuffer::Draw(size_t FirstCommand, size_t CommandCount, GLenum IndexType) const
+	{
+		const size_t Offset = FirstCommand * sizeof(DrawElementsIndirectCommand);
+		glMultiDrawElementsIndirect(GL_TRIANGLES, IndexType, (const void*)Offset, static_cast<GLsizei>(CommandCount), 0);
+
+		// Commands written by the GPU keep the instance count they were pushed with, zero
+		uint64_t Instances = 0;
+		uint64_t Triangles = 0;
+		for (size_t Index = FirstCommand; Index < std::min(FirstCommand + CommandCount, m_Commands.size()); Index++)
+		{
+			Instances += m_Commands[Index].InstanceCount;
+			Triangles += static_cast<uint64_t>(m_Commands[Index].InstanceCount) * (m_Commands[Index].Count / 3);
+		}
+		RenderCounters::CountDraw(Instances, Triangles);
+	}
+
+	size_t IndirectDrawBuffer::GetCommandCount() const
+	{
+		return m_Commands.size();
+	}
+
+	GLuint IndirectDrawBuffer::GetBufferID() const
+	{
+		return m_BufferID;
+	}
+
+} // namespace fgl
\ No newline at end of file
@@ -0,0 +1,97 @@
+#include <FireGL/Renderer/LightUniformBuffer.h>
+#include <FireGL/Renderer/BaseCamera.h>
+#include <FireGL/Renderer/RenderStats.h>
+
+namespace fgl
+{
+
+	namespace
+	{
+		/** The four point lights the lighting material used to hardcode. */
+		LightData GetDefaultLights()
+		{
+			LightData Lights;
+			Lights.PointLights[0].Position = glm::vec4(0.7f, 0.2f, 2.0f, 1.0f);
+			Lights.PointLights[1].Position = glm::vec4(2.3f, -3.3f, -4.0f, 1.0f);
+			Lights.PointLights[2].Position = glm::vec4(-4.0f, 2.0f, -12.0f, 1.0f);
+			Lights.PointLights[3].Position = glm::vec4(0.0f, 0.0f, -3.0f, 1.0f);
+			return Lights;
+		}
+	}
+
+	void LightUniformBuffer::Create()
+	{
+		m_Data = GetDefaultLights();
+		m_RenderData = m_Data;
+		m_bEdited = false;
+		m_bDirty = true;
+
+		RenderDevice& Device = RenderDevice::Get();
+		m_Buffer = Device.CreateBuffer({ sizeof(LightData), BufferUsage::Dynamic, GPUMemoryCategory::Uniforms, "LightUniformBuffer" });
+		Device.BindUniformBuffer(BindingPoint, m_Buffer);
+	}
+
+	void LightUniformBuffer::Destroy()
+	{
+		RenderDevice::Get().DestroyBuffer(m_Buffer);
+	}
+
+	LightData& LightUniformBuffer::Edit()
+	{
+		m_bEdited = true;
+		return m_Data;
+	}
+
+	const LightData& LightUniformBuffer::GetData() const
+	{
+		return m_Data;
+	}
+
+	void LightUniformBuffer::Capture()
+	{
+		if (!m_bEdited)
+			return;
+
+		m_RenderData = m_Data;
+		m_bEdited = false;
+		m_bDirty = true;
+	}
+
+	const LightData& LightUniformBuffer::GetRenderData() const
+	{
+		return m_RenderData;
+	}
+
+	void LightUniformBuffer::SetSpotLightFollowsCamera(bool bFollow)
+	{
+		m_bSpotLightFollowsCamera = bFollow;
+	}
+
+	bool LightUniformBuffer::GetSpotLightFollowsCamera() const
+	{
+		return m_bSpotLightFollowsCamera;
+	}
+
+	void LightUniformBuffer::Update(BaseCamera& Camera)
+	{
+		if (m_bSpotLightFollowsCamera)
+		{
+			const glm::vec4 Position = glm::vec4(Camera.GetViewPosition(), 1.0f);
+			const glm::vec4 Direction = glm::vec4(Camera.GetFrontVector(), 0.0f);
+			if (Position != m_RenderData.SpotLight.Position || Direction != m_RenderData.SpotLight.Direction)
+			{
+				m_RenderData.SpotLight.Position = Position;
+				m_RenderData.SpotLight.Direction = Direction;
+				m_bDirty = true;
+			}
+		}
+
+		if (!m_bDirty)
+			return;
+
+		RenderDevice::Get().UpdateBuffer(m_Buffer, 0, sizeof(LightData), &m_RenderData);
+		RenderCounters::CountUpload(sizeof(LightData));
+		m_bDirty = false;
+	}
+
+} // namespace fgl
\ No newline at end of file
@@ -0,0 +1,574 @@
+#include <FireGL/Renderer/Lightmap.h>
+#include <FireGL/Renderer/SceneObject.h>
+#include <FireGL/Renderer/Mesh.h>
+#include <FireGL/Renderer/LightUniformBuffer.h>
+#include <FireGL/Renderer/GLStateCache.h>
+#include <FireGL/Renderer/GPUMemoryTracker.h>
+#include <FireGL/Core/JobSystem.h>
+#include <FireGL/Core/BaseLog.h>
+
+#include <External/glm/geometric.hpp>
+#include <External/glm/common.hpp>
+
+namespace fgl
+{
+
+	namespace
+	{
+		/** A world-space triangle the shadow rays are tested against. */
+		struct Occluder
+		{
+			glm::vec3 A;
+			glm::vec3 B;
+			glm::vec3 C;
+		};
+
+		/** A texel covered by a triangle, lit once the rasterization is done. */
+		struct TexelSample
+		{
+			glm::vec3 Position; ///< World position of the texel's center on the triangle.
+			glm::vec3 Normal;   ///< Interpolated world normal.
+			uint32_t Texel;     ///< Index of the texel in the atlas.
+		};
+
+		/** Layout of a saved lightmap, followed by the regions and the texels. */
+		struct FileHeader
+		{
+			uint32_t Magic;
+			uint32_t Version;
+			uint32_t Resolution;
+			uint32_t RegionCount;
+		};
+
+		/**
+		 * Bounding volume hierarchy of the occluders, split at the median of the longest axis, answering
+		 * whether anything lies along a segment.
+		 */
+		class OccluderTree
+		{
+		public:
+			static constexpr uint32_t LeafSize = 4; ///< Occluders per leaf, at most.
+
+			explicit OccluderTree(std::vector<Occluder>&& Occluders)
+				: m_Occluders(std::move(Occluders))
+			{
+				if (!m_Occluders.empty())
+				{
+					m_Nodes.reserve(m_Occluders.size() * 2 / LeafSize + 1);
+					BuildNode(0, static_cast<uint32_t>(m_Occluders.size()));
+				}
+			}
+
+			/** @return True if an occluder crosses the segment from Origin along Direction (normalized) up to MaxDistance. */
+			bool IsOccluded(const glm::vec3& Origin, const glm::vec3& Direction, float MaxDistance) const
+			{
+				if (m_Nodes.empty())
+					return false;
+
+				const glm::vec3 InverseDirection = 1.0f / Direction;
+				uint32_t Stack[64];
+				uint32_t StackSize = 0;
+				Stack[StackSize++] = 0;
+				while (StackSize > 0)
+				{
+					const Node& Current = m_Nodes[Stack[--StackSize]];
+					if (!IntersectsBox(Origin, InverseDirection, Current.Min, Current.Max, MaxDistance))
+						continue;
+
+					if (Current.Count > 0)
+					{
+						for (uint32_t Index = Current.First; Index < Current.First + Current.Count; Index++)
+						{
+							if (IntersectsTriangle(Origin, Direction, m_Occluders[Index], MaxDistance))
+								return true;
+						}
+						continue;
+					}
+
+					// Interior nodes keep their left child right after them
+					const uint32_t NodeIndex = static_cast<uint32_t>(&Current - m_Nodes.data());
+					if (StackSize + 2 <= std::size(Stack))
+					{
+						Stack[StackSize++] = Current.First;
+						Stack[StackSize++] = NodeIndex + 1;
+					}
+				}
+				return false;
+			}
+
+		private:
+			/** Leaves hold Count > 0 occluders from First, interior nodes have Count 0 and their right child at First. */
+			struct Node
+			{
+				glm::vec3 Min;
+				uint32_t First = 0;
+				glm::vec3 Max;
+				uint32_t Count = 0;
+			};
+
+			void BuildNode(uint32_t First, uint32_t Count)
+			{
+				const uint32_t NodeIndex = static_cast<uint32_t>(m_Nodes.size());
+				m_Nodes.emplace_back();
+
+				glm::vec3 Min(std::numeric_limits<float>::max());
+				glm::vec3 Max(std::numeric_limits<float>::lowest());
+				glm::vec3 CenterMin = Min;
+				glm::vec3 CenterMax = Max;
+				for (uint32_t Index = First; Index < First + Count; Index++)
+				{
+					const Occluder& Triangle = m_Occluders[Index];
+					Min = glm::min(Min, glm::min(Triangle.A, glm::min(Triangle.B, Triangle.C)));
+					Max = glm::max(Max, glm::max(Triangle.A, glm::max(Triangle.B, Triangle.C)));
+					const glm::vec3 Center = (Triangle.A + Triangle.B + Triangle.C) / 3.0f;
+					CenterMin = glm::min(CenterMin, Center);
+					CenterMax = glm::max(CenterMax, Center);
+				}
+				m_Nodes[NodeIndex].Min = Min;
+				m_Nodes[NodeIndex].Max = Max;
+				if (Count <= LeafSize)
+				{
+					m_Nodes[NodeIndex].First = First;
+					m_Nodes[NodeIndex].Count = Count;
+					return;
+				}
+
+				const glm::vec3 Extent = CenterMax - CenterMin;
+				const int Axis = Extent.x > Extent.y ? (Extent.x > Extent.z ? 0 : 2) : (Extent.y > Extent.z ? 1 : 2);
+				const uint32_t Half = Count / 2;
+				std::nth_element(m_Occluders.begin() + First, m_Occluders.begin() + First + Half, m_Occluders.begin() + First + Count,
+					[Axis](const Occluder& Left, const Occluder& Right)
+					{
+						return Left.A[Axis] + Left.B[Axis] + Left.C[Axis] < Right.A[Axis] + Right.B[Axis] + Right.C[Axis];
+					});
+
+				BuildNode(First, Half);
+				m_Nodes[NodeIndex].First = static_cast<uint32_t>(m_Nodes.size());
+				BuildNode(First + Half, Count - Half);
+			}
+
+			static bool IntersectsBox(const glm::vec3& Origin, const glm::vec3& InverseDirection, const glm::vec3& Min, const glm::vec3& Max, float MaxDistance)
+			{
+				const glm::vec3 Near = (Min - Origin) * InverseDirection;
+				const glm::vec3 Far = (Max - Origin) * InverseDirection;
+				const glm::vec3 Entry = glm::min(Near, Far);
+				const glm::vec3 Exit = glm::max(Near, Far);
+				const float Enter = std::max(std::max(Entry.x, Entry.y), std::max(Entry.z, 0.0f));
+				const float Leave = std::min(std::min(Exit.x, Exit.y), std::min(Exit.z, MaxDistance));
+				return Enter <= Leave;
+			}
+
+			/** Moller-Trumbore, both faces. */
+			static bool IntersectsTriangle(const glm::vec3& Origin, const glm::vec3& Direction, const Occluder& Triangle, float MaxDistance)
+			{
+				const glm::vec3 EdgeB = Triangle.B - Triangle.A;
+				const glm::vec3 EdgeC = Triangle.C - Triangle.A;
+				const glm::vec3 P = glm::cross(Direction, EdgeC);
+				const float Determinant = glm::dot(EdgeB, P);
+				if (std::abs(Determinant) < 1e-10f)
+					return false;
+
+				const float InverseDeterminant = 1.0f / Determinant;
+				const glm::vec3 T = Origin - Triangle.A;
+				const float U = glm::dot(T, P) * InverseDeterminant;
+				if (U < 0.0f || U > 1.0f)
+					return false;
+
+				const glm::vec3 Q = glm::cross(T, EdgeB);
+				const float V = glm::dot(Direction, Q) * InverseDeterminant;
+				if (V < 0.0f || U + V > 1.0f)
+					return false;
+
+				const float Distance = glm::dot(EdgeC, Q) * InverseDeterminant;
+				return Distance > 0.0f && Distance < MaxDistance;
+			}
+
+			std::vector<Occluder> m_Occluders;
+			std::vector<Node> m_Nodes;
+		};
+
+		/** @return The world area of the lightmapped triangles of an object. */
+		float GetLightmappedArea(SceneObject& Object)
+		{
+			const glm::mat4& Model = Object.GetTransform().GetModelMatrix();
+			float Area = 0.0f;
+			for (const BaseMesh& Mesh : Object.GetMeshes())
+			{
+				if (Mesh.GetVertexFormat() != VertexFormat::Lightmapped)
+					continue;
+
+				const std::vector<Vertex>& Vertices = Mesh.GetVertices();
+				const std::vector<unsigned int>& Indices = Mesh.GetIndices();
+				for (size_t Index = 0; Index + 2 < Indices.size(); Index += 3)
+				{
+					const glm::vec3 A = glm::vec3(Model * glm::vec4(Vertices[Indices[Index]].Position, 1.0f));
+					const glm::vec3 B = glm::vec3(Model * glm::vec4(Vertices[Indices[Index + 1]].Position, 1.0f));
+					const glm::vec3 C = glm::vec3(Model * glm::vec4(Vertices[Indices[Index + 2]].Position, 1.0f));
+					Area += 0.5f * glm::length(glm::cross(B - A, C - A));
+				}
+			}
+			return Area;
+		}
+	} // namespace
+
+	Lightmap::~Lightmap()
+	{
+		Destroy();
+	}
+
+	bool Lightmap::Bake(const std::vector<SceneObject*>& Objects, const LightData& Lights, const LightmapBakeSettings& Settings, JobSystem* Jobs)
+	{
+		const int Resolution = std::max(Settings.Resolution, 1);
+		const int Padding = std::max(Settings.Padding, 0);
+
+		// Square regions by the side of the surfaces' area, shelves of decreasing height; the density drops until all fit
+		std::vector<float> Areas(Objects.size(), 0.0f);
+		std::vector<size_t> Order;
+		for (size_t Index = 0; Index < Objects.size(); Index++)
+		{
+			Areas[Index] = GetLightmappedArea(*Objects[Index]);
+			if (Areas[Index] > 0.0f)
+			{
+				Order.push_back(Index);
+			}
+		}
+		std::sort(Order.begin(), Order.end(), [&Areas](size_t Left, size_t Right) { return Areas[Left] > Areas[Right]; });
+
+		std::vector<glm::vec4> Regions(Objects.size(), glm::vec4(0.0f));
+		float Density = Settings.TexelsPerUnit;
+		bool bPacked = false;
+		while (!bPacked)
+		{
+			bPacked = true;
+			int X = 0, Y = 0, ShelfHeight = 0;
+			int LargestInner = 0;
+			for (size_t Index : Order)
+			{
+				const int Inner = std::clamp(static_cast<int>(std::ceil(std::sqrt(Areas[Index]) * Density)), 1, Resolution);
+				const int Size = Inner + 2 * Padding;
+				LargestInner = std::max(LargestInner, Inner);
+				if (X + Size > Resolution)
+				{
+					X = 0;
+					Y += ShelfHeight;
+					ShelfHeight = 0;
+				}
+				if (Size > Resolution || Y + Size > Resolution)
+				{
+					bPacked = false;
+					break;
+				}
+				Regions[Index] = glm::vec4(glm::vec2(static_cast<float>(Inner)), glm::vec2(static_cast<float>(X + Padding), static_cast<float>(Y + Padding)))
+					/ static_cast<float>(Resolution);
+				X += Size;
+				ShelfHeight = std::max(ShelfHeight, Size);
+			}
+
+			if (!bPacked && LargestInner <= 1)
+			{
+				LOG_ERROR("The lightmapped objects don't fit a lightmap of " + std::to_string(Resolution) + " texels, even at one texel each.", false)
+				return false;
+			}
+			Density *= 0.75f;
+		}
+
+		// Every triangle occludes, lightmapped or not; only the lightmapped ones are rasterized
+		std::vector<Occluder> Occluders;
+		std::vector<TexelSample> Samples;
+		std::vector<int32_t> SampleOfTexel(static_cast<size_t>(Resolution) * Resolution, -1);
+		const auto Cover = [&Samples, &SampleOfTexel, Resolution](int X, int Y, const glm::vec3& Position, const glm::vec3& Normal)
+		{
+			const uint32_t Texel = static_cast<uint32_t>(Y * Resolution + X);
+			int32_t& Slot = SampleOfTexel[Texel];
+			if (Slot < 0)
+			{
+				Slot = static_cast<int32_t>(Samples.size());
+				Samples.push_back({ Position, Normal, Texel });
+				return;
+			}
+			Samples[Slot].Position = Position;
+			Samples[Slot].Normal = Normal;
+		};
+
+		for (size_t ObjectIndex = 0; ObjectIndex < Objects.size(); ObjectIndex++)
+		{
+			SceneObject& Object = *Objects[ObjectIndex];
+			const glm::mat4& Model = Object.GetTransform().GetModelMatrix();
+			const glm::mat3& NormalMatrix = Object.GetTransform().GetNormalMatrix();
+			const glm::vec4& Region = Regions[ObjectIndex];
+			for (const BaseMesh& Mesh : Object.GetMeshes())
+			{
+				const std::vector<Vertex>& Vertices = Mesh.GetVertices();
+				const std::vector<unsigned int>& Indices = Mesh.GetIndices();
+				const std::vector<glm::vec2>& LightmapCoords = Mesh.GetLightmapCoords();
+				const bool bRasterize = Mesh.GetVertexFormat() == VertexFormat::Lightmapped && LightmapCoords.size() >= Vertices.size() && Region.x > 0.0f;
+				for (size_t Index = 0; Index + 2 < Indices.size(); Index += 3)
+				{
+					glm::vec3 Positions[3];
+					glm::vec3 Normals[3];
+					glm::vec2 Points[3];
+					for (int Corner = 0; Corner < 3; Corner++)
+					{
+						const unsigned int VertexIndex = Indices[Index + Corner];
+						Positions[Corner] = glm::vec3(Model * glm::vec4(Vertices[VertexIndex].Position, 1.0f));
+						Normals[Corner] = NormalMatrix * Vertices[VertexIndex].Normal;
+						if (bRasterize)
+						{
+							Points[Corner] = (LightmapCoords[VertexIndex] * glm::vec2(Region.x, Region.y) + glm::vec2(Region.z, Region.w)) * static_cast<float>(Resolution);
+						}
+					}
+					Occluders.push_back({ Positions[0], Positions[1], Positions[2] });
+					if (!bRasterize)
+						continue;
+
+					const float Area = (Points[1].x - Points[0].x) * (Points[2].y - Points[0].y) - (Points[2].x - Points[0].x) * (Points[1].y - Points[0].y);
+					if (std::abs(Area) < 1e-12f)
+						continue;
+
+					// Texel centers inside the triangle, by their barycentric coordinates
+					const glm::vec2 Min = glm::min(Points[0], glm::min(Points[1], Points[2]));
+					const glm::vec2 Max = glm::max(Points[0], glm::max(Points[1], Points[2]));
+					const int MinX = std::max(static_cast<int>(std::floor(Min.x)), 0);
+					const int MinY = std::max(static_cast<int>(std::floor(Min.y)), 0);
+					const int MaxX = std::min(static_cast<int>(std::ceil(Max.x)), Resolution - 1);
+					const int MaxY = std::min(static_cast<int>(std::ceil(Max.y)), Resolution - 1);
+					bool bCovered = false;
+					for (int Y = MinY; Y <= MaxY; Y++)
+					{
+						for (int X = MinX; X <= MaxX; X++)
+						{
+							const glm::vec2 Center(static_cast<float>(X) + 0.5f, static_cast<float>(Y) + 0.5f);
+							const float W0 = ((Points[1].x - Center.x) * (Points[2].y - Center.y) - (Points[2].x - Center.x) * (Points[1].y - Center.y)) / Area;
+							const float W1 = ((Points[2].x - Center.x) * (Points[0].y - Center.y) - (Points[0].x - Center.x) * (Points[2].y - Center.y)) / Area;
+							const float W2 = 1.0f - W0 - W1;
+							if (W0 < 0.0f || W1 < 0.0f || W2 < 0.0f)
+								continue;
+
+							Cover(X, Y, W0 * Positions[0] + W1 * Positions[1] + W2 * Positions[2], W0 * Normals[0] + W1 * Normals[1] + W2 * Normals[2]);
+							bCovered = true;
+						}
+					}
+
+					// Triangles thinner than a texel still light the texel of their center, unless a larger one does
+					const glm::vec2 Centroid = (Points[0] + Points[1] + Points[2]) / 3.0f;
+					const int X = std::clamp(static_cast<int>(Centroid.x), 0, Resolution - 1);
+					const int Y = std::clamp(static_cast<int>(Centroid.y), 0, Resolution - 1);
+					if (!bCovered && SampleOfTexel[Y * Resolution + X] < 0)
+					{
+						Cover(X, Y, (Positions[0] + Positions[1] + Positions[2]) / 3.0f, Normals[0] + Normals[1] + Normals[2]);
+					}
+				}
+			}
+		}
+
+		// Lit like BaseLighting.frag: ambient plus shadowed diffuse of the directional light, then of the attenuated point lights
+		const OccluderTree Tree(std::move(Occluders));
+		m_Resolution = Resolution;
+		m_Texels.assign(SampleOfTexel.size(), glm::vec3(0.0f));
+		m_Coverage.assign(SampleOfTexel.size(), 0);
+		const int PointLightCount = std::clamp(Lights.Counts.x, 0, LightData::MaxPointLights);
+		const auto Light = [&](size_t Begin, size_t End)
+		{
+			for (size_t Index = Begin; Index < End; Index++)
+			{
+				const TexelSample& Sample = Samples[Index];
+				const float NormalLength = glm::length(Sample.Normal);
+				const glm::vec3 Normal = NormalLength > 0.0f ? Sample.Normal / NormalLength : glm::vec3(0.0f, 1.0f, 0.0f);
+				const glm::vec3 Origin = Sample.Position + Normal * Settings.ShadowBias;
+
+				const DirectionalLightData& Directional = Lights.DirectionalLight;
+				const glm::vec3 ToSun = -glm::normalize(glm::vec3(Directional.Direction));
+				const float SunLambert = std::max(glm::dot(Normal, ToSun), 0.0f);
+				const bool bSunShadowed = Settings.bShadows && SunLambert > 0.0f && Tree.IsOccluded(Origin, ToSun, std::numeric_limits<float>::max());
+				glm::vec3 Result = glm::vec3(Directional.Ambient) + glm::vec3(Directional.Diffuse) * (bSunShadowed ? 0.0f : SunLambert);
+
+				for (int LightIndex = 0; LightIndex < PointLightCount; LightIndex++)
+				{
+					const PointLightData& Point = Lights.PointLights[LightIndex];
+					const glm::vec3 ToLight = glm::vec3(Point.Position) - Sample.Position;
+					const float Distance = glm::length(ToLight);
+					if (Distance <= 0.0f)
+						continue;
+
+					const glm::vec3 Direction = ToLight / Distance;
+					const float Lambert = std::max(glm::dot(Normal, Direction), 0.0f);
+					const bool bShadowed = Settings.bShadows && Lambert > 0.0f && Tree.IsOccluded(Origin, Direction, Distance - Settings.ShadowBias);
+					const float Attenuation = 1.0f / (Point.Attenuation.x + Point.Attenuation.y * Distance + Point.Attenuation.z * Distance * Distance);
+					Result += (glm::vec3(Point.Ambient) + glm::vec3(Point.Diffuse) * (bShadowed ? 0.0f : Lambert)) * Attenuation;
+				}
+				m_Texels[Sample.Texel] = Result;
+				m_Coverage[Sample.Texel] = 1;
+			}
+		};
+		if (Jobs)
+		{
+			Jobs->ParallelFor(Samples.size(), 1024, Light);
+		}
+		else
+		{
+			Light(0, Samples.size());
+		}
+
+		Dilate(Padding);
+		for (size_t Index = 0; Index < Objects.size(); Index++)
+		{
+			if (Regions[Index].x > 0.0f)
+			{
+				Objects[Index]->SetInstancePayload(Regions[Index]);
+			}
+		}
+		m_Regions = std::move(Regions);
+		Upload();
+		LOG_INFO("Baked a lightmap of " + std::to_string(Resolution) + " texels for " + std::to_string(Order.size()) + " objects, "
+			+ std::to_string(Samples.size()) + " texels lit.")
+		return true;
+	}
+
+	bool Lightmap::Save(std::string_view Path) const
+	{
+		if (!IsBaked())
+			return false;
+
+		std::ofstream File(std::string(Path), std::ios::binary | std::ios::trunc);
+		if (!File)
+			return false;
+
+		const FileHeader Header = { Magic, Version, static_cast<uint32_t>(m_Resolution), static_cast<uint32_t>(m_Regions.size()) };
+		File.write(reinterpret_cast<const char*>(&Header), sizeof(Header));
+		File.write(reinterpret_cast<const char*>(m_Regions.data()), m_Regions.size() * sizeof(glm::vec4));
+		File.write(reinterpret_cast<const char*>(m_Texels.data()), m_Texels.size() * sizeof(glm::vec3));
+		return static_cast<bool>(File);
+	}
+
+	bool Lightmap::Load(std::string_view Path, const std::vector<SceneObject*>& Objects)
+	{
+		std::ifstream File(std::string(Path), std::ios::binary);
+		if (!File)
+			return false;
+
+		FileHeader Header = {};
+		File.read(reinterpret_cast<char*>(&Header), sizeof(Header));
+		if (!File || Header.Magic != Magic || Header.Version != Version || Header.RegionCount != Objects.size() || Header.Resolution == 0)
+			return false;
+
+		std::vector<glm::vec4> Regions(Header.RegionCount);
+		std::vector<glm::vec3> Texels(static_cast<size_t>(Header.Resolution) * Header.Resolution);
+		File.read(reinterpret_cast<char*>(Regions.data()), Regions.size() * sizeof(glm::vec4));
+		File.read(reinterpret_cast<char*>(Texels.data()), Texels.size() * sizeof(glm::vec3));
+		if (!File)
+			return false;
+
+		for (size_t Index = 0; Index < Objects.size(); Index++)
+		{
+			if (Regions[Index].x > 0.0f)
+			{
+				Objects[Index]->SetInstancePayload(Regions[Index]);
+			}
+		}
+		m_Resolution = static_cast<int>(Header.Resolution);
+		m_Regions = std::move(Regions);
+		m_Texels = std::move(Texels);
+		m_Coverage.clear();
+		Upload();
+		return true;
+	}
+
+	void Lightmap::Destroy()
+	{
+		if (m_Texture != 0)
+		{
+			glDeleteTextures(1, &m_Texture);
+			GLStateCache::OnTextureDeleted(m_Texture);
+			GPUMemoryTracker::UntrackTexture(m_Texture);
+			m_Texture = 0;
+		}
+		m_Resolution = 0;
+		m_Texels.clear();
+		m_Coverage.clear();
+		m_Regions.clear();
+	}
+
+	bool Lightmap::IsBaked() const
+	{
+		return m_Texture != 0;
+	}
+
+	void Lightmap::Bind() const
+	{
+		GLStateCache::BindTextureUnit(TextureUnit, GL_TEXTURE_2D, m_Texture);
+	}
+
+	int Lightmap::GetResolution() const
+	{
+		return m_Resolution;
+	}
+
+	const std::vector<glm::vec4>& Lightmap::GetRegions() const
+	{
+		return m_Regions;
+	}
+
+	void Lightmap::Upload()
+	{
+		if (m_Texture == 0)
+		{
+			glGenTextures(1, &m_Texture);
+		}
+		else
+		{
+			GPUMemoryTracker::UntrackTexture(m_Texture);
+		}
+		GLStateCache::BindTexture(GL_TEXTURE_2D, m_Texture);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, m_Resolution, m_Resolution, 0, GL_RGB, GL_FLOAT, m_Texels.data());
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		GPUMemoryTracker::TrackTexture(m_Texture, GPUMemoryTracker::GetTextureSize(GL_RGB16F, m_Resolution, m_Resolution), GPUMemoryCategory::Textures, "Lightmap");
+	}
+
+	void Lightmap::Dilate(int Iterations)
+	{
+		std::vector<uint8_t> Filled;
+		for (int Iteration = 0; Iteration < Iterations; Iteration++)
+		{
+			Filled = m_Coverage;
+			for (int Y = 0; Y < m_Resolution; Y++)
+			{
+				for (int X = 0; X < m_Resolution; X++)
+				{
+					const size_t Texel = static_cast<size_t>(Y) * m_Resolution + X;
+					if (m_Coverage[Texel])
+						continue;
+
+					glm::vec3 Sum(0.0f);
+					int Count = 0;
+					for (int OffsetY = -1; OffsetY <= 1; OffsetY++)
+					{
+						for (int OffsetX = -1; OffsetX <= 1; OffsetX++)
+						{
+							const int NeighbourX = X + OffsetX;
+							const int NeighbourY = Y + OffsetY;
+							if (NeighbourX < 0 || NeighbourY < 0 || NeighbourX >= m_Resolution || NeighbourY >= m_Resolution)
+								continue;
+
+							const size_t Neighbour = static_cast<size_t>(NeighbourY) * m_Resolution + NeighbourX;
+							if (m_Coverage[Neighbour])
+							{
+								Sum += m_Texels[Neighbour];
+								Count++;
+							}
+						}
+					}
+					if (Count > 0)
+					{
+						m_Texels[Texel] = Sum / static_cast<float>(Count);
+						Filled[Texel] = 1;
+					}
+				}
+			}
+			m_Coverage.swap(Filled);
+		}
+	}
+
+} // namespace fgl
@@ -0,0 +1,578 @@
+#include <FireGL/Renderer/LocalShadowAtlas.h>
+#include <FireGL/Renderer/GLStateCache.h>
+#include <FireGL/Renderer/GPUMemoryTracker.h>
+#include <FireGL/Renderer/RenderStats.h>
+#include <FireGL/Core/BaseLog.h>
+
+#include <External/glm/gtc/matrix_transform.hpp>
+
+#include <bit>
+#include <cstring>
+
+namespace fgl
+{
+
+	namespace
+	{
+		constexpr std::string_view CasterVertexCode = R"(#version 410 core
+layout (location = 0) in vec3 aPos;
+layout (location = 3) in mat4 ModelMatrix;
+layout (location = 7) in mat3x4 NormalMatrix;
+
+layout (std140) uniform CameraData
+{
+    mat4 View;
+    mat4 Projection;
+    mat4 ViewProjection;
+    vec4 Position;
+    mat4 InverseViewProjection;
+    vec4 Time;
+} Camera;
+
+uniform mat4 LightViewProjection;
+
+// Same procedural animation as BaseLighting.vert, see ProceduralAnimation
+float UnpackHalf(uint Bits)
+{
+    float Mantissa = float(Bits & 0x3FFu);
+    uint Exponent = (Bits >> 10u) & 0x1Fu;
+    float Value = Exponent == 0u ? Mantissa * exp2(-24.0) : (1024.0 + Mantissa) * exp2(float(Exponent) - 25.0);
+    return (Bits & 0x8000u) != 0u ? -Value : Value;
+}
+
+mat3 ProceduralRotation(uvec3 Packed, float Time, out vec3 Offset)
+{
+    vec2 Octahedral = vec2(Packed.x & 0xFFu, (Packed.x >> 8u) & 0xFFu) / 127.5 - 1.0;
+    vec3 Axis = vec3(Octahedral, 1.0 - abs(Octahedral.x) - abs(Octahedral.y));
+    if (Axis.z < 0.0)
+        Axis.xy = (1.0 - abs(Axis.yx)) * mix(vec2(-1.0), vec2(1.0), greaterThanEqual(Axis.xy, vec2(0.0)));
+    Axis = normalize(Axis);
+    float Wave = sin(6.2831853 * UnpackHalf(Packed.z >> 16u) * Time + UnpackHalf(Packed.z & 0xFFFFu));
+    float Angle = UnpackHalf(Packed.x >> 16u) * Time + UnpackHalf(Packed.y & 0xFFFFu) * Wave;
+    Offset = Axis * (UnpackHalf(Packed.y >> 16u) * Wave);
+    float Cosine = cos(Angle);
+    return mat3(Cosine) + sin(Angle) * mat3(0.0, Axis.z, -Axis.y, -Axis.z, 0.0, Axis.x, Axis.y, -Axis.x, 0.0) + (1.0 - Cosine) * outerProduct(Axis, Axis);
+}
+
+void main()
+{
+    vec3 Position = aPos;
+    uvec3 Animation = floatBitsToUint(vec3(NormalMatrix[0].w, NormalMatrix[1].w, NormalMatrix[2].w));
+    if (Animation != uvec3(0u))
+    {
+        vec3 Offset;
+        Position = ProceduralRotation(Animation, Camera.Time.x, Offset) * Position + Offset;
+    }
+    gl_Position = LightViewProjection * ModelMatrix * vec4(Position, 1.0);
+})";
+
+		constexpr std::string_view CasterFragmentCode = R"(#version 410 core
+void main()
+{
+})";
+
+		/** Looking directions and up vectors of the faces of a point light, in cube map order. */
+		constexpr glm::vec3 FaceDirections[LocalShadowAtlas::MaxFaces] = {
+			{ 1.0f, 0.0f, 0.0f }, { -1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, -1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, -1.0f }
+		};
+		constexpr glm::vec3 FaceUps[LocalShadowAtlas::MaxFaces] = {
+			{ 0.0f, -1.0f, 0.0f }, { 0.0f, -1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, -1.0f }, { 0.0f, -1.0f, 0.0f }, { 0.0f, -1.0f, 0.0f }
+		};
+
+		/** FNV-1a step over the bits of a float. */
+		uint64_t HashFloat(uint64_t Hash, float Value)
+		{
+			uint32_t Bits = 0;
+			std::memcpy(&Bits, &Value, sizeof(Bits));
+			return (Hash ^ Bits) * 1099511628211ull;
+		}
+	}
+
+	void LocalShadowAtlas::Create()
+	{
+		glGenBuffers(1, &m_BufferID);
+		GLStateCache::BindBuffer(GL_UNIFORM_BUFFER, m_BufferID);
+		glBufferData(GL_UNIFORM_BUFFER, sizeof(LocalShadowData), &m_Data, GL_DYNAMIC_DRAW);
+		GPUMemoryTracker::TrackBuffer(m_BufferID, sizeof(LocalShadowData), GPUMemoryCategory::Uniforms, "LocalShadowAtlas");
+		m_bDirty = false;
+
+		// Also binds the generic GL_UNIFORM_BUFFER point, which the cache already holds
+		glBindBufferBase(GL_UNIFORM_BUFFER, BindingPoint, m_BufferID);
+	}
+
+	void LocalShadowAtlas::Destroy()
+	{
+		DestroyTextures();
+		if (m_CasterShader)
+		{
+			m_CasterShader->Cleanup();
+			m_CasterShader.reset();
+		}
+		glDeleteBuffers(1, &m_BufferID);
+		GLStateCache::OnBufferDeleted(m_BufferID);
+		GPUMemoryTracker::UntrackBuffer(m_BufferID);
+		m_BufferID = 0;
+	}
+
+	void LocalShadowAtlas::SetAtlasSize(uint32_t Size)
+	{
+		m_AtlasSize = std::bit_ceil(std::max<uint32_t>(Size, 1));
+		m_MinTileSize = std::min(m_MinTileSize, m_AtlasSize);
+		m_AllocatedSize = 0;
+	}
+
+	uint32_t LocalShadowAtlas::GetAtlasSize() const
+	{
+		return m_AtlasSize;
+	}
+
+	void LocalShadowAtlas::SetTileSizes(uint32_t MinSize, uint32_t MaxSize)
+	{
+		m_MinTileSize = std::min(std::bit_ceil(std::max<uint32_t>(MinSize, 1)), m_AtlasSize);
+		m_MaxTileSize = std::max(std::bit_ceil(std::max<uint32_t>(MaxSize, 1)), m_MinTileSize);
+		m_AllocatedSize = 0;
+	}
+
+	void LocalShadowAtlas::SetResolutionScale(float Scale)
+	{
+		m_ResolutionScale = std::max(Scale, 0.0f);
+	}
+
+	void LocalShadowAtlas::SetUpdateBudget(uint32_t Tiles)
+	{
+		m_UpdateBudget = Tiles;
+	}
+
+	uint32_t LocalShadowAtlas::GetUpdateBudget() const
+	{
+		return m_UpdateBudget;
+	}
+
+	void LocalShadowAtlas::SetShadowedLights(uint32_t PointLightMask, bool bSpotLight)
+	{
+		m_PointLightMask = PointLightMask;
+		m_bSpotLightShadowed = bSpotLight;
+	}
+
+	void LocalShadowAtlas::SetMaxRange(float Range)
+	{
+		m_MaxRange = std::max(Range, m_NearPlane * 2.0f);
+	}
+
+	void LocalShadowAtlas::SetNearPlane(float Distance)
+	{
+		m_NearPlane = std::max(Distance, 0.001f);
+	}
+
+	void LocalShadowAtlas::SetBias(float DepthBias, float NormalBias)
+	{
+		m_DepthBias = DepthBias;
+		m_NormalBias = NormalBias;
+	}
+
+	float LocalShadowAtlas::GetLightRange(const glm::vec4& Attenuation, const glm::vec4& Diffuse) const
+	{
+		// Solves Constant + Linear * d + Quadratic * d^2 = 256 * Brightness
+		const float Brightness = std::max({ Diffuse.x, Diffuse.y, Diffuse.z, 1.0f / 256.0f });
+		const float Constant = Attenuation.x - 256.0f * Brightness;
+		float Range = m_MaxRange;
+		if (Constant >= 0.0f)
+		{
+			Range = 0.0f;
+		}
+		else if (Attenuation.z > 0.0f)
+		{
+			Range = (-Attenuation.y + std::sqrt(Attenuation.y * Attenuation.y - 4.0f * Attenuation.z * Constant)) / (2.0f * Attenuation.z);
+		}
+		else if (Attenuation.y > 0.0f)
+		{
+			Range = -Constant / Attenuation.y;
+		}
+		return std::clamp(Range, m_NearPlane * 2.0f, m_MaxRange);
+	}
+
+	void LocalShadowAtlas::Update(const LightData& Lights, const CameraData& Camera, int ViewportHeight)
+	{
+		const glm::vec3 CameraPosition(Camera.Position);
+		const float Height = static_cast<float>(std::max(ViewportHeight, 1));
+		for (uint32_t Slot = 0; Slot < SlotCount; Slot++)
+		{
+			LightState& Light = m_Lights[Slot];
+			const bool bSpotLight = Slot == SpotLightSlot;
+			Light.bShadowed = bSpotLight ? m_bSpotLightShadowed && Lights.Counts.y != 0
+				: (m_PointLightMask >> Slot & 1u) != 0 && static_cast<int>(Slot) < Lights.Counts.x;
+			if (!Light.bShadowed)
+				continue;
+
+			const glm::vec3 Position = bSpotLight ? glm::vec3(Lights.SpotLight.Position) : glm::vec3(Lights.PointLights[Slot].Position);
+			const float Range = bSpotLight ? GetLightRange(Lights.SpotLight.Attenuation, Lights.SpotLight.Diffuse)
+				: GetLightRange(Lights.PointLights[Slot].Attenuation, Lights.PointLights[Slot].Diffuse);
+			Light.Bounds = BoundingSphere{ Position, Range };
+
+			uint64_t Hash = 14695981039346656037ull;
+			for (float Value : { Position.x, Position.y, Position.z, Range, m_NearPlane })
+			{
+				Hash = HashFloat(Hash, Value);
+			}
+			if (bSpotLight)
+			{
+				// One face around the outer cone, widened by a texel's worth so its edge isn't filtered against the border
+				const glm::vec3 Direction = glm::normalize(glm::vec3(Lights.SpotLight.Direction));
+				const float HalfAngle = std::min(std::acos(std::clamp(Lights.SpotLight.CutOff.y, -1.0f, 1.0f)) * 1.02f, glm::radians(85.0f));
+				const glm::vec3 Up = std::abs(Direction.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+				Light.FaceCount = 1;
+				Light.FovScale = 2.0f * std::tan(HalfAngle);
+				Light.ViewProjection[0] = glm::perspective(2.0f * HalfAngle, 1.0f, m_NearPlane, Range) * glm::lookAt(Position, Position + Direction, Up);
+				for (float Value : { Direction.x, Direction.y, Direction.z, HalfAngle })
+				{
+					Hash = HashFloat(Hash, Value);
+				}
+			}
+			else
+			{
+				const glm::mat4 Projection = glm::perspective(glm::radians(90.0f), 1.0f, m_NearPlane, Range);
+				Light.FaceCount = MaxFaces;
+				Light.FovScale = 2.0f;
+				for (uint32_t Face = 0; Face < MaxFaces; Face++)
+				{
+					Light.ViewProjection[Face] = Projection * glm::lookAt(Position, Position + FaceDirections[Face], FaceUps[Face]);
+				}
+			}
+			Light.LightHash = Hash;
+
+			// Projected diameter of the lit sphere, the whole viewport once the camera is inside it
+			const float Distance = glm::length(Position - CameraPosition);
+			float Diameter = Height;
+			if (Distance > Range)
+			{
+				const float TanAngle = Range / std::sqrt(Distance * Distance - Range * Range);
+				Diameter = std::min(TanAngle * Camera.Projection[1][1], 1.0f) * Height;
+			}
+			Light.Importance = Diameter;
+			const uint32_t Texels = static_cast<uint32_t>(std::max(Diameter * m_ResolutionScale, 1.0f));
+			Light.DesiredSize = std::clamp(std::bit_ceil(Texels), m_MinTileSize, std::min(m_MaxTileSize, m_AtlasSize));
+		}
+	}
+
+	bool LocalShadowAtlas::IsShadowed(uint32_t Slot) const
+	{
+		return m_Lights[Slot].bShadowed;
+	}
+
+	const BoundingSphere& LocalShadowAtlas::GetLightBounds(uint32_t Slot) const
+	{
+		return m_Lights[Slot].Bounds;
+	}
+
+	uint32_t LocalShadowAtlas::GetFaceCount(uint32_t Slot) const
+	{
+		return m_Lights[Slot].FaceCount;
+	}
+
+	const glm::mat4& LocalShadowAtlas::GetFaceViewProjection(uint32_t Slot, uint32_t Face) const
+	{
+		return m_Lights[Slot].ViewProjection[Face];
+	}
+
+	LocalShadowSlot& LocalShadowAtlas::GetSlot(uint32_t Slot)
+	{
+		return Slot == SpotLightSlot ? m_Data.SpotLight : m_Data.PointLights[Slot];
+	}
+
+	const std::vector<uint32_t>& LocalShadowAtlas::ScheduleUpdates(const std::array<uint64_t, SlotCount>& CasterHashes)
+	{
+		if (m_AllocatedSize != m_AtlasSize)
+		{
+			Allocate();
+		}
+
+		// Lights that stopped casting give their tiles back, the others are redrawn once their view, casters or size changed
+		m_Candidates.clear();
+		for (uint32_t Slot = 0; Slot < SlotCount; Slot++)
+		{
+			LightState& Light = m_Lights[Slot];
+			if (!Light.bShadowed)
+			{
+				if (Light.TileSize != 0)
+				{
+					ReleaseTiles(Light);
+					GetSlot(Slot).Params.x = 0.0f;
+					m_bDirty = true;
+				}
+				continue;
+			}
+
+			Light.PendingHash = (Light.LightHash ^ CasterHashes[Slot]) * 1099511628211ull;
+			const bool bResize = Light.DesiredSize > Light.TileSize || Light.DesiredSize * 4 <= Light.TileSize;
+			if (Light.TileSize == 0 || Light.DrawnHash != Light.PendingHash || bResize)
+			{
+				Light.StaleFrames++;
+				m_Candidates.push_back(Slot);
+			}
+		}
+
+		// Lights without shadows first, then the most important ones, weighed by how long they waited
+		const auto Priority = [this](uint32_t Slot)
+		{
+			const LightState& Light = m_Lights[Slot];
+			return Light.TileSize == 0 ? std::numeric_limits<float>::infinity() : Light.Importance * static_cast<float>(Light.StaleFrames);
+		};
+		std::sort(m_Candidates.begin(), m_Candidates.end(), [&Priority](uint32_t A, uint32_t B) { return Priority(A) > Priority(B); });
+
+		m_Scheduled.clear();
+		m_UpdatedTiles = 0;
+		const float InverseSize = 1.0f / static_cast<float>(m_AllocatedSize);
+		for (uint32_t Slot : m_Candidates)
+		{
+			LightState& Light = m_Lights[Slot];
+			if (m_UpdatedTiles + Light.FaceCount > m_UpdateBudget && !m_Scheduled.empty())
+				continue;
+
+			// A light whose only change was its size keeps its depth if no other size fits
+			const uint32_t DrawnSize = Light.TileSize;
+			if (!FitTiles(Light) || (Light.TileSize == DrawnSize && Light.DrawnHash == Light.PendingHash))
+				continue;
+
+			m_UpdatedTiles += Light.FaceCount;
+			Light.DrawnHash = Light.PendingHash;
+			Light.StaleFrames = 0;
+			m_Scheduled.push_back(Slot);
+
+			// The block takes the matrices the tiles are drawn with, lights waiting for a redraw keep their previous ones
+			LocalShadowSlot& Data = GetSlot(Slot);
+			const float TileScale = static_cast<float>(Light.TileSize) * InverseSize;
+			for (uint32_t Face = 0; Face < Light.FaceCount; Face++)
+			{
+				Data.ViewProjection[Face] = Light.ViewProjection[Face];
+				Data.Tiles[Face] = glm::vec4(glm::vec2(Light.Tiles[Face]) * InverseSize, TileScale, TileScale);
+			}
+			Data.Params = glm::vec4(static_cast<float>(Light.FaceCount), m_DepthBias, m_NormalBias, Light.FovScale);
+			m_bDirty = true;
+		}
+
+		if (m_Data.Params.x != InverseSize)
+		{
+			m_Data.Params.x = InverseSize;
+			m_bDirty = true;
+		}
+		if (m_bDirty || m_bDisabled)
+		{
+			Upload(m_Data);
+		}
+		GLStateCache::BindTextureUnit(TextureUnit, GL_TEXTURE_2D, m_Atlas);
+		return m_Scheduled;
+	}
+
+	void LocalShadowAtlas::BeginCasterPass()
+	{
+		glGetIntegerv(GL_VIEWPORT, m_SavedViewport);
+		glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &m_SavedFramebuffer);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_Framebuffer);
+
+		// Each face clears and draws its own tile only, the other tiles keep their depth
+		glEnable(GL_SCISSOR_TEST);
+		glEnable(GL_POLYGON_OFFSET_FILL);
+		glPolygonOffset(2.0f, 1.0f);
+
+		if (!m_CasterShader)
+		{
+			m_CasterShader = Shader::CreateFromSource(CasterVertexCode, CasterFragmentCode);
+			m_ViewProjectionUniform = m_CasterShader->GetUniform("LightViewProjection");
+		}
+		m_CasterShader->Activate();
+	}
+
+	void LocalShadowAtlas::BeginTile(uint32_t Slot, uint32_t Face)
+	{
+		const LightState& Light = m_Lights[Slot];
+		const GLint X = static_cast<GLint>(Light.Tiles[Face].x);
+		const GLint Y = static_cast<GLint>(Light.Tiles[Face].y);
+		const GLsizei Size = static_cast<GLsizei>(Light.TileSize);
+		glViewport(X, Y, Size, Size);
+		glScissor(X, Y, Size, Size);
+		glClear(GL_DEPTH_BUFFER_BIT);
+		m_CasterShader->SetMat4(m_ViewProjectionUniform, Light.ViewProjection[Face]);
+	}
+
+	void LocalShadowAtlas::EndCasterPass()
+	{
+		glDisable(GL_POLYGON_OFFSET_FILL);
+		glDisable(GL_SCISSOR_TEST);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_SavedFramebuffer);
+		glViewport(m_SavedViewport[0], m_SavedViewport[1], m_SavedViewport[2], m_SavedViewport[3]);
+		GLStateCache::BindTextureUnit(TextureUnit, GL_TEXTURE_2D, m_Atlas);
+	}
+
+	void LocalShadowAtlas::Disable()
+	{
+		if (m_bDisabled)
+			return;
+
+		// Only the uploaded copy is cleared, the next ScheduleUpdates() uploads the tiles again
+		LocalShadowData Data = m_Data;
+		for (LocalShadowSlot& Slot : Data.PointLights)
+		{
+			Slot.Params.x = 0.0f;
+		}
+		Data.SpotLight.Params.x = 0.0f;
+		Upload(Data);
+		m_bDisabled = true;
+	}
+
+	uint32_t LocalShadowAtlas::GetUpdatedTileCount() const
+	{
+		return m_UpdatedTiles;
+	}
+
+	void LocalShadowAtlas::Upload(const LocalShadowData& Data)
+	{
+		GLStateCache::BindBuffer(GL_UNIFORM_BUFFER, m_BufferID);
+		glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(LocalShadowData), &Data);
+		RenderCounters::CountUpload(sizeof(LocalShadowData));
+		m_bDirty = false;
+		m_bDisabled = false;
+	}
+
+	bool LocalShadowAtlas::FitTiles(LightState& Light)
+	{
+		// From the asked size towards the current one, which the light keeps if nothing in between fits
+		const uint32_t CurrentSize = Light.TileSize;
+		std::array<glm::uvec2, MaxFaces> Tiles{};
+		for (uint32_t Size = Light.DesiredSize; Size != CurrentSize;)
+		{
+			uint32_t Allocated = 0;
+			while (Allocated < Light.FaceCount && AllocateTile(Size, Tiles[Allocated]))
+			{
+				Allocated++;
+			}
+			if (Allocated == Light.FaceCount)
+			{
+				ReleaseTiles(Light);
+				Light.Tiles = Tiles;
+				Light.TileSize = Size;
+				return true;
+			}
+			for (uint32_t Face = 0; Face < Allocated; Face++)
+			{
+				FreeTile(Size, Tiles[Face]);
+			}
+
+			// A light without tiles tries every size down to the smallest
+			if (CurrentSize == 0 && Size == m_MinTileSize)
+				break;
+			Size = CurrentSize == 0 || Size > CurrentSize ? Size / 2 : Size * 2;
+		}
+		return Light.TileSize != 0;
+	}
+
+	void LocalShadowAtlas::ReleaseTiles(LightState& Light)
+	{
+		for (uint32_t Face = 0; Face < Light.FaceCount && Light.TileSize != 0; Face++)
+		{
+			FreeTile(Light.TileSize, Light.Tiles[Face]);
+		}
+		Light.TileSize = 0;
+	}
+
+	bool LocalShadowAtlas::AllocateTile(uint32_t Size, glm::uvec2& Offset)
+	{
+		const uint32_t Level = static_cast<uint32_t>(std::countr_zero(m_AllocatedSize) - std::countr_zero(Size));
+		if (Level >= m_FreeTiles.size())
+			return false;
+
+		// The smallest free tile at least as large, split down to the size
+		uint32_t Source = Level;
+		while (m_FreeTiles[Source].empty())
+		{
+			if (Source == 0)
+				return false;
+			Source--;
+		}
+		Offset = m_FreeTiles[Source].back();
+		m_FreeTiles[Source].pop_back();
+		for (; Source < Level; Source++)
+		{
+			const uint32_t Half = m_AllocatedSize >> (Source + 1);
+			m_FreeTiles[Source + 1].push_back(Offset + glm::uvec2(Half, 0));
+			m_FreeTiles[Source + 1].push_back(Offset + glm::uvec2(0, Half));
+			m_FreeTiles[Source + 1].push_back(Offset + glm::uvec2(Half, Half));
+		}
+		return true;
+	}
+
+	void LocalShadowAtlas::FreeTile(uint32_t Size, glm::uvec2 Offset)
+	{
+		uint32_t Level = static_cast<uint32_t>(std::countr_zero(m_AllocatedSize) - std::countr_zero(Size));
+		while (Level > 0)
+		{
+			const glm::uvec2 Parent(Offset.x & ~(Size * 2 - 1), Offset.y & ~(Size * 2 - 1));
+			const auto IsBuddy = [Parent, Size](const glm::uvec2& Tile)
+			{
+				return (Tile.x & ~(Size * 2 - 1)) == Parent.x && (Tile.y & ~(Size * 2 - 1)) == Parent.y;
+			};
+			std::vector<glm::uvec2>& Free = m_FreeTiles[Level];
+			if (std::count_if(Free.begin(), Free.end(), IsBuddy) < 3)
+				break;
+
+			std::erase_if(Free, IsBuddy);
+			Offset = Parent;
+			Size *= 2;
+			Level--;
+		}
+		m_FreeTiles[Level].push_back(Offset);
+	}
+
+	void LocalShadowAtlas::Allocate()
+	{
+		DestroyTextures();
+		m_AllocatedSize = m_AtlasSize;
+
+		// Every light lost its tiles, they are drawn again as budget allows
+		m_FreeTiles.assign(static_cast<size_t>(std::countr_zero(m_AtlasSize) - std::countr_zero(m_MinTileSize)) + 1, {});
+		m_FreeTiles[0].push_back(glm::uvec2(0));
+		for (uint32_t Slot = 0; Slot < SlotCount; Slot++)
+		{
+			m_Lights[Slot].TileSize = 0;
+			GetSlot(Slot).Params.x = 0.0f;
+		}
+		m_bDirty = true;
+
+		// Hardware comparison with linear filtering gives a 2x2 PCF per tap, the taps are clamped to their tile
+		glGenTextures(1, &m_Atlas);
+		GLStateCache::BindTexture(GL_TEXTURE_2D, m_Atlas);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, static_cast<GLsizei>(m_AtlasSize), static_cast<GLsizei>(m_AtlasSize),
+			0, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, nullptr);
+		GPUMemoryTracker::TrackTexture(m_Atlas, GPUMemoryTracker::GetTextureSize(GL_DEPTH_COMPONENT24, static_cast<int>(m_AtlasSize),
+			static_cast<int>(m_AtlasSize), 1), GPUMemoryCategory::RenderTargets, "LocalShadowAtlas");
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+
+		GLint DrawFramebuffer = 0;
+		glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &DrawFramebuffer);
+		glGenFramebuffers(1, &m_Framebuffer);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_Framebuffer);
+		glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, m_Atlas, 0);
+		glDrawBuffer(GL_NONE);
+		LOG_ASSERT(glCheckFramebufferStatus(GL_DRAW_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE, "Local shadow atlas framebuffer is incomplete")
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, DrawFramebuffer);
+	}
+
+	void LocalShadowAtlas::DestroyTextures()
+	{
+		m_AllocatedSize = 0;
+		if (m_Framebuffer == 0)
+			return;
+
+		glDeleteFramebuffers(1, &m_Framebuffer);
+		m_Framebuffer = 0;
+		glDeleteTextures(1, &m_Atlas);
+		GLStateCache::OnTextureDeleted(m_Atlas);
+		GPUMemoryTracker::UntrackTexture(m_Atlas);
+		m_Atlas = 0;
+	}
+
+} // namespace fgl
@@ -1,60 +1,307 @@
 #include <FireGL/Renderer/Material.h>
 #include <FireGL/Core/BaseLog.h>
 #include <FireGL/Renderer/Shader.h>
+#include <FireGL/Renderer/ShaderVariants.h>
 #include <FireGL/Renderer/Texture.h>
 #include <FireGL/Renderer/SceneObject.h>
+#include <FireGL/Renderer/MaterialBuffer.h>
+#include <FireGL/Renderer/GLStateCache.h>
+#include <FireGL/Renderer/RenderDevice.h>
+#include <FireGL/Renderer/GPUMemoryTracker.h>
+#include <FireGL/Renderer/RenderStats.h>
 
 namespace fgl
 {
 
+	uint32_t Material::s_NextID = 1;
+	const Material* Material::s_ActiveMaterial = nullptr;
+	uint32_t Material::s_ActiveVersion = 0;
+	uint32_t Material::s_Generation = 0;
+	std::vector<Material*> Material::s_CaptureQueue;
+
+	namespace
+	{
+		/** The material whose uniforms a program holds, at which version and in which generation. */
+		struct AppliedUniforms
+		{
+			const Material* Owner = nullptr;
+			uint32_t Version = 0;
+			uint32_t Generation = 0;
+		};
+
+		/** Uniforms held by each program, uniform values are program state and survive other programs being used. */
+		std::unordered_map<uint32_t, AppliedUniforms> s_AppliedUniforms;
+	}
+
 	Material::Material(Shader* Shader)
-		: m_ShaderProgram{ Shader }
+		: m_SceneObject{ nullptr }, m_ID{ s_NextID++ }
 	{
+		m_BatchID = m_ID;
+		m_State.Program = Shader;
+		m_RenderState.Program = Shader;
+	}
+
+	Material::~Material()
+	{
+		if (m_ParameterBuffer != 0)
+		{
+			glDeleteBuffers(1, &m_ParameterBuffer);
+			GLStateCache::OnBufferDeleted(m_ParameterBuffer);
+			GPUMemoryTracker::UntrackBuffer(m_ParameterBuffer);
+		}
+		if (s_ActiveMaterial == this)
+		{
+			s_ActiveMaterial = nullptr;
+		}
+		if (m_bCaptureQueued)
+		{
+			std::erase(s_CaptureQueue, this);
+		}
+		if (m_RenderState.Program)
+		{
+			auto It = s_AppliedUniforms.find(m_RenderState.Program->GetID());
+			if (It != s_AppliedUniforms.end() && It->second.Owner == this)
+			{
+				s_AppliedUniforms.erase(It);
+			}
+		}
+	}
+
+	void Material::SetParameters(const void* Data, size_t Size)
+	{
+		const uint8_t* Bytes = static_cast<const uint8_t*>(Data);
+		if (m_State.Parameters.size() == Size && std::equal(Bytes, Bytes + Size, m_State.Parameters.begin()))
+			return;
+
+		m_State.Parameters.assign(Bytes, Bytes + Size);
+		m_bParametersChanged = true;
+		MarkChanged();
 	}
 
 	void Material::SetTexture(std::string_view TextureName, Texture* Texture)
+	{
+		SetTexture(Symbol(TextureName), Texture);
+	}
+
+	void Material::SetTexture(Symbol TextureName, Texture* Texture)
 	{
 		LOG_ASSERT(Texture, "Texture initialized was not valid...")
 		
-		Texture->SetSlotIndex(m_Textures.size());
-		m_Textures[TextureName.data()] = Texture;
+		// A replaced texture keeps the slot of the previous one, new names take the next slot
+		auto Found = m_State.Textures.find(TextureName);
+		const int Slot = Found != m_State.Textures.end() && Found->second ? Found->second->GetSlotIndex() : static_cast<int>(m_State.Textures.size());
+		Texture->SetSlotIndex(static_cast<int8_t>(Slot));
+		m_State.Textures[TextureName] = Texture;
+		MarkChanged();
+	}
+
+	void Material::SetShaderVariant(ShaderVariants& Variants, uint32_t FeatureMask)
+	{
+		m_State.Program = Variants.Get(FeatureMask);
+		MarkChanged();
 	}
 
 	void Material::Activate()
 	{
-		if (!m_ShaderProgram)
+		const Shader* Program = m_RenderState.Program;
+		if (!Program)
 		{
 			LOG_ERROR("Shader program is null or uninitialized. Ensure a valid shader program is assigned to this material before activation.", true)
 			return;
 		}
 
-		m_ShaderProgram->Activate();
+		if (m_bParametersDirty)
+		{
+			UploadParameters();
+		}
+
+		// Passes between two draws of the active material may have bound another program or reset the raster state
+		RenderDevice::Get().BindPipeline({ Program, m_RenderState.Raster });
+
+		const uint32_t Version = m_RenderState.Version;
+		if (s_ActiveMaterial == this && s_ActiveVersion == Version)
+			return;
+
 		ActivateTextures();
-		ApplyUniforms();
+		if (m_ParameterBuffer != 0)
+		{
+			RenderDevice::Get().BindUniformBuffer(ParameterBindingPoint, { m_ParameterBuffer });
+		}
+
+		// Skip the uniforms when the program still holds this material's values from this generation
+		AppliedUniforms& Applied = s_AppliedUniforms[Program->GetID()];
+		if (Applied.Owner != this || Applied.Version != Version || Applied.Generation != s_Generation)
+		{
+			ApplyUniforms();
+			Applied = { this, Version, s_Generation };
+		}
+
+		s_ActiveMaterial = this;
+		s_ActiveVersion = Version;
+	}
+
+	void Material::UploadParameters()
+	{
+		if (m_ParameterBuffer == 0)
+		{
+			glGenBuffers(1, &m_ParameterBuffer);
+		}
+
+		GLStateCache::BindBuffer(GL_UNIFORM_BUFFER, m_ParameterBuffer);
+		const std::vector<uint8_t>& Parameters = m_RenderState.Parameters;
+		glBufferData(GL_UNIFORM_BUFFER, Parameters.size(), Parameters.data(), GL_DYNAMIC_DRAW);
+		GPUMemoryTracker::TrackBuffer(m_ParameterBuffer, Parameters.size(), GPUMemoryCategory::Uniforms, "Material");
+		RenderCounters::CountUpload(Parameters.size());
+		m_bParametersDirty = false;
+	}
+
+	void Material::InvalidateActiveMaterial()
+	{
+		s_ActiveMaterial = nullptr;
+		s_Generation++;
+	}
+
+	void Material::CaptureChanges()
+	{
+		for (Material* Edited : s_CaptureQueue)
+		{
+			// The parameter block is compared as a whole by SetParameters(), an unchanged one isn't uploaded again
+			Edited->m_RenderState = Edited->m_State;
+			Edited->m_bParametersDirty |= Edited->m_bParametersChanged;
+			Edited->m_bParametersChanged = false;
+			Edited->m_bCaptureQueued = false;
+		}
+		s_CaptureQueue.clear();
+	}
+
+	const MaterialRenderState& Material::GetRenderState() const
+	{
+		return m_RenderState;
+	}
+
+	void Material::QueueCapture()
+	{
+		if (m_bCaptureQueued)
+			return;
+
+		m_bCaptureQueued = true;
+		s_CaptureQueue.push_back(this);
+	}
+
+	uint32_t Material::GetID() const
+	{
+		return m_ID;
+	}
+
+	void Material::ShareBatchesWith(const Material& Other)
+	{
+		LOG_ASSERT(Other.m_State.Program == m_State.Program && Other.m_State.BlendMode == m_State.BlendMode, "Materials sharing batches must have the same shader and blend mode")
+		m_BatchID = Other.m_BatchID;
+	}
+
+	uint32_t Material::GetBatchID() const
+	{
+		return m_BatchID;
+	}
+
+	void Material::SetInstanceData(const MaterialInstanceData& Data)
+	{
+		MaterialInstanceBuffer::SetRecord(m_ID, Data);
+	}
+
+	MaterialInstanceData Material::GetInstanceData() const
+	{
+		return MaterialInstanceBuffer::GetRecord(m_ID);
+	}
+
+	void Material::SetBlendMode(MaterialBlendMode Mode)
+	{
+		m_State.BlendMode = Mode;
+		QueueCapture();
+	}
+
+	MaterialBlendMode Material::GetBlendMode() const
+	{
+		return m_State.BlendMode;
+	}
+
+	void Material::SetRasterState(const RasterState& State)
+	{
+		m_State.Raster = State;
+		QueueCapture();
+	}
+
+	const RasterState& Material::GetRasterState() const
+	{
+		return m_State.Raster;
+	}
+
+	uint32_t Material::GetVersion() const
+	{
+		return m_State.Version;
+	}
+
+	void Material::MarkChanged()
+	{
+		m_State.Version++;
+		QueueCapture();
+	}
+
+	void Material::WriteGPUData(MaterialGPUData& Data) const
+	{
+		for (const auto& [TextureName, Texture] : m_RenderState.Textures)
+		{
+			if (!Texture)
+				continue;
+
+			const int Slot = Texture->GetSlotIndex();
+			if (Slot >= 0 && Slot < static_cast<int>(MaterialGPUData::MaxTextures))
+			{
+				Data.Textures[Slot] = Texture->GetBindlessHandle();
+			}
+		}
 	}
 
 	void Material::SetSceneObject(SceneObject* SceneObject)
 	{
 		m_SceneObject = SceneObject;
+		MarkChanged();
 	}
 
 	const Texture* Material::GetTexture(std::string_view TextureName) const
 	{
-		auto it = m_Textures.find(TextureName.data());
-		if (it != m_Textures.end())
+		// A name never interned can't be a texture of any material, it isn't added to the table
+		const Symbol Name = Symbol::Find(TextureName);
+		if (Name.IsEmpty())
+		{
+			LOG_ERROR("Failed to retrieve texture: \"" + std::string(TextureName) + "\". Ensure the texture name is correct and matches the expected value.", true)
+			return nullptr;
+		}
+		return GetTexture(Name);
+	}
+
+	const Texture* Material::GetTexture(Symbol TextureName) const
+	{
+		auto it = m_RenderState.Textures.find(TextureName);
+		if (it != m_RenderState.Textures.end())
 		{
 			return it->second;
 		}
 		else
 		{
-			LOG_ERROR("Failed to retrieve texture: \"" + std::string(TextureName) + "\". Ensure the texture name is correct and matches the expected value.", true)
+			LOG_ERROR("Failed to retrieve texture: \"" + TextureName.GetString() + "\". Ensure the texture name is correct and matches the expected value.", true)
 			return nullptr;
 		}
 	}
 
 	const Shader* Material::GetShader() const
 	{
-		return m_ShaderProgram;
+		return m_State.Program;
+	}
+
+	const FlatHashMap<Symbol, Texture*>& Material::GetTextures() const
+	{
+		return m_State.Textures;
 	}
 
 	void Material::ApplyUniforms()
@@ -68,7 +315,7 @@ namespace fgl
 
 	void Material::ActivateTextures() const
 	{
-		for (const auto& [TextureName, Texture] : m_Textures)
+		for (const auto& [TextureName, Texture] : m_RenderState.Textures)
 		{
 			if (Texture)
 			{
@@ -76,7 +323,7 @@ namespace fgl
 			}
 			else
 			{
-				LOG_INFO("Texture with name '" + TextureName + "' is null or uninitialized. Skipping activation.")
+				LOG_INFO("Texture with name '" + TextureName.GetString() + "' is null or uninitialized. Skipping activation.")
 			}
 		}
 	}
@@ -0,0 +1,70 @@
+#include <FireGL/Renderer/MaterialBuffer.h>
+#include <FireGL/Renderer/Material.h>
+#include <FireGL/Renderer/GLExtensions.h>
+#include <FireGL/Renderer/GLStateCache.h>
+#include <FireGL/Renderer/GPUMemoryTracker.h>
+#include <FireGL/Renderer/RenderStats.h>
+
+namespace fgl
+{
+
+	bool MaterialBuffer::IsSupported()
+	{
+		return GLAD_GL_VERSION_4_3 && GLExtensions::HasBindlessTexture();
+	}
+
+	static_assert(sizeof(MaterialGPUData) == 48, "MaterialGPUData must match the std430 layout of MaterialRecord");
+
+	void MaterialBuffer::Create()
+	{
+		glGenBuffers(1, &m_BufferID);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, BindingPoint, m_BufferID);
+	}
+
+	void MaterialBuffer::Destroy()
+	{
+		if (m_BufferID == 0)
+			return;
+
+		glDeleteBuffers(1, &m_BufferID);
+		GLStateCache::OnBufferDeleted(m_BufferID);
+		GPUMemoryTracker::UntrackBuffer(m_BufferID);
+		m_BufferID = 0;
+		m_Capacity = 0;
+	}
+
+	void MaterialBuffer::Update(const std::vector<Material*>& Materials)
+	{
+		uint32_t MaxID = 0;
+		for (const Material* DrawnMaterial : Materials)
+		{
+			MaxID = std::max(MaxID, DrawnMaterial->GetID());
+		}
+
+		// Record 0 stays empty for objects without material
+		const size_t RecordCount = static_cast<size_t>(MaxID) + 1;
+		if (m_Records.size() < RecordCount)
+		{
+			m_Records.resize(RecordCount);
+		}
+		for (const Material* DrawnMaterial : Materials)
+		{
+			MaterialGPUData& Record = m_Records[DrawnMaterial->GetID()];
+			Record = MaterialGPUData();
+			DrawnMaterial->WriteGPUData(Record);
+		}
+
+		// glBindBufferBase also bound the generic GL_SHADER_STORAGE_BUFFER point
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_BufferID);
+		if (RecordCount > m_Capacity)
+		{
+			m_Capacity = RecordCount * 2;
+			glBufferData(GL_SHADER_STORAGE_BUFFER, m_Capacity * sizeof(MaterialGPUData), nullptr, GL_DYNAMIC_DRAW);
+			GPUMemoryTracker::TrackBuffer(m_BufferID, m_Capacity * sizeof(MaterialGPUData), GPUMemoryCategory::Storage, "MaterialBuffer");
+			glBindBufferBase(GL_SHADER_STORAGE_BUFFER, BindingPoint, m_BufferID);
+		}
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, RecordCount * sizeof(MaterialGPUData), m_Records.data());
+		RenderCounters::CountUpload(RecordCount * sizeof(MaterialGPUData));
+	}
+
+} // namespace fgl
\ No newline at end of file
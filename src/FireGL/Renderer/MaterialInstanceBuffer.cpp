@@ -0,0 +1,87 @@
+#include <FireGL/Renderer/MaterialInstanceBuffer.h>
+#include <FireGL/Renderer/GLStateCache.h>
+#include <FireGL/Renderer/GPUMemoryTracker.h>
+#include <FireGL/Renderer/RenderStats.h>
+
+namespace fgl
+{
+
+	std::mutex MaterialInstanceBuffer::s_Mutex;
+	std::vector<MaterialInstanceData> MaterialInstanceBuffer::s_Records;
+	uint64_t MaterialInstanceBuffer::s_Revision = 1;
+
+	static_assert(sizeof(MaterialInstanceData) == 48, "MaterialInstanceData must match the std430 layout of MaterialInstance");
+
+	bool MaterialInstanceBuffer::IsSupported()
+	{
+		return GLAD_GL_VERSION_4_3;
+	}
+
+	void MaterialInstanceBuffer::SetRecord(uint32_t MaterialID, const MaterialInstanceData& Data)
+	{
+		std::lock_guard<std::mutex> Lock(s_Mutex);
+		if (s_Records.size() <= MaterialID)
+		{
+			s_Records.resize(static_cast<size_t>(MaterialID) + 1);
+		}
+		if (s_Records[MaterialID] != Data)
+		{
+			s_Records[MaterialID] = Data;
+			s_Revision++;
+		}
+	}
+
+	MaterialInstanceData MaterialInstanceBuffer::GetRecord(uint32_t MaterialID)
+	{
+		std::lock_guard<std::mutex> Lock(s_Mutex);
+		return MaterialID < s_Records.size() ? s_Records[MaterialID] : MaterialInstanceData();
+	}
+
+	void MaterialInstanceBuffer::Create()
+	{
+		glGenBuffers(1, &m_BufferID);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, BindingPoint, m_BufferID);
+	}
+
+	void MaterialInstanceBuffer::Destroy()
+	{
+		if (m_BufferID == 0)
+			return;
+
+		glDeleteBuffers(1, &m_BufferID);
+		GLStateCache::OnBufferDeleted(m_BufferID);
+		GPUMemoryTracker::UntrackBuffer(m_BufferID);
+		m_BufferID = 0;
+		m_Capacity = 0;
+		m_UploadedRevision = 0;
+	}
+
+	bool MaterialInstanceBuffer::IsCreated() const
+	{
+		return m_BufferID != 0;
+	}
+
+	void MaterialInstanceBuffer::Update()
+	{
+		// Other passes may use the binding point, it is bound again every frame
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, BindingPoint, m_BufferID);
+
+		std::lock_guard<std::mutex> Lock(s_Mutex);
+		if (m_UploadedRevision == s_Revision || s_Records.empty())
+			return;
+
+		// The table is a few kilobytes at most, it is uploaded whole rather than tracking ranges
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_BufferID);
+		if (s_Records.size() > m_Capacity)
+		{
+			m_Capacity = s_Records.size() * 2;
+			glBufferData(GL_SHADER_STORAGE_BUFFER, m_Capacity * sizeof(MaterialInstanceData), nullptr, GL_DYNAMIC_DRAW);
+			GPUMemoryTracker::TrackBuffer(m_BufferID, m_Capacity * sizeof(MaterialInstanceData), GPUMemoryCategory::Storage, "MaterialInstanceBuffer");
+			glBindBufferBase(GL_SHADER_STORAGE_BUFFER, BindingPoint, m_BufferID);
+		}
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, s_Records.size() * sizeof(MaterialInstanceData), s_Records.data());
+		RenderCounters::CountUpload(s_Records.size() * sizeof(MaterialInstanceData));
+		m_UploadedRevision = s_Revision;
+	}
+
+} // namespace fgl
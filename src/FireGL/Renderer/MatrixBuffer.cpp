@@ -1,4 +1,8 @@
 #include <FireGL/Renderer/MatrixBuffer.h>
+#include <FireGL/Core/BaseLog.h>
+#include <FireGL/Renderer/RenderStats.h>
+
+#include <cstring>
 
 namespace fgl
 {
@@ -11,33 +15,176 @@ namespace fgl
     MatrixBuffer::MatrixBuffer(size_t ObjectCount)
         : m_ObjectCount(ObjectCount * 2) // Allocate space for twice the object count to reduce frequent resizing
     {
-        m_Buffer = std::make_unique<glm::mat4[]>(m_ObjectCount * 2); // Each object may need up to 2 matrices
+        m_Buffer = std::make_unique<InstanceData[]>(m_ObjectCount);
+    }
+
+    MatrixBuffer::~MatrixBuffer()
+    {
+        DestroyGPUBuffer();
+    }
+
+    void MatrixBuffer::CreateGPUBuffer()
+    {
+        // Persistent mapping needs immutable storage (4.4) and a base instance per draw (4.2)
+        m_Mode = RenderDevice::Get().SupportsPersistentBuffers() ? MatrixBufferMode::PersistentRing : MatrixBufferMode::Orphaning;
+
+        m_bGPUBufferCreated = true;
+        if (m_ObjectCount > 0)
+        {
+            AllocateGPUStorage();
+        }
     }
 
-    void MatrixBuffer::Resize(size_t NewObjectCount)
+    void MatrixBuffer::DestroyGPUBuffer()
+    {
+        if (!m_bGPUBufferCreated)
+            return;
+
+        RenderDevice& Device = RenderDevice::Get();
+        for (FenceHandle& Fence : m_RegionFences)
+        {
+            Device.DestroyFence(Fence);
+        }
+        Device.DestroyBuffer(m_GPUBuffer);
+        m_bGPUBufferCreated = false;
+    }
+
+    bool MatrixBuffer::Resize(size_t NewObjectCount)
     {
         // Resize only if the requested size exceeds the current buffer capacity
         if (NewObjectCount <= m_ObjectCount)
-            return;
+            return false;
 
         // Double the buffer size to minimize reallocations during instanced rendering
         m_ObjectCount = NewObjectCount * 2;
-        m_Buffer = std::make_unique<glm::mat4[]>(m_ObjectCount * 2);
+        m_Buffer = std::make_unique<InstanceData[]>(m_ObjectCount);
+
+        if (!m_bGPUBufferCreated)
+            return false;
+
+        // Immutable storage can't be respecified, and neither mode keeps the contents: replace the buffer
+        RenderDevice& Device = RenderDevice::Get();
+        for (FenceHandle& Fence : m_RegionFences)
+        {
+            Device.DestroyFence(Fence);
+        }
+        Device.DestroyBuffer(m_GPUBuffer);
+        AllocateGPUStorage();
+        return true;
+    }
+
+    void MatrixBuffer::AllocateGPUStorage()
+    {
+        const bool bPersistent = m_Mode == MatrixBufferMode::PersistentRing;
+        const size_t Regions = bPersistent ? RegionCount : 1;
+        const BufferDesc Desc = { GetBufferSize() * Regions, bPersistent ? BufferUsage::Persistent : BufferUsage::Dynamic,
+            GPUMemoryCategory::Instances, "MatrixBuffer" };
+        m_GPUBuffer = RenderDevice::Get().CreateBuffer(Desc);
+
+        // Fresh storage holds no data, every region has to receive the full used range once
+        m_PendingFullUploads = Regions;
+    }
+
+    void MatrixBuffer::BeginFrame()
+    {
+        if (m_Mode != MatrixBufferMode::PersistentRing)
+            return;
+
+        // The GPU is usually two frames behind at most, the wait only blocks when it is not
+        m_CurrentRegion = (m_CurrentRegion + 1) % RegionCount;
+        RenderDevice::Get().WaitFence(m_RegionFences[m_CurrentRegion]);
+    }
+
+    void MatrixBuffer::MarkDirty(size_t ObjectIndex)
+    {
+        m_Dirty.Begin = std::min(m_Dirty.Begin, ObjectIndex);
+        m_Dirty.End = std::max(m_Dirty.End, ObjectIndex + 1);
     }
 
-    glm::mat4* MatrixBuffer::Get() const 
-    { 
+    void MatrixBuffer::Upload(size_t UsedObjectCount)
+    {
+        DirtyRange Range = m_Dirty;
+        m_Dirty = DirtyRange();
+
+        if (m_PendingFullUploads > 0)
+        {
+            Range = { 0, UsedObjectCount };
+            m_PendingFullUploads--;
+        }
+        Range.End = std::min(Range.End, UsedObjectCount);
+
+        constexpr size_t ObjectSize = sizeof(InstanceData);
+        if (m_Mode == MatrixBufferMode::PersistentRing)
+        {
+            // The region was last written RegionCount frames ago, it also misses what the other regions received since
+            m_RegionDirty[m_CurrentRegion] = Range;
+            DirtyRange Missing;
+            for (const DirtyRange& RegionRange : m_RegionDirty)
+            {
+                Missing.Begin = std::min(Missing.Begin, RegionRange.Begin);
+                Missing.End = std::max(Missing.End, RegionRange.End);
+            }
+            Missing.End = std::min(Missing.End, UsedObjectCount);
+
+            if (Missing.Begin < Missing.End)
+            {
+                InstanceData* Mapped = static_cast<InstanceData*>(m_GPUBuffer.Mapped);
+                std::memcpy(Mapped + GetRegionBaseInstance() + Missing.Begin, m_Buffer.get() + Missing.Begin,
+                    (Missing.End - Missing.Begin) * ObjectSize);
+                RenderCounters::CountUpload((Missing.End - Missing.Begin) * ObjectSize);
+            }
+            return;
+        }
+
+        if (Range.Begin >= Range.End)
+            return;
+
+        RenderDevice& Device = RenderDevice::Get();
+        if (Range.Begin == 0 && Range.End == UsedObjectCount)
+        {
+            // Orphan the previous storage so the driver doesn't stall on in-flight draws
+            Device.DiscardBuffer(m_GPUBuffer);
+        }
+        Device.UpdateBuffer(m_GPUBuffer, Range.Begin * ObjectSize, (Range.End - Range.Begin) * ObjectSize, m_Buffer.get() + Range.Begin);
+        RenderCounters::CountUpload((Range.End - Range.Begin) * ObjectSize);
+    }
+
+    void MatrixBuffer::EndFrame()
+    {
+        if (m_Mode != MatrixBufferMode::PersistentRing)
+            return;
+
+        m_RegionFences[m_CurrentRegion] = RenderDevice::Get().InsertFence();
+    }
+
+    InstanceData* MatrixBuffer::Get() const
+    {
         return m_Buffer.get();
     }
 
-    size_t MatrixBuffer::GetObjectCount() const 
-    { 
+    size_t MatrixBuffer::GetObjectCount() const
+    {
         return m_ObjectCount;
     }
 
-    size_t MatrixBuffer::GetBufferSize() const 
-    { 
-        return m_ObjectCount * 2 * sizeof(glm::mat4);
+    size_t MatrixBuffer::GetBufferSize() const
+    {
+        return m_ObjectCount * sizeof(InstanceData);
+    }
+
+    size_t MatrixBuffer::GetRegionBaseInstance() const
+    {
+        return m_Mode == MatrixBufferMode::PersistentRing ? m_CurrentRegion * m_ObjectCount : 0;
+    }
+
+    GLuint MatrixBuffer::GetBufferID() const
+    {
+        return m_GPUBuffer.ID;
+    }
+
+    MatrixBufferMode MatrixBuffer::GetMode() const
+    {
+        return m_Mode;
     }
 
 } // namespace fgl
\ No newline at end of file
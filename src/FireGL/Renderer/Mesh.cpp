@@ -1,140 +1,497 @@
 #include <FireGL/Renderer/Mesh.h>
 #include <FireGL/Renderer/Material.h>
+#include <FireGL/Renderer/RenderStats.h>
+#include <FireGL/Core/BaseLog.h>
+
+#include <cstring>
+#include <mutex>
 
 namespace fgl
 {
 
-    BaseMesh::BaseMesh(std::vector<Vertex>&& Vertices, std::vector<unsigned int>&& Indices, std::vector<Texture>&& Textures, bool bComputeHash)
+    CPUGeometryPolicy BaseMesh::s_DefaultCPUGeometryPolicy = CPUGeometryPolicy::Keep;
+    std::atomic<uint32_t> BaseMesh::s_DrawRevision{ 1 };
+
+    namespace
+    {
+        std::mutex s_MeshIDMutex;                           ///< Guards the ID registry, models may be loaded on worker threads.
+        std::unordered_map<uint64_t, uint32_t> s_MeshIDs;   ///< Mesh ID of every content hash seen.
+        uint32_t s_NextMeshID = 1;                          ///< 0 is never handed out.
+
+        constexpr uint64_t HashPrime = 0x9E3779B97F4A7C15ull;
+
+        uint64_t MixWord(uint64_t Word)
+        {
+            Word ^= Word >> 32;
+            Word *= 0xD6E8FEB86659FD93ull;
+            Word ^= Word >> 32;
+            return Word;
+        }
+
+        /** Hashes a byte range with four independent lanes, so the multiplies of consecutive words overlap. */
+        uint64_t HashBytes(const void* Data, size_t Size, uint64_t Seed)
+        {
+            const unsigned char* Bytes = static_cast<const unsigned char*>(Data);
+            uint64_t Lanes[4] = { Seed, Seed ^ HashPrime, Seed + HashPrime, Seed - HashPrime };
+
+            size_t Offset = 0;
+            for (; Offset + sizeof(Lanes) <= Size; Offset += sizeof(Lanes))
+            {
+                uint64_t Words[4];
+                std::memcpy(Words, Bytes + Offset, sizeof(Words));
+                for (size_t Lane = 0; Lane < 4; Lane++)
+                {
+                    Lanes[Lane] = (Lanes[Lane] ^ MixWord(Words[Lane])) * HashPrime;
+                }
+            }
+
+            // Up to three whole words and seven bytes are left, folded into the first lane
+            for (; Offset + sizeof(uint64_t) <= Size; Offset += sizeof(uint64_t))
+            {
+                uint64_t Word;
+                std::memcpy(&Word, Bytes + Offset, sizeof(Word));
+                Lanes[0] = (Lanes[0] ^ MixWord(Word)) * HashPrime;
+            }
+            uint64_t Tail = 0;
+            std::memcpy(&Tail, Bytes + Offset, Size - Offset);
+            uint64_t Hash = MixWord(Lanes[0] ^ Tail) ^ Size;
+            for (size_t Lane = 1; Lane < 4; Lane++)
+            {
+                Hash = (Hash ^ MixWord(Lanes[Lane])) * HashPrime;
+            }
+            return MixWord(Hash);
+        }
+    }
+
+    uint64_t ComputeMeshContentHash(std::span<const Vertex> Vertices, std::span<const unsigned int> Indices)
+    {
+        // Vertex is tightly packed floats, normals and texture coordinates take part like positions do
+        static_assert(sizeof(Vertex) == 8 * sizeof(float), "Vertex must not contain padding to be hashed as bytes");
+        uint64_t Hash = HashBytes(Vertices.data(), Vertices.size_bytes(), HashPrime);
+        Hash = HashBytes(Indices.data(), Indices.size_bytes(), Hash);
+        return Hash != 0 ? Hash : 1;
+    }
+
+    BaseMesh::BaseMesh(std::vector<Vertex>&& Vertices, std::vector<unsigned int>&& Indices, std::vector<Texture>&& Textures, bool bDeduplicate)
 		:
 		m_Vertices( std::move(Vertices) ),
 		m_Indices( std::move(Indices) ),
 		m_Textures( std::move(Textures) )
 	{
-        if (bComputeHash)
+        m_BoundingBox = ComputeBoundingBox(m_Vertices);
+        m_BoundingSphere = ComputeBoundingSphere(m_Vertices, m_BoundingBox);
+
+        SetContentHash(bDeduplicate ? ComputeMeshContentHash(m_Vertices, m_Indices) : 0);
+        UpdateCPUMemory();
+	}
+
+    BaseMesh::BaseMesh(const BaseMesh& Other)
+        : m_Vertices(Other.m_Vertices),
+          m_Indices(Other.m_Indices),
+          m_Skin(Other.m_Skin),
+          m_LightmapCoords(Other.m_LightmapCoords),
+          m_LODs(Other.m_LODs),
+          m_Meshlets(Other.m_Meshlets),
+          m_Material(Other.m_Material),
+          m_ContentHash(Other.m_ContentHash),
+          m_MeshID(Other.m_MeshID),
+          m_BoundingBox(Other.m_BoundingBox),
+          m_BoundingSphere(Other.m_BoundingSphere),
+          m_HasInstanceAttributes(Other.m_HasInstanceAttributes),
+          m_VertexFormat(Other.m_VertexFormat),
+          m_Arena(Other.m_Arena),
+          m_Geometry(Other.m_Geometry),
+          m_CPUGeometryPolicy(Other.m_CPUGeometryPolicy),
+          m_bCPUGeometryReleased(Other.m_bCPUGeometryReleased),
+          m_VertexCount(Other.m_VertexCount),
+          m_IndexCount(Other.m_IndexCount),
+          m_CollisionPositions(Other.m_CollisionPositions)
+    {
+        m_Textures.reserve(Other.m_Textures.size());
+        for (const Texture& MeshTexture : Other.m_Textures)
         {
-            ComputeHash();
+            m_Textures.push_back(MeshTexture.CreateView());
         }
-	}
+        UpdateCPUMemory();
+    }
+
+    BaseMesh& BaseMesh::operator=(const BaseMesh& Other)
+    {
+        return *this = BaseMesh(Other);
+    }
+
+    void BaseMesh::FirstPass(GeometryArena& Arena)
+    {
+        // Meshes of a shared ModelResource are uploaded by the first Model rendered
+        if (m_Arena == &Arena)
+            return;
+
+        LOG_ASSERT(!m_bCPUGeometryReleased, "The CPU geometry of the mesh was released, restore it before uploading the mesh again")
+        m_Arena = &Arena;
+        s_DrawRevision.fetch_add(1, std::memory_order_relaxed);
+        m_VertexCount = static_cast<uint32_t>(m_Vertices.size());
+        m_IndexCount = static_cast<uint32_t>(m_Indices.size());
+        if (m_LODs.empty())
+        {
+            m_Geometry = Arena.Allocate(m_Vertices, m_Indices, m_VertexFormat, m_ContentHash, m_Skin, m_LightmapCoords);
+            ReleaseCPUGeometry();
+            return;
+        }
+
+        // Every level indexes the same vertices, so they share one allocation and its base vertex
+        std::vector<unsigned int> Indices = m_Indices;
+        for (MeshLOD& Level : m_LODs)
+        {
+            Level.IndexOffset = static_cast<uint32_t>(Indices.size());
+            Level.IndexCount = static_cast<uint32_t>(Level.Indices.size());
+            Indices.insert(Indices.end(), Level.Indices.begin(), Level.Indices.end());
+        }
+        m_Geometry = Arena.Allocate(m_Vertices, Indices, m_VertexFormat, m_ContentHash, m_Skin, m_LightmapCoords);
+        ReleaseCPUGeometry();
+    }
+
+    void BaseMesh::SetDefaultCPUGeometryPolicy(CPUGeometryPolicy Policy)
+    {
+        s_DefaultCPUGeometryPolicy = Policy;
+    }
+
+    void BaseMesh::SetCPUGeometryPolicy(CPUGeometryPolicy Policy)
+    {
+        m_CPUGeometryPolicy = Policy;
+    }
 
-    void BaseMesh::FirstPass()
+    bool BaseMesh::HasCPUGeometry() const
     {
-        InitializeBuffers();
-        ConfigureVertexAttributes();
+        return !m_bCPUGeometryReleased;
+    }
+
+    size_t BaseMesh::GetVertexCount() const
+    {
+        return m_bCPUGeometryReleased ? m_VertexCount : m_Vertices.size();
+    }
+
+    size_t BaseMesh::GetIndexCount() const
+    {
+        return m_bCPUGeometryReleased ? m_IndexCount : m_Indices.size();
+    }
+
+    void BaseMesh::ReleaseCPUGeometry()
+    {
+        const CPUGeometryPolicy Policy = m_CPUGeometryPolicy == CPUGeometryPolicy::Default ? s_DefaultCPUGeometryPolicy : m_CPUGeometryPolicy;
+        if (Policy == CPUGeometryPolicy::Default || Policy == CPUGeometryPolicy::Keep)
+            return;
+
+        // Positions are 12 of the 32 bytes of a vertex, the other attributes only matter to the GPU
+        if (Policy == CPUGeometryPolicy::Collision)
+        {
+            m_CollisionPositions.resize(m_Vertices.size());
+            for (size_t Index = 0; Index < m_Vertices.size(); Index++)
+            {
+                m_CollisionPositions[Index] = m_Vertices[Index].Position;
+            }
+        }
+        else
+        {
+            std::vector<unsigned int>().swap(m_Indices);
+        }
+
+        std::vector<Vertex>().swap(m_Vertices);
+        std::vector<VertexSkin>().swap(m_Skin);
+        std::vector<glm::vec2>().swap(m_LightmapCoords);
+        for (MeshLOD& Level : m_LODs)
+        {
+            std::vector<unsigned int>().swap(Level.Indices);
+        }
+        m_bCPUGeometryReleased = true;
+        UpdateCPUMemory();
+    }
+
+    void BaseMesh::RestoreCPUGeometry(std::vector<Vertex>&& Vertices, std::vector<unsigned int>&& Indices, std::vector<std::vector<unsigned int>>&& LODIndices)
+    {
+        if (!m_bCPUGeometryReleased)
+            return;
+
+        LOG_ASSERT(Vertices.size() == m_VertexCount && Indices.size() == m_IndexCount && LODIndices.size() == m_LODs.size(),
+            "The restored geometry doesn't match the mesh")
+        m_Vertices = std::move(Vertices);
+        m_Indices = std::move(Indices);
+        for (size_t Level = 0; Level < m_LODs.size(); Level++)
+        {
+            m_LODs[Level].Indices = std::move(LODIndices[Level]);
+        }
+        std::vector<glm::vec3>().swap(m_CollisionPositions);
+        m_bCPUGeometryReleased = false;
+        UpdateCPUMemory();
+    }
+
+    void BaseMesh::UpdateCPUMemory()
+    {
+        uint64_t Bytes = m_Vertices.capacity() * sizeof(Vertex) + m_Indices.capacity() * sizeof(unsigned int)
+            + m_Skin.capacity() * sizeof(VertexSkin) + m_LightmapCoords.capacity() * sizeof(glm::vec2)
+            + m_LODs.capacity() * sizeof(MeshLOD) + m_Meshlets.capacity() * sizeof(Meshlet)
+            + m_CollisionPositions.capacity() * sizeof(glm::vec3);
+        for (const MeshLOD& Level : m_LODs)
+        {
+            Bytes += Level.Indices.capacity() * sizeof(unsigned int);
+        }
+        m_CPUMemory.Set(Bytes);
+    }
+
+    const std::vector<glm::vec3>& BaseMesh::GetCollisionPositions() const
+    {
+        return m_CollisionPositions;
     }
     
     void BaseMesh::SecondPass()
     {
-        ConfigureVertexAttributesInstances();
+        // The instance attributes live in the VAO shared by every mesh of the same format
+        m_Arena->ConfigureInstanceAttributes(GetAllocation().Format);
+        m_HasInstanceAttributes = true;
     }
 
-	void BaseMesh::InitializeBuffers()
-	{
-        glGenVertexArrays(1, &VAO);
-        glGenBuffers(1, &VBO);
-        glGenBuffers(1, &EBO);
+    void BaseMesh::Render(size_t NumberInstance, size_t BaseInstance, uint32_t LOD) const
+    {
+        if (m_Material)
+        {
+            m_Material->Activate();
+        }
+        Draw(NumberInstance, BaseInstance, LOD);
+    }
+
+    void BaseMesh::Draw(size_t NumberInstance, size_t BaseInstance, uint32_t LOD) const
+    {
+        Draw(GetDrawInfo(LOD), NumberInstance, BaseInstance);
+    }
 
-        glBindVertexArray(VAO);
+    void BaseMesh::Draw(const MeshDrawInfo& Info, size_t NumberInstance, size_t BaseInstance)
+    {
+        IndexedDraw Indexed;
+        Indexed.IndexCount = Info.Command.Count;
+        Indexed.InstanceCount = static_cast<uint32_t>(NumberInstance);
+        Indexed.FirstIndex = Info.Command.FirstIndex;
+        Indexed.BaseVertex = Info.Command.BaseVertex;
+        Indexed.Format = Info.IndexType == GL_UNSIGNED_SHORT ? IndexFormat::UInt16 : IndexFormat::UInt32;
+        if (Info.bInstanceAttributes && SupportsBaseInstance())
+        {
+            // Attributes stay bound at offset 0, the draw call offsets the instance fetch
+            Indexed.BaseInstance = static_cast<uint32_t>(BaseInstance);
+        }
+        else if (Info.bInstanceAttributes)
+        {
+            // Point the attributes at this batch's slice of the arena's instance buffer
+            Info.Arena->BindInstanceBase(Info.Format, BaseInstance);
+        }
 
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferData(GL_ARRAY_BUFFER, m_Vertices.size() * sizeof(Vertex), m_Vertices.data(), GL_STATIC_DRAW);
+        RenderDevice& Device = RenderDevice::Get();
+        Device.BindVertexArray({ Info.VertexArray });
+        Device.DrawIndexed(Indexed);
+        RenderCounters::CountDraw(NumberInstance, NumberInstance * (Info.Command.Count / 3));
+    }
 
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_Indices.size() * sizeof(unsigned int), m_Indices.data(), GL_STATIC_DRAW);
-	}
+    MeshDrawInfo BaseMesh::GetDrawInfo(uint32_t LOD) const
+    {
+        MeshDrawInfo Info;
+        Info.Command = GetDrawCommand(0, 0, LOD);
+        Info.VertexArray = GetAllocation().VertexArray;
+        Info.IndexType = GetAllocation().IndexType;
+        Info.Format = GetAllocation().Format;
+        Info.bInstanceAttributes = m_HasInstanceAttributes;
+        Info.bMeshlets = LOD == 0 && !m_Meshlets.empty();
+        Info.DrawMaterial = m_Material.get();
+        Info.Arena = m_Arena;
+        Info.Mesh = this;
+        return Info;
+    }
 
-    void BaseMesh::ConfigureVertexAttributesInstances()
+    DrawElementsIndirectCommand BaseMesh::GetDrawCommand(size_t NumberInstance, size_t BaseInstance, uint32_t LOD) const
     {
-        glBindVertexArray(VAO);
+        DrawElementsIndirectCommand Command;
+        GetLODRange(LOD, Command.FirstIndex, Command.Count);
+        Command.InstanceCount = static_cast<uint32_t>(NumberInstance);
+        Command.BaseVertex = static_cast<int32_t>(GetAllocation().BaseVertex);
+        Command.BaseInstance = static_cast<uint32_t>(BaseInstance);
+        return Command;
+    }
 
-        std::size_t vec4Size = sizeof(glm::vec4);
+    void BaseMesh::GetLODRange(uint32_t LOD, uint32_t& FirstIndex, uint32_t& IndexCount) const
+    {
+        // Objects select one level for all of their meshes, meshes with fewer levels draw their last one
+        const uint32_t Level = std::min<uint32_t>(LOD, static_cast<uint32_t>(m_LODs.size()));
+        if (Level == 0)
+        {
+            FirstIndex = GetAllocation().FirstIndex;
+            IndexCount = m_IndexCount;
+            return;
+        }
 
-        // Configure the MVP matrix for instancing
-        glEnableVertexAttribArray(3);
-        glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, 8 * vec4Size, (void*)0);
-        glEnableVertexAttribArray(4);
-        glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, 8 * vec4Size, (void*)(1 * vec4Size));
-        glEnableVertexAttribArray(5);
-        glVertexAttribPointer(5, 4, GL_FLOAT, GL_FALSE, 8 * vec4Size, (void*)(2 * vec4Size));
-        glEnableVertexAttribArray(6);
-        glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, 8 * vec4Size, (void*)(3 * vec4Size));
+        const MeshLOD& Detail = m_LODs[Level - 1];
+        FirstIndex = GetAllocation().FirstIndex + Detail.IndexOffset;
+        IndexCount = Detail.IndexCount;
+    }
 
-        // Configure the Model matrix for instancing
-        glEnableVertexAttribArray(7);
-        glVertexAttribPointer(7, 4, GL_FLOAT, GL_FALSE, 8 * vec4Size, (void*)(4 * vec4Size));
-        glEnableVertexAttribArray(8);
-        glVertexAttribPointer(8, 4, GL_FLOAT, GL_FALSE, 8 * vec4Size, (void*)(5 * vec4Size));
-        glEnableVertexAttribArray(9);
-        glVertexAttribPointer(9, 4, GL_FLOAT, GL_FALSE, 8 * vec4Size, (void*)(6 * vec4Size));
-        glEnableVertexAttribArray(10);
-        glVertexAttribPointer(10, 4, GL_FLOAT, GL_FALSE, 8 * vec4Size, (void*)(7 * vec4Size));
+    void BaseMesh::AddLOD(std::vector<unsigned int>&& Indices, float ScreenSize)
+    {
+        MeshLOD& Level = m_LODs.emplace_back();
+        Level.Indices = std::move(Indices);
+        Level.ScreenSize = ScreenSize;
 
-        // Set the divisor to 1 for instancing (this updates per instance)
-        glVertexAttribDivisor(3, 1);
-        glVertexAttribDivisor(4, 1);
-        glVertexAttribDivisor(5, 1);
-        glVertexAttribDivisor(6, 1);
-        glVertexAttribDivisor(7, 1);
-        glVertexAttribDivisor(8, 1);
-        glVertexAttribDivisor(9, 1);
-        glVertexAttribDivisor(10, 1);
+        // Meshes of equal vertices but different levels must not be drawn by one another's batches
+        if (m_ContentHash != 0)
+        {
+            uint64_t Hash = HashBytes(Level.Indices.data(), Level.Indices.size() * sizeof(unsigned int), m_ContentHash);
+            SetContentHash(Hash != 0 ? Hash : 1);
+        }
+        UpdateCPUMemory();
+    }
 
-        glBindVertexArray(0);
+    uint32_t BaseMesh::GetLODCount() const
+    {
+        return static_cast<uint32_t>(m_LODs.size()) + 1;
     }
 
-    void BaseMesh::ConfigureVertexAttributes()
+    const std::vector<MeshLOD>& BaseMesh::GetLODs() const
     {
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+        return m_LODs;
+    }
 
-        glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Normal));
+    void BaseMesh::BuildMeshlets(size_t MaxVertices, size_t MaxTriangles)
+    {
+        m_Meshlets = fgl::BuildMeshlets(m_Vertices, m_Indices, MaxVertices, MaxTriangles);
+        UpdateCPUMemory();
+    }
+
+    const std::vector<Meshlet>& BaseMesh::GetMeshlets() const
+    {
+        return m_Meshlets;
+    }
 
-        glEnableVertexAttribArray(2);
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, TexCoords));
+    DrawElementsIndirectCommand BaseMesh::GetMeshletDrawCommand(uint32_t FirstMeshlet, uint32_t MeshletCount, size_t NumberInstance, size_t BaseInstance) const
+    {
+        const Meshlet& First = m_Meshlets[FirstMeshlet];
+        const Meshlet& Last = m_Meshlets[FirstMeshlet + MeshletCount - 1];
 
-        glBindVertexArray(0);
+        DrawElementsIndirectCommand Command;
+        Command.FirstIndex = GetAllocation().FirstIndex + First.FirstIndex;
+        Command.Count = Last.FirstIndex + Last.TriangleCount * 3 - First.FirstIndex;
+        Command.InstanceCount = static_cast<uint32_t>(NumberInstance);
+        Command.BaseVertex = static_cast<int32_t>(GetAllocation().BaseVertex);
+        Command.BaseInstance = static_cast<uint32_t>(BaseInstance);
+        return Command;
     }
 
-    void BaseMesh::Render(size_t NumberInstance) const
+    GLuint BaseMesh::GetVertexArray() const
     {
-        if (m_Material)
+        return GetAllocation().VertexArray;
+    }
+
+    void BaseMesh::SetVertexFormat(VertexFormat Format)
+    {
+        m_VertexFormat = Format;
+    }
+
+    VertexFormat BaseMesh::GetVertexFormat() const
+    {
+        return m_VertexFormat;
+    }
+
+    void BaseMesh::SetSkin(std::vector<VertexSkin>&& Skin)
+    {
+        m_Skin = std::move(Skin);
+
+        // Equal geometry skinned to other bones must not share the allocation
+        if (m_ContentHash != 0 && !m_Skin.empty())
         {
-            m_Material->Activate();
+            static_assert(sizeof(VertexSkin) == 12, "VertexSkin must not contain padding to be hashed as bytes");
+            uint64_t Hash = HashBytes(m_Skin.data(), m_Skin.size() * sizeof(VertexSkin), m_ContentHash);
+            SetContentHash(Hash != 0 ? Hash : 1);
         }
+        UpdateCPUMemory();
+    }
 
-        glBindVertexArray(VAO);
-        glDrawElementsInstanced(GL_TRIANGLES, m_Indices.size(), GL_UNSIGNED_INT, (GLvoid*)(0), NumberInstance);
-        glBindVertexArray(0);
+    const std::vector<VertexSkin>& BaseMesh::GetSkin() const
+    {
+        return m_Skin;
     }
 
-    void BaseMesh::ComputeHash()
+    void BaseMesh::SetLightmapCoords(std::vector<glm::vec2>&& LightmapCoords)
     {
-        // Compute a hash for the vertices and indices to batch meshes for instancing
-        size_t hash = std::hash<size_t>()(m_Vertices.size());
+        m_LightmapCoords = std::move(LightmapCoords);
 
-        // Hash the size and content of the vertices
-        for (const Vertex& vertex : m_Vertices) {
-            hash ^= std::hash<float>()(vertex.Position.x) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
-            hash ^= std::hash<float>()(vertex.Position.y) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
-            hash ^= std::hash<float>()(vertex.Position.z) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+        // Equal geometry unwrapped differently must not share the allocation
+        if (m_ContentHash != 0 && !m_LightmapCoords.empty())
+        {
+            uint64_t Hash = HashBytes(m_LightmapCoords.data(), m_LightmapCoords.size() * sizeof(glm::vec2), m_ContentHash);
+            SetContentHash(Hash != 0 ? Hash : 1);
         }
+        UpdateCPUMemory();
+    }
+
+    const std::vector<glm::vec2>& BaseMesh::GetLightmapCoords() const
+    {
+        return m_LightmapCoords;
+    }
+
+    GLenum BaseMesh::GetIndexType() const
+    {
+        return GetAllocation().IndexType;
+    }
+
+    bool BaseMesh::SupportsBaseInstance()
+    {
+        return RenderDevice::Get().SupportsBaseInstance();
+    }
+
+    uint32_t BaseMesh::AcquireMeshID(uint64_t ContentHash)
+    {
+        std::lock_guard<std::mutex> Lock(s_MeshIDMutex);
+        if (ContentHash == 0)
+            return s_NextMeshID++;
 
-        // Hash the indices to ensure unique mesh identification
-        for (const uint32_t& index : m_Indices) {
-            hash ^= std::hash<uint32_t>()(index) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+        auto [It, bInserted] = s_MeshIDs.try_emplace(ContentHash, s_NextMeshID);
+        if (bInserted)
+        {
+            s_NextMeshID++;
         }
+        return It->second;
+    }
 
-        m_MeshHash = hash;
+    uint32_t BaseMesh::GetMeshID() const
+    {
+        return m_MeshID;
     }
 
-    size_t BaseMesh::GetMeshHash() const
+    uint64_t BaseMesh::GetContentHash() const
     {
-        return m_MeshHash;
+        return m_ContentHash;
+    }
+
+    void BaseMesh::SetContentHash(uint64_t ContentHash)
+    {
+        m_ContentHash = ContentHash;
+        m_MeshID = AcquireMeshID(ContentHash);
     }
 
     void BaseMesh::SetMaterial(std::shared_ptr<Material> Material)
     {
         m_Material = Material;
+        s_DrawRevision.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint32_t BaseMesh::GetDrawRevision()
+    {
+        return s_DrawRevision.load(std::memory_order_relaxed);
+    }
+
+    void BaseMesh::OnGeometryMoved()
+    {
+        s_DrawRevision.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    const GeometryAllocation& BaseMesh::GetAllocation() const
+    {
+        // Read through the arena on every use, compaction moves the geometry between frames
+        static const GeometryAllocation Empty;
+        return m_Geometry ? m_Arena->GetAllocation(m_Geometry->GetHandle()) : Empty;
     }
 
     const std::shared_ptr<Material> BaseMesh::GetMaterial() const
@@ -142,9 +499,29 @@ namespace fgl
         return m_Material;
     }
 
+    const BoundingBox& BaseMesh::GetBoundingBox() const
+    {
+        return m_BoundingBox;
+    }
+
+    const BoundingSphere& BaseMesh::GetBoundingSphere() const
+    {
+        return m_BoundingSphere;
+    }
+
     std::vector<Texture>& BaseMesh::GetTextures()
     { 
         return m_Textures; 
     }
 
+    const std::vector<Vertex>& BaseMesh::GetVertices() const
+    {
+        return m_Vertices;
+    }
+
+    const std::vector<unsigned int>& BaseMesh::GetIndices() const
+    {
+        return m_Indices;
+    }
+
 } // namespace fgl
\ No newline at end of file
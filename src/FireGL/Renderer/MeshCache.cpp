@@ -0,0 +1,235 @@
+#include <FireGL/Renderer/MeshCache.h>
+#include <FireGL/Renderer/Mesh.h>
+#include <FireGL/Core/MappedFile.h>
+#include <FireGL/Core/AssetArchive.h>
+
+#include <filesystem>
+#include <cstring>
+
+namespace fgl
+{
+
+	namespace
+	{
+		/** Bounds-checked sequential reader over a mapped cache file. */
+		class CacheReader
+		{
+		public:
+			CacheReader(const uint8_t* Data, size_t Size)
+				: m_Data(Data), m_Size(Size)
+			{
+			}
+
+			bool Read(void* Target, size_t Bytes)
+			{
+				if (Bytes > m_Size - m_Offset)
+					return false;
+
+				std::memcpy(Target, m_Data + m_Offset, Bytes);
+				m_Offset += Bytes;
+				return true;
+			}
+
+			bool ReadString(std::string& Target)
+			{
+				uint32_t Length = 0;
+				if (!Read(&Length, sizeof(Length)) || Length > m_Size - m_Offset)
+					return false;
+
+				Target.assign(reinterpret_cast<const char*>(m_Data + m_Offset), Length);
+				m_Offset += Length;
+				return true;
+			}
+
+		private:
+			const uint8_t* m_Data;
+			size_t m_Size;
+			size_t m_Offset = 0;
+		};
+
+		void WriteString(std::ofstream& File, std::string_view String)
+		{
+			const uint32_t Length = static_cast<uint32_t>(String.size());
+			File.write(reinterpret_cast<const char*>(&Length), sizeof(Length));
+			File.write(String.data(), Length);
+		}
+	}
+
+	std::string MeshCache::GetCachePath(std::string_view SourcePath, std::string_view CacheDirectory)
+	{
+		std::filesystem::path Source(SourcePath);
+		std::string FileName = Source.filename().string() + Extension;
+		if (CacheDirectory.empty())
+			return (Source.parent_path() / FileName).string();
+
+		return (std::filesystem::path(CacheDirectory) / FileName).string();
+	}
+
+	bool MeshCache::GetSourceStamp(std::string_view SourcePath, uint64_t& Size, int64_t& Time)
+	{
+		std::error_code Error;
+		const std::filesystem::path Source(SourcePath);
+		Size = std::filesystem::file_size(Source, Error);
+		if (Error)
+			return false;
+
+		Time = static_cast<int64_t>(std::filesystem::last_write_time(Source, Error).time_since_epoch().count());
+		return !Error;
+	}
+
+	bool MeshCache::Load(std::string_view CachePath, std::string_view SourcePath, uint32_t SettingsKey, std::vector<MeshCacheEntry>& Meshes)
+	{
+		uint64_t SourceSize = 0;
+		int64_t SourceTime = 0;
+		const bool bSourceFound = GetSourceStamp(SourcePath, SourceSize, SourceTime);
+
+		// Cooked caches may be packed in a mounted archive, the others are mapped from their file
+		AssetArchive::Blob Packed;
+		MappedFile File;
+		if (!AssetArchive::Read(CachePath, Packed))
+		{
+			if (!File.Open(CachePath))
+				return false;
+
+			Packed.Data = std::span<const uint8_t>(File.GetData(), File.GetSize());
+		}
+
+		CacheReader Reader(Packed.Data.data(), Packed.Data.size());
+		Header FileHeader;
+		if (!Reader.Read(&FileHeader, sizeof(FileHeader)) || FileHeader.Magic != Magic || FileHeader.Version != Version
+			|| FileHeader.SettingsKey != SettingsKey)
+		{
+			return false;
+		}
+
+		// Cooked caches record no stamp and stand in for a source that isn't shipped, a present source must match
+		const bool bCooked = FileHeader.SourceSize == 0 && FileHeader.SourceTime == 0;
+		if (bSourceFound ? (FileHeader.SourceSize != SourceSize || FileHeader.SourceTime != SourceTime) : !bCooked)
+			return false;
+
+		std::vector<MeshHeader> MeshHeaders(FileHeader.MeshCount);
+		std::vector<MeshCacheEntry> Entries(FileHeader.MeshCount);
+		for (uint32_t MeshIndex = 0; MeshIndex < FileHeader.MeshCount; MeshIndex++)
+		{
+			MeshHeader& Mesh = MeshHeaders[MeshIndex];
+			MeshCacheEntry& Entry = Entries[MeshIndex];
+			if (!Reader.Read(&Mesh, sizeof(Mesh)))
+				return false;
+
+			Entry.ContentHash = Mesh.ContentHash;
+			Entry.Textures.resize(Mesh.TextureCount);
+			for (MeshCacheTexture& Texture : Entry.Textures)
+			{
+				if (!Reader.ReadString(Texture.TypeName) || !Reader.ReadString(Texture.Path))
+					return false;
+			}
+
+			Entry.LODIndices.resize(Mesh.LODCount);
+			for (std::vector<unsigned int>& LOD : Entry.LODIndices)
+			{
+				uint32_t IndexCount = 0;
+				if (!Reader.Read(&IndexCount, sizeof(IndexCount)))
+					return false;
+
+				LOD.resize(IndexCount);
+			}
+		}
+
+		// Geometry blobs follow the table, copied straight from the mapping
+		for (uint32_t MeshIndex = 0; MeshIndex < FileHeader.MeshCount; MeshIndex++)
+		{
+			const MeshHeader& Mesh = MeshHeaders[MeshIndex];
+			MeshCacheEntry& Entry = Entries[MeshIndex];
+			Entry.Vertices.resize(Mesh.VertexCount);
+			Entry.Indices.resize(Mesh.IndexCount);
+			if (!Reader.Read(Entry.Vertices.data(), Entry.Vertices.size() * sizeof(Vertex))
+				|| !Reader.Read(Entry.Indices.data(), Entry.Indices.size() * sizeof(unsigned int)))
+			{
+				return false;
+			}
+
+			for (std::vector<unsigned int>& LOD : Entry.LODIndices)
+			{
+				if (!Reader.Read(LOD.data(), LOD.size() * sizeof(unsigned int)))
+					return false;
+			}
+		}
+
+		Meshes = std::move(Entries);
+		return true;
+	}
+
+	bool MeshCache::Save(std::string_view CachePath, std::string_view SourcePath, uint32_t SettingsKey, std::span<BaseMesh> Meshes, bool bCooked)
+	{
+		Header FileHeader;
+		FileHeader.Magic = Magic;
+		FileHeader.Version = Version;
+		FileHeader.SettingsKey = SettingsKey;
+		FileHeader.MeshCount = static_cast<uint32_t>(Meshes.size());
+		FileHeader.SourceSize = 0;
+		FileHeader.SourceTime = 0;
+		if (!bCooked && !GetSourceStamp(SourcePath, FileHeader.SourceSize, FileHeader.SourceTime))
+			return false;
+
+		std::error_code Error;
+		const std::filesystem::path Directory = std::filesystem::path(CachePath).parent_path();
+		if (!Directory.empty())
+		{
+			std::filesystem::create_directories(Directory, Error);
+		}
+
+		// Write to a temporary file first so a crash never leaves a truncated cache behind
+		const std::string TemporaryPath = std::string(CachePath) + ".tmp";
+		{
+			std::ofstream File(TemporaryPath, std::ios::binary | std::ios::trunc);
+			if (!File)
+				return false;
+
+			File.write(reinterpret_cast<const char*>(&FileHeader), sizeof(FileHeader));
+			for (BaseMesh& Mesh : Meshes)
+			{
+				MeshHeader Entry = {};
+				Entry.ContentHash = Mesh.GetContentHash();
+				Entry.VertexCount = static_cast<uint32_t>(Mesh.GetVertices().size());
+				Entry.IndexCount = static_cast<uint32_t>(Mesh.GetIndices().size());
+				Entry.TextureCount = static_cast<uint32_t>(Mesh.GetTextures().size());
+				Entry.LODCount = static_cast<uint32_t>(Mesh.GetLODs().size());
+				File.write(reinterpret_cast<const char*>(&Entry), sizeof(Entry));
+
+				for (const Texture& Texture : Mesh.GetTextures())
+				{
+					WriteString(File, Texture.GetName());
+					WriteString(File, Texture.GetPath());
+				}
+
+				for (const MeshLOD& LOD : Mesh.GetLODs())
+				{
+					const uint32_t IndexCount = static_cast<uint32_t>(LOD.Indices.size());
+					File.write(reinterpret_cast<const char*>(&IndexCount), sizeof(IndexCount));
+				}
+			}
+
+			for (const BaseMesh& Mesh : Meshes)
+			{
+				File.write(reinterpret_cast<const char*>(Mesh.GetVertices().data()), Mesh.GetVertices().size() * sizeof(Vertex));
+				File.write(reinterpret_cast<const char*>(Mesh.GetIndices().data()), Mesh.GetIndices().size() * sizeof(unsigned int));
+				for (const MeshLOD& LOD : Mesh.GetLODs())
+				{
+					File.write(reinterpret_cast<const char*>(LOD.Indices.data()), LOD.Indices.size() * sizeof(unsigned int));
+				}
+			}
+
+			if (!File)
+				return false;
+		}
+
+		std::filesystem::rename(TemporaryPath, std::filesystem::path(CachePath), Error);
+		if (Error)
+		{
+			std::filesystem::remove(TemporaryPath, Error);
+			return false;
+		}
+		return true;
+	}
+
+} // namespace fgl
\ No newline at end of file
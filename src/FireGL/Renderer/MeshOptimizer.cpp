@@ -0,0 +1,548 @@
+#include <FireGL/Renderer/MeshOptimizer.h>
+
+#include <External/glm/common.hpp>
+#include <External/glm/geometric.hpp>
+#include <External/glm/vec3.hpp>
+
+#include <cstring>
+#include <numeric>
+
+namespace fgl
+{
+
+	namespace
+	{
+		constexpr double BorderWeight = 10.0; ///< Weight of the planes holding open borders and seams, relative to the surface planes.
+
+		/** Symmetric 4x4 error quadric: the weighted sum of the squared distances to a set of planes. */
+		struct Quadric
+		{
+			double Terms[10] = {}; ///< Upper triangle of the matrix, row by row.
+
+			void AddPlane(const glm::dvec3& Normal, double Distance, double Weight)
+			{
+				const double Plane[4] = { Normal.x, Normal.y, Normal.z, Distance };
+				size_t Term = 0;
+				for (size_t Row = 0; Row < 4; Row++)
+				{
+					for (size_t Column = Row; Column < 4; Column++)
+					{
+						Terms[Term++] += Weight * Plane[Row] * Plane[Column];
+					}
+				}
+			}
+
+			void Add(const Quadric& Other)
+			{
+				for (size_t Term = 0; Term < 10; Term++)
+				{
+					Terms[Term] += Other.Terms[Term];
+				}
+			}
+
+			/** @return The weighted sum of squared distances from a point to the planes. */
+			double Evaluate(const glm::vec3& Point) const
+			{
+				const double X = Point.x, Y = Point.y, Z = Point.z;
+				const double Error = Terms[0] * X * X + 2.0 * Terms[1] * X * Y + 2.0 * Terms[2] * X * Z + 2.0 * Terms[3] * X
+					+ Terms[4] * Y * Y + 2.0 * Terms[5] * Y * Z + 2.0 * Terms[6] * Y
+					+ Terms[7] * Z * Z + 2.0 * Terms[8] * Z + Terms[9];
+				return std::max(Error, 0.0);
+			}
+		};
+
+		/** A collapse of the welded vertex From onto the welded vertex To. */
+		struct Collapse
+		{
+			double Cost;
+			unsigned int From;
+			unsigned int To;
+		};
+
+		uint64_t MakeEdgeKey(unsigned int A, unsigned int B)
+		{
+			return (static_cast<uint64_t>(std::min(A, B)) << 32) | std::max(A, B);
+		}
+
+		/** @return For every vertex, the first vertex sharing its position. */
+		std::vector<unsigned int> WeldPositions(const std::vector<Vertex>& Vertices)
+		{
+			struct PositionHash
+			{
+				size_t operator()(const glm::vec3& Position) const
+				{
+					uint32_t Bits[3];
+					std::memcpy(Bits, &Position, sizeof(Bits));
+					return (Bits[0] * 73856093u) ^ (Bits[1] * 19349663u) ^ (Bits[2] * 83492791u);
+				}
+			};
+
+			std::unordered_map<glm::vec3, unsigned int, PositionHash> FirstVertex;
+			FirstVertex.reserve(Vertices.size());
+			std::vector<unsigned int> Welded(Vertices.size());
+			for (unsigned int Index = 0; Index < Vertices.size(); Index++)
+			{
+				// Adding zero turns -0 into +0, so both hash the same
+				Welded[Index] = FirstVertex.try_emplace(Vertices[Index].Position + 0.0f, Index).first->second;
+			}
+			return Welded;
+		}
+
+		/** Computes the bounding sphere and normal cone of the triangles of a cluster. */
+		void ComputeMeshletBounds(const std::vector<Vertex>& Vertices, const std::vector<unsigned int>& Indices, Meshlet& Cluster)
+		{
+			const unsigned int* Triangles = Indices.data() + Cluster.FirstIndex;
+			const size_t IndexCount = Cluster.TriangleCount * 3;
+
+			glm::vec3 Min(std::numeric_limits<float>::max());
+			glm::vec3 Max(std::numeric_limits<float>::lowest());
+			for (size_t Index = 0; Index < IndexCount; Index++)
+			{
+				Min = glm::min(Min, Vertices[Triangles[Index]].Position);
+				Max = glm::max(Max, Vertices[Triangles[Index]].Position);
+			}
+			const glm::vec3 Center = (Min + Max) * 0.5f;
+			float RadiusSquared = 0.0f;
+			for (size_t Index = 0; Index < IndexCount; Index++)
+			{
+				const glm::vec3 Offset = Vertices[Triangles[Index]].Position - Center;
+				RadiusSquared = std::max(RadiusSquared, glm::dot(Offset, Offset));
+			}
+			Cluster.Bounds.Center = Center;
+			Cluster.Bounds.Radius = std::sqrt(RadiusSquared);
+
+			// Unit normals, so large triangles don't hide the direction of small ones
+			std::vector<glm::vec3> Normals;
+			Normals.reserve(Cluster.TriangleCount);
+			glm::vec3 NormalSum(0.0f);
+			for (size_t Index = 0; Index < IndexCount; Index += 3)
+			{
+				const glm::vec3& A = Vertices[Triangles[Index]].Position;
+				const glm::vec3 Normal = glm::cross(Vertices[Triangles[Index + 1]].Position - A, Vertices[Triangles[Index + 2]].Position - A);
+				const float Length = glm::length(Normal);
+				Normals.push_back(Length > 0.0f ? Normal / Length : glm::vec3(0.0f));
+				NormalSum += Normals.back();
+			}
+
+			const float SumLength = glm::length(NormalSum);
+			if (SumLength <= 0.0f)
+				return;
+
+			const glm::vec3 Axis = NormalSum / SumLength;
+			float MinDot = 1.0f;
+			for (const glm::vec3& Normal : Normals)
+			{
+				if (Normal != glm::vec3(0.0f))
+				{
+					MinDot = std::min(MinDot, glm::dot(Normal, Axis));
+				}
+			}
+
+			// Close to a half space the cone rejects almost no view point, it is left disabled
+			if (MinDot <= 0.1f)
+				return;
+
+			// The apex slides back along the axis until it lies behind every triangle plane
+			float Offset = 0.0f;
+			for (size_t Triangle = 0; Triangle < Normals.size(); Triangle++)
+			{
+				const glm::vec3& Normal = Normals[Triangle];
+				if (Normal == glm::vec3(0.0f))
+					continue;
+
+				const glm::vec3& Corner = Vertices[Triangles[Triangle * 3]].Position;
+				Offset = std::max(Offset, glm::dot(Center - Corner, Normal) / glm::dot(Axis, Normal));
+			}
+			Cluster.ConeApex = Center - Axis * Offset;
+			Cluster.ConeAxis = Axis;
+			Cluster.ConeCutoff = std::sqrt(1.0f - MinDot * MinDot);
+		}
+	}
+
+	void OptimizeOverdraw(const std::vector<Vertex>& Vertices, std::vector<unsigned int>& Indices, size_t ClusterSize)
+	{
+		const size_t TriangleCount = Indices.size() / 3;
+		if (ClusterSize == 0 || TriangleCount <= ClusterSize)
+			return;
+
+		glm::vec3 MeshCenter(0.0f);
+		for (const Vertex& Vertex : Vertices)
+		{
+			MeshCenter += Vertex.Position;
+		}
+		MeshCenter /= static_cast<float>(std::max<size_t>(Vertices.size(), 1));
+
+		// Score every cluster by how much its area-weighted normal points away from the mesh center
+		struct Cluster
+		{
+			size_t FirstTriangle;
+			size_t TriangleCount;
+			float Score;
+		};
+		std::vector<Cluster> Clusters;
+		for (size_t First = 0; First < TriangleCount; First += ClusterSize)
+		{
+			const size_t Count = std::min(ClusterSize, TriangleCount - First);
+			glm::vec3 Centroid(0.0f);
+			glm::vec3 Normal(0.0f);
+			for (size_t Triangle = First; Triangle < First + Count; Triangle++)
+			{
+				const glm::vec3& A = Vertices[Indices[Triangle * 3 + 0]].Position;
+				const glm::vec3& B = Vertices[Indices[Triangle * 3 + 1]].Position;
+				const glm::vec3& C = Vertices[Indices[Triangle * 3 + 2]].Position;
+				Centroid += (A + B + C) / 3.0f;
+				Normal += glm::cross(B - A, C - A);
+			}
+			Centroid /= static_cast<float>(Count);
+
+			const float Length = glm::length(Normal);
+			const float Score = Length > 0.0f ? glm::dot(Centroid - MeshCenter, Normal / Length) : 0.0f;
+			Clusters.push_back({ First, Count, Score });
+		}
+
+		std::stable_sort(Clusters.begin(), Clusters.end(), [](const Cluster& A, const Cluster& B) {
+			return A.Score > B.Score;
+			});
+
+		std::vector<unsigned int> Sorted;
+		Sorted.reserve(Indices.size());
+		for (const Cluster& Cluster : Clusters)
+		{
+			auto Begin = Indices.begin() + Cluster.FirstTriangle * 3;
+			Sorted.insert(Sorted.end(), Begin, Begin + Cluster.TriangleCount * 3);
+		}
+		// Keep any trailing indices of an incomplete triangle
+		Sorted.insert(Sorted.end(), Indices.begin() + TriangleCount * 3, Indices.end());
+		Indices = std::move(Sorted);
+	}
+
+	void OptimizeVertexFetch(std::vector<Vertex>& Vertices, std::vector<unsigned int>& Indices)
+	{
+		constexpr unsigned int Unassigned = std::numeric_limits<unsigned int>::max();
+		std::vector<unsigned int> Remap(Vertices.size(), Unassigned);
+
+		std::vector<Vertex> Reordered;
+		Reordered.reserve(Vertices.size());
+		for (unsigned int& Index : Indices)
+		{
+			if (Remap[Index] == Unassigned)
+			{
+				Remap[Index] = static_cast<unsigned int>(Reordered.size());
+				Reordered.push_back(Vertices[Index]);
+			}
+			Index = Remap[Index];
+		}
+		Vertices = std::move(Reordered);
+	}
+
+	std::vector<unsigned int> SimplifyMesh(const std::vector<Vertex>& Vertices, const std::vector<unsigned int>& Indices,
+		size_t TargetIndexCount, float MaxError)
+	{
+		std::vector<unsigned int> Result(Indices.begin(), Indices.begin() + Indices.size() / 3 * 3);
+		TargetIndexCount = TargetIndexCount / 3 * 3;
+		if (Result.size() <= TargetIndexCount || Vertices.empty())
+			return Result;
+
+		const size_t VertexCount = Vertices.size();
+		const std::vector<unsigned int> Welded = WeldPositions(Vertices);
+
+		// Vertices sharing a position, grouped by their welded vertex
+		std::vector<unsigned int> GroupStart(VertexCount + 1, 0);
+		std::vector<unsigned int> GroupVertices(VertexCount);
+		for (unsigned int Index = 0; Index < VertexCount; Index++)
+		{
+			GroupStart[Welded[Index] + 1]++;
+		}
+		std::partial_sum(GroupStart.begin(), GroupStart.end(), GroupStart.begin());
+		{
+			std::vector<unsigned int> Cursor(GroupStart.begin(), GroupStart.end() - 1);
+			for (unsigned int Index = 0; Index < VertexCount; Index++)
+			{
+				GroupVertices[Cursor[Welded[Index]]++] = Index;
+			}
+		}
+
+		// The error bound is a squared distance, relative to the radius of the mesh bounds
+		glm::vec3 Min(std::numeric_limits<float>::max());
+		glm::vec3 Max(std::numeric_limits<float>::lowest());
+		for (const Vertex& Vertex : Vertices)
+		{
+			Min = glm::min(Min, Vertex.Position);
+			Max = glm::max(Max, Vertex.Position);
+		}
+		const double ErrorBound = static_cast<double>(MaxError) * 0.5 * glm::length(Max - Min);
+		const double ErrorLimit = ErrorBound * ErrorBound;
+
+		auto GetPosition = [&Vertices](unsigned int Index) { return glm::dvec3(Vertices[Index].Position); };
+
+		// Every triangle adds its plane to its corners, weighted by its area
+		std::vector<Quadric> Quadrics(VertexCount);
+		std::unordered_map<uint64_t, uint32_t> EdgeUses;
+		for (size_t Triangle = 0; Triangle < Result.size() / 3; Triangle++)
+		{
+			const unsigned int* Corners = &Result[Triangle * 3];
+			const glm::dvec3 Cross = glm::cross(GetPosition(Corners[1]) - GetPosition(Corners[0]), GetPosition(Corners[2]) - GetPosition(Corners[0]));
+			const double Length = glm::length(Cross);
+			if (Length > 0.0)
+			{
+				const glm::dvec3 Normal = Cross / Length;
+				const double Distance = -glm::dot(Normal, GetPosition(Corners[0]));
+				for (size_t Corner = 0; Corner < 3; Corner++)
+				{
+					Quadrics[Welded[Corners[Corner]]].AddPlane(Normal, Distance, Length * 0.5);
+				}
+			}
+			for (size_t Corner = 0; Corner < 3; Corner++)
+			{
+				EdgeUses[MakeEdgeKey(Corners[Corner], Corners[(Corner + 1) % 3])]++;
+			}
+		}
+
+		// Edges of a single triangle are open borders or attribute seams: a plane through them, perpendicular
+		// to the triangle, keeps collapses from pulling them off their line
+		for (size_t Triangle = 0; Triangle < Result.size() / 3; Triangle++)
+		{
+			const unsigned int* Corners = &Result[Triangle * 3];
+			const glm::dvec3 Cross = glm::cross(GetPosition(Corners[1]) - GetPosition(Corners[0]), GetPosition(Corners[2]) - GetPosition(Corners[0]));
+			if (glm::length(Cross) == 0.0)
+				continue;
+
+			for (size_t Corner = 0; Corner < 3; Corner++)
+			{
+				const unsigned int A = Corners[Corner];
+				const unsigned int B = Corners[(Corner + 1) % 3];
+				if (EdgeUses[MakeEdgeKey(A, B)] != 1)
+					continue;
+
+				const glm::dvec3 Edge = GetPosition(B) - GetPosition(A);
+				const glm::dvec3 PlaneCross = glm::cross(Edge, Cross);
+				const double PlaneLength = glm::length(PlaneCross);
+				if (PlaneLength == 0.0)
+					continue;
+
+				const glm::dvec3 Normal = PlaneCross / PlaneLength;
+				const double Distance = -glm::dot(Normal, GetPosition(A));
+				const double Weight = glm::dot(Edge, Edge) * BorderWeight;
+				Quadrics[Welded[A]].AddPlane(Normal, Distance, Weight);
+				Quadrics[Welded[B]].AddPlane(Normal, Distance, Weight);
+			}
+		}
+
+		std::vector<unsigned int> AdjacencyStart(VertexCount + 1);
+		std::vector<unsigned int> Adjacency;
+		std::vector<uint64_t> Edges;
+		std::vector<Collapse> Collapses;
+		std::vector<unsigned int> CollapseTarget(VertexCount);
+		std::vector<uint8_t> Locked(VertexCount);
+		std::vector<unsigned int> Replacement(VertexCount);
+
+		// A collapse is rejected if it turns any triangle around From (not removed by it) over
+		auto FlipsTriangle = [&](unsigned int From, unsigned int To)
+		{
+			const glm::vec3& Target = Vertices[To].Position;
+			for (unsigned int Slot = AdjacencyStart[From]; Slot < AdjacencyStart[From + 1]; Slot++)
+			{
+				const unsigned int* Corners = &Result[Adjacency[Slot] * 3];
+				glm::vec3 Positions[3];
+				glm::vec3 Moved[3];
+				bool bRemoved = false;
+				for (size_t Corner = 0; Corner < 3; Corner++)
+				{
+					bRemoved |= Welded[Corners[Corner]] == To;
+					Positions[Corner] = Vertices[Corners[Corner]].Position;
+					Moved[Corner] = Welded[Corners[Corner]] == From ? Target : Positions[Corner];
+				}
+				if (bRemoved)
+					continue;
+
+				const glm::vec3 Before = glm::cross(Positions[1] - Positions[0], Positions[2] - Positions[0]);
+				const glm::vec3 After = glm::cross(Moved[1] - Moved[0], Moved[2] - Moved[0]);
+				if (glm::dot(Before, After) <= 0.0f)
+					return true;
+			}
+			return false;
+		};
+
+		// Among the vertices at the target position, the one whose normal and texture coordinates are the closest
+		auto FindReplacement = [&](unsigned int Index, unsigned int Target)
+		{
+			unsigned int Best = Target;
+			float BestScore = std::numeric_limits<float>::max();
+			for (unsigned int Slot = GroupStart[Target]; Slot < GroupStart[Target + 1]; Slot++)
+			{
+				const Vertex& Candidate = Vertices[GroupVertices[Slot]];
+				const glm::vec3 NormalDelta = Candidate.Normal - Vertices[Index].Normal;
+				const glm::vec2 TexCoordsDelta = Candidate.TexCoords - Vertices[Index].TexCoords;
+				const float Score = glm::dot(NormalDelta, NormalDelta) + glm::dot(TexCoordsDelta, TexCoordsDelta);
+				if (Score < BestScore)
+				{
+					Best = GroupVertices[Slot];
+					BestScore = Score;
+				}
+			}
+			return Best;
+		};
+
+		while (Result.size() > TargetIndexCount)
+		{
+			const size_t TriangleCount = Result.size() / 3;
+
+			// Triangles around every welded vertex
+			std::fill(AdjacencyStart.begin(), AdjacencyStart.end(), 0);
+			for (unsigned int Index : Result)
+			{
+				AdjacencyStart[Welded[Index] + 1]++;
+			}
+			std::partial_sum(AdjacencyStart.begin(), AdjacencyStart.end(), AdjacencyStart.begin());
+			Adjacency.resize(Result.size());
+			{
+				std::vector<unsigned int> Cursor(AdjacencyStart.begin(), AdjacencyStart.end() - 1);
+				for (size_t Slot = 0; Slot < Result.size(); Slot++)
+				{
+					Adjacency[Cursor[Welded[Result[Slot]]]++] = static_cast<unsigned int>(Slot / 3);
+				}
+			}
+
+			// Every welded edge is collapsed in its cheaper direction, cheapest edges first
+			Edges.clear();
+			for (size_t Slot = 0; Slot < Result.size(); Slot++)
+			{
+				const unsigned int A = Welded[Result[Slot]];
+				const unsigned int B = Welded[Result[Slot - Slot % 3 + (Slot + 1) % 3]];
+				if (A != B)
+				{
+					Edges.push_back(MakeEdgeKey(A, B));
+				}
+			}
+			std::sort(Edges.begin(), Edges.end());
+			Edges.erase(std::unique(Edges.begin(), Edges.end()), Edges.end());
+
+			Collapses.clear();
+			for (uint64_t Edge : Edges)
+			{
+				const unsigned int A = static_cast<unsigned int>(Edge >> 32);
+				const unsigned int B = static_cast<unsigned int>(Edge);
+				Quadric Sum = Quadrics[A];
+				Sum.Add(Quadrics[B]);
+				const double CostOntoB = Sum.Evaluate(Vertices[B].Position);
+				const double CostOntoA = Sum.Evaluate(Vertices[A].Position);
+				Collapses.push_back(CostOntoB <= CostOntoA ? Collapse{ CostOntoB, A, B } : Collapse{ CostOntoA, B, A });
+			}
+			std::sort(Collapses.begin(), Collapses.end(), [](const Collapse& Left, const Collapse& Right) {
+				return Left.Cost < Right.Cost;
+				});
+
+			// The triangles around a collapsed vertex are locked for the rest of the pass,
+			// so the flip test of every collapse stays valid once all of them are applied
+			std::iota(CollapseTarget.begin(), CollapseTarget.end(), 0u);
+			std::fill(Locked.begin(), Locked.end(), 0);
+			const size_t TrianglesToRemove = TriangleCount - TargetIndexCount / 3;
+			size_t RemovedTriangles = 0;
+			bool bCollapsed = false;
+			for (const Collapse& Candidate : Collapses)
+			{
+				if (Candidate.Cost > ErrorLimit || RemovedTriangles >= TrianglesToRemove)
+					break;
+
+				if (Locked[Candidate.From] || Locked[Candidate.To] || FlipsTriangle(Candidate.From, Candidate.To))
+					continue;
+
+				CollapseTarget[Candidate.From] = Candidate.To;
+				Quadrics[Candidate.To].Add(Quadrics[Candidate.From]);
+				for (unsigned int Slot = AdjacencyStart[Candidate.From]; Slot < AdjacencyStart[Candidate.From + 1]; Slot++)
+				{
+					const unsigned int* Corners = &Result[Adjacency[Slot] * 3];
+					bool bRemoved = false;
+					for (size_t Corner = 0; Corner < 3; Corner++)
+					{
+						Locked[Welded[Corners[Corner]]] = 1;
+						bRemoved |= Welded[Corners[Corner]] == Candidate.To;
+					}
+					RemovedTriangles += bRemoved ? 1 : 0;
+				}
+				bCollapsed = true;
+			}
+
+			// The error bound or the flip test stopped every collapse
+			if (!bCollapsed)
+				break;
+
+			// Collapsed vertices are replaced by a vertex at the target, triangles left without area are dropped
+			std::fill(Replacement.begin(), Replacement.end(), std::numeric_limits<unsigned int>::max());
+			size_t Write = 0;
+			for (size_t Triangle = 0; Triangle < TriangleCount; Triangle++)
+			{
+				unsigned int Corners[3];
+				for (size_t Corner = 0; Corner < 3; Corner++)
+				{
+					unsigned int Index = Result[Triangle * 3 + Corner];
+					const unsigned int Target = CollapseTarget[Welded[Index]];
+					if (Target != Welded[Index])
+					{
+						if (Replacement[Index] == std::numeric_limits<unsigned int>::max())
+						{
+							Replacement[Index] = FindReplacement(Index, Target);
+						}
+						Index = Replacement[Index];
+					}
+					Corners[Corner] = Index;
+				}
+
+				if (Welded[Corners[0]] == Welded[Corners[1]] || Welded[Corners[1]] == Welded[Corners[2]] || Welded[Corners[2]] == Welded[Corners[0]])
+					continue;
+
+				Result[Write++] = Corners[0];
+				Result[Write++] = Corners[1];
+				Result[Write++] = Corners[2];
+			}
+			Result.resize(Write);
+		}
+		return Result;
+	}
+
+	std::vector<Meshlet> BuildMeshlets(const std::vector<Vertex>& Vertices, const std::vector<unsigned int>& Indices,
+		size_t MaxVertices, size_t MaxTriangles)
+	{
+		std::vector<Meshlet> Meshlets;
+
+		// Vertices seen by the current cluster are stamped with its index, nothing is cleared between clusters
+		std::vector<uint32_t> VertexStamp(Vertices.size(), std::numeric_limits<uint32_t>::max());
+		Meshlet Current;
+		for (size_t Index = 0; Index + 2 < Indices.size(); Index += 3)
+		{
+			const unsigned int* Corners = Indices.data() + Index;
+			const size_t DistinctCorners = 3 - (Corners[1] == Corners[0] ? 1 : 0) - (Corners[2] == Corners[0] || Corners[2] == Corners[1] ? 1 : 0);
+			size_t NewVertices = DistinctCorners;
+			for (size_t Corner = 0; Corner < 3; Corner++)
+			{
+				const bool bRepeated = (Corner > 0 && Corners[0] == Corners[Corner]) || (Corner > 1 && Corners[1] == Corners[Corner]);
+				NewVertices -= VertexStamp[Corners[Corner]] == Meshlets.size() && !bRepeated ? 1 : 0;
+			}
+
+			if (Current.TriangleCount > 0 && (Current.TriangleCount == MaxTriangles || Current.VertexCount + NewVertices > MaxVertices))
+			{
+				ComputeMeshletBounds(Vertices, Indices, Current);
+				Meshlets.push_back(Current);
+				Current = Meshlet();
+				Current.FirstIndex = static_cast<uint32_t>(Index);
+				NewVertices = DistinctCorners;
+			}
+
+			const uint32_t Stamp = static_cast<uint32_t>(Meshlets.size());
+			for (size_t Corner = 0; Corner < 3; Corner++)
+			{
+				VertexStamp[Corners[Corner]] = Stamp;
+			}
+			Current.VertexCount += static_cast<uint32_t>(NewVertices);
+			Current.TriangleCount++;
+		}
+
+		if (Current.TriangleCount > 0)
+		{
+			ComputeMeshletBounds(Vertices, Indices, Current);
+			Meshlets.push_back(Current);
+		}
+		return Meshlets;
+	}
+
+} // namespace fgl
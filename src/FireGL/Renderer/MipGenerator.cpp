@@ -0,0 +1,149 @@
+#include <FireGL/Renderer/MipGenerator.h>
+#include <FireGL/Renderer/GLStateCache.h>
+#include <FireGL/Renderer/Material.h>
+
+namespace fgl
+{
+
+	std::unordered_map<uint64_t, std::unique_ptr<Shader>> MipGenerator::s_Programs;
+
+	namespace
+	{
+		constexpr GLuint WorkgroupSize = 8;
+
+		// Prefixed with the FORMAT and, for arrays, ARRAY definitions
+		constexpr std::string_view DownsampleCode = R"(
+layout (local_size_x = 8, local_size_y = 8) in;
+
+#ifdef ARRAY
+layout (FORMAT, binding = 0) readonly uniform image2DArray Source;
+layout (FORMAT, binding = 1) writeonly uniform image2DArray Destination;
+#define LOAD(Texel) imageLoad(Source, ivec3(Texel, gl_GlobalInvocationID.z))
+#define STORE(Texel, Value) imageStore(Destination, ivec3(Texel, gl_GlobalInvocationID.z), Value)
+#else
+layout (FORMAT, binding = 0) readonly uniform image2D Source;
+layout (FORMAT, binding = 1) writeonly uniform image2D Destination;
+#define LOAD(Texel) imageLoad(Source, Texel)
+#define STORE(Texel, Value) imageStore(Destination, Texel, Value)
+#endif
+
+void main()
+{
+    ivec2 Texel = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 DestinationSize = imageSize(Destination).xy;
+    if (any(greaterThanEqual(Texel, DestinationSize)))
+        return;
+
+    // Odd sizes fold their last row and column into the last texel, as the Hi-Z reduction does
+    ivec2 SourceSize = imageSize(Source).xy;
+    ivec2 First = Texel * 2;
+    ivec2 Last = min(First + 1 + ivec2(equal(Texel, DestinationSize - 1)) * (SourceSize & 1), SourceSize - 1);
+
+    vec4 Sum = vec4(0.0);
+    for (int Y = First.y; Y <= Last.y; Y++)
+    {
+        for (int X = First.x; X <= Last.x; X++)
+        {
+            Sum += LOAD(ivec2(X, Y));
+        }
+    }
+    ivec2 Count = Last - First + 1;
+    STORE(Texel, Sum / float(Count.x * Count.y));
+})";
+
+		GLuint GetGroupCount(GLint Size)
+		{
+			return (static_cast<GLuint>(Size) + WorkgroupSize - 1) / WorkgroupSize;
+		}
+	}
+
+	bool MipGenerator::IsSupported()
+	{
+		return GLAD_GL_VERSION_4_3;
+	}
+
+	void MipGenerator::Generate(GLuint Texture, GLenum Target)
+	{
+		GLStateCache::BindTexture(Target, Texture);
+		if (!IsSupported() || (Target != GL_TEXTURE_2D && Target != GL_TEXTURE_2D_ARRAY))
+		{
+			glGenerateMipmap(Target);
+			return;
+		}
+
+		// Only immutable textures are sure to have every level allocated
+		GLint bImmutable = GL_FALSE, LevelCount = 0, InternalFormat = 0;
+		glGetTexParameteriv(Target, GL_TEXTURE_IMMUTABLE_FORMAT, &bImmutable);
+		glGetTexParameteriv(Target, GL_TEXTURE_IMMUTABLE_LEVELS, &LevelCount);
+		glGetTexLevelParameteriv(Target, 0, GL_TEXTURE_INTERNAL_FORMAT, &InternalFormat);
+		if (!bImmutable || !GetImageFormat(InternalFormat))
+		{
+			glGenerateMipmap(Target);
+			return;
+		}
+
+		GLint Width = 0, Height = 0, LayerCount = 1;
+		glGetTexLevelParameteriv(Target, 0, GL_TEXTURE_WIDTH, &Width);
+		glGetTexLevelParameteriv(Target, 0, GL_TEXTURE_HEIGHT, &Height);
+		const bool bArray = Target == GL_TEXTURE_2D_ARRAY;
+		if (bArray)
+		{
+			glGetTexLevelParameteriv(Target, 0, GL_TEXTURE_DEPTH, &LayerCount);
+		}
+
+		GetProgram(InternalFormat, bArray).Activate();
+		for (GLint Level = 1; Level < LevelCount; Level++)
+		{
+			Width = std::max(Width / 2, 1);
+			Height = std::max(Height / 2, 1);
+			glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+			glBindImageTexture(0, Texture, Level - 1, bArray ? GL_TRUE : GL_FALSE, 0, GL_READ_ONLY, InternalFormat);
+			glBindImageTexture(1, Texture, Level, bArray ? GL_TRUE : GL_FALSE, 0, GL_WRITE_ONLY, InternalFormat);
+			glDispatchCompute(GetGroupCount(Width), GetGroupCount(Height), static_cast<GLuint>(LayerCount));
+		}
+
+		// Sampled next, or read back for uploads to other textures
+		glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT);
+		Material::InvalidateActiveMaterial();
+	}
+
+	void MipGenerator::Destroy()
+	{
+		for (auto& [Key, Program] : s_Programs)
+		{
+			Program->Cleanup();
+		}
+		s_Programs.clear();
+	}
+
+	const char* MipGenerator::GetImageFormat(GLenum InternalFormat)
+	{
+		switch (InternalFormat)
+		{
+		case GL_RGBA8: return "rgba8";
+		case GL_RG8: return "rg8";
+		case GL_R8: return "r8";
+		case GL_RGBA16F: return "rgba16f";
+		case GL_RG16F: return "rg16f";
+		case GL_R16F: return "r16f";
+		case GL_RGBA32F: return "rgba32f";
+		case GL_RG32F: return "rg32f";
+		case GL_R32F: return "r32f";
+		default: return nullptr;
+		}
+	}
+
+	Shader& MipGenerator::GetProgram(GLenum InternalFormat, bool bArray)
+	{
+		const uint64_t Key = (static_cast<uint64_t>(InternalFormat) << 1) | (bArray ? 1 : 0);
+		std::unique_ptr<Shader>& Program = s_Programs[Key];
+		if (!Program)
+		{
+			const std::string Code = std::string("#version 430 core\n#define FORMAT ") + GetImageFormat(InternalFormat) + "\n"
+				+ (bArray ? "#define ARRAY\n" : "") + std::string(DownsampleCode);
+			Program = Shader::CreateComputeFromSource(Code);
+		}
+		return *Program;
+	}
+
+} // namespace fgl
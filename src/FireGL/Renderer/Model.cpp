@@ -1,38 +1,310 @@
 #include <FireGL/Renderer/Model.h>
+#include <FireGL/Core/AssetArchive.h>
+#include <FireGL/Core/AssetManifest.h>
 #include <FireGL/Core/BaseLog.h>
+#include <FireGL/Core/JobSystem.h>
+#include <FireGL/Core/MappedFile.h>
+#include <FireGL/Core/Profiler.h>
+#include <FireGL/Core/StartupTimeline.h>
+#include <FireGL/Core/SystemManager.h>
+#include <FireGL/Core/Window.h>
+#include <FireGL/Renderer/AssetPrefetcher.h>
+#include <FireGL/Renderer/GLStateCache.h>
 #include <FireGL/Renderer/Material.h>
 #include <FireGL/Renderer/Transform.h>
 #include <FireGL/Renderer/Mesh.h>
+#include <FireGL/Renderer/MeshOptimizer.h>
+#include <FireGL/Renderer/TextureCache.h>
 
 #include <External/stb/stb_image.h>
+#include <External/assimp/DefaultIOSystem.h>
+#include <External/assimp/MemoryIOWrapper.h>
 
+#include <bit>
+#include <cstring>
 #include <filesystem>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <tuple>
 
 namespace fgl
 {
 
-	Model::Model(std::string_view Path)
-		: SceneObject()
+	namespace
 	{
-		LoadModel(Path);
+		std::mutex s_ResourceMutex;                                                 ///< Guards s_SharedResources, models may be created on worker threads.
+		std::unordered_map<std::string, std::weak_ptr<ModelResource>> s_SharedResources; ///< Live resources by Model::GetResourceKey().
+
+		/** An Assimp stream over an archived file, keeping its decompressed storage alive. */
+		class ArchiveIOStream : public Assimp::MemoryIOStream
+		{
+		public:
+			explicit ArchiveIOStream(AssetArchive::Blob Contents)
+				: Assimp::MemoryIOStream(Contents.Data.data(), Contents.Data.size(), false)
+				, m_Contents(std::move(Contents))
+			{
+			}
+
+		private:
+			AssetArchive::Blob m_Contents; ///< Owns the bytes read when they were decompressed.
+		};
+
+		/** An Assimp stream reading a file in place from its memory mapping. */
+		class MappedIOStream : public Assimp::MemoryIOStream
+		{
+		public:
+			explicit MappedIOStream(std::unique_ptr<MappedFile> File)
+				: Assimp::MemoryIOStream(File->GetData(), File->GetSize(), false)
+				, m_File(std::move(File))
+			{
+			}
+
+		private:
+			std::unique_ptr<MappedFile> m_File; ///< Keeps the bytes read mapped.
+		};
+
+		/**
+		 * Serves Assimp the files held by mounted asset archives, e.g. a model's .bin or .mtl, and maps the
+		 * others from disk, so the parsers read them in place instead of through buffered reads.
+		 */
+		class ModelIOSystem : public Assimp::DefaultIOSystem
+		{
+		public:
+			bool Exists(const char* File) const override
+			{
+				return (AssetArchive::IsMounted() && AssetArchive::Contains(File)) || Assimp::DefaultIOSystem::Exists(File);
+			}
+
+			Assimp::IOStream* Open(const char* File, const char* Mode) override
+			{
+				AssetArchive::Blob Packed;
+				if (AssetArchive::IsMounted() && AssetArchive::Read(File, Packed))
+					return new ArchiveIOStream(std::move(Packed));
+
+				// Writes and empty files, which can't be mapped, go through the default buffered streams
+				if (std::strchr(Mode, 'w') == nullptr && std::strchr(Mode, 'a') == nullptr && std::strchr(Mode, '+') == nullptr)
+				{
+					std::unique_ptr<MappedFile> Mapped = std::make_unique<MappedFile>();
+					if (Mapped->Open(File))
+						return new MappedIOStream(std::move(Mapped));
+				}
+				return Assimp::DefaultIOSystem::Open(File, Mode);
+			}
+		};
+
+		/** @return True if the model path names a cooked mesh cache (see AssetCooker) rather than a source asset. */
+		bool IsCookedPath(std::string_view Path)
+		{
+			return Path.ends_with(MeshCache::Extension);
+		}
+
+		/** @return The mesh cache of a model path: the path itself when cooked, else the one of MeshCache::GetCachePath(). */
+		std::string GetModelCachePath(std::string_view Path, const ModelImportSettings& Settings)
+		{
+			return IsCookedPath(Path) ? std::string(Path) : MeshCache::GetCachePath(Path, Settings.CacheDirectory);
+		}
+
+		/** @return The source asset of a model path, which a cooked cache names without its extension. */
+		std::string_view GetModelSourcePath(std::string_view Path)
+		{
+			return IsCookedPath(Path) ? Path.substr(0, Path.size() - std::string_view(MeshCache::Extension).size()) : Path;
+		}
+	}
+
+	ModelResource::~ModelResource()
+	{
+		// Mesh textures are views of the cached ones, each texture holds a single cache reference.
+		// Uploads still in flight were never registered, their Textures delete them when destroyed
+		for (const auto& [Key, Texture] : CachedTextures)
+		{
+			if (Texture.GetID() != 0)
+			{
+				TextureCache::Release(Key);
+			}
+		}
+		DrawCommands.Destroy();
+	}
+
+	uint32_t ModelImportSettings::GetGeometryKey() const
+	{
+		// The vertex format is applied at upload time, it doesn't change the cached geometry
+		uint32_t Key = (bOptimizeVertexCache ? 1u : 0u) | (bOptimizeOverdraw ? 2u : 0u) | (bOptimizeVertexFetch ? 4u : 0u);
+
+		// Simplified levels are cached with the meshes, the screen sizes are only applied when loading
+		if (LODCount > 1)
+		{
+			uint32_t LODKey = LODCount;
+			LODKey = LODKey * 31 + std::bit_cast<uint32_t>(LODTriangleRatio);
+			LODKey = LODKey * 31 + std::bit_cast<uint32_t>(LODMaxError);
+			Key |= LODKey << 3;
+		}
+		return Key;
+	}
+
+	float ModelImportSettings::GetLODScreenSize(uint32_t Level) const
+	{
+		// The triangle count follows the projected area, so the size shrinks with the square root of the ratio
+		return LODScreenSize * std::pow(std::sqrt(LODTriangleRatio), static_cast<float>(Level - 1));
+	}
+
+	Model::Model(std::string_view Path, const ModelImportSettings& Settings)
+		: SceneObject(), m_Settings(Settings)
+	{
+		const std::string ResourceKey = m_Settings.bShareResources ? GetResourceKey(Path) : std::string();
+		if (m_Settings.bShareResources)
+		{
+			m_Resource = FindSharedResource(ResourceKey);
+		}
+
+		const uint64_t Start = Profiler::Now();
+		const bool bLoaded = !m_Resource;
+		uint64_t Decoded = Start;
+		uint64_t BytesRead = 0;
+		if (bLoaded)
+		{
+			m_Resource = std::make_shared<ModelResource>();
+			LoadModel(Path);
+			if (m_Settings.bShareResources)
+			{
+				RegisterSharedResource(ResourceKey);
+			}
+			Decoded = Profiler::Now();
+
+			if (StartupTimeline::IsRecording())
+			{
+				BytesRead = StartupTimeline::FileSize(Path);
+				for (const ModelResource::PendingTexture& Pending : m_Resource->PendingTextures)
+				{
+					BytesRead += StartupTimeline::FileSize(Pending.FilePath);
+				}
+			}
+		}
+
+		// A shared resource may still wait for the uploads of the Model that loaded it
+		const uint64_t Uploading = Profiler::Now();
+		if (!m_Settings.bDeferTextureUploads)
+		{
+			while (HasPendingTextureUploads())
+			{
+				if (!UploadPendingTexture())
+				{
+					FinishUploadedTextures(true);
+				}
+			}
+		}
+
+		// The file sizes were read between decoding and uploading, they aren't part of either
+		if (bLoaded)
+		{
+			StartupTimeline::Record("Model", Path, BytesRead, Start, Decoded, Decoded + (Profiler::Now() - Uploading));
+		}
 	}
 
-	std::vector<BaseMesh>& Model::GetMeshes()
+	std::span<BaseMesh> Model::GetMeshes()
 	{
-		return m_Meshes;
+		return m_Resource->Meshes;
+	}
+
+	std::span<const BaseMesh> Model::GetMeshes() const
+	{
+		return m_Resource->Meshes;
 	}
 
 	size_t Model::GetHash() const
 	{
-		return m_Meshes[0].GetMeshHash();
+		return m_Resource->MeshSetID;
+	}
+
+	void Model::Render(size_t NumberInstance, size_t BaseInstance, uint32_t LOD) const
+	{
+		std::span<const BaseMesh> Meshes = m_Resource->Meshes;
+		if (Meshes.size() < 2 || !IndirectDrawBuffer::IsSupported() || !UpdateDrawGroups())
+		{
+			for (unsigned int i = 0; i < Meshes.size(); i++)
+			{
+				Meshes[i].Render(NumberInstance, BaseInstance, LOD);
+			}
+			return;
+		}
+
+		// Models of one resource drawn with the same instances, e.g. every frame, reuse the uploaded commands
+		ModelResource& Resource = *m_Resource;
+		if (Resource.DrawCommands.GetCommandCount() == 0 || Resource.CommandInstanceCount != NumberInstance
+			|| Resource.CommandBaseInstance != BaseInstance || Resource.CommandLOD != LOD)
+		{
+			if (Resource.DrawCommands.GetBufferID() == 0)
+			{
+				Resource.DrawCommands.Create();
+			}
+			Resource.DrawCommands.Clear();
+			for (uint32_t MeshIndex : Resource.DrawOrder)
+			{
+				Resource.DrawCommands.Push(Meshes[MeshIndex].GetDrawCommand(NumberInstance, BaseInstance, LOD));
+			}
+			Resource.DrawCommands.Upload();
+			Resource.CommandInstanceCount = NumberInstance;
+			Resource.CommandBaseInstance = BaseInstance;
+			Resource.CommandLOD = LOD;
+		}
+		else
+		{
+			Resource.DrawCommands.Bind();
+		}
+
+		for (const ModelResource::DrawGroup& Group : Resource.DrawGroups)
+		{
+			if (Group.GroupMaterial)
+			{
+				Group.GroupMaterial->Activate();
+			}
+			GLStateCache::BindVertexArray(Group.VertexArray);
+			Resource.DrawCommands.Draw(Group.FirstCommand, Group.CommandCount, Group.IndexType);
+		}
 	}
 
-	void Model::Render(size_t NumberInstance) const
+	bool Model::UpdateDrawGroups() const
 	{
-		for (unsigned int i = 0; i < m_Meshes.size(); i++)
+		ModelResource& Resource = *m_Resource;
+		const uint32_t Revision = BaseMesh::GetDrawRevision();
+		if (Resource.DrawRevision == Revision)
+			return true;
+
+		std::span<const BaseMesh> Meshes = Resource.Meshes;
+		for (const BaseMesh& Mesh : Meshes)
 		{
-			m_Meshes[i].Render(NumberInstance);
+			if (Mesh.GetVertexArray() == 0)
+				return false;
 		}
+
+		// Stable, so the meshes of a group keep the model's order
+		const auto GroupKey = [&Meshes](uint32_t MeshIndex)
+		{
+			const BaseMesh& Mesh = Meshes[MeshIndex];
+			return std::make_tuple(reinterpret_cast<uintptr_t>(Mesh.GetMaterial().get()), Mesh.GetVertexArray(), Mesh.GetIndexType());
+		};
+		Resource.DrawOrder.resize(Meshes.size());
+		std::iota(Resource.DrawOrder.begin(), Resource.DrawOrder.end(), 0u);
+		std::stable_sort(Resource.DrawOrder.begin(), Resource.DrawOrder.end(),
+			[&GroupKey](uint32_t A, uint32_t B) { return GroupKey(A) < GroupKey(B); });
+
+		Resource.DrawGroups.clear();
+		for (uint32_t Index = 0; Index < Resource.DrawOrder.size(); Index++)
+		{
+			const BaseMesh& Mesh = Meshes[Resource.DrawOrder[Index]];
+			if (Index == 0 || GroupKey(Resource.DrawOrder[Index]) != GroupKey(Resource.DrawOrder[Index - 1]))
+			{
+				Resource.DrawGroups.push_back({ Mesh.GetMaterial().get(), Mesh.GetVertexArray(), Mesh.GetIndexType(), Index, 0 });
+			}
+			Resource.DrawGroups.back().CommandCount++;
+		}
+
+		// The uploaded commands follow the previous order
+		Resource.DrawCommands.Clear();
+		Resource.DrawRevision = Revision;
+		return true;
 	}
 
 	void Model::BeginPlay()
@@ -43,11 +315,20 @@ namespace fgl
 	{
 	}
 
+	bool Model::IsTickThreadSafe() const
+	{
+		return true;
+	}
+
+	bool Model::WantsTick() const
+	{
+		return false;
+	}
+
 	void Model::Destroy()
 	{
-		CleanupTextures();
-		m_Meshes.clear();
-		m_CachedTextures.clear();
+		// The textures are freed with the last Model holding the resource
+		m_Resource.reset();
 	}
 
 	std::string Model::GetTextureNumber(std::string_view Name, unsigned int& DiffuseNr, unsigned int& SpecularNr)
@@ -67,101 +348,434 @@ namespace fgl
 			return;
 		}
 
-		for (BaseMesh& Mesh : m_Meshes)
+		for (BaseMesh& Mesh : m_Resource->Meshes)
 		{
 			Mesh.SetMaterial(Material);
 		}
 
 		Material->SetSceneObject(this);
+		NotifyMaterialChanged();
 	}
 
 	const std::shared_ptr<Material> Model::GetMaterial(size_t MeshIndex) const
 	{
-		if (m_Meshes.empty() || MeshIndex >= m_Meshes.size())
+		if (m_Resource->Meshes.empty() || MeshIndex >= m_Resource->Meshes.size())
 		{
 			LOG_INFO("No mesh data was found in the model when attempting to retrieve its material. \
 				Ensure that the model has at least one mesh before calling GetMaterial().")
 			return nullptr;
 		}
 
-		return m_Meshes[MeshIndex].GetMaterial();
+		return m_Resource->Meshes[MeshIndex].GetMaterial();
+	}
+
+	std::shared_ptr<ModelResource> Model::FindSharedResource(const std::string& Key) const
+	{
+		std::lock_guard<std::mutex> Lock(s_ResourceMutex);
+		auto It = s_SharedResources.find(Key);
+		return It != s_SharedResources.end() ? It->second.lock() : nullptr;
+	}
+
+	void Model::RegisterSharedResource(const std::string& Key) const
+	{
+		// Models of the same file loaded concurrently each import it, the first one registered is kept
+		std::lock_guard<std::mutex> Lock(s_ResourceMutex);
+		std::erase_if(s_SharedResources, [](const auto& Entry) { return Entry.second.expired(); });
+		s_SharedResources.try_emplace(Key, m_Resource);
+	}
+
+	std::string Model::GetResourceKey(std::string_view Path) const
+	{
+		std::error_code Error;
+		std::filesystem::path Canonical = std::filesystem::weakly_canonical(std::filesystem::path(Path), Error);
+		if (Error)
+		{
+			Canonical = std::filesystem::path(Path).lexically_normal();
+		}
+		return Canonical.generic_string() + '|' + std::to_string(m_Settings.GetGeometryKey()) + '|'
+			+ std::to_string(static_cast<int>(m_Settings.Format)) + '|' + std::to_string(m_Settings.LODScreenSize) + '|'
+			+ std::to_string(m_Settings.bBuildMeshlets ? m_Settings.MeshletMinTriangles : 0u);
 	}
 
 	void Model::LoadModel(std::string_view Path)
 	{
+		FGL_PROFILE_SCOPE("Model::LoadModel")
+		m_Resource->Path = Path;
+		m_Resource->Directory = Path.substr(0, Path.find_last_of('/'));
+
+		LoadGeometry(Path);
+		ComputeMeshSetID();
+		for (BaseMesh& Mesh : m_Resource->Meshes)
+		{
+			Mesh.SetCPUGeometryPolicy(m_Settings.CPUGeometry);
+		}
+
+		// Traversal only collected the texture paths, decoding them all at once keeps every core busy
+		DecodePendingTextures();
+	}
+
+	void Model::LoadGeometry(std::string_view Path)
+	{
+		// Cache files hold no skin, skeleton, animation nor second UV set
+		const bool bCooked = IsCookedPath(Path);
+		if (!bCooked && (!m_Settings.bUseMeshCache || m_Settings.Format == VertexFormat::Skinned || m_Settings.Format == VertexFormat::Lightmapped))
+		{
+			ImportModel(Path);
+			return;
+		}
+
+		const std::string CachePath = GetModelCachePath(Path, m_Settings);
+		std::vector<MeshCacheEntry> Entries;
+		if (MeshCache::Load(CachePath, GetModelSourcePath(Path), m_Settings.GetGeometryKey(), Entries))
+		{
+			LoadCachedMeshes(Entries);
+			return;
+		}
+
+		// Without its source, a cooked cache can't be imported again
+		if (bCooked)
+		{
+			LOG_ERROR("The cooked model " + std::string(Path) + " is unreadable or was cooked with other geometry settings.", false)
+			return;
+		}
+
+		if (ImportModel(Path) && !MeshCache::Save(CachePath, Path, m_Settings.GetGeometryKey(), m_Resource->Meshes))
+		{
+			LOG_INFO("Failed to write the mesh cache " + CachePath + ", the model will be imported again on the next load.")
+		}
+	}
+
+	bool Model::RestoreCPUGeometry()
+	{
+		std::span<BaseMesh> Meshes = m_Resource->Meshes;
+		if (std::all_of(Meshes.begin(), Meshes.end(), [](const BaseMesh& Mesh) { return Mesh.HasCPUGeometry(); }))
+			return true;
+
+		const std::string CachePath = GetModelCachePath(m_Resource->Path, m_Settings);
+		std::vector<MeshCacheEntry> Entries;
+		if (!MeshCache::Load(CachePath, GetModelSourcePath(m_Resource->Path), m_Settings.GetGeometryKey(), Entries) || Entries.size() != Meshes.size())
+			return false;
+
+		for (size_t Index = 0; Index < Meshes.size(); Index++)
+		{
+			Meshes[Index].RestoreCPUGeometry(std::move(Entries[Index].Vertices), std::move(Entries[Index].Indices), std::move(Entries[Index].LODIndices));
+		}
+		return true;
+	}
+
+	bool Model::ImportModel(std::string_view Path)
+	{
+		// The importer owns its IO handler; files referenced by the model, e.g. an .mtl, are opened through it too
 		Assimp::Importer Import;
-		const aiScene* Scene = Import.ReadFile(Path.data(), aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_OptimizeMeshes);
+		Import.SetIOHandler(new ModelIOSystem());
+		unsigned int Flags = aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_OptimizeMeshes;
+		if (m_Settings.bOptimizeVertexCache)
+		{
+			// Cache locality needs an indexed mesh, which only JoinIdenticalVertices provides for most formats
+			Flags |= aiProcess_JoinIdenticalVertices | aiProcess_ImproveCacheLocality;
+		}
+		if (m_Settings.Format == VertexFormat::Skinned)
+		{
+			// Four influences per vertex, the weakest dropped and the rest renormalized
+			Flags |= aiProcess_LimitBoneWeights;
+		}
+		const aiScene* Scene = Import.ReadFile(Path.data(), Flags);
 
 		if (!Scene || Scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !Scene->mRootNode)
 		{
 			LOG_ERROR("Assimp Error: " + std::string(Import.GetErrorString()), true);
+			return false;
+		}
+
+		if (m_Settings.Format == VertexFormat::Skinned)
+		{
+			m_Resource->ModelSkeleton = Skeleton::Import(Scene);
+			if (m_Resource->ModelSkeleton)
+			{
+				for (unsigned int i = 0; i < Scene->mNumAnimations; i++)
+				{
+					m_Resource->Animations.push_back(AnimationClip::Import(Scene->mAnimations[i], *m_Resource->ModelSkeleton));
+				}
+			}
+			else
+			{
+				LOG_INFO("Model " + std::string(Path) + " has no bones, its meshes are loaded unskinned.")
+			}
 		}
 
-		m_Directory = Path.substr(0, Path.find_last_of('/'));
 		ProcessNode(Scene->mRootNode, Scene);
+		return true;
+	}
+
+	void Model::LoadCachedMeshes(std::vector<MeshCacheEntry>& Entries)
+	{
+		m_Resource->Meshes.reserve(Entries.size());
+		for (MeshCacheEntry& Entry : Entries)
+		{
+			std::vector<Texture> Textures;
+			for (const MeshCacheTexture& Texture : Entry.Textures)
+			{
+				AddTexture(Texture.Path, Texture.TypeName, Textures);
+			}
+
+			// Caches written without deduplication have no hash to restore
+			const bool bHashNow = m_Settings.bDeduplicateMeshes && Entry.ContentHash == 0;
+			BaseMesh& Mesh = m_Resource->Meshes.emplace_back(std::move(Entry.Vertices), std::move(Entry.Indices), std::move(Textures), bHashNow);
+			for (uint32_t Level = 0; Level < Entry.LODIndices.size(); Level++)
+			{
+				Mesh.AddLOD(std::move(Entry.LODIndices[Level]), m_Settings.GetLODScreenSize(Level + 1));
+			}
+
+			// The cached hash already covers the levels of detail
+			if (m_Settings.bDeduplicateMeshes && !bHashNow)
+			{
+				Mesh.SetContentHash(Entry.ContentHash);
+			}
+			Mesh.SetVertexFormat(m_Settings.Format);
+			GenerateMeshlets(Mesh);
+		}
 	}
 
 	void Model::ProcessNode(aiNode* Node, const aiScene* Scene)
 	{
-		ProcessNodeMesh(Node, Scene);
-		ProcessNodeChild(Node, Scene);
+		std::vector<aiMesh*> Meshes;
+		CollectNodeMeshes(Node, Scene, Meshes);
+
+		// Textures go through the model's caches, resolved in mesh order before the geometry goes parallel
+		std::vector<std::vector<Texture>> Textures;
+		Textures.reserve(Meshes.size());
+		for (aiMesh* Mesh : Meshes)
+		{
+			Textures.push_back(ProcessTextures(Mesh, Scene));
+		}
+
+		// Every submesh is written to its own slot, so the order doesn't depend on which job finishes first
+		std::vector<std::optional<BaseMesh>> Processed(Meshes.size());
+		auto ProcessRange = [this, &Meshes, &Textures, &Processed](size_t Begin, size_t End) {
+			for (size_t i = Begin; i < End; i++)
+			{
+				Processed[i].emplace(ProcessMesh(Meshes[i], std::move(Textures[i])));
+			}
+		};
+		if (m_Settings.Jobs && Meshes.size() > 1)
+		{
+			m_Settings.Jobs->ParallelFor(Meshes.size(), 1, ProcessRange);
+		}
+		else
+		{
+			ProcessRange(0, Meshes.size());
+		}
+
+		m_Resource->Meshes.reserve(m_Resource->Meshes.size() + Processed.size());
+		for (std::optional<BaseMesh>& Mesh : Processed)
+		{
+			m_Resource->Meshes.push_back(std::move(*Mesh));
+		}
 	}
 
-	void Model::ProcessNodeMesh(aiNode* Node, const aiScene* Scene)
+	void Model::CollectNodeMeshes(aiNode* Node, const aiScene* Scene, std::vector<aiMesh*>& OutMeshes) const
 	{
 		for (unsigned int i = 0; i < Node->mNumMeshes; i++)
 		{
-			aiMesh* Mesh = Scene->mMeshes[Node->mMeshes[i]];
-			// Only compute hash for the first mesh (i == false)
-			m_Meshes.push_back(ProcessMesh(Mesh, Scene, i));
+			OutMeshes.push_back(Scene->mMeshes[Node->mMeshes[i]]);
+		}
+		for (unsigned int i = 0; i < Node->mNumChildren; i++)
+		{
+			CollectNodeMeshes(Node->mChildren[i], Scene, OutMeshes);
 		}
 	}
 
-	void Model::ProcessNodeChild(aiNode* Node, const aiScene* Scene)
+	BaseMesh Model::ProcessMesh(aiMesh* Mesh, std::vector<Texture>&& Textures) const
 	{
-		for (unsigned int i = 0; i < Node->mNumChildren; i++)
+		std::vector<Vertex> Vertices = ProcessMeshVertices(*Mesh);
+		std::vector<unsigned int> Indices = ProcessMeshIndices(*Mesh);
+
+		// Overdraw ordering works on the cache-optimized triangle order, the fetch remap must see the final order
+		if (m_Settings.bOptimizeOverdraw)
+		{
+			OptimizeOverdraw(Vertices, Indices);
+		}
+		// Reordering the vertices would leave the skin and the lightmap coordinates behind
+		std::vector<VertexSkin> Skin = ProcessSkin(Mesh);
+		std::vector<glm::vec2> LightmapCoords = ProcessLightmapCoords(Mesh);
+		if (m_Settings.bOptimizeVertexFetch && Skin.empty() && LightmapCoords.empty())
+		{
+			OptimizeVertexFetch(Vertices, Indices);
+		}
+
+		BaseMesh Result(std::move(Vertices), std::move(Indices), std::move(Textures), m_Settings.bDeduplicateMeshes);
+		Result.SetSkin(std::move(Skin));
+		Result.SetLightmapCoords(std::move(LightmapCoords));
+		Result.SetVertexFormat(m_Settings.Format == VertexFormat::Skinned && !m_Resource->ModelSkeleton ? VertexFormat::Standard : m_Settings.Format);
+		GenerateLODs(Result);
+		GenerateMeshlets(Result);
+		return Result;
+	}
+
+	void Model::GenerateLODs(BaseMesh& Mesh) const
+	{
+		std::vector<unsigned int> Previous = Mesh.GetIndices();
+		for (uint32_t Level = 1; Level < m_Settings.LODCount; Level++)
+		{
+			const size_t TargetIndexCount = static_cast<size_t>(Previous.size() / 3 * m_Settings.LODTriangleRatio) * 3;
+			std::vector<unsigned int> Simplified = SimplifyMesh(Mesh.GetVertices(), Previous, TargetIndexCount, m_Settings.LODMaxError);
+
+			// A level barely smaller than the previous one would only add a batch
+			if (Simplified.empty() || Simplified.size() > Previous.size() * 9 / 10)
+				break;
+
+			Previous = Simplified;
+			Mesh.AddLOD(std::move(Simplified), m_Settings.GetLODScreenSize(Level));
+		}
+	}
+
+	void Model::GenerateMeshlets(BaseMesh& Mesh) const
+	{
+		if (m_Settings.bBuildMeshlets && Mesh.GetIndices().size() / 3 >= m_Settings.MeshletMinTriangles)
 		{
-			ProcessNode(Node->mChildren[i], Scene);
+			Mesh.BuildMeshlets();
 		}
 	}
 
-	BaseMesh Model::ProcessMesh(aiMesh* Mesh, const aiScene* Scene, bool ComputeHash)
+	void Model::ComputeMeshSetID()
 	{
-		return BaseMesh(std::move(ProcessVertices(Mesh)), std::move(ProcessIndices(Mesh)), std::move(ProcessTextures(Mesh, Scene)), !ComputeHash);
+		std::span<const BaseMesh> Meshes = m_Resource->Meshes;
+		if (Meshes.size() == 1)
+		{
+			m_Resource->MeshSetID = Meshes[0].GetMeshID();
+			return;
+		}
+
+		// Mesh IDs are already unique per content, equal ID sequences get the same set ID
+		uint64_t SetHash = Meshes.size();
+		for (const BaseMesh& Mesh : Meshes)
+		{
+			SetHash = (SetHash ^ Mesh.GetMeshID()) * 0x100000001B3ull;
+		}
+		m_Resource->MeshSetID = BaseMesh::AcquireMeshID(SetHash != 0 ? SetHash : 1);
 	}
 
-	std::vector<Vertex> Model::ProcessVertices(aiMesh* Mesh)
+	static_assert(sizeof(aiVector3D) == sizeof(glm::vec3), "Assimp vectors are copied as glm vectors");
+
+	std::vector<Vertex> ProcessMeshVertices(const aiMesh& Mesh)
 	{
-		std::vector<Vertex> Vertices;
+		// Sized once, then each attribute is copied in its own loop: straight strided copies the compiler vectorizes
+		const unsigned int Count = Mesh.mNumVertices;
+		std::vector<Vertex> Vertices(Count);
+		Vertex* Out = Vertices.data();
 
-		for (unsigned int i = 0; i < Mesh->mNumVertices; i++)
+		const aiVector3D* Positions = Mesh.mVertices;
+		for (unsigned int i = 0; i < Count; i++)
 		{
-			Vertices.push_back(CreateVertex(Mesh, i));
+			std::memcpy(&Out[i].Position, &Positions[i], sizeof(glm::vec3));
+		}
+
+		// Point clouds and line meshes come without normals, they keep zero ones
+		if (const aiVector3D* Normals = Mesh.mNormals)
+		{
+			for (unsigned int i = 0; i < Count; i++)
+			{
+				std::memcpy(&Out[i].Normal, &Normals[i], sizeof(glm::vec3));
+			}
+		}
+
+		if (const aiVector3D* TexCoords = Mesh.mTextureCoords[0])
+		{
+			for (unsigned int i = 0; i < Count; i++)
+			{
+				std::memcpy(&Out[i].TexCoords, &TexCoords[i], sizeof(glm::vec2));
+			}
 		}
 		return Vertices;
 	}
 
-	Vertex Model::CreateVertex(aiMesh* Mesh, unsigned int Index)
+	std::vector<glm::vec2> Model::ProcessLightmapCoords(aiMesh* Mesh) const
 	{
-		Vertex Vertex;
-		Vertex.Position = glm::vec3(Mesh->mVertices[Index].x, Mesh->mVertices[Index].y, Mesh->mVertices[Index].z);
-		Vertex.Normal = glm::vec3(Mesh->mNormals[Index].x, Mesh->mNormals[Index].y, Mesh->mNormals[Index].z);
-		if (Mesh->mTextureCoords[0])
+		if (m_Settings.Format != VertexFormat::Lightmapped)
+			return {};
+
+		const aiVector3D* Coords = Mesh->mTextureCoords[1] ? Mesh->mTextureCoords[1] : Mesh->mTextureCoords[0];
+		std::vector<glm::vec2> LightmapCoords(Mesh->mNumVertices, glm::vec2(0.0f));
+		if (!Coords)
+			return LightmapCoords;
+
+		for (unsigned int i = 0; i < Mesh->mNumVertices; i++)
 		{
-			Vertex.TexCoords = glm::vec2(Mesh->mTextureCoords[0][Index].x, Mesh->mTextureCoords[0][Index].y);
+			LightmapCoords[i] = glm::vec2(Coords[i].x, Coords[i].y);
 		}
-		return Vertex;
+		return LightmapCoords;
 	}
 
-	std::vector<unsigned int> Model::ProcessIndices(aiMesh* Mesh)
+	std::vector<VertexSkin> Model::ProcessSkin(aiMesh* Mesh) const
 	{
-		std::vector<unsigned int> Indices;
+		const Skeleton* Bones = m_Resource->ModelSkeleton.get();
+		if (!Bones)
+			return {};
+
+		// Meshes of a skinned model without bones of their own keep zero weights, drawn unskinned
+		std::vector<VertexSkin> Skin(Mesh->mNumVertices);
+		std::vector<glm::vec4> Weights(Mesh->mNumVertices, glm::vec4(0.0f));
+		for (unsigned int BoneIndex = 0; BoneIndex < Mesh->mNumBones; BoneIndex++)
+		{
+			const aiBone* Bone = Mesh->mBones[BoneIndex];
+			const uint16_t Index = static_cast<uint16_t>(std::max(Bones->FindBone(Bone->mName.C_Str()), 0));
+			for (unsigned int i = 0; i < Bone->mNumWeights; i++)
+			{
+				const aiVertexWeight& Influence = Bone->mWeights[i];
+				glm::vec4& VertexWeights = Weights[Influence.mVertexId];
+
+				// Replaces the weakest slot, so the four strongest survive whatever the order
+				int Weakest = 0;
+				for (int Slot = 1; Slot < 4; Slot++)
+				{
+					if (VertexWeights[Slot] < VertexWeights[Weakest])
+						Weakest = Slot;
+				}
+				if (Influence.mWeight > VertexWeights[Weakest])
+				{
+					VertexWeights[Weakest] = Influence.mWeight;
+					Skin[Influence.mVertexId].BoneIndices[Weakest] = Index;
+				}
+			}
+		}
+
+		for (size_t i = 0; i < Skin.size(); i++)
+		{
+			const float Total = Weights[i].x + Weights[i].y + Weights[i].z + Weights[i].w;
+			if (Total <= 0.0f)
+				continue;
+
+			// Rounding is corrected on the strongest weight so the bytes always sum to 255
+			int Sum = 0;
+			int Strongest = 0;
+			for (int Slot = 0; Slot < 4; Slot++)
+			{
+				Skin[i].BoneWeights[Slot] = static_cast<uint8_t>(std::lround(Weights[i][Slot] / Total * 255.0f));
+				Sum += Skin[i].BoneWeights[Slot];
+				if (Weights[i][Slot] > Weights[i][Strongest])
+					Strongest = Slot;
+			}
+			Skin[i].BoneWeights[Strongest] = static_cast<uint8_t>(Skin[i].BoneWeights[Strongest] + 255 - Sum);
+		}
+		return Skin;
+	}
 
-		for (unsigned int i = 0; i < Mesh->mNumFaces; i++)
+	std::vector<unsigned int> ProcessMeshIndices(const aiMesh& Mesh)
+	{
+		// aiProcess_Triangulate leaves triangles, and the odd point or line of mixed meshes, sized for triangles up front
+		std::vector<unsigned int> Indices(static_cast<size_t>(Mesh.mNumFaces) * 3);
+		size_t Written = 0;
+		for (unsigned int i = 0; i < Mesh.mNumFaces; i++)
 		{
-			const aiFace& Face = Mesh->mFaces[i];
-			Indices.insert(Indices.end(), Face.mIndices, Face.mIndices + Face.mNumIndices);
+			const aiFace& Face = Mesh.mFaces[i];
+			if (Written + Face.mNumIndices > Indices.size())
+			{
+				Indices.resize(std::max(Indices.size() * 2, Written + Face.mNumIndices));
+			}
+			std::memcpy(Indices.data() + Written, Face.mIndices, Face.mNumIndices * sizeof(unsigned int));
+			Written += Face.mNumIndices;
 		}
+		Indices.resize(Written);
 		return Indices;
 	}
 
@@ -190,66 +804,202 @@ namespace fgl
 	{
 		aiString Str;
 		Material->GetTexture(Type, Index, &Str);
+		AddTexture(Str.C_Str(), TypeName, Textures);
+	}
 
-		if (IsTextureLoaded(Str))
+	void Model::AddTexture(std::string_view Path, std::string_view TypeName, std::vector<Texture>& Textures)
+	{
+		const std::string FilePath = (std::filesystem::path(m_Resource->Directory) / Path).string();
+		const size_t Key = TextureCache::GetKey(FilePath);
+
+		auto It = m_Resource->CachedTextures.find(Key);
+		if (It != m_Resource->CachedTextures.end())
 		{
-			Textures.push_back(FindLoadedTexture(Str));
+			Textures.push_back(It->second.CreateView());
 		}
 		else
 		{
-			Textures.push_back(LoadNewTexture(Str, TypeName));
+			if (AssetManifest::IsRecording())
+			{
+				AssetManifest::Record(m_Resource->Path, FilePath);
+			}
+			Textures.push_back(LoadNewTexture(Key, FilePath, Path, TypeName));
 		}
 	}
 
-	bool Model::IsTextureLoaded(const aiString& str)
+	Texture Model::LoadNewTexture(size_t Key, const std::string& FilePath, std::string_view Path, std::string_view TypeName)
 	{
-		return std::any_of(m_CachedTextures.begin(), m_CachedTextures.end(), [&str](const Texture& Texture) {
-			return std::strcmp(Texture.GetPath().data(), str.C_Str()) == 0;
-			});
+		Texture Texture;
+		Texture.SetName(TypeName);
+		Texture.SetPath(Path);
+
+		// Reuse the texture if another model uploaded it, otherwise it is decoded by DecodePendingTextures
+		// and the ID filled in by UploadPendingTexture
+		GLuint ID = 0;
+		if (TextureCache::Acquire(Key, ID))
+		{
+			Texture.SetID(ID);
+		}
+		else
+		{
+			m_Resource->PendingTextures.push_back({ Texture.GetPathSymbol(), FilePath, Key, ImageData() });
+		}
+
+		return m_Resource->CachedTextures.emplace(Key, std::move(Texture)).first->second.CreateView();
 	}
 
-	Texture Model::FindLoadedTexture(const aiString& str)
+	void Model::DecodePendingTextures()
 	{
-		auto It = std::find_if(m_CachedTextures.begin(), m_CachedTextures.end(), [&str](const Texture& Texture) {
-			return std::strcmp(Texture.GetPath().data(), str.C_Str()) == 0;
+		if (m_Resource->PendingTextures.empty())
+			return;
+
+		const size_t HardwareThreads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+		const size_t ThreadCount = std::min(HardwareThreads, m_Resource->PendingTextures.size());
+
+		// stb_image is reentrant, each thread claims the next image until none are left
+		std::atomic<size_t> NextTexture = 0;
+		auto DecodeLoop = [this, &NextTexture]() {
+			for (size_t i = NextTexture++; i < m_Resource->PendingTextures.size(); i = NextTexture++)
+			{
+				ModelResource::PendingTexture& Pending = m_Resource->PendingTextures[i];
+				if (!AssetPrefetcher::TakeImage(Pending.Key, Pending.Image))
+				{
+					Texture::DecodeImage(Pending.FilePath, true, Pending.Image);
+				}
+			}
+		};
+
+		std::vector<std::thread> Threads;
+		Threads.reserve(ThreadCount - 1);
+		for (size_t i = 1; i < ThreadCount; i++)
+		{
+			Threads.emplace_back(DecodeLoop);
+		}
+		DecodeLoop();
+		for (std::thread& Thread : Threads)
+		{
+			Thread.join();
+		}
+
+		// Failed images keep a zero ID, like a texture whose upload failed
+		std::erase_if(m_Resource->PendingTextures, [](const ModelResource::PendingTexture& Pending) {
+			if (Pending.Image.Pixels)
+				return false;
+			LOG_ERROR("Failed to load texture at path: " + Pending.FilePath, false);
+			return true;
 			});
-		return *It;
 	}
 
-	Texture Model::LoadNewTexture(const aiString& str, std::string_view TypeName)
+	const Skeleton* Model::GetSkeleton() const
 	{
-		Texture Texture;
-		std::filesystem::path FilePath = std::filesystem::path(m_Directory) / str.C_Str();
-		Texture.LoadTexture(FilePath.string());
-		Texture.SetName(TypeName);
-		Texture.SetPath(str.C_Str());
-		m_CachedTextures.push_back(Texture);
-		return Texture;
+		return m_Resource->ModelSkeleton.get();
 	}
 
-	void Model::CleanupTextures()
+	std::span<const AnimationClip> Model::GetAnimations() const
 	{
-		CleanupMeshTextures();
-		CleanupCachedTextures();
+		return m_Resource->Animations;
 	}
 
-	void Model::CleanupMeshTextures()
+	bool Model::HasPendingTextureUploads() const
 	{
-		for (auto& Mesh : m_Meshes)
+		return !m_Resource->PendingTextures.empty() || !m_Resource->UploadingTextures.empty();
+	}
+
+	bool Model::UploadPendingTexture()
+	{
+		GLUploadThread& UploadThread = SystemManager<BaseWindow>::Get()->GetUploadThread();
+		if (UploadThread.IsRunning())
 		{
-			for (auto& Texture : Mesh.GetTextures())
+			const bool bQueued = !m_Resource->PendingTextures.empty();
+			for (ModelResource::PendingTexture& Pending : m_Resource->PendingTextures)
 			{
-				Texture.Cleanup();
+				// Another model may have uploaded the same image since this one was loaded
+				GLuint ID = 0;
+				if (TextureCache::Acquire(Pending.Key, ID))
+				{
+					AssignTextureID(Pending.Key, Pending.Path, ID);
+					continue;
+				}
+
+				ModelResource::UploadingTexture Uploading{ Pending.Path, Pending.Key, Texture(), 0 };
+				Uploading.Uploaded.SetPath(Pending.FilePath);
+				Uploading.Ticket = Uploading.Uploaded.UploadImageAsync(UploadThread, Pending.Image);
+				if (Uploading.Ticket != 0)
+				{
+					m_Resource->UploadingTextures.push_back(std::move(Uploading));
+				}
 			}
+			m_Resource->PendingTextures.clear();
+			return FinishUploadedTextures(false) || bQueued;
 		}
+
+		// Uploads queued before the thread stopped have completed, Stop() ran them all
+		if (!m_Resource->UploadingTextures.empty())
+			return FinishUploadedTextures(false);
+
+		if (m_Resource->PendingTextures.empty())
+			return false;
+
+		ModelResource::PendingTexture Pending = std::move(m_Resource->PendingTextures.back());
+		m_Resource->PendingTextures.pop_back();
+
+		// Another model may have uploaded the same image since this one was loaded
+		GLuint ID = 0;
+		if (!TextureCache::Acquire(Pending.Key, ID))
+		{
+			Texture Uploaded;
+			Uploaded.SetPath(Pending.FilePath);
+			if (!Uploaded.UploadImage(Pending.Image))
+				return true;
+
+			ID = Uploaded.ReleaseOwnership();
+			TextureCache::Add(Pending.Key, ID);
+		}
+
+		AssignTextureID(Pending.Key, Pending.Path, ID);
+		return true;
 	}
 
-	void Model::CleanupCachedTextures()
+	bool Model::FinishUploadedTextures(bool bWait)
 	{
-		for (auto& Texture : m_CachedTextures)
+		auto& Uploading = m_Resource->UploadingTextures;
+		if (Uploading.empty())
+			return false;
+
+		GLUploadThread& UploadThread = SystemManager<BaseWindow>::Get()->GetUploadThread();
+		if (bWait && UploadThread.IsRunning())
 		{
-			Texture.Cleanup();
+			UploadThread.Wait(Uploading.front().Ticket);
+		}
+
+		// Tickets complete in order, the first upload still running ends the scan
+		size_t Finished = 0;
+		while (Finished < Uploading.size() && (!UploadThread.IsRunning() || UploadThread.IsComplete(Uploading[Finished].Ticket)))
+		{
+			GLuint ID = Uploading[Finished].Uploaded.ReleaseOwnership();
+			TextureCache::Add(Uploading[Finished].Key, ID);
+			AssignTextureID(Uploading[Finished].Key, Uploading[Finished].Path, ID);
+			Finished++;
+		}
+		Uploading.erase(Uploading.begin(), Uploading.begin() + Finished);
+		return Finished > 0;
+	}
+
+	void Model::AssignTextureID(size_t Key, Symbol Path, GLuint ID)
+	{
+		// Textures are views held by value, every view sharing the path receives the new ID; paths are symbols,
+		// so each texture costs an integer compare
+		m_Resource->CachedTextures[Key].SetID(ID);
+		for (BaseMesh& Mesh : m_Resource->Meshes)
+		{
+			for (Texture& MeshTexture : Mesh.GetTextures())
+			{
+				if (MeshTexture.GetPathSymbol() == Path)
+				{
+					MeshTexture.SetID(ID);
+				}
+			}
 		}
 	}
 
-} // namespace fgl
\ No newline at end of file
+} // namespace fgl
@@ -0,0 +1,152 @@
+#include <FireGL/Renderer/ModelLoader.h>
+#include <FireGL/Core/BaseLog.h>
+
+#include <chrono>
+
+namespace fgl
+{
+
+	ModelLoadState ModelLoadHandle::GetState() const
+	{
+		return m_State.load();
+	}
+
+	bool ModelLoadHandle::IsReady() const
+	{
+		return GetState() == ModelLoadState::Ready;
+	}
+
+	std::shared_ptr<Model> ModelLoadHandle::GetModel() const
+	{
+		return IsReady() ? m_Model : nullptr;
+	}
+
+	ModelLoader::ModelLoader(size_t WorkerCount)
+	{
+		if (WorkerCount == 0)
+		{
+			const size_t HardwareThreads = std::thread::hardware_concurrency();
+			WorkerCount = HardwareThreads > 1 ? HardwareThreads - 1 : 1;
+		}
+
+		for (size_t i = 0; i < WorkerCount; i++)
+		{
+			m_Workers.emplace_back(&ModelLoader::WorkerLoop, this);
+		}
+	}
+
+	ModelLoader::~ModelLoader()
+	{
+		{
+			std::lock_guard<std::mutex> Lock(m_Mutex);
+			m_bStopping = true;
+		}
+		m_Condition.notify_all();
+
+		for (std::thread& Worker : m_Workers)
+		{
+			Worker.join();
+		}
+	}
+
+	std::shared_ptr<ModelLoadHandle> ModelLoader::LoadAsync(std::string_view Path, const ModelImportSettings& Settings)
+	{
+		std::shared_ptr<ModelLoadHandle> Handle = std::make_shared<ModelLoadHandle>();
+		Handle->m_Path = Path;
+		Handle->m_Settings = Settings;
+		Handle->m_Settings.bDeferTextureUploads = true;
+
+		{
+			std::lock_guard<std::mutex> Lock(m_Mutex);
+			m_Queue.push_back(Handle);
+		}
+		m_Condition.notify_one();
+		return Handle;
+	}
+
+	void ModelLoader::WorkerLoop()
+	{
+		while (true)
+		{
+			std::shared_ptr<ModelLoadHandle> Handle;
+			{
+				std::unique_lock<std::mutex> Lock(m_Mutex);
+				m_Condition.wait(Lock, [this] { return m_bStopping || !m_Queue.empty(); });
+				if (m_bStopping)
+					return;
+
+				Handle = std::move(m_Queue.front());
+				m_Queue.pop_front();
+				m_ActiveLoads++;
+			}
+
+			try
+			{
+				Handle->m_Model = std::make_shared<Model>(Handle->m_Path, Handle->m_Settings);
+			}
+			catch (const std::exception& Exception)
+			{
+				LOG_ERROR("Failed to load model " + Handle->m_Path + ": " + Exception.what(), false)
+				Handle->m_Model = nullptr;
+			}
+
+			std::lock_guard<std::mutex> Lock(m_Mutex);
+			m_ActiveLoads--;
+			if (Handle->m_Model)
+			{
+				Handle->m_State = ModelLoadState::Uploading;
+				m_Imported.push_back(std::move(Handle));
+			}
+			else
+			{
+				Handle->m_State = ModelLoadState::Failed;
+			}
+		}
+	}
+
+	void ModelLoader::ProcessUploads(float BudgetMilliseconds)
+	{
+		{
+			std::lock_guard<std::mutex> Lock(m_Mutex);
+			m_Uploading.insert(m_Uploading.end(), m_Imported.begin(), m_Imported.end());
+			m_Imported.clear();
+		}
+
+		const auto Start = std::chrono::steady_clock::now();
+		const auto Budget = std::chrono::duration<float, std::milli>(BudgetMilliseconds);
+		bool bUploaded = false;
+
+		auto It = m_Uploading.begin();
+		while (It != m_Uploading.end())
+		{
+			Model& Loading = *(*It)->m_Model;
+			while (Loading.HasPendingTextureUploads() && (!bUploaded || std::chrono::steady_clock::now() - Start < Budget))
+			{
+				// Textures waiting for the upload thread don't use the budget, the next models can queue theirs
+				if (!Loading.UploadPendingTexture())
+					break;
+
+				bUploaded = true;
+			}
+
+			if (Loading.HasPendingTextureUploads())
+			{
+				if (std::chrono::steady_clock::now() - Start >= Budget)
+					return;
+
+				++It;
+				continue;
+			}
+
+			(*It)->m_State = ModelLoadState::Ready;
+			It = m_Uploading.erase(It);
+		}
+	}
+
+	bool ModelLoader::IsBusy() const
+	{
+		std::lock_guard<std::mutex> Lock(m_Mutex);
+		return !m_Queue.empty() || !m_Imported.empty() || !m_Uploading.empty() || m_ActiveLoads > 0;
+	}
+
+} // namespace fgl
\ No newline at end of file
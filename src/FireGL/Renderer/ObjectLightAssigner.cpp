@@ -0,0 +1,130 @@
+#include <FireGL/Renderer/ObjectLightAssigner.h>
+#include <FireGL/Renderer/LightUniformBuffer.h>
+#include <FireGL/Renderer/Scene.h>
+#include <FireGL/Renderer/SceneObject.h>
+#include <FireGL/Renderer/BoundingVolume.h>
+#include <FireGL/Core/Profiler.h>
+
+namespace fgl
+{
+
+	namespace
+	{
+		static_assert(LightData::MaxPointLights < 256, "Point light indices plus 1 are packed in bytes");
+
+		/** Reach clamped for lights without falloff, which would otherwise cover the whole scene at infinity. */
+		constexpr float MaxLightRange = 1.0e6f;
+
+		/** @return The attenuation of a point light at a distance, as computed by the lighting shaders. */
+		float GetAttenuation(const PointLightData& Light, float Distance)
+		{
+			return 1.0f / (Light.Attenuation.x + Light.Attenuation.y * Distance + Light.Attenuation.z * Distance * Distance);
+		}
+
+		/** @return The distance at which Brightness * attenuation falls to Threshold, 0 if it never reaches it. */
+		float GetLightRange(const PointLightData& Light, float Brightness, float Threshold)
+		{
+			// Solves constant + linear * d + quadratic * d^2 = Brightness / Threshold for d
+			const float Constant = Light.Attenuation.x - Brightness / Threshold;
+			if (Constant >= 0.0f)
+				return 0.0f;
+			if (Light.Attenuation.z > 0.0f)
+			{
+				const float Linear = Light.Attenuation.y;
+				return std::min((-Linear + std::sqrt(Linear * Linear - 4.0f * Light.Attenuation.z * Constant)) / (2.0f * Light.Attenuation.z), MaxLightRange);
+			}
+			return Light.Attenuation.y > 0.0f ? std::min(-Constant / Light.Attenuation.y, MaxLightRange) : MaxLightRange;
+		}
+	}
+
+	void ObjectLightAssigner::SetInfluenceThreshold(float Threshold)
+	{
+		m_InfluenceThreshold = std::max(Threshold, 1.0e-6f);
+	}
+
+	float ObjectLightAssigner::GetInfluenceThreshold() const
+	{
+		return m_InfluenceThreshold;
+	}
+
+	void ObjectLightAssigner::Assign(Scene* Scene, const LightData& Lights)
+	{
+		FGL_PROFILE_SCOPE("ObjectLightAssigner::Assign")
+		const auto& Objects = Scene->GetObjects();
+		const BoundingSphereArrays& Spheres = Scene->GetBoundingSpheres();
+		m_Candidates.assign(Objects.size(), Candidates());
+
+		const int PointLightCount = std::clamp(Lights.Counts.x, 0, LightData::MaxPointLights);
+		for (int LightIndex = 0; LightIndex < PointLightCount; LightIndex++)
+		{
+			const PointLightData& Light = Lights.PointLights[LightIndex];
+			const glm::vec3 Position = glm::vec3(Light.Position);
+			const float Brightness = std::max({ Light.Diffuse.r, Light.Diffuse.g, Light.Diffuse.b }) + std::max({ Light.Ambient.r, Light.Ambient.g, Light.Ambient.b });
+			const float Range = GetLightRange(Light, Brightness, m_InfluenceThreshold);
+			if (Range <= 0.0f)
+				continue;
+
+			// The spatial index narrows the light down to the objects within its reach
+			BoundingSphere Reach;
+			Reach.Center = Position;
+			Reach.Radius = Range;
+			Scene->QuerySphere(Reach, m_Reached);
+			for (uint32_t Index : m_Reached)
+			{
+				// Skyboxes have infinite bounds, they are lit by nothing
+				const float Radius = Spheres.Radius[Index];
+				if (std::isinf(Radius))
+					continue;
+
+				// Rated at the nearest point of the bounds, so large objects keep the lights close to any part of them
+				const glm::vec3 Offset = glm::vec3(Spheres.X[Index], Spheres.Y[Index], Spheres.Z[Index]) - Position;
+				const float Distance = std::max(glm::length(Offset) - Radius, 0.0f);
+				Insert(m_Candidates[Index], static_cast<uint8_t>(LightIndex), Brightness * GetAttenuation(Light, Distance));
+			}
+		}
+
+		m_LitObjectCount = 0;
+		for (size_t Index = 0; Index < Objects.size(); Index++)
+		{
+			const Candidates& Object = m_Candidates[Index];
+			uint32_t Packed = 0;
+			for (uint32_t Entry = 0; Entry < Object.Count; Entry++)
+			{
+				Packed |= (static_cast<uint32_t>(Object.Lights[Entry]) + 1) << (8 * Entry);
+			}
+			m_LitObjectCount += Object.Count > 0 ? 1 : 0;
+			Objects[Index]->SetPointLights(Packed);
+		}
+	}
+
+	size_t ObjectLightAssigner::GetLitObjectCount() const
+	{
+		return m_LitObjectCount;
+	}
+
+	void ObjectLightAssigner::Insert(Candidates& Object, uint8_t Light, float Influence)
+	{
+		if (Influence <= 0.0f)
+			return;
+
+		// Insertion into a list of four, the weakest falls off the end when it is full
+		uint32_t Position = Object.Count;
+		while (Position > 0 && Object.Influences[Position - 1] < Influence)
+		{
+			Position--;
+		}
+		if (Position >= MaxLightsPerObject)
+			return;
+
+		const uint32_t Last = std::min(Object.Count, MaxLightsPerObject - 1);
+		for (uint32_t Entry = Last; Entry > Position; Entry--)
+		{
+			Object.Influences[Entry] = Object.Influences[Entry - 1];
+			Object.Lights[Entry] = Object.Lights[Entry - 1];
+		}
+		Object.Influences[Position] = Influence;
+		Object.Lights[Position] = Light;
+		Object.Count = std::min(Object.Count + 1, MaxLightsPerObject);
+	}
+
+} // namespace fgl
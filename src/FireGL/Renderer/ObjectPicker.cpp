@@ -0,0 +1,316 @@
+#include <FireGL/Renderer/ObjectPicker.h>
+#include <FireGL/Renderer/Scene.h>
+#include <FireGL/Renderer/SceneObject.h>
+#include <FireGL/Renderer/Material.h>
+#include <FireGL/Renderer/GLStateCache.h>
+#include <FireGL/Renderer/GPUMemoryTracker.h>
+#include <FireGL/Core/BaseLog.h>
+
+#include <External/glm/gtc/matrix_transform.hpp>
+
+namespace fgl
+{
+
+	namespace
+	{
+		// Same position math as the depth prepass, the instance index follows the draw's first one
+		constexpr std::string_view PickVertexCode = R"(#version 410 core
+layout (location = 0) in vec3 aPos;
+layout (location = 3) in mat4 ModelMatrix;
+layout (location = 7) in mat3x4 NormalMatrix;
+
+layout (std140) uniform CameraData
+{
+    mat4 View;
+    mat4 Projection;
+    mat4 ViewProjection;
+    vec4 Position;
+    mat4 InverseViewProjection;
+    vec4 Time;
+} Camera;
+
+uniform mat4 PickViewProjection;
+uniform int FirstIndex;
+
+flat out uint ObjectID;
+
+// Same procedural animation as BaseLighting.vert, see ProceduralAnimation
+float UnpackHalf(uint Bits)
+{
+    float Mantissa = float(Bits & 0x3FFu);
+    uint Exponent = (Bits >> 10u) & 0x1Fu;
+    float Value = Exponent == 0u ? Mantissa * exp2(-24.0) : (1024.0 + Mantissa) * exp2(float(Exponent) - 25.0);
+    return (Bits & 0x8000u) != 0u ? -Value : Value;
+}
+
+mat3 ProceduralRotation(uvec3 Packed, float Time, out vec3 Offset)
+{
+    vec2 Octahedral = vec2(Packed.x & 0xFFu, (Packed.x >> 8u) & 0xFFu) / 127.5 - 1.0;
+    vec3 Axis = vec3(Octahedral, 1.0 - abs(Octahedral.x) - abs(Octahedral.y));
+    if (Axis.z < 0.0)
+        Axis.xy = (1.0 - abs(Axis.yx)) * mix(vec2(-1.0), vec2(1.0), greaterThanEqual(Axis.xy, vec2(0.0)));
+    Axis = normalize(Axis);
+    float Wave = sin(6.2831853 * UnpackHalf(Packed.z >> 16u) * Time + UnpackHalf(Packed.z & 0xFFFFu));
+    float Angle = UnpackHalf(Packed.x >> 16u) * Time + UnpackHalf(Packed.y & 0xFFFFu) * Wave;
+    Offset = Axis * (UnpackHalf(Packed.y >> 16u) * Wave);
+    float Cosine = cos(Angle);
+    return mat3(Cosine) + sin(Angle) * mat3(0.0, Axis.z, -Axis.y, -Axis.z, 0.0, Axis.x, Axis.y, -Axis.x, 0.0) + (1.0 - Cosine) * outerProduct(Axis, Axis);
+}
+
+void main()
+{
+    vec3 Position = aPos;
+    uvec3 Animation = floatBitsToUint(vec3(NormalMatrix[0].w, NormalMatrix[1].w, NormalMatrix[2].w));
+    if (Animation != uvec3(0u))
+    {
+        vec3 Offset;
+        Position = ProceduralRotation(Animation, Camera.Time.x, Offset) * Position + Offset;
+    }
+    ObjectID = uint(FirstIndex + gl_InstanceID) + 1u;
+    gl_Position = PickViewProjection * (ModelMatrix * vec4(Position, 1.0));
+})";
+
+		constexpr std::string_view PickFragmentCode = R"(#version 410 core
+flat in uint ObjectID;
+
+layout (location = 0) out uint FragID;
+
+void main()
+{
+    FragID = ObjectID;
+})";
+	}
+
+	ObjectPicker::~ObjectPicker()
+	{
+		Destroy();
+	}
+
+	void ObjectPicker::Request(const glm::vec2& Position, Callback OnPicked, LayerMask Layers)
+	{
+		std::lock_guard<std::mutex> Lock(m_Mutex);
+		m_bRequested = true;
+		m_RequestPosition = Position;
+		m_RequestCallback = std::move(OnPicked);
+		m_RequestLayers = Layers;
+	}
+
+	bool ObjectPicker::HasRequest() const
+	{
+		std::lock_guard<std::mutex> Lock(m_Mutex);
+		return m_bRequested;
+	}
+
+	bool ObjectPicker::IsPending() const
+	{
+		if (HasRequest())
+			return true;
+
+		for (const Slot& Pick : m_Slots)
+		{
+			if (Pick.Fence)
+				return true;
+		}
+		return false;
+	}
+
+	void ObjectPicker::Create()
+	{
+		m_Shader = Shader::CreateFromSource(PickVertexCode, PickFragmentCode);
+
+		glGenTextures(1, &m_IDTexture);
+		GLStateCache::BindTexture(GL_TEXTURE_2D, m_IDTexture);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_R32UI, 1, 1, 0, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		GPUMemoryTracker::TrackTexture(m_IDTexture, GPUMemoryTracker::GetTextureSize(GL_R32UI, 1, 1), GPUMemoryCategory::RenderTargets, "Object Picker");
+
+		glGenRenderbuffers(1, &m_DepthBuffer);
+		glBindRenderbuffer(GL_RENDERBUFFER, m_DepthBuffer);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT32F, 1, 1);
+
+		glGenFramebuffers(1, &m_Framebuffer);
+		glBindFramebuffer(GL_FRAMEBUFFER, m_Framebuffer);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_IDTexture, 0);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_DepthBuffer);
+		LOG_ASSERT(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE, "Object picker framebuffer is incomplete")
+
+		m_Slots.resize(RingSize);
+		for (Slot& Pick : m_Slots)
+		{
+			glGenBuffers(1, &Pick.Buffer);
+			GLStateCache::BindBuffer(GL_PIXEL_PACK_BUFFER, Pick.Buffer);
+			glBufferData(GL_PIXEL_PACK_BUFFER, sizeof(uint32_t), nullptr, GL_STREAM_READ);
+			GPUMemoryTracker::TrackBuffer(Pick.Buffer, sizeof(uint32_t), GPUMemoryCategory::Staging, "Object Picker");
+		}
+		GLStateCache::BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	}
+
+	bool ObjectPicker::BeginPass(const glm::mat4& ViewProjection, const glm::ivec2& ViewportSize, const glm::ivec2& WindowSize)
+	{
+		glm::vec2 Position;
+		{
+			std::lock_guard<std::mutex> Lock(m_Mutex);
+			if (!m_bRequested)
+				return false;
+
+			m_bRequested = false;
+			Position = m_RequestPosition;
+			m_PassCallback = std::move(m_RequestCallback);
+			m_RequestCallback = nullptr;
+			m_PassLayers = m_RequestLayers;
+		}
+
+		// Window coordinates differ from pixels on high-DPI displays, and count rows from the top
+		const glm::vec2 Scale = glm::vec2(ViewportSize) / glm::max(glm::vec2(WindowSize), glm::vec2(1.0f));
+		const glm::ivec2 Pixel(static_cast<int>(Position.x * Scale.x), ViewportSize.y - 1 - static_cast<int>(Position.y * Scale.y));
+		if (Pixel.x < 0 || Pixel.y < 0 || Pixel.x >= ViewportSize.x || Pixel.y >= ViewportSize.y)
+		{
+			if (m_PassCallback)
+			{
+				m_PassCallback(nullptr);
+			}
+			m_PassCallback = nullptr;
+			return false;
+		}
+
+		if (!m_Shader)
+		{
+			Create();
+		}
+
+		// Pick matrix: the pixel's square of normalized device coordinates is stretched over the whole 1 x 1 target
+		const glm::vec2 Center = (glm::vec2(Pixel) + 0.5f) / glm::vec2(ViewportSize) * 2.0f - 1.0f;
+		const glm::mat4 PickMatrix = glm::translate(glm::scale(glm::mat4(1.0f), glm::vec3(glm::vec2(ViewportSize), 1.0f)), glm::vec3(-Center, 0.0f));
+
+		glBindFramebuffer(GL_FRAMEBUFFER, m_Framebuffer);
+		glViewport(0, 0, 1, 1);
+		glEnable(GL_DEPTH_TEST);
+		GLStateCache::SetDepthFunc(GL_LESS);
+		GLStateCache::SetDepthWrite(true);
+		glDisable(GL_BLEND);
+		const GLuint ClearID[4] = { 0, 0, 0, 0 };
+		const GLfloat ClearDepth = 1.0f;
+		glClearBufferuiv(GL_COLOR, 0, ClearID);
+		glClearBufferfv(GL_DEPTH, 0, &ClearDepth);
+		m_Shader->Activate();
+		m_Shader->SetMat4("PickViewProjection", PickMatrix * ViewProjection);
+		m_Shader->SetInt("FirstIndex", 0);
+		return true;
+	}
+
+	LayerMask ObjectPicker::GetPassLayers() const
+	{
+		return m_PassLayers;
+	}
+
+	void ObjectPicker::SetFirstIndex(uint32_t FirstIndex)
+	{
+		m_Shader->SetInt("FirstIndex", static_cast<int>(FirstIndex));
+	}
+
+	void ObjectPicker::EndPass(std::vector<SceneObject*> Objects, const Scene* Scene)
+	{
+		// The ring is only full when picks come faster than the GPU answers them, the oldest is answered first
+		Slot& Pick = m_Slots[m_Next];
+		if (Pick.Fence)
+		{
+			glClientWaitSync(Pick.Fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+			Collect(Scene);
+		}
+
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, m_Framebuffer);
+		glReadBuffer(GL_COLOR_ATTACHMENT0);
+		GLStateCache::BindBuffer(GL_PIXEL_PACK_BUFFER, Pick.Buffer);
+		glReadPixels(0, 0, 1, 1, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+		GLStateCache::BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		Pick.Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		Pick.Objects = std::move(Objects);
+		Pick.OnPicked = std::move(m_PassCallback);
+		m_PassCallback = nullptr;
+		m_Next = (m_Next + 1) % m_Slots.size();
+
+		// The pass program replaced the one of the active material
+		Material::InvalidateActiveMaterial();
+	}
+
+	void ObjectPicker::Collect(const Scene* Scene)
+	{
+		for (Slot& Pick : m_Slots)
+		{
+			if (!Pick.Fence)
+				continue;
+
+			const GLenum Status = glClientWaitSync(Pick.Fence, 0, 0);
+			if (Status != GL_ALREADY_SIGNALED && Status != GL_CONDITION_SATISFIED)
+				continue;
+
+			glDeleteSync(Pick.Fence);
+			Pick.Fence = nullptr;
+
+			uint32_t ObjectID = 0;
+			GLStateCache::BindBuffer(GL_PIXEL_PACK_BUFFER, Pick.Buffer);
+			if (const void* Mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, sizeof(uint32_t), GL_MAP_READ_BIT))
+			{
+				std::memcpy(&ObjectID, Mapped, sizeof(uint32_t));
+				glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+			}
+			GLStateCache::BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+			// The object may have left the Scene while its pixel was in flight
+			SceneObject* Object = ObjectID != 0 && ObjectID <= Pick.Objects.size() ? Pick.Objects[ObjectID - 1] : nullptr;
+			if (Object && Scene)
+			{
+				const auto& Objects = Scene->GetObjects();
+				const bool bAlive = std::any_of(Objects.begin(), Objects.end(), [Object](const std::unique_ptr<SceneObject>& Candidate) { return Candidate.get() == Object; });
+				Object = bAlive ? Object : nullptr;
+			}
+			Pick.Objects.clear();
+			Callback OnPicked = std::move(Pick.OnPicked);
+			Pick.OnPicked = nullptr;
+			if (OnPicked)
+			{
+				OnPicked(Object);
+			}
+		}
+	}
+
+	void ObjectPicker::Destroy()
+	{
+		for (Slot& Pick : m_Slots)
+		{
+			if (Pick.Fence)
+			{
+				glDeleteSync(Pick.Fence);
+			}
+			glDeleteBuffers(1, &Pick.Buffer);
+			GLStateCache::OnBufferDeleted(Pick.Buffer);
+			GPUMemoryTracker::UntrackBuffer(Pick.Buffer);
+		}
+		m_Slots.clear();
+		m_Next = 0;
+		if (m_Framebuffer != 0)
+		{
+			glDeleteFramebuffers(1, &m_Framebuffer);
+			m_Framebuffer = 0;
+		}
+		if (m_IDTexture != 0)
+		{
+			glDeleteTextures(1, &m_IDTexture);
+			GLStateCache::OnTextureDeleted(m_IDTexture);
+			GPUMemoryTracker::UntrackTexture(m_IDTexture);
+			m_IDTexture = 0;
+		}
+		if (m_DepthBuffer != 0)
+		{
+			glDeleteRenderbuffers(1, &m_DepthBuffer);
+			m_DepthBuffer = 0;
+		}
+		if (m_Shader)
+		{
+			m_Shader->Cleanup();
+			m_Shader.reset();
+		}
+	}
+
+} // namespace fgl
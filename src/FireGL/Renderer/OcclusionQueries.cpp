@@ -0,0 +1,187 @@
+#include <FireGL/Renderer/OcclusionQueries.h>
+#include <FireGL/Renderer/GLStateCache.h>
+#include <FireGL/Renderer/GPUMemoryTracker.h>
+#include <FireGL/Renderer/RenderStats.h>
+
+#include <External/glm/gtc/matrix_transform.hpp>
+
+namespace fgl
+{
+
+	namespace
+	{
+		constexpr std::string_view BoxVertexCode = R"(#version 410 core
+layout (location = 0) in vec3 aPos;
+
+uniform mat4 BoxTransform;
+
+void main()
+{
+    gl_Position = BoxTransform * vec4(aPos, 1.0);
+})";
+
+		constexpr std::string_view BoxFragmentCode = R"(#version 410 core
+void main()
+{
+})";
+
+		// Corner i has x, y and z set by its bits 0, 1 and 2; faces wind counter-clockwise seen from outside
+		constexpr GLubyte BoxIndices[] = {
+			0, 4, 6, 0, 6, 2,
+			1, 3, 7, 1, 7, 5,
+			0, 1, 5, 0, 5, 4,
+			2, 6, 7, 2, 7, 3,
+			0, 2, 3, 0, 3, 1,
+			4, 5, 7, 4, 7, 6
+		};
+	}
+
+	void OcclusionQueries::Create()
+	{
+		float Corners[8 * 3];
+		for (int Corner = 0; Corner < 8; Corner++)
+		{
+			Corners[Corner * 3 + 0] = (Corner & 1) ? 1.0f : -1.0f;
+			Corners[Corner * 3 + 1] = (Corner & 2) ? 1.0f : -1.0f;
+			Corners[Corner * 3 + 2] = (Corner & 4) ? 1.0f : -1.0f;
+		}
+
+		glGenVertexArrays(1, &m_BoxVertexArray);
+		GLStateCache::BindVertexArray(m_BoxVertexArray);
+		glGenBuffers(1, &m_BoxVertexBuffer);
+		GLStateCache::BindBuffer(GL_ARRAY_BUFFER, m_BoxVertexBuffer);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(Corners), Corners, GL_STATIC_DRAW);
+		GPUMemoryTracker::TrackBuffer(m_BoxVertexBuffer, sizeof(Corners), GPUMemoryCategory::Geometry, "OcclusionQueries");
+		glGenBuffers(1, &m_BoxIndexBuffer);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_BoxIndexBuffer);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(BoxIndices), BoxIndices, GL_STATIC_DRAW);
+		GPUMemoryTracker::TrackBuffer(m_BoxIndexBuffer, sizeof(BoxIndices), GPUMemoryCategory::Geometry, "OcclusionQueries");
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+
+		m_BoxShader = Shader::CreateFromSource(BoxVertexCode, BoxFragmentCode);
+		m_BoxTransform = m_BoxShader->GetUniform("BoxTransform");
+	}
+
+	void OcclusionQueries::Destroy()
+	{
+		for (QueryState& State : m_States)
+		{
+			if (State.Query != 0)
+			{
+				glDeleteQueries(1, &State.Query);
+			}
+		}
+		m_States.clear();
+
+		if (m_BoxVertexArray == 0)
+			return;
+
+		glDeleteVertexArrays(1, &m_BoxVertexArray);
+		GLStateCache::OnVertexArrayDeleted(m_BoxVertexArray);
+		m_BoxVertexArray = 0;
+		for (GLuint* Buffer : { &m_BoxVertexBuffer, &m_BoxIndexBuffer })
+		{
+			glDeleteBuffers(1, Buffer);
+			GLStateCache::OnBufferDeleted(*Buffer);
+			GPUMemoryTracker::UntrackBuffer(*Buffer);
+			*Buffer = 0;
+		}
+		m_BoxShader->Cleanup();
+		m_BoxShader.reset();
+	}
+
+	bool OcclusionQueries::IsCreated() const
+	{
+		return m_BoxVertexArray != 0;
+	}
+
+	void OcclusionQueries::BeginFrame(size_t ObjectCount)
+	{
+		// States past the object count keep their query objects for the indices filled again later
+		if (m_States.size() < ObjectCount)
+		{
+			m_States.resize(ObjectCount);
+		}
+		m_Frame++;
+	}
+
+	bool OcclusionQueries::IsVisible(uint32_t Index, const SceneObject* Object)
+	{
+		QueryState& State = m_States[Index];
+
+		// Another object took the index, or the object comes back into view: nothing known about it is current
+		if (State.Owner != Object || State.LastFrame + 1 < m_Frame)
+		{
+			State.Owner = Object;
+			State.bVisible = true;
+			State.bPending = false;
+		}
+		State.LastFrame = m_Frame;
+
+		if (State.bPending)
+		{
+			GLuint bAvailable = GL_FALSE;
+			glGetQueryObjectuiv(State.Query, GL_QUERY_RESULT_AVAILABLE, &bAvailable);
+			if (bAvailable)
+			{
+				GLuint bPassed = GL_TRUE;
+				glGetQueryObjectuiv(State.Query, GL_QUERY_RESULT, &bPassed);
+				State.bVisible = bPassed != GL_FALSE;
+				State.bPending = false;
+			}
+		}
+		return State.bVisible;
+	}
+
+	void OcclusionQueries::Issue(const std::vector<uint32_t>& Indices, const BoundingSphereArrays& Spheres, const glm::mat4& ViewProjection,
+		const glm::vec3& CameraPosition, float Near)
+	{
+		m_BoxShader->Activate();
+		GLStateCache::BindVertexArray(m_BoxVertexArray);
+		glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+		GLStateCache::SetDepthWrite(false);
+
+		for (uint32_t Index : Indices)
+		{
+			// Skyboxes and objects waiting for their upload were never read this frame
+			QueryState& State = m_States[Index];
+			if (State.LastFrame != m_Frame || State.bPending)
+				continue;
+
+			// Hidden objects are tested every frame, visible ones every few frames, spread over the frames by index
+			if (State.bVisible && (m_Frame + Index) % m_VisibleQueryInterval != 0)
+				continue;
+
+			// A box clipped by the near plane could pass no sample while the object is in view
+			const glm::vec3 Center(Spheres.X[Index], Spheres.Y[Index], Spheres.Z[Index]);
+			const float Radius = Spheres.Radius[Index];
+			if (glm::all(glm::lessThan(glm::abs(CameraPosition - Center), glm::vec3(Radius + Near))))
+			{
+				State.bVisible = true;
+				continue;
+			}
+
+			if (State.Query == 0)
+			{
+				glGenQueries(1, &State.Query);
+			}
+			const glm::mat4 BoxTransform = glm::scale(glm::translate(ViewProjection, Center), glm::vec3(Radius));
+			m_BoxShader->SetMat4(m_BoxTransform, BoxTransform);
+			glBeginQuery(GL_ANY_SAMPLES_PASSED, State.Query);
+			glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(std::size(BoxIndices)), GL_UNSIGNED_BYTE, nullptr);
+			RenderCounters::CountDraw(1, std::size(BoxIndices) / 3);
+			glEndQuery(GL_ANY_SAMPLES_PASSED);
+			State.bPending = true;
+		}
+
+		glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+		GLStateCache::SetDepthWrite(true);
+	}
+
+	void OcclusionQueries::SetVisibleQueryInterval(uint32_t Frames)
+	{
+		m_VisibleQueryInterval = std::max<uint32_t>(Frames, 1);
+	}
+
+} // namespace fgl
@@ -0,0 +1,670 @@
+#include <FireGL/Renderer/OpenGLRenderDevice.h>
+#include <FireGL/Renderer/GLStateCache.h>
+#include <FireGL/Renderer/GPUMemoryTracker.h>
+#include <FireGL/Renderer/GLExtensions.h>
+#include <FireGL/Renderer/Material.h>
+#include <FireGL/Renderer/Mesh.h>
+#include <FireGL/Renderer/MipGenerator.h>
+#include <FireGL/Renderer/PixelUploadPool.h>
+#include <FireGL/Renderer/SceneObject.h>
+#include <FireGL/Renderer/Shader.h>
+#include <FireGL/Renderer/Texture.h>
+#include <FireGL/Core/BaseLog.h>
+#include <FireGL/Core/GLDebug.h>
+
+namespace fgl
+{
+
+	RenderBackend OpenGLRenderDevice::GetBackend() const
+	{
+		return RenderBackend::OpenGL;
+	}
+
+	BufferHandle OpenGLRenderDevice::CreateBuffer(const BufferDesc& Desc, const void* Data)
+	{
+		BufferHandle Buffer;
+		Buffer.Size = Desc.Size;
+		Buffer.Usage = Desc.Usage;
+		glGenBuffers(1, &Buffer.ID);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, Buffer.ID);
+		if (Desc.Usage == BufferUsage::Persistent)
+		{
+			LOG_ASSERT(SupportsPersistentBuffers(), "Persistent buffers need OpenGL 4.4")
+			const GLbitfield Flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+			glBufferStorage(GL_COPY_WRITE_BUFFER, Desc.Size, Data, Flags);
+			Buffer.Mapped = glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, Desc.Size, Flags);
+			LOG_ASSERT(Buffer.Mapped, "Failed to persistently map a buffer")
+		}
+		else
+		{
+			glBufferData(GL_COPY_WRITE_BUFFER, Desc.Size, Data, GetUsage(Desc.Usage));
+		}
+		GPUMemoryTracker::TrackBuffer(Buffer.ID, Desc.Size, Desc.Category, Desc.Owner);
+		return Buffer;
+	}
+
+	void OpenGLRenderDevice::DestroyBuffer(BufferHandle& Buffer)
+	{
+		if (!Buffer)
+			return;
+
+		if (Buffer.Mapped)
+		{
+			glBindBuffer(GL_COPY_WRITE_BUFFER, Buffer.ID);
+			glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+		}
+		glDeleteBuffers(1, &Buffer.ID);
+		GLStateCache::OnBufferDeleted(Buffer.ID);
+		GPUMemoryTracker::UntrackBuffer(Buffer.ID);
+		Buffer = BufferHandle();
+	}
+
+	void OpenGLRenderDevice::UpdateBuffer(const BufferHandle& Buffer, size_t Offset, size_t Size, const void* Data)
+	{
+		glBindBuffer(GL_COPY_WRITE_BUFFER, Buffer.ID);
+		glBufferSubData(GL_COPY_WRITE_BUFFER, Offset, Size, Data);
+	}
+
+	void OpenGLRenderDevice::CopyBuffer(const BufferHandle& Source, size_t SourceOffset, const BufferHandle& Target, size_t TargetOffset, size_t Size)
+	{
+		glBindBuffer(GL_COPY_READ_BUFFER, Source.ID);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, Target.ID);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, SourceOffset, TargetOffset, Size);
+	}
+
+	void OpenGLRenderDevice::DiscardBuffer(const BufferHandle& Buffer)
+	{
+		if (Buffer.Usage == BufferUsage::Persistent)
+			return;
+
+		// Orphans the storage, the driver hands out new memory while the draws in flight keep the old one
+		glBindBuffer(GL_COPY_WRITE_BUFFER, Buffer.ID);
+		glBufferData(GL_COPY_WRITE_BUFFER, Buffer.Size, nullptr, GetUsage(Buffer.Usage));
+	}
+
+	bool OpenGLRenderDevice::SupportsPersistentBuffers() const
+	{
+		return GLAD_GL_VERSION_4_4;
+	}
+
+	void OpenGLRenderDevice::BindUniformBuffer(uint32_t Binding, const BufferHandle& Buffer)
+	{
+		// Also binds the generic GL_UNIFORM_BUFFER point, which the cache then holds
+		GLStateCache::BindBuffer(GL_UNIFORM_BUFFER, Buffer.ID);
+		glBindBufferBase(GL_UNIFORM_BUFFER, Binding, Buffer.ID);
+	}
+
+	TextureHandle OpenGLRenderDevice::CreateTexture(const TextureDesc& Desc, const void* Data)
+	{
+		TextureHandle Texture;
+		Texture.Width = Desc.Width;
+		Texture.Height = Desc.Height;
+		Texture.Format = Desc.Format;
+
+		const GLenum InternalFormat = GetInternalFormat(Desc.Format);
+		const auto [PixelFormat, PixelType] = GetPixelFormat(Desc.Format);
+		const uint32_t Levels = std::max(Desc.Levels, 1u);
+
+		glGenTextures(1, &Texture.ID);
+		GLStateCache::BindTexture(GL_TEXTURE_2D, Texture.ID);
+
+		// glTexImage2D per level rather than glTexStorage2D, which 4.1 lacks
+		for (uint32_t Level = 0; Level < Levels; Level++)
+		{
+			const GLsizei Width = static_cast<GLsizei>(std::max(Desc.Width >> Level, 1u));
+			const GLsizei Height = static_cast<GLsizei>(std::max(Desc.Height >> Level, 1u));
+			glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(Level), InternalFormat, Width, Height, 0, PixelFormat, PixelType,
+				Level == 0 ? Data : nullptr);
+		}
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(Levels - 1));
+
+		const bool bLinear = Desc.Filter == TextureFilter::Linear;
+		GLint MinFilter = bLinear ? GL_LINEAR : GL_NEAREST;
+		if (Levels > 1)
+		{
+			MinFilter = bLinear ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST_MIPMAP_NEAREST;
+		}
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, MinFilter);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, bLinear ? GL_LINEAR : GL_NEAREST);
+
+		const GLint Wrap = Desc.Wrap == TextureWrap::ClampToEdge ? GL_CLAMP_TO_EDGE : GL_REPEAT;
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, Wrap);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, Wrap);
+
+		GPUMemoryTracker::TrackTexture(Texture.ID, GPUMemoryTracker::GetTextureSize(InternalFormat, static_cast<int>(Desc.Width),
+			static_cast<int>(Desc.Height), 1, static_cast<int>(Levels)), Desc.Category, Desc.Owner);
+		return Texture;
+	}
+
+	void OpenGLRenderDevice::DestroyTexture(TextureHandle& Texture)
+	{
+		if (!Texture)
+			return;
+
+		glDeleteTextures(1, &Texture.ID);
+		GLStateCache::OnTextureDeleted(Texture.ID);
+		GPUMemoryTracker::UntrackTexture(Texture.ID);
+		Texture = TextureHandle();
+	}
+
+	void OpenGLRenderDevice::UpdateTexture(const TextureHandle& Texture, uint32_t Level, uint32_t X, uint32_t Y, uint32_t Width, uint32_t Height, const void* Data)
+	{
+		const auto [PixelFormat, PixelType] = GetPixelFormat(Texture.Format);
+		GLStateCache::BindTexture(GL_TEXTURE_2D, Texture.ID);
+		glTexSubImage2D(GL_TEXTURE_2D, static_cast<GLint>(Level), static_cast<GLint>(X), static_cast<GLint>(Y),
+			static_cast<GLsizei>(Width), static_cast<GLsizei>(Height), PixelFormat, PixelType, Data);
+	}
+
+	TextureHandle OpenGLRenderDevice::CreateImageTexture(const ImageData& Image, const ImageTextureDesc& Desc)
+	{
+		const bool bCompressed = Image.CompressedFormat != 0;
+		TextureHandle Texture;
+		Texture.Type = Image.FaceCount == 6 ? TextureType::CubeMap : TextureType::Texture2D;
+		Texture.Format = bCompressed ? TextureFormat::Compressed : TextureFormat::RGBA8;
+		if (bCompressed)
+		{
+			const ImageData::Level& Base = Image.Levels[static_cast<size_t>(Desc.BaseLevel) * Image.FaceCount];
+			Texture.Width = static_cast<uint32_t>(Base.Width);
+			Texture.Height = static_cast<uint32_t>(Base.Height);
+		}
+		else
+		{
+			Texture.Width = static_cast<uint32_t>(Image.Width);
+			Texture.Height = static_cast<uint32_t>(Image.Height);
+		}
+
+		const GLenum Target = GetTarget(Texture.Type);
+		glGenTextures(1, &Texture.ID);
+		GLStateCache::BindTexture(Target, Texture.ID);
+		UploadImagePixels(Image, Target, Desc.BaseLevel);
+		SetTextureParameters(Target, Desc.Sampler);
+
+		// Immutable storage only holds the levels from BaseLevel, which becomes its level 0
+		const int StorageBase = GLExtensions::HasTextureStorage() ? 0 : Desc.BaseLevel;
+		glTexParameteri(Target, GL_TEXTURE_BASE_LEVEL, StorageBase);
+		if (bCompressed)
+		{
+			// The mip chain comes from the file, a short chain must not leave the texture incomplete.
+			// Cube maps keep their prefiltered levels, generating mipmaps would overwrite them
+			const int LevelCount = static_cast<int>(Image.Levels.size()) / Image.FaceCount;
+			glTexParameteri(Target, GL_TEXTURE_MAX_LEVEL, LevelCount - 1 - (Desc.BaseLevel - StorageBase));
+		}
+		else
+		{
+			// Generated levels stop at 1x1, counted from the base level
+			const int Size = std::max(Image.Width, Image.Height);
+			const int GeneratedLevels = static_cast<int>(std::floor(std::log2(std::max(Size, 1))));
+			glTexParameteri(Target, GL_TEXTURE_MAX_LEVEL, StorageBase + GeneratedLevels);
+			MipGenerator::Generate(Texture.ID, Target);
+		}
+		GLStateCache::BindTexture(Target, 0);
+		GPUMemoryTracker::TrackTexture(Texture.ID, GetImageStorageSize(Image, Desc.BaseLevel), Desc.Category, Desc.Owner);
+		return Texture;
+	}
+
+	TextureHandle OpenGLRenderDevice::CreateCubeTexture(std::span<const ImageData, 6> Faces, const ImageTextureDesc& Desc)
+	{
+		TextureHandle Texture;
+		Texture.Type = TextureType::CubeMap;
+		Texture.Width = static_cast<uint32_t>(Faces[0].Width);
+		Texture.Height = static_cast<uint32_t>(Faces[0].Height);
+
+		glGenTextures(1, &Texture.ID);
+		GLStateCache::BindTexture(GL_TEXTURE_CUBE_MAP, Texture.ID);
+
+		// The six faces share one immutable allocation, their pixels are then uploaded into it
+		if (GLExtensions::HasTextureStorage())
+		{
+			GLExtensions::TexStorage2D(GL_TEXTURE_CUBE_MAP, 1, GL_RGBA8, Faces[0].Width, Faces[0].Height);
+		}
+
+		uint64_t StorageSize = 0;
+		for (size_t Face = 0; Face < Faces.size(); Face++)
+		{
+			UploadImagePixels(Faces[Face], GL_TEXTURE_CUBE_MAP_POSITIVE_X + static_cast<GLenum>(Face));
+			StorageSize += GPUMemoryTracker::GetTextureSize(GetImageFormat(Faces[Face]), Faces[Face].Width, Faces[Face].Height);
+		}
+		SetTextureParameters(GL_TEXTURE_CUBE_MAP, Desc.Sampler);
+		GLStateCache::BindTexture(GL_TEXTURE_CUBE_MAP, 0);
+		GPUMemoryTracker::TrackTexture(Texture.ID, StorageSize, Desc.Category, Desc.Owner);
+		return Texture;
+	}
+
+	SamplerHandle OpenGLRenderDevice::GetSampler(const SamplerState& State)
+	{
+		return { SamplerCache::Get(State) };
+	}
+
+	void OpenGLRenderDevice::BindTexture(uint32_t Slot, const TextureHandle& Texture, SamplerHandle Sampler)
+	{
+		GLStateCache::BindTextureUnit(Slot, GetTarget(Texture.Type), Texture.ID, Sampler.ID);
+	}
+
+	ProgramHandle OpenGLRenderDevice::CreateProgram()
+	{
+		return { glCreateProgram() };
+	}
+
+	uint32_t OpenGLRenderDevice::CompileShaderStage(ShaderStage Stage, const char* Code)
+	{
+		const GLuint Shader = glCreateShader(GetShaderType(Stage));
+		glShaderSource(Shader, 1, &Code, nullptr);
+		glCompileShader(Shader);
+		return Shader;
+	}
+
+	void OpenGLRenderDevice::LinkProgram(const ProgramHandle& Program, std::span<const uint32_t> Stages, std::span<const char* const> Varyings)
+	{
+		for (uint32_t Stage : Stages)
+		{
+			if (Stage != 0)
+			{
+				glAttachShader(Program.ID, Stage);
+			}
+		}
+		if (!Varyings.empty())
+		{
+			glTransformFeedbackVaryings(Program.ID, static_cast<GLsizei>(Varyings.size()), Varyings.data(), GL_INTERLEAVED_ATTRIBS);
+		}
+
+		// Lets the ShaderCache read the binary back once linked
+		glProgramParameteri(Program.ID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+		glLinkProgram(Program.ID);
+	}
+
+	void OpenGLRenderDevice::ReleaseShaderStage(const ProgramHandle& Program, uint32_t& Stage)
+	{
+		if (Stage == 0)
+			return;
+
+		glDetachShader(Program.ID, Stage);
+		glDeleteShader(Stage);
+		Stage = 0;
+	}
+
+	void OpenGLRenderDevice::DestroyProgram(ProgramHandle& Program)
+	{
+		if (!Program)
+			return;
+
+		glDeleteProgram(Program.ID);
+		GLStateCache::OnProgramDeleted(Program.ID);
+		Program = ProgramHandle();
+	}
+
+	void OpenGLRenderDevice::BindProgram(const ProgramHandle& Program)
+	{
+		GLStateCache::UseProgram(Program.ID);
+	}
+
+	void OpenGLRenderDevice::BindPipeline(const PipelineState& State)
+	{
+		if (State.Program)
+		{
+			State.Program->Activate();
+		}
+		GLStateCache::ApplyRasterState(State.Raster);
+	}
+
+	VertexArrayHandle OpenGLRenderDevice::CreateVertexArray(std::string_view Label)
+	{
+		// A vertex array only exists once bound, the label needs it to
+		VertexArrayHandle VertexArray;
+		glGenVertexArrays(1, &VertexArray.ID);
+		GLStateCache::BindVertexArray(VertexArray.ID);
+		FGL_GL_LABEL(GL_VERTEX_ARRAY, VertexArray.ID, Label)
+		return VertexArray;
+	}
+
+	void OpenGLRenderDevice::DestroyVertexArray(VertexArrayHandle& VertexArray)
+	{
+		if (!VertexArray)
+			return;
+
+		glDeleteVertexArrays(1, &VertexArray.ID);
+		GLStateCache::OnVertexArrayDeleted(VertexArray.ID);
+		VertexArray = VertexArrayHandle();
+	}
+
+	void OpenGLRenderDevice::SetIndexBuffer(const VertexArrayHandle& VertexArray, const BufferHandle& Buffer)
+	{
+		// The element buffer binding is part of the vertex array
+		GLStateCache::BindVertexArray(VertexArray.ID);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, Buffer.ID);
+	}
+
+	void OpenGLRenderDevice::SetVertexAttributes(const VertexArrayHandle& VertexArray, const BufferHandle& Buffer, uint32_t Stride, uint32_t Divisor,
+		std::span<const VertexAttribute> Attributes)
+	{
+		// Attribute pointers capture the buffer bound to GL_ARRAY_BUFFER when they are set
+		GLStateCache::BindVertexArray(VertexArray.ID);
+		GLStateCache::BindBuffer(GL_ARRAY_BUFFER, Buffer.ID);
+		for (const VertexAttribute& Attribute : Attributes)
+		{
+			const GLint Components = static_cast<GLint>(Attribute.Components);
+			const GLenum Type = GetAttributeType(Attribute.Type);
+			const void* Offset = reinterpret_cast<const void*>(Attribute.Offset);
+			glEnableVertexAttribArray(Attribute.Location);
+			if (Attribute.bInteger)
+			{
+				glVertexAttribIPointer(Attribute.Location, Components, Type, static_cast<GLsizei>(Stride), Offset);
+			}
+			else
+			{
+				glVertexAttribPointer(Attribute.Location, Components, Type, Attribute.bNormalized ? GL_TRUE : GL_FALSE, static_cast<GLsizei>(Stride), Offset);
+			}
+			glVertexAttribDivisor(Attribute.Location, Divisor);
+		}
+	}
+
+	void OpenGLRenderDevice::BindVertexArray(const VertexArrayHandle& VertexArray)
+	{
+		GLStateCache::BindVertexArray(VertexArray.ID);
+	}
+
+	bool OpenGLRenderDevice::SupportsBaseInstance() const
+	{
+		static const bool bSupported = GLAD_GL_VERSION_4_2 != 0;
+		return bSupported;
+	}
+
+	void OpenGLRenderDevice::DrawIndexed(const IndexedDraw& Draw)
+	{
+		const bool bShortIndices = Draw.Format == IndexFormat::UInt16;
+		const GLenum IndexType = bShortIndices ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+		const size_t IndexWidth = bShortIndices ? sizeof(uint16_t) : sizeof(uint32_t);
+		const void* IndexOffset = reinterpret_cast<const void*>(Draw.FirstIndex * IndexWidth);
+		const GLsizei Count = static_cast<GLsizei>(Draw.IndexCount);
+		const GLsizei Instances = static_cast<GLsizei>(Draw.InstanceCount);
+
+		// The base instance entry point needs OpenGL 4.2, draws from instance 0 keep to 4.1
+		if (Draw.BaseInstance != 0)
+		{
+			glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, Count, IndexType, IndexOffset, Instances, Draw.BaseVertex, Draw.BaseInstance);
+		}
+		else
+		{
+			glDrawElementsInstancedBaseVertex(GL_TRIANGLES, Count, IndexType, IndexOffset, Instances, Draw.BaseVertex);
+		}
+	}
+
+	void OpenGLRenderDevice::Draw(uint32_t VertexCount, uint32_t InstanceCount, uint32_t FirstVertex)
+	{
+		glDrawArraysInstanced(GL_TRIANGLES, static_cast<GLint>(FirstVertex), static_cast<GLsizei>(VertexCount), static_cast<GLsizei>(InstanceCount));
+	}
+
+	void OpenGLRenderDevice::ExecuteCommands(RenderCommandPacket Commands)
+	{
+		size_t InstanceCount = 1;
+		size_t BaseInstance = 0;
+		for (const RenderCommand& Command : Commands)
+		{
+			switch (Command.Type)
+			{
+			case RenderCommandType::BindShader:
+				Command.Program->Activate();
+				Material::InvalidateActiveMaterial();
+				GLStateCache::ResetRasterState();
+				break;
+			case RenderCommandType::BindMaterial:
+				Command.BoundMaterial->Activate();
+				break;
+			case RenderCommandType::SetInstanceRange:
+				InstanceCount = Command.InstanceCount;
+				BaseInstance = Command.BaseInstance;
+				break;
+			case RenderCommandType::DrawMesh:
+				Command.Mesh->Draw(InstanceCount, BaseInstance, Command.LOD);
+				break;
+			case RenderCommandType::DrawMeshInfo:
+				BaseMesh::Draw(*Command.DrawInfo, InstanceCount, BaseInstance);
+				break;
+			case RenderCommandType::DrawObject:
+				Command.Object->Render(InstanceCount, BaseInstance, Command.LOD);
+				break;
+			case RenderCommandType::Invoke:
+				GLStateCache::ResetRasterState();
+				Command.Function(Command.Data);
+				break;
+			case RenderCommandType::PushDebugGroup:
+				GLDebug::PushGroup(Command.Label);
+				break;
+			case RenderCommandType::PopDebugGroup:
+				GLDebug::PopGroup();
+				break;
+			}
+		}
+	}
+
+	FenceHandle OpenGLRenderDevice::InsertFence()
+	{
+		FenceHandle Fence;
+		Fence.Sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		return Fence;
+	}
+
+	void OpenGLRenderDevice::WaitFence(FenceHandle& Fence)
+	{
+		if (!Fence)
+			return;
+
+		// The first check flushes without waiting, the loop only spins when the GPU is behind
+		const GLsync Sync = static_cast<GLsync>(Fence.Sync);
+		GLenum Result = glClientWaitSync(Sync, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+		while (Result == GL_TIMEOUT_EXPIRED)
+		{
+			Result = glClientWaitSync(Sync, GL_SYNC_FLUSH_COMMANDS_BIT, 1'000'000);
+		}
+		LOG_ASSERT(Result != GL_WAIT_FAILED, "Failed waiting on a fence")
+
+		DestroyFence(Fence);
+	}
+
+	void OpenGLRenderDevice::DestroyFence(FenceHandle& Fence)
+	{
+		if (!Fence)
+			return;
+
+		glDeleteSync(static_cast<GLsync>(Fence.Sync));
+		Fence = FenceHandle();
+	}
+
+	GLenum OpenGLRenderDevice::GetUsage(BufferUsage Usage)
+	{
+		switch (Usage)
+		{
+		case BufferUsage::Dynamic:
+			return GL_DYNAMIC_DRAW;
+		case BufferUsage::Stream:
+			return GL_STREAM_DRAW;
+		default:
+			return GL_STATIC_DRAW;
+		}
+	}
+
+	GLenum OpenGLRenderDevice::GetInternalFormat(TextureFormat Format)
+	{
+		switch (Format)
+		{
+		case TextureFormat::RGBA16F:
+			return GL_RGBA16F;
+		case TextureFormat::R32F:
+			return GL_R32F;
+		case TextureFormat::Depth32F:
+			return GL_DEPTH_COMPONENT32F;
+		default:
+			return GL_RGBA8;
+		}
+	}
+
+	std::pair<GLenum, GLenum> OpenGLRenderDevice::GetPixelFormat(TextureFormat Format)
+	{
+		switch (Format)
+		{
+		case TextureFormat::RGBA16F:
+			return { GL_RGBA, GL_HALF_FLOAT };
+		case TextureFormat::R32F:
+			return { GL_RED, GL_FLOAT };
+		case TextureFormat::Depth32F:
+			return { GL_DEPTH_COMPONENT, GL_FLOAT };
+		default:
+			return { GL_RGBA, GL_UNSIGNED_BYTE };
+		}
+	}
+
+	GLenum OpenGLRenderDevice::GetTarget(TextureType Type)
+	{
+		switch (Type)
+		{
+		case TextureType::CubeMap:
+			return GL_TEXTURE_CUBE_MAP;
+		case TextureType::Array2D:
+			return GL_TEXTURE_2D_ARRAY;
+		default:
+			return GL_TEXTURE_2D;
+		}
+	}
+
+	GLenum OpenGLRenderDevice::GetShaderType(ShaderStage Stage)
+	{
+		switch (Stage)
+		{
+		case ShaderStage::Fragment:
+			return GL_FRAGMENT_SHADER;
+		case ShaderStage::Geometry:
+			return GL_GEOMETRY_SHADER;
+		case ShaderStage::TessControl:
+			return GL_TESS_CONTROL_SHADER;
+		case ShaderStage::TessEvaluation:
+			return GL_TESS_EVALUATION_SHADER;
+		case ShaderStage::Compute:
+			return GL_COMPUTE_SHADER;
+		default:
+			return GL_VERTEX_SHADER;
+		}
+	}
+
+	GLenum OpenGLRenderDevice::GetAttributeType(VertexAttributeType Type)
+	{
+		switch (Type)
+		{
+		case VertexAttributeType::HalfFloat:
+			return GL_HALF_FLOAT;
+		case VertexAttributeType::Int2101010:
+			return GL_INT_2_10_10_10_REV;
+		case VertexAttributeType::UnsignedByte:
+			return GL_UNSIGNED_BYTE;
+		case VertexAttributeType::UnsignedShort:
+			return GL_UNSIGNED_SHORT;
+		case VertexAttributeType::UnsignedInt:
+			return GL_UNSIGNED_INT;
+		default:
+			return GL_FLOAT;
+		}
+	}
+
+	GLenum OpenGLRenderDevice::GetImageFormat(const ImageData& Image)
+	{
+		// Immutable storage holds 3-channel pixels as RGBA8, which drivers pad RGB8 to anyway and compute shaders can write
+		return (Image.Channels == 3 && !GLExtensions::HasTextureStorage()) ? GL_RGB8 : GL_RGBA8;
+	}
+
+	uint64_t OpenGLRenderDevice::GetImageStorageSize(const ImageData& Image, int BaseLevel)
+	{
+		// Compressed images bring their mip chain, uncompressed ones get a full chain from the MipGenerator
+		if (Image.CompressedFormat == 0)
+			return GPUMemoryTracker::GetTextureSize(GetImageFormat(Image), Image.Width, Image.Height, 1, GPUMemoryTracker::GetMipLevelCount(Image.Width, Image.Height));
+
+		uint64_t Bytes = 0;
+		for (size_t Level = static_cast<size_t>(BaseLevel) * Image.FaceCount; Level < Image.Levels.size(); Level++)
+		{
+			Bytes += Image.Levels[Level].Size;
+		}
+		return Bytes;
+	}
+
+	void OpenGLRenderDevice::SetTextureParameters(GLenum Target, const SamplerState& Sampler)
+	{
+		glTexParameteri(Target, GL_TEXTURE_WRAP_S, static_cast<GLint>(Sampler.WrapS));
+		glTexParameteri(Target, GL_TEXTURE_WRAP_T, static_cast<GLint>(Sampler.WrapT));
+		glTexParameteri(Target, GL_TEXTURE_WRAP_R, static_cast<GLint>(Sampler.WrapR));
+
+		glTexParameteri(Target, GL_TEXTURE_MIN_FILTER, static_cast<GLint>(Sampler.MinFilter));
+		glTexParameteri(Target, GL_TEXTURE_MAG_FILTER, static_cast<GLint>(Sampler.MagFilter));
+	}
+
+	void OpenGLRenderDevice::UploadImagePixels(const ImageData& Image, GLenum Target, int BaseLevel, bool bStaged)
+	{
+		// Immutable storage only holds the levels from BaseLevel, which becomes its level 0
+		const bool bImmutable = GLExtensions::HasTextureStorage();
+		const int StorageBase = bImmutable ? BaseLevel : 0;
+		if (Image.CompressedFormat != 0)
+		{
+			// Stage the span covering every level at once, the levels are then read at their offset in it
+			size_t Begin = SIZE_MAX, End = 0;
+			const size_t First = static_cast<size_t>(BaseLevel) * Image.FaceCount;
+			for (size_t Level = First; Level < Image.Levels.size(); Level++)
+			{
+				Begin = std::min(Begin, Image.Levels[Level].Offset);
+				End = std::max(End, Image.Levels[Level].Offset + Image.Levels[Level].Size);
+			}
+			if (Begin >= End)
+				return;
+
+			if (bImmutable)
+			{
+				const ImageData::Level& Base = Image.Levels[First];
+				const GLsizei LevelCount = static_cast<GLsizei>(Image.Levels.size() / Image.FaceCount) - BaseLevel;
+				GLExtensions::TexStorage2D(Image.FaceCount > 1 ? GL_TEXTURE_CUBE_MAP : Target, LevelCount, Image.CompressedFormat, Base.Width, Base.Height);
+			}
+
+			const unsigned char* Source = bStaged
+				? static_cast<const unsigned char*>(PixelUploadPool::Stage(Image.Pixels.get() + Begin, End - Begin))
+				: Image.Pixels.get() + Begin;
+			for (size_t Index = First; Index < Image.Levels.size(); Index++)
+			{
+				const ImageData::Level& Mip = Image.Levels[Index];
+				const GLenum FaceTarget = Image.FaceCount > 1 ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + static_cast<GLenum>(Index % Image.FaceCount) : Target;
+				const GLint Level = static_cast<GLint>(Index / Image.FaceCount) - StorageBase;
+				if (bImmutable)
+				{
+					glCompressedTexSubImage2D(FaceTarget, Level, 0, 0, Mip.Width, Mip.Height, Image.CompressedFormat,
+						static_cast<GLsizei>(Mip.Size), Source + (Mip.Offset - Begin));
+				}
+				else
+				{
+					glCompressedTexImage2D(FaceTarget, Level, Image.CompressedFormat, Mip.Width, Mip.Height, 0,
+						static_cast<GLsizei>(Mip.Size), Source + (Mip.Offset - Begin));
+				}
+			}
+			if (bStaged)
+			{
+				PixelUploadPool::EndUpload();
+			}
+			return;
+		}
+
+		GLenum Format = (Image.Channels == 3) ? GL_RGB : GL_RGBA;
+		const size_t Size = static_cast<size_t>(Image.Width) * Image.Height * Image.Channels;
+		const void* Source = bStaged ? PixelUploadPool::Stage(Image.Pixels.get(), Size) : Image.Pixels.get();
+		if (bImmutable)
+		{
+			// Cube faces are uploaded into the storage CreateCubeTexture() allocated for the six of them
+			if (Target == GL_TEXTURE_2D)
+			{
+				GLExtensions::TexStorage2D(GL_TEXTURE_2D, GPUMemoryTracker::GetMipLevelCount(Image.Width, Image.Height), GetImageFormat(Image),
+					Image.Width, Image.Height);
+			}
+			glTexSubImage2D(Target, 0, 0, 0, Image.Width, Image.Height, Format, GL_UNSIGNED_BYTE, Source);
+		}
+		else
+		{
+			glTexImage2D(Target, BaseLevel, Format, Image.Width, Image.Height, 0, Format, GL_UNSIGNED_BYTE, Source);
+		}
+		if (bStaged)
+		{
+			PixelUploadPool::EndUpload();
+		}
+	}
+
+} // namespace fgl
@@ -0,0 +1,169 @@
+#include <FireGL/Renderer/OverlapSystem.h>
+#include <FireGL/Renderer/SceneObject.h>
+#include <FireGL/Renderer/Transform.h>
+#include <FireGL/Core/Profiler.h>
+#include <FireGL/Core/BaseLog.h>
+
+namespace fgl
+{
+
+	OverlapSystem::Pair OverlapSystem::MakePair(SceneObject* A, SceneObject* B)
+	{
+		return A < B ? Pair(A, B) : Pair(B, A);
+	}
+
+	void OverlapSystem::Add(SceneObject* Object)
+	{
+		LOG_ASSERT(Object->GetOverlapProxy() == InvalidProxy, "The object is already registered for overlap events")
+
+		const uint32_t Index = static_cast<uint32_t>(m_Proxies.size());
+		Proxy Registered;
+		Registered.Object = Object;
+		m_Proxies.push_back(Registered);
+		m_Order.push_back(Index);
+		Object->SetOverlapProxy(Index);
+	}
+
+	void OverlapSystem::Remove(SceneObject* Object)
+	{
+		const uint32_t Index = Object->GetOverlapProxy();
+		LOG_ASSERT(Index != InvalidProxy && Index < m_Proxies.size(), "The object isn't registered for overlap events")
+
+		// Swap-and-pop, the last proxy takes the freed index in the sort order too
+		const uint32_t Last = static_cast<uint32_t>(m_Proxies.size() - 1);
+		if (Index != Last)
+		{
+			m_Proxies[Index] = m_Proxies[Last];
+			m_Proxies[Index].Object->SetOverlapProxy(Index);
+		}
+		m_Proxies.pop_back();
+		Object->SetOverlapProxy(InvalidProxy);
+
+		m_Order.erase(std::remove(m_Order.begin(), m_Order.end(), Index), m_Order.end());
+		for (uint32_t& Ordered : m_Order)
+		{
+			Ordered = Ordered == Last ? Index : Ordered;
+		}
+
+		std::vector<Pair> Ended;
+		m_Pairs.erase(std::remove_if(m_Pairs.begin(), m_Pairs.end(), [Object, &Ended, this](const Pair& Overlap)
+		{
+			if (Overlap.first != Object && Overlap.second != Object)
+				return false;
+
+			// Removed from a begin event of Update(), the pairs whose begin is still to come never started
+			if (!std::binary_search(m_Begun.begin() + m_BeginCursor, m_Begun.end(), Overlap))
+			{
+				Ended.push_back(Overlap);
+			}
+			return true;
+		}), m_Pairs.end());
+
+		for (const Pair& Overlap : Ended)
+		{
+			Overlap.first->OnOverlapEnd(Overlap.second);
+			Overlap.second->OnOverlapEnd(Overlap.first);
+		}
+	}
+
+	void OverlapSystem::Update()
+	{
+		FGL_PROFILE_SCOPE("OverlapSystem::Update")
+
+		// GetModelMatrix() recalculates dirty transforms, bumping their revision past the cached one
+		for (Proxy& Registered : m_Proxies)
+		{
+			Transform& ObjectTransform = Registered.Object->GetTransform();
+			const glm::mat4& ModelMatrix = ObjectTransform.GetModelMatrix();
+			if (Registered.Revision == ObjectTransform.GetRevision())
+				continue;
+
+			Registered.Box = Registered.Object->GetLocalBoundingBox().Transformed(ModelMatrix);
+			Registered.Revision = ObjectTransform.GetRevision();
+		}
+
+		// Insertion sort of last frame's order, near linear while the objects move little from frame to frame
+		for (size_t Index = 1; Index < m_Order.size(); Index++)
+		{
+			const uint32_t Current = m_Order[Index];
+			const float Key = m_Proxies[Current].Box.Min.x;
+			size_t Slot = Index;
+			while (Slot > 0 && m_Proxies[m_Order[Slot - 1]].Box.Min.x > Key)
+			{
+				m_Order[Slot] = m_Order[Slot - 1];
+				Slot--;
+			}
+			m_Order[Slot] = Current;
+		}
+
+		// Sweep along X: only the boxes starting before the end of the current one can overlap it. Empty boxes
+		// start at the largest float and end at the lowest, they sort last and never overlap
+		m_NewPairs.clear();
+		for (size_t Index = 0; Index < m_Order.size(); Index++)
+		{
+			const Proxy& Current = m_Proxies[m_Order[Index]];
+			for (size_t Next = Index + 1; Next < m_Order.size(); Next++)
+			{
+				const Proxy& Candidate = m_Proxies[m_Order[Next]];
+				if (Candidate.Box.Min.x > Current.Box.Max.x)
+					break;
+
+				if (Current.Box.Overlaps(Candidate.Box))
+				{
+					m_NewPairs.push_back(MakePair(Current.Object, Candidate.Object));
+				}
+			}
+		}
+		std::sort(m_NewPairs.begin(), m_NewPairs.end());
+
+		m_Begun.clear();
+		m_Ended.clear();
+		std::set_difference(m_NewPairs.begin(), m_NewPairs.end(), m_Pairs.begin(), m_Pairs.end(), std::back_inserter(m_Begun));
+		std::set_difference(m_Pairs.begin(), m_Pairs.end(), m_NewPairs.begin(), m_NewPairs.end(), std::back_inserter(m_Ended));
+		m_Pairs.swap(m_NewPairs);
+
+		// The handlers may unregister objects, Remove() then ends their pairs itself
+		m_BeginCursor = 0;
+		for (const Pair& Overlap : m_Ended)
+		{
+			Overlap.first->OnOverlapEnd(Overlap.second);
+			Overlap.second->OnOverlapEnd(Overlap.first);
+		}
+		while (m_BeginCursor < m_Begun.size())
+		{
+			const Pair Overlap = m_Begun[m_BeginCursor++];
+			if (Overlap.first->GetOverlapProxy() == InvalidProxy || Overlap.second->GetOverlapProxy() == InvalidProxy)
+				continue;
+
+			Overlap.first->OnOverlapBegin(Overlap.second);
+			Overlap.second->OnOverlapBegin(Overlap.first);
+		}
+	}
+
+	void OverlapSystem::QueryOverlaps(const SceneObject* Object, std::vector<SceneObject*>& OutObjects) const
+	{
+		OutObjects.clear();
+		for (const Pair& Overlap : m_Pairs)
+		{
+			if (Overlap.first == Object)
+			{
+				OutObjects.push_back(Overlap.second);
+			}
+			else if (Overlap.second == Object)
+			{
+				OutObjects.push_back(Overlap.first);
+			}
+		}
+	}
+
+	size_t OverlapSystem::GetProxyCount() const
+	{
+		return m_Proxies.size();
+	}
+
+	size_t OverlapSystem::GetPairCount() const
+	{
+		return m_Pairs.size();
+	}
+
+} // namespace fgl
@@ -0,0 +1,623 @@
+#include <FireGL/Renderer/ParticleSystem.h>
+#include <FireGL/Renderer/Texture.h>
+#include <FireGL/Renderer/Material.h>
+#include <FireGL/Renderer/GLStateCache.h>
+#include <FireGL/Renderer/GPUMemoryTracker.h>
+#include <FireGL/Renderer/RenderStats.h>
+#include <FireGL/Core/BaseLog.h>
+
+namespace fgl
+{
+
+	float ParticleSystem::s_EmissionScale = 1.0f;
+
+	namespace
+	{
+		constexpr GLuint WorkgroupSize = 256;
+		constexpr GLintptr DispatchOffset = 8;  ///< Offset of GroupsX in the state buffer.
+		constexpr GLintptr DrawOffset = 20;     ///< Offset of VertexCount in the state buffer.
+		constexpr GLsizeiptr StateSize = 36;    ///< Size of ParticleStateData.
+		constexpr GLsizeiptr ParticleSize = 32; ///< Size of a particle record: two vec4.
+
+		constexpr std::string_view ComputeHeaderCode = R"(#version 430 core
+layout (local_size_x = 256) in;
+)";
+
+		constexpr std::string_view TransformFeedbackHeaderCode = R"(#version 410 core
+)";
+
+		// Spawning and motion, shared by the compute shaders and the transform feedback program
+		constexpr std::string_view SimulationCode = R"(
+uniform float DeltaTime;
+uniform uint Seed;
+uniform vec3 Position;
+uniform float SpawnRadius;
+uniform vec3 Velocity;
+uniform float VelocitySpread;
+uniform vec3 Acceleration;
+uniform float Drag;
+uniform float MinLifetime;
+uniform float MaxLifetime;
+
+uint Hash(uint X)
+{
+    X ^= X >> 16;
+    X *= 0x7feb352du;
+    X ^= X >> 15;
+    X *= 0x846ca68bu;
+    X ^= X >> 16;
+    return X;
+}
+
+float Random(inout uint State)
+{
+    State = Hash(State);
+    return float(State >> 8) * (1.0 / 16777216.0);
+}
+
+// Uniform in the unit ball: a uniform direction, scaled by the cube root of a uniform number
+vec3 RandomInSphere(inout uint State)
+{
+    float Z = Random(State) * 2.0 - 1.0;
+    float Phi = Random(State) * 6.28318530718;
+    float Radius = pow(Random(State), 1.0 / 3.0);
+    return vec3(sqrt(1.0 - Z * Z) * vec2(cos(Phi), sin(Phi)), Z) * Radius;
+}
+
+void Spawn(uint Index, out vec4 PositionAge, out vec4 VelocityLifetime)
+{
+    uint State = Hash(Index ^ Hash(Seed));
+    PositionAge = vec4(Position + RandomInSphere(State) * SpawnRadius, 0.0);
+    VelocityLifetime = vec4(Velocity + RandomInSphere(State) * VelocitySpread, mix(MinLifetime, MaxLifetime, Random(State)));
+}
+
+// Returns false once the particle outlived its lifetime
+bool Advance(inout vec4 PositionAge, inout vec4 VelocityLifetime)
+{
+    PositionAge.w += DeltaTime;
+    if (PositionAge.w >= VelocityLifetime.w)
+        return false;
+
+    vec3 NewVelocity = (VelocityLifetime.xyz + Acceleration * DeltaTime) * max(1.0 - Drag * DeltaTime, 0.0);
+    PositionAge.xyz += NewVelocity * DeltaTime;
+    VelocityLifetime.xyz = NewVelocity;
+    return true;
+}
+)";
+
+		// Must match the particle records and the state buffer offsets above
+		constexpr std::string_view ComputeBuffersCode = R"(
+struct Particle
+{
+    vec4 PositionAge;
+    vec4 VelocityLifetime;
+};
+
+layout (std430, binding = 11) readonly buffer ParticleSourceData { Particle Sources[]; };
+layout (std430, binding = 12) writeonly buffer ParticleTargetData { Particle Targets[]; };
+layout (std430, binding = 13) coherent buffer ParticleStateData
+{
+    uint Alive[2];
+    uint GroupsX;
+    uint GroupsY;
+    uint GroupsZ;
+    uint VertexCount;
+    uint InstanceCount;
+    uint FirstVertex;
+    uint BaseInstance;
+};
+
+uniform uint Capacity;
+uniform uint SourceIndex;
+)";
+
+		// Survivors are appended to the target, in any order
+		constexpr std::string_view SimulateComputeCode = R"(
+void main()
+{
+    uint Index = gl_GlobalInvocationID.x;
+    if (Index >= Alive[SourceIndex])
+        return;
+
+    Particle Current = Sources[Index];
+    if (Advance(Current.PositionAge, Current.VelocityLifetime))
+    {
+        Targets[atomicAdd(Alive[1u - SourceIndex], 1u)] = Current;
+    }
+}
+)";
+
+		constexpr std::string_view EmitComputeCode = R"(
+uniform uint EmitCount;
+
+void main()
+{
+    uint Index = gl_GlobalInvocationID.x;
+    if (Index >= EmitCount)
+        return;
+
+    // Spawns past the capacity are dropped, the count is clamped afterwards
+    uint Slot = atomicAdd(Alive[1u - SourceIndex], 1u);
+    if (Slot >= Capacity)
+        return;
+
+    Particle Spawned;
+    Spawn(Index, Spawned.PositionAge, Spawned.VelocityLifetime);
+    Targets[Slot] = Spawned;
+}
+)";
+
+		// The target becomes the source of the next update, the current source its target
+		constexpr std::string_view CountComputeCode = R"(
+void main()
+{
+    if (gl_LocalInvocationIndex != 0u)
+        return;
+
+    uint Count = min(Alive[1u - SourceIndex], Capacity);
+    Alive[1u - SourceIndex] = Count;
+    Alive[SourceIndex] = 0u;
+    GroupsX = (Count + 255u) / 256u;
+    GroupsY = 1u;
+    GroupsZ = 1u;
+    VertexCount = 4u;
+    InstanceCount = Count;
+    FirstVertex = 0u;
+    BaseInstance = 0u;
+}
+)";
+
+		constexpr std::string_view SimulateVertexCode = R"(
+layout (location = 0) in vec4 aPositionAge;
+layout (location = 1) in vec4 aVelocityLifetime;
+
+uniform bool bEmit;
+
+out vec4 vPositionAge;
+out vec4 vVelocityLifetime;
+out float vAlive;
+
+void main()
+{
+    vPositionAge = aPositionAge;
+    vVelocityLifetime = aVelocityLifetime;
+    if (bEmit)
+    {
+        Spawn(uint(gl_VertexID), vPositionAge, vVelocityLifetime);
+        vAlive = 1.0;
+    }
+    else
+    {
+        vAlive = Advance(vPositionAge, vVelocityLifetime) ? 1.0 : 0.0;
+    }
+})";
+
+		// Only the surviving particles reach transform feedback
+		constexpr std::string_view SimulateGeometryCode = R"(#version 410 core
+layout (points) in;
+layout (points, max_vertices = 1) out;
+
+in vec4 vPositionAge[];
+in vec4 vVelocityLifetime[];
+in float vAlive[];
+
+out vec4 PositionAge;
+out vec4 VelocityLifetime;
+
+void main()
+{
+    if (vAlive[0] > 0.5)
+    {
+        PositionAge = vPositionAge[0];
+        VelocityLifetime = vVelocityLifetime[0];
+        EmitVertex();
+        EndPrimitive();
+    }
+})";
+
+		// Camera-facing quad corner, shared by the instanced vertex shader and the point expanding geometry shader
+		constexpr std::string_view BillboardCode = R"(
+layout (std140) uniform CameraData
+{
+    mat4 View;
+    mat4 Projection;
+    mat4 ViewProjection;
+} Camera;
+
+uniform float StartSize;
+uniform float EndSize;
+uniform vec4 StartColor;
+uniform vec4 EndColor;
+
+out vec2 TexCoord;
+out vec4 Color;
+
+void Billboard(vec4 PositionAge, vec4 VelocityLifetime, vec2 Corner)
+{
+    float T = clamp(PositionAge.w / VelocityLifetime.w, 0.0, 1.0);
+    vec3 Right = vec3(Camera.View[0][0], Camera.View[1][0], Camera.View[2][0]);
+    vec3 Up = vec3(Camera.View[0][1], Camera.View[1][1], Camera.View[2][1]);
+    vec3 WorldPosition = PositionAge.xyz + (Right * (Corner.x - 0.5) + Up * (Corner.y - 0.5)) * mix(StartSize, EndSize, T);
+    gl_Position = Camera.ViewProjection * vec4(WorldPosition, 1.0);
+    TexCoord = Corner;
+    Color = mix(StartColor, EndColor, T);
+}
+)";
+
+		constexpr std::string_view RenderInstancedVertexCode = R"(
+struct Particle
+{
+    vec4 PositionAge;
+    vec4 VelocityLifetime;
+};
+
+layout (std430, binding = 11) readonly buffer ParticleSourceData { Particle Sources[]; };
+
+void main()
+{
+    // 4-vertex strip: (0, 0), (1, 0), (0, 1), (1, 1)
+    Particle Current = Sources[gl_InstanceID];
+    Billboard(Current.PositionAge, Current.VelocityLifetime, vec2(gl_VertexID & 1, gl_VertexID >> 1));
+})";
+
+		constexpr std::string_view RenderPointVertexCode = R"(#version 410 core
+layout (location = 0) in vec4 aPositionAge;
+layout (location = 1) in vec4 aVelocityLifetime;
+
+out vec4 vPositionAge;
+out vec4 vVelocityLifetime;
+
+void main()
+{
+    vPositionAge = aPositionAge;
+    vVelocityLifetime = aVelocityLifetime;
+})";
+
+		constexpr std::string_view RenderPointGeometryCode = R"(
+layout (points) in;
+layout (triangle_strip, max_vertices = 4) out;
+
+in vec4 vPositionAge[];
+in vec4 vVelocityLifetime[];
+
+void main()
+{
+    for (int Corner = 0; Corner < 4; Corner++)
+    {
+        Billboard(vPositionAge[0], vVelocityLifetime[0], vec2(Corner & 1, Corner >> 1));
+        EmitVertex();
+    }
+    EndPrimitive();
+})";
+
+		constexpr std::string_view RenderFragmentCode = R"(#version 410 core
+in vec2 TexCoord;
+in vec4 Color;
+out vec4 FragColor;
+
+uniform sampler2D Sprite;
+uniform bool bSprite;
+uniform bool bAdditive;
+
+void main()
+{
+    vec4 Texel = bSprite ? texture(Sprite, TexCoord) : vec4(1.0, 1.0, 1.0, clamp(1.0 - length(TexCoord * 2.0 - 1.0), 0.0, 1.0));
+    vec4 Shaded = Color * Texel;
+    if (Shaded.a <= 0.0)
+        discard;
+
+    // Premultiplied: an alpha of 0 adds the color, an alpha of 1 covers what is behind
+    FragColor = vec4(Shaded.rgb * Shaded.a, bAdditive ? 0.0 : Shaded.a);
+})";
+
+		std::string Concatenate(std::initializer_list<std::string_view> Parts)
+		{
+			std::string Code;
+			for (std::string_view Part : Parts)
+			{
+				Code += Part;
+			}
+			return Code;
+		}
+
+		/** Creates a buffer of Size bytes holding Data, or uninitialized if null. */
+		GLuint CreateBuffer(GLenum Target, GLsizeiptr Size, const void* Data, GPUMemoryCategory Category)
+		{
+			GLuint Buffer;
+			glGenBuffers(1, &Buffer);
+			GLStateCache::BindBuffer(Target, Buffer);
+			glBufferData(Target, Size, Data, GL_DYNAMIC_COPY);
+			GPUMemoryTracker::TrackBuffer(Buffer, Size, Category, "ParticleSystem");
+			return Buffer;
+		}
+	}
+
+	ParticleSystem::~ParticleSystem()
+	{
+		Destroy();
+	}
+
+	void ParticleSystem::Create(uint32_t Capacity)
+	{
+		Destroy();
+		m_Capacity = Capacity;
+		m_Current = 0;
+		m_PendingEmission = 0.0f;
+		m_bSimulated = false;
+		m_bCompute = GLAD_GL_VERSION_4_3;
+		if (m_bCompute)
+		{
+			CreateCompute();
+		}
+		else
+		{
+			CreateTransformFeedback();
+		}
+	}
+
+	void ParticleSystem::CreateCompute()
+	{
+		for (GLuint& Buffer : m_Particles)
+		{
+			Buffer = CreateBuffer(GL_SHADER_STORAGE_BUFFER, m_Capacity * ParticleSize, nullptr, GPUMemoryCategory::Storage);
+		}
+
+		// No particle alive: no simulation group, no instance
+		const uint32_t InitialState[StateSize / sizeof(uint32_t)] = { 0, 0, 0, 1, 1, 4, 0, 0, 0 };
+		m_StateBuffer = CreateBuffer(GL_SHADER_STORAGE_BUFFER, StateSize, InitialState, GPUMemoryCategory::Indirect);
+		RenderCounters::CountUpload(StateSize);
+		glGenVertexArrays(1, &m_EmptyVertexArray);
+
+		m_SimulateShader = Shader::CreateComputeFromSource(Concatenate({ ComputeHeaderCode, SimulationCode, ComputeBuffersCode, SimulateComputeCode }));
+		m_EmitShader = Shader::CreateComputeFromSource(Concatenate({ ComputeHeaderCode, SimulationCode, ComputeBuffersCode, EmitComputeCode }));
+		m_CountShader = Shader::CreateComputeFromSource(Concatenate({ ComputeHeaderCode, ComputeBuffersCode, CountComputeCode }));
+		m_RenderShader = Shader::CreateFromSource(Concatenate({ "#version 430 core\n", BillboardCode, RenderInstancedVertexCode }), RenderFragmentCode);
+	}
+
+	void ParticleSystem::CreateTransformFeedback()
+	{
+		glGenTransformFeedbacks(2, m_Feedback);
+		glGenVertexArrays(2, m_ParticleArrays);
+		for (uint32_t Index = 0; Index < 2; Index++)
+		{
+			m_Particles[Index] = CreateBuffer(GL_ARRAY_BUFFER, m_Capacity * ParticleSize, nullptr, GPUMemoryCategory::Storage);
+
+			GLStateCache::BindVertexArray(m_ParticleArrays[Index]);
+			glEnableVertexAttribArray(0);
+			glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, ParticleSize, reinterpret_cast<void*>(0));
+			glEnableVertexAttribArray(1);
+			glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, ParticleSize, reinterpret_cast<void*>(ParticleSize / 2));
+
+			glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, m_Feedback[Index]);
+			glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, m_Particles[Index]);
+		}
+		glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, 0);
+		GLStateCache::BindVertexArray(0);
+
+		m_SimulateShader = Shader::CreateTransformFeedbackFromSource(Concatenate({ TransformFeedbackHeaderCode, SimulationCode, SimulateVertexCode }),
+			SimulateGeometryCode, { "PositionAge", "VelocityLifetime" });
+		m_RenderShader = Shader::CreateWithGeometryFromSource(RenderPointVertexCode,
+			Concatenate({ TransformFeedbackHeaderCode, BillboardCode, RenderPointGeometryCode }), RenderFragmentCode);
+	}
+
+	void ParticleSystem::Destroy()
+	{
+		for (GLuint* Buffer : { &m_Particles[0], &m_Particles[1], &m_StateBuffer })
+		{
+			if (*Buffer == 0)
+				continue;
+
+			glDeleteBuffers(1, Buffer);
+			GLStateCache::OnBufferDeleted(*Buffer);
+			GPUMemoryTracker::UntrackBuffer(*Buffer);
+			*Buffer = 0;
+		}
+		for (GLuint* VertexArray : { &m_ParticleArrays[0], &m_ParticleArrays[1], &m_EmptyVertexArray })
+		{
+			if (*VertexArray == 0)
+				continue;
+
+			glDeleteVertexArrays(1, VertexArray);
+			GLStateCache::OnVertexArrayDeleted(*VertexArray);
+			*VertexArray = 0;
+		}
+		if (m_Feedback[0] != 0)
+		{
+			glDeleteTransformFeedbacks(2, m_Feedback);
+			m_Feedback[0] = 0;
+			m_Feedback[1] = 0;
+		}
+		for (std::unique_ptr<Shader>* Program : { &m_SimulateShader, &m_EmitShader, &m_CountShader, &m_RenderShader })
+		{
+			if (*Program)
+			{
+				(*Program)->Cleanup();
+				Program->reset();
+			}
+		}
+		m_Capacity = 0;
+	}
+
+	bool ParticleSystem::IsCreated() const
+	{
+		return m_Particles[0] != 0;
+	}
+
+	bool ParticleSystem::UsesCompute() const
+	{
+		return m_bCompute;
+	}
+
+	void ParticleSystem::SetSettings(const ParticleSettings& Settings)
+	{
+		m_Settings = Settings;
+	}
+
+	const ParticleSettings& ParticleSystem::GetSettings() const
+	{
+		return m_Settings;
+	}
+
+	void ParticleSystem::SetSprite(const Texture* Sprite)
+	{
+		m_Sprite = Sprite;
+	}
+
+	void ParticleSystem::SetEmitting(bool bEmitting)
+	{
+		m_bEmitting = bEmitting;
+	}
+
+	void ParticleSystem::SetEmissionScale(float Scale)
+	{
+		s_EmissionScale = std::clamp(Scale, 0.0f, 1.0f);
+	}
+
+	float ParticleSystem::GetEmissionScale()
+	{
+		return s_EmissionScale;
+	}
+
+	void ParticleSystem::Update(float DeltaTime)
+	{
+		LOG_ASSERT(IsCreated(), "ParticleSystem::Update() called before Create()");
+
+		// Fractions of a particle are carried over, so low rates still spawn at high frame rates
+		uint32_t EmitCount = 0;
+		if (m_bEmitting)
+		{
+			const float Emission = m_PendingEmission + m_Settings.EmissionRate * s_EmissionScale * DeltaTime;
+			EmitCount = static_cast<uint32_t>(std::min(Emission, static_cast<float>(m_Capacity)));
+			m_PendingEmission = Emission - std::floor(Emission);
+		}
+		m_Seed++;
+
+		if (m_bCompute)
+		{
+			UpdateCompute(DeltaTime, EmitCount);
+		}
+		else
+		{
+			UpdateTransformFeedback(DeltaTime, EmitCount);
+		}
+		m_Current = 1 - m_Current;
+	}
+
+	void ParticleSystem::ApplySimulationUniforms(const Shader& Program, float DeltaTime) const
+	{
+		Program.SetFloat("DeltaTime", DeltaTime);
+		Program.SetUInt("Seed", m_Seed);
+		Program.SetVec3("Position", m_Settings.Position);
+		Program.SetFloat("SpawnRadius", m_Settings.SpawnRadius);
+		Program.SetVec3("Velocity", m_Settings.Velocity);
+		Program.SetFloat("VelocitySpread", m_Settings.VelocitySpread);
+		Program.SetVec3("Acceleration", m_Settings.Acceleration);
+		Program.SetFloat("Drag", m_Settings.Drag);
+		Program.SetFloat("MinLifetime", m_Settings.MinLifetime);
+		Program.SetFloat("MaxLifetime", m_Settings.MaxLifetime);
+		Program.SetUInt("Capacity", m_Capacity);
+		Program.SetUInt("SourceIndex", m_Current);
+	}
+
+	void ParticleSystem::UpdateCompute(float DeltaTime, uint32_t EmitCount)
+	{
+		// The binding points are shared with nothing else, but bound again in case the buffers swapped
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SourceBindingPoint, m_Particles[m_Current]);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, TargetBindingPoint, m_Particles[1 - m_Current]);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, StateBindingPoint, m_StateBuffer);
+
+		// As many groups as particles alive after the last update, written by the count pass
+		glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, m_StateBuffer);
+		m_SimulateShader->Activate();
+		ApplySimulationUniforms(*m_SimulateShader, DeltaTime);
+		glDispatchComputeIndirect(DispatchOffset);
+
+		// Both passes append with the same atomic counter, they need no barrier between them
+		if (EmitCount > 0)
+		{
+			m_EmitShader->Activate();
+			ApplySimulationUniforms(*m_EmitShader, DeltaTime);
+			m_EmitShader->SetUInt("EmitCount", EmitCount);
+			glDispatchCompute((EmitCount + WorkgroupSize - 1) / WorkgroupSize, 1, 1);
+		}
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+		m_CountShader->Activate();
+		m_CountShader->SetUInt("Capacity", m_Capacity);
+		m_CountShader->SetUInt("SourceIndex", m_Current);
+		glDispatchCompute(1, 1, 1);
+
+		// The next simulation and the draw read the commands, the vertex shader the particles
+		glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+	}
+
+	void ParticleSystem::UpdateTransformFeedback(float DeltaTime, uint32_t EmitCount)
+	{
+		const uint32_t Target = 1 - m_Current;
+		m_SimulateShader->Activate();
+		ApplySimulationUniforms(*m_SimulateShader, DeltaTime);
+
+		// Survivors first, then the spawns, appended by the same transform feedback; writes past the capacity are dropped
+		glEnable(GL_RASTERIZER_DISCARD);
+		GLStateCache::BindVertexArray(m_ParticleArrays[m_Current]);
+		glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, m_Feedback[Target]);
+		glBeginTransformFeedback(GL_POINTS);
+		if (m_bSimulated)
+		{
+			m_SimulateShader->SetBool("bEmit", false);
+			glDrawTransformFeedback(GL_POINTS, m_Feedback[m_Current]);
+		}
+		if (EmitCount > 0)
+		{
+			m_SimulateShader->SetBool("bEmit", true);
+			glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(EmitCount));
+		}
+		glEndTransformFeedback();
+		glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, 0);
+		glDisable(GL_RASTERIZER_DISCARD);
+
+		// The target now holds what was written, even nothing, and can be drawn by count
+		m_bSimulated = true;
+	}
+
+	void ParticleSystem::Render()
+	{
+		if (!IsCreated() || (!m_bCompute && !m_bSimulated))
+			return;
+
+		if (m_Sprite)
+		{
+			GLStateCache::BindTextureUnit(SpriteUnit, GL_TEXTURE_2D, m_Sprite->GetID());
+		}
+		m_RenderShader->Activate();
+		m_RenderShader->SetInt("Sprite", SpriteUnit);
+		m_RenderShader->SetBool("bSprite", m_Sprite != nullptr);
+		m_RenderShader->SetBool("bAdditive", m_Settings.bAdditive);
+		m_RenderShader->SetFloat("StartSize", m_Settings.StartSize);
+		m_RenderShader->SetFloat("EndSize", m_Settings.EndSize);
+		m_RenderShader->SetVec4("StartColor", m_Settings.StartColor);
+		m_RenderShader->SetVec4("EndColor", m_Settings.EndColor);
+
+		// Unsorted premultiplied blending: additive particles need no order, covering ones accept its errors
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+		GLStateCache::SetDepthWrite(false);
+		if (m_bCompute)
+		{
+			glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SourceBindingPoint, m_Particles[m_Current]);
+			GLStateCache::BindBuffer(GL_DRAW_INDIRECT_BUFFER, m_StateBuffer);
+			GLStateCache::BindVertexArray(m_EmptyVertexArray);
+			glDrawArraysIndirect(GL_TRIANGLE_STRIP, reinterpret_cast<const void*>(DrawOffset));
+		}
+		else
+		{
+			GLStateCache::BindVertexArray(m_ParticleArrays[m_Current]);
+			glDrawTransformFeedback(GL_POINTS, m_Feedback[m_Current]);
+		}
+		RenderCounters::CountDraw(1, 1);
+		GLStateCache::SetDepthWrite(true);
+		glDisable(GL_BLEND);
+		Material::InvalidateActiveMaterial();
+	}
+
+} // namespace fgl
@@ -0,0 +1,368 @@
+#include <FireGL/Renderer/PerformanceHUD.h>
+#include <FireGL/Renderer/Renderer.h>
+#include <FireGL/Renderer/GPUProfiler.h>
+#include <FireGL/Renderer/GPUMemoryTracker.h>
+#include <FireGL/Renderer/RenderDevice.h>
+#include <FireGL/Renderer/RenderStats.h>
+#include <FireGL/Core/MemoryTracker.h>
+#include <FireGL/Core/Profiler.h>
+
+#include <cstdarg>
+
+namespace fgl
+{
+
+	namespace
+	{
+		constexpr uint64_t TextInterval = 250'000'000;  ///< Nanoseconds between two rebuilds of the text.
+		constexpr float TargetFrameTime = 1000.0f / 60.0f; ///< Frame time drawn as a line over the graphs, in milliseconds.
+		constexpr uint32_t CellWidth = 6;               ///< Pixels of a cell of the built-in font, a 5 x 7 glyph and its spacing.
+		constexpr uint32_t CellHeight = 8;
+		constexpr uint32_t AtlasColumns = 16;           ///< The 96 printable ASCII characters, from ' ', in 16 x 6 cells.
+		constexpr uint32_t AtlasRows = 6;
+		constexpr uint32_t FirstCharacter = 32;
+
+		/** A glyph of the built-in font: 7 rows from the top, the leftmost pixel in bit 4. */
+		struct Glyph
+		{
+			char Character;
+			uint8_t Rows[7];
+		};
+
+		constexpr Glyph BuiltInGlyphs[] = {
+			{ '0', { 0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E } }, { '1', { 0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E } },
+			{ '2', { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F } }, { '3', { 0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E } },
+			{ '4', { 0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02 } }, { '5', { 0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E } },
+			{ '6', { 0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E } }, { '7', { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08 } },
+			{ '8', { 0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E } }, { '9', { 0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C } },
+			{ 'A', { 0x0E, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 } }, { 'B', { 0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E } },
+			{ 'C', { 0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E } }, { 'D', { 0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C } },
+			{ 'E', { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F } }, { 'F', { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10 } },
+			{ 'G', { 0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F } }, { 'H', { 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 } },
+			{ 'I', { 0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E } }, { 'J', { 0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C } },
+			{ 'K', { 0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11 } }, { 'L', { 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F } },
+			{ 'M', { 0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11 } }, { 'N', { 0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11 } },
+			{ 'O', { 0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E } }, { 'P', { 0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10 } },
+			{ 'Q', { 0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D } }, { 'R', { 0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11 } },
+			{ 'S', { 0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E } }, { 'T', { 0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 } },
+			{ 'U', { 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E } }, { 'V', { 0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04 } },
+			{ 'W', { 0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A } }, { 'X', { 0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11 } },
+			{ 'Y', { 0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04 } }, { 'Z', { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F } },
+			{ '.', { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C } }, { ',', { 0x00, 0x00, 0x00, 0x00, 0x0C, 0x04, 0x08 } },
+			{ ':', { 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00 } }, { '-', { 0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00 } },
+			{ '+', { 0x00, 0x04, 0x04, 0x1F, 0x04, 0x04, 0x00 } }, { '=', { 0x00, 0x00, 0x1F, 0x00, 0x1F, 0x00, 0x00 } },
+			{ '/', { 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00 } }, { '%', { 0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03 } },
+			{ '(', { 0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02 } }, { ')', { 0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08 } },
+			{ '<', { 0x02, 0x04, 0x08, 0x10, 0x08, 0x04, 0x02 } }, { '>', { 0x08, 0x04, 0x02, 0x01, 0x02, 0x04, 0x08 } },
+			{ '_', { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F } }, { '|', { 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 } },
+		};
+
+		/** Appends a formatted line to Text. */
+		void AppendLine(std::string& Text, const char* Format, ...)
+		{
+			char Line[128];
+			va_list Arguments;
+			va_start(Arguments, Format);
+			const int Length = std::vsnprintf(Line, sizeof(Line), Format, Arguments);
+			va_end(Arguments);
+			if (Length > 0)
+			{
+				Text.append(Line, std::min(static_cast<size_t>(Length), sizeof(Line) - 1));
+				Text += '\n';
+			}
+		}
+
+		/** Formats a counter in at most 6 characters, e.g. 950, 12.5K or 1.2M. */
+		const char* FormatCount(uint64_t Count, char (&Buffer)[16])
+		{
+			if (Count >= 10'000'000)
+				std::snprintf(Buffer, sizeof(Buffer), "%.1fM", static_cast<double>(Count) * 1e-6);
+			else if (Count >= 10'000)
+				std::snprintf(Buffer, sizeof(Buffer), "%.1fK", static_cast<double>(Count) * 1e-3);
+			else
+				std::snprintf(Buffer, sizeof(Buffer), "%llu", static_cast<unsigned long long>(Count));
+			return Buffer;
+		}
+
+		/** Mean and longest of the frames of a history, those never written being zero. */
+		void GetHistoryStats(const std::array<float, PerformanceHUD::HistoryLength>& History, float& Mean, float& Max)
+		{
+			float Sum = 0.0f;
+			size_t Count = 0;
+			Max = 0.0f;
+			for (const float Time : History)
+			{
+				if (Time <= 0.0f)
+					continue;
+				Sum += Time;
+				Max = std::max(Max, Time);
+				Count++;
+			}
+			Mean = Count > 0 ? Sum / static_cast<float>(Count) : 0.0f;
+		}
+
+		constexpr double ToMegabytes(uint64_t Bytes)
+		{
+			return static_cast<double>(Bytes) / (1024.0 * 1024.0);
+		}
+	}
+
+	PerformanceHUD::PerformanceHUD(Renderer& Target)
+		: m_Renderer(Target)
+	{
+	}
+
+	PerformanceHUD::~PerformanceHUD()
+	{
+		Destroy();
+	}
+
+	void PerformanceHUD::Initialize()
+	{
+		if (m_Font.Atlas != 0)
+			return;
+
+		// Lowercase characters get the uppercase glyphs, the others not in the table stay blank
+		const uint32_t Width = AtlasColumns * CellWidth;
+		const uint32_t Height = AtlasRows * CellHeight;
+		std::vector<uint32_t> Pixels(Width * Height, 0x00FFFFFF);
+		for (uint32_t Code = FirstCharacter; Code < FirstCharacter + AtlasColumns * AtlasRows; Code++)
+		{
+			const char Character = static_cast<char>(Code >= 'a' && Code <= 'z' ? Code - 'a' + 'A' : Code);
+			const auto Found = std::find_if(std::begin(BuiltInGlyphs), std::end(BuiltInGlyphs), [Character](const Glyph& Entry) { return Entry.Character == Character; });
+			if (Found == std::end(BuiltInGlyphs))
+				continue;
+
+			const uint32_t Cell = Code - FirstCharacter;
+			const uint32_t Left = (Cell % AtlasColumns) * CellWidth;
+			const uint32_t Top = (Cell / AtlasColumns) * CellHeight;
+			for (uint32_t Row = 0; Row < 7; Row++)
+			{
+				for (uint32_t Column = 0; Column < 5; Column++)
+				{
+					if (Found->Rows[Row] & (0x10 >> Column))
+					{
+						Pixels[(Top + Row) * Width + Left + Column] = 0xFFFFFFFF;
+					}
+				}
+			}
+		}
+
+		TextureDesc AtlasDesc;
+		AtlasDesc.Width = Width;
+		AtlasDesc.Height = Height;
+		AtlasDesc.Filter = TextureFilter::Nearest;
+		AtlasDesc.Wrap = TextureWrap::ClampToEdge;
+		AtlasDesc.Owner = "Performance HUD";
+		m_BuiltInAtlas = RenderDevice::Get().CreateTexture(AtlasDesc, Pixels.data());
+
+		m_Font.Atlas = m_BuiltInAtlas.ID;
+		m_Font.Columns = AtlasColumns;
+		m_Font.Rows = AtlasRows;
+		m_Font.FirstCharacter = FirstCharacter;
+		m_Font.CellAspect = static_cast<float>(CellWidth) / static_cast<float>(CellHeight);
+		m_Font.Spacing = 1.0f;
+	}
+
+	void PerformanceHUD::Destroy()
+	{
+		if (!m_BuiltInAtlas)
+			return;
+
+		if (m_Font.Atlas == m_BuiltInAtlas.ID)
+		{
+			m_Font = SpriteFont();
+		}
+		RenderDevice::Get().DestroyTexture(m_BuiltInAtlas);
+	}
+
+	void PerformanceHUD::SetVisible(bool bVisible)
+	{
+		if (bVisible == m_bVisible)
+			return;
+
+		m_bVisible = bVisible;
+		GPUProfiler& Profiler = m_Renderer.GetGPUProfiler();
+		if (!bVisible)
+		{
+			m_Renderer.SetGPUProfiling(m_bProfilingWasEnabled);
+			return;
+		}
+
+		// The graphs and averages start over, what was measured before the HUD was shown is stale
+		m_bProfilingWasEnabled = Profiler.IsEnabled();
+		m_Renderer.SetGPUProfiling(true);
+		Profiler.ResetStats();
+		m_GPUFramesRead = Profiler.GetFramesRead();
+		m_CPUTimes.fill(0.0f);
+		m_GPUTimes.fill(0.0f);
+		m_CPUHead = 0;
+		m_GPUHead = 0;
+		m_LastSample = 0;
+		m_LastText = 0;
+	}
+
+	bool PerformanceHUD::IsVisible() const
+	{
+		return m_bVisible;
+	}
+
+	void PerformanceHUD::Toggle()
+	{
+		SetVisible(!m_bVisible);
+	}
+
+	void PerformanceHUD::SetFont(const SpriteFont& Font)
+	{
+		m_Font = Font;
+	}
+
+	void PerformanceHUD::SetLoadingQueue(std::function<size_t()> Depth)
+	{
+		m_LoadingQueue = std::move(Depth);
+	}
+
+	void PerformanceHUD::SetLayout(const glm::vec2& Position, float LineHeight)
+	{
+		m_Position = Position;
+		m_LineHeight = std::max(LineHeight, 1.0f);
+	}
+
+	void PerformanceHUD::Record(SpriteBatch& Overlay, int Layer)
+	{
+		if (!m_bVisible)
+			return;
+
+		Sample();
+		const uint64_t Now = Profiler::Now();
+		if (m_LastText == 0 || Now - m_LastText >= TextInterval)
+		{
+			BuildText();
+			m_LastText = Now;
+		}
+
+		const float Padding = m_LineHeight * 0.5f;
+		const glm::vec2 Origin = m_Position + Padding;
+
+		// Recorded before the panel, whose size depends on it; the layers keep the panel behind
+		Overlay.SetLayer(Layer + 3);
+		float TextWidth = 0.0f;
+		float TextHeight = 0.0f;
+		if (m_Font.Atlas != 0)
+		{
+			TextWidth = Overlay.DrawString(m_Font, m_Text, Origin, m_LineHeight);
+			TextHeight = static_cast<float>(m_TextLines) * m_LineHeight;
+		}
+
+		const glm::vec2 GraphSize(static_cast<float>(HistoryLength) * std::max(std::floor(m_LineHeight / 6.0f), 1.0f), m_LineHeight * 3.0f);
+		const glm::vec2 CPUGraph(Origin.x, Origin.y + TextHeight + Padding);
+		const glm::vec2 GPUGraph(Origin.x, CPUGraph.y + GraphSize.y + Padding);
+		RecordGraph(Overlay, m_CPUTimes, m_CPUHead, CPUGraph, GraphSize, Layer + 1);
+		RecordGraph(Overlay, m_GPUTimes, m_GPUHead, GPUGraph, GraphSize, Layer + 1);
+		if (m_Font.Atlas != 0)
+		{
+			Overlay.SetLayer(Layer + 3);
+			Overlay.DrawString(m_Font, "CPU", CPUGraph + 2.0f, m_LineHeight, glm::vec4(1.0f, 1.0f, 1.0f, 0.8f));
+			Overlay.DrawString(m_Font, "GPU", GPUGraph + 2.0f, m_LineHeight, glm::vec4(1.0f, 1.0f, 1.0f, 0.8f));
+		}
+
+		Overlay.SetLayer(Layer);
+		const glm::vec2 PanelSize(std::max(TextWidth, GraphSize.x) + Padding * 2.0f, GPUGraph.y + GraphSize.y + Padding - m_Position.y);
+		Overlay.DrawRect(m_Position, PanelSize, glm::vec4(0.0f, 0.0f, 0.0f, 0.65f));
+		Overlay.SetLayer(0);
+	}
+
+	void PerformanceHUD::Sample()
+	{
+		// The CPU time of a frame is the time between two Record() calls, waits on the GPU and VSync included
+		const uint64_t Now = Profiler::Now();
+		if (m_LastSample != 0)
+		{
+			m_CPUTimes[m_CPUHead] = static_cast<float>(static_cast<double>(Now - m_LastSample) * 1e-6);
+			m_CPUHead = (m_CPUHead + 1) % HistoryLength;
+		}
+		m_LastSample = Now;
+
+		// GPU frames arrive a few frames late and not every frame is measured, see GPUProfiler
+		const GPUProfiler& Profiler = m_Renderer.GetGPUProfiler();
+		if (Profiler.GetFramesRead() != m_GPUFramesRead)
+		{
+			m_GPUFramesRead = Profiler.GetFramesRead();
+			m_GPUTimes[m_GPUHead] = Profiler.GetLastFrameTime();
+			m_GPUHead = (m_GPUHead + 1) % HistoryLength;
+		}
+	}
+
+	void PerformanceHUD::BuildText()
+	{
+		m_Text.clear();
+
+		float Mean = 0.0f;
+		float Max = 0.0f;
+		GetHistoryStats(m_CPUTimes, Mean, Max);
+		const float LastCPU = m_CPUTimes[(m_CPUHead + HistoryLength - 1) % HistoryLength];
+		AppendLine(m_Text, "CPU %6.2f ms  avg %6.2f  max %6.2f  %5.0f fps", LastCPU, Mean, Max, Mean > 0.0f ? 1000.0f / Mean : 0.0f);
+		GetHistoryStats(m_GPUTimes, Mean, Max);
+		const float LastGPU = m_GPUTimes[(m_GPUHead + HistoryLength - 1) % HistoryLength];
+		AppendLine(m_Text, "GPU %6.2f ms  avg %6.2f  max %6.2f", LastGPU, Mean, Max);
+
+		const RenderStats& Stats = m_Renderer.GetStats();
+		char Draws[16], Instances[16], Triangles[16], Visible[16], Culled[16];
+		AppendLine(m_Text, "Draws %s  instances %s  triangles %s", FormatCount(Stats.DrawCalls, Draws),
+			FormatCount(Stats.Instances, Instances), FormatCount(Stats.Triangles, Triangles));
+		AppendLine(m_Text, "Binds program %llu  texture %llu  vao %llu", static_cast<unsigned long long>(Stats.ProgramBinds),
+			static_cast<unsigned long long>(Stats.TextureBinds), static_cast<unsigned long long>(Stats.VertexArrayBinds));
+		AppendLine(m_Text, "Batches %u  visible %s  culled %s  upload %.2f MB", Stats.Batches, FormatCount(Stats.VisibleObjects, Visible),
+			FormatCount(Stats.CulledObjects, Culled), ToMegabytes(Stats.BytesUploaded));
+		AppendLine(m_Text, "VRAM %.1f MB  heap %.1f MB", ToMegabytes(GPUMemoryTracker::GetTotal()), ToMegabytes(MemoryTracker::GetTotal()));
+		if (m_LoadingQueue)
+		{
+			AppendLine(m_Text, "Loading %zu", m_LoadingQueue());
+		}
+
+		for (const GPUPassStats& Pass : m_Renderer.GetGPUProfiler().GetPassStats())
+		{
+			if (Pass.Samples > 0)
+			{
+				AppendLine(m_Text, "%-18.18s %6.2f ms  avg %6.2f", Pass.Name.c_str(), Pass.Last, Pass.Average);
+			}
+		}
+
+		m_TextLines = static_cast<size_t>(std::count(m_Text.begin(), m_Text.end(), '\n'));
+		if (!m_Text.empty())
+		{
+			m_Text.pop_back();
+		}
+	}
+
+	void PerformanceHUD::RecordGraph(SpriteBatch& Overlay, const std::array<float, HistoryLength>& History, size_t Head, const glm::vec2& Position,
+		const glm::vec2& Size, int Layer) const
+	{
+		float Mean = 0.0f;
+		float Max = 0.0f;
+		GetHistoryStats(History, Mean, Max);
+		const float Scale = std::max(Max, TargetFrameTime) * 1.1f;
+
+		Overlay.SetLayer(Layer);
+		Overlay.DrawRect(Position, Size, glm::vec4(0.15f, 0.15f, 0.15f, 0.8f));
+
+		// Oldest frame on the left, green within the target frame time, yellow within twice, red beyond
+		Overlay.SetLayer(Layer + 1);
+		const float BarWidth = Size.x / static_cast<float>(HistoryLength);
+		for (size_t Index = 0; Index < HistoryLength; Index++)
+		{
+			const float Time = History[(Head + Index) % HistoryLength];
+			if (Time <= 0.0f)
+				continue;
+
+			const float Height = std::min(Time / Scale, 1.0f) * Size.y;
+			const glm::vec4 Color = Time <= TargetFrameTime ? glm::vec4(0.3f, 0.9f, 0.3f, 0.9f)
+				: Time <= TargetFrameTime * 2.0f ? glm::vec4(0.95f, 0.8f, 0.2f, 0.9f) : glm::vec4(0.95f, 0.25f, 0.2f, 0.9f);
+			Overlay.DrawRect(glm::vec2(Position.x + BarWidth * static_cast<float>(Index), Position.y + Size.y - Height), glm::vec2(BarWidth, Height), Color);
+		}
+
+		const float TargetY = Position.y + Size.y - TargetFrameTime / Scale * Size.y;
+		Overlay.DrawRect(glm::vec2(Position.x, TargetY), glm::vec2(Size.x, 1.0f), glm::vec4(1.0f, 1.0f, 1.0f, 0.5f));
+	}
+
+} // namespace fgl
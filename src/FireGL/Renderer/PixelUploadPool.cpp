@@ -0,0 +1,158 @@
+#include <FireGL/Renderer/PixelUploadPool.h>
+#include <FireGL/Core/BaseLog.h>
+#include <FireGL/Renderer/GLStateCache.h>
+#include <FireGL/Renderer/GPUMemoryTracker.h>
+#include <FireGL/Renderer/RenderStats.h>
+
+#include <cstring>
+
+namespace fgl
+{
+
+	std::array<PixelUploadPool::StagingBuffer, PixelUploadPool::BufferCount> PixelUploadPool::s_Buffers;
+	size_t PixelUploadPool::s_Current = PixelUploadPool::BufferCount;
+	bool PixelUploadPool::s_bEnabled = true;
+
+	const void* PixelUploadPool::Stage(const void* Data, size_t Size)
+	{
+		if (!s_bEnabled || Size == 0)
+			return Data;
+
+		s_Current = FindFreeBuffer(Size);
+		if (s_Current == BufferCount)
+			return Data;
+
+		StagingBuffer& Staging = s_Buffers[s_Current];
+		if (Staging.Capacity < Size)
+		{
+			AllocateBuffer(Staging, Size);
+		}
+
+		GLStateCache::BindBuffer(GL_PIXEL_UNPACK_BUFFER, Staging.Buffer);
+		if (Staging.Mapped)
+		{
+			std::memcpy(Staging.Mapped, Data, Size);
+			RenderCounters::CountUpload(Size);
+		}
+		else
+		{
+			// Orphaning gives the map fresh storage, the previous upload keeps reading the old one
+			glBufferData(GL_PIXEL_UNPACK_BUFFER, Staging.Capacity, nullptr, GL_STREAM_DRAW);
+			void* Mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, Size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+			if (!Mapped)
+			{
+				GLStateCache::BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+				s_Current = BufferCount;
+				return Data;
+			}
+			std::memcpy(Mapped, Data, Size);
+			glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+			RenderCounters::CountUpload(Size);
+		}
+		return nullptr;
+	}
+
+	void PixelUploadPool::EndUpload()
+	{
+		if (s_Current == BufferCount)
+			return;
+
+		GLStateCache::BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		StagingBuffer& Staging = s_Buffers[s_Current];
+		if (Staging.Mapped)
+		{
+			Staging.Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		}
+		s_Current = BufferCount;
+	}
+
+	void PixelUploadPool::SetEnabled(bool bEnabled)
+	{
+		s_bEnabled = bEnabled;
+	}
+
+	void PixelUploadPool::Destroy()
+	{
+		for (StagingBuffer& Staging : s_Buffers)
+		{
+			if (Staging.Fence)
+			{
+				glDeleteSync(Staging.Fence);
+			}
+			if (Staging.Buffer != 0)
+			{
+				if (Staging.Mapped)
+				{
+					GLStateCache::BindBuffer(GL_PIXEL_UNPACK_BUFFER, Staging.Buffer);
+					glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+					GLStateCache::BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+				}
+				glDeleteBuffers(1, &Staging.Buffer);
+				GLStateCache::OnBufferDeleted(Staging.Buffer);
+				GPUMemoryTracker::UntrackBuffer(Staging.Buffer);
+			}
+			Staging = StagingBuffer();
+		}
+	}
+
+	size_t PixelUploadPool::FindFreeBuffer(size_t Size)
+	{
+		// Prefer a free buffer that already fits, a smaller free one is reallocated
+		size_t Result = BufferCount;
+		for (size_t Index = 0; Index < BufferCount; Index++)
+		{
+			StagingBuffer& Staging = s_Buffers[Index];
+			if (Staging.Fence)
+			{
+				if (glClientWaitSync(Staging.Fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+					continue;
+
+				glDeleteSync(Staging.Fence);
+				Staging.Fence = nullptr;
+			}
+
+			if (Staging.Capacity >= Size)
+				return Index;
+			if (Result == BufferCount)
+			{
+				Result = Index;
+			}
+		}
+		return Result;
+	}
+
+	void PixelUploadPool::AllocateBuffer(StagingBuffer& Staging, size_t Size)
+	{
+		const size_t Capacity = std::max(Size, MinBufferSize);
+		if (Staging.Buffer != 0)
+		{
+			// Immutable storage can't be respecified, replace the buffer object
+			if (Staging.Mapped)
+			{
+				GLStateCache::BindBuffer(GL_PIXEL_UNPACK_BUFFER, Staging.Buffer);
+				glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+			}
+			glDeleteBuffers(1, &Staging.Buffer);
+			GLStateCache::OnBufferDeleted(Staging.Buffer);
+			GPUMemoryTracker::UntrackBuffer(Staging.Buffer);
+			Staging.Mapped = nullptr;
+		}
+
+		glGenBuffers(1, &Staging.Buffer);
+		GLStateCache::BindBuffer(GL_PIXEL_UNPACK_BUFFER, Staging.Buffer);
+		if (GLAD_GL_VERSION_4_4)
+		{
+			const GLbitfield Flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+			glBufferStorage(GL_PIXEL_UNPACK_BUFFER, Capacity, nullptr, Flags);
+			Staging.Mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, Capacity, Flags);
+			LOG_ASSERT(Staging.Mapped, "Failed to persistently map a pixel upload buffer");
+		}
+		else
+		{
+			glBufferData(GL_PIXEL_UNPACK_BUFFER, Capacity, nullptr, GL_STREAM_DRAW);
+		}
+		Staging.Capacity = Capacity;
+		GPUMemoryTracker::TrackBuffer(Staging.Buffer, Capacity, GPUMemoryCategory::Staging, "PixelUploadPool");
+	}
+
+} // namespace fgl
\ No newline at end of file
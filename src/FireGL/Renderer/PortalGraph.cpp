@@ -0,0 +1,206 @@
+#include <FireGL/Renderer/PortalGraph.h>
+#include <FireGL/Renderer/Frustum.h>
+#include <FireGL/Core/BaseLog.h>
+
+#include <External/glm/common.hpp>
+#include <External/glm/geometric.hpp>
+#include <External/glm/vector_relational.hpp>
+
+namespace fgl
+{
+
+	namespace
+	{
+		float GetDistance(const glm::vec4& Plane, const glm::vec3& Point)
+		{
+			return glm::dot(glm::vec3(Plane), Point) + Plane.w;
+		}
+
+		bool OverlapsSphere(const BoundingBox& Box, const BoundingSphere& Sphere)
+		{
+			const glm::vec3 Offset = glm::clamp(Sphere.Center, Box.Min, Box.Max) - Sphere.Center;
+			return glm::dot(Offset, Offset) <= Sphere.Radius * Sphere.Radius;
+		}
+	}
+
+	uint32_t PortalGraph::AddCell(const BoundingBox& Bounds)
+	{
+		m_Cells.push_back({ Bounds, {} });
+		return static_cast<uint32_t>(m_Cells.size() - 1);
+	}
+
+	uint32_t PortalGraph::AddPortal(uint32_t CellA, uint32_t CellB, std::span<const glm::vec3> Corners)
+	{
+		LOG_ASSERT(CellA < m_Cells.size() && CellB < m_Cells.size(), "Invalid cell index.")
+		LOG_ASSERT(Corners.size() >= 3 && Corners.size() <= MaxPortalCorners, "A portal has 3 to " + std::to_string(MaxPortalCorners) + " corners.")
+
+		Portal Added;
+		Added.Cells[0] = CellA;
+		Added.Cells[1] = CellB;
+		std::copy(Corners.begin(), Corners.end(), Added.Corners.begin());
+		Added.CornerCount = static_cast<uint32_t>(Corners.size());
+		Added.bOpen = true;
+		m_Portals.push_back(Added);
+
+		const uint32_t Index = static_cast<uint32_t>(m_Portals.size() - 1);
+		m_Cells[CellA].Portals.push_back(Index);
+		m_Cells[CellB].Portals.push_back(Index);
+		return Index;
+	}
+
+	void PortalGraph::SetPortalOpen(uint32_t Portal, bool bOpen)
+	{
+		LOG_ASSERT(Portal < m_Portals.size(), "Invalid portal index.")
+		m_Portals[Portal].bOpen = bOpen;
+	}
+
+	void PortalGraph::Clear()
+	{
+		m_Cells.clear();
+		m_Portals.clear();
+		m_Views.clear();
+		m_Planes.clear();
+		m_bActive = false;
+	}
+
+	uint32_t PortalGraph::FindCell(const glm::vec3& Position) const
+	{
+		for (uint32_t Index = 0; Index < m_Cells.size(); Index++)
+		{
+			const BoundingBox& Bounds = m_Cells[Index].Bounds;
+			if (glm::all(glm::greaterThanEqual(Position, Bounds.Min)) && glm::all(glm::lessThanEqual(Position, Bounds.Max)))
+				return Index;
+		}
+		return InvalidCell;
+	}
+
+	void PortalGraph::ComputeVisibility(const glm::vec3& Eye, const Frustum& ViewFrustum)
+	{
+		m_Views.clear();
+		m_Planes.clear();
+		const uint32_t Start = FindCell(Eye);
+		m_bActive = Start != InvalidCell;
+		if (!m_bActive)
+			return;
+
+		// The camera's cell is seen through the whole frustum, the cells behind portals through narrower ones
+		m_Eye = Eye;
+		const auto& Planes = ViewFrustum.GetPlanes();
+		m_NearPlane = Planes[Frustum::Near];
+		m_FarPlane = Planes[Frustum::Far];
+		m_Planes.assign(Planes.begin(), Planes.end());
+		Visit(Start, 0, static_cast<uint32_t>(Planes.size()), UINT32_MAX, 0);
+	}
+
+	void PortalGraph::Visit(uint32_t CellIndex, uint32_t FirstPlane, uint32_t PlaneCount, uint32_t EnteredBy, uint32_t Depth)
+	{
+		m_Views.push_back({ CellIndex, FirstPlane, PlaneCount });
+		if (Depth == MaxDepth)
+			return;
+
+		for (uint32_t PortalIndex : m_Cells[CellIndex].Portals)
+		{
+			const Portal& Opening = m_Portals[PortalIndex];
+			if (PortalIndex == EnteredBy || !Opening.bOpen)
+				continue;
+
+			// Sutherland-Hodgman clipping of the opening by every plane of the frustum it is seen through
+			m_Clipped.assign(Opening.Corners.begin(), Opening.Corners.begin() + Opening.CornerCount);
+			for (uint32_t Plane = FirstPlane; Plane < FirstPlane + PlaneCount && !m_Clipped.empty(); Plane++)
+			{
+				const glm::vec4 Clip = m_Planes[Plane];
+				m_Clipping.clear();
+				for (size_t Corner = 0; Corner < m_Clipped.size(); Corner++)
+				{
+					const glm::vec3& Current = m_Clipped[Corner];
+					const glm::vec3& Next = m_Clipped[(Corner + 1) % m_Clipped.size()];
+					const float CurrentDistance = GetDistance(Clip, Current);
+					const float NextDistance = GetDistance(Clip, Next);
+					if (CurrentDistance >= 0.0f)
+					{
+						m_Clipping.push_back(Current);
+					}
+					if ((CurrentDistance >= 0.0f) != (NextDistance >= 0.0f))
+					{
+						m_Clipping.push_back(Current + (Next - Current) * (CurrentDistance / (CurrentDistance - NextDistance)));
+					}
+				}
+				m_Clipped.swap(m_Clipping);
+			}
+			if (m_Clipped.size() < 3)
+				continue;
+
+			// The frustum through the clipped opening: a plane through the eye and each edge, facing the opening's center
+			glm::vec3 Center(0.0f);
+			for (const glm::vec3& Corner : m_Clipped)
+			{
+				Center += Corner;
+			}
+			Center /= static_cast<float>(m_Clipped.size());
+
+			const uint32_t NextFirst = static_cast<uint32_t>(m_Planes.size());
+			m_Planes.push_back(m_NearPlane);
+			m_Planes.push_back(m_FarPlane);
+			for (size_t Corner = 0; Corner < m_Clipped.size(); Corner++)
+			{
+				const glm::vec3 Normal = glm::cross(m_Clipped[Corner] - m_Eye, m_Clipped[(Corner + 1) % m_Clipped.size()] - m_Eye);
+				const float Length = glm::length(Normal);
+
+				// An edge seen edge-on bounds nothing, leaving it out keeps the frustum conservative
+				if (Length < 1e-6f)
+					continue;
+
+				glm::vec4 Side(Normal / Length, 0.0f);
+				Side.w = -glm::dot(glm::vec3(Side), m_Eye);
+				m_Planes.push_back(GetDistance(Side, Center) < 0.0f ? -Side : Side);
+			}
+
+			const uint32_t Next = Opening.Cells[0] == CellIndex ? Opening.Cells[1] : Opening.Cells[0];
+			Visit(Next, NextFirst, static_cast<uint32_t>(m_Planes.size()) - NextFirst, PortalIndex, Depth + 1);
+		}
+	}
+
+	bool PortalGraph::IsActive() const
+	{
+		return m_bActive;
+	}
+
+	bool PortalGraph::IsVisible(const BoundingSphere& Sphere) const
+	{
+		if (!m_bActive)
+			return true;
+
+		for (const View& Reached : m_Views)
+		{
+			if (!OverlapsSphere(m_Cells[Reached.Cell].Bounds, Sphere))
+				continue;
+
+			bool bInside = true;
+			for (uint32_t Plane = Reached.FirstPlane; Plane < Reached.FirstPlane + Reached.PlaneCount && bInside; Plane++)
+			{
+				bInside = GetDistance(m_Planes[Plane], Sphere.Center) >= -Sphere.Radius;
+			}
+			if (bInside)
+				return true;
+		}
+		return false;
+	}
+
+	size_t PortalGraph::GetVisibleCellCount() const
+	{
+		std::vector<uint32_t> Cells;
+		Cells.reserve(m_Views.size());
+		for (const View& Reached : m_Views)
+		{
+			Cells.push_back(Reached.Cell);
+		}
+		std::sort(Cells.begin(), Cells.end());
+		return static_cast<size_t>(std::unique(Cells.begin(), Cells.end()) - Cells.begin());
+	}
+
+	size_t PortalGraph::GetCellCount() const
+	{
+		return m_Cells.size();
+	}
+
+} // namespace fgl
@@ -0,0 +1,565 @@
+#include <FireGL/Renderer/PostProcessStack.h>
+#include <FireGL/Renderer/GLStateCache.h>
+#include <FireGL/Renderer/RenderStats.h>
+
+#include <External/glm/matrix.hpp>
+
+namespace fgl
+{
+
+	namespace
+	{
+		constexpr std::string_view FullScreenVertexCode = R"(#version 410 core
+out vec2 TexCoords;
+
+void main()
+{
+    // vertices (0, 0), (2, 0) and (0, 2) cover the screen
+    TexCoords = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    gl_Position = vec4(TexCoords * 2.0 - 1.0, 0.0, 1.0);
+})";
+
+		constexpr std::string_view DownsampleFragmentCode = R"(
+in vec2 TexCoords;
+out vec4 FragColor;
+
+uniform sampler2D Source;
+uniform vec2 TexelSize;
+uniform float Threshold;
+
+void main()
+{
+    // Four bilinear taps one texel away average the 4x4 source texels under the target texel
+    vec4 Offset = TexelSize.xyxy * vec4(-1.0, -1.0, 1.0, 1.0);
+    vec3 Color = 0.25 * (texture(Source, TexCoords + Offset.xy).rgb + texture(Source, TexCoords + Offset.zy).rgb
+        + texture(Source, TexCoords + Offset.xw).rgb + texture(Source, TexCoords + Offset.zw).rgb);
+#ifdef PREFILTER
+    // Quadratic knee over half the threshold, so pixels don't pop in as they cross it
+    float Brightness = max(Color.r, max(Color.g, Color.b));
+    float Knee = Threshold * 0.5;
+    float Soft = clamp(Brightness - Threshold + Knee, 0.0, 2.0 * Knee);
+    Soft = Soft * Soft / (4.0 * Knee + 1e-4);
+    Color *= max(Soft, Brightness - Threshold) / max(Brightness, 1e-4);
+#endif
+    FragColor = vec4(Color, 1.0);
+})";
+
+		constexpr std::string_view UpsampleFragmentCode = R"(#version 410 core
+in vec2 TexCoords;
+out vec4 FragColor;
+
+uniform sampler2D Source;
+uniform vec2 TexelSize;
+
+void main()
+{
+    // 3x3 tent, blended additively into the larger level
+    vec4 Offset = TexelSize.xyxy * vec4(1.0, 1.0, -1.0, 0.0);
+    vec3 Color = texture(Source, TexCoords).rgb * 4.0;
+    Color += (texture(Source, TexCoords - Offset.wy).rgb + texture(Source, TexCoords + Offset.wy).rgb
+        + texture(Source, TexCoords - Offset.xw).rgb + texture(Source, TexCoords + Offset.xw).rgb) * 2.0;
+    Color += texture(Source, TexCoords - Offset.xy).rgb + texture(Source, TexCoords + Offset.xy).rgb
+        + texture(Source, TexCoords - Offset.zy).rgb + texture(Source, TexCoords + Offset.zy).rgb;
+    FragColor = vec4(Color / 16.0, 1.0);
+})";
+
+		constexpr std::string_view CompositeFragmentCode = R"(
+in vec2 TexCoords;
+out vec4 FragColor;
+
+uniform sampler2D SceneColor;
+uniform sampler2D BloomColor;
+uniform float BloomIntensity;
+uniform float Exposure;
+uniform vec3 ColorFilter;
+uniform float Contrast;
+uniform float Saturation;
+uniform float VignetteIntensity;
+uniform float VignetteSmoothness;
+
+#ifdef FXAA
+uniform vec2 SceneTexelSize;
+
+float SceneLuminance(vec2 Coords)
+{
+    // Compressed so edges are found in the HDR range too
+    float Luminance = dot(textureLod(SceneColor, Coords, 0.0).rgb, vec3(0.299, 0.587, 0.114));
+    return Luminance / (1.0 + Luminance);
+}
+
+// Finds the edge through the pixel and returns the coordinates to sample for the pixel's coverage of it
+vec2 SmoothEdge(vec2 Coords)
+{
+    float M = SceneLuminance(Coords);
+    float N = SceneLuminance(Coords + vec2(0.0, SceneTexelSize.y));
+    float S = SceneLuminance(Coords - vec2(0.0, SceneTexelSize.y));
+    float E = SceneLuminance(Coords + vec2(SceneTexelSize.x, 0.0));
+    float W = SceneLuminance(Coords - vec2(SceneTexelSize.x, 0.0));
+    float Highest = max(M, max(max(N, S), max(E, W)));
+    float Range = Highest - min(M, min(min(N, S), min(E, W)));
+    if (Range < max(0.0312, Highest * 0.125))
+        return Coords;
+
+    float NE = SceneLuminance(Coords + SceneTexelSize);
+    float SW = SceneLuminance(Coords - SceneTexelSize);
+    float NW = SceneLuminance(Coords + vec2(-SceneTexelSize.x, SceneTexelSize.y));
+    float SE = SceneLuminance(Coords + vec2(SceneTexelSize.x, -SceneTexelSize.y));
+
+    // Sub-pixel blend, for details thinner than a pixel
+    float Average = (2.0 * (N + S + E + W) + NE + NW + SE + SW) / 12.0;
+    float Subpixel = smoothstep(0.0, 1.0, clamp(abs(Average - M) / Range, 0.0, 1.0));
+    Subpixel = Subpixel * Subpixel * 0.75;
+
+    bool bHorizontal = 2.0 * abs(N + S - 2.0 * M) + abs(NE + SE - 2.0 * E) + abs(NW + SW - 2.0 * W)
+        >= 2.0 * abs(E + W - 2.0 * M) + abs(NE + NW - 2.0 * N) + abs(SE + SW - 2.0 * S);
+    float Positive = bHorizontal ? N : E;
+    float Negative = bHorizontal ? S : W;
+    float StepLength = bHorizontal ? SceneTexelSize.y : SceneTexelSize.x;
+    float Opposite = Positive;
+    float Gradient = abs(Positive - M);
+    if (abs(Negative - M) > Gradient)
+    {
+        StepLength = -StepLength;
+        Opposite = Negative;
+        Gradient = abs(Negative - M);
+    }
+
+    // Walks along the edge both ways until its contrast drops
+    vec2 EdgeCoords = Coords + (bHorizontal ? vec2(0.0, StepLength) : vec2(StepLength, 0.0)) * 0.5;
+    vec2 EdgeStep = bHorizontal ? vec2(SceneTexelSize.x, 0.0) : vec2(0.0, SceneTexelSize.y);
+    float EdgeLuminance = (M + Opposite) * 0.5;
+    float Threshold = Gradient * 0.25;
+    const float Steps[10] = float[](1.0, 1.0, 1.0, 1.0, 1.5, 2.0, 2.0, 2.0, 2.0, 4.0);
+
+    vec2 PositiveCoords = EdgeCoords + EdgeStep;
+    float PositiveDelta = SceneLuminance(PositiveCoords) - EdgeLuminance;
+    for (int Index = 0; Index < 10 && abs(PositiveDelta) < Threshold; Index++)
+    {
+        PositiveCoords += EdgeStep * Steps[Index];
+        PositiveDelta = SceneLuminance(PositiveCoords) - EdgeLuminance;
+    }
+    vec2 NegativeCoords = EdgeCoords - EdgeStep;
+    float NegativeDelta = SceneLuminance(NegativeCoords) - EdgeLuminance;
+    for (int Index = 0; Index < 10 && abs(NegativeDelta) < Threshold; Index++)
+    {
+        NegativeCoords -= EdgeStep * Steps[Index];
+        NegativeDelta = SceneLuminance(NegativeCoords) - EdgeLuminance;
+    }
+
+    float PositiveDistance = bHorizontal ? PositiveCoords.x - Coords.x : PositiveCoords.y - Coords.y;
+    float NegativeDistance = bHorizontal ? Coords.x - NegativeCoords.x : Coords.y - NegativeCoords.y;
+    float Distance = min(PositiveDistance, NegativeDistance);
+    float EndDelta = PositiveDistance <= NegativeDistance ? PositiveDelta : NegativeDelta;
+
+    // Only the end of the edge on the pixel's side of it blends, farther from it the less
+    float EdgeBlend = (EndDelta >= 0.0) == (M - EdgeLuminance >= 0.0) ? 0.0 : 0.5 - Distance / (PositiveDistance + NegativeDistance);
+    float Blend = max(Subpixel, EdgeBlend);
+    return Coords + (bHorizontal ? vec2(0.0, StepLength) : vec2(StepLength, 0.0)) * Blend;
+}
+#endif
+
+void main()
+{
+#ifdef FXAA
+    vec2 Coords = SmoothEdge(TexCoords);
+#else
+    vec2 Coords = TexCoords;
+#endif
+    vec4 Scene = texture(SceneColor, Coords);
+    vec3 Color = Scene.rgb;
+#ifdef BLOOM
+    Color += texture(BloomColor, Coords).rgb * BloomIntensity;
+#endif
+#ifdef TONE_MAPPING
+    // Narkowicz's fit of the ACES filmic curve
+    Color *= Exposure;
+    Color = clamp((Color * (2.51 * Color + 0.03)) / (Color * (2.43 * Color + 0.59) + 0.14), 0.0, 1.0);
+#endif
+#ifdef COLOR_GRADING
+    Color *= ColorFilter;
+    Color = (Color - 0.5) * Contrast + 0.5;
+    float Luminance = dot(Color, vec3(0.2126, 0.7152, 0.0722));
+    Color = max(mix(vec3(Luminance), Color, Saturation), 0.0);
+#endif
+#ifdef VIGNETTE
+    // 0 at the center, 1 in the corners
+    float Distance = length(TexCoords - 0.5) * 1.41421356;
+    Color *= 1.0 - VignetteIntensity * smoothstep(1.0 - VignetteSmoothness, 1.0, Distance);
+#endif
+    FragColor = vec4(Color, Scene.a);
+})";
+
+		constexpr std::string_view TemporalFragmentCode = R"(
+in vec2 TexCoords;
+out vec4 FragColor;
+
+uniform sampler2D Source;
+uniform sampler2D HistoryColor;
+uniform sampler2D SceneDepth;
+uniform mat4 Reprojection;
+uniform vec2 TexelSize;
+uniform float Feedback;
+#ifdef UPSCALE
+uniform vec2 InputSize;
+uniform vec2 Jitter;
+#endif
+
+void main()
+{
+#ifdef UPSCALE
+    // The input texel whose jittered sample is the closest to this output pixel, weighted by its distance
+    vec2 InputPosition = TexCoords * InputSize;
+    ivec2 LastTexel = ivec2(InputSize) - 1;
+    ivec2 Texel = clamp(ivec2(floor(InputPosition + Jitter)), ivec2(0), LastTexel);
+    vec2 SampleOffset = vec2(Texel) + 0.5 - Jitter - InputPosition;
+    float SampleWeight = exp(-2.29 * dot(SampleOffset, SampleOffset));
+    vec4 Current = texelFetch(Source, Texel, 0);
+#else
+    ivec2 LastTexel = textureSize(Source, 0) - 1;
+    ivec2 Texel = ivec2(TexCoords / TexelSize);
+    float SampleWeight = 1.0;
+    vec4 Current = texture(Source, TexCoords);
+#endif
+
+    // The history may only hold colors found around the pixel this frame, anything else moved or was uncovered
+    vec3 Lowest = Current.rgb;
+    vec3 Highest = Current.rgb;
+    for (int Y = -1; Y <= 1; Y++)
+    {
+        for (int X = -1; X <= 1; X++)
+        {
+            vec3 Neighbour = texelFetch(Source, clamp(Texel + ivec2(X, Y), ivec2(0), LastTexel), 0).rgb;
+            Lowest = min(Lowest, Neighbour);
+            Highest = max(Highest, Neighbour);
+        }
+    }
+
+    float Depth = texture(SceneDepth, TexCoords).r;
+    vec4 Previous = Reprojection * vec4(TexCoords * 2.0 - 1.0, Depth * 2.0 - 1.0, 1.0);
+    vec2 PreviousCoords = Previous.xy / Previous.w * 0.5 + 0.5;
+    bool bOutside = any(lessThan(PreviousCoords, vec2(0.0))) || any(greaterThan(PreviousCoords, vec2(1.0)));
+    float HistoryWeight = bOutside ? 0.0 : Feedback;
+    if (HistoryWeight == 0.0)
+    {
+        FragColor = texture(Source, TexCoords);
+        return;
+    }
+
+    // Output pixels far from this frame's sample keep more of the history, they were covered by other frames
+    vec3 History = clamp(texture(HistoryColor, PreviousCoords).rgb, Lowest, Highest);
+    FragColor = vec4(mix(History, Current.rgb, (1.0 - HistoryWeight) * SampleWeight), Current.a);
+})";
+
+		/** Fills polygons with depth testing and blending off for the full-screen passes, restored when destroyed. */
+		class FullScreenState
+		{
+		public:
+			FullScreenState()
+			{
+				// The debug modes draw lines, the triangles must be filled to cover every pixel
+				glGetIntegerv(GL_POLYGON_MODE, m_PolygonMode);
+				m_bDepthTest = glIsEnabled(GL_DEPTH_TEST);
+				m_bBlend = glIsEnabled(GL_BLEND);
+				glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+				glDisable(GL_DEPTH_TEST);
+				glDisable(GL_BLEND);
+			}
+
+			~FullScreenState()
+			{
+				glPolygonMode(GL_FRONT_AND_BACK, static_cast<GLenum>(m_PolygonMode[0]));
+				if (m_bDepthTest)
+				{
+					glEnable(GL_DEPTH_TEST);
+				}
+				if (m_bBlend)
+				{
+					glEnable(GL_BLEND);
+				}
+			}
+
+		private:
+			GLint m_PolygonMode[2] = {};
+			GLboolean m_bDepthTest = GL_FALSE;
+			GLboolean m_bBlend = GL_FALSE;
+		};
+
+		/** @return The element of the Halton sequence of a base, in [0, 1). */
+		float Halton(uint32_t Index, uint32_t Base)
+		{
+			float Result = 0.0f;
+			float Fraction = 1.0f;
+			while (Index > 0)
+			{
+				Fraction /= static_cast<float>(Base);
+				Result += Fraction * static_cast<float>(Index % Base);
+				Index /= Base;
+			}
+			return Result;
+		}
+
+		std::string Concatenate(std::initializer_list<std::string_view> Parts)
+		{
+			std::string Code;
+			for (std::string_view Part : Parts)
+			{
+				Code += Part;
+			}
+			return Code;
+		}
+	}
+
+	PostProcessStack::~PostProcessStack()
+	{
+		Destroy();
+	}
+
+	PostProcessSettings& PostProcessStack::GetSettings()
+	{
+		return m_Settings;
+	}
+
+	const PostProcessSettings& PostProcessStack::GetSettings() const
+	{
+		return m_Settings;
+	}
+
+	void PostProcessStack::Apply(GLuint SceneColor, int Width, int Height, GLuint OutputFramebuffer, const GLint OutputViewport[4], bool bEffects, bool bFXAA)
+	{
+		if (m_FullScreenVertexArray == 0)
+		{
+			glGenVertexArrays(1, &m_FullScreenVertexArray);
+		}
+		m_PassCount = 0;
+		const FullScreenState State;
+
+		const bool bBloom = bEffects && m_Settings.bBloom && m_Settings.BloomIntensity > 0.0f;
+		PooledTarget Bloom;
+		if (bBloom)
+		{
+			Bloom = RenderBloom(SceneColor, Width, Height);
+		}
+
+		const uint32_t Features = (bEffects && m_Settings.bToneMapping ? ToneMappingFeature : 0u) | (bEffects && m_Settings.bColorGrading ? ColorGradingFeature : 0u)
+			| (bBloom ? BloomFeature : 0u) | (bEffects && m_Settings.bVignette ? VignetteFeature : 0u) | (bFXAA ? FXAAFeature : 0u);
+		Shader& Composite = GetCompositeShader(Features);
+		glBindFramebuffer(GL_FRAMEBUFFER, OutputFramebuffer);
+		glViewport(OutputViewport[0], OutputViewport[1], OutputViewport[2], OutputViewport[3]);
+		GLStateCache::BindTextureUnit(SceneUnit, GL_TEXTURE_2D, SceneColor);
+		Composite.Activate();
+		Composite.SetInt("SceneColor", SceneUnit);
+		if (bBloom)
+		{
+			GLStateCache::BindTextureUnit(BloomUnit, GL_TEXTURE_2D, Bloom.Texture);
+			Composite.SetInt("BloomColor", BloomUnit);
+			Composite.SetFloat("BloomIntensity", m_Settings.BloomIntensity);
+		}
+		if (Features & ToneMappingFeature)
+		{
+			Composite.SetFloat("Exposure", m_Settings.Exposure);
+		}
+		if (Features & ColorGradingFeature)
+		{
+			Composite.SetVec3("ColorFilter", m_Settings.ColorFilter);
+			Composite.SetFloat("Contrast", m_Settings.Contrast);
+			Composite.SetFloat("Saturation", m_Settings.Saturation);
+		}
+		if (Features & VignetteFeature)
+		{
+			Composite.SetFloat("VignetteIntensity", std::clamp(m_Settings.VignetteIntensity, 0.0f, 1.0f));
+			Composite.SetFloat("VignetteSmoothness", std::clamp(m_Settings.VignetteSmoothness, 0.01f, 1.0f));
+		}
+		if (bFXAA)
+		{
+			Composite.SetVec2("SceneTexelSize", glm::vec2(1.0f / Width, 1.0f / Height));
+		}
+		DrawFullScreen();
+		if (bBloom)
+		{
+			m_Targets.Release(Bloom);
+		}
+		m_Targets.EndFrame();
+	}
+
+	GLuint PostProcessStack::ResolveTemporal(GLuint SceneColor, GLuint SceneDepth, int Width, int Height, GLenum Format, const glm::mat4& Reprojection,
+		const glm::vec2& Jitter, int OutputWidth, int OutputHeight)
+	{
+		if (m_FullScreenVertexArray == 0)
+		{
+			glGenVertexArrays(1, &m_FullScreenVertexArray);
+		}
+		const bool bUpscale = OutputWidth != Width || OutputHeight != Height;
+		std::unique_ptr<Shader>& Resolve = bUpscale ? m_UpscaleShader : m_TemporalShader;
+		if (!Resolve)
+		{
+			Resolve = Shader::CreateFromSource(FullScreenVertexCode, Concatenate({ bUpscale ? "#version 410 core\n#define UPSCALE\n" : "#version 410 core\n", TemporalFragmentCode }));
+		}
+		const FullScreenState State;
+
+		// A history of another size or format can't be reprojected, the frame starts a new one
+		const bool bHistory = m_bHistoryValid && m_History.Width == OutputWidth && m_History.Height == OutputHeight && m_History.Format == Format;
+		const PooledTarget Resolved = m_Targets.Acquire(OutputWidth, OutputHeight, Format);
+		glBindFramebuffer(GL_FRAMEBUFFER, Resolved.Framebuffer);
+		glViewport(0, 0, OutputWidth, OutputHeight);
+		GLStateCache::BindTextureUnit(BloomUnit, GL_TEXTURE_2D, SceneColor);
+		GLStateCache::BindTextureUnit(HistoryUnit, GL_TEXTURE_2D, bHistory ? m_History.Texture : SceneColor);
+		GLStateCache::BindTextureUnit(DepthUnit, GL_TEXTURE_2D, SceneDepth);
+		Resolve->Activate();
+		Resolve->SetInt("Source", BloomUnit);
+		Resolve->SetInt("HistoryColor", HistoryUnit);
+		Resolve->SetInt("SceneDepth", DepthUnit);
+		Resolve->SetMat4("Reprojection", Reprojection);
+		Resolve->SetVec2("TexelSize", glm::vec2(1.0f / Width, 1.0f / Height));
+		Resolve->SetFloat("Feedback", bHistory ? (bUpscale ? UpscaleFeedback : TemporalFeedback) : 0.0f);
+		if (bUpscale)
+		{
+			Resolve->SetVec2("InputSize", glm::vec2(Width, Height));
+			Resolve->SetVec2("Jitter", Jitter);
+		}
+		DrawFullScreen();
+
+		if (m_bHistoryValid)
+		{
+			m_Targets.Release(m_History);
+		}
+		m_History = Resolved;
+		m_bHistoryValid = true;
+		return Resolved.Texture;
+	}
+
+	void PostProcessStack::ResetHistory()
+	{
+		if (m_bHistoryValid)
+		{
+			m_Targets.Release(m_History);
+			m_bHistoryValid = false;
+		}
+	}
+
+	glm::vec2 PostProcessStack::GetJitterOffset(uint32_t Frame)
+	{
+		// Halton indices start at 1, 0 would be the pixel's corner every time
+		const uint32_t Index = Frame % JitterSequenceLength + 1;
+		return glm::vec2(Halton(Index, 2), Halton(Index, 3)) - 0.5f;
+	}
+
+	PooledTarget PostProcessStack::RenderBloom(GLuint SceneColor, int Width, int Height)
+	{
+		if (!m_PrefilterShader)
+		{
+			m_PrefilterShader = Shader::CreateFromSource(FullScreenVertexCode, Concatenate({ "#version 410 core\n#define PREFILTER\n", DownsampleFragmentCode }));
+			m_DownsampleShader = Shader::CreateFromSource(FullScreenVertexCode, Concatenate({ "#version 410 core\n", DownsampleFragmentCode }));
+			m_UpsampleShader = Shader::CreateFromSource(FullScreenVertexCode, UpsampleFragmentCode);
+		}
+
+		// Levels stop at MaxBloomLevels, or once they would drop below 2 pixels
+		const int Downsample = std::max(m_Settings.BloomDownsample, 1);
+		const int LevelCount = std::clamp(m_Settings.BloomLevels, 1, MaxBloomLevels);
+		std::array<PooledTarget, MaxBloomLevels> Levels;
+		int Count = 0;
+		int LevelWidth = std::max(Width / Downsample, 1);
+		int LevelHeight = std::max(Height / Downsample, 1);
+		GLuint Source = SceneColor;
+		glm::vec2 SourceTexelSize = glm::vec2(1.0f / Width, 1.0f / Height);
+		while (Count < LevelCount && (Count == 0 || std::min(LevelWidth, LevelHeight) >= 2))
+		{
+			Shader& Pass = Count == 0 ? *m_PrefilterShader : *m_DownsampleShader;
+			const PooledTarget& Level = Levels[Count] = m_Targets.Acquire(LevelWidth, LevelHeight, BloomFormat);
+			glBindFramebuffer(GL_FRAMEBUFFER, Level.Framebuffer);
+			glViewport(0, 0, LevelWidth, LevelHeight);
+			GLStateCache::BindTextureUnit(BloomUnit, GL_TEXTURE_2D, Source);
+			Pass.Activate();
+			Pass.SetInt("Source", BloomUnit);
+			Pass.SetVec2("TexelSize", SourceTexelSize);
+			if (Count == 0)
+			{
+				Pass.SetFloat("Threshold", std::max(m_Settings.BloomThreshold, 0.0f));
+			}
+			DrawFullScreen();
+
+			Source = Level.Texture;
+			SourceTexelSize = glm::vec2(1.0f / LevelWidth, 1.0f / LevelHeight);
+			LevelWidth = std::max(LevelWidth / 2, 1);
+			LevelHeight = std::max(LevelHeight / 2, 1);
+			Count++;
+		}
+
+		// Each level adds its blur to the larger one, which then holds the light of every smaller level
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_ONE, GL_ONE);
+		m_UpsampleShader->Activate();
+		m_UpsampleShader->SetInt("Source", BloomUnit);
+		for (int Index = Count - 1; Index > 0; Index--)
+		{
+			const PooledTarget& Target = Levels[Index - 1];
+			glBindFramebuffer(GL_FRAMEBUFFER, Target.Framebuffer);
+			glViewport(0, 0, Target.Width, Target.Height);
+			GLStateCache::BindTextureUnit(BloomUnit, GL_TEXTURE_2D, Levels[Index].Texture);
+			m_UpsampleShader->SetVec2("TexelSize", glm::vec2(1.0f / Levels[Index].Width, 1.0f / Levels[Index].Height));
+			DrawFullScreen();
+			m_Targets.Release(Levels[Index]);
+		}
+		glDisable(GL_BLEND);
+		return Levels[0];
+	}
+
+	Shader& PostProcessStack::GetCompositeShader(uint32_t Features)
+	{
+		std::unique_ptr<Shader>& Composite = m_CompositeShaders[Features];
+		if (!Composite)
+		{
+			std::string Header = "#version 410 core\n";
+			Header += Features & ToneMappingFeature ? "#define TONE_MAPPING\n" : "";
+			Header += Features & ColorGradingFeature ? "#define COLOR_GRADING\n" : "";
+			Header += Features & BloomFeature ? "#define BLOOM\n" : "";
+			Header += Features & VignetteFeature ? "#define VIGNETTE\n" : "";
+			Header += Features & FXAAFeature ? "#define FXAA\n" : "";
+			Composite = Shader::CreateFromSource(FullScreenVertexCode, Concatenate({ Header, CompositeFragmentCode }));
+		}
+		return *Composite;
+	}
+
+	void PostProcessStack::DrawFullScreen()
+	{
+		GLStateCache::BindVertexArray(m_FullScreenVertexArray);
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+		RenderCounters::CountDraw(1, 1);
+		m_PassCount++;
+	}
+
+	void PostProcessStack::Destroy()
+	{
+		m_bHistoryValid = false;
+		m_Targets.Destroy();
+		for (auto& [Features, Composite] : m_CompositeShaders)
+		{
+			Composite->Cleanup();
+		}
+		m_CompositeShaders.clear();
+		for (std::unique_ptr<Shader>* Pass : { &m_PrefilterShader, &m_DownsampleShader, &m_UpsampleShader, &m_TemporalShader, &m_UpscaleShader })
+		{
+			if (*Pass)
+			{
+				(*Pass)->Cleanup();
+				Pass->reset();
+			}
+		}
+		if (m_FullScreenVertexArray != 0)
+		{
+			glDeleteVertexArrays(1, &m_FullScreenVertexArray);
+			GLStateCache::OnVertexArrayDeleted(m_FullScreenVertexArray);
+			m_FullScreenVertexArray = 0;
+		}
+	}
+
+	const RenderTargetPool& PostProcessStack::GetTargetPool() const
+	{
+		return m_Targets;
+	}
+
+	uint32_t PostProcessStack::GetPassCount() const
+	{
+		return m_PassCount;
+	}
+
+} // namespace fgl
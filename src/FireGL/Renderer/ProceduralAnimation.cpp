@@ -0,0 +1,61 @@
+#include <FireGL/Renderer/ProceduralAnimation.h>
+
+#include <External/glm/common.hpp>
+#include <External/glm/gtc/constants.hpp>
+#include <External/glm/geometric.hpp>
+#include <External/glm/gtc/packing.hpp>
+
+namespace fgl
+{
+
+	bool ProceduralAnimation::IsAnimated() const
+	{
+		return SpinSpeed != 0.0f || SwayAngle != 0.0f || BobAmplitude != 0.0f;
+	}
+
+	glm::uvec3 ProceduralAnimation::Pack() const
+	{
+		if (!IsAnimated())
+			return glm::uvec3(0u);
+
+		// Octahedral axis, the lower hemisphere folded over the diagonals
+		const float Length = glm::length(Axis);
+		const glm::vec3 Direction = Length > 0.0f ? Axis / Length : glm::vec3(0.0f, 1.0f, 0.0f);
+		glm::vec2 Octahedral = glm::vec2(Direction) / (glm::abs(Direction.x) + glm::abs(Direction.y) + glm::abs(Direction.z));
+		if (Direction.z < 0.0f)
+		{
+			const glm::vec2 Sign(Octahedral.x >= 0.0f ? 1.0f : -1.0f, Octahedral.y >= 0.0f ? 1.0f : -1.0f);
+			Octahedral = (1.0f - glm::abs(glm::vec2(Octahedral.y, Octahedral.x))) * Sign;
+		}
+		const glm::uvec2 Bytes = glm::uvec2(glm::round(glm::clamp(Octahedral * 0.5f + 0.5f, 0.0f, 1.0f) * 255.0f));
+
+		// The phase only matters modulo a turn, wrapped it keeps the precision of a half
+		const float Turn = glm::two_pi<float>();
+		const float WrappedPhase = Phase - Turn * std::floor(Phase / Turn);
+
+		const auto Half = [](float Value) { return static_cast<uint32_t>(glm::packHalf1x16(Value)); };
+		return glm::uvec3(
+			Half(SpinSpeed) << 16 | Bytes.y << 8 | Bytes.x,
+			Half(BobAmplitude) << 16 | Half(SwayAngle),
+			Half(Frequency) << 16 | Half(WrappedPhase));
+	}
+
+	BoundingSphere ProceduralAnimation::Enclose(const BoundingSphere& Local) const
+	{
+		if (!IsAnimated())
+			return Local;
+
+		const float Length = glm::length(Axis);
+		const glm::vec3 Direction = Length > 0.0f ? Axis / Length : glm::vec3(0.0f, 1.0f, 0.0f);
+		BoundingSphere Result = Local;
+		if (SpinSpeed != 0.0f || SwayAngle != 0.0f)
+		{
+			// Turning around the axis sweeps the center on a circle around its projection on the axis
+			Result.Center = Direction * glm::dot(Local.Center, Direction);
+			Result.Radius += glm::length(Local.Center - Result.Center);
+		}
+		Result.Radius += glm::abs(BobAmplitude);
+		return Result;
+	}
+
+} // namespace fgl
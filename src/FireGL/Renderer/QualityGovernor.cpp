@@ -0,0 +1,131 @@
+#include <FireGL/Renderer/QualityGovernor.h>
+#include <FireGL/Core/BaseLog.h>
+
+namespace fgl
+{
+
+	namespace
+	{
+		/** Weight of the newest frame in the moving averages, about the last 10 frames counting. */
+		constexpr float SmoothingFactor = 0.1f;
+	}
+
+	QualityGovernor::QualityGovernor()
+		: m_Levels(MakeDefaultLevels())
+	{
+	}
+
+	std::vector<QualityLevel> QualityGovernor::MakeDefaultLevels()
+	{
+		// Each step gives up what costs the most for the least visible loss first
+		std::vector<QualityLevel> Levels(4);
+		Levels[1].LODBias = 0.75f;
+		Levels[1].ShadowResolution = 1536;
+		Levels[1].MaxLightsPerCluster = 32;
+
+		Levels[2].LODBias = 0.5f;
+		Levels[2].ShadowResolution = 1024;
+		Levels[2].CascadeCount = 3;
+		Levels[2].bAmbientOcclusion = false;
+		Levels[2].ParticleBudget = 0.5f;
+		Levels[2].MaxLightsPerCluster = 16;
+
+		Levels[3].LODBias = 0.35f;
+		Levels[3].ShadowResolution = 1024;
+		Levels[3].CascadeCount = 1;
+		Levels[3].bAmbientOcclusion = false;
+		Levels[3].ParticleBudget = 0.25f;
+		Levels[3].MaxLightsPerCluster = 8;
+		return Levels;
+	}
+
+	void QualityGovernor::SetLevels(std::vector<QualityLevel> Levels)
+	{
+		LOG_ASSERT(!Levels.empty(), "A quality governor needs at least one level")
+		m_Levels = std::move(Levels);
+		Reset(0);
+	}
+
+	const std::vector<QualityLevel>& QualityGovernor::GetLevels() const
+	{
+		return m_Levels;
+	}
+
+	void QualityGovernor::SetTargetFrameTime(float Milliseconds)
+	{
+		m_TargetFrameTime = std::max(Milliseconds, 0.1f);
+	}
+
+	float QualityGovernor::GetTargetFrameTime() const
+	{
+		return m_TargetFrameTime;
+	}
+
+	void QualityGovernor::SetHysteresis(float DowngradeRatio, float UpgradeRatio, uint32_t DowngradeFrames, uint32_t UpgradeFrames)
+	{
+		m_DowngradeRatio = std::max(DowngradeRatio, 1.0f);
+		m_UpgradeRatio = std::clamp(UpgradeRatio, 0.0f, 1.0f);
+		m_DowngradeFrames = std::max<uint32_t>(DowngradeFrames, 1);
+		m_UpgradeFrames = std::max<uint32_t>(UpgradeFrames, 1);
+	}
+
+	void QualityGovernor::Reset(size_t Level)
+	{
+		m_State = QualityGovernorState();
+		m_State.Level = std::min(Level, m_Levels.size() - 1);
+	}
+
+	bool QualityGovernor::Update(float FrameTime, float GPUFrameTime)
+	{
+		// The first frame seeds the averages, a long loading frame would otherwise drag them for a while
+		m_State.FrameTime = m_State.FrameTime == 0.0f ? FrameTime : m_State.FrameTime + (FrameTime - m_State.FrameTime) * SmoothingFactor;
+		if (GPUFrameTime > 0.0f)
+		{
+			m_State.GPUFrameTime = m_State.GPUFrameTime == 0.0f ? GPUFrameTime : m_State.GPUFrameTime + (GPUFrameTime - m_State.GPUFrameTime) * SmoothingFactor;
+		}
+
+		const float Cost = std::max(m_State.FrameTime, m_State.GPUFrameTime);
+		const float Headroom = m_State.GPUFrameTime > 0.0f ? m_State.GPUFrameTime : m_State.FrameTime;
+		const bool bOverBudget = Cost > m_TargetFrameTime * m_DowngradeRatio;
+		const bool bUnderBudget = Headroom < m_TargetFrameTime * m_UpgradeRatio;
+		m_State.FramesOverBudget = bOverBudget ? m_State.FramesOverBudget + 1 : 0;
+		m_State.FramesUnderBudget = bUnderBudget ? m_State.FramesUnderBudget + 1 : 0;
+
+		if (m_State.FramesOverBudget >= m_DowngradeFrames && m_State.Level + 1 < m_Levels.size())
+		{
+			ChangeLevel(m_State.Level + 1);
+			return true;
+		}
+		if (m_State.FramesUnderBudget >= m_UpgradeFrames && m_State.Level > 0)
+		{
+			ChangeLevel(m_State.Level - 1);
+			return true;
+		}
+		return false;
+	}
+
+	void QualityGovernor::ChangeLevel(size_t Level)
+	{
+		// The averages still hold frames of the previous level, the counts only start from the next frame
+		m_State.Level = Level;
+		m_State.FramesOverBudget = 0;
+		m_State.FramesUnderBudget = 0;
+		m_State.Changes++;
+	}
+
+	size_t QualityGovernor::GetLevel() const
+	{
+		return m_State.Level;
+	}
+
+	const QualityLevel& QualityGovernor::GetCurrentLevel() const
+	{
+		return m_Levels[m_State.Level];
+	}
+
+	const QualityGovernorState& QualityGovernor::GetState() const
+	{
+		return m_State;
+	}
+
+} // namespace fgl
@@ -0,0 +1,419 @@
+#include <FireGL/Renderer/ReflectionProbes.h>
+#include <FireGL/Renderer/Renderer.h>
+#include <FireGL/Renderer/Scene.h>
+#include <FireGL/Renderer/SceneObject.h>
+#include <FireGL/Renderer/BaseCamera.h>
+#include <FireGL/Renderer/Material.h>
+#include <FireGL/Renderer/GLStateCache.h>
+#include <FireGL/Renderer/GPUMemoryTracker.h>
+#include <FireGL/Renderer/RenderStats.h>
+#include <FireGL/Core/BaseLog.h>
+#include <FireGL/Core/Profiler.h>
+
+#include <External/glm/geometric.hpp>
+
+namespace fgl
+{
+
+	namespace
+	{
+		/** Camera of the captures, its view set face by face. */
+		class CaptureCamera final : public BaseCamera
+		{
+		public:
+			void ProcessMovementInput(CameraMovement MovementDirection, float DeltaTime) override {}
+			void ProcessRotationInput(float XOffset, float YOffset) override {}
+		};
+
+		// Directions and up vectors of the faces, in the order and orientation of GL_TEXTURE_CUBE_MAP_POSITIVE_X + Face
+		const glm::vec3 FaceFronts[6] = {
+			glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f),
+			glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 0.0f, -1.0f)
+		};
+		const glm::vec3 FaceUps[6] = {
+			glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f),
+			glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f)
+		};
+
+		constexpr std::string_view FullScreenVertexCode = R"(#version 410 core
+void main()
+{
+    // vertices (0, 0), (2, 0) and (0, 2) cover the target
+    vec2 Corner = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    gl_Position = vec4(Corner * 2.0 - 1.0, 0.0, 1.0);
+})";
+
+		// The GGX convolution of ImageBasedLighting, with fewer samples: it runs again on every refresh
+		constexpr std::string_view PrefilterFragmentCode = R"(#version 410 core
+out vec4 FragColor;
+
+uniform samplerCube Environment;
+uniform int Face;
+uniform float FaceSize;
+uniform float EnvironmentSize;
+uniform float Roughness;
+uniform int SampleCount;
+
+const float PI = 3.14159265359;
+
+vec3 GetDirection()
+{
+    vec2 Coord = gl_FragCoord.xy / FaceSize * 2.0 - 1.0;
+    if (Face == 0)      return vec3(1.0, -Coord.y, -Coord.x);
+    else if (Face == 1) return vec3(-1.0, -Coord.y, Coord.x);
+    else if (Face == 2) return vec3(Coord.x, 1.0, Coord.y);
+    else if (Face == 3) return vec3(Coord.x, -1.0, -Coord.y);
+    else if (Face == 4) return vec3(Coord.x, -Coord.y, 1.0);
+    return vec3(-Coord.x, -Coord.y, -1.0);
+}
+
+vec2 Hammersley(uint Index, uint Count)
+{
+    return vec2(float(Index) / float(Count), float(bitfieldReverse(Index)) * 2.3283064365386963e-10);
+}
+
+vec3 ImportanceSampleGGX(vec2 Xi, vec3 N, float Alpha)
+{
+    float Phi = 2.0 * PI * Xi.x;
+    float CosTheta = sqrt((1.0 - Xi.y) / (1.0 + (Alpha * Alpha - 1.0) * Xi.y));
+    float SinTheta = sqrt(1.0 - CosTheta * CosTheta);
+    vec3 Up = abs(N.z) < 0.999 ? vec3(0.0, 0.0, 1.0) : vec3(1.0, 0.0, 0.0);
+    vec3 TangentX = normalize(cross(Up, N));
+    vec3 TangentY = cross(N, TangentX);
+    return normalize(TangentX * (SinTheta * cos(Phi)) + TangentY * (SinTheta * sin(Phi)) + N * CosTheta);
+}
+
+void main()
+{
+    vec3 N = normalize(GetDirection());
+    float BaseLod = max(log2(EnvironmentSize / FaceSize), 0.0);
+    if (Roughness == 0.0)
+    {
+        FragColor = vec4(textureLod(Environment, N, BaseLod).rgb, 1.0);
+        return;
+    }
+
+    float Alpha = Roughness * Roughness;
+    float TexelSolidAngle = 4.0 * PI / (6.0 * EnvironmentSize * EnvironmentSize);
+    vec3 Sum = vec3(0.0);
+    float Weight = 0.0;
+    for (int Sample = 0; Sample < SampleCount; Sample++)
+    {
+        vec3 H = ImportanceSampleGGX(Hammersley(uint(Sample), uint(SampleCount)), N, Alpha);
+        vec3 L = 2.0 * dot(N, H) * H - N;
+        float NdotL = dot(N, L);
+        if (NdotL <= 0.0)
+            continue;
+
+        // Each sample reads the level matching its solid angle, so few samples still integrate the whole lobe
+        float NdotH = max(dot(N, H), 0.0);
+        float Denominator = NdotH * NdotH * (Alpha * Alpha - 1.0) + 1.0;
+        float D = Alpha * Alpha / (PI * Denominator * Denominator);
+        float SampleSolidAngle = 1.0 / (float(SampleCount) * D * 0.25 + 0.0001);
+        float Lod = max(0.5 * log2(SampleSolidAngle / TexelSolidAngle) + 1.0, BaseLod);
+        Sum += textureLod(Environment, L, Lod).rgb * NdotL;
+        Weight += NdotL;
+    }
+    FragColor = vec4(Sum / max(Weight, 0.0001), 1.0);
+})";
+	}
+
+	ReflectionProbes::~ReflectionProbes()
+	{
+		Destroy();
+	}
+
+	void ReflectionProbes::Create(const ReflectionProbeSettings& Settings)
+	{
+		Destroy();
+		m_Settings = Settings;
+		m_Settings.Resolution = std::max(m_Settings.Resolution, 1 << (PrefilteredLevels - 1));
+		const int Resolution = m_Settings.Resolution;
+
+		glGenTextures(1, &m_ProbeMaps);
+		GLStateCache::BindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, m_ProbeMaps);
+		for (int Level = 0; Level < PrefilteredLevels; Level++)
+		{
+			const int LevelSize = std::max(Resolution >> Level, 1);
+			glTexImage3D(GL_TEXTURE_CUBE_MAP_ARRAY, Level, GL_RGB16F, LevelSize, LevelSize, 6 * MaxProbes, 0, GL_RGB, GL_HALF_FLOAT, nullptr);
+		}
+		glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_MAX_LEVEL, PrefilteredLevels - 1);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+		GLStateCache::BindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, 0);
+		GPUMemoryTracker::TrackTexture(m_ProbeMaps, GPUMemoryTracker::GetTextureSize(GL_RGB16F, Resolution, Resolution, 6 * MaxProbes, PrefilteredLevels),
+			GPUMemoryCategory::Textures, "ReflectionProbes");
+
+		// The staging faces keep their full mip chain, the convolution reads the levels matching its samples
+		const int StagingLevels = static_cast<int>(GPUMemoryTracker::GetMipLevelCount(Resolution, Resolution));
+		glGenTextures(1, &m_StagingMap);
+		GLStateCache::BindTexture(GL_TEXTURE_CUBE_MAP, m_StagingMap);
+		for (int Face = 0; Face < 6; Face++)
+		{
+			glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + Face, 0, GL_RGB16F, Resolution, Resolution, 0, GL_RGB, GL_HALF_FLOAT, nullptr);
+		}
+		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+		glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
+		GLStateCache::BindTexture(GL_TEXTURE_CUBE_MAP, 0);
+		GPUMemoryTracker::TrackTexture(m_StagingMap, GPUMemoryTracker::GetTextureSize(GL_RGB16F, Resolution, Resolution, 6, StagingLevels),
+			GPUMemoryCategory::RenderTargets, "ReflectionProbes");
+
+		glGenFramebuffers(1, &m_Framebuffer);
+		glGenVertexArrays(1, &m_FullScreenVertexArray);
+		m_CaptureTarget.Resize(Resolution, Resolution, 0, GL_RGBA16F);
+		m_CaptureCamera = std::make_shared<CaptureCamera>();
+		m_CaptureCamera->SetPerspective(90.0f, 1.0f, m_Settings.Near, m_Settings.Far);
+		Bind();
+	}
+
+	void ReflectionProbes::Destroy()
+	{
+		for (GLuint* Texture : { &m_ProbeMaps, &m_StagingMap })
+		{
+			if (*Texture == 0)
+				continue;
+
+			glDeleteTextures(1, Texture);
+			GLStateCache::OnTextureDeleted(*Texture);
+			GPUMemoryTracker::UntrackTexture(*Texture);
+			*Texture = 0;
+		}
+		if (m_Framebuffer != 0)
+		{
+			glDeleteFramebuffers(1, &m_Framebuffer);
+			m_Framebuffer = 0;
+		}
+		if (m_FullScreenVertexArray != 0)
+		{
+			glDeleteVertexArrays(1, &m_FullScreenVertexArray);
+			GLStateCache::OnVertexArrayDeleted(m_FullScreenVertexArray);
+			m_FullScreenVertexArray = 0;
+		}
+		m_CaptureTarget.Destroy();
+		m_CaptureCamera.reset();
+		m_PrefilterShader.reset();
+		m_Probes.clear();
+		m_CurrentProbe = UINT32_MAX;
+		m_CurrentFace = 0;
+		m_NextContinuous = 0;
+	}
+
+	bool ReflectionProbes::IsCreated() const
+	{
+		return m_ProbeMaps != 0;
+	}
+
+	ReflectionProbeSettings& ReflectionProbes::GetSettings()
+	{
+		return m_Settings;
+	}
+
+	uint32_t ReflectionProbes::AddProbe(const glm::vec3& Position, float Radius)
+	{
+		if (m_Probes.size() >= MaxProbes)
+		{
+			LOG_ERROR("No room for another reflection probe, " + std::to_string(MaxProbes) + " at most.", false);
+			return UINT32_MAX;
+		}
+
+		m_Probes.push_back({ Position, std::max(Radius, 0.0f), true });
+		return static_cast<uint32_t>(m_Probes.size() - 1);
+	}
+
+	void ReflectionProbes::SetProbe(uint32_t Probe, const glm::vec3& Position, float Radius)
+	{
+		LOG_ASSERT(Probe < m_Probes.size(), "Invalid reflection probe index.")
+		m_Probes[Probe].Position = Position;
+		m_Probes[Probe].Radius = std::max(Radius, 0.0f);
+		m_Probes[Probe].bDirty = true;
+	}
+
+	uint32_t ReflectionProbes::GetProbeCount() const
+	{
+		return static_cast<uint32_t>(m_Probes.size());
+	}
+
+	void ReflectionProbes::MarkDirty(uint32_t Probe)
+	{
+		LOG_ASSERT(Probe < m_Probes.size(), "Invalid reflection probe index.")
+		m_Probes[Probe].bDirty = true;
+	}
+
+	void ReflectionProbes::MarkAllDirty()
+	{
+		for (Probe& Current : m_Probes)
+		{
+			Current.bDirty = true;
+		}
+	}
+
+	bool ReflectionProbes::IsUpdating() const
+	{
+		if (m_CurrentProbe != UINT32_MAX)
+			return true;
+
+		return std::any_of(m_Probes.begin(), m_Probes.end(), [](const Probe& Current) { return Current.bDirty; });
+	}
+
+	void ReflectionProbes::Update(Renderer& Target, Scene* Scene)
+	{
+		if (!IsCreated())
+			return;
+
+		FGL_PROFILE_SCOPE("ReflectionProbes::Update")
+		m_CaptureCamera->SetPerspective(90.0f, 1.0f, m_Settings.Near, m_Settings.Far);
+		for (uint32_t Budget = std::max(m_Settings.FacesPerUpdate, 1u); Budget > 0; Budget--)
+		{
+			if (m_CurrentProbe == UINT32_MAX)
+			{
+				m_CurrentProbe = SelectNextProbe();
+				m_CurrentFace = 0;
+				if (m_CurrentProbe == UINT32_MAX)
+					break;
+
+				// Cleared when the capture starts, so a change during the capture queues another one
+				m_Probes[m_CurrentProbe].bDirty = false;
+			}
+
+			CaptureFace(Target, Scene);
+			if (++m_CurrentFace == 6)
+			{
+				Prefilter();
+				m_CurrentProbe = UINT32_MAX;
+			}
+		}
+	}
+
+	void ReflectionProbes::AssignNearest(Scene* Scene) const
+	{
+		for (const std::unique_ptr<SceneObject>& Object : Scene->GetObjects())
+		{
+			const glm::vec3 Center = glm::vec3(Object->GetTransform().GetModelMatrix() * glm::vec4(Object->GetLocalBoundingSphere().Center, 1.0f));
+			uint32_t Nearest = 0;
+			float NearestDistance = std::numeric_limits<float>::max();
+			for (uint32_t Index = 0; Index < m_Probes.size(); Index++)
+			{
+				const glm::vec3 Offset = Center - m_Probes[Index].Position;
+				const float Distance = glm::dot(Offset, Offset);
+				if (Distance <= m_Probes[Index].Radius * m_Probes[Index].Radius && Distance < NearestDistance)
+				{
+					Nearest = Index + 1;
+					NearestDistance = Distance;
+				}
+			}
+			Object->SetReflectionProbe(Nearest);
+		}
+	}
+
+	void ReflectionProbes::Bind() const
+	{
+		GLStateCache::BindTextureUnit(TextureUnit, GL_TEXTURE_CUBE_MAP_ARRAY, m_ProbeMaps);
+	}
+
+	GLuint ReflectionProbes::GetProbeMaps() const
+	{
+		return m_ProbeMaps;
+	}
+
+	void ReflectionProbes::CaptureFace(Renderer& Target, Scene* Scene)
+	{
+		const Probe& Current = m_Probes[m_CurrentProbe];
+		m_CaptureCamera->SetView(Current.Position, FaceFronts[m_CurrentFace], FaceUps[m_CurrentFace]);
+		Target.RenderCapture(Scene, *m_CaptureCamera, m_CaptureTarget, m_Settings.LODBias);
+
+		GLint ReadFramebuffer = 0;
+		GLint DrawFramebuffer = 0;
+		glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &ReadFramebuffer);
+		glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &DrawFramebuffer);
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, m_CaptureTarget.GetResolveFramebuffer());
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_Framebuffer);
+		glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + m_CurrentFace, m_StagingMap, 0);
+		const GLint Size = m_Settings.Resolution;
+		glBlitFramebuffer(0, 0, Size, Size, 0, 0, Size, Size, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, ReadFramebuffer);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, DrawFramebuffer);
+	}
+
+	void ReflectionProbes::Prefilter()
+	{
+		if (!m_PrefilterShader)
+		{
+			m_PrefilterShader = Shader::CreateFromSource(FullScreenVertexCode, PrefilterFragmentCode);
+		}
+
+		GLint Viewport[4];
+		GLint DrawFramebuffer = 0;
+		glGetIntegerv(GL_VIEWPORT, Viewport);
+		glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &DrawFramebuffer);
+		const GLboolean bDepthTest = glIsEnabled(GL_DEPTH_TEST);
+		const GLboolean bBlend = glIsEnabled(GL_BLEND);
+		const GLboolean bSeamless = glIsEnabled(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+
+		GLStateCache::BindTextureUnit(SourceUnit, GL_TEXTURE_CUBE_MAP, m_StagingMap);
+		glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_Framebuffer);
+		glDisable(GL_DEPTH_TEST);
+		glDisable(GL_BLEND);
+		glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+		GLStateCache::BindVertexArray(m_FullScreenVertexArray);
+		m_PrefilterShader->Activate();
+		m_PrefilterShader->SetInt("Environment", SourceUnit);
+		m_PrefilterShader->SetFloat("EnvironmentSize", static_cast<float>(m_Settings.Resolution));
+		m_PrefilterShader->SetInt("SampleCount", std::max(m_Settings.PrefilterSamples, 1));
+
+		// Roughness grows linearly with the level, every face of the probe's layer is rewritten
+		for (int Level = 0; Level < PrefilteredLevels; Level++)
+		{
+			const int LevelSize = std::max(m_Settings.Resolution >> Level, 1);
+			glViewport(0, 0, LevelSize, LevelSize);
+			m_PrefilterShader->SetFloat("FaceSize", static_cast<float>(LevelSize));
+			m_PrefilterShader->SetFloat("Roughness", static_cast<float>(Level) / static_cast<float>(PrefilteredLevels - 1));
+			for (int Face = 0; Face < 6; Face++)
+			{
+				glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, m_ProbeMaps, Level, static_cast<GLint>(m_CurrentProbe * 6 + Face));
+				m_PrefilterShader->SetInt("Face", Face);
+				glDrawArrays(GL_TRIANGLES, 0, 3);
+				RenderCounters::CountDraw(1, 1);
+			}
+		}
+
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, DrawFramebuffer);
+		glViewport(Viewport[0], Viewport[1], Viewport[2], Viewport[3]);
+		if (bDepthTest)
+		{
+			glEnable(GL_DEPTH_TEST);
+		}
+		if (bBlend)
+		{
+			glEnable(GL_BLEND);
+		}
+		if (!bSeamless)
+		{
+			glDisable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+		}
+		Material::InvalidateActiveMaterial();
+		Bind();
+	}
+
+	uint32_t ReflectionProbes::SelectNextProbe()
+	{
+		for (uint32_t Index = 0; Index < m_Probes.size(); Index++)
+		{
+			if (m_Probes[Index].bDirty)
+				return Index;
+		}
+		if (!m_Settings.bContinuous || m_Probes.empty())
+			return UINT32_MAX;
+
+		m_NextContinuous = (m_NextContinuous + 1) % static_cast<uint32_t>(m_Probes.size());
+		return m_NextContinuous;
+	}
+
+} // namespace fgl
@@ -0,0 +1,160 @@
+#include <FireGL/Renderer/RenderCommandList.h>
+#include <FireGL/Renderer/RenderDevice.h>
+#include <FireGL/Renderer/Material.h>
+#include <FireGL/Renderer/Mesh.h>
+#include <FireGL/Renderer/SceneObject.h>
+#include <FireGL/Core/BaseLog.h>
+#include <FireGL/Core/Profiler.h>
+
+namespace fgl
+{
+
+	void RenderCommandList::BeginPacket(uint64_t SortKey)
+	{
+		m_Packets.push_back({ SortKey, static_cast<uint32_t>(m_Commands.size()), 0 });
+	}
+
+	void RenderCommandList::BindShader(Shader* Program)
+	{
+		Push(RenderCommandType::BindShader).Program = Program;
+	}
+
+	void RenderCommandList::BindMaterial(Material* BoundMaterial)
+	{
+		Push(RenderCommandType::BindMaterial).BoundMaterial = BoundMaterial;
+	}
+
+	void RenderCommandList::SetInstanceRange(size_t InstanceCount, size_t BaseInstance)
+	{
+		RenderCommand& Command = Push(RenderCommandType::SetInstanceRange);
+		Command.InstanceCount = InstanceCount;
+		Command.BaseInstance = BaseInstance;
+	}
+
+	void RenderCommandList::DrawMesh(const BaseMesh& Mesh, uint32_t LOD)
+	{
+		RenderCommand& Command = Push(RenderCommandType::DrawMesh);
+		Command.Mesh = &Mesh;
+		Command.LOD = LOD;
+	}
+
+	void RenderCommandList::DrawMeshInfo(const MeshDrawInfo& Info)
+	{
+		Push(RenderCommandType::DrawMeshInfo).DrawInfo = &Info;
+	}
+
+	void RenderCommandList::DrawObject(const SceneObject& Object, uint32_t LOD)
+	{
+		RenderCommand& Command = Push(RenderCommandType::DrawObject);
+		Command.Object = &Object;
+		Command.LOD = LOD;
+	}
+
+	void RenderCommandList::DrawProxy(const RenderProxy& Proxy, uint32_t LOD)
+	{
+		// Submeshes sharing a material in a row bind it once
+		Material* LastMaterial = nullptr;
+		if (!Proxy.Draws.empty())
+		{
+			for (const MeshDrawInfo& Info : Proxy.GetDraws(LOD))
+			{
+				if (Info.DrawMaterial && Info.DrawMaterial != LastMaterial)
+				{
+					BindMaterial(Info.DrawMaterial);
+					LastMaterial = Info.DrawMaterial;
+				}
+				DrawMeshInfo(Info);
+			}
+			return;
+		}
+
+		for (const BaseMesh& Mesh : Proxy.Meshes)
+		{
+			Material* MeshMaterial = Mesh.GetMaterial().get();
+			if (MeshMaterial && MeshMaterial != LastMaterial)
+			{
+				BindMaterial(MeshMaterial);
+				LastMaterial = MeshMaterial;
+			}
+			DrawMesh(Mesh, LOD);
+		}
+	}
+
+	void RenderCommandList::Invoke(void (*Function)(void*), void* Data)
+	{
+		RenderCommand& Command = Push(RenderCommandType::Invoke);
+		Command.Function = Function;
+		Command.Data = Data;
+	}
+
+	void RenderCommandList::PushDebugGroup(const char* Label)
+	{
+		Push(RenderCommandType::PushDebugGroup).Label = Label;
+	}
+
+	void RenderCommandList::PopDebugGroup()
+	{
+		Push(RenderCommandType::PopDebugGroup);
+	}
+
+	void RenderCommandList::Clear()
+	{
+		m_Commands.clear();
+		m_Packets.clear();
+	}
+
+	RenderCommand& RenderCommandList::Push(RenderCommandType Type)
+	{
+		LOG_ASSERT(!m_Packets.empty(), "Render commands are recorded after RenderCommandList::BeginPacket()")
+		m_Packets.back().Count++;
+		RenderCommand& Command = m_Commands.emplace_back();
+		Command.Type = Type;
+		return Command;
+	}
+
+	RenderCommandList& RenderCommandQueue::AcquireList()
+	{
+		std::lock_guard<std::mutex> Lock(m_Mutex);
+		if (m_AcquiredCount == m_Lists.size())
+		{
+			m_Lists.push_back(std::make_unique<RenderCommandList>());
+		}
+		return *m_Lists[m_AcquiredCount++];
+	}
+
+	void RenderCommandQueue::Submit()
+	{
+		FGL_PROFILE_SCOPE("RenderCommandQueue::Submit")
+		m_Order.Clear();
+		m_PacketRefs.clear();
+		for (uint32_t ListIndex = 0; ListIndex < m_AcquiredCount; ListIndex++)
+		{
+			const RenderCommandList& List = *m_Lists[ListIndex];
+			for (uint32_t PacketIndex = 0; PacketIndex < List.m_Packets.size(); PacketIndex++)
+			{
+				m_Order.Push(List.m_Packets[PacketIndex].Key, static_cast<uint32_t>(m_PacketRefs.size()));
+				m_PacketRefs.emplace_back(ListIndex, PacketIndex);
+			}
+		}
+		m_Order.Sort();
+
+		RenderDevice& Device = RenderDevice::Get();
+		for (const RenderQueueItem& Item : m_Order.GetItems())
+		{
+			const auto [ListIndex, PacketIndex] = m_PacketRefs[Item.Payload];
+			const RenderCommandList& List = *m_Lists[ListIndex];
+			const RenderCommandList::Packet& Packet = List.m_Packets[PacketIndex];
+			Device.ExecuteCommands({ List.m_Commands.data() + Packet.First, Packet.Count });
+		}
+
+		// Material raster state doesn't outlive the queue, the passes drawn next expect no culling
+		Device.BindPipeline({ nullptr, { CullMode::None, GL_LESS, true } });
+
+		for (size_t ListIndex = 0; ListIndex < m_AcquiredCount; ListIndex++)
+		{
+			m_Lists[ListIndex]->Clear();
+		}
+		m_AcquiredCount = 0;
+	}
+
+} // namespace fgl
@@ -0,0 +1,25 @@
+#include <FireGL/Renderer/RenderDevice.h>
+#include <FireGL/Renderer/OpenGLRenderDevice.h>
+
+namespace fgl
+{
+
+	RenderDevice& RenderDevice::Get()
+	{
+		static OpenGLRenderDevice Device;
+		return Device;
+	}
+
+	void RenderDevice::ResizeBuffer(BufferHandle& Buffer, const BufferDesc& Desc, size_t PreservedBytes)
+	{
+		BufferHandle NewBuffer = CreateBuffer(Desc);
+		const size_t Preserved = std::min(PreservedBytes, std::min(Buffer.Size, NewBuffer.Size));
+		if (Buffer && Preserved > 0)
+		{
+			CopyBuffer(Buffer, 0, NewBuffer, 0, Preserved);
+		}
+		DestroyBuffer(Buffer);
+		Buffer = NewBuffer;
+	}
+
+} // namespace fgl
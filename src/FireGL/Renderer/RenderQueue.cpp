@@ -0,0 +1,89 @@
+#include <FireGL/Renderer/RenderQueue.h>
+
+#include <cstring>
+
+namespace fgl
+{
+
+	uint64_t RenderQueue::MakeSortKey(uint32_t Pass, uint32_t ShaderID, uint32_t MaterialID, size_t MeshID, float ViewDepth)
+	{
+		// The bit pattern of a non-negative float increases with its value, its top 16 bits are a coarse depth
+		float ClampedDepth = std::max(ViewDepth, 0.0f);
+		uint32_t DepthBits;
+		std::memcpy(&DepthBits, &ClampedDepth, sizeof(DepthBits));
+
+		return (static_cast<uint64_t>(Pass & 0xF) << 60)
+			| (static_cast<uint64_t>(ShaderID & 0xFFF) << 48)
+			| (static_cast<uint64_t>(MaterialID & 0xFFFF) << 32)
+			| (static_cast<uint64_t>(MeshID & 0xFFFF) << 16)
+			| static_cast<uint64_t>(DepthBits >> 16);
+	}
+
+	uint64_t RenderQueue::MakeBackToFrontKey(uint32_t Pass, float ViewDepth, uint32_t ShaderID, uint32_t MaterialID)
+	{
+		// Inverting the bit pattern of the depth sorts larger depths first
+		float ClampedDepth = std::max(ViewDepth, 0.0f);
+		uint32_t DepthBits;
+		std::memcpy(&DepthBits, &ClampedDepth, sizeof(DepthBits));
+
+		return (static_cast<uint64_t>(Pass & 0xF) << 60)
+			| (static_cast<uint64_t>(~DepthBits) << 28)
+			| (static_cast<uint64_t>(ShaderID & 0xFFF) << 16)
+			| static_cast<uint64_t>(MaterialID & 0xFFFF);
+	}
+
+	void RenderQueue::Clear()
+	{
+		m_Items.clear();
+	}
+
+	void RenderQueue::Push(uint64_t Key, uint32_t Payload)
+	{
+		m_Items.push_back({ Key, Payload });
+	}
+
+	void RenderQueue::Sort()
+	{
+		constexpr size_t DigitBits = 8;
+		constexpr size_t BucketCount = size_t(1) << DigitBits;
+
+		if (m_Items.size() < 2)
+			return;
+
+		m_Scratch.resize(m_Items.size());
+		std::array<uint32_t, BucketCount> Counts;
+
+		for (size_t Shift = 0; Shift < 64; Shift += DigitBits)
+		{
+			Counts.fill(0);
+			for (const RenderQueueItem& Item : m_Items)
+			{
+				Counts[(Item.Key >> Shift) & (BucketCount - 1)]++;
+			}
+
+			// Every key shares this digit, the pass would not move anything
+			if (Counts[(m_Items.front().Key >> Shift) & (BucketCount - 1)] == m_Items.size())
+				continue;
+
+			uint32_t Offset = 0;
+			for (uint32_t& Count : Counts)
+			{
+				uint32_t Current = Count;
+				Count = Offset;
+				Offset += Current;
+			}
+
+			for (const RenderQueueItem& Item : m_Items)
+			{
+				m_Scratch[Counts[(Item.Key >> Shift) & (BucketCount - 1)]++] = Item;
+			}
+			m_Items.swap(m_Scratch);
+		}
+	}
+
+	const std::vector<RenderQueueItem>& RenderQueue::GetItems() const
+	{
+		return m_Items;
+	}
+
+} // namespace fgl
\ No newline at end of file
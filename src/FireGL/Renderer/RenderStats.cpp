@@ -0,0 +1,15 @@
+#include <FireGL/Renderer/RenderStats.h>
+
+namespace fgl
+{
+
+	RenderStats RenderCounters::s_Stats;
+
+	RenderStats RenderCounters::Collect()
+	{
+		const RenderStats Stats = s_Stats;
+		s_Stats = RenderStats();
+		return Stats;
+	}
+
+} // namespace fgl
@@ -0,0 +1,235 @@
+#include <FireGL/Renderer/RenderTarget.h>
+#include <FireGL/Renderer/Shader.h>
+#include <FireGL/Renderer/GLStateCache.h>
+#include <FireGL/Renderer/GPUMemoryTracker.h>
+#include <FireGL/Renderer/RenderStats.h>
+#include <FireGL/Core/BaseLog.h>
+
+namespace fgl
+{
+
+	namespace
+	{
+		constexpr std::string_view PresentVertexCode = R"(#version 410 core
+out vec2 TexCoords;
+
+void main()
+{
+    // vertices (0, 0), (2, 0) and (0, 2) cover the screen
+    TexCoords = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    gl_Position = vec4(TexCoords * 2.0 - 1.0, 0.0, 1.0);
+})";
+
+		constexpr std::string_view PresentFragmentCode = R"(#version 410 core
+in vec2 TexCoords;
+out vec4 FragColor;
+
+uniform sampler2D SourceColor;
+
+void main()
+{
+    FragColor = texture(SourceColor, TexCoords);
+})";
+	}
+
+	RenderTarget::~RenderTarget()
+	{
+		Destroy();
+	}
+
+	void RenderTarget::Resize(int Width, int Height, int Samples, GLenum ColorFormat)
+	{
+		Samples = Samples > 1 ? Samples : 0;
+		if (m_Framebuffer != 0 && Width == m_Width && Height == m_Height && Samples == m_Samples && ColorFormat == m_ColorFormat)
+			return;
+
+		DestroyAttachments();
+		m_Width = Width;
+		m_Height = Height;
+		m_Samples = Samples;
+		m_ColorFormat = ColorFormat;
+
+		GLint DrawFramebuffer = 0;
+		glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &DrawFramebuffer);
+
+		m_ColorTexture = CreateTexture(m_ColorFormat, GL_RGBA, GL_UNSIGNED_BYTE);
+		m_DepthTexture = CreateTexture(GL_DEPTH24_STENCIL8, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8);
+		glGenFramebuffers(1, &m_ResolveFramebuffer);
+		glBindFramebuffer(GL_FRAMEBUFFER, m_ResolveFramebuffer);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_ColorTexture, 0);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, m_DepthTexture, 0);
+		LOG_ASSERT(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE, "Render target framebuffer is incomplete");
+		m_Framebuffer = m_ResolveFramebuffer;
+
+		if (m_Samples > 0)
+		{
+			m_ColorRenderbuffer = CreateRenderbuffer(m_ColorFormat);
+			m_DepthRenderbuffer = CreateRenderbuffer(GL_DEPTH24_STENCIL8);
+			glGenFramebuffers(1, &m_Framebuffer);
+			glBindFramebuffer(GL_FRAMEBUFFER, m_Framebuffer);
+			glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_ColorRenderbuffer);
+			glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_DepthRenderbuffer);
+			LOG_ASSERT(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE, "Multisampled render target framebuffer is incomplete");
+		}
+		glBindFramebuffer(GL_FRAMEBUFFER, DrawFramebuffer);
+	}
+
+	GLuint RenderTarget::CreateTexture(GLenum InternalFormat, GLenum Format, GLenum Type) const
+	{
+		GLuint Texture;
+		glGenTextures(1, &Texture);
+		GLStateCache::BindTexture(GL_TEXTURE_2D, Texture);
+		glTexImage2D(GL_TEXTURE_2D, 0, InternalFormat, m_Width, m_Height, 0, Format, Type, nullptr);
+		GPUMemoryTracker::TrackTexture(Texture, GPUMemoryTracker::GetTextureSize(InternalFormat, m_Width, m_Height), GPUMemoryCategory::RenderTargets, "RenderTarget");
+
+		// Filtered when presented at another size
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		return Texture;
+	}
+
+	GLuint RenderTarget::CreateRenderbuffer(GLenum InternalFormat) const
+	{
+		GLuint Renderbuffer;
+		glGenRenderbuffers(1, &Renderbuffer);
+		glBindRenderbuffer(GL_RENDERBUFFER, Renderbuffer);
+		glRenderbufferStorageMultisample(GL_RENDERBUFFER, m_Samples, InternalFormat, m_Width, m_Height);
+		GPUMemoryTracker::Track(GPUObjectType::Renderbuffer, Renderbuffer, GPUMemoryTracker::GetTextureSize(InternalFormat, m_Width, m_Height) * std::max(m_Samples, 1),
+			GPUMemoryCategory::RenderTargets, "RenderTarget");
+		return Renderbuffer;
+	}
+
+	void RenderTarget::Destroy()
+	{
+		DestroyAttachments();
+		if (!m_PresentShader)
+			return;
+
+		m_PresentShader->Cleanup();
+		m_PresentShader.reset();
+		glDeleteVertexArrays(1, &m_FullScreenVertexArray);
+		GLStateCache::OnVertexArrayDeleted(m_FullScreenVertexArray);
+		m_FullScreenVertexArray = 0;
+	}
+
+	void RenderTarget::DestroyAttachments()
+	{
+		if (m_ResolveFramebuffer == 0)
+			return;
+
+		if (m_Framebuffer != m_ResolveFramebuffer)
+		{
+			glDeleteFramebuffers(1, &m_Framebuffer);
+			glDeleteRenderbuffers(1, &m_ColorRenderbuffer);
+			glDeleteRenderbuffers(1, &m_DepthRenderbuffer);
+			GPUMemoryTracker::Untrack(GPUObjectType::Renderbuffer, m_ColorRenderbuffer);
+			GPUMemoryTracker::Untrack(GPUObjectType::Renderbuffer, m_DepthRenderbuffer);
+			m_ColorRenderbuffer = 0;
+			m_DepthRenderbuffer = 0;
+		}
+		glDeleteFramebuffers(1, &m_ResolveFramebuffer);
+		m_Framebuffer = 0;
+		m_ResolveFramebuffer = 0;
+
+		for (GLuint* Texture : { &m_ColorTexture, &m_DepthTexture })
+		{
+			glDeleteTextures(1, Texture);
+			GLStateCache::OnTextureDeleted(*Texture);
+			GPUMemoryTracker::UntrackTexture(*Texture);
+			*Texture = 0;
+		}
+	}
+
+	void RenderTarget::Bind() const
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, m_Framebuffer);
+		glViewport(0, 0, m_Width, m_Height);
+	}
+
+	void RenderTarget::Resolve() const
+	{
+		if (m_Framebuffer == m_ResolveFramebuffer)
+			return;
+
+		GLint ReadFramebuffer = 0;
+		GLint DrawFramebuffer = 0;
+		glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &ReadFramebuffer);
+		glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &DrawFramebuffer);
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, m_Framebuffer);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_ResolveFramebuffer);
+		glBlitFramebuffer(0, 0, m_Width, m_Height, 0, 0, m_Width, m_Height, GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, ReadFramebuffer);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, DrawFramebuffer);
+	}
+
+	void RenderTarget::Present()
+	{
+		if (!m_PresentShader)
+		{
+			m_PresentShader = Shader::CreateFromSource(PresentVertexCode, PresentFragmentCode);
+			glGenVertexArrays(1, &m_FullScreenVertexArray);
+		}
+
+		GLStateCache::BindTextureUnit(PresentUnit, GL_TEXTURE_2D, m_ColorTexture);
+		m_PresentShader->Activate();
+		m_PresentShader->SetInt("SourceColor", PresentUnit);
+
+		// The debug modes draw lines, the triangle must be filled to cover every pixel
+		GLint PolygonMode[2];
+		glGetIntegerv(GL_POLYGON_MODE, PolygonMode);
+		const GLboolean bDepthTest = glIsEnabled(GL_DEPTH_TEST);
+		glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+		glDisable(GL_DEPTH_TEST);
+		GLStateCache::BindVertexArray(m_FullScreenVertexArray);
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+		RenderCounters::CountDraw(1, 1);
+		glPolygonMode(GL_FRONT_AND_BACK, static_cast<GLenum>(PolygonMode[0]));
+		if (bDepthTest)
+		{
+			glEnable(GL_DEPTH_TEST);
+		}
+	}
+
+	GLuint RenderTarget::GetFramebuffer() const
+	{
+		return m_Framebuffer;
+	}
+
+	GLuint RenderTarget::GetResolveFramebuffer() const
+	{
+		return m_ResolveFramebuffer;
+	}
+
+	GLuint RenderTarget::GetColorTexture() const
+	{
+		return m_ColorTexture;
+	}
+
+	GLuint RenderTarget::GetDepthTexture() const
+	{
+		return m_DepthTexture;
+	}
+
+	int RenderTarget::GetWidth() const
+	{
+		return m_Width;
+	}
+
+	int RenderTarget::GetHeight() const
+	{
+		return m_Height;
+	}
+
+	int RenderTarget::GetSamples() const
+	{
+		return m_Samples;
+	}
+
+	GLenum RenderTarget::GetColorFormat() const
+	{
+		return m_ColorFormat;
+	}
+
+} // namespace fgl
@@ -0,0 +1,106 @@
+#include <FireGL/Renderer/RenderTargetPool.h>
+#include <FireGL/Renderer/GLStateCache.h>
+#include <FireGL/Renderer/GPUMemoryTracker.h>
+#include <FireGL/Core/BaseLog.h>
+
+namespace fgl
+{
+
+	RenderTargetPool::~RenderTargetPool()
+	{
+		Destroy();
+	}
+
+	PooledTarget RenderTargetPool::Acquire(int Width, int Height, GLenum Format)
+	{
+		for (Entry& Candidate : m_Entries)
+		{
+			const PooledTarget& Target = Candidate.Target;
+			if (!Candidate.bInUse && Target.Width == Width && Target.Height == Height && Target.Format == Format)
+			{
+				Candidate.bInUse = true;
+				Candidate.IdleFrames = 0;
+				return Target;
+			}
+		}
+
+		Entry& Created = m_Entries.emplace_back();
+		Created.bInUse = true;
+		PooledTarget& Target = Created.Target;
+		Target.Width = Width;
+		Target.Height = Height;
+		Target.Format = Format;
+
+		glGenTextures(1, &Target.Texture);
+		GLStateCache::BindTexture(GL_TEXTURE_2D, Target.Texture);
+		glTexImage2D(GL_TEXTURE_2D, 0, Format, Width, Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		GPUMemoryTracker::TrackTexture(Target.Texture, GPUMemoryTracker::GetTextureSize(Format, Width, Height), GPUMemoryCategory::RenderTargets, "RenderTargetPool");
+
+		GLint DrawFramebuffer = 0;
+		glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &DrawFramebuffer);
+		glGenFramebuffers(1, &Target.Framebuffer);
+		glBindFramebuffer(GL_FRAMEBUFFER, Target.Framebuffer);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, Target.Texture, 0);
+		LOG_ASSERT(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE, "Pooled render target framebuffer is incomplete")
+		glBindFramebuffer(GL_FRAMEBUFFER, DrawFramebuffer);
+		return Target;
+	}
+
+	void RenderTargetPool::Release(const PooledTarget& Target)
+	{
+		for (Entry& Candidate : m_Entries)
+		{
+			if (Candidate.Target.Framebuffer == Target.Framebuffer)
+			{
+				LOG_ASSERT(Candidate.bInUse, "Pooled render target released twice")
+				Candidate.bInUse = false;
+				return;
+			}
+		}
+		LOG_ASSERT(false, "Released render target doesn't belong to the pool")
+	}
+
+	void RenderTargetPool::EndFrame()
+	{
+		for (size_t Index = 0; Index < m_Entries.size();)
+		{
+			Entry& Candidate = m_Entries[Index];
+			if (Candidate.bInUse || ++Candidate.IdleFrames < MaxIdleFrames)
+			{
+				Index++;
+				continue;
+			}
+
+			DeleteTarget(Candidate.Target);
+			Candidate = m_Entries.back();
+			m_Entries.pop_back();
+		}
+	}
+
+	void RenderTargetPool::Destroy()
+	{
+		for (const Entry& Candidate : m_Entries)
+		{
+			DeleteTarget(Candidate.Target);
+		}
+		m_Entries.clear();
+	}
+
+	size_t RenderTargetPool::GetTargetCount() const
+	{
+		return m_Entries.size();
+	}
+
+	void RenderTargetPool::DeleteTarget(const PooledTarget& Target)
+	{
+		glDeleteFramebuffers(1, &Target.Framebuffer);
+		glDeleteTextures(1, &Target.Texture);
+		GLStateCache::OnTextureDeleted(Target.Texture);
+		GPUMemoryTracker::UntrackTexture(Target.Texture);
+	}
+
+} // namespace fgl
@@ -1,91 +1,2593 @@
 #include <FireGL/Renderer/Renderer.h>
 #include <FireGL/Renderer/SceneObject.h>
 #include <FireGL/Renderer/Scene.h>
+#include <FireGL/Renderer/BaseCamera.h>
+#include <FireGL/Renderer/Frustum.h>
+#include <FireGL/Renderer/Material.h>
+#include <FireGL/Renderer/Shader.h>
+#include <FireGL/Renderer/Texture.h>
+#include <FireGL/Renderer/ParticleSystem.h>
+#include <FireGL/Renderer/SpriteBatch.h>
+#include <FireGL/Renderer/Terrain.h>
+#include <FireGL/Renderer/DynamicMesh.h>
+#include <FireGL/Renderer/GLStateCache.h>
+#include <FireGL/Renderer/Mesh.h>
+#include <FireGL/Renderer/PixelUploadPool.h>
+#include <FireGL/Renderer/MipGenerator.h>
+#include <FireGL/Renderer/TransformPool.h>
+#include <FireGL/Renderer/StaticGeometry.h>
+#include <FireGL/Renderer/PortalGraph.h>
+#include <FireGL/Renderer/GPUMemoryTracker.h>
+#include <FireGL/Core/GLDebug.h>
+#include <FireGL/Core/JobSystem.h>
+#include <FireGL/Core/BaseLog.h>
+#include <FireGL/Core/Profiler.h>
+#include <FireGL/Core/StartupTimeline.h>
+#include <FireGL/Core/InputManager.h>
+#include <FireGL/Core/SystemManager.h>
+#include <FireGL/Core/TimeManager.h>
+#include <FireGL/Core/Window.h>
 
 #include <External/glad/glad.h>
+#include <External/glm/common.hpp>
+
+#include <chrono>
 
 namespace fgl
 {
 
-	Renderer::Renderer(RenderingMode Mode)
+	namespace
+	{
+		// Same position math as BaseLighting.vert, so the shading pass passes the GL_EQUAL depth test
+		constexpr std::string_view DepthPrepassVertexCode = R"(#version 410 core
+#ifdef VERTEX_PULLING
+#extension GL_ARB_shader_storage_buffer_object : require
+#extension GL_ARB_shader_draw_parameters : require
+#extension GL_ARB_shading_language_420pack : require
+#extension GL_ARB_shading_language_packing : require
+#endif
+layout (location = 0) in vec3 aPos;
+layout (location = 3) in mat4 ModelMatrix;
+layout (location = 7) in mat3x4 NormalMatrix;
+
+layout (std140) uniform CameraData
+{
+    mat4 View;
+    mat4 Projection;
+    mat4 ViewProjection;
+    vec4 Position;
+    mat4 InverseViewProjection;
+    vec4 Time;
+} Camera;
+
+// Same procedural animation as BaseLighting.vert, see ProceduralAnimation
+float UnpackHalf(uint Bits)
+{
+    float Mantissa = float(Bits & 0x3FFu);
+    uint Exponent = (Bits >> 10u) & 0x1Fu;
+    float Value = Exponent == 0u ? Mantissa * exp2(-24.0) : (1024.0 + Mantissa) * exp2(float(Exponent) - 25.0);
+    return (Bits & 0x8000u) != 0u ? -Value : Value;
+}
+
+mat3 ProceduralRotation(uvec3 Packed, float Time, out vec3 Offset)
+{
+    vec2 Octahedral = vec2(Packed.x & 0xFFu, (Packed.x >> 8u) & 0xFFu) / 127.5 - 1.0;
+    vec3 Axis = vec3(Octahedral, 1.0 - abs(Octahedral.x) - abs(Octahedral.y));
+    if (Axis.z < 0.0)
+        Axis.xy = (1.0 - abs(Axis.yx)) * mix(vec2(-1.0), vec2(1.0), greaterThanEqual(Axis.xy, vec2(0.0)));
+    Axis = normalize(Axis);
+    float Wave = sin(6.2831853 * UnpackHalf(Packed.z >> 16u) * Time + UnpackHalf(Packed.z & 0xFFFFu));
+    float Angle = UnpackHalf(Packed.x >> 16u) * Time + UnpackHalf(Packed.y & 0xFFFFu) * Wave;
+    Offset = Axis * (UnpackHalf(Packed.y >> 16u) * Wave);
+    float Cosine = cos(Angle);
+    return mat3(Cosine) + sin(Angle) * mat3(0.0, Axis.z, -Axis.y, -Axis.z, 0.0, Axis.x, Axis.y, -Axis.x, 0.0) + (1.0 - Cosine) * outerProduct(Axis, Axis);
+}
+
+#ifdef VERTEX_PULLING
+// Same fetch as the VERTEX_PULLING variant of BaseLighting.vert, see GeometryArena
+layout (std430, binding = 15) buffer StandardVertices { uint StandardWords[]; };
+layout (std430, binding = 16) buffer PackedVertices { uint PackedWords[]; };
+layout (std430, binding = 17) buffer SkinnedVertices { uint SkinnedWords[]; };
+layout (std430, binding = 18) buffer LightmappedVertices { uint LightmappedWords[]; };
+struct PulledInstance { mat4 Model; vec4 NormalColumns[3]; uvec4 TextureLayers; uvec4 Indices; vec4 Payload; };
+layout (std430, binding = 19) buffer PulledInstances { PulledInstance Instances[]; };
+
+vec3 PullPosition(uint Format, uint Index)
+{
+    if (Format == 2u)
+        return vec3(unpackHalf2x16(PackedWords[Index * 4u]), unpackHalf2x16(PackedWords[Index * 4u + 1u]).x);
+    if (Format == 3u)
+        return uintBitsToFloat(uvec3(SkinnedWords[Index * 11u], SkinnedWords[Index * 11u + 1u], SkinnedWords[Index * 11u + 2u]));
+    if (Format == 4u)
+        return uintBitsToFloat(uvec3(LightmappedWords[Index * 10u], LightmappedWords[Index * 10u + 1u], LightmappedWords[Index * 10u + 2u]));
+    return uintBitsToFloat(uvec3(StandardWords[Index * 8u], StandardWords[Index * 8u + 1u], StandardWords[Index * 8u + 2u]));
+}
+#endif
+
+void main()
+{
+    vec3 Position = aPos;
+    mat4 Model = ModelMatrix;
+    uvec3 Animation = floatBitsToUint(vec3(NormalMatrix[0].w, NormalMatrix[1].w, NormalMatrix[2].w));
+#ifdef VERTEX_PULLING
+    // Format plus 1 in the top bits of pulled draws, 0 for draws through the format VAOs
+    uint Format = uint(gl_VertexID) >> 28u;
+    if (Format != 0u)
+    {
+        PulledInstance Instance = Instances[gl_BaseInstanceARB + gl_InstanceID];
+        Position = PullPosition(Format, uint(gl_VertexID) & 0x0FFFFFFFu);
+        Model = Instance.Model;
+        Animation = floatBitsToUint(vec3(Instance.NormalColumns[0].w, Instance.NormalColumns[1].w, Instance.NormalColumns[2].w));
+    }
+#endif
+    if (Animation != uvec3(0u))
+    {
+        vec3 Offset;
+        Position = ProceduralRotation(Animation, Camera.Time.x, Offset) * Position + Offset;
+    }
+    vec3 FragPos = vec3(Model * vec4(Position, 1.0));
+    gl_Position = Camera.ViewProjection * vec4(FragPos, 1.0);
+})";
+
+		static_assert(GeometryArena::PulledVertexBindingPoint == 15 && GeometryArena::PulledInstanceBindingPoint == 19 && GeometryArena::PulledFormatShift == 28,
+			"The pulling shaders hardcode the GeometryArena bindings");
+		static_assert(sizeof(InstanceData) == 160, "PulledInstance of the pulling shaders mirrors InstanceData");
+
+		constexpr std::string_view DepthPrepassFragmentCode = R"(#version 410 core
+void main()
+{
+})";
+
+		// The far plane minus the near plane of each corner, so perspective and orthographic cameras both work
+		constexpr std::string_view SkyVertexCode = R"(#version 410 core
+layout (std140) uniform CameraData
+{
+    mat4 View;
+    mat4 Projection;
+    mat4 ViewProjection;
+    vec4 Position;
+    mat4 InverseViewProjection;
+} Camera;
+
+out vec3 Direction;
+
+void main()
+{
+    // vertices (0, 0), (2, 0) and (0, 2) cover the screen, at depth 1 so only uncovered pixels pass GL_LEQUAL
+    vec2 Corner = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2) * 2.0 - 1.0;
+    vec4 Far = Camera.InverseViewProjection * vec4(Corner, 1.0, 1.0);
+    vec4 Near = Camera.InverseViewProjection * vec4(Corner, -1.0, 1.0);
+    Direction = Far.xyz / Far.w - Near.xyz / Near.w;
+    gl_Position = vec4(Corner, 1.0, 1.0);
+})";
+
+		constexpr std::string_view SkyFragmentCode = R"(#version 410 core
+in vec3 Direction;
+out vec4 FragColor;
+
+uniform samplerCube Skybox;
+
+void main()
+{
+    FragColor = texture(Skybox, Direction);
+})";
+
+		constexpr GLint SkyUnit = 0; ///< Unit the sky CubeMap is bound to while drawn.
+
+		/** Pass field of the sort keys of the recorded commands, in replay order. */
+		namespace BatchPass
+		{
+			constexpr uint32_t PrepassBegin = 0; ///< Switches to the depth prepass.
+			constexpr uint32_t Prepass = 1;      ///< Depth-only draws of the batches.
+			constexpr uint32_t PrepassEnd = 2;   ///< Switches to shading against the prepass depth.
+			constexpr uint32_t Shading = 3;      ///< Batches, with their materials.
+			constexpr uint32_t ShadingEnd = 4;   ///< Restores the depth test after a prepass.
+			constexpr uint32_t Skybox = 5;       ///< The skybox, drawn after the opaque batches.
+			constexpr uint32_t Transparent = 6;  ///< Objects of transparent materials, drawn last.
+		}
+
+		/** @return True if the object's material is blended, drawn by the transparent pass rather than with the opaque batches. */
+		bool IsTransparent(const SceneObject& Object)
+		{
+			const std::shared_ptr<Material>& ObjectMaterial = Object.GetRenderProxy().ObjectMaterial;
+			return ObjectMaterial && ObjectMaterial->GetRenderState().BlendMode == MaterialBlendMode::Transparent;
+		}
+
+		// Mesh and depth fields of a sort key (see RenderQueue), prepass draws are ordered by them alone
+		constexpr uint64_t PrepassKeyMask = (uint64_t(1) << 32) - 1;
+
+		// Batches recorded per job when a job system is set
+		constexpr size_t BatchRecordChunkSize = 256;
+
+		/** One pipeline of PrewarmPipelines(): what the driver compiles a program variant for, and a mesh drawing with it. */
+		struct PrewarmDraw
+		{
+			const Shader* Program;  ///< Program of the mesh's material
+			GLuint VertexArray;     ///< Vertex array of the mesh's vertex format
+			GLenum IndexType;       ///< Index type of the mesh
+			RasterState Raster;     ///< Raster state of the mesh's material
+			bool bTransparent;      ///< Whether the object is drawn by the transparent pass
+			const BaseMesh* Mesh;   ///< First mesh seen with this combination
+
+			bool SharesPipeline(const PrewarmDraw& Other) const
+			{
+				return Program == Other.Program && VertexArray == Other.VertexArray && IndexType == Other.IndexType
+					&& Raster == Other.Raster && bTransparent == Other.bTransparent;
+			}
+		};
+
+		void AddPrewarmDraws(std::vector<PrewarmDraw>& Draws, std::span<const BaseMesh> Meshes, bool bTransparent)
+		{
+			for (const BaseMesh& Mesh : Meshes)
+			{
+				const Material* MeshMaterial = Mesh.GetMaterial().get();
+				if (!MeshMaterial || Mesh.GetVertexArray() == 0)
+					continue;
+
+				const MaterialRenderState& State = MeshMaterial->GetRenderState();
+				const PrewarmDraw Draw{ State.Program, Mesh.GetVertexArray(), Mesh.GetIndexType(), State.Raster, bTransparent, &Mesh };
+				if (std::none_of(Draws.begin(), Draws.end(), [&Draw](const PrewarmDraw& Added) { return Added.SharesPipeline(Draw); }))
+				{
+					Draws.push_back(Draw);
+				}
+			}
+		}
+
+#if defined(FIREGL_ENABLE_GL_DEBUG)
+		/** @return The name of a batch in capture tools: the fragment shader of its material, when loaded from a file. */
+		const char* GetBatchLabel(const Shader* Program)
+		{
+			return Program && !Program->GetFragmentPath().empty() ? Program->GetFragmentPath().c_str() : "Batch";
+		}
+#endif
+
+		/** Writes a ProceduralAnimation::Pack() bit for bit into the unused w of the normal matrix columns. */
+		void WriteProceduralAnimation(InstanceData& Instance, const glm::uvec3& PackedAnimation)
+		{
+			for (glm::length_t Column = 0; Column < 3; Column++)
+			{
+				Instance.NormalMatrix[Column].w = glm::uintBitsToFloat(PackedAnimation[Column]);
+			}
+		}
+
+		/** Copy of the active camera's view a prepared frame is drawn from, never moved by input. */
+		class SnapshotCamera final : public BaseCamera
+		{
+		public:
+			void ProcessMovementInput(CameraMovement MovementDirection, float DeltaTime) override {}
+			void ProcessRotationInput(float XOffset, float YOffset) override {}
+		};
+	}
+
+	Renderer::Renderer(RenderingMode Mode)
+	{
+		ConfigureRenderingMode(Mode);
+		SetupBuffer();
+	}
+
+	Renderer::~Renderer()
+	{
+		CleanupBuffer();
+	}
+
+	void Renderer::ConfigureRenderingMode(RenderingMode NewMode)
+	{
+		m_Mode = NewMode;
+		switch (NewMode)
+		{
+		case RenderingMode::Default:
+			glEnable(GL_DEPTH_TEST);
+			break;
+		case RenderingMode::DebugLine:
+			glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+			break;
+		case RenderingMode::DebugFill:
+			glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+			break;
+		case RenderingMode::Deferred:
+			glEnable(GL_DEPTH_TEST);
+			glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+			break;
+		}
+		if (m_AntiAliasing == AntiAliasingMode::MSAA)
+		{
+			glEnable(GL_MULTISAMPLE);
+		}
+		else
+		{
+			glDisable(GL_MULTISAMPLE);
+		}
+	}
+
+	void Renderer::SetupBuffer()
+	{
+		m_MVPMatrixBuffer.CreateGPUBuffer();
+		m_CameraBuffer.Create();
+		m_LightBuffer.Create();
+		if (IndirectDrawBuffer::IsSupported())
+		{
+			m_IndirectBuffer.Create();
+		}
+		if (MaterialBuffer::IsSupported())
+		{
+			m_MaterialBuffer.Create();
+		}
+		if (MaterialInstanceBuffer::IsSupported())
+		{
+			m_MaterialInstances.Create();
+		}
+		if (ClusteredLightManager::IsSupported())
+		{
+			m_ClusteredLights.Create();
+		}
+		m_ShadowMaps.Create();
+		m_ShadowInstances.CreateGPUBuffer();
+		m_LocalShadowAtlas.Create();
+		m_LocalShadowInstances.CreateGPUBuffer();
+		m_SSAO.Create();
+		m_Fog.Create();
+	}
+
+	void Renderer::CleanupBuffer()
+	{
+		m_MVPMatrixBuffer.DestroyGPUBuffer();
+		m_CameraBuffer.Destroy();
+		m_LightBuffer.Destroy();
+		m_IndirectBuffer.Destroy();
+		m_MaterialBuffer.Destroy();
+		m_MaterialInstances.Destroy();
+		m_ClusteredLights.Destroy();
+		m_GPUCulling.Destroy();
+		m_HiZBuffer.Destroy();
+		m_OcclusionQueries.Destroy();
+		m_ShadowMaps.Destroy();
+		m_ShadowInstances.DestroyGPUBuffer();
+		m_LocalShadowAtlas.Destroy();
+		m_LocalShadowInstances.DestroyGPUBuffer();
+		m_SceneTarget.Destroy();
+		m_PostProcess.Destroy();
+		m_SSAO.Destroy();
+		m_Fog.Destroy();
+		m_ResolutionController.Destroy();
+		m_GPUProfiler.Destroy();
+		m_ObjectPicker.Destroy();
+#if defined(FIREGL_ENABLE_DEBUG_DRAW)
+		m_DebugDraw.Destroy();
+#endif
+		m_GBuffer.Destroy();
+		m_TransparencyBuffer.Destroy();
+		m_BonePalettes.Destroy();
+		if (m_StaticInstanceBuffer != 0)
+		{
+			glDeleteBuffers(1, &m_StaticInstanceBuffer);
+			GLStateCache::OnBufferDeleted(m_StaticInstanceBuffer);
+			GPUMemoryTracker::UntrackBuffer(m_StaticInstanceBuffer);
+			m_StaticInstanceBuffer = 0;
+		}
+		m_StaticRevision = 0;
+		m_GeometryArena.Destroy();
+		PixelUploadPool::Destroy();
+		MipGenerator::Destroy();
+		if (m_SkyShader)
+		{
+			m_SkyShader->Cleanup();
+			m_SkyShader.reset();
+			RenderDevice::Get().DestroyVertexArray(m_SkyVertexArray);
+		}
+	}
+
+	void Renderer::PrepareFrame(Scene* Scene)
+	{
+		FGL_PROFILE_SCOPE("Renderer::PrepareFrame")
+		if (m_LateLatchInput)
+		{
+			LatchCameraInput(Scene);
+		}
+
+		// The object list stays as drawn until the next call, objects added or removed meanwhile wait for it
+		Scene->SetDeferredChanges(true);
+		Scene->ApplyDeferredChanges();
+
+		TransformPool::UpdateDirtyMatrices(m_JobSystem);
+		Scene->UpdateBoundingSpheres();
+		TransformPool::CaptureSnapshot();
+		Material::CaptureChanges();
+		m_LightBuffer.Capture();
+		m_ClusteredLights.Capture();
+
+		if (!m_FrameCamera)
+		{
+			m_FrameCamera = std::make_shared<SnapshotCamera>();
+		}
+		m_FrameCamera->CopyView(*Scene->GetActiveCamera());
+#if defined(FIREGL_ENABLE_DEBUG_DRAW)
+		m_DebugDraw.Latch();
+#endif
+		if (m_Overlay)
+		{
+			m_Overlay->Latch();
+		}
+		m_bFramePrepared = true;
+	}
+
+	void Renderer::Render(Scene* Scene)
+	{
+		FGL_PROFILE_SCOPE("Renderer::Render")
+		const bool bCapture = m_CaptureCamera != nullptr;
+
+		// A minimized window shows nothing, the frame is dropped with the snapshot prepared for it
+		const BaseWindow* Window = SystemManager<BaseWindow>::Get();
+		if (Window && !Window->IsPresentable())
+		{
+			m_bFramePrepared = false;
+			return;
+		}
+
+		if (!m_bFramePrepared && !bCapture)
+		{
+			TransformPool::DiscardSnapshot();
+			Material::CaptureChanges();
+			m_LightBuffer.Capture();
+			m_ClusteredLights.Capture();
+			if (m_LateLatchInput)
+			{
+				LatchCameraInput(Scene);
+			}
+#if defined(FIREGL_ENABLE_DEBUG_DRAW)
+			m_DebugDraw.Latch();
+#endif
+			if (m_Overlay)
+			{
+				m_Overlay->Latch();
+			}
+		}
+		m_FrameArena.BeginFrame();
+		if (m_DynamicResolution || m_QualityGovernorEnabled)
+		{
+			m_ResolutionController.BeginFrame();
+		}
+		if (!bCapture)
+		{
+			m_GPUProfiler.BeginFrame();
+		}
+
+		// A headless output target replaces the default framebuffer, its size is the viewport
+		const GLuint OutputFramebuffer = m_OutputTarget ? m_OutputTarget->GetFramebuffer() : 0;
+		if (m_OutputTarget)
+		{
+			m_OutputTarget->Bind();
+		}
+
+		// Below full resolution every pass sees the offscreen target as its output, upscaled once everything is drawn
+		GLint OutputViewport[4];
+		glGetIntegerv(GL_VIEWPORT, OutputViewport);
+		GLint Viewport[4] = { OutputViewport[0], OutputViewport[1], OutputViewport[2], OutputViewport[3] };
+		const bool bRenderTarget = UsesRenderTarget();
+		if (bRenderTarget)
+		{
+			const float Scale = GetAppliedRenderScale();
+			m_SceneTarget.Resize(std::max(static_cast<int>(std::lround(OutputViewport[2] * Scale)), 1),
+				std::max(static_cast<int>(std::lround(OutputViewport[3] * Scale)), 1), m_AntiAliasing == AntiAliasingMode::MSAA ? m_RenderTargetSamples : 0,
+				m_PostProcessing ? PostProcessStack::SceneFormat : GL_RGBA8);
+			m_SceneTarget.Bind();
+			Viewport[0] = 0;
+			Viewport[1] = 0;
+			Viewport[2] = m_SceneTarget.GetWidth();
+			Viewport[3] = m_SceneTarget.GetHeight();
+		}
+		m_GPUProfiler.BeginPass("Clear");
+		ClearFrameBuffer();
+		m_GPUProfiler.EndPass();
+		m_GPUProfiler.BeginPass("Upload");
+		if (!bCapture)
+		{
+			CompactGeometry(Scene);
+		}
+		UploadPendingObjects(Scene);
+		UploadStaticGeometry(Scene);
+		m_BonePalettes.Upload();
+		m_GPUProfiler.EndPass();
+		SceneObject* Skybox = nullptr;
+		const bool bGPUCulling = UsesGPUCulling();
+		FrameBatchList ObjectBatches(m_FrameArena.GetResource());
+		if (bGPUCulling)
+		{
+			Skybox = UpdateGPUObjects(Scene);
+			RenderCounters::SetObjects(0, 0, static_cast<uint32_t>(m_Batches.size()));
+		}
+		else
+		{
+			// Changes drained by CPU frames never reach the GPU copy, it is rewritten if GPU culling comes back
+			ObjectBatches = BatchSceneObjects(Scene, Skybox);
+			m_GPUObjectsCurrent = false;
+		}
+
+		// RenderViews() draws the frame once per view: culling, batches and instances above are shared, each view
+		// only updates the camera and lights and records its draws into its rectangle
+		const bool bViews = !m_Views.empty();
+		BaseCamera& Camera = bViews ? *m_Views.front().Camera : GetFrameCamera(Scene);
+		const bool bUpscaling = m_AntiAliasing == AntiAliasingMode::TemporalUpscaling;
+		const bool bTemporal = (m_AntiAliasing == AntiAliasingMode::TAA || bUpscaling) && bRenderTarget;
+		const glm::vec2 Jitter = bTemporal ? PostProcessStack::GetJitterOffset(m_TemporalFrame++) : glm::vec2(0.0f);
+		if (m_MaterialInstances.IsCreated())
+		{
+			m_MaterialInstances.Update();
+		}
+		if (UsesBindlessMaterials())
+		{
+			if (bGPUCulling)
+			{
+				UpdateGPUMaterialBuffer();
+			}
+			else
+			{
+				UpdateMaterialBuffer(ObjectBatches);
+			}
+		}
+		if (!bGPUCulling)
+		{
+			m_MVPMatrixBuffer.BeginFrame();
+			UpdateMVPInstances(ObjectBatches);
+		}
+
+		// The deferred geometry pass draws the same batches into the G-buffer, lit afterwards in one pass
+		const bool bDeferred = m_Mode == RenderingMode::Deferred && m_DeferredLightingShader && !bViews;
+		const size_t ViewCount = bViews ? m_Views.size() : 1;
+
+		// Clock of the procedural animations, evaluated by the vertex shaders
+		TimeManager* Time = SystemManager<TimeManager>::Get();
+		const float Seconds = Time ? static_cast<float>(Time->GetTimeSeconds()) : 0.0f;
+		for (size_t ViewIndex = 0; ViewIndex < ViewCount; ViewIndex++)
+		{
+			BaseCamera& ViewCamera = bViews ? *m_Views[ViewIndex].Camera : Camera;
+			GLint ViewViewport[4] = { Viewport[0], Viewport[1], Viewport[2], Viewport[3] };
+			if (bViews)
+			{
+				const glm::vec4& Rectangle = m_Views[ViewIndex].Rectangle;
+				ViewViewport[0] = Viewport[0] + static_cast<GLint>(std::lround(Rectangle.x * Viewport[2]));
+				ViewViewport[1] = Viewport[1] + static_cast<GLint>(std::lround(Rectangle.y * Viewport[3]));
+				ViewViewport[2] = std::max(static_cast<GLint>(std::lround(Rectangle.z * Viewport[2])), 1);
+				ViewViewport[3] = std::max(static_cast<GLint>(std::lround(Rectangle.w * Viewport[3])), 1);
+				glViewport(ViewViewport[0], ViewViewport[1], ViewViewport[2], ViewViewport[3]);
+			}
+			if (bTemporal)
+			{
+				// Culling above used the unjittered view, the jitter only moves the rasterization
+				ViewCamera.SetJitter(Jitter * 2.0f / glm::vec2(ViewViewport[2], ViewViewport[3]));
+			}
+			m_CameraBuffer.Update(ViewCamera, Seconds);
+			m_LightBuffer.Update(ViewCamera);
+			if (ClusteredLightManager::IsSupported() && !m_ClusteredLights.GetRenderLights().empty())
+			{
+				m_ClusteredLights.Update(ViewCamera, ViewViewport[2], ViewViewport[3]);
+			}
+
+			// The cascades of the first view serve every view, the shadow map is drawn once per frame
+			if (ViewIndex == 0 && m_Shadows)
+			{
+				m_ShadowMaps.Update(m_CameraBuffer.GetData(), glm::vec3(m_LightBuffer.GetRenderData().DirectionalLight.Direction));
+				m_GPUProfiler.BeginPass("Shadows");
+				RenderShadowCasters(Scene);
+				m_GPUProfiler.EndPass();
+				if (bViews)
+				{
+					glBindFramebuffer(GL_FRAMEBUFFER, bRenderTarget ? m_SceneTarget.GetFramebuffer() : OutputFramebuffer);
+					glViewport(ViewViewport[0], ViewViewport[1], ViewViewport[2], ViewViewport[3]);
+				}
+			}
+			else if (ViewIndex == 0)
+			{
+				m_ShadowMaps.Disable();
+			}
+
+			// Like the cascades, the atlas is culled and drawn for the first view and shared by the others
+			if (ViewIndex == 0 && m_LocalShadows)
+			{
+				m_LocalShadowAtlas.Update(m_LightBuffer.GetRenderData(), m_CameraBuffer.GetData(), ViewViewport[3]);
+				m_GPUProfiler.BeginPass("Local shadows");
+				RenderLocalShadowCasters(Scene);
+				m_GPUProfiler.EndPass();
+				if (bViews)
+				{
+					glBindFramebuffer(GL_FRAMEBUFFER, bRenderTarget ? m_SceneTarget.GetFramebuffer() : OutputFramebuffer);
+					glViewport(ViewViewport[0], ViewViewport[1], ViewViewport[2], ViewViewport[3]);
+				}
+			}
+			else if (ViewIndex == 0)
+			{
+				m_LocalShadowAtlas.Disable();
+			}
+
+			// After the shadows it samples, the history only follows a single view
+			if (m_VolumetricFog && VolumetricFog::IsSupported())
+			{
+				m_GPUProfiler.BeginPass("Volumetric fog");
+				m_Fog.Compute(m_CameraBuffer.GetData(), m_LightBuffer.GetRenderData().DirectionalLight, ViewViewport,
+					ClusteredLightManager::IsSupported() && !m_ClusteredLights.GetRenderLights().empty(), !bViews);
+				m_GPUProfiler.EndPass();
+			}
+			else
+			{
+				m_Fog.Disable();
+			}
+
+			m_GPUProfiler.BeginPass("Batches");
+			if (bDeferred)
+			{
+				m_GBuffer.Resize(Viewport[2], Viewport[3]);
+				m_GBuffer.BindForGeometry();
+			}
+
+			// Unoccluded until the end of the depth prepass computes this frame's occlusion
+			m_SSAO.Disable();
+			if (m_Lightmap && m_Lightmap->IsBaked())
+			{
+				m_Lightmap->Bind();
+			}
+			RenderStaticGeometry(Scene);
+			if (bGPUCulling)
+			{
+				RenderGPUCulledBatches(Scene);
+			}
+			else
+			{
+				RenderBatches(ObjectBatches);
+			}
+			m_GPUProfiler.EndPass();
+			if (!bGPUCulling && m_OcclusionCulling)
+			{
+				m_GPUProfiler.BeginPass("Occlusion queries");
+				IssueOcclusionQueries(Scene);
+				m_GPUProfiler.EndPass();
+			}
+			if (bDeferred)
+			{
+				m_GPUProfiler.BeginPass("Deferred lighting");
+				m_GBuffer.Resolve(*m_DeferredLightingShader, bRenderTarget ? m_SceneTarget.GetFramebuffer() : OutputFramebuffer);
+				Material::InvalidateActiveMaterial();
+				m_GPUProfiler.EndPass();
+			}
+			if (!m_Terrains.empty())
+			{
+				// Forward shaded, after the deferred lighting which copies the depth the terrain is tested against
+				m_GPUProfiler.BeginPass("Terrain");
+				for (Terrain* Ground : m_Terrains)
+				{
+					Ground->Render(ViewCamera, static_cast<float>(ViewViewport[3]));
+				}
+				m_GPUProfiler.EndPass();
+			}
+			if (!m_DynamicMeshes.empty())
+			{
+				// Forward shaded like the terrain; the terrain's program replaced the last material's
+				m_GPUProfiler.BeginPass("Dynamic meshes");
+				Material::InvalidateActiveMaterial();
+				for (DynamicMesh* Mesh : m_DynamicMeshes)
+				{
+					Mesh->Render();
+				}
+				m_GPUProfiler.EndPass();
+			}
+			if (!bGPUCulling && m_Impostors)
+			{
+				// After the deferred lighting, which copies the depth the pictures are tested against
+				m_GPUProfiler.BeginPass("Impostors");
+				RenderImpostors();
+				m_GPUProfiler.EndPass();
+			}
+			m_GPUProfiler.BeginPass("Skybox");
+			if (m_Skybox)
+			{
+				RenderSkyPass();
+			}
+			else
+			{
+				RenderSkybox(Skybox);
+			}
+			m_GPUProfiler.EndPass();
+			if (!bGPUCulling)
+			{
+				// Blended over everything opaque, the sky included; the instances stay in use until then
+				m_GPUProfiler.BeginPass("Transparent");
+				RenderTransparentObjects(ObjectBatches, bRenderTarget ? m_SceneTarget.GetFramebuffer() : OutputFramebuffer, ViewViewport);
+				m_GPUProfiler.EndPass();
+				if (!bCapture && !bViews && m_ObjectPicker.HasRequest())
+				{
+					m_GPUProfiler.BeginPass("Picking");
+					RenderPickingPass(Scene, ObjectBatches, Camera.GetUnjitteredProjectionMatrix() * Camera.GetViewMatrix(), OutputViewport);
+					glBindFramebuffer(GL_FRAMEBUFFER, bRenderTarget ? m_SceneTarget.GetFramebuffer() : OutputFramebuffer);
+					glViewport(Viewport[0], Viewport[1], Viewport[2], Viewport[3]);
+					m_GPUProfiler.EndPass();
+				}
+			}
+			if (!m_ParticleSystems.empty())
+			{
+				m_GPUProfiler.BeginPass("Particles");
+				for (ParticleSystem* Particles : m_ParticleSystems)
+				{
+					Particles->Render();
+				}
+				m_GPUProfiler.EndPass();
+			}
+#if defined(FIREGL_ENABLE_DEBUG_DRAW)
+			if (!bCapture)
+			{
+				// Depth tested against the Scene, before the effects so they are anti-aliased and upscaled with it
+				m_GPUProfiler.BeginPass("Debug Draw");
+				m_DebugDraw.Render();
+				m_GPUProfiler.EndPass();
+			}
+#endif
+		}
+		if (!bGPUCulling)
+		{
+			m_MVPMatrixBuffer.EndFrame();
+		}
+		if (bViews)
+		{
+			glViewport(Viewport[0], Viewport[1], Viewport[2], Viewport[3]);
+		}
+
+		const bool bFXAA = m_AntiAliasing == AntiAliasingMode::FXAA;
+		if (bRenderTarget && (m_PostProcessing || bFXAA || bTemporal))
+		{
+			// The final pass of the effects scales to the viewport, there is no separate upscale
+			m_GPUProfiler.BeginPass("Post-processing");
+			m_SceneTarget.Resolve();
+			GLuint SceneColor = m_SceneTarget.GetColorTexture();
+			int SceneWidth = m_SceneTarget.GetWidth();
+			int SceneHeight = m_SceneTarget.GetHeight();
+			if (bTemporal)
+			{
+				// Upscaling reconstructs at the output size, the effects then run on the reconstructed frame
+				const glm::mat4 ViewProjection = Camera.GetUnjitteredProjectionMatrix() * Camera.GetViewMatrix();
+				const int ResolvedWidth = bUpscaling ? OutputViewport[2] : SceneWidth;
+				const int ResolvedHeight = bUpscaling ? OutputViewport[3] : SceneHeight;
+				SceneColor = m_PostProcess.ResolveTemporal(SceneColor, m_SceneTarget.GetDepthTexture(), SceneWidth, SceneHeight, m_SceneTarget.GetColorFormat(),
+					m_PreviousViewProjection * glm::inverse(ViewProjection), Jitter, ResolvedWidth, ResolvedHeight);
+				m_PreviousViewProjection = ViewProjection;
+				Camera.SetJitter(glm::vec2(0.0f));
+				SceneWidth = ResolvedWidth;
+				SceneHeight = ResolvedHeight;
+			}
+			m_PostProcess.Apply(SceneColor, SceneWidth, SceneHeight, OutputFramebuffer, OutputViewport, m_PostProcessing, bFXAA);
+			Material::InvalidateActiveMaterial();
+			m_GPUProfiler.EndPass();
+		}
+		else if (bRenderTarget)
+		{
+			m_GPUProfiler.BeginPass("Upscale");
+			m_SceneTarget.Resolve();
+			glBindFramebuffer(GL_FRAMEBUFFER, OutputFramebuffer);
+			glViewport(OutputViewport[0], OutputViewport[1], OutputViewport[2], OutputViewport[3]);
+			m_SceneTarget.Present();
+			Material::InvalidateActiveMaterial();
+			m_GPUProfiler.EndPass();
+		}
+		if (m_Overlay && !bCapture)
+		{
+			// Over the final image, neither post-processed nor scaled with the Scene
+			m_GPUProfiler.BeginPass("Overlay");
+			glBindFramebuffer(GL_FRAMEBUFFER, OutputFramebuffer);
+			glViewport(OutputViewport[0], OutputViewport[1], OutputViewport[2], OutputViewport[3]);
+			m_Overlay->Render(OutputViewport[2], OutputViewport[3]);
+			m_GPUProfiler.EndPass();
+		}
+		if (m_OutputTarget)
+		{
+			m_OutputTarget->Resolve();
+		}
+		if (bCapture)
+			return;
+
+		m_FrameCapture.EndFrame(m_OutputTarget ? m_OutputTarget->GetResolveFramebuffer() : 0, OutputViewport[2], OutputViewport[3]);
+		m_ObjectPicker.Collect(Scene);
+		m_GPUProfiler.EndFrame();
+		if (m_DynamicResolution || m_QualityGovernorEnabled)
+		{
+			m_ResolutionController.EndFrame();
+		}
+		if (m_QualityGovernorEnabled)
+		{
+			UpdateQualityGovernor();
+		}
+
+		m_bFramePrepared = false;
+		StartupTimeline::Finish();
+		m_Stats = RenderCounters::Collect();
+		if (m_StatsLogInterval > 0 && ++m_StatsLogFrame >= m_StatsLogInterval)
+		{
+			m_StatsLogFrame = 0;
+			LOG_INFO("Render stats: " + std::to_string(m_Stats.DrawCalls) + " draw calls, " + std::to_string(m_Stats.Instances)
+				+ " instances, " + std::to_string(m_Stats.Triangles) + " triangles, " + std::to_string(m_Stats.Batches) + " batches, "
+				+ std::to_string(m_Stats.VisibleObjects) + " visible / " + std::to_string(m_Stats.CulledObjects) + " culled objects, "
+				+ std::to_string(m_Stats.ProgramBinds) + " program / " + std::to_string(m_Stats.TextureBinds) + " texture / "
+				+ std::to_string(m_Stats.VertexArrayBinds) + " vertex array binds, " + std::to_string(m_Stats.BytesUploaded) + " bytes uploaded")
+		}
+	}
+
+	void Renderer::ClearFrameBuffer()
+	{
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	}
+
+	Renderer::FrameBatchList Renderer::BatchSceneObjects(Scene* Scene, SceneObject*& Skybox)
+	{
+		FGL_PROFILE_SCOPE("Renderer::BatchSceneObjects")
+		const auto& Objects = Scene->GetObjects();
+
+		// Changed matrices are recalculated in one sweep over the pool, before anything reads them
+		// Bounds are refreshed every frame so the Scene's move queue never grows, even without culling
+		// A prepared frame did both before its snapshot
+		if (!m_bFramePrepared)
+		{
+			TransformPool::UpdateDirtyMatrices(m_JobSystem);
+			Scene->UpdateBoundingSpheres();
+		}
+
+		// Lights are picked from the fresh bounds, the objects whose list changed have their instances rewritten below
+		if (m_ObjectLights)
+		{
+			m_ObjectLightAssigner.Assign(Scene, m_LightBuffer.GetRenderData());
+		}
+
+		// Views share the batches, an object is drawn if any of their cameras draws its layers
+		LayerMask CullingMask = 0;
+		for (const RenderView& View : m_Views)
+		{
+			CullingMask |= View.Camera->GetCullingMask();
+		}
+		if (m_Views.empty())
+		{
+			CullingMask = GetFrameCamera(Scene).GetCullingMask();
+		}
+
+		// Compact the visible objects into an index list, the BVH rejects whole groups of objects at once
+		m_VisibleIndices.clear();
+		if (m_FrustumCulling && !m_Views.empty())
+		{
+			// One traversal for every view, an object seen by several is batched once
+			m_ViewFrustums.clear();
+			for (const RenderView& View : m_Views)
+			{
+				m_ViewFrustums.push_back(View.Camera->GetFrustum());
+			}
+			Scene->QueryFrustums(m_ViewFrustums, m_VisibleIndices);
+		}
+		else if (m_FrustumCulling)
+		{
+			BaseCamera& Camera = GetFrameCamera(Scene);
+			const Frustum ViewFrustum = Camera.GetFrustum();
+			Scene->QueryFrustum(ViewFrustum, m_VisibleIndices);
+			if (m_PortalGraph)
+			{
+				// Indoors, only the cells seen through the portals from the camera's cell are drawn
+				m_PortalGraph->ComputeVisibility(Camera.GetViewPosition(), ViewFrustum);
+				if (m_PortalGraph->IsActive())
+				{
+					const BoundingSphereArrays& Spheres = Scene->GetBoundingSpheres();
+					std::erase_if(m_VisibleIndices, [&](uint32_t Index)
+					{
+						if (Objects[Index]->GetRenderProxy().Flags & RenderProxy::Skybox)
+							return false;
+
+						return !m_PortalGraph->IsVisible({ glm::vec3(Spheres.X[Index], Spheres.Y[Index], Spheres.Z[Index]), Spheres.Radius[Index] });
+					});
+				}
+			}
+		}
+		else if ((Scene->GetUsedLayers() & ~CullingMask) != 0)
+		{
+			// Only the lists of the drawn layers are walked
+			Scene->GatherLayerObjects(CullingMask, m_VisibleIndices);
+		}
+		else
+		{
+			for (uint32_t Index = 0; Index < Objects.size(); Index++)
+			{
+				m_VisibleIndices.push_back(Index);
+			}
+		}
+		if (m_FrustumCulling)
+		{
+			Scene->FilterLayers(CullingMask, m_VisibleIndices);
+		}
+
+		const bool bOcclusionCulling = m_OcclusionCulling;
+		if (bOcclusionCulling)
+		{
+			if (!m_OcclusionQueries.IsCreated())
+			{
+				m_OcclusionQueries.Create();
+			}
+			m_OcclusionQueries.BeginFrame(Objects.size());
+		}
+
+		// Batches keep their membership across frames, only their visible objects are refilled
+		for (ObjectBatch& Batch : m_Batches)
+		{
+			Batch.Objects.clear();
+		}
+		for (auto& [Impostor, Instances] : m_ImpostorInstances)
+		{
+			Instances.clear();
+		}
+
+		// Projected size is the sphere radius times the projection's vertical scale, over the view distance in perspective.
+		// Views share the batches, an object takes its level and impostor frame from the view nearest to it
+		m_LODViews.clear();
+		if (m_Views.empty())
+		{
+			m_LODViews.push_back(MakeLODView(GetFrameCamera(Scene)));
+		}
+		for (const RenderView& View : m_Views)
+		{
+			m_LODViews.push_back(MakeLODView(*View.Camera));
+		}
+		const BoundingSphereArrays& Spheres = Scene->GetBoundingSpheres();
+
+		// Objects past the cull distance count as occluded
+		uint32_t OccludedObjects = 0;
+		uint32_t BatchedObjects = 0;
+		for (uint32_t Index : m_VisibleIndices)
+		{
+			SceneObject* Object = Objects[Index].get();
+			if (Object->IsNew() || Object->IsMerged())
+				continue;
+
+			if (Object->GetRenderProxy().Flags & RenderProxy::Skybox)
+			{
+				Skybox = Object;
+				continue;
+			}
+
+			if (bOcclusionCulling && !m_OcclusionQueries.IsVisible(Index, Object))
+			{
+				OccludedObjects++;
+				continue;
+			}
+
+			const glm::vec3 Center(Spheres.X[Index], Spheres.Y[Index], Spheres.Z[Index]);
+			const LODView& View = m_LODViews.size() == 1 ? m_LODViews.front() : GetNearestLODView(Center);
+			if (m_CullDistance > 0.0f)
+			{
+				// A capture's own draw distance, nearer than the camera's far plane
+				const glm::vec3 ToCenter = Center - View.Position;
+				const float Reach = m_CullDistance + Spheres.Radius[Index];
+				if (glm::dot(ToCenter, ToCenter) > Reach * Reach)
+				{
+					OccludedObjects++;
+					continue;
+				}
+			}
+
+			// Far enough, the object is drawn as the picture of its atlas closest to the camera's direction
+			ImpostorAtlas* Impostor = Object->GetImpostor();
+			if (m_Impostors && Impostor && Impostor->IsCaptured())
+			{
+				const glm::vec3 ToCamera = View.Position - Center;
+				if (glm::dot(ToCamera, ToCamera) > Impostor->GetDistance() * Impostor->GetDistance())
+				{
+					const glm::mat3 Rotation(Object->GetTransform().GetModelMatrix());
+					m_ImpostorInstances[Impostor].push_back({ Center, Spheres.Radius[Index], Impostor->SelectFrame(glm::transpose(Rotation) * ToCamera) });
+					BatchedObjects++;
+					continue;
+				}
+			}
+
+			uint32_t BatchIndex = Object->GetBatchIndex();
+			if (BatchIndex == SceneObject::InvalidBatch)
+			{
+				BatchIndex = AssignBatch(Object);
+			}
+
+			if (m_LevelOfDetail && m_Batches[BatchIndex].LODCount > 1)
+			{
+				const float Distance = glm::length(Center - View.Position);
+				float ScreenSize = Spheres.Radius[Index] * View.SizeScale;
+				if (!View.bOrthographic)
+				{
+					// Inside its bounds the object fills the view
+					ScreenSize = Distance > Spheres.Radius[Index] ? ScreenSize / Distance : std::numeric_limits<float>::max();
+				}
+				BatchIndex += SelectLOD(BatchIndex, ScreenSize);
+			}
+			m_Batches[BatchIndex].Objects.push_back(Object);
+			BatchedObjects++;
+		}
+
+		// The list lives in this frame's arena, released by the next BeginFrame()
+		FrameBatchList ObjectBatches(m_FrameArena.GetResource());
+		for (const ObjectBatch& Batch : m_Batches)
+		{
+			if (!Batch.Objects.empty())
+			{
+				ObjectBatches.push_back(&Batch);
+			}
+		}
+		const uint32_t FrustumCulled = static_cast<uint32_t>(Objects.size() - m_VisibleIndices.size());
+		RenderCounters::SetObjects(BatchedObjects, FrustumCulled + OccludedObjects, static_cast<uint32_t>(ObjectBatches.size()));
+		return ObjectBatches;
+	}
+
+	Renderer::LODView Renderer::MakeLODView(BaseCamera& Camera) const
+	{
+		const glm::mat4 Projection = Camera.GetProjectionMatrix();
+		return { Camera.GetViewPosition(), Projection[1][1] * m_LODBias, Projection[3][3] == 1.0f };
+	}
+
+	const Renderer::LODView& Renderer::GetNearestLODView(const glm::vec3& Center) const
+	{
+		const LODView* Nearest = &m_LODViews.front();
+		float NearestDistance = std::numeric_limits<float>::max();
+		for (const LODView& View : m_LODViews)
+		{
+			const glm::vec3 Offset = View.Position - Center;
+			const float Distance = glm::dot(Offset, Offset);
+			if (Distance < NearestDistance)
+			{
+				Nearest = &View;
+				NearestDistance = Distance;
+			}
+		}
+		return *Nearest;
+	}
+
+	uint32_t Renderer::AssignBatch(SceneObject* Object)
+	{
+		// Objects only share a batch when both their meshes and their material match, materials sharing batches counting as one.
+		// The proxy is captured again here, after InvalidateBatch(), so the per-frame loops never call the object's virtual methods
+		Object->CaptureRenderProxy();
+		const RenderProxy& Proxy = Object->GetRenderProxy();
+		const std::shared_ptr<Material>& ObjectMaterial = Proxy.ObjectMaterial;
+		const size_t MeshID = Proxy.MeshID;
+		const uint64_t Key = (static_cast<uint64_t>(ObjectMaterial ? ObjectMaterial->GetBatchID() : 0) << 32) | static_cast<uint32_t>(MeshID);
+
+		auto [It, bInserted] = m_BatchLookup.try_emplace(Key, static_cast<uint32_t>(m_Batches.size()));
+		if (bInserted)
+		{
+			// Objects of one key have equal meshes, so the levels and their screen sizes are read from this one.
+			// Meshes may have fewer levels than others, a level is selected below the largest size of its meshes
+			uint32_t LODCount = 1;
+			for (const BaseMesh& Mesh : Proxy.Meshes)
+			{
+				LODCount = std::max(LODCount, Mesh.GetLODCount());
+			}
+
+			m_Batches.push_back({ Key, MeshID, 0, LODCount, std::numeric_limits<float>::max(), {}, {} });
+			for (uint32_t LOD = 1; LOD < LODCount; LOD++)
+			{
+				float ScreenSize = 0.0f;
+				for (const BaseMesh& Mesh : Proxy.Meshes)
+				{
+					if (LOD < Mesh.GetLODCount())
+					{
+						ScreenSize = std::max(ScreenSize, Mesh.GetLODs()[LOD - 1].ScreenSize);
+					}
+				}
+				m_Batches.push_back({ Key, MeshID, LOD, LODCount, ScreenSize, {}, {} });
+			}
+
+			// The GPU culling path draws batches without going through their objects
+			for (uint32_t LOD = 0; LOD < LODCount; LOD++)
+			{
+				const std::span<const MeshDrawInfo> Infos = Proxy.GetDraws(LOD);
+				for (size_t Index = 0; Index < Infos.size(); Index++)
+				{
+					m_Batches[It->second + LOD].Draws.push_back({ Proxy.Meshes[Index].GetMaterial(), Infos[Index].VertexArray, Infos[Index].IndexType, Infos[Index].Format, Infos[Index].Command });
+				}
+			}
+		}
+		else
+		{
+			RefreshBatchDraws(It->second, Proxy);
+		}
+
+		Object->SetBatchIndex(It->second);
+		return It->second;
+	}
+
+	void Renderer::RefreshBatchDraws(uint32_t BatchIndex, const RenderProxy& Proxy)
+	{
+		// Objects of a batch share the content of their meshes, not always the allocation: the one the batch was
+		// built from may have been freed with its objects since, or moved by the compaction
+		const uint32_t LODCount = m_Batches[BatchIndex].LODCount;
+		for (uint32_t LOD = 0; LOD < LODCount; LOD++)
+		{
+			const std::span<const MeshDrawInfo> Infos = Proxy.GetDraws(LOD);
+			std::vector<BatchDraw>& Draws = m_Batches[BatchIndex + LOD].Draws;
+			for (size_t Index = 0; Index < Infos.size() && Index < Draws.size(); Index++)
+			{
+				DrawElementsIndirectCommand& Command = Draws[Index].Command;
+				if (Command.FirstIndex != Infos[Index].Command.FirstIndex || Command.BaseVertex != Infos[Index].Command.BaseVertex)
+				{
+					Command.FirstIndex = Infos[Index].Command.FirstIndex;
+					Command.BaseVertex = Infos[Index].Command.BaseVertex;
+					m_bBatchDrawsMoved = true;
+				}
+			}
+		}
+	}
+
+	void Renderer::CompactGeometry(Scene* Scene)
+	{
+		if (!m_GeometryArena.Compact(m_GeometryCompactionBudget))
+			return;
+
+		// Every draw built from the arena offsets is rebuilt: the models' groups, the proxies and the batches
+		BaseMesh::OnGeometryMoved();
+		for (const std::unique_ptr<SceneObject>& Object : Scene->GetObjects())
+		{
+			if (Object->IsNew())
+				continue;
+
+			Object->CaptureRenderProxy();
+			if (Object->GetBatchIndex() != SceneObject::InvalidBatch)
+			{
+				RefreshBatchDraws(Object->GetBatchIndex(), Object->GetRenderProxy());
+			}
+		}
+	}
+
+	uint32_t Renderer::SelectLOD(uint32_t BatchIndex, float ScreenSize) const
+	{
+		// Screen sizes decrease with the level, the last level whose size is still above the object's wins
+		const uint32_t LODCount = m_Batches[BatchIndex].LODCount;
+		uint32_t LOD = 0;
+		while (LOD + 1 < LODCount && ScreenSize < m_Batches[BatchIndex + LOD + 1].ScreenSize)
+		{
+			LOD++;
+		}
+		return LOD;
+	}
+
+	void Renderer::RenderImpostors()
+	{
+		FGL_PROFILE_SCOPE("Renderer::RenderImpostors")
+		// Atlases no object referenced this frame may be gone, only the filled entries are drawn
+		for (auto& [Impostor, Instances] : m_ImpostorInstances)
+		{
+			if (!Instances.empty())
+			{
+				Impostor->Draw(Instances);
+			}
+		}
+	}
+
+	void Renderer::UploadPendingObjects(Scene* Scene)
+	{
+		auto& PendingUploads = Scene->GetPendingUploads();
+		const auto& Objects = Scene->GetObjects();
+
+		const auto UploadStart = std::chrono::steady_clock::now();
+		const auto UploadBudget = std::chrono::duration<float, std::milli>(m_UploadBudget);
+		bool bUploaded = false;
+		m_UploadedObjects.clear();
+
+		while (!PendingUploads.empty())
+		{
+			// Geometry uploads are spread over frames, objects past the budget wait for the next one
+			if (m_UploadBudget > 0.0f && bUploaded && std::chrono::steady_clock::now() - UploadStart >= UploadBudget)
+				break;
+
+			SceneObject* Object = Objects[PendingUploads.front()].get();
+			m_UploadedObjects.push_back(PendingUploads.front());
+			PendingUploads.pop_front();
+
+			PerformFirstPass(Object);
+			if (!(Object->GetRenderProxy().Flags & RenderProxy::Skybox))
+			{
+				// The second pass reads its instances from the MVP buffer
+				BindMVPBuffer();
+				PerformSecondPass(Object);
+				AssignBatch(Object);
+			}
+			Object->SetNew(false);
+			bUploaded = true;
+		}
+
+		// Second passes point the instanced attributes at the MVP buffer
+		if (bUploaded)
+		{
+			m_InstanceSource = m_MVPMatrixBuffer.GetBufferID();
+		}
+	}
+
+	void Renderer::UploadStaticGeometry(Scene* Scene)
+	{
+		StaticGeometry* Static = Scene->GetStaticGeometry();
+		if (!Static || Static->GetRevision() == m_StaticRevision)
+			return;
+
+		FGL_PROFILE_SCOPE("Renderer::UploadStaticGeometry")
+		m_StaticRevision = Static->GetRevision();
+		m_StaticMaterials.clear();
+		std::vector<StaticChunk>& Chunks = Static->GetChunks();
+		if (Chunks.empty())
+			return;
+
+		// One identity instance per chunk, read at the chunk's index as its base instance
+		std::vector<InstanceData> Instances;
+		Instances.reserve(Chunks.size());
+		for (StaticChunk& Chunk : Chunks)
+		{
+			Chunk.Mesh.FirstPass(m_GeometryArena);
+			Instances.push_back(Chunk.Instance);
+			Material* ChunkMaterial = Chunk.Mesh.GetMaterial().get();
+			if (ChunkMaterial && (m_StaticMaterials.empty() || m_StaticMaterials.back() != ChunkMaterial))
+			{
+				m_StaticMaterials.push_back(ChunkMaterial);
+			}
+		}
+
+		if (m_StaticInstanceBuffer == 0)
+		{
+			glGenBuffers(1, &m_StaticInstanceBuffer);
+		}
+		GLStateCache::BindBuffer(GL_ARRAY_BUFFER, m_StaticInstanceBuffer);
+		glBufferData(GL_ARRAY_BUFFER, Instances.size() * sizeof(InstanceData), Instances.data(), GL_STATIC_DRAW);
+		GPUMemoryTracker::TrackBuffer(m_StaticInstanceBuffer, Instances.size() * sizeof(InstanceData), GPUMemoryCategory::Instances, "StaticGeometry");
+		RenderCounters::CountUpload(Instances.size() * sizeof(InstanceData));
+
+		// The second passes point the instanced attributes at the static instances
+		m_GeometryArena.SetInstanceBuffer({ m_StaticInstanceBuffer });
+		for (StaticChunk& Chunk : Chunks)
+		{
+			Chunk.Mesh.SecondPass();
+		}
+		m_InstanceSource = m_StaticInstanceBuffer;
+	}
+
+	void Renderer::RenderStaticGeometry(Scene* Scene)
+	{
+		const StaticGeometry* Static = Scene->GetStaticGeometry();
+		if (!Static || Static->GetChunks().empty() || Static->GetRevision() != m_StaticRevision)
+			return;
+
+		FGL_PROFILE_SCOPE("Renderer::RenderStaticGeometry")
+		if (m_InstanceSource != m_StaticInstanceBuffer)
+		{
+			BindInstanceSource(m_StaticInstanceBuffer);
+		}
+
+		// Chunks are sorted by material, each is one draw of its full geometry
+		Material::InvalidateActiveMaterial();
+		const Frustum ViewFrustum(m_CameraBuffer.GetData().ViewProjection);
+		const std::vector<StaticChunk>& Chunks = Static->GetChunks();
+		for (size_t Index = 0; Index < Chunks.size(); Index++)
+		{
+			if (m_FrustumCulling && !ViewFrustum.IsVisible(Chunks[Index].Mesh.GetBoundingSphere()))
+				continue;
+
+			Chunks[Index].Mesh.Render(1, Index);
+		}
+	}
+
+	void Renderer::SetFrustumCulling(bool bEnabled)
+	{
+		m_FrustumCulling = bEnabled;
+	}
+
+	void Renderer::SetLevelOfDetail(bool bEnabled)
+	{
+		m_LevelOfDetail = bEnabled;
+	}
+
+	void Renderer::SetLODBias(float Bias)
+	{
+		m_LODBias = Bias;
+	}
+
+	void Renderer::SetImpostors(bool bEnabled)
+	{
+		m_Impostors = bEnabled;
+	}
+
+	void Renderer::SetIndirectDrawing(bool bEnabled)
+	{
+		m_IndirectDrawing = bEnabled;
+	}
+
+	void Renderer::SetUploadBudget(float Milliseconds)
+	{
+		m_UploadBudget = Milliseconds;
+	}
+
+	void Renderer::SetGeometryCompactionBudget(size_t BytesPerFrame)
+	{
+		m_GeometryCompactionBudget = BytesPerFrame;
+	}
+
+	const GeometryArena& Renderer::GetGeometryArena() const
+	{
+		return m_GeometryArena;
+	}
+
+	void Renderer::SetBindlessMaterials(bool bEnabled)
+	{
+		m_BindlessMaterials = bEnabled;
+	}
+
+	void Renderer::SetVertexPulling(bool bEnabled)
+	{
+		m_VertexPulling = bEnabled;
+	}
+
+	bool Renderer::UsesVertexPulling() const
+	{
+		return m_VertexPulling && m_IndirectDrawing && IndirectDrawBuffer::IsSupported() && GeometryArena::SupportsVertexPulling();
+	}
+
+	void Renderer::SetGPUCulling(bool bEnabled)
+	{
+		m_GPUCullingEnabled = bEnabled;
+	}
+
+	void Renderer::SetOcclusionCulling(bool bEnabled)
+	{
+		m_OcclusionCulling = bEnabled;
+	}
+
+	void Renderer::SetMeshletCulling(bool bEnabled)
+	{
+		m_MeshletCulling = bEnabled;
+	}
+
+	void Renderer::SetShadows(bool bEnabled)
+	{
+		m_Shadows = bEnabled;
+	}
+
+	void Renderer::SetShadowCasterLayers(LayerMask Layers)
+	{
+		m_ShadowCasterLayers = Layers;
+	}
+
+	LayerMask Renderer::GetShadowCasterLayers() const
+	{
+		return m_ShadowCasterLayers;
+	}
+
+	CascadedShadowMaps& Renderer::GetShadowMaps()
+	{
+		return m_ShadowMaps;
+	}
+
+	void Renderer::SetLocalShadows(bool bEnabled)
+	{
+		m_LocalShadows = bEnabled;
+	}
+
+	LocalShadowAtlas& Renderer::GetLocalShadowAtlas()
+	{
+		return m_LocalShadowAtlas;
+	}
+
+	void Renderer::SetRenderScale(float Scale)
+	{
+		m_RenderScale = std::clamp(Scale, 0.25f, 2.0f);
+		if (m_DynamicResolution)
+		{
+			m_ResolutionController.Reset(m_RenderScale);
+		}
+	}
+
+	float Renderer::GetRenderScale() const
+	{
+		return GetAppliedRenderScale();
+	}
+
+	void Renderer::SetPostProcessing(bool bEnabled)
+	{
+		m_PostProcessing = bEnabled;
+	}
+
+	PostProcessStack& Renderer::GetPostProcessing()
+	{
+		return m_PostProcess;
+	}
+
+	void Renderer::SetDynamicResolution(bool bEnabled, float TargetFrameTime, float MinScale, float MaxScale)
+	{
+		m_ResolutionController.SetTargetFrameTime(TargetFrameTime);
+		m_ResolutionController.SetBounds(MinScale, MaxScale);
+
+		// Turning it on continues from the fixed scale, turning it off keeps the resolution it reached
+		if (bEnabled && !m_DynamicResolution)
+		{
+			m_ResolutionController.Reset(m_RenderScale);
+		}
+		else if (!bEnabled && m_DynamicResolution)
+		{
+			m_RenderScale = m_ResolutionController.GetAppliedScale();
+		}
+		m_DynamicResolution = bEnabled;
+	}
+
+	ResolutionController& Renderer::GetResolutionController()
+	{
+		return m_ResolutionController;
+	}
+
+	void Renderer::SetQualityGovernor(bool bEnabled, float TargetFrameTime)
+	{
+		m_QualityGovernor.SetTargetFrameTime(TargetFrameTime);
+
+		// Turning it on starts from the best level, turning it off keeps the level it reached
+		if (bEnabled && !m_QualityGovernorEnabled)
+		{
+			m_QualityGovernor.Reset(0);
+			m_QualityMeasurements = m_ResolutionController.GetState().Measurements;
+			ApplyQualityLevel(m_QualityGovernor.GetCurrentLevel());
+		}
+		m_QualityGovernorEnabled = bEnabled;
+	}
+
+	QualityGovernor& Renderer::GetQualityGovernor()
+	{
+		return m_QualityGovernor;
+	}
+
+	void Renderer::UpdateQualityGovernor()
+	{
+		// Only a GPU time read back since the last frame is a new measurement
+		const TimeManager* Time = SystemManager<TimeManager>::Get();
+		const float FrameTime = Time ? static_cast<float>(Time->GetDeltaTimeSeconds() * 1000.0) : 0.0f;
+		const ResolutionControllerState& Timing = m_ResolutionController.GetState();
+		const float GPUFrameTime = Timing.Measurements != m_QualityMeasurements ? Timing.GPUFrameTime : 0.0f;
+		m_QualityMeasurements = Timing.Measurements;
+		if (!m_QualityGovernor.Update(FrameTime, GPUFrameTime))
+			return;
+
+		ApplyQualityLevel(m_QualityGovernor.GetCurrentLevel());
+		LOG_INFO("Quality level " + std::to_string(m_QualityGovernor.GetLevel()) + " of " + std::to_string(m_QualityGovernor.GetLevels().size())
+			+ " selected at " + std::to_string(m_QualityGovernor.GetState().FrameTime) + " ms per frame.")
+	}
+
+	void Renderer::ApplyQualityLevel(const QualityLevel& Level)
+	{
+		// Shadow maps reallocate on their next caster pass, unchanged values cost nothing
+		m_LODBias = Level.LODBias;
+		m_ShadowMaps.SetResolution(Level.ShadowResolution);
+		m_ShadowMaps.SetCascadeCount(Level.CascadeCount);
+		ParticleSystem::SetEmissionScale(Level.ParticleBudget);
+		m_ClusteredLights.SetMaxLightsPerCluster(Level.MaxLightsPerCluster);
+	}
+
+	void Renderer::SetGPUProfiling(bool bEnabled)
+	{
+		m_GPUProfiler.SetEnabled(bEnabled);
+	}
+
+	GPUProfiler& Renderer::GetGPUProfiler()
+	{
+		return m_GPUProfiler;
+	}
+
+	const RenderStats& Renderer::GetStats() const
+	{
+		return m_Stats;
+	}
+
+	void Renderer::SetStatsLogInterval(uint32_t Frames)
+	{
+		m_StatsLogInterval = Frames;
+		m_StatsLogFrame = 0;
+	}
+
+	void Renderer::SetRenderTargetSamples(int Samples)
+	{
+		m_RenderTargetSamples = std::max(Samples, 0);
+	}
+
+	void Renderer::SetAntiAliasing(AntiAliasingMode Mode, int Samples)
+	{
+		if (Mode != m_AntiAliasing)
+		{
+			m_PostProcess.ResetHistory();
+		}
+		if (Mode == AntiAliasingMode::MSAA)
+		{
+			m_RenderTargetSamples = std::max(Samples, 0);
+		}
+		m_AntiAliasing = Mode;
+		ConfigureRenderingMode(m_Mode);
+	}
+
+	AntiAliasingMode Renderer::GetAntiAliasing() const
+	{
+		return m_AntiAliasing;
+	}
+
+	void Renderer::SetOutputTarget(RenderTarget* Target)
+	{
+		m_OutputTarget = Target;
+	}
+
+	RenderTarget* Renderer::GetOutputTarget() const
+	{
+		return m_OutputTarget;
+	}
+
+	FrameCapture& Renderer::GetFrameCapture()
+	{
+		return m_FrameCapture;
+	}
+
+	ObjectPicker& Renderer::GetObjectPicker()
+	{
+		return m_ObjectPicker;
+	}
+
+	float Renderer::GetAppliedRenderScale() const
+	{
+		return m_DynamicResolution ? m_ResolutionController.GetAppliedScale() : m_RenderScale;
+	}
+
+	bool Renderer::UsesRenderTarget() const
+	{
+		return m_DynamicResolution || m_RenderScale != 1.0f || m_PostProcessing || m_AntiAliasing == AntiAliasingMode::FXAA
+			|| m_AntiAliasing == AntiAliasingMode::TAA || m_AntiAliasing == AntiAliasingMode::TemporalUpscaling;
+	}
+
+	LightUniformBuffer& Renderer::GetLightBuffer()
+	{
+		return m_LightBuffer;
+	}
+
+	ClusteredLightManager& Renderer::GetClusteredLights()
+	{
+		return m_ClusteredLights;
+	}
+
+	void Renderer::SetObjectLights(bool bEnabled)
+	{
+		m_ObjectLights = bEnabled;
+	}
+
+	ObjectLightAssigner& Renderer::GetObjectLightAssigner()
+	{
+		return m_ObjectLightAssigner;
+	}
+
+	void Renderer::SetDeferredLightingShader(Shader* LightingShader)
+	{
+		m_DeferredLightingShader = LightingShader;
+	}
+
+	void Renderer::SetSkybox(const Texture* CubeMap)
+	{
+		m_Skybox = CubeMap;
+	}
+
+	void Renderer::SetTransparencyMode(TransparencyMode Mode)
+	{
+		m_TransparencyMode = Mode;
+	}
+
+	void Renderer::AddParticleSystem(ParticleSystem* Particles)
+	{
+		if (std::find(m_ParticleSystems.begin(), m_ParticleSystems.end(), Particles) == m_ParticleSystems.end())
+		{
+			m_ParticleSystems.push_back(Particles);
+		}
+	}
+
+	void Renderer::RemoveParticleSystem(ParticleSystem* Particles)
+	{
+		m_ParticleSystems.erase(std::remove(m_ParticleSystems.begin(), m_ParticleSystems.end(), Particles), m_ParticleSystems.end());
+	}
+
+	void Renderer::AddTerrain(Terrain* Ground)
+	{
+		if (std::find(m_Terrains.begin(), m_Terrains.end(), Ground) == m_Terrains.end())
+		{
+			m_Terrains.push_back(Ground);
+		}
+	}
+
+	void Renderer::RemoveTerrain(Terrain* Ground)
+	{
+		m_Terrains.erase(std::remove(m_Terrains.begin(), m_Terrains.end(), Ground), m_Terrains.end());
+	}
+
+	void Renderer::AddDynamicMesh(DynamicMesh* Mesh)
+	{
+		if (std::find(m_DynamicMeshes.begin(), m_DynamicMeshes.end(), Mesh) == m_DynamicMeshes.end())
+		{
+			m_DynamicMeshes.push_back(Mesh);
+		}
+	}
+
+	void Renderer::RemoveDynamicMesh(DynamicMesh* Mesh)
+	{
+		m_DynamicMeshes.erase(std::remove(m_DynamicMeshes.begin(), m_DynamicMeshes.end(), Mesh), m_DynamicMeshes.end());
+	}
+
+	BonePaletteBuffer& Renderer::GetBonePalettes()
+	{
+		return m_BonePalettes;
+	}
+
+	void Renderer::SetDepthPrepass(bool bEnabled)
+	{
+		m_DepthPrepass = bEnabled;
+	}
+
+	void Renderer::SetAmbientOcclusion(bool bEnabled)
+	{
+		m_AmbientOcclusion = bEnabled;
+	}
+
+	AmbientOcclusion& Renderer::GetAmbientOcclusion()
+	{
+		return m_SSAO;
+	}
+
+	void Renderer::SetVolumetricFog(bool bEnabled)
+	{
+		m_VolumetricFog = bEnabled;
+	}
+
+	VolumetricFog& Renderer::GetVolumetricFog()
+	{
+		return m_Fog;
+	}
+
+	void Renderer::SetLightmap(const Lightmap* BakedLighting)
+	{
+		m_Lightmap = BakedLighting;
+	}
+
+	void Renderer::SetPortalGraph(PortalGraph* Graph)
+	{
+		m_PortalGraph = Graph;
+	}
+
+	void Renderer::SetOverlay(SpriteBatch* Overlay)
+	{
+		m_Overlay = Overlay;
+	}
+
+	void Renderer::RenderCapture(Scene* Scene, BaseCamera& Camera, RenderTarget& Target, float LODBias, float CullDistance)
+	{
+		FGL_PROFILE_SCOPE("Renderer::RenderCapture")
+
+		// Everything Render() reads that the capture overrides, restored once it is drawn
+		RenderTarget* const OutputTarget = m_OutputTarget;
+		const bool bFramePrepared = m_bFramePrepared;
+		const float MainLODBias = m_LODBias;
+		const bool bShadows = m_Shadows;
+		const bool bLocalShadows = m_LocalShadows;
+		const bool bOcclusionCulling = m_OcclusionCulling;
+		const bool bAmbientOcclusion = m_AmbientOcclusion;
+		const bool bVolumetricFog = m_VolumetricFog;
+		const bool bPostProcessing = m_PostProcessing;
+		const bool bDynamicResolution = m_DynamicResolution;
+		const float RenderScale = m_RenderScale;
+		const AntiAliasingMode AntiAliasing = m_AntiAliasing;
+		const bool bSpotLightFollowsCamera = m_LightBuffer.GetSpotLightFollowsCamera();
+		GLint Viewport[4];
+		GLint DrawFramebuffer = 0;
+		GLint ReadFramebuffer = 0;
+		glGetIntegerv(GL_VIEWPORT, Viewport);
+		glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &DrawFramebuffer);
+		glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &ReadFramebuffer);
+
+		m_CaptureCamera = &Camera;
+		m_OutputTarget = &Target;
+		m_LODBias *= LODBias;
+		m_CullDistance = std::max(CullDistance, 0.0f);
+		m_Shadows = false;
+		m_LocalShadows = false;
+		m_OcclusionCulling = false;
+		m_AmbientOcclusion = false;
+		m_VolumetricFog = false;
+		m_PostProcessing = false;
+		m_DynamicResolution = false;
+		m_RenderScale = 1.0f;
+		m_AntiAliasing = AntiAliasingMode::None;
+		m_LightBuffer.SetSpotLightFollowsCamera(false);
+
+		Render(Scene);
+
+		m_CaptureCamera = nullptr;
+		m_OutputTarget = OutputTarget;
+		m_bFramePrepared = bFramePrepared;
+		m_LODBias = MainLODBias;
+		m_CullDistance = 0.0f;
+		m_Shadows = bShadows;
+		m_LocalShadows = bLocalShadows;
+		m_OcclusionCulling = bOcclusionCulling;
+		m_AmbientOcclusion = bAmbientOcclusion;
+		m_VolumetricFog = bVolumetricFog;
+		m_PostProcessing = bPostProcessing;
+		m_DynamicResolution = bDynamicResolution;
+		m_RenderScale = RenderScale;
+		m_AntiAliasing = AntiAliasing;
+		m_LightBuffer.SetSpotLightFollowsCamera(bSpotLightFollowsCamera);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, DrawFramebuffer);
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, ReadFramebuffer);
+		glViewport(Viewport[0], Viewport[1], Viewport[2], Viewport[3]);
+	}
+
+	void Renderer::RenderViews(Scene* Scene, std::span<const RenderView> Views)
+	{
+		FGL_PROFILE_SCOPE("Renderer::RenderViews")
+		LOG_ASSERT(!m_CaptureCamera, "Views can't be drawn from within a capture")
+		if (Views.empty())
+			return;
+
+		for (const RenderView& View : Views)
+		{
+			LOG_ASSERT(View.Camera, "Every view needs a camera")
+		}
+
+		// Features keeping per-view history or full-viewport buffers are off for the frame, restored once it is drawn
+		const bool bGPUCulling = m_GPUCullingEnabled;
+		const bool bOcclusionCulling = m_OcclusionCulling;
+		const bool bAmbientOcclusion = m_AmbientOcclusion;
+		const AntiAliasingMode AntiAliasing = m_AntiAliasing;
+		const bool bSpotLightFollowsCamera = m_LightBuffer.GetSpotLightFollowsCamera();
+
+		m_Views = Views;
+		m_GPUCullingEnabled = false;
+		m_OcclusionCulling = false;
+		m_AmbientOcclusion = false;
+		if (m_AntiAliasing == AntiAliasingMode::TAA || m_AntiAliasing == AntiAliasingMode::TemporalUpscaling)
+		{
+			m_AntiAliasing = AntiAliasingMode::None;
+		}
+		m_LightBuffer.SetSpotLightFollowsCamera(false);
+
+		Render(Scene);
+
+		m_Views = {};
+		m_GPUCullingEnabled = bGPUCulling;
+		m_OcclusionCulling = bOcclusionCulling;
+		m_AmbientOcclusion = bAmbientOcclusion;
+		m_AntiAliasing = AntiAliasing;
+		m_LightBuffer.SetSpotLightFollowsCamera(bSpotLightFollowsCamera);
+	}
+
+	bool Renderer::UsesDepthPrepass() const
+	{
+		return m_DepthPrepass || UsesAmbientOcclusion();
+	}
+
+	bool Renderer::UsesAmbientOcclusion() const
+	{
+		return m_AmbientOcclusion && (!m_QualityGovernorEnabled || m_QualityGovernor.GetCurrentLevel().bAmbientOcclusion);
+	}
+
+	void Renderer::SetLateLatchInput(bool bEnabled)
+	{
+		m_LateLatchInput = bEnabled;
+	}
+
+	void Renderer::LatchCameraInput(Scene* Scene)
+	{
+		// Before the viewport is read and anything is culled, a resize or the new view then applies to the whole frame
+		InputManager* Input = SystemManager<InputManager>::Get();
+		if (Input)
+		{
+			Input->PollLatestInput();
+		}
+		Scene->GetActiveCamera()->UpdateViewMatrix();
+	}
+
+	BaseCamera& Renderer::GetFrameCamera(Scene* Scene)
+	{
+		if (m_CaptureCamera)
+			return *m_CaptureCamera;
+
+		return m_bFramePrepared ? *m_FrameCamera : *Scene->GetActiveCamera();
+	}
+
+	void Renderer::BeginDepthPrepass()
+	{
+		if (!m_DepthPrepassShader)
+		{
+			// The pulling variant still reads the attributes of the draws made through the format VAOs
+			std::string VertexCode(DepthPrepassVertexCode);
+			if (GeometryArena::SupportsVertexPulling())
+			{
+				VertexCode.insert(VertexCode.find('\n') + 1, "#define VERTEX_PULLING 1\n");
+			}
+			m_DepthPrepassShader = Shader::CreateFromSource(VertexCode, DepthPrepassFragmentCode);
+		}
+		m_DepthPrepassShader->Activate();
+		glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+	}
+
+	void Renderer::EndDepthPrepass()
+	{
+		glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+		if (UsesAmbientOcclusion())
+		{
+			m_GPUProfiler.BeginPass("Ambient occlusion");
+			m_SSAO.Compute(m_CameraBuffer.GetData());
+			m_GPUProfiler.EndPass();
+		}
+		GLStateCache::BeginDepthOverride(GL_EQUAL, false);
+
+		// The prepass program replaced the one of the active material
+		Material::InvalidateActiveMaterial();
+	}
+
+	void Renderer::EndPrepassedShading()
+	{
+		GLStateCache::EndDepthOverride();
+	}
+
+	bool Renderer::UsesBindlessMaterials() const
+	{
+		return m_BindlessMaterials && MaterialBuffer::IsSupported();
+	}
+
+	void Renderer::UpdateMaterialBuffer(const FrameBatchList& ObjectBatches)
+	{
+		m_FrameMaterials.clear();
+		for (const ObjectBatch* Batch : ObjectBatches)
+		{
+			for (SceneObject* Object : Batch->Objects)
+			{
+				Material* ObjectMaterial = Object->GetRenderProxy().ObjectMaterial.get();
+				if (ObjectMaterial && std::find(m_FrameMaterials.begin(), m_FrameMaterials.end(), ObjectMaterial) == m_FrameMaterials.end())
+				{
+					m_FrameMaterials.push_back(ObjectMaterial);
+				}
+			}
+		}
+		AddStaticMaterials();
+		m_MaterialBuffer.Update(m_FrameMaterials);
+	}
+
+	void Renderer::UpdateGPUMaterialBuffer()
+	{
+		// Visibility is only known on the GPU, every batch's material gets a record
+		m_FrameMaterials.clear();
+		for (const ObjectBatch& Batch : m_Batches)
+		{
+			Material* BatchMaterial = Batch.LOD == 0 && !Batch.Draws.empty() ? Batch.Draws.front().DrawMaterial.get() : nullptr;
+			if (BatchMaterial && std::find(m_FrameMaterials.begin(), m_FrameMaterials.end(), BatchMaterial) == m_FrameMaterials.end())
+			{
+				m_FrameMaterials.push_back(BatchMaterial);
+			}
+		}
+		AddStaticMaterials();
+		m_MaterialBuffer.Update(m_FrameMaterials);
+	}
+
+	void Renderer::AddStaticMaterials()
+	{
+		for (Material* ChunkMaterial : m_StaticMaterials)
+		{
+			if (std::find(m_FrameMaterials.begin(), m_FrameMaterials.end(), ChunkMaterial) == m_FrameMaterials.end())
+			{
+				m_FrameMaterials.push_back(ChunkMaterial);
+			}
+		}
+	}
+
+	void Renderer::RenderBatches(const FrameBatchList& ObjectBatches)
+	{
+		// Material state is bound again once per frame, then only when the sorted key prefix changes
+		Material::InvalidateActiveMaterial();
+		BindMVPBuffer();
+		if (m_InstanceSource != m_MVPMatrixBuffer.GetBufferID())
+		{
+			// GPU culling frames pointed the instanced attributes at their own buffer
+			BindInstanceSource(m_MVPMatrixBuffer.GetBufferID());
+		}
+		if (m_IndirectDrawing && IndirectDrawBuffer::IsSupported())
+		{
+			QueueBatches(ObjectBatches);
+			SubmitIndirectBatches();
+			return;
+		}
+
+		RecordBatchCommands(ObjectBatches);
+		m_Commands.Submit();
+	}
+
+	uint64_t Renderer::MakeBatchKey(const ObjectBatch& Batch, uint32_t Pass) const
+	{
+		// The closest instance decides where the batch lands in the front-to-back order
+		const glm::mat4& View = m_CameraBuffer.GetData().View;
+		float ViewDepth = std::numeric_limits<float>::max();
+		for (SceneObject* Object : Batch.Objects)
+		{
+			ViewDepth = std::min(ViewDepth, -(View * Object->GetTransform().GetRenderModelMatrix()[3]).z);
+		}
+
+		const std::shared_ptr<Material>& BatchMaterial = Batch.Objects.front()->GetRenderProxy().ObjectMaterial;
+		const uint32_t ShaderID = BatchMaterial && BatchMaterial->GetRenderState().Program ? BatchMaterial->GetRenderState().Program->GetID() : 0;
+		const uint32_t MaterialID = BatchMaterial ? BatchMaterial->GetBatchID() : 0;
+		return RenderQueue::MakeSortKey(Pass, ShaderID, MaterialID, Batch.MeshID, ViewDepth);
+	}
+
+	void Renderer::QueueBatches(const FrameBatchList& ObjectBatches)
+	{
+		// Instances are laid out in the MVP buffer in batch order (see UpdateMVPInstances),
+		// so every batch is a contiguous slice drawn with a single instanced call
+		m_QueuedBatches.clear();
+		m_RenderQueue.Clear();
+
+		size_t BaseInstance = m_MVPMatrixBuffer.GetRegionBaseInstance();
+		for (const ObjectBatch* Batch : ObjectBatches)
+		{
+			if (!IsTransparent(*Batch->Objects.front()))
+			{
+				m_RenderQueue.Push(MakeBatchKey(*Batch, 0), static_cast<uint32_t>(m_QueuedBatches.size()));
+				m_QueuedBatches.push_back({ Batch->Objects.front(), Batch->Objects.size(), BaseInstance, Batch->LOD });
+			}
+			BaseInstance += Batch->Objects.size();
+		}
+		m_RenderQueue.Sort();
+	}
+
+	void Renderer::RecordBatchCommands(const FrameBatchList& ObjectBatches)
+	{
+		FGL_PROFILE_SCOPE("Renderer::RecordBatchCommands")
+
+		// Slices of the MVP buffer follow batch order (see UpdateMVPInstances), known before recording in any order
+		m_BatchBaseInstances.resize(ObjectBatches.size());
+		size_t BaseInstance = m_MVPMatrixBuffer.GetRegionBaseInstance();
+		for (size_t Index = 0; Index < ObjectBatches.size(); Index++)
+		{
+			m_BatchBaseInstances[Index] = BaseInstance;
+			BaseInstance += ObjectBatches[Index]->Objects.size();
+		}
+
+		const bool bDepthPrepass = UsesDepthPrepass();
+		if (bDepthPrepass)
+		{
+			RenderCommandList& PassCommands = m_Commands.AcquireList();
+			PassCommands.BeginPacket(RenderQueue::MakeSortKey(BatchPass::PrepassBegin, 0, 0, 0, 0.0f));
+			PassCommands.Invoke([](void* Data) { static_cast<Renderer*>(Data)->BeginDepthPrepass(); }, this);
+			PassCommands.BeginPacket(RenderQueue::MakeSortKey(BatchPass::PrepassEnd, 0, 0, 0, 0.0f));
+			PassCommands.Invoke([](void* Data) { static_cast<Renderer*>(Data)->EndDepthPrepass(); }, this);
+			PassCommands.BeginPacket(RenderQueue::MakeSortKey(BatchPass::ShadingEnd, 0, 0, 0, 0.0f));
+			PassCommands.Invoke([](void* Data) { static_cast<Renderer*>(Data)->EndPrepassedShading(); }, this);
+		}
+
+		// Every chunk records into its own list, the queue sorts them all together
+		const auto Record = [this, &ObjectBatches, bDepthPrepass](size_t Begin, size_t End)
+		{
+			RenderCommandList& Commands = m_Commands.AcquireList();
+			for (size_t Index = Begin; Index < End; Index++)
+			{
+				const ObjectBatch& Batch = *ObjectBatches[Index];
+				SceneObject* Front = Batch.Objects.front();
+				if (IsTransparent(*Front))
+					continue;
+
+				const uint64_t Key = MakeBatchKey(Batch, BatchPass::Shading);
+				if (bDepthPrepass)
+				{
+					// Only the shader field differs: the prepass draws every batch with the same program
+					Commands.BeginPacket(RenderQueue::MakeSortKey(BatchPass::Prepass, 0, 0, 0, 0.0f) | (Key & PrepassKeyMask));
+					Commands.SetInstanceRange(Batch.Objects.size(), m_BatchBaseInstances[Index]);
+					for (const MeshDrawInfo& Info : Front->GetRenderProxy().GetDraws(Batch.LOD))
+					{
+						Commands.DrawMeshInfo(Info);
+					}
+				}
+				Commands.BeginPacket(Key);
+				Commands.SetInstanceRange(Batch.Objects.size(), m_BatchBaseInstances[Index]);
+#if defined(FIREGL_ENABLE_GL_DEBUG)
+				const Material* BatchMaterial = Front->GetRenderProxy().ObjectMaterial.get();
+				Commands.PushDebugGroup(GetBatchLabel(BatchMaterial ? BatchMaterial->GetRenderState().Program : nullptr));
+				Commands.DrawProxy(Front->GetRenderProxy(), Batch.LOD);
+				Commands.PopDebugGroup();
+#else
+				Commands.DrawProxy(Front->GetRenderProxy(), Batch.LOD);
+#endif
+			}
+		};
+		if (m_JobSystem && ObjectBatches.size() > BatchRecordChunkSize)
+		{
+			m_JobSystem->ParallelFor(ObjectBatches.size(), BatchRecordChunkSize, Record);
+		}
+		else
+		{
+			Record(0, ObjectBatches.size());
+		}
+	}
+
+	void Renderer::SubmitIndirectBatches()
+	{
+		m_IndirectBuffer.Clear();
+		m_IndirectGroups.clear();
+		m_MeshletFrustum = Frustum(m_CameraBuffer.GetData().ViewProjection);
+		const GLuint PullingVertexArray = UsesVertexPulling() ? m_GeometryArena.GetPullingVertexArray() : 0;
+
+		for (const RenderQueueItem& Item : m_RenderQueue.GetItems())
+		{
+			const QueuedBatch& Batch = m_QueuedBatches[Item.Payload];
+			for (const MeshDrawInfo& Info : Batch.Object->GetRenderProxy().GetDraws(Batch.LOD))
+			{
+				// Meshlets only split the full-detail level
+				if (m_MeshletCulling && Batch.LOD == 0 && Info.bMeshlets)
+				{
+					PushMeshletCommands(*Info.Mesh, Batch.InstanceCount, Batch.BaseInstance);
+					continue;
+				}
+
+				// The queue is sorted by shader and material, so equal state is already adjacent
+				// Pulled commands of every format share one VAO, their base vertex tells the shader the format
+				AddToIndirectGroup(m_IndirectGroups, Info.DrawMaterial, PullingVertexArray ? PullingVertexArray : Info.VertexArray, Info.IndexType, m_IndirectBuffer.GetCommandCount());
+				DrawElementsIndirectCommand Command = Info.Command;
+				Command.InstanceCount = static_cast<uint32_t>(Batch.InstanceCount);
+				Command.BaseInstance = static_cast<uint32_t>(Batch.BaseInstance);
+				if (PullingVertexArray)
+				{
+					Command.BaseVertex = GeometryArena::EncodePulledBaseVertex(Info.Format, Command.BaseVertex);
+				}
+				m_IndirectBuffer.Push(Command);
+			}
+		}
+
+		m_IndirectBuffer.Upload();
+		DrawIndirectGroups(m_IndirectGroups, m_IndirectBuffer);
+	}
+
+	void Renderer::PushMeshletCommands(const BaseMesh& Mesh, size_t InstanceCount, size_t BaseInstance)
+	{
+		const std::vector<Meshlet>& Meshlets = Mesh.GetMeshlets();
+		const InstanceData* Instances = m_MVPMatrixBuffer.Get() + (BaseInstance - m_MVPMatrixBuffer.GetRegionBaseInstance());
+		const glm::vec4 CameraPosition(glm::vec3(m_CameraBuffer.GetData().Position), 1.0f);
+
+		for (size_t Instance = 0; Instance < InstanceCount; Instance++)
+		{
+			// Mirroring transforms flip the winding, their cones would cull the front faces
+			const glm::mat4& Model = Instances[Instance].Model;
+			const bool bConeCulling = glm::determinant(glm::mat3(Model)) > 0.0f;
+			const glm::vec3 LocalCamera = bConeCulling ? glm::vec3(glm::inverse(Model) * CameraPosition) : glm::vec3(0.0f);
+
+			uint32_t RunStart = 0;
+			uint32_t RunLength = 0;
+			for (uint32_t Index = 0; Index <= Meshlets.size(); Index++)
+			{
+				bool bVisible = false;
+				if (Index < Meshlets.size())
+				{
+					const Meshlet& Cluster = Meshlets[Index];
+					bVisible = !(bConeCulling && glm::dot(glm::normalize(Cluster.ConeApex - LocalCamera), Cluster.ConeAxis) >= Cluster.ConeCutoff)
+						&& (!m_FrustumCulling || m_MeshletFrustum.IsVisible(Cluster.Bounds.Transformed(Model)));
+				}
+
+				if (bVisible)
+				{
+					RunStart = RunLength == 0 ? Index : RunStart;
+					RunLength++;
+					continue;
+				}
+
+				if (RunLength > 0)
+				{
+					DrawElementsIndirectCommand Command = Mesh.GetMeshletDrawCommand(RunStart, RunLength, 1, BaseInstance + Instance);
+					GLuint VertexArray = Mesh.GetVertexArray();
+					if (UsesVertexPulling())
+					{
+						VertexArray = m_GeometryArena.GetPullingVertexArray();
+						Command.BaseVertex = GeometryArena::EncodePulledBaseVertex(Mesh.GetVertexFormat(), Command.BaseVertex);
+					}
+					AddToIndirectGroup(m_IndirectGroups, Mesh.GetMaterial().get(), VertexArray, Mesh.GetIndexType(), m_IndirectBuffer.GetCommandCount());
+					m_IndirectBuffer.Push(Command);
+					RunLength = 0;
+				}
+			}
+		}
+	}
+
+	void Renderer::AddToIndirectGroup(std::vector<IndirectGroup>& Groups, Material* CommandMaterial, GLuint VertexArray, GLenum IndexType, size_t FirstCommand) const
 	{
-		ConfigureRenderingMode(Mode);
-		SetupBuffer();
+		// Bindless materials are read per instance, only the shader has to match
+		const Shader* CommandShader = CommandMaterial ? CommandMaterial->GetRenderState().Program : nullptr;
+		const IndirectGroup* Last = Groups.empty() ? nullptr : &Groups.back();
+		const bool bSameMaterial = Last && (UsesBindlessMaterials() ? Last->GroupShader == CommandShader : Last->GroupMaterial == CommandMaterial);
+		if (!bSameMaterial || Last->VertexArray != VertexArray || Last->IndexType != IndexType)
+		{
+			Groups.push_back({ CommandMaterial, CommandShader, VertexArray, IndexType, FirstCommand, 0 });
+		}
+		Groups.back().CommandCount++;
 	}
 
-	Renderer::~Renderer()
+	void Renderer::DrawIndirectGroups(const std::vector<IndirectGroup>& Groups, const IndirectDrawBuffer& Commands)
 	{
-		CleanupBuffer();
+		Commands.Bind();
+		if (UsesVertexPulling())
+		{
+			// The arena's buffers move when it grows, and the instances come from the MVP or the culling buffer
+			m_GeometryArena.BindPulledBuffers(m_InstanceSource);
+		}
+		if (UsesDepthPrepass())
+		{
+			// Materials don't matter for depth, only vertex array or index type changes split the prepass
+			BeginDepthPrepass();
+			size_t First = 0;
+			for (size_t Index = 1; Index <= Groups.size(); Index++)
+			{
+				const IndirectGroup& Run = Groups[First];
+				if (Index < Groups.size() && Groups[Index].VertexArray == Run.VertexArray
+					&& Groups[Index].IndexType == Run.IndexType)
+					continue;
+
+				const IndirectGroup& Last = Groups[Index - 1];
+				GLStateCache::BindVertexArray(Run.VertexArray);
+				Commands.Draw(Run.FirstCommand, Last.FirstCommand + Last.CommandCount - Run.FirstCommand, Run.IndexType);
+				First = Index;
+			}
+			EndDepthPrepass();
+		}
+
+		for (const IndirectGroup& Group : Groups)
+		{
+			FGL_GL_DEBUG_GROUP(GetBatchLabel(Group.GroupShader))
+			if (Group.GroupMaterial)
+			{
+				Group.GroupMaterial->Activate();
+			}
+			GLStateCache::BindVertexArray(Group.VertexArray);
+			Commands.Draw(Group.FirstCommand, Group.CommandCount, Group.IndexType);
+		}
+		GLStateCache::ResetRasterState();
+
+		if (UsesDepthPrepass())
+		{
+			EndPrepassedShading();
+		}
 	}
 
-	void Renderer::ConfigureRenderingMode(RenderingMode NewMode)
+	bool Renderer::UsesGPUCulling() const
 	{
-		switch (NewMode)
+		return m_GPUCullingEnabled && m_IndirectDrawing && GPUCulling::IsSupported();
+	}
+
+	SceneObject* Renderer::UpdateGPUObjects(Scene* Scene)
+	{
+		if (!m_GPUCulling.IsCreated())
 		{
-		case RenderingMode::Default:
-			glEnable(GL_DEPTH_TEST);
-			break;
-		case RenderingMode::DebugLine:
-			glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-			break;
-		case RenderingMode::DebugFill:
-			glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-			break;
+			m_GPUCulling.Create();
+		}
+
+		const auto& Objects = Scene->GetObjects();
+		if (!m_bFramePrepared)
+		{
+			TransformPool::UpdateDirtyMatrices(m_JobSystem);
+			Scene->UpdateBoundingSpheres();
+		}
+
+		// Only the objects added, moved or re-batched since the last frame are written again
+		m_GPUCulling.SetObjectCount(Objects.size());
+		if (!m_GPUObjectsCurrent)
+		{
+			for (uint32_t Index = 0; Index < Objects.size(); Index++)
+			{
+				WriteGPUObject(Scene, Index);
+			}
+			m_GPUObjectsCurrent = true;
 		}
-		glEnable(GL_MULTISAMPLE);
+		else
+		{
+			for (uint32_t Index : Scene->GetChangedObjects())
+			{
+				WriteGPUObject(Scene, Index);
+			}
+			for (uint32_t Index : m_UploadedObjects)
+			{
+				WriteGPUObject(Scene, Index);
+			}
+		}
+
+		// Batches are never removed from the cache, the commands only change when some are added or their geometry moved
+		if (m_GPUCulling.GetBatchCount() < m_Batches.size() || m_GPUCommandsBindless != UsesBindlessMaterials() || m_GPUCommandsPulled != UsesVertexPulling()
+			|| m_bBatchDrawsMoved)
+		{
+			for (size_t Index = m_GPUCulling.GetBatchCount(); Index < m_Batches.size(); Index++)
+			{
+				const ObjectBatch& Batch = m_Batches[Index];
+				m_GPUCulling.AddBatch({ Batch.LOD, Batch.LODCount, Batch.ScreenSize, 0 });
+			}
+			RecordGPUCommands();
+		}
+
+		const Scene::IndexList& Skyboxes = Scene->GetUnboundedObjects();
+		if (Skyboxes.empty() || Objects[Skyboxes.front()]->IsNew())
+			return nullptr;
+
+		return Objects[Skyboxes.front()].get();
 	}
 
-	void Renderer::SetupBuffer()
+	void Renderer::WriteGPUObject(Scene* Scene, uint32_t Index)
 	{
-		glGenBuffers(1, &m_MVPBufferID);
+		SceneObject* Object = Scene->GetObjects()[Index].get();
+		GPUCullingObject Record;
+		if (!Object->IsNew() && !(Object->GetRenderProxy().Flags & RenderProxy::Skybox) && !Object->IsMerged())
+		{
+			uint32_t BatchIndex = Object->GetBatchIndex();
+			if (BatchIndex == SceneObject::InvalidBatch)
+			{
+				BatchIndex = AssignBatch(Object);
+			}
+
+			const std::shared_ptr<Material>& ObjectMaterial = Object->GetRenderProxy().ObjectMaterial;
+			const BoundingSphereArrays& Spheres = Scene->GetBoundingSpheres();
+			Transform& ObjectTransform = Object->GetTransform();
+			Record.Instance.Model = ObjectTransform.GetRenderModelMatrix();
+			Record.Instance.NormalMatrix = glm::mat3x4(ObjectTransform.GetRenderNormalMatrix());
+			WriteProceduralAnimation(Record.Instance, Object->GetPackedAnimation());
+			Record.Instance.TextureLayers = Object->GetTextureLayers();
+			Record.Instance.MaterialIndex = ObjectMaterial ? ObjectMaterial->GetID() : 0;
+			Record.Instance.BoneOffset = Object->GetBoneOffset();
+			Record.Instance.ReflectionProbe = Object->GetReflectionProbe();
+			Record.Instance.PointLights = Object->GetPointLights();
+			Record.Instance.Payload = Object->GetInstancePayload();
+			Record.BoundingSphere = glm::vec4(Spheres.X[Index], Spheres.Y[Index], Spheres.Z[Index], Spheres.Radius[Index]);
+			Record.BatchIndex = BatchIndex;
+			Record.Layers = Scene->GetObjectLayers()[Index];
+		}
+		m_GPUCulling.SetObject(Index, Record);
 	}
 
-	void Renderer::CleanupBuffer()
+	void Renderer::RecordGPUCommands()
 	{
-		glDeleteBuffers(1, &m_MVPBufferID);
+		// Draws are sorted once by shader, material and vertex array, not per frame: there is no depth to sort by
+		m_RenderQueue.Clear();
+		m_GPUDraws.clear();
+		for (uint32_t BatchIndex = 0; BatchIndex < m_Batches.size(); BatchIndex++)
+		{
+			const std::vector<BatchDraw>& Draws = m_Batches[BatchIndex].Draws;
+			for (uint32_t DrawIndex = 0; DrawIndex < Draws.size(); DrawIndex++)
+			{
+				const Material* DrawMaterial = Draws[DrawIndex].DrawMaterial.get();
+				uint32_t ShaderID = DrawMaterial && DrawMaterial->GetRenderState().Program ? DrawMaterial->GetRenderState().Program->GetID() : 0;
+				uint32_t MaterialID = DrawMaterial ? DrawMaterial->GetID() : 0;
+				m_RenderQueue.Push(RenderQueue::MakeSortKey(0, ShaderID, MaterialID, Draws[DrawIndex].VertexArray, 0.0f), static_cast<uint32_t>(m_GPUDraws.size()));
+				m_GPUDraws.emplace_back(BatchIndex, DrawIndex);
+			}
+		}
+		m_RenderQueue.Sort();
+
+		m_GPUCulling.ClearCommands();
+		m_GPUIndirectGroups.clear();
+		const GLuint PullingVertexArray = UsesVertexPulling() ? m_GeometryArena.GetPullingVertexArray() : 0;
+		for (const RenderQueueItem& Item : m_RenderQueue.GetItems())
+		{
+			const auto [BatchIndex, DrawIndex] = m_GPUDraws[Item.Payload];
+			const BatchDraw& Draw = m_Batches[BatchIndex].Draws[DrawIndex];
+			DrawElementsIndirectCommand Command = Draw.Command;
+			if (PullingVertexArray)
+			{
+				Command.BaseVertex = GeometryArena::EncodePulledBaseVertex(Draw.Format, Command.BaseVertex);
+			}
+			AddToIndirectGroup(m_GPUIndirectGroups, Draw.DrawMaterial.get(), PullingVertexArray ? PullingVertexArray : Draw.VertexArray, Draw.IndexType, m_GPUCulling.GetCommands().GetCommandCount());
+			m_GPUCulling.PushCommand(Command, BatchIndex);
+		}
+		m_GPUCulling.UploadCommands();
+		m_GPUCommandsBindless = UsesBindlessMaterials();
+		m_GPUCommandsPulled = UsesVertexPulling();
+		m_bBatchDrawsMoved = false;
 	}
 
-	void Renderer::Render(Scene* Scene)
+	void Renderer::RenderGPUCulledBatches(Scene* Scene)
 	{
-		ClearFrameBuffer();
-		SceneObject* Skybox = nullptr;
-		auto ObjectBatches = BatchSceneObjects(Scene, Skybox);
+		// The pyramid is only current if the previous frame built it
+		const bool bOcclusionCulling = m_OcclusionCulling && HiZBuffer::IsSupported();
+		const HiZBuffer* Occlusion = bOcclusionCulling && m_HiZBuffer.IsValid() ? &m_HiZBuffer : nullptr;
+		m_GPUCulling.Cull(GetFrameCamera(Scene), m_FrustumCulling, m_LevelOfDetail, m_LODBias, Occlusion);
+		if (m_InstanceSource != m_GPUCulling.GetInstanceBuffer())
+		{
+			BindInstanceSource(m_GPUCulling.GetInstanceBuffer());
+		}
 
-		UpdateMVPInstances(Scene, ObjectBatches, Skybox != nullptr);
-		RenderBatches(ObjectBatches);
-		RenderSkybox(Skybox);
+		// The compute passes replaced the program of the active material
+		Material::InvalidateActiveMaterial();
+		DrawIndirectGroups(m_GPUIndirectGroups, m_GPUCulling.GetCommands());
+
+		if (bOcclusionCulling)
+		{
+			if (!m_HiZBuffer.IsCreated())
+			{
+				m_HiZBuffer.Create();
+			}
+			m_HiZBuffer.Build(m_CameraBuffer.GetData().ViewProjection);
+		}
+		else
+		{
+			m_HiZBuffer.Invalidate();
+		}
 	}
 
-	void Renderer::ClearFrameBuffer()
+	void Renderer::IssueOcclusionQueries(Scene* Scene)
 	{
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		// Near plane distance of the [0, 1] depth projections, perspective or orthographic
+		BaseCamera& Camera = GetFrameCamera(Scene);
+		const glm::mat4 Projection = Camera.GetProjectionMatrix();
+		const float Near = Projection[3][2] / Projection[2][2];
+
+		m_OcclusionQueries.Issue(m_VisibleIndices, Scene->GetBoundingSpheres(), m_CameraBuffer.GetData().ViewProjection,
+			Camera.GetViewPosition(), Near);
+		Material::InvalidateActiveMaterial();
+
+		// The GPU culling path's pyramid misses the depth of this frame
+		m_HiZBuffer.Invalidate();
 	}
 
-	std::map<size_t, std::vector<SceneObject*>> Renderer::BatchSceneObjects(Scene* Scene, SceneObject*& Skybox)
+	void Renderer::RenderShadowCasters(Scene* Scene)
 	{
-		std::map<size_t, std::vector<SceneObject*>> ObjectBatches;
-		for (const auto& Object : Scene->GetObjects())
+		FGL_PROFILE_SCOPE("Renderer::RenderShadowCasters")
+		const auto& Objects = Scene->GetObjects();
+		m_CasterMasks.assign(Objects.size(), 0);
+
+		// Every cascade is culled on its own, the caster hash changes when an object enters, leaves, moves or swaps meshes
+		std::array<uint64_t, CascadedShadowMaps::MaxCascades> CasterHashes{};
+		for (uint32_t Cascade = 0; Cascade < m_ShadowMaps.GetCascadeCount(); Cascade++)
 		{
-			if (Object->IsSkybox())
+			Scene->QueryFrustum(Frustum(m_ShadowMaps.GetCasterViewProjection(Cascade)), m_CascadeIndices);
+			Scene->FilterLayers(m_ShadowCasterLayers, m_CascadeIndices);
+			uint64_t Hash = 14695981039346656037ull;
+			for (uint32_t Index : m_CascadeIndices)
 			{
-				Skybox = Object.get();
+				SceneObject* Object = Objects[Index].get();
+				const RenderProxy& Proxy = Object->GetRenderProxy();
+				if (Object->IsNew() || (Proxy.Flags & RenderProxy::Skybox))
+					continue;
+
+				m_CasterMasks[Index] |= 1u << Cascade;
+				for (uint64_t Value : { reinterpret_cast<uintptr_t>(Object), static_cast<uint64_t>(Proxy.MeshID), Object->GetTransform().GetRenderRevision() })
+				{
+					Hash = (Hash ^ Value) * 1099511628211ull;
+				}
+			}
+			CasterHashes[Cascade] = Hash;
+		}
+
+		const uint32_t DrawMask = m_ShadowMaps.BeginCasterPass(CasterHashes);
+		if (DrawMask == 0)
+			return;
+
+		// Casters of unchanged cascades only keep their bits for the changed ones, or are skipped
+		m_ShadowCasters.clear();
+		for (uint32_t Index = 0; Index < Objects.size(); Index++)
+		{
+			if ((m_CasterMasks[Index] & DrawMask) == 0)
 				continue;
+
+			SceneObject* Object = Objects[Index].get();
+			uint32_t BatchIndex = Object->GetBatchIndex();
+			if (BatchIndex == SceneObject::InvalidBatch)
+			{
+				BatchIndex = AssignBatch(Object);
 			}
-			size_t VertexHash = Object->GetHash();
-			ObjectBatches[VertexHash].push_back(Object.get());
+			m_ShadowCasters.emplace_back(BatchIndex, Object);
 		}
-		return ObjectBatches;
+		std::sort(m_ShadowCasters.begin(), m_ShadowCasters.end(),
+			[](const auto& A, const auto& B) { return A.first < B.first; });
+
+		m_ShadowInstances.BeginFrame();
+		if (m_ShadowInstances.GetObjectCount() < m_ShadowCasters.size())
+		{
+			m_ShadowInstances.Resize(m_ShadowCasters.size());
+		}
+		InstanceData* Instances = m_ShadowInstances.Get();
+		for (size_t Slot = 0; Slot < m_ShadowCasters.size(); Slot++)
+		{
+			SceneObject* Object = m_ShadowCasters[Slot].second;
+			Instances[Slot].Model = Object->GetTransform().GetRenderModelMatrix();
+			WriteProceduralAnimation(Instances[Slot], Object->GetPackedAnimation());
+			Instances[Slot].MaterialIndex = m_CasterMasks[Object->GetSceneIndex()] & DrawMask;
+			Instances[Slot].BoneOffset = Object->GetBoneOffset();
+			Instances[Slot].Payload = Object->GetInstancePayload();
+		}
+		if (!m_ShadowCasters.empty())
+		{
+			m_ShadowInstances.MarkDirty(0);
+			m_ShadowInstances.MarkDirty(m_ShadowCasters.size() - 1);
+		}
+		m_ShadowInstances.Upload(m_ShadowCasters.size());
+
+		// Objects of a batch share their meshes, each run of a batch is one instanced draw per mesh
+		BindInstanceSource(m_ShadowInstances.GetBufferID());
+		const size_t RegionBase = m_ShadowInstances.GetRegionBaseInstance();
+		for (size_t First = 0; First < m_ShadowCasters.size();)
+		{
+			size_t End = First + 1;
+			while (End < m_ShadowCasters.size() && m_ShadowCasters[End].first == m_ShadowCasters[First].first)
+			{
+				End++;
+			}
+			for (const MeshDrawInfo& Info : m_ShadowCasters[First].second->GetRenderProxy().GetDraws(0))
+			{
+				BaseMesh::Draw(Info, End - First, RegionBase + First);
+			}
+			First = End;
+		}
+		m_ShadowInstances.EndFrame();
+
+		m_ShadowMaps.EndCasterPass();
+		Material::InvalidateActiveMaterial();
+	}
+
+	void Renderer::RenderLocalShadowCasters(Scene* Scene)
+	{
+		FGL_PROFILE_SCOPE("Renderer::RenderLocalShadowCasters")
+		const auto& Objects = Scene->GetObjects();
+
+		// Every light is culled once against its sphere, the caster hash changes when an object enters, leaves, moves or swaps meshes
+		std::array<uint64_t, LocalShadowAtlas::SlotCount> CasterHashes{};
+		for (uint32_t Slot = 0; Slot < LocalShadowAtlas::SlotCount; Slot++)
+		{
+			std::vector<uint32_t>& Casters = m_LocalCasterIndices[Slot];
+			Casters.clear();
+			if (!m_LocalShadowAtlas.IsShadowed(Slot))
+				continue;
+
+			Scene->QuerySphere(m_LocalShadowAtlas.GetLightBounds(Slot), Casters);
+			Scene->FilterLayers(m_ShadowCasterLayers, Casters);
+			std::erase_if(Casters, [&Objects](uint32_t Index)
+			{
+				return Objects[Index]->IsNew() || (Objects[Index]->GetRenderProxy().Flags & RenderProxy::Skybox);
+			});
+			uint64_t Hash = 14695981039346656037ull;
+			for (uint32_t Index : Casters)
+			{
+				SceneObject* Object = Objects[Index].get();
+				for (uint64_t Value : { reinterpret_cast<uintptr_t>(Object), static_cast<uint64_t>(Object->GetRenderProxy().MeshID), Object->GetTransform().GetRenderRevision() })
+				{
+					Hash = (Hash ^ Value) * 1099511628211ull;
+				}
+			}
+			CasterHashes[Slot] = Hash;
+		}
+
+		const std::vector<uint32_t>& Slots = m_LocalShadowAtlas.ScheduleUpdates(CasterHashes);
+		if (Slots.empty())
+			return;
+
+		// Each face keeps the casters inside its frustum, sorted by batch, in its own run of instances
+		const BoundingSphereArrays& Spheres = Scene->GetBoundingSpheres();
+		m_LocalShadowCasters.clear();
+		m_LocalShadowRuns.clear();
+		for (uint32_t Slot : Slots)
+		{
+			for (uint32_t Face = 0; Face < m_LocalShadowAtlas.GetFaceCount(Slot); Face++)
+			{
+				const Frustum FaceFrustum(m_LocalShadowAtlas.GetFaceViewProjection(Slot, Face));
+				const size_t First = m_LocalShadowCasters.size();
+				for (uint32_t Index : m_LocalCasterIndices[Slot])
+				{
+					const BoundingSphere Sphere{ glm::vec3(Spheres.X[Index], Spheres.Y[Index], Spheres.Z[Index]), Spheres.Radius[Index] };
+					if (!FaceFrustum.IsVisible(Sphere))
+						continue;
+
+					SceneObject* Object = Objects[Index].get();
+					uint32_t BatchIndex = Object->GetBatchIndex();
+					if (BatchIndex == SceneObject::InvalidBatch)
+					{
+						BatchIndex = AssignBatch(Object);
+					}
+					m_LocalShadowCasters.emplace_back(BatchIndex, Object);
+				}
+				std::sort(m_LocalShadowCasters.begin() + First, m_LocalShadowCasters.end(),
+					[](const auto& A, const auto& B) { return A.first < B.first; });
+				m_LocalShadowRuns.push_back(static_cast<uint32_t>(m_LocalShadowCasters.size()));
+			}
+		}
+
+		m_LocalShadowInstances.BeginFrame();
+		if (m_LocalShadowInstances.GetObjectCount() < m_LocalShadowCasters.size())
+		{
+			m_LocalShadowInstances.Resize(m_LocalShadowCasters.size());
+		}
+		InstanceData* Instances = m_LocalShadowInstances.Get();
+		for (size_t Slot = 0; Slot < m_LocalShadowCasters.size(); Slot++)
+		{
+			SceneObject* Object = m_LocalShadowCasters[Slot].second;
+			Instances[Slot].Model = Object->GetTransform().GetRenderModelMatrix();
+			WriteProceduralAnimation(Instances[Slot], Object->GetPackedAnimation());
+			Instances[Slot].MaterialIndex = 0;
+			Instances[Slot].BoneOffset = Object->GetBoneOffset();
+			Instances[Slot].Payload = Object->GetInstancePayload();
+		}
+		if (!m_LocalShadowCasters.empty())
+		{
+			m_LocalShadowInstances.MarkDirty(0);
+			m_LocalShadowInstances.MarkDirty(m_LocalShadowCasters.size() - 1);
+		}
+		m_LocalShadowInstances.Upload(m_LocalShadowCasters.size());
+
+		// Every scheduled face is cleared, even without casters; objects of a batch are one instanced draw per mesh
+		m_LocalShadowAtlas.BeginCasterPass();
+		BindInstanceSource(m_LocalShadowInstances.GetBufferID());
+		const size_t RegionBase = m_LocalShadowInstances.GetRegionBaseInstance();
+		size_t Run = 0;
+		size_t First = 0;
+		for (uint32_t Slot : Slots)
+		{
+			for (uint32_t Face = 0; Face < m_LocalShadowAtlas.GetFaceCount(Slot); Face++)
+			{
+				m_LocalShadowAtlas.BeginTile(Slot, Face);
+				const size_t RunEnd = m_LocalShadowRuns[Run++];
+				while (First < RunEnd)
+				{
+					size_t End = First + 1;
+					while (End < RunEnd && m_LocalShadowCasters[End].first == m_LocalShadowCasters[First].first)
+					{
+						End++;
+					}
+					for (const MeshDrawInfo& Info : m_LocalShadowCasters[First].second->GetRenderProxy().GetDraws(0))
+					{
+						BaseMesh::Draw(Info, End - First, RegionBase + First);
+					}
+					First = End;
+				}
+			}
+		}
+		m_LocalShadowInstances.EndFrame();
+
+		m_LocalShadowAtlas.EndCasterPass();
+		Material::InvalidateActiveMaterial();
 	}
 
-	void Renderer::RenderBatches(const std::map<size_t, std::vector<SceneObject*>>& ObjectBatches)
+	void Renderer::BindInstanceSource(GLuint Buffer)
 	{
-		for (const auto& [Hash, ObjectBatch] : ObjectBatches)
+		m_GeometryArena.SetInstanceBuffer({ Buffer });
+		for (size_t Format = 0; Format < VertexFormatCount; Format++)
+		{
+			m_GeometryArena.ConfigureInstanceAttributes(static_cast<VertexFormat>(Format));
+		}
+		m_InstanceSource = Buffer;
+	}
+
+	void Renderer::RenderPickingPass(Scene* Scene, const FrameBatchList& ObjectBatches, const glm::mat4& ViewProjection, const GLint OutputViewport[4])
+	{
+		// The pick position comes in window coordinates, a headless output target has none
+		const glm::ivec2 ViewportSize(OutputViewport[2], OutputViewport[3]);
+		glm::ivec2 WindowSize = ViewportSize;
+		const BaseWindow* Window = SystemManager<BaseWindow>::Get();
+		if (Window && !m_OutputTarget)
+		{
+			Window->GetWindowSize(WindowSize.x, WindowSize.y);
+		}
+		if (!m_ObjectPicker.BeginPass(ViewProjection, ViewportSize, WindowSize))
+			return;
+
+		// Instances follow batch order in the MVP buffer (see UpdateMVPInstances), so do the pick indices
+		// Objects outside the pick's layers split their batch, each run of pickable instances is drawn on its own
+		const LayerMask PickLayers = m_ObjectPicker.GetPassLayers();
+		const auto& ObjectLayers = Scene->GetObjectLayers();
+		std::vector<SceneObject*> Objects;
+		size_t BaseInstance = m_MVPMatrixBuffer.GetRegionBaseInstance();
+		for (const ObjectBatch* Batch : ObjectBatches)
 		{
-			for (SceneObject* Object : ObjectBatch)
+			const size_t Count = Batch->Objects.size();
+			for (size_t Begin = 0; Begin < Count;)
 			{
-				Object->Render(ObjectBatch.size());
+				if ((ObjectLayers[Batch->Objects[Begin]->GetSceneIndex()] & PickLayers) == 0)
+				{
+					Begin++;
+					continue;
+				}
+
+				size_t End = Begin + 1;
+				while (End < Count && (ObjectLayers[Batch->Objects[End]->GetSceneIndex()] & PickLayers) != 0)
+				{
+					End++;
+				}
+				m_ObjectPicker.SetFirstIndex(static_cast<uint32_t>(Objects.size()));
+				for (const MeshDrawInfo& Info : Batch->Objects.front()->GetRenderProxy().GetDraws(Batch->LOD))
+				{
+					BaseMesh::Draw(Info, End - Begin, BaseInstance + Begin);
+				}
+				Objects.insert(Objects.end(), Batch->Objects.begin() + Begin, Batch->Objects.begin() + End);
+				Begin = End;
 			}
+			BaseInstance += Count;
 		}
+		m_ObjectPicker.EndPass(std::move(Objects), Scene);
 	}
 
 	void Renderer::RenderSkybox(SceneObject* Skybox)
@@ -93,19 +2595,114 @@ namespace fgl
 		if (!Skybox)
 			return;
 
-		if (Skybox->IsNew())
+		RenderCommandList& Commands = m_Commands.AcquireList();
+		Commands.BeginPacket(RenderQueue::MakeSortKey(BatchPass::Skybox, 0, 0, 0, 0.0f));
+		Commands.SetInstanceRange(1, 0);
+		Commands.DrawObject(*Skybox);
+		m_Commands.Submit();
+	}
+
+	void Renderer::RenderSkyPass()
+	{
+		RenderDevice& Device = RenderDevice::Get();
+		if (!m_SkyShader)
+		{
+			m_SkyShader = Shader::CreateFromSource(SkyVertexCode, SkyFragmentCode);
+			m_SkyVertexArray = Device.CreateVertexArray("Renderer sky");
+		}
+
+		Device.BindTexture(SkyUnit, m_Skybox->GetHandle());
+		m_SkyShader->Activate();
+		m_SkyShader->SetInt("Skybox", SkyUnit);
+
+		// Depth writes off: the sky only fills what the opaque passes left at the cleared depth
+		GLint PolygonMode[2];
+		glGetIntegerv(GL_POLYGON_MODE, PolygonMode);
+		glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+		GLStateCache::SetDepthFunc(GL_LEQUAL);
+		GLStateCache::SetDepthWrite(false);
+		Device.BindVertexArray(m_SkyVertexArray);
+		Device.Draw(3);
+		RenderCounters::CountDraw(1, 1);
+		GLStateCache::SetDepthWrite(true);
+		GLStateCache::SetDepthFunc(GL_LESS);
+		glPolygonMode(GL_FRONT_AND_BACK, static_cast<GLenum>(PolygonMode[0]));
+		Material::InvalidateActiveMaterial();
+	}
+
+	void Renderer::RenderTransparentObjects(const FrameBatchList& ObjectBatches, GLuint Framebuffer, const GLint Viewport[4])
+	{
+		FGL_PROFILE_SCOPE("Renderer::RenderTransparentObjects")
+
+		const bool bWeightedBlended = m_TransparencyMode == TransparencyMode::WeightedBlended;
+		const glm::mat4& View = m_CameraBuffer.GetData().View;
+		RenderCommandList& Commands = m_Commands.AcquireList();
+		bool bAnyTransparent = false;
+
+		// Slices of the MVP buffer follow batch order (see UpdateMVPInstances), as in RecordBatchCommands()
+		size_t BaseInstance = m_MVPMatrixBuffer.GetRegionBaseInstance();
+		for (const ObjectBatch* Batch : ObjectBatches)
+		{
+			SceneObject* Front = Batch->Objects.front();
+			if (IsTransparent(*Front))
+			{
+				bAnyTransparent = true;
+				if (bWeightedBlended)
+				{
+					// Accumulation does not depend on the draw order, batches stay instanced and sorted by state
+					Commands.BeginPacket(MakeBatchKey(*Batch, BatchPass::Transparent));
+					Commands.SetInstanceRange(Batch->Objects.size(), BaseInstance);
+					Commands.DrawProxy(Front->GetRenderProxy(), Batch->LOD);
+				}
+				else
+				{
+					// Blending needs every object in depth order, whatever batch it belongs to
+					const std::shared_ptr<Material>& BatchMaterial = Front->GetRenderProxy().ObjectMaterial;
+					const uint32_t ShaderID = BatchMaterial->GetRenderState().Program ? BatchMaterial->GetRenderState().Program->GetID() : 0;
+					for (size_t Index = 0; Index < Batch->Objects.size(); Index++)
+					{
+						SceneObject* Object = Batch->Objects[Index];
+						const float ViewDepth = -(View * Object->GetTransform().GetRenderModelMatrix()[3]).z;
+						Commands.BeginPacket(RenderQueue::MakeBackToFrontKey(BatchPass::Transparent, ViewDepth, ShaderID, BatchMaterial->GetID()));
+						Commands.SetInstanceRange(1, BaseInstance + Index);
+						Commands.DrawProxy(Object->GetRenderProxy(), Batch->LOD);
+					}
+				}
+			}
+			BaseInstance += Batch->Objects.size();
+		}
+
+		if (!bAnyTransparent)
+		{
+			// Releases the empty list
+			m_Commands.Submit();
+			return;
+		}
+
+		if (bWeightedBlended)
+		{
+			m_TransparencyBuffer.Resize(Viewport[2], Viewport[3]);
+			m_TransparencyBuffer.BeginAccumulation(Framebuffer, Viewport[0], Viewport[1]);
+			m_Commands.Submit();
+			m_TransparencyBuffer.Composite();
+		}
+		else
 		{
-			PerformFirstPass(Skybox);
-			Skybox->SetNew(false);
+			glEnable(GL_BLEND);
+			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+			GLStateCache::BeginDepthOverride(GL_LESS, false);
+			m_Commands.Submit();
+			GLStateCache::EndDepthOverride();
+			glDisable(GL_BLEND);
 		}
-		Skybox->Render(1);
+		Material::InvalidateActiveMaterial();
 	}
 
 	void Renderer::PerformFirstPass(SceneObject* Object)
 	{
 		for (BaseMesh& Mesh : Object->GetMeshes())
 		{
-			Mesh.FirstPass();
+			Mesh.FirstPass(m_GeometryArena);
 		}
 	}
 
@@ -117,61 +2714,286 @@ namespace fgl
 		}
 	}
 
-	void Renderer::UpdateMVPInstances(const Scene* Scene, const std::map<size_t, std::vector<SceneObject*>>& ObjectBatches, bool HasSkybox)
+	void Renderer::UpdateMVPInstances(const FrameBatchList& ObjectBatches)
 	{
-		size_t TotalObjectCount = Scene->GetObjects().size() - HasSkybox;
+		FGL_PROFILE_SCOPE("Renderer::UpdateMVPInstances")
+		size_t TotalObjectCount = 0;
+		for (const ObjectBatch* Batch : ObjectBatches)
+		{
+			TotalObjectCount += Batch->Objects.size();
+		}
+
+		bool bRewriteAll = EnsureBufferCapacity(ObjectBatches, TotalObjectCount);
 
-		EnsureBufferCapacity(TotalObjectCount);
+		// Slots follow batch order, every batched object was already set up by UploadPendingObjects
+		m_SlotObjects.clear();
+		for (const ObjectBatch* Batch : ObjectBatches)
+		{
+			m_SlotObjects.insert(m_SlotObjects.end(), Batch->Objects.begin(), Batch->Objects.end());
+		}
 
-		size_t Index = 0;
-		for (const auto& [Hash, Batch] : ObjectBatches)
+		// Instances only carry model matrices, only moved or re-slotted objects are rewritten
+		if (!m_JobSystem || TotalObjectCount <= m_InstanceChunkSize)
+		{
+			for (size_t Slot = 0; Slot < TotalObjectCount; Slot++)
+			{
+				if (ProcessObjectForMVP(m_SlotObjects[Slot], Slot, bRewriteAll))
+				{
+					m_MVPMatrixBuffer.MarkDirty(Slot);
+				}
+			}
+		}
+		else
 		{
-			for (SceneObject* Object : Batch)
+			// Every chunk writes its own slots and dirty range, the ranges are merged once all chunks ran
+			m_ChunkDirtyRanges.assign((TotalObjectCount + m_InstanceChunkSize - 1) / m_InstanceChunkSize, { SIZE_MAX, 0 });
+			m_JobSystem->ParallelFor(TotalObjectCount, m_InstanceChunkSize, [this, bRewriteAll](size_t Begin, size_t End)
+			{
+				std::pair<size_t, size_t>& Range = m_ChunkDirtyRanges[Begin / m_InstanceChunkSize];
+				for (size_t Slot = Begin; Slot < End; Slot++)
+				{
+					if (ProcessObjectForMVP(m_SlotObjects[Slot], Slot, bRewriteAll))
+					{
+						Range.first = std::min(Range.first, Slot);
+						Range.second = Slot + 1;
+					}
+				}
+			});
+
+			for (const auto& [First, End] : m_ChunkDirtyRanges)
 			{
-				ProcessObjectForMVP(Object, Index);
+				if (First < End)
+				{
+					m_MVPMatrixBuffer.MarkDirty(First);
+					m_MVPMatrixBuffer.MarkDirty(End - 1);
+				}
 			}
 		}
 
-		UploadMVPDataToGPU();
+		UploadMVPDataToGPU(TotalObjectCount);
 	}
 
-	void Renderer::EnsureBufferCapacity(size_t TotalObjectCount)
+	void Renderer::SetJobSystem(JobSystem* Jobs, size_t ChunkSize)
 	{
-		if (!m_MVPMatrixBuffer.Get() || m_MVPMatrixBuffer.GetObjectCount() < TotalObjectCount)
+		m_JobSystem = Jobs;
+		m_InstanceChunkSize = std::max<size_t>(ChunkSize, 1);
+	}
+
+	size_t Renderer::PrewarmPipelines(Scene* Scene)
+	{
+		FGL_PROFILE_SCOPE("Renderer::PrewarmPipelines")
+		const auto Start = std::chrono::steady_clock::now();
+
+		// Every mesh needs its vertex array, whatever the per-frame upload budget
+		const float UploadBudget = std::exchange(m_UploadBudget, 0.0f);
+		UploadPendingObjects(Scene);
+		m_UploadBudget = UploadBudget;
+		if (!m_UploadedObjects.empty())
+		{
+			// The next GPU culling frame would only write the objects it uploads itself
+			m_GPUObjectsCurrent = false;
+		}
+		UploadStaticGeometry(Scene);
+
+		std::vector<PrewarmDraw> Draws;
+		for (const auto& Object : Scene->GetObjects())
+		{
+			if (!(Object->GetRenderProxy().Flags & RenderProxy::Skybox))
+			{
+				AddPrewarmDraws(Draws, Object->GetRenderProxy().Meshes, IsTransparent(*Object));
+			}
+		}
+		if (const StaticGeometry* Static = Scene->GetStaticGeometry())
+		{
+			for (const StaticChunk& Chunk : Static->GetChunks())
+			{
+				AddPrewarmDraws(Draws, std::span<const BaseMesh>(&Chunk.Mesh, 1), false);
+			}
+		}
+		if (Draws.empty())
+			return 0;
+
+		// Draws go to the framebuffer Render() draws into, its formats are part of the compiled state
+		GLint Framebuffer = 0;
+		GLint Viewport[4];
+		glGetIntegerv(GL_FRAMEBUFFER_BINDING, &Framebuffer);
+		glGetIntegerv(GL_VIEWPORT, Viewport);
+		if (m_OutputTarget)
+		{
+			m_OutputTarget->Bind();
+		}
+		GLint TargetViewport[4] = { 0, 0, Viewport[2], Viewport[3] };
+		if (UsesRenderTarget())
+		{
+			const float Scale = GetAppliedRenderScale();
+			m_SceneTarget.Resize(std::max(static_cast<int>(std::lround(Viewport[2] * Scale)), 1),
+				std::max(static_cast<int>(std::lround(Viewport[3] * Scale)), 1), m_AntiAliasing == AntiAliasingMode::MSAA ? m_RenderTargetSamples : 0,
+				m_PostProcessing ? PostProcessStack::SceneFormat : GL_RGBA8);
+			m_SceneTarget.Bind();
+			TargetViewport[2] = m_SceneTarget.GetWidth();
+			TargetViewport[3] = m_SceneTarget.GetHeight();
+		}
+		GLint TargetFramebuffer = 0;
+		glGetIntegerv(GL_FRAMEBUFFER_BINDING, &TargetFramebuffer);
+		glViewport(0, 0, 1, 1);
+
+		// One identity instance stands in for the objects, whose slots aren't written before their first frame
+		const InstanceData Instance{ glm::mat4(1.0f), glm::mat3x4(1.0f), glm::uvec4(0), 0, 0, 0, 0, glm::vec4(0.0f) };
+		GLuint InstanceBuffer = 0;
+		glGenBuffers(1, &InstanceBuffer);
+		GLStateCache::BindBuffer(GL_ARRAY_BUFFER, InstanceBuffer);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(InstanceData), &Instance, GL_STATIC_DRAW);
+		const GLuint InstanceSource = m_InstanceSource;
+		BindInstanceSource(InstanceBuffer);
+
+		// Every draw is one instance of the coarsest level, only the first pixel is rasterized
+		const uint32_t CoarsestLOD = std::numeric_limits<uint32_t>::max();
+		Material::InvalidateActiveMaterial();
+		if (UsesDepthPrepass())
+		{
+			// The prepass program only varies with the vertex format; EndDepthPrepass() isn't called, it computes the SSAO
+			BeginDepthPrepass();
+			for (size_t Index = 0; Index < Draws.size(); Index++)
+			{
+				const PrewarmDraw& Draw = Draws[Index];
+				const bool bNewFormat = std::none_of(Draws.begin(), Draws.begin() + Index, [&Draw](const PrewarmDraw& Drawn)
+				{
+					return !Drawn.bTransparent && Drawn.VertexArray == Draw.VertexArray && Drawn.IndexType == Draw.IndexType;
+				});
+				if (!Draw.bTransparent && bNewFormat)
+				{
+					Draw.Mesh->Draw(1, 0, CoarsestLOD);
+				}
+			}
+			glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+			Material::InvalidateActiveMaterial();
+		}
+
+		for (const PrewarmDraw& Draw : Draws)
 		{
-			m_MVPMatrixBuffer.Resize(TotalObjectCount);
-			glBindBuffer(GL_ARRAY_BUFFER, m_MVPBufferID);
-			glBufferData(GL_ARRAY_BUFFER, m_MVPMatrixBuffer.GetBufferSize(), nullptr, GL_DYNAMIC_DRAW);
+			if (!Draw.bTransparent)
+			{
+				Draw.Mesh->GetMaterial()->Activate();
+				Draw.Mesh->Draw(1, 0, CoarsestLOD);
+			}
+		}
+		GLStateCache::ResetRasterState();
+
+		// Transparent materials compile against the blending of their pass
+		const bool bAnyTransparent = std::any_of(Draws.begin(), Draws.end(), [](const PrewarmDraw& Draw) { return Draw.bTransparent; });
+		if (bAnyTransparent)
+		{
+			const bool bWeightedBlended = m_TransparencyMode == TransparencyMode::WeightedBlended;
+			if (bWeightedBlended)
+			{
+				m_TransparencyBuffer.Resize(TargetViewport[2], TargetViewport[3]);
+				m_TransparencyBuffer.BeginAccumulation(TargetFramebuffer, 0, 0);
+				glViewport(0, 0, 1, 1);
+			}
+			else
+			{
+				glEnable(GL_BLEND);
+				glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+				GLStateCache::BeginDepthOverride(GL_LESS, false);
+			}
+			for (const PrewarmDraw& Draw : Draws)
+			{
+				if (Draw.bTransparent)
+				{
+					Draw.Mesh->GetMaterial()->Activate();
+					Draw.Mesh->Draw(1, 0, CoarsestLOD);
+				}
+			}
+			GLStateCache::ResetRasterState();
+			if (bWeightedBlended)
+			{
+				m_TransparencyBuffer.Composite();
+			}
+			else
+			{
+				GLStateCache::EndDepthOverride();
+				glDisable(GL_BLEND);
+			}
+		}
+		Material::InvalidateActiveMaterial();
+
+		// The next frame points the instanced attributes at its own buffer again and clears the pixel
+		glDeleteBuffers(1, &InstanceBuffer);
+		GLStateCache::OnBufferDeleted(InstanceBuffer);
+		if (InstanceSource != 0)
+		{
+			BindInstanceSource(InstanceSource);
+		}
+		else
+		{
+			m_GeometryArena.SetInstanceBuffer({});
+			m_InstanceSource = 0;
 		}
+		glBindFramebuffer(GL_FRAMEBUFFER, Framebuffer);
+		glViewport(Viewport[0], Viewport[1], Viewport[2], Viewport[3]);
+
+		const float Milliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - Start).count();
+		LOG_INFO("Prewarmed " + std::to_string(Draws.size()) + " pipelines in " + std::to_string(Milliseconds) + " ms.")
+		return Draws.size();
 	}
 
-	void Renderer::ProcessObjectForMVP(SceneObject* Object, size_t& Index)
+	bool Renderer::EnsureBufferCapacity(const FrameBatchList& ObjectBatches, size_t TotalObjectCount)
 	{
-		if (Object->IsNew())
+		if (m_MVPMatrixBuffer.GetObjectCount() >= TotalObjectCount)
+			return false;
+
+		if (m_MVPMatrixBuffer.Resize(TotalObjectCount))
 		{
-			PerformFirstPass(Object);
+			// The buffer object was replaced, objects already set up still point at the old one
 			BindMVPBuffer();
-			PerformSecondPass(Object);
-			Object->SetNew(false);
+			for (const ObjectBatch* Batch : ObjectBatches)
+			{
+				for (SceneObject* Object : Batch->Objects)
+				{
+					PerformSecondPass(Object);
+				}
+			}
+		}
+		return true;
+	}
+
+	bool Renderer::ProcessObjectForMVP(SceneObject* Object, size_t Slot, bool bRewrite)
+	{
+		// Materials can be swapped without touching the Transform, their index is compared directly
+		const std::shared_ptr<Material>& ObjectMaterial = Object->GetRenderProxy().ObjectMaterial;
+		const uint32_t MaterialIndex = ObjectMaterial ? ObjectMaterial->GetID() : 0;
+		InstanceData& Instance = m_MVPMatrixBuffer.Get()[Slot];
+
+		// Snapshot matrices never change under the frame, the live dirty flags belong to the next one
+		Transform& ObjectTransform = Object->GetTransform();
+		const uint64_t Revision = ObjectTransform.GetRenderRevision();
+		if (!bRewrite && Object->GetInstanceSlot() == Slot && (TransformPool::HasSnapshot() || !ObjectTransform.IsDirty())
+			&& Revision == Object->GetInstanceRevision() && Instance.MaterialIndex == MaterialIndex)
+		{
+			return false;
 		}
 
-		glm::mat4 MVP, Model;
-		Object->GetTransform().ComputeModelViewProjection(MVP, Model);
-		m_MVPMatrixBuffer.Get()[Index] = MVP;
-		m_MVPMatrixBuffer.Get()[Index + 1] = Model;
-		Index += 2;
+		Instance.Model = ObjectTransform.GetRenderModelMatrix();
+		Instance.NormalMatrix = glm::mat3x4(ObjectTransform.GetRenderNormalMatrix());
+		WriteProceduralAnimation(Instance, Object->GetPackedAnimation());
+		Instance.TextureLayers = Object->GetTextureLayers();
+		Instance.MaterialIndex = MaterialIndex;
+		Instance.BoneOffset = Object->GetBoneOffset();
+		Instance.ReflectionProbe = Object->GetReflectionProbe();
+		Instance.PointLights = Object->GetPointLights();
+		Instance.Payload = Object->GetInstancePayload();
+		Object->SetInstanceSlot(Slot, Revision);
+		return true;
 	}
 
 	void Renderer::BindMVPBuffer()
 	{
-		glBindBuffer(GL_ARRAY_BUFFER, m_MVPBufferID);
+		m_GeometryArena.SetInstanceBuffer({ m_MVPMatrixBuffer.GetBufferID() });
 	}
 
-	void Renderer::UploadMVPDataToGPU()
+	void Renderer::UploadMVPDataToGPU(size_t UsedObjectCount)
 	{
-		glBindBuffer(GL_ARRAY_BUFFER, m_MVPBufferID);
-		glBufferSubData(GL_ARRAY_BUFFER, 0, m_MVPMatrixBuffer.GetBufferSize(), m_MVPMatrixBuffer.Get());
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		m_MVPMatrixBuffer.Upload(UsedObjectCount);
 	}
 
 } // namespace fgl
\ No newline at end of file
@@ -0,0 +1,121 @@
+#include <FireGL/Renderer/ResolutionController.h>
+
+namespace fgl
+{
+
+	void ResolutionController::Destroy()
+	{
+		for (FrameQuery& Frame : m_Queries)
+		{
+			if (Frame.Query != 0)
+			{
+				glDeleteQueries(1, &Frame.Query);
+			}
+			Frame = FrameQuery();
+		}
+		m_Next = 0;
+		m_Oldest = 0;
+		m_bTiming = false;
+	}
+
+	void ResolutionController::BeginFrame()
+	{
+		m_Frame++;
+
+		// Every slot still waiting on the GPU: this frame goes unmeasured rather than stalling
+		FrameQuery& Frame = m_Queries[m_Next];
+		m_bTiming = !Frame.bPending;
+		if (!m_bTiming)
+			return;
+
+		if (Frame.Query == 0)
+		{
+			glGenQueries(1, &Frame.Query);
+		}
+		Frame.Frame = m_Frame;
+		glBeginQuery(GL_TIME_ELAPSED, Frame.Query);
+	}
+
+	void ResolutionController::EndFrame()
+	{
+		if (m_bTiming)
+		{
+			glEndQuery(GL_TIME_ELAPSED);
+			m_Queries[m_Next].bPending = true;
+			m_Next = (m_Next + 1) % QueryCount;
+			m_bTiming = false;
+		}
+
+		// Queries complete in order, the first one not available ends the readback
+		while (m_Queries[m_Oldest].bPending)
+		{
+			FrameQuery& Frame = m_Queries[m_Oldest];
+			GLint bAvailable = GL_FALSE;
+			glGetQueryObjectiv(Frame.Query, GL_QUERY_RESULT_AVAILABLE, &bAvailable);
+			if (!bAvailable)
+				break;
+
+			GLuint64 Nanoseconds = 0;
+			glGetQueryObjectui64v(Frame.Query, GL_QUERY_RESULT, &Nanoseconds);
+			Frame.bPending = false;
+			m_Oldest = (m_Oldest + 1) % QueryCount;
+			Apply(static_cast<float>(Nanoseconds) * 1e-6f, static_cast<uint32_t>(m_Frame - Frame.Frame));
+		}
+	}
+
+	void ResolutionController::Apply(float GPUFrameTime, uint32_t Latency)
+	{
+		const float Error = (m_TargetFrameTime - GPUFrameTime) / m_TargetFrameTime;
+		const float Adjustment = m_Proportional * (Error - m_PreviousError) + m_Integral * Error
+			+ m_Derivative * (Error - 2.0f * m_PreviousError + m_OlderError);
+		m_OlderError = m_PreviousError;
+		m_PreviousError = Error;
+
+		m_State.Scale = std::clamp(m_State.Scale + Adjustment, m_MinScale, m_MaxScale);
+		m_State.AppliedScale = std::clamp(std::round(m_State.Scale * 16.0f) / 16.0f, m_MinScale, m_MaxScale);
+		m_State.GPUFrameTime = GPUFrameTime;
+		m_State.Error = Error;
+		m_State.Adjustment = Adjustment;
+		m_State.Latency = Latency;
+		m_State.Measurements++;
+	}
+
+	void ResolutionController::SetTargetFrameTime(float Milliseconds)
+	{
+		m_TargetFrameTime = std::max(Milliseconds, 0.1f);
+	}
+
+	void ResolutionController::SetBounds(float MinScale, float MaxScale)
+	{
+		m_MinScale = std::clamp(MinScale, 0.25f, 2.0f);
+		m_MaxScale = std::clamp(MaxScale, m_MinScale, 2.0f);
+		Reset(m_State.Scale);
+	}
+
+	void ResolutionController::SetGains(float Proportional, float Integral, float Derivative)
+	{
+		m_Proportional = Proportional;
+		m_Integral = Integral;
+		m_Derivative = Derivative;
+	}
+
+	void ResolutionController::Reset(float Scale)
+	{
+		m_State = ResolutionControllerState();
+		m_State.Scale = std::clamp(Scale, m_MinScale, m_MaxScale);
+		m_State.AppliedScale = std::clamp(std::round(m_State.Scale * 16.0f) / 16.0f, m_MinScale, m_MaxScale);
+		m_PreviousError = 0.0f;
+		m_OlderError = 0.0f;
+	}
+
+	float ResolutionController::GetAppliedScale() const
+	{
+		return m_State.AppliedScale;
+	}
+
+	const ResolutionControllerState& ResolutionController::GetState() const
+	{
+		return m_State;
+	}
+
+} // namespace fgl
@@ -0,0 +1,84 @@
+#include <FireGL/Renderer/SamplerCache.h>
+#include <FireGL/Renderer/GLExtensions.h>
+
+namespace fgl
+{
+
+	std::vector<std::pair<SamplerState, GLuint>> SamplerCache::s_Samplers;
+	float SamplerCache::s_MaxAnisotropy = 1.0f;
+
+	namespace
+	{
+		bool UsesMipmaps(GLenum MinFilter)
+		{
+			return MinFilter != GL_NEAREST && MinFilter != GL_LINEAR;
+		}
+	}
+
+	GLuint SamplerCache::Get(const SamplerState& State)
+	{
+		for (const auto& [Cached, Sampler] : s_Samplers)
+		{
+			if (Cached == State)
+				return Sampler;
+		}
+
+		GLuint Sampler = 0;
+		glGenSamplers(1, &Sampler);
+		glSamplerParameteri(Sampler, GL_TEXTURE_WRAP_S, State.WrapS);
+		glSamplerParameteri(Sampler, GL_TEXTURE_WRAP_T, State.WrapT);
+		glSamplerParameteri(Sampler, GL_TEXTURE_WRAP_R, State.WrapR);
+		glSamplerParameteri(Sampler, GL_TEXTURE_MIN_FILTER, State.MinFilter);
+		glSamplerParameteri(Sampler, GL_TEXTURE_MAG_FILTER, State.MagFilter);
+		ApplyAnisotropy(Sampler, State);
+		s_Samplers.emplace_back(State, Sampler);
+		return Sampler;
+	}
+
+	void SamplerCache::SetMaxAnisotropy(float Anisotropy)
+	{
+		Anisotropy = std::clamp(Anisotropy, 1.0f, GetSupportedAnisotropy());
+		if (Anisotropy == s_MaxAnisotropy)
+			return;
+
+		s_MaxAnisotropy = Anisotropy;
+		for (const auto& [State, Sampler] : s_Samplers)
+		{
+			ApplyAnisotropy(Sampler, State);
+		}
+	}
+
+	float SamplerCache::GetMaxAnisotropy()
+	{
+		return s_MaxAnisotropy;
+	}
+
+	float SamplerCache::GetSupportedAnisotropy()
+	{
+		static const float Supported = []()
+		{
+			if (!GLExtensions::HasAnisotropicFiltering())
+				return 1.0f;
+
+			GLfloat Max = 1.0f;
+			glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY, &Max);
+			return std::max(Max, 1.0f);
+		}();
+		return Supported;
+	}
+
+	size_t SamplerCache::GetCount()
+	{
+		return s_Samplers.size();
+	}
+
+	void SamplerCache::ApplyAnisotropy(GLuint Sampler, const SamplerState& State)
+	{
+		// Without mips there is nothing to filter anisotropically, and the parameter is an error without support
+		if (!State.bAnisotropic || !UsesMipmaps(State.MinFilter) || !GLExtensions::HasAnisotropicFiltering())
+			return;
+
+		glSamplerParameterf(Sampler, GL_TEXTURE_MAX_ANISOTROPY, s_MaxAnisotropy);
+	}
+
+} // namespace fgl
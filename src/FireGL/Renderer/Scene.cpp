@@ -1,12 +1,53 @@
 #include <FireGL/Renderer/Scene.h>
 #include <FireGL/Core/TimeManager.h>
+#include <FireGL/Core/Profiler.h>
 #include <FireGL/Core/SystemManager.h>
+#include <FireGL/Core/JobSystem.h>
+#include <FireGL/Renderer/ComponentPool.h>
+#include <FireGL/Renderer/ObjectPool.h>
+#include <FireGL/Core/BaseLog.h>
 #include <FireGL/Renderer/SceneObject.h>
 #include <FireGL/Renderer/BaseCamera.h>
+#include <FireGL/Renderer/Frustum.h>
+#include <FireGL/Renderer/TransformPool.h>
+#include <FireGL/Renderer/StaticGeometry.h>
+
+#include <External/glm/geometric.hpp>
+
+#include <bit>
 
 namespace fgl
 {
 
+	namespace
+	{
+		/** Replaces the queued indices of a queue by their objects, dropping the objects being removed. */
+		template<typename Queue>
+		std::vector<SceneObject*> ResolveQueue(const Queue& Indices, const Scene::ObjectList& Objects)
+		{
+			std::vector<SceneObject*> Resolved;
+			for (uint32_t Index : Indices)
+			{
+				if (!Objects[Index]->IsPendingRemoval())
+				{
+					Resolved.push_back(Objects[Index].get());
+				}
+			}
+			return Resolved;
+		}
+
+		/** Refills a queue with the current indices of its objects. */
+		template<typename Queue>
+		void RestoreQueue(Queue& Indices, const std::vector<SceneObject*>& Objects)
+		{
+			Indices.clear();
+			for (SceneObject* Object : Objects)
+			{
+				Indices.push_back(Object->GetSceneIndex());
+			}
+		}
+	}
+
 	Scene::Scene()
 		: m_ActiveCamera(nullptr)
 	{
@@ -17,32 +58,571 @@ namespace fgl
 		AddCamera(ActiveCamera);
 	}
 
+	Scene::~Scene() = default;
+
 	void Scene::AddObject(std::unique_ptr<SceneObject> Object)
 	{
+		if (m_bDeferChanges)
+		{
+			m_DeferredObjects.push_back(std::move(Object));
+			return;
+		}
+
+		const uint32_t Index = static_cast<uint32_t>(m_Objects.size());
 		Object->SetScene(this);
+		Object->SetSceneIndex(Index);
+		Object->CaptureRenderProxy();
+		if (Object->GetRenderProxy().Flags & RenderProxy::Skybox)
+		{
+			m_UnboundedObjects.push_back(Index);
+		}
+		m_MovedObjects.push_back(Index);
+		m_PendingUploads.push_back(Index);
+		RecordChange(Object.get(), SceneChange::Added);
+		if (Object->HasOverlapEvents())
+		{
+			m_Overlaps.Add(Object.get());
+		}
+		// Queued rather than registered, objects may be spawned from a Tick()
+		m_TickScheduler.Refresh(Object.get());
 		Object->BeginPlay();
 		m_Objects.push_back(std::move(Object));
 	}
 
-	const std::vector<std::unique_ptr<SceneObject>>& Scene::GetObjects() const
+	void Scene::Reserve(size_t ObjectCount)
+	{
+		m_Objects.reserve(ObjectCount);
+		m_BoundingSphereRevisions.reserve(ObjectCount);
+		m_BoundingVolumeLeaves.reserve(ObjectCount);
+		m_ObjectLayers.reserve(ObjectCount);
+		m_MovedObjects.reserve(ObjectCount);
+		m_ChangedObjects.reserve(ObjectCount);
+		m_BoundingSpheres.X.reserve(ObjectCount);
+		m_BoundingSpheres.Y.reserve(ObjectCount);
+		m_BoundingSpheres.Z.reserve(ObjectCount);
+		m_BoundingSpheres.Radius.reserve(ObjectCount);
+	}
+
+	void Scene::RemoveObject(SceneObject* Object)
+	{
+		LOG_ASSERT(Object && Object->GetScene() == this, "The object to remove isn't part of this scene")
+		if (Object->IsPendingRemoval())
+			return;
+
+		Object->SetPendingRemoval(true);
+		m_PendingRemovals.push_back(Object->GetSceneIndex());
+	}
+
+	void Scene::FlushRemovedObjects()
+	{
+		if (m_PendingRemovals.empty())
+			return;
+
+		// Registrations queued for the removed objects are applied first, they are unregistered below
+		m_TickScheduler.ApplyRefreshes();
+
+		// Objects move during compaction, the queues follow them by pointer and the moved ones are queued as changed
+		std::vector<SceneObject*> MovedObjects = ResolveQueue(m_MovedObjects, m_Objects);
+		const std::vector<SceneObject*> PendingUploads = ResolveQueue(m_PendingUploads, m_Objects);
+		const std::vector<SceneObject*> UnboundedObjects = ResolveQueue(m_UnboundedObjects, m_Objects);
+
+		// Objects added since the last UpdateBoundingSpheres() get default bounds, as it would give them
+		const size_t ObjectCount = m_Objects.size();
+		m_BoundingSpheres.Resize(ObjectCount);
+		m_BoundingSphereRevisions.resize(ObjectCount, 0);
+		m_BoundingVolumeLeaves.resize(ObjectCount, DynamicBVH::NullNode);
+		m_ObjectLayers.resize(ObjectCount, 0);
+		m_bLayersDirty = true;
+
+		// From the highest index down, so the last object is never one still to be removed
+		std::sort(m_PendingRemovals.begin(), m_PendingRemovals.end(), std::greater<uint32_t>());
+		for (uint32_t Index : m_PendingRemovals)
+		{
+			std::unique_ptr<SceneObject> Removed = std::move(m_Objects[Index]);
+			if (m_BoundingVolumeLeaves[Index] != DynamicBVH::NullNode)
+			{
+				m_BoundingVolumes.Remove(m_BoundingVolumeLeaves[Index]);
+			}
+
+			const uint32_t Last = static_cast<uint32_t>(m_Objects.size() - 1);
+			if (Index != Last)
+			{
+				m_Objects[Index] = std::move(m_Objects[Last]);
+				m_Objects[Index]->SetSceneIndex(Index);
+				MovedObjects.push_back(m_Objects[Index].get());
+				RecordChange(m_Objects[Index].get(), SceneChange::Reindexed);
+				m_BoundingSpheres.X[Index] = m_BoundingSpheres.X[Last];
+				m_BoundingSpheres.Y[Index] = m_BoundingSpheres.Y[Last];
+				m_BoundingSpheres.Z[Index] = m_BoundingSpheres.Z[Last];
+				m_BoundingSpheres.Radius[Index] = m_BoundingSpheres.Radius[Last];
+				m_BoundingSphereRevisions[Index] = m_BoundingSphereRevisions[Last];
+				m_BoundingVolumeLeaves[Index] = m_BoundingVolumeLeaves[Last];
+				m_ObjectLayers[Index] = m_ObjectLayers[Last];
+				if (m_BoundingVolumeLeaves[Index] != DynamicBVH::NullNode)
+				{
+					m_BoundingVolumes.SetObjectIndex(m_BoundingVolumeLeaves[Index], Index);
+				}
+			}
+			m_Objects.pop_back();
+			m_BoundingSphereRevisions.pop_back();
+			m_BoundingVolumeLeaves.pop_back();
+			m_ObjectLayers.pop_back();
+			m_BoundingSpheres.Resize(m_Objects.size());
+
+			// A recycled object starts over: new scene, new instance slot, new batch, new upload
+			if (Removed->GetOverlapProxy() != OverlapSystem::InvalidProxy)
+			{
+				m_Overlaps.Remove(Removed.get());
+			}
+			m_TickScheduler.Remove(Removed.get());
+			Removed->Destroy();
+			Removed->SetScene(nullptr);
+
+			// Past Destroy() nothing records changes anymore, the journal forgets the object's; one added and removed since the last publication never existed
+			const uint8_t ChangeMask = Removed->GetChangeMask();
+			if (ChangeMask != 0)
+			{
+				m_JournalObjects[Removed->GetChangeSlot()] = nullptr;
+				Removed->SetChangeState(0, 0);
+			}
+			if (!(ChangeMask & (1u << static_cast<uint8_t>(SceneChange::Added))))
+			{
+				m_JournalRemoved.push_back(Removed.get());
+			}
+
+			Removed->SetPendingRemoval(false);
+			Removed->SetMerged(false);
+			Removed->SetInstanceSlot(SIZE_MAX, 0);
+			Removed->InvalidateBatch();
+			if (ObjectPoolBase* Pool = Removed->GetObjectPool())
+			{
+				Pool->Recycle(std::move(Removed));
+			}
+		}
+		m_PendingRemovals.clear();
+
+		RestoreQueue(m_MovedObjects, MovedObjects);
+		RestoreQueue(m_PendingUploads, PendingUploads);
+		RestoreQueue(m_UnboundedObjects, UnboundedObjects);
+	}
+
+	const Scene::ObjectList& Scene::GetObjects() const
 	{
 		return m_Objects;
 	}
 
+	void Scene::BuildStaticGeometry(float ChunkSize)
+	{
+		FGL_PROFILE_SCOPE("Scene::BuildStaticGeometry")
+		if (!m_StaticGeometry)
+		{
+			m_StaticGeometry = std::make_unique<StaticGeometry>();
+		}
+
+		std::vector<SceneObject*> Merged;
+		for (const auto& Object : m_Objects)
+		{
+			const bool bMerged = Object->IsStatic() && !Object->IsPendingRemoval() && StaticGeometry::CanMerge(*Object);
+			Object->SetMerged(bMerged);
+			if (bMerged)
+			{
+				Merged.push_back(Object.get());
+			}
+		}
+		m_StaticGeometry->Build(Merged, ChunkSize);
+		LOG_INFO("Merged " + std::to_string(Merged.size()) + " static objects into " + std::to_string(m_StaticGeometry->GetChunks().size()) + " chunks.")
+	}
+
+	void Scene::ClearStaticGeometry()
+	{
+		if (!m_StaticGeometry)
+			return;
+
+		for (const auto& Object : m_Objects)
+		{
+			Object->SetMerged(false);
+		}
+		m_StaticGeometry->Clear();
+	}
+
+	StaticGeometry* Scene::GetStaticGeometry() const
+	{
+		return m_StaticGeometry.get();
+	}
+
+	TaggedDeque<uint32_t, MemoryTag::Scene>& Scene::GetPendingUploads()
+	{
+		return m_PendingUploads;
+	}
+
+	void Scene::SetDeferredChanges(bool bEnabled)
+	{
+		m_bDeferChanges = bEnabled;
+		if (!bEnabled)
+		{
+			ApplyDeferredChanges();
+		}
+	}
+
+	bool Scene::IsDeferringChanges() const
+	{
+		return m_bDeferChanges;
+	}
+
+	void Scene::ApplyDeferredChanges()
+	{
+		FlushRemovedObjects();
+
+		// AddObject() would queue them again while deferring
+		const bool bDeferChanges = m_bDeferChanges;
+		m_bDeferChanges = false;
+		ObjectList DeferredObjects = std::move(m_DeferredObjects);
+		m_DeferredObjects.clear();
+		for (std::unique_ptr<SceneObject>& Object : DeferredObjects)
+		{
+			AddObject(std::move(Object));
+		}
+		m_bDeferChanges = bDeferChanges;
+	}
+
 	void Scene::Process()
 	{
+		FGL_PROFILE_SCOPE("Scene::Process")
+		if (!m_bDeferChanges)
+		{
+			FlushRemovedObjects();
+		}
 		m_ActiveCamera->UpdateViewMatrix();
 
-		for (const auto& Object : m_Objects)
+		TimeManager* Manager = SystemManager<TimeManager>::Get();
+		if (!Manager)
+		{
+			PublishChanges();
+			return;
+		}
+
+		// With a fixed timestep the objects are ticked once per step, their transforms rendered between the last two
+		if (!Manager->IsFixedTimeStep())
+		{
+			TransformPool::SetInterpolation(false);
+			TickObjects(Manager->GetDeltaTime());
+		}
+		else
+		{
+			TransformPool::SetInterpolation(true);
+			for (uint32_t Step = 0; Step < Manager->GetFixedStepCount(); Step++)
+			{
+				TransformPool::BeginFixedStep();
+				TickObjects(Manager->GetFixedDeltaTime());
+			}
+			TransformPool::SetInterpolationAlpha(Manager->GetInterpolationAlpha());
+		}
+
+		// Once per frame, the overlap events follow the transforms of the last tick
+		m_Overlaps.Update();
+		m_TickScheduler.Tick(TickGroup::Late, Manager->GetDeltaTime(), m_JobSystem, m_TickChunkSize);
+		PublishChanges();
+	}
+
+	void Scene::TickObjects(float DeltaTime)
+	{
+		m_TickScheduler.Tick(TickGroup::PrePhysics, DeltaTime, m_JobSystem, m_TickChunkSize);
+
+		// Components are updated type by type, each pool sweeping its contiguous storage
+		ComponentPoolBase::TickAll(this, DeltaTime, m_JobSystem);
+
+		m_TickScheduler.Tick(TickGroup::PostPhysics, DeltaTime, m_JobSystem, m_TickChunkSize);
+	}
+
+	void Scene::PublishChanges()
+	{
+		FGL_PROFILE_SCOPE("Scene::PublishChanges")
+		for (TaggedVector<uint32_t, MemoryTag::Scene>& Objects : m_Changes.Objects)
+		{
+			Objects.clear();
+		}
+		m_Changes.Removed.clear();
+		m_Changes.Removed.swap(m_JournalRemoved);
+
+		for (SceneObject* Object : m_JournalObjects)
 		{
-			TimeManager* Manager = SystemManager<TimeManager>::Get();
-			if (Manager)
+			if (!Object)
+				continue;
+
+			const uint32_t Index = Object->GetSceneIndex();
+			for (uint8_t Mask = Object->GetChangeMask(); Mask != 0; Mask &= Mask - 1)
 			{
-				Object->Tick(Manager->GetDeltaTime());
+				m_Changes.Objects[std::countr_zero(Mask)].push_back(Index);
 			}
+			Object->SetChangeState(0, 0);
+		}
+		m_JournalObjects.clear();
+		m_Changes.Frame++;
+	}
+
+	void Scene::SetJobSystem(JobSystem* Jobs, size_t ChunkSize)
+	{
+		m_JobSystem = Jobs;
+		m_TickChunkSize = ChunkSize;
+	}
+
+	void Scene::UpdateBoundingSpheres()
+	{
+		const size_t ObjectCount = m_Objects.size();
+		m_BoundingSpheres.Resize(ObjectCount);
+		m_BoundingSphereRevisions.resize(ObjectCount, 0);
+		m_BoundingVolumeLeaves.resize(ObjectCount, DynamicBVH::NullNode);
+		if (m_ObjectLayers.size() != ObjectCount)
+		{
+			// Added objects get no layer until visited below, they are all queued
+			m_ObjectLayers.resize(ObjectCount, 0);
+			m_bLayersDirty = true;
+		}
+
+		// Objects that didn't move keep their sphere and leaf, only the queued ones are visited
+		// Recalculating a child's matrix can queue it again, the queue is walked by index
+		for (size_t Queued = 0; Queued < m_MovedObjects.size(); Queued++)
+		{
+			const uint32_t Index = m_MovedObjects[Queued];
+			SceneObject* Object = m_Objects[Index].get();
+			if (m_ObjectLayers[Index] != Object->GetLayers())
+			{
+				m_ObjectLayers[Index] = Object->GetLayers();
+				m_bLayersDirty = true;
+			}
+			if (Object->GetRenderProxy().Flags & RenderProxy::Skybox)
+			{
+				m_BoundingSpheres.Set(Index, { glm::vec3(0.0f), std::numeric_limits<float>::infinity() });
+				continue;
+			}
+
+			// GetModelMatrix() recalculates dirty transforms, bumping their revision past the cached one
+			Transform& ObjectTransform = Object->GetTransform();
+			// Both counters only grow, their sum changes with either the transform or the object-space bounds
+			const glm::mat4& ModelMatrix = ObjectTransform.GetModelMatrix();
+			const uint64_t Revision = ObjectTransform.GetRevision() + Object->GetBoundsRevision();
+			if (m_BoundingSphereRevisions[Index] == Revision)
+				continue;
+
+			const BoundingSphere Sphere = Object->GetProceduralAnimation().Enclose(Object->GetLocalBoundingSphere()).Transformed(ModelMatrix);
+			m_BoundingSpheres.Set(Index, Sphere);
+			m_BoundingSphereRevisions[Index] = Revision;
+
+			const BoundingBox Box = { Sphere.Center - glm::vec3(Sphere.Radius), Sphere.Center + glm::vec3(Sphere.Radius) };
+			int32_t& Leaf = m_BoundingVolumeLeaves[Index];
+			if (Leaf == DynamicBVH::NullNode)
+			{
+				Leaf = m_BoundingVolumes.Insert(Index, Box);
+			}
+			else
+			{
+				m_BoundingVolumes.Move(Leaf, Box);
+			}
+		}
+		m_ChangedObjects.swap(m_MovedObjects);
+		m_MovedObjects.clear();
+
+		// Layers change rarely, the lists are rebuilt in one pass rather than patched per object
+		if (m_bLayersDirty)
+		{
+			m_UsedLayers = 0;
+			for (IndexList& Layer : m_LayerObjects)
+			{
+				Layer.clear();
+			}
+			for (uint32_t Index = 0; Index < ObjectCount; Index++)
+			{
+				const LayerMask Layers = m_ObjectLayers[Index];
+				m_UsedLayers |= Layers;
+				for (LayerMask Remaining = Layers; Remaining != 0; Remaining &= Remaining - 1)
+				{
+					m_LayerObjects[std::countr_zero(Remaining)].push_back(Index);
+				}
+			}
+			m_bLayersDirty = false;
+		}
+	}
+
+	const Scene::IndexList& Scene::GetChangedObjects() const
+	{
+		return m_ChangedObjects;
+	}
+
+	const Scene::IndexList& Scene::GetUnboundedObjects() const
+	{
+		return m_UnboundedObjects;
+	}
+
+	const TaggedVector<LayerMask, MemoryTag::Scene>& Scene::GetObjectLayers() const
+	{
+		return m_ObjectLayers;
+	}
+
+	const Scene::IndexList& Scene::GetLayerObjects(uint32_t Layer) const
+	{
+		LOG_ASSERT(Layer < MaxLayers, "The layer index is out of range")
+		return m_LayerObjects[Layer];
+	}
+
+	LayerMask Scene::GetUsedLayers() const
+	{
+		return m_UsedLayers;
+	}
+
+	void Scene::GatherLayerObjects(LayerMask Layers, std::vector<uint32_t>& OutIndices) const
+	{
+		OutIndices.clear();
+		Layers &= m_UsedLayers;
+		for (LayerMask Remaining = Layers; Remaining != 0; Remaining &= Remaining - 1)
+		{
+			const IndexList& Layer = m_LayerObjects[std::countr_zero(Remaining)];
+			OutIndices.insert(OutIndices.end(), Layer.begin(), Layer.end());
+		}
+
+		// A single layer is already sorted, objects in several layers appear once per layer otherwise
+		if (std::popcount(Layers) > 1)
+		{
+			std::sort(OutIndices.begin(), OutIndices.end());
+			OutIndices.erase(std::unique(OutIndices.begin(), OutIndices.end()), OutIndices.end());
 		}
 	}
 
+	void Scene::FilterLayers(LayerMask Layers, std::vector<uint32_t>& Indices) const
+	{
+		if ((m_UsedLayers & ~Layers) == 0)
+			return;
+
+		std::erase_if(Indices, [&](uint32_t Index) { return (m_ObjectLayers[Index] & Layers) == 0; });
+	}
+
+	void Scene::OnObjectMoved(uint32_t ObjectIndex)
+	{
+		std::lock_guard<std::mutex> Lock(m_MovedObjectsMutex);
+		m_MovedObjects.push_back(ObjectIndex);
+	}
+
+	void Scene::RecordChange(SceneObject* Object, SceneChange Type)
+	{
+		std::lock_guard<std::mutex> Lock(m_JournalMutex);
+		const uint8_t Mask = Object->GetChangeMask();
+		if (Mask == 0)
+		{
+			Object->SetChangeState(0, static_cast<uint32_t>(m_JournalObjects.size()));
+			m_JournalObjects.push_back(Object);
+		}
+		Object->SetChangeState(Mask | static_cast<uint8_t>(1u << static_cast<uint8_t>(Type)), Object->GetChangeSlot());
+	}
+
+	const SceneChangeList& Scene::GetChanges() const
+	{
+		return m_Changes;
+	}
+
+	void Scene::QueryFrustum(const Frustum& ViewFrustum, std::vector<uint32_t>& OutIndices) const
+	{
+		OutIndices.clear();
+		m_BoundingVolumes.QueryFrustum(ViewFrustum, OutIndices);
+
+		// The leaves are padded boxes around the spheres, keep the spheres that are really visible
+		std::erase_if(OutIndices, [&](uint32_t Index)
+		{
+			const BoundingSphere Sphere = { glm::vec3(m_BoundingSpheres.X[Index], m_BoundingSpheres.Y[Index], m_BoundingSpheres.Z[Index]), m_BoundingSpheres.Radius[Index] };
+			return !ViewFrustum.IsVisible(Sphere);
+		});
+		OutIndices.insert(OutIndices.end(), m_UnboundedObjects.begin(), m_UnboundedObjects.end());
+		std::sort(OutIndices.begin(), OutIndices.end());
+	}
+
+	void Scene::QueryFrustums(std::span<const Frustum> Frustums, std::vector<uint32_t>& OutIndices) const
+	{
+		OutIndices.clear();
+		m_BoundingVolumes.QueryFrustums(Frustums, OutIndices);
+		std::erase_if(OutIndices, [&](uint32_t Index)
+		{
+			const BoundingSphere Sphere = { glm::vec3(m_BoundingSpheres.X[Index], m_BoundingSpheres.Y[Index], m_BoundingSpheres.Z[Index]), m_BoundingSpheres.Radius[Index] };
+			return std::none_of(Frustums.begin(), Frustums.end(), [&Sphere](const Frustum& ViewFrustum) { return ViewFrustum.IsVisible(Sphere); });
+		});
+		OutIndices.insert(OutIndices.end(), m_UnboundedObjects.begin(), m_UnboundedObjects.end());
+		std::sort(OutIndices.begin(), OutIndices.end());
+	}
+
+	void Scene::QueryBox(const BoundingBox& Box, std::vector<uint32_t>& OutIndices) const
+	{
+		OutIndices.clear();
+		m_BoundingVolumes.QueryBox(Box, OutIndices);
+		std::erase_if(OutIndices, [&](uint32_t Index)
+		{
+			const glm::vec3 Center(m_BoundingSpheres.X[Index], m_BoundingSpheres.Y[Index], m_BoundingSpheres.Z[Index]);
+			const glm::vec3 Offset = glm::clamp(Center, Box.Min, Box.Max) - Center;
+			return glm::dot(Offset, Offset) > m_BoundingSpheres.Radius[Index] * m_BoundingSpheres.Radius[Index];
+		});
+		std::sort(OutIndices.begin(), OutIndices.end());
+	}
+
+	void Scene::QuerySphere(const BoundingSphere& Sphere, std::vector<uint32_t>& OutIndices) const
+	{
+		OutIndices.clear();
+		m_BoundingVolumes.QuerySphere(Sphere, OutIndices);
+		std::erase_if(OutIndices, [&](uint32_t Index)
+		{
+			const glm::vec3 Offset = glm::vec3(m_BoundingSpheres.X[Index], m_BoundingSpheres.Y[Index], m_BoundingSpheres.Z[Index]) - Sphere.Center;
+			const float Reach = m_BoundingSpheres.Radius[Index] + Sphere.Radius;
+			return glm::dot(Offset, Offset) > Reach * Reach;
+		});
+		std::sort(OutIndices.begin(), OutIndices.end());
+	}
+
+	void Scene::QueryRay(const glm::vec3& Origin, const glm::vec3& Direction, float MaxDistance, std::vector<RayHit>& OutHits) const
+	{
+		OutHits.clear();
+		const glm::vec3 RayDirection = glm::normalize(Direction);
+
+		std::vector<uint32_t> Candidates;
+		m_BoundingVolumes.QueryRay(Origin, RayDirection, MaxDistance, Candidates);
+		for (uint32_t Index : Candidates)
+		{
+			// Nearest point of the sphere along the ray, the origin itself when it starts inside
+			const glm::vec3 ToCenter = glm::vec3(m_BoundingSpheres.X[Index], m_BoundingSpheres.Y[Index], m_BoundingSpheres.Z[Index]) - Origin;
+			const float Radius = m_BoundingSpheres.Radius[Index];
+			const float Along = glm::dot(ToCenter, RayDirection);
+			const float SquaredGap = glm::dot(ToCenter, ToCenter) - Along * Along;
+			if (SquaredGap > Radius * Radius)
+				continue;
+
+			const float Distance = std::max(Along - std::sqrt(Radius * Radius - SquaredGap), 0.0f);
+			if (Along + Radius >= 0.0f && Distance <= MaxDistance)
+			{
+				OutHits.push_back({ Index, Distance });
+			}
+		}
+		std::sort(OutHits.begin(), OutHits.end(), [](const RayHit& A, const RayHit& B) { return A.Distance < B.Distance; });
+	}
+
+	const BoundingSphereArrays& Scene::GetBoundingSpheres() const
+	{
+		return m_BoundingSpheres;
+	}
+
+	OverlapSystem& Scene::GetOverlapSystem()
+	{
+		return m_Overlaps;
+	}
+
+	const OverlapSystem& Scene::GetOverlapSystem() const
+	{
+		return m_Overlaps;
+	}
+
+	TickScheduler& Scene::GetTickScheduler()
+	{
+		return m_TickScheduler;
+	}
+
+	const TickScheduler& Scene::GetTickScheduler() const
+	{
+		return m_TickScheduler;
+	}
+
 	void Scene::SetActiveCamera(std::shared_ptr<BaseCamera> ActiveCamera)
 	{
 		m_ActiveCamera = ActiveCamera;
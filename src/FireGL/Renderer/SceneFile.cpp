@@ -0,0 +1,223 @@
+#include <FireGL/Renderer/SceneFile.h>
+#include <FireGL/Renderer/Scene.h>
+#include <FireGL/Renderer/SceneObject.h>
+#include <FireGL/Renderer/Material.h>
+#include <FireGL/Core/Profiler.h>
+#include <FireGL/Core/BaseLog.h>
+
+#include <filesystem>
+#include <cstring>
+#include <unordered_set>
+
+namespace fgl
+{
+
+	static_assert(std::is_trivially_copyable_v<SceneFileObject>, "Scene file records are read in place from the mapping");
+
+	void SceneFile::RegisterType(std::string_view Name, ObjectFactory Factory)
+	{
+		m_Types[AssetId::HashKey(Name)] = std::move(Factory);
+	}
+
+	void SceneFile::RegisterMaterial(std::string_view Name, std::shared_ptr<Material> SharedMaterial)
+	{
+		m_Materials[AssetId::HashKey(Name)] = std::move(SharedMaterial);
+	}
+
+	void SceneFile::Record(std::string_view Type, std::string_view Asset, std::string_view MaterialName, const SceneObject& Object,
+		std::initializer_list<std::string_view> Components)
+	{
+		const Transform& ObjectTransform = Object.GetTransform();
+
+		SceneFileObject Recorded;
+		Recorded.Type = AssetId::HashKey(Type);
+		Recorded.Asset = Asset.empty() ? 0 : AssetId::HashKey(Asset);
+		Recorded.Material = MaterialName.empty() ? 0 : AssetId::HashKey(MaterialName);
+		Recorded.Position = ObjectTransform.GetPosition();
+		Recorded.Orientation = ObjectTransform.GetOrientation();
+		Recorded.Scale = ObjectTransform.GetScale();
+		Recorded.Flags = (Object.IsStatic() ? StaticObject : 0u) | (Object.HasOverlapEvents() ? OverlapEvents : 0u);
+		Recorded.FirstComponent = static_cast<uint32_t>(m_RecordComponents.size());
+		Recorded.ComponentCount = static_cast<uint32_t>(Components.size());
+		for (std::string_view Component : Components)
+		{
+			m_RecordComponents.push_back(AssetId::HashKey(Component));
+		}
+		m_Records.push_back(Recorded);
+	}
+
+	void SceneFile::ClearRecords()
+	{
+		m_Records.clear();
+		m_RecordComponents.clear();
+	}
+
+	bool SceneFile::Save(std::string_view Path) const
+	{
+		Header FileHeader;
+		FileHeader.Magic = Magic;
+		FileHeader.Version = Version;
+		FileHeader.ObjectCount = static_cast<uint32_t>(m_Records.size());
+		FileHeader.ComponentCount = static_cast<uint32_t>(m_RecordComponents.size());
+
+		std::error_code Error;
+		const std::filesystem::path Directory = std::filesystem::path(Path).parent_path();
+		if (!Directory.empty())
+		{
+			std::filesystem::create_directories(Directory, Error);
+		}
+
+		// Write to a temporary file first so a crash never leaves a truncated scene behind
+		const std::string TemporaryPath = std::string(Path) + ".tmp";
+		{
+			std::ofstream File(TemporaryPath, std::ios::binary | std::ios::trunc);
+			if (!File)
+				return false;
+
+			File.write(reinterpret_cast<const char*>(&FileHeader), sizeof(FileHeader));
+			File.write(reinterpret_cast<const char*>(m_Records.data()), m_Records.size() * sizeof(SceneFileObject));
+			File.write(reinterpret_cast<const char*>(m_RecordComponents.data()), m_RecordComponents.size() * sizeof(uint64_t));
+			if (!File)
+				return false;
+		}
+
+		std::filesystem::rename(TemporaryPath, std::filesystem::path(Path), Error);
+		if (Error)
+		{
+			std::filesystem::remove(TemporaryPath, Error);
+			return false;
+		}
+		return true;
+	}
+
+	bool SceneFile::Open(std::string_view Path)
+	{
+		Close();
+		if (!m_File.Open(Path))
+			return false;
+
+		// The header is 16 bytes and the records a multiple of 8, so both arrays stay aligned within the mapping
+		Header FileHeader;
+		if (m_File.GetSize() < sizeof(FileHeader))
+		{
+			Close();
+			return false;
+		}
+		std::memcpy(&FileHeader, m_File.GetData(), sizeof(FileHeader));
+
+		const size_t ObjectsSize = static_cast<size_t>(FileHeader.ObjectCount) * sizeof(SceneFileObject);
+		const size_t ComponentsSize = static_cast<size_t>(FileHeader.ComponentCount) * sizeof(uint64_t);
+		if (FileHeader.Magic != Magic || FileHeader.Version != Version || m_File.GetSize() < sizeof(FileHeader) + ObjectsSize + ComponentsSize)
+		{
+			Close();
+			return false;
+		}
+
+		const uint8_t* Objects = m_File.GetData() + sizeof(FileHeader);
+		m_Objects = std::span<const SceneFileObject>(reinterpret_cast<const SceneFileObject*>(Objects), FileHeader.ObjectCount);
+		m_ObjectComponents = std::span<const uint64_t>(reinterpret_cast<const uint64_t*>(Objects + ObjectsSize), FileHeader.ComponentCount);
+		return true;
+	}
+
+	void SceneFile::Close()
+	{
+		m_Objects = {};
+		m_ObjectComponents = {};
+		m_File.Close();
+	}
+
+	std::span<const SceneFileObject> SceneFile::GetObjects() const
+	{
+		return m_Objects;
+	}
+
+	void SceneFile::GetAssets(std::vector<AssetId>& OutAssets) const
+	{
+		OutAssets.clear();
+		std::unordered_set<uint64_t> Seen;
+		for (const SceneFileObject& Object : m_Objects)
+		{
+			if (Object.Asset != 0 && Seen.insert(Object.Asset).second)
+			{
+				AssetId Asset;
+				Asset.Hash = Object.Asset;
+				OutAssets.push_back(Asset);
+			}
+		}
+	}
+
+	size_t SceneFile::Instantiate(Scene& Target, std::vector<SceneObject*>* OutObjects, const SceneFile* Factories) const
+	{
+		FGL_PROFILE_SCOPE("SceneFile::Instantiate")
+		const SceneFile& Registry = Factories ? *Factories : *this;
+		Target.Reserve(Target.GetObjects().size() + m_Objects.size());
+
+		// Records of one type are usually stored together, the last factory found is tried first
+		uint64_t LastType = 0;
+		const ObjectFactory* Factory = nullptr;
+		size_t Added = 0;
+		size_t Skipped = 0;
+		for (const SceneFileObject& Record : m_Objects)
+		{
+			if (!Factory || Record.Type != LastType)
+			{
+				const auto Found = Registry.m_Types.find(Record.Type);
+				Factory = Found != Registry.m_Types.end() ? &Found->second : nullptr;
+				LastType = Record.Type;
+			}
+
+			AssetId Asset;
+			Asset.Hash = Record.Asset;
+			std::unique_ptr<SceneObject> Object = Factory ? (*Factory)(Asset) : nullptr;
+			if (!Object)
+			{
+				Skipped++;
+				continue;
+			}
+
+			if (Record.Material != 0)
+			{
+				const auto Found = Registry.m_Materials.find(Record.Material);
+				if (Found != Registry.m_Materials.end())
+				{
+					Object->SetMaterial(Found->second);
+				}
+			}
+
+			Transform& ObjectTransform = Object->GetTransform();
+			ObjectTransform.SetPosition(Record.Position);
+			ObjectTransform.SetOrientation(Record.Orientation);
+			ObjectTransform.SetScale(Record.Scale);
+			Object->SetStatic((Record.Flags & StaticObject) != 0);
+			Object->SetOverlapEvents((Record.Flags & OverlapEvents) != 0);
+
+			if (Record.ComponentCount != 0)
+			{
+				Entity* Owner = dynamic_cast<Entity*>(Object.get());
+				const size_t End = std::min<size_t>(static_cast<size_t>(Record.FirstComponent) + Record.ComponentCount, m_ObjectComponents.size());
+				for (size_t Index = Record.FirstComponent; Owner && Index < End; Index++)
+				{
+					const auto Found = Registry.m_Components.find(m_ObjectComponents[Index]);
+					if (Found != Registry.m_Components.end())
+					{
+						Found->second(*Owner);
+					}
+				}
+			}
+
+			if (OutObjects)
+			{
+				OutObjects->push_back(Object.get());
+			}
+			Target.AddObject(std::move(Object));
+			Added++;
+		}
+
+		if (Skipped != 0)
+		{
+			LOG_INFO("Skipped " + std::to_string(Skipped) + " scene file objects of unregistered types.")
+		}
+		return Added;
+	}
+
+} // namespace fgl
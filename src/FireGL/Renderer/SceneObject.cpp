@@ -1,4 +1,5 @@
 #include <FireGL/Renderer/SceneObject.h>
+#include <FireGL/Core/BaseLog.h>
 
 namespace fgl
 {
@@ -6,7 +7,36 @@ namespace fgl
 	SceneObject::SceneObject()
 		: m_Transform(this),
 		  m_OwningScene(nullptr),
-		  m_New(true)
+		  m_SceneIndex(0),
+		  m_PendingRemoval(false),
+		  m_Static(false),
+		  m_Merged(false),
+		  m_Layers(DefaultLayer),
+		  m_TickGroup(TickGroup::PostPhysics),
+		  m_TickEnabled(true),
+		  m_Sleeping(false),
+		  m_TickIntervalFrames(1),
+		  m_TickIntervalSeconds(0.0f),
+		  m_TickSlot(TickScheduler::InvalidSlot),
+		  m_TickSlotGroup(TickGroup::PostPhysics),
+		  m_ObjectPool(nullptr),
+		  m_New(true),
+		  m_InstanceSlot(SIZE_MAX),
+		  m_InstanceRevision(0),
+		  m_BatchIndex(InvalidBatch),
+		  m_HasLocalBounds(false),
+		  m_OverlapEvents(false),
+		  m_OverlapProxy(OverlapSystem::InvalidProxy),
+		  m_TextureLayers(0),
+		  m_BoneOffset(0),
+		  m_ReflectionProbe(0),
+		  m_PointLights(0),
+		  m_InstancePayload(0.0f),
+		  m_PackedAnimation(0u),
+		  m_BoundsRevision(0),
+		  m_ChangeMask(0),
+		  m_ChangeSlot(0),
+		  m_Impostor(nullptr)
 	{
 	}
 
@@ -20,6 +50,225 @@ namespace fgl
 		return m_OwningScene; 
 	}
 
+	void SceneObject::SetSceneIndex(uint32_t Index)
+	{
+		m_SceneIndex = Index;
+	}
+
+	uint32_t SceneObject::GetSceneIndex() const
+	{
+		return m_SceneIndex;
+	}
+
+	void SceneObject::SetPendingRemoval(bool bPending)
+	{
+		m_PendingRemoval = bPending;
+	}
+
+	bool SceneObject::IsPendingRemoval() const
+	{
+		return m_PendingRemoval;
+	}
+
+	void SceneObject::SetStatic(bool bStatic)
+	{
+		m_Static = bStatic;
+	}
+
+	bool SceneObject::IsStatic() const
+	{
+		return m_Static;
+	}
+
+	void SceneObject::RefreshTick()
+	{
+		// Objects outside of a scene register when added, see Scene::AddObject()
+		if (m_OwningScene)
+		{
+			m_OwningScene->GetTickScheduler().Refresh(this);
+		}
+	}
+
+	void SceneObject::SetTickEnabled(bool bEnabled)
+	{
+		if (bEnabled == m_TickEnabled)
+			return;
+
+		m_TickEnabled = bEnabled;
+		RefreshTick();
+	}
+
+	bool SceneObject::IsTickEnabled() const
+	{
+		return m_TickEnabled;
+	}
+
+	void SceneObject::SetTickGroup(TickGroup Group)
+	{
+		LOG_ASSERT(Group != TickGroup::Count, "TickGroup::Count isn't a tick group")
+		if (Group == m_TickGroup)
+			return;
+
+		m_TickGroup = Group;
+		RefreshTick();
+	}
+
+	TickGroup SceneObject::GetTickGroup() const
+	{
+		return m_TickGroup;
+	}
+
+	void SceneObject::SetTickInterval(uint32_t Frames, float Seconds)
+	{
+		Frames = std::max<uint32_t>(Frames, 1);
+		Seconds = std::max(Seconds, 0.0f);
+		if (Frames == m_TickIntervalFrames && Seconds == m_TickIntervalSeconds)
+			return;
+
+		m_TickIntervalFrames = Frames;
+		m_TickIntervalSeconds = Seconds;
+		RefreshTick();
+	}
+
+	uint32_t SceneObject::GetTickIntervalFrames() const
+	{
+		return m_TickIntervalFrames;
+	}
+
+	float SceneObject::GetTickIntervalSeconds() const
+	{
+		return m_TickIntervalSeconds;
+	}
+
+	void SceneObject::Sleep()
+	{
+		if (m_Sleeping)
+			return;
+
+		m_Sleeping = true;
+		RefreshTick();
+	}
+
+	void SceneObject::WakeUp()
+	{
+		if (!m_Sleeping)
+			return;
+
+		m_Sleeping = false;
+		RefreshTick();
+	}
+
+	bool SceneObject::IsSleeping() const
+	{
+		return m_Sleeping;
+	}
+
+	void SceneObject::SetTickSlot(TickGroup Group, uint32_t Slot)
+	{
+		m_TickSlotGroup = Group;
+		m_TickSlot = Slot;
+	}
+
+	uint32_t SceneObject::GetTickSlot() const
+	{
+		return m_TickSlot;
+	}
+
+	TickGroup SceneObject::GetTickSlotGroup() const
+	{
+		return m_TickSlotGroup;
+	}
+
+	void SceneObject::SetOverlapEvents(bool bEnabled)
+	{
+		if (bEnabled == m_OverlapEvents)
+			return;
+
+		// Objects outside of a scene register when added, see Scene::AddObject()
+		m_OverlapEvents = bEnabled;
+		if (m_OwningScene)
+		{
+			if (bEnabled)
+			{
+				m_OwningScene->GetOverlapSystem().Add(this);
+			}
+			else if (m_OverlapProxy != OverlapSystem::InvalidProxy)
+			{
+				m_OwningScene->GetOverlapSystem().Remove(this);
+			}
+		}
+	}
+
+	bool SceneObject::HasOverlapEvents() const
+	{
+		return m_OverlapEvents;
+	}
+
+	void SceneObject::SetOverlapProxy(uint32_t Proxy)
+	{
+		m_OverlapProxy = Proxy;
+	}
+
+	uint32_t SceneObject::GetOverlapProxy() const
+	{
+		return m_OverlapProxy;
+	}
+
+	void SceneObject::SetMerged(bool bMerged)
+	{
+		if (bMerged == m_Merged)
+			return;
+
+		// The GPU copy of the object is rewritten, drawn or not
+		m_Merged = bMerged;
+		if (m_OwningScene)
+		{
+			m_OwningScene->OnObjectMoved(m_SceneIndex);
+		}
+	}
+
+	bool SceneObject::IsMerged() const
+	{
+		return m_Merged;
+	}
+
+	void SceneObject::SetLayers(LayerMask Layers)
+	{
+		if (Layers == m_Layers)
+			return;
+
+		// Queued like a move, the Scene reads the layers back and the GPU copy of the object is rewritten
+		m_Layers = Layers;
+		if (m_OwningScene)
+		{
+			m_OwningScene->OnObjectMoved(m_SceneIndex);
+		}
+	}
+
+	LayerMask SceneObject::GetLayers() const
+	{
+		return m_Layers;
+	}
+
+	void SceneObject::SetObjectPool(ObjectPoolBase* Pool)
+	{
+		m_ObjectPool = Pool;
+	}
+
+	ObjectPoolBase* SceneObject::GetObjectPool() const
+	{
+		return m_ObjectPool;
+	}
+
+	void SceneObject::OnTransformChanged()
+	{
+		if (m_OwningScene)
+		{
+			m_OwningScene->OnObjectMoved(m_SceneIndex);
+			m_OwningScene->RecordChange(this, SceneChange::Transform);
+		}
+	}
+
 	Transform& SceneObject::GetTransform()
 	{
 		return m_Transform;
@@ -40,4 +289,277 @@ namespace fgl
 		m_New = IsNew;
 	}
 
+	size_t SceneObject::GetInstanceSlot() const
+	{
+		return m_InstanceSlot;
+	}
+
+	uint64_t SceneObject::GetInstanceRevision() const
+	{
+		return m_InstanceRevision;
+	}
+
+	const BoundingSphere& SceneObject::GetLocalBoundingSphere()
+	{
+		if (m_HasLocalBounds)
+			return m_LocalBoundingSphere;
+
+		const std::span<const BaseMesh> Meshes = std::as_const(*this).GetMeshes();
+		BoundingBox Box;
+		for (const BaseMesh& Mesh : Meshes)
+		{
+			Box.Merge(Mesh.GetBoundingBox());
+		}
+
+		m_LocalBoundingBox = Box;
+		m_LocalBoundingSphere.Center = Box.GetCenter();
+		for (const BaseMesh& Mesh : Meshes)
+		{
+			const BoundingSphere& MeshSphere = Mesh.GetBoundingSphere();
+			float Reach = glm::length(MeshSphere.Center - m_LocalBoundingSphere.Center) + MeshSphere.Radius;
+			m_LocalBoundingSphere.Radius = std::max(m_LocalBoundingSphere.Radius, Reach);
+		}
+
+		m_HasLocalBounds = true;
+		return m_LocalBoundingSphere;
+	}
+
+	const BoundingBox& SceneObject::GetLocalBoundingBox()
+	{
+		GetLocalBoundingSphere();
+		return m_LocalBoundingBox;
+	}
+
+	void SceneObject::CaptureRenderProxy()
+	{
+		m_RenderProxy.Meshes = GetMeshes();
+		m_RenderProxy.ObjectMaterial = GetMaterial();
+		m_RenderProxy.MeshID = GetHash();
+		m_RenderProxy.Flags = IsSkybox() ? RenderProxy::Skybox : 0u;
+
+		// Objects are captured again once uploaded (see Renderer::AssignBatch()), the draw info needs the arena location
+		m_RenderProxy.Draws.clear();
+		m_RenderProxy.LODCount = 1;
+		bool bUploaded = !m_RenderProxy.Meshes.empty();
+		for (const BaseMesh& Mesh : m_RenderProxy.Meshes)
+		{
+			m_RenderProxy.LODCount = std::max(m_RenderProxy.LODCount, Mesh.GetLODCount());
+			bUploaded &= Mesh.GetVertexArray() != 0;
+		}
+		if (!bUploaded)
+			return;
+
+		m_RenderProxy.Draws.reserve(m_RenderProxy.LODCount * m_RenderProxy.Meshes.size());
+		for (uint32_t LOD = 0; LOD < m_RenderProxy.LODCount; LOD++)
+		{
+			for (const BaseMesh& Mesh : m_RenderProxy.Meshes)
+			{
+				m_RenderProxy.Draws.push_back(Mesh.GetDrawInfo(LOD));
+			}
+		}
+	}
+
+	const RenderProxy& SceneObject::GetRenderProxy() const
+	{
+		return m_RenderProxy;
+	}
+
+	void SceneObject::SetTextureLayers(const glm::uvec4& Layers)
+	{
+		if (Layers == m_TextureLayers)
+			return;
+
+		// Forces the renderer to rewrite the instance data of the object
+		m_TextureLayers = Layers;
+		m_InstanceSlot = SIZE_MAX;
+		if (m_OwningScene)
+		{
+			m_OwningScene->OnObjectMoved(m_SceneIndex);
+		}
+	}
+
+	const glm::uvec4& SceneObject::GetTextureLayers() const
+	{
+		return m_TextureLayers;
+	}
+
+	void SceneObject::SetBoneOffset(uint32_t Offset)
+	{
+		if (Offset == m_BoneOffset)
+			return;
+
+		// Forces the renderer to rewrite the instance data of the object
+		m_BoneOffset = Offset;
+		m_InstanceSlot = SIZE_MAX;
+		if (m_OwningScene)
+		{
+			m_OwningScene->OnObjectMoved(m_SceneIndex);
+		}
+	}
+
+	uint32_t SceneObject::GetBoneOffset() const
+	{
+		return m_BoneOffset;
+	}
+
+	void SceneObject::SetReflectionProbe(uint32_t Probe)
+	{
+		if (Probe == m_ReflectionProbe)
+			return;
+
+		// Forces the renderer to rewrite the instance data of the object
+		m_ReflectionProbe = Probe;
+		m_InstanceSlot = SIZE_MAX;
+		if (m_OwningScene)
+		{
+			m_OwningScene->OnObjectMoved(m_SceneIndex);
+		}
+	}
+
+	uint32_t SceneObject::GetReflectionProbe() const
+	{
+		return m_ReflectionProbe;
+	}
+
+	void SceneObject::SetPointLights(uint32_t PackedLights)
+	{
+		if (PackedLights == m_PointLights)
+			return;
+
+		// Forces the renderer to rewrite the instance data of the object
+		m_PointLights = PackedLights;
+		m_InstanceSlot = SIZE_MAX;
+		if (m_OwningScene)
+		{
+			m_OwningScene->OnObjectMoved(m_SceneIndex);
+		}
+	}
+
+	uint32_t SceneObject::GetPointLights() const
+	{
+		return m_PointLights;
+	}
+
+	void SceneObject::SetInstancePayload(const glm::vec4& Payload)
+	{
+		if (Payload == m_InstancePayload)
+			return;
+
+		// Forces the renderer to rewrite the instance data of the object
+		m_InstancePayload = Payload;
+		m_InstanceSlot = SIZE_MAX;
+		if (m_OwningScene)
+		{
+			m_OwningScene->OnObjectMoved(m_SceneIndex);
+		}
+	}
+
+	const glm::vec4& SceneObject::GetInstancePayload() const
+	{
+		return m_InstancePayload;
+	}
+
+	void SceneObject::SetProceduralAnimation(const ProceduralAnimation& Animation)
+	{
+		if (Animation == m_ProceduralAnimation)
+			return;
+
+		// Forces the renderer to rewrite the instance data of the object, and the Scene to grow its bounds
+		m_ProceduralAnimation = Animation;
+		m_PackedAnimation = Animation.Pack();
+		m_BoundsRevision++;
+		m_InstanceSlot = SIZE_MAX;
+		if (m_OwningScene)
+		{
+			m_OwningScene->OnObjectMoved(m_SceneIndex);
+		}
+	}
+
+	const ProceduralAnimation& SceneObject::GetProceduralAnimation() const
+	{
+		return m_ProceduralAnimation;
+	}
+
+	const glm::uvec3& SceneObject::GetPackedAnimation() const
+	{
+		return m_PackedAnimation;
+	}
+
+	uint64_t SceneObject::GetBoundsRevision() const
+	{
+		return m_BoundsRevision;
+	}
+
+	void SceneObject::SetImpostor(ImpostorAtlas* Impostor)
+	{
+		m_Impostor = Impostor;
+	}
+
+	ImpostorAtlas* SceneObject::GetImpostor() const
+	{
+		return m_Impostor;
+	}
+
+	void SceneObject::SetInstanceSlot(size_t Slot, uint64_t TransformRevision)
+	{
+		m_InstanceSlot = Slot;
+		m_InstanceRevision = TransformRevision;
+	}
+
+	uint32_t SceneObject::GetBatchIndex() const
+	{
+		return m_BatchIndex;
+	}
+
+	void SceneObject::SetBatchIndex(uint32_t Index)
+	{
+		m_BatchIndex = Index;
+	}
+
+	void SceneObject::InvalidateBatch()
+	{
+		m_BatchIndex = InvalidBatch;
+		if (m_OwningScene)
+		{
+			m_OwningScene->OnObjectMoved(m_SceneIndex);
+		}
+	}
+
+	void SceneObject::NotifyMaterialChanged()
+	{
+		InvalidateBatch();
+		if (m_OwningScene)
+		{
+			m_OwningScene->RecordChange(this, SceneChange::Material);
+		}
+	}
+
+	void SceneObject::NotifyMeshChanged()
+	{
+		// The bounds are computed again from the new meshes, the Scene refits the object with them
+		m_HasLocalBounds = false;
+		m_BoundsRevision++;
+		InvalidateBatch();
+		if (m_OwningScene)
+		{
+			m_OwningScene->RecordChange(this, SceneChange::Mesh);
+		}
+	}
+
+	uint8_t SceneObject::GetChangeMask() const
+	{
+		return m_ChangeMask;
+	}
+
+	uint32_t SceneObject::GetChangeSlot() const
+	{
+		return m_ChangeSlot;
+	}
+
+	void SceneObject::SetChangeState(uint8_t Mask, uint32_t Slot)
+	{
+		m_ChangeMask = Mask;
+		m_ChangeSlot = Slot;
+	}
+
 } // namespace fgl
\ No newline at end of file
@@ -1,28 +1,89 @@
 #include <FireGL/Renderer/Shader.h>
 #include <FireGL/Core/BaseLog.h>
+#include <FireGL/Core/Profiler.h>
+#include <FireGL/Core/StartupTimeline.h>
+#include <FireGL/Core/AssetArchive.h>
+#include <FireGL/Renderer/CameraUniformBuffer.h>
+#include <FireGL/Renderer/LightUniformBuffer.h>
+#include <FireGL/Renderer/Material.h>
+#include <FireGL/Renderer/CascadedShadowMaps.h>
+#include <FireGL/Renderer/LocalShadowAtlas.h>
+#include <FireGL/Renderer/AmbientOcclusion.h>
+#include <FireGL/Renderer/Lightmap.h>
+#include <FireGL/Renderer/ReflectionProbes.h>
+#include <FireGL/Renderer/VolumetricFog.h>
+#include <FireGL/Renderer/RenderDevice.h>
+#include <FireGL/Renderer/ShaderCache.h>
+#include <FireGL/Renderer/GLExtensions.h>
+#include <FireGL/Core/GLDebug.h>
 
 namespace fgl {
 
-	Shader::Shader(std::string_view VertexPath, std::string_view FragmentPath)
+	namespace
 	{
+		constexpr uint32_t SPIRVMagic = 0x07230203; ///< First word of every SPIR-V module.
+	}
+
+	std::vector<std::pair<std::string, GLuint>> Shader::s_DefaultBlockBindings = {
+		{ CameraUniformBuffer::BlockName, CameraUniformBuffer::BindingPoint },
+		{ LightUniformBuffer::BlockName, LightUniformBuffer::BindingPoint },
+		{ Material::ParameterBlockName, Material::ParameterBindingPoint },
+		{ CascadedShadowMaps::BlockName, CascadedShadowMaps::BindingPoint },
+		{ LocalShadowAtlas::BlockName, LocalShadowAtlas::BindingPoint },
+		{ VolumetricFog::BlockName, VolumetricFog::BindingPoint }
+	};
+
+	std::vector<std::pair<std::string, GLint>> Shader::s_DefaultSamplerUnits = {
+		{ CascadedShadowMaps::SamplerName, static_cast<GLint>(CascadedShadowMaps::TextureUnit) },
+		{ LocalShadowAtlas::SamplerName, static_cast<GLint>(LocalShadowAtlas::TextureUnit) },
+		{ AmbientOcclusion::SamplerName, static_cast<GLint>(AmbientOcclusion::TextureUnit) },
+		{ Lightmap::SamplerName, static_cast<GLint>(Lightmap::TextureUnit) },
+		{ ReflectionProbes::SamplerName, static_cast<GLint>(ReflectionProbes::TextureUnit) },
+		{ VolumetricFog::SamplerName, static_cast<GLint>(VolumetricFog::TextureUnit) }
+	};
+
+	Shader::Shader(std::string_view VertexPath, std::string_view FragmentPath, bool bDeferLinkCheck)
+		: m_VertexPath(VertexPath), m_FragmentPath(FragmentPath)
+	{
+		const uint64_t Start = Profiler::Now();
 		std::string VertexCode = LoadShaderCode(VertexPath);
 		std::string FragmentCode = LoadShaderCode(FragmentPath);
 
+		const uint64_t Decoded = Profiler::Now();
 		CompileAndLinkShaders(VertexCode.c_str(), FragmentCode.c_str());
+		FGL_GL_LABEL(GL_PROGRAM, m_ID, m_VertexPath + " + " + m_FragmentPath)
+		if (!bDeferLinkCheck)
+		{
+			FinishLink();
+		}
+		if (StartupTimeline::IsRecording())
+		{
+			StartupTimeline::Record("Shader", m_VertexPath + " + " + m_FragmentPath, VertexCode.size() + FragmentCode.size(), Start, Decoded, Profiler::Now());
+		}
 	}
 
-	std::string Shader::LoadShaderCode(std::string_view ShaderPath) const
+	std::string Shader::LoadShaderCode(std::string_view ShaderPath)
 	{
+		uint64_t PackedSize = 0;
+		if (AssetArchive::GetSize(ShaderPath, PackedSize))
+		{
+			std::string ShaderCode(static_cast<size_t>(PackedSize), '\0');
+			if (AssetArchive::ReadInto(ShaderPath, std::span<uint8_t>(reinterpret_cast<uint8_t*>(ShaderCode.data()), ShaderCode.size())))
+				return ShaderCode;
+		}
+
 		std::ifstream ShaderFile;
 		ShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
 		try
 		{
-			ShaderFile.open(ShaderPath.data());
-			std::stringstream ShaderStream;
-			ShaderStream << ShaderFile.rdbuf();
+			// Read straight into the string, the source is hashed for the program cache anyway
+			ShaderFile.open(std::string(ShaderPath), std::ios::binary | std::ios::ate);
+			std::string ShaderCode(static_cast<size_t>(ShaderFile.tellg()), '\0');
+			ShaderFile.seekg(0);
+			ShaderFile.read(ShaderCode.data(), ShaderCode.size());
 			ShaderFile.close();
 
-			return ShaderStream.str();
+			return ShaderCode;
 		}
 		catch (const std::ifstream::failure& f)
 		{
@@ -32,33 +93,260 @@ namespace fgl {
 		}
 	}
 
-	void Shader::CompileAndLinkShaders(const char* VertexCode, const char* FragmentCode)
+	void Shader::CompileAndLinkShaders(const char* VertexCode, const char* FragmentCode, const char* GeometryCode,
+		const char* TessControlCode, const char* TessEvaluationCode)
 	{
-		unsigned int Vertex = CompileShader(VertexCode, GL_VERTEX_SHADER);
-		unsigned int Fragment = CompileShader(FragmentCode, GL_FRAGMENT_SHADER);
+		FGL_PROFILE_SCOPE("Shader::CompileAndLinkShaders")
+		m_ID = RenderDevice::Get().CreateProgram().ID;
 
-		m_ID = glCreateProgram();
-		glAttachShader(m_ID, Vertex);
-		glAttachShader(m_ID, Fragment);
-		glLinkProgram(m_ID);
-		CheckCompileErrors(m_ID, "Program");
+		// Block and sampler bindings aren't part of a program binary, cached programs get them assigned too
+		const bool bTessellation = TessControlCode && TessEvaluationCode;
+		const uint64_t CacheKey = bTessellation ? ShaderCache::GetKey({ VertexCode, TessControlCode, TessEvaluationCode, FragmentCode })
+			: GeometryCode ? ShaderCache::GetKey({ VertexCode, GeometryCode, FragmentCode })
+			: ShaderCache::GetKey({ VertexCode, FragmentCode });
+		if (ShaderCache::Load(CacheKey, m_ID))
+		{
+			ApplyDefaultBlockBindings();
+			ApplyDefaultSamplerUnits();
+			return;
+		}
+
+		// Any status query would wait for the driver, every check is left to FinishLink()
+		RenderDevice& Device = RenderDevice::Get();
+		m_PendingShaders[0] = Device.CompileShaderStage(ShaderStage::Vertex, VertexCode);
+		m_PendingShaders[1] = Device.CompileShaderStage(ShaderStage::Fragment, FragmentCode);
+		m_CacheKey = CacheKey;
+		m_bLinkPending = true;
 
-		glDeleteShader(Vertex);
-		glDeleteShader(Fragment);
+		if (GeometryCode)
+		{
+			m_PendingShaders[2] = Device.CompileShaderStage(ShaderStage::Geometry, GeometryCode);
+		}
+		if (bTessellation)
+		{
+			m_PendingShaders[3] = Device.CompileShaderStage(ShaderStage::TessControl, TessControlCode);
+			m_PendingShaders[4] = Device.CompileShaderStage(ShaderStage::TessEvaluation, TessEvaluationCode);
+		}
+		Device.LinkProgram({ m_ID }, m_PendingShaders);
 	}
 
-	uint32_t Shader::CompileShader(const char* ShaderCode, GLenum ShaderType)
+	void Shader::CompileAndLinkCompute(const char* ComputeCode)
 	{
+		FGL_PROFILE_SCOPE("Shader::CompileAndLinkCompute")
+		m_ID = RenderDevice::Get().CreateProgram().ID;
+		m_bCompute = true;
+
+		const uint64_t CacheKey = ShaderCache::GetKey({ ComputeCode });
+		if (ShaderCache::Load(CacheKey, m_ID))
+			return;
+
+		RenderDevice& Device = RenderDevice::Get();
+		m_PendingShaders[0] = Device.CompileShaderStage(ShaderStage::Compute, ComputeCode);
+		m_CacheKey = CacheKey;
+		m_bLinkPending = true;
+
+		Device.LinkProgram({ m_ID }, m_PendingShaders);
+	}
+
+	void Shader::CompileAndLinkTransformFeedback(const char* VertexCode, const char* GeometryCode, const std::vector<std::string>& Varyings)
+	{
+		FGL_PROFILE_SCOPE("Shader::CompileAndLinkTransformFeedback")
+		m_ID = RenderDevice::Get().CreateProgram().ID;
+
+		// The captured outputs are part of the linked program, they are hashed with the sources
+		std::string VaryingList;
+		std::vector<const char*> VaryingNames;
+		for (const std::string& Varying : Varyings)
+		{
+			VaryingList += Varying + ';';
+			VaryingNames.push_back(Varying.c_str());
+		}
+		const uint64_t CacheKey = GeometryCode ? ShaderCache::GetKey({ VertexCode, GeometryCode, VaryingList })
+			: ShaderCache::GetKey({ VertexCode, VaryingList });
+		if (ShaderCache::Load(CacheKey, m_ID))
+		{
+			ApplyDefaultBlockBindings();
+			ApplyDefaultSamplerUnits();
+			return;
+		}
+
+		RenderDevice& Device = RenderDevice::Get();
+		m_PendingShaders[0] = Device.CompileShaderStage(ShaderStage::Vertex, VertexCode);
+		m_CacheKey = CacheKey;
+		m_bLinkPending = true;
+
+		if (GeometryCode)
+		{
+			m_PendingShaders[2] = Device.CompileShaderStage(ShaderStage::Geometry, GeometryCode);
+		}
+		Device.LinkProgram({ m_ID }, m_PendingShaders, VaryingNames);
+	}
+
+	void Shader::SpecializeAndLink(const std::string& VertexModule, const std::string& FragmentModule,
+		const std::vector<std::pair<GLuint, GLuint>>& Constants, const std::string& EntryPoint)
+	{
+		FGL_PROFILE_SCOPE("Shader::SpecializeAndLink")
+		m_ID = RenderDevice::Get().CreateProgram().ID;
+
+		// The specialization changes the program, it is hashed with the modules
+		std::string Specialization = EntryPoint + ';';
+		std::vector<GLuint> ConstantIndices;
+		std::vector<GLuint> ConstantValues;
+		for (const auto& [Index, Value] : Constants)
+		{
+			Specialization += std::to_string(Index) + '=' + std::to_string(Value) + ';';
+			ConstantIndices.push_back(Index);
+			ConstantValues.push_back(Value);
+		}
+		const uint64_t CacheKey = ShaderCache::GetKey({ VertexModule, FragmentModule, Specialization });
+		if (ShaderCache::Load(CacheKey, m_ID))
+		{
+			ApplyDefaultBlockBindings();
+			ApplyDefaultSamplerUnits();
+			return;
+		}
+
+		m_PendingShaders[0] = SpecializeShader(VertexModule, GL_VERTEX_SHADER, ConstantIndices, ConstantValues, EntryPoint);
+		m_PendingShaders[1] = SpecializeShader(FragmentModule, GL_FRAGMENT_SHADER, ConstantIndices, ConstantValues, EntryPoint);
+		m_CacheKey = CacheKey;
+		m_bLinkPending = true;
+
+		// SPIR-V modules are created by OpenGL, the device links them like compiled stages
+		RenderDevice::Get().LinkProgram({ m_ID }, m_PendingShaders);
+	}
+
+	uint32_t Shader::SpecializeShader(const std::string& Module, GLenum ShaderType, const std::vector<GLuint>& ConstantIndices,
+		const std::vector<GLuint>& ConstantValues, const std::string& EntryPoint)
+	{
+		// Specializing compiles the module, its status is read like a GLSL compile status
 		uint32_t Shader = glCreateShader(ShaderType);
-		glShaderSource(Shader, 1, &ShaderCode, nullptr);
-		glCompileShader(Shader);
-		CheckCompileErrors(Shader, (ShaderType == GL_VERTEX_SHADER ? "Vertex" : "Fragment"));
+		glShaderBinary(1, &Shader, GL_SHADER_BINARY_FORMAT_SPIR_V, Module.data(), static_cast<GLsizei>(Module.size()));
+		GLExtensions::SpecializeShader(Shader, EntryPoint.c_str(), static_cast<GLuint>(ConstantIndices.size()), ConstantIndices.data(), ConstantValues.data());
 		return Shader;
 	}
 
+	void Shader::FinishLink() const
+	{
+		if (!m_bLinkPending)
+			return;
+
+		FGL_PROFILE_SCOPE("Shader::FinishLink")
+
+		m_bLinkPending = false;
+		CheckCompileErrors(m_PendingShaders[0], m_bCompute ? "Compute" : "Vertex");
+		if (m_PendingShaders[1] != 0)
+		{
+			CheckCompileErrors(m_PendingShaders[1], "Fragment");
+		}
+		if (m_PendingShaders[2] != 0)
+		{
+			CheckCompileErrors(m_PendingShaders[2], "Geometry");
+		}
+		if (m_PendingShaders[3] != 0)
+		{
+			CheckCompileErrors(m_PendingShaders[3], "TessControl");
+			CheckCompileErrors(m_PendingShaders[4], "TessEvaluation");
+		}
+		CheckCompileErrors(m_ID, "Program");
+
+		GLint bLinked = GL_FALSE;
+		glGetProgramiv(m_ID, GL_LINK_STATUS, &bLinked);
+		if (bLinked == GL_TRUE)
+		{
+			ShaderCache::Save(m_CacheKey, m_ID);
+		}
+
+		RenderDevice& Device = RenderDevice::Get();
+		for (uint32_t& PendingShader : m_PendingShaders)
+		{
+			Device.ReleaseShaderStage({ m_ID }, PendingShader);
+		}
+
+		ApplyDefaultBlockBindings();
+		ApplyDefaultSamplerUnits();
+	}
+
+	bool Shader::IsReady() const
+	{
+		if (!m_bLinkPending || !GLExtensions::HasParallelShaderCompile())
+			return true;
+
+		GLint bCompleted = GL_FALSE;
+		glGetProgramiv(m_ID, GLExtensions::CompletionStatus, &bCompleted);
+		return bCompleted == GL_TRUE;
+	}
+
+	void Shader::WaitUntilReady() const
+	{
+		FinishLink();
+	}
+
+	bool Shader::AreReady(const std::vector<const Shader*>& Shaders)
+	{
+		return std::all_of(Shaders.begin(), Shaders.end(), [](const Shader* Program) { return Program->IsReady(); });
+	}
+
 	void Shader::Activate() const
 	{
-		glUseProgram(m_ID);
+		FinishLink();
+		RenderDevice::Get().BindProgram({ m_ID });
+	}
+
+	void Shader::BindUniformBlock(std::string_view BlockName, GLuint BindingPoint) const
+	{
+		FinishLink();
+		GLuint BlockIndex = glGetUniformBlockIndex(m_ID, std::string(BlockName).c_str());
+		if (BlockIndex != GL_INVALID_INDEX)
+		{
+			glUniformBlockBinding(m_ID, BlockIndex, BindingPoint);
+		}
+	}
+
+	void Shader::SetDefaultBlockBinding(std::string_view BlockName, GLuint BindingPoint)
+	{
+		for (auto& [Name, Point] : s_DefaultBlockBindings)
+		{
+			if (Name == BlockName)
+			{
+				Point = BindingPoint;
+				return;
+			}
+		}
+		s_DefaultBlockBindings.emplace_back(BlockName, BindingPoint);
+	}
+
+	void Shader::ApplyDefaultBlockBindings() const
+	{
+		for (const auto& [Name, Point] : s_DefaultBlockBindings)
+		{
+			BindUniformBlock(Name, Point);
+		}
+	}
+
+	void Shader::SetDefaultSamplerUnit(std::string_view SamplerName, GLint Unit)
+	{
+		for (auto& [Name, SamplerUnit] : s_DefaultSamplerUnits)
+		{
+			if (Name == SamplerName)
+			{
+				SamplerUnit = Unit;
+				return;
+			}
+		}
+		s_DefaultSamplerUnits.emplace_back(SamplerName, Unit);
+	}
+
+	void Shader::ApplyDefaultSamplerUnits() const
+	{
+		// Compute programs have no default samplers, and most programs none of the registered ones
+		for (const auto& [Name, Unit] : s_DefaultSamplerUnits)
+		{
+			const GLint Location = glGetUniformLocation(m_ID, Name.c_str());
+			if (Location >= 0)
+			{
+				glProgramUniform1i(m_ID, Location, Unit);
+			}
+		}
 	}
 
 	uint32_t Shader::GetID() const
@@ -66,134 +354,347 @@ namespace fgl {
 		return m_ID;
 	}
 
-	void Shader::SetBool(std::string_view Name, bool Value) const
+	const std::string& Shader::GetVertexPath() const
+	{
+		return m_VertexPath;
+	}
+
+	const std::string& Shader::GetFragmentPath() const
+	{
+		return m_FragmentPath;
+	}
+
+	std::unique_ptr<Shader> Shader::CreateFromSource(std::string_view VertexCode, std::string_view FragmentCode, bool bDeferLinkCheck)
 	{
-		GLint UniformLocation = GetUniformLocation(Name);
-		if (UniformLocation != -1)
+		std::unique_ptr<Shader> Result(new Shader());
+		const std::string Vertex(VertexCode);
+		const std::string Fragment(FragmentCode);
+		Result->CompileAndLinkShaders(Vertex.c_str(), Fragment.c_str());
+		if (!bDeferLinkCheck)
 		{
-			glUniform1i(UniformLocation, static_cast<int>(Value));
+			Result->FinishLink();
 		}
+		return Result;
 	}
 
-	void Shader::SetInt(std::string_view Name, int Value) const
+	std::unique_ptr<Shader> Shader::CreateWithGeometryFromSource(std::string_view VertexCode, std::string_view GeometryCode,
+		std::string_view FragmentCode, bool bDeferLinkCheck)
 	{
-		GLint UniformLocation = GetUniformLocation(Name);
-		if (UniformLocation != -1)
+		std::unique_ptr<Shader> Result(new Shader());
+		const std::string Vertex(VertexCode);
+		const std::string Geometry(GeometryCode);
+		const std::string Fragment(FragmentCode);
+		Result->CompileAndLinkShaders(Vertex.c_str(), Fragment.c_str(), Geometry.c_str());
+		if (!bDeferLinkCheck)
 		{
-			glUniform1i(UniformLocation, Value);
+			Result->FinishLink();
 		}
+		return Result;
 	}
 
-	void Shader::SetUInt(std::string_view Name, unsigned int Value) const
+	std::unique_ptr<Shader> Shader::CreateWithTessellationFromSource(std::string_view VertexCode, std::string_view TessControlCode,
+		std::string_view TessEvaluationCode, std::string_view FragmentCode, bool bDeferLinkCheck)
 	{
-		GLint UniformLocation = GetUniformLocation(Name);
-		if (UniformLocation != -1)
+		std::unique_ptr<Shader> Result(new Shader());
+		const std::string Vertex(VertexCode);
+		const std::string TessControl(TessControlCode);
+		const std::string TessEvaluation(TessEvaluationCode);
+		const std::string Fragment(FragmentCode);
+		Result->CompileAndLinkShaders(Vertex.c_str(), Fragment.c_str(), nullptr, TessControl.c_str(), TessEvaluation.c_str());
+		if (!bDeferLinkCheck)
 		{
-			glUniform1ui(UniformLocation, Value);
+			Result->FinishLink();
 		}
+		return Result;
 	}
 
-	void Shader::SetFloat(std::string_view Name, float Value) const
+	std::unique_ptr<Shader> Shader::CreateComputeFromSource(std::string_view ComputeCode, bool bDeferLinkCheck)
 	{
-		GLint UniformLocation = GetUniformLocation(Name);
-		if (UniformLocation != -1)
+		std::unique_ptr<Shader> Result(new Shader());
+		const std::string Compute(ComputeCode);
+		Result->CompileAndLinkCompute(Compute.c_str());
+		if (!bDeferLinkCheck)
 		{
-			glUniform1f(UniformLocation, Value);
+			Result->FinishLink();
 		}
+		return Result;
 	}
 
-	void Shader::SetDouble(std::string_view Name, double Value) const
+	std::unique_ptr<Shader> Shader::CreateTransformFeedbackFromSource(std::string_view VertexCode, std::string_view GeometryCode,
+		const std::vector<std::string>& Varyings, bool bDeferLinkCheck)
 	{
-		GLint UniformLocation = GetUniformLocation(Name);
-		if (UniformLocation != -1)
+		std::unique_ptr<Shader> Result(new Shader());
+		const std::string Vertex(VertexCode);
+		const std::string Geometry(GeometryCode);
+		Result->CompileAndLinkTransformFeedback(Vertex.c_str(), Geometry.empty() ? nullptr : Geometry.c_str(), Varyings);
+		if (!bDeferLinkCheck)
 		{
-			glUniform1d(UniformLocation, Value);
+			Result->FinishLink();
 		}
+		return Result;
 	}
 
-	void Shader::SetVec2(std::string_view Name, const glm::vec2& Value) const
+	std::unique_ptr<Shader> Shader::CreateFromSPIRV(std::string_view VertexPath, std::string_view FragmentPath,
+		const std::vector<std::pair<GLuint, GLuint>>& Constants, std::string_view EntryPoint, bool bDeferLinkCheck)
 	{
-		GLint UniformLocation = GetUniformLocation(Name);
-		if (UniformLocation != -1)
+		if (!SupportsSPIRV())
+			return nullptr;
+
+		// Modules are read like sources, LoadShaderCode() keeps the bytes as they are
+		const uint64_t Start = Profiler::Now();
+		const std::string VertexModule = LoadShaderCode(VertexPath);
+		const std::string FragmentModule = LoadShaderCode(FragmentPath);
+		for (const auto& [Path, Module] : { std::pair{ VertexPath, &VertexModule }, std::pair{ FragmentPath, &FragmentModule } })
 		{
-			glUniform2fv(UniformLocation, 1, glm::value_ptr(Value));
+			uint32_t FirstWord = 0;
+			if (Module->size() >= sizeof(FirstWord))
+			{
+				std::memcpy(&FirstWord, Module->data(), sizeof(FirstWord));
+			}
+			if (FirstWord != SPIRVMagic || Module->size() % sizeof(uint32_t) != 0)
+			{
+				const std::string ErrorMessage = "Error: \'" + std::string(Path) + "\' isn't a SPIR-V module";
+				std::cout << ErrorMessage << std::endl;
+				throw std::runtime_error(ErrorMessage);
+			}
+		}
+
+		const uint64_t Decoded = Profiler::Now();
+		std::unique_ptr<Shader> Result(new Shader());
+		Result->SpecializeAndLink(VertexModule, FragmentModule, Constants, std::string(EntryPoint));
+		FGL_GL_LABEL(GL_PROGRAM, Result->m_ID, std::string(VertexPath) + " + " + std::string(FragmentPath))
+		if (!bDeferLinkCheck)
+		{
+			Result->FinishLink();
+		}
+		if (StartupTimeline::IsRecording())
+		{
+			StartupTimeline::Record("Shader", std::string(VertexPath) + " + " + std::string(FragmentPath), VertexModule.size() + FragmentModule.size(),
+				Start, Decoded, Profiler::Now());
 		}
+		return Result;
 	}
 
-	void Shader::SetVec2(std::string_view Name, float X, float Y) const
+	bool Shader::SupportsSPIRV()
 	{
-		SetVec2(Name, glm::vec2(X, Y));
+		return GLExtensions::HasSPIRV();
 	}
 
-	void Shader::SetVec3(std::string_view Name, const glm::vec3& Value) const
+	bool Shader::IsLinked() const
+	{
+		if (m_ID == 0)
+			return false;
+
+		FinishLink();
+		GLint bLinked = GL_FALSE;
+		glGetProgramiv(m_ID, GL_LINK_STATUS, &bLinked);
+		return bLinked == GL_TRUE;
+	}
+
+	void Shader::ReplaceProgram(Shader& Source)
 	{
-		GLint UniformLocation = GetUniformLocation(Name);
-		if (UniformLocation != -1)
+		Source.FinishLink();
+		Cleanup();
+
+		m_ID = Source.m_ID;
+		Source.m_ID = 0;
+		m_UniformLocationCache.clear();
+	}
+
+	Shader::~Shader()
+	{
+		Cleanup();
+	}
+
+	void Shader::Cleanup()
+	{
+		FinishLink();
+		if (m_ID == 0)
+			return;
+
+		ProgramHandle Program{ m_ID };
+		RenderDevice::Get().DestroyProgram(Program);
+		m_ID = 0;
+	}
+
+	UniformHandle Shader::GetUniform(std::string_view Name) const
+	{
+		return UniformHandle{ GetUniformLocation(Name) };
+	}
+
+	void Shader::SetBool(UniformHandle Uniform, bool Value) const
+	{
+		if (Uniform.Location != -1)
 		{
-			glUniform3fv(UniformLocation, 1, glm::value_ptr(Value));
+			glUniform1i(Uniform.Location, static_cast<int>(Value));
 		}
 	}
 
-	void Shader::SetVec3(std::string_view Name, float X, float Y, float Z) const
+	void Shader::SetInt(UniformHandle Uniform, int Value) const
 	{
-		SetVec3(Name, glm::vec3(X, Y, Z));
+		if (Uniform.Location != -1)
+		{
+			glUniform1i(Uniform.Location, Value);
+		}
 	}
 
-	void Shader::SetVec4(std::string_view Name, const glm::vec4& Value) const
+	void Shader::SetUInt(UniformHandle Uniform, unsigned int Value) const
 	{
-		GLint UniformLocation = GetUniformLocation(Name);
-		if (UniformLocation != -1)
+		if (Uniform.Location != -1)
 		{
-			glUniform4fv(UniformLocation, 1, glm::value_ptr(Value));
+			glUniform1ui(Uniform.Location, Value);
 		}
 	}
 
-	void Shader::SetVec4(std::string_view Name, float X, float Y, float Z, float W) const
+	void Shader::SetFloat(UniformHandle Uniform, float Value) const
 	{
-		SetVec4(Name, glm::vec4(X, Y, Z, W));
+		if (Uniform.Location != -1)
+		{
+			glUniform1f(Uniform.Location, Value);
+		}
 	}
 
-	void Shader::SetMat2(std::string_view Name, const glm::mat2& Value) const
+	void Shader::SetDouble(UniformHandle Uniform, double Value) const
 	{
-		GLint UniformLocation = GetUniformLocation(Name);
-		if (UniformLocation != -1)
+		if (Uniform.Location != -1)
 		{
-			glUniformMatrix2fv(UniformLocation, 1, GL_FALSE, glm::value_ptr(Value));
+			glUniform1d(Uniform.Location, Value);
 		}
 	}
 
-	void Shader::SetMat3(std::string_view Name, const glm::mat3& Value) const
+	void Shader::SetVec2(UniformHandle Uniform, const glm::vec2& Value) const
 	{
-		GLint UniformLocation = GetUniformLocation(Name);
-		if (UniformLocation != -1)
+		if (Uniform.Location != -1)
 		{
-			glUniformMatrix3fv(UniformLocation, 1, GL_FALSE, glm::value_ptr(Value));
+			glUniform2fv(Uniform.Location, 1, glm::value_ptr(Value));
 		}
 	}
 
-	void Shader::SetMat4(std::string_view Name, const glm::mat4& Value) const
+	void Shader::SetVec3(UniformHandle Uniform, const glm::vec3& Value) const
 	{
-		GLint UniformLocation = GetUniformLocation(Name);
-		if (UniformLocation != -1)
+		if (Uniform.Location != -1)
 		{
-			glUniformMatrix4fv(UniformLocation, 1, GL_FALSE, glm::value_ptr(Value));
+			glUniform3fv(Uniform.Location, 1, glm::value_ptr(Value));
 		}
 	}
 
-	GLint Shader::GetUniformLocation(std::string_view Name) const
+	void Shader::SetVec4(UniformHandle Uniform, const glm::vec4& Value) const
 	{
-		if (m_UniformLocationCache.find(Name.data()) != m_UniformLocationCache.end())
+		if (Uniform.Location != -1)
 		{
-			return m_UniformLocationCache[Name.data()];
+			glUniform4fv(Uniform.Location, 1, glm::value_ptr(Value));
 		}
-		else
+	}
+
+	void Shader::SetMat2(UniformHandle Uniform, const glm::mat2& Value) const
+	{
+		if (Uniform.Location != -1)
 		{
-			GLint UniformLocation = glGetUniformLocation(m_ID, Name.data());
-			m_UniformLocationCache[Name.data()] = UniformLocation;
-			return UniformLocation;
+			glUniformMatrix2fv(Uniform.Location, 1, GL_FALSE, glm::value_ptr(Value));
 		}
 	}
 
+	void Shader::SetMat3(UniformHandle Uniform, const glm::mat3& Value) const
+	{
+		if (Uniform.Location != -1)
+		{
+			glUniformMatrix3fv(Uniform.Location, 1, GL_FALSE, glm::value_ptr(Value));
+		}
+	}
+
+	void Shader::SetMat4(UniformHandle Uniform, const glm::mat4& Value) const
+	{
+		if (Uniform.Location != -1)
+		{
+			glUniformMatrix4fv(Uniform.Location, 1, GL_FALSE, glm::value_ptr(Value));
+		}
+	}
+
+	void Shader::SetBool(std::string_view Name, bool Value) const
+	{
+		SetBool(GetUniform(Name), Value);
+	}
+
+	void Shader::SetInt(std::string_view Name, int Value) const
+	{
+		SetInt(GetUniform(Name), Value);
+	}
+
+	void Shader::SetUInt(std::string_view Name, unsigned int Value) const
+	{
+		SetUInt(GetUniform(Name), Value);
+	}
+
+	void Shader::SetFloat(std::string_view Name, float Value) const
+	{
+		SetFloat(GetUniform(Name), Value);
+	}
+
+	void Shader::SetDouble(std::string_view Name, double Value) const
+	{
+		SetDouble(GetUniform(Name), Value);
+	}
+
+	void Shader::SetVec2(std::string_view Name, const glm::vec2& Value) const
+	{
+		SetVec2(GetUniform(Name), Value);
+	}
+
+	void Shader::SetVec2(std::string_view Name, float X, float Y) const
+	{
+		SetVec2(Name, glm::vec2(X, Y));
+	}
+
+	void Shader::SetVec3(std::string_view Name, const glm::vec3& Value) const
+	{
+		SetVec3(GetUniform(Name), Value);
+	}
+
+	void Shader::SetVec3(std::string_view Name, float X, float Y, float Z) const
+	{
+		SetVec3(Name, glm::vec3(X, Y, Z));
+	}
+
+	void Shader::SetVec4(std::string_view Name, const glm::vec4& Value) const
+	{
+		SetVec4(GetUniform(Name), Value);
+	}
+
+	void Shader::SetVec4(std::string_view Name, float X, float Y, float Z, float W) const
+	{
+		SetVec4(Name, glm::vec4(X, Y, Z, W));
+	}
+
+	void Shader::SetMat2(std::string_view Name, const glm::mat2& Value) const
+	{
+		SetMat2(GetUniform(Name), Value);
+	}
+
+	void Shader::SetMat3(std::string_view Name, const glm::mat3& Value) const
+	{
+		SetMat3(GetUniform(Name), Value);
+	}
+
+	void Shader::SetMat4(std::string_view Name, const glm::mat4& Value) const
+	{
+		SetMat4(GetUniform(Name), Value);
+	}
+
+	GLint Shader::GetUniformLocation(std::string_view Name) const
+	{
+		FinishLink();
+
+		// Heterogeneous lookup, a std::string is only built the first time a name is seen
+		auto It = m_UniformLocationCache.find(Name);
+		if (It != m_UniformLocationCache.end())
+			return It->second;
+
+		std::string NameString(Name);
+		GLint UniformLocation = glGetUniformLocation(m_ID, NameString.c_str());
+		m_UniformLocationCache.emplace(std::move(NameString), UniformLocation);
+		return UniformLocation;
+	}
+
 	void Shader::CheckCompileErrors(uint32_t Shader, std::string_view Type)
 	{
 		int Success;
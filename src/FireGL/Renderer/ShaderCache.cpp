@@ -0,0 +1,143 @@
+#include <FireGL/Renderer/ShaderCache.h>
+#include <FireGL/Core/MappedFile.h>
+
+#include <filesystem>
+#include <cstring>
+
+namespace fgl
+{
+
+	std::string ShaderCache::s_Directory = "ShaderCache";
+	bool ShaderCache::s_bEnabled = true;
+
+	namespace
+	{
+		/** @return The string of a glGetString query, empty if the context doesn't report it. */
+		std::string_view GetDriverString(GLenum Name)
+		{
+			const GLubyte* String = glGetString(Name);
+			return String ? std::string_view(reinterpret_cast<const char*>(String)) : std::string_view();
+		}
+	}
+
+	uint64_t ShaderCache::GetKey(const std::vector<std::string_view>& Sources)
+	{
+		// The separators keep "ab" + "c" and "a" + "bc" from producing the same key
+		std::string KeySource;
+		for (GLenum Name : { GL_VENDOR, GL_RENDERER, GL_VERSION })
+		{
+			KeySource += GetDriverString(Name);
+			KeySource += '\0';
+		}
+		for (std::string_view Source : Sources)
+		{
+			KeySource += std::to_string(Source.size());
+			KeySource += '\0';
+			KeySource += Source;
+		}
+		return static_cast<uint64_t>(std::hash<std::string>()(KeySource));
+	}
+
+	bool ShaderCache::Load(uint64_t Key, GLuint Program)
+	{
+		if (!IsEnabled())
+			return false;
+
+		MappedFile File;
+		if (!File.Open(GetCachePath(Key)))
+			return false;
+
+		Header FileHeader;
+		if (File.GetSize() < sizeof(FileHeader))
+			return false;
+
+		std::memcpy(&FileHeader, File.GetData(), sizeof(FileHeader));
+		if (FileHeader.Magic != Magic || FileHeader.Version != Version || FileHeader.Key != Key
+			|| FileHeader.BinarySize > File.GetSize() - sizeof(FileHeader))
+		{
+			return false;
+		}
+
+		glProgramBinary(Program, FileHeader.BinaryFormat, File.GetData() + sizeof(FileHeader), static_cast<GLsizei>(FileHeader.BinarySize));
+
+		// Drivers reject binaries from another build without any error, only the link status tells
+		GLint bLinked = GL_FALSE;
+		glGetProgramiv(Program, GL_LINK_STATUS, &bLinked);
+		return bLinked == GL_TRUE;
+	}
+
+	bool ShaderCache::Save(uint64_t Key, GLuint Program)
+	{
+		if (!IsEnabled())
+			return false;
+
+		GLint BinarySize = 0;
+		glGetProgramiv(Program, GL_PROGRAM_BINARY_LENGTH, &BinarySize);
+		if (BinarySize <= 0)
+			return false;
+
+		std::vector<char> Binary(BinarySize);
+		GLenum BinaryFormat = 0;
+		glGetProgramBinary(Program, BinarySize, nullptr, &BinaryFormat, Binary.data());
+
+		Header FileHeader;
+		FileHeader.Magic = Magic;
+		FileHeader.Version = Version;
+		FileHeader.Key = Key;
+		FileHeader.BinaryFormat = BinaryFormat;
+		FileHeader.BinarySize = static_cast<uint32_t>(BinarySize);
+
+		std::error_code Error;
+		std::filesystem::create_directories(s_Directory, Error);
+
+		// Write to a temporary file first so a crash never leaves a truncated binary behind
+		const std::string CachePath = GetCachePath(Key);
+		const std::string TemporaryPath = CachePath + ".tmp";
+		{
+			std::ofstream File(TemporaryPath, std::ios::binary | std::ios::trunc);
+			if (!File)
+				return false;
+
+			File.write(reinterpret_cast<const char*>(&FileHeader), sizeof(FileHeader));
+			File.write(Binary.data(), Binary.size());
+			if (!File)
+				return false;
+		}
+
+		std::filesystem::rename(TemporaryPath, std::filesystem::path(CachePath), Error);
+		if (Error)
+		{
+			std::filesystem::remove(TemporaryPath, Error);
+			return false;
+		}
+		return true;
+	}
+
+	void ShaderCache::SetDirectory(std::string_view Directory)
+	{
+		s_Directory = Directory;
+	}
+
+	void ShaderCache::SetEnabled(bool bEnabled)
+	{
+		s_bEnabled = bEnabled;
+	}
+
+	bool ShaderCache::IsEnabled()
+	{
+		if (!s_bEnabled)
+			return false;
+
+		GLint FormatCount = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &FormatCount);
+		return FormatCount > 0;
+	}
+
+	std::string ShaderCache::GetCachePath(uint64_t Key)
+	{
+		char FileName[32];
+		std::snprintf(FileName, sizeof(FileName), "%016llx", static_cast<unsigned long long>(Key));
+		return (std::filesystem::path(s_Directory) / (std::string(FileName) + Extension)).string();
+	}
+
+} // namespace fgl
\ No newline at end of file
@@ -0,0 +1,186 @@
+#include <FireGL/Renderer/ShaderHotReloader.h>
+#include <FireGL/Core/BaseLog.h>
+#include <FireGL/Renderer/Shader.h>
+#include <FireGL/Renderer/Material.h>
+
+namespace fgl
+{
+
+	namespace
+	{
+		/** @return The contents of a file, empty if it can't be read (e.g. while an editor rewrites it). */
+		std::string ReadFile(const std::string& Path)
+		{
+			std::ifstream File(Path, std::ios::binary);
+			if (!File)
+				return std::string();
+
+			return std::string(std::istreambuf_iterator<char>(File), std::istreambuf_iterator<char>());
+		}
+	}
+
+	ShaderHotReloader::ShaderHotReloader(std::chrono::milliseconds PollInterval)
+		: m_PollInterval(PollInterval)
+	{
+		m_Watcher = std::thread(&ShaderHotReloader::WatchFiles, this);
+	}
+
+	ShaderHotReloader::~ShaderHotReloader()
+	{
+		{
+			std::lock_guard<std::mutex> Lock(m_Mutex);
+			m_bStop = true;
+		}
+		m_StopSignal.notify_one();
+		m_Watcher.join();
+
+		for (std::unique_ptr<WatchedShader>& Watched : m_Shaders)
+		{
+			if (Watched->Replacement)
+			{
+				Watched->Replacement->Cleanup();
+			}
+		}
+	}
+
+	void ShaderHotReloader::Watch(Shader& Target)
+	{
+		if (Target.GetVertexPath().empty() || Target.GetFragmentPath().empty())
+		{
+			LOG_ERROR("Only shaders loaded from files can be hot-reloaded.", false);
+			return;
+		}
+
+		std::unique_ptr<WatchedShader> Watched = std::make_unique<WatchedShader>();
+		Watched->Target = &Target;
+		Watched->WriteTimes[0] = GetWriteTime(Target.GetVertexPath());
+		Watched->WriteTimes[1] = GetWriteTime(Target.GetFragmentPath());
+
+		std::lock_guard<std::mutex> Lock(m_Mutex);
+		m_Shaders.push_back(std::move(Watched));
+	}
+
+	void ShaderHotReloader::Unwatch(Shader& Target)
+	{
+		std::lock_guard<std::mutex> Lock(m_Mutex);
+		std::erase_if(m_Shaders, [&Target](const std::unique_ptr<WatchedShader>& Watched)
+		{
+			if (Watched->Target != &Target)
+				return false;
+
+			if (Watched->Replacement)
+			{
+				Watched->Replacement->Cleanup();
+			}
+			return true;
+		});
+	}
+
+	void ShaderHotReloader::Update()
+	{
+		// Never wait on the watcher thread from the render loop, the next frame checks again
+		std::unique_lock<std::mutex> Lock(m_Mutex, std::try_to_lock);
+		if (!Lock.owns_lock())
+			return;
+
+		for (std::unique_ptr<WatchedShader>& Watched : m_Shaders)
+		{
+			if (Watched->Replacement && Watched->Replacement->IsReady())
+			{
+				if (Watched->Replacement->IsLinked())
+				{
+					// Materials bound the previous program, their state is bound again on the next activation
+					Watched->Target->ReplaceProgram(*Watched->Replacement);
+					Material::InvalidateActiveMaterial();
+					LOG_INFO("Reloaded shader: " + Watched->Target->GetFragmentPath())
+				}
+				else
+				{
+					Watched->Replacement->Cleanup();
+					LOG_ERROR("Failed to reload shader, keeping the previous program: " + Watched->Target->GetFragmentPath(), false);
+				}
+				Watched->Replacement.reset();
+			}
+
+			// A save during a compile waits for it, the next Update() submits the newest sources
+			if (Watched->bSourcesChanged && !Watched->Replacement)
+			{
+				Watched->Replacement = Shader::CreateFromSource(Watched->Sources[0], Watched->Sources[1], true);
+				Watched->bSourcesChanged = false;
+			}
+		}
+	}
+
+	void ShaderHotReloader::WatchFiles()
+	{
+		/** What the thread needs to know about a watched shader, copied so files are read without the lock. */
+		struct PollEntry
+		{
+			WatchedShader* Watched;
+			std::string Paths[2];
+			std::filesystem::file_time_type WriteTimes[2];
+		};
+
+		std::unique_lock<std::mutex> Lock(m_Mutex);
+		while (!m_StopSignal.wait_for(Lock, m_PollInterval, [this] { return m_bStop; }))
+		{
+			std::vector<PollEntry> Entries;
+			for (std::unique_ptr<WatchedShader>& Watched : m_Shaders)
+			{
+				Entries.push_back({ Watched.get(), { Watched->Target->GetVertexPath(), Watched->Target->GetFragmentPath() },
+					{ Watched->WriteTimes[0], Watched->WriteTimes[1] } });
+			}
+			Lock.unlock();
+
+			std::vector<std::pair<PollEntry*, std::array<std::string, 2>>> Changes;
+			for (PollEntry& Entry : Entries)
+			{
+				bool bChanged = false;
+				for (int Stage = 0; Stage < 2; Stage++)
+				{
+					const std::filesystem::file_time_type WriteTime = GetWriteTime(Entry.Paths[Stage]);
+					bChanged |= WriteTime != Entry.WriteTimes[Stage];
+					Entry.WriteTimes[Stage] = WriteTime;
+				}
+				if (!bChanged)
+					continue;
+
+				std::array<std::string, 2> Sources = { ReadFile(Entry.Paths[0]), ReadFile(Entry.Paths[1]) };
+				if (Sources[0].empty() || Sources[1].empty())
+				{
+					// Retried on the next poll, once the editor is done writing
+					Entry.WriteTimes[0] = Entry.WriteTimes[1] = std::filesystem::file_time_type::min();
+				}
+				Changes.emplace_back(&Entry, std::move(Sources));
+			}
+
+			Lock.lock();
+			for (auto& [Entry, Sources] : Changes)
+			{
+				// The shader may have been unwatched while the files were read
+				auto It = std::find_if(m_Shaders.begin(), m_Shaders.end(),
+					[Entry](const std::unique_ptr<WatchedShader>& Watched) { return Watched.get() == Entry->Watched; });
+				if (It == m_Shaders.end())
+					continue;
+
+				WatchedShader& Watched = **It;
+				Watched.WriteTimes[0] = Entry->WriteTimes[0];
+				Watched.WriteTimes[1] = Entry->WriteTimes[1];
+				if (Sources[0].empty() || Sources[1].empty())
+					continue;
+
+				Watched.Sources[0] = std::move(Sources[0]);
+				Watched.Sources[1] = std::move(Sources[1]);
+				Watched.bSourcesChanged = true;
+			}
+		}
+	}
+
+	std::filesystem::file_time_type ShaderHotReloader::GetWriteTime(const std::string& Path)
+	{
+		std::error_code Error;
+		const std::filesystem::file_time_type WriteTime = std::filesystem::last_write_time(Path, Error);
+		return Error ? std::filesystem::file_time_type::min() : WriteTime;
+	}
+
+} // namespace fgl
\ No newline at end of file
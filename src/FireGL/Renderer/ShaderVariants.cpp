@@ -0,0 +1,89 @@
+#include <FireGL/Renderer/ShaderVariants.h>
+#include <FireGL/Core/BaseLog.h>
+#include <FireGL/Renderer/Shader.h>
+
+namespace fgl
+{
+
+	ShaderVariants::ShaderVariants(std::string_view VertexPath, std::string_view FragmentPath, std::vector<std::string> Features)
+		: m_VertexCode(Shader::LoadShaderCode(VertexPath)), m_FragmentCode(Shader::LoadShaderCode(FragmentPath)), m_Features(std::move(Features))
+	{
+		LOG_ASSERT(m_Features.size() <= MaxFeatures, "A shader can't have more than 32 permutation features");
+	}
+
+	ShaderVariants::~ShaderVariants()
+	{
+		for (auto& [FeatureMask, Variant] : m_Variants)
+		{
+			Variant->Cleanup();
+		}
+	}
+
+	Shader* ShaderVariants::Get(uint32_t FeatureMask)
+	{
+		// Bits past the last feature would create duplicate variants of the same program
+		if (m_Features.size() < MaxFeatures)
+		{
+			FeatureMask &= (1u << m_Features.size()) - 1;
+		}
+
+		auto It = m_Variants.find(FeatureMask);
+		if (It != m_Variants.end())
+			return It->second.get();
+
+		std::string Defines;
+		for (size_t Feature = 0; Feature < m_Features.size(); Feature++)
+		{
+			if (FeatureMask & (1u << Feature))
+			{
+				Defines += "#define " + m_Features[Feature] + " 1\n";
+			}
+		}
+
+		std::unique_ptr<Shader> Variant = Shader::CreateFromSource(InsertDefines(m_VertexCode, Defines), InsertDefines(m_FragmentCode, Defines), true);
+		return m_Variants.emplace(FeatureMask, std::move(Variant)).first->second.get();
+	}
+
+	uint32_t ShaderVariants::GetFeatureBit(std::string_view Feature) const
+	{
+		for (size_t Index = 0; Index < m_Features.size(); Index++)
+		{
+			if (m_Features[Index] == Feature)
+				return 1u << Index;
+		}
+		return 0;
+	}
+
+	size_t ShaderVariants::GetVariantCount() const
+	{
+		return m_Variants.size();
+	}
+
+	std::string ShaderVariants::InsertDefines(const std::string& Source, const std::string& Defines)
+	{
+		if (Defines.empty())
+			return Source;
+
+		// #version must stay the first directive; #line keeps compiler messages on the file's own line numbers
+		size_t Insert = 0;
+		int NextLine = 1;
+		const size_t Version = Source.find("#version");
+		if (Version != std::string::npos)
+		{
+			const size_t LineEnd = Source.find('\n', Version);
+			Insert = LineEnd == std::string::npos ? Source.size() : LineEnd + 1;
+			NextLine = static_cast<int>(std::count(Source.begin(), Source.begin() + Insert, '\n')) + 1;
+		}
+
+		std::string Result = Source.substr(0, Insert);
+		if (!Result.empty() && Result.back() != '\n')
+		{
+			Result += '\n';
+		}
+		Result += Defines;
+		Result += "#line " + std::to_string(NextLine) + "\n";
+		Result += Source.substr(Insert);
+		return Result;
+	}
+
+} // namespace fgl
\ No newline at end of file
@@ -3,32 +3,62 @@
 #include <FireGL/Renderer/Vertex.h>
 #include <FireGL/Renderer/Material.h>
 
+#include <mutex>
+
 namespace fgl
 {
 
+	namespace
+	{
+		std::mutex s_GeometryMutex;                                        ///< Guards s_Geometries.
+		std::unordered_map<uint64_t, std::unique_ptr<BaseMesh>> s_Geometries; ///< Generated geometry by shape key.
+	}
+
 	Shape::Shape(std::vector<Vertex>&& Vertices, std::vector<unsigned int>&& Indices)
 		: m_Mesh{ { std::move(Vertices), std::move(Indices), {}, 1 } }, SceneObject()
 	{
 	}
 
-	std::vector<BaseMesh>& Shape::GetMeshes()
+	Shape::Shape(const BaseMesh& Geometry)
+		: m_Mesh{ Geometry }, SceneObject()
+	{
+	}
+
+	const BaseMesh& Shape::AcquireGeometry(uint64_t Key, const std::function<BaseMesh()>& Generate)
+	{
+		std::lock_guard<std::mutex> Lock(s_GeometryMutex);
+		std::unique_ptr<BaseMesh>& Geometry = s_Geometries[Key];
+		if (!Geometry)
+		{
+			Geometry = std::make_unique<BaseMesh>(Generate());
+		}
+		return *Geometry;
+	}
+
+	std::span<BaseMesh> Shape::GetMeshes()
 	{
-		return { m_Mesh };
+		return m_Mesh;
+	}
+
+	std::span<const BaseMesh> Shape::GetMeshes() const
+	{
+		return m_Mesh;
 	}
 
 	size_t Shape::GetHash() const
 	{
-		return m_Mesh[0].GetMeshHash();
+		return m_Mesh[0].GetMeshID();
 	}
 
-	void Shape::Render(size_t NumberInstance) const
+	void Shape::Render(size_t NumberInstance, size_t BaseInstance, uint32_t LOD) const
 	{
-		m_Mesh[0].Render(NumberInstance);
+		m_Mesh[0].Render(NumberInstance, BaseInstance, LOD);
 	}
 
 	void Shape::SetMaterial(std::shared_ptr<Material> Material)
 	{
 		m_Mesh[0].SetMaterial(Material);
+		NotifyMaterialChanged();
 		Material->SetSceneObject(this);
 	}
 
@@ -41,6 +71,16 @@ namespace fgl
 	{
 	}
 
+	bool Shape::IsTickThreadSafe() const
+	{
+		return true;
+	}
+
+	bool Shape::WantsTick() const
+	{
+		return false;
+	}
+
 	void Shape::BeginPlay()
 	{
 	}
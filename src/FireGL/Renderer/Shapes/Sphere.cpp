@@ -1,37 +1,82 @@
 #include <FireGL/Renderer/Shapes/Sphere.h>
 #include <FireGL/Renderer/Vertex.h>
 
+#include <FireGL/Core/AssetId.h>
+
+#include <bit>
 #include <numbers>
 
 namespace fgl
 {
 
-    Sphere::Sphere(float Radius, int Stacks, int Slices)
-        : Shape(std::move(GenerateVertices(Radius, Stacks, Slices)), std::move(GenerateIndices(Stacks, Slices)))
+    namespace
+    {
+        constexpr float FirstLODScreenSize = 0.25f; ///< Projected size below which the first reduced level is drawn.
+        constexpr int MinLODStacks = 2;             ///< Fewest stacks a reduced level may have.
+        constexpr int MinLODSlices = 3;             ///< Fewest slices a reduced level may have.
+
+        /** @return The geometry cache key of a sphere's parameters. */
+        uint64_t GetGeometryKey(float Radius, int Stacks, int Slices, int LODCount)
+        {
+            const uint32_t Parameters[] = { std::bit_cast<uint32_t>(Radius), static_cast<uint32_t>(Stacks),
+                static_cast<uint32_t>(Slices), static_cast<uint32_t>(LODCount) };
+            return AssetId::HashKey(std::string_view(reinterpret_cast<const char*>(Parameters), sizeof(Parameters)));
+        }
+    }
+
+    Sphere::Sphere(float Radius, int Stacks, int Slices, int LODCount)
+        : Shape(AcquireGeometry(GetGeometryKey(Radius, Stacks, Slices, LODCount),
+            [=]() { return GenerateMesh(Radius, Stacks, Slices, LODCount); }))
+    {
+    }
+
+    BaseMesh Sphere::GenerateMesh(float Radius, int Stacks, int Slices, int LODCount)
+    {
+        BaseMesh Mesh(GenerateVertices(Radius, Stacks, Slices), GenerateIndices(Stacks, Slices, Stacks, Slices), {}, true);
+        GenerateLODs(Mesh, Stacks, Slices, LODCount);
+        return Mesh;
+    }
+
+    void Sphere::GenerateLODs(BaseMesh& Mesh, int Stacks, int Slices, int LODCount)
     {
+        // A level has a quarter of the triangles of the previous one, so it is drawn at half its size
+        float ScreenSize = FirstLODScreenSize;
+        for (int Level = 1; Level < LODCount; Level++)
+        {
+            const int LODStacks = Stacks >> Level;
+            const int LODSlices = Slices >> Level;
+            if (LODStacks < MinLODStacks || LODSlices < MinLODSlices)
+                break;
+
+            Mesh.AddLOD(GenerateIndices(Stacks, Slices, LODStacks, LODSlices), ScreenSize);
+            ScreenSize *= 0.5f;
+        }
     }
 
     std::vector<Vertex> Sphere::GenerateVertices(float Radius, int Stacks, int Slices)
     {
         std::vector<Vertex> Vertices;
+        Vertices.reserve(static_cast<size_t>(Stacks + 1) * (Slices + 1));
+
+        // The horizontal angle (theta) of every slice, ranging from 0 to 2*Pi, is shared by all stacks
+        std::vector<glm::vec2> SliceDirections(Slices + 1);
+        for (int SliceIndex = 0; SliceIndex <= Slices; ++SliceIndex) {
+            float Theta = 2.0f * std::numbers::pi * SliceIndex / Slices;
+            SliceDirections[SliceIndex] = { cosf(Theta), sinf(Theta) };
+        }
 
         // Loop through latitudinal segments (Stacks)
         for (int StackIndex = 0; StackIndex <= Stacks; ++StackIndex) {
             // Calculate the vertical angle (phi), ranging from 0 to Pi
             float Phi = std::numbers::pi * StackIndex / Stacks;
+            float SinPhi = sinf(Phi);
+            float CosPhi = cosf(Phi);
 
             // Loop through longitudinal segments (Slices)
             for (int SliceIndex = 0; SliceIndex <= Slices; ++SliceIndex) {
-                // Calculate the horizontal angle (theta), ranging from 0 to 2*Pi
-                float Theta = 2.0f * std::numbers::pi * SliceIndex / Slices;
-
                 // Convert spherical coordinates to Cartesian coordinates
-                float X = Radius * sinf(Phi) * cosf(Theta);
-                float Y = Radius * cosf(Phi);
-                float Z = Radius * sinf(Phi) * sinf(Theta);
-
-                glm::vec3 Position(X, Y, Z);
-                glm::vec3 Normal = glm::normalize(Position);
+                glm::vec3 Normal(SinPhi * SliceDirections[SliceIndex].x, CosPhi, SinPhi * SliceDirections[SliceIndex].y);
+                glm::vec3 Position = Radius * Normal;
 
                 // Calculate texture coordinates (u, v) based on the current slice and stack
                 glm::vec2 TexCoords = { 
@@ -46,25 +91,35 @@ namespace fgl
         return Vertices;
     }
 
-    std::vector<unsigned int> Sphere::GenerateIndices(int Stacks, int Slices)
+    std::vector<unsigned int> Sphere::GenerateIndices(int Stacks, int Slices, int LODStacks, int LODSlices)
     {
         std::vector<unsigned int> Indices;
+        Indices.reserve(static_cast<size_t>(LODStacks) * LODSlices * 6);
 
         // Loop through each stack and slice to generate indices for triangles
-        for (int StackIndex = 0; StackIndex < Stacks; ++StackIndex) {
-            for (int SliceIndex = 0; SliceIndex < Slices; ++SliceIndex) {
+        for (int StackIndex = 0; StackIndex < LODStacks; ++StackIndex) {
+            // Rows and columns of the full vertex grid spanned by this segment
+            int Row = StackIndex * Stacks / LODStacks;
+            int NextRow = (StackIndex + 1) * Stacks / LODStacks;
+
+            for (int SliceIndex = 0; SliceIndex < LODSlices; ++SliceIndex) {
+                int Column = SliceIndex * Slices / LODSlices;
+                int NextColumn = (SliceIndex + 1) * Slices / LODSlices;
+
                 // Calculate indices for the current quad
-                int First = (StackIndex * (Slices + 1)) + SliceIndex;
-                int Second = First + Slices + 1;
+                int First = (Row * (Slices + 1)) + Column;
+                int FirstNext = (Row * (Slices + 1)) + NextColumn;
+                int Second = (NextRow * (Slices + 1)) + Column;
+                int SecondNext = (NextRow * (Slices + 1)) + NextColumn;
 
-                // Create two triangles for each quad (quad split into 2 tris)
+                // Create two triangles for each quad (quad split into 2 tris), counter-clockwise seen from outside
                 Indices.push_back(First);        // Triangle 1
+                Indices.push_back(FirstNext);
                 Indices.push_back(Second);
-                Indices.push_back(First + 1);
 
                 Indices.push_back(Second);       // Triangle 2
-                Indices.push_back(Second + 1);
-                Indices.push_back(First + 1);
+                Indices.push_back(FirstNext);
+                Indices.push_back(SecondNext);
             }
         }
         return Indices;
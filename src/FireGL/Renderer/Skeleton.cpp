@@ -0,0 +1,149 @@
+#include <FireGL/Renderer/Skeleton.h>
+#include <FireGL/Core/BaseLog.h>
+
+#include <External/assimp/scene.h>
+#include <External/glm/glm.hpp>
+
+namespace fgl
+{
+
+	namespace
+	{
+		/** Assimp matrices are row-major, glm's column-major. */
+		glm::mat4 ToMatrix(const aiMatrix4x4& Matrix)
+		{
+			return glm::mat4(
+				Matrix.a1, Matrix.b1, Matrix.c1, Matrix.d1,
+				Matrix.a2, Matrix.b2, Matrix.c2, Matrix.d2,
+				Matrix.a3, Matrix.b3, Matrix.c3, Matrix.d3,
+				Matrix.a4, Matrix.b4, Matrix.c4, Matrix.d4);
+		}
+	}
+
+	std::shared_ptr<Skeleton> Skeleton::Import(const aiScene* Scene)
+	{
+		bool bHasBones = false;
+		for (unsigned int i = 0; i < Scene->mNumMeshes && !bHasBones; i++)
+		{
+			bHasBones = Scene->mMeshes[i]->HasBones();
+		}
+		if (!bHasBones)
+			return nullptr;
+
+		std::shared_ptr<Skeleton> Result = std::make_shared<Skeleton>();
+
+		// Depth-first with an explicit stack, a node is always pushed after its parent
+		std::vector<std::pair<const aiNode*, int32_t>> Pending = { { Scene->mRootNode, -1 } };
+		while (!Pending.empty())
+		{
+			const auto [Node, Parent] = Pending.back();
+			Pending.pop_back();
+
+			const uint32_t Index = static_cast<uint32_t>(Result->m_Nodes.size());
+			SkeletonNode& Added = Result->m_Nodes.emplace_back();
+			Added.Name = Node->mName.C_Str();
+			Added.Parent = Parent;
+			Added.LocalTransform = ToMatrix(Node->mTransformation);
+			Result->m_NodeIndices.try_emplace(Added.Name, Index);
+
+			for (unsigned int Child = Node->mNumChildren; Child > 0; Child--)
+			{
+				Pending.emplace_back(Node->mChildren[Child - 1], static_cast<int32_t>(Index));
+			}
+		}
+		Result->m_GlobalInverse = glm::inverse(Result->m_Nodes[0].LocalTransform);
+
+		Result->m_RestPose.Resize(static_cast<uint32_t>(Result->m_Nodes.size()));
+		for (uint32_t i = 0; i < Result->m_Nodes.size(); i++)
+		{
+			Result->m_RestPose.SetNode(i, Result->m_Nodes[i].LocalTransform);
+		}
+
+		// Meshes sharing a bone reference the same node with the same offset, the first record is kept
+		for (unsigned int MeshIndex = 0; MeshIndex < Scene->mNumMeshes; MeshIndex++)
+		{
+			const aiMesh* Mesh = Scene->mMeshes[MeshIndex];
+			for (unsigned int BoneIndex = 0; BoneIndex < Mesh->mNumBones; BoneIndex++)
+			{
+				const aiBone* Bone = Mesh->mBones[BoneIndex];
+				const std::string Name = Bone->mName.C_Str();
+				if (Result->m_BoneIndices.contains(Name))
+					continue;
+
+				const int32_t Node = Result->FindNode(Name);
+				if (Node < 0)
+				{
+					LOG_INFO("Bone " + Name + " has no node in the scene hierarchy, it follows the root.")
+				}
+
+				Result->m_BoneIndices.emplace(Name, static_cast<uint32_t>(Result->m_Bones.size()));
+				SkeletonBone& Added = Result->m_Bones.emplace_back();
+				Added.Node = static_cast<uint32_t>(std::max(Node, 0));
+				Added.Offset = ToMatrix(Bone->mOffsetMatrix);
+			}
+		}
+
+		if (Result->m_Bones.size() > std::numeric_limits<uint16_t>::max())
+		{
+			LOG_ERROR("Skeleton has " + std::to_string(Result->m_Bones.size()) + " bones, vertices index at most 65,535.", true)
+		}
+		return Result;
+	}
+
+	int32_t Skeleton::FindNode(std::string_view Name) const
+	{
+		auto Found = m_NodeIndices.find(std::string(Name));
+		return Found != m_NodeIndices.end() ? static_cast<int32_t>(Found->second) : -1;
+	}
+
+	int32_t Skeleton::FindBone(std::string_view Name) const
+	{
+		auto Found = m_BoneIndices.find(std::string(Name));
+		return Found != m_BoneIndices.end() ? static_cast<int32_t>(Found->second) : -1;
+	}
+
+	const std::vector<SkeletonNode>& Skeleton::GetNodes() const
+	{
+		return m_Nodes;
+	}
+
+	const std::vector<SkeletonBone>& Skeleton::GetBones() const
+	{
+		return m_Bones;
+	}
+
+	uint32_t Skeleton::GetBoneCount() const
+	{
+		return static_cast<uint32_t>(m_Bones.size());
+	}
+
+	const SkeletonPose& Skeleton::GetRestPose() const
+	{
+		return m_RestPose;
+	}
+
+	void Skeleton::ComputePalette(std::vector<glm::mat4>& Transforms, std::vector<glm::mat4>& Palette) const
+	{
+		LOG_ASSERT(Transforms.size() == m_Nodes.size(), "Pose and skeleton node counts differ")
+
+		// The parent's entry already holds its model transform when a child is reached
+		Transforms[0] = m_GlobalInverse * Transforms[0];
+		for (size_t i = 1; i < m_Nodes.size(); i++)
+		{
+			Transforms[i] = Transforms[m_Nodes[i].Parent] * Transforms[i];
+		}
+
+		Palette.resize(m_Bones.size());
+		for (size_t i = 0; i < m_Bones.size(); i++)
+		{
+			Palette[i] = Transforms[m_Bones[i].Node] * m_Bones[i].Offset;
+		}
+	}
+
+	void Skeleton::ComputePalette(const SkeletonPose& Pose, std::vector<glm::mat4>& Transforms, std::vector<glm::mat4>& Palette) const
+	{
+		Pose.GetTransforms(Transforms);
+		ComputePalette(Transforms, Palette);
+	}
+
+} // namespace fgl
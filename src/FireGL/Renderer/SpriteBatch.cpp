@@ -0,0 +1,298 @@
+#include <FireGL/Renderer/SpriteBatch.h>
+#include <FireGL/Renderer/BaseCamera.h>
+#include <FireGL/Renderer/Material.h>
+#include <FireGL/Renderer/GLStateCache.h>
+#include <FireGL/Renderer/RenderDevice.h>
+#include <FireGL/Renderer/GPUMemoryTracker.h>
+#include <FireGL/Renderer/RenderStats.h>
+#include <FireGL/Core/BaseLog.h>
+
+#include <External/glm/gtc/packing.hpp>
+
+namespace fgl
+{
+
+	namespace
+	{
+		constexpr GLint SpriteUnit = 0; ///< Texture unit of the quads' textures while drawn.
+
+		constexpr std::string_view SpriteVertexCode = R"(#version 410 core
+layout (location = 0) in vec2 aPosition;
+layout (location = 1) in vec2 aUV;
+layout (location = 2) in vec4 aColor;
+
+uniform mat4 Projection;
+
+out vec2 UV;
+out vec4 Color;
+
+void main()
+{
+    UV = aUV;
+    Color = aColor;
+    gl_Position = Projection * vec4(aPosition, 0.0, 1.0);
+}
+)";
+
+		constexpr std::string_view SpriteFragmentCode = R"(#version 410 core
+in vec2 UV;
+in vec4 Color;
+
+uniform sampler2D Sprite;
+
+out vec4 FragColor;
+
+void main()
+{
+    FragColor = texture(Sprite, UV) * Color;
+}
+)";
+
+		/** Pixel-space camera of the overlay, never moved by input. */
+		class OverlayCamera final : public BaseCamera
+		{
+		public:
+			void ProcessMovementInput(CameraMovement MovementDirection, float DeltaTime) override {}
+			void ProcessRotationInput(float XOffset, float YOffset) override {}
+		};
+	}
+
+	SpriteBatch::SpriteBatch()
+		: m_Camera(std::make_shared<OverlayCamera>())
+	{
+	}
+
+	SpriteBatch::~SpriteBatch()
+	{
+		Destroy();
+	}
+
+	void SpriteBatch::SetLayer(int Layer)
+	{
+		m_Layer = Layer;
+	}
+
+	void SpriteBatch::DrawSprite(GLuint Texture, const glm::vec2& Position, const glm::vec2& Size, const glm::vec4& Color, const glm::vec4& UVRect)
+	{
+		m_Recording.push_back({ glm::vec4(Position, Position + Size), UVRect, glm::packUnorm4x8(Color), Texture, m_Layer });
+	}
+
+	void SpriteBatch::DrawRect(const glm::vec2& Position, const glm::vec2& Size, const glm::vec4& Color)
+	{
+		DrawSprite(0, Position, Size, Color);
+	}
+
+	float SpriteBatch::DrawString(const SpriteFont& Font, std::string_view Text, const glm::vec2& Position, float Height, const glm::vec4& Color)
+	{
+		const uint32_t GlyphCount = Font.Columns * Font.Rows;
+		const uint32_t PackedColor = glm::packUnorm4x8(Color);
+		const glm::vec2 GlyphSize(Height * Font.CellAspect, Height);
+		const glm::vec2 CellUV(1.0f / static_cast<float>(Font.Columns), 1.0f / static_cast<float>(Font.Rows));
+		const float Advance = GlyphSize.x * Font.Spacing;
+
+		glm::vec2 Pen = Position;
+		float Width = 0.0f;
+		m_Recording.reserve(m_Recording.size() + Text.size());
+		for (const char Character : Text)
+		{
+			if (Character == '\n')
+			{
+				Width = std::max(Width, Pen.x - Position.x);
+				Pen = glm::vec2(Position.x, Pen.y + Height);
+				continue;
+			}
+
+			// Spaces and characters outside of the grid only advance
+			const uint32_t Code = static_cast<unsigned char>(Character);
+			if (Character != ' ' && Code >= Font.FirstCharacter && Code - Font.FirstCharacter < GlyphCount)
+			{
+				const uint32_t Cell = Code - Font.FirstCharacter;
+				const glm::vec2 UV(static_cast<float>(Cell % Font.Columns) * CellUV.x, static_cast<float>(Cell / Font.Columns) * CellUV.y);
+				m_Recording.push_back({ glm::vec4(Pen, Pen + GlyphSize), glm::vec4(UV, UV + CellUV), PackedColor, Font.Atlas, m_Layer });
+			}
+			Pen.x += Advance;
+		}
+		return std::max(Width, Pen.x - Position.x);
+	}
+
+	size_t SpriteBatch::GetQuadCount() const
+	{
+		return m_Recording.size();
+	}
+
+	void SpriteBatch::Latch()
+	{
+		// Swapped rather than copied, both lists keep their capacity from frame to frame
+		m_Latched.swap(m_Recording);
+		m_Recording.clear();
+		m_Layer = 0;
+	}
+
+	void SpriteBatch::Reserve(size_t QuadCount)
+	{
+		if (QuadCount <= m_Capacity)
+			return;
+
+		m_Capacity = std::max(QuadCount, m_Capacity * 2);
+		GLStateCache::BindVertexArray(m_VertexArray);
+
+		// The vertex buffer is respecified every frame, only its size is set here
+		GLStateCache::BindBuffer(GL_ARRAY_BUFFER, m_VertexBuffer);
+		GPUMemoryTracker::UntrackBuffer(m_VertexBuffer);
+		GPUMemoryTracker::TrackBuffer(m_VertexBuffer, m_Capacity * 4 * sizeof(Vertex), GPUMemoryCategory::Geometry, "Sprite Batch");
+
+		// The same two triangles for every quad, written once per growth
+		std::vector<uint32_t> Indices(m_Capacity * 6);
+		for (uint32_t Quad = 0; Quad < m_Capacity; Quad++)
+		{
+			const uint32_t First = Quad * 4;
+			uint32_t* QuadIndices = &Indices[Quad * 6];
+			QuadIndices[0] = First;
+			QuadIndices[1] = First + 1;
+			QuadIndices[2] = First + 2;
+			QuadIndices[3] = First + 2;
+			QuadIndices[4] = First + 3;
+			QuadIndices[5] = First;
+		}
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_IndexBuffer);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(Indices.size() * sizeof(uint32_t)), Indices.data(), GL_STATIC_DRAW);
+		GPUMemoryTracker::UntrackBuffer(m_IndexBuffer);
+		GPUMemoryTracker::TrackBuffer(m_IndexBuffer, Indices.size() * sizeof(uint32_t), GPUMemoryCategory::Geometry, "Sprite Batch");
+		RenderCounters::CountUpload(Indices.size() * sizeof(uint32_t));
+	}
+
+	void SpriteBatch::Render(int Width, int Height)
+	{
+		if (m_Latched.empty())
+			return;
+
+		if (!m_Shader)
+		{
+			m_Shader = Shader::CreateFromSource(SpriteVertexCode, SpriteFragmentCode);
+			glGenVertexArrays(1, &m_VertexArray);
+			glGenBuffers(1, &m_VertexBuffer);
+			glGenBuffers(1, &m_IndexBuffer);
+			GLStateCache::BindVertexArray(m_VertexArray);
+			GLStateCache::BindBuffer(GL_ARRAY_BUFFER, m_VertexBuffer);
+			glEnableVertexAttribArray(0);
+			glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<const void*>(offsetof(Vertex, Position)));
+			glEnableVertexAttribArray(1);
+			glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<const void*>(offsetof(Vertex, UV)));
+			glEnableVertexAttribArray(2);
+			glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex), reinterpret_cast<const void*>(offsetof(Vertex, Color)));
+
+			const uint32_t White = 0xFFFFFFFF;
+			TextureDesc WhiteDesc;
+			WhiteDesc.Filter = TextureFilter::Nearest;
+			WhiteDesc.Owner = "Sprite Batch";
+			m_WhiteTexture = RenderDevice::Get().CreateTexture(WhiteDesc, &White);
+		}
+		Reserve(m_Latched.size());
+
+		// Stable, so the quads of one texture keep the order they were recorded in
+		m_Order.resize(m_Latched.size());
+		for (uint32_t Index = 0; Index < m_Order.size(); Index++)
+		{
+			m_Order[Index] = Index;
+		}
+		std::stable_sort(m_Order.begin(), m_Order.end(), [this](uint32_t Left, uint32_t Right)
+			{
+				const Quad& A = m_Latched[Left];
+				const Quad& B = m_Latched[Right];
+				return A.Layer != B.Layer ? A.Layer < B.Layer : A.Texture < B.Texture;
+			});
+
+		// Orphaned then mapped, the vertices are written in place without a copy on the CPU
+		const size_t VertexBytes = m_Latched.size() * 4 * sizeof(Vertex);
+		GLStateCache::BindBuffer(GL_ARRAY_BUFFER, m_VertexBuffer);
+		glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(m_Capacity * 4 * sizeof(Vertex)), nullptr, GL_STREAM_DRAW);
+		Vertex* Vertices = static_cast<Vertex*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(VertexBytes),
+			GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+		if (!Vertices)
+		{
+			LOG_ERROR("SpriteBatch: mapping the vertex buffer failed, the overlay is skipped", false);
+			m_Latched.clear();
+			return;
+		}
+		for (const uint32_t Index : m_Order)
+		{
+			const Quad& Sprite = m_Latched[Index];
+			*Vertices++ = { glm::vec2(Sprite.Rect.x, Sprite.Rect.y), glm::vec2(Sprite.UVRect.x, Sprite.UVRect.y), Sprite.Color };
+			*Vertices++ = { glm::vec2(Sprite.Rect.x, Sprite.Rect.w), glm::vec2(Sprite.UVRect.x, Sprite.UVRect.w), Sprite.Color };
+			*Vertices++ = { glm::vec2(Sprite.Rect.z, Sprite.Rect.w), glm::vec2(Sprite.UVRect.z, Sprite.UVRect.w), Sprite.Color };
+			*Vertices++ = { glm::vec2(Sprite.Rect.z, Sprite.Rect.y), glm::vec2(Sprite.UVRect.z, Sprite.UVRect.y), Sprite.Color };
+		}
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+		RenderCounters::CountUpload(VertexBytes);
+
+		// Top left origin, y down, one unit per pixel
+		m_Camera->SetOrthographic(0.0f, static_cast<float>(Width), static_cast<float>(Height), 0.0f);
+		m_Shader->Activate();
+		m_Shader->SetMat4("Projection", m_Camera->GetProjectionMatrix());
+		m_Shader->SetInt("Sprite", SpriteUnit);
+
+		// The debug modes draw lines, the quads must be filled; y down flips their winding
+		GLint PolygonMode[2];
+		glGetIntegerv(GL_POLYGON_MODE, PolygonMode);
+		const GLboolean bDepthTest = glIsEnabled(GL_DEPTH_TEST);
+		glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+		glDisable(GL_DEPTH_TEST);
+		GLStateCache::SetCullMode(CullMode::None);
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+		// One draw per run of quads sharing a texture
+		GLStateCache::BindVertexArray(m_VertexArray);
+		size_t RunStart = 0;
+		while (RunStart < m_Order.size())
+		{
+			const GLuint Texture = m_Latched[m_Order[RunStart]].Texture;
+			size_t RunEnd = RunStart + 1;
+			while (RunEnd < m_Order.size() && m_Latched[m_Order[RunEnd]].Texture == Texture)
+			{
+				RunEnd++;
+			}
+			GLStateCache::BindTextureUnit(SpriteUnit, GL_TEXTURE_2D, Texture != 0 ? Texture : m_WhiteTexture.ID);
+			glDrawElements(GL_TRIANGLES, static_cast<GLsizei>((RunEnd - RunStart) * 6), GL_UNSIGNED_INT,
+				reinterpret_cast<const void*>(RunStart * 6 * sizeof(uint32_t)));
+			RenderCounters::CountDraw(1, (RunEnd - RunStart) * 2);
+			RunStart = RunEnd;
+		}
+
+		glDisable(GL_BLEND);
+		glPolygonMode(GL_FRONT_AND_BACK, static_cast<GLenum>(PolygonMode[0]));
+		if (bDepthTest)
+		{
+			glEnable(GL_DEPTH_TEST);
+		}
+		Material::InvalidateActiveMaterial();
+	}
+
+	void SpriteBatch::Destroy()
+	{
+		for (GLuint* Buffer : { &m_VertexBuffer, &m_IndexBuffer })
+		{
+			if (*Buffer == 0)
+				continue;
+
+			glDeleteBuffers(1, Buffer);
+			GLStateCache::OnBufferDeleted(*Buffer);
+			GPUMemoryTracker::UntrackBuffer(*Buffer);
+			*Buffer = 0;
+		}
+		if (m_VertexArray != 0)
+		{
+			glDeleteVertexArrays(1, &m_VertexArray);
+			GLStateCache::OnVertexArrayDeleted(m_VertexArray);
+			m_VertexArray = 0;
+		}
+		RenderDevice::Get().DestroyTexture(m_WhiteTexture);
+		if (m_Shader)
+		{
+			m_Shader->Cleanup();
+			m_Shader.reset();
+		}
+		m_Capacity = 0;
+	}
+
+} // namespace fgl
@@ -0,0 +1,153 @@
+#include <FireGL/Renderer/StaticGeometry.h>
+#include <FireGL/Renderer/SceneObject.h>
+#include <FireGL/Renderer/Material.h>
+
+#include <External/glm/geometric.hpp>
+#include <External/glm/matrix.hpp>
+
+namespace fgl
+{
+
+	std::atomic<uint64_t> StaticGeometry::s_NextRevision = 1;
+
+	namespace
+	{
+		/** Merged content of one chunk while it is built. */
+		struct ChunkBuilder
+		{
+			std::vector<Vertex> Vertices;
+			std::vector<glm::vec2> LightmapCoords;
+			std::vector<unsigned int> Indices;
+			std::shared_ptr<Material> ChunkMaterial;
+			glm::uvec4 TextureLayers = glm::uvec4(0);
+			glm::vec4 Payload = glm::vec4(0.0f);
+			uint32_t ReflectionProbe = 0;
+		};
+
+		template<typename T>
+		uint32_t ToBits(T Value)
+		{
+			uint32_t Bits;
+			std::memcpy(&Bits, &Value, sizeof(Bits));
+			return Bits;
+		}
+	}
+
+	void StaticGeometry::Build(const std::vector<SceneObject*>& Objects, float ChunkSize)
+	{
+		m_Chunks.clear();
+		m_Revision = s_NextRevision++;
+
+		// Material first so the chunks come out sorted by material, then everything else the instance carries, then the cell
+		std::map<std::array<uint32_t, 14>, ChunkBuilder> Builders;
+		for (SceneObject* Object : Objects)
+		{
+			Transform& ObjectTransform = Object->GetTransform();
+			const glm::mat4& Model = ObjectTransform.GetModelMatrix();
+			const glm::mat3& NormalMatrix = ObjectTransform.GetNormalMatrix();
+			const bool bMirrored = glm::determinant(glm::mat3(Model)) < 0.0f;
+
+			const glm::vec3 Center = glm::vec3(Model * glm::vec4(Object->GetLocalBoundingSphere().Center, 1.0f));
+			const glm::ivec3 Cell = glm::ivec3(glm::floor(Center / ChunkSize));
+
+			for (const BaseMesh& Mesh : Object->GetMeshes())
+			{
+				const std::shared_ptr<Material> MeshMaterial = Mesh.GetMaterial();
+				const glm::uvec4& Layers = Object->GetTextureLayers();
+
+				// The payload of a lightmapped object is its lightmap region, moved into the coordinates so the objects merge
+				const bool bLightmapped = Mesh.GetVertexFormat() == VertexFormat::Lightmapped;
+				const glm::vec4 Region = Object->GetInstancePayload();
+				const glm::vec4 Payload = bLightmapped ? glm::vec4(1.0f, 1.0f, 0.0f, 0.0f) : Region;
+				const std::array<uint32_t, 14> Key = { MeshMaterial ? MeshMaterial->GetID() : 0, bLightmapped ? 1u : 0u, Layers.x, Layers.y, Layers.z, Layers.w,
+					ToBits(Payload.x), ToBits(Payload.y), ToBits(Payload.z), ToBits(Payload.w), Object->GetReflectionProbe(),
+					ToBits(Cell.x), ToBits(Cell.y), ToBits(Cell.z) };
+
+				ChunkBuilder& Builder = Builders[Key];
+				Builder.ChunkMaterial = MeshMaterial;
+				Builder.TextureLayers = Layers;
+				Builder.Payload = Payload;
+				Builder.ReflectionProbe = Object->GetReflectionProbe();
+
+				const unsigned int BaseVertex = static_cast<unsigned int>(Builder.Vertices.size());
+				for (const Vertex& Source : Mesh.GetVertices())
+				{
+					Vertex& Target = Builder.Vertices.emplace_back(Source);
+					Target.Position = glm::vec3(Model * glm::vec4(Source.Position, 1.0f));
+					Target.Normal = glm::normalize(NormalMatrix * Source.Normal);
+				}
+				if (bLightmapped)
+				{
+					const std::vector<glm::vec2>& LightmapCoords = Mesh.GetLightmapCoords();
+					for (size_t Index = 0; Index < Mesh.GetVertices().size(); Index++)
+					{
+						const glm::vec2 Coords = Index < LightmapCoords.size() ? LightmapCoords[Index] : glm::vec2(0.0f);
+						Builder.LightmapCoords.push_back(Coords * glm::vec2(Region.x, Region.y) + glm::vec2(Region.z, Region.w));
+					}
+				}
+
+				// A mirroring transform turns the triangles inside out, their winding is flipped back
+				const std::vector<unsigned int>& Indices = Mesh.GetIndices();
+				for (size_t Index = 0; Index + 2 < Indices.size(); Index += 3)
+				{
+					Builder.Indices.push_back(BaseVertex + Indices[Index]);
+					Builder.Indices.push_back(BaseVertex + Indices[Index + (bMirrored ? 2 : 1)]);
+					Builder.Indices.push_back(BaseVertex + Indices[Index + (bMirrored ? 1 : 2)]);
+				}
+			}
+		}
+
+		m_Chunks.reserve(Builders.size());
+		for (auto& [Key, Builder] : Builders)
+		{
+			StaticChunk& Chunk = m_Chunks.emplace_back(StaticChunk{ BaseMesh(std::move(Builder.Vertices), std::move(Builder.Indices), {}, false), {} });
+			Chunk.Mesh.SetMaterial(Builder.ChunkMaterial);
+			if (Key[1] != 0)
+			{
+				Chunk.Mesh.SetLightmapCoords(std::move(Builder.LightmapCoords));
+				Chunk.Mesh.SetVertexFormat(VertexFormat::Lightmapped);
+			}
+			Chunk.Instance.Model = glm::mat4(1.0f);
+			Chunk.Instance.NormalMatrix = glm::mat3x4(glm::mat3(1.0f));
+			Chunk.Instance.TextureLayers = Builder.TextureLayers;
+			Chunk.Instance.MaterialIndex = Builder.ChunkMaterial ? Builder.ChunkMaterial->GetID() : 0;
+			Chunk.Instance.BoneOffset = 0;
+			Chunk.Instance.ReflectionProbe = Builder.ReflectionProbe;
+			Chunk.Instance.Payload = Builder.Payload;
+		}
+	}
+
+	void StaticGeometry::Clear()
+	{
+		m_Chunks.clear();
+		m_Revision = s_NextRevision++;
+	}
+
+	bool StaticGeometry::CanMerge(SceneObject& Object)
+	{
+		for (const BaseMesh& Mesh : Object.GetMeshes())
+		{
+			// Merging reads the vertices, which the mesh may have released after its upload
+			const std::shared_ptr<Material> MeshMaterial = Mesh.GetMaterial();
+			if (!Mesh.HasCPUGeometry() || Mesh.GetVertexFormat() == VertexFormat::Skinned || (MeshMaterial && MeshMaterial->GetBlendMode() == MaterialBlendMode::Transparent))
+				return false;
+		}
+		return !Object.IsSkybox() && !Object.GetMeshes().empty() && !Object.GetProceduralAnimation().IsAnimated();
+	}
+
+	std::vector<StaticChunk>& StaticGeometry::GetChunks()
+	{
+		return m_Chunks;
+	}
+
+	const std::vector<StaticChunk>& StaticGeometry::GetChunks() const
+	{
+		return m_Chunks;
+	}
+
+	uint64_t StaticGeometry::GetRevision() const
+	{
+		return m_Revision;
+	}
+
+} // namespace fgl
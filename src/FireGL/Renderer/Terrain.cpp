@@ -0,0 +1,549 @@
+#include <FireGL/Renderer/Terrain.h>
+#include <FireGL/Renderer/BaseCamera.h>
+#include <FireGL/Renderer/Texture.h>
+#include <FireGL/Renderer/VirtualTexture.h>
+#include <FireGL/Renderer/Material.h>
+#include <FireGL/Renderer/GLStateCache.h>
+#include <FireGL/Renderer/GPUMemoryTracker.h>
+#include <FireGL/Renderer/RenderStats.h>
+#include <FireGL/Core/Profiler.h>
+#include <FireGL/Core/BaseLog.h>
+
+#include <External/glm/geometric.hpp>
+
+namespace fgl
+{
+
+	namespace
+	{
+		// Heights of a patch, shared by the vertex and evaluation shaders. Sample 0 of a chunk is texel 1 of its layer
+		constexpr std::string_view HeightCode = R"(
+uniform sampler2DArray Heights;
+uniform float ChunkSize;
+uniform float TileSamples;
+uniform float HeightScale;
+uniform float BaseHeight;
+uniform float ChunkExtent;
+
+layout (std140) uniform CameraData
+{
+    mat4 View;
+    mat4 Projection;
+    mat4 ViewProjection;
+} Camera;
+
+float SampleHeight(vec2 UV, float Layer)
+{
+    vec2 TexCoord = (1.5 + UV * ChunkSize) / TileSamples;
+    return textureLod(Heights, vec3(TexCoord, Layer), 0.0).r * HeightScale + BaseHeight;
+}
+)";
+
+		constexpr std::string_view VertexCode = R"(
+layout (location = 0) in vec4 aPatch;
+
+out vec3 vPosition;
+out vec2 vUV;
+out vec4 vPatch;
+
+void main()
+{
+    // Corners (0, 0), (1, 0), (1, 1), (0, 1); the patch origin is in xy and its layer in z
+    vUV = vec2(gl_VertexID == 1 || gl_VertexID == 2, gl_VertexID >= 2);
+    vPatch = aPatch;
+    vPosition = vec3(aPatch.x + vUV.x * ChunkExtent, SampleHeight(vUV, aPatch.z), aPatch.y + vUV.y * ChunkExtent);
+})";
+
+		constexpr std::string_view TessControlCode = R"(#version 410 core
+layout (vertices = 4) out;
+
+layout (std140) uniform CameraData
+{
+    mat4 View;
+    mat4 Projection;
+    mat4 ViewProjection;
+} Camera;
+
+uniform float ViewportHeight;
+uniform float TriangleSize;
+uniform float MaxLevel;
+
+in vec3 vPosition[];
+in vec2 vUV[];
+in vec4 vPatch[];
+out vec2 tcUV[];
+out vec4 tcPatch[];
+
+// Segments of an edge so each spans TriangleSize pixels: its length projected at its midpoint.
+// Computed from the edge alone, the two patches sharing it agree on the result
+float EdgeLevel(vec3 A, vec3 B)
+{
+    vec4 Center = Camera.ViewProjection * vec4((A + B) * 0.5, 1.0);
+    float Pixels = distance(A, B) * Camera.Projection[1][1] * 0.5 * ViewportHeight / max(abs(Center.w), 1e-4);
+    return clamp(Pixels / TriangleSize, 1.0, MaxLevel);
+}
+
+void main()
+{
+    tcUV[gl_InvocationID] = vUV[gl_InvocationID];
+    tcPatch[gl_InvocationID] = vPatch[gl_InvocationID];
+    if (gl_InvocationID == 0)
+    {
+        // Outer levels: edges u = 0, v = 0, u = 1, v = 1
+        gl_TessLevelOuter[0] = EdgeLevel(vPosition[0], vPosition[3]);
+        gl_TessLevelOuter[1] = EdgeLevel(vPosition[0], vPosition[1]);
+        gl_TessLevelOuter[2] = EdgeLevel(vPosition[1], vPosition[2]);
+        gl_TessLevelOuter[3] = EdgeLevel(vPosition[3], vPosition[2]);
+        gl_TessLevelInner[0] = max(gl_TessLevelOuter[1], gl_TessLevelOuter[3]);
+        gl_TessLevelInner[1] = max(gl_TessLevelOuter[0], gl_TessLevelOuter[2]);
+    }
+})";
+
+		constexpr std::string_view TessEvaluationCode = R"(
+layout (quads, fractional_even_spacing) in;
+
+uniform float CellSize;
+
+in vec2 tcUV[];
+in vec4 tcPatch[];
+out vec3 WorldPosition;
+out vec3 Normal;
+
+void main()
+{
+    vec2 UV = gl_TessCoord.xy;
+    float Layer = tcPatch[0].z;
+    float Step = 1.0 / ChunkSize;
+
+    // Central differences over the neighbour samples, the layer's border holds the ones of the next chunks
+    float Left = SampleHeight(UV - vec2(Step, 0.0), Layer);
+    float Right = SampleHeight(UV + vec2(Step, 0.0), Layer);
+    float Back = SampleHeight(UV - vec2(0.0, Step), Layer);
+    float Front = SampleHeight(UV + vec2(0.0, Step), Layer);
+    Normal = normalize(vec3(Left - Right, 2.0 * CellSize, Back - Front));
+
+    WorldPosition = vec3(tcPatch[0].x + UV.x * ChunkExtent, SampleHeight(UV, Layer), tcPatch[0].y + UV.y * ChunkExtent);
+    gl_Position = Camera.ViewProjection * vec4(WorldPosition, 1.0);
+})";
+
+		constexpr std::string_view FragmentCode = R"(
+in vec3 WorldPosition;
+in vec3 Normal;
+out vec4 FragColor;
+
+struct DirLight
+{
+    vec4 Direction;
+    vec4 Ambient;
+    vec4 Diffuse;
+    vec4 Specular;
+};
+
+layout (std140) uniform LightData
+{
+    DirLight DirectionalLight;
+} Lights;
+
+uniform sampler2D Albedo;
+uniform bool bAlbedo;
+uniform bool bVirtual;
+uniform float TextureScale;
+uniform vec2 TerrainOrigin;
+uniform vec2 TerrainExtent;
+
+void main()
+{
+    // Without a texture, grass on the flat ground and rock on the slopes
+    vec3 N = normalize(Normal);
+    vec3 Color = bVirtual ? SampleVirtual((WorldPosition.xz - TerrainOrigin) / TerrainExtent).rgb
+        : bAlbedo ? texture(Albedo, WorldPosition.xz / TextureScale).rgb
+        : mix(vec3(0.30, 0.45, 0.18), vec3(0.42, 0.38, 0.33), smoothstep(0.15, 0.3, 1.0 - N.y));
+
+    vec3 LightDirection = normalize(-Lights.DirectionalLight.Direction.xyz);
+    vec3 Lighting = Lights.DirectionalLight.Ambient.rgb + Lights.DirectionalLight.Diffuse.rgb * max(dot(N, LightDirection), 0.0);
+    FragColor = vec4(Color * Lighting, 1.0);
+})";
+
+		// Same interface as the shading, the pages and levels the pixels of the virtual texture sample
+		constexpr std::string_view FeedbackCode = R"(
+in vec3 WorldPosition;
+in vec3 Normal;
+out vec4 FragColor;
+
+uniform vec2 TerrainOrigin;
+uniform vec2 TerrainExtent;
+
+void main()
+{
+    FragColor = VirtualFeedback((WorldPosition.xz - TerrainOrigin) / TerrainExtent);
+})";
+
+		constexpr std::string_view HeaderCode = R"(#version 410 core
+)";
+
+		std::string Concatenate(std::initializer_list<std::string_view> Parts)
+		{
+			std::string Code;
+			for (std::string_view Part : Parts)
+			{
+				Code += Part;
+			}
+			return Code;
+		}
+	}
+
+	Terrain::~Terrain()
+	{
+		Destroy();
+	}
+
+	void Terrain::Create(std::vector<float> Heights, int Width, int Depth, const TerrainSettings& Settings)
+	{
+		LOG_ASSERT(GLAD_GL_VERSION_4_0, "Terrain tessellation requires OpenGL 4.0")
+		LOG_ASSERT(Width >= 2 && Depth >= 2 && Heights.size() == static_cast<size_t>(Width) * Depth, "Terrain heights don't match their size")
+		LOG_ASSERT(Settings.ChunkSize > 0 && Settings.ChunkSize <= MaxChunkSize, "Terrain chunks span 1 to 64 cells")
+		Destroy();
+		m_Settings = Settings;
+		m_Heights = std::move(Heights);
+		m_Width = Width;
+		m_Depth = Depth;
+
+		// The last row and column of chunks may overhang the samples, they repeat the border heights
+		const int ChunkSize = m_Settings.ChunkSize;
+		const float ChunkExtent = ChunkSize * m_Settings.CellSize;
+		m_ChunksX = (Width - 1 + ChunkSize - 1) / ChunkSize;
+		m_ChunksZ = (Depth - 1 + ChunkSize - 1) / ChunkSize;
+		m_Chunks.resize(static_cast<size_t>(m_ChunksX) * m_ChunksZ);
+		for (int ChunkZ = 0; ChunkZ < m_ChunksZ; ChunkZ++)
+		{
+			for (int ChunkX = 0; ChunkX < m_ChunksX; ChunkX++)
+			{
+				float MinHeight = std::numeric_limits<float>::max();
+				float MaxHeight = std::numeric_limits<float>::lowest();
+				for (int Z = ChunkZ * ChunkSize; Z <= (ChunkZ + 1) * ChunkSize; Z++)
+				{
+					for (int X = ChunkX * ChunkSize; X <= (ChunkX + 1) * ChunkSize; X++)
+					{
+						MinHeight = std::min(MinHeight, GetSample(X, Z));
+						MaxHeight = std::max(MaxHeight, GetSample(X, Z));
+					}
+				}
+
+				const uint32_t Index = static_cast<uint32_t>(ChunkZ * m_ChunksX + ChunkX);
+				Chunk& Target = m_Chunks[Index];
+				Target.Bounds.Min = m_Settings.Origin + glm::vec3(ChunkX * ChunkExtent, MinHeight * m_Settings.HeightScale, ChunkZ * ChunkExtent);
+				Target.Bounds.Max = m_Settings.Origin + glm::vec3((ChunkX + 1) * ChunkExtent, MaxHeight * m_Settings.HeightScale, (ChunkZ + 1) * ChunkExtent);
+				m_ChunkTree.Insert(Index, Target.Bounds);
+			}
+		}
+
+		// One layer per resident chunk, its samples and a border of one sample around them
+		const int TileSamples = ChunkSize + 3;
+		glGenTextures(1, &m_HeightArray);
+		GLStateCache::BindTexture(GL_TEXTURE_2D_ARRAY, m_HeightArray);
+		glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_R32F, TileSamples, TileSamples, m_Settings.ResidentChunks, 0, GL_RED, GL_FLOAT, nullptr);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		GPUMemoryTracker::TrackTexture(m_HeightArray, GPUMemoryTracker::GetTextureSize(GL_R32F, TileSamples, TileSamples, m_Settings.ResidentChunks),
+			GPUMemoryCategory::Textures, "Terrain");
+		for (int32_t Layer = m_Settings.ResidentChunks - 1; Layer >= 0; Layer--)
+		{
+			m_FreeLayers.push_back(Layer);
+		}
+
+		m_Shader = Shader::CreateWithTessellationFromSource(Concatenate({ HeaderCode, HeightCode, VertexCode }), TessControlCode,
+			Concatenate({ HeaderCode, HeightCode, TessEvaluationCode }), Concatenate({ HeaderCode, VirtualTexture::GetShaderCode(), FragmentCode }));
+		m_FeedbackShader = Shader::CreateWithTessellationFromSource(Concatenate({ HeaderCode, HeightCode, VertexCode }), TessControlCode,
+			Concatenate({ HeaderCode, HeightCode, TessEvaluationCode }), Concatenate({ HeaderCode, VirtualTexture::GetShaderCode(), FeedbackCode }));
+		glGenBuffers(1, &m_PatchBuffer);
+		glGenVertexArrays(1, &m_VertexArray);
+		LOG_INFO("Created terrain of " + std::to_string(Width) + "x" + std::to_string(Depth) + " samples in " + std::to_string(m_Chunks.size()) + " chunks")
+	}
+
+	void Terrain::Destroy()
+	{
+		if (m_HeightArray != 0)
+		{
+			glDeleteTextures(1, &m_HeightArray);
+			GLStateCache::OnTextureDeleted(m_HeightArray);
+			GPUMemoryTracker::UntrackTexture(m_HeightArray);
+			m_HeightArray = 0;
+		}
+		if (m_PatchBuffer != 0)
+		{
+			glDeleteBuffers(1, &m_PatchBuffer);
+			GLStateCache::OnBufferDeleted(m_PatchBuffer);
+			GPUMemoryTracker::UntrackBuffer(m_PatchBuffer);
+			m_PatchBuffer = 0;
+			m_PatchCapacity = 0;
+		}
+		if (m_VertexArray != 0)
+		{
+			glDeleteVertexArrays(1, &m_VertexArray);
+			GLStateCache::OnVertexArrayDeleted(m_VertexArray);
+			m_VertexArray = 0;
+		}
+		if (m_Shader)
+		{
+			m_Shader->Cleanup();
+			m_Shader.reset();
+		}
+		if (m_FeedbackShader)
+		{
+			m_FeedbackShader->Cleanup();
+			m_FeedbackShader.reset();
+		}
+		m_Heights.clear();
+		m_Chunks.clear();
+		m_ChunkTree.Clear();
+		m_FreeLayers.clear();
+		m_ResidentChunks.clear();
+		m_Width = 0;
+		m_Depth = 0;
+		m_DrawnCount = 0;
+	}
+
+	bool Terrain::IsCreated() const
+	{
+		return m_HeightArray != 0;
+	}
+
+	void Terrain::SetTexture(const Texture* Albedo)
+	{
+		m_Albedo = Albedo;
+	}
+
+	void Terrain::SetVirtualTexture(VirtualTexture* Albedo)
+	{
+		m_VirtualTexture = Albedo;
+	}
+
+	float Terrain::GetSample(int X, int Z) const
+	{
+		X = std::clamp(X, 0, m_Width - 1);
+		Z = std::clamp(Z, 0, m_Depth - 1);
+		return m_Heights[static_cast<size_t>(Z) * m_Width + X];
+	}
+
+	float Terrain::GetHeight(float X, float Z) const
+	{
+		const float GridX = std::clamp((X - m_Settings.Origin.x) / m_Settings.CellSize, 0.0f, static_cast<float>(m_Width - 1));
+		const float GridZ = std::clamp((Z - m_Settings.Origin.z) / m_Settings.CellSize, 0.0f, static_cast<float>(m_Depth - 1));
+		const int X0 = static_cast<int>(GridX);
+		const int Z0 = static_cast<int>(GridZ);
+		const float FractionX = GridX - X0;
+		const float FractionZ = GridZ - Z0;
+
+		const float Back = GetSample(X0, Z0) + (GetSample(X0 + 1, Z0) - GetSample(X0, Z0)) * FractionX;
+		const float Front = GetSample(X0, Z0 + 1) + (GetSample(X0 + 1, Z0 + 1) - GetSample(X0, Z0 + 1)) * FractionX;
+		return (Back + (Front - Back) * FractionZ) * m_Settings.HeightScale + m_Settings.Origin.y;
+	}
+
+	float Terrain::GetDistance(const Chunk& Target, const glm::vec3& Position) const
+	{
+		const float DeltaX = std::max({ Target.Bounds.Min.x - Position.x, 0.0f, Position.x - Target.Bounds.Max.x });
+		const float DeltaZ = std::max({ Target.Bounds.Min.z - Position.z, 0.0f, Position.z - Target.Bounds.Max.z });
+		return std::sqrt(DeltaX * DeltaX + DeltaZ * DeltaZ);
+	}
+
+	void Terrain::StreamChunks(const glm::vec3& ViewPosition)
+	{
+		// Only the chunks of the square around the camera can be within the stream distance
+		const float ChunkExtent = m_Settings.ChunkSize * m_Settings.CellSize;
+		const glm::vec3 Local = ViewPosition - m_Settings.Origin;
+		const int FirstX = std::max(static_cast<int>(std::floor((Local.x - m_Settings.StreamDistance) / ChunkExtent)), 0);
+		const int LastX = std::min(static_cast<int>(std::floor((Local.x + m_Settings.StreamDistance) / ChunkExtent)), m_ChunksX - 1);
+		const int FirstZ = std::max(static_cast<int>(std::floor((Local.z - m_Settings.StreamDistance) / ChunkExtent)), 0);
+		const int LastZ = std::min(static_cast<int>(std::floor((Local.z + m_Settings.StreamDistance) / ChunkExtent)), m_ChunksZ - 1);
+
+		m_StreamCandidates.clear();
+		for (int ChunkZ = FirstZ; ChunkZ <= LastZ; ChunkZ++)
+		{
+			for (int ChunkX = FirstX; ChunkX <= LastX; ChunkX++)
+			{
+				const uint32_t Index = static_cast<uint32_t>(ChunkZ * m_ChunksX + ChunkX);
+				const float Distance = GetDistance(m_Chunks[Index], ViewPosition);
+				if (m_Chunks[Index].Layer < 0 && Distance <= m_Settings.StreamDistance)
+				{
+					m_StreamCandidates.emplace_back(Distance, Index);
+				}
+			}
+		}
+
+		// Closest first, a chunk is only evicted for a closer one
+		const size_t UploadCount = std::min(m_StreamCandidates.size(), static_cast<size_t>(std::max(m_Settings.UploadsPerFrame, 0)));
+		std::partial_sort(m_StreamCandidates.begin(), m_StreamCandidates.begin() + UploadCount, m_StreamCandidates.end());
+		for (size_t Candidate = 0; Candidate < UploadCount; Candidate++)
+		{
+			const auto [Distance, Index] = m_StreamCandidates[Candidate];
+			if (m_FreeLayers.empty())
+			{
+				size_t Farthest = 0;
+				float FarthestDistance = -1.0f;
+				for (size_t Resident = 0; Resident < m_ResidentChunks.size(); Resident++)
+				{
+					const float ResidentDistance = GetDistance(m_Chunks[m_ResidentChunks[Resident]], ViewPosition);
+					if (ResidentDistance > FarthestDistance)
+					{
+						Farthest = Resident;
+						FarthestDistance = ResidentDistance;
+					}
+				}
+				if (FarthestDistance <= Distance)
+					break;
+
+				Chunk& Evicted = m_Chunks[m_ResidentChunks[Farthest]];
+				m_FreeLayers.push_back(Evicted.Layer);
+				Evicted.Layer = -1;
+				m_ResidentChunks[Farthest] = m_ResidentChunks.back();
+				m_ResidentChunks.pop_back();
+			}
+
+			const int32_t Layer = m_FreeLayers.back();
+			m_FreeLayers.pop_back();
+			UploadChunk(Index, Layer);
+			m_Chunks[Index].Layer = Layer;
+			m_ResidentChunks.push_back(Index);
+		}
+	}
+
+	void Terrain::UploadChunk(uint32_t ChunkIndex, int32_t Layer)
+	{
+		const int ChunkSize = m_Settings.ChunkSize;
+		const int TileSamples = ChunkSize + 3;
+		const int FirstX = static_cast<int>(ChunkIndex % m_ChunksX) * ChunkSize - 1;
+		const int FirstZ = static_cast<int>(ChunkIndex / m_ChunksX) * ChunkSize - 1;
+
+		m_UploadScratch.resize(static_cast<size_t>(TileSamples) * TileSamples);
+		for (int Z = 0; Z < TileSamples; Z++)
+		{
+			for (int X = 0; X < TileSamples; X++)
+			{
+				m_UploadScratch[static_cast<size_t>(Z) * TileSamples + X] = GetSample(FirstX + X, FirstZ + Z);
+			}
+		}
+
+		GLStateCache::BindTexture(GL_TEXTURE_2D_ARRAY, m_HeightArray);
+		glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, Layer, TileSamples, TileSamples, 1, GL_RED, GL_FLOAT, m_UploadScratch.data());
+		RenderCounters::CountUpload(m_UploadScratch.size() * sizeof(float));
+	}
+
+	void Terrain::Render(const BaseCamera& Camera, float ViewportHeight)
+	{
+		if (!IsCreated())
+			return;
+
+		FGL_PROFILE_SCOPE("Terrain::Render")
+		const glm::vec3 ViewPosition = Camera.GetViewPosition();
+		StreamChunks(ViewPosition);
+
+		// The tree only reports candidates, the chunks' spheres are tested exactly
+		const Frustum ViewFrustum = Camera.GetFrustum();
+		m_VisibleChunks.clear();
+		m_ChunkTree.QueryFrustum(ViewFrustum, m_VisibleChunks);
+		m_PatchData.clear();
+		for (uint32_t Index : m_VisibleChunks)
+		{
+			const Chunk& Candidate = m_Chunks[Index];
+			if (Candidate.Layer < 0 || GetDistance(Candidate, ViewPosition) > m_Settings.StreamDistance)
+				continue;
+
+			const BoundingSphere Sphere{ Candidate.Bounds.GetCenter(), glm::length(Candidate.Bounds.Max - Candidate.Bounds.Min) * 0.5f };
+			if (ViewFrustum.IsVisible(Sphere))
+			{
+				m_PatchData.emplace_back(Candidate.Bounds.Min.x, Candidate.Bounds.Min.z, static_cast<float>(Candidate.Layer), 0.0f);
+			}
+		}
+		m_DrawnCount = static_cast<uint32_t>(m_PatchData.size());
+		if (m_PatchData.empty())
+			return;
+
+		const GLsizeiptr Size = static_cast<GLsizeiptr>(m_PatchData.size() * sizeof(glm::vec4));
+		GLStateCache::BindBuffer(GL_ARRAY_BUFFER, m_PatchBuffer);
+		if (m_PatchData.size() > m_PatchCapacity)
+		{
+			m_PatchCapacity = std::max(m_PatchData.size(), m_PatchCapacity * 2);
+			const GLsizeiptr Capacity = static_cast<GLsizeiptr>(m_PatchCapacity * sizeof(glm::vec4));
+			glBufferData(GL_ARRAY_BUFFER, Capacity, nullptr, GL_STREAM_DRAW);
+			GPUMemoryTracker::UntrackBuffer(m_PatchBuffer);
+			GPUMemoryTracker::TrackBuffer(m_PatchBuffer, Capacity, GPUMemoryCategory::Instances, "Terrain");
+
+			GLStateCache::BindVertexArray(m_VertexArray);
+			glEnableVertexAttribArray(0);
+			glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4), nullptr);
+			glVertexAttribDivisor(0, 1);
+		}
+		glBufferSubData(GL_ARRAY_BUFFER, 0, Size, m_PatchData.data());
+		RenderCounters::CountUpload(static_cast<size_t>(Size));
+
+		GLStateCache::BindTextureUnit(HeightUnit, GL_TEXTURE_2D_ARRAY, m_HeightArray);
+		if (m_Albedo)
+		{
+			GLStateCache::BindTextureUnit(AlbedoUnit, GL_TEXTURE_2D, m_Albedo->GetID());
+		}
+		const bool bVirtual = m_VirtualTexture && m_VirtualTexture->IsOpen();
+		m_Shader->Activate();
+		SetPatchUniforms(*m_Shader, ViewportHeight);
+		m_Shader->SetInt("Albedo", AlbedoUnit);
+		m_Shader->SetBool("bAlbedo", m_Albedo != nullptr);
+		m_Shader->SetBool("bVirtual", bVirtual);
+		m_Shader->SetFloat("TextureScale", m_Settings.TextureScale);
+		if (bVirtual)
+		{
+			m_VirtualTexture->Apply(*m_Shader, VirtualCacheUnit, VirtualIndirectionUnit);
+		}
+
+		GLStateCache::BindVertexArray(m_VertexArray);
+		glPatchParameteri(GL_PATCH_VERTICES, 4);
+		glDrawArraysInstanced(GL_PATCHES, 0, 4, static_cast<GLsizei>(m_PatchData.size()));
+
+		// Tessellated on the GPU, the triangles are counted at the lowest level
+		RenderCounters::CountDraw(m_PatchData.size(), m_PatchData.size() * 2);
+
+		// The same patches into the small feedback target, measured against the same viewport so they tessellate alike
+		if (bVirtual)
+		{
+			FGL_PROFILE_SCOPE("Terrain::Feedback")
+			m_VirtualTexture->BeginFeedback();
+			m_FeedbackShader->Activate();
+			SetPatchUniforms(*m_FeedbackShader, ViewportHeight);
+			m_VirtualTexture->Apply(*m_FeedbackShader, VirtualCacheUnit, VirtualIndirectionUnit);
+			glDrawArraysInstanced(GL_PATCHES, 0, 4, static_cast<GLsizei>(m_PatchData.size()));
+			m_VirtualTexture->EndFeedback();
+			RenderCounters::CountDraw(m_PatchData.size(), m_PatchData.size() * 2);
+		}
+		Material::InvalidateActiveMaterial();
+	}
+
+	void Terrain::SetPatchUniforms(const Shader& Target, float ViewportHeight) const
+	{
+		// The virtual texture samplers get their own units even unused, samplers of different types can't share one
+		Target.SetInt("Heights", HeightUnit);
+		Target.SetInt("VTCache", VirtualCacheUnit);
+		Target.SetInt("VTIndirection", VirtualIndirectionUnit);
+		Target.SetFloat("ChunkSize", static_cast<float>(m_Settings.ChunkSize));
+		Target.SetFloat("TileSamples", static_cast<float>(m_Settings.ChunkSize + 3));
+		Target.SetFloat("HeightScale", m_Settings.HeightScale);
+		Target.SetFloat("BaseHeight", m_Settings.Origin.y);
+		Target.SetFloat("ChunkExtent", m_Settings.ChunkSize * m_Settings.CellSize);
+		Target.SetFloat("CellSize", m_Settings.CellSize);
+		Target.SetFloat("ViewportHeight", ViewportHeight);
+		Target.SetFloat("TriangleSize", m_Settings.TriangleSize);
+		Target.SetFloat("MaxLevel", static_cast<float>(m_Settings.ChunkSize));
+		Target.SetVec2("TerrainOrigin", m_Settings.Origin.x, m_Settings.Origin.z);
+		Target.SetVec2("TerrainExtent", (m_Width - 1) * m_Settings.CellSize, (m_Depth - 1) * m_Settings.CellSize);
+	}
+
+	uint32_t Terrain::GetResidentCount() const
+	{
+		return static_cast<uint32_t>(m_ResidentChunks.size());
+	}
+
+	uint32_t Terrain::GetDrawnCount() const
+	{
+		return m_DrawnCount;
+	}
+
+} // namespace fgl
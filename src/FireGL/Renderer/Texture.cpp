@@ -1,45 +1,307 @@
 #include <FireGL/Renderer/Texture.h>
 #include <FireGL/Core/BaseLog.h>
+#include <FireGL/Core/Profiler.h>
+#include <FireGL/Core/StartupTimeline.h>
+#include <FireGL/Core/GLUploadThread.h>
+#include <FireGL/Core/AssetArchive.h>
+#include <FireGL/Core/MemoryTracker.h>
+#include <FireGL/Renderer/GLStateCache.h>
+#include <FireGL/Renderer/TextureContainer.h>
+#include <FireGL/Renderer/ImageDecoder.h>
+#include <FireGL/Renderer/PixelUploadPool.h>
+#include <FireGL/Renderer/GLExtensions.h>
+#include <FireGL/Renderer/GPUMemoryTracker.h>
+#include <FireGL/Renderer/MipGenerator.h>
+#include <FireGL/Renderer/OpenGLRenderDevice.h>
+#include <FireGL/Renderer/RenderStats.h>
+#include <FireGL/Renderer/Shader.h>
 
 #include <External/stb/stb_image.h>
 
+#include <atomic>
+#include <filesystem>
+#include <thread>
+
 namespace fgl
 {
 
+    namespace
+    {
+        constexpr GLint PanoramaUnit = 0; ///< Unit the panorama is bound to while converted to a CubeMap.
+
+        constexpr std::string_view PanoramaVertexCode = R"(#version 410 core
+void main()
+{
+    // vertices (0, 0), (2, 0) and (0, 2) cover the face
+    vec2 Corner = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    gl_Position = vec4(Corner * 2.0 - 1.0, 0.0, 1.0);
+})";
+
+        // Row 0 of a face is its t = 0 edge, so the face coordinates come straight from the fragment position
+        constexpr std::string_view PanoramaFragmentCode = R"(#version 410 core
+out vec4 FragColor;
+
+uniform sampler2D Panorama;
+uniform int Face;
+uniform float FaceSize;
+
+const float PI = 3.14159265359;
+
+void main()
+{
+    vec2 Coord = gl_FragCoord.xy / FaceSize * 2.0 - 1.0;
+    vec3 Direction;
+    if (Face == 0)      Direction = vec3(1.0, -Coord.y, -Coord.x);
+    else if (Face == 1) Direction = vec3(-1.0, -Coord.y, Coord.x);
+    else if (Face == 2) Direction = vec3(Coord.x, 1.0, Coord.y);
+    else if (Face == 3) Direction = vec3(Coord.x, -1.0, -Coord.y);
+    else if (Face == 4) Direction = vec3(Coord.x, -Coord.y, 1.0);
+    else                Direction = vec3(-Coord.x, -Coord.y, -1.0);
+    Direction = normalize(Direction);
+
+    // The panorama's top row is straight up
+    vec2 UV = vec2(atan(Direction.z, Direction.x) / (2.0 * PI) + 0.5, acos(clamp(Direction.y, -1.0, 1.0)) / PI);
+    FragColor = vec4(textureLod(Panorama, UV, 0.0).rgb, 1.0);
+})";
+
+        // Residency belongs to the OpenGL texture, not to the Texture views referencing it
+        std::unordered_map<GLuint, GLuint64> s_ResidentHandles;
+    }
+
     Texture::Texture()
-        : m_ID(0), m_SlotIndex(0)
+        : m_SlotIndex(0)
     {
     }
 
     void Texture::Activate() const
     {
-        glActiveTexture(GL_TEXTURE0 + m_SlotIndex);
-        glBindTexture(m_TextureTarget, m_ID);
+        // The sampler is resolved on the first bind, textures may be set up on loading threads
+        RenderDevice& Device = RenderDevice::Get();
+        if (!m_SamplerHandle)
+        {
+            m_SamplerHandle = Device.GetSampler(m_Sampler);
+        }
+        Device.BindTexture(static_cast<uint32_t>(m_SlotIndex), m_Handle, m_SamplerHandle);
     }
 
-    void Texture::Cleanup() const
+    Texture::~Texture()
     {
-        glDeleteTextures(1, &m_ID);
+        Cleanup();
     }
 
-    bool Texture::LoadTexture(std::string_view Path, GLenum WrapS, GLenum WrapT, GLenum MinFilter, GLenum MagFilter, bool FlipVertical)
+    Texture::Texture(Texture&& Other) noexcept
+        : m_Handle(std::exchange(Other.m_Handle, TextureHandle())), m_Name(Other.m_Name), m_Path(Other.m_Path),
+          m_SlotIndex(Other.m_SlotIndex), m_Sampler(Other.m_Sampler), m_SamplerHandle(Other.m_SamplerHandle),
+          m_FlipVertical(Other.m_FlipVertical), m_bOwnsID(std::exchange(Other.m_bOwnsID, false))
+    {
+    }
+
+    Texture& Texture::operator=(Texture&& Other) noexcept
     {
-        m_TextureTarget = GL_TEXTURE_2D;
-        m_Path = Path;
+        if (this != &Other)
+        {
+            Cleanup();
+            m_Handle = std::exchange(Other.m_Handle, TextureHandle());
+            m_Name = Other.m_Name;
+            m_Path = Other.m_Path;
+            m_SlotIndex = Other.m_SlotIndex;
+            m_Sampler = Other.m_Sampler;
+            m_SamplerHandle = Other.m_SamplerHandle;
+            m_FlipVertical = Other.m_FlipVertical;
+            m_bOwnsID = std::exchange(Other.m_bOwnsID, false);
+        }
+        return *this;
+    }
 
-        stbi_set_flip_vertically_on_load(FlipVertical);
-        glGenTextures(1, &m_ID);
-        glBindTexture(GL_TEXTURE_2D, m_ID);
+    Texture Texture::CreateView() const
+    {
+        Texture View;
+        View.m_Handle = m_Handle;
+        View.m_Name = m_Name;
+        View.m_Path = m_Path;
+        View.m_SlotIndex = m_SlotIndex;
+        View.m_Sampler = m_Sampler;
+        View.m_SamplerHandle = m_SamplerHandle;
+        View.m_FlipVertical = m_FlipVertical;
+        return View;
+    }
 
-        if (!LoadTextureFromFile(Path))
+    void Texture::Cleanup()
+    {
+        if (m_bOwnsID)
+        {
+            Delete(m_Handle.ID);
+        }
+        m_Handle.ID = 0;
+        m_bOwnsID = false;
+    }
+
+    void Texture::Delete(GLuint ID)
+    {
+        if (ID == 0)
+            return;
+
+        auto Resident = s_ResidentHandles.find(ID);
+        if (Resident != s_ResidentHandles.end())
         {
-            HandleTextureLoadingFailure();
+            GLExtensions::MakeTextureHandleNonResident(Resident->second);
+            s_ResidentHandles.erase(Resident);
+        }
+
+        TextureHandle Handle;
+        Handle.ID = ID;
+        RenderDevice::Get().DestroyTexture(Handle);
+    }
+
+    GLuint Texture::ReleaseOwnership()
+    {
+        m_bOwnsID = false;
+        return m_Handle.ID;
+    }
+
+    bool Texture::IsOwner() const
+    {
+        return m_bOwnsID;
+    }
+
+    void Texture::GenerateID(TextureType Type)
+    {
+        Cleanup();
+        m_Handle = TextureHandle();
+        m_Handle.Type = Type;
+        glGenTextures(1, &m_Handle.ID);
+        m_bOwnsID = true;
+    }
+
+    void Texture::Adopt(const TextureHandle& Handle)
+    {
+        Cleanup();
+        m_Handle = Handle;
+        m_bOwnsID = true;
+    }
+
+    uint64_t Texture::GetBindlessHandle() const
+    {
+        if (m_Handle.ID == 0)
+            return 0;
+
+        auto [Resident, bInserted] = s_ResidentHandles.try_emplace(m_Handle.ID, 0);
+        if (bInserted)
+        {
+            Resident->second = GLExtensions::GetTextureHandle(m_Handle.ID);
+            GLExtensions::MakeTextureHandleResident(Resident->second);
+        }
+        return Resident->second;
+    }
+
+    bool Texture::LoadTexture(std::string_view Path, GLenum WrapS, GLenum WrapT, GLenum MinFilter, GLenum MagFilter, bool FlipVertical)
+    {
+        m_Handle.Type = TextureType::Texture2D;
+        m_Path = Symbol(Path);
+
+        const uint64_t Start = Profiler::Now();
+        ImageData Image;
+        if (!DecodeImage(Path, FlipVertical, Image))
+        {
+            LOG_ERROR("Failed to load texture at path: " + m_Path.GetString(), false);
             return false;
         }
+        const uint64_t Decoded = Profiler::Now();
+        const bool bUploaded = UploadImage(Image, WrapS, WrapT, MinFilter, MagFilter);
+        if (StartupTimeline::IsRecording())
+        {
+            StartupTimeline::Record("Texture", Path, StartupTimeline::FileSize(Path), Start, Decoded, Profiler::Now());
+        }
+        return bUploaded;
+    }
+
+    bool Texture::ReadContainer(std::string_view Path, ImageData& Image)
+    {
+        // Archived files are read from the mapping or decompressed on this thread. Containers keep pointing
+        // into the blob: the aliasing pointer owns its decompressed storage, or views the mapping until unmounted
+        AssetArchive::Blob Packed;
+        if (!AssetArchive::Read(Path, Packed))
+            return TextureContainer::Load(Path, Image);
+
+        std::shared_ptr<unsigned char> View(Packed.Storage, const_cast<unsigned char*>(Packed.Data.data()));
+        return TextureContainer::Parse(std::move(View), Packed.Data.size(), Image, Path);
+    }
+
+    bool Texture::DecodeImage(std::string_view Path, bool FlipVertical, ImageData& Image)
+    {
+        if (TextureContainer::IsContainer(Path))
+        {
+            if (!ReadContainer(Path, Image))
+                return false;
+
+            if (Image.FaceCount != 1)
+            {
+                LOG_ERROR("The texture " + std::string(Path) + " is a cube map, load it with LoadCubeMap.", false);
+                Image = ImageData();
+                return false;
+            }
+            return true;
+        }
+
+        // JPEG and PNG go to the fastest decoder built in, the rest to stb_image
+        AssetArchive::Blob Packed;
+        if (AssetArchive::Read(Path, Packed))
+            return ImageDecoder::Decode(Packed.Data, FlipVertical, Image);
+
+        return ImageDecoder::DecodeFile(Path, FlipVertical, Image);
+    }
+
+    bool Texture::UploadImage(const ImageData& Image, GLenum WrapS, GLenum WrapT, GLenum MinFilter, GLenum MagFilter)
+    {
+        if (!IsUploadable(Image))
+            return false;
 
-        SetupTextureParameters(WrapS, WrapT, MinFilter, MagFilter);
-        glGenerateMipmap(GL_TEXTURE_2D);
-        glBindTexture(GL_TEXTURE_2D, 0);
+        const SamplerState Sampler{ WrapS, WrapT, GL_REPEAT, MinFilter, MagFilter };
+        Adopt(RenderDevice::Get().CreateImageTexture(Image, { Sampler, 0, GPUMemoryCategory::Textures, m_Path.IsEmpty() ? "Texture" : m_Path.GetString() }));
+        SetSampler(Sampler);
+        return true;
+    }
+
+    uint64_t Texture::UploadImageAsync(GLUploadThread& Thread, const ImageData& Image, GLenum WrapS, GLenum WrapT, GLenum MinFilter, GLenum MagFilter)
+    {
+        if (!IsUploadable(Image))
+            return 0;
+
+        // Names belong to the share group: the texture has its final ID before the upload thread creates it.
+        // The shared context has no RenderDevice, the upload thread calls OpenGL itself
+        const SamplerState Sampler{ WrapS, WrapT, GL_REPEAT, MinFilter, MagFilter };
+        GenerateID(TextureType::Texture2D);
+        SetSampler(Sampler);
+        GPUMemoryTracker::TrackTexture(m_Handle.ID, OpenGLRenderDevice::GetImageStorageSize(Image, 0), GPUMemoryCategory::Textures,
+            m_Path.IsEmpty() ? "Texture" : m_Path.GetString());
+
+        const GLuint ID = m_Handle.ID;
+        return Thread.Enqueue([ID, Image, Sampler]()
+            {
+                // The shared context has no state cache, its bindings are only set here
+                glBindTexture(GL_TEXTURE_2D, ID);
+                OpenGLRenderDevice::UploadImagePixels(Image, GL_TEXTURE_2D, 0, false);
+                OpenGLRenderDevice::SetTextureParameters(GL_TEXTURE_2D, Sampler);
+                if (Image.CompressedFormat != 0)
+                {
+                    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(Image.Levels.size()) - 1);
+                }
+                else
+                {
+                    glGenerateMipmap(GL_TEXTURE_2D);
+                }
+                glBindTexture(GL_TEXTURE_2D, 0);
+            });
+    }
+
+    bool Texture::UploadMipRange(const ImageData& Image, int BaseLevel, GLenum WrapS, GLenum WrapT, GLenum MinFilter, GLenum MagFilter)
+    {
+        if (!Image.Pixels || (Image.CompressedFormat != 0 && BaseLevel >= static_cast<int>(Image.Levels.size())))
+            return false;
+
+        const SamplerState Sampler{ WrapS, WrapT, GL_REPEAT, MinFilter, MagFilter };
+        Adopt(RenderDevice::Get().CreateImageTexture(Image, { Sampler, BaseLevel, GPUMemoryCategory::Textures, m_Path.IsEmpty() ? "Texture" : m_Path.GetString() }));
+        SetSampler(Sampler);
         return true;
     }
 
@@ -50,92 +312,353 @@ namespace fgl
             LOG_ERROR("CubeMap loading failed: Expected 6 faces, but received " + std::to_string(PathToFaces.size()) + ".", true)
             return false;
         }
-        m_Path = PathToFaces[0];  // Just for logging purposes
-        m_TextureTarget = GL_TEXTURE_CUBE_MAP;
+        m_Path = Symbol(PathToFaces[0]);  // Just for logging purposes
+        m_Handle.Type = TextureType::CubeMap;
+        m_FlipVertical = FlipVertical;
 
-        stbi_set_flip_vertically_on_load(FlipVertical);
-        glGenTextures(1, &m_ID);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, m_ID);
+        // stb_image is reentrant, the six faces are decoded at once, each thread claiming the next face
+        const uint64_t Start = Profiler::Now();
+        std::array<ImageData, 6> Faces;
+        std::atomic<size_t> NextFace = 0;
+        auto DecodeLoop = [&]() {
+            for (size_t i = NextFace++; i < Faces.size(); i = NextFace++)
+            {
+                DecodeImage(PathToFaces[i], m_FlipVertical, Faces[i]);
+            }
+        };
 
+        const size_t ThreadCount = std::min<size_t>(std::max<size_t>(std::thread::hardware_concurrency(), 1), Faces.size());
+        std::vector<std::thread> Threads;
+        Threads.reserve(ThreadCount - 1);
+        for (size_t i = 1; i < ThreadCount; i++)
+        {
+            Threads.emplace_back(DecodeLoop);
+        }
+        DecodeLoop();
+        for (std::thread& Thread : Threads)
+        {
+            Thread.join();
+        }
+        const uint64_t Decoded = Profiler::Now();
 
-        for (int i = 0; i < PathToFaces.size(); ++i)
+        // Every face is checked before the device creates the texture, which takes them as given
+        uint64_t BytesRead = 0;
+        for (size_t i = 0; i < Faces.size(); ++i)
         {
-            if (!LoadTextureFromFile(PathToFaces[i], GL_TEXTURE_CUBE_MAP_POSITIVE_X + i))
+            if (!Faces[i].Pixels || Faces[i].CompressedFormat != 0)
             {
+                m_Path = Symbol(PathToFaces[i]);
                 HandleTextureLoadingFailure();
                 return false;
             }
+            BytesRead += StartupTimeline::FileSize(PathToFaces[i]);
         }
-        
-        SetupCubeMapParameters(MinFilter, MagFilter);
+
+        const SamplerState Sampler = GetCubeMapSampler(MinFilter, MagFilter);
+        Adopt(RenderDevice::Get().CreateCubeTexture(Faces, { Sampler, 0, GPUMemoryCategory::Textures, m_Path.GetString() }));
+        SetSampler(Sampler);
+        StartupTimeline::Record("CubeMap", m_Path.GetString(), BytesRead, Start, Decoded, Profiler::Now());
+        return true;
+    }
+
+    bool Texture::LoadCubeMap(std::string_view Path, GLenum MinFilter, GLenum MagFilter, int FaceSize)
+    {
+        m_Path = Symbol(Path);
+        m_Handle.Type = TextureType::CubeMap;
+
+        std::string Extension = std::filesystem::path(Path).extension().string();
+        std::transform(Extension.begin(), Extension.end(), Extension.begin(), [](unsigned char C) { return static_cast<char>(std::tolower(C)); });
+        if (Extension == ".hdr")
+        {
+            const uint64_t Start = Profiler::Now();
+            GenerateID(TextureType::CubeMap);
+            if (!ConvertEquirectangular(Path, FaceSize))
+            {
+                HandleTextureLoadingFailure();
+                return false;
+            }
+            const SamplerState Sampler = GetCubeMapSampler(MinFilter, MagFilter);
+            GLStateCache::BindTexture(GL_TEXTURE_CUBE_MAP, m_Handle.ID);
+            OpenGLRenderDevice::SetTextureParameters(GL_TEXTURE_CUBE_MAP, Sampler);
+            GLStateCache::BindTexture(GL_TEXTURE_CUBE_MAP, 0);
+            SetSampler(Sampler);
+            StartupTimeline::Record("CubeMap", m_Path.GetString(), StartupTimeline::FileSize(Path), Start, Start, Profiler::Now());
+            return true;
+        }
+
+        const uint64_t Start = Profiler::Now();
+        ImageData Image;
+        if (!TextureContainer::IsContainer(Path) || !ReadContainer(Path, Image) || Image.FaceCount != 6 || !IsUploadable(Image))
+        {
+            LOG_ERROR("CubeMap loading failed: " + std::string(Path) + " isn't a DDS or KTX2 cube map, or an .hdr panorama.", false);
+            return false;
+        }
+        const uint64_t Decoded = Profiler::Now();
+
+        // The prebuilt chain holds the prefiltered levels, the device keeps them rather than generating mipmaps
+        const SamplerState Sampler = GetCubeMapSampler(MinFilter, MagFilter);
+        Adopt(RenderDevice::Get().CreateImageTexture(Image, { Sampler, 0, GPUMemoryCategory::Textures, m_Path.GetString() }));
+        SetSampler(Sampler);
+        StartupTimeline::Record("CubeMap", m_Path.GetString(), StartupTimeline::FileSize(Path), Start, Decoded, Profiler::Now());
         return true;
     }
 
-    void Texture::SetupTextureParameters(GLenum WrapS, GLenum WrapT, GLenum MinFilter, GLenum MagFilter)
+    bool Texture::ConvertEquirectangular(std::string_view Path, int FaceSize)
     {
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, WrapS);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, WrapT);
+        // Decoded as floats, HDR skies exceed the 8-bit range by far
+        AssetArchive::Blob Packed;
+        int Width = 0, Height = 0, Channels = 0;
+        stbi_set_flip_vertically_on_load_thread(false);
+        float* Pixels = AssetArchive::Read(Path, Packed)
+            ? stbi_loadf_from_memory(Packed.Data.data(), static_cast<int>(Packed.Data.size()), &Width, &Height, &Channels, 3)
+            : stbi_loadf(std::string(Path).c_str(), &Width, &Height, &Channels, 3);
+        if (!Pixels)
+            return false;
+
+        GLuint Panorama = 0;
+        glGenTextures(1, &Panorama);
+        GLStateCache::BindTexture(GL_TEXTURE_2D, Panorama);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, Width, Height, 0, GL_RGB, GL_FLOAT, Pixels);
+        stbi_image_free(Pixels);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+        FaceSize = FaceSize > 0 ? FaceSize : std::max(Width / 4, 1);
+        GLStateCache::BindTexture(GL_TEXTURE_CUBE_MAP, m_Handle.ID);
+        if (GLExtensions::HasTextureStorage())
+        {
+            GLExtensions::TexStorage2D(GL_TEXTURE_CUBE_MAP, GPUMemoryTracker::GetMipLevelCount(FaceSize, FaceSize), GL_RGB16F, FaceSize, FaceSize);
+        }
+        else
+        {
+            for (int Face = 0; Face < 6; Face++)
+            {
+                glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + Face, 0, GL_RGB16F, FaceSize, FaceSize, 0, GL_RGB, GL_FLOAT, nullptr);
+            }
+        }
+
+        GLint Viewport[4];
+        GLint PolygonMode[2];
+        GLint DrawFramebuffer = 0;
+        glGetIntegerv(GL_VIEWPORT, Viewport);
+        glGetIntegerv(GL_POLYGON_MODE, PolygonMode);
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &DrawFramebuffer);
+        const GLboolean bDepthTest = glIsEnabled(GL_DEPTH_TEST);
+        const GLboolean bBlend = glIsEnabled(GL_BLEND);
+
+        // Loaded once per sky, the program and framebuffer don't outlive the conversion
+        std::unique_ptr<Shader> Converter = Shader::CreateFromSource(PanoramaVertexCode, PanoramaFragmentCode);
+        GLuint Framebuffer = 0;
+        GLuint VertexArray = 0;
+        glGenFramebuffers(1, &Framebuffer);
+        glGenVertexArrays(1, &VertexArray);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, Framebuffer);
+        glViewport(0, 0, FaceSize, FaceSize);
+        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+        glDisable(GL_DEPTH_TEST);
+        glDisable(GL_BLEND);
 
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, MinFilter);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, MagFilter);
+        GLStateCache::BindTextureUnit(PanoramaUnit, GL_TEXTURE_2D, Panorama);
+        GLStateCache::BindVertexArray(VertexArray);
+        Converter->Activate();
+        Converter->SetInt("Panorama", PanoramaUnit);
+        Converter->SetFloat("FaceSize", static_cast<float>(FaceSize));
+        for (int Face = 0; Face < 6; Face++)
+        {
+            glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + Face, m_Handle.ID, 0);
+            Converter->SetInt("Face", Face);
+            glDrawArrays(GL_TRIANGLES, 0, 3);
+            RenderCounters::CountDraw(1, 1);
+        }
+
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, DrawFramebuffer);
+        glViewport(Viewport[0], Viewport[1], Viewport[2], Viewport[3]);
+        glPolygonMode(GL_FRONT_AND_BACK, static_cast<GLenum>(PolygonMode[0]));
+        if (bDepthTest)
+        {
+            glEnable(GL_DEPTH_TEST);
+        }
+        if (bBlend)
+        {
+            glEnable(GL_BLEND);
+        }
+        GLStateCache::BindVertexArray(0);
+        glDeleteVertexArrays(1, &VertexArray);
+        glDeleteFramebuffers(1, &Framebuffer);
+        GLStateCache::BindTextureUnit(PanoramaUnit, GL_TEXTURE_2D, 0);
+        glDeleteTextures(1, &Panorama);
+        GLStateCache::OnTextureDeleted(Panorama);
+
+        GLStateCache::BindTexture(GL_TEXTURE_CUBE_MAP, m_Handle.ID);
+        glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
+        GLStateCache::BindTexture(GL_TEXTURE_CUBE_MAP, 0);
+        m_Handle.Width = static_cast<uint32_t>(FaceSize);
+        m_Handle.Height = static_cast<uint32_t>(FaceSize);
+        m_Handle.Format = TextureFormat::RGBA16F;
+        GPUMemoryTracker::TrackTexture(m_Handle.ID, GPUMemoryTracker::GetTextureSize(GL_RGB16F, FaceSize, FaceSize, 6, GPUMemoryTracker::GetMipLevelCount(FaceSize, FaceSize)),
+            GPUMemoryCategory::Textures, m_Path.GetString());
+        return true;
     }
 
-    void Texture::SetupCubeMapParameters(GLenum MinFilter, GLenum MagFilter)
+    bool Texture::CreateArray(int Width, int Height, int LayerCount, GLenum InternalFormat, int LevelCount, GLenum MinFilter, GLenum MagFilter)
     {
-        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, MinFilter);
-        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, MagFilter);
+        const bool bCompressed = InternalFormat != GL_RGB8 && InternalFormat != GL_RGBA8;
+        if (bCompressed && !TextureContainer::IsFormatSupported(InternalFormat))
+        {
+            LOG_ERROR("Compressed texture format " + std::to_string(InternalFormat) + " isn't supported by this OpenGL context.", false);
+            return false;
+        }
+
+        // Arrays are filled layer by layer from the streaming pools, they stay on OpenGL until the device takes layers
+        GenerateID(TextureType::Array2D);
+        m_Handle.Width = static_cast<uint32_t>(Width);
+        m_Handle.Height = static_cast<uint32_t>(Height);
+        GLStateCache::BindTexture(GL_TEXTURE_2D_ARRAY, m_Handle.ID);
+        if (GLAD_GL_VERSION_4_2)
+        {
+            glTexStorage3D(GL_TEXTURE_2D_ARRAY, LevelCount, InternalFormat, Width, Height, LayerCount);
+        }
+        else
+        {
+            // Mutable storage has to be specified level by level
+            const GLenum Format = InternalFormat == GL_RGB8 ? GL_RGB : GL_RGBA;
+            for (int Level = 0; Level < LevelCount; Level++)
+            {
+                const int LevelWidth = std::max(Width >> Level, 1);
+                const int LevelHeight = std::max(Height >> Level, 1);
+                if (bCompressed)
+                {
+                    const size_t LayerSize = TextureContainer::GetLevelSize(InternalFormat, LevelWidth, LevelHeight);
+                    glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, Level, InternalFormat, LevelWidth, LevelHeight, LayerCount, 0,
+                        static_cast<GLsizei>(LayerSize * LayerCount), nullptr);
+                }
+                else
+                {
+                    glTexImage3D(GL_TEXTURE_2D_ARRAY, Level, InternalFormat, LevelWidth, LevelHeight, LayerCount, 0, Format, GL_UNSIGNED_BYTE, nullptr);
+                }
+            }
+        }
 
-        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, MinFilter);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, MagFilter);
+        SetSampler({ GL_REPEAT, GL_REPEAT, GL_REPEAT, MinFilter, MagFilter });
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, LevelCount - 1);
+        GLStateCache::BindTexture(GL_TEXTURE_2D_ARRAY, 0);
+        GPUMemoryTracker::TrackTexture(m_Handle.ID, GPUMemoryTracker::GetTextureSize(InternalFormat, Width, Height, LayerCount, LevelCount),
+            GPUMemoryCategory::Textures, "TextureArrayPool");
+        return true;
     }
 
-    bool Texture::LoadTextureFromFile(std::string_view Path, GLenum Target)
+    void Texture::UploadLayer(int Layer, const ImageData& Image)
     {
-        int Width, Height, ChannelNr;
-        unsigned char* Data = stbi_load(Path.data(), &Width, &Height, &ChannelNr, 0);
-        if (Data)
+        if (!Image.Pixels)
+            return;
+
+        GLStateCache::BindTexture(GL_TEXTURE_2D_ARRAY, m_Handle.ID);
+        if (Image.CompressedFormat != 0)
         {
-            GLenum Format = (ChannelNr == 3) ? GL_RGB : GL_RGBA;
-            if (Target == GL_TEXTURE_2D)
+            size_t Begin = SIZE_MAX, End = 0;
+            for (const ImageData::Level& Mip : Image.Levels)
             {
-                glTexImage2D(GL_TEXTURE_2D, 0, Format, Width, Height, 0, Format, GL_UNSIGNED_BYTE, Data);
+                Begin = std::min(Begin, Mip.Offset);
+                End = std::max(End, Mip.Offset + Mip.Size);
             }
-            else
+
+            const unsigned char* Source = static_cast<const unsigned char*>(PixelUploadPool::Stage(Image.Pixels.get() + Begin, End - Begin));
+            for (size_t Level = 0; Level < Image.Levels.size(); Level++)
             {
-                glTexImage2D(Target, 0, Format, Width, Height, 0, Format, GL_UNSIGNED_BYTE, Data);
+                const ImageData::Level& Mip = Image.Levels[Level];
+                glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, static_cast<GLint>(Level), 0, 0, Layer, Mip.Width, Mip.Height, 1,
+                    Image.CompressedFormat, static_cast<GLsizei>(Mip.Size), Source + (Mip.Offset - Begin));
             }
-            stbi_image_free(Data);
-            return true;
         }
         else
         {
-            stbi_image_free(Data);
+            const GLenum Format = (Image.Channels == 3) ? GL_RGB : GL_RGBA;
+            const size_t Size = static_cast<size_t>(Image.Width) * Image.Height * Image.Channels;
+            const void* Source = PixelUploadPool::Stage(Image.Pixels.get(), Size);
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, Layer, Image.Width, Image.Height, 1, Format, GL_UNSIGNED_BYTE, Source);
+        }
+        PixelUploadPool::EndUpload();
+        GLStateCache::BindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    }
+
+    void Texture::GenerateMipmaps()
+    {
+        const GLenum Target = GetTarget();
+        MipGenerator::Generate(m_Handle.ID, Target);
+        GLStateCache::BindTexture(Target, 0);
+    }
+
+    SamplerState Texture::GetCubeMapSampler(GLenum MinFilter, GLenum MagFilter)
+    {
+        return { GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE, MinFilter, MagFilter };
+    }
+
+    bool Texture::IsUploadable(const ImageData& Image)
+    {
+        if (!Image.Pixels)
+            return false;
+
+        if (Image.CompressedFormat != 0 && !TextureContainer::IsFormatSupported(Image.CompressedFormat))
+        {
+            LOG_ERROR("Compressed texture format " + std::to_string(Image.CompressedFormat) + " isn't supported by this OpenGL context.", false);
             return false;
         }
+        return true;
     }
 
     void Texture::HandleTextureLoadingFailure()
     {
-        LOG_ERROR("Failed to load texture at path: " + std::string(m_Path), false);
-        glBindTexture(GL_TEXTURE_2D, 0);
+        LOG_ERROR("Failed to load texture at path: " + m_Path.GetString(), false);
+        GLStateCache::BindTexture(GetTarget(), 0);
     }
 
     unsigned int Texture::GetID() const 
     {
-        return m_ID;
+        return m_Handle.ID;
+    }
+
+    GLenum Texture::GetTarget() const
+    {
+        return OpenGLRenderDevice::GetTarget(m_Handle.Type);
+    }
+
+    const TextureHandle& Texture::GetHandle() const
+    {
+        return m_Handle;
     }
 
-    std::string Texture::GetName() const 
+    const std::string& Texture::GetName() const 
+    {
+        return m_Name.GetString();
+    }
+
+    const std::string& Texture::GetPath() const 
+    {
+        return m_Path.GetString();
+    }
+
+    Symbol Texture::GetNameSymbol() const
     {
         return m_Name;
     }
 
-    std::string Texture::GetPath() const 
+    Symbol Texture::GetPathSymbol() const
     {
         return m_Path;
     }
 
+    const SamplerState& Texture::GetSampler() const
+    {
+        return m_Sampler;
+    }
+
     int8_t Texture::GetSlotIndex() const 
     {
         return m_SlotIndex;
@@ -143,17 +666,18 @@ namespace fgl
 
     void Texture::SetID(unsigned int ID)
     {
-        m_ID = ID;
+        Cleanup();
+        m_Handle.ID = ID;
     }
 
     void Texture::SetName(std::string_view Name)
     {
-        m_Name = Name;
+        m_Name = Symbol(Name);
     }
 
     void Texture::SetPath(std::string_view Path)
     {
-        m_Path = Path;
+        m_Path = Symbol(Path);
     }
 
     void Texture::SetSlotIndex(int8_t SlotIndex)
@@ -161,4 +685,13 @@ namespace fgl
         m_SlotIndex = SlotIndex;
     }
 
+    void Texture::SetSampler(const SamplerState& State)
+    {
+        if (m_Sampler == State)
+            return;
+
+        m_Sampler = State;
+        m_SamplerHandle = SamplerHandle();
+    }
+
 } // namespace fgl
\ No newline at end of file
@@ -0,0 +1,101 @@
+#include <FireGL/Renderer/TextureArrayPool.h>
+#include <FireGL/Core/BaseLog.h>
+
+namespace fgl
+{
+
+	TextureArrayPool::TextureArrayPool(int LayersPerArray)
+		: m_LayersPerArray(std::max(LayersPerArray, 1))
+	{
+	}
+
+	TextureArrayPool::~TextureArrayPool()
+	{
+		for (PoolArray& Array : m_Arrays)
+		{
+			Array.Array->Cleanup();
+		}
+	}
+
+	TextureArrayLayer TextureArrayPool::AddImage(const ImageData& Image)
+	{
+		const ArrayClass Class = GetClass(Image);
+		if (Class.InternalFormat == 0)
+		{
+			LOG_ERROR("Texture arrays only store RGB, RGBA or compressed images.", false);
+			return TextureArrayLayer();
+		}
+
+		// The last array of a class is the only one with free layers
+		PoolArray* Target = nullptr;
+		for (auto It = m_Arrays.rbegin(); It != m_Arrays.rend(); ++It)
+		{
+			if (It->Class == Class)
+			{
+				Target = It->UsedLayers < m_LayersPerArray ? &*It : nullptr;
+				break;
+			}
+		}
+
+		if (!Target)
+		{
+			std::unique_ptr<Texture> Array = std::make_unique<Texture>();
+			if (!Array->CreateArray(Class.Width, Class.Height, m_LayersPerArray, Class.InternalFormat, Class.LevelCount))
+				return TextureArrayLayer();
+
+			Target = &m_Arrays.emplace_back(PoolArray{ Class, std::move(Array) });
+		}
+
+		const int Layer = Target->UsedLayers++;
+		Target->Array->UploadLayer(Layer, Image);
+		Target->bMipmapsDirty = Image.CompressedFormat == 0 && Class.LevelCount > 1;
+		return { Target->Array.get(), static_cast<uint32_t>(Layer) };
+	}
+
+	TextureArrayLayer TextureArrayPool::LoadImage(std::string_view Path, bool FlipVertical)
+	{
+		ImageData Image;
+		if (!Texture::DecodeImage(Path, FlipVertical, Image))
+		{
+			LOG_ERROR("Failed to load texture at path: " + std::string(Path), false);
+			return TextureArrayLayer();
+		}
+		return AddImage(Image);
+	}
+
+	void TextureArrayPool::GenerateMipmaps()
+	{
+		for (PoolArray& Array : m_Arrays)
+		{
+			if (Array.bMipmapsDirty)
+			{
+				Array.Array->GenerateMipmaps();
+				Array.bMipmapsDirty = false;
+			}
+		}
+	}
+
+	size_t TextureArrayPool::GetArrayCount() const
+	{
+		return m_Arrays.size();
+	}
+
+	TextureArrayPool::ArrayClass TextureArrayPool::GetClass(const ImageData& Image)
+	{
+		ArrayClass Class;
+		Class.Width = Image.Width;
+		Class.Height = Image.Height;
+		if (Image.CompressedFormat != 0)
+		{
+			Class.InternalFormat = Image.CompressedFormat;
+			Class.LevelCount = static_cast<int>(Image.Levels.size());
+		}
+		else if (Image.Channels == 3 || Image.Channels == 4)
+		{
+			Class.InternalFormat = Image.Channels == 3 ? GL_RGB8 : GL_RGBA8;
+			Class.LevelCount = static_cast<int>(std::floor(std::log2(std::max(Image.Width, Image.Height)))) + 1;
+		}
+		return Class;
+	}
+
+} // namespace fgl
\ No newline at end of file
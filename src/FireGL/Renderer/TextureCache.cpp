@@ -0,0 +1,77 @@
+#include <FireGL/Renderer/TextureCache.h>
+#include <FireGL/Core/BaseLog.h>
+#include <FireGL/Renderer/Texture.h>
+
+#include <filesystem>
+#include <mutex>
+
+namespace fgl
+{
+
+	std::unordered_map<size_t, TextureCache::Entry> TextureCache::s_Entries;
+
+	namespace
+	{
+		std::mutex s_Mutex; ///< Guards TextureCache::s_Entries, models may be imported on worker threads.
+	}
+
+	size_t TextureCache::GetKey(std::string_view FilePath)
+	{
+		// weakly_canonical resolves "..", "." and links for the part of the path that exists
+		std::error_code Error;
+		std::filesystem::path Canonical = std::filesystem::weakly_canonical(std::filesystem::path(FilePath), Error);
+		if (Error)
+		{
+			Canonical = std::filesystem::path(FilePath).lexically_normal();
+		}
+		return std::hash<std::string>()(Canonical.generic_string());
+	}
+
+	bool TextureCache::Acquire(size_t Key, GLuint& ID)
+	{
+		std::lock_guard<std::mutex> Lock(s_Mutex);
+		auto It = s_Entries.find(Key);
+		if (It == s_Entries.end())
+			return false;
+
+		It->second.RefCount++;
+		ID = It->second.ID;
+		return true;
+	}
+
+	void TextureCache::Add(size_t Key, GLuint& ID)
+	{
+		std::lock_guard<std::mutex> Lock(s_Mutex);
+		auto [It, bInserted] = s_Entries.try_emplace(Key, Entry{ ID, 0 });
+		if (!bInserted && It->second.ID != ID)
+		{
+			Texture::Delete(ID);
+			ID = It->second.ID;
+		}
+		It->second.RefCount++;
+	}
+
+	void TextureCache::Release(size_t Key)
+	{
+		std::lock_guard<std::mutex> Lock(s_Mutex);
+		auto It = s_Entries.find(Key);
+		if (It == s_Entries.end())
+		{
+			LOG_ERROR("Released a texture that isn't in the texture cache.", false);
+			return;
+		}
+
+		if (--It->second.RefCount > 0)
+			return;
+
+		Texture::Delete(It->second.ID);
+		s_Entries.erase(It);
+	}
+
+	size_t TextureCache::GetCount()
+	{
+		std::lock_guard<std::mutex> Lock(s_Mutex);
+		return s_Entries.size();
+	}
+
+} // namespace fgl
\ No newline at end of file
@@ -0,0 +1,129 @@
+#include <FireGL/Renderer/TextureCameras.h>
+#include <FireGL/Renderer/Renderer.h>
+#include <FireGL/Renderer/BaseCamera.h>
+#include <FireGL/Core/BaseLog.h>
+#include <FireGL/Core/Profiler.h>
+
+namespace fgl
+{
+
+	uint32_t TextureCameras::Add(std::shared_ptr<BaseCamera> Camera, const TextureCameraSettings& Settings)
+	{
+		if (!Camera)
+		{
+			LOG_ERROR("A texture camera needs a camera.", false);
+			return InvalidCamera;
+		}
+
+		// Removed slots are reused, the indices of the other cameras never change
+		auto Free = std::find_if(m_Slots.begin(), m_Slots.end(), [](const Slot& Current) { return !Current.Camera; });
+		if (Free == m_Slots.end())
+		{
+			Free = m_Slots.emplace(m_Slots.end());
+		}
+
+		Free->Camera = std::move(Camera);
+		Free->Settings = Settings;
+		Free->Target = std::make_unique<RenderTarget>();
+		Free->LastFrame = m_Frame;
+		Free->bCaptured = false;
+		Free->bRequested = true;
+		return static_cast<uint32_t>(Free - m_Slots.begin());
+	}
+
+	void TextureCameras::Remove(uint32_t Index)
+	{
+		Slot& Removed = GetSlot(Index);
+		Removed.Camera.reset();
+		Removed.Target.reset();
+		Removed.bCaptured = false;
+	}
+
+	void TextureCameras::SetSettings(uint32_t Index, const TextureCameraSettings& Settings)
+	{
+		GetSlot(Index).Settings = Settings;
+	}
+
+	const TextureCameraSettings& TextureCameras::GetSettings(uint32_t Index) const
+	{
+		return GetSlot(Index).Settings;
+	}
+
+	void TextureCameras::RequestUpdate(uint32_t Index)
+	{
+		GetSlot(Index).bRequested = true;
+	}
+
+	void TextureCameras::SetMaxCapturesPerUpdate(uint32_t Count)
+	{
+		m_MaxCapturesPerUpdate = std::max(Count, 1u);
+	}
+
+	void TextureCameras::Update(Renderer& Target, Scene* Scene)
+	{
+		FGL_PROFILE_SCOPE("TextureCameras::Update")
+		m_Frame++;
+
+		// Requested captures rank above any overdue one, the others by the frames they are late
+		m_Due.clear();
+		for (uint32_t Index = 0; Index < m_Slots.size(); Index++)
+		{
+			const Slot& Current = m_Slots[Index];
+			if (!Current.Camera)
+				continue;
+
+			const uint64_t Age = m_Frame - Current.LastFrame;
+			const uint32_t Interval = Current.Settings.UpdateInterval;
+			if (Current.bRequested)
+			{
+				m_Due.emplace_back(std::numeric_limits<uint64_t>::max(), Index);
+			}
+			else if (Interval != 0 && Age >= Interval)
+			{
+				m_Due.emplace_back(Age - Interval, Index);
+			}
+		}
+
+		const size_t Count = std::min<size_t>(m_Due.size(), m_MaxCapturesPerUpdate);
+		std::partial_sort(m_Due.begin(), m_Due.begin() + Count, m_Due.end(), [](const auto& A, const auto& B) { return A.first > B.first; });
+		for (size_t Captured = 0; Captured < Count; Captured++)
+		{
+			Slot& Current = m_Slots[m_Due[Captured].second];
+			const TextureCameraSettings& Settings = Current.Settings;
+			Current.Target->Resize(std::max(Settings.Width, 1), std::max(Settings.Height, 1), Settings.Samples, Settings.ColorFormat);
+			Target.RenderCapture(Scene, *Current.Camera, *Current.Target, Settings.LODBias, Settings.CullDistance);
+			Current.LastFrame = m_Frame;
+			Current.bCaptured = true;
+			Current.bRequested = false;
+		}
+	}
+
+	GLuint TextureCameras::GetTexture(uint32_t Index) const
+	{
+		const Slot& Current = GetSlot(Index);
+		return Current.bCaptured ? Current.Target->GetColorTexture() : 0;
+	}
+
+	uint64_t TextureCameras::GetAge(uint32_t Index) const
+	{
+		return m_Frame - GetSlot(Index).LastFrame;
+	}
+
+	size_t TextureCameras::GetCameraCount() const
+	{
+		return static_cast<size_t>(std::count_if(m_Slots.begin(), m_Slots.end(), [](const Slot& Current) { return Current.Camera != nullptr; }));
+	}
+
+	TextureCameras::Slot& TextureCameras::GetSlot(uint32_t Index)
+	{
+		LOG_ASSERT(Index < m_Slots.size() && m_Slots[Index].Camera, "Invalid texture camera index.")
+		return m_Slots[Index];
+	}
+
+	const TextureCameras::Slot& TextureCameras::GetSlot(uint32_t Index) const
+	{
+		LOG_ASSERT(Index < m_Slots.size() && m_Slots[Index].Camera, "Invalid texture camera index.")
+		return m_Slots[Index];
+	}
+
+} // namespace fgl
@@ -0,0 +1,739 @@
+#include <FireGL/Renderer/TextureContainer.h>
+#include <FireGL/Core/BaseLog.h>
+#include <FireGL/Core/MemoryTracker.h>
+#include <FireGL/Renderer/GLExtensions.h>
+
+#include <filesystem>
+#include <cstring>
+
+namespace fgl
+{
+
+	namespace
+	{
+		// Formats of GL_EXT_texture_compression_s3tc, EXT_texture_sRGB and GL_KHR_texture_compression_astc_ldr,
+		// which the generated loader doesn't declare
+		constexpr GLenum CompressedRGBDXT1 = 0x83F0;
+		constexpr GLenum CompressedRGBADXT1 = 0x83F1;
+		constexpr GLenum CompressedRGBADXT5 = 0x83F3;
+		constexpr GLenum CompressedSRGBDXT1 = 0x8C4C;
+		constexpr GLenum CompressedSRGBAlphaDXT1 = 0x8C4D;
+		constexpr GLenum CompressedSRGBAlphaDXT5 = 0x8C4F;
+		constexpr GLenum CompressedRGBAASTCFirst = 0x93B0; ///< GL_COMPRESSED_RGBA_ASTC_4x4_KHR, the 14 block sizes follow.
+		constexpr GLenum CompressedSRGBASTCFirst = 0x93D0; ///< GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR.
+		constexpr GLenum ASTCBlockSizeCount = 14;
+
+		/** Block footprints of the ASTC formats, in the order of their OpenGL and Vulkan enums. */
+		constexpr int ASTCBlockSizes[ASTCBlockSizeCount][2] = {
+			{ 4, 4 }, { 5, 4 }, { 5, 5 }, { 6, 5 }, { 6, 6 }, { 8, 5 }, { 8, 6 },
+			{ 8, 8 }, { 10, 5 }, { 10, 6 }, { 10, 8 }, { 10, 10 }, { 12, 10 }, { 12, 12 }
+		};
+
+		constexpr uint32_t MakeFourCC(char A, char B, char C, char D)
+		{
+			return uint32_t(uint8_t(A)) | (uint32_t(uint8_t(B)) << 8) | (uint32_t(uint8_t(C)) << 16) | (uint32_t(uint8_t(D)) << 24);
+		}
+
+		constexpr uint8_t KTX2Identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+		template<typename T>
+		T ReadValue(const unsigned char* Data, size_t Offset)
+		{
+			T Value;
+			std::memcpy(&Value, Data + Offset, sizeof(T));
+			return Value;
+		}
+
+		bool IsBPTC(GLenum Format)
+		{
+			return Format == GL_COMPRESSED_RGBA_BPTC_UNORM || Format == GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM
+				|| Format == GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT || Format == GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT;
+		}
+
+		bool IsASTC(GLenum Format)
+		{
+			return (Format >= CompressedRGBAASTCFirst && Format < CompressedRGBAASTCFirst + ASTCBlockSizeCount)
+				|| (Format >= CompressedSRGBASTCFirst && Format < CompressedSRGBASTCFirst + ASTCBlockSizeCount);
+		}
+
+		GLenum FormatFromDXGI(uint32_t DXGIFormat)
+		{
+			switch (DXGIFormat)
+			{
+			case 71: return CompressedRGBADXT1;                  // DXGI_FORMAT_BC1_UNORM
+			case 72: return CompressedSRGBAlphaDXT1;             // DXGI_FORMAT_BC1_UNORM_SRGB
+			case 77: return CompressedRGBADXT5;                  // DXGI_FORMAT_BC3_UNORM
+			case 78: return CompressedSRGBAlphaDXT5;             // DXGI_FORMAT_BC3_UNORM_SRGB
+			case 83: return GL_COMPRESSED_RG_RGTC2;              // DXGI_FORMAT_BC5_UNORM
+			case 95: return GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT; // DXGI_FORMAT_BC6H_UF16
+			case 96: return GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT; // DXGI_FORMAT_BC6H_SF16
+			case 98: return GL_COMPRESSED_RGBA_BPTC_UNORM;       // DXGI_FORMAT_BC7_UNORM
+			case 99: return GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM; // DXGI_FORMAT_BC7_UNORM_SRGB
+			default: return 0;
+			}
+		}
+
+		GLenum FormatFromVulkan(uint32_t VkFormat)
+		{
+			switch (VkFormat)
+			{
+			case 131: return CompressedRGBDXT1;                   // VK_FORMAT_BC1_RGB_UNORM_BLOCK
+			case 132: return CompressedSRGBDXT1;                  // VK_FORMAT_BC1_RGB_SRGB_BLOCK
+			case 133: return CompressedRGBADXT1;                  // VK_FORMAT_BC1_RGBA_UNORM_BLOCK
+			case 134: return CompressedSRGBAlphaDXT1;             // VK_FORMAT_BC1_RGBA_SRGB_BLOCK
+			case 137: return CompressedRGBADXT5;                  // VK_FORMAT_BC3_UNORM_BLOCK
+			case 138: return CompressedSRGBAlphaDXT5;             // VK_FORMAT_BC3_SRGB_BLOCK
+			case 141: return GL_COMPRESSED_RG_RGTC2;              // VK_FORMAT_BC5_UNORM_BLOCK
+			case 143: return GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT; // VK_FORMAT_BC6H_UFLOAT_BLOCK
+			case 144: return GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT; // VK_FORMAT_BC6H_SFLOAT_BLOCK
+			case 145: return GL_COMPRESSED_RGBA_BPTC_UNORM;       // VK_FORMAT_BC7_UNORM_BLOCK
+			case 146: return GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM; // VK_FORMAT_BC7_SRGB_BLOCK
+			default:
+				break;
+			}
+
+			// VK_FORMAT_ASTC_4x4_UNORM_BLOCK (157) to VK_FORMAT_ASTC_12x12_SRGB_BLOCK (184), UNORM and SRGB alternate
+			if (VkFormat >= 157 && VkFormat <= 184)
+			{
+				const uint32_t Index = VkFormat - 157;
+				return ((Index % 2) ? CompressedSRGBASTCFirst : CompressedRGBAASTCFirst) + Index / 2;
+			}
+			return 0;
+		}
+
+		uint32_t VulkanFromFormat(GLenum Format)
+		{
+			switch (Format)
+			{
+			case CompressedRGBDXT1: return 131;
+			case CompressedSRGBDXT1: return 132;
+			case CompressedRGBADXT1: return 133;
+			case CompressedSRGBAlphaDXT1: return 134;
+			case CompressedRGBADXT5: return 137;
+			case CompressedSRGBAlphaDXT5: return 138;
+			case GL_COMPRESSED_RG_RGTC2: return 141;
+			case GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT: return 143;
+			case GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT: return 144;
+			case GL_COMPRESSED_RGBA_BPTC_UNORM: return 145;
+			case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM: return 146;
+			default:
+				break;
+			}
+
+			if (IsASTC(Format))
+			{
+				const bool bSRGB = Format >= CompressedSRGBASTCFirst;
+				return 157 + (Format - (bSRGB ? CompressedSRGBASTCFirst : CompressedRGBAASTCFirst)) * 2 + (bSRGB ? 1 : 0);
+			}
+			return 0;
+		}
+
+		/** @return The KHR_DF_MODEL_* color model of a compressed format, written in the data format descriptor of KTX2 files. */
+		uint8_t GetColorModel(GLenum Format)
+		{
+			if (IsASTC(Format))
+				return 162;
+			if (Format == CompressedRGBADXT5 || Format == CompressedSRGBAlphaDXT5)
+				return 130;
+			if (Format == GL_COMPRESSED_RG_RGTC2)
+				return 132;
+			if (Format == GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT || Format == GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT)
+				return 133;
+			if (Format == GL_COMPRESSED_RGBA_BPTC_UNORM || Format == GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM)
+				return 134;
+			return 128;
+		}
+
+		bool IsSRGB(GLenum Format)
+		{
+			return Format == CompressedSRGBDXT1 || Format == CompressedSRGBAlphaDXT1 || Format == CompressedSRGBAlphaDXT5
+				|| Format == GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM || Format >= CompressedSRGBASTCFirst;
+		}
+
+		template<typename T>
+		void WriteValue(std::vector<unsigned char>& Data, T Value)
+		{
+			const size_t Offset = Data.size();
+			Data.resize(Offset + sizeof(T));
+			std::memcpy(Data.data() + Offset, &Value, sizeof(T));
+		}
+
+		using BlockPixels = std::array<std::array<uint8_t, 4>, 16>;
+
+		uint16_t PackRGB565(const float Color[3])
+		{
+			const auto Quantize = [](float Value, int Max) { return static_cast<uint16_t>(std::lround(std::clamp(Value, 0.0f, 255.0f) * Max / 255.0f)); };
+			return static_cast<uint16_t>((Quantize(Color[0], 31) << 11) | (Quantize(Color[1], 63) << 5) | Quantize(Color[2], 31));
+		}
+
+		void UnpackRGB565(uint16_t Packed, int Color[3])
+		{
+			const int Red = (Packed >> 11) & 31;
+			const int Green = (Packed >> 5) & 63;
+			const int Blue = Packed & 31;
+			Color[0] = (Red << 3) | (Red >> 2);
+			Color[1] = (Green << 2) | (Green >> 4);
+			Color[2] = (Blue << 3) | (Blue >> 2);
+		}
+
+		/** Encodes the colors of a block in BC1's four-color mode, with endpoints along their principal axis. */
+		void EncodeColorBlock(const BlockPixels& Pixels, unsigned char* Block)
+		{
+			float Mean[3] = { 0.0f, 0.0f, 0.0f };
+			for (const auto& Pixel : Pixels)
+			{
+				for (int Channel = 0; Channel < 3; Channel++)
+				{
+					Mean[Channel] += Pixel[Channel] / 16.0f;
+				}
+			}
+
+			float Covariance[6] = {}; // RR, RG, RB, GG, GB, BB
+			for (const auto& Pixel : Pixels)
+			{
+				const float R = Pixel[0] - Mean[0], G = Pixel[1] - Mean[1], B = Pixel[2] - Mean[2];
+				Covariance[0] += R * R; Covariance[1] += R * G; Covariance[2] += R * B;
+				Covariance[3] += G * G; Covariance[4] += G * B; Covariance[5] += B * B;
+			}
+
+			// A few power iterations find the principal axis well enough for 16 colors
+			float Axis[3] = { 1.0f, 1.0f, 1.0f };
+			for (int Iteration = 0; Iteration < 4; Iteration++)
+			{
+				const float X = Covariance[0] * Axis[0] + Covariance[1] * Axis[1] + Covariance[2] * Axis[2];
+				const float Y = Covariance[1] * Axis[0] + Covariance[3] * Axis[1] + Covariance[4] * Axis[2];
+				const float Z = Covariance[2] * Axis[0] + Covariance[4] * Axis[1] + Covariance[5] * Axis[2];
+				const float Length = std::max({ std::abs(X), std::abs(Y), std::abs(Z) });
+				if (Length < 1e-6f)
+					break;
+				Axis[0] = X / Length; Axis[1] = Y / Length; Axis[2] = Z / Length;
+			}
+
+			float MinProjection = std::numeric_limits<float>::max();
+			float MaxProjection = std::numeric_limits<float>::lowest();
+			for (const auto& Pixel : Pixels)
+			{
+				const float Projection = (Pixel[0] - Mean[0]) * Axis[0] + (Pixel[1] - Mean[1]) * Axis[1] + (Pixel[2] - Mean[2]) * Axis[2];
+				MinProjection = std::min(MinProjection, Projection);
+				MaxProjection = std::max(MaxProjection, Projection);
+			}
+			const float AxisLength = Axis[0] * Axis[0] + Axis[1] * Axis[1] + Axis[2] * Axis[2];
+			float Low[3], High[3];
+			for (int Channel = 0; Channel < 3; Channel++)
+			{
+				Low[Channel] = Mean[Channel] + Axis[Channel] * MinProjection / AxisLength;
+				High[Channel] = Mean[Channel] + Axis[Channel] * MaxProjection / AxisLength;
+			}
+
+			// The first endpoint must be the larger one, equal endpoints leave every index at 0
+			uint16_t Endpoint0 = PackRGB565(High);
+			uint16_t Endpoint1 = PackRGB565(Low);
+			if (Endpoint0 < Endpoint1)
+			{
+				std::swap(Endpoint0, Endpoint1);
+			}
+
+			int Palette[4][3];
+			UnpackRGB565(Endpoint0, Palette[0]);
+			UnpackRGB565(Endpoint1, Palette[1]);
+			for (int Channel = 0; Channel < 3; Channel++)
+			{
+				Palette[2][Channel] = (2 * Palette[0][Channel] + Palette[1][Channel]) / 3;
+				Palette[3][Channel] = (Palette[0][Channel] + 2 * Palette[1][Channel]) / 3;
+			}
+
+			uint32_t Indices = 0;
+			if (Endpoint0 != Endpoint1)
+			{
+				for (int Index = 0; Index < 16; Index++)
+				{
+					int Best = 0;
+					int BestDistance = std::numeric_limits<int>::max();
+					for (int Entry = 0; Entry < 4; Entry++)
+					{
+						const int R = Pixels[Index][0] - Palette[Entry][0];
+						const int G = Pixels[Index][1] - Palette[Entry][1];
+						const int B = Pixels[Index][2] - Palette[Entry][2];
+						const int Distance = R * R + G * G + B * B;
+						if (Distance < BestDistance)
+						{
+							Best = Entry;
+							BestDistance = Distance;
+						}
+					}
+					Indices |= static_cast<uint32_t>(Best) << (Index * 2);
+				}
+			}
+
+			std::memcpy(Block, &Endpoint0, sizeof(Endpoint0));
+			std::memcpy(Block + 2, &Endpoint1, sizeof(Endpoint1));
+			std::memcpy(Block + 4, &Indices, sizeof(Indices));
+		}
+
+		/** Encodes the alpha of a block as BC3's first half, in its eight-value mode. */
+		void EncodeAlphaBlock(const BlockPixels& Pixels, unsigned char* Block)
+		{
+			uint8_t Alpha0 = 0;
+			uint8_t Alpha1 = 255;
+			for (const auto& Pixel : Pixels)
+			{
+				Alpha0 = std::max(Alpha0, Pixel[3]);
+				Alpha1 = std::min(Alpha1, Pixel[3]);
+			}
+
+			int Palette[8] = { Alpha0, Alpha1 };
+			for (int Entry = 2; Entry < 8; Entry++)
+			{
+				Palette[Entry] = ((8 - Entry) * Alpha0 + (Entry - 1) * Alpha1) / 7;
+			}
+
+			uint64_t Indices = 0;
+			if (Alpha0 != Alpha1)
+			{
+				for (int Index = 0; Index < 16; Index++)
+				{
+					int Best = 0;
+					for (int Entry = 1; Entry < 8; Entry++)
+					{
+						if (std::abs(Pixels[Index][3] - Palette[Entry]) < std::abs(Pixels[Index][3] - Palette[Best]))
+						{
+							Best = Entry;
+						}
+					}
+					Indices |= static_cast<uint64_t>(Best) << (Index * 3);
+				}
+			}
+
+			Block[0] = Alpha0;
+			Block[1] = Alpha1;
+			for (int Byte = 0; Byte < 6; Byte++)
+			{
+				Block[2 + Byte] = static_cast<unsigned char>(Indices >> (Byte * 8));
+			}
+		}
+
+		/** Halves an RGBA8 image with a box filter, the last row and column of odd sizes are filtered with themselves. */
+		std::vector<uint8_t> DownsampleRGBA(const std::vector<uint8_t>& Pixels, int Width, int Height)
+		{
+			const int NextWidth = std::max(Width / 2, 1);
+			const int NextHeight = std::max(Height / 2, 1);
+			std::vector<uint8_t> Next(static_cast<size_t>(NextWidth) * NextHeight * 4);
+			for (int Y = 0; Y < NextHeight; Y++)
+			{
+				const int Y0 = std::min(Y * 2, Height - 1), Y1 = std::min(Y * 2 + 1, Height - 1);
+				for (int X = 0; X < NextWidth; X++)
+				{
+					const int X0 = std::min(X * 2, Width - 1), X1 = std::min(X * 2 + 1, Width - 1);
+					for (int Channel = 0; Channel < 4; Channel++)
+					{
+						const int Sum = Pixels[(static_cast<size_t>(Y0) * Width + X0) * 4 + Channel] + Pixels[(static_cast<size_t>(Y0) * Width + X1) * 4 + Channel]
+							+ Pixels[(static_cast<size_t>(Y1) * Width + X0) * 4 + Channel] + Pixels[(static_cast<size_t>(Y1) * Width + X1) * 4 + Channel];
+						Next[(static_cast<size_t>(Y) * NextWidth + X) * 4 + Channel] = static_cast<uint8_t>((Sum + 2) / 4);
+					}
+				}
+			}
+			return Next;
+		}
+	}
+
+	bool TextureContainer::IsContainer(std::string_view Path)
+	{
+		std::string Extension = std::filesystem::path(Path).extension().string();
+		std::transform(Extension.begin(), Extension.end(), Extension.begin(), [](unsigned char C) { return static_cast<char>(std::tolower(C)); });
+		return Extension == ".dds" || Extension == ".ktx2";
+	}
+
+	bool TextureContainer::Load(std::string_view Path, ImageData& Image)
+	{
+		std::ifstream File(std::string(Path), std::ios::binary | std::ios::ate);
+		if (!File)
+			return false;
+
+		const std::streamsize FileSize = File.tellg();
+		if (FileSize <= 0)
+			return false;
+
+		// The levels point into the file contents, which are kept as the image pixels
+		std::shared_ptr<unsigned char> Contents = MemoryTracker::MakeSharedBuffer(MemoryTag::Textures, static_cast<size_t>(FileSize));
+		File.seekg(0);
+		if (!File.read(reinterpret_cast<char*>(Contents.get()), FileSize))
+			return false;
+
+		return Parse(std::move(Contents), static_cast<size_t>(FileSize), Image, Path);
+	}
+
+	bool TextureContainer::Parse(std::shared_ptr<unsigned char> Contents, size_t Size, ImageData& Image, std::string_view Name)
+	{
+		ImageData Parsed;
+		Parsed.Pixels = Contents;
+		const bool bParsed = (Size >= sizeof(KTX2Identifier) && std::memcmp(Contents.get(), KTX2Identifier, sizeof(KTX2Identifier)) == 0)
+			? ParseKTX2(Parsed, Size)
+			: ParseDDS(Parsed, Size);
+		if (!bParsed)
+		{
+			LOG_ERROR("Unsupported or corrupted compressed texture: " + std::string(Name), false);
+			return false;
+		}
+
+		Image = std::move(Parsed);
+		return true;
+	}
+
+	bool TextureContainer::Encode(const ImageData& Source, ImageData& Compressed)
+	{
+		if (Source.CompressedFormat != 0 || !Source.Pixels || Source.Channels < 1 || Source.Channels > 4 || Source.Width <= 0 || Source.Height <= 0)
+			return false;
+
+		// Gray and gray-alpha images are spread to RGBA first
+		const size_t PixelCount = static_cast<size_t>(Source.Width) * Source.Height;
+		std::vector<uint8_t> Pixels(PixelCount * 4);
+		bool bAlpha = false;
+		for (size_t Pixel = 0; Pixel < PixelCount; Pixel++)
+		{
+			const unsigned char* In = Source.Pixels.get() + Pixel * Source.Channels;
+			uint8_t* Out = &Pixels[Pixel * 4];
+			Out[0] = In[0];
+			Out[1] = Source.Channels >= 3 ? In[1] : In[0];
+			Out[2] = Source.Channels >= 3 ? In[2] : In[0];
+			Out[3] = Source.Channels == 4 ? In[3] : Source.Channels == 2 ? In[1] : 255;
+			bAlpha |= Out[3] != 255;
+		}
+
+		const GLenum Format = bAlpha ? CompressedRGBADXT5 : CompressedRGBDXT1;
+		const size_t BlockBytes = bAlpha ? 16 : 8;
+		const int LevelCount = 1 + static_cast<int>(std::floor(std::log2(std::max(Source.Width, Source.Height))));
+		size_t TotalSize = 0;
+		for (int Level = 0; Level < LevelCount; Level++)
+		{
+			TotalSize += GetLevelSize(Format, std::max(Source.Width >> Level, 1), std::max(Source.Height >> Level, 1));
+		}
+
+		ImageData Encoded;
+		Encoded.Pixels = MemoryTracker::MakeSharedBuffer(MemoryTag::Textures, TotalSize);
+		Encoded.Width = Source.Width;
+		Encoded.Height = Source.Height;
+		Encoded.CompressedFormat = Format;
+
+		size_t Offset = 0;
+		int Width = Source.Width;
+		int Height = Source.Height;
+		for (int Level = 0; Level < LevelCount; Level++)
+		{
+			const size_t Size = GetLevelSize(Format, Width, Height);
+			unsigned char* Block = Encoded.Pixels.get() + Offset;
+			for (int BlockY = 0; BlockY < Height; BlockY += 4)
+			{
+				for (int BlockX = 0; BlockX < Width; BlockX += 4)
+				{
+					// Blocks past the edge repeat the last row and column
+					BlockPixels Texels;
+					for (int Index = 0; Index < 16; Index++)
+					{
+						const int X = std::min(BlockX + Index % 4, Width - 1);
+						const int Y = std::min(BlockY + Index / 4, Height - 1);
+						std::memcpy(Texels[Index].data(), &Pixels[(static_cast<size_t>(Y) * Width + X) * 4], 4);
+					}
+
+					if (bAlpha)
+					{
+						EncodeAlphaBlock(Texels, Block);
+						EncodeColorBlock(Texels, Block + 8);
+					}
+					else
+					{
+						EncodeColorBlock(Texels, Block);
+					}
+					Block += BlockBytes;
+				}
+			}
+			Encoded.Levels.push_back({ Offset, Size, Width, Height });
+			Offset += Size;
+
+			if (Level + 1 < LevelCount)
+			{
+				Pixels = DownsampleRGBA(Pixels, Width, Height);
+				Width = std::max(Width / 2, 1);
+				Height = std::max(Height / 2, 1);
+			}
+		}
+
+		Compressed = std::move(Encoded);
+		return true;
+	}
+
+	bool TextureContainer::SaveKTX2(std::string_view Path, const ImageData& Image)
+	{
+		constexpr size_t HeaderSize = 80;
+		constexpr size_t LevelIndexEntrySize = 24;
+		constexpr uint32_t DescriptorSize = 4 + 24 + 16;
+		const uint32_t VkFormat = VulkanFromFormat(Image.CompressedFormat);
+		if (VkFormat == 0 || !Image.Pixels || (Image.FaceCount != 1 && Image.FaceCount != 6) || Image.Levels.empty()
+			|| Image.Levels.size() % Image.FaceCount != 0)
+		{
+			return false;
+		}
+
+		int BlockWidth = 4, BlockHeight = 4;
+		if (IsASTC(Image.CompressedFormat))
+		{
+			const GLenum Index = Image.CompressedFormat - (Image.CompressedFormat >= CompressedSRGBASTCFirst ? CompressedSRGBASTCFirst : CompressedRGBAASTCFirst);
+			BlockWidth = ASTCBlockSizes[Index][0];
+			BlockHeight = ASTCBlockSizes[Index][1];
+		}
+		const uint32_t BlockBytes = static_cast<uint32_t>(GetLevelSize(Image.CompressedFormat, 1, 1));
+		const uint32_t LevelCount = static_cast<uint32_t>(Image.Levels.size() / Image.FaceCount);
+		const uint32_t DescriptorOffset = static_cast<uint32_t>(HeaderSize + LevelCount * LevelIndexEntrySize);
+
+		std::vector<unsigned char> Data(KTX2Identifier, KTX2Identifier + sizeof(KTX2Identifier));
+		WriteValue<uint32_t>(Data, VkFormat);
+		WriteValue<uint32_t>(Data, 1); // typeSize
+		WriteValue<uint32_t>(Data, static_cast<uint32_t>(Image.Width));
+		WriteValue<uint32_t>(Data, static_cast<uint32_t>(Image.Height));
+		WriteValue<uint32_t>(Data, 0); // pixelDepth
+		WriteValue<uint32_t>(Data, 0); // layerCount
+		WriteValue<uint32_t>(Data, static_cast<uint32_t>(Image.FaceCount));
+		WriteValue<uint32_t>(Data, LevelCount);
+		WriteValue<uint32_t>(Data, 0); // supercompressionScheme
+		WriteValue<uint32_t>(Data, DescriptorOffset);
+		WriteValue<uint32_t>(Data, DescriptorSize);
+		WriteValue<uint32_t>(Data, 0); // kvdByteOffset
+		WriteValue<uint32_t>(Data, 0); // kvdByteLength
+		WriteValue<uint64_t>(Data, 0); // sgdByteOffset
+		WriteValue<uint64_t>(Data, 0); // sgdByteLength
+
+		// Levels are stored smallest first, each aligned to a block; the index is filled in once they are placed
+		const size_t LevelIndexOffset = Data.size();
+		Data.resize(DescriptorOffset);
+
+		// Basic data format descriptor with one sample covering the whole block, as readers of block formats expect
+		WriteValue<uint32_t>(Data, DescriptorSize);
+		WriteValue<uint32_t>(Data, 0); // vendorId and descriptorType: Khronos basic
+		WriteValue<uint32_t>(Data, 2 | ((DescriptorSize - 4) << 16)); // versionNumber and descriptorBlockSize
+		Data.push_back(GetColorModel(Image.CompressedFormat));
+		Data.push_back(1); // BT.709 primaries
+		Data.push_back(IsSRGB(Image.CompressedFormat) ? 2 : 1);
+		Data.push_back(0); // Straight alpha
+		Data.push_back(static_cast<unsigned char>(BlockWidth - 1));
+		Data.push_back(static_cast<unsigned char>(BlockHeight - 1));
+		Data.push_back(0);
+		Data.push_back(0);
+		WriteValue<uint32_t>(Data, BlockBytes); // bytesPlane0
+		WriteValue<uint32_t>(Data, 0);          // bytesPlane4 to 7
+		WriteValue<uint32_t>(Data, (BlockBytes * 8 - 1) << 16); // bitOffset 0, bitLength, channelType 0
+		WriteValue<uint32_t>(Data, 0);          // samplePosition
+		WriteValue<uint32_t>(Data, 0);          // sampleLower
+		WriteValue<uint32_t>(Data, 0xFFFFFFFF); // sampleUpper
+
+		for (uint32_t Level = LevelCount; Level-- > 0;)
+		{
+			Data.resize((Data.size() + BlockBytes - 1) / BlockBytes * BlockBytes);
+			const uint64_t LevelOffset = Data.size();
+			for (int Face = 0; Face < Image.FaceCount; Face++)
+			{
+				const ImageData::Level& Stored = Image.Levels[Level * Image.FaceCount + Face];
+				Data.insert(Data.end(), Image.Pixels.get() + Stored.Offset, Image.Pixels.get() + Stored.Offset + Stored.Size);
+			}
+
+			const uint64_t LevelSize = Data.size() - LevelOffset;
+			const size_t Entry = LevelIndexOffset + size_t(Level) * LevelIndexEntrySize;
+			std::memcpy(&Data[Entry], &LevelOffset, sizeof(uint64_t));
+			std::memcpy(&Data[Entry + 8], &LevelSize, sizeof(uint64_t));
+			std::memcpy(&Data[Entry + 16], &LevelSize, sizeof(uint64_t));
+		}
+
+		std::error_code Error;
+		const std::filesystem::path Directory = std::filesystem::path(Path).parent_path();
+		if (!Directory.empty())
+		{
+			std::filesystem::create_directories(Directory, Error);
+		}
+
+		std::ofstream File(std::string(Path), std::ios::binary | std::ios::trunc);
+		return File && File.write(reinterpret_cast<const char*>(Data.data()), static_cast<std::streamsize>(Data.size()));
+	}
+
+	bool TextureContainer::ParseDDS(ImageData& Image, size_t FileSize)
+	{
+		constexpr size_t HeaderSize = 4 + 124;
+		constexpr size_t DX10HeaderSize = 20;
+		const unsigned char* Data = Image.Pixels.get();
+		if (FileSize < HeaderSize || ReadValue<uint32_t>(Data, 0) != MakeFourCC('D', 'D', 'S', ' '))
+			return false;
+
+		// DDS_HEADER follows the magic, the pixel format is 72 bytes into it
+		Image.Height = static_cast<int>(ReadValue<uint32_t>(Data, 4 + 8));
+		Image.Width = static_cast<int>(ReadValue<uint32_t>(Data, 4 + 12));
+		const uint32_t MipCount = ReadValue<uint32_t>(Data, 4 + 24);
+		const uint32_t FourCC = ReadValue<uint32_t>(Data, 4 + 72 + 8);
+		const uint32_t Caps2 = ReadValue<uint32_t>(Data, 4 + 108);
+
+		// DDSCAPS2_CUBEMAP with every DDSCAPS2_CUBEMAP_* face, partial cube maps aren't supported
+		constexpr uint32_t CubeMapAllFaces = 0x200 | 0xFC00;
+		if ((Caps2 & 0x200) && (Caps2 & CubeMapAllFaces) != CubeMapAllFaces)
+			return false;
+		Image.FaceCount = (Caps2 & 0x200) ? 6 : 1;
+
+		size_t Offset = HeaderSize;
+		if (FourCC == MakeFourCC('D', 'X', '1', '0'))
+		{
+			if (FileSize < HeaderSize + DX10HeaderSize)
+				return false;
+
+			// Texture arrays aren't supported, a single cube map is flagged DDS_RESOURCE_MISC_TEXTURECUBE
+			const uint32_t Dimension = ReadValue<uint32_t>(Data, HeaderSize + 4);
+			const uint32_t MiscFlags = ReadValue<uint32_t>(Data, HeaderSize + 8);
+			const uint32_t ArraySize = ReadValue<uint32_t>(Data, HeaderSize + 12);
+			if (Dimension != 3 || ArraySize > 1) // D3D10_RESOURCE_DIMENSION_TEXTURE2D
+				return false;
+			Image.FaceCount = (MiscFlags & 0x4) ? 6 : 1;
+
+			Image.CompressedFormat = FormatFromDXGI(ReadValue<uint32_t>(Data, HeaderSize));
+			Offset += DX10HeaderSize;
+		}
+		else if (FourCC == MakeFourCC('D', 'X', 'T', '1'))
+		{
+			Image.CompressedFormat = CompressedRGBADXT1;
+		}
+		else if (FourCC == MakeFourCC('D', 'X', 'T', '5'))
+		{
+			Image.CompressedFormat = CompressedRGBADXT5;
+		}
+		else if (FourCC == MakeFourCC('A', 'T', 'I', '2') || FourCC == MakeFourCC('B', 'C', '5', 'U'))
+		{
+			Image.CompressedFormat = GL_COMPRESSED_RG_RGTC2;
+		}
+
+		if (Image.CompressedFormat == 0 || Image.Width <= 0 || Image.Height <= 0)
+			return false;
+
+		// Faces are stored one after the other, each with its whole mip chain
+		const size_t LevelCount = std::max<uint32_t>(MipCount, 1);
+		for (int Face = 0; Face < Image.FaceCount; Face++)
+		{
+			if (!AddConsecutiveLevels(Image, Offset, LevelCount, FileSize))
+				return false;
+			Offset = Image.Levels.back().Offset + Image.Levels.back().Size;
+		}
+		if (Image.FaceCount > 1)
+		{
+			// Levels lists the faces of each level in turn
+			std::vector<ImageData::Level> FaceMajor = std::move(Image.Levels);
+			Image.Levels.clear();
+			for (size_t Level = 0; Level < LevelCount; Level++)
+			{
+				for (int Face = 0; Face < Image.FaceCount; Face++)
+				{
+					Image.Levels.push_back(FaceMajor[Face * LevelCount + Level]);
+				}
+			}
+		}
+		return true;
+	}
+
+	bool TextureContainer::ParseKTX2(ImageData& Image, size_t FileSize)
+	{
+		constexpr size_t HeaderSize = 80;
+		constexpr size_t LevelIndexEntrySize = 24;
+		const unsigned char* Data = Image.Pixels.get();
+		if (FileSize < HeaderSize)
+			return false;
+
+		const uint32_t VkFormat = ReadValue<uint32_t>(Data, 12);
+		Image.Width = static_cast<int>(ReadValue<uint32_t>(Data, 20));
+		Image.Height = static_cast<int>(ReadValue<uint32_t>(Data, 24));
+		const uint32_t Depth = ReadValue<uint32_t>(Data, 28);
+		const uint32_t LayerCount = ReadValue<uint32_t>(Data, 32);
+		const uint32_t FaceCount = ReadValue<uint32_t>(Data, 36);
+		const uint32_t LevelCount = std::max<uint32_t>(ReadValue<uint32_t>(Data, 40), 1);
+		const uint32_t Supercompression = ReadValue<uint32_t>(Data, 44);
+
+		// Only plain 2D textures and cube maps are uploaded, supercompressed data would need a transcoder
+		if (Depth > 0 || LayerCount > 1 || (FaceCount != 1 && FaceCount != 6) || Supercompression != 0)
+			return false;
+		Image.FaceCount = static_cast<int>(FaceCount);
+
+		Image.CompressedFormat = FormatFromVulkan(VkFormat);
+		if (Image.CompressedFormat == 0 || Image.Width <= 0 || Image.Height <= 0)
+			return false;
+
+		if (FileSize < HeaderSize + size_t(LevelCount) * LevelIndexEntrySize)
+			return false;
+
+		// The level index is ordered from the base level down, the data itself is stored smallest first.
+		// The faces of a cube map level follow each other without padding
+		for (uint32_t Level = 0; Level < LevelCount; Level++)
+		{
+			const size_t Entry = HeaderSize + size_t(Level) * LevelIndexEntrySize;
+			const uint64_t ByteOffset = ReadValue<uint64_t>(Data, Entry);
+			const uint64_t ByteLength = ReadValue<uint64_t>(Data, Entry + 8);
+			const int Width = std::max(Image.Width >> Level, 1);
+			const int Height = std::max(Image.Height >> Level, 1);
+			const size_t FaceSize = GetLevelSize(Image.CompressedFormat, Width, Height);
+			if (ByteOffset > FileSize || ByteLength > FileSize - ByteOffset || ByteLength < FaceSize * FaceCount)
+				return false;
+
+			for (uint32_t Face = 0; Face < FaceCount; Face++)
+			{
+				Image.Levels.push_back({ static_cast<size_t>(ByteOffset) + Face * FaceSize, FaceSize, Width, Height });
+			}
+		}
+		return true;
+	}
+
+	bool TextureContainer::AddConsecutiveLevels(ImageData& Image, size_t Offset, size_t LevelCount, size_t FileSize)
+	{
+		for (size_t Level = 0; Level < LevelCount; Level++)
+		{
+			const int Width = std::max(Image.Width >> Level, 1);
+			const int Height = std::max(Image.Height >> Level, 1);
+			const size_t Size = GetLevelSize(Image.CompressedFormat, Width, Height);
+			if (Size > FileSize - Offset)
+				return false;
+
+			Image.Levels.push_back({ Offset, Size, Width, Height });
+			Offset += Size;
+		}
+		return true;
+	}
+
+	size_t TextureContainer::GetLevelSize(GLenum Format, int Width, int Height)
+	{
+		int BlockWidth = 4, BlockHeight = 4;
+		size_t BlockBytes = 16;
+		if (IsASTC(Format))
+		{
+			const GLenum Index = Format - (Format >= CompressedSRGBASTCFirst ? CompressedSRGBASTCFirst : CompressedRGBAASTCFirst);
+			BlockWidth = ASTCBlockSizes[Index][0];
+			BlockHeight = ASTCBlockSizes[Index][1];
+		}
+		else if (Format == CompressedRGBDXT1 || Format == CompressedRGBADXT1 || Format == CompressedSRGBDXT1 || Format == CompressedSRGBAlphaDXT1)
+		{
+			BlockBytes = 8;
+		}
+		else if (Format != CompressedRGBADXT5 && Format != CompressedSRGBAlphaDXT5 && Format != GL_COMPRESSED_RG_RGTC2
+			&& !IsBPTC(Format))
+		{
+			return 0;
+		}
+
+		const size_t BlocksX = (static_cast<size_t>(Width) + BlockWidth - 1) / BlockWidth;
+		const size_t BlocksY = (static_cast<size_t>(Height) + BlockHeight - 1) / BlockHeight;
+		return BlocksX * BlocksY * BlockBytes;
+	}
+
+	bool TextureContainer::IsFormatSupported(GLenum Format)
+	{
+		static const bool bS3TC = GLExtensions::Has("GL_EXT_texture_compression_s3tc");
+		static const bool bBPTC = GLAD_GL_VERSION_4_2 || GLExtensions::Has("GL_ARB_texture_compression_bptc");
+		static const bool bASTC = GLExtensions::Has("GL_KHR_texture_compression_astc_ldr");
+
+		if (IsASTC(Format))
+			return bASTC;
+		if (IsBPTC(Format))
+			return bBPTC;
+		if (Format == GL_COMPRESSED_RG_RGTC2)
+			return true; // Core since OpenGL 3.0
+		return bS3TC;
+	}
+
+} // namespace fgl
\ No newline at end of file
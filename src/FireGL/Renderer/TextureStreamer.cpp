@@ -0,0 +1,281 @@
+#include <FireGL/Renderer/TextureStreamer.h>
+#include <FireGL/Core/BaseLog.h>
+#include <FireGL/Core/MemoryTracker.h>
+#include <FireGL/Renderer/Scene.h>
+#include <FireGL/Renderer/SceneObject.h>
+#include <FireGL/Renderer/BaseCamera.h>
+#include <FireGL/Renderer/Material.h>
+#include <FireGL/Renderer/Frustum.h>
+
+namespace fgl
+{
+
+	TextureStreamer::TextureStreamer(size_t BudgetBytes)
+		: m_Budget(BudgetBytes)
+	{
+	}
+
+	TextureStreamer::~TextureStreamer()
+	{
+		for (StreamedTexture& Streamed : m_Textures)
+		{
+			if (Streamed.Handle->GetID() != 0)
+			{
+				Streamed.Handle->Cleanup();
+			}
+		}
+	}
+
+	Texture* TextureStreamer::Load(std::string_view Path, bool FlipVertical)
+	{
+		StreamedTexture Streamed;
+		if (!Texture::DecodeImage(Path, FlipVertical, Streamed.Image))
+		{
+			LOG_ERROR("Failed to load texture at path: " + std::string(Path), false);
+			return nullptr;
+		}
+
+		if (Streamed.Image.CompressedFormat != 0)
+		{
+			Streamed.LevelCount = static_cast<int>(Streamed.Image.Levels.size());
+		}
+		else
+		{
+			const int Size = std::max(Streamed.Image.Width, Streamed.Image.Height);
+			Streamed.LevelCount = static_cast<int>(std::floor(std::log2(std::max(Size, 1)))) + 1;
+		}
+
+		Streamed.Handle = std::make_unique<Texture>();
+		Streamed.Handle->SetPath(Path);
+		Streamed.ResidentLevel = Streamed.LevelCount;
+		MakeResident(Streamed, GetCoarsestLevel(Streamed));
+		if (Streamed.Handle->GetID() == 0)
+			return nullptr;
+
+		Streamed.DesiredLevel = Streamed.ResidentLevel;
+		m_TextureIndices[Streamed.Handle.get()] = m_Textures.size();
+		return m_Textures.emplace_back(std::move(Streamed)).Handle.get();
+	}
+
+	void TextureStreamer::Update(const Scene& Scene, int ViewportHeight)
+	{
+		m_Frame++;
+		const std::shared_ptr<BaseCamera> Camera = Scene.GetActiveCamera();
+		if (!Camera || m_Textures.empty())
+			return;
+
+		for (StreamedTexture& Streamed : m_Textures)
+		{
+			Streamed.DesiredLevel = GetCoarsestLevel(Streamed);
+		}
+
+		const glm::mat4 Projection = Camera->GetProjectionMatrix();
+		const glm::vec3 CameraPosition = glm::vec3(glm::inverse(Camera->GetViewMatrix())[3]);
+		const Frustum ViewFrustum = Camera->GetFrustum();
+		const bool bPerspective = Projection[3][3] == 0.0f;
+
+		for (const std::unique_ptr<SceneObject>& Object : Scene.GetObjects())
+		{
+			const BoundingSphere Sphere = Object->GetLocalBoundingSphere().Transformed(Object->GetTransform().GetModelMatrix());
+			if (!ViewFrustum.IsVisible(Sphere))
+				continue;
+
+			// Height in pixels of the sphere's projection, the camera inside it sees the texture up close
+			const float Distance = glm::length(Sphere.Center - CameraPosition);
+			float ScreenPixels = Sphere.Radius * Projection[1][1] * static_cast<float>(ViewportHeight);
+			if (bPerspective)
+			{
+				ScreenPixels = Distance > Sphere.Radius ? ScreenPixels / Distance : std::numeric_limits<float>::max();
+			}
+
+			const size_t MeshCount = Object->GetMeshes().size();
+			for (size_t MeshIndex = 0; MeshIndex < MeshCount; MeshIndex++)
+			{
+				const std::shared_ptr<Material> ObjectMaterial = Object->GetMaterial(MeshIndex);
+				if (!ObjectMaterial)
+					continue;
+
+				for (const auto& [Name, MaterialTexture] : ObjectMaterial->GetRenderState().Textures)
+				{
+					auto It = m_TextureIndices.find(MaterialTexture);
+					if (It == m_TextureIndices.end())
+						continue;
+
+					StreamedTexture& Streamed = m_Textures[It->second];
+					Streamed.LastUsedFrame = m_Frame;
+
+					// One texel per pixel: every level finer than the one matching the screen size is wasted
+					const float Size = static_cast<float>(std::max(Streamed.Image.Width, Streamed.Image.Height));
+					const float Ratio = Size / std::max(ScreenPixels, 1.0f);
+					const int Level = Ratio > 1.0f ? static_cast<int>(std::floor(std::log2(Ratio))) : 0;
+					Streamed.DesiredLevel = std::min(Streamed.DesiredLevel, Level);
+				}
+			}
+		}
+
+		// Evicts the least recently used texture holding finer levels than it needs, skipping Keep
+		auto EvictOne = [this](const StreamedTexture* Keep) -> bool
+		{
+			StreamedTexture* Victim = nullptr;
+			for (StreamedTexture& Streamed : m_Textures)
+			{
+				if (&Streamed != Keep && Streamed.ResidentLevel < Streamed.DesiredLevel &&
+					(!Victim || Streamed.LastUsedFrame < Victim->LastUsedFrame))
+				{
+					Victim = &Streamed;
+				}
+			}
+
+			if (!Victim)
+				return false;
+
+			MakeResident(*Victim, Victim->DesiredLevel);
+			return true;
+		};
+
+		while (m_ResidentBytes > m_Budget && EvictOne(nullptr))
+		{
+		}
+
+		// Textures missing the most levels are upgraded first
+		std::vector<StreamedTexture*> Upgrades;
+		for (StreamedTexture& Streamed : m_Textures)
+		{
+			if (Streamed.DesiredLevel < Streamed.ResidentLevel)
+			{
+				Upgrades.push_back(&Streamed);
+			}
+		}
+		std::sort(Upgrades.begin(), Upgrades.end(), [](const StreamedTexture* A, const StreamedTexture* B)
+		{
+			return A->ResidentLevel - A->DesiredLevel > B->ResidentLevel - B->DesiredLevel;
+		});
+
+		int Uploads = 0;
+		for (StreamedTexture* Streamed : Upgrades)
+		{
+			if (Uploads >= m_MaxUploadsPerFrame)
+				break;
+
+			const size_t Needed = GetLevelBytes(*Streamed, Streamed->DesiredLevel) - Streamed->ResidentBytes;
+			while (m_ResidentBytes + Needed > m_Budget && EvictOne(Streamed))
+			{
+			}
+			if (m_ResidentBytes + Needed > m_Budget)
+				continue;
+
+			MakeResident(*Streamed, Streamed->DesiredLevel);
+			Uploads++;
+		}
+	}
+
+	void TextureStreamer::SetBudget(size_t Bytes)
+	{
+		m_Budget = Bytes;
+	}
+
+	void TextureStreamer::SetMaxUploadsPerFrame(int Count)
+	{
+		m_MaxUploadsPerFrame = std::max(Count, 1);
+	}
+
+	size_t TextureStreamer::GetResidentBytes() const
+	{
+		return m_ResidentBytes;
+	}
+
+	size_t TextureStreamer::GetBudget() const
+	{
+		return m_Budget;
+	}
+
+	int TextureStreamer::GetCoarsestLevel(const StreamedTexture& Streamed)
+	{
+		int Level = 0;
+		while (Level < Streamed.LevelCount - 1)
+		{
+			const int Size = Streamed.Image.CompressedFormat != 0
+				? std::max(Streamed.Image.Levels[Level].Width, Streamed.Image.Levels[Level].Height)
+				: std::max(Streamed.Image.Width, Streamed.Image.Height) >> Level;
+			if (Size <= MinResidentSize)
+				break;
+			Level++;
+		}
+		return Level;
+	}
+
+	size_t TextureStreamer::GetLevelBytes(const StreamedTexture& Streamed, int Level)
+	{
+		size_t Bytes = 0;
+		for (int Mip = Level; Mip < Streamed.LevelCount; Mip++)
+		{
+			if (Streamed.Image.CompressedFormat != 0)
+			{
+				Bytes += Streamed.Image.Levels[Mip].Size;
+			}
+			else
+			{
+				// Drivers usually pad RGB texels to four bytes
+				const size_t Width = std::max(Streamed.Image.Width >> Mip, 1);
+				const size_t Height = std::max(Streamed.Image.Height >> Mip, 1);
+				Bytes += Width * Height * 4;
+			}
+		}
+		return Bytes;
+	}
+
+	ImageData TextureStreamer::Downsample(const ImageData& Image, int Level)
+	{
+		ImageData Result = Image;
+		for (int Mip = 0; Mip < Level; Mip++)
+		{
+			const int Width = std::max(Result.Width / 2, 1);
+			const int Height = std::max(Result.Height / 2, 1);
+			const int Channels = Result.Channels;
+			std::shared_ptr<unsigned char> Pixels = MemoryTracker::MakeSharedBuffer(MemoryTag::Textures, static_cast<size_t>(Width) * Height * Channels);
+
+			const unsigned char* Source = Result.Pixels.get();
+			for (int Y = 0; Y < Height; Y++)
+			{
+				const int Y0 = std::min(Y * 2, Result.Height - 1), Y1 = std::min(Y * 2 + 1, Result.Height - 1);
+				for (int X = 0; X < Width; X++)
+				{
+					const int X0 = std::min(X * 2, Result.Width - 1), X1 = std::min(X * 2 + 1, Result.Width - 1);
+					for (int Channel = 0; Channel < Channels; Channel++)
+					{
+						const int Sum = Source[(static_cast<size_t>(Y0) * Result.Width + X0) * Channels + Channel] +
+							Source[(static_cast<size_t>(Y0) * Result.Width + X1) * Channels + Channel] +
+							Source[(static_cast<size_t>(Y1) * Result.Width + X0) * Channels + Channel] +
+							Source[(static_cast<size_t>(Y1) * Result.Width + X1) * Channels + Channel];
+						Pixels.get()[(static_cast<size_t>(Y) * Width + X) * Channels + Channel] = static_cast<unsigned char>((Sum + 2) / 4);
+					}
+				}
+			}
+
+			Result.Pixels = std::move(Pixels);
+			Result.Width = Width;
+			Result.Height = Height;
+		}
+		return Result;
+	}
+
+	void TextureStreamer::MakeResident(StreamedTexture& Streamed, int Level)
+	{
+		Level = std::clamp(Level, 0, Streamed.LevelCount - 1);
+		if (Level == Streamed.ResidentLevel)
+			return;
+
+		// Clamping the base level alone doesn't free memory, the texture is re-created with the levels it keeps
+		const bool bCreated = Streamed.Image.CompressedFormat != 0
+			? Streamed.Handle->UploadMipRange(Streamed.Image, Level)
+			: Streamed.Handle->UploadMipRange(Downsample(Streamed.Image, Level), Level);
+		if (!bCreated)
+			return;
+
+		m_ResidentBytes -= Streamed.ResidentBytes;
+		Streamed.ResidentBytes = GetLevelBytes(Streamed, Level);
+		Streamed.ResidentLevel = Level;
+		m_ResidentBytes += Streamed.ResidentBytes;
+	}
+
+} // namespace fgl
\ No newline at end of file
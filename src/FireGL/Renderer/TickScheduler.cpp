@@ -0,0 +1,123 @@
+#include <FireGL/Renderer/TickScheduler.h>
+#include <FireGL/Renderer/SceneObject.h>
+#include <FireGL/Core/JobSystem.h>
+
+namespace fgl
+{
+
+	void TickScheduler::Refresh(SceneObject* Object)
+	{
+		std::lock_guard<std::mutex> Lock(m_RefreshMutex);
+		m_Refreshes.push_back(Object);
+	}
+
+	void TickScheduler::ApplyRefreshes()
+	{
+		std::lock_guard<std::mutex> Lock(m_RefreshMutex);
+		for (SceneObject* Object : m_Refreshes)
+		{
+			// Re-adding resets the interval, a refreshed object is due after a whole interval again
+			Remove(Object);
+			if (Object->GetScene() && Object->WantsTick() && Object->IsTickEnabled() && !Object->IsSleeping())
+			{
+				Add(Object);
+			}
+		}
+		m_Refreshes.clear();
+	}
+
+	void TickScheduler::Add(SceneObject* Object)
+	{
+		auto& Entries = m_Groups[static_cast<size_t>(Object->GetTickGroup())];
+		const uint32_t Slot = static_cast<uint32_t>(Entries.size());
+
+		Entry& Added = Entries.emplace_back();
+		Added.Object = Object;
+		Added.IntervalSeconds = Object->GetTickIntervalSeconds();
+		Added.IntervalFrames = Object->GetTickIntervalFrames();
+		// Objects added together would all come due on the same frame, the slot spreads them over the interval
+		Added.FramesLeft = 1 + Slot % Added.IntervalFrames;
+		Object->SetTickSlot(Object->GetTickGroup(), Slot);
+	}
+
+	void TickScheduler::Remove(SceneObject* Object)
+	{
+		const uint32_t Slot = Object->GetTickSlot();
+		if (Slot == InvalidSlot)
+			return;
+
+		// Swap-and-pop, the order of the objects in a group doesn't matter
+		auto& Entries = m_Groups[static_cast<size_t>(Object->GetTickSlotGroup())];
+		if (Slot + 1 != Entries.size())
+		{
+			Entries[Slot] = Entries.back();
+			Entries[Slot].Object->SetTickSlot(Object->GetTickSlotGroup(), Slot);
+		}
+		Entries.pop_back();
+		Object->SetTickSlot(Object->GetTickSlotGroup(), InvalidSlot);
+	}
+
+	void TickScheduler::Tick(TickGroup Group, float DeltaTime, JobSystem* Jobs, size_t ChunkSize)
+	{
+		ApplyRefreshes();
+
+		m_DueTicks.clear();
+		for (Entry& Scheduled : m_Groups[static_cast<size_t>(Group)])
+		{
+			Scheduled.Elapsed += DeltaTime;
+			Scheduled.FramesLeft = Scheduled.FramesLeft > 0 ? Scheduled.FramesLeft - 1 : 0;
+			if (Scheduled.FramesLeft > 0 || Scheduled.Elapsed < Scheduled.IntervalSeconds)
+				continue;
+
+			m_DueTicks.emplace_back(Scheduled.Object, Scheduled.Elapsed);
+			Scheduled.Elapsed = 0.0f;
+			Scheduled.FramesLeft = Scheduled.IntervalFrames;
+		}
+		m_TickedCounts[static_cast<size_t>(Group)] = m_DueTicks.size();
+
+		if (!Jobs)
+		{
+			for (const auto& [Object, Elapsed] : m_DueTicks)
+			{
+				Object->Tick(Elapsed);
+			}
+			return;
+		}
+
+		// Thread-safe objects only touch their own state, they run before the others so nothing observes them mid-tick
+		m_ParallelTicks.clear();
+		for (const DueTick& Due : m_DueTicks)
+		{
+			if (Due.first->IsTickThreadSafe())
+			{
+				m_ParallelTicks.push_back(Due);
+			}
+		}
+		Jobs->ParallelFor(m_ParallelTicks.size(), ChunkSize, [this](size_t Begin, size_t End)
+		{
+			for (size_t Index = Begin; Index < End; Index++)
+			{
+				m_ParallelTicks[Index].first->Tick(m_ParallelTicks[Index].second);
+			}
+		});
+
+		for (const auto& [Object, Elapsed] : m_DueTicks)
+		{
+			if (!Object->IsTickThreadSafe())
+			{
+				Object->Tick(Elapsed);
+			}
+		}
+	}
+
+	size_t TickScheduler::GetActiveCount(TickGroup Group) const
+	{
+		return m_Groups[static_cast<size_t>(Group)].size();
+	}
+
+	size_t TickScheduler::GetTickedCount(TickGroup Group) const
+	{
+		return m_TickedCounts[static_cast<size_t>(Group)];
+	}
+
+} // namespace fgl
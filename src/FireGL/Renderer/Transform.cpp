@@ -1,4 +1,5 @@
 #include <FireGL/Renderer/Transform.h>
+#include <FireGL/Renderer/TransformPool.h>
 #include <FireGL/Renderer/SceneObject.h>
 #include <FireGL/Renderer/BaseCamera.h>
 #include <FireGL/Core/BaseLog.h>
@@ -6,143 +7,226 @@
 namespace fgl
 {
     Transform::Transform(SceneObject* Owner)
-        : m_Position(0.0f), m_Rotation(0.0f), 
-          m_Scale(1.0f), m_Owner(Owner),
-          m_Dirty(true)
+        : m_Handle(TransformPool::Allocate(Owner))
     {
     }
 
+    Transform::~Transform()
+    {
+        TransformPool::Free(m_Handle);
+    }
+
     void Transform::SetPosition(float X, float Y, float Z)
     {
-        m_Position = glm::vec3(X, Y, Z);
-        m_Dirty = true;
+        TransformPool::s_Positions[m_Handle] = glm::vec3(X, Y, Z);
+        MarkDirty();
     }
 
     void Transform::SetPosition(const glm::vec3& NewPosition)
     {
-        m_Position = NewPosition;
-        m_Dirty = true;
+        TransformPool::s_Positions[m_Handle] = NewPosition;
+        MarkDirty();
     }
 
     void Transform::MoveBy(float DeltaX, float DeltaY, float DeltaZ)
     {
-        m_Position += glm::vec3(DeltaX, DeltaY, DeltaZ);
-        m_Dirty = true;
+        TransformPool::s_Positions[m_Handle] += glm::vec3(DeltaX, DeltaY, DeltaZ);
+        MarkDirty();
     }
 
     void Transform::MoveBy(const glm::vec3& Offset)
     {
-        m_Position += Offset;
-        m_Dirty = true;
+        TransformPool::s_Positions[m_Handle] += Offset;
+        MarkDirty();
     }
 
     const glm::vec3& Transform::GetPosition() const
     {
-        return m_Position;
+        return TransformPool::s_Positions[m_Handle];
     }
 
     void Transform::SetRotation(float Pitch, float Yaw, float Roll)
     {
-        m_Rotation = glm::vec3(Pitch, Yaw, Roll);
-        m_Dirty = true;
+        TransformPool::SetEulerRotation(m_Handle, glm::vec3(Pitch, Yaw, Roll));
+        MarkDirty();
     }
 
     void Transform::SetRotation(const glm::vec3& NewRotation)
     {
-        m_Rotation = NewRotation;
-        m_Dirty = true;
+        TransformPool::SetEulerRotation(m_Handle, NewRotation);
+        MarkDirty();
     }
 
     void Transform::RotateBy(float DeltaPitch, float DeltaYaw, float DeltaRoll)
     {
-        m_Rotation += glm::vec3(DeltaPitch, DeltaYaw, DeltaRoll);
-        m_Dirty = true;
+        TransformPool::SetEulerRotation(m_Handle, TransformPool::s_Rotations[m_Handle] + glm::vec3(DeltaPitch, DeltaYaw, DeltaRoll));
+        MarkDirty();
     }
 
     void Transform::RotateBy(const glm::vec3& RotationOffset)
     {
-        m_Rotation += RotationOffset;
-        m_Dirty = true;
+        TransformPool::SetEulerRotation(m_Handle, TransformPool::s_Rotations[m_Handle] + RotationOffset);
+        MarkDirty();
     }
 
     const glm::vec3& Transform::GetRotation() const
     {
-        return m_Rotation;
+        return TransformPool::s_Rotations[m_Handle];
+    }
+
+    void Transform::SetOrientation(const glm::quat& NewOrientation)
+    {
+        TransformPool::SetOrientation(m_Handle, NewOrientation);
+        MarkDirty();
+    }
+
+    void Transform::RotateBy(const glm::quat& RotationOffset)
+    {
+        TransformPool::SetOrientation(m_Handle, TransformPool::s_Orientations[m_Handle] * RotationOffset);
+        MarkDirty();
+    }
+
+    const glm::quat& Transform::GetOrientation() const
+    {
+        return TransformPool::s_Orientations[m_Handle];
     }
 
     void Transform::SetScale(float X, float Y, float Z)
     {
-        m_Scale = glm::vec3(X, Y, Z);
-        m_Dirty = true;
+        TransformPool::s_Scales[m_Handle] = glm::vec3(X, Y, Z);
+        MarkDirty();
     }
 
     void Transform::SetScale(const glm::vec3& NewScale)
     {
-        m_Scale = NewScale;
-        m_Dirty = true;
+        TransformPool::s_Scales[m_Handle] = NewScale;
+        MarkDirty();
     }
 
     void Transform::SetUniformScale(float ScaleFactor)
     {
-        m_Scale = glm::vec3(ScaleFactor);
-        m_Dirty = true;
+        TransformPool::s_Scales[m_Handle] = glm::vec3(ScaleFactor);
+        MarkDirty();
     }
 
     void Transform::ScaleBy(float FactorX, float FactorY, float FactorZ)
     {
-        m_Scale *= glm::vec3(FactorX, FactorY, FactorZ);
-        m_Dirty = true;
+        TransformPool::s_Scales[m_Handle] *= glm::vec3(FactorX, FactorY, FactorZ);
+        MarkDirty();
     }
 
     void Transform::ScaleBy(const glm::vec3& ScaleOffset)
     {
-        m_Scale *= ScaleOffset;
-        m_Dirty = true;
+        TransformPool::s_Scales[m_Handle] *= ScaleOffset;
+        MarkDirty();
     }
 
     void Transform::ScaleByUniform(float Factor)
     {
-        m_Scale *= Factor;
-        m_Dirty = true;
+        TransformPool::s_Scales[m_Handle] *= Factor;
+        MarkDirty();
     }
 
     const glm::vec3& Transform::GetScale() const
     {
-        return m_Scale;
+        return TransformPool::s_Scales[m_Handle];
     }
 
     void Transform::ComputeModelViewProjection(glm::mat4& OutModelViewProjection, glm::mat4& OutModelMatrix)
     {
-        if (!m_Owner)
+        SceneObject* Owner = TransformPool::s_Owners[m_Handle];
+        if (!Owner)
         {
             LOG_ERROR("Invalid owner. For camera usage, call the appropriate function to retrieve the MVP.", true)
         }
-        std::shared_ptr<BaseCamera> ActiveCamera = m_Owner->GetScene()->GetActiveCamera();
+        std::shared_ptr<BaseCamera> ActiveCamera = Owner->GetScene()->GetActiveCamera();
 
-        if (m_Dirty)
+        TransformPool::Resolve(m_Handle);
+
+        ApplyCachedModelMatrix(OutModelViewProjection, OutModelMatrix, ActiveCamera);
+    }
+
+    void Transform::MarkDirty()
+    {
+        // Only the first change since the last recalculation is reported, a moved object is queued once
+        uint8_t& Dirty = TransformPool::s_Dirty[m_Handle];
+        SceneObject* Owner = TransformPool::s_Owners[m_Handle];
+        if (!Dirty && Owner)
         {
-            RecalculateModelMatrix();
+            Owner->OnTransformChanged();
         }
+        Dirty = 1;
+        TransformPool::TrackMotion(m_Handle);
+        TransformPool::s_bChanged.store(true, std::memory_order_relaxed);
+    }
 
-        ApplyCachedModelMatrix(OutModelViewProjection, OutModelMatrix, ActiveCamera);
+    glm::mat4 Transform::ComputeLocalMatrix() const
+    {
+        return TransformPool::ComposeLocalMatrix(m_Handle);
+    }
+
+    const glm::mat4& Transform::GetModelMatrix()
+    {
+        TransformPool::Resolve(m_Handle);
+        return TransformPool::s_ModelMatrices[m_Handle];
+    }
+
+    const glm::mat3& Transform::GetNormalMatrix()
+    {
+        TransformPool::Resolve(m_Handle);
+        return TransformPool::s_NormalMatrices[m_Handle];
+    }
+
+    bool Transform::SetParent(Transform* Parent)
+    {
+        return TransformPool::SetParent(m_Handle, Parent ? Parent->m_Handle : TransformPool::NullHandle);
+    }
+
+    bool Transform::HasParent() const
+    {
+        return TransformPool::s_Parents[m_Handle] != TransformPool::NullHandle;
+    }
+
+    bool Transform::IsDirty() const
+    {
+        return TransformPool::IsStale(m_Handle);
+    }
+
+    uint64_t Transform::GetRevision() const
+    {
+        return TransformPool::s_Revisions[m_Handle];
+    }
+
+    const glm::mat4& Transform::GetRenderModelMatrix()
+    {
+        // Slots allocated since the capture aren't part of the frame, they fall back on the live matrices
+        if (TransformPool::s_bSnapshot && m_Handle < TransformPool::s_SnapshotModelMatrices.size())
+            return TransformPool::s_SnapshotModelMatrices[m_Handle];
+
+        return GetModelMatrix();
+    }
+
+    const glm::mat3& Transform::GetRenderNormalMatrix()
+    {
+        if (TransformPool::s_bSnapshot && m_Handle < TransformPool::s_SnapshotNormalMatrices.size())
+            return TransformPool::s_SnapshotNormalMatrices[m_Handle];
+
+        return GetNormalMatrix();
     }
 
-    void Transform::RecalculateModelMatrix()
+    uint64_t Transform::GetRenderRevision() const
     {
-        m_CachedModelMatrix =
-            glm::translate(glm::mat4(1.0f), m_Position) *
-            glm::rotate(glm::mat4(1.0f), glm::radians(m_Rotation.x), glm::vec3(1, 0, 0)) *
-            glm::rotate(glm::mat4(1.0f), glm::radians(m_Rotation.y), glm::vec3(0, 1, 0)) *
-            glm::rotate(glm::mat4(1.0f), glm::radians(m_Rotation.z), glm::vec3(0, 0, 1)) *
-            glm::scale(glm::mat4(1.0f), m_Scale);
+        if (TransformPool::s_bSnapshot && m_Handle < TransformPool::s_SnapshotRevisions.size())
+            return TransformPool::s_SnapshotRevisions[m_Handle];
 
-        m_Dirty = false;
+        return GetRevision();
     }
 
     void Transform::ApplyCachedModelMatrix(glm::mat4& OutModelViewProjection, glm::mat4& OutModelMatrix, std::shared_ptr<BaseCamera>& Camera)
     {
-        OutModelMatrix = m_CachedModelMatrix;
-        OutModelViewProjection = Camera->GetProjectionMatrix() * Camera->GetViewMatrix() * m_CachedModelMatrix;
+        const glm::mat4& ModelMatrix = TransformPool::s_ModelMatrices[m_Handle];
+        OutModelMatrix = ModelMatrix;
+        OutModelViewProjection = Camera->GetProjectionMatrix() * Camera->GetViewMatrix() * ModelMatrix;
     }
 
 } // namespace fgl
\ No newline at end of file
@@ -0,0 +1,440 @@
+#include <FireGL/Renderer/TransformPool.h>
+#include <FireGL/Renderer/SceneObject.h>
+#include <FireGL/Core/JobSystem.h>
+#include <FireGL/Core/BaseLog.h>
+
+#include <External/glm/gtx/euler_angles.hpp>
+
+namespace fgl
+{
+
+	std::vector<glm::vec3> TransformPool::s_Positions;
+	std::vector<glm::vec3> TransformPool::s_Rotations;
+	std::vector<glm::quat> TransformPool::s_Orientations;
+	std::vector<glm::vec3> TransformPool::s_Scales;
+	std::vector<glm::mat4> TransformPool::s_ModelMatrices;
+	std::vector<glm::mat3> TransformPool::s_NormalMatrices;
+	std::vector<uint8_t> TransformPool::s_Dirty;
+	std::vector<uint64_t> TransformPool::s_Revisions;
+	std::vector<SceneObject*> TransformPool::s_Owners;
+	std::vector<uint32_t> TransformPool::s_Parents;
+	std::vector<uint64_t> TransformPool::s_ParentRevisions;
+	std::vector<uint32_t> TransformPool::s_ChildCounts;
+	std::vector<uint32_t> TransformPool::s_FreeHandles;
+	std::vector<uint32_t> TransformPool::s_LevelOrder;
+	std::vector<size_t> TransformPool::s_LevelStarts;
+	std::vector<glm::vec3> TransformPool::s_PreviousPositions;
+	std::vector<glm::quat> TransformPool::s_PreviousOrientations;
+	std::vector<glm::vec3> TransformPool::s_PreviousScales;
+	std::vector<uint8_t> TransformPool::s_Interpolated;
+	std::vector<uint32_t> TransformPool::s_InterpolatedHandles;
+	std::mutex TransformPool::s_InterpolatedMutex;
+	bool TransformPool::s_bInterpolation = false;
+	float TransformPool::s_InterpolationAlpha = 1.0f;
+	std::vector<glm::mat4> TransformPool::s_SnapshotModelMatrices;
+	std::vector<glm::mat3> TransformPool::s_SnapshotNormalMatrices;
+	std::vector<uint64_t> TransformPool::s_SnapshotRevisions;
+	bool TransformPool::s_bSnapshot = false;
+	bool TransformPool::s_bLevelOrderDirty = true;
+	std::atomic<bool> TransformPool::s_bChanged = false;
+
+	uint32_t TransformPool::Allocate(SceneObject* Owner)
+	{
+		uint32_t Handle;
+		if (!s_FreeHandles.empty())
+		{
+			Handle = s_FreeHandles.back();
+			s_FreeHandles.pop_back();
+		}
+		else
+		{
+			Handle = static_cast<uint32_t>(s_Positions.size());
+			s_Positions.emplace_back();
+			s_Rotations.emplace_back();
+			s_Orientations.emplace_back();
+			s_Scales.emplace_back();
+			s_ModelMatrices.emplace_back();
+			s_NormalMatrices.emplace_back();
+			s_Dirty.emplace_back();
+			s_Revisions.emplace_back();
+			s_Owners.emplace_back();
+			s_Parents.emplace_back();
+			s_ParentRevisions.emplace_back();
+			s_ChildCounts.emplace_back();
+			s_PreviousPositions.emplace_back();
+			s_PreviousOrientations.emplace_back();
+			s_PreviousScales.emplace_back();
+			s_Interpolated.emplace_back();
+			s_bLevelOrderDirty = true;
+		}
+
+		s_Positions[Handle] = glm::vec3(0.0f);
+		s_Rotations[Handle] = glm::vec3(0.0f);
+		s_Orientations[Handle] = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+		s_Scales[Handle] = glm::vec3(1.0f);
+		s_Dirty[Handle] = 1;
+		s_Revisions[Handle] = 0;
+		s_Owners[Handle] = Owner;
+		s_Parents[Handle] = NullHandle;
+		s_ParentRevisions[Handle] = 0;
+		s_ChildCounts[Handle] = 0;
+		s_Interpolated[Handle] = 0;
+		s_bChanged.store(true, std::memory_order_relaxed);
+		return Handle;
+	}
+
+	void TransformPool::Free(uint32_t Handle)
+	{
+		// Owners are being destroyed along with their scene, nobody is notified here
+		uint32_t& Parent = s_Parents[Handle];
+		if (Parent != NullHandle)
+		{
+			s_ChildCounts[Parent]--;
+			Parent = NullHandle;
+		}
+		if (s_ChildCounts[Handle] > 0)
+		{
+			for (uint32_t Child = 0; Child < s_Parents.size(); Child++)
+			{
+				if (s_Parents[Child] == Handle)
+				{
+					s_Parents[Child] = NullHandle;
+					s_Dirty[Child] = 1;
+				}
+			}
+			s_ChildCounts[Handle] = 0;
+			s_bChanged.store(true, std::memory_order_relaxed);
+		}
+		s_bLevelOrderDirty = true;
+
+		// Released slots stay clean so the sweep skips them
+		s_Dirty[Handle] = 0;
+		s_Interpolated[Handle] = 0;
+		s_Owners[Handle] = nullptr;
+		s_FreeHandles.push_back(Handle);
+	}
+
+	bool TransformPool::SetParent(uint32_t Handle, uint32_t Parent)
+	{
+		for (uint32_t Ancestor = Parent; Ancestor != NullHandle; Ancestor = s_Parents[Ancestor])
+		{
+			if (Ancestor == Handle)
+			{
+				LOG_ERROR("A transform can't be parented to itself or to one of its descendants", false)
+				return false;
+			}
+		}
+
+		uint32_t& CurrentParent = s_Parents[Handle];
+		if (CurrentParent == Parent)
+			return true;
+
+		if (CurrentParent != NullHandle)
+		{
+			s_ChildCounts[CurrentParent]--;
+		}
+		if (Parent != NullHandle)
+		{
+			s_ChildCounts[Parent]++;
+		}
+		CurrentParent = Parent;
+
+		// The world matrix changes with the parent, even though the local values don't
+		if (!s_Dirty[Handle] && s_Owners[Handle])
+		{
+			s_Owners[Handle]->OnTransformChanged();
+		}
+		s_Dirty[Handle] = 1;
+		s_bLevelOrderDirty = true;
+		s_bChanged.store(true, std::memory_order_relaxed);
+		return true;
+	}
+
+	void TransformPool::UpdateDirtyMatrices(JobSystem* Jobs, size_t ChunkSize)
+	{
+		if (!s_bChanged.exchange(false, std::memory_order_relaxed))
+			return;
+
+		if (s_bLevelOrderDirty)
+		{
+			RebuildLevelOrder();
+		}
+
+		const auto Sweep = [](size_t Begin, size_t End)
+		{
+			for (size_t Entry = Begin; Entry < End; Entry++)
+			{
+				const uint32_t Handle = s_LevelOrder[Entry];
+				if (IsOutOfDate(Handle))
+				{
+					RecalculateModelMatrix(Handle);
+				}
+			}
+		};
+
+		// A level only reads the world matrices of the previous one, its slots are independent
+		for (size_t Level = 0; Level + 1 < s_LevelStarts.size(); Level++)
+		{
+			const size_t Begin = s_LevelStarts[Level];
+			const size_t End = s_LevelStarts[Level + 1];
+			if (!Jobs || End - Begin <= ChunkSize)
+			{
+				Sweep(Begin, End);
+				continue;
+			}
+			Jobs->ParallelFor(End - Begin, ChunkSize, [&Sweep, Begin](size_t First, size_t Last)
+			{
+				Sweep(Begin + First, Begin + Last);
+			});
+		}
+	}
+
+	void TransformPool::SetInterpolation(bool bEnabled)
+	{
+		if (s_bInterpolation == bEnabled)
+			return;
+
+		s_bInterpolation = bEnabled;
+		if (!bEnabled)
+		{
+			SetInterpolationAlpha(1.0f);
+			BeginFixedStep();
+		}
+	}
+
+	void TransformPool::BeginFixedStep()
+	{
+		// Listed slots now start from where they are; the others already match their previous state
+		for (uint32_t Handle : s_InterpolatedHandles)
+		{
+			if (!s_Interpolated[Handle])
+				continue;
+
+			s_PreviousPositions[Handle] = s_Positions[Handle];
+			s_PreviousOrientations[Handle] = s_Orientations[Handle];
+			s_PreviousScales[Handle] = s_Scales[Handle];
+			s_Interpolated[Handle] = 0;
+
+			// Rendered partway through the previous step, it must reach its current state even if it stops here
+			FlagRecalculation(Handle);
+		}
+		s_InterpolatedHandles.clear();
+	}
+
+	void TransformPool::SetInterpolationAlpha(float Alpha)
+	{
+		s_InterpolationAlpha = std::clamp(Alpha, 0.0f, 1.0f);
+		for (uint32_t Handle : s_InterpolatedHandles)
+		{
+			if (s_Interpolated[Handle])
+			{
+				FlagRecalculation(Handle);
+			}
+		}
+	}
+
+	void TransformPool::FlagRecalculation(uint32_t Handle)
+	{
+		// Same as Transform::MarkDirty(), the rendered matrix moves although the local values didn't
+		if (!s_Dirty[Handle] && s_Owners[Handle])
+		{
+			s_Owners[Handle]->OnTransformChanged();
+		}
+		s_Dirty[Handle] = 1;
+		s_bChanged.store(true, std::memory_order_relaxed);
+	}
+
+	void TransformPool::TrackMotion(uint32_t Handle)
+	{
+		// Never-rendered slots appear where they were placed instead of sliding from the origin
+		if (!s_bInterpolation || s_Interpolated[Handle] || s_Revisions[Handle] == 0)
+			return;
+
+		s_Interpolated[Handle] = 1;
+		std::lock_guard<std::mutex> Lock(s_InterpolatedMutex);
+		s_InterpolatedHandles.push_back(Handle);
+	}
+
+	size_t TransformPool::GetSize()
+	{
+		return s_Positions.size();
+	}
+
+	void TransformPool::CaptureSnapshot()
+	{
+		// Assigning keeps the capacity, frames after the first copy without allocating
+		s_SnapshotModelMatrices = s_ModelMatrices;
+		s_SnapshotNormalMatrices = s_NormalMatrices;
+		s_SnapshotRevisions = s_Revisions;
+		s_bSnapshot = true;
+	}
+
+	void TransformPool::DiscardSnapshot()
+	{
+		s_bSnapshot = false;
+	}
+
+	bool TransformPool::HasSnapshot()
+	{
+		return s_bSnapshot;
+	}
+
+	bool TransformPool::IsOutOfDate(uint32_t Handle)
+	{
+		const uint32_t Parent = s_Parents[Handle];
+		return s_Dirty[Handle] || (Parent != NullHandle && s_ParentRevisions[Handle] != s_Revisions[Parent]);
+	}
+
+	bool TransformPool::IsStale(uint32_t Handle)
+	{
+		for (uint32_t Node = Handle; Node != NullHandle; Node = s_Parents[Node])
+		{
+			if (IsOutOfDate(Node))
+				return true;
+		}
+		return false;
+	}
+
+	void TransformPool::SetEulerRotation(uint32_t Handle, const glm::vec3& Degrees)
+	{
+		// Same order as rotate(X) * rotate(Y) * rotate(Z), the trig is paid once here instead of per rebuild
+		const glm::vec3 Radians = glm::radians(Degrees);
+		s_Rotations[Handle] = Degrees;
+		s_Orientations[Handle] =
+			glm::angleAxis(Radians.x, glm::vec3(1, 0, 0)) *
+			glm::angleAxis(Radians.y, glm::vec3(0, 1, 0)) *
+			glm::angleAxis(Radians.z, glm::vec3(0, 0, 1));
+	}
+
+	void TransformPool::SetOrientation(uint32_t Handle, const glm::quat& Orientation)
+	{
+		const glm::quat Normalized = glm::normalize(Orientation);
+		glm::vec3 Radians;
+		glm::extractEulerAngleXYZ(glm::mat4_cast(Normalized), Radians.x, Radians.y, Radians.z);
+		s_Rotations[Handle] = glm::degrees(Radians);
+		s_Orientations[Handle] = Normalized;
+	}
+
+	glm::mat4 TransformPool::ComposeLocalMatrix(uint32_t Handle)
+	{
+		return ComposeMatrix(s_Positions[Handle], s_Orientations[Handle], s_Scales[Handle]);
+	}
+
+	glm::mat4 TransformPool::ComposeMatrix(const glm::vec3& Position, const glm::quat& Orientation, const glm::vec3& Scale)
+	{
+		const glm::mat3 Rotation = glm::mat3_cast(Orientation);
+		return glm::mat4(
+			glm::vec4(Rotation[0] * Scale.x, 0.0f),
+			glm::vec4(Rotation[1] * Scale.y, 0.0f),
+			glm::vec4(Rotation[2] * Scale.z, 0.0f),
+			glm::vec4(Position, 1.0f));
+	}
+
+	void TransformPool::Resolve(uint32_t Handle)
+	{
+		const uint32_t Parent = s_Parents[Handle];
+		if (Parent != NullHandle)
+		{
+			Resolve(Parent);
+		}
+		if (IsOutOfDate(Handle))
+		{
+			RecalculateModelMatrix(Handle);
+		}
+	}
+
+	void TransformPool::RecalculateModelMatrix(uint32_t Handle)
+	{
+		const uint32_t Parent = s_Parents[Handle];
+
+		// Interpolated slots render between their previous and current state, the others sync their previous state
+		glm::vec3 Position = s_Positions[Handle];
+		glm::quat Orientation = s_Orientations[Handle];
+		glm::vec3 Scale = s_Scales[Handle];
+		if (s_Interpolated[Handle])
+		{
+			Position = glm::mix(s_PreviousPositions[Handle], Position, s_InterpolationAlpha);
+			Orientation = glm::slerp(s_PreviousOrientations[Handle], Orientation, s_InterpolationAlpha);
+			Scale = glm::mix(s_PreviousScales[Handle], Scale, s_InterpolationAlpha);
+		}
+		else
+		{
+			s_PreviousPositions[Handle] = Position;
+			s_PreviousOrientations[Handle] = Orientation;
+			s_PreviousScales[Handle] = Scale;
+		}
+
+		glm::mat4& ModelMatrix = s_ModelMatrices[Handle];
+		ModelMatrix = ComposeMatrix(Position, Orientation, Scale);
+		if (Parent != NullHandle)
+		{
+			ModelMatrix = s_ModelMatrices[Parent] * ModelMatrix;
+			s_ParentRevisions[Handle] = s_Revisions[Parent];
+		}
+
+		// The inverse-transpose of R*S is R*S^-1, no inverse needed; a parent may shear the world matrix though
+		if (Parent == NullHandle && Scale.x != 0.0f && Scale.y != 0.0f && Scale.z != 0.0f)
+		{
+			const glm::mat3 Rotation = glm::mat3_cast(Orientation);
+			s_NormalMatrices[Handle] = glm::mat3(Rotation[0] / Scale.x, Rotation[1] / Scale.y, Rotation[2] / Scale.z);
+		}
+		else
+		{
+			s_NormalMatrices[Handle] = glm::transpose(glm::inverse(glm::mat3(ModelMatrix)));
+		}
+
+		// Moved by its parent only: the owner wasn't told by MarkDirty()
+		if (!s_Dirty[Handle] && s_Owners[Handle])
+		{
+			s_Owners[Handle]->OnTransformChanged();
+		}
+		s_Dirty[Handle] = 0;
+		s_Revisions[Handle]++;
+	}
+
+	void TransformPool::RebuildLevelOrder()
+	{
+		// Depth of every slot, walking up until a slot of known depth; chains are short
+		const size_t Count = s_Parents.size();
+		std::vector<uint32_t> Levels(Count, UINT32_MAX);
+		std::vector<uint32_t> Chain;
+		uint32_t MaxLevel = 0;
+		for (uint32_t Handle = 0; Handle < Count; Handle++)
+		{
+			uint32_t Node = Handle;
+			while (Node != NullHandle && Levels[Node] == UINT32_MAX)
+			{
+				Chain.push_back(Node);
+				Node = s_Parents[Node];
+			}
+
+			uint32_t Level = Node == NullHandle ? 0 : Levels[Node] + 1;
+			while (!Chain.empty())
+			{
+				Levels[Chain.back()] = Level++;
+				Chain.pop_back();
+			}
+			MaxLevel = std::max(MaxLevel, Levels[Handle]);
+		}
+
+		// Counting sort, slots of a level keep their handle order so roots are swept linearly
+		s_LevelStarts.assign(MaxLevel + 2, 0);
+		for (uint32_t Level : Levels)
+		{
+			s_LevelStarts[Level + 1]++;
+		}
+		for (size_t Level = 1; Level < s_LevelStarts.size(); Level++)
+		{
+			s_LevelStarts[Level] += s_LevelStarts[Level - 1];
+		}
+
+		s_LevelOrder.resize(Count);
+		std::vector<size_t> Cursors(s_LevelStarts.begin(), s_LevelStarts.end() - 1);
+		for (uint32_t Handle = 0; Handle < Count; Handle++)
+		{
+			s_LevelOrder[Cursors[Levels[Handle]]++] = Handle;
+		}
+		s_bLevelOrderDirty = false;
+	}
+
+} // namespace fgl
\ No newline at end of file
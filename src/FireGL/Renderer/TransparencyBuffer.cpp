@@ -0,0 +1,189 @@
+#include <FireGL/Renderer/TransparencyBuffer.h>
+#include <FireGL/Renderer/Shader.h>
+#include <FireGL/Renderer/GLStateCache.h>
+#include <FireGL/Renderer/GPUMemoryTracker.h>
+#include <FireGL/Renderer/RenderStats.h>
+#include <FireGL/Core/BaseLog.h>
+
+namespace fgl
+{
+
+	namespace
+	{
+		constexpr std::string_view CompositeVertexCode = R"(#version 410 core
+out vec2 TexCoord;
+
+void main()
+{
+    // vertices (0, 0), (2, 0) and (0, 2) cover the screen
+    TexCoord = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    gl_Position = vec4(TexCoord * 2.0 - 1.0, 0.0, 1.0);
+})";
+
+		constexpr std::string_view CompositeFragmentCode = R"(#version 410 core
+in vec2 TexCoord;
+out vec4 FragColor;
+
+uniform sampler2D Accumulation;
+uniform sampler2D Revealage;
+
+void main()
+{
+    // Fully revealed: no transparent surface covers the pixel
+    float Revealed = texture(Revealage, TexCoord).r;
+    if (Revealed >= 1.0)
+        discard;
+
+    // Sums past the 16-bit float range are clamped rather than turned into infinities
+    vec4 Accumulated = texture(Accumulation, TexCoord);
+    Accumulated = min(Accumulated, vec4(65504.0));
+    FragColor = vec4(Accumulated.rgb / max(Accumulated.a, 1e-5), 1.0 - Revealed);
+})";
+	}
+
+	TransparencyBuffer::~TransparencyBuffer()
+	{
+		Destroy();
+	}
+
+	void TransparencyBuffer::Resize(int Width, int Height)
+	{
+		if (m_Framebuffer != 0 && Width == m_Width && Height == m_Height)
+			return;
+
+		DestroyTargets();
+		m_Width = Width;
+		m_Height = Height;
+
+		m_Accumulation = CreateAttachment(GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT);
+		m_Revealage = CreateAttachment(GL_R16F, GL_RED, GL_HALF_FLOAT);
+		m_Depth = CreateAttachment(GL_DEPTH24_STENCIL8, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8);
+
+		glGenFramebuffers(1, &m_Framebuffer);
+		glBindFramebuffer(GL_FRAMEBUFFER, m_Framebuffer);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_Accumulation, 0);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, m_Revealage, 0);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, m_Depth, 0);
+
+		const GLenum DrawBuffers[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+		glDrawBuffers(2, DrawBuffers);
+		LOG_ASSERT(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE, "Transparency framebuffer is incomplete");
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+		if (m_FullScreenVertexArray == 0)
+		{
+			glGenVertexArrays(1, &m_FullScreenVertexArray);
+		}
+	}
+
+	GLuint TransparencyBuffer::CreateAttachment(GLenum InternalFormat, GLenum Format, GLenum Type) const
+	{
+		GLuint Texture;
+		glGenTextures(1, &Texture);
+		GLStateCache::BindTexture(GL_TEXTURE_2D, Texture);
+		glTexImage2D(GL_TEXTURE_2D, 0, InternalFormat, m_Width, m_Height, 0, Format, Type, nullptr);
+		GPUMemoryTracker::TrackTexture(Texture, GPUMemoryTracker::GetTextureSize(InternalFormat, m_Width, m_Height), GPUMemoryCategory::RenderTargets, "TransparencyBuffer");
+
+		// Sampled at pixel centers, one texel per pixel
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		return Texture;
+	}
+
+	void TransparencyBuffer::DestroyTargets()
+	{
+		if (m_Framebuffer == 0)
+			return;
+
+		glDeleteFramebuffers(1, &m_Framebuffer);
+		m_Framebuffer = 0;
+
+		for (GLuint* Texture : { &m_Accumulation, &m_Revealage, &m_Depth })
+		{
+			glDeleteTextures(1, Texture);
+			GLStateCache::OnTextureDeleted(*Texture);
+			GPUMemoryTracker::UntrackTexture(*Texture);
+			*Texture = 0;
+		}
+	}
+
+	void TransparencyBuffer::Destroy()
+	{
+		DestroyTargets();
+		if (m_CompositeShader)
+		{
+			m_CompositeShader->Cleanup();
+			m_CompositeShader.reset();
+		}
+		if (m_FullScreenVertexArray != 0)
+		{
+			glDeleteVertexArrays(1, &m_FullScreenVertexArray);
+			GLStateCache::OnVertexArrayDeleted(m_FullScreenVertexArray);
+			m_FullScreenVertexArray = 0;
+		}
+	}
+
+	void TransparencyBuffer::BeginAccumulation(GLuint Framebuffer, int X, int Y)
+	{
+		m_Output = Framebuffer;
+		m_OutputX = X;
+		m_OutputY = Y;
+
+		// Transparent surfaces are hidden by the opaque ones, a multisampled depth is resolved by the copy
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, Framebuffer);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_Framebuffer);
+		glBlitFramebuffer(X, Y, X + m_Width, Y + m_Height, 0, 0, m_Width, m_Height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+		glBindFramebuffer(GL_FRAMEBUFFER, m_Framebuffer);
+		glViewport(0, 0, m_Width, m_Height);
+
+		const GLfloat NoAccumulation[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		const GLfloat FullyRevealed[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+		glClearBufferfv(GL_COLOR, 0, NoAccumulation);
+		glClearBufferfv(GL_COLOR, 1, FullyRevealed);
+
+		// Sum of the weighted colors, product of the transmittances
+		glEnable(GL_BLEND);
+		glBlendFunci(0, GL_ONE, GL_ONE);
+		glBlendFunci(1, GL_ZERO, GL_ONE_MINUS_SRC_COLOR);
+		GLStateCache::BeginDepthOverride(GL_LESS, false);
+	}
+
+	void TransparencyBuffer::Composite()
+	{
+		if (!m_CompositeShader)
+		{
+			m_CompositeShader = Shader::CreateFromSource(CompositeVertexCode, CompositeFragmentCode);
+		}
+
+		glBindFramebuffer(GL_FRAMEBUFFER, m_Output);
+		glViewport(m_OutputX, m_OutputY, m_Width, m_Height);
+
+		GLStateCache::BindTextureUnit(AccumulationUnit, GL_TEXTURE_2D, m_Accumulation);
+		GLStateCache::BindTextureUnit(RevealageUnit, GL_TEXTURE_2D, m_Revealage);
+		m_CompositeShader->Activate();
+		m_CompositeShader->SetInt("Accumulation", AccumulationUnit);
+		m_CompositeShader->SetInt("Revealage", RevealageUnit);
+
+		// Average color over the opaque image, weighted by the total coverage
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		GLStateCache::SetDepthFunc(GL_ALWAYS);
+		GLStateCache::BindVertexArray(m_FullScreenVertexArray);
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+		RenderCounters::CountDraw(1, 1);
+		GLStateCache::EndDepthOverride();
+		glDisable(GL_BLEND);
+	}
+
+	int TransparencyBuffer::GetWidth() const
+	{
+		return m_Width;
+	}
+
+	int TransparencyBuffer::GetHeight() const
+	{
+		return m_Height;
+	}
+
+} // namespace fgl
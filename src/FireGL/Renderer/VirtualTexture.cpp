@@ -0,0 +1,740 @@
+#include <FireGL/Renderer/VirtualTexture.h>
+#include <FireGL/Renderer/Texture.h>
+#include <FireGL/Renderer/Shader.h>
+#include <FireGL/Renderer/GLExtensions.h>
+#include <FireGL/Renderer/GLStateCache.h>
+#include <FireGL/Renderer/GPUMemoryTracker.h>
+#include <FireGL/Renderer/RenderStats.h>
+#include <FireGL/Core/Profiler.h>
+#include <FireGL/Core/BaseLog.h>
+
+#include <cstring>
+#include <fstream>
+
+namespace fgl
+{
+
+	namespace
+	{
+		// A feedback pixel packs the page's X and Y in 12 bits each and its level plus one in alpha, 0 where nothing was drawn
+		constexpr std::string_view ShaderCode = R"(
+uniform sampler2D VTCache;
+uniform usampler2D VTIndirection;
+uniform vec2 VTSize;
+uniform float VTPageSize;
+uniform float VTBorder;
+uniform float VTCacheSize;
+uniform float VTMaxLevel;
+uniform float VTFeedbackBias;
+
+float VirtualLevel(vec2 UV, float Bias)
+{
+    vec2 DX = dFdx(UV * VTSize);
+    vec2 DY = dFdy(UV * VTSize);
+    return clamp(0.5 * log2(max(max(dot(DX, DX), dot(DY, DY)), 1e-8)) + Bias, 0.0, VTMaxLevel);
+}
+
+vec4 SampleVirtual(vec2 UV)
+{
+    // The entry of the wanted page names the slot of the finest resident page covering it and that page's level
+    UV = clamp(UV, vec2(0.0), vec2(0.99999));
+    int Level = int(VirtualLevel(UV, 0.0));
+    ivec2 Page = ivec2(UV * VTSize / (VTPageSize * exp2(float(Level))));
+    uvec4 Entry = texelFetch(VTIndirection, min(Page, textureSize(VTIndirection, Level) - 1), Level);
+    vec2 InPage = fract(UV * VTSize / (VTPageSize * exp2(float(Entry.b))));
+    vec2 Texel = vec2(Entry.rg) * (VTPageSize + 2.0 * VTBorder) + VTBorder + InPage * VTPageSize;
+    return textureLod(VTCache, Texel / VTCacheSize, 0.0);
+}
+
+vec4 VirtualFeedback(vec2 UV)
+{
+    UV = clamp(UV, vec2(0.0), vec2(0.99999));
+    int Level = int(VirtualLevel(UV, VTFeedbackBias));
+    uvec2 Page = uvec2(UV * VTSize / (VTPageSize * exp2(float(Level))));
+    return vec4(uvec4(Page & 255u, (Page.x >> 8u) | ((Page.y >> 8u) << 4u), uint(Level) + 1u)) / 255.0;
+}
+)";
+
+		/** @return The indirection entry of a cache slot, in the byte order of an RGBA8 texel. */
+		uint32_t PackEntry(int SlotX, int SlotY, int Level)
+		{
+			const uint8_t Bytes[4] = { static_cast<uint8_t>(SlotX), static_cast<uint8_t>(SlotY), static_cast<uint8_t>(Level), 255 };
+			uint32_t Entry = 0;
+			std::memcpy(&Entry, Bytes, sizeof(Entry));
+			return Entry;
+		}
+	}
+
+	std::pair<int, int> VirtualTexture::GetLevelPages(int Width, int Height, int PageSize, int Level)
+	{
+		// Halving the page counts rather than the level sizes keeps every page over four of the finer level
+		const int PagesX = (Width + PageSize - 1) / PageSize;
+		const int PagesY = (Height + PageSize - 1) / PageSize;
+		return { std::max((PagesX + (1 << Level) - 1) >> Level, 1), std::max((PagesY + (1 << Level) - 1) >> Level, 1) };
+	}
+
+	int VirtualTexture::GetLevelCount(int Width, int Height, int PageSize)
+	{
+		int LevelCount = 1;
+		for (auto Pages = GetLevelPages(Width, Height, PageSize, 0); Pages.first > 1 || Pages.second > 1; )
+		{
+			Pages = GetLevelPages(Width, Height, PageSize, LevelCount++);
+		}
+		return LevelCount;
+	}
+
+	bool VirtualTexture::BuildPageFile(std::string_view ImagePath, std::string_view PageFilePath, const VirtualTextureBuildSettings& Settings)
+	{
+		FGL_PROFILE_SCOPE("VirtualTexture::BuildPageFile")
+		LOG_ASSERT(Settings.PageSize > 0 && Settings.Border >= 0, "Virtual texture pages need a positive size")
+		if (!AssetArchive::IsSupported(Settings.Compression))
+		{
+			LOG_ERROR("The compression method of the page file " + std::string(PageFilePath) + " isn't compiled in.", false);
+			return false;
+		}
+
+		// Flipped like the textures, so the first row is V = 0
+		ImageData Image;
+		if (!Texture::DecodeImage(ImagePath, true, Image) || Image.CompressedFormat != 0 || Image.Channels <= 0)
+		{
+			LOG_ERROR("Failed to decode " + std::string(ImagePath) + " into a page file.", false);
+			return false;
+		}
+
+		// The mip chain in RGBA8, each level half the previous one rounded up, box filtered with clamped borders
+		const int LevelCount = GetLevelCount(Image.Width, Image.Height, Settings.PageSize);
+		std::vector<std::vector<uint8_t>> Levels(LevelCount);
+		std::vector<std::pair<int, int>> LevelSizes(LevelCount);
+		LevelSizes[0] = { Image.Width, Image.Height };
+		Levels[0].resize(static_cast<size_t>(Image.Width) * Image.Height * 4);
+		for (size_t Texel = 0; Texel < static_cast<size_t>(Image.Width) * Image.Height; Texel++)
+		{
+			const unsigned char* Source = Image.Pixels.get() + Texel * Image.Channels;
+			uint8_t* Destination = Levels[0].data() + Texel * 4;
+			Destination[0] = Source[0];
+			Destination[1] = Image.Channels > 2 ? Source[1] : Source[0];
+			Destination[2] = Image.Channels > 2 ? Source[2] : Source[0];
+			Destination[3] = Image.Channels == 4 ? Source[3] : Image.Channels == 2 ? Source[1] : 255;
+		}
+		Image.Pixels.reset();
+
+		for (int LevelIndex = 1; LevelIndex < LevelCount; LevelIndex++)
+		{
+			const auto [SourceWidth, SourceHeight] = LevelSizes[LevelIndex - 1];
+			const int Width = std::max((SourceWidth + 1) / 2, 1);
+			const int Height = std::max((SourceHeight + 1) / 2, 1);
+			LevelSizes[LevelIndex] = { Width, Height };
+			const std::vector<uint8_t>& Source = Levels[LevelIndex - 1];
+			std::vector<uint8_t>& Destination = Levels[LevelIndex];
+			Destination.resize(static_cast<size_t>(Width) * Height * 4);
+			for (int Y = 0; Y < Height; Y++)
+			{
+				const int Y0 = std::min(Y * 2, SourceHeight - 1);
+				const int Y1 = std::min(Y * 2 + 1, SourceHeight - 1);
+				for (int X = 0; X < Width; X++)
+				{
+					const int X0 = std::min(X * 2, SourceWidth - 1);
+					const int X1 = std::min(X * 2 + 1, SourceWidth - 1);
+					for (int Channel = 0; Channel < 4; Channel++)
+					{
+						const int Sum = Source[(static_cast<size_t>(Y0) * SourceWidth + X0) * 4 + Channel] + Source[(static_cast<size_t>(Y0) * SourceWidth + X1) * 4 + Channel]
+							+ Source[(static_cast<size_t>(Y1) * SourceWidth + X0) * 4 + Channel] + Source[(static_cast<size_t>(Y1) * SourceWidth + X1) * 4 + Channel];
+						Destination[(static_cast<size_t>(Y) * Width + X) * 4 + Channel] = static_cast<uint8_t>((Sum + 2) / 4);
+					}
+				}
+			}
+		}
+
+		uint32_t PageCount = 0;
+		for (int LevelIndex = 0; LevelIndex < LevelCount; LevelIndex++)
+		{
+			const auto [PagesX, PagesY] = GetLevelPages(Image.Width, Image.Height, Settings.PageSize, LevelIndex);
+			PageCount += static_cast<uint32_t>(PagesX * PagesY);
+		}
+
+		// The table is rewritten once every offset and size is known
+		std::ofstream File(std::string(PageFilePath), std::ios::binary | std::ios::trunc);
+		const FileHeader Header = { Magic, Version, static_cast<uint32_t>(Image.Width), static_cast<uint32_t>(Image.Height),
+			static_cast<uint32_t>(Settings.PageSize), static_cast<uint32_t>(Settings.Border), static_cast<uint32_t>(LevelCount), PageCount };
+		std::vector<FilePage> Pages(PageCount);
+		File.write(reinterpret_cast<const char*>(&Header), sizeof(Header));
+		File.write(reinterpret_cast<const char*>(Pages.data()), static_cast<std::streamsize>(Pages.size() * sizeof(FilePage)));
+
+		const int TileSize = Settings.PageSize + 2 * Settings.Border;
+		std::vector<char> Texels(static_cast<size_t>(TileSize) * TileSize * 4);
+		std::vector<char> Compressed;
+		uint64_t Offset = sizeof(Header) + Pages.size() * sizeof(FilePage);
+		uint32_t PageIndex = 0;
+		for (int LevelIndex = 0; LevelIndex < LevelCount; LevelIndex++)
+		{
+			const auto [PagesX, PagesY] = GetLevelPages(Image.Width, Image.Height, Settings.PageSize, LevelIndex);
+			const auto [Width, Height] = LevelSizes[LevelIndex];
+			const std::vector<uint8_t>& Source = Levels[LevelIndex];
+			for (int PageY = 0; PageY < PagesY; PageY++)
+			{
+				for (int PageX = 0; PageX < PagesX; PageX++, PageIndex++)
+				{
+					for (int Y = 0; Y < TileSize; Y++)
+					{
+						const int SourceY = std::clamp(PageY * Settings.PageSize + Y - Settings.Border, 0, Height - 1);
+						for (int X = 0; X < TileSize; X++)
+						{
+							const int SourceX = std::clamp(PageX * Settings.PageSize + X - Settings.Border, 0, Width - 1);
+							std::memcpy(Texels.data() + (static_cast<size_t>(Y) * TileSize + X) * 4, Source.data() + (static_cast<size_t>(SourceY) * Width + SourceX) * 4, 4);
+						}
+					}
+
+					const bool bCompressed = Settings.Compression != AssetArchive::Compression::None
+						&& AssetArchive::Compress(Settings.Compression, Texels, Compressed) && Compressed.size() < Texels.size();
+					const std::vector<char>& Stored = bCompressed ? Compressed : Texels;
+					Pages[PageIndex] = { Offset, static_cast<uint32_t>(Stored.size()),
+						static_cast<uint32_t>(bCompressed ? Settings.Compression : AssetArchive::Compression::None) };
+					File.write(Stored.data(), static_cast<std::streamsize>(Stored.size()));
+					Offset += Stored.size();
+				}
+			}
+		}
+
+		File.seekp(sizeof(Header));
+		File.write(reinterpret_cast<const char*>(Pages.data()), static_cast<std::streamsize>(Pages.size() * sizeof(FilePage)));
+		if (!File)
+		{
+			LOG_ERROR("Failed to write the page file " + std::string(PageFilePath) + ".", false);
+			return false;
+		}
+		LOG_INFO("Built page file " + std::string(PageFilePath) + ": " + std::to_string(PageCount) + " pages in " + std::to_string(LevelCount) + " levels")
+		return true;
+	}
+
+	std::string_view VirtualTexture::GetShaderCode()
+	{
+		return ShaderCode;
+	}
+
+	VirtualTexture::~VirtualTexture()
+	{
+		Close();
+	}
+
+	bool VirtualTexture::Open(std::string_view PageFilePath, const VirtualTextureSettings& Settings)
+	{
+		FGL_PROFILE_SCOPE("VirtualTexture::Open")
+		Close();
+		if (!m_File.Open(PageFilePath) || m_File.GetSize() < sizeof(FileHeader))
+		{
+			LOG_ERROR("Failed to map the page file " + std::string(PageFilePath) + ".", false);
+			return false;
+		}
+
+		FileHeader Header;
+		std::memcpy(&Header, m_File.GetData(), sizeof(Header));
+		const size_t TableEnd = sizeof(FileHeader) + static_cast<size_t>(Header.PageCount) * sizeof(FilePage);
+		bool bValid = Header.Magic == Magic && Header.Version == Version && Header.Width > 0 && Header.Height > 0 && Header.PageSize > 0
+			&& Header.LevelCount == static_cast<uint32_t>(GetLevelCount(Header.Width, Header.Height, Header.PageSize)) && TableEnd <= m_File.GetSize();
+		if (bValid)
+		{
+			m_Width = static_cast<int>(Header.Width);
+			m_Height = static_cast<int>(Header.Height);
+			m_PageSize = static_cast<int>(Header.PageSize);
+			m_Border = static_cast<int>(Header.Border);
+			m_Pages = reinterpret_cast<const FilePage*>(m_File.GetData() + sizeof(FileHeader));
+			uint32_t PageCount = 0;
+			for (int LevelIndex = 0; LevelIndex < static_cast<int>(Header.LevelCount); LevelIndex++)
+			{
+				const auto [PagesX, PagesY] = GetLevelPages(m_Width, m_Height, m_PageSize, LevelIndex);
+				m_Levels.push_back({ PageCount, PagesX, PagesY });
+				PageCount += static_cast<uint32_t>(PagesX * PagesY);
+			}
+			// The feedback encodes page coordinates in 12 bits
+			bValid = PageCount == Header.PageCount && m_Levels[0].PagesX <= 4096 && m_Levels[0].PagesY <= 4096;
+
+			const uint64_t TileBytes = static_cast<uint64_t>(m_PageSize + 2 * m_Border) * (m_PageSize + 2 * m_Border) * 4;
+			for (uint32_t Page = 0; bValid && Page < Header.PageCount; Page++)
+			{
+				const FilePage& Stored = m_Pages[Page];
+				const AssetArchive::Compression Method = static_cast<AssetArchive::Compression>(Stored.Compression);
+				bValid = Stored.Offset <= m_File.GetSize() && Stored.StoredSize <= m_File.GetSize() - Stored.Offset && AssetArchive::IsSupported(Method)
+					&& (Method != AssetArchive::Compression::None || Stored.StoredSize == TileBytes);
+			}
+		}
+		if (!bValid)
+		{
+			LOG_ERROR(std::string(PageFilePath) + " isn't a valid page file, or uses a compression method not compiled in.", false);
+			Close();
+			return false;
+		}
+
+		m_Settings = Settings;
+		const int TileSize = m_PageSize + 2 * m_Border;
+		GLint MaxTextureSize = 0;
+		glGetIntegerv(GL_MAX_TEXTURE_SIZE, &MaxTextureSize);
+		m_Settings.CachePages = std::clamp(m_Settings.CachePages, 1, std::min(MaxCachePages, static_cast<int>(MaxTextureSize) / TileSize));
+		m_CacheTexels = m_Settings.CachePages * TileSize;
+
+		glGenTextures(1, &m_Cache);
+		GLStateCache::BindTexture(GL_TEXTURE_2D, m_Cache);
+		m_bSparse = m_Settings.bSparseCache && GLExtensions::HasSparseTexture();
+		if (m_bSparse)
+		{
+			// Sparse storage spans whole pages, the texels past the last slot are never committed
+			glGetInternalformativ(GL_TEXTURE_2D, GL_RGBA8, GLExtensions::VirtualPageSizeX, 1, &m_SparsePageX);
+			glGetInternalformativ(GL_TEXTURE_2D, GL_RGBA8, GLExtensions::VirtualPageSizeY, 1, &m_SparsePageY);
+			m_bSparse = m_SparsePageX > 0 && m_SparsePageY > 0;
+		}
+		if (m_bSparse)
+		{
+			const int SparseWidth = (m_CacheTexels + m_SparsePageX - 1) / m_SparsePageX;
+			const int SparseHeight = (m_CacheTexels + m_SparsePageY - 1) / m_SparsePageY;
+			glTexParameteri(GL_TEXTURE_2D, GLExtensions::TextureSparse, GL_TRUE);
+			glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, SparseWidth * m_SparsePageX, SparseHeight * m_SparsePageY);
+			m_CommittedPages.assign(static_cast<size_t>(SparseWidth) * SparseHeight, false);
+		}
+		else
+		{
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_CacheTexels, m_CacheTexels, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+			GPUMemoryTracker::TrackTexture(m_Cache, GPUMemoryTracker::GetTextureSize(GL_RGBA8, m_CacheTexels, m_CacheTexels),
+				GPUMemoryCategory::Textures, "VirtualTexture");
+		}
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+		// A square power of two whose mip chain has a texel for every page of every level
+		const int LevelCount = static_cast<int>(m_Levels.size());
+		const int IndirectionSize = 1 << (LevelCount - 1);
+		glGenTextures(1, &m_IndirectionTexture);
+		GLStateCache::BindTexture(GL_TEXTURE_2D, m_IndirectionTexture);
+		for (int LevelIndex = 0; LevelIndex < LevelCount; LevelIndex++)
+		{
+			glTexImage2D(GL_TEXTURE_2D, LevelIndex, GL_RGBA8UI, IndirectionSize >> LevelIndex, IndirectionSize >> LevelIndex, 0, GL_RGBA_INTEGER, GL_UNSIGNED_BYTE, nullptr);
+		}
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, LevelCount - 1);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		GPUMemoryTracker::TrackTexture(m_IndirectionTexture, GPUMemoryTracker::GetTextureSize(GL_RGBA8UI, IndirectionSize, IndirectionSize, 1, LevelCount),
+			GPUMemoryCategory::Textures, "VirtualTexture");
+
+		m_PageSlots.assign(Header.PageCount, -1);
+		m_RequestFrames.assign(Header.PageCount, 0);
+		m_Slots.assign(static_cast<size_t>(m_Settings.CachePages) * m_Settings.CachePages, Slot());
+		for (Slot& Target : m_Slots)
+		{
+			Target.bCommitted = !m_bSparse;
+		}
+		m_Indirection.resize(LevelCount);
+		m_DirtyRows.assign(LevelCount, { std::numeric_limits<int>::max(), -1 });
+		for (int LevelIndex = 0; LevelIndex < LevelCount; LevelIndex++)
+		{
+			m_Indirection[LevelIndex].assign(static_cast<size_t>(m_Levels[LevelIndex].PagesX) * m_Levels[LevelIndex].PagesY, 0);
+		}
+
+		// The coarsest page is the fallback of every other one, its entries fill the whole indirection chain
+		PageLoad Coarsest;
+		Coarsest.Page = Header.PageCount - 1;
+		LoadPage(Coarsest);
+		if (!Coarsest.bLoaded || !MakeResident(Coarsest))
+		{
+			LOG_ERROR("Failed to load the coarsest page of " + std::string(PageFilePath) + ".", false);
+			Close();
+			return false;
+		}
+		m_Slots[m_PageSlots[Coarsest.Page]].bPinned = true;
+		UploadIndirection();
+
+		m_FeedbackBias = -std::log2(static_cast<float>(std::max(m_Settings.FeedbackDivisor, 1)));
+		m_Readback = std::make_unique<FrameReadback>([this](const ReadbackFrame& Frame) { ReadFeedback(Frame); });
+		LOG_INFO("Opened virtual texture " + std::string(PageFilePath) + " of " + std::to_string(m_Width) + "x" + std::to_string(m_Height) + " texels, cache of "
+			+ std::to_string(m_Slots.size()) + " pages" + (m_bSparse ? " (sparse)" : ""))
+		return true;
+	}
+
+	void VirtualTexture::Close()
+	{
+		if (!m_Loads.empty() && m_Settings.Jobs)
+		{
+			m_Settings.Jobs->Wait(m_LoadCounter);
+		}
+		m_Loads.clear();
+		if (m_Readback)
+		{
+			m_Readback->Destroy();
+			m_Readback.reset();
+		}
+		m_FeedbackTarget.Destroy();
+		if (m_Cache != 0)
+		{
+			glDeleteTextures(1, &m_Cache);
+			GLStateCache::OnTextureDeleted(m_Cache);
+			GPUMemoryTracker::UntrackTexture(m_Cache);
+			m_Cache = 0;
+		}
+		if (m_IndirectionTexture != 0)
+		{
+			glDeleteTextures(1, &m_IndirectionTexture);
+			GLStateCache::OnTextureDeleted(m_IndirectionTexture);
+			GPUMemoryTracker::UntrackTexture(m_IndirectionTexture);
+			m_IndirectionTexture = 0;
+		}
+		m_File.Close();
+		m_Pages = nullptr;
+		m_Levels.clear();
+		m_PageSlots.clear();
+		m_RequestFrames.clear();
+		m_Slots.clear();
+		m_Indirection.clear();
+		m_DirtyRows.clear();
+		m_Requests.clear();
+		m_CommittedPages.clear();
+		m_CommittedBytes = 0;
+		m_ResidentCount = 0;
+		m_bSparse = false;
+	}
+
+	bool VirtualTexture::IsOpen() const
+	{
+		return m_Cache != 0;
+	}
+
+	void VirtualTexture::DecodePage(uint32_t Page, int& LevelIndex, int& X, int& Y) const
+	{
+		LevelIndex = static_cast<int>(m_Levels.size()) - 1;
+		while (m_Levels[LevelIndex].FirstPage > Page)
+		{
+			LevelIndex--;
+		}
+		const Level& Info = m_Levels[LevelIndex];
+		X = static_cast<int>(Page - Info.FirstPage) % Info.PagesX;
+		Y = static_cast<int>(Page - Info.FirstPage) / Info.PagesX;
+	}
+
+	void VirtualTexture::LoadPage(PageLoad& Load) const
+	{
+		FGL_PROFILE_SCOPE("VirtualTexture::LoadPage")
+		const FilePage& Stored = m_Pages[Load.Page];
+		const size_t TileSize = static_cast<size_t>(m_PageSize + 2 * m_Border);
+		Load.Texels.resize(TileSize * TileSize * 4);
+		const uint8_t* Source = m_File.GetData() + Stored.Offset;
+		const AssetArchive::Compression Method = static_cast<AssetArchive::Compression>(Stored.Compression);
+		if (Method == AssetArchive::Compression::None)
+		{
+			std::memcpy(Load.Texels.data(), Source, Load.Texels.size());
+			Load.bLoaded = true;
+		}
+		else
+		{
+			Load.bLoaded = AssetArchive::Decompress(Method, std::span<const uint8_t>(Source, Stored.StoredSize), std::span<uint8_t>(Load.Texels.data(), Load.Texels.size()));
+		}
+	}
+
+	void VirtualTexture::Update()
+	{
+		if (!IsOpen())
+			return;
+
+		FGL_PROFILE_SCOPE("VirtualTexture::Update")
+		m_Frame++;
+		m_Readback->Collect();
+
+		// Coarsest first: the levels are stored from the finest, and a page only helps once its parent is in
+		if (m_FeedbackFrame == m_Frame)
+		{
+			std::sort(m_Requests.begin(), m_Requests.end(), std::greater<uint32_t>());
+		}
+
+		// One batch in flight, its jobs write into m_Loads so it doesn't change until they all ran
+		if (m_Loads.empty())
+		{
+			for (uint32_t Page : m_Requests)
+			{
+				if (m_Loads.size() >= static_cast<size_t>(std::max(m_Settings.UploadsPerFrame, 0)))
+					break;
+
+				if (m_PageSlots[Page] < 0)
+				{
+					m_Loads.emplace_back().Page = Page;
+				}
+			}
+			for (PageLoad& Load : m_Loads)
+			{
+				if (m_Settings.Jobs)
+				{
+					m_Settings.Jobs->Schedule([this, &Load]() { LoadPage(Load); }, m_LoadCounter);
+				}
+				else
+				{
+					LoadPage(Load);
+				}
+			}
+		}
+
+		if (!m_Loads.empty() && m_LoadCounter.IsDone())
+		{
+			for (const PageLoad& Load : m_Loads)
+			{
+				if (Load.bLoaded && m_PageSlots[Load.Page] < 0 && !MakeResident(Load))
+					break;
+			}
+			m_Loads.clear();
+		}
+		UploadIndirection();
+	}
+
+	void VirtualTexture::ReadFeedback(const ReadbackFrame& Frame)
+	{
+		// The frames delivered by one Update() add up, the next Update() with feedback starts over
+		if (m_FeedbackFrame != m_Frame)
+		{
+			m_Requests.clear();
+			m_FeedbackFrame = m_Frame;
+		}
+
+		const int LevelCount = static_cast<int>(m_Levels.size());
+		const size_t PixelCount = static_cast<size_t>(Frame.Width) * Frame.Height;
+		for (size_t Pixel = 0; Pixel < PixelCount; Pixel++)
+		{
+			const unsigned char* Texel = Frame.Pixels + Pixel * 4;
+			if (Texel[3] == 0)
+				continue;
+
+			const Level& Info = m_Levels[std::min(Texel[3] - 1, LevelCount - 1)];
+			const int X = std::min(Texel[0] | ((Texel[2] & 15) << 8), Info.PagesX - 1);
+			const int Y = std::min(Texel[1] | ((Texel[2] >> 4) << 8), Info.PagesY - 1);
+			RequestPage(Info.FirstPage + static_cast<uint32_t>(Y * Info.PagesX + X));
+		}
+	}
+
+	void VirtualTexture::RequestPage(uint32_t Page)
+	{
+		// The ancestors are the fallbacks while the page streams in, they're kept or requested too
+		const int LevelCount = static_cast<int>(m_Levels.size());
+		while (m_RequestFrames[Page] != m_Frame)
+		{
+			m_RequestFrames[Page] = m_Frame;
+			if (m_PageSlots[Page] >= 0)
+			{
+				m_Slots[m_PageSlots[Page]].LastUsed = m_Frame;
+			}
+			else
+			{
+				m_Requests.push_back(Page);
+			}
+
+			int LevelIndex = 0;
+			int X = 0;
+			int Y = 0;
+			DecodePage(Page, LevelIndex, X, Y);
+			if (LevelIndex + 1 >= LevelCount)
+				break;
+
+			const Level& Parent = m_Levels[LevelIndex + 1];
+			Page = Parent.FirstPage + static_cast<uint32_t>((Y / 2) * Parent.PagesX + X / 2);
+		}
+	}
+
+	int32_t VirtualTexture::FindSlot() const
+	{
+		int32_t Oldest = -1;
+		for (size_t Index = 0; Index < m_Slots.size(); Index++)
+		{
+			const Slot& Candidate = m_Slots[Index];
+			if (Candidate.Page == InvalidPage)
+				return static_cast<int32_t>(Index);
+
+			// Pages the feedback saw this frame are in use, evicting them would only bring them back
+			if (!Candidate.bPinned && Candidate.LastUsed < m_Frame && (Oldest < 0 || Candidate.LastUsed < m_Slots[Oldest].LastUsed))
+			{
+				Oldest = static_cast<int32_t>(Index);
+			}
+		}
+		return Oldest;
+	}
+
+	bool VirtualTexture::MakeResident(const PageLoad& Load)
+	{
+		const int32_t SlotIndex = FindSlot();
+		if (SlotIndex < 0)
+			return false;
+
+		Slot& Target = m_Slots[SlotIndex];
+		if (Target.Page != InvalidPage)
+		{
+			m_PageSlots[Target.Page] = -1;
+			RefreshIndirection(Target.Page);
+			m_ResidentCount--;
+		}
+		if (!Target.bCommitted)
+		{
+			CommitSlot(SlotIndex);
+		}
+
+		const int TileSize = m_PageSize + 2 * m_Border;
+		GLStateCache::BindTexture(GL_TEXTURE_2D, m_Cache);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, (SlotIndex % m_Settings.CachePages) * TileSize, (SlotIndex / m_Settings.CachePages) * TileSize, TileSize, TileSize,
+			GL_RGBA, GL_UNSIGNED_BYTE, Load.Texels.data());
+		RenderCounters::CountUpload(Load.Texels.size());
+
+		Target.Page = Load.Page;
+		Target.LastUsed = m_Frame;
+		m_PageSlots[Load.Page] = SlotIndex;
+		m_ResidentCount++;
+		RefreshIndirection(Load.Page);
+		return true;
+	}
+
+	void VirtualTexture::CommitSlot(int32_t SlotIndex)
+	{
+		// Neighbour slots may share sparse pages, those are committed once and kept
+		const int TileSize = m_PageSize + 2 * m_Border;
+		const int SlotX = (SlotIndex % m_Settings.CachePages) * TileSize;
+		const int SlotY = (SlotIndex / m_Settings.CachePages) * TileSize;
+		const int PagesPerRow = (m_CacheTexels + m_SparsePageX - 1) / m_SparsePageX;
+		GLStateCache::BindTexture(GL_TEXTURE_2D, m_Cache);
+		for (int Y = SlotY / m_SparsePageY; Y <= (SlotY + TileSize - 1) / m_SparsePageY; Y++)
+		{
+			for (int X = SlotX / m_SparsePageX; X <= (SlotX + TileSize - 1) / m_SparsePageX; X++)
+			{
+				const size_t Index = static_cast<size_t>(Y) * PagesPerRow + X;
+				if (!m_CommittedPages[Index])
+				{
+					GLExtensions::TexPageCommitment(GL_TEXTURE_2D, 0, X * m_SparsePageX, Y * m_SparsePageY, m_SparsePageX, m_SparsePageY, true);
+					m_CommittedPages[Index] = true;
+					m_CommittedBytes += GPUMemoryTracker::GetTextureSize(GL_RGBA8, m_SparsePageX, m_SparsePageY);
+				}
+			}
+		}
+		m_Slots[SlotIndex].bCommitted = true;
+		GPUMemoryTracker::UntrackTexture(m_Cache);
+		GPUMemoryTracker::TrackTexture(m_Cache, m_CommittedBytes, GPUMemoryCategory::Textures, "VirtualTexture");
+	}
+
+	void VirtualTexture::RefreshIndirection(uint32_t Page)
+	{
+		int PageLevel = 0;
+		int PageX = 0;
+		int PageY = 0;
+		DecodePage(Page, PageLevel, PageX, PageY);
+
+		// From the page down to the finest level, so every entry can copy its parent's when not resident itself
+		const int LevelCount = static_cast<int>(m_Levels.size());
+		for (int LevelIndex = PageLevel; LevelIndex >= 0; LevelIndex--)
+		{
+			const int Scale = 1 << (PageLevel - LevelIndex);
+			const Level& Info = m_Levels[LevelIndex];
+			const int FirstX = PageX * Scale;
+			const int FirstY = PageY * Scale;
+			const int LastX = std::min((PageX + 1) * Scale, Info.PagesX) - 1;
+			const int LastY = std::min((PageY + 1) * Scale, Info.PagesY) - 1;
+			for (int Y = FirstY; Y <= LastY; Y++)
+			{
+				for (int X = FirstX; X <= LastX; X++)
+				{
+					const size_t Index = static_cast<size_t>(Y) * Info.PagesX + X;
+					const int32_t SlotIndex = m_PageSlots[Info.FirstPage + Index];
+					uint32_t Entry = 0;
+					if (SlotIndex >= 0)
+					{
+						Entry = PackEntry(SlotIndex % m_Settings.CachePages, SlotIndex / m_Settings.CachePages, LevelIndex);
+					}
+					else if (LevelIndex + 1 < LevelCount)
+					{
+						Entry = m_Indirection[LevelIndex + 1][static_cast<size_t>(Y / 2) * m_Levels[LevelIndex + 1].PagesX + X / 2];
+					}
+					m_Indirection[LevelIndex][Index] = Entry;
+				}
+			}
+
+			auto& [MinRow, MaxRow] = m_DirtyRows[LevelIndex];
+			MinRow = std::min(MinRow, FirstY);
+			MaxRow = std::max(MaxRow, LastY);
+		}
+	}
+
+	void VirtualTexture::UploadIndirection()
+	{
+		// Whole rows, so the entries upload straight from their arrays
+		for (size_t LevelIndex = 0; LevelIndex < m_Levels.size(); LevelIndex++)
+		{
+			auto& [MinRow, MaxRow] = m_DirtyRows[LevelIndex];
+			if (MinRow > MaxRow)
+				continue;
+
+			const int PagesX = m_Levels[LevelIndex].PagesX;
+			GLStateCache::BindTexture(GL_TEXTURE_2D, m_IndirectionTexture);
+			glTexSubImage2D(GL_TEXTURE_2D, static_cast<GLint>(LevelIndex), 0, MinRow, PagesX, MaxRow - MinRow + 1, GL_RGBA_INTEGER, GL_UNSIGNED_BYTE,
+				m_Indirection[LevelIndex].data() + static_cast<size_t>(MinRow) * PagesX);
+			RenderCounters::CountUpload(static_cast<size_t>(MaxRow - MinRow + 1) * PagesX * sizeof(uint32_t));
+			MinRow = std::numeric_limits<int>::max();
+			MaxRow = -1;
+		}
+	}
+
+	void VirtualTexture::Apply(const Shader& Target, GLint CacheUnit, GLint IndirectionUnit) const
+	{
+		GLStateCache::BindTextureUnit(CacheUnit, GL_TEXTURE_2D, m_Cache);
+		GLStateCache::BindTextureUnit(IndirectionUnit, GL_TEXTURE_2D, m_IndirectionTexture);
+		Target.SetInt("VTCache", CacheUnit);
+		Target.SetInt("VTIndirection", IndirectionUnit);
+		Target.SetVec2("VTSize", static_cast<float>(m_Width), static_cast<float>(m_Height));
+		Target.SetFloat("VTPageSize", static_cast<float>(m_PageSize));
+		Target.SetFloat("VTBorder", static_cast<float>(m_Border));
+		Target.SetFloat("VTCacheSize", static_cast<float>(m_CacheTexels));
+		Target.SetFloat("VTMaxLevel", static_cast<float>(m_Levels.size() - 1));
+		Target.SetFloat("VTFeedbackBias", m_FeedbackBias);
+	}
+
+	void VirtualTexture::BeginFeedback()
+	{
+		if (!IsOpen())
+			return;
+
+		glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &m_SavedDrawFramebuffer);
+		glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &m_SavedReadFramebuffer);
+		glGetIntegerv(GL_VIEWPORT, m_SavedViewport);
+		const int Divisor = std::max(m_Settings.FeedbackDivisor, 1);
+		m_FeedbackTarget.Resize(std::max(m_SavedViewport[2] / Divisor, 1), std::max(m_SavedViewport[3] / Divisor, 1));
+		m_FeedbackTarget.Bind();
+
+		// Cleared without touching the clear color of the frame, alpha 0 marks the pixels nothing was drawn to
+		const GLfloat Empty[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		glClearBufferfv(GL_COLOR, 0, Empty);
+		glClearBufferfi(GL_DEPTH_STENCIL, 0, 1.0f, 0);
+	}
+
+	void VirtualTexture::EndFeedback()
+	{
+		if (!IsOpen())
+			return;
+
+		m_Readback->Capture(m_FeedbackTarget.GetFramebuffer(), m_FeedbackTarget.GetWidth(), m_FeedbackTarget.GetHeight(), m_Frame);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, static_cast<GLuint>(m_SavedDrawFramebuffer));
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, static_cast<GLuint>(m_SavedReadFramebuffer));
+		glViewport(m_SavedViewport[0], m_SavedViewport[1], m_SavedViewport[2], m_SavedViewport[3]);
+	}
+
+	int VirtualTexture::GetWidth() const
+	{
+		return m_Width;
+	}
+
+	int VirtualTexture::GetHeight() const
+	{
+		return m_Height;
+	}
+
+	uint32_t VirtualTexture::GetResidentCount() const
+	{
+		return m_ResidentCount;
+	}
+
+	uint32_t VirtualTexture::GetRequestedCount() const
+	{
+		return static_cast<uint32_t>(m_Requests.size());
+	}
+
+	bool VirtualTexture::IsSparse() const
+	{
+		return m_bSparse;
+	}
+
+} // namespace fgl
@@ -0,0 +1,366 @@
+#include <FireGL/Renderer/VolumetricFog.h>
+#include <FireGL/Renderer/CameraUniformBuffer.h>
+#include <FireGL/Renderer/LightUniformBuffer.h>
+#include <FireGL/Renderer/GLStateCache.h>
+#include <FireGL/Renderer/GPUMemoryTracker.h>
+#include <FireGL/Renderer/RenderStats.h>
+#include <FireGL/Core/BaseLog.h>
+
+namespace fgl
+{
+
+	namespace
+	{
+		constexpr GLuint WorkgroupSize = 8;
+
+		// One invocation per froxel: the fog at a point jittered along its depth and the light it scatters toward the camera
+		constexpr std::string_view ScatterCode = R"(#version 430 core
+layout (local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+
+layout (rgba16f, binding = 0) writeonly uniform image3D Destination;
+uniform sampler3D History;
+
+layout (std140) uniform ShadowData
+{
+    mat4 LightViewProjection[4];
+    vec4 SplitDepths;
+    vec4 TexelSizes;
+    vec4 Params;          // cascade count (0 when off), depth bias, normal bias in texels, 1 / resolution
+} Shadows;
+uniform sampler2DArrayShadow ShadowMap;
+
+struct PointLight {
+    vec4 positionRange;   // world-space position, range
+    vec4 colorIntensity;  // linear color, intensity
+};
+
+layout (std430, binding = 1) readonly buffer ClusteredLightData
+{
+    PointLight pointLights[];
+};
+
+layout (std430, binding = 2) readonly buffer LightClusterData
+{
+    uvec4 gridSize;       // clusters along x, y, z, light count
+    vec4 depthParams;     // near, far, slice scale, slice bias
+    vec4 screenParams;    // viewport width, height, tile width, tile height
+    uvec2 clusters[];     // offset in lightIndices, light count
+};
+
+layout (std430, binding = 3) readonly buffer LightIndexData
+{
+    uint lightIndices[];
+};
+
+uniform mat4 InverseView;
+uniform mat4 PreviousViewProjection;
+uniform vec4 ProjectionParams;     // projection [0][0], [1][1], [2][0], [2][1]
+uniform vec4 Viewport;
+uniform vec2 SliceParams;          // near, log(far / near)
+uniform vec2 PreviousSliceParams;  // slice coordinate of a view depth: log(depth) * x + y
+uniform float Jitter;
+uniform bool bHistory;
+uniform float TemporalBlend;
+uniform bool bPointLights;
+
+uniform float Density;
+uniform vec3 Albedo;
+uniform float Anisotropy;
+uniform float HeightFalloff;
+uniform float BaseHeight;
+uniform vec3 LightDirection;
+uniform vec3 LightColor;
+uniform vec3 AmbientColor;
+
+float Phase(float CosTheta)
+{
+    float G2 = Anisotropy * Anisotropy;
+    return (1.0 - G2) / (12.5663706 * pow(max(1.0 + G2 - 2.0 * Anisotropy * CosTheta, 1e-4), 1.5));
+}
+
+float DirectionalShadow(vec3 Position, float ViewDepth)
+{
+    int Count = int(Shadows.Params.x);
+    int Cascade = 0;
+    while (Cascade < Count && ViewDepth > Shadows.SplitDepths[Cascade])
+        Cascade++;
+    if (Cascade >= Count)
+        return 1.0;
+    // a single tap, the froxels are far coarser than the shadow texels
+    vec3 ShadowPosition = (Shadows.LightViewProjection[Cascade] * vec4(Position, 1.0)).xyz;
+    return texture(ShadowMap, vec4(ShadowPosition.xy * 0.5 + 0.5, float(Cascade), ShadowPosition.z - Shadows.Params.y));
+}
+
+void main()
+{
+    ivec3 Froxel = ivec3(gl_GlobalInvocationID);
+    ivec3 Size = imageSize(Destination);
+    if (any(greaterThanEqual(Froxel, Size)))
+        return;
+
+    // Slices are spaced exponentially like the light clusters: depth = near * (far / near)^w
+    vec2 UV = (vec2(Froxel.xy) + 0.5) / vec2(Size.xy);
+    float ViewDepth = SliceParams.x * exp((float(Froxel.z) + Jitter) / float(Size.z) * SliceParams.y);
+    vec2 Ndc = UV * 2.0 - 1.0;
+    vec3 ViewPosition = vec3(ViewDepth * (Ndc + ProjectionParams.zw) / ProjectionParams.xy, -ViewDepth);
+    vec3 Position = (InverseView * vec4(ViewPosition, 1.0)).xyz;
+    vec3 ToCamera = normalize(InverseView[3].xyz - Position);
+
+    float Extinction = Density * exp(-HeightFalloff * max(Position.y - BaseHeight, 0.0));
+    vec3 Light = AmbientColor + LightColor * Phase(dot(normalize(LightDirection), ToCamera)) * DirectionalShadow(Position, ViewDepth);
+
+    // The point lights of the cluster the froxel falls in, the same lists the clustered shading reads
+    if (bPointLights)
+    {
+        uvec3 Cluster;
+        Cluster.xy = min(uvec2((Viewport.xy + UV * Viewport.zw) / screenParams.zw), gridSize.xy - 1u);
+        Cluster.z = uint(clamp(floor(log(ViewDepth) * depthParams.z + depthParams.w), 0.0, float(gridSize.z - 1u)));
+        uvec2 LightList = clusters[Cluster.x + gridSize.x * (Cluster.y + gridSize.y * Cluster.z)];
+        for (uint Index = 0u; Index < LightList.y; Index++)
+        {
+            PointLight Point = pointLights[lightIndices[LightList.x + Index]];
+            vec3 FromLight = Position - Point.positionRange.xyz;
+            float Distance = length(FromLight);
+            float Window = clamp(1.0 - pow(Distance / Point.positionRange.w, 4.0), 0.0, 1.0);
+            float Attenuation = Window * Window / (Distance * Distance + 1.0);
+            Light += Point.colorIntensity.rgb * Point.colorIntensity.w * Attenuation * Phase(dot(FromLight / max(Distance, 1e-4), ToCamera));
+        }
+    }
+    vec4 Result = vec4(Light * Albedo * Extinction, Extinction);
+
+    // Blended with the froxel's position in the previous frame, unless it was off screen
+    if (bHistory)
+    {
+        vec4 Previous = PreviousViewProjection * vec4(Position, 1.0);
+        if (Previous.w > 0.0)
+        {
+            vec3 PreviousUVW = vec3(Previous.xy / Previous.w * 0.5 + 0.5, log(Previous.w) * PreviousSliceParams.x + PreviousSliceParams.y);
+            if (all(greaterThanEqual(PreviousUVW, vec3(0.0))) && all(lessThanEqual(PreviousUVW, vec3(1.0))))
+                Result = mix(texture(History, PreviousUVW), Result, TemporalBlend);
+        }
+    }
+    imageStore(Destination, Froxel, Result);
+})";
+
+		// One invocation per column, front to back: the light scattered toward the camera and the transmittance so far
+		constexpr std::string_view IntegrateCode = R"(#version 430 core
+layout (local_size_x = 8, local_size_y = 8) in;
+
+layout (rgba16f, binding = 0) readonly uniform image3D Source;
+layout (rgba16f, binding = 1) writeonly uniform image3D Destination;
+
+uniform vec2 SliceParams;  // near, log(far / near)
+
+void main()
+{
+    ivec2 Column = ivec2(gl_GlobalInvocationID.xy);
+    ivec3 Size = imageSize(Destination);
+    if (any(greaterThanEqual(Column, Size.xy)))
+        return;
+
+    vec3 Scattered = vec3(0.0);
+    float Transmittance = 1.0;
+    float Near = SliceParams.x;
+    for (int Slice = 0; Slice < Size.z; Slice++)
+    {
+        float Far = SliceParams.x * exp(float(Slice + 1) / float(Size.z) * SliceParams.y);
+        vec4 Froxel = imageLoad(Source, ivec3(Column, Slice));
+        float Extinction = max(Froxel.a, 1e-6);
+        float SliceTransmittance = exp(-Extinction * (Far - Near));
+        // The light scattered along the slice, integrated analytically so thick slices don't add energy
+        Scattered += Transmittance * (Froxel.rgb - Froxel.rgb * SliceTransmittance) / Extinction;
+        Transmittance *= SliceTransmittance;
+        imageStore(Destination, ivec3(Column, Slice), vec4(Scattered, Transmittance));
+        Near = Far;
+    }
+})";
+
+		GLuint GetGroupCount(GLuint Size)
+		{
+			return (Size + WorkgroupSize - 1) / WorkgroupSize;
+		}
+
+		/** Creates a froxel volume, filtered linearly and clamped. */
+		GLuint CreateVolume(GLsizei Width, GLsizei Height, GLsizei Depth)
+		{
+			GLuint Texture = 0;
+			glGenTextures(1, &Texture);
+			GLStateCache::BindTexture(GL_TEXTURE_3D, Texture);
+			glTexStorage3D(GL_TEXTURE_3D, 1, GL_RGBA16F, Width, Height, Depth);
+			glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+			glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+			glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+			GPUMemoryTracker::TrackTexture(Texture, GPUMemoryTracker::GetTextureSize(GL_RGBA16F, Width, Height, Depth),
+				GPUMemoryCategory::RenderTargets, "VolumetricFog");
+			return Texture;
+		}
+	}
+
+	VolumetricFog::~VolumetricFog()
+	{
+		Destroy();
+	}
+
+	bool VolumetricFog::IsSupported()
+	{
+		return GLAD_GL_VERSION_4_3;
+	}
+
+	void VolumetricFog::Create()
+	{
+		LOG_ASSERT(m_NeutralTexture == 0, "Volumetric fog created twice")
+
+		// Nothing scattered, everything transmitted
+		const float Unfogged[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+		glGenTextures(1, &m_NeutralTexture);
+		GLStateCache::BindTexture(GL_TEXTURE_3D, m_NeutralTexture);
+		glTexImage3D(GL_TEXTURE_3D, 0, GL_RGBA16F, 1, 1, 1, 0, GL_RGBA, GL_FLOAT, Unfogged);
+		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		GPUMemoryTracker::TrackTexture(m_NeutralTexture, GPUMemoryTracker::GetTextureSize(GL_RGBA16F, 1, 1), GPUMemoryCategory::RenderTargets, "VolumetricFog");
+
+		m_Data = FogData();
+		glGenBuffers(1, &m_BufferID);
+		GLStateCache::BindBuffer(GL_UNIFORM_BUFFER, m_BufferID);
+		glBufferData(GL_UNIFORM_BUFFER, sizeof(FogData), &m_Data, GL_DYNAMIC_DRAW);
+		GPUMemoryTracker::TrackBuffer(m_BufferID, sizeof(FogData), GPUMemoryCategory::Uniforms, "VolumetricFog");
+
+		// Also binds the generic GL_UNIFORM_BUFFER point, which the cache already holds
+		glBindBufferBase(GL_UNIFORM_BUFFER, BindingPoint, m_BufferID);
+		Disable();
+	}
+
+	void VolumetricFog::Destroy()
+	{
+		m_bHistoryValid = false;
+		for (GLuint* Texture : { &m_NeutralTexture, &m_Scattering[0], &m_Scattering[1], &m_Integrated })
+		{
+			if (*Texture != 0)
+			{
+				glDeleteTextures(1, Texture);
+				GLStateCache::OnTextureDeleted(*Texture);
+				GPUMemoryTracker::UntrackTexture(*Texture);
+				*Texture = 0;
+			}
+		}
+		if (m_BufferID != 0)
+		{
+			glDeleteBuffers(1, &m_BufferID);
+			GLStateCache::OnBufferDeleted(m_BufferID);
+			GPUMemoryTracker::UntrackBuffer(m_BufferID);
+			m_BufferID = 0;
+		}
+		for (std::unique_ptr<Shader>* Pass : { &m_ScatterShader, &m_IntegrateShader })
+		{
+			if (*Pass)
+			{
+				(*Pass)->Cleanup();
+				Pass->reset();
+			}
+		}
+	}
+
+	bool VolumetricFog::IsCreated() const
+	{
+		return m_NeutralTexture != 0;
+	}
+
+	VolumetricFogSettings& VolumetricFog::GetSettings()
+	{
+		return m_Settings;
+	}
+
+	const VolumetricFogSettings& VolumetricFog::GetSettings() const
+	{
+		return m_Settings;
+	}
+
+	void VolumetricFog::CreateVolumes()
+	{
+		m_ScatterShader = Shader::CreateComputeFromSource(ScatterCode);
+		m_IntegrateShader = Shader::CreateComputeFromSource(IntegrateCode);
+		for (GLuint* Texture : { &m_Scattering[0], &m_Scattering[1], &m_Integrated })
+		{
+			*Texture = CreateVolume(GridX, GridY, GridZ);
+		}
+	}
+
+	void VolumetricFog::Compute(const CameraData& Camera, const DirectionalLightData& Light, const GLint Viewport[4], bool bClusteredLights, bool bReproject)
+	{
+		LOG_ASSERT(IsCreated(), "Volumetric fog computed before Create()")
+		const glm::mat4& Projection = Camera.Projection;
+		LOG_ASSERT(Projection[3][3] == 0.0f, "Volumetric fog requires a perspective projection");
+		if (m_Integrated == 0)
+		{
+			CreateVolumes();
+		}
+
+		// Planes of the [0, 1] depth range projection, the volume ends at the fog distance
+		const float Near = Projection[3][2] / Projection[2][2];
+		const float Far = std::max(m_Settings.Distance, Near * 1.01f);
+		const float LogRatio = std::log(Far / Near);
+		const glm::vec2 SliceParams(Near, LogRatio);
+		const glm::vec2 VolumeParams(1.0f / LogRatio, -std::log(Near) / LogRatio);
+
+		// Golden ratio steps cover the slice evenly over a few frames
+		m_Frame++;
+		const float Jitter = std::fmod(static_cast<float>(m_Frame) * 0.618034f, 1.0f);
+		const bool bHistory = bReproject && m_bHistoryValid && m_Settings.TemporalBlend < 1.0f;
+		const uint32_t Previous = m_Current;
+		m_Current = 1 - m_Current;
+
+		m_ScatterShader->Activate();
+		GLStateCache::BindTextureUnit(HistoryUnit, GL_TEXTURE_3D, m_Scattering[Previous]);
+		m_ScatterShader->SetInt("History", HistoryUnit);
+		m_ScatterShader->SetMat4("InverseView", glm::inverse(Camera.View));
+		m_ScatterShader->SetMat4("PreviousViewProjection", m_PreviousViewProjection);
+		m_ScatterShader->SetVec4("ProjectionParams", glm::vec4(Projection[0][0], Projection[1][1], Projection[2][0], Projection[2][1]));
+		m_ScatterShader->SetVec4("Viewport", glm::vec4(Viewport[0], Viewport[1], Viewport[2], Viewport[3]));
+		m_ScatterShader->SetVec2("SliceParams", SliceParams);
+		// The history's texels are centred on their slices, unlike the integrated volume's
+		m_ScatterShader->SetVec2("PreviousSliceParams", glm::vec2(m_Data.DepthParams.x, m_Data.DepthParams.y + 0.5f / GridZ));
+		m_ScatterShader->SetFloat("Jitter", Jitter);
+		m_ScatterShader->SetBool("bHistory", bHistory);
+		m_ScatterShader->SetFloat("TemporalBlend", std::clamp(m_Settings.TemporalBlend, 0.0f, 1.0f));
+		m_ScatterShader->SetBool("bPointLights", bClusteredLights);
+		m_ScatterShader->SetFloat("Density", std::max(m_Settings.Density, 0.0f));
+		m_ScatterShader->SetVec3("Albedo", m_Settings.Albedo);
+		m_ScatterShader->SetFloat("Anisotropy", std::clamp(m_Settings.Anisotropy, -0.99f, 0.99f));
+		m_ScatterShader->SetFloat("HeightFalloff", std::max(m_Settings.HeightFalloff, 0.0f));
+		m_ScatterShader->SetFloat("BaseHeight", m_Settings.BaseHeight);
+		m_ScatterShader->SetVec3("LightDirection", glm::vec3(Light.Direction));
+		m_ScatterShader->SetVec3("LightColor", glm::vec3(Light.Diffuse));
+		m_ScatterShader->SetVec3("AmbientColor", glm::vec3(Light.Ambient));
+		glBindImageTexture(0, m_Scattering[m_Current], 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+		glDispatchCompute(GetGroupCount(GridX), GetGroupCount(GridY), GridZ);
+
+		glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+		m_IntegrateShader->Activate();
+		m_IntegrateShader->SetVec2("SliceParams", SliceParams);
+		glBindImageTexture(0, m_Scattering[m_Current], 0, GL_TRUE, 0, GL_READ_ONLY, GL_RGBA16F);
+		glBindImageTexture(1, m_Integrated, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+		glDispatchCompute(GetGroupCount(GridX), GetGroupCount(GridY), 1);
+
+		// Every slice stores the fog up to its far edge, so the lookup is shifted half a texel toward the camera
+		m_Data.DepthParams = glm::vec4(VolumeParams.x, VolumeParams.y - 0.5f / GridZ, 0.0f, 0.0f);
+		m_Data.ScreenParams = glm::vec4(Viewport[0], Viewport[1], 1.0f / std::max(Viewport[2], 1), 1.0f / std::max(Viewport[3], 1));
+		GLStateCache::BindBuffer(GL_UNIFORM_BUFFER, m_BufferID);
+		glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FogData), &m_Data);
+		RenderCounters::CountUpload(sizeof(FogData));
+
+		// Sampled by the shading, and this frame's scattering by the next frame's history
+		glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+		GLStateCache::BindTextureUnit(TextureUnit, GL_TEXTURE_3D, m_Integrated);
+		m_PreviousViewProjection = Camera.ViewProjection;
+		m_bHistoryValid = bReproject;
+	}
+
+	void VolumetricFog::Disable()
+	{
+		m_bHistoryValid = false;
+		GLStateCache::BindTextureUnit(TextureUnit, GL_TEXTURE_3D, m_NeutralTexture);
+	}
+
+} // namespace fgl
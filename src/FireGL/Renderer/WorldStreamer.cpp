@@ -0,0 +1,201 @@
+#include <FireGL/Renderer/WorldStreamer.h>
+#include <FireGL/Renderer/Scene.h>
+#include <FireGL/Renderer/SceneObject.h>
+#include <FireGL/Renderer/BaseCamera.h>
+#include <FireGL/Core/Profiler.h>
+#include <FireGL/Core/BaseLog.h>
+
+#include <External/glm/common.hpp>
+#include <External/glm/geometric.hpp>
+
+namespace fgl
+{
+
+	WorldStreamer::WorldStreamer(Scene& Target, const SceneFile& Factories, JobSystem& Jobs, std::string_view Directory, float CellSize)
+		: m_Scene(Target), m_Factories(Factories), m_Jobs(Jobs), m_Directory(Directory), m_CellSize(CellSize),
+		  m_LoadRadius(CellSize * 2.0f), m_UnloadRadius(CellSize * 3.0f)
+	{
+		LOG_ASSERT(CellSize > 0.0f, "World cells must have a positive size")
+	}
+
+	WorldStreamer::~WorldStreamer()
+	{
+		for (auto& [Key, Streamed] : m_Cells)
+		{
+			m_Jobs.Wait(Streamed->Counter);
+		}
+	}
+
+	std::string WorldStreamer::GetCellPath(std::string_view Directory, const glm::ivec2& Cell)
+	{
+		std::string Path(Directory);
+		if (!Path.empty() && Path.back() != '/' && Path.back() != '\\')
+		{
+			Path += '/';
+		}
+		return Path + "Cell_" + std::to_string(Cell.x) + "_" + std::to_string(Cell.y) + SceneFile::Extension;
+	}
+
+	glm::ivec2 WorldStreamer::GetCell(const glm::vec3& Position, float CellSize)
+	{
+		return glm::ivec2(glm::floor(glm::vec2(Position.x, Position.z) / CellSize));
+	}
+
+	void WorldStreamer::SetRadii(float LoadRadius, float UnloadRadius)
+	{
+		m_LoadRadius = LoadRadius;
+		m_UnloadRadius = std::max(UnloadRadius, LoadRadius);
+	}
+
+	void WorldStreamer::SetMaxPendingLoads(size_t Count)
+	{
+		m_MaxPendingLoads = std::max<size_t>(Count, 1);
+	}
+
+	void WorldStreamer::SetAssetCallback(AssetCallback Callback)
+	{
+		m_AssetCallback = std::move(Callback);
+	}
+
+	uint64_t WorldStreamer::GetKey(const glm::ivec2& Coordinates)
+	{
+		return (static_cast<uint64_t>(static_cast<uint32_t>(Coordinates.x)) << 32) | static_cast<uint32_t>(Coordinates.y);
+	}
+
+	float WorldStreamer::GetDistance(const glm::vec2& Viewer, const glm::ivec2& Coordinates) const
+	{
+		const glm::vec2 Min = glm::vec2(Coordinates) * m_CellSize;
+		const glm::vec2 Nearest = glm::clamp(Viewer, Min, Min + m_CellSize);
+		return glm::distance(Viewer, Nearest);
+	}
+
+	void WorldStreamer::Unload(Cell& Unloaded)
+	{
+		for (SceneObject* Object : Unloaded.Objects)
+		{
+			m_Scene.RemoveObject(Object);
+		}
+		Unloaded.Objects.clear();
+		Unloaded.File.Close();
+	}
+
+	void WorldStreamer::Update()
+	{
+		FGL_PROFILE_SCOPE("WorldStreamer::Update")
+		const std::shared_ptr<BaseCamera> Camera = m_Scene.GetActiveCamera();
+		if (!Camera)
+			return;
+
+		const glm::vec3 CameraPosition = Camera->GetViewPosition();
+		const glm::vec2 Viewer(CameraPosition.x, CameraPosition.z);
+
+		// Finished reads, then the cells out of range; cells still being read are dropped once their job is done
+		size_t Pending = 0;
+		Cell* Nearest = nullptr;
+		float NearestDistance = std::numeric_limits<float>::max();
+		for (auto Iterator = m_Cells.begin(); Iterator != m_Cells.end();)
+		{
+			Cell& Streamed = *Iterator->second;
+			if (Streamed.State == CellState::Reading && Streamed.Counter.IsDone())
+			{
+				Streamed.State = Streamed.bOpened ? CellState::Read : CellState::Empty;
+				if (Streamed.bOpened && m_AssetCallback)
+				{
+					m_AssetCallback(Streamed.Assets);
+				}
+			}
+
+			const float Distance = GetDistance(Viewer, Streamed.Coordinates);
+			if (Distance > m_UnloadRadius && Streamed.State != CellState::Reading)
+			{
+				Unload(Streamed);
+				Iterator = m_Cells.erase(Iterator);
+				continue;
+			}
+
+			if (Streamed.State == CellState::Reading)
+			{
+				Pending++;
+			}
+			else if (Streamed.State == CellState::Read && Distance < NearestDistance)
+			{
+				Nearest = &Streamed;
+				NearestDistance = Distance;
+			}
+			++Iterator;
+		}
+
+		// One cell per frame, the nearest first
+		if (Nearest)
+		{
+			Nearest->File.Instantiate(m_Scene, &Nearest->Objects, &m_Factories);
+			Nearest->File.Close();
+			Nearest->Assets.clear();
+			Nearest->State = CellState::Loaded;
+		}
+
+		// The nearest missing cells are read first, a few at a time, the others wait for the next frames
+		m_Candidates.clear();
+		const glm::ivec2 First = glm::ivec2(glm::floor((Viewer - m_LoadRadius) / m_CellSize));
+		const glm::ivec2 Last = glm::ivec2(glm::floor((Viewer + m_LoadRadius) / m_CellSize));
+		for (int Z = First.y; Z <= Last.y; Z++)
+		{
+			for (int X = First.x; X <= Last.x; X++)
+			{
+				const glm::ivec2 Coordinates(X, Z);
+				const float Distance = GetDistance(Viewer, Coordinates);
+				if (Distance <= m_LoadRadius && !m_Cells.count(GetKey(Coordinates)))
+				{
+					m_Candidates.emplace_back(Distance, Coordinates);
+				}
+			}
+		}
+		std::sort(m_Candidates.begin(), m_Candidates.end(), [](const auto& A, const auto& B) { return A.first < B.first; });
+
+		for (const auto& [Distance, Coordinates] : m_Candidates)
+		{
+			if (Pending >= m_MaxPendingLoads)
+				break;
+
+			std::unique_ptr<Cell> Requested = std::make_unique<Cell>();
+			Requested->Coordinates = Coordinates;
+			Cell* Reading = Requested.get();
+			m_Cells.emplace(GetKey(Coordinates), std::move(Requested));
+
+			// Reading the records through faults the mapped pages in on the worker rather than in Instantiate()
+			m_Jobs.Schedule([Reading, Path = GetCellPath(m_Directory, Coordinates)]()
+			{
+				Reading->bOpened = Reading->File.Open(Path);
+				if (Reading->bOpened)
+				{
+					Reading->File.GetAssets(Reading->Assets);
+				}
+			}, Reading->Counter);
+			Pending++;
+		}
+	}
+
+	void WorldStreamer::UnloadAll()
+	{
+		for (auto& [Key, Streamed] : m_Cells)
+		{
+			m_Jobs.Wait(Streamed->Counter);
+			Unload(*Streamed);
+		}
+		m_Cells.clear();
+	}
+
+	size_t WorldStreamer::GetLoadedCellCount() const
+	{
+		return static_cast<size_t>(std::count_if(m_Cells.begin(), m_Cells.end(), [](const auto& Entry) { return Entry.second->State == CellState::Loaded; }));
+	}
+
+	size_t WorldStreamer::GetPendingCellCount() const
+	{
+		return static_cast<size_t>(std::count_if(m_Cells.begin(), m_Cells.end(), [](const auto& Entry)
+		{
+			return Entry.second->State == CellState::Reading || Entry.second->State == CellState::Read;
+		}));
+	}
+
+} // namespace fgl